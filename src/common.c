@@ -36,6 +36,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -61,11 +62,43 @@
 #include "shm_sub.h"
 #include "sysrepo.h"
 
+#ifndef MAP_NORESERVE
+# define MAP_NORESERVE 0
+#endif
+
+/* macro for getting the length of a SHM mapping */
+#define SR_SHM_MAP_SIZE(shm) (((shm)->size > (shm)->reserve) ? (shm)->size : (shm)->reserve)
+
+/* initial size of the strings buffer of a values arena */
+#define SR_VAL_ARENA_SIZE 4096
+
+/**
+ * @brief Growing buffer with all the strings of values being created in a single block.
+ */
+struct sr_val_arena_s {
+    char *buf;      /**< strings buffer */
+    size_t size;    /**< allocated size of @p buf */
+    size_t used;    /**< used size of @p buf */
+};
+
+/* magic value of the header of a values arena block, combined with the address of the values */
+#define SR_VAL_ARENA_MAGIC 0x5352564c41524e41ULL
+
+/**
+ * @brief Header of a values arena block, directly followed by the array of values and then their strings.
+ */
+struct sr_val_arena_hdr_s {
+    uint64_t magic;     /**< ::SR_VAL_ARENA_MAGIC XOR the address of the values */
+    uint64_t count;     /**< count of the values */
+};
+
 /**
  * @brief Internal datastore plugin array.
  */
 const struct srplg_ds_s *sr_internal_ds_plugins[] = {
     &srpds_json,    /**< JSON DS file */
+    &srpds_lyb,     /**< LYB DS file */
+    &srpds_shm,     /**< SHM DS */
 #ifdef SR_ENABLED_DS_PLG_MONGO
     &srpds_mongo,   /**< MONGO DS */
 #endif
@@ -79,6 +112,7 @@ const struct srplg_ds_s *sr_internal_ds_plugins[] = {
  */
 const struct srplg_ntf_s *sr_internal_ntf_plugins[] = {
     &srpntf_json,   /**< default */
+    &srpntf_lyb,    /**< LYB notif */
 };
 
 /**
@@ -977,6 +1011,17 @@ sr_module_has_data(const struct lys_module *ly_mod, int state_data)
     return 0;
 }
 
+int
+sr_module_all_ds_lockable(const struct lys_module *ly_mod)
+{
+    if (!strcmp(ly_mod->name, "sysrepo") || !strcmp(ly_mod->name, "ietf-netconf")) {
+        /* the same modules are skipped as by sr_modinfo_add_all_modules_with_data() */
+        return 0;
+    }
+
+    return sr_module_has_data(ly_mod, 0);
+}
+
 sr_error_info_t *
 sr_module_get_impl_inv_imports(const struct lys_module *ly_mod, struct ly_set *mod_set)
 {
@@ -1103,6 +1148,63 @@ sr_path_ext_shm(char **path)
     return err_info;
 }
 
+sr_error_info_t *
+sr_path_lock_stats_shm(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%s_lock_stats", SR_SHM_DIR, prefix) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+        *path = NULL;
+    }
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_event_stats_shm(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%s_event_stats", SR_SHM_DIR, prefix) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+        *path = NULL;
+    }
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_printed_ctx(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%s_ctx", SR_SHM_DIR, prefix) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+        *path = NULL;
+    }
+
+    return err_info;
+}
+
 sr_error_info_t *
 sr_path_sub_shm(const char *mod_name, const char *suffix1, int64_t suffix2, char **path)
 {
@@ -1151,6 +1253,74 @@ sr_path_sub_data_shm(const char *mod_name, const char *suffix1, int64_t suffix2,
     return err_info;
 }
 
+sr_error_info_t *
+sr_path_sub_diff_shm(sr_cid_t cid, uint32_t diff_id, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%sdiff.%08" PRIx32 ".%08" PRIx32, SR_SHM_DIR, prefix, cid, diff_id) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_run_cache_shm(const char *mod_name, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%srun_cache_%s", SR_SHM_DIR, prefix, mod_name) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_oper_slots_shm(const char *mod_name, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s/%soper_slots_%s", SR_SHM_DIR, prefix, mod_name) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_oper_cache_shm(const char *mod_name, const char *path, char **shm_path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (asprintf(shm_path, "%s/%soper_cache_%s_%08" PRIx32, SR_SHM_DIR, prefix, mod_name, sr_str_hash(path, 0)) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
 sr_error_info_t *
 sr_path_evpipe(uint32_t evpipe_num, char **path)
 {
@@ -1256,6 +1426,156 @@ cleanup:
     sr_errinfo_free(&err_info);
 }
 
+void
+sr_remove_sub_diffs(sr_cid_t cid)
+{
+    sr_error_info_t *err_info = NULL;
+    DIR *dir = NULL;
+    struct dirent *ent;
+    const char *prefix;
+    char *name = NULL, *path;
+    int len;
+
+    if ((err_info = sr_shm_prefix(&prefix))) {
+        goto cleanup;
+    }
+
+    /* segment name prefix, only of the specific connection if set */
+    if (cid) {
+        len = asprintf(&name, "%sdiff.%08" PRIx32 ".", prefix, cid);
+    } else {
+        len = asprintf(&name, "%sdiff.", prefix);
+    }
+    if (len == -1) {
+        name = NULL;
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+
+    dir = opendir(SR_SHM_DIR);
+    if (!dir) {
+        SR_ERRINFO_SYSERRNO(&err_info, "opendir");
+        goto cleanup;
+    }
+
+    while ((ent = readdir(dir))) {
+        if (!strncmp(ent->d_name, name, len)) {
+            SR_LOG_WRN("Removing shared diff segment \"%s\" after a crashed originator.", ent->d_name);
+
+            if (asprintf(&path, "%s/%s", SR_SHM_DIR, ent->d_name) == -1) {
+                SR_ERRINFO_MEM(&err_info);
+                goto cleanup;
+            }
+
+            if (unlink(path) == -1) {
+                /* continue */
+                SR_ERRINFO_SYSERRNO(&err_info, "unlink");
+            }
+            free(path);
+        }
+    }
+
+cleanup:
+    if (dir) {
+        closedir(dir);
+    }
+    free(name);
+    sr_errinfo_free(&err_info);
+}
+
+/**
+ * @brief Remove all segments with a specific name in SHM directory.
+ *
+ * @param[in] seg_name Segment name that follows the SHM prefix.
+ */
+static void
+sr_remove_shm_segments(const char *seg_name)
+{
+    sr_error_info_t *err_info = NULL;
+    DIR *dir = NULL;
+    struct dirent *ent;
+    const char *prefix;
+    char *name = NULL, *path;
+    int len;
+
+    if ((err_info = sr_shm_prefix(&prefix))) {
+        goto cleanup;
+    }
+
+    /* segment name prefix */
+    if ((len = asprintf(&name, "%s%s", prefix, seg_name)) == -1) {
+        name = NULL;
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+
+    dir = opendir(SR_SHM_DIR);
+    if (!dir) {
+        SR_ERRINFO_SYSERRNO(&err_info, "opendir");
+        goto cleanup;
+    }
+
+    while ((ent = readdir(dir))) {
+        if (!strncmp(ent->d_name, name, len)) {
+            if (asprintf(&path, "%s/%s", SR_SHM_DIR, ent->d_name) == -1) {
+                SR_ERRINFO_MEM(&err_info);
+                goto cleanup;
+            }
+
+            if (unlink(path) == -1) {
+                /* continue */
+                SR_ERRINFO_SYSERRNO(&err_info, "unlink");
+            }
+            free(path);
+        }
+    }
+
+cleanup:
+    if (dir) {
+        closedir(dir);
+    }
+    free(name);
+    sr_errinfo_free(&err_info);
+}
+
+void
+sr_remove_run_caches(void)
+{
+    /* cache IDs are reset with main SHM so the segments are stale */
+    sr_remove_shm_segments("run_cache_");
+}
+
+void
+sr_remove_oper_caches(void)
+{
+    sr_remove_shm_segments("oper_cache_");
+}
+
+void
+sr_remove_oper_slots(const char *mod_name)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    if (!mod_name) {
+        /* the slots of all the modules */
+        sr_remove_shm_segments("oper_slots_");
+        return;
+    }
+
+    if ((err_info = sr_path_oper_slots_shm(mod_name, &path))) {
+        goto cleanup;
+    }
+
+    if ((unlink(path) == -1) && (errno != ENOENT)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "unlink");
+    }
+
+cleanup:
+    free(path);
+    sr_errinfo_free(&err_info);
+}
+
 sr_error_info_t *
 sr_get_pwd(uid_t *uid, char **user)
 {
@@ -1470,24 +1790,169 @@ sr_time_sub_ms(const struct timespec *ts1, const struct timespec *ts2)
     return (result.tv_sec * 1000) + (result.tv_nsec / 1000000);
 }
 
-sr_error_info_t *
-sr_shm_remap(sr_shm_t *shm, size_t new_shm_size)
+/**
+ * @brief Get the number of microseconds elapsed since a time.
+ *
+ * @param[in] start Start time.
+ * @return Elapsed microseconds.
+ */
+static uint32_t
+sr_time_elapsed_us(const struct timespec *start)
 {
-    sr_error_info_t *err_info = NULL;
-    size_t shm_file_size = 0;
+    struct timespec now, result;
 
-    /* read the new shm size if not set */
-    if (!new_shm_size && (err_info = sr_file_get_size(shm->fd, &shm_file_size))) {
-        return err_info;
+    sr_timeouttime_get(&now, 0);
+    result = sr_time_sub(&now, start);
+    if ((result.tv_sec == 0) && (result.tv_nsec == -1)) {
+        return 0;
     }
+    return (result.tv_sec * 1000000) + (result.tv_nsec / 1000);
+}
 
-    if ((!new_shm_size && (shm_file_size == shm->size)) || (new_shm_size && (new_shm_size == shm->size))) {
-        /* mapping is fine, the size has not changed */
-        return NULL;
+void
+sr_timing_request_start(sr_session_ctx_t *session, struct timespec *start)
+{
+    if (!session->timing.enabled) {
+        return;
+    }
+
+    memset(session->timing.phase_us, 0, sizeof session->timing.phase_us);
+    session->timing.total_us = 0;
+    sr_timeouttime_get(start, 0);
+}
+
+void
+sr_timing_request_end(sr_session_ctx_t *session, const char *request, const struct timespec *start)
+{
+    const uint32_t *p;
+
+    if (!session->timing.enabled) {
+        return;
+    }
+
+    session->timing.total_us = sr_time_elapsed_us(start);
+
+    if (session->timing.slow_ms && (session->timing.total_us / 1000 >= session->timing.slow_ms)) {
+        p = session->timing.phase_us;
+        SR_LOG_WRN("Slow %s of session %" PRIu32 " took %" PRIu32 " us (lock %" PRIu32 ", load %" PRIu32 ", edit %"
+                PRIu32 ", validate %" PRIu32 ", notify %" PRIu32 ", store %" PRIu32 ").", request, session->sid,
+                session->timing.total_us, p[SR_PHASE_LOCK], p[SR_PHASE_LOAD], p[SR_PHASE_EDIT], p[SR_PHASE_VALIDATE],
+                p[SR_PHASE_NOTIFY], p[SR_PHASE_STORE]);
+    }
+}
+
+void
+sr_timing_phase_start(const uint32_t *phase_us, struct timespec *start)
+{
+    if (!phase_us) {
+        return;
+    }
+
+    sr_timeouttime_get(start, 0);
+}
+
+void
+sr_timing_phase_end(uint32_t *phase_us, sr_phase_t phase, const struct timespec *start)
+{
+    if (!phase_us) {
+        return;
+    }
+
+    phase_us[phase] += sr_time_elapsed_us(start);
+}
+
+int
+sr_shm_hugepages(void)
+{
+    const char *value;
+
+    value = getenv(SR_SHM_HUGEPAGES_ENV);
+    if (value && value[0]) {
+        return strcmp(value, "0") ? 1 : 0;
+    }
+
+#ifdef SR_SHM_HUGEPAGES
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Advise a SHM mapping to use transparent huge pages and pre-fault a part of it.
+ *
+ * Both are only hints, if the kernel does not support them the mapping uses normal pages.
+ *
+ * @param[in] shm SHM with the mapping.
+ * @param[in] new_map Whether the mapping was just created.
+ * @param[in] old_size Size of the file part of the mapping that is already faulted in.
+ */
+static void
+sr_shm_huge_advise(sr_shm_t *shm, int new_map, size_t old_size)
+{
+    size_t page_size, off;
+
+    if (new_map) {
+        /* the advice applies to the whole mapping, also to the reserved space the file grows into */
+#ifdef MADV_HUGEPAGE
+        madvise(shm->addr, SR_SHM_MAP_SIZE(shm), MADV_HUGEPAGE);
+#endif
+        old_size = 0;
+    }
+
+    if (old_size >= shm->size) {
+        /* nothing new to fault in */
+        return;
+    }
+
+    /* pre-fault only the part backed by the file, accessing the rest would fail */
+    page_size = sysconf(_SC_PAGESIZE);
+    off = old_size - (old_size % page_size);
+#ifdef MADV_POPULATE_WRITE
+    if (!madvise(shm->addr + off, shm->size - off, MADV_POPULATE_WRITE)) {
+        return;
+    }
+#endif
+
+    /* populating not supported, read every page, writing it could overwrite data of other processes */
+    for ( ; off < shm->size; off += page_size) {
+        (void)*(volatile char *)(shm->addr + off);
+    }
+}
+
+sr_error_info_t *
+sr_shm_remap(sr_shm_t *shm, size_t new_shm_size)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t shm_file_size = 0, old_size;
+
+    /* read the new shm size if not set */
+    if (!new_shm_size && (err_info = sr_file_get_size(shm->fd, &shm_file_size))) {
+        return err_info;
+    }
+
+    if ((!new_shm_size && (shm_file_size == shm->size)) || (new_shm_size && (new_shm_size == shm->size))) {
+        /* mapping is fine, the size has not changed */
+        return NULL;
+    }
+
+    if (SR_SHM_RESERVED(shm, new_shm_size ? new_shm_size : shm_file_size)) {
+        /* the reserved mapping stays valid, only truncate if needed */
+        if (new_shm_size && (ftruncate(shm->fd, new_shm_size) == -1)) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to truncate shared memory (%s).", strerror(errno));
+            return err_info;
+        }
+
+        old_size = shm->size;
+        shm->size = new_shm_size ? new_shm_size : shm_file_size;
+        if (shm->huge) {
+            sr_shm_huge_advise(shm, 0, old_size);
+        }
+        return NULL;
     }
 
     if (shm->addr) {
-        munmap(shm->addr, shm->size);
+        munmap(shm->addr, SR_SHM_MAP_SIZE(shm));
     }
 
     /* truncate if needed */
@@ -1499,13 +1964,17 @@ sr_shm_remap(sr_shm_t *shm, size_t new_shm_size)
 
     shm->size = new_shm_size ? new_shm_size : shm_file_size;
 
-    /* map */
-    shm->addr = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    /* map, the whole reserved address space if the SHM fits into it, it is backed by the file only up to its size */
+    shm->addr = mmap(NULL, SR_SHM_MAP_SIZE(shm), PROT_READ | PROT_WRITE,
+            MAP_SHARED | ((shm->size <= shm->reserve) ? MAP_NORESERVE : 0), shm->fd, 0);
     if (shm->addr == MAP_FAILED) {
         shm->addr = NULL;
         sr_errinfo_new(&err_info, SR_ERR_NO_MEMORY, "Failed to map shared memory (%s).", strerror(errno));
         return err_info;
     }
+    if (shm->huge) {
+        sr_shm_huge_advise(shm, 1, 0);
+    }
 
     return NULL;
 }
@@ -1514,7 +1983,7 @@ void
 sr_shm_clear(sr_shm_t *shm)
 {
     if (shm->addr) {
-        munmap(shm->addr, shm->size);
+        munmap(shm->addr, SR_SHM_MAP_SIZE(shm));
         shm->addr = NULL;
     }
     if (shm->fd > -1) {
@@ -1524,49 +1993,128 @@ sr_shm_clear(sr_shm_t *shm)
     shm->size = 0;
 }
 
+/** get a hole from its offset in ext SHM */
+#define SR_EXT_HOLE(ext_shm, off) ((sr_ext_hole_t *)(((char *)(ext_shm)) + (off)))
+
+/** get the offset of a hole in ext SHM */
+#define SR_EXT_HOLE_OFF(ext_shm, hole) ((uint32_t)(((char *)(hole)) - (char *)(ext_shm)))
+
+/**
+ * @brief Get the size class of a hole, its size is at least SR_SHM_MEM_ALIGN * 2^class.
+ *
+ * @param[in] size Hole size.
+ * @return Size class.
+ */
+static uint32_t
+sr_ext_hole_class(uint32_t size)
+{
+    uint32_t class = 0;
+
+    size /= SR_SHM_MEM_ALIGN;
+    while ((size >>= 1) && (class < SR_EXT_HOLE_CLASS_COUNT - 1)) {
+        ++class;
+    }
+
+    return class;
+}
+
 sr_ext_hole_t *
 sr_ext_hole_next(sr_ext_hole_t *last, sr_ext_shm_t *ext_shm)
 {
-    if (!last) {
-        if (!ext_shm->first_hole_off) {
-            return NULL;
+    sr_ext_hole_t *hole, *next = NULL;
+    uint32_t class, off, last_off;
+
+    last_off = last ? SR_EXT_HOLE_OFF(ext_shm, last) : 0;
+
+    /* the first hole following the last one in each list, the lowest one of those */
+    for (class = 0; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        for (off = ext_shm->first_hole_off[class]; off; off = hole->next_hole_off) {
+            hole = SR_EXT_HOLE(ext_shm, off);
+            if (off > last_off) {
+                if (!next || (hole < next)) {
+                    next = hole;
+                }
+                break;
+            }
         }
-        return (sr_ext_hole_t *)(((char *)ext_shm) + ext_shm->first_hole_off);
-    } else if (!last->next_hole_off) {
-        return NULL;
     }
 
-    return (sr_ext_hole_t *)(((char *)ext_shm) + last->next_hole_off);
+    return next;
 }
 
 sr_ext_hole_t *
 sr_ext_hole_find(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t min_size)
 {
     sr_ext_hole_t *hole;
+    uint32_t class, hole_off;
+
+    class = sr_ext_hole_class(min_size);
+
+    if (off) {
+        /* only the lists with large enough holes can contain it */
+        for ( ; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+            for (hole_off = ext_shm->first_hole_off[class]; hole_off && (hole_off <= off);
+                    hole_off = hole->next_hole_off) {
+                hole = SR_EXT_HOLE(ext_shm, hole_off);
+                if (hole_off == off) {
+                    return (hole->size >= min_size) ? hole : NULL;
+                }
+            }
+        }
+        return NULL;
+    }
+
+    /* first fit in the list of the size class, holes may be smaller */
+    for (hole_off = ext_shm->first_hole_off[class]; hole_off; hole_off = hole->next_hole_off) {
+        hole = SR_EXT_HOLE(ext_shm, hole_off);
+        if (hole->size >= min_size) {
+            return hole;
+        }
+    }
+
+    /* any hole from the smallest larger size class */
+    for (++class; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        if (ext_shm->first_hole_off[class]) {
+            return SR_EXT_HOLE(ext_shm, ext_shm->first_hole_off[class]);
+        }
+    }
+
+    return NULL;
+}
+
+sr_ext_hole_t *
+sr_ext_hole_find_end(sr_ext_shm_t *ext_shm, uint32_t end_off)
+{
+    sr_ext_hole_t *hole;
+    uint32_t class, off;
 
-    for (hole = sr_ext_hole_next(NULL, ext_shm); hole; hole = sr_ext_hole_next(hole, ext_shm)) {
-        if (off) {
-            if (((char *)hole - (char *)ext_shm == (int)off) && (hole->size >= min_size)) {
+    for (class = 0; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        for (off = ext_shm->first_hole_off[class]; off && (off < end_off); off = hole->next_hole_off) {
+            hole = SR_EXT_HOLE(ext_shm, off);
+            if (off + hole->size == end_off) {
                 return hole;
             }
-            if ((char *)hole - (char *)ext_shm > (int)off) {
-                /* foo large offset, it cannot be found anymore */
-                break;
-            }
-        } else if (hole->size >= min_size) {
-            return hole;
         }
     }
 
     return NULL;
 }
 
-void
-sr_ext_hole_del(sr_ext_shm_t *ext_shm, sr_ext_hole_t *hole)
+/**
+ * @brief Unlink a hole from the list of its size class.
+ *
+ * @param[in] ext_shm Ext SHM.
+ * @param[in] hole Hole to unlink.
+ */
+static void
+sr_ext_hole_unlink(sr_ext_shm_t *ext_shm, sr_ext_hole_t *hole)
 {
     sr_ext_hole_t *h, *prev = NULL;
+    uint32_t class, off;
 
-    for (h = sr_ext_hole_next(NULL, ext_shm); h; h = sr_ext_hole_next(h, ext_shm)) {
+    class = sr_ext_hole_class(hole->size);
+    for (off = ext_shm->first_hole_off[class]; off; off = h->next_hole_off) {
+        h = SR_EXT_HOLE(ext_shm, off);
         if (h == hole) {
             /* found the hole */
             break;
@@ -1574,74 +2122,144 @@ sr_ext_hole_del(sr_ext_shm_t *ext_shm, sr_ext_hole_t *hole)
 
         prev = h;
     }
-    assert(h);
+    assert(off);
 
-    /* fíx offsets */
+    /* fix offsets */
     if (prev) {
         prev->next_hole_off = hole->next_hole_off;
     } else {
-        ext_shm->first_hole_off = hole->next_hole_off;
+        ext_shm->first_hole_off[class] = hole->next_hole_off;
+    }
+}
+
+/**
+ * @brief Link a hole into the list of its size class, keeping it ordered by offset.
+ *
+ * @param[in] ext_shm Ext SHM.
+ * @param[in] off Offset of the hole.
+ * @param[in] size Size of the hole.
+ */
+static void
+sr_ext_hole_link(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t size)
+{
+    sr_ext_hole_t *hole, *h, *prev = NULL;
+    uint32_t class, next_off;
+
+    class = sr_ext_hole_class(size);
+    for (next_off = ext_shm->first_hole_off[class]; next_off && (next_off < off); next_off = h->next_hole_off) {
+        h = SR_EXT_HOLE(ext_shm, next_off);
+        prev = h;
+    }
+
+    hole = SR_EXT_HOLE(ext_shm, off);
+    hole->size = size;
+    hole->next_hole_off = next_off;
+    if (prev) {
+        prev->next_hole_off = off;
+    } else {
+        ext_shm->first_hole_off[class] = off;
+    }
+}
+
+void
+sr_ext_hole_del(sr_ext_shm_t *ext_shm, sr_ext_hole_t *hole)
+{
+    sr_ext_hole_unlink(ext_shm, hole);
+
+    /* update stats */
+    --ext_shm->hole_count;
+    ext_shm->hole_size -= hole->size;
+}
+
+/**
+ * @brief Find the holes adjacent to a new hole, in a single pass of each size class list.
+ *
+ * Every list is ordered by offset so only its last hole before the new one can end at @p off and only the
+ * following one can start right after it. The lists are still scanned up to @p off, there is no index of
+ * the holes by their offset.
+ *
+ * @param[in] ext_shm Ext SHM.
+ * @param[in] off Offset of the new hole.
+ * @param[in] size Size of the new hole.
+ * @param[out] prev Hole ending at @p off, NULL if none.
+ * @param[out] next Hole starting right after the new hole, NULL if none.
+ */
+static void
+sr_ext_hole_find_adjacent(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t size, sr_ext_hole_t **prev,
+        sr_ext_hole_t **next)
+{
+    sr_ext_hole_t *hole, *last;
+    uint32_t class, hole_off;
+
+    *prev = NULL;
+    *next = NULL;
+
+    for (class = 0; (class < SR_EXT_HOLE_CLASS_COUNT) && (!*prev || !*next); ++class) {
+        last = NULL;
+        for (hole_off = ext_shm->first_hole_off[class]; hole_off && (hole_off < off); hole_off = hole->next_hole_off) {
+            hole = SR_EXT_HOLE(ext_shm, hole_off);
+            last = hole;
+        }
+
+        if (last && (SR_EXT_HOLE_OFF(ext_shm, last) + last->size == off)) {
+            *prev = last;
+        }
+        if (hole_off == off + size) {
+            *next = SR_EXT_HOLE(ext_shm, hole_off);
+        }
     }
 }
 
 void
 sr_ext_hole_add(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t size)
 {
-    sr_ext_hole_t *next, *prev = NULL, *hole;
-    int con_prev = 0, con_next = 0;
+    sr_ext_hole_t *prev, *next;
 
     if (!size) {
         /* nothing to do */
         return;
     }
 
-    for (next = sr_ext_hole_next(NULL, ext_shm); next; next = sr_ext_hole_next(next, ext_shm)) {
-        if ((char *)next - (char *)ext_shm > (int)off) {
-            /* found the next hole */
-            break;
-        }
+    /* update stats */
+    ++ext_shm->hole_count;
+    ext_shm->hole_size += size;
 
-        prev = next;
-    }
+    /* find the adjacent holes */
+    sr_ext_hole_find_adjacent(ext_shm, off, size, &prev, &next);
 
-    if (prev && (((char *)prev - (char *)ext_shm) + prev->size == off)) {
-        /* connecting with prev */
-        con_prev = 1;
+    if (prev) {
+        /* prev + hole */
+        sr_ext_hole_unlink(ext_shm, prev);
+        off = SR_EXT_HOLE_OFF(ext_shm, prev);
+        size += prev->size;
+        --ext_shm->hole_count;
     }
-    if (next && ((int)(off + size) == (char *)next - (char *)ext_shm)) {
-        /* connecting with next */
-        con_next = 1;
+    if (next) {
+        /* hole + next */
+        sr_ext_hole_unlink(ext_shm, next);
+        size += next->size;
+        --ext_shm->hole_count;
     }
 
-    hole = (sr_ext_hole_t *)((char *)ext_shm + off);
-    if (con_prev && con_next) {
-        /* prev + hole + next */
-        prev->size += size + next->size;
-        prev->next_hole_off = next->next_hole_off;
-    } else if (con_prev) {
-        /* prev + hole -> (next) */
-        prev->size += size;
-    } else if (con_next) {
-        /* (prev) -> hole + next */
-        if (prev) {
-            prev->next_hole_off = off;
-        } else {
-            ext_shm->first_hole_off = off;
-        }
-        hole->size = size + next->size;
-        hole->next_hole_off = next->next_hole_off;
-    } else {
-        /* (prev) -> hole -> (next) */
-        if (prev) {
-            prev->next_hole_off = off;
-        } else {
-            ext_shm->first_hole_off = off;
-        }
-        hole->size = size;
-        if (next) {
-            hole->next_hole_off = (char *)next - (char *)ext_shm;
-        } else {
-            hole->next_hole_off = 0;
+    /* the (merged) hole belongs to a size class */
+    sr_ext_hole_link(ext_shm, off, size);
+}
+
+void
+sr_ext_hole_stats(sr_ext_shm_t *ext_shm, uint32_t *class_count, uint32_t *largest)
+{
+    sr_ext_hole_t *hole;
+    uint32_t class, off;
+
+    *largest = 0;
+    for (class = 0; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        class_count[class] = 0;
+        for (off = ext_shm->first_hole_off[class]; off; off = hole->next_hole_off) {
+            hole = SR_EXT_HOLE(ext_shm, off);
+            ++class_count[class];
+            if (hole->size > *largest) {
+                *largest = hole->size;
+            }
         }
     }
 }
@@ -2087,1243 +2705,4545 @@ sr_ev_data_get(const void *ev_data, uint32_t idx, uint32_t *size, void **data)
     return SR_ERR_OK;
 }
 
+#if defined (SR_LOCK_STATS) || defined (SR_EVENT_TRACE)
+
 /**
- * @brief Wrapper for pthread_mutex_init().
+ * @brief Open and map a stats SHM, create it if it does not exist.
  *
- * @param[in,out] lock pthread mutex to initialize.
- * @param[in] shared Whether the mutex will be shared between processes or not.
- * @param[in] robust Whether the mutex should support recovery after its owner dies or not.
- * @return err_info, NULL on success.
+ * @param[in] path Stats SHM path.
+ * @param[in] shm_size Size of the stats SHM structure, its first member must be the SHM version.
+ * @param[in] desc Stats SHM description for printing.
+ * @return Mapped stats SHM, NULL on error or version mismatch.
  */
-static sr_error_info_t *
-_sr_mutex_init(pthread_mutex_t *lock, int shared, int robust)
+static void *
+sr_stats_shm_map(const char *path, size_t shm_size, const char *desc)
 {
     sr_error_info_t *err_info = NULL;
-    pthread_mutexattr_t attr;
-    int ret;
+    size_t size;
+    uint_fast32_t shm_ver = 0;
+    void *addr = NULL;
+    int fd = -1, r;
 
-    /* check address alignment */
-    if (SR_MUTEX_ALIGN_CHECK(lock)) {
-        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Mutex address not aligned.");
-        return err_info;
+    fd = sr_open(path, O_RDWR | O_CREAT, SR_SHM_PERM);
+    if (fd == -1) {
+        SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
+        goto cleanup;
     }
 
-    if (shared || robust) {
-        /* init attr */
-        if ((ret = pthread_mutexattr_init(&attr))) {
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread attr failed (%s).", strerror(ret));
-            return err_info;
-        }
-
-        if (shared && (ret = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED))) {
-            pthread_mutexattr_destroy(&attr);
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Changing pthread attr failed (%s).", strerror(ret));
-            return err_info;
-        }
+    /* the stats always have the same size, zeroed when created */
+    if ((err_info = sr_file_get_size(fd, &size))) {
+        goto cleanup;
+    }
+    if ((size < shm_size) && (ftruncate(fd, shm_size) == -1)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "ftruncate");
+        goto cleanup;
+    }
 
-        if (robust && (ret = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST))) {
-            pthread_mutexattr_destroy(&attr);
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Changing pthread attr failed (%s).", strerror(ret));
-            return err_info;
-        }
+    addr = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        SR_ERRINFO_SYSERRNO(&err_info, "mmap");
+        addr = NULL;
+        goto cleanup;
+    }
 
-        if ((ret = pthread_mutex_init(lock, &attr))) {
-            pthread_mutexattr_destroy(&attr);
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread mutex failed (%s).", strerror(ret));
-            return err_info;
-        }
-        pthread_mutexattr_destroy(&attr);
-    } else {
-        if ((ret = pthread_mutex_init(lock, NULL))) {
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread mutex failed (%s).", strerror(ret));
-            return err_info;
-        }
+    /* check the version, initialize it if not yet */
+    ATOMIC_COMPARE_EXCHANGE_RELAXED(*(ATOMIC_T *)addr, shm_ver, SR_SHM_VER, r);
+    if (!r && (shm_ver != SR_SHM_VER)) {
+        SR_LOG_WRN("%s stats SHM \"%s\" version mismatch, statistics will not be collected.", desc, path);
+        munmap(addr, shm_size);
+        addr = NULL;
+        goto cleanup;
     }
 
-    return NULL;
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    sr_errinfo_free(&err_info);
+    return addr;
 }
 
-sr_error_info_t *
-sr_mutex_init(pthread_mutex_t *lock, int shared)
+/**
+ * @brief Find the histogram bucket of a duration.
+ *
+ * @param[in] us Duration in us.
+ * @param[in] bucket_count Number of histogram buckets, bucket i holds durations below 10^(i+1) us.
+ * @return Bucket index.
+ */
+static uint32_t
+sr_stats_hist_bucket(uint64_t us, uint32_t bucket_count)
 {
-    return _sr_mutex_init(lock, shared, shared);
+    uint64_t limit_us;
+    uint32_t bucket = 0;
+
+    for (limit_us = 10; (bucket < bucket_count - 1) && (us >= limit_us); limit_us *= 10) {
+        ++bucket;
+    }
+    return bucket;
 }
 
-sr_error_info_t *
-sr_mlock(pthread_mutex_t *lock, int timeout_ms, const char *func, sr_lock_recover_cb cb, void *cb_data)
-{
-    sr_error_info_t *err_info = NULL;
-    struct timespec abs_ts;
-    int ret;
+#endif
 
-    assert(timeout_ms);
+#ifdef SR_LOCK_STATS
 
-    if (timeout_ms == -1) {
-        ret = pthread_mutex_lock(lock);
-    } else {
-        sr_timeouttime_get(&abs_ts, (uint32_t)timeout_ms);
-        ret = pthread_mutex_clocklock(lock, COMPAT_CLOCK_ID, &abs_ts);
-    }
+/** number of locks held by a thread at once with tracked hold duration, the oldest are forgotten */
+#define SR_LOCK_STATS_HELD_COUNT 16
 
-    if (ret == EOWNERDEAD) {
-        /* make consistent */
-        ret = pthread_mutex_consistent(lock);
-        SR_CHECK_INT_RET(ret, err_info);
+/**
+ * @brief Lock held by a thread, used for measuring the lock hold duration.
+ */
+struct sr_lock_stats_held_s {
+    const void *lock;               /**< Held lock, NULL if the item is unused. */
+    struct timespec ts;             /**< Timestamp of the lock acquisition. */
+    sr_lock_stats_site_t *site;     /**< Site of the lock acquisition. */
+};
 
-        /* recover */
-        if (cb) {
-            cb(SR_LOCK_WRITE, 0, cb_data);
-        }
+/** lock stats SHM mapped for the whole lifetime of the process */
+static sr_lock_stats_shm_t *sr_lock_stats_shm;
 
-        SR_LOG_WRN("Recovered a lock with a dead owner (%s).", func);
-    } else if (ret) {
-        SR_ERRINFO_LOCK(&err_info, func, ret);
-        return err_info;
-    }
+/** guards lock stats SHM mapping */
+static pthread_once_t sr_lock_stats_once = PTHREAD_ONCE_INIT;
 
-    return NULL;
-}
+/** locks held by this thread */
+static _Thread_local struct sr_lock_stats_held_s sr_lock_stats_held[SR_LOCK_STATS_HELD_COUNT];
 
-void
-sr_munlock(pthread_mutex_t *lock)
+/** index of the next held lock item to use */
+static _Thread_local uint32_t sr_lock_stats_held_next;
+
+/**
+ * @brief Open and map lock stats SHM, create it if it does not exist.
+ */
+static void
+sr_lock_stats_open(void)
 {
     sr_error_info_t *err_info = NULL;
-    int ret;
+    char *path = NULL;
 
-    ret = pthread_mutex_unlock(lock);
-    if (ret) {
-        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(ret));
+    if ((err_info = sr_path_lock_stats_shm(&path))) {
         sr_errinfo_free(&err_info);
+        return;
     }
+
+    sr_lock_stats_shm = sr_stats_shm_map(path, sizeof *sr_lock_stats_shm, "Lock");
+    free(path);
 }
 
-sr_error_info_t *
-sr_rwlock_init(sr_rwlock_t *rwlock, int shared)
+/**
+ * @brief Find or add a lock site in lock stats SHM.
+ *
+ * @param[in] func Lock site name.
+ * @return Lock site, NULL if lock stats SHM is not available or there is no space left.
+ */
+static sr_lock_stats_site_t *
+sr_lock_stats_site(const char *func)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_lock_stats_site_t *site;
+    uint_fast32_t hash, exp;
+    uint32_t i;
+    int r;
 
-    if ((err_info = sr_mutex_init(&rwlock->mutex, shared))) {
-        return err_info;
+    if (!func || pthread_once(&sr_lock_stats_once, sr_lock_stats_open) || !sr_lock_stats_shm) {
+        return NULL;
     }
-    if ((err_info = sr_cond_init(&rwlock->cond, shared, shared))) {
-        pthread_mutex_destroy(&rwlock->mutex);
-        return err_info;
+
+    hash = sr_str_hash(func, 0);
+    if (!hash) {
+        /* reserved */
+        hash = 1;
     }
 
-    memset(rwlock->readers, 0, sizeof rwlock->readers);
-    rwlock->upgr = 0;
-    rwlock->writer = 0;
+    for (i = 0; i < SR_LOCK_STATS_SITE_COUNT; ++i) {
+        site = &sr_lock_stats_shm->sites[(hash + i) & (SR_LOCK_STATS_SITE_COUNT - 1)];
+
+        exp = ATOMIC_LOAD_RELAXED(site->site_hash);
+        if (!exp) {
+            /* try to claim the free site */
+            ATOMIC_COMPARE_EXCHANGE_RELAXED(site->site_hash, exp, hash, r);
+            if (r) {
+                strncpy(site->site, func, SR_LOCK_STATS_SITE_LEN - 1);
+                return site;
+            }
+        }
+        if (exp == hash) {
+            return site;
+        }
+    }
 
+    /* full */
     return NULL;
 }
 
-void
-sr_rwlock_destroy(sr_rwlock_t *rwlock)
+/**
+ * @brief Get the difference of 2 timestamps in microseconds.
+ *
+ * @param[in] ts1 Later timestamp.
+ * @param[in] ts2 Earlier timestamp.
+ * @return Difference in us, 0 if negative.
+ */
+static uint64_t
+sr_lock_stats_time_sub_us(const struct timespec *ts1, const struct timespec *ts2)
 {
-    pthread_mutex_destroy(&rwlock->mutex);
-    sr_cond_destroy(&rwlock->cond);
+    struct timespec result;
+
+    result = sr_time_sub(ts1, ts2);
+    if ((result.tv_sec == 0) && (result.tv_nsec == -1)) {
+        return 0;
+    }
+    return ((uint64_t)result.tv_sec * 1000000) + (result.tv_nsec / 1000);
 }
 
 /**
- * @brief Add a reader CID to a rwlock.
+ * @brief Update lock stats after a lock was acquired.
  *
- * @param[in] rwlock Lock to add a reader to.
- * @param[in] cid Owner CID.
- * @return err_info, NULL on success.
+ * @param[in] lock Acquired lock.
+ * @param[in] func Lock site name.
+ * @param[in] start_ts Timestamp when the locking started.
+ * @param[in] hold Whether to start measuring the lock hold duration.
  */
-static sr_error_info_t *
-sr_rwlock_reader_add(sr_rwlock_t *rwlock, sr_cid_t cid)
+static void
+sr_lock_stats_acquired(const void *lock, const char *func, const struct timespec *start_ts, int hold)
 {
-    sr_error_info_t *err_info = NULL;
-    uint32_t i;
+    sr_lock_stats_site_t *site;
+    struct sr_lock_stats_held_s *held;
+    struct timespec cur_ts;
+    uint_fast64_t wait_us, max_us;
+    int r;
 
-    /* find this connection or first free item */
-    for (i = 0; (i < SR_RWLOCK_READ_LIMIT) && rwlock->readers[i] && (rwlock->readers[i] != cid); ++i) {}
-    if (i == SR_RWLOCK_READ_LIMIT) {
-        sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Concurrent reader limit %d reached, possibly because of missing unlocks.",
-                SR_RWLOCK_READ_LIMIT);
-        goto cleanup;
+    if (!(site = sr_lock_stats_site(func))) {
+        return;
     }
 
-    if (!rwlock->readers[i]) {
-        /* first connection reader, assign owner cid */
-        rwlock->readers[i] = cid;
-        rwlock->read_count[i] = 1;
-    } else {
-        /* recursive read lock on the connection */
-        if (rwlock->read_count[i] == UINT8_MAX) {
-            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Recursive reader limit %" PRIu8
-                    " reached, possibly because of missing unlocks.", UINT8_MAX);
-            goto cleanup;
+    sr_timeouttime_get(&cur_ts, 0);
+    wait_us = sr_lock_stats_time_sub_us(&cur_ts, start_ts);
+
+    ATOMIC_INC_RELAXED(site->acquire_count);
+    ATOMIC_ADD_RELAXED(site->wait_total_us, wait_us);
+    max_us = ATOMIC_LOAD_RELAXED(site->wait_max_us);
+    while (wait_us > max_us) {
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(site->wait_max_us, max_us, wait_us, r);
+        if (r) {
+            break;
         }
-        ++rwlock->read_count[i];
     }
 
-cleanup:
-    return err_info;
+    if (hold) {
+        /* remember the lock, overwrite the oldest one if there are too many */
+        held = &sr_lock_stats_held[sr_lock_stats_held_next];
+        sr_lock_stats_held_next = (sr_lock_stats_held_next + 1) % SR_LOCK_STATS_HELD_COUNT;
+
+        held->lock = lock;
+        held->ts = cur_ts;
+        held->site = site;
+    }
 }
 
 /**
- * @brief Remove a reader lock from a rwlock.
+ * @brief Update lock stats after a lock was released.
  *
- * @param[in] rwlock Lock to remove the reader lock from.
- * @param[in] i Index of the reader.
+ * @param[in] lock Released lock.
  */
 static void
-sr_rwlock_reader_del_(sr_rwlock_t *rwlock, uint32_t i)
+sr_lock_stats_released(const void *lock)
 {
-    uint32_t move_count;
-    sr_cid_t last_reader;
-    uint8_t last_read_count;
-
-    /* decrease recursive read lock count */
-    assert(rwlock->read_count[i]);
-    --rwlock->read_count[i];
+    struct sr_lock_stats_held_s *held;
+    struct timespec cur_ts;
+    uint64_t hold_us;
+    uint32_t i;
 
-    if (rwlock->read_count[i]) {
-        /* read lock is still recursively held */
+    /* find the lock acquired last */
+    for (i = 1; i <= SR_LOCK_STATS_HELD_COUNT; ++i) {
+        held = &sr_lock_stats_held[(sr_lock_stats_held_next + SR_LOCK_STATS_HELD_COUNT - i) % SR_LOCK_STATS_HELD_COUNT];
+        if (held->lock == lock) {
+            break;
+        }
+    }
+    if (i > SR_LOCK_STATS_HELD_COUNT) {
+        /* not tracked */
         return;
     }
 
-    /* move all the readers to replace the deleted one, avoid duplicates and try to keep the arrays consistent for
-     * sysrepo monitoring */
-    move_count = 0;
-    while ((move_count < SR_RWLOCK_READ_LIMIT - i - 1) && rwlock->readers[i + move_count + 1]) {
-        ++move_count;
+    sr_timeouttime_get(&cur_ts, 0);
+    hold_us = sr_lock_stats_time_sub_us(&cur_ts, &held->ts);
+
+    ATOMIC_INC_RELAXED(held->site->hold_hist[sr_stats_hist_bucket(hold_us, SR_LOCK_STATS_HIST_COUNT)]);
+
+    held->lock = NULL;
+}
+
+#endif
+
+const sr_lock_stats_shm_t *
+sr_lock_stats_get(void)
+{
+#ifdef SR_LOCK_STATS
+    if (pthread_once(&sr_lock_stats_once, sr_lock_stats_open)) {
+        return NULL;
     }
+    return sr_lock_stats_shm;
+#else
+    return NULL;
+#endif
+}
+
+#ifdef SR_EVENT_TRACE
+
+/** event stats SHM mapped for the whole lifetime of the process */
+static sr_event_stats_shm_t *sr_event_stats_shm;
 
-    /* temporarily remove the last reader to avoid duplicating it */
-    last_reader = rwlock->readers[i + move_count];
-    last_read_count = rwlock->read_count[i + move_count];
-    rwlock->readers[i + move_count] = 0;
-    rwlock->read_count[i + move_count] = 0;
+/** guards event stats SHM mapping */
+static pthread_once_t sr_event_stats_once = PTHREAD_ONCE_INIT;
 
-    if (!move_count) {
-        /* no readers left */
+/**
+ * @brief Open and map event stats SHM, create it if it does not exist.
+ */
+static void
+sr_event_stats_open(void)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    if ((err_info = sr_path_event_stats_shm(&path))) {
+        sr_errinfo_free(&err_info);
         return;
     }
 
-    memmove(&rwlock->readers[i], &rwlock->readers[i + 1], move_count * sizeof *rwlock->readers);
-    memmove(&rwlock->read_count[i], &rwlock->read_count[i + 1], move_count * sizeof *rwlock->read_count);
-
-    /* restore the last reader */
-    rwlock->readers[i + move_count - 1] = last_reader;
-    rwlock->read_count[i + move_count - 1] = last_read_count;
+    sr_event_stats_shm = sr_stats_shm_map(path, sizeof *sr_event_stats_shm, "Event");
+    free(path);
 }
 
 /**
- * @brief Remove a reader from a rwlock.
+ * @brief Get the item of a subscription in event stats SHM, take it over from an older subscription if needed.
  *
- * @param[in] rwlock Lock to remove a reader from.
- * @param[in] cid Owner CID.
- * @return err_info, NULL on success.
+ * @param[in] sub_id Subscription ID.
+ * @param[in] type Subscription type.
+ * @param[in] name Subscription module name, NULL to only find an existing item.
+ * @return Subscription stats, NULL if event stats SHM is not available or the item was not found.
  */
-static sr_error_info_t *
-sr_rwlock_reader_del(sr_rwlock_t *rwlock, sr_cid_t cid)
+static sr_event_stats_sub_t *
+sr_event_stats_sub(uint32_t sub_id, sr_event_stats_type_t type, const char *name)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_event_stats_sub_t *sub;
+    uint_fast32_t cur_id;
     uint32_t i;
+    int r;
 
-    /* find a CID match */
-    for (i = 0; (i < SR_RWLOCK_READ_LIMIT) && rwlock->readers[i] && (rwlock->readers[i] != cid); ++i) {}
-    if ((i == SR_RWLOCK_READ_LIMIT) || (rwlock->readers[i] != cid)) {
-        /* CID not found */
-        SR_ERRINFO_INT(&err_info);
-        goto cleanup;
+    if (!sub_id || pthread_once(&sr_event_stats_once, sr_event_stats_open) || !sr_event_stats_shm) {
+        return NULL;
     }
 
-    /* remove the CID */
-    sr_rwlock_reader_del_(rwlock, i);
+    sub = &sr_event_stats_shm->subs[sub_id & (SR_EVENT_STATS_SUB_COUNT - 1)];
+    cur_id = ATOMIC_LOAD_RELAXED(sub->sub_id);
+    if (cur_id == sub_id) {
+        return sub;
+    } else if (!name || (cur_id > sub_id)) {
+        /* not found or used by a newer subscription */
+        return NULL;
+    }
 
-cleanup:
-    return err_info;
+    /* free or used by an older subscription, take it over */
+    ATOMIC_COMPARE_EXCHANGE_RELAXED(sub->sub_id, cur_id, sub_id, r);
+    if (!r) {
+        return (cur_id == sub_id) ? sub : NULL;
+    }
+
+    ATOMIC_STORE_RELAXED(sub->type, type);
+    strncpy(sub->name, name, SR_EVENT_STATS_NAME_LEN - 1);
+    sub->name[SR_EVENT_STATS_NAME_LEN - 1] = '\0';
+    ATOMIC_STORE_RELAXED(sub->event_count, 0);
+    for (i = 0; i < SR_EVENT_STATS_HIST_COUNT; ++i) {
+        ATOMIC_STORE_RELAXED(sub->wake_hist[i], 0);
+        ATOMIC_STORE_RELAXED(sub->cb_hist[i], 0);
+        ATOMIC_STORE_RELAXED(sub->reply_hist[i], 0);
+    }
+    return sub;
 }
 
 /**
- * @brief Recover a sysrepo RW lock.
- * Mutex must be held!
+ * @brief Get the duration between 2 trace timestamps.
  *
- * @param[in] rwlock RW lock to recover.
- * @param[in] func Lock caller function.
- * @param[in] cb Optional callback to call for each recovered lock.
- * @param[in] cb_data User data for @p cb.
+ * @param[in] ts1 Later timestamp.
+ * @param[in] ts2 Earlier timestamp.
+ * @return Duration in us, 0 if negative.
  */
-static void
-sr_rwlock_recover(sr_rwlock_t *rwlock, const char *func, sr_lock_recover_cb cb, void *cb_data)
+static uint64_t
+sr_event_trace_diff(uint64_t ts1, uint64_t ts2)
 {
-    uint32_t i = 0;
-    sr_cid_t cid;
+    return (ts1 > ts2) ? ts1 - ts2 : 0;
+}
 
-    /* readers */
-    while ((i < SR_RWLOCK_READ_LIMIT) && rwlock->readers[i]) {
-        if (!sr_conn_is_alive(rwlock->readers[i])) {
-            /* remove the dead reader */
-            cid = rwlock->readers[i];
-            sr_rwlock_reader_del_(rwlock, i);
+uint64_t
+sr_event_trace_now(void)
+{
+    struct timespec ts;
 
-            /* recover */
-            if (cb) {
-                cb(SR_LOCK_READ, cid, cb_data);
-            }
-            SR_LOG_WRN("Recovered a read-lock of CID %" PRIu32 " (%s).", cid, func);
-        } else {
-            ++i;
-        }
-    }
+    sr_timeouttime_get(&ts, 0);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
 
-    /* read-upgr */
-    if (rwlock->upgr) {
-        if (!sr_conn_is_alive(rwlock->upgr)) {
-            cid = rwlock->upgr;
-            rwlock->upgr = 0;
+void
+sr_event_trace_enqueue(sr_sub_trace_t *trace)
+{
+    ATOMIC_STORE_RELAXED(trace->wake, 0);
+    ATOMIC_STORE_RELAXED(trace->cb_start, 0);
+    ATOMIC_STORE_RELAXED(trace->cb_end, 0);
+    ATOMIC_STORE_RELAXED(trace->reply, 0);
+    ATOMIC_STORE_RELAXED(trace->sub_id, 0);
+    ATOMIC_STORE_RELAXED(trace->enqueue, sr_event_trace_now());
+}
 
-            /* recover */
-            if (cb) {
-                cb(SR_LOCK_READ_UPGR, cid, cb_data);
-            }
-            SR_LOG_WRN("Recovered a read-upgr-lock of CID %" PRIu32 " (%s).", cid, func);
-        }
-    }
+void
+sr_event_trace_callback(sr_sub_trace_t *trace, uint32_t sub_id, sr_event_stats_type_t type, const char *name,
+        uint64_t wake, uint64_t cb_start, uint64_t cb_end)
+{
+    sr_event_stats_sub_t *sub;
+    uint64_t enqueue;
 
-    /* write */
-    if (rwlock->writer) {
-        if (!sr_conn_is_alive(rwlock->writer)) {
-            cid = rwlock->writer;
-            rwlock->writer = 0;
+    enqueue = ATOMIC_LOAD_RELAXED(trace->enqueue);
 
-            /* recover */
-            if (cb) {
-                cb(SR_LOCK_WRITE, cid, cb_data);
-            }
-            SR_LOG_WRN("Recovered a write-lock of CID %" PRIu32 " (%s).", cid, func);
-        }
+    /* the header keeps the trace of the subscription that finished last */
+    ATOMIC_STORE_RELAXED(trace->wake, wake);
+    ATOMIC_STORE_RELAXED(trace->cb_start, cb_start);
+    ATOMIC_STORE_RELAXED(trace->cb_end, cb_end);
+    ATOMIC_STORE_RELAXED(trace->sub_id, sub_id);
+
+    if (!(sub = sr_event_stats_sub(sub_id, type, name))) {
+        return;
     }
+
+    ATOMIC_INC_RELAXED(sub->event_count);
+    if (enqueue) {
+        ATOMIC_INC_RELAXED(sub->wake_hist[sr_stats_hist_bucket(sr_event_trace_diff(wake, enqueue),
+                SR_EVENT_STATS_HIST_COUNT)]);
+    }
+    ATOMIC_INC_RELAXED(sub->cb_hist[sr_stats_hist_bucket(sr_event_trace_diff(cb_end, cb_start),
+            SR_EVENT_STATS_HIST_COUNT)]);
 }
 
-sr_error_info_t *
-sr_sub_rwlock(sr_rwlock_t *rwlock, struct timespec *timeout_abs, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
-        sr_lock_recover_cb cb, void *cb_data, int has_mutex)
+void
+sr_event_trace_reply(sr_sub_trace_t *trace)
 {
-    sr_error_info_t *err_info = NULL;
-    int ret = 0, r, wr_urged;
+    sr_event_stats_sub_t *sub;
+    uint64_t cb_end, reply;
+    uint32_t sub_id;
 
-    assert(mode && timeout_abs && cid);
+    reply = sr_event_trace_now();
+    ATOMIC_STORE_RELAXED(trace->reply, reply);
 
-    if (!has_mutex) {
-        /* MUTEX LOCK */
-        ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+    cb_end = ATOMIC_LOAD_RELAXED(trace->cb_end);
+    sub_id = ATOMIC_LOAD_RELAXED(trace->sub_id);
+    if (!cb_end || !sub_id) {
+        /* no callback was called */
+        return;
     }
 
-    if (ret == EOWNERDEAD) {
-        /* make it consistent */
-        ret = pthread_mutex_consistent(&rwlock->mutex);
+    if (!(sub = sr_event_stats_sub(sub_id, 0, NULL))) {
+        return;
+    }
 
-        /* recover the lock */
-        sr_rwlock_recover(rwlock, func, cb, cb_data);
-        SR_CHECK_INT_RET(ret, err_info);
-    } else if (ret) {
-        SR_ERRINFO_LOCK(&err_info, func, ret);
+    ATOMIC_INC_RELAXED(sub->reply_hist[sr_stats_hist_bucket(sr_event_trace_diff(reply, cb_end),
+            SR_EVENT_STATS_HIST_COUNT)]);
+}
+
+#endif
+
+const sr_event_stats_shm_t *
+sr_event_stats_get(void)
+{
+#ifdef SR_EVENT_TRACE
+    if (pthread_once(&sr_event_stats_once, sr_event_stats_open)) {
+        return NULL;
+    }
+    return sr_event_stats_shm;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Wrapper for pthread_mutex_init().
+ *
+ * @param[in,out] lock pthread mutex to initialize.
+ * @param[in] shared Whether the mutex will be shared between processes or not.
+ * @param[in] robust Whether the mutex should support recovery after its owner dies or not.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+_sr_mutex_init(pthread_mutex_t *lock, int shared, int robust)
+{
+    sr_error_info_t *err_info = NULL;
+    pthread_mutexattr_t attr;
+    int ret;
+
+    /* check address alignment */
+    if (SR_MUTEX_ALIGN_CHECK(lock)) {
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Mutex address not aligned.");
         return err_info;
     }
 
-    if (mode == SR_LOCK_WRITE) {
-        /* WRITE lock */
-        if (rwlock->readers[0] || rwlock->writer) {
-            /* instead of waiting, try to recover the lock immediately */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
+    if (shared || robust) {
+        /* init attr */
+        if ((ret = pthread_mutexattr_init(&attr))) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread attr failed (%s).", strerror(ret));
+            return err_info;
         }
 
-        /* wait until there are no readers or another writer waiting */
-        ret = 0;
-        while (!ret && (rwlock->readers[0] || rwlock->writer)) {
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+        if (shared && (ret = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED))) {
+            pthread_mutexattr_destroy(&attr);
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Changing pthread attr failed (%s).", strerror(ret));
+            return err_info;
         }
+
+        if (robust && (ret = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST))) {
+            pthread_mutexattr_destroy(&attr);
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Changing pthread attr failed (%s).", strerror(ret));
+            return err_info;
+        }
+
+        if ((ret = pthread_mutex_init(lock, &attr))) {
+            pthread_mutexattr_destroy(&attr);
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread mutex failed (%s).", strerror(ret));
+            return err_info;
+        }
+        pthread_mutexattr_destroy(&attr);
+    } else {
+        if ((ret = pthread_mutex_init(lock, NULL))) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Initializing pthread mutex failed (%s).", strerror(ret));
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_mutex_init(pthread_mutex_t *lock, int shared)
+{
+    return _sr_mutex_init(lock, shared, shared);
+}
+
+sr_error_info_t *
+sr_mlock(pthread_mutex_t *lock, int timeout_ms, const char *func, sr_lock_recover_cb cb, void *cb_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec abs_ts;
+    int ret;
+
+#ifdef SR_LOCK_STATS
+    struct timespec start_ts;
+
+    sr_timeouttime_get(&start_ts, 0);
+#endif
+
+    assert(timeout_ms);
+
+    if (timeout_ms == -1) {
+        ret = pthread_mutex_lock(lock);
+    } else {
+        sr_timeouttime_get(&abs_ts, (uint32_t)timeout_ms);
+        ret = pthread_mutex_clocklock(lock, COMPAT_CLOCK_ID, &abs_ts);
+    }
+
+    if (ret == EOWNERDEAD) {
+        /* make consistent */
+        ret = pthread_mutex_consistent(lock);
+        SR_CHECK_INT_RET(ret, err_info);
+
+        /* recover */
+        if (cb) {
+            cb(SR_LOCK_WRITE, 0, cb_data);
+        }
+
+        SR_LOG_WRN("Recovered a lock with a dead owner (%s).", func);
+    } else if (ret) {
+        SR_ERRINFO_LOCK(&err_info, func, ret);
+        return err_info;
+    }
+
+#ifdef SR_LOCK_STATS
+    sr_lock_stats_acquired(lock, func, &start_ts, 1);
+#endif
+    return NULL;
+}
+
+void
+sr_munlock(pthread_mutex_t *lock)
+{
+    sr_error_info_t *err_info = NULL;
+    int ret;
+
+#ifdef SR_LOCK_STATS
+    sr_lock_stats_released(lock);
+#endif
+
+    ret = pthread_mutex_unlock(lock);
+    if (ret) {
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(ret));
+        sr_errinfo_free(&err_info);
+    }
+}
+
+sr_error_info_t *
+sr_rwlock_init(sr_rwlock_t *rwlock, int shared)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if ((err_info = sr_mutex_init(&rwlock->mutex, shared))) {
+        return err_info;
+    }
+    if ((err_info = sr_cond_init(&rwlock->cond, shared, shared))) {
+        pthread_mutex_destroy(&rwlock->mutex);
+        return err_info;
+    }
+
+    memset(rwlock->readers, 0, sizeof rwlock->readers);
+    ATOMIC_STORE_RELAXED(rwlock->waiters, 0);
+    ATOMIC_STORE_RELAXED(rwlock->upgr, 0);
+    ATOMIC_STORE_RELAXED(rwlock->writer, 0);
+    rwlock->mutex_read = 0;
+    ATOMIC_STORE_RELAXED(rwlock->fair_writer, 0);
+    rwlock->fair_wait_ms = 0;
+
+    return NULL;
+}
+
+void
+sr_rwlock_destroy(sr_rwlock_t *rwlock)
+{
+    pthread_mutex_destroy(&rwlock->mutex);
+    sr_cond_destroy(&rwlock->cond);
+}
+
+/**
+ * @brief Get the reader registry slot index where the search for a CID starts.
+ *
+ * CIDs are assigned sequentially so a simple modulo distributes them evenly.
+ */
+#define SR_RWLOCK_SLOT_IDX(cid) ((cid) % SR_RWLOCK_READ_LIMIT)
+
+/**
+ * @brief Find the reader registry slot of a connection or the free slot where it can be added.
+ *
+ * Open addressing with linear probing is used and freed slots are always backward-shifted
+ * (::sr_rwlock_reader_free()) so a free slot ends the search. The result may be stale if the mutex is not held.
+ *
+ * @param[in] rwlock Lock to search in.
+ * @param[in] cid Reader CID.
+ * @return Slot index, ::SR_RWLOCK_READ_LIMIT if the registry is full.
+ */
+static uint32_t
+sr_rwlock_reader_find_add(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    uint32_t i, idx;
+    uint_fast64_t slot;
+
+    idx = SR_RWLOCK_SLOT_IDX(cid);
+    for (i = 0; i < SR_RWLOCK_READ_LIMIT; ++i) {
+        slot = ATOMIC_LOAD_RELAXED(rwlock->readers[idx]);
+        if (!slot || (SR_RWLOCK_SLOT_CID(slot) == cid)) {
+            return idx;
+        }
+
+        idx = (idx + 1) % SR_RWLOCK_READ_LIMIT;
+    }
+
+    return SR_RWLOCK_READ_LIMIT;
+}
+
+/**
+ * @brief Find the reader registry slot of a connection.
+ *
+ * @param[in] rwlock Lock to search in.
+ * @param[in] cid Reader CID.
+ * @return Slot index, ::SR_RWLOCK_READ_LIMIT if not found.
+ */
+static uint32_t
+sr_rwlock_reader_find(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    uint32_t idx;
+
+    idx = sr_rwlock_reader_find_add(rwlock, cid);
+    if ((idx < SR_RWLOCK_READ_LIMIT) && !ATOMIC_LOAD_RELAXED(rwlock->readers[idx])) {
+        /* free slot */
+        idx = SR_RWLOCK_READ_LIMIT;
+    }
+
+    return idx;
+}
+
+/**
+ * @brief Atomically change the read lock count in the reader registry slot of a connection.
+ *
+ * Safe to call without holding the mutex, other threads of the connection may be changing the count concurrently.
+ *
+ * @param[in] rwlock Lock with the registry.
+ * @param[in] idx Slot index.
+ * @param[in] cid Owner CID of the slot.
+ * @param[in] inc Whether to increment or decrement the count.
+ * @return 0 on success, 1 if the slot is not owned by @p cid (anymore) or the count cannot be changed.
+ */
+static int
+sr_rwlock_reader_count_change(sr_rwlock_t *rwlock, uint32_t idx, sr_cid_t cid, int inc)
+{
+    uint_fast64_t slot;
+    int r;
+
+    if (!inc) {
+        /* all the accesses of the read critical section must complete before the read lock is seen released,
+         * pairs with the acquire fence in sr_rwlock_reader_count() */
+        ATOMIC_RELEASE_FENCE();
+    }
+
+    slot = ATOMIC_LOAD_RELAXED(rwlock->readers[idx]);
+    do {
+        if (!slot || (SR_RWLOCK_SLOT_CID(slot) != cid)) {
+            /* slot was moved or freed */
+            return 1;
+        }
+        if (inc && (SR_RWLOCK_SLOT_COUNT(slot) == SR_RWLOCK_READ_RECURSIVE_LIMIT)) {
+            return 1;
+        } else if (!inc && !SR_RWLOCK_SLOT_COUNT(slot)) {
+            return 1;
+        }
+
+        /* on failure slot is updated to the current value */
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(rwlock->readers[idx], slot, inc ? slot + 1 : slot - 1, r);
+    } while (!r);
+
+    return 0;
+}
+
+/**
+ * @brief Free a reader registry slot and move the following slots so that they are still found.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock Lock with the registry.
+ * @param[in] idx Index of the slot to free.
+ * @param[in] slot Expected value of the slot.
+ * @return 0 on success, 1 if the slot value was changed in the meantime and was not freed.
+ */
+static int
+sr_rwlock_reader_free(sr_rwlock_t *rwlock, uint32_t idx, uint_fast64_t slot)
+{
+    uint32_t i, home;
+    int r;
+
+    /* fast-path readers may be changing the count */
+    ATOMIC_COMPARE_EXCHANGE_RELAXED(rwlock->readers[idx], slot, 0, r);
+    if (!r) {
+        return 1;
+    }
+
+    i = (idx + 1) % SR_RWLOCK_READ_LIMIT;
+    while ((slot = ATOMIC_LOAD_RELAXED(rwlock->readers[i]))) {
+        home = SR_RWLOCK_SLOT_IDX(SR_RWLOCK_SLOT_CID(slot));
+
+        /* the slot must be moved if the free slot is cyclically between its home and its current index */
+        if ((idx < i) ? ((home <= idx) || (home > i)) : ((home <= idx) && (home > i))) {
+            /* while moved, the slot cannot be found by fast-path readers and they use the slow path */
+            ATOMIC_COMPARE_EXCHANGE_RELAXED(rwlock->readers[i], slot, 0, r);
+            if (!r) {
+                /* count changed, try again */
+                continue;
+            }
+            ATOMIC_STORE_RELAXED(rwlock->readers[idx], slot);
+            idx = i;
+        }
+
+        i = (i + 1) % SR_RWLOCK_READ_LIMIT;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Free all the reader registry slots reserved by connections not holding any read locks.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock Lock with the registry.
+ */
+static void
+sr_rwlock_reader_reclaim(sr_rwlock_t *rwlock)
+{
+    uint32_t i = 0;
+    uint_fast64_t slot;
+
+    while (i < SR_RWLOCK_READ_LIMIT) {
+        slot = ATOMIC_LOAD_RELAXED(rwlock->readers[i]);
+        if (slot && !SR_RWLOCK_SLOT_COUNT(slot) && !sr_rwlock_reader_free(rwlock, i, slot)) {
+            /* another slot may have been moved into the freed one, check it again */
+            continue;
+        }
+
+        ++i;
+    }
+}
+
+/**
+ * @brief Check whether there is no reader registry slot available for a connection.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock Lock to check.
+ * @param[in] cid Reader CID.
+ * @return Whether the registry is full.
+ */
+static int
+sr_rwlock_reader_full(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    if (sr_rwlock_reader_find_add(rwlock, cid) < SR_RWLOCK_READ_LIMIT) {
+        return 0;
+    }
+
+    /* free slots of connections without read locks and try again */
+    sr_rwlock_reader_reclaim(rwlock);
+    return (sr_rwlock_reader_find_add(rwlock, cid) == SR_RWLOCK_READ_LIMIT) ? 1 : 0;
+}
+
+/**
+ * @brief Get the number of read locks held (including recursive ones).
+ *
+ * @param[in] rwlock Lock to examine.
+ * @return Read lock count.
+ */
+static uint32_t
+sr_rwlock_reader_count(sr_rwlock_t *rwlock)
+{
+    uint32_t i, count = 0;
+
+    for (i = 0; i < SR_RWLOCK_READ_LIMIT; ++i) {
+        count += SR_RWLOCK_SLOT_COUNT(ATOMIC_LOAD_RELAXED(rwlock->readers[i]));
+    }
+
+    /* a writer seeing the released read locks must also see all the accesses of their critical sections,
+     * pairs with the release fence in sr_rwlock_reader_count_change() */
+    ATOMIC_ACQUIRE_FENCE();
+
+    return count;
+}
+
+int
+sr_rwlock_has_readers(sr_rwlock_t *rwlock)
+{
+    uint32_t i;
+
+    for (i = 0; i < SR_RWLOCK_READ_LIMIT; ++i) {
+        if (SR_RWLOCK_SLOT_COUNT(ATOMIC_LOAD_RELAXED(rwlock->readers[i]))) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Add a reader CID to a rwlock.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock Lock to add a reader to.
+ * @param[in] cid Owner CID.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_rwlock_reader_add(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t idx;
+
+    /* find this connection or a free slot */
+    if (sr_rwlock_reader_full(rwlock, cid)) {
+        sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Concurrent reader limit %d reached, possibly because of missing unlocks.",
+                SR_RWLOCK_READ_LIMIT);
+        goto cleanup;
+    }
+    idx = sr_rwlock_reader_find_add(rwlock, cid);
+
+    if (!ATOMIC_LOAD_RELAXED(rwlock->readers[idx])) {
+        /* first connection reader, assign owner cid, only mutex holders use free slots */
+        ATOMIC_STORE_RELAXED(rwlock->readers[idx], SR_RWLOCK_SLOT(cid, 1));
+    } else if (sr_rwlock_reader_count_change(rwlock, idx, cid, 1)) {
+        /* recursive read lock on the connection */
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Recursive reader limit %d reached, possibly because of missing"
+                " unlocks.", SR_RWLOCK_READ_RECURSIVE_LIMIT);
+        goto cleanup;
+    }
+
+cleanup:
+    return err_info;
+}
+
+/**
+ * @brief Remove a reader from a rwlock. Its registry slot is kept reserved for fast-path locking.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock Lock to remove a reader from.
+ * @param[in] cid Owner CID.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_rwlock_reader_del(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t idx;
+
+    /* find a CID match and remove a read lock */
+    idx = sr_rwlock_reader_find(rwlock, cid);
+    if ((idx == SR_RWLOCK_READ_LIMIT) || sr_rwlock_reader_count_change(rwlock, idx, cid, 0)) {
+        /* CID not found or not holding any read locks */
+        SR_ERRINFO_INT(&err_info);
+    }
+
+    return err_info;
+}
+
+/**
+ * @brief Recover a sysrepo RW lock.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock RW lock to recover.
+ * @param[in] func Lock caller function.
+ * @param[in] cb Optional callback to call for each recovered lock.
+ * @param[in] cb_data User data for @p cb.
+ */
+static void
+sr_rwlock_recover(sr_rwlock_t *rwlock, const char *func, sr_lock_recover_cb cb, void *cb_data)
+{
+    uint32_t i = 0, count;
+    uint_fast64_t slot;
+    sr_cid_t cid;
+
+    /* readers */
+    while (i < SR_RWLOCK_READ_LIMIT) {
+        slot = ATOMIC_LOAD_RELAXED(rwlock->readers[i]);
+        if (!slot || sr_conn_is_alive(SR_RWLOCK_SLOT_CID(slot))) {
+            ++i;
+            continue;
+        }
+
+        /* remove the slot of the dead reader with all its read locks, it cannot change anymore */
+        if (sr_rwlock_reader_free(rwlock, i, slot)) {
+            continue;
+        }
+
+        cid = SR_RWLOCK_SLOT_CID(slot);
+        for (count = SR_RWLOCK_SLOT_COUNT(slot); count; --count) {
+            /* recover */
+            if (cb) {
+                cb(SR_LOCK_READ, cid, cb_data);
+            }
+            SR_LOG_WRN("Recovered a read-lock of CID %" PRIu32 " (%s).", cid, func);
+        }
+
+        /* another reader may have been moved into the freed slot, check it again */
+    }
+
+    /* read-upgr */
+    if ((cid = ATOMIC_LOAD_RELAXED(rwlock->upgr))) {
+        if (!sr_conn_is_alive(cid)) {
+            ATOMIC_STORE_RELAXED(rwlock->upgr, 0);
+
+            /* recover */
+            if (cb) {
+                cb(SR_LOCK_READ_UPGR, cid, cb_data);
+            }
+            SR_LOG_WRN("Recovered a read-upgr-lock of CID %" PRIu32 " (%s).", cid, func);
+        }
+    }
+
+    /* write */
+    if ((cid = ATOMIC_LOAD_RELAXED(rwlock->writer))) {
+        if (!sr_conn_is_alive(cid)) {
+            ATOMIC_STORE_RELAXED(rwlock->writer, 0);
+
+            /* recover */
+            if (cb) {
+                cb(SR_LOCK_WRITE, cid, cb_data);
+            }
+            SR_LOG_WRN("Recovered a write-lock of CID %" PRIu32 " (%s).", cid, func);
+        }
+    }
+
+    /* waiting writer blocking readers, holds no lock */
+    if ((cid = ATOMIC_LOAD_RELAXED(rwlock->fair_writer)) && !sr_conn_is_alive(cid)) {
+        ATOMIC_STORE_RELAXED(rwlock->fair_writer, 0);
+    }
+}
+
+/**
+ * @brief Start waiting on a rwlock condition, fast-path unlocks will wake the waiter.
+ * Must be called before the wait predicate is checked for the first time.
+ *
+ * @param[in] rwlock RW lock to wait on.
+ */
+static void
+sr_rwlock_wait_start(sr_rwlock_t *rwlock)
+{
+    ATOMIC_INC_RELAXED(rwlock->waiters);
+
+    /* pairs with the fence in sr_rwlock_fast_wake() */
+    ATOMIC_THREAD_FENCE();
+}
+
+/**
+ * @brief Stop waiting on a rwlock condition.
+ *
+ * @param[in] rwlock RW lock that was waited on.
+ */
+static void
+sr_rwlock_wait_end(sr_rwlock_t *rwlock)
+{
+    ATOMIC_DEC_RELAXED(rwlock->waiters);
+}
+
+/**
+ * @brief Atomically set the read-upgr flag if not set.
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] cid Read-upgr lock owner CID.
+ * @return Whether the flag was set.
+ */
+static int
+sr_rwlock_upgr_set(sr_rwlock_t *rwlock, sr_cid_t cid)
+{
+    uint_fast32_t exp = 0;
+    int r;
+
+    ATOMIC_COMPARE_EXCHANGE_RELAXED(rwlock->upgr, exp, cid, r);
+    return r;
+}
+
+/**
+ * @brief Check whether a new read lock must wait for a WRITE lock request blocking new readers. Connections
+ * already holding a read lock are never blocked because the writer is waiting for them.
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] cid Reader CID.
+ * @param[in] nofair Whether the reader ignores the writer-fair policy.
+ * @return Whether the read lock must wait.
+ */
+static int
+sr_rwlock_read_blocked(sr_rwlock_t *rwlock, sr_cid_t cid, int nofair)
+{
+    uint32_t idx;
+
+    if (nofair || !ATOMIC_LOAD_RELAXED(rwlock->fair_writer)) {
+        return 0;
+    }
+
+    idx = sr_rwlock_reader_find(rwlock, cid);
+    if ((idx < SR_RWLOCK_READ_LIMIT) && SR_RWLOCK_SLOT_COUNT(ATOMIC_LOAD_RELAXED(rwlock->readers[idx]))) {
+        /* recursive read lock */
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether a new read lock must wait for the writer flag. Mutex must be held!
+ *
+ * A writer holding the lock keeps the mutex so a writer flag seen here always belongs to a writer still
+ * waiting for the readers. Readers ignoring the writer-fair policy may join them as long as there are any.
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] nofair Whether the reader ignores the writer-fair policy.
+ * @return Whether the read lock must wait.
+ */
+static int
+sr_rwlock_read_writer(sr_rwlock_t *rwlock, int nofair)
+{
+    if (!rwlock->writer) {
+        return 0;
+    }
+
+    return !nofair || !sr_rwlock_reader_count(rwlock);
+}
+
+/**
+ * @brief Wait until there are no readers (except for the writer itself) and no writer. With the writer-fair
+ * policy (::sr_rwlock_t.fair_wait_ms) new readers are blocked after waiting long enough.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] read_count Number of read locks held by the writer itself.
+ * @param[in] timeout_abs Absolute timeout.
+ * @param[in] cid Writer CID.
+ * @param[in,out] fair Whether the writer is blocking new readers, must be cleared by the caller.
+ * @return errno
+ */
+static int
+sr_rwlock_write_wait(sr_rwlock_t *rwlock, uint32_t read_count, struct timespec *timeout_abs, sr_cid_t cid, int *fair)
+{
+    struct timespec fair_abs;
+    uint_fast32_t exp = 0;
+    int ret = 0, r;
+
+    if (rwlock->fair_wait_ms && !*fair) {
+        sr_timeouttime_get(&fair_abs, rwlock->fair_wait_ms);
+        if (sr_time_cmp(&fair_abs, timeout_abs) < 0) {
+            while (!ret && ((sr_rwlock_reader_count(rwlock) > read_count) || rwlock->writer)) {
+                /* COND WAIT */
+                ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, &fair_abs);
+            }
+            if (ret != ETIMEDOUT) {
+                return ret;
+            }
+
+            /* waited long enough, block new readers unless another writer already does */
+            ATOMIC_COMPARE_EXCHANGE_RELAXED(rwlock->fair_writer, exp, cid, r);
+            *fair = r;
+            ret = 0;
+        }
+    }
+
+    while (!ret && ((sr_rwlock_reader_count(rwlock) > read_count) || rwlock->writer)) {
+        /* COND WAIT */
+        ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Stop blocking new readers by a writer.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] fair Whether the writer was blocking new readers.
+ * @param[in] wake Whether to wake the blocked readers.
+ */
+static void
+sr_rwlock_write_fair_end(sr_rwlock_t *rwlock, int fair, int wake)
+{
+    if (!fair) {
+        return;
+    }
+
+    ATOMIC_STORE_RELAXED(rwlock->fair_writer, 0);
+    if (wake) {
+        sr_cond_broadcast(&rwlock->cond);
+    }
+}
+
+/**
+ * @brief Set the writer flag unless a fast-path reader locked before it could see the flag.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] read_count Number of read locks held by the writer itself.
+ * @param[in] cid Writer CID.
+ * @return 0 if the flag was set and there are no other readers, non-zero if the flag was not set.
+ */
+static int
+sr_rwlock_writer_set(sr_rwlock_t *rwlock, uint32_t read_count, sr_cid_t cid)
+{
+    rwlock->writer = cid;
+
+    /* pairs with the fence in sr_rwlock_fast_lock() */
+    ATOMIC_THREAD_FENCE();
+
+    if (sr_rwlock_reader_count(rwlock) <= read_count) {
+        return 0;
+    }
+
+    /* let the readers finish without blocking any new ones and wake those that backed off */
+    rwlock->writer = 0;
+    sr_cond_broadcast(&rwlock->cond);
+    return 1;
+}
+
+/**
+ * @brief Having the writer flag set, wait for readers to unlock. Fast-path readers may have locked right before
+ * the flag was set.
+ * Mutex must be held!
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] read_count Number of read locks held by the writer itself.
+ * @param[in] timeout_abs Absolute timeout.
+ * @param[in] func Lock caller function.
+ * @param[in] cb Optional callback to call for each recovered lock.
+ * @param[in] cb_data User data for @p cb.
+ * @return errno
+ */
+static int
+sr_rwlock_wait_readers(sr_rwlock_t *rwlock, uint32_t read_count, struct timespec *timeout_abs, const char *func,
+        sr_lock_recover_cb cb, void *cb_data)
+{
+    int ret = 0;
+
+    assert(ATOMIC_LOAD_RELAXED(rwlock->writer));
+
+    sr_rwlock_wait_start(rwlock);
+    while (!ret && (sr_rwlock_reader_count(rwlock) > read_count)) {
+        /* COND WAIT */
+        ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+    }
+    sr_rwlock_wait_end(rwlock);
+
+    if (ret == ETIMEDOUT) {
+        /* the readers may have died */
+        sr_rwlock_recover(rwlock, func, cb, cb_data);
+        if (sr_rwlock_reader_count(rwlock) <= read_count) {
+            /* recovered */
+            ret = 0;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Wake all the waiters of a rwlock after a fast-path unlock, if there are any.
+ *
+ * @param[in] rwlock RW lock.
+ * @param[in] timeout_ms Timeout in ms for locking the mutex.
+ * @param[in] func Lock caller function.
+ */
+static void
+sr_rwlock_fast_wake(sr_rwlock_t *rwlock, uint32_t timeout_ms, const char *func)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+    int ret;
+
+    /* pairs with the fence in sr_rwlock_wait_start() */
+    ATOMIC_THREAD_FENCE();
+
+    if (!ATOMIC_LOAD_RELAXED(rwlock->waiters)) {
+        /* nobody to wake */
+        return;
+    }
+
+    /* MUTEX LOCK, so that the waiter cannot miss the broadcast between checking its predicate and waiting */
+    sr_timeouttime_get(&timeout_abs, timeout_ms);
+    ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
+    if (ret == EOWNERDEAD) {
+        /* make it consistent */
+        ret = pthread_mutex_consistent(&rwlock->mutex);
+        if (ret) {
+            SR_ERRINFO_INT(&err_info);
+            sr_errinfo_free(&err_info);
+        }
+
+        /* recover the lock */
+        sr_rwlock_recover(rwlock, func, NULL, NULL);
+    } else if (ret) {
+        SR_ERRINFO_LOCK(&err_info, func, ret);
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
+    /* broadcast on condition */
+    sr_cond_broadcast(&rwlock->cond);
+
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&rwlock->mutex);
+}
+
+/**
+ * @brief Try to READ or READ-UPGR lock a rwlock without locking its mutex.
+ *
+ * Possible only if there is no writer (nor read-upgr owner for READ-UPGR) and the connection has a reserved
+ * slot in the reader registry from its previous read lock.
+ *
+ * @param[in] rwlock RW lock to lock.
+ * @param[in] timeout_ms Timeout in ms for locking the mutex if the lock is not acquired and there are waiters to wake.
+ * @param[in] mode Lock mode to set.
+ * @param[in] cid Lock owner connection ID.
+ * @param[in] func Lock caller function.
+ * @param[in] nofair Whether to ignore the writer-fair policy.
+ * @return 0 if the lock was acquired, non-zero if the slow path must be used.
+ */
+static int
+sr_rwlock_fast_lock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        int nofair)
+{
+    uint32_t idx;
+
+    if (rwlock->mutex_read || ATOMIC_LOAD_RELAXED(rwlock->writer) ||
+            ((mode == SR_LOCK_READ_UPGR) && ATOMIC_LOAD_RELAXED(rwlock->upgr)) ||
+            sr_rwlock_read_blocked(rwlock, cid, nofair)) {
+        return 1;
+    }
+
+    /* add a read lock into the reserved slot */
+    idx = sr_rwlock_reader_find(rwlock, cid);
+    if ((idx == SR_RWLOCK_READ_LIMIT) || sr_rwlock_reader_count_change(rwlock, idx, cid, 1)) {
+        return 1;
+    }
+
+    /* the read lock must be visible before checking the writer flag, pairs with the fence in
+     * sr_rwlock_writer_set() and sr_rwlock_wait_start() of the writer that sets the flag before checking readers */
+    ATOMIC_THREAD_FENCE();
+
+    if (!ATOMIC_LOAD_RELAXED(rwlock->writer)) {
+        /* no access of the read critical section may be performed before the writer flag is seen cleared,
+         * pairs with the release store of the flag in sr_rwunlock() */
+        ATOMIC_ACQUIRE_FENCE();
+
+        if (mode == SR_LOCK_READ) {
+            return 0;
+        }
+
+        /* set upgradeable flag */
+        if (sr_rwlock_upgr_set(rwlock, cid)) {
+            return 0;
+        }
+    }
+
+    /* a writer or another read-upgr owner is present, back off, a waiting writer may need to be woken */
+    sr_rwunlock(rwlock, timeout_ms, SR_LOCK_READ, cid, func);
+    return 1;
+}
+
+/**
+ * @brief Try to READ unlock a rwlock without locking its mutex.
+ *
+ * @param[in] rwlock RW lock to unlock.
+ * @param[in] timeout_ms Timeout in ms for locking the mutex if there are waiters to wake.
+ * @param[in] cid Lock owner connection ID.
+ * @param[in] func Lock caller function.
+ * @return 0 if the lock was released, non-zero if the slow path must be used.
+ */
+static int
+sr_rwlock_fast_unlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_cid_t cid, const char *func)
+{
+    uint32_t idx;
+
+    if (rwlock->mutex_read) {
+        return 1;
+    }
+
+    /* remove the read lock from the slot, keep it reserved */
+    idx = sr_rwlock_reader_find(rwlock, cid);
+    if ((idx == SR_RWLOCK_READ_LIMIT) || sr_rwlock_reader_count_change(rwlock, idx, cid, 0)) {
+        /* slot is being moved */
+        return 1;
+    }
+
+    sr_rwlock_fast_wake(rwlock, timeout_ms, func);
+    return 0;
+}
+
+/**
+ * @brief Lock a rwlock, see ::sr_sub_rwlock().
+ *
+ * @param[in] nofair Whether READ and READ-UPGR locks ignore waiting writers, see ::sr_rwlock_nofair().
+ */
+static sr_error_info_t *
+_sr_sub_rwlock(sr_rwlock_t *rwlock, struct timespec *timeout_abs, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data, int has_mutex, int nofair)
+{
+    sr_error_info_t *err_info = NULL;
+    int ret = 0, r, wr_urged, fair;
+
+    assert(mode && timeout_abs && cid);
+
+    if (!has_mutex) {
+        /* MUTEX LOCK */
+        ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+    }
+
+    if (ret == EOWNERDEAD) {
+        /* make it consistent */
+        ret = pthread_mutex_consistent(&rwlock->mutex);
+
+        /* recover the lock */
+        sr_rwlock_recover(rwlock, func, cb, cb_data);
+        SR_CHECK_INT_RET(ret, err_info);
+    } else if (ret) {
+        SR_ERRINFO_LOCK(&err_info, func, ret);
+        return err_info;
+    }
+
+    if (mode == SR_LOCK_WRITE) {
+        /* WRITE lock */
+        if (sr_rwlock_has_readers(rwlock) || rwlock->writer) {
+            /* instead of waiting, try to recover the lock immediately */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        ret = 0;
+        fair = 0;
+        sr_rwlock_wait_start(rwlock);
+        do {
+            /* wait until there are no readers or another writer waiting */
+            ret = sr_rwlock_write_wait(rwlock, 0, timeout_abs, cid, &fair);
+            if (ret == ETIMEDOUT) {
+                /* recover the lock again, the owner may have died while processing */
+                sr_rwlock_recover(rwlock, func, cb, cb_data);
+                if (!sr_rwlock_has_readers(rwlock) && !rwlock->writer) {
+                    /* recovered */
+                    ret = 0;
+                }
+            }
+            if (ret) {
+                break;
+            }
+
+            /* set writer flag, wait again if a fast-path reader was faster */
+        } while (sr_rwlock_writer_set(rwlock, 0, cid));
+        sr_rwlock_wait_end(rwlock);
+        sr_rwlock_write_fair_end(rwlock, fair, ret);
+        if (ret) {
+            goto error_cond_unlock;
+        }
+
+        /* consistency checks */
+        assert(!rwlock->upgr && (rwlock->writer == cid));
+
+    } else if (mode == SR_LOCK_WRITE_URGE) {
+        /* WRITE URGE lock */
+        if (sr_rwlock_has_readers(rwlock) || rwlock->writer) {
+            /* instead of waiting, try to recover the lock immediately */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        /* wait until there are no readers or another writer waiting */
+        ret = 0;
+        wr_urged = 0;
+        sr_rwlock_wait_start(rwlock);
+        while (!ret && (sr_rwlock_has_readers(rwlock) || (rwlock->writer && !wr_urged))) {
+            if (!rwlock->writer) {
+                /* urge waiting for write lock */
+                rwlock->writer = cid;
+                wr_urged = 1;
+            }
+
+            /* COND WAIT */
+            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+        }
+        sr_rwlock_wait_end(rwlock);
+        if (ret == ETIMEDOUT) {
+            /* recover the lock again, the owner may have died while processing */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+            if (!sr_rwlock_has_readers(rwlock) && (!rwlock->writer || wr_urged)) {
+                /* recovered */
+                ret = 0;
+            }
+        }
+        if (ret) {
+            /* restore flags */
+            if (wr_urged) {
+                rwlock->writer = 0;
+            }
+            goto error_cond_unlock;
+        }
+
+        /* set writer flag (if not set before) */
+        if (!wr_urged) {
+            rwlock->writer = cid;
+        }
+        assert(rwlock->writer == cid);
+
+        /* wait for any fast-path readers that have not seen the flag */
+        if ((ret = sr_rwlock_wait_readers(rwlock, 0, timeout_abs, func, cb, cb_data))) {
+            rwlock->writer = 0;
+            sr_cond_broadcast(&rwlock->cond);
+            goto error_cond_unlock;
+        }
+
+        /* consistency checks */
+        assert(!rwlock->upgr);
+
+    } else if (mode == SR_LOCK_READ_UPGR) {
+        /* READ UPGR lock */
+        if (sr_rwlock_reader_full(rwlock, cid) || rwlock->upgr || rwlock->writer) {
+            /* max reader count, probably some crashed, try to recover first */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        ret = 0;
+        sr_rwlock_wait_start(rwlock);
+        do {
+            /* wait until there is no read-upgr lock nor a writer */
+            while (!ret && (sr_rwlock_reader_full(rwlock, cid) || rwlock->upgr || rwlock->writer ||
+                    sr_rwlock_read_blocked(rwlock, cid, nofair))) {
+                /* COND WAIT */
+                ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+            }
+            if (ret == ETIMEDOUT) {
+                /* recover the lock again, the owner may have died while processing */
+                sr_rwlock_recover(rwlock, func, cb, cb_data);
+                if (!sr_rwlock_reader_full(rwlock, cid) && !rwlock->upgr && !rwlock->writer &&
+                        !sr_rwlock_read_blocked(rwlock, cid, nofair)) {
+                    /* recovered */
+                    ret = 0;
+                }
+            }
+            if (ret) {
+                break;
+            }
+
+            /* set upgradeable flag, a fast-path reader may have set it first */
+        } while (!sr_rwlock_upgr_set(rwlock, cid));
+        sr_rwlock_wait_end(rwlock);
+        if (ret) {
+            goto error_cond_unlock;
+        }
+
+        /* add a reader */
+        if ((err_info = sr_rwlock_reader_add(rwlock, cid))) {
+            rwlock->upgr = 0;
+        }
+
+        /* MUTEX UNLOCK */
+        r = pthread_mutex_unlock(&rwlock->mutex);
+        if (r) {
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(r));
+        }
+
+    } else {
+        /* READ lock */
+        if (sr_rwlock_reader_full(rwlock, cid) || rwlock->writer) {
+            /* max reader count, probably some crashed, try to recover first */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        /* wait until there is no writer waiting for lock */
+        ret = 0;
+        sr_rwlock_wait_start(rwlock);
+        while (!ret && (sr_rwlock_reader_full(rwlock, cid) || sr_rwlock_read_writer(rwlock, nofair) ||
+                sr_rwlock_read_blocked(rwlock, cid, nofair))) {
+            /* COND WAIT */
+            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+        }
+        sr_rwlock_wait_end(rwlock);
+        if (ret == ETIMEDOUT) {
+            /* recover the lock again, the owner may have died while processing */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+            if (!sr_rwlock_reader_full(rwlock, cid) && !sr_rwlock_read_writer(rwlock, nofair) &&
+                    !sr_rwlock_read_blocked(rwlock, cid, nofair)) {
+                /* recovered */
+                ret = 0;
+            }
+        }
+        if (ret) {
+            goto error_cond_unlock;
+        }
+
+        /* add a reader */
+        err_info = sr_rwlock_reader_add(rwlock, cid);
+
+        /* MUTEX UNLOCK */
+        r = pthread_mutex_unlock(&rwlock->mutex);
+        if (r) {
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(r));
+        }
+    }
+
+    return err_info;
+
+error_cond_unlock:
+    if (!has_mutex) {
+        /* MUTEX UNLOCK */
+        pthread_mutex_unlock(&rwlock->mutex);
+    }
+
+    SR_ERRINFO_COND(&err_info, func, ret);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_sub_rwlock(sr_rwlock_t *rwlock, struct timespec *timeout_abs, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data, int has_mutex)
+{
+    return _sr_sub_rwlock(rwlock, timeout_abs, mode, cid, func, cb, cb_data, has_mutex, 0);
+}
+
+/**
+ * @brief Lock a rwlock, see ::sr_rwlock().
+ *
+ * @param[in] nofair Whether READ and READ-UPGR locks ignore waiting writers, see ::sr_rwlock_nofair().
+ */
+static sr_error_info_t *
+_sr_rwlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data, int nofair)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+
+#ifdef SR_LOCK_STATS
+    struct timespec start_ts;
+
+    sr_timeouttime_get(&start_ts, 0);
+#endif
+
+    SR_PROBE(lock__acquire__start, rwlock, (int)mode, func);
+
+    if (((mode == SR_LOCK_READ) || (mode == SR_LOCK_READ_UPGR)) &&
+            !sr_rwlock_fast_lock(rwlock, timeout_ms, mode, cid, func, nofair)) {
+        /* locked without the mutex */
+        goto cleanup;
+    }
+
+    sr_timeouttime_get(&timeout_abs, timeout_ms);
+
+    err_info = _sr_sub_rwlock(rwlock, &timeout_abs, mode, cid, func, cb, cb_data, 0, nofair);
+
+cleanup:
+    SR_PROBE(lock__acquire__done, rwlock, (int)mode, func, err_info ? (int)err_info->err[0].err_code : 0);
+#ifdef SR_LOCK_STATS
+    if (!err_info) {
+        sr_lock_stats_acquired(rwlock, func, &start_ts, 1);
+    }
+#endif
+    return err_info;
+}
+
+sr_error_info_t *
+sr_rwlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data)
+{
+    return _sr_rwlock(rwlock, timeout_ms, mode, cid, func, cb, cb_data, 0);
+}
+
+sr_error_info_t *
+sr_rwlock_nofair(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data)
+{
+    return _sr_rwlock(rwlock, timeout_ms, mode, cid, func, cb, cb_data, 1);
+}
+
+/**
+ * @brief Lock a rwlock mutex.
+ *
+ * @param[in] rwlock RW lock to lock.
+ * @param[in] timeout_ms Timeout in ms for locking.
+ * @param[in] func Name of the calling function for logging.
+ * @param[in] cb Optional callback called when recovering locks. When calling it, WRITE lock is always held.
+ * @param[in] cb_data Arbitrary user data for @p cb.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_rwlock_mutex_lock(sr_rwlock_t *rwlock, uint32_t timeout_ms, const char *func, sr_lock_recover_cb cb, void *cb_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+    int ret;
+
+    sr_timeouttime_get(&timeout_abs, timeout_ms);
+
+    /* MUTEX LOCK */
+    ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
+    if (ret == EOWNERDEAD) {
+        /* make it consistent */
+        ret = pthread_mutex_consistent(&rwlock->mutex);
+
+        /* recover the lock */
+        sr_rwlock_recover(rwlock, func, cb, cb_data);
+        SR_CHECK_INT_RET(ret, err_info);
+    } else if (ret) {
+        SR_ERRINFO_LOCK(&err_info, func, ret);
+        return err_info;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Relock a rwlock, see ::sr_rwrelock().
+ */
+static sr_error_info_t *
+_sr_rwrelock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+    int ret, wr_urged, fair;
+
+    assert(mode && cid);
+    assert(((mode != SR_LOCK_WRITE) && (mode != SR_LOCK_WRITE_URGE)) || (timeout_ms > 0));
+
+    if (mode == SR_LOCK_WRITE) {
+        /*
+         * upgrade from upgradeable read-lock to write-lock
+         */
+
+        /* MUTEX LOCK */
+        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
+            return err_info;
+        }
+
+        /* consistency checks */
+        assert(rwlock->upgr == cid);
+
+        if ((sr_rwlock_reader_count(rwlock) > 1) || rwlock->writer) {
+            /* instead of waiting, try to recover the lock immediately */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        sr_timeouttime_get(&timeout_abs, timeout_ms);
+        ret = 0;
+        fair = 0;
+        sr_rwlock_wait_start(rwlock);
+        do {
+            /* wait until there are no readers except for this one */
+            ret = sr_rwlock_write_wait(rwlock, 1, &timeout_abs, cid, &fair);
+            if (ret == ETIMEDOUT) {
+                sr_rwlock_recover(rwlock, func, cb, cb_data);
+                if ((sr_rwlock_reader_count(rwlock) == 1) && !rwlock->writer) {
+                    /* recovered */
+                    ret = 0;
+                }
+            }
+            if (ret) {
+                break;
+            }
+
+            /* set writer flag, wait again if a fast-path reader was faster */
+        } while (sr_rwlock_writer_set(rwlock, 1, cid));
+        sr_rwlock_wait_end(rwlock);
+        sr_rwlock_write_fair_end(rwlock, fair, ret);
+        if (ret) {
+            SR_ERRINFO_COND(&err_info, func, ret);
+            goto cleanup_unlock;
+        }
+
+        /* additional consistency check */
+        assert((rwlock->upgr == cid) && (sr_rwlock_reader_find(rwlock, cid) < SR_RWLOCK_READ_LIMIT));
+
+        /* update readers and flags */
+        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
+            rwlock->writer = 0;
+            goto cleanup_unlock;
+        }
+        rwlock->upgr = 0;
+
+        /* simply keep the lock */
+        return NULL;
+
+    } else if (mode == SR_LOCK_WRITE_URGE) {
+        /*
+         * upgrade from upgradeable read-lock to write-lock, urged
+         */
+
+        /* MUTEX LOCK */
+        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
+            return err_info;
+        }
+
+        /* consistency checks */
+        assert(rwlock->upgr == cid);
+
+        /* clear the flag, wanting write now */
+        rwlock->upgr = 0;
+
+        if ((sr_rwlock_reader_count(rwlock) > 1) || rwlock->writer) {
+            /* instead of waiting, try to recover the lock immediately */
+            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        }
+
+        /* wait until there are no readers except for this one */
+        sr_timeouttime_get(&timeout_abs, timeout_ms);
+        wr_urged = 0;
+        ret = 0;
+        sr_rwlock_wait_start(rwlock);
+        while (!ret && ((sr_rwlock_reader_count(rwlock) > 1) || (rwlock->writer && !wr_urged))) {
+            if (!rwlock->writer) {
+                /* waiting for write lock */
+                rwlock->writer = cid;
+                wr_urged = 1;
+            }
+
+            /* COND WAIT */
+            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
+        }
+        sr_rwlock_wait_end(rwlock);
         if (ret == ETIMEDOUT) {
-            /* recover the lock again, the owner may have died while processing */
             sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[0] && !rwlock->writer) {
+            if ((sr_rwlock_reader_count(rwlock) == 1) && (!rwlock->writer || wr_urged)) {
                 /* recovered */
                 ret = 0;
             }
         }
-        if (ret) {
-            goto error_cond_unlock;
+        if (!ret) {
+            /* set writer flag (if not set before) and wait for any fast-path readers that have not seen it */
+            if (!wr_urged) {
+                rwlock->writer = cid;
+                wr_urged = 1;
+            }
+            ret = sr_rwlock_wait_readers(rwlock, 1, &timeout_abs, func, cb, cb_data);
+        }
+        if (ret) {
+            /* restore flags */
+            if (wr_urged) {
+                rwlock->writer = 0;
+            }
+            rwlock->upgr = cid;
+            sr_cond_broadcast(&rwlock->cond);
+
+            SR_ERRINFO_COND(&err_info, func, ret);
+            goto cleanup_unlock;
+        }
+
+        /* additional consistency check */
+        assert(sr_rwlock_reader_find(rwlock, cid) < SR_RWLOCK_READ_LIMIT);
+
+        /* update readers and flags */
+        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
+            /* restore flags */
+            rwlock->writer = 0;
+            rwlock->upgr = cid;
+            goto cleanup_unlock;
+        }
+
+        /* simply keep the lock */
+        return NULL;
+    }
+
+    if (!rwlock->writer) {
+        /*
+         * downgrade from read-upgr lock to read lock
+         */
+
+        /* MUTEX LOCK */
+        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
+            return err_info;
+        }
+
+        assert(rwlock->upgr == cid);
+        rwlock->upgr = 0;
+
+        /* broadcast on condition so waiters can grab read-upgr lock */
+        sr_cond_broadcast(&rwlock->cond);
+        goto cleanup_unlock;
+    }
+
+    /*
+     * downgrade from write-lock to read-lock (optionally with upgrade capability)
+     */
+
+    /* consistency checks, fast-path readers may be holding the lock only briefly before backing off */
+    assert(!rwlock->upgr && (rwlock->writer == cid));
+
+    /* add a reader */
+    if ((err_info = sr_rwlock_reader_add(rwlock, cid))) {
+        /* keep the WRITE lock on error */
+        return err_info;
+    }
+
+    if (mode == SR_LOCK_READ_UPGR) {
+        /* we want the upgrade capability, set before the writer flag is removed so no fast-path reader can get it */
+        rwlock->upgr = cid;
+    }
+
+    /* remove writer flag, all the changes must be visible to the fast-path readers that see it cleared */
+    ATOMIC_STORE_RELEASE(rwlock->writer, 0);
+
+    /* redundant to broadcast on condition because we were holding write-lock, so something can only be
+     * waiting on the mutex, never the condition */
+
+cleanup_unlock:
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&rwlock->mutex);
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_rwrelock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
+        sr_lock_recover_cb cb, void *cb_data)
+{
+    sr_error_info_t *err_info;
+
+#ifdef SR_LOCK_STATS
+    struct timespec start_ts;
+
+    sr_timeouttime_get(&start_ts, 0);
+#endif
+
+    err_info = _sr_rwrelock(rwlock, timeout_ms, mode, cid, func, cb, cb_data);
+
+#ifdef SR_LOCK_STATS
+    if (!err_info) {
+        /* the lock is still held, only the wait time is measured */
+        sr_lock_stats_acquired(rwlock, func, &start_ts, 0);
+    }
+#endif
+    return err_info;
+}
+
+void
+sr_rwunlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_ts;
+    uint32_t reader_count;
+    int ret = 0;
+
+    assert(mode && cid);
+
+    SR_PROBE(lock__release, rwlock, (int)mode, func);
+
+#ifdef SR_LOCK_STATS
+    sr_lock_stats_released(rwlock);
+#endif
+
+    if ((mode == SR_LOCK_READ) && !sr_rwlock_fast_unlock(rwlock, timeout_ms, cid, func)) {
+        /* unlocked without the mutex */
+        return;
+    }
+
+    if ((mode == SR_LOCK_WRITE) || (mode == SR_LOCK_WRITE_URGE)) {
+        /* we are unlocking a write lock, there can be no readers except for fast-path ones backing off */
+        assert(!rwlock->upgr && (rwlock->writer == cid));
+
+        /* remove the writer flag, all the changes must be visible to the fast-path readers that see it cleared */
+        ATOMIC_STORE_RELEASE(rwlock->writer, 0);
+    } else {
+        sr_timeouttime_get(&timeout_ts, timeout_ms);
+
+        /* MUTEX LOCK */
+        ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, &timeout_ts);
+        if (ret == EOWNERDEAD) {
+            /* make it consistent */
+            ret = pthread_mutex_consistent(&rwlock->mutex);
+            if (ret) {
+                SR_ERRINFO_INT(&err_info);
+                sr_errinfo_free(&err_info);
+            }
+
+            /* recover the lock, no CB needed since when we are unlocking, the state is expected to be valid and cleared */
+            sr_rwlock_recover(rwlock, func, NULL, NULL);
+        } else if (ret) {
+            SR_ERRINFO_LOCK(&err_info, func, ret);
+            sr_errinfo_free(&err_info);
+        }
+
+        if (mode == SR_LOCK_READ_UPGR) {
+            assert(rwlock->upgr == cid);
+
+            /* remove the upgradeable flag */
+            rwlock->upgr = 0;
+        }
+
+        /* remove this reader */
+        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
+            sr_errinfo_free(&err_info);
+        }
+    }
+
+    if (ret) {
+        /* lock not held, cannot broadcast nor unlock it */
+        return;
+    }
+
+    /* write-unlock/last read-unlock, last read-unlock with read-upgr lock waiting for an upgrade,
+     * writer waiting, or upgradeable read-unlock (there may be another upgr-read-lock waiting) */
+    reader_count = sr_rwlock_reader_count(rwlock);
+    if ((mode == SR_LOCK_WRITE) || (mode == SR_LOCK_WRITE_URGE) || (mode == SR_LOCK_READ_UPGR) || !reader_count ||
+            ((reader_count == 1) && rwlock->upgr) || rwlock->writer) {
+        /* broadcast on condition */
+        sr_cond_broadcast(&rwlock->cond);
+    }
+
+    /* MUTEX UNLOCK */
+    ret = pthread_mutex_unlock(&rwlock->mutex);
+    if (ret) {
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(ret));
+        sr_errinfo_free(&err_info);
+    }
+}
+
+/**
+ * @brief Connection aliveness cache used by this thread.
+ */
+static _Thread_local struct sr_conn_alive_cache_s *sr_conn_alive_cache;
+
+sr_error_info_t *
+sr_conn_alive_cache_init(struct sr_conn_alive_cache_s *cache)
+{
+    memset(cache, 0, sizeof *cache);
+    return sr_mutex_init(&cache->lock, 0);
+}
+
+void
+sr_conn_alive_cache_destroy(struct sr_conn_alive_cache_s *cache)
+{
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->cids);
+    memset(cache, 0, sizeof *cache);
+}
+
+void
+sr_conn_alive_cache_use(struct sr_conn_alive_cache_s *cache)
+{
+    sr_conn_alive_cache = cache;
+}
+
+/**
+ * @brief Find a CID in a connection aliveness cache.
+ *
+ * @param[in] cache Cache to search, its lock must be held.
+ * @param[in] cid CID to find.
+ * @param[out] idx Index of the CID or the index it should be inserted at.
+ * @return Whether the CID was found.
+ */
+static int
+sr_conn_alive_cache_find(const struct sr_conn_alive_cache_s *cache, sr_cid_t cid, uint32_t *idx)
+{
+    uint32_t lo = 0, hi = cache->count, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (cache->cids[mid].cid == cid) {
+            *idx = mid;
+            return 1;
+        } else if (cache->cids[mid].cid < cid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *idx = lo;
+    return 0;
+}
+
+/**
+ * @brief Check whether a connection is alive.
+ *
+ * @param[in] cid Connection CID.
+ * @return 0 if it is dead, non-zero if it alive.
+ */
+static int
+_sr_conn_is_alive(sr_cid_t cid)
+{
+    int alive = 0;
+    sr_error_info_t *err_info;
+
+    if ((err_info = sr_shmmain_conn_check(cid, &alive, NULL))) {
+        SR_LOG_WRN("Failed to check connection %" PRIu32 " aliveness.", cid);
+        sr_errinfo_free(&err_info);
+        /* if check fails, assume the connection is alive */
+        alive = 1;
+    }
+
+    return alive;
+}
+
+int
+sr_conn_is_alive(sr_cid_t cid)
+{
+    struct sr_conn_alive_cache_s *cache = sr_conn_alive_cache;
+    struct sr_conn_alive_cid_s *cids;
+    sr_error_info_t *err_info = NULL;
+    uint32_t idx;
+    int alive;
+
+    if (!cache) {
+        return _sr_conn_is_alive(cid);
+    }
+
+    /* CACHE LOCK */
+    if ((err_info = sr_mlock(&cache->lock, -1, __func__, NULL, NULL))) {
+        sr_errinfo_free(&err_info);
+        return _sr_conn_is_alive(cid);
+    }
+    if (sr_conn_alive_cache_find(cache, cid, &idx)) {
+        alive = cache->cids[idx].alive;
+
+        /* CACHE UNLOCK */
+        sr_munlock(&cache->lock);
+        return alive;
+    }
+
+    /* CACHE UNLOCK */
+    sr_munlock(&cache->lock);
+
+    /* the check itself is performed unlocked, another thread may check the same CID concurrently */
+    alive = _sr_conn_is_alive(cid);
+
+    /* CACHE LOCK */
+    if ((err_info = sr_mlock(&cache->lock, -1, __func__, NULL, NULL))) {
+        sr_errinfo_free(&err_info);
+        return alive;
+    }
+    if (!sr_conn_alive_cache_find(cache, cid, &idx)) {
+        /* insert the CID keeping the order */
+        cids = realloc(cache->cids, (cache->count + 1) * sizeof *cache->cids);
+        if (cids) {
+            cache->cids = cids;
+            memmove(&cache->cids[idx + 1], &cache->cids[idx], (cache->count - idx) * sizeof *cache->cids);
+            cache->cids[idx].cid = cid;
+            cache->cids[idx].alive = alive;
+            ++cache->count;
+        }
+    }
+
+    /* CACHE UNLOCK */
+    sr_munlock(&cache->lock);
+
+    return alive;
+}
+
+sr_error_info_t *
+sr_conn_ext_data_update(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    struct sr_mod_info_s mi;
+    struct lyd_node *yl_data = NULL, *new_ext_data = NULL;
+
+    /* init mod info for cleanup */
+    SR_MODINFO_INIT(mi, conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
+
+    /* manually get ietf-yang-schema-mount operational data but avoid recursive call of this function */
+    ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, "ietf-yang-schema-mount");
+    assert(ly_mod);
+    if ((err_info = sr_modinfo_add(ly_mod, NULL, 0, 1, &mi))) {
+        goto cleanup;
+    }
+    if ((err_info = sr_modinfo_consolidate(&mi, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ, 0, NULL, NULL,
+            SR_OPER_CB_TIMEOUT, 0, 0))) {
+        goto cleanup;
+    }
+
+    if (mi.data && !(mi.data->flags & LYD_DEFAULT)) {
+        /* validate them for the parent reference prefixes to be resolved */
+        if ((err_info = sr_lyd_validate_module(&mi.data, mi.data->schema->module, 0, NULL))) {
+            goto cleanup;
+        }
+
+        /* get ietf-yang-library operational data */
+        if ((err_info = sr_ly_ctx_get_yanglib_data(conn->ly_ctx, &yl_data,
+                ATOMIC_LOAD_RELAXED(SR_CONN_MAIN_SHM(conn)->content_id)))) {
+            goto cleanup;
+        }
+
+        /* merge the data into one tree */
+        if ((err_info = sr_lyd_insert_sibling(yl_data, mi.data, &new_ext_data))) {
+            goto cleanup;
+        }
+        yl_data = NULL;
+        mi.data = NULL;
+    }
+
+    /* LY EXT DATA WRITE LOCK */
+    if ((err_info = sr_rwlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+            __func__, NULL, NULL))) {
+        goto cleanup;
+    }
+
+    /* update LY ext data */
+    lyd_free_siblings(conn->ly_ext_data);
+    conn->ly_ext_data = new_ext_data;
+    new_ext_data = NULL;
+
+    /* LY EXT DATA UNLOCK */
+    sr_rwunlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+
+cleanup:
+    /* MODULES UNLOCK */
+    sr_shmmod_modinfo_unlock(&mi);
+
+    sr_modinfo_erase(&mi);
+    lyd_free_siblings(yl_data);
+    lyd_free_siblings(new_ext_data);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_conn_oper_cache_add(sr_conn_ctx_t *conn, uint32_t sub_id, const char *module_name, const char *path)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    void *mem;
+    struct sr_oper_poll_cache_s *cache;
+
+    /* CONN OPER CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+            __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* look for a cache entry in the connection for the same path */
+    for (i = 0; i < conn->oper_cache_count; ++i) {
+        if (!strcmp(conn->oper_caches[i].path, path)) {
+            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Operational poll subscription for \"%s\" on the connection"
+                    " already exists.", path);
+            goto cleanup;
+        }
+    }
+
+    /* add new cache entry */
+    mem = realloc(conn->oper_caches, (conn->oper_cache_count + 1) * sizeof *conn->oper_caches);
+    SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+    conn->oper_caches = mem;
+    cache = &conn->oper_caches[conn->oper_cache_count];
+    memset(cache, 0, sizeof *cache);
+
+    /* fill */
+    cache->sub_id = sub_id;
+    cache->module_name = strdup(module_name);
+    SR_CHECK_MEM_GOTO(!cache->module_name, err_info, cleanup);
+    cache->path = strdup(path);
+    SR_CHECK_MEM_GOTO(!cache->path, err_info, cleanup);
+    if ((err_info = sr_rwlock_init(&cache->data_lock, 0))) {
+        goto cleanup;
+    }
+
+    ++conn->oper_cache_count;
+
+cleanup:
+    /* CONN OPER CACHE UNLOCK */
+    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    return err_info;
+}
+
+void
+sr_conn_oper_cache_del(sr_conn_ctx_t *conn, uint32_t sub_id)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    struct sr_oper_poll_cache_s *cache = NULL;
+
+    /* CONN OPER CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+            __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+    }
+
+    /* find the cache entry */
+    for (i = 0; i < conn->oper_cache_count; ++i) {
+        if (conn->oper_caches[i].sub_id == sub_id) {
+            cache = &conn->oper_caches[i];
+            break;
+        }
+    }
+    assert(cache);
+
+    /* the shared data would no longer be refreshed */
+    sr_conn_oper_cache_shm_remove(cache->module_name, cache->path);
+
+    /* free members */
+    free(cache->module_name);
+    free(cache->path);
+    sr_rwlock_destroy(&cache->data_lock);
+    lyd_free_siblings(cache->data);
+    free(cache->hashes);
+
+    /* replace cache entry with the last */
+    if (i < conn->oper_cache_count - 1) {
+        memcpy(cache, &conn->oper_caches[conn->oper_cache_count - 1], sizeof *cache);
+    }
+    --conn->oper_cache_count;
+
+    if (!conn->oper_cache_count) {
+        /* no other cache entries */
+        free(conn->oper_caches);
+        conn->oper_caches = NULL;
+    }
+
+    /* CONN OPER CACHE UNLOCK */
+    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+}
+
+sr_error_info_t *
+sr_conn_oper_cache_shm_publish(sr_conn_ctx_t *conn, const char *module_name, const char *path,
+        const struct lyd_node *data, const struct timespec *timestamp, uint32_t valid_ms)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_oper_cache_shm_t hdr = {0};
+    char *shm_path = NULL, *tmp_path = NULL;
+    int fd = -1;
+
+    if ((err_info = sr_path_oper_cache_shm(module_name, path, &shm_path))) {
+        goto cleanup;
+    }
+    if (asprintf(&tmp_path, "%s.%08" PRIx32, shm_path, conn->cid) == -1) {
+        tmp_path = NULL;
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+
+    /* create a new segment */
+    fd = sr_open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, SR_SHM_PERM);
+    if (fd == -1) {
+        if (errno != EEXIST) {
+            SR_ERRINFO_SYSERRPATH(&err_info, "open", tmp_path);
+        }
+        free(tmp_path);
+        tmp_path = NULL;
+        goto cleanup;
+    }
+
+    /* write the path and the data after the header */
+    hdr.path_len = strlen(path) + 1;
+    if (pwrite(fd, path, hdr.path_len, sizeof hdr) != (ssize_t)hdr.path_len) {
+        SR_ERRINFO_SYSERRNO(&err_info, "pwrite");
+        goto cleanup;
+    }
+    if (lseek(fd, sizeof hdr + hdr.path_len, SEEK_SET) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "lseek");
+        goto cleanup;
+    }
+    if ((err_info = sr_lyd_print_data(data, LYD_LYB, 0, fd, NULL, &hdr.lyb_len))) {
+        goto cleanup;
+    }
+
+    /* write the header */
+    hdr.shm_ver = SR_SHM_VER;
+    hdr.content_id = conn->content_id;
+    hdr.timestamp = *timestamp;
+    hdr.valid_ms = valid_ms;
+    if (pwrite(fd, &hdr, sizeof hdr, 0) != (ssize_t)sizeof hdr) {
+        SR_ERRINFO_SYSERRNO(&err_info, "pwrite");
+        goto cleanup;
+    }
+
+    /* replace the previous segment */
+    if (rename(tmp_path, shm_path) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "rename");
+        goto cleanup;
+    }
+    free(tmp_path);
+    tmp_path = NULL;
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    if (tmp_path) {
+        unlink(tmp_path);
+    }
+    free(shm_path);
+    free(tmp_path);
+    return err_info;
+}
+
+void
+sr_conn_oper_cache_shm_remove(const char *module_name, const char *path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *shm_path = NULL;
+
+    if ((err_info = sr_path_oper_cache_shm(module_name, path, &shm_path))) {
+        goto cleanup;
+    }
+
+    if ((unlink(shm_path) == -1) && (errno != ENOENT)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "unlink");
+    }
+
+cleanup:
+    free(shm_path);
+    sr_errinfo_free(&err_info);
+}
+
+sr_error_info_t *
+sr_conn_oper_cache_shm_load(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, const char *path,
+        struct lyd_node **data, int *found)
+{
+    sr_error_info_t *err_info = NULL;
+    const sr_oper_cache_shm_t *hdr;
+    struct timespec cur_ts, timeout_ts;
+    char *shm_path = NULL;
+    void *addr = NULL;
+    size_t size = 0;
+    int fd = -1;
+
+    *data = NULL;
+    *found = 0;
+
+    if ((err_info = sr_path_oper_cache_shm(ly_mod->name, path, &shm_path))) {
+        goto cleanup;
+    }
+
+    fd = sr_open(shm_path, O_RDONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            SR_ERRINFO_SYSERRPATH(&err_info, "open", shm_path);
+        }
+        goto cleanup;
+    }
+
+    /* the segment is always complete because it is only ever replaced */
+    if ((err_info = sr_file_get_size(fd, &size))) {
+        goto cleanup;
+    }
+    if (size < sizeof *hdr) {
+        goto cleanup;
+    }
+    addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        SR_ERRINFO_SYSERRNO(&err_info, "mmap");
+        addr = NULL;
+        goto cleanup;
+    }
+
+    /* check that the data are of this path and context */
+    hdr = addr;
+    if ((hdr->shm_ver != SR_SHM_VER) || (hdr->content_id != conn->content_id) ||
+            (sizeof *hdr + hdr->path_len + hdr->lyb_len > size) || (hdr->path_len != strlen(path) + 1) ||
+            strcmp((char *)(hdr + 1), path)) {
+        goto cleanup;
+    }
+
+    /* check that the data are still valid */
+    sr_realtime_get(&cur_ts);
+    timeout_ts = sr_time_ts_add(&hdr->timestamp, hdr->valid_ms);
+    if (sr_time_cmp(&timeout_ts, &cur_ts) <= 0) {
+        goto cleanup;
+    }
+
+    /* parse the data */
+    if ((err_info = sr_lyd_parse_data(ly_mod->ctx, (char *)(hdr + 1) + hdr->path_len, NULL, LYD_LYB,
+            LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT, 0, data))) {
+        goto cleanup;
+    }
+    *found = 1;
+
+cleanup:
+    if (addr) {
+        munmap(addr, size);
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    free(shm_path);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_oper_slots_shm_map(const char *mod_name, int create, sr_shm_t *shm)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_oper_slots_shm_t *slots_shm;
+    uint_fast32_t shm_ver = 0;
+    char *path = NULL;
+    size_t size;
+    int r;
+
+    memset(shm, 0, sizeof *shm);
+    shm->fd = -1;
+
+    if ((err_info = sr_path_oper_slots_shm(mod_name, &path))) {
+        goto cleanup;
+    }
+
+    shm->fd = sr_open(path, create ? (O_RDWR | O_CREAT) : O_RDONLY, SR_SHM_PERM);
+    if (shm->fd == -1) {
+        if (create || (errno != ENOENT)) {
+            SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
+        }
+        goto cleanup;
+    }
+
+    /* the slots always have the same size, zeroed when created */
+    if ((err_info = sr_file_get_size(shm->fd, &size))) {
+        goto cleanup;
+    }
+    if (size < sizeof *slots_shm) {
+        if (!create) {
+            /* being created, no slots yet */
+            sr_shm_clear(shm);
+            goto cleanup;
+        }
+        if (ftruncate(shm->fd, sizeof *slots_shm) == -1) {
+            SR_ERRINFO_SYSERRNO(&err_info, "ftruncate");
+            goto cleanup;
+        }
+    }
+
+    shm->addr = mmap(NULL, sizeof *slots_shm, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (shm->addr == MAP_FAILED) {
+        SR_ERRINFO_SYSERRNO(&err_info, "mmap");
+        shm->addr = NULL;
+        goto cleanup;
+    }
+    shm->size = sizeof *slots_shm;
+
+    /* the mapping is kept without the file */
+    close(shm->fd);
+    shm->fd = -1;
+
+    /* check the version, initialize it if not yet */
+    slots_shm = (sr_oper_slots_shm_t *)shm->addr;
+    if (create) {
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(slots_shm->shm_ver, shm_ver, SR_SHM_VER, r);
+    } else {
+        shm_ver = ATOMIC_LOAD_RELAXED(slots_shm->shm_ver);
+        r = (shm_ver == SR_SHM_VER);
+    }
+    if (!r && (shm_ver != SR_SHM_VER)) {
+        if (shm_ver) {
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Operational value slots SHM \"%s\" version mismatch.", path);
+            goto cleanup;
+        }
+
+        /* not yet initialized, no slots yet */
+        sr_shm_clear(shm);
+    }
+
+cleanup:
+    if (err_info) {
+        sr_shm_clear(shm);
+    }
+    free(path);
+    return err_info;
+}
+
+void
+sr_oper_slot_write(sr_oper_slot_shm_t *slot, const char *path, const char *value, size_t value_len)
+{
+    uint_fast32_t seq;
+    int r;
+
+    /* SLOT SEQ LOCK, make the sequence number odd */
+    do {
+        seq = ATOMIC_LOAD_RELAXED(slot->seq);
+        if (seq & 1) {
+            /* another writer */
+            r = 0;
+            continue;
+        }
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(slot->seq, seq, seq + 1, r);
+    } while (!r);
+    ATOMIC_THREAD_FENCE();
+
+    if (path) {
+        strcpy(slot->path, path);
+    }
+    memcpy(slot->value, value, value_len);
+    slot->value[value_len] = '\0';
+
+    /* SLOT SEQ UNLOCK */
+    ATOMIC_THREAD_FENCE();
+    ATOMIC_STORE_RELAXED(slot->seq, seq + 2);
+}
+
+/** maximum number of spins waiting for an operational value slot writer, it may have crashed */
+#define SR_OPER_SLOT_READ_SPIN 100000
+
+/**
+ * @brief Read the path and the value of an operational value slot consistently.
+ *
+ * @param[in] slot Slot to read.
+ * @param[out] path Read path, empty if the slot is free.
+ * @param[out] value Read value.
+ * @return Whether the slot was read, its writer may never finish.
+ */
+static int
+sr_oper_slot_read(const sr_oper_slot_shm_t *slot, char *path, char *value)
+{
+    uint_fast32_t seq;
+    uint32_t spin = 0;
+
+    do {
+        /* wait for a writer to finish */
+        while ((seq = ATOMIC_LOAD_RELAXED(((sr_oper_slot_shm_t *)slot)->seq)) & 1) {
+            if (++spin == SR_OPER_SLOT_READ_SPIN) {
+                return 0;
+            }
+        }
+        ATOMIC_THREAD_FENCE();
+
+        memcpy(path, slot->path, SR_OPER_SLOT_PATH_LEN);
+        memcpy(value, slot->value, SR_OPER_SLOT_VALUE_LEN);
+
+        /* retry if written meanwhile */
+        ATOMIC_THREAD_FENCE();
+    } while (ATOMIC_LOAD_RELAXED(((sr_oper_slot_shm_t *)slot)->seq) != seq);
+
+    path[SR_OPER_SLOT_PATH_LEN - 1] = '\0';
+    value[SR_OPER_SLOT_VALUE_LEN - 1] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Learn whether a connection is alive, remembering the result for next checks.
+ *
+ * @param[in] cid CID of the connection.
+ * @param[in,out] alive Array of learned alive connections.
+ * @param[in,out] alive_count Count of @p alive.
+ * @param[in,out] dead Array of learned dead connections.
+ * @param[in,out] dead_count Count of @p dead.
+ * @param[out] is_alive Whether the connection is alive.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_oper_slot_cid_alive(sr_cid_t cid, sr_cid_t **alive, uint32_t *alive_count, sr_cid_t **dead, uint32_t *dead_count,
+        int *is_alive)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    void *mem;
+
+    for (i = 0; i < *alive_count; ++i) {
+        if ((*alive)[i] == cid) {
+            *is_alive = 1;
+            return NULL;
+        }
+    }
+    for (i = 0; i < *dead_count; ++i) {
+        if ((*dead)[i] == cid) {
+            *is_alive = 0;
+            return NULL;
+        }
+    }
+
+    /* check the connection only once */
+    *is_alive = sr_conn_is_alive(cid);
+    if (*is_alive) {
+        mem = realloc(*alive, (*alive_count + 1) * sizeof **alive);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        *alive = mem;
+        (*alive)[(*alive_count)++] = cid;
+    } else {
+        mem = realloc(*dead, (*dead_count + 1) * sizeof **dead);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        *dead = mem;
+        (*dead)[(*dead_count)++] = cid;
+    }
+    return NULL;
+}
+
+sr_error_info_t *
+sr_oper_slot_alloc(sr_oper_slots_shm_t *slots_shm, sr_cid_t cid, const char *path, const char *value,
+        size_t value_len, uint32_t *idx)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_oper_slot_shm_t *slot;
+    sr_cid_t *alive = NULL, *dead = NULL;
+    uint_fast32_t cur_cid, seq, count;
+    uint32_t alive_count = 0, dead_count = 0;
+    int is_alive, r = 0;
+
+    for (*idx = 0; *idx < SR_OPER_SLOT_COUNT; ++*idx) {
+        slot = &slots_shm->slots[*idx];
+        cur_cid = ATOMIC_LOAD_RELAXED(slot->cid);
+        if (cur_cid == cid) {
+            continue;
+        } else if (cur_cid) {
+            if ((err_info = sr_oper_slot_cid_alive(cur_cid, &alive, &alive_count, &dead, &dead_count, &is_alive))) {
+                goto cleanup;
+            }
+            if (is_alive) {
+                continue;
+            }
+        }
+
+        /* take over the slot */
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(slot->cid, cur_cid, cid, r);
+        if (r) {
+            /* pairs with the release of the slot by its previous owner */
+            ATOMIC_ACQUIRE_FENCE();
+            break;
+        }
+    }
+    if (!r) {
+        sr_errinfo_new(&err_info, SR_ERR_OPERATION_FAILED, "All the %d operational value slots are used.",
+                SR_OPER_SLOT_COUNT);
+        goto cleanup;
+    }
+
+    if ((seq = ATOMIC_LOAD_RELAXED(slot->seq)) & 1) {
+        /* the dead owner crashed while writing */
+        ATOMIC_STORE_RELAXED(slot->seq, seq + 1);
+    }
+    sr_oper_slot_write(slot, path, value, value_len);
+
+    /* the readers must check this slot */
+    count = ATOMIC_LOAD_RELAXED(slots_shm->slot_count);
+    do {
+        if (count > *idx) {
+            break;
+        }
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(slots_shm->slot_count, count, *idx + 1, r);
+    } while (!r);
+
+cleanup:
+    free(alive);
+    free(dead);
+    return err_info;
+}
+
+/**
+ * @brief Get the mapped operational value slots SHM of a module cached in a connection, map it if not yet.
+ *
+ * The mapping is valid until the context of the connection is switched.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the slots.
+ * @param[out] slots_shm Mapped slots SHM, NULL if it does not exist.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_conn_oper_slots_cache_get(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
+        const sr_oper_slots_shm_t **slots_shm)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_oper_slots_cache_s *cache;
+    sr_shm_t shm;
+    uint32_t i;
+    void *mem;
+
+    *slots_shm = NULL;
+
+    /* OPER SLOTS CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->oper_slots_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    for (i = 0; i < conn->oper_slots_cache_count; ++i) {
+        if (conn->oper_slots_cache[i].ly_mod == ly_mod) {
+            *slots_shm = (sr_oper_slots_shm_t *)conn->oper_slots_cache[i].shm.addr;
+            goto cleanup;
+        }
+    }
+
+    /* map the slots, not cached if they do not exist yet */
+    if ((err_info = sr_oper_slots_shm_map(ly_mod->name, 0, &shm)) || !shm.addr) {
+        goto cleanup;
+    }
+
+    mem = realloc(conn->oper_slots_cache, (conn->oper_slots_cache_count + 1) * sizeof *conn->oper_slots_cache);
+    if (!mem) {
+        sr_shm_clear(&shm);
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+    conn->oper_slots_cache = mem;
+    cache = &conn->oper_slots_cache[conn->oper_slots_cache_count++];
+    cache->ly_mod = ly_mod;
+    cache->shm = shm;
+    *slots_shm = (sr_oper_slots_shm_t *)shm.addr;
+
+cleanup:
+    /* OPER SLOTS CACHE UNLOCK */
+    sr_munlock(&conn->oper_slots_cache_lock);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_oper_slots_merge(sr_conn_ctx_t *conn, const sr_mod_t *shm_mod, const struct lys_module *ly_mod,
+        struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    const sr_oper_slots_shm_t *slots_shm;
+    sr_cid_t cid, *alive = NULL, *dead = NULL;
+    uint32_t i, slot_count, alive_count = 0, dead_count = 0;
+    char path[SR_OPER_SLOT_PATH_LEN], value[SR_OPER_SLOT_VALUE_LEN];
+    int is_alive;
+
+    if (!ATOMIC_LOAD_RELAXED(((sr_mod_t *)shm_mod)->oper_slots)) {
+        /* no slots were ever added */
+        return NULL;
+    }
+
+    /* the mapping stays valid while the context is locked */
+    if ((err_info = sr_conn_oper_slots_cache_get(conn, ly_mod, &slots_shm)) || !slots_shm) {
+        /* no slots */
+        goto cleanup;
+    }
+
+    slot_count = ATOMIC_LOAD_RELAXED(((sr_oper_slots_shm_t *)slots_shm)->slot_count);
+    for (i = 0; (i < slot_count) && (i < SR_OPER_SLOT_COUNT); ++i) {
+        if (!(cid = ATOMIC_LOAD_RELAXED(((sr_oper_slots_shm_t *)slots_shm)->slots[i].cid))) {
+            continue;
+        }
+
+        /* the values of dead connections are ignored */
+        if ((err_info = sr_oper_slot_cid_alive(cid, &alive, &alive_count, &dead, &dead_count, &is_alive))) {
+            goto cleanup;
+        }
+        if (!is_alive) {
+            continue;
+        }
+
+        if (!sr_oper_slot_read(&slots_shm->slots[i], path, value) || !path[0]) {
+            /* being written for too long or just freed */
+            continue;
+        }
+
+        /* set the value, it is not validated when updated so it may be invalid */
+        if ((tmp_err = sr_val_sr2ly(ly_mod->ctx, path, value, 0, 0, data))) {
+            SR_LOG_WRN("Ignoring operational value slot \"%s\" value \"%s\".", path, value);
+            sr_errinfo_free(&tmp_err);
+            continue;
+        }
+        *data = lyd_first_sibling(*data);
+    }
+
+cleanup:
+    free(alive);
+    free(dead);
+    return err_info;
+}
+
+/**
+ * @brief Replace cached schema-mount operational data (LY ext data) of a connection.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] new_ext_data New LY ext data to use, may be NULL.
+ */
+static void
+sr_conn_ext_data_replace(sr_conn_ctx_t *conn, struct lyd_node *new_ext_data)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* expected to be called with CTX LOCK so we can access the data */
+
+    /* LY EXT DATA WRITE LOCK */
+    err_info = sr_rwlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
+            NULL, NULL);
+
+    /* replace LY ext data */
+    lyd_free_siblings(conn->ly_ext_data);
+    conn->ly_ext_data = new_ext_data;
+
+    if (!err_info) {
+        /* LY EXT DATA UNLOCK */
+        sr_rwunlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    }
+    sr_errinfo_free(&err_info);
+}
+
+struct sr_run_cache_snap_s *
+sr_conn_run_cache_snap_ref(sr_conn_ctx_t *conn)
+{
+    struct sr_run_cache_snap_s *snap = conn->run_cache_snap;
+
+    if (snap) {
+        ATOMIC_INC_RELAXED(snap->refcount);
+    }
+    return snap;
+}
+
+void
+sr_conn_run_cache_snap_unref(struct sr_run_cache_snap_s *snap)
+{
+    if (!snap) {
+        return;
+    }
+
+    if (ATOMIC_DEC_RELAXED(snap->refcount) == 1) {
+        /* last reference */
+        lyd_free_siblings(snap->data);
+        free(snap);
+    }
+}
+
+/**
+ * @brief Make sure the current snapshot of connection cached running data can be modified, copy it if it is shared.
+ *
+ * Conn run cache WRITE lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_conn_run_cache_snap_own(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_snap_s *snap;
+
+    if (conn->run_cache_snap && (ATOMIC_LOAD_RELAXED(conn->run_cache_snap->refcount) == 1)) {
+        /* only referenced by the cache */
+        return NULL;
+    }
+
+    /* create a new snapshot */
+    snap = calloc(1, sizeof *snap);
+    SR_CHECK_MEM_RET(!snap, err_info);
+    ATOMIC_STORE_RELAXED(snap->refcount, 1);
+
+    if (conn->run_cache_snap) {
+        /* copy the shared data, the readers keep the old snapshot */
+        if (conn->run_cache_snap->data && (err_info = sr_lyd_dup(conn->run_cache_snap->data, NULL,
+                LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 1, &snap->data))) {
+            free(snap);
+            return err_info;
+        }
+        sr_conn_run_cache_snap_unref(conn->run_cache_snap);
+    }
+    conn->run_cache_snap = snap;
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_conn_run_cache_shm_publish(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, uint32_t cache_id,
+        const struct lyd_node *mod_data, const struct lyd_node *mod_diff)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_run_cache_shm_t hdr = {0};
+    char *path = NULL, *tmp_path = NULL;
+    int fd = -1;
+
+    if ((err_info = sr_path_run_cache_shm(ly_mod->name, &path))) {
+        goto cleanup;
+    }
+    if (asprintf(&tmp_path, "%s.%08" PRIx32, path, conn->cid) == -1) {
+        tmp_path = NULL;
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+
+    /* create a new segment, the data may be being published by another thread of this connection */
+    fd = sr_open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, SR_SHM_PERM);
+    if (fd == -1) {
+        if (errno != EEXIST) {
+            SR_ERRINFO_SYSERRPATH(&err_info, "open", tmp_path);
+        }
+        free(tmp_path);
+        tmp_path = NULL;
+        goto cleanup;
+    }
+
+    /* write the data after the header */
+    if (lseek(fd, sizeof hdr, SEEK_SET) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "lseek");
+        goto cleanup;
+    }
+    if ((err_info = sr_lyd_print_data(mod_data, LYD_LYB, 0, fd, NULL, &hdr.lyb_len))) {
+        goto cleanup;
+    }
+
+    /* write the diff after the data */
+    if (mod_diff && (err_info = sr_lyd_print_data(mod_diff, LYD_LYB, 0, fd, NULL, &hdr.diff_len))) {
+        goto cleanup;
+    }
+
+    /* write the header */
+    hdr.shm_ver = SR_SHM_VER;
+    hdr.content_id = conn->content_id;
+    hdr.cache_id = cache_id;
+    if (pwrite(fd, &hdr, sizeof hdr, 0) != (ssize_t)sizeof hdr) {
+        SR_ERRINFO_SYSERRNO(&err_info, "pwrite");
+        goto cleanup;
+    }
+
+    /* replace the previous segment, connections that have it mapped keep the old one */
+    if (rename(tmp_path, path) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "rename");
+        goto cleanup;
+    }
+    free(tmp_path);
+    tmp_path = NULL;
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    if (tmp_path) {
+        unlink(tmp_path);
+    }
+    free(path);
+    free(tmp_path);
+    return err_info;
+}
+
+/**
+ * @brief Load running data of a module from its shared running cache segment.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the data.
+ * @param[in] cache_id Required cache ID of the data.
+ * @param[in] diff_only Whether only the diff from the previous cache ID is needed, if the segment includes it.
+ * @param[out] mod_data Parsed module data, NULL if @p mod_diff is set.
+ * @param[out] mod_diff Parsed module diff if @p diff_only was set and the diff available.
+ * @param[out] found Whether the segment with current data was found and @p mod_data or @p mod_diff set.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_conn_run_cache_shm_load(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, uint32_t cache_id, int diff_only,
+        struct lyd_node **mod_data, struct lyd_node **mod_diff, int *found)
+{
+    sr_error_info_t *err_info = NULL;
+    const sr_run_cache_shm_t *hdr;
+    char *path = NULL;
+    void *addr = NULL;
+    size_t size = 0;
+    int fd = -1;
+
+    *mod_data = NULL;
+    *mod_diff = NULL;
+    *found = 0;
+
+    if ((err_info = sr_path_run_cache_shm(ly_mod->name, &path))) {
+        goto cleanup;
+    }
+
+    fd = sr_open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
+        }
+        goto cleanup;
+    }
+
+    /* the segment is always complete because it is only ever replaced */
+    if ((err_info = sr_file_get_size(fd, &size))) {
+        goto cleanup;
+    }
+    if (size < sizeof *hdr) {
+        goto cleanup;
+    }
+    addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        SR_ERRINFO_SYSERRNO(&err_info, "mmap");
+        addr = NULL;
+        goto cleanup;
+    }
+
+    /* check that the data are current */
+    hdr = addr;
+    if ((hdr->shm_ver != SR_SHM_VER) || (hdr->content_id != conn->content_id) || (hdr->cache_id != cache_id) ||
+            (sizeof *hdr + hdr->lyb_len + hdr->diff_len > size)) {
+        goto cleanup;
+    }
+
+    if (diff_only && hdr->diff_len) {
+        /* parse only the diff, the rest of the segment is never read */
+        if ((err_info = sr_lyd_parse_data(ly_mod->ctx, (char *)(hdr + 1) + hdr->lyb_len, NULL, LYD_LYB,
+                LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED | LYD_PARSE_STRICT, 0, mod_diff))) {
+            goto cleanup;
+        }
+    } else {
+        /* parse the data */
+        if ((err_info = sr_lyd_parse_data(ly_mod->ctx, (char *)(hdr + 1), NULL, LYD_LYB,
+                LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED | LYD_PARSE_STRICT, 0, mod_data))) {
+            goto cleanup;
+        }
+    }
+    *found = 1;
+
+cleanup:
+    if (addr) {
+        munmap(addr, size);
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Lock loading running data of a module into its shared running cache segment so that only one connection
+ * loads them from the datastore plugin at a time, for example after a reboot, and the others wait for the segment.
+ *
+ * The lock is released when @p fd is closed, also if the process crashes.
+ *
+ * @param[in] ly_mod Module of the data.
+ * @param[out] fd Lock file descriptor.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_conn_run_cache_shm_lock(const struct lys_module *ly_mod, int *fd)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL, *lock_path = NULL;
+    int r;
+
+    *fd = -1;
+
+    if ((err_info = sr_path_run_cache_shm(ly_mod->name, &path))) {
+        goto cleanup;
+    }
+    if (asprintf(&lock_path, "%s.lock", path) == -1) {
+        lock_path = NULL;
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+
+    *fd = sr_open(lock_path, O_RDWR | O_CREAT, SR_SHM_PERM);
+    if (*fd == -1) {
+        SR_ERRINFO_SYSERRPATH(&err_info, "open", lock_path);
+        goto cleanup;
+    }
+
+    /* a BSD lock so that closing other file descriptors of the file does not release it */
+    while (((r = flock(*fd, LOCK_EX)) == -1) && (errno == EINTR)) {}
+    if (r == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "flock");
+        close(*fd);
+        *fd = -1;
+        goto cleanup;
+    }
+
+cleanup:
+    free(path);
+    free(lock_path);
+    return err_info;
+}
+
+/**
+ * @brief Free enabled data of a cached running data module, they are selected again once required.
+ * Cache WRITE lock is expected to be held.
+ *
+ * @param[in] cmod Cached module.
+ */
+static void
+sr_conn_run_cache_enabled_clear(struct sr_run_cache_s *cmod)
+{
+    lyd_free_siblings(cmod->enabled);
+    cmod->enabled = NULL;
+    cmod->enabled_id = UINT32_MAX;
+}
+
+/**
+ * @brief Free compact data of a cached running data module. Cache WRITE lock is expected to be held.
+ *
+ * @param[in] cmod Cached module.
+ */
+static void
+sr_conn_run_cache_compact_clear(struct sr_run_cache_s *cmod)
+{
+    free(cmod->compact);
+    cmod->compact = NULL;
+    cmod->compact_len = 0;
+    cmod->compact_size = 0;
+}
+
+/**
+ * @brief Evict the least recently used cached running data of modules not required by an operation until the cache
+ * fits its memory limit. Cache WRITE lock is expected to be held and the snapshot owned.
+ *
+ * With ::SR_CONN_CACHE_RUNNING_COMPACT, evicted data are first kept compact and only the compact data are evicted
+ * once they are the least recently used.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mod_info Mod info with the modules required by the operation.
+ */
+static void
+sr_conn_run_cache_evict(sr_conn_ctx_t *conn, const struct sr_mod_info_s *mod_info)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_s *cmod, *lru;
+    struct lyd_node *old_data;
+    uint64_t total = 0;
+    uint32_t i, j;
+    int compact_only = 0;
+
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        total += conn->run_cache_mods[i].size + conn->run_cache_mods[i].compact_len;
+    }
+
+    while (total > conn->mem_limit[SR_CONN_MEM_RUN_CACHE]) {
+        /* find the least recently used data, compact data only once there are no other */
+        lru = NULL;
+        for (i = 0; i < conn->run_cache_mod_count; ++i) {
+            cmod = &conn->run_cache_mods[i];
+            if ((compact_only ? !cmod->compact : !cmod->size) ||
+                    (lru && (ATOMIC_LOAD_RELAXED(cmod->last_use) >= ATOMIC_LOAD_RELAXED(lru->last_use)))) {
+                continue;
+            }
+
+            for (j = 0; j < mod_info->mod_count; ++j) {
+                if (mod_info->mods[j].ly_mod == cmod->mod) {
+                    break;
+                }
+            }
+            if (j < mod_info->mod_count) {
+                /* required by the operation */
+                continue;
+            }
+
+            lru = cmod;
+        }
+        if (!lru && !compact_only && (conn->opts & SR_CONN_CACHE_RUNNING_COMPACT)) {
+            /* evict the compact data next */
+            compact_only = 1;
+            continue;
+        } else if (!lru) {
+            /* only the required data are cached */
+            break;
+        }
+
+        if (compact_only) {
+            /* evict the compact data */
+            total -= lru->compact_len;
+            sr_conn_run_cache_compact_clear(lru);
+            ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_RUN_CACHE].evictions);
+            continue;
+        }
+
+        /* evict the data, they are parsed from the compact data or loaded again once required */
+        old_data = sr_module_data_unlink(&conn->run_cache_snap->data, lru->mod);
+        if (conn->opts & SR_CONN_CACHE_RUNNING_COMPACT) {
+            sr_conn_run_cache_compact_clear(lru);
+            if ((err_info = sr_lyd_print_data(old_data, LYD_LYB, 0, -1, &lru->compact, &lru->compact_len))) {
+                /* the data are only not kept compact */
+                sr_errinfo_free(&err_info);
+                sr_conn_run_cache_compact_clear(lru);
+            } else {
+                lru->compact_id = lru->id;
+                lru->compact_size = lru->size;
+                total += lru->compact_len;
+            }
+        }
+        lyd_free_siblings(old_data);
+        total -= lru->size;
+        lru->size = 0;
+        lru->id = UINT32_MAX;
+        free(lru->hashes);
+        lru->hashes = NULL;
+        lru->hash_count = 0;
+        sr_conn_run_cache_enabled_clear(lru);
+        ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_RUN_CACHE].evictions);
+    }
+}
+
+sr_error_info_t *
+sr_conn_run_cache_update(sr_conn_ctx_t *conn, const struct sr_mod_info_s *mod_info, sr_lock_mode_t has_lock)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    struct sr_mod_info_mod_s *mod;
+    struct sr_run_cache_s *cmod;
+    struct lyd_node *mod_data, *mod_diff, *old_data;
+    sr_datastore_t cache_ds;
+    uint32_t i, j, cur_id;
+    int found, lock_fd = -1;
+    void *mem;
+
+    assert(has_lock == SR_LOCK_READ);
+
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+
+        if (!mod->shm_mod->plugins[SR_DS_RUNNING]) {
+            /* disabled running, use startup */
+            cache_ds = SR_DS_STARTUP;
+        } else {
+            cache_ds = SR_DS_RUNNING;
+        }
+
+        /* find the cache mod */
+        cmod = NULL;
+        for (j = 0; j < conn->run_cache_mod_count; ++j) {
+            if (mod->ly_mod == conn->run_cache_mods[j].mod) {
+                cmod = &conn->run_cache_mods[j];
+                break;
+            }
+        }
+
+        if (!cmod) {
+            if (has_lock != SR_LOCK_WRITE) {
+                /* CACHE READ UNLOCK */
+                sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+                has_lock = SR_LOCK_NONE;
+
+                /* CACHE WRITE LOCK */
+                if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
+                        conn->cid, __func__, NULL, NULL))) {
+                    goto cleanup;
+                }
+                has_lock = SR_LOCK_WRITE;
+            }
+
+            /* add the module into the cache */
+            mem = realloc(conn->run_cache_mods, (conn->run_cache_mod_count + 1) * sizeof *conn->run_cache_mods);
+            SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+            conn->run_cache_mods = mem;
+
+            cmod = &conn->run_cache_mods[conn->run_cache_mod_count];
+            memset(cmod, 0, sizeof *cmod);
+            cmod->mod = mod->ly_mod;
+            cmod->id = UINT32_MAX;
+            cmod->enabled_id = UINT32_MAX;
+
+            ++conn->run_cache_mod_count;
         }
 
-        /* consistency checks */
-        assert(!rwlock->upgr && !rwlock->writer);
+        /* check whether the data are current */
+        if (mod->ds_handle[cache_ds]->plugin->data_version_cb) {
+            if ((err_info = mod->ds_handle[cache_ds]->plugin->data_version_cb(mod->ly_mod, cache_ds,
+                    mod->ds_handle[cache_ds]->plg_data, &cur_id))) {
+                goto cleanup;
+            }
+        } else {
+            cur_id = mod->shm_mod->run_cache_id;
+        }
 
-        /* set writer flag */
-        rwlock->writer = cid;
+        /* mark the data as used */
+        ATOMIC_STORE_RELAXED(cmod->last_use, ATOMIC_INC_RELAXED(conn->cache_tick) + 1);
+        if (cmod->id == cur_id) {
+            ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_RUN_CACHE].hits);
+            continue;
+        }
+        ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_RUN_CACHE].misses);
 
-    } else if (mode == SR_LOCK_WRITE_URGE) {
-        /* WRITE URGE lock */
-        if (rwlock->readers[0] || rwlock->writer) {
-            /* instead of waiting, try to recover the lock immediately */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
+        if (has_lock != SR_LOCK_WRITE) {
+            /* CACHE READ UNLOCK */
+            sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+            has_lock = SR_LOCK_NONE;
+
+            /* CACHE WRITE LOCK */
+            if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
+                    conn->cid, __func__, NULL, NULL))) {
+                goto cleanup;
+            }
+            has_lock = SR_LOCK_WRITE;
+
+            /* update cmod, there may have been modules added (realloc) but not removed */
+            cmod = &conn->run_cache_mods[j];
         }
 
-        /* wait until there are no readers or another writer waiting */
-        ret = 0;
-        wr_urged = 0;
-        while (!ret && (rwlock->readers[0] || (rwlock->writer && !wr_urged))) {
-            if (!rwlock->writer) {
-                /* urge waiting for write lock */
-                rwlock->writer = cid;
-                wr_urged = 1;
+        /* copy-on-write if the data are shared */
+        if ((err_info = sr_conn_run_cache_snap_own(conn))) {
+            goto cleanup;
+        }
+
+        mod_data = NULL;
+        mod_diff = NULL;
+        found = 0;
+        if (cmod->compact) {
+            /* parse the evicted data if still current */
+            if ((cmod->compact_id == cur_id) && (tmp_err = sr_lyd_parse_data(mod->ly_mod->ctx, cmod->compact, NULL,
+                    LYD_LYB, LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED | LYD_PARSE_STRICT, 0, &mod_data))) {
+                /* load the data from the datastore */
+                sr_errinfo_free(&tmp_err);
+            } else if (cmod->compact_id == cur_id) {
+                found = 1;
+            }
+            sr_conn_run_cache_compact_clear(cmod);
+        }
+
+        /* use the current data published by another connection if possible, only the diff of the last change
+         * if the cached data are just one change behind */
+        if (!found && (conn->opts & SR_CONN_CACHE_RUNNING_SHARED) && (tmp_err = sr_conn_run_cache_shm_load(conn,
+                mod->ly_mod, cur_id, (cmod->id != UINT32_MAX) && (cmod->id + 1 == cur_id), &mod_data, &mod_diff,
+                &found))) {
+            /* load the data from the datastore */
+            sr_errinfo_free(&tmp_err);
+        }
+
+        if (mod_diff) {
+            /* apply the diff to the cached data */
+            tmp_err = sr_lyd_diff_apply_module(&conn->run_cache_snap->data, mod_diff, mod->ly_mod, NULL);
+            lyd_free_siblings(mod_diff);
+            if (!tmp_err) {
+                /* update the cached data ID, the subtree hashes and enabled data are no longer valid */
+                cmod->id = cur_id;
+                free(cmod->hashes);
+                cmod->hashes = NULL;
+                sr_conn_run_cache_enabled_clear(cmod);
+                if (conn->mem_limit[SR_CONN_MEM_RUN_CACHE]) {
+                    cmod->size = sr_lyd_mem_size(conn->run_cache_snap->data, mod->ly_mod);
+                }
+                continue;
             }
 
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
+            /* the cached data are not as expected, reload them */
+            sr_errinfo_free(&tmp_err);
+            found = 0;
         }
-        if (ret == ETIMEDOUT) {
-            /* recover the lock again, the owner may have died while processing */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[0] && (!rwlock->writer || wr_urged)) {
-                /* recovered */
-                ret = 0;
+
+        /* remove old data */
+        old_data = sr_module_data_unlink(&conn->run_cache_snap->data, cmod->mod);
+        lyd_free_siblings(old_data);
+
+        /* replace with current data */
+        if (!found && (conn->opts & SR_CONN_CACHE_RUNNING_SHARED)) {
+            /* SHM CACHE LOAD LOCK */
+            if ((tmp_err = sr_conn_run_cache_shm_lock(mod->ly_mod, &lock_fd))) {
+                sr_errinfo_free(&tmp_err);
+            } else if ((tmp_err = sr_conn_run_cache_shm_load(conn, mod->ly_mod, cur_id, 0, &mod_data, &mod_diff,
+                    &found))) {
+                /* the data may have been published while waiting for the lock */
+                sr_errinfo_free(&tmp_err);
             }
         }
-        if (ret) {
-            /* restore flags */
-            if (wr_urged) {
-                rwlock->writer = 0;
+        if (!found) {
+            if ((err_info = mod->ds_handle[cache_ds]->plugin->load_cb(mod->ly_mod, cache_ds, NULL, 0,
+                    mod->ds_handle[cache_ds]->plg_data, &mod_data))) {
+                goto cleanup;
             }
-            goto error_cond_unlock;
+
+            /* publish the data for other connections */
+            if ((conn->opts & SR_CONN_CACHE_RUNNING_SHARED) &&
+                    (tmp_err = sr_conn_run_cache_shm_publish(conn, mod->ly_mod, cur_id, mod_data, NULL))) {
+                sr_errinfo_free(&tmp_err);
+            }
+        }
+        if (lock_fd > -1) {
+            /* SHM CACHE LOAD UNLOCK */
+            close(lock_fd);
+            lock_fd = -1;
+        }
+        cmod->size = conn->mem_limit[SR_CONN_MEM_RUN_CACHE] ? sr_lyd_mem_size(mod_data, NULL) : 0;
+        if (mod_data) {
+            lyd_insert_sibling(conn->run_cache_snap->data, mod_data, &conn->run_cache_snap->data);
+        }
+
+        /* update the cached data ID, the subtree hashes and enabled data are no longer valid */
+        cmod->id = cur_id;
+        free(cmod->hashes);
+        cmod->hashes = NULL;
+        sr_conn_run_cache_enabled_clear(cmod);
+    }
+
+    if ((has_lock == SR_LOCK_WRITE) && conn->mem_limit[SR_CONN_MEM_RUN_CACHE]) {
+        /* keep the cache within its memory limit */
+        if ((err_info = sr_conn_run_cache_snap_own(conn))) {
+            goto cleanup;
+        }
+        sr_conn_run_cache_evict(conn, mod_info);
+    }
+
+cleanup:
+    if (lock_fd > -1) {
+        /* SHM CACHE LOAD UNLOCK */
+        close(lock_fd);
+    }
+    if (has_lock == SR_LOCK_WRITE) {
+        /* CACHE READ RELOCK */
+        if ((tmp_err = sr_rwrelock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+                __func__, NULL, NULL))) {
+            sr_errinfo_merge(&err_info, tmp_err);
+        }
+    } else if (has_lock == SR_LOCK_NONE) {
+        /* CACHE READ LOCK */
+        if ((tmp_err = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+                __func__, NULL, NULL))) {
+            sr_errinfo_merge(&err_info, tmp_err);
+        }
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_conn_run_cache_update_mod(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, uint32_t mod_cache_id,
+        struct lyd_node *mod_data, struct sr_subtree_hash_s *hashes, uint32_t hash_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_s *cmod = NULL;
+    struct lyd_node *old_data;
+    uint32_t i;
+
+    /* CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
+            conn->cid, __func__, NULL, NULL))) {
+        free(hashes);
+        return err_info;
+    }
+
+    /* find the cache mod, it must have been cached for this operation, if not before */
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        if (ly_mod == conn->run_cache_mods[i].mod) {
+            cmod = &conn->run_cache_mods[i];
+            break;
+        }
+    }
+    assert(cmod);
+
+    /* the data are expected to be just modified, cannot yet be cached */
+    assert(cmod->id != mod_cache_id);
+
+    /* copy-on-write if the data are shared */
+    if ((err_info = sr_conn_run_cache_snap_own(conn))) {
+        lyd_free_siblings(mod_data);
+        free(hashes);
+        goto cleanup;
+    }
+
+    /* remove old data */
+    old_data = sr_module_data_unlink(&conn->run_cache_snap->data, cmod->mod);
+    lyd_free_siblings(old_data);
+
+    /* replace with current data */
+    cmod->size = conn->mem_limit[SR_CONN_MEM_RUN_CACHE] ? sr_lyd_mem_size(mod_data, NULL) : 0;
+    if (mod_data) {
+        lyd_insert_sibling(conn->run_cache_snap->data, mod_data, &conn->run_cache_snap->data);
+    }
+
+    /* update the cached data ID */
+    cmod->id = mod_cache_id;
+    ATOMIC_STORE_RELAXED(cmod->last_use, ATOMIC_INC_RELAXED(conn->cache_tick) + 1);
+
+    /* replace the subtree hashes, they belong to the current data */
+    free(cmod->hashes);
+    cmod->hashes = hashes;
+    cmod->hash_count = hash_count;
+    cmod->hash_id = mod_cache_id;
+
+    /* the enabled data are no longer valid */
+    sr_conn_run_cache_enabled_clear(cmod);
+
+cleanup:
+    /* CACHE WRITE UNLOCK */
+    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_conn_run_cache_hashes_get(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, struct sr_subtree_hash_s **hashes,
+        uint32_t *hash_count)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct sr_run_cache_s *cmod = NULL;
+    uint32_t i;
+
+    *hashes = NULL;
+    *hash_count = 0;
+
+    /* CACHE READ LOCK */
+    if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+            __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        if (ly_mod == conn->run_cache_mods[i].mod) {
+            cmod = &conn->run_cache_mods[i];
+            break;
+        }
+    }
+
+    if (cmod && cmod->hashes && (cmod->hash_id == cmod->id)) {
+        *hashes = malloc(cmod->hash_count * sizeof **hashes);
+        SR_CHECK_MEM_GOTO(!*hashes, err_info, cleanup);
+        memcpy(*hashes, cmod->hashes, cmod->hash_count * sizeof **hashes);
+        *hash_count = cmod->hash_count;
+    }
+
+cleanup:
+    /* CACHE READ UNLOCK */
+    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_conn_run_cache_hashes_set(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, struct sr_subtree_hash_s *hashes,
+        uint32_t hash_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_s *cmod = NULL;
+    uint32_t i;
+
+    /* CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
+            conn->cid, __func__, NULL, NULL))) {
+        free(hashes);
+        return err_info;
+    }
+
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        if (ly_mod == conn->run_cache_mods[i].mod) {
+            cmod = &conn->run_cache_mods[i];
+            break;
         }
+    }
+
+    if (cmod) {
+        free(cmod->hashes);
+        cmod->hashes = hashes;
+        cmod->hash_count = hash_count;
+        cmod->hash_id = cmod->id;
+    } else {
+        free(hashes);
+    }
+
+    /* CACHE WRITE UNLOCK */
+    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    return NULL;
+}
+
+void
+sr_conn_run_cache_flush(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    if (!(conn->opts & SR_CONN_CACHE_RUNNING)) {
+        return;
+    }
+    /* context will be destroyed, free the cache */
+
+    /* CACHE WRITE LOCK */
+    err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE, conn->cid, __func__,
+            NULL, NULL);
+
+    /* nothing else to do but continue on error */
+
+    /* release the connection cache, there can be no other references with the context being destroyed */
+    sr_conn_run_cache_snap_unref(conn->run_cache_snap);
+    conn->run_cache_snap = NULL;
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        free(conn->run_cache_mods[i].hashes);
+        lyd_free_siblings(conn->run_cache_mods[i].enabled);
+        free(conn->run_cache_mods[i].compact);
+    }
+    free(conn->run_cache_mods);
+    conn->run_cache_mods = NULL;
+    conn->run_cache_mod_count = 0;
+
+    if (!err_info) {
+        /* CACHE WRITE UNLOCK */
+        sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    }
 
-        /* consistency checks */
-        assert(!rwlock->upgr);
+    sr_errinfo_free(&err_info);
+}
 
-        /* set writer flag (if not set before) */
-        if (!wr_urged) {
-            rwlock->writer = cid;
-        }
-        assert(rwlock->writer == cid);
+/**
+ * @brief Evict the least recently used cached startup and factory-default data until the cache fits its memory limit.
+ * DS CACHE lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] keep Just cached data to evict only if they alone exceed the limit.
+ */
+static void
+sr_conn_ds_cache_evict(sr_conn_ctx_t *conn, struct sr_ds_cache_s *keep)
+{
+    struct sr_ds_cache_s *cmod, *lru;
+    uint64_t total = 0;
+    uint32_t i;
 
-    } else if (mode == SR_LOCK_READ_UPGR) {
-        /* READ UPGR lock */
-        if (rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] || rwlock->upgr || rwlock->writer) {
-            /* max reader count, probably some crashed, try to recover first */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-        }
+    for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+        total += conn->ds_cache_mods[i].size;
+    }
 
-        /* wait until there is no read-upgr lock */
-        ret = 0;
-        while (!ret && (rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] || rwlock->upgr || rwlock->writer)) {
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
-        }
-        if (ret == ETIMEDOUT) {
-            /* recover the lock again, the owner may have died while processing */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] && !rwlock->upgr && !rwlock->writer) {
-                /* recovered */
-                ret = 0;
+    while (total > conn->mem_limit[SR_CONN_MEM_DS_CACHE]) {
+        /* find the least recently used data, the just cached data last */
+        lru = NULL;
+        for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+            cmod = &conn->ds_cache_mods[i];
+            if ((cmod == keep) || !cmod->size || (lru && (cmod->last_use >= lru->last_use))) {
+                continue;
             }
+            lru = cmod;
         }
-        if (ret) {
-            goto error_cond_unlock;
+        if (!lru) {
+            /* the data alone exceed the limit */
+            lru = keep;
         }
 
-        /* set upgradeable flag */
-        rwlock->upgr = cid;
+        /* evict the data, they are loaded again once required */
+        lyd_free_siblings(lru->data);
+        lru->data = NULL;
+        lru->id = UINT32_MAX;
+        total -= lru->size;
+        lru->size = 0;
+        ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_DS_CACHE].evictions);
+    }
+}
 
-        /* add a reader */
-        err_info = sr_rwlock_reader_add(rwlock, cid);
+sr_error_info_t *
+sr_conn_ds_cache_data_append(sr_conn_ctx_t *conn, const struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
+        struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_ds_cache_s *cmod;
+    struct lyd_node *mod_data = NULL, *dup = NULL;
+    uint32_t i, cur_id;
+    int cached = 0;
+    void *mem;
 
-        /* MUTEX UNLOCK */
-        r = pthread_mutex_unlock(&rwlock->mutex);
-        if (r) {
-            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(r));
-        }
+    assert((ds == SR_DS_STARTUP) || (ds == SR_DS_FACTORY_DEFAULT));
 
-    } else {
-        /* READ lock */
-        if (rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] || rwlock->writer) {
-            /* max reader count, probably some crashed, try to recover first */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
+    /* learn the current data version */
+    if (mod->ds_handle[ds]->plugin->data_version_cb) {
+        if ((err_info = mod->ds_handle[ds]->plugin->data_version_cb(mod->ly_mod, ds, mod->ds_handle[ds]->plg_data,
+                &cur_id))) {
+            return err_info;
         }
+    } else {
+        cur_id = mod->shm_mod->ds_cache_id[ds];
+    }
 
-        /* wait until there is no writer waiting for lock */
-        ret = 0;
-        while (!ret && (rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] || rwlock->writer)) {
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, timeout_abs);
-        }
-        if (ret == ETIMEDOUT) {
-            /* recover the lock again, the owner may have died while processing */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[SR_RWLOCK_READ_LIMIT - 1] && !rwlock->writer) {
-                /* recovered */
-                ret = 0;
+    /* DS CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->ds_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* use the cached data if current */
+    for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+        cmod = &conn->ds_cache_mods[i];
+        if ((cmod->mod == mod->ly_mod) && (cmod->ds == ds) && (cmod->id == cur_id)) {
+            if ((err_info = sr_lyd_dup(cmod->data, NULL, LYD_DUP_RECURSIVE, 1, &dup))) {
+                goto cleanup_unlock;
             }
+            cmod->last_use = ATOMIC_INC_RELAXED(conn->cache_tick) + 1;
+            cached = 1;
+            break;
         }
-        if (ret) {
-            goto error_cond_unlock;
-        }
+    }
 
-        /* add a reader */
-        err_info = sr_rwlock_reader_add(rwlock, cid);
+    /* DS CACHE UNLOCK */
+    sr_munlock(&conn->ds_cache_lock);
 
-        /* MUTEX UNLOCK */
-        r = pthread_mutex_unlock(&rwlock->mutex);
-        if (r) {
-            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(r));
+    if (cached) {
+        ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_DS_CACHE].hits);
+        goto cleanup;
+    }
+    ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_DS_CACHE].misses);
+
+    /* load the data, the cache is not locked meanwhile */
+    if ((err_info = mod->ds_handle[ds]->plugin->load_cb(mod->ly_mod, ds, NULL, 0, mod->ds_handle[ds]->plg_data,
+            &mod_data))) {
+        goto cleanup;
+    }
+    if ((err_info = sr_lyd_dup(mod_data, NULL, LYD_DUP_RECURSIVE, 1, &dup))) {
+        goto cleanup;
+    }
+
+    /* DS CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->ds_cache_lock, -1, __func__, NULL, NULL))) {
+        goto cleanup;
+    }
+
+    /* find the cache mod again, it may have been added or updated meanwhile */
+    for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+        if ((conn->ds_cache_mods[i].mod == mod->ly_mod) && (conn->ds_cache_mods[i].ds == ds)) {
+            break;
         }
     }
+    if (i == conn->ds_cache_mod_count) {
+        /* add the module into the cache */
+        mem = realloc(conn->ds_cache_mods, (conn->ds_cache_mod_count + 1) * sizeof *conn->ds_cache_mods);
+        SR_CHECK_MEM_GOTO(!mem, err_info, cleanup_unlock);
+        conn->ds_cache_mods = mem;
 
-    return err_info;
+        cmod = &conn->ds_cache_mods[conn->ds_cache_mod_count];
+        cmod->mod = mod->ly_mod;
+        cmod->ds = ds;
+        cmod->data = NULL;
+        cmod->size = 0;
+        ++conn->ds_cache_mod_count;
+    } else {
+        cmod = &conn->ds_cache_mods[i];
+    }
 
-error_cond_unlock:
-    if (!has_mutex) {
-        /* MUTEX UNLOCK */
-        pthread_mutex_unlock(&rwlock->mutex);
+    /* cache the loaded data */
+    lyd_free_siblings(cmod->data);
+    cmod->data = mod_data;
+    cmod->id = cur_id;
+    cmod->size = sr_lyd_mem_size(mod_data, NULL);
+    cmod->last_use = ATOMIC_INC_RELAXED(conn->cache_tick) + 1;
+    mod_data = NULL;
+
+    if (conn->mem_limit[SR_CONN_MEM_DS_CACHE]) {
+        /* keep the cache within its memory limit */
+        sr_conn_ds_cache_evict(conn, cmod);
     }
 
-    SR_ERRINFO_COND(&err_info, func, ret);
+cleanup_unlock:
+    /* DS CACHE UNLOCK */
+    sr_munlock(&conn->ds_cache_lock);
+
+cleanup:
+    lyd_free_siblings(mod_data);
+    if (err_info) {
+        lyd_free_siblings(dup);
+    } else if (dup) {
+        lyd_insert_sibling(*data, dup, data);
+    }
     return err_info;
 }
 
-sr_error_info_t *
-sr_rwlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
-        sr_lock_recover_cb cb, void *cb_data)
+void
+sr_conn_ds_cache_flush(sr_conn_ctx_t *conn)
 {
-    struct timespec timeout_abs;
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
 
-    sr_timeouttime_get(&timeout_abs, timeout_ms);
+    if (!(conn->opts & SR_CONN_CACHE_DS)) {
+        return;
+    }
+
+    /* DS CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->ds_cache_lock, -1, __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
+    /* context will be destroyed, free the cache */
+    for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+        lyd_free_siblings(conn->ds_cache_mods[i].data);
+    }
+    free(conn->ds_cache_mods);
+    conn->ds_cache_mods = NULL;
+    conn->ds_cache_mod_count = 0;
 
-    return sr_sub_rwlock(rwlock, &timeout_abs, mode, cid, func, cb, cb_data, 0);
+    /* DS CACHE UNLOCK */
+    sr_munlock(&conn->ds_cache_lock);
 }
 
 /**
- * @brief Lock a rwlock mutex.
+ * @brief Get the estimated size of the notifications buffered by a session.
  *
- * @param[in] rwlock RW lock to lock.
- * @param[in] timeout_ms Timeout in ms for locking.
- * @param[in] func Name of the calling function for logging.
- * @param[in] cb Optional callback called when recovering locks. When calling it, WRITE lock is always held.
- * @param[in] cb_data Arbitrary user data for @p cb.
+ * @param[in] sess Session to use.
+ * @param[out] size Size of the buffered notifications.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_rwlock_mutex_lock(sr_rwlock_t *rwlock, uint32_t timeout_ms, const char *func, sr_lock_recover_cb cb, void *cb_data)
+sr_sess_notif_buf_mem_size(sr_session_ctx_t *sess, uint64_t *size)
 {
     sr_error_info_t *err_info = NULL;
-    struct timespec timeout_abs;
-    int ret;
+    struct sr_sess_notif_buf_node *node;
+    struct timespec timeout_ts;
+    int r;
 
-    sr_timeouttime_get(&timeout_abs, timeout_ms);
+    *size = 0;
 
     /* MUTEX LOCK */
-    ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
-    if (ret == EOWNERDEAD) {
-        /* make it consistent */
-        ret = pthread_mutex_consistent(&rwlock->mutex);
-
-        /* recover the lock */
-        sr_rwlock_recover(rwlock, func, cb, cb_data);
-        SR_CHECK_INT_RET(ret, err_info);
-    } else if (ret) {
-        SR_ERRINFO_LOCK(&err_info, func, ret);
+    sr_timeouttime_get(&timeout_ts, SR_NOTIF_BUF_LOCK_TIMEOUT);
+    if ((r = pthread_mutex_clocklock(&sess->notif_buf.lock.mutex, COMPAT_CLOCK_ID, &timeout_ts))) {
+        SR_ERRINFO_LOCK(&err_info, __func__, r);
         return err_info;
     }
 
+    for (node = sess->notif_buf.first; node; node = node->next) {
+        *size += sizeof *node + sr_lyd_mem_size(node->notif, NULL);
+    }
+
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&sess->notif_buf.lock.mutex);
+
     return NULL;
 }
 
 sr_error_info_t *
-sr_rwrelock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
-        sr_lock_recover_cb cb, void *cb_data)
+sr_conn_mem_usage(sr_conn_ctx_t *conn, uint64_t *mem_usage)
 {
     sr_error_info_t *err_info = NULL;
-    struct timespec timeout_abs;
-    int ret, wr_urged;
-
-    assert(mode && cid);
-    assert(((mode != SR_LOCK_WRITE) && (mode != SR_LOCK_WRITE_URGE)) || (timeout_ms > 0));
-
-    if (mode == SR_LOCK_WRITE) {
-        /*
-         * upgrade from upgradeable read-lock to write-lock
-         */
-
-        /* MUTEX LOCK */
-        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
-            return err_info;
-        }
-
-        /* consistency checks */
-        assert(rwlock->upgr == cid);
-
-        if (rwlock->readers[1] || (rwlock->read_count[0] > 1) || rwlock->writer) {
-            /* instead of waiting, try to recover the lock immediately */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-        }
-
-        /* wait until there are no readers except for this one */
-        sr_timeouttime_get(&timeout_abs, timeout_ms);
-        ret = 0;
-        while (!ret && (rwlock->readers[1] || (rwlock->read_count[0] > 1) || rwlock->writer)) {
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
-        }
-        if (ret == ETIMEDOUT) {
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[1] && (rwlock->read_count[0] == 1) && !rwlock->writer) {
-                /* recovered */
-                ret = 0;
-            }
-        }
-        if (ret) {
-            SR_ERRINFO_COND(&err_info, func, ret);
-            goto cleanup_unlock;
-        }
-
-        /* additional consistency check */
-        assert((rwlock->upgr == cid) && (rwlock->readers[0] == cid));
-
-        /* update readers and flags */
-        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
-            goto cleanup_unlock;
-        }
-        rwlock->upgr = 0;
-        rwlock->writer = cid;
+    uint64_t size;
+    uint32_t i;
 
-        /* simply keep the lock */
-        return NULL;
+#ifdef SR_HAVE_LY_PRINTED_CONTEXT
+    int ctx_size;
+#endif
 
-    } else if (mode == SR_LOCK_WRITE_URGE) {
-        /*
-         * upgrade from upgradeable read-lock to write-lock, urged
-         */
+    memset(mem_usage, 0, SR_CONN_MEM_COUNT * sizeof *mem_usage);
 
-        /* MUTEX LOCK */
-        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
+    if (conn->opts & SR_CONN_CACHE_RUNNING) {
+        /* CACHE READ LOCK */
+        if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+                __func__, NULL, NULL))) {
             return err_info;
         }
 
-        /* consistency checks */
-        assert(rwlock->upgr == cid);
-
-        /* clear the flag, wanting write now */
-        rwlock->upgr = 0;
-
-        if (rwlock->readers[1] || (rwlock->read_count[0] > 1) || rwlock->writer) {
-            /* instead of waiting, try to recover the lock immediately */
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-        }
-
-        /* wait until there are no readers except for this one */
-        sr_timeouttime_get(&timeout_abs, timeout_ms);
-        wr_urged = 0;
-        ret = 0;
-        while (!ret && (rwlock->readers[1] || (rwlock->read_count[0] > 1) || (rwlock->writer && !wr_urged))) {
-            if (!rwlock->writer) {
-                /* waiting for write lock */
-                rwlock->writer = cid;
-                wr_urged = 1;
-            }
-
-            /* COND WAIT */
-            ret = sr_cond_clockwait(&rwlock->cond, &rwlock->mutex, COMPAT_CLOCK_ID, &timeout_abs);
-        }
-        if (ret == ETIMEDOUT) {
-            sr_rwlock_recover(rwlock, func, cb, cb_data);
-            if (!rwlock->readers[1] && (rwlock->read_count[0] == 1) && (!rwlock->writer || wr_urged)) {
-                /* recovered */
-                ret = 0;
-            }
-        }
-        if (ret) {
-            /* restore flags */
-            if (wr_urged) {
-                rwlock->writer = 0;
-            }
-            rwlock->upgr = cid;
-
-            SR_ERRINFO_COND(&err_info, func, ret);
-            goto cleanup_unlock;
-        }
-
-        /* additional consistency check */
-        assert(rwlock->readers[0] == cid);
-
-        /* update readers and flags */
-        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
-            /* restore flags */
-            if (wr_urged) {
-                rwlock->writer = 0;
-            }
-            rwlock->upgr = cid;
-            goto cleanup_unlock;
+        if (conn->run_cache_snap) {
+            mem_usage[SR_CONN_MEM_RUN_CACHE] = sr_lyd_mem_size(conn->run_cache_snap->data, NULL);
         }
-        if (!wr_urged) {
-            rwlock->writer = cid;
+        for (i = 0; i < conn->run_cache_mod_count; ++i) {
+            mem_usage[SR_CONN_MEM_RUN_CACHE_COMPACT] += conn->run_cache_mods[i].compact_len;
         }
 
-        /* simply keep the lock */
-        return NULL;
+        /* CACHE READ UNLOCK */
+        sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
     }
 
-    if (!rwlock->writer) {
-        /*
-         * downgrade from read-upgr lock to read lock
-         */
-
-        /* MUTEX LOCK */
-        if ((err_info = sr_rwlock_mutex_lock(rwlock, timeout_ms, func, cb, cb_data))) {
+    if (conn->opts & SR_CONN_CACHE_DS) {
+        /* DS CACHE LOCK */
+        if ((err_info = sr_mlock(&conn->ds_cache_lock, -1, __func__, NULL, NULL))) {
             return err_info;
         }
 
-        assert(rwlock->upgr == cid);
-        rwlock->upgr = 0;
+        for (i = 0; i < conn->ds_cache_mod_count; ++i) {
+            mem_usage[SR_CONN_MEM_DS_CACHE] += conn->ds_cache_mods[i].size;
+        }
 
-        /* broadcast on condition so waiters can grab read-upgr lock */
-        sr_cond_broadcast(&rwlock->cond);
-        goto cleanup_unlock;
+        /* DS CACHE UNLOCK */
+        sr_munlock(&conn->ds_cache_lock);
     }
 
-    /*
-     * downgrade from write-lock to read-lock (optionally with upgrade capability)
-     */
+    /* CONN OPER CACHE READ LOCK */
+    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+            __func__, NULL, NULL))) {
+        return err_info;
+    }
 
-    /* consistency checks */
-    assert(!rwlock->readers[0] && !rwlock->upgr && (rwlock->writer == cid));
+    for (i = 0; i < conn->oper_cache_count; ++i) {
+        mem_usage[SR_CONN_MEM_OPER_CACHE] += conn->oper_caches[i].size;
+    }
 
-    /* add a reader */
-    if ((err_info = sr_rwlock_reader_add(rwlock, cid))) {
-        /* keep the WRITE lock on error */
+    /* CONN OPER CACHE UNLOCK */
+    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+    /* PTR LOCK */
+    if ((err_info = sr_mlock(&conn->ptr_lock, -1, __func__, NULL, NULL))) {
         return err_info;
     }
 
-    /* remove writer flag */
-    rwlock->writer = 0;
-
-    if (mode == SR_LOCK_READ_UPGR) {
-        /* we want the upgrade capability */
-        rwlock->upgr = cid;
+    for (i = 0; i < conn->session_count; ++i) {
+        if ((err_info = sr_sess_notif_buf_mem_size(conn->sessions[i], &size))) {
+            break;
+        }
+        mem_usage[SR_CONN_MEM_NOTIF_BUF] += size;
     }
 
-    /* redundant to broadcast on condition because we were holding write-lock, so something can only be
-     * waiting on the mutex, never the condition */
+    /* PTR UNLOCK */
+    sr_munlock(&conn->ptr_lock);
 
-cleanup_unlock:
-    /* MUTEX UNLOCK */
-    pthread_mutex_unlock(&rwlock->mutex);
+    if (err_info) {
+        return err_info;
+    }
 
-    return err_info;
+#ifdef SR_HAVE_LY_PRINTED_CONTEXT
+    /* the size of the printed context is close to the size of the compiled one */
+    if ((ctx_size = ly_ctx_compiled_size(conn->ly_ctx)) > 0) {
+        mem_usage[SR_CONN_MEM_CONTEXT] = ctx_size;
+    }
+#endif
+
+    return NULL;
 }
 
-void
-sr_rwunlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func)
+sr_error_info_t *
+sr_conn_run_cache_compact_saved(sr_conn_ctx_t *conn, uint64_t *saved)
 {
     sr_error_info_t *err_info = NULL;
-    struct timespec timeout_ts;
-    int ret = 0;
+    const struct sr_run_cache_s *cmod;
+    uint32_t i;
 
-    assert(mode && cid);
+    *saved = 0;
 
-    if ((mode == SR_LOCK_WRITE) || (mode == SR_LOCK_WRITE_URGE)) {
-        /* we are unlocking a write lock, there can be no readers */
-        assert(!rwlock->readers[0] && !rwlock->upgr && (rwlock->writer == cid));
+    if (!(conn->opts & SR_CONN_CACHE_RUNNING_COMPACT)) {
+        return NULL;
+    }
 
-        /* remove the writer flag */
-        rwlock->writer = 0;
-    } else {
-        sr_timeouttime_get(&timeout_ts, timeout_ms);
+    /* CACHE READ LOCK */
+    if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+            __func__, NULL, NULL))) {
+        return err_info;
+    }
 
-        /* MUTEX LOCK */
-        ret = pthread_mutex_clocklock(&rwlock->mutex, COMPAT_CLOCK_ID, &timeout_ts);
-        if (ret == EOWNERDEAD) {
-            /* make it consistent */
-            ret = pthread_mutex_consistent(&rwlock->mutex);
-            if (ret) {
-                SR_ERRINFO_INT(&err_info);
-                sr_errinfo_free(&err_info);
-            }
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        cmod = &conn->run_cache_mods[i];
+        if (cmod->compact && (cmod->compact_size > cmod->compact_len)) {
+            *saved += cmod->compact_size - cmod->compact_len;
+        }
+    }
 
-            /* recover the lock, no CB needed since when we are unlocking, the state is expected to be valid and cleared */
-            sr_rwlock_recover(rwlock, func, NULL, NULL);
-        } else if (ret) {
-            SR_ERRINFO_LOCK(&err_info, func, ret);
-            sr_errinfo_free(&err_info);
+    /* CACHE READ UNLOCK */
+    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_conn_mem_limit_set(sr_conn_ctx_t *conn, sr_conn_mem_t mem, uint64_t limit)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_s *cmod;
+    uint32_t i;
+
+    switch (mem) {
+    case SR_CONN_MEM_RUN_CACHE:
+        /* CACHE WRITE LOCK */
+        if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
+                conn->cid, __func__, NULL, NULL))) {
+            return err_info;
         }
 
-        if (mode == SR_LOCK_READ_UPGR) {
-            assert(rwlock->upgr == cid);
+        /* the sizes of the cached module data are kept only with a limit */
+        conn->mem_limit[mem] = limit;
+        for (i = 0; i < conn->run_cache_mod_count; ++i) {
+            cmod = &conn->run_cache_mods[i];
+            cmod->size = (limit && conn->run_cache_snap) ? sr_lyd_mem_size(conn->run_cache_snap->data, cmod->mod) : 0;
+        }
 
-            /* remove the upgradeable flag */
-            rwlock->upgr = 0;
+        /* CACHE WRITE UNLOCK */
+        sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+        break;
+    case SR_CONN_MEM_DS_CACHE:
+        /* DS CACHE LOCK */
+        if ((err_info = sr_mlock(&conn->ds_cache_lock, -1, __func__, NULL, NULL))) {
+            return err_info;
         }
 
-        /* remove this reader */
-        if ((err_info = sr_rwlock_reader_del(rwlock, cid))) {
-            sr_errinfo_free(&err_info);
+        conn->mem_limit[mem] = limit;
+
+        /* DS CACHE UNLOCK */
+        sr_munlock(&conn->ds_cache_lock);
+        break;
+    case SR_CONN_MEM_OPER_CACHE:
+        /* CONN OPER CACHE WRITE LOCK */
+        if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+                __func__, NULL, NULL))) {
+            return err_info;
         }
-    }
 
-    if (ret) {
-        /* lock not held, cannot broadcast nor unlock it */
-        return;
+        conn->mem_limit[mem] = limit;
+
+        /* CONN OPER CACHE UNLOCK */
+        sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+        break;
+    default:
+        SR_ERRINFO_INT(&err_info);
+        break;
     }
 
-    /* write-unlock/last read-unlock, last read-unlock with read-upgr lock waiting for an upgrade,
-     * writer waiting, or upgradeable read-unlock (there may be another upgr-read-lock waiting) */
-    if (!rwlock->readers[0] || (!rwlock->readers[1] && (rwlock->read_count[0] == 1) && rwlock->upgr) ||
-            rwlock->writer || (mode == SR_LOCK_READ_UPGR)) {
-        /* broadcast on condition */
-        sr_cond_broadcast(&rwlock->cond);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_sess_mem_usage(sr_session_ctx_t *sess, uint64_t *edit, uint64_t *notif_buf)
+{
+    uint32_t i;
+
+    if (edit) {
+        *edit = 0;
+        for (i = 0; i < SR_DS_COUNT; ++i) {
+            if (sess->dt[i].edit) {
+                *edit += sr_lyd_mem_size(sess->dt[i].edit->tree, NULL);
+            }
+        }
     }
 
-    /* MUTEX UNLOCK */
-    ret = pthread_mutex_unlock(&rwlock->mutex);
-    if (ret) {
-        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Unlocking a mutex in %s() failed (%s).", __func__, strerror(ret));
-        sr_errinfo_free(&err_info);
+    if (notif_buf) {
+        return sr_sess_notif_buf_mem_size(sess, notif_buf);
     }
+    return NULL;
 }
 
-int
-sr_conn_is_alive(sr_cid_t cid)
+/**
+ * @brief Start the next job of a load batch and remove the batch from the queue if it was its last one.
+ *
+ * Conn load lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] batch Batch with jobs not yet started.
+ * @return Index of the started job.
+ */
+static uint32_t
+sr_conn_load_job_start(sr_conn_ctx_t *conn, struct sr_load_batch_s *batch)
 {
-    int alive = 0;
-    sr_error_info_t *err_info;
+    struct sr_load_batch_s **iter;
+    uint32_t idx;
 
-    if ((err_info = sr_shmmain_conn_check(cid, &alive, NULL))) {
-        SR_LOG_WRN("Failed to check connection %" PRIu32 " aliveness.", cid);
-        sr_errinfo_free(&err_info);
-        /* if check fails, assume the connection is alive */
-        alive = 1;
+    assert(batch->next < batch->count);
+
+    idx = batch->next++;
+    if (batch->next == batch->count) {
+        /* all the jobs started, unlink the batch */
+        for (iter = &conn->load_batches; *iter != batch; iter = &(*iter)->next_batch) {}
+        *iter = batch->next_batch;
     }
 
-    return alive;
+    return idx;
 }
 
-sr_error_info_t *
-sr_conn_ext_data_update(sr_conn_ctx_t *conn)
+/**
+ * @brief Load worker thread of a connection.
+ *
+ * @param[in] arg Connection.
+ * @return Always NULL.
+ */
+static void *
+sr_conn_load_worker_thread(void *arg)
 {
     sr_error_info_t *err_info = NULL;
-    const struct lys_module *ly_mod;
-    struct sr_mod_info_s mi;
-    struct lyd_node *yl_data = NULL, *new_ext_data = NULL;
-
-    /* init mod info for cleanup */
-    SR_MODINFO_INIT(mi, conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
+    sr_conn_ctx_t *conn = arg;
+    struct sr_load_batch_s *batch;
+    uint32_t idx;
+    int r;
 
-    /* manually get ietf-yang-schema-mount operational data but avoid recursive call of this function */
-    ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, "ietf-yang-schema-mount");
-    assert(ly_mod);
-    if ((err_info = sr_modinfo_add(ly_mod, NULL, 0, 1, &mi))) {
-        goto cleanup;
-    }
-    if ((err_info = sr_modinfo_consolidate(&mi, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ, 0, NULL, NULL,
-            SR_OPER_CB_TIMEOUT, 0, 0))) {
+    /* MUTEX LOCK */
+    if ((r = pthread_mutex_lock(&conn->load_lock.mutex))) {
+        SR_ERRINFO_LOCK(&err_info, __func__, r);
         goto cleanup;
     }
 
-    if (mi.data && !(mi.data->flags & LYD_DEFAULT)) {
-        /* validate them for the parent reference prefixes to be resolved */
-        if ((err_info = sr_lyd_validate_module(&mi.data, mi.data->schema->module, 0, NULL))) {
-            goto cleanup;
+    while (conn->load_running) {
+        if (!conn->load_batches) {
+            /* COND WAIT */
+            if ((r = sr_cond_wait(&conn->load_lock.cond, &conn->load_lock.mutex))) {
+                SR_ERRINFO_COND(&err_info, __func__, r);
+                break;
+            }
+            continue;
         }
 
-        /* get ietf-yang-library operational data */
-        if ((err_info = sr_ly_ctx_get_yanglib_data(conn->ly_ctx, &yl_data, SR_CONN_MAIN_SHM(conn)->content_id))) {
-            goto cleanup;
-        }
+        /* start a job of the first batch */
+        batch = conn->load_batches;
+        idx = sr_conn_load_job_start(conn, batch);
 
-        /* merge the data into one tree */
-        if ((err_info = sr_lyd_insert_sibling(yl_data, mi.data, &new_ext_data))) {
-            goto cleanup;
+        /* MUTEX UNLOCK */
+        pthread_mutex_unlock(&conn->load_lock.mutex);
+
+        batch->err_info[idx] = batch->cb(idx, batch->cb_data);
+
+        /* MUTEX LOCK */
+        pthread_mutex_lock(&conn->load_lock.mutex);
+
+        if (++batch->done == batch->count) {
+            /* wake the waiting thread */
+            sr_cond_broadcast(&conn->load_lock.cond);
         }
-        yl_data = NULL;
-        mi.data = NULL;
     }
 
-    /* LY EXT DATA WRITE LOCK */
-    if ((err_info = sr_rwlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
-            __func__, NULL, NULL))) {
-        goto cleanup;
-    }
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&conn->load_lock.mutex);
 
-    /* update LY ext data */
-    lyd_free_siblings(conn->ly_ext_data);
-    conn->ly_ext_data = new_ext_data;
-    new_ext_data = NULL;
+cleanup:
+    sr_errinfo_free(&err_info);
+    return NULL;
+}
 
-    /* LY EXT DATA UNLOCK */
-    sr_rwunlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+/**
+ * @brief Start the load workers of a connection.
+ *
+ * Conn load lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_conn_load_workers_start(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    int r;
 
-cleanup:
-    /* MODULES UNLOCK */
-    sr_shmmod_modinfo_unlock(&mi);
+    conn->load_workers = calloc(SR_LOAD_POOL_THREADS, sizeof *conn->load_workers);
+    SR_CHECK_MEM_RET(!conn->load_workers, err_info);
+    conn->load_running = 1;
+
+    for (i = 0; i < SR_LOAD_POOL_THREADS; ++i) {
+        if ((r = pthread_create(&conn->load_workers[i], NULL, sr_conn_load_worker_thread, conn))) {
+            /* keep the started workers */
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Creating a new thread failed (%s).", strerror(r));
+            break;
+        }
+        ++conn->load_worker_count;
+    }
 
-    sr_modinfo_erase(&mi);
-    lyd_free_siblings(yl_data);
-    lyd_free_siblings(new_ext_data);
     return err_info;
 }
 
 sr_error_info_t *
-sr_conn_oper_cache_add(sr_conn_ctx_t *conn, uint32_t sub_id, const char *module_name, const char *path)
+sr_conn_load_run(sr_conn_ctx_t *conn, uint32_t count, sr_load_job_cb cb, void *cb_data)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t i;
-    void *mem;
-    struct sr_oper_poll_cache_s *cache;
+    struct sr_load_batch_s batch = {0}, **iter;
+    uint32_t i, idx;
+    int r;
 
-    /* CONN OPER CACHE WRITE LOCK */
-    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
-            __func__, NULL, NULL))) {
+    if ((count < 2) || !SR_LOAD_POOL_THREADS) {
+        /* sequential */
+        for (i = 0; i < count; ++i) {
+            sr_errinfo_merge(&err_info, cb(i, cb_data));
+        }
+        return err_info;
+    }
+
+    batch.cb = cb;
+    batch.cb_data = cb_data;
+    batch.count = count;
+    batch.err_info = calloc(count, sizeof *batch.err_info);
+    SR_CHECK_MEM_RET(!batch.err_info, err_info);
+
+    /* MUTEX LOCK */
+    if ((r = pthread_mutex_lock(&conn->load_lock.mutex))) {
+        SR_ERRINFO_LOCK(&err_info, __func__, r);
+        free(batch.err_info);
         return err_info;
     }
 
-    /* look for a cache entry in the connection for the same path */
-    for (i = 0; i < conn->oper_cache_count; ++i) {
-        if (!strcmp(conn->oper_caches[i].path, path)) {
-            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Operational poll subscription for \"%s\" on the connection"
-                    " already exists.", path);
-            goto cleanup;
+    if (!conn->load_workers) {
+        /* start the workers, the jobs are executed by this thread on failure */
+        if ((err_info = sr_conn_load_workers_start(conn))) {
+            sr_errinfo_free(&err_info);
         }
     }
 
-    /* add new cache entry */
-    mem = realloc(conn->oper_caches, (conn->oper_cache_count + 1) * sizeof *conn->oper_caches);
-    SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
-    conn->oper_caches = mem;
-    cache = &conn->oper_caches[conn->oper_cache_count];
-    memset(cache, 0, sizeof *cache);
+    /* enqueue the batch and wake the workers */
+    for (iter = &conn->load_batches; *iter; iter = &(*iter)->next_batch) {}
+    *iter = &batch;
+    sr_cond_broadcast(&conn->load_lock.cond);
 
-    /* fill */
-    cache->sub_id = sub_id;
-    cache->module_name = strdup(module_name);
-    SR_CHECK_MEM_GOTO(!cache->module_name, err_info, cleanup);
-    cache->path = strdup(path);
-    SR_CHECK_MEM_GOTO(!cache->path, err_info, cleanup);
-    if ((err_info = sr_rwlock_init(&cache->data_lock, 0))) {
-        goto cleanup;
+    /* execute the jobs of the batch too */
+    while (batch.next < batch.count) {
+        idx = sr_conn_load_job_start(conn, &batch);
+
+        /* MUTEX UNLOCK */
+        pthread_mutex_unlock(&conn->load_lock.mutex);
+
+        batch.err_info[idx] = cb(idx, cb_data);
+
+        /* MUTEX LOCK */
+        pthread_mutex_lock(&conn->load_lock.mutex);
+
+        ++batch.done;
     }
 
-    ++conn->oper_cache_count;
+    /* wait for the jobs executed by the workers */
+    while (batch.done < batch.count) {
+        /* COND WAIT */
+        sr_cond_wait(&conn->load_lock.cond, &conn->load_lock.mutex);
+    }
 
-cleanup:
-    /* CONN OPER CACHE UNLOCK */
-    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&conn->load_lock.mutex);
+
+    /* merge the errors in the job order */
+    for (i = 0; i < count; ++i) {
+        sr_errinfo_merge(&err_info, batch.err_info[i]);
+    }
+    free(batch.err_info);
     return err_info;
 }
 
 void
-sr_conn_oper_cache_del(sr_conn_ctx_t *conn, uint32_t sub_id)
+sr_conn_load_workers_stop(sr_conn_ctx_t *conn)
 {
-    sr_error_info_t *err_info = NULL;
     uint32_t i;
-    struct sr_oper_poll_cache_s *cache = NULL;
+    int r;
 
-    /* CONN OPER CACHE WRITE LOCK */
-    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
-            __func__, NULL, NULL))) {
-        /* should never happen */
-        sr_errinfo_free(&err_info);
+    if (!conn->load_workers) {
+        return;
     }
 
-    /* find the cache entry */
-    for (i = 0; i < conn->oper_cache_count; ++i) {
-        if (conn->oper_caches[i].sub_id == sub_id) {
-            cache = &conn->oper_caches[i];
-            break;
-        }
-    }
-    assert(cache);
+    /* MUTEX LOCK */
+    pthread_mutex_lock(&conn->load_lock.mutex);
 
-    /* free members */
-    free(cache->module_name);
-    free(cache->path);
-    sr_rwlock_destroy(&cache->data_lock);
-    lyd_free_siblings(cache->data);
+    conn->load_running = 0;
+    sr_cond_broadcast(&conn->load_lock.cond);
 
-    /* replace cache entry with the last */
-    if (i < conn->oper_cache_count - 1) {
-        memcpy(cache, &conn->oper_caches[conn->oper_cache_count - 1], sizeof *cache);
-    }
-    --conn->oper_cache_count;
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&conn->load_lock.mutex);
 
-    if (!conn->oper_cache_count) {
-        /* no other cache entries */
-        free(conn->oper_caches);
-        conn->oper_caches = NULL;
+    for (i = 0; i < conn->load_worker_count; ++i) {
+        if ((r = pthread_join(conn->load_workers[i], NULL))) {
+            SR_LOG_WRN("Joining the load worker thread failed (%s).", strerror(r));
+        }
     }
 
-    /* CONN OPER CACHE UNLOCK */
-    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    free(conn->load_workers);
+    conn->load_workers = NULL;
+    conn->load_worker_count = 0;
 }
 
 /**
- * @brief Replace cached schema-mount operational data (LY ext data) of a connection.
+ * @brief Flush all cached oper data of a connection.
  *
  * @param[in] conn Connection to use.
- * @param[in] new_ext_data New LY ext data to use, may be NULL.
  */
 static void
-sr_conn_ext_data_replace(sr_conn_ctx_t *conn, struct lyd_node *new_ext_data)
+sr_conn_oper_cache_flush(sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    struct sr_oper_poll_cache_s *cache;
 
-    /* expected to be called with CTX LOCK so we can access the data */
+    /* CONN OPER CACHE READ LOCK */
+    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+            __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+    }
 
-    /* LY EXT DATA WRITE LOCK */
-    err_info = sr_rwlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
-            NULL, NULL);
+    for (i = 0; i < conn->oper_cache_count; ++i) {
+        cache = &conn->oper_caches[i];
 
-    /* replace LY ext data */
-    lyd_free_siblings(conn->ly_ext_data);
-    conn->ly_ext_data = new_ext_data;
+        /* CACHE DATA WRITE LOCK */
+        if ((err_info = sr_rwlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+                __func__, NULL, NULL))) {
+            /* should never happen */
+            sr_errinfo_free(&err_info);
+        }
 
-    if (!err_info) {
-        /* LY EXT DATA UNLOCK */
-        sr_rwunlock(&conn->ly_ext_data_lock, SR_CONN_EXT_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+        /* flush data */
+        lyd_free_siblings(cache->data);
+        cache->data = NULL;
+        free(cache->hashes);
+        cache->hashes = NULL;
+        cache->hash_count = 0;
+        memset(&cache->timestamp, 0, sizeof cache->timestamp);
+
+        /* CACHE DATA UNLOCK */
+        sr_rwunlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
     }
-    sr_errinfo_free(&err_info);
+
+    /* CONN OPER CACHE UNLOCK */
+    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
 }
 
 sr_error_info_t *
-sr_conn_run_cache_update(sr_conn_ctx_t *conn, const struct sr_mod_info_s *mod_info, sr_lock_mode_t has_lock)
+sr_conn_xpath_cache_get(sr_conn_ctx_t *conn, const char *xpath, int conventional,
+        const struct lys_module ***mods, uint32_t *mod_count, int *found)
 {
-    sr_error_info_t *err_info = NULL, *tmp_err;
-    struct sr_mod_info_mod_s *mod;
-    struct sr_run_cache_s *cmod;
-    struct lyd_node *mod_data;
-    sr_datastore_t cache_ds;
-    uint32_t i, j, cur_id;
-    void *mem;
-
-    assert(has_lock == SR_LOCK_READ);
+    sr_error_info_t *err_info = NULL;
+    struct sr_xpath_cache_s entry;
+    uint32_t i;
 
-    for (i = 0; i < mod_info->mod_count; ++i) {
-        mod = &mod_info->mods[i];
+    *mods = NULL;
+    *mod_count = 0;
+    *found = 0;
 
-        if (!mod->shm_mod->plugins[SR_DS_RUNNING]) {
-            /* disabled running, use startup */
-            cache_ds = SR_DS_STARTUP;
-        } else {
-            cache_ds = SR_DS_RUNNING;
-        }
+    /* XPATH CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->xpath_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
 
-        /* find the cache mod */
-        cmod = NULL;
-        for (j = 0; j < conn->run_cache_mod_count; ++j) {
-            if (mod->ly_mod == conn->run_cache_mods[j].mod) {
-                cmod = &conn->run_cache_mods[j];
-                break;
-            }
+    for (i = 0; (i < SR_XPATH_CACHE_SIZE) && conn->xpath_cache[i].xpath; ++i) {
+        if ((conn->xpath_cache[i].conventional == conventional) && !strcmp(conn->xpath_cache[i].xpath, xpath)) {
+            break;
         }
+    }
+    if ((i == SR_XPATH_CACHE_SIZE) || !conn->xpath_cache[i].xpath) {
+        /* not cached */
+        goto cleanup;
+    }
 
-        if (!cmod) {
-            if (has_lock != SR_LOCK_WRITE) {
-                /* CACHE READ UNLOCK */
-                sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
-                has_lock = SR_LOCK_NONE;
-
-                /* CACHE WRITE LOCK */
-                if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
-                        conn->cid, __func__, NULL, NULL))) {
-                    goto cleanup;
-                }
-                has_lock = SR_LOCK_WRITE;
-            }
+    /* move the entry to the front */
+    entry = conn->xpath_cache[i];
+    memmove(&conn->xpath_cache[1], &conn->xpath_cache[0], i * sizeof entry);
+    conn->xpath_cache[0] = entry;
 
-            /* add the module into the cache */
-            mem = realloc(conn->run_cache_mods, (conn->run_cache_mod_count + 1) * sizeof *conn->run_cache_mods);
-            SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
-            conn->run_cache_mods = mem;
+    /* return a copy of the modules */
+    if (entry.mod_count) {
+        *mods = malloc(entry.mod_count * sizeof **mods);
+        SR_CHECK_MEM_GOTO(!*mods, err_info, cleanup);
+        memcpy(*mods, entry.mods, entry.mod_count * sizeof **mods);
+    }
+    *mod_count = entry.mod_count;
+    *found = 1;
 
-            cmod = &conn->run_cache_mods[conn->run_cache_mod_count];
-            cmod->mod = mod->ly_mod;
-            cmod->id = UINT32_MAX;
+cleanup:
+    /* XPATH CACHE UNLOCK */
+    sr_munlock(&conn->xpath_cache_lock);
+    return err_info;
+}
 
-            ++conn->run_cache_mod_count;
-        }
+sr_error_info_t *
+sr_conn_xpath_cache_add(sr_conn_ctx_t *conn, const char *xpath, int conventional,
+        const struct lys_module **mods, uint32_t mod_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_xpath_cache_s entry = {0};
 
-        /* check whether the data are current */
-        if (mod->ds_handle[cache_ds]->plugin->data_version_cb) {
-            if ((err_info = mod->ds_handle[cache_ds]->plugin->data_version_cb(mod->ly_mod, cache_ds,
-                    mod->ds_handle[cache_ds]->plg_data, &cur_id))) {
-                goto cleanup;
-            }
-        } else {
-            cur_id = mod->shm_mod->run_cache_id;
-        }
-        if (cmod->id == cur_id) {
-            continue;
-        }
+    /* prepare the new entry */
+    entry.xpath = strdup(xpath);
+    SR_CHECK_MEM_GOTO(!entry.xpath, err_info, cleanup);
+    entry.conventional = conventional;
+    if (mod_count) {
+        entry.mods = malloc(mod_count * sizeof *entry.mods);
+        SR_CHECK_MEM_GOTO(!entry.mods, err_info, cleanup);
+        memcpy(entry.mods, mods, mod_count * sizeof *entry.mods);
+    }
+    entry.mod_count = mod_count;
 
-        if (has_lock != SR_LOCK_WRITE) {
-            /* CACHE READ UNLOCK */
-            sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
-            has_lock = SR_LOCK_NONE;
+    /* XPATH CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->xpath_cache_lock, -1, __func__, NULL, NULL))) {
+        goto cleanup;
+    }
 
-            /* CACHE WRITE LOCK */
-            if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
-                    conn->cid, __func__, NULL, NULL))) {
-                goto cleanup;
-            }
-            has_lock = SR_LOCK_WRITE;
+    /* replace the least recently used entry and store the new one in the front */
+    free(conn->xpath_cache[SR_XPATH_CACHE_SIZE - 1].xpath);
+    free(conn->xpath_cache[SR_XPATH_CACHE_SIZE - 1].mods);
+    memmove(&conn->xpath_cache[1], &conn->xpath_cache[0], (SR_XPATH_CACHE_SIZE - 1) * sizeof entry);
+    conn->xpath_cache[0] = entry;
+    memset(&entry, 0, sizeof entry);
 
-            /* update cmod, there may have been modules added (realloc) but not removed */
-            cmod = &conn->run_cache_mods[j];
-        }
+    /* XPATH CACHE UNLOCK */
+    sr_munlock(&conn->xpath_cache_lock);
 
-        /* remove old data */
-        mod_data = sr_module_data_unlink(&conn->run_cache_data, cmod->mod);
-        lyd_free_siblings(mod_data);
+cleanup:
+    free(entry.xpath);
+    free(entry.mods);
+    return err_info;
+}
 
-        /* replace with loaded current data */
-        if ((err_info = mod->ds_handle[cache_ds]->plugin->load_cb(mod->ly_mod, cache_ds, NULL, 0,
-                mod->ds_handle[cache_ds]->plg_data, &mod_data))) {
-            goto cleanup;
-        }
-        if (mod_data) {
-            lyd_insert_sibling(conn->run_cache_data, mod_data, &conn->run_cache_data);
-        }
+void
+sr_conn_xpath_cache_flush(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
 
-        /* update the cached data ID */
-        cmod->id = cur_id;
+    /* XPATH CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->xpath_cache_lock, -1, __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+        return;
     }
 
-cleanup:
-    if (has_lock == SR_LOCK_WRITE) {
-        /* CACHE READ RELOCK */
-        if ((tmp_err = sr_rwrelock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
-                __func__, NULL, NULL))) {
-            sr_errinfo_merge(&err_info, tmp_err);
-        }
-    } else if (has_lock == SR_LOCK_NONE) {
-        /* CACHE READ LOCK */
-        if ((tmp_err = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
-                __func__, NULL, NULL))) {
-            sr_errinfo_merge(&err_info, tmp_err);
-        }
+    for (i = 0; i < SR_XPATH_CACHE_SIZE; ++i) {
+        free(conn->xpath_cache[i].xpath);
+        free(conn->xpath_cache[i].mods);
     }
-    return err_info;
+    memset(conn->xpath_cache, 0, sizeof conn->xpath_cache);
+
+    /* XPATH CACHE UNLOCK */
+    sr_munlock(&conn->xpath_cache_lock);
 }
 
 sr_error_info_t *
-sr_conn_run_cache_update_mod(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, uint32_t mod_cache_id,
-        struct lyd_node *mod_data)
+sr_conn_rpc_dep_cache_collect(sr_conn_ctx_t *conn, const char *path, int output, struct sr_mod_info_s *mod_info,
+        int *instid, int *found)
 {
     sr_error_info_t *err_info = NULL;
-    struct sr_run_cache_s *cmod = NULL;
-    struct lyd_node *old_data;
+    struct sr_rpc_dep_cache_s entry;
     uint32_t i;
 
-    /* CACHE WRITE LOCK */
-    if ((err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE,
-            conn->cid, __func__, NULL, NULL))) {
+    *instid = 0;
+    *found = 0;
+
+    /* RPC DEP CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->rpc_dep_cache_lock, -1, __func__, NULL, NULL))) {
         return err_info;
     }
 
-    /* find the cache mod, it must have been cached for this operation, if not before */
-    for (i = 0; i < conn->run_cache_mod_count; ++i) {
-        if (ly_mod == conn->run_cache_mods[i].mod) {
-            cmod = &conn->run_cache_mods[i];
+    for (i = 0; (i < SR_RPC_DEP_CACHE_SIZE) && conn->rpc_dep_cache[i].path; ++i) {
+        if ((conn->rpc_dep_cache[i].output == output) && !strcmp(conn->rpc_dep_cache[i].path, path)) {
             break;
         }
     }
-    assert(cmod);
-
-    /* the data are expected to be just modified, cannot yet be cached */
-    assert(cmod->id != mod_cache_id);
+    if ((i == SR_RPC_DEP_CACHE_SIZE) || !conn->rpc_dep_cache[i].path) {
+        /* not cached */
+        goto cleanup;
+    }
+
+    /* move the entry to the front */
+    entry = conn->rpc_dep_cache[i];
+    memmove(&conn->rpc_dep_cache[1], &conn->rpc_dep_cache[0], i * sizeof entry);
+    conn->rpc_dep_cache[0] = entry;
+
+    /* add the dependencies, the XPaths must be duplicated because the entry may be replaced */
+    for (i = 0; i < entry.dep_count; ++i) {
+        if ((err_info = sr_modinfo_add(entry.deps[i].ly_mod, entry.deps[i].xpath, 1, 0, mod_info))) {
+            goto cleanup;
+        }
+    }
+    *instid = entry.instid;
+    *found = 1;
 
-    /* remove old data */
-    old_data = sr_module_data_unlink(&conn->run_cache_data, cmod->mod);
-    lyd_free_siblings(old_data);
+cleanup:
+    /* RPC DEP CACHE UNLOCK */
+    sr_munlock(&conn->rpc_dep_cache_lock);
+    return err_info;
+}
 
-    /* replace with current data */
-    if (mod_data) {
-        lyd_insert_sibling(conn->run_cache_data, mod_data, &conn->run_cache_data);
+sr_error_info_t *
+sr_conn_rpc_dep_cache_add(sr_conn_ctx_t *conn, const char *path, int output, struct sr_rpc_dep_mod_s *deps,
+        uint32_t dep_count, int instid)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_rpc_dep_cache_s entry = {0};
+
+    /* prepare the new entry */
+    entry.deps = deps;
+    entry.dep_count = dep_count;
+    entry.path = strdup(path);
+    SR_CHECK_MEM_GOTO(!entry.path, err_info, cleanup);
+    entry.output = output;
+    entry.instid = instid;
+
+    /* RPC DEP CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->rpc_dep_cache_lock, -1, __func__, NULL, NULL))) {
+        goto cleanup;
     }
 
-    /* update the cached data ID */
-    cmod->id = mod_cache_id;
+    /* replace the least recently used entry and store the new one in the front */
+    free(conn->rpc_dep_cache[SR_RPC_DEP_CACHE_SIZE - 1].path);
+    sr_conn_rpc_dep_cache_deps_free(conn->rpc_dep_cache[SR_RPC_DEP_CACHE_SIZE - 1].deps,
+            conn->rpc_dep_cache[SR_RPC_DEP_CACHE_SIZE - 1].dep_count);
+    memmove(&conn->rpc_dep_cache[1], &conn->rpc_dep_cache[0], (SR_RPC_DEP_CACHE_SIZE - 1) * sizeof entry);
+    conn->rpc_dep_cache[0] = entry;
+    memset(&entry, 0, sizeof entry);
 
-    /* CACHE WRITE UNLOCK */
-    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    /* RPC DEP CACHE UNLOCK */
+    sr_munlock(&conn->rpc_dep_cache_lock);
 
+cleanup:
+    free(entry.path);
+    sr_conn_rpc_dep_cache_deps_free(entry.deps, entry.dep_count);
     return err_info;
 }
 
 void
-sr_conn_run_cache_flush(sr_conn_ctx_t *conn)
+sr_conn_rpc_dep_cache_deps_free(struct sr_rpc_dep_mod_s *deps, uint32_t dep_count)
+{
+    uint32_t i;
+
+    for (i = 0; i < dep_count; ++i) {
+        free(deps[i].xpath);
+    }
+    free(deps);
+}
+
+void
+sr_conn_rpc_dep_cache_flush(sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
+    uint32_t i;
 
-    if (!(conn->opts & SR_CONN_CACHE_RUNNING)) {
+    /* RPC DEP CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->rpc_dep_cache_lock, -1, __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
         return;
     }
-    /* context will be destroyed, free the cache */
 
-    /* CACHE WRITE LOCK */
-    err_info = sr_rwlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE_URGE, conn->cid, __func__,
-            NULL, NULL);
+    for (i = 0; i < SR_RPC_DEP_CACHE_SIZE; ++i) {
+        free(conn->rpc_dep_cache[i].path);
+        sr_conn_rpc_dep_cache_deps_free(conn->rpc_dep_cache[i].deps, conn->rpc_dep_cache[i].dep_count);
+    }
+    memset(conn->rpc_dep_cache, 0, sizeof conn->rpc_dep_cache);
 
-    /* nothing else to do but continue on error */
+    /* RPC DEP CACHE UNLOCK */
+    sr_munlock(&conn->rpc_dep_cache_lock);
+}
 
-    /* free the connection cache */
-    lyd_free_siblings(conn->run_cache_data);
-    conn->run_cache_data = NULL;
-    free(conn->run_cache_mods);
-    conn->run_cache_mods = NULL;
-    conn->run_cache_mod_count = 0;
+void
+sr_conn_yanglib_cache_flush(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
 
-    if (!err_info) {
-        /* CACHE WRITE UNLOCK */
-        sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    /* YANGLIB CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->yanglib_cache_lock, -1, __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+        return;
     }
 
-    sr_errinfo_free(&err_info);
+    lyd_free_siblings(conn->yanglib_cache);
+    conn->yanglib_cache = NULL;
+
+    /* YANGLIB CACHE UNLOCK */
+    sr_munlock(&conn->yanglib_cache_lock);
 }
 
-/**
- * @brief Flush all cached oper data of a connection.
- *
- * @param[in] conn Connection to use.
- */
-static void
-sr_conn_oper_cache_flush(sr_conn_ctx_t *conn)
+void
+sr_conn_oper_slots_cache_flush(sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t i;
-    struct sr_oper_poll_cache_s *cache;
 
-    /* CONN OPER CACHE READ LOCK */
-    if ((err_info = sr_rwlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
-            __func__, NULL, NULL))) {
+    /* OPER SLOTS CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->oper_slots_cache_lock, -1, __func__, NULL, NULL))) {
         /* should never happen */
         sr_errinfo_free(&err_info);
+        return;
     }
 
-    for (i = 0; i < conn->oper_cache_count; ++i) {
-        cache = &conn->oper_caches[i];
+    for (i = 0; i < conn->oper_slots_cache_count; ++i) {
+        sr_shm_clear(&conn->oper_slots_cache[i].shm);
+    }
+    free(conn->oper_slots_cache);
+    conn->oper_slots_cache = NULL;
+    conn->oper_slots_cache_count = 0;
 
-        /* CACHE DATA WRITE LOCK */
-        if ((err_info = sr_rwlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
-                __func__, NULL, NULL))) {
-            /* should never happen */
-            sr_errinfo_free(&err_info);
-        }
+    /* OPER SLOTS CACHE UNLOCK */
+    sr_munlock(&conn->oper_slots_cache_lock);
+}
 
-        /* flush data */
-        lyd_free_siblings(cache->data);
-        cache->data = NULL;
-        memset(&cache->timestamp, 0, sizeof cache->timestamp);
+void
+sr_conn_value_constr_cache_flush(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
 
-        /* CACHE DATA UNLOCK */
-        sr_rwunlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    /* VALUE CONSTR CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->value_constr_cache_lock, -1, __func__, NULL, NULL))) {
+        /* should never happen */
+        sr_errinfo_free(&err_info);
+        return;
     }
 
-    /* CONN OPER CACHE UNLOCK */
-    sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+    free(conn->value_constr_cache);
+    conn->value_constr_cache = NULL;
+    conn->value_constr_cache_count = 0;
+
+    /* VALUE CONSTR CACHE UNLOCK */
+    sr_munlock(&conn->value_constr_cache_lock);
 }
 
 void
@@ -3334,9 +7254,11 @@ sr_conn_ctx_switch(sr_conn_ctx_t *conn, struct ly_ctx **new_ctx, struct ly_ctx *
 
     assert(new_ctx);
 
+    SR_PROBE(ctx__switch__start, conn->cid, conn->content_id);
+
     if (conn->ly_ext_data) {
         /* copy the ext data into the new context */
-        if ((err_info = sr_lyd_dup_siblings_to_ctx(conn->ly_ext_data, *new_ctx, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS,
+        if ((err_info = sr_lyd_dup_to_ctx(conn->ly_ext_data, *new_ctx, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 1,
                 &new_ext_data))) {
             sr_errinfo_free(&err_info);
         }
@@ -3345,21 +7267,29 @@ sr_conn_ctx_switch(sr_conn_ctx_t *conn, struct ly_ctx **new_ctx, struct ly_ctx *
     /* replace/flush caches before context destroy */
     sr_conn_ext_data_replace(conn, new_ext_data);
     sr_conn_run_cache_flush(conn);
+    sr_conn_ds_cache_flush(conn);
     sr_conn_oper_cache_flush(conn);
+    sr_conn_xpath_cache_flush(conn);
+    sr_conn_rpc_dep_cache_flush(conn);
+    sr_conn_yanglib_cache_flush(conn);
+    sr_conn_oper_slots_cache_flush(conn);
+    sr_conn_value_constr_cache_flush(conn);
 
     /* update content ID */
-    conn->content_id = SR_CONN_MAIN_SHM(conn)->content_id;
+    conn->content_id = ATOMIC_LOAD_ACQUIRE(SR_CONN_MAIN_SHM(conn)->content_id);
 
     /* old ctx */
     if (old_ctx) {
         *old_ctx = conn->ly_ctx;
     } else {
-        ly_ctx_destroy(conn->ly_ctx);
+        sr_ly_ctx_destroy(conn->ly_ctx);
     }
 
     /* new ctx */
     conn->ly_ctx = *new_ctx;
     *new_ctx = NULL;
+
+    SR_PROBE(ctx__switch, conn->cid, conn->content_id);
 }
 
 sr_error_info_t *
@@ -3948,30 +7878,345 @@ sr_ev2api(sr_sub_event_t ev)
 {
     sr_error_info_t *err_info = NULL;
 
-    switch (ev) {
-    case SR_SUB_EV_UPDATE:
-        return SR_EV_UPDATE;
-    case SR_SUB_EV_CHANGE:
-        return SR_EV_CHANGE;
-    case SR_SUB_EV_DONE:
-        return SR_EV_DONE;
-    case SR_SUB_EV_ABORT:
-        return SR_EV_ABORT;
-    case SR_SUB_EV_ENABLED:
-        return SR_EV_ENABLED;
-    case SR_SUB_EV_RPC:
-        return SR_EV_RPC;
-    default:
-        SR_ERRINFO_INT(&err_info);
-        sr_errinfo_free(&err_info);
-        break;
+    switch (ev) {
+    case SR_SUB_EV_UPDATE:
+        return SR_EV_UPDATE;
+    case SR_SUB_EV_CHANGE:
+        return SR_EV_CHANGE;
+    case SR_SUB_EV_DONE:
+        return SR_EV_DONE;
+    case SR_SUB_EV_ABORT:
+        return SR_EV_ABORT;
+    case SR_SUB_EV_ENABLED:
+        return SR_EV_ENABLED;
+    case SR_SUB_EV_RPC:
+        return SR_EV_RPC;
+    default:
+        SR_ERRINFO_INT(&err_info);
+        sr_errinfo_free(&err_info);
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Learn whether the path segment of a node can be generated by ::sr_lyd_path_next().
+ *
+ * @param[in] node Data node.
+ * @return Whether the segment is supported, otherwise the full path is generated by libyang.
+ */
+static int
+sr_lyd_path_node_supported(const struct lyd_node *node)
+{
+    if (!node->schema) {
+        /* opaque node */
+        return 0;
+    }
+
+    switch (node->schema->nodetype) {
+    case LYS_LIST:
+        /* position predicate */
+        return !(node->schema->flags & LYS_KEYLESS);
+    case LYS_LEAFLIST:
+        /* state leaf-lists use position predicates, too */
+        return (node->schema->flags & LYS_CONFIG_W) ? 1 : 0;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * @brief Make sure there is enough space in a path buffer.
+ *
+ * @param[in] path Path builder.
+ * @param[in] len Required size of the buffer.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lyd_path_reserve(struct sr_lyd_path_s *path, uint32_t len)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t size;
+    char *mem;
+
+    if (len <= path->size) {
+        return NULL;
+    }
+
+    for (size = path->size ? path->size : 256; size < len; size *= 2) {}
+    mem = realloc(path->buf, size);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    path->buf = mem;
+    path->size = size;
+    return NULL;
+}
+
+/**
+ * @brief Append a predicate with a value to a path.
+ *
+ * @param[in] path Path builder.
+ * @param[in,out] len Length of the path, updated.
+ * @param[in] name Predicate node name.
+ * @param[in] value Predicate value.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lyd_path_append_pred(struct sr_lyd_path_s *path, uint32_t *len, const char *name, const char *value)
+{
+    sr_error_info_t *err_info = NULL;
+    char quot;
+
+    /* "[<name>=<quot><value><quot>]" */
+    if ((err_info = sr_lyd_path_reserve(path, *len + strlen(name) + strlen(value) + 6))) {
+        return err_info;
+    }
+    quot = strchr(value, '\'') ? '\"' : '\'';
+    *len += sprintf(path->buf + *len, "[%s=%c%s%c]", name, quot, value, quot);
+    return NULL;
+}
+
+/**
+ * @brief Append the path segment of a node to a path.
+ *
+ * @param[in] path Path builder.
+ * @param[in,out] len Length of the path, updated.
+ * @param[in] node Node whose segment to append, supported by ::sr_lyd_path_node_supported().
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lyd_path_append(struct sr_lyd_path_s *path, uint32_t *len, const struct lyd_node *node)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *parent, *key;
+    const char *mod_name = NULL;
+
+    /* module prefix, only if changed */
+    parent = lyd_parent(node);
+    if (!parent || (parent->schema->module != node->schema->module)) {
+        mod_name = node->schema->module->name;
+    }
+
+    /* "/[<mod>:]<name>" */
+    if ((err_info = sr_lyd_path_reserve(path, *len + (mod_name ? strlen(mod_name) + 1 : 0) +
+            strlen(LYD_NAME(node)) + 2))) {
+        return err_info;
+    }
+    *len += sprintf(path->buf + *len, "/%s%s%s", mod_name ? mod_name : "", mod_name ? ":" : "", LYD_NAME(node));
+
+    /* predicates */
+    if (node->schema->nodetype == LYS_LIST) {
+        for (key = lyd_child(node); key && lysc_is_key(key->schema); key = key->next) {
+            if ((err_info = sr_lyd_path_append_pred(path, len, LYD_NAME(key), lyd_get_value(key)))) {
+                return err_info;
+            }
+        }
+    } else if (node->schema->nodetype == LYS_LEAFLIST) {
+        if ((err_info = sr_lyd_path_append_pred(path, len, ".", lyd_get_value(node)))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_lyd_path_next(struct sr_lyd_path_s *path, const struct lyd_node *node, const char **str)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *iter;
+    const struct lyd_node **nodes;
+    uint32_t depth = 0, d, i, len, *lens;
+    char *p;
+
+    *str = NULL;
+
+    /* learn the depth and whether the path can be generated incrementally */
+    for (iter = node; iter; iter = lyd_parent(iter)) {
+        if (!sr_lyd_path_node_supported(iter)) {
+            goto full_path;
+        }
+        ++depth;
+    }
+
+    if (path->alloc < depth) {
+        nodes = realloc(path->nodes, depth * sizeof *path->nodes);
+        SR_CHECK_MEM_RET(!nodes, err_info);
+        path->nodes = nodes;
+        lens = realloc(path->lens, depth * sizeof *path->lens);
+        SR_CHECK_MEM_RET(!lens, err_info);
+        path->lens = lens;
+        path->alloc = depth;
+    }
+
+    /* find the ancestor whose path prefix is already generated, store the other ones */
+    for (iter = node, d = depth; iter; iter = lyd_parent(iter)) {
+        --d;
+        if ((d < path->count) && (path->nodes[d] == iter)) {
+            ++d;
+            break;
+        }
+        path->nodes[d] = iter;
+    }
+
+    /* append the segments of the remaining nodes */
+    len = d ? path->lens[d - 1] : 0;
+    path->count = d;
+    for (i = d; i < depth; ++i) {
+        if ((err_info = sr_lyd_path_append(path, &len, path->nodes[i]))) {
+            return err_info;
+        }
+        path->lens[i] = len;
+        path->count = i + 1;
+    }
+    path->count = depth;
+
+    /* the path of a descendant of the node may follow in the buffer */
+    path->buf[len] = '\0';
+    *str = path->buf;
+    return NULL;
+
+full_path:
+    path->count = 0;
+    p = lyd_path(node, LYD_PATH_STD, NULL, 0);
+    SR_CHECK_MEM_RET(!p, err_info);
+    free(path->buf);
+    path->buf = p;
+    path->size = strlen(p) + 1;
+    *str = path->buf;
+    return NULL;
+}
+
+void
+sr_lyd_path_erase(struct sr_lyd_path_s *path)
+{
+    if (!path) {
+        return;
+    }
+
+    free(path->buf);
+    free(path->nodes);
+    free(path->lens);
+    memset(path, 0, sizeof *path);
+}
+
+/**
+ * @brief Make sure there is enough free space in a values arena.
+ *
+ * @param[in] arena Values arena.
+ * @param[in] len Required free space.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_val_arena_reserve(struct sr_val_arena_s *arena, size_t len)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t size;
+    char *mem;
+
+    size = arena->size ? arena->size : SR_VAL_ARENA_SIZE;
+    while (size - arena->used < len) {
+        size *= 2;
+    }
+    if (size == arena->size) {
+        return NULL;
+    }
+
+    mem = realloc(arena->buf, size);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    arena->buf = mem;
+    arena->size = size;
+    return NULL;
+}
+
+/**
+ * @brief Store a string of a sysrepo value.
+ *
+ * @param[in] arena Values arena to store the string in as an offset, if NULL the string is duplicated.
+ * @param[in] str String to store.
+ * @param[out] dst Stored string or its arena offset.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_val_str_store(struct sr_val_arena_s *arena, const char *str, char **dst)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t len;
+
+    if (!arena) {
+        *dst = strdup(str);
+        SR_CHECK_MEM_RET(!*dst, err_info);
+        return NULL;
+    }
+
+    len = strlen(str) + 1;
+    if ((err_info = sr_val_arena_reserve(arena, len))) {
+        return err_info;
+    }
+    memcpy(arena->buf + arena->used, str, len);
+
+    /* pointers are resolved once the arena no longer moves, 0 is kept for NULL */
+    *dst = (char *)(uintptr_t)(arena->used + 1);
+    arena->used += len;
+    return NULL;
+}
+
+/**
+ * @brief Store the path of a node as the xpath of a sysrepo value.
+ *
+ * @param[in] path Optional path builder to generate the path with.
+ * @param[in] arena Values arena to generate the path into, if NULL the path is allocated.
+ * @param[in] node Node whose path to store.
+ * @param[out] dst Stored path or its arena offset.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_val_path_store(struct sr_lyd_path_s *path, struct sr_val_arena_s *arena, const struct lyd_node *node, char **dst)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t len = SR_VAL_ARENA_SIZE / 16;
+    const char *str;
+
+    if (path) {
+        /* reuse the path of the previous node */
+        if ((err_info = sr_lyd_path_next(path, node, &str))) {
+            return err_info;
+        }
+        return sr_val_str_store(arena, str, dst);
+    } else if (!arena) {
+        *dst = lyd_path(node, LYD_PATH_STD, NULL, 0);
+        SR_CHECK_MEM_RET(!*dst, err_info);
+        return NULL;
+    }
+
+    /* print directly into the arena, NULL is returned if the free space is not enough */
+    while (1) {
+        if ((err_info = sr_val_arena_reserve(arena, len))) {
+            return err_info;
+        }
+        if (lyd_path(node, LYD_PATH_STD, arena->buf + arena->used, arena->size - arena->used)) {
+            break;
+        }
+        len = (arena->size - arena->used) * 2;
     }
 
-    return 0;
+    *dst = (char *)(uintptr_t)(arena->used + 1);
+    arena->used += strlen(arena->buf + arena->used) + 1;
+    return NULL;
 }
 
-sr_error_info_t *
-sr_val_ly2sr(const struct lyd_node *node, sr_val_t *sr_val)
+/**
+ * @brief Transform a libyang node into sysrepo value.
+ *
+ * @param[in] node libyang node to transform.
+ * @param[in] path Optional path builder to generate the xpath with.
+ * @param[in] arena Optional values arena to store all the strings in.
+ * @param[out] sr_val sysrepo value.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_val_ly2sr_store(const struct lyd_node *node, struct sr_lyd_path_s *path, struct sr_val_arena_s *arena,
+        sr_val_t *sr_val)
 {
     sr_error_info_t *err_info = NULL;
     char *ptr, *origin;
@@ -3980,8 +8225,10 @@ sr_val_ly2sr(const struct lyd_node *node, sr_val_t *sr_val)
     struct lyd_node_any *any;
     struct lyd_node *tree;
 
-    sr_val->xpath = lyd_path(node, LYD_PATH_STD, NULL, 0);
-    SR_CHECK_MEM_GOTO(!sr_val->xpath, err_info, error);
+    sr_val->xpath = NULL;
+    if ((err_info = sr_val_path_store(path, arena, node, &sr_val->xpath))) {
+        goto error;
+    }
 
     sr_val->dflt = node->flags & LYD_DEFAULT ? 1 : 0;
 
@@ -3994,13 +8241,17 @@ store_value:
         switch (val->realtype->basetype) {
         case LY_TYPE_BINARY:
             sr_val->type = SR_BINARY_T;
-            sr_val->data.binary_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.binary_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.binary_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_BITS:
             sr_val->type = SR_BITS_T;
-            sr_val->data.bits_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.bits_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.bits_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_BOOL:
             sr_val->type = SR_BOOL_T;
@@ -4021,18 +8272,24 @@ store_value:
             break;
         case LY_TYPE_ENUM:
             sr_val->type = SR_ENUM_T;
-            sr_val->data.enum_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.enum_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.enum_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_IDENT:
             sr_val->type = SR_IDENTITYREF_T;
-            sr_val->data.identityref_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.identityref_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.identityref_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_INST:
             sr_val->type = SR_INSTANCEID_T;
-            sr_val->data.instanceid_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.instanceid_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.instanceid_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_INT8:
             sr_val->type = SR_INT8_T;
@@ -4052,8 +8309,10 @@ store_value:
             break;
         case LY_TYPE_STRING:
             sr_val->type = SR_STRING_T;
-            sr_val->data.string_val = strdup(lyd_value_get_canonical(LYD_CTX(node), val));
-            SR_CHECK_MEM_GOTO(!sr_val->data.string_val, err_info, error);
+            if ((err_info = sr_val_str_store(arena, lyd_value_get_canonical(LYD_CTX(node), val),
+                    &sr_val->data.string_val))) {
+                goto error;
+            }
             break;
         case LY_TYPE_UINT8:
             sr_val->type = SR_UINT8_T;
@@ -4124,6 +8383,15 @@ store_value:
             break;
         }
 
+        if (ptr && arena) {
+            err_info = sr_val_str_store(arena, ptr, &origin);
+            free(ptr);
+            ptr = origin;
+            if (err_info) {
+                goto error;
+            }
+        }
+
         if (node->schema->nodetype == LYS_ANYXML) {
             sr_val->type = SR_ANYXML_T;
             sr_val->data.anyxml_val = ptr;
@@ -4139,15 +8407,147 @@ store_value:
 
     /* origin */
     sr_edit_diff_get_origin(node, &origin, NULL);
-    sr_val->origin = origin;
+    if (origin && arena) {
+        err_info = sr_val_str_store(arena, origin, &sr_val->origin);
+        free(origin);
+        if (err_info) {
+            goto error;
+        }
+    } else {
+        sr_val->origin = origin;
+    }
 
     return NULL;
 
 error:
-    free(sr_val->xpath);
+    if (!arena) {
+        free(sr_val->xpath);
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_val_ly2sr(const struct lyd_node *node, struct sr_lyd_path_s *path, sr_val_t *sr_val)
+{
+    return sr_val_ly2sr_store(node, path, NULL, sr_val);
+}
+
+/**
+ * @brief Learn whether a sysrepo value type has its data stored as a string.
+ *
+ * @param[in] type Value type.
+ * @return Whether the data are a string.
+ */
+static int
+sr_val_type_is_str(sr_val_type_t type)
+{
+    switch (type) {
+    case SR_BINARY_T:
+    case SR_BITS_T:
+    case SR_ENUM_T:
+    case SR_IDENTITYREF_T:
+    case SR_INSTANCEID_T:
+    case SR_STRING_T:
+    case SR_ANYXML_T:
+    case SR_ANYDATA_T:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Resolve an arena offset of a value string into a pointer.
+ *
+ * @param[in] base Base address of the strings.
+ * @param[in,out] str Value string offset to resolve.
+ */
+static void
+sr_val_arena_resolve(char *base, char **str)
+{
+    if (*str) {
+        *str = base + ((uintptr_t)*str - 1);
+    }
+}
+
+sr_error_info_t *
+sr_vals_ly2sr_arena(const struct ly_set *set, sr_val_t **values, size_t *value_cnt)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_val_arena_s arena = {0};
+    struct sr_lyd_path_s path = {0};
+    struct sr_val_arena_hdr_s *hdr;
+    sr_val_t *vals = NULL;
+    char *block = NULL, *base;
+    uint32_t i;
+
+    *values = NULL;
+    *value_cnt = 0;
+    if (!set->count) {
+        return NULL;
+    }
+
+    vals = calloc(set->count, sizeof *vals);
+    SR_CHECK_MEM_GOTO(!vals, err_info, cleanup);
+
+    /* transform all the nodes, strings are stored as offsets into the arena */
+    for (i = 0; i < set->count; ++i) {
+        if ((err_info = sr_val_ly2sr_store(set->dnodes[i], &path, &arena, &vals[i]))) {
+            goto cleanup;
+        }
+    }
+
+    /* put the header, the values, and the strings into a single block */
+    block = malloc(sizeof *hdr + set->count * sizeof *vals + arena.used);
+    SR_CHECK_MEM_GOTO(!block, err_info, cleanup);
+    hdr = (struct sr_val_arena_hdr_s *)block;
+    *values = (sr_val_t *)(block + sizeof *hdr);
+    memcpy(*values, vals, set->count * sizeof *vals);
+    base = (char *)(*values + set->count);
+    memcpy(base, arena.buf, arena.used);
+
+    for (i = 0; i < set->count; ++i) {
+        sr_val_arena_resolve(base, &(*values)[i].xpath);
+        sr_val_arena_resolve(base, &(*values)[i].origin);
+        if (sr_val_type_is_str((*values)[i].type)) {
+            sr_val_arena_resolve(base, &(*values)[i].data.string_val);
+        }
+    }
+
+    /* mark the block so that it is recognized and freed as a whole */
+    hdr->magic = SR_VAL_ARENA_MAGIC ^ (uintptr_t)*values;
+    hdr->count = set->count;
+    *value_cnt = set->count;
+
+cleanup:
+    free(vals);
+    free(arena.buf);
+    sr_lyd_path_erase(&path);
     return err_info;
 }
 
+int
+sr_vals_arena_free(sr_val_t *values, size_t count)
+{
+    struct sr_val_arena_hdr_s *hdr;
+
+    /* the first string always directly follows the array of an arena, any other array is rejected cheaply */
+    if (values[0].xpath != (char *)(values + count)) {
+        return 0;
+    }
+
+    /* the header directly precedes the values */
+    hdr = (struct sr_val_arena_hdr_s *)((char *)values - sizeof *hdr);
+    if ((hdr->magic != (SR_VAL_ARENA_MAGIC ^ (uintptr_t)values)) || (hdr->count != count)) {
+        return 0;
+    }
+
+    /* clear the magic so that a freed block is never recognized again */
+    hdr->magic = 0;
+    free(hdr);
+    return 1;
+}
+
 char *
 sr_val_sr2ly_str(struct ly_ctx *ctx, const sr_val_t *sr_val, const char *xpath, char *buf, int output)
 {
@@ -4300,6 +8700,45 @@ sr_lyd_trim_depth(struct lyd_node *subtree, uint32_t max_depth)
     }
 }
 
+uint64_t
+sr_lyd_mem_size(const struct lyd_node *first, const struct lys_module *ly_mod)
+{
+    const struct lyd_node *sibling, *elem;
+    const struct lyd_meta *meta;
+    const char *value;
+    uint64_t size = 0;
+
+    LY_LIST_FOR(first, sibling) {
+        if (ly_mod && (lyd_owner_module(sibling) != ly_mod)) {
+            continue;
+        }
+
+        LYD_TREE_DFS_BEGIN(sibling, elem) {
+            if (!elem->schema) {
+                size += sizeof(struct lyd_node_opaq);
+            } else if (elem->schema->nodetype & LYD_NODE_TERM) {
+                size += sizeof(struct lyd_node_term);
+            } else if (elem->schema->nodetype & LYD_NODE_ANY) {
+                size += sizeof(struct lyd_node_any);
+            } else {
+                size += sizeof(struct lyd_node_inner);
+            }
+
+            /* values are stored in the dictionary but are mostly unique */
+            if ((value = lyd_get_value(elem))) {
+                size += strlen(value) + 1;
+            }
+            LY_LIST_FOR(elem->meta, meta) {
+                size += sizeof *meta;
+            }
+
+            LYD_TREE_DFS_END(sibling, elem);
+        }
+    }
+
+    return size;
+}
+
 /**
  * @brief Copy any existing config NP containers, recursively.
  *
@@ -4394,7 +8833,7 @@ sr_lyd_dup_module_np_cont(const struct lyd_node *data, const struct lys_module *
 
 sr_error_info_t *
 sr_lyd_get_module_data(struct lyd_node **data, const struct lys_module *ly_mod, int add_state_np_conts, int dup,
-        struct lyd_node **new_data)
+        uint32_t max_depth, struct lyd_node **new_data)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *node, *next, *subtree;
@@ -4403,7 +8842,16 @@ sr_lyd_get_module_data(struct lyd_node **data, const struct lys_module *ly_mod,
 
     LY_LIST_FOR_SAFE(*data, next, node) {
         if (lysc_owner_module(node->schema) == ly_mod) {
-            if (dup) {
+            if (dup && max_depth) {
+                /* duplicate only the required depth of the subtree */
+                if ((err_info = sr_lyd_dup(node, NULL, LYD_DUP_WITH_FLAGS, 0, &subtree))) {
+                    return err_info;
+                }
+                if ((err_info = sr_lyd_dup_r(node, max_depth - 1, subtree))) {
+                    lyd_free_tree(subtree);
+                    return err_info;
+                }
+            } else if (dup) {
                 /* duplicate subtree */
                 if ((err_info = sr_lyd_dup(node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 0, &subtree))) {
                     return err_info;
@@ -4635,6 +9083,166 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Add data into a FNV-1a 64-bit hash.
+ *
+ * @param[in] hash Current hash.
+ * @param[in] data Data to add.
+ * @param[in] len Length of @p data.
+ * @return Updated hash.
+ */
+static uint64_t
+sr_hash64_add(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *ptr = data;
+    size_t i;
+
+    for (i = 0; i < len; ++i) {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+uint64_t
+sr_subtree_hash_path(uint64_t parent_path, const struct lyd_node *node)
+{
+    /* the node hash includes the schema node and list keys or leaf-list value */
+    return sr_hash64_add(parent_path, &node->hash, sizeof node->hash);
+}
+
+/**
+ * @brief Compute content hash of a subtree and store hashes of all its inner subtrees.
+ *
+ * @param[in] node Subtree root.
+ * @param[in] parent_path Path hash of the parent of @p node.
+ * @param[in,out] hashes Array of subtree hashes to add to.
+ * @param[in,out] hash_count Count of @p hashes.
+ * @param[in,out] hash_size Allocated size of @p hashes.
+ * @param[out] content Content hash of @p node, 0 if not hashable.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lyd_subtree_hashes_r(const struct lyd_node *node, uint64_t parent_path, struct sr_subtree_hash_s **hashes,
+        uint32_t *hash_count, uint32_t *hash_size, uint64_t *content)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *child;
+    const char *val;
+    uint64_t path, hash, child_content;
+    uint32_t idx;
+    void *mem;
+
+    *content = 0;
+
+    if (!node->schema || (node->schema->nodetype & LYD_NODE_ANY) || (node->flags & LYD_EXT)) {
+        /* not hashable */
+        return NULL;
+    }
+
+    hash = sr_hash64_add(SR_SUBTREE_HASH_ROOT, &node->schema, sizeof node->schema);
+    if (node->schema->nodetype & LYD_NODE_TERM) {
+        val = lyd_get_value(node);
+        *content = sr_hash64_add(hash, val, strlen(val) + 1);
+        return NULL;
+    }
+
+    /* reserve the subtree hash, the array may be reallocated by the descendants */
+    if (*hash_count == *hash_size) {
+        *hash_size = *hash_size ? *hash_size * 2 : 32;
+        mem = realloc(*hashes, *hash_size * sizeof **hashes);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        *hashes = mem;
+    }
+    idx = (*hash_count)++;
+    path = sr_subtree_hash_path(parent_path, node);
+
+    LY_LIST_FOR(lyd_child(node), child) {
+        if (child->flags & LYD_DEFAULT) {
+            /* skip default nodes */
+            continue;
+        }
+
+        if ((err_info = sr_lyd_subtree_hashes_r(child, path, hashes, hash_count, hash_size, &child_content))) {
+            return err_info;
+        }
+        if (!child_content) {
+            /* a descendant is not hashable */
+            hash = 0;
+        } else if (hash) {
+            hash = sr_hash64_add(hash, &child_content, sizeof child_content);
+        }
+    }
+
+    /* 0 is reserved for not hashable subtrees */
+    (*hashes)[idx].path = path;
+    (*hashes)[idx].content = hash;
+    *content = hash;
+    return NULL;
+}
+
+/**
+ * @brief Compare subtree hashes by their path hash, callback for qsort() and bsearch().
+ */
+static int
+sr_subtree_hash_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct sr_subtree_hash_s *hash1 = ptr1, *hash2 = ptr2;
+
+    if (hash1->path < hash2->path) {
+        return -1;
+    } else if (hash1->path > hash2->path) {
+        return 1;
+    }
+    return 0;
+}
+
+sr_error_info_t *
+sr_lyd_subtree_hashes(const struct lyd_node *first, struct sr_subtree_hash_s **hashes, uint32_t *hash_count)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *node;
+    uint32_t hash_size = 0;
+    uint64_t content;
+
+    *hashes = NULL;
+    *hash_count = 0;
+
+    LY_LIST_FOR(first, node) {
+        if (node->flags & LYD_DEFAULT) {
+            continue;
+        }
+
+        if ((err_info = sr_lyd_subtree_hashes_r(node, SR_SUBTREE_HASH_ROOT, hashes, hash_count, &hash_size,
+                &content))) {
+            free(*hashes);
+            *hashes = NULL;
+            *hash_count = 0;
+            return err_info;
+        }
+    }
+
+    if (*hash_count) {
+        qsort(*hashes, *hash_count, sizeof **hashes, sr_subtree_hash_cmp);
+    }
+    return NULL;
+}
+
+uint64_t
+sr_subtree_hash_find(const struct sr_subtree_hash_s *hashes, uint32_t hash_count, uint64_t path)
+{
+    struct sr_subtree_hash_s key = {.path = path};
+    const struct sr_subtree_hash_s *found;
+
+    if (!hash_count) {
+        return 0;
+    }
+
+    found = bsearch(&key, hashes, hash_count, sizeof *hashes, sr_subtree_hash_cmp);
+    return found ? found->content : 0;
+}
+
 /*
  * Bob Jenkin's one-at-a-time hash
  * http://www.burtleburtle.net/bob/hash/doobs.html
@@ -4842,26 +9450,137 @@ sr_xpath_next_qname(const char *xpath, const char **mod, int *mod_len, const cha
         *len = ptr - xpath;
     }
 
-    return ptr;
+    return ptr;
+}
+
+const char *
+sr_xpath_skip_predicate(const char *xpath)
+{
+    int quot = 0;
+
+    assert(xpath[0] == '[');
+
+    do {
+        ++xpath;
+        if (xpath[0] == quot) {
+            quot = 0;
+        } else if (!quot && ((xpath[0] == '\'') || (xpath[0] == '\"'))) {
+            quot = xpath[0];
+        }
+    } while (quot || (xpath[0] != ']'));
+
+    return xpath + 1;
+}
+
+uint32_t
+sr_xpath_path_depth(const char *xpath)
+{
+    uint32_t depth = 0;
+
+    if (xpath[0] != '/') {
+        return 0;
+    }
+
+    for ( ; xpath[0]; ++xpath) {
+        if (xpath[0] == '/') {
+            if ((xpath[1] == '/') || (xpath[1] == '.')) {
+                /* descendant or other axes */
+                return 0;
+            }
+            ++depth;
+        } else if (strchr("[|() ", xpath[0])) {
+            /* predicates, unions, functions, or any other expressions */
+            return 0;
+        }
+    }
+
+    return depth;
 }
 
-const char *
-sr_xpath_skip_predicate(const char *xpath)
+int
+sr_xpath_is_instance_path(const struct ly_ctx *ly_ctx, const char *xpath)
 {
-    int quot = 0;
+    const struct lys_module *ly_mod = NULL;
+    const struct lysc_node *snode = NULL, *child;
+    const char *mod, *name;
+    int mod_len, len, quot, leaflist_pred;
+    uint32_t pred_count, key_count;
 
-    assert(xpath[0] == '[');
+    if (xpath[0] != '/') {
+        return 0;
+    }
 
-    do {
-        ++xpath;
-        if (xpath[0] == quot) {
-            quot = 0;
-        } else if (!quot && ((xpath[0] == '\'') || (xpath[0] == '\"'))) {
+    while (xpath[0]) {
+        if (xpath[0] != '/') {
+            /* not a simple path */
+            return 0;
+        }
+
+        /* node, the module must be specified for the first one */
+        xpath = sr_xpath_next_qname(xpath + 1, &mod, &mod_len, &name, &len);
+        if (!len || (name[0] == '*') || (name[0] == '.')) {
+            return 0;
+        }
+        if (mod) {
+            ly_mod = ly_ctx_get_module_implemented2(ly_ctx, mod, mod_len);
+        }
+        if (!ly_mod) {
+            return 0;
+        }
+        snode = lys_find_child(snode, ly_mod, name, len, 0, 0);
+        if (!snode || (snode->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF))) {
+            return 0;
+        }
+
+        /* predicates, only simple equality ones */
+        pred_count = 0;
+        leaflist_pred = 0;
+        while (xpath[0] == '[') {
+            ++xpath;
+            if ((xpath[0] == '.') && (xpath[1] == '=')) {
+                leaflist_pred = 1;
+                ++xpath;
+            } else {
+                xpath = sr_xpath_next_qname(xpath, NULL, NULL, NULL, &len);
+                if (!len || (xpath[0] != '=')) {
+                    return 0;
+                }
+            }
+            ++xpath;
+            if ((xpath[0] != '\'') && (xpath[0] != '\"')) {
+                return 0;
+            }
             quot = xpath[0];
+            xpath = strchr(xpath + 1, quot);
+            if (!xpath || (xpath[1] != ']')) {
+                return 0;
+            }
+            xpath += 2;
+            ++pred_count;
         }
-    } while (quot || (xpath[0] != ']'));
 
-    return xpath + 1;
+        /* the predicates must identify a single instance */
+        if (snode->nodetype == LYS_LIST) {
+            if (snode->flags & LYS_KEYLESS) {
+                return 0;
+            }
+            key_count = 0;
+            for (child = lysc_node_child(snode); child && lysc_is_key(child); child = child->next) {
+                ++key_count;
+            }
+            if (leaflist_pred || (pred_count != key_count)) {
+                return 0;
+            }
+        } else if (snode->nodetype == LYS_LEAFLIST) {
+            if (!leaflist_pred || (pred_count != 1)) {
+                return 0;
+            }
+        } else if (pred_count) {
+            return 0;
+        }
+    }
+
+    return 1;
 }
 
 /**
@@ -5387,45 +10106,50 @@ sr_module_file_data_append(const struct lys_module *ly_mod, const struct sr_ds_h
 }
 
 sr_error_info_t *
-sr_module_file_oper_data_load(struct sr_mod_info_mod_s *mod, struct lyd_node **edit)
+sr_oper_edit_del_dead(struct lyd_node **edit)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *root, *elem;
-    struct lyd_meta *meta;
-    sr_cid_t dead_cid = 0;
+    struct sr_conn_alive_cache_s alive;
+    uint32_t i;
 
-    assert(!*edit);
+    if (!*edit) {
+        return NULL;
+    }
 
-    /* load the operational data (edit) */
-    if ((err_info = mod->ds_handle[SR_DS_OPERATIONAL]->plugin->load_cb(mod->ly_mod, SR_DS_OPERATIONAL, NULL, 0,
-            mod->ds_handle[SR_DS_OPERATIONAL]->plg_data, edit))) {
+    if ((err_info = sr_conn_alive_cache_init(&alive))) {
         return err_info;
     }
 
-trim_retry:
-    if (dead_cid) {
-        /* this connection is dead, remove its stored edit */
-        SR_LOG_INF("Recovering module \"%s\" stored operational data of CID %" PRIu32 ".", mod->ly_mod->name, dead_cid);
-        if ((err_info = sr_edit_oper_del(edit, dead_cid, NULL, NULL))) {
-            return err_info;
+    /* remove the nodes of all the dead connections in a single pass, checking every CID only once */
+    sr_conn_alive_cache_use(&alive);
+    err_info = sr_edit_oper_del(edit, 0, NULL, NULL);
+    sr_conn_alive_cache_use(NULL);
+
+    for (i = 0; i < alive.count; ++i) {
+        if (!alive.cids[i].alive) {
+            SR_LOG_INF("Recovering stored operational data of CID %" PRIu32 ".", alive.cids[i].cid);
         }
     }
 
-    /* find edit belonging to a dead connection, if any */
-    LY_LIST_FOR(*edit, root) {
-        LYD_TREE_DFS_BEGIN(root, elem) {
-            meta = lyd_find_meta(elem->meta, NULL, "sysrepo:cid");
-            if (meta && !sr_conn_is_alive(meta->value.uint32)) {
-                dead_cid = meta->value.uint32;
+    sr_conn_alive_cache_destroy(&alive);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_module_file_oper_data_load(struct sr_mod_info_mod_s *mod, struct lyd_node **edit)
+{
+    sr_error_info_t *err_info = NULL;
 
-                /* retry the whole check until there are no dead connections */
-                goto trim_retry;
-            }
-            LYD_TREE_DFS_END(root, elem);
-        }
+    assert(!*edit);
+
+    /* load the operational data (edit) */
+    if ((err_info = mod->ds_handle[SR_DS_OPERATIONAL]->plugin->load_cb(mod->ly_mod, SR_DS_OPERATIONAL, NULL, 0,
+            mod->ds_handle[SR_DS_OPERATIONAL]->plg_data, edit))) {
+        return err_info;
     }
 
-    return err_info;
+    /* filter out the edit of dead connections, it is removed from the datastore by the next writer */
+    return sr_oper_edit_del_dead(edit);
 }
 
 sr_error_info_t *
@@ -5611,3 +10335,428 @@ cleanup:
 
     return err_info;
 }
+
+/**
+ * @brief Free the paths of a compiled notification filter.
+ *
+ * @param[in] filter Filter with the paths to free.
+ */
+static void
+sr_notif_filter_paths_free(sr_notif_filter_t *filter)
+{
+    struct sr_notif_filter_step_s *step;
+    uint32_t i, j, k;
+
+    for (i = 0; i < filter->path_count; ++i) {
+        for (j = 0; j < filter->paths[i].step_count; ++j) {
+            step = &filter->paths[i].steps[j];
+            for (k = 0; k < step->pred_count; ++k) {
+                free(step->preds[k].mod);
+                free(step->preds[k].name);
+                free(step->preds[k].value);
+            }
+            free(step->preds);
+            free(step->mod);
+            free(step->name);
+        }
+        free(filter->paths[i].steps);
+    }
+    free(filter->paths);
+    filter->paths = NULL;
+    filter->path_count = 0;
+}
+
+/**
+ * @brief Parse a qualified node name of a notification filter path.
+ *
+ * @param[in] ptr Current position in the XPath.
+ * @param[in] inherit_mod Module name to use if the name has no prefix, NULL if it is required.
+ * @param[out] mod Module name.
+ * @param[out] name Node name.
+ * @return Pointer to the first character after the name, NULL if not supported.
+ */
+static const char *
+sr_notif_filter_parse_qname(const char *ptr, const char *inherit_mod, char **mod, char **name)
+{
+    const char *m, *n;
+    int m_len, n_len;
+
+    if (!isalpha(ptr[0]) && (ptr[0] != '_')) {
+        /* wildcards, axes, functions, ... */
+        return NULL;
+    }
+
+    ptr = sr_xpath_next_qname(ptr, &m, &m_len, &n, &n_len);
+    if (!n_len || (!isalpha(n[0]) && (n[0] != '_')) || (!m && !inherit_mod)) {
+        return NULL;
+    }
+
+    *mod = m ? strndup(m, m_len) : strdup(inherit_mod);
+    *name = strndup(n, n_len);
+    return ptr;
+}
+
+/**
+ * @brief Parse simple paths of a notification subscription XPath into a filter.
+ *
+ * @param[in] xpath Subscription XPath.
+ * @param[in] filter Filter to add the paths to.
+ * @param[out] supported Whether the XPath is supported.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_notif_filter_parse(const char *xpath, sr_notif_filter_t *filter, int *supported)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_notif_filter_path_s *path;
+    struct sr_notif_filter_step_s *step;
+    struct sr_notif_filter_pred_s *pred;
+    const char *ptr, *end;
+    int paren = 0;
+    void *mem;
+
+    *supported = 0;
+
+    ptr = xpath;
+    while (isspace(ptr[0])) {
+        ++ptr;
+    }
+    if (ptr[0] == '(') {
+        paren = 1;
+        ++ptr;
+    }
+
+    while (1) {
+        while (isspace(ptr[0])) {
+            ++ptr;
+        }
+        if ((ptr[0] != '/') || (ptr[1] == '/')) {
+            /* relative paths, descendant axes */
+            return NULL;
+        }
+
+        /* new path */
+        mem = realloc(filter->paths, (filter->path_count + 1) * sizeof *filter->paths);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        filter->paths = mem;
+        path = &filter->paths[filter->path_count];
+        memset(path, 0, sizeof *path);
+        ++filter->path_count;
+
+        while ((ptr[0] == '/') && (ptr[1] != '/')) {
+            /* new step */
+            mem = realloc(path->steps, (path->step_count + 1) * sizeof *path->steps);
+            SR_CHECK_MEM_RET(!mem, err_info);
+            path->steps = mem;
+            step = &path->steps[path->step_count];
+            memset(step, 0, sizeof *step);
+            ++path->step_count;
+
+            ptr = sr_notif_filter_parse_qname(ptr + 1, (path->step_count > 1) ? step[-1].mod : NULL, &step->mod,
+                    &step->name);
+            if (!ptr) {
+                return NULL;
+            }
+            SR_CHECK_MEM_RET(!step->mod || !step->name, err_info);
+
+            while (ptr[0] == '[') {
+                /* new predicate */
+                mem = realloc(step->preds, (step->pred_count + 1) * sizeof *step->preds);
+                SR_CHECK_MEM_RET(!mem, err_info);
+                step->preds = mem;
+                pred = &step->preds[step->pred_count];
+                memset(pred, 0, sizeof *pred);
+                ++step->pred_count;
+
+                ++ptr;
+                while (isspace(ptr[0])) {
+                    ++ptr;
+                }
+                ptr = sr_notif_filter_parse_qname(ptr, step->mod, &pred->mod, &pred->name);
+                if (!ptr) {
+                    return NULL;
+                }
+                SR_CHECK_MEM_RET(!pred->mod || !pred->name, err_info);
+                while (isspace(ptr[0])) {
+                    ++ptr;
+                }
+                if (ptr[0] != '=') {
+                    /* other operators, positional predicates */
+                    return NULL;
+                }
+                ++ptr;
+                while (isspace(ptr[0])) {
+                    ++ptr;
+                }
+                if ((ptr[0] != '\'') && (ptr[0] != '\"')) {
+                    /* not a literal */
+                    return NULL;
+                }
+                if (!(end = strchr(ptr + 1, ptr[0]))) {
+                    return NULL;
+                }
+                pred->value = strndup(ptr + 1, end - (ptr + 1));
+                SR_CHECK_MEM_RET(!pred->value, err_info);
+                ptr = end + 1;
+                while (isspace(ptr[0])) {
+                    ++ptr;
+                }
+                if (ptr[0] != ']') {
+                    return NULL;
+                }
+                ++ptr;
+            }
+        }
+
+        while (isspace(ptr[0])) {
+            ++ptr;
+        }
+        if (ptr[0] != '|') {
+            break;
+        }
+        ++ptr;
+    }
+
+    if (paren) {
+        if (ptr[0] != ')') {
+            return NULL;
+        }
+        ++ptr;
+        while (isspace(ptr[0])) {
+            ++ptr;
+        }
+    }
+    if (ptr[0]) {
+        /* trailing expression */
+        return NULL;
+    }
+
+    *supported = 1;
+    return NULL;
+}
+
+sr_error_info_t *
+sr_notif_filter_compile(const char *xpath, sr_notif_filter_t **filter)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_notif_filter_t *f;
+    int supported;
+
+    *filter = NULL;
+
+    if (!xpath) {
+        return NULL;
+    }
+
+    f = calloc(1, sizeof *f);
+    SR_CHECK_MEM_RET(!f, err_info);
+    if ((err_info = sr_mutex_init(&f->lock, 0))) {
+        free(f);
+        return err_info;
+    }
+
+    if ((err_info = sr_notif_filter_parse(xpath, f, &supported)) || !supported) {
+        /* the XPath will be evaluated */
+        sr_notif_filter_free(f);
+        return err_info;
+    }
+
+    *filter = f;
+    return NULL;
+}
+
+/**
+ * @brief Find a leaf predicate schema node that can be compared with a literal by its canonical value.
+ *
+ * @param[in] ly_ctx Context to use.
+ * @param[in] path Schema path of the leaf.
+ * @return Found schema node, NULL if not found or not supported.
+ */
+static const struct lysc_node *
+sr_notif_filter_bind_pred(const struct ly_ctx *ly_ctx, const char *path)
+{
+    const struct lysc_node *snode;
+    const struct lysc_type *type;
+
+    if (!(snode = lys_find_path(ly_ctx, NULL, path, 0))) {
+        return NULL;
+    }
+
+    if (snode->nodetype == LYS_LEAF) {
+        type = ((struct lysc_node_leaf *)snode)->type;
+    } else if (snode->nodetype == LYS_LEAFLIST) {
+        type = ((struct lysc_node_leaflist *)snode)->type;
+    } else {
+        return NULL;
+    }
+
+    /* only types whose canonical value is the lexical value */
+    if ((type->basetype != LY_TYPE_STRING) && (type->basetype != LY_TYPE_ENUM)) {
+        return NULL;
+    }
+
+    return snode;
+}
+
+/**
+ * @brief Bind the paths of a filter to schema nodes of a context.
+ *
+ * @param[in] filter Filter to bind.
+ * @param[in] ly_ctx Context to use.
+ * @return 0 on success, non-zero if some nodes were not found or are not supported.
+ */
+static int
+sr_notif_filter_bind(sr_notif_filter_t *filter, const struct ly_ctx *ly_ctx)
+{
+    struct sr_notif_filter_path_s *path;
+    struct sr_notif_filter_step_s *step;
+    struct sr_notif_filter_pred_s *pred;
+    char *spath = NULL, *mem;
+    size_t spath_len, step_len;
+    uint32_t i, j, k;
+    int rc = 1;
+
+    for (i = 0; i < filter->path_count; ++i) {
+        path = &filter->paths[i];
+        spath_len = 0;
+
+        for (j = 0; j < path->step_count; ++j) {
+            step = &path->steps[j];
+
+            /* append the step to the schema path */
+            step_len = 1 + strlen(step->mod) + 1 + strlen(step->name);
+            if (!(mem = realloc(spath, spath_len + step_len + 1))) {
+                goto cleanup;
+            }
+            spath = mem;
+            sprintf(spath + spath_len, "/%s:%s", step->mod, step->name);
+            spath_len += step_len;
+
+            if (!(step->snode = lys_find_path(ly_ctx, NULL, spath, 0))) {
+                goto cleanup;
+            }
+
+            for (k = 0; k < step->pred_count; ++k) {
+                pred = &step->preds[k];
+
+                /* temporarily append the predicate leaf */
+                if (!(mem = realloc(spath, spath_len + 1 + strlen(pred->mod) + 1 + strlen(pred->name) + 1))) {
+                    goto cleanup;
+                }
+                spath = mem;
+                sprintf(spath + spath_len, "/%s:%s", pred->mod, pred->name);
+                pred->snode = sr_notif_filter_bind_pred(ly_ctx, spath);
+                spath[spath_len] = '\0';
+                if (!pred->snode) {
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    rc = 0;
+
+cleanup:
+    free(spath);
+    return rc;
+}
+
+/**
+ * @brief Match sibling data nodes against a step of a filter path and the following steps.
+ *
+ * @param[in] first First sibling to match.
+ * @param[in] path Filter path.
+ * @param[in] step_idx Index of the step in @p path.
+ * @return Whether any sibling matches.
+ */
+static int
+sr_notif_filter_match_step(const struct lyd_node *first, const struct sr_notif_filter_path_s *path, uint32_t step_idx)
+{
+    const struct sr_notif_filter_step_s *step = &path->steps[step_idx];
+    const struct lyd_node *node, *child;
+    uint32_t i;
+
+    LY_LIST_FOR(first, node) {
+        if (node->schema != step->snode) {
+            continue;
+        }
+
+        /* all the predicates must be satisfied */
+        for (i = 0; i < step->pred_count; ++i) {
+            LY_LIST_FOR(lyd_child(node), child) {
+                if ((child->schema == step->preds[i].snode) && !strcmp(lyd_get_value(child), step->preds[i].value)) {
+                    break;
+                }
+            }
+            if (!child) {
+                break;
+            }
+        }
+        if (i < step->pred_count) {
+            continue;
+        }
+
+        if ((step_idx + 1 == path->step_count) || sr_notif_filter_match_step(lyd_child(node), path, step_idx + 1)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int
+sr_notif_filter_match(sr_notif_filter_t *filter, const struct lyd_node *notif, uint32_t content_id, int *match)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct ly_ctx *ly_ctx = LYD_CTX(notif);
+    const struct lyd_node *root;
+    uint32_t i;
+    int rc = 1;
+
+    *match = 0;
+
+    /* FILTER LOCK */
+    if ((err_info = sr_mlock(&filter->lock, -1, __func__, NULL, NULL))) {
+        sr_errinfo_free(&err_info);
+        return 1;
+    }
+
+    if ((filter->ly_ctx != ly_ctx) || (filter->content_id != content_id)) {
+        /* (re)bind the paths to the context of the notification */
+        filter->ly_ctx = ly_ctx;
+        filter->content_id = content_id;
+        filter->bind_failed = sr_notif_filter_bind(filter, ly_ctx);
+    }
+    if (filter->bind_failed) {
+        goto cleanup;
+    }
+
+    /* top-level sibling of the notification */
+    for (root = notif; root->parent; root = lyd_parent(root)) {}
+    root = lyd_first_sibling(root);
+
+    for (i = 0; i < filter->path_count; ++i) {
+        if (sr_notif_filter_match_step(root, &filter->paths[i], 0)) {
+            *match = 1;
+            break;
+        }
+    }
+    rc = 0;
+
+cleanup:
+    /* FILTER UNLOCK */
+    sr_munlock(&filter->lock);
+    return rc;
+}
+
+void
+sr_notif_filter_free(sr_notif_filter_t *filter)
+{
+    if (!filter) {
+        return;
+    }
+
+    sr_notif_filter_paths_free(filter);
+    pthread_mutex_destroy(&filter->lock);
+    free(filter);
+}
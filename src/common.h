@@ -26,6 +26,10 @@
 #include "shm_types.h"
 #include "sysrepo_types.h"
 
+#ifdef SR_USDT_PROBES
+# include <sys/sdt.h>
+#endif
+
 struct lysp_submodule;
 struct sr_ds_handle;
 struct sr_mod_info_s;
@@ -33,6 +37,16 @@ struct sr_mod_info_mod_s;
 struct srplg_ds_s;
 struct srplg_ntf_s;
 
+/**
+ * @brief Fire a USDT static probe of the "sysrepo" provider, compiled out unless USDT probes are enabled.
+ * The arguments must have no side-effects.
+ */
+#ifdef SR_USDT_PROBES
+# define SR_PROBE(name, ...) STAP_PROBEV(sysrepo, name, ##__VA_ARGS__)
+#else
+# define SR_PROBE(name, ...)
+#endif
+
 /** macro for mutex align check */
 #define SR_MUTEX_ALIGN_CHECK(mutex) ((uintptr_t)mutex % sizeof(void *))
 
@@ -51,6 +65,9 @@ struct srplg_ntf_s;
 /* macro for getting aligned SHM size */
 #define SR_SHM_SIZE(size) ((size) + ((~(size) + 1) & (SR_SHM_MEM_ALIGN - 1)))
 
+/* macro for checking whether a SHM reserved mapping is valid for a size without remapping */
+#define SR_SHM_RESERVED(shm, new_size) ((shm)->addr && ((shm)->size <= (shm)->reserve) && ((new_size) <= (shm)->reserve))
+
 /* macro for getting main SHM from a connection */
 #define SR_CONN_MAIN_SHM(conn) ((sr_main_shm_t *)(conn)->main_shm.addr)
 
@@ -63,6 +80,12 @@ struct srplg_ntf_s;
 /** all ext SHM item sizes will be aligned to this number; also represents the allocation unit (B) */
 #define SR_SHM_MEM_ALIGN 8
 
+/** percentage of ext SHM size in memory holes that triggers automatic compaction of ext SHM */
+#define SR_EXT_COMPACT_HOLE_PERC 50
+
+/** minimal total size of ext SHM memory holes that triggers automatic compaction of ext SHM (B) */
+#define SR_EXT_COMPACT_HOLE_MIN 16384
+
 /** timeout for locking subscription structure lock, should be enough for a single ::sr_process_events() call (ms) */
 #define SR_SUBSCR_LOCK_TIMEOUT 30000
 
@@ -72,6 +95,9 @@ struct srplg_ntf_s;
 /** timeout for locking notification buffer lock, used when adding (including dup)/removing notifications (ms) */
 #define SR_NOTIF_BUF_LOCK_TIMEOUT 500
 
+/** maximum number of buffered notifications of a module stored for replay at once */
+#define SR_NOTIF_BUF_BATCH 256
+
 /** timeout for locking subscription SHM; maximum time an event handling should take (ms) */
 #define SR_SUBSHM_LOCK_TIMEOUT 10000
 
@@ -84,6 +110,9 @@ struct srplg_ntf_s;
 /** timeout for locking the local connection list; maximum time the list can be accessed (ms) */
 #define SR_CONN_LIST_LOCK_TIMEOUT 100
 
+/** maximum age of a connection aliveness registry result trusted without checking the connection lockfile (ms) */
+#define SR_CONN_REG_CHECK_INTERVAL 1000
+
 /** timeout for locking connection remap lock; maximum time it can be continuously read/written to (ms) */
 #define SR_CONN_REMAP_LOCK_TIMEOUT 10000
 
@@ -102,6 +131,9 @@ struct srplg_ntf_s;
 /** timeout for locking (data of) a module; maximum time a module write lock is expected to be held (ms) */
 #define SR_MOD_LOCK_TIMEOUT 5000
 
+/** time a WRITE lock request of module data waits before blocking new readers (ms) */
+#define SR_MOD_LOCK_FAIR_WAIT 50
+
 /** timeout for locking DS lock mutex of a module; is held only when accessing the DS lock information (ms) */
 #define SR_DS_LOCK_MUTEX_TIMEOUT 100
 
@@ -111,9 +143,15 @@ struct srplg_ntf_s;
 /** timeout for locking SHM module/RPC subscriptions; maxmum time full event processing may take (ms) */
 #define SR_SHMEXT_SUB_LOCK_TIMEOUT 15000
 
+/** timeout for locking SHM module/RPC subscriptions for automatic ext SHM compaction, it is skipped on timeout (ms) */
+#define SR_SHMEXT_COMPACT_LOCK_TIMEOUT 100
+
 /** default timeout for change subscription callback (ms) */
 #define SR_CHANGE_CB_TIMEOUT 5000
 
+/** time a group commit leader waits for other commits to join the group (ms) */
+#define SR_GROUP_COMMIT_WINDOW 1
+
 /** default timeout for operational subscription callback (ms) */
 #define SR_OPER_CB_TIMEOUT 5000
 
@@ -129,6 +167,12 @@ struct srplg_ntf_s;
 /** timeout for waiting until SRSN dispatch thread closes the read end of the notification pipe (ms) */
 #define SR_SN_READ_DISPATCH_CLOSE_TIMEOUT 1000
 
+/** number of threads processing all the SRSN (subscribed-notifications) timers */
+#define SR_SN_TIMER_THREADS 4
+
+/** maximum delay of a periodic yang-push update after another one with the same filter to share its data (ms) */
+#define SR_SN_YP_SNAPSHOT_SHARE_MS 100
+
 /** permissions of main SHM lock file and main/mod/ext SHM */
 #define SR_SHM_PERM 00666
 
@@ -159,6 +203,9 @@ struct srplg_ntf_s;
 /** get string value of the first child of a node */
 #define SR_LY_CHILD_VALUE(node) lyd_get_value(lyd_child(node))
 
+/** path hash of the parent of top-level data nodes, FNV-1a 64-bit offset basis */
+#define SR_SUBTREE_HASH_ROOT 0xcbf29ce484222325ULL
+
 /** check that a timespec struct is zeroed */
 #define SR_TS_IS_ZERO(ts) (!(ts).tv_sec && !(ts).tv_nsec)
 
@@ -183,7 +230,7 @@ extern const sr_module_ds_t sr_module_ds_default;
 extern const sr_module_ds_t sr_module_ds_disabled_run;
 
 /** static initializer of the shared memory structure */
-#define SR_SHM_INITIALIZER {.fd = -1, .size = 0, .addr = NULL}
+#define SR_SHM_INITIALIZER {.fd = -1, .size = 0, .reserve = 0, .huge = 0, .addr = NULL}
 
 /** initializer of mod_info structure */
 #define SR_MODINFO_INIT(mi, c, d, d2) memset(&(mi), 0, sizeof (mi)); (mi).ds = (d); (mi).ds2 = (d2); (mi).conn = (c)
@@ -407,6 +454,14 @@ mode_t sr_module_default_mode(const struct lys_module *ly_mod);
  */
 int sr_module_has_data(const struct lys_module *ly_mod, int state_data);
 
+/**
+ * @brief Check whether a module is covered by the DS lock of all the modules.
+ *
+ * @param[in] ly_mod Module to examine.
+ * @return Whether the module is DS-locked with all the modules or not.
+ */
+int sr_module_all_ds_lockable(const struct lys_module *ly_mod);
+
 /**
  * @brief Collect all implemented modules importing a specific module into a set.
  *
@@ -440,6 +495,30 @@ sr_error_info_t *sr_path_mod_shm(char **path);
  */
 sr_error_info_t *sr_path_ext_shm(char **path);
 
+/**
+ * @brief Get the path of the lock stats SHM.
+ *
+ * @param[out] path Created path. Should be freed by the caller.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_lock_stats_shm(char **path);
+
+/**
+ * @brief Get the path of the event stats SHM.
+ *
+ * @param[out] path Created path. Should be freed by the caller.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_event_stats_shm(char **path);
+
+/**
+ * @brief Get the path of the printed context image.
+ *
+ * @param[out] path Created path. Should be freed by the caller.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_printed_ctx(char **path);
+
 /**
  * @brief Get the path to a subscription SHM.
  *
@@ -462,6 +541,44 @@ sr_error_info_t *sr_path_sub_shm(const char *mod_name, const char *suffix1, int6
  */
 sr_error_info_t *sr_path_sub_data_shm(const char *mod_name, const char *suffix1, int64_t suffix2, char **path);
 
+/**
+ * @brief Get the path to a shared diff segment.
+ *
+ * @param[in] cid CID of the connection that created the segment.
+ * @param[in] diff_id Diff segment ID.
+ * @param[out] path Created path.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_sub_diff_shm(sr_cid_t cid, uint32_t diff_id, char **path);
+
+/**
+ * @brief Get the path to a shared running cache segment.
+ *
+ * @param[in] mod_name Module name.
+ * @param[out] path Created path.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_run_cache_shm(const char *mod_name, char **path);
+
+/**
+ * @brief Get the path to an operational value slots SHM.
+ *
+ * @param[in] mod_name Module name.
+ * @param[out] path Created path.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_oper_slots_shm(const char *mod_name, char **path);
+
+/**
+ * @brief Get the path to a shared oper cache segment.
+ *
+ * @param[in] mod_name Module name.
+ * @param[in] path Operational get subscription path.
+ * @param[out] shm_path Created path.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_path_oper_cache_shm(const char *mod_name, const char *path, char **shm_path);
+
 /**
  * @brief Get the path to an event pipe.
  *
@@ -508,6 +625,30 @@ sr_error_info_t *sr_path_conn_lockfile(sr_cid_t cid, int creat, char **path);
  */
 void sr_remove_evpipes(void);
 
+/**
+ * @brief Remove any leftover shared diff segments after crashed originators.
+ *
+ * @param[in] cid CID of the crashed originator, 0 to remove the segments of all the connections.
+ */
+void sr_remove_sub_diffs(sr_cid_t cid);
+
+/**
+ * @brief Remove all shared running cache segments, they are stale once main SHM is created.
+ */
+void sr_remove_run_caches(void);
+
+/**
+ * @brief Remove all shared oper cache segments, they are stale once main SHM is created.
+ */
+void sr_remove_oper_caches(void);
+
+/**
+ * @brief Remove the operational value slots segment of a module, mapped slots are no longer shared then.
+ *
+ * @param[in] mod_name Module name, NULL to remove the segments of all the modules once main SHM is created.
+ */
+void sr_remove_oper_slots(const char *mod_name);
+
 /**
  * @brief Get the UID of a user or vice versa.
  *
@@ -586,10 +727,60 @@ struct timespec sr_time_sub(const struct timespec *ts1, const struct timespec *t
  */
 int sr_time_sub_ms(const struct timespec *ts1, const struct timespec *ts2);
 
+/**
+ * @brief Get the request phase durations of a session, if timed.
+ */
+#define SR_SESS_PHASE_US(session) (((session) && (session)->timing.enabled) ? (session)->timing.phase_us : NULL)
+
+/**
+ * @brief Start a timed request of a session.
+ *
+ * @param[in] session Session of the request, nothing is done if its timing is not enabled.
+ * @param[out] start Start time of the request.
+ */
+void sr_timing_request_start(sr_session_ctx_t *session, struct timespec *start);
+
+/**
+ * @brief Finish a timed request of a session and log it if it was slow.
+ *
+ * @param[in] session Session of the request, nothing is done if its timing is not enabled.
+ * @param[in] request Request name for logging.
+ * @param[in] start Start time of the request.
+ */
+void sr_timing_request_end(sr_session_ctx_t *session, const char *request, const struct timespec *start);
+
+/**
+ * @brief Start a phase of a timed request.
+ *
+ * @param[in] phase_us Request phase durations, nothing is done if not set.
+ * @param[out] start Start time of the phase.
+ */
+void sr_timing_phase_start(const uint32_t *phase_us, struct timespec *start);
+
+/**
+ * @brief Finish a phase of a timed request and add its duration.
+ *
+ * @param[in] phase_us Request phase durations, nothing is done if not set.
+ * @param[in] phase Finished phase.
+ * @param[in] start Start time of the phase.
+ */
+void sr_timing_phase_end(uint32_t *phase_us, sr_phase_t phase, const struct timespec *start);
+
+/**
+ * @brief Learn whether large SHM should be backed by huge pages, set by ::SR_SHM_HUGEPAGES_ENV or the build default.
+ *
+ * @return 0 if not, non-zero if it should.
+ */
+int sr_shm_hugepages(void);
+
 /**
  * @brief Remap and possibly resize a SHM. Needs WRITE lock for resizing,
  * otherwise READ lock is fine.
  *
+ * If the SHM has reserved virtual address space and the new size fits into it, only the file is resized and
+ * the mapping address does not change. If the SHM should use huge pages, the mapping is advised so and any newly
+ * mapped part of the file is pre-faulted.
+ *
  * @param[in] shm SHM structure to remap.
  * @param[in] new_shm_size Resize SHM to this size, if 0 read the size of the SHM file.
  * @return err_info, NULL on success.
@@ -604,7 +795,7 @@ sr_error_info_t *sr_shm_remap(sr_shm_t *shm, size_t new_shm_size);
 void sr_shm_clear(sr_shm_t *shm);
 
 /**
- * @brief Get the next ext SHM memory hole.
+ * @brief Get the next ext SHM memory hole ordered by their offset.
  *
  * @param[in] last Last returned hole, NULL on first call.
  * @param[in] ext_shm Ext SHM.
@@ -618,10 +809,19 @@ sr_ext_hole_t *sr_ext_hole_next(sr_ext_hole_t *last, sr_ext_shm_t *ext_shm);
  * @param[in] ext_shm Ext SHM.
  * @param[in] off Optional offset of the hole.
  * @param[in] min_size Minimum matching hole size.
- * @return First suitable hole, NULL if none found.
+ * @return First suitable hole from the smallest suitable size class, NULL if none found.
  */
 sr_ext_hole_t *sr_ext_hole_find(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t min_size);
 
+/**
+ * @brief Find an existing hole ending at an offset.
+ *
+ * @param[in] ext_shm Ext SHM.
+ * @param[in] end_off Offset right after the hole.
+ * @return Found hole, NULL if none found.
+ */
+sr_ext_hole_t *sr_ext_hole_find_end(sr_ext_shm_t *ext_shm, uint32_t end_off);
+
 /**
  * @brief Delete an existing hole.
  *
@@ -631,15 +831,25 @@ sr_ext_hole_t *sr_ext_hole_find(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t mi
 void sr_ext_hole_del(sr_ext_shm_t *ext_shm, sr_ext_hole_t *hole);
 
 /**
- * @brief Add a new hole.
+ * @brief Add a new hole, it is merged with any adjacent holes.
+ *
+ * Finding the adjacent holes is linear in the number of holes preceding the new one.
  *
  * @param[in] ext_shm Ext SHM.
  * @param[in] off Offset of the new hole.
  * @param[in] size Size of the new hole.
- * @return First suitable hole, NULL if none found.
  */
 void sr_ext_hole_add(sr_ext_shm_t *ext_shm, uint32_t off, uint32_t size);
 
+/**
+ * @brief Collect ext SHM hole statistics, total hole count and size are kept in ext SHM.
+ *
+ * @param[in] ext_shm Ext SHM.
+ * @param[out] class_count Array of ::SR_EXT_HOLE_CLASS_COUNT hole counts of each size class.
+ * @param[out] largest Size of the largest hole.
+ */
+void sr_ext_hole_stats(sr_ext_shm_t *ext_shm, uint32_t *class_count, uint32_t *largest);
+
 /**
  * @brief Copy memory into SHM.
  *
@@ -749,6 +959,62 @@ sr_error_info_t *sr_ev_data_push(void **ev_data, uint32_t size, const void *data
  */
 sr_error_t sr_ev_data_get(const void *ev_data, uint32_t idx, uint32_t *size, void **data);
 
+/**
+ * @brief Get lock stats SHM with statistics of all the process-shared locks.
+ *
+ * @return Lock stats SHM, NULL if not available or lock statistics are not compiled in.
+ */
+const sr_lock_stats_shm_t *sr_lock_stats_get(void);
+
+#ifdef SR_EVENT_TRACE
+
+/**
+ * @brief Get the current event trace timestamp.
+ *
+ * @return Monotonic timestamp in us.
+ */
+uint64_t sr_event_trace_now(void);
+
+/**
+ * @brief Start the trace of a newly published event.
+ *
+ * @param[in] trace Event trace in the sub SHM.
+ */
+void sr_event_trace_enqueue(sr_sub_trace_t *trace);
+
+/**
+ * @brief Finish the trace of a subscription callback and record its latencies in event stats SHM.
+ *
+ * Sub SHM lock is expected to be held.
+ *
+ * @param[in] trace Event trace in the sub SHM.
+ * @param[in] sub_id Subscription ID.
+ * @param[in] type Subscription type.
+ * @param[in] name Subscription module name.
+ * @param[in] wake Timestamp when the subscriber noticed the event.
+ * @param[in] cb_start Timestamp when the callback was called.
+ * @param[in] cb_end Timestamp when the callback returned.
+ */
+void sr_event_trace_callback(sr_sub_trace_t *trace, uint32_t sub_id, sr_event_stats_type_t type, const char *name,
+        uint64_t wake, uint64_t cb_start, uint64_t cb_end);
+
+/**
+ * @brief Finish the trace of an event when its reply was observed by the originator and record the reply latency
+ * of the subscription that finished last.
+ *
+ * @param[in] trace Event trace in the sub SHM.
+ */
+void sr_event_trace_reply(sr_sub_trace_t *trace);
+
+#endif
+
+/**
+ * @brief Get event stats SHM with latency statistics of all the subscriptions.
+ *
+ * @return Event stats SHM, NULL if not available or event tracing is not compiled in.
+ */
+const sr_event_stats_shm_t *sr_event_stats_get(void);
+
 /**
  * @brief Wrapper for pthread_mutex_init().
  *
@@ -794,6 +1060,14 @@ sr_error_info_t *sr_rwlock_init(sr_rwlock_t *rwlock, int shared);
  */
 void sr_rwlock_destroy(sr_rwlock_t *rwlock);
 
+/**
+ * @brief Check whether a sysrepo RW lock is READ locked by anyone.
+ *
+ * @param[in] rwlock RW lock to check.
+ * @return Whether there are any read locks held.
+ */
+int sr_rwlock_has_readers(sr_rwlock_t *rwlock);
+
 /**
  * @brief Lock a sysrepo RW lock with additional options for sub SHM. On failure, the lock is not changed in any way.
  *
@@ -825,6 +1099,24 @@ sr_error_info_t *sr_sub_rwlock(sr_rwlock_t *rwlock, struct timespec *timeout_abs
 sr_error_info_t *sr_rwlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid, const char *func,
         sr_lock_recover_cb cb, void *cb_data);
 
+/**
+ * @brief Lock a sysrepo RW lock, READ and READ-UPGR locks are never blocked by a WRITE lock request using
+ * the writer-fair policy (::sr_rwlock_t.fair_wait_ms) and READ locks not by a WRITE-URGE lock request still
+ * waiting for other readers. Meant for event sessions, the waiting writer may itself wait for the originator
+ * of the event, which waits for the event to be processed.
+ *
+ * @param[in] rwlock RW lock to lock.
+ * @param[in] timeout_ms Timeout in ms for locking.
+ * @param[in] mode Lock mode to set.
+ * @param[in] cid Lock owner connection ID.
+ * @param[in] func Name of the calling function for logging.
+ * @param[in] cb Optional callback called when recovering locks. When calling it, WRITE lock is always held.
+ * @param[in] cb_data Arbitrary user data for @p cb.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_rwlock_nofair(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode, sr_cid_t cid,
+        const char *func, sr_lock_recover_cb cb, void *cb_data);
+
 /**
  * @brief Relock a sysrepo RW lock (upgrade or downgrade). On failure, the lock is not changed in any way.
  *
@@ -863,6 +1155,40 @@ void sr_rwunlock(sr_rwlock_t *rwlock, uint32_t timeout_ms, sr_lock_mode_t mode,
  */
 int sr_conn_is_alive(sr_cid_t cid);
 
+/**
+ * @brief Connection aliveness cache of a bulk check, every CID is checked only once.
+ */
+struct sr_conn_alive_cache_s {
+    pthread_mutex_t lock;           /**< Lock for accessing the cached CIDs. */
+    struct sr_conn_alive_cid_s {
+        sr_cid_t cid;               /**< Checked CID. */
+        int alive;                  /**< Whether the connection is alive. */
+    } *cids;                        /**< Checked CIDs sorted by CID. */
+    uint32_t count;                 /**< Checked CID count. */
+};
+
+/**
+ * @brief Initialize a connection aliveness cache.
+ *
+ * @param[in] cache Cache to initialize.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_alive_cache_init(struct sr_conn_alive_cache_s *cache);
+
+/**
+ * @brief Destroy a connection aliveness cache.
+ *
+ * @param[in] cache Cache to destroy.
+ */
+void sr_conn_alive_cache_destroy(struct sr_conn_alive_cache_s *cache);
+
+/**
+ * @brief Use a connection aliveness cache for all ::sr_conn_is_alive() calls of this thread.
+ *
+ * @param[in] cache Cache to use, NULL to stop using any.
+ */
+void sr_conn_alive_cache_use(struct sr_conn_alive_cache_s *cache);
+
 /**
  * @brief Update cached schema-mount operational data (LY ext data) of a connection.
  *
@@ -890,6 +1216,88 @@ sr_error_info_t *sr_conn_oper_cache_add(sr_conn_ctx_t *conn, uint32_t sub_id, co
  */
 void sr_conn_oper_cache_del(sr_conn_ctx_t *conn, uint32_t sub_id);
 
+/**
+ * @brief Publish cached operational data of an oper poll subscription into its shared oper cache segment
+ * so that they can be used by all the connections.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] module_name Module name of the data.
+ * @param[in] path Operational get subscription path of the data.
+ * @param[in] data Cached data.
+ * @param[in] timestamp Timestamp of the cached data.
+ * @param[in] valid_ms Validity period of the cached data.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_oper_cache_shm_publish(sr_conn_ctx_t *conn, const char *module_name, const char *path,
+        const struct lyd_node *data, const struct timespec *timestamp, uint32_t valid_ms);
+
+/**
+ * @brief Remove a shared oper cache segment, if it exists.
+ *
+ * @param[in] module_name Module name of the data.
+ * @param[in] path Operational get subscription path of the data.
+ */
+void sr_conn_oper_cache_shm_remove(const char *module_name, const char *path);
+
+/**
+ * @brief Load cached operational data from a shared oper cache segment.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the data.
+ * @param[in] path Operational get subscription path of the data.
+ * @param[out] data Parsed cached data.
+ * @param[out] found Whether valid cached data were found and @p data set.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_oper_cache_shm_load(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, const char *path,
+        struct lyd_node **data, int *found);
+
+/**
+ * @brief Map the operational value slots SHM of a module.
+ *
+ * @param[in] mod_name Module name.
+ * @param[in] create Whether to create the SHM if it does not exist, it is mapped writable then.
+ * @param[out] shm Mapped SHM, its address is NULL if it does not exist.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_oper_slots_shm_map(const char *mod_name, int create, sr_shm_t *shm);
+
+/**
+ * @brief Write the path and/or the value of an operational value slot under its sequence lock.
+ *
+ * @param[in] slot Slot to write.
+ * @param[in] path Path to write, NULL to keep.
+ * @param[in] value Value to write.
+ * @param[in] value_len Length of @p value.
+ */
+void sr_oper_slot_write(sr_oper_slot_shm_t *slot, const char *path, const char *value, size_t value_len);
+
+/**
+ * @brief Allocate a free operational value slot, or a slot of a dead connection, and write its path and value.
+ *
+ * @param[in] slots_shm Operational value slots SHM of the module.
+ * @param[in] cid CID of the new owner connection.
+ * @param[in] path Leaf path.
+ * @param[in] value Leaf value.
+ * @param[in] value_len Length of @p value.
+ * @param[out] idx Index of the allocated slot.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_oper_slot_alloc(sr_oper_slots_shm_t *slots_shm, sr_cid_t cid, const char *path, const char *value,
+        size_t value_len, uint32_t *idx);
+
+/**
+ * @brief Merge the current values of all the used operational value slots of a module into its data.
+ *
+ * @param[in] conn Connection to use, caches the mapped slots.
+ * @param[in] shm_mod SHM module of @p ly_mod.
+ * @param[in] ly_mod Module of the data.
+ * @param[in,out] data Operational data tree.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_oper_slots_merge(sr_conn_ctx_t *conn, const sr_mod_t *shm_mod, const struct lys_module *ly_mod,
+        struct lyd_node **data);
+
 /**
  * @brief Update cached running data of a connection.
  *
@@ -907,10 +1315,72 @@ sr_error_info_t *sr_conn_run_cache_update(sr_conn_ctx_t *conn, const struct sr_m
  * @param[in] ly_mod Module to update.
  * @param[in] mod_cache_id Module @p mod_data cache ID.
  * @param[in] mod_data Current module data to store in the cache, are spent.
+ * @param[in] hashes Optional subtree hashes of @p mod_data to store in the cache, are spent.
+ * @param[in] hash_count Count of @p hashes.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_conn_run_cache_update_mod(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
-        uint32_t mod_cache_id, struct lyd_node *mod_data);
+        uint32_t mod_cache_id, struct lyd_node *mod_data, struct sr_subtree_hash_s *hashes, uint32_t hash_count);
+
+/**
+ * @brief Get a copy of the subtree hashes of connection cached running data of a module.
+ *
+ * The cached data are expected to be current, the hashes are only returned if they belong to them.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the data.
+ * @param[out] hashes Copy of the subtree hashes, NULL if not known.
+ * @param[out] hash_count Count of @p hashes.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_run_cache_hashes_get(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
+        struct sr_subtree_hash_s **hashes, uint32_t *hash_count);
+
+/**
+ * @brief Store subtree hashes of connection cached running data of a module.
+ *
+ * The cached data are expected to be current and the hashes generated from them.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the data.
+ * @param[in] hashes Subtree hashes of the cached data, are spent.
+ * @param[in] hash_count Count of @p hashes.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_run_cache_hashes_set(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
+        struct sr_subtree_hash_s *hashes, uint32_t hash_count);
+
+/**
+ * @brief Publish running data of a module in its shared running cache segment for connections
+ * with ::SR_CONN_CACHE_RUNNING_SHARED.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module of the data.
+ * @param[in] cache_id Module @p mod_data cache ID.
+ * @param[in] mod_data Current module data.
+ * @param[in] mod_diff Optional diff of @p mod_data from the data with the previous cache ID.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_run_cache_shm_publish(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, uint32_t cache_id,
+        const struct lyd_node *mod_data, const struct lyd_node *mod_diff);
+
+/**
+ * @brief Get a reference of the current snapshot of connection cached running data.
+ *
+ * Conn run cache READ lock is expected to be held. The snapshot data stay valid and unchanged until the reference
+ * is released, even after the lock is released.
+ *
+ * @param[in] conn Connection to use.
+ * @return Referenced snapshot, NULL if there is none.
+ */
+struct sr_run_cache_snap_s *sr_conn_run_cache_snap_ref(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Release a reference of a snapshot of connection cached running data, free it if it was the last one.
+ *
+ * @param[in] snap Snapshot to release, may be NULL.
+ */
+void sr_conn_run_cache_snap_unref(struct sr_run_cache_snap_s *snap);
 
 /**
  * @brief Flush all cached running data of a connection.
@@ -919,6 +1389,207 @@ sr_error_info_t *sr_conn_run_cache_update_mod(sr_conn_ctx_t *conn, const struct
  */
 void sr_conn_run_cache_flush(sr_conn_ctx_t *conn);
 
+/**
+ * @brief Append the data of a module in a datastore, from the connection cache if current (::SR_CONN_CACHE_DS).
+ *
+ * The data are loaded and cached if not yet cached or changed since, module READ lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mod Mod info module.
+ * @param[in] ds Datastore, ::SR_DS_STARTUP or ::SR_DS_FACTORY_DEFAULT.
+ * @param[in,out] data Data tree to append the module data to.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_ds_cache_data_append(sr_conn_ctx_t *conn, const struct sr_mod_info_mod_s *mod,
+        sr_datastore_t ds, struct lyd_node **data);
+
+/**
+ * @brief Flush all cached startup and factory-default data of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_ds_cache_flush(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Get the memory used by the caches and buffers of a connection.
+ * CONTEXT READ lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @param[out] mem_usage Array of ::SR_CONN_MEM_COUNT items to fill.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_mem_usage(sr_conn_ctx_t *conn, uint64_t *mem_usage);
+
+/**
+ * @brief Get the memory saved by keeping evicted cached running data compact (::SR_CONN_CACHE_RUNNING_COMPACT)
+ * instead of as data trees.
+ *
+ * @param[in] conn Connection to use.
+ * @param[out] saved Estimated saved memory in bytes.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_run_cache_compact_saved(sr_conn_ctx_t *conn, uint64_t *saved);
+
+/**
+ * @brief Set the memory limit of a cache of a connection.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mem Cache to limit.
+ * @param[in] limit Limit to set, 0 for no limit.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_mem_limit_set(sr_conn_ctx_t *conn, sr_conn_mem_t mem, uint64_t limit);
+
+/**
+ * @brief Get the memory used by the prepared changes and buffered notifications of a session.
+ *
+ * @param[in] sess Session to use.
+ * @param[out] edit Optional size of the prepared edits.
+ * @param[out] notif_buf Optional size of the buffered notifications.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_sess_mem_usage(sr_session_ctx_t *sess, uint64_t *edit, uint64_t *notif_buf);
+
+/**
+ * @brief Callback executing a single load job.
+ *
+ * @param[in] idx Index of the job.
+ * @param[in] cb_data Callback data.
+ * @return err_info, NULL on success.
+ */
+typedef sr_error_info_t *(*sr_load_job_cb)(uint32_t idx, void *cb_data);
+
+/**
+ * @brief Batch of load jobs executed by a connection.
+ */
+struct sr_load_batch_s {
+    sr_load_job_cb cb;              /**< Job callback. */
+    void *cb_data;                  /**< Job callback data. */
+    uint32_t count;                 /**< Job count. */
+    uint32_t next;                  /**< Index of the next job to start. */
+    uint32_t done;                  /**< Count of finished jobs. */
+    sr_error_info_t **err_info;     /**< Error of every job. */
+    struct sr_load_batch_s *next_batch; /**< Next batch in the queue. */
+};
+
+/**
+ * @brief Execute independent load jobs, in parallel by the connection load workers and the calling thread.
+ *
+ * The workers are started on the first use, the jobs are executed sequentially if there are none.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] count Job count.
+ * @param[in] cb Job callback called for every job index.
+ * @param[in] cb_data Callback data.
+ * @return err_info of all the failed jobs in their order, NULL on success.
+ */
+sr_error_info_t *sr_conn_load_run(sr_conn_ctx_t *conn, uint32_t count, sr_load_job_cb cb, void *cb_data);
+
+/**
+ * @brief Stop the load workers of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_load_workers_stop(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Get the cached modules required for evaluating an XPath.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] xpath XPath to find.
+ * @param[in] conventional Whether the modules are needed for a conventional datastore.
+ * @param[out] mods Duplicated array of the cached modules, if found.
+ * @param[out] mod_count Count of @p mods.
+ * @param[out] found Whether the XPath was found in the cache.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_xpath_cache_get(sr_conn_ctx_t *conn, const char *xpath, int conventional,
+        const struct lys_module ***mods, uint32_t *mod_count, int *found);
+
+/**
+ * @brief Cache the modules required for evaluating an XPath, replacing the least recently used entry.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] xpath XPath to store.
+ * @param[in] conventional Whether the modules are needed for a conventional datastore.
+ * @param[in] mods Array of modules, is duplicated.
+ * @param[in] mod_count Count of @p mods.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_xpath_cache_add(sr_conn_ctx_t *conn, const char *xpath, int conventional,
+        const struct lys_module **mods, uint32_t mod_count);
+
+/**
+ * @brief Flush all the cached XPath modules of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_xpath_cache_flush(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Add the cached validation dependencies of an RPC/action into mod info.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] path RPC/action path to find.
+ * @param[in] output Whether to find the output or the input dependencies.
+ * @param[in,out] mod_info Mod info to add the dependencies to, if found.
+ * @param[out] instid Whether the RPC/action has also instance-identifier dependencies, which are not cached.
+ * @param[out] found Whether the dependencies were found in the cache.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_rpc_dep_cache_collect(sr_conn_ctx_t *conn, const char *path, int output,
+        struct sr_mod_info_s *mod_info, int *instid, int *found);
+
+/**
+ * @brief Cache the validation dependencies of an RPC/action, replacing the least recently used entry.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] path RPC/action path to store.
+ * @param[in] output Whether the dependencies are of the output or the input.
+ * @param[in] deps Array of leafref and XPath dependencies, is spent.
+ * @param[in] dep_count Count of @p deps.
+ * @param[in] instid Whether the RPC/action has also instance-identifier dependencies.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_conn_rpc_dep_cache_add(sr_conn_ctx_t *conn, const char *path, int output,
+        struct sr_rpc_dep_mod_s *deps, uint32_t dep_count, int instid);
+
+/**
+ * @brief Free an array of cached RPC/action dependencies.
+ *
+ * @param[in] deps Array of dependencies to free.
+ * @param[in] dep_count Count of @p deps.
+ */
+void sr_conn_rpc_dep_cache_deps_free(struct sr_rpc_dep_mod_s *deps, uint32_t dep_count);
+
+/**
+ * @brief Flush all the cached RPC/action dependencies of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_rpc_dep_cache_flush(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Flush the cached ietf-yang-library data of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_yanglib_cache_flush(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Flush the cached mapped operational value slots SHM of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_oper_slots_cache_flush(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Flush the cached value-dependent constraints of modules of a connection.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_conn_value_constr_cache_flush(sr_conn_ctx_t *conn);
+
 /**
  * @brief Switch the context of a connection while correctly handling all connection data in the context.
  *
@@ -1103,14 +1774,59 @@ const char *sr_ev2str(sr_sub_event_t ev);
  */
 sr_event_t sr_ev2api(sr_sub_event_t ev);
 
+/**
+ * @brief Generate the standard path of a data node, reusing the path prefix of the previous node.
+ *
+ * Meant for nodes in depth-first order, when only the segments of nodes that are not ancestors of the previous
+ * node are generated. Paths with position predicates or opaque nodes are fully generated by libyang.
+ *
+ * @param[in] path Path builder, zeroed before the first use.
+ * @param[in] node Node whose path to generate.
+ * @param[out] str Path of @p node, valid until the next call.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_lyd_path_next(struct sr_lyd_path_s *path, const struct lyd_node *node, const char **str);
+
+/**
+ * @brief Free the members of a path builder.
+ *
+ * @param[in] path Path builder to erase.
+ */
+void sr_lyd_path_erase(struct sr_lyd_path_s *path);
+
 /**
  * @brief Transform a libyang node into sysrepo value.
  *
  * @param[in] node libyang node to transform.
+ * @param[in] path Optional path builder to generate the xpath with, useful for nodes in depth-first order.
  * @param[out] sr_val sysrepo value.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_val_ly2sr(const struct lyd_node *node, sr_val_t *sr_val);
+sr_error_info_t *sr_val_ly2sr(const struct lyd_node *node, struct sr_lyd_path_s *path, sr_val_t *sr_val);
+
+/**
+ * @brief Transform libyang nodes into an array of sysrepo values allocated as a single block.
+ *
+ * The block starts with a header with a magic value directly followed by the array, all the strings of the values
+ * are stored in the same block after the array. The block is freed by ::sr_free_values() at once.
+ *
+ * @param[in] set Set of the nodes to transform.
+ * @param[out] values Array of the values, NULL if @p set is empty.
+ * @param[out] value_cnt Count of @p values.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_vals_ly2sr_arena(const struct ly_set *set, sr_val_t **values, size_t *value_cnt);
+
+/**
+ * @brief Free an array of sysrepo values if allocated as a single block.
+ *
+ * The block is recognized by the header preceding the values.
+ *
+ * @param[in] values Array of values.
+ * @param[in] count Count of @p values, non-zero.
+ * @return Whether the values were allocated as a single block and were freed.
+ */
+int sr_vals_arena_free(sr_val_t *values, size_t count);
 
 /**
  * @brief Transform a sysrepo value into libyang string value.
@@ -1156,6 +1872,15 @@ sr_error_info_t *sr_lyd_dup_r(const struct lyd_node *src_parent, uint32_t depth,
  */
 void sr_lyd_trim_depth(struct lyd_node *subtree, uint32_t max_depth);
 
+/**
+ * @brief Estimate the memory allocated for data trees.
+ *
+ * @param[in] first First sibling of the trees.
+ * @param[in] ly_mod Optional module to estimate only the trees of.
+ * @return Estimated size in bytes.
+ */
+uint64_t sr_lyd_mem_size(const struct lyd_node *first, const struct lys_module *ly_mod);
+
 /**
  * @brief Duplicate only config NP containers of a module from a data tree. Also optionally create state NP containers.
  *
@@ -1176,11 +1901,12 @@ sr_error_info_t *sr_lyd_dup_module_np_cont(const struct lyd_node *data, const st
  * @param[in] ly_mod Module whose data to duplicate.
  * @param[in] add_state_np_conts Whether to also add state NP containers.
  * @param[in] dup Whether to duplicate data or only unlink.
+ * @param[in] max_depth Maximum depth of the duplicated data, 0 if unlimited. Used only if @p dup is set.
  * @param[in,out] new_data Data with appended duplicated nodes.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_lyd_get_module_data(struct lyd_node **data, const struct lys_module *ly_mod,
-        int add_state_np_conts, int dup, struct lyd_node **new_data);
+        int add_state_np_conts, int dup, uint32_t max_depth, struct lyd_node **new_data);
 
 /**
  * @brief Duplicate selected nodes from a data tree. Also properly handles config/state NP containers.
@@ -1206,6 +1932,38 @@ sr_error_info_t *sr_lyd_get_enabled_xpath(struct lyd_node **data, char **xpaths,
  */
 sr_error_info_t *sr_lyd_xpath_complement(struct lyd_node **data, const char *xpath);
 
+/**
+ * @brief Get the path hash of a data node used by subtree hashes.
+ *
+ * @param[in] parent_path Path hash of the parent, ::SR_SUBTREE_HASH_ROOT for top-level nodes.
+ * @param[in] node Data node.
+ * @return Path hash of @p node.
+ */
+uint64_t sr_subtree_hash_path(uint64_t parent_path, const struct lyd_node *node);
+
+/**
+ * @brief Compute content hashes of all the inner (container and list) subtrees of data.
+ *
+ * Default nodes are not part of the hashes so that validated and not validated data can be compared.
+ *
+ * @param[in] first First top-level sibling of the data.
+ * @param[out] hashes Subtree hashes sorted by their path hash.
+ * @param[out] hash_count Count of @p hashes.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_lyd_subtree_hashes(const struct lyd_node *first, struct sr_subtree_hash_s **hashes,
+        uint32_t *hash_count);
+
+/**
+ * @brief Find the content hash of a subtree.
+ *
+ * @param[in] hashes Subtree hashes from ::sr_lyd_subtree_hashes().
+ * @param[in] hash_count Count of @p hashes.
+ * @param[in] path Path hash of the subtree root.
+ * @return Content hash of the subtree, 0 if not found or not hashable.
+ */
+uint64_t sr_subtree_hash_find(const struct sr_subtree_hash_s *hashes, uint32_t hash_count, uint64_t path);
+
 /**
  * @brief Get a hash of a string value.
  *
@@ -1259,6 +2017,28 @@ const char *sr_xpath_next_qname(const char *xpath, const char **mod, int *mod_le
  */
 const char *sr_xpath_skip_predicate(const char *xpath);
 
+/**
+ * @brief Get the depth of the nodes selected by a simple absolute path.
+ *
+ * @param[in] xpath Path to examine.
+ * @return Depth of the selected nodes, top-level nodes having depth 1;
+ * @return 0 if the depth is not known (the path is not a simple path without predicates).
+ */
+uint32_t sr_xpath_path_depth(const char *xpath);
+
+/**
+ * @brief Learn whether a path identifies a single data node instance, meaning it is an absolute path in JSON format
+ * with all the keys of all the lists and the values of all the leaf-lists specified but no other predicates.
+ *
+ * Such a path can be resolved using hashes by ::sr_lyd_find_path() instead of evaluating it as an XPath.
+ *
+ * @param[in] ly_ctx Context to use.
+ * @param[in] xpath Path to examine.
+ * @return non-zero if the path is an instance path;
+ * @return 0 otherwise, or if not known.
+ */
+int sr_xpath_is_instance_path(const struct ly_ctx *ly_ctx, const char *xpath);
+
 /**
  * @brief Filter out the results that are descendants of another result. In case the results represent selected
  * subtrees, the filtered out results are redundant.
@@ -1333,6 +2113,14 @@ struct lyd_node *sr_module_data_unlink(struct lyd_node **data, const struct lys_
 sr_error_info_t *sr_module_file_data_append(const struct lys_module *ly_mod, const struct sr_ds_handle_s *ds_handle[],
         sr_datastore_t ds, const char **xpaths, uint32_t xpath_count, struct lyd_node **data);
 
+/**
+ * @brief Remove the nodes of all the dead connections from a stored operational edit.
+ *
+ * @param[in,out] edit Edit to remove from.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_oper_edit_del_dead(struct lyd_node **edit);
+
 /**
  * @brief Load operational data (edit) loaded from a SHM for a specific module.
  *
@@ -1372,4 +2160,34 @@ sr_error_info_t *sr_conn_push_oper_mod_add(sr_conn_ctx_t *conn, const char *mod_
  */
 sr_error_info_t *sr_conn_push_oper_mod_del(sr_conn_ctx_t *conn, const char *mod_name);
 
+/**
+ * @brief Compile a notification subscription XPath filter.
+ *
+ * Only a union of absolute paths with steps and `[leaf='literal']` predicates is supported, any other
+ * XPath is not compiled and must be evaluated.
+ *
+ * @param[in] xpath Subscription XPath.
+ * @param[out] filter Compiled filter, NULL if @p xpath is not supported.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_notif_filter_compile(const char *xpath, sr_notif_filter_t **filter);
+
+/**
+ * @brief Match a notification against a compiled notification subscription filter.
+ *
+ * @param[in] filter Compiled filter.
+ * @param[in] notif Notification data tree, any node of it.
+ * @param[in] content_id Content ID of the context of @p notif.
+ * @param[out] match Whether the notification matches the filter.
+ * @return 0 if matched, non-zero if the filter could not be used and its XPath must be evaluated.
+ */
+int sr_notif_filter_match(sr_notif_filter_t *filter, const struct lyd_node *notif, uint32_t content_id, int *match);
+
+/**
+ * @brief Free a compiled notification subscription filter.
+ *
+ * @param[in] filter Filter to free.
+ */
+void sr_notif_filter_free(sr_notif_filter_t *filter);
+
 #endif /* _COMMON_H */
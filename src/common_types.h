@@ -35,6 +35,9 @@
 typedef struct {
     int fd;                         /**< Shared memory file desriptor. */
     size_t size;                    /**< Shared memory mapping current size. */
+    size_t reserve;                 /**< Virtual address space to reserve for the mapping so that it does not need
+                                         to be remapped when shared memory grows up to this size, 0 for none. */
+    int huge;                       /**< Whether to back the mapping by transparent huge pages and pre-fault it. */
     char *addr;                     /**< Shared memory mapping address. */
 } sr_shm_t;
 
@@ -49,8 +52,32 @@ typedef enum {
     SR_LOCK_WRITE_URGE          /**< Write lock with priority forcing next readers to wait. */
 } sr_lock_mode_t;
 
-/** maximum number of system-wide concurrent connection owners of a read lock */
-#define SR_RWLOCK_READ_LIMIT 16
+/** number of subscriber event pipes a connection keeps opened for writing */
+#define SR_EVPIPE_CACHE_SIZE 32
+
+/** number of XPaths whose required modules a connection keeps cached */
+#define SR_XPATH_CACHE_SIZE 32
+
+/** number of RPC/action inputs and outputs whose validation dependencies a connection keeps cached */
+#define SR_RPC_DEP_CACHE_SIZE 16
+
+/** number of sub SHM lanes of an RPC/action, how many of its events can be pending at once, power of 2 */
+#define SR_RPC_LANE_COUNT 4
+
+/** maximum number of system-wide concurrent connection owners of a read lock, size of the reader registry */
+#define SR_RWLOCK_READ_LIMIT 64
+
+/** maximum number of recursive read locks of a single connection */
+#define SR_RWLOCK_READ_RECURSIVE_LIMIT UINT8_MAX
+
+/** create a reader registry slot value from a CID and its recursive read lock count */
+#define SR_RWLOCK_SLOT(cid, count) (((uint64_t)(cid) << 32) | (uint32_t)(count))
+
+/** get the CID from a reader registry slot value */
+#define SR_RWLOCK_SLOT_CID(slot) ((sr_cid_t)((slot) >> 32))
+
+/** get the recursive read lock count from a reader registry slot value */
+#define SR_RWLOCK_SLOT_COUNT(slot) ((uint32_t)((slot) & UINT32_MAX))
 
 /**
  * @brief Sysrepo read-write lock.
@@ -59,11 +86,21 @@ typedef struct {
     pthread_mutex_t mutex;          /**< Lock mutex. */
     sr_cond_t cond;                 /**< Lock condition variable. */
 
-    sr_cid_t readers[SR_RWLOCK_READ_LIMIT]; /**< CIDs of all READ lock owners (including READ-UPGR), 0s otherwise. */
-    uint8_t read_count[SR_RWLOCK_READ_LIMIT];   /**< Number of recursive read locks of the connection in readers. */
-    sr_cid_t upgr;                  /**< CID of the READ-UPGR lock owner if locked, 0 otherwise. */
-    sr_cid_t writer;                /**< CID of the WRITE lock owner if locked, can be set if an WRITE-URGE lock
+    ATOMIC64_T readers[SR_RWLOCK_READ_LIMIT];   /**< Registry of all READ lock owners (including READ-UPGR) with
+                                                     slots hashed by their CID, each slot holds the CID and its
+                                                     recursive read lock count (::SR_RWLOCK_SLOT()), 0 if free.
+                                                     Slots with count 0 stay reserved for fast-path read locking
+                                                     without the mutex. */
+    ATOMIC_T waiters;               /**< Number of threads waiting on the condition, fast-path unlocks need to wake
+                                         them. */
+    ATOMIC_T upgr;                  /**< CID of the READ-UPGR lock owner if locked, 0 otherwise. */
+    ATOMIC_T writer;                /**< CID of the WRITE lock owner if locked, can be set if an WRITE-URGE lock
                                          is being waited on, 0 otherwise. */
+    int mutex_read;                 /**< Whether READ locks must always lock the mutex (no fast path). */
+    ATOMIC_T fair_writer;           /**< CID of the WRITE lock request blocking new READ locks, 0 if none. */
+    uint32_t fair_wait_ms;          /**< Writer-fair policy, if non-zero a WRITE lock request waiting this long (ms)
+                                         blocks new READ locks of connections not holding any so that it cannot
+                                         be starved by them. */
 } sr_rwlock_t;
 
 /**
@@ -101,10 +138,45 @@ typedef struct {
     uint32_t union_count;
 } sr_xp_atoms_t;
 
+/**
+ * @brief Notification subscription XPath filter compiled into a union of simple paths bound to schema nodes.
+ */
+typedef struct {
+    pthread_mutex_t lock;           /**< Lock for binding the paths to a context. */
+    struct sr_notif_filter_path_s {
+        struct sr_notif_filter_step_s {
+            char *mod;              /**< Step module name. */
+            char *name;             /**< Step node name. */
+            const struct lysc_node *snode;  /**< Bound step schema node. */
+            struct sr_notif_filter_pred_s {
+                char *mod;          /**< Predicate leaf module name. */
+                char *name;         /**< Predicate leaf name. */
+                char *value;        /**< Predicate literal value. */
+                const struct lysc_node *snode;  /**< Bound predicate leaf schema node. */
+            } *preds;               /**< Step predicates, all must be satisfied. */
+            uint32_t pred_count;    /**< Step predicate count. */
+        } *steps;                   /**< Path steps from the top-level node. */
+        uint32_t step_count;        /**< Path step count. */
+    } *paths;                       /**< Paths of the union, any must match. */
+    uint32_t path_count;            /**< Path count. */
+
+    const struct ly_ctx *ly_ctx;    /**< Context the paths are bound to, NULL if not bound. */
+    uint32_t content_id;            /**< Content ID of the context the paths are bound to. */
+    int bind_failed;                /**< Whether binding to the context failed and the XPath must be evaluated. */
+} sr_notif_filter_t;
+
 /*
  * Private definitions of public declarations
  */
 
+/**
+ * @brief Content hash of a data subtree (Merkle-style, includes hashes of all the descendants).
+ */
+struct sr_subtree_hash_s {
+    uint64_t path;                  /**< Hash of the subtree root path, see ::sr_subtree_hash_path(). */
+    uint64_t content;               /**< Hash of the subtree content excluding default nodes, 0 if not hashable. */
+};
+
 /**
  * @brief Sysrepo connection.
  */
@@ -135,13 +207,45 @@ struct sr_conn_ctx_s {
     } *ds_handles;                  /**< Datastore implementation handles. */
     uint32_t ds_handle_count;       /**< Datastore implementaion handle count. */
 
-    struct lyd_node *run_cache_data;    /**< Cached running data of all the modules. */
+    struct sr_run_cache_snap_s {
+        struct lyd_node *data;          /**< Cached running data of all the modules, never modified while shared. */
+        ATOMIC_T refcount;              /**< Number of references, the cache holds one while the snapshot is current. */
+    } *run_cache_snap;              /**< Current snapshot of cached running data, NULL if none. */
     struct sr_run_cache_s {
         const struct lys_module *mod;   /**< Cached libyang module. */
         uint32_t id;                    /**< Cached module data ID. */
+        struct sr_subtree_hash_s *hashes;   /**< Subtree hashes of the cached data (::sr_lyd_subtree_hashes()), if
+                                                 known, valid only if @p hash_id matches @p id. */
+        uint32_t hash_count;            /**< Count of @p hashes. */
+        uint32_t hash_id;               /**< Module data ID of @p hashes. */
+        struct lyd_node *enabled;       /**< Enabled data of the module for operational reads, valid only if
+                                             @p enabled_id matches @p id and @p enabled_gen the generation of running
+                                             change subscriptions. */
+        uint32_t enabled_id;            /**< Module data ID of @p enabled, UINT32_MAX if not selected. */
+        uint32_t enabled_gen;           /**< Running change subscription generation of @p enabled. */
+        char *compact;                  /**< Evicted module data in the compact LYB form
+                                             (::SR_CONN_CACHE_RUNNING_COMPACT), parsed again once required. */
+        uint32_t compact_len;           /**< Length of @p compact. */
+        uint32_t compact_id;            /**< Module data ID of @p compact. */
+        uint64_t compact_size;          /**< Estimated size of the module data in @p compact once parsed. */
+        uint64_t size;                  /**< Estimated size of the cached module data, kept only with a memory limit. */
+        ATOMIC64_T last_use;            /**< Value of @p cache_tick when the data were last used. */
     } *run_cache_mods;
     uint32_t run_cache_mod_count;
     sr_rwlock_t run_cache_lock;     /**< Session-shared lock for accessing running data cache. */
+    pthread_mutex_t run_cache_enabled_lock; /**< Session-shared lock for accessing enabled data of cached modules,
+                                                 with run_cache_lock held. */
+
+    struct sr_ds_cache_s {
+        const struct lys_module *mod;   /**< Cached libyang module. */
+        sr_datastore_t ds;              /**< Cached datastore. */
+        uint32_t id;                    /**< Cached module data ID. */
+        struct lyd_node *data;          /**< Cached module data. */
+        uint64_t size;                  /**< Estimated size of the cached module data. */
+        uint64_t last_use;              /**< Value of @p cache_tick when the data were last used. */
+    } *ds_cache_mods;               /**< Cached data of modules in the startup and factory-default datastores. */
+    uint32_t ds_cache_mod_count;
+    pthread_mutex_t ds_cache_lock;  /**< Session-shared lock for accessing ds_cache_mods. */
 
     struct sr_ntf_handle_s {
         void *dl_handle;            /**< Handle from dlopen(3) call. */
@@ -156,7 +260,13 @@ struct sr_conn_ctx_s {
 
         sr_rwlock_t data_lock;      /**< Lock for accessing the data and timestamp. */
         struct lyd_node *data;      /**< Cached data of a single operational get subscription. */
+        struct sr_subtree_hash_s *hashes;   /**< Subtree hashes of the cached data (::sr_lyd_subtree_hashes()), if
+                                                 generated for an oper poll diff. */
+        uint32_t hash_count;        /**< Count of subtree hashes. */
         struct timespec timestamp;  /**< Timestamp of the cached operational data. */
+        uint64_t size;              /**< Estimated size of the cached data. */
+        int evicted;                /**< Whether the last polled data were evicted because of the memory limit. */
+        ATOMIC64_T last_use;        /**< Value of @p cache_tick when the data were last stored or used. */
     } *oper_caches;                 /**< Operational get subscription data caches. */
     uint32_t oper_cache_count;      /**< Operational get subscription data cache count. */
     sr_rwlock_t oper_cache_lock;    /**< Operational get subscription data cache lock. */
@@ -164,6 +274,88 @@ struct sr_conn_ctx_s {
     char **oper_push_mods;          /**< Modules whose pushed oper data were modified by this connection. */
     uint32_t oper_push_mod_count;   /**< Count of modules with modified push oper data. */
     pthread_mutex_t oper_push_mod_lock; /**< Session-shared lock for modifying oper_push_mods. */
+
+    struct sr_evpipe_cache_s {
+        uint32_t evpipe_num;        /**< Subscriber event pipe number. */
+        int fd;                     /**< Event pipe opened for writing, -1 if the entry is unused. */
+    } evpipe_cache[SR_EVPIPE_CACHE_SIZE];   /**< Opened subscriber event pipes. */
+    uint32_t evpipe_cache_next;     /**< Index of the next replaced entry once the cache is full. */
+    pthread_mutex_t evpipe_cache_lock;  /**< Session-shared lock for accessing evpipe_cache. */
+
+    struct sr_xpath_cache_s {
+        char *xpath;                /**< Cached XPath, NULL if the entry is unused. */
+        int conventional;           /**< Whether the modules were collected for a conventional datastore. */
+        const struct lys_module **mods; /**< Modules with the data required for evaluating the XPath. */
+        uint32_t mod_count;         /**< Module count. */
+    } xpath_cache[SR_XPATH_CACHE_SIZE]; /**< Required modules of recently used XPaths, most recently used first,
+                                             valid only for the current context. */
+    pthread_mutex_t xpath_cache_lock;   /**< Session-shared lock for accessing xpath_cache. */
+
+    struct sr_rpc_dep_cache_s {
+        char *path;                 /**< Cached RPC/action path, NULL if the entry is unused. */
+        int output;                 /**< Whether the dependencies are of the output or the input. */
+        struct sr_rpc_dep_mod_s {
+            const struct lys_module *ly_mod;    /**< Module with the data required for validation. */
+            char *xpath;            /**< XPath selecting the required data. */
+        } *deps;                    /**< Leafref and XPath dependencies, independent of the operation data. */
+        uint32_t dep_count;         /**< Count of @p deps. */
+        int instid;                 /**< Whether there are also instance-identifier dependencies to evaluate
+                                         on the operation data. */
+    } rpc_dep_cache[SR_RPC_DEP_CACHE_SIZE]; /**< Validation dependencies of recently used RPCs/actions, most recently
+                                                 used first, valid only for the current context. */
+    pthread_mutex_t rpc_dep_cache_lock; /**< Session-shared lock for accessing rpc_dep_cache. */
+
+    struct lyd_node *yanglib_cache; /**< Generated ietf-yang-library data, valid only for the current context. */
+    pthread_mutex_t yanglib_cache_lock; /**< Session-shared lock for accessing yanglib_cache. */
+
+    struct sr_oper_slots_cache_s {
+        const struct lys_module *ly_mod;    /**< Module of the operational value slots. */
+        sr_shm_t shm;               /**< Mapped operational value slots SHM of the module. */
+    } *oper_slots_cache;            /**< Mapped operational value slots SHM of modules, valid only for the current
+                                         context. */
+    uint32_t oper_slots_cache_count;    /**< Count of oper_slots_cache. */
+    pthread_mutex_t oper_slots_cache_lock;  /**< Session-shared lock for accessing oper_slots_cache. */
+
+    struct sr_value_constr_cache_s {
+        const struct lys_module *ly_mod;    /**< Module whose schema was traversed. */
+        int found;                  /**< Whether the module has any constraints depending on other data values. */
+    } *value_constr_cache;          /**< Value-dependent constraints of modules, valid only for the current context. */
+    uint32_t value_constr_cache_count;  /**< Count of value_constr_cache. */
+    pthread_mutex_t value_constr_cache_lock;    /**< Session-shared lock for accessing value_constr_cache. */
+
+    pthread_mutex_t commit_group_lock;  /**< Session-shared lock for accessing the group commit members. */
+    sr_cond_t commit_group_cond;    /**< Condition signalled when the group commit members have been applied. */
+    struct sr_commit_group_s {
+        sr_session_ctx_t *session;  /**< Member session with the edit to apply. */
+        int taken;                  /**< Set by the leader once it started applying the group, the member must
+                                         then wait until it is done. */
+        int done;                   /**< Set by the leader once the group was applied. */
+        int fallback;               /**< Set by the leader if the group failed and the member must apply alone. */
+        sr_error_info_t *err_info;  /**< Set by the leader if the group failed after notifying subscribers. */
+        struct sr_commit_group_s *next; /**< Next member. */
+    } *commit_group;                /**< Members joined to the group being collected by the leader. */
+    int commit_group_leader;        /**< Whether there is a leader collecting a group commit. */
+    uint32_t commit_group_applying; /**< Number of sessions applying changes using the group commit. */
+    sr_datastore_t commit_group_ds; /**< Datastore of the group being collected. */
+
+    pthread_t *load_workers;        /**< Worker threads executing load jobs, started on demand. */
+    uint32_t load_worker_count;     /**< Load worker thread count. */
+    sr_rwlock_t load_lock;          /**< Lock for accessing load_batches and load_running (READ-lock is not used). */
+    struct sr_load_batch_s *load_batches;   /**< Queue of load job batches with jobs not yet started. */
+    int load_running;               /**< Flag whether the load worker threads should keep running. */
+
+    pthread_mutex_t lazy_lock;      /**< Session-shared lock for accessing lazy_mods. */
+    char **lazy_mods;               /**< Modules required in the context of a ::SR_CONN_CTX_LAZY connection. */
+    uint32_t lazy_mod_count;        /**< Count of lazy_mods. */
+    ATOMIC_T lazy_pending;          /**< Set if some lazy_mods are not loaded in the context yet. */
+
+    uint64_t mem_limit[SR_CONN_MEM_COUNT];  /**< Memory limits of the caches (B), 0 for no limit. */
+    ATOMIC64_T cache_tick;          /**< Counter of cache uses ordering the cached data from the least recently used. */
+    struct sr_cache_counters_s {
+        ATOMIC64_T hits;            /**< Number of cache hits. */
+        ATOMIC64_T misses;          /**< Number of cache misses. */
+        ATOMIC64_T evictions;       /**< Number of evicted cache entries. */
+    } cache_stats[SR_CONN_MEM_OPER_CACHE + 1];  /**< Usage statistics of the caches, indexed by ::sr_conn_mem_t. */
 };
 
 /**
@@ -185,6 +377,10 @@ struct sr_session_ctx_s {
     struct {
         char *orig_name;            /**< Set originator name by the event originator. */
         void *orig_data;            /**< Set originator data by the event originator. */
+        const char *diff_shm;       /**< Mapped shared diff segment of a change event if the diffs of other modules
+                                         than @p diff_mod were not parsed yet. */
+        const char *diff_mod;       /**< Module of a change event whose diff was parsed. */
+        uint32_t oper_max_depth;    /**< Maximum depth of the data requested by an operational get event. */
     } ev_data;                      /**< Event data from the originator. Valid only if ev is not ::SR_SUB_EV_NONE. */
     sr_error_info_t *ev_err_info;   /**< Event error info for the originator. */
 
@@ -209,6 +405,14 @@ struct sr_session_ctx_s {
         } *first;                   /**< First stored notification buffer node. */
         struct sr_sess_notif_buf_node *last;    /**< Last stored notification buffer node. */
     } notif_buf;                    /**< Notification buffering attributes. */
+
+    struct {
+        int enabled;                /**< Whether the phases of requests are timed. */
+        uint32_t slow_ms;           /**< Requests taking longer are logged, 0 for none. */
+        uint32_t total_us;          /**< Total duration of the last timed request. */
+        uint32_t phase_us[SR_PHASE_COUNT];  /**< Durations of the phases of the last timed request. */
+    } timing;                       /**< Request phase timing. */
+    int async_done;                 /**< Whether the "done" events of the applied changes are not waited for. */
 };
 
 /**
@@ -220,6 +424,16 @@ struct sr_subscription_ctx_s {
     int evpipe;                     /**< Event pipe opened for reading. */
     ATOMIC_T thread_running;        /**< Flag whether the thread handling this subscription is running. */
     pthread_t tid;                  /**< Thread ID of the handler thread. */
+
+    struct sr_subscr_worker_s {
+        struct sr_subscription_ctx_s *subscr;   /**< Subscription structure of the worker. */
+        uint32_t idx;               /**< Worker index, selects the module subscriptions handled by the worker. */
+        pthread_t tid;              /**< Thread ID of the worker thread. */
+    } *workers;                     /**< Worker threads handling change, oper get, and RPC events, if used. */
+    uint32_t worker_count;          /**< Worker thread count. */
+    sr_rwlock_t worker_lock;        /**< Lock for accessing worker_gen and worker_running (READ-lock is not used). */
+    uint32_t worker_gen;            /**< Event generation, incremented whenever there may be new events. */
+    int worker_running;             /**< Flag whether the worker threads should keep running. */
     sr_rwlock_t subs_lock;          /**< Session-shared lock for accessing the subscriptions. */
     uint32_t last_sub_id;           /**< Subscription ID of the last created subscription. */
 
@@ -243,6 +457,8 @@ struct sr_subscription_ctx_s {
         uint32_t sub_count;         /**< Configuration change module XPath subscription count. */
 
         sr_shm_t sub_shm;           /**< Subscription SHM. */
+        sr_shm_t data_shm;          /**< Subscription data SHM, kept mapped between events. */
+        uint32_t data_gen;          /**< Subscription data SHM size generation of the mapping. */
     } *change_subs;                 /**< Change subscriptions for each module. */
     uint32_t change_sub_count;      /**< Change module subscription count. */
 
@@ -258,6 +474,8 @@ struct sr_subscription_ctx_s {
 
             ATOMIC_T request_id;    /**< Request ID of the last processed request. */
             sr_shm_t sub_shm;       /**< Subscription SHM. */
+            sr_shm_t data_shm;      /**< Subscription data SHM, kept mapped between events. */
+            uint32_t data_gen;      /**< Subscription data SHM size generation of the mapping. */
             ATOMIC_T suspended;     /**< Whether the subscription is suspended. */
         } *subs;                    /**< Operational subscriptions for each XPath. */
         uint32_t sub_count;         /**< Operational module XPath subscription count. */
@@ -283,6 +501,7 @@ struct sr_subscription_ctx_s {
         struct modsub_notifsub_s {
             uint32_t sub_id;        /**< Unique subscription ID. */
             char *xpath;            /**< Subscription XPath. */
+            sr_notif_filter_t *filter;  /**< Compiled subscription XPath, NULL if it could not be compiled. */
             struct timespec listen_since_mono;  /**< Monotonic timestamp of the subscription listening for real-time notifications. */
             struct timespec listen_since_real;  /**< Realtime timestamp of the subscription listening for real-time notifications. */
             struct timespec start_time; /**< Subscription start time. */
@@ -314,24 +533,80 @@ struct sr_subscription_ctx_s {
             void *private_data;     /**< Subscription callback private data. */
             sr_session_ctx_t *sess; /**< Subscription session. */
 
-            ATOMIC_T request_id;    /**< Request ID of the last processed request. */
-            ATOMIC_T event;         /**< Type of the last processed event. */
+            ATOMIC_T request_id[SR_RPC_LANE_COUNT]; /**< Request ID of the last processed request in each lane. */
+            ATOMIC_T event[SR_RPC_LANE_COUNT];  /**< Type of the last processed event in each lane. */
             ATOMIC_T suspended;     /**< Whether the subscription is suspended. */
         } *subs;                    /**< RPC/action subscription for each XPath. */
         uint32_t sub_count;         /**< RPC/action XPath subscription count. */
 
-        sr_shm_t sub_shm;           /**< Subscription SHM. */
+        sr_shm_t sub_shm[SR_RPC_LANE_COUNT];    /**< Subscription SHM of each lane. */
+        sr_shm_t data_shm[SR_RPC_LANE_COUNT];   /**< Subscription data SHM of each lane, kept mapped between events. */
+        uint32_t data_gen[SR_RPC_LANE_COUNT];   /**< Subscription data SHM size generation of each lane mapping. */
     } *rpc_subs;                    /**< RPC/action subscriptions for each operation. */
     uint32_t rpc_sub_count;         /**< RPC/action operation subscription count. */
 };
 
+/**
+ * @brief Incremental builder of standard data node paths, see ::sr_lyd_path_next().
+ */
+struct sr_lyd_path_s {
+    char *buf;                      /**< Path of the last node, with the paths of its ancestors as prefixes. */
+    uint32_t size;                  /**< Allocated size of the buffer. */
+    const struct lyd_node **nodes;  /**< Nodes of the last path, starting with the top-level one. */
+    uint32_t *lens;                 /**< Path length of each of the nodes. */
+    uint32_t count;                 /**< Count of nodes with a valid path in the buffer. */
+    uint32_t alloc;                 /**< Allocated count of nodes and lens. */
+};
+
 /**
  * @brief Change iterator.
  */
 struct sr_change_iter_s {
     struct lyd_node *diff;          /**< Optional copied diff that set items point into. */
-    struct ly_set *set;             /**< Set of all the selected diff nodes. */
-    uint32_t idx;                   /**< Index of the next change. */
+    struct ly_set *set;             /**< Set of all the selected diff nodes or only the roots of selected subtrees. */
+    uint32_t idx;                   /**< Index of the next change (set item). */
+    int subtrees;                   /**< Whether whole subtrees of the set items are selected and walked lazily. */
+    struct lyd_node *dfs_node;      /**< Last node returned from the current subtree, NULL if none yet. */
+    struct sr_lyd_path_s path;      /**< Path builder for the returned changes. */
+};
+
+/**
+ * @brief Operational value slot handle.
+ */
+struct sr_oper_slot_s {
+    sr_shm_t shm;                   /**< Mapped operational value slots SHM of the module. */
+    uint32_t idx;                   /**< Index of the owned slot. */
+    sr_cid_t cid;                   /**< CID of the owner connection. */
+};
+
+/**
+ * @brief Compiled edit template.
+ */
+struct sr_edit_template_s {
+    char *path;                     /**< Template path with the placeholders removed. */
+    uint32_t path_len;              /**< Length of @p path. */
+    uint32_t *arg_pos;              /**< Positions in @p path where the quoted arguments are inserted. */
+    uint32_t arg_count;             /**< Count of placeholders. */
+    char *spath;                    /**< Schema path of the template, with all the predicates removed. */
+
+    const struct ly_ctx *ly_ctx;    /**< Context the schema path is bound to, NULL if not bound. */
+    uint32_t content_id;            /**< Content ID of the context the schema path is bound to. */
+    const struct lysc_node *snode;  /**< Bound schema node of the template path. */
+
+    char *buf[2];                   /**< Alternating buffers for the bound paths, the previous one is still cached. */
+    uint32_t buf_size[2];           /**< Allocated sizes of @p buf. */
+};
+
+/**
+ * @brief Get data iterator.
+ */
+struct sr_get_data_iter_s {
+    sr_session_ctx_t *session;      /**< Session used for getting the data. */
+    int ctx_locked;                 /**< Whether the context is READ locked by the iterator. */
+    struct sr_mod_info_s *mod_info; /**< Mod info with all the loaded data the selected nodes point into. */
+    struct ly_set *set;             /**< Set of all the selected data nodes. */
+    uint32_t max_depth;             /**< Maximum depth of the returned subtrees. */
+    uint32_t idx;                   /**< Index of the next selected node. */
 };
 
 /**
@@ -348,6 +623,16 @@ typedef void (*sr_lock_recover_cb)(sr_lock_mode_t mode, sr_cid_t cid, void *data
  */
 extern const struct srplg_ds_s srpds_json;
 
+/**
+ * @brief Internal DS plugin "LYB DS file".
+ */
+extern const struct srplg_ds_s srpds_lyb;
+
+/**
+ * @brief Internal DS plugin "SHM DS".
+ */
+extern const struct srplg_ds_s srpds_shm;
+
 /**
  * @brief Internal DS plugin "MONGO DS".
  */
@@ -367,4 +652,9 @@ extern const struct srplg_ds_s srpds_redis;
  */
 extern const struct srplg_ntf_s srpntf_json;
 
+/**
+ * @brief Internal notif plugin "LYB notif".
+ */
+extern const struct srplg_ntf_s srpntf_lyb;
+
 #endif /* _COMMON_TYPES_H */
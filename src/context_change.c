@@ -20,6 +20,7 @@
 #include "context_change.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,15 +39,116 @@
 #include "sysrepo.h"
 #include "sysrepo_types.h"
 
+/**
+ * @brief Number of contexts locked by this thread, a context in use cannot be lazily replaced.
+ */
+static _Thread_local uint32_t sr_lycc_lock_depth;
+
+/**
+ * @brief Load modules into a new context of a connection.
+ *
+ * @param[in] conn Connection to use, mod remap WRITE lock must be held.
+ * @param[in] new_ctx New context to load to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lycc_ctx_load_modules(sr_conn_ctx_t *conn, struct ly_ctx *new_ctx)
+{
+    sr_error_info_t *err_info = NULL;
+    char **mods = NULL;
+    uint32_t mod_count;
+
+    if (!(conn->opts & SR_CONN_CTX_LAZY)) {
+        return sr_shmmod_ctx_load_modules(SR_CONN_MOD_SHM(conn), new_ctx, NULL);
+    }
+
+    /* all the required modules are going to be loaded */
+    ATOMIC_STORE_RELAXED(conn->lazy_pending, 0);
+
+    /* LAZY LOCK */
+    if ((err_info = sr_mlock(&conn->lazy_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* copy the required modules */
+    mod_count = conn->lazy_mod_count;
+    if (mod_count) {
+        mods = malloc(mod_count * sizeof *mods);
+        if (mods) {
+            memcpy(mods, conn->lazy_mods, mod_count * sizeof *mods);
+        }
+    }
+
+    /* LAZY UNLOCK */
+    sr_munlock(&conn->lazy_lock);
+
+    SR_CHECK_MEM_RET(mod_count && !mods, err_info);
+
+    /* the module names are freed only with the connection */
+    err_info = sr_shmmod_ctx_load_modules_lazy(SR_CONN_MOD_SHM(conn), new_ctx, mods, mod_count);
+    free(mods);
+    return err_info;
+}
+
+/**
+ * @brief Create a new context of a connection with the current modules.
+ *
+ * @param[in] conn Connection to use, mod remap WRITE lock must be held.
+ * @param[in] printed Whether to store the new context as the printed context shared by the processes.
+ * @param[in] content_id Current content ID.
+ * @param[out] new_ctx Created context.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lycc_ctx_create(sr_conn_ctx_t *conn, int printed, uint32_t content_id, struct ly_ctx **new_ctx)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    char *path;
+
+    if ((err_info = sr_ly_ctx_init(conn, new_ctx))) {
+        return err_info;
+    }
+    if ((err_info = sr_lycc_ctx_load_modules(conn, *new_ctx))) {
+        if (!strcmp(err_info->err[err_info->err_count - 1].message, "Loading \"ietf-datastores\" module failed.")) {
+            if (!(tmp_err = sr_path_yang_dir(&path))) {
+                sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED,
+                        "YANG modules directory \"%s\" is different than the one used when creating the SHM "
+                        "state. Either change the SHM state files prefix, too, or clear the current SHM state.", path);
+                free(path);
+            } else {
+                sr_errinfo_merge(&err_info, tmp_err);
+            }
+        }
+        ly_ctx_destroy(*new_ctx);
+        *new_ctx = NULL;
+        return err_info;
+    }
+
+    /* share the compiled context with the other processes */
+    if (printed && (tmp_err = sr_ly_ctx_printed_store(*new_ctx, content_id))) {
+        SR_LOG_WRN("Failed to store the printed context (%s).", tmp_err->err[tmp_err->err_count - 1].message);
+        sr_errinfo_free(&tmp_err);
+    }
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_lycc_lock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const char *func)
 {
-    sr_error_info_t *err_info = NULL, *tmp_err;
+    sr_error_info_t *err_info = NULL;
     sr_main_shm_t *main_shm = SR_CONN_MAIN_SHM(conn);
     sr_lock_mode_t remap_mode = SR_LOCK_NONE;
     struct sr_shmmod_recover_cb_s cb_data;
     struct ly_ctx *new_ctx = NULL;
-    char *path;
+    int lazy_only, parsed, printed;
+    uint32_t content_id;
+
+    if (lydmods_lock && (conn->opts & SR_CONN_CTX_LAZY)) {
+        sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, "Modules cannot be changed using a connection with "
+                "a lazily loaded context.");
+        return err_info;
+    }
 
     /* fill the cb_data for recovery */
     cb_data.ly_ctx_p = &conn->ly_ctx;
@@ -68,8 +170,15 @@ sr_lycc_lock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const c
     }
     remap_mode = SR_LOCK_READ;
 
-    /* check whether the context is current and does not need to be updated */
-    if (main_shm->content_id != conn->content_id) {
+    /* check whether the context is current and does not need to be updated, changing modules needs parsed modules,
+     * pairs with the release store of the content ID publishing the new context content */
+    content_id = ATOMIC_LOAD_ACQUIRE(main_shm->content_id);
+    lazy_only = (content_id == conn->content_id);
+    parsed = lydmods_lock && sr_ly_ctx_is_printed(conn->ly_ctx);
+    if (lazy_only && ATOMIC_LOAD_RELAXED(conn->lazy_pending) && sr_lycc_lock_depth) {
+        /* the context is in use by this thread, load the required modules only once it is not */
+        SR_LOG_DBG("Context in use, loading the lazily required modules postponed.");
+    } else if (!lazy_only || ATOMIC_LOAD_RELAXED(conn->lazy_pending) || parsed) {
         /* MOD REMAP UNLOCK */
         sr_rwunlock(&conn->mod_remap_lock, SR_CONN_REMAP_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, func);
         remap_mode = SR_LOCK_NONE;
@@ -81,36 +190,32 @@ sr_lycc_lock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const c
         }
         remap_mode = SR_LOCK_WRITE;
 
-        /* remap mod SHM */
-        if ((err_info = sr_shm_remap(&conn->mod_shm, 0))) {
-            goto cleanup_unlock;
-        }
+        /* another thread of this connection may have switched to the latest context while we were waiting */
+        if ((content_id != conn->content_id) || ATOMIC_LOAD_RELAXED(conn->lazy_pending) ||
+                (lydmods_lock && sr_ly_ctx_is_printed(conn->ly_ctx))) {
+            /* remap mod SHM */
+            if ((err_info = sr_shm_remap(&conn->mod_shm, 0))) {
+                goto cleanup_unlock;
+            }
 
-        /* context was updated, create a new one with the current modules */
-        if ((err_info = sr_ly_ctx_init(conn, &new_ctx))) {
-            goto cleanup_unlock;
-        }
-        if ((err_info = sr_shmmod_ctx_load_modules(SR_CONN_MOD_SHM(conn), new_ctx, NULL))) {
-            if (!strcmp(err_info->err[err_info->err_count - 1].message, "Loading \"ietf-datastores\" module failed.")) {
-                if (!(tmp_err = sr_path_yang_dir(&path))) {
-                    sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED,
-                            "YANG modules directory \"%s\" is different than the one used when creating the SHM state. "
-                            "Either change the SHM state files prefix, too, or clear the current SHM state.",
-                            path);
-                    free(path);
-                } else {
-                    sr_errinfo_merge(&err_info, tmp_err);
-                }
+            /* a printed context with all the current modules is shared by the processes, if available */
+            printed = !lydmods_lock && !(conn->opts & (SR_CONN_CTX_LAZY | SR_CONN_CTX_SET_PRIV_PARSED));
+            if (printed && (err_info = sr_ly_ctx_printed_load(conn, content_id, &new_ctx))) {
+                goto cleanup_unlock;
             }
-            goto cleanup_unlock;
-        }
 
-        /* use the new context */
-        sr_conn_ctx_switch(conn, &new_ctx, NULL);
+            /* context was updated, create a new one with the current modules */
+            if (!new_ctx && (err_info = sr_lycc_ctx_create(conn, printed, content_id, &new_ctx))) {
+                goto cleanup_unlock;
+            }
 
-        /* initialize new DS plugins */
-        if ((err_info = sr_conn_ds_init(conn))) {
-            goto cleanup_unlock;
+            /* use the new context */
+            sr_conn_ctx_switch(conn, &new_ctx, NULL);
+
+            /* initialize new DS plugins */
+            if ((err_info = sr_conn_ds_init(conn))) {
+                goto cleanup_unlock;
+            }
         }
 
         /* MOD REMAP DOWNGRADE */
@@ -126,8 +231,10 @@ sr_lycc_lock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const c
         goto cleanup_unlock;
     }
 
+    ++sr_lycc_lock_depth;
+
 cleanup_unlock:
-    ly_ctx_destroy(new_ctx);
+    sr_ly_ctx_destroy(new_ctx);
     if (err_info) {
         if (remap_mode) {
             /* MOD REMAP UNLOCK */
@@ -154,7 +261,7 @@ sr_lycc_relock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, const char *func)
             sr_shmmod_recover_cb, &cb_data))) {
         return err_info;
     }
-    assert(main_shm->content_id == conn->content_id);
+    assert(ATOMIC_LOAD_RELAXED(main_shm->content_id) == conn->content_id);
 
     return NULL;
 }
@@ -178,6 +285,122 @@ sr_lycc_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const
 
     /* CONTEXT UNLOCK */
     sr_rwunlock(&main_shm->context_lock, SR_CONTEXT_LOCK_TIMEOUT, mode, conn->cid, func);
+
+    if (sr_lycc_lock_depth) {
+        /* the context may have been locked by another thread */
+        --sr_lycc_lock_depth;
+    }
+}
+
+/**
+ * @brief Require a module to be loaded in the lazy context of a connection.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] name Module name, not necessarily terminated.
+ * @param[in] name_len Length of @p name.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lycc_lazy_require_module(sr_conn_ctx_t *conn, const char *name, uint32_t name_len)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    char *mod_name = NULL;
+    void *mem;
+    uint32_t i;
+
+    mod_name = strndup(name, name_len);
+    SR_CHECK_MEM_RET(!mod_name, err_info);
+
+    /* MOD REMAP LOCK */
+    if ((err_info = sr_rwlock(&conn->mod_remap_lock, SR_CONN_REMAP_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__,
+            NULL, NULL))) {
+        free(mod_name);
+        return err_info;
+    }
+
+    /* LAZY LOCK */
+    if ((err_info = sr_mlock(&conn->lazy_lock, -1, __func__, NULL, NULL))) {
+        goto cleanup_remap_unlock;
+    }
+
+    for (i = 0; i < conn->lazy_mod_count; ++i) {
+        if (!strcmp(conn->lazy_mods[i], mod_name)) {
+            /* already required */
+            goto cleanup_unlock;
+        }
+    }
+
+    if (!sr_shmmod_find_module(SR_CONN_MOD_SHM(conn), mod_name)) {
+        /* not an installed module, nothing to load */
+        goto cleanup_unlock;
+    }
+
+    /* remember it for every new context */
+    mem = realloc(conn->lazy_mods, (conn->lazy_mod_count + 1) * sizeof *conn->lazy_mods);
+    SR_CHECK_MEM_GOTO(!mem, err_info, cleanup_unlock);
+    conn->lazy_mods = mem;
+    conn->lazy_mods[conn->lazy_mod_count++] = mod_name;
+
+    ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, mod_name);
+    mod_name = NULL;
+    if (!ly_mod) {
+        /* the context needs to be created again */
+        ATOMIC_STORE_RELAXED(conn->lazy_pending, 1);
+    }
+
+cleanup_unlock:
+    /* LAZY UNLOCK */
+    sr_munlock(&conn->lazy_lock);
+
+cleanup_remap_unlock:
+    /* MOD REMAP UNLOCK */
+    sr_rwunlock(&conn->mod_remap_lock, SR_CONN_REMAP_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+    free(mod_name);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_lycc_lazy_require(sr_conn_ctx_t *conn, const char *mod_name, const char *path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *ptr, *start;
+
+    if (!(conn->opts & SR_CONN_CTX_LAZY)) {
+        return NULL;
+    }
+
+    if (mod_name && (err_info = sr_lycc_lazy_require_module(conn, mod_name, strlen(mod_name)))) {
+        return err_info;
+    }
+
+    /* require the modules of all the prefixes */
+    for (ptr = path; ptr && *ptr; ++ptr) {
+        if ((*ptr == '\'') || (*ptr == '\"')) {
+            /* skip literals */
+            if (!(ptr = strchr(ptr + 1, *ptr))) {
+                break;
+            }
+            continue;
+        }
+
+        if ((*ptr != ':') || (ptr[1] == ':') || ((ptr > path) && (ptr[-1] == ':'))) {
+            /* not a prefix, or an axis */
+            continue;
+        }
+
+        start = ptr;
+        while ((start > path) && (isalnum(start[-1]) || strchr("_-.", start[-1]))) {
+            --start;
+        }
+        if ((start < ptr) && (isalpha(start[0]) || (start[0] == '_')) &&
+                (err_info = sr_lycc_lazy_require_module(conn, start, ptr - start))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
 }
 
 sr_error_info_t *
@@ -468,6 +691,9 @@ sr_lycc_del_module(sr_conn_ctx_t *conn, const struct ly_ctx *ly_ctx, const struc
         if ((err_info = sr_remove_module_yang_r(ly_mod, ly_ctx, &del_set))) {
             goto cleanup;
         }
+
+        /* remove operational value slots */
+        sr_remove_oper_slots(ly_mod->name);
     }
 
 cleanup:
@@ -535,6 +761,9 @@ sr_lycc_upd_modules(const struct ly_set *old_mod_set, const struct ly_set *upd_m
         if ((err_info = sr_store_module_yang_r(upd_mod))) {
             goto cleanup;
         }
+
+        /* remove operational value slots, the leaves may have changed */
+        sr_remove_oper_slots(old_mod->name);
     }
 
 cleanup:
@@ -642,6 +871,10 @@ sr_lycc_append_data(sr_conn_ctx_t *conn, const struct ly_ctx *ctx, struct sr_dat
         /* find running plugin and append data, if not disabled */
         ds = SR_DS_RUNNING;
         if (shm_mod->plugins[ds]) {
+            /* running data are read directly, copy them from startup if still inherited */
+            if ((err_info = sr_shmmod_run_inherit_copy(conn, ly_mod, shm_mod, 0, 0))) {
+                goto cleanup;
+            }
             if ((err_info = sr_ds_handle_find(conn->mod_shm.addr + shm_mod->plugins[ds], conn, &ds_handle[ds]))) {
                 goto cleanup;
             }
@@ -673,33 +906,209 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Check whether a module in a new context is the same revision with the same features as in the old one.
+ *
+ * @param[in] old_mod Module in the old context.
+ * @param[in] new_mod Module in the new context, may be NULL.
+ * @return Whether the modules are the same.
+ */
+static int
+sr_lycc_module_is_same(const struct lys_module *old_mod, const struct lys_module *new_mod)
+{
+    struct lysp_feature *f = NULL;
+    uint32_t idx = 0;
+    LY_ERR lyrc;
+
+    if (!new_mod || (old_mod->implemented != new_mod->implemented) || (!old_mod->revision != !new_mod->revision) ||
+            (old_mod->revision && strcmp(old_mod->revision, new_mod->revision))) {
+        return 0;
+    }
+
+    while ((f = lysp_feature_next(f, old_mod->parsed, &idx))) {
+        lyrc = lys_feature_value(new_mod, f->name);
+        if ((f->flags & LYS_FENABLED) ? (lyrc != LY_SUCCESS) : (lyrc != LY_ENOT)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether data of a module can be duplicated into a new context without reparsing them
+ * because its schema, including augments, deviations, and imported types, did not change.
+ *
+ * @param[in] old_mod Data module in the old context.
+ * @param[in] new_ctx New context.
+ * @return Whether the data are compatible.
+ */
+static int
+sr_lycc_module_data_is_compatible(const struct lys_module *old_mod, const struct ly_ctx *new_ctx)
+{
+    const struct lys_module *new_mod, *mod;
+    const struct lysp_submodule *old_submod, *new_submod;
+    LY_ARRAY_COUNT_TYPE u;
+
+    new_mod = ly_ctx_get_module_implemented(new_ctx, old_mod->name);
+    if (!sr_lycc_module_is_same(old_mod, new_mod)) {
+        return 0;
+    }
+
+    /* submodules */
+    LY_ARRAY_FOR(old_mod->parsed->includes, u) {
+        old_submod = old_mod->parsed->includes[u].submodule;
+        new_submod = ly_ctx_get_submodule2(new_mod, old_submod->name);
+        if (!new_submod || (!old_submod->revs != !new_submod->revs) ||
+                (old_submod->revs && strcmp(old_submod->revs[0].date, new_submod->revs[0].date))) {
+            return 0;
+        }
+    }
+
+    /* augments and deviations */
+    if ((LY_ARRAY_COUNT(old_mod->augmented_by) != LY_ARRAY_COUNT(new_mod->augmented_by)) ||
+            (LY_ARRAY_COUNT(old_mod->deviated_by) != LY_ARRAY_COUNT(new_mod->deviated_by))) {
+        return 0;
+    }
+    LY_ARRAY_FOR(old_mod->augmented_by, u) {
+        mod = old_mod->augmented_by[u];
+        if (!sr_lycc_module_is_same(mod, ly_ctx_get_module_implemented(new_ctx, mod->name))) {
+            return 0;
+        }
+    }
+    LY_ARRAY_FOR(old_mod->deviated_by, u) {
+        mod = old_mod->deviated_by[u];
+        if (!sr_lycc_module_is_same(mod, ly_ctx_get_module_implemented(new_ctx, mod->name))) {
+            return 0;
+        }
+    }
+
+    /* imports with typedefs and identities */
+    LY_ARRAY_FOR(old_mod->parsed->imports, u) {
+        mod = old_mod->parsed->imports[u].module;
+        if (!sr_lycc_module_is_same(mod, ly_ctx_get_module(new_ctx, mod->name, mod->revision))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Duplicate data of modules compatible with a new context into it and copy the remaining data
+ * to be reparsed.
+ *
+ * @param[in] old_data Old data to update.
+ * @param[in] new_ctx New context to use.
+ * @param[out] dup_data Data of the compatible modules in @p new_ctx.
+ * @param[out] reparse_data Data of the other modules in the old context.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lycc_update_data_split(const struct lyd_node *old_data, const struct ly_ctx *new_ctx, struct lyd_node **dup_data,
+        struct lyd_node **reparse_data)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *node;
+    const struct lys_module *ly_mod, *last_mod = NULL;
+    struct lyd_node *dup, **data;
+    int compat = 0;
+
+    *dup_data = NULL;
+    *reparse_data = NULL;
+
+    LY_LIST_FOR(old_data, node) {
+        /* the data are usually grouped by modules */
+        ly_mod = node->schema ? node->schema->module : NULL;
+        if (ly_mod != last_mod) {
+            last_mod = ly_mod;
+            compat = ly_mod ? sr_lycc_module_data_is_compatible(ly_mod, new_ctx) : 0;
+        }
+
+        if (compat) {
+            err_info = sr_lyd_dup_to_ctx(node, new_ctx, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 0, &dup);
+            data = dup_data;
+        } else {
+            err_info = sr_lyd_dup(node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 0, &dup);
+            data = reparse_data;
+        }
+        if (err_info) {
+            goto cleanup;
+        }
+
+        if (!(*data)) {
+            *data = dup;
+        } else if ((err_info = sr_lyd_insert_sibling(*data, dup, data))) {
+            lyd_free_tree(dup);
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (err_info) {
+        lyd_free_siblings(*dup_data);
+        *dup_data = NULL;
+        lyd_free_siblings(*reparse_data);
+        *reparse_data = NULL;
+    }
+    return err_info;
+}
+
 /**
  * @brief Update data parsed with old context to be parsed with a new context.
  *
  * @param[in] old_data Old data to update.
  * @param[in] parse_opts Parse options to use for parsing back @p old_data.
+ * @param[in] incremental Whether all the schema nodes of @p old_data are unchanged in @p new_ctx so the data
+ * can be directly duplicated into it.
  * @param[in] new_ctx New context to use.
  * @param[in,out] append_data Optional data to append, are spent.
  * @param[out] new_data Data tree in @p new_ctx with optional @p append_data.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_lycc_update_data_tree(const struct lyd_node *old_data, uint32_t parse_opts, const struct ly_ctx *new_ctx,
-        struct lyd_node **append_data, struct lyd_node **new_data)
+sr_lycc_update_data_tree(const struct lyd_node *old_data, uint32_t parse_opts, int incremental,
+        const struct ly_ctx *new_ctx, struct lyd_node **append_data, struct lyd_node **new_data)
 {
     sr_error_info_t *err_info = NULL;
+    struct lyd_node *dup_data = NULL, *reparse_data = NULL;
     char *data_json = NULL;
 
     *new_data = NULL;
 
-    /* print the data of all the modules into JSON */
-    if ((err_info = sr_lyd_print_data(old_data, LYD_JSON, LYD_PRINT_SHRINK, -1, &data_json, NULL))) {
-        goto cleanup;
-    }
+    if (incremental) {
+        /* no need to print and parse the data, they are valid in the new context as they are */
+        if (old_data && (err_info = sr_lyd_dup_to_ctx(old_data, new_ctx, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 1,
+                new_data))) {
+            goto cleanup;
+        }
+    } else {
+        /* duplicate data of unchanged modules directly */
+        if ((err_info = sr_lycc_update_data_split(old_data, new_ctx, &dup_data, &reparse_data))) {
+            goto cleanup;
+        }
 
-    /* try to load it into the new updated context skipping any unknown nodes */
-    if ((err_info = sr_lyd_parse_data(new_ctx, data_json, NULL, LYD_JSON, parse_opts, 0, new_data))) {
-        goto cleanup;
+        if (reparse_data) {
+            /* print the data of all the changed modules into JSON */
+            if ((err_info = sr_lyd_print_data(reparse_data, LYD_JSON, LYD_PRINT_SHRINK, -1, &data_json, NULL))) {
+                goto cleanup;
+            }
+
+            /* try to load it into the new updated context skipping any unknown nodes */
+            if ((err_info = sr_lyd_parse_data(new_ctx, data_json, NULL, LYD_JSON, parse_opts, 0, new_data))) {
+                goto cleanup;
+            }
+        }
+
+        if (dup_data) {
+            /* link the duplicated data */
+            if (!(*new_data)) {
+                *new_data = dup_data;
+            } else if ((err_info = sr_lyd_insert_sibling(*new_data, dup_data, new_data))) {
+                goto cleanup;
+            }
+            dup_data = NULL;
+        }
     }
 
     if (append_data && *append_data) {
@@ -713,6 +1122,8 @@ sr_lycc_update_data_tree(const struct lyd_node *old_data, uint32_t parse_opts, c
     }
 
 cleanup:
+    lyd_free_siblings(dup_data);
+    lyd_free_siblings(reparse_data);
     free(data_json);
     return err_info;
 }
@@ -730,12 +1141,22 @@ sr_lycc_update_oper_data_tree(const struct lyd_node *old_data, const struct ly_c
 {
     sr_error_info_t *err_info = NULL;
     char *data_json = NULL;
-    struct lyd_node *root, *node, *to_free;
+    struct lyd_node *root, *node, *to_free, *dup_data = NULL, *reparse_data = NULL;
 
     *new_data = NULL;
 
-    /* print the data of all the modules into JSON */
-    if ((err_info = sr_lyd_print_data(old_data, LYD_JSON, LYD_PRINT_SHRINK, -1, &data_json, NULL))) {
+    /* duplicate data of unchanged modules directly */
+    if ((err_info = sr_lycc_update_data_split(old_data, new_ctx, &dup_data, &reparse_data))) {
+        goto cleanup;
+    }
+
+    if (!reparse_data) {
+        /* no data to reparse */
+        goto cleanup;
+    }
+
+    /* print the data of all the changed modules into JSON */
+    if ((err_info = sr_lyd_print_data(reparse_data, LYD_JSON, LYD_PRINT_SHRINK, -1, &data_json, NULL))) {
         goto cleanup;
     }
 
@@ -774,6 +1195,17 @@ sr_lycc_update_oper_data_tree(const struct lyd_node *old_data, const struct ly_c
     lyd_free_tree(to_free);
 
 cleanup:
+    if (!err_info && dup_data) {
+        /* link the duplicated data */
+        if (!(*new_data)) {
+            *new_data = dup_data;
+            dup_data = NULL;
+        } else if (!(err_info = sr_lyd_insert_sibling(*new_data, dup_data, new_data))) {
+            dup_data = NULL;
+        }
+    }
+    lyd_free_siblings(dup_data);
+    lyd_free_siblings(reparse_data);
     free(data_json);
     return err_info;
 }
@@ -845,6 +1277,54 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Check whether a context change only adds new modules and all the existing ones are unchanged.
+ *
+ * @param[in] conn Connection with the current context.
+ * @param[in] new_ctx New context.
+ * @param[in] new_mods Array of new modules.
+ * @param[in] new_mod_count Count of @p new_mods.
+ * @return Whether the data of the existing modules can be kept as they are.
+ */
+static int
+sr_lycc_update_data_is_incremental(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, sr_int_install_mod_t *new_mods,
+        uint32_t new_mod_count)
+{
+    const struct lys_module *old_ly_mod, *new_ly_mod;
+    uint32_t i, idx = 0;
+
+    if (!new_mod_count) {
+        return 0;
+    }
+
+    for (i = 0; i < new_mod_count; ++i) {
+        if (new_mods[i].enable_features) {
+            /* existing module changed */
+            return 0;
+        }
+    }
+
+    while ((old_ly_mod = ly_ctx_get_module_iter(conn->ly_ctx, &idx))) {
+        if (!old_ly_mod->implemented) {
+            continue;
+        }
+
+        new_ly_mod = ly_ctx_get_module_implemented(new_ctx, old_ly_mod->name);
+        if (!new_ly_mod || (!old_ly_mod->revision != !new_ly_mod->revision) ||
+                (old_ly_mod->revision && strcmp(old_ly_mod->revision, new_ly_mod->revision))) {
+            return 0;
+        }
+
+        /* new modules must not augment or deviate the existing ones */
+        if ((LY_ARRAY_COUNT(old_ly_mod->augmented_by) != LY_ARRAY_COUNT(new_ly_mod->augmented_by)) ||
+                (LY_ARRAY_COUNT(old_ly_mod->deviated_by) != LY_ARRAY_COUNT(new_ly_mod->deviated_by))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 /**
  * @brief Check whether a module DS is enabled when updating its data.
  *
@@ -884,6 +1364,53 @@ sr_lycc_update_data_is_enabled(sr_conn_ctx_t *conn, const struct lys_module *ly_
     }
 }
 
+/**
+ * @brief Validate only the data of modules that are not implemented in the current context.
+ *
+ * @param[in] conn Connection with the current context.
+ * @param[in] new_ctx New context.
+ * @param[in] ds Datastore of @p data.
+ * @param[in] new_mods Array of new modules.
+ * @param[in] new_mod_count Count of @p new_mods.
+ * @param[in,out] data Data tree in @p new_ctx to validate.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lycc_update_data_validate_new(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, sr_datastore_t ds,
+        sr_int_install_mod_t *new_mods, uint32_t new_mod_count, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    uint32_t idx = 0;
+
+    /* validate the new modules first so that all their default values are created */
+    while ((ly_mod = ly_ctx_get_module_iter(new_ctx, &idx))) {
+        if (!ly_mod->implemented || ly_ctx_get_module_implemented(conn->ly_ctx, ly_mod->name) ||
+                !sr_lycc_update_data_is_enabled(conn, ly_mod, ds, new_mods, new_mod_count)) {
+            continue;
+        }
+
+        if ((err_info = sr_lyd_validate_module(data, ly_mod, LYD_VALIDATE_NO_STATE | LYD_VALIDATE_NOT_FINAL, NULL))) {
+            return err_info;
+        }
+    }
+
+    /* then finish the validation that may reference their data */
+    idx = 0;
+    while ((ly_mod = ly_ctx_get_module_iter(new_ctx, &idx))) {
+        if (!ly_mod->implemented || ly_ctx_get_module_implemented(conn->ly_ctx, ly_mod->name) ||
+                !sr_lycc_update_data_is_enabled(conn, ly_mod, ds, new_mods, new_mod_count)) {
+            continue;
+        }
+
+        if ((err_info = sr_lyd_validate_module_final(*data, ly_mod, LYD_VALIDATE_NO_STATE))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_lycc_update_data(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, struct lyd_node *init_data,
         sr_int_install_mod_t *new_mods, uint32_t new_mod_count, struct sr_data_update_s *data_info)
@@ -895,6 +1422,9 @@ sr_lycc_update_data(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, struct ly
 
     memset(data_info, 0, sizeof *data_info);
 
+    /* learn whether only new modules are being added */
+    data_info->incremental = sr_lycc_update_data_is_incremental(conn, new_ctx, new_mods, new_mod_count);
+
     /* parse all the startup/running/operational/factory-default data using the old context (that must succeed) */
     if ((err_info = sr_lycc_append_data(conn, conn->ly_ctx, &data_info->old))) {
         goto cleanup;
@@ -927,16 +1457,43 @@ sr_lycc_update_data(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, struct ly
 
     /* update data for the new context */
     parse_opts = LYD_PARSE_NO_STATE | LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED;
-    if ((err_info = sr_lycc_update_data_tree(data_info->old.start, parse_opts, new_ctx, &start_init_data, &data_info->new.start))) {
+    if ((err_info = sr_lycc_update_data_tree(data_info->old.start, parse_opts, data_info->incremental, new_ctx,
+            &start_init_data, &data_info->new.start))) {
         goto cleanup;
     }
-    if ((err_info = sr_lycc_update_data_tree(data_info->old.run, parse_opts, new_ctx, &run_init_data, &data_info->new.run))) {
+    if ((err_info = sr_lycc_update_data_tree(data_info->old.run, parse_opts, data_info->incremental, new_ctx,
+            &run_init_data, &data_info->new.run))) {
         goto cleanup;
     }
-    if ((err_info = sr_lycc_update_data_tree(data_info->old.fdflt, parse_opts, new_ctx, &fdflt_init_data, &data_info->new.fdflt))) {
+    if ((err_info = sr_lycc_update_data_tree(data_info->old.fdflt, parse_opts, data_info->incremental, new_ctx,
+            &fdflt_init_data, &data_info->new.fdflt))) {
         goto cleanup;
     }
-    if ((err_info = sr_lycc_update_oper_data_tree(data_info->old.oper, new_ctx, &data_info->new.oper))) {
+    if (data_info->incremental) {
+        if ((err_info = sr_lycc_update_data_tree(data_info->old.oper, 0, 1, new_ctx, NULL, &data_info->new.oper))) {
+            goto cleanup;
+        }
+    } else if ((err_info = sr_lycc_update_oper_data_tree(data_info->old.oper, new_ctx, &data_info->new.oper))) {
+        goto cleanup;
+    }
+
+    if (data_info->incremental) {
+        /* the existing data stay valid, only the data of the new modules need to be validated */
+        if ((err_info = sr_lycc_update_data_validate_new(conn, new_ctx, SR_DS_STARTUP, new_mods, new_mod_count,
+                &data_info->new.start))) {
+            sr_errinfo_new(&err_info, SR_ERR_VALIDATION_FAILED, "Invalid startup datastore data.");
+            goto cleanup;
+        }
+        if ((err_info = sr_lycc_update_data_validate_new(conn, new_ctx, SR_DS_RUNNING, new_mods, new_mod_count,
+                &data_info->new.run))) {
+            sr_errinfo_new(&err_info, SR_ERR_VALIDATION_FAILED, "Invalid running datastore data.");
+            goto cleanup;
+        }
+        if ((err_info = sr_lycc_update_data_validate_new(conn, new_ctx, SR_DS_FACTORY_DEFAULT, new_mods, new_mod_count,
+                &data_info->new.fdflt))) {
+            sr_errinfo_new(&err_info, SR_ERR_VALIDATION_FAILED, "Invalid factory-default datastore data.");
+            goto cleanup;
+        }
         goto cleanup;
     }
 
@@ -991,13 +1548,14 @@ cleanup:
  * @param[in] new_ctx New context to iterate over.
  * @param[in] ds Affected datastore.
  * @param[in] sr_mods SR internal module data.
+ * @param[in] incremental Whether the data of the existing modules are known to be unchanged.
  * @param[in,out] old_data Previous (current) data, are freed for each module.
  * @param[in,out] new_data New data, are freed for each module.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_lycc_store_data_ds_if_differ(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx, sr_datastore_t ds,
-        const struct lyd_node *sr_mods, struct lyd_node **old_data, struct lyd_node **new_data)
+        const struct lyd_node *sr_mods, int incremental, struct lyd_node **old_data, struct lyd_node **new_data)
 {
     sr_error_info_t *err_info = NULL;
     const struct lys_module *new_ly_mod, *old_ly_mod;
@@ -1014,7 +1572,10 @@ sr_lycc_store_data_ds_if_differ(sr_conn_ctx_t *conn, const struct ly_ctx *new_ct
         }
 
         old_ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, new_ly_mod->name);
-        if (old_ly_mod && !sr_module_has_data(old_ly_mod, 0) && !sr_module_has_data(new_ly_mod, 0)) {
+        if (old_ly_mod && incremental) {
+            /* existing module with the same schema and data, nothing to store */
+            continue;
+        } else if (old_ly_mod && !sr_module_has_data(old_ly_mod, 0) && !sr_module_has_data(new_ly_mod, 0)) {
             /* neither of the modules have configuration data so they cannot be changed */
             continue;
         }
@@ -1061,6 +1622,9 @@ sr_lycc_store_data_ds_if_differ(sr_conn_ctx_t *conn, const struct ly_ctx *new_ct
             diff = 1;
         } else if (mod_diff) {
             diff = 1;
+        } else if ((ds_handle->plugin == &srpds_lyb) || (ds_handle->plugin == &srpds_shm)) {
+            /* LYB data are printed for specific revisions of the modules */
+            diff = 1;
         }
         ly_temp_log_options(NULL);
 
@@ -1085,26 +1649,26 @@ sr_lycc_store_data_if_differ(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx,
     sr_error_info_t *err_info = NULL;
 
     /* startup */
-    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_STARTUP, sr_mods, &data_info->old.start,
-            &data_info->new.start))) {
+    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_STARTUP, sr_mods, data_info->incremental,
+            &data_info->old.start, &data_info->new.start))) {
         return err_info;
     }
 
     /* running */
-    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_RUNNING, sr_mods, &data_info->old.run,
-            &data_info->new.run))) {
+    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_RUNNING, sr_mods, data_info->incremental,
+            &data_info->old.run, &data_info->new.run))) {
         return err_info;
     }
 
     /* operational */
-    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_OPERATIONAL, sr_mods, &data_info->old.oper,
-            &data_info->new.oper))) {
+    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_OPERATIONAL, sr_mods, data_info->incremental,
+            &data_info->old.oper, &data_info->new.oper))) {
         return err_info;
     }
 
     /* factory-default */
-    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_FACTORY_DEFAULT, sr_mods, &data_info->old.fdflt,
-            &data_info->new.fdflt))) {
+    if ((err_info = sr_lycc_store_data_ds_if_differ(conn, new_ctx, SR_DS_FACTORY_DEFAULT, sr_mods,
+            data_info->incremental, &data_info->old.fdflt, &data_info->new.fdflt))) {
         return err_info;
     }
 
@@ -34,11 +34,16 @@ struct sr_data_update_s {
         struct lyd_node *fdflt;
     } old;
     struct sr_data_update_set_s new;
+    int incremental;    /**< Set if only new modules were added and the data of the existing ones are unchanged. */
 };
 
 /**
  * @brief Lock context and update it if needed.
  *
+ * The context lock is not RCU-like, a context change holds it WRITE for its whole duration and so blocks all
+ * the readers. Connections only use the published content ID to detect a new context, which is then created
+ * once per connection.
+ *
  * @param[in] conn Connection to use.
  * @param[in] mode Requested lock mode.
  * @param[in] lydmods_lock Set if SR internal module data will be modified.
@@ -67,6 +72,17 @@ sr_error_info_t *sr_lycc_relock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, const
  */
 void sr_lycc_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lydmods_lock, const char *func);
 
+/**
+ * @brief Require modules to be loaded in the context of a ::SR_CONN_CTX_LAZY connection, does nothing for other
+ * connections. The modules are loaded on the next context lock.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mod_name Optional required module name.
+ * @param[in] path Optional path or XPath, the modules of all its prefixes are required.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_lycc_lazy_require(sr_conn_ctx_t *conn, const char *mod_name, const char *path);
+
 /**
  * @brief Check that modules can be added.
  *
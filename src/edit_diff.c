@@ -1014,33 +1014,206 @@ sr_edit_userord_is_moved(const struct lyd_node *data_match, enum insert_val inse
     return 0;
 }
 
+/**
+ * @brief Index of the instances of a duplicate-instance (leaf-)list in data siblings, used while applying an edit
+ * so that finding an instance on a position does not require iterating over all the preceding instances.
+ *
+ * The index is valid for the single set of siblings its instances belong to and must be updated on every change
+ * of the instances or their ancestors, see ::sr_edit_dup_idx_update().
+ */
+struct sr_edit_dup_idx_s {
+    struct lyd_node **insts;        /**< All the instances in their order, the index is not valid if there are none. */
+    uint32_t *meta_pos;             /**< Position metadata value of every instance, 0 if it has none. */
+    uint32_t count;                 /**< Count of indexed instances. */
+    uint32_t size;                  /**< Allocated size of the arrays. */
+    int has_meta;                   /**< Whether any instance has position metadata. */
+};
+
+/**
+ * @brief Append an instance into a duplicate-instance (leaf-)list index.
+ *
+ * @param[in] dup_idx Index to update.
+ * @param[in] inst Instance to append.
+ * @return 0 on success, non-zero on memory allocation failure.
+ */
+static int
+sr_edit_dup_idx_append(struct sr_edit_dup_idx_s *dup_idx, struct lyd_node *inst)
+{
+    struct lyd_meta *meta;
+    void *mem;
+
+    if (dup_idx->count == dup_idx->size) {
+        mem = realloc(dup_idx->insts, (dup_idx->size ? dup_idx->size * 2 : 16) * sizeof *dup_idx->insts);
+        if (!mem) {
+            return 1;
+        }
+        dup_idx->insts = mem;
+        mem = realloc(dup_idx->meta_pos, (dup_idx->size ? dup_idx->size * 2 : 16) * sizeof *dup_idx->meta_pos);
+        if (!mem) {
+            return 1;
+        }
+        dup_idx->meta_pos = mem;
+        dup_idx->size = dup_idx->size ? dup_idx->size * 2 : 16;
+    }
+
+    dup_idx->insts[dup_idx->count] = inst;
+    meta = lyd_find_meta(inst->meta, NULL, "sysrepo:dup-inst-list-position");
+    dup_idx->meta_pos[dup_idx->count] = meta ? strtoul(lyd_get_meta_value(meta), NULL, 10) : 0;
+    if (meta) {
+        dup_idx->has_meta = 1;
+    }
+    ++dup_idx->count;
+
+    return 0;
+}
+
+/**
+ * @brief Get a valid duplicate-instance (leaf-)list index for data siblings, rebuild it if needed.
+ *
+ * @param[in] dup_idx Index to use.
+ * @param[in] sibling First data tree sibling.
+ * @param[in] schema Schema node of the (leaf-)list.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_edit_dup_idx_get(struct sr_edit_dup_idx_s *dup_idx, const struct lyd_node *sibling, const struct lysc_node *schema)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *first, *iter;
+
+    /* find the first instance */
+    lyd_find_sibling_val(sibling, schema, NULL, 0, &first);
+    if (dup_idx->count && (dup_idx->insts[0] == first)) {
+        /* the index is valid */
+        return NULL;
+    }
+
+    /* rebuild the index */
+    dup_idx->count = 0;
+    dup_idx->has_meta = 0;
+    for (iter = first; iter && (iter->schema == schema); iter = iter->next) {
+        if (sr_edit_dup_idx_append(dup_idx, iter)) {
+            dup_idx->count = 0;
+            SR_ERRINFO_MEM(&err_info);
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find an instance on a position in a duplicate-instance (leaf-)list index.
+ *
+ * @param[in] dup_idx Valid index to use.
+ * @param[in] pos Position to find, starting from 1.
+ * @param[in] use_meta Whether instances with position metadata match based on its value instead of their position.
+ * @return Found instance, NULL if not found.
+ */
+static struct lyd_node *
+sr_edit_dup_idx_find(const struct sr_edit_dup_idx_s *dup_idx, uint32_t pos, int use_meta)
+{
+    uint32_t i;
+
+    if (!pos) {
+        return NULL;
+    }
+
+    if (!use_meta || !dup_idx->has_meta) {
+        return (pos <= dup_idx->count) ? dup_idx->insts[pos - 1] : NULL;
+    }
+
+    /* the first instance with a matching position metadata or without them on the position */
+    for (i = 0; i < dup_idx->count; ++i) {
+        if (dup_idx->meta_pos[i] ? (dup_idx->meta_pos[i] == pos) : (i + 1 == pos)) {
+            return dup_idx->insts[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Update a duplicate-instance (leaf-)list index after a data node was inserted or before it is removed.
+ *
+ * Only appending and removing the last instance is handled, the index is invalidated on any other change.
+ *
+ * @param[in] dup_idx Index to update, may be NULL.
+ * @param[in] node Inserted node or a node to be removed (unlinked or freed).
+ * @param[in] inserted Whether @p node was inserted or is to be removed.
+ */
+static void
+sr_edit_dup_idx_update(struct sr_edit_dup_idx_s *dup_idx, const struct lyd_node *node, int inserted)
+{
+    const struct lyd_node *last, *parent;
+
+    if (!dup_idx || !dup_idx->count) {
+        return;
+    }
+
+    last = dup_idx->insts[dup_idx->count - 1];
+    if ((node->schema == last->schema) && (lyd_parent(node) == lyd_parent(last))) {
+        /* instance of the indexed (leaf-)list */
+        if (inserted && (node->prev == last) && (!node->next || (node->next->schema != node->schema))) {
+            /* appended */
+            if (sr_edit_dup_idx_append(dup_idx, (struct lyd_node *)node)) {
+                dup_idx->count = 0;
+            }
+        } else if (!inserted && (node == last)) {
+            /* last removed */
+            --dup_idx->count;
+        } else {
+            dup_idx->count = 0;
+        }
+        return;
+    }
+
+    if (!inserted) {
+        /* removing an ancestor of the instances invalidates the index */
+        for (parent = lyd_parent(last); parent; parent = lyd_parent(parent)) {
+            if (parent == node) {
+                dup_idx->count = 0;
+                break;
+            }
+        }
+    }
+}
+
 /**
  * @brief Find a matching node in data tree for a specific (leaf-)list instance.
  *
  * @param[in] sibling First data tree sibling.
  * @param[in] llist Arbitrary instance of the (leaf-)list.
  * @param[in] userord_anchor Preceding user-ordered anchor of the searched instance.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to use.
  * @param[out] match Matching instance in the data tree.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_find_userord_predicate(const struct lyd_node *sibling, const struct lyd_node *llist, const char *userord_anchor,
-        struct lyd_node **match)
+        struct sr_edit_dup_idx_s *dup_idx, struct lyd_node **match)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *iter;
+    struct lyd_node *iter = NULL;
     uint32_t cur_pos, pos;
     int found = 0;
 
     if (lysc_is_dup_inst_list(llist->schema)) {
         pos = strtoul(userord_anchor, NULL, 10);
-        cur_pos = 1;
-        LYD_LIST_FOR_INST(sibling, llist->schema, iter) {
-            if (cur_pos == pos) {
-                found = 1;
-                break;
+        if (dup_idx) {
+            if ((err_info = sr_edit_dup_idx_get(dup_idx, sibling, llist->schema))) {
+                return err_info;
+            }
+            iter = sr_edit_dup_idx_find(dup_idx, pos, 0);
+            found = iter ? 1 : 0;
+        } else {
+            cur_pos = 1;
+            LYD_LIST_FOR_INST(sibling, llist->schema, iter) {
+                if (cur_pos == pos) {
+                    found = 1;
+                    break;
+                }
+                ++cur_pos;
             }
-            ++cur_pos;
         }
         if (!found) {
             sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, "Node \"%s\" instance to insert next to not found.",
@@ -1066,11 +1239,13 @@ sr_edit_find_userord_predicate(const struct lyd_node *sibling, const struct lyd_
  *
  * @param[in] data_sibling First sibling in the data tree.
  * @param[in] edit_node Edit node to match.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to use.
  * @param[out] match_p Matching node.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_edit_find_match(const struct lyd_node *data_sibling, const struct lyd_node *edit_node, struct lyd_node **match_p)
+sr_edit_find_match(const struct lyd_node *data_sibling, const struct lyd_node *edit_node, struct sr_edit_dup_idx_s *dup_idx,
+        struct lyd_node **match_p)
 {
     sr_error_info_t *err_info = NULL;
     const struct lysc_node *schema = NULL;
@@ -1097,31 +1272,39 @@ sr_edit_find_match(const struct lyd_node *data_sibling, const struct lyd_node *e
         }
         pos = strtoul(lyd_get_meta_value(m1), NULL, 10);
 
-        /* iterate over all the instances */
-        lyd_find_sibling_val(data_sibling, edit_node->schema, NULL, 0, match_p);
-        inst_pos = 1;
-        while (pos && *match_p && ((*match_p)->schema == edit_node->schema)) {
-            m2 = lyd_find_meta((*match_p)->meta, NULL, "sysrepo:dup-inst-list-position");
-            if (m2) {
-                /* actually merging edits, try to find an instance with the same position */
-                if (pos == strtoul(lyd_get_meta_value(m2), NULL, 10)) {
-                    found = 1;
-                    break;
-                }
-            } else {
-                /* find instance on this position */
-                if (pos == inst_pos) {
-                    found = 1;
-                    break;
-                }
+        if (dup_idx) {
+            /* use the index of all the instances */
+            if ((err_info = sr_edit_dup_idx_get(dup_idx, data_sibling, edit_node->schema))) {
+                return err_info;
             }
+            *match_p = sr_edit_dup_idx_find(dup_idx, pos, 1);
+        } else {
+            /* iterate over all the instances */
+            lyd_find_sibling_val(data_sibling, edit_node->schema, NULL, 0, match_p);
+            inst_pos = 1;
+            while (pos && *match_p && ((*match_p)->schema == edit_node->schema)) {
+                m2 = lyd_find_meta((*match_p)->meta, NULL, "sysrepo:dup-inst-list-position");
+                if (m2) {
+                    /* actually merging edits, try to find an instance with the same position */
+                    if (pos == strtoul(lyd_get_meta_value(m2), NULL, 10)) {
+                        found = 1;
+                        break;
+                    }
+                } else {
+                    /* find instance on this position */
+                    if (pos == inst_pos) {
+                        found = 1;
+                        break;
+                    }
+                }
 
-            *match_p = (*match_p)->next;
-            ++inst_pos;
-        }
+                *match_p = (*match_p)->next;
+                ++inst_pos;
+            }
 
-        if (!found) {
-            *match_p = NULL;
+            if (!found) {
+                *match_p = NULL;
+            }
         }
     } else if (edit_node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
         /* exact (leaf-)list instance */
@@ -1155,13 +1338,15 @@ sr_edit_find_match(const struct lyd_node *data_sibling, const struct lyd_node *e
  * @param[in] userord_anchor Optional user-ordered list anchor of relative (leaf-)list instance of the operation.
  * @param[in] dflt_ll_skip Whether to skip found default leaf-list instance.
  * @param[in] flags Flags modifying the behavior.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to use.
  * @param[out] match_p Matching node.
  * @param[out] val_equal_p Whether even the value matches.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_find(const struct lyd_node *data_sibling, const struct lyd_node *edit_node, enum edit_op op, enum insert_val insert,
-        const char *userord_anchor, int dflt_ll_skip, int flags, struct lyd_node **match_p, int *val_equal_p)
+        const char *userord_anchor, int dflt_ll_skip, int flags, struct sr_edit_dup_idx_s *dup_idx, struct lyd_node **match_p,
+        int *val_equal_p)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *anchor_node;
@@ -1178,7 +1363,7 @@ sr_edit_find(const struct lyd_node *data_sibling, const struct lyd_node *edit_no
         }
     } else {
         /* find the edit node instance efficiently in data (if possible) */
-        if ((err_info = sr_edit_find_match(data_sibling, edit_node, (struct lyd_node **)&match))) {
+        if ((err_info = sr_edit_find_match(data_sibling, edit_node, dup_idx, (struct lyd_node **)&match))) {
             return err_info;
         }
 
@@ -1213,7 +1398,8 @@ sr_edit_find(const struct lyd_node *data_sibling, const struct lyd_node *edit_no
                         anchor_node = NULL;
                         if (userord_anchor) {
                             /* find the anchor node if set */
-                            if ((err_info = sr_edit_find_userord_predicate(data_sibling, match, userord_anchor, &anchor_node))) {
+                            if ((err_info = sr_edit_find_userord_predicate(data_sibling, match, userord_anchor, dup_idx,
+                                    &anchor_node))) {
                                 return err_info;
                             }
                         } else if (flags & EDIT_APPLY_REPLACE_R) {
@@ -1292,17 +1478,23 @@ sr_edit_op2str(enum edit_op op)
  * @param[in] new_node Edit node to insert.
  * @param[in] insert Place where to insert the node.
  * @param[in] userord_anchor Optional user-ordered anchor of relative (leaf-)list instance.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to use and update.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_insert(struct lyd_node **data_root, struct lyd_node *data_parent, struct lyd_node *new_node,
-        enum insert_val insert, const char *userord_anchor)
+        enum insert_val insert, const char *userord_anchor, struct sr_edit_dup_idx_s *dup_idx)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *anchor;
 
     assert(new_node);
 
+    if (new_node->parent || (new_node->prev != new_node) || (new_node == *data_root)) {
+        /* node is being moved */
+        sr_edit_dup_idx_update(dup_idx, new_node, 0);
+    }
+
     /* unlink properly first to avoid unwanted behavior (first node equals new_node or new_node is the first sibling) */
     if (new_node == *data_root) {
         *data_root = (*data_root)->next;
@@ -1351,7 +1543,7 @@ sr_edit_insert(struct lyd_node **data_root, struct lyd_node *data_parent, struct
 
     /* find the anchor sibling */
     if ((err_info = sr_edit_find_userord_predicate(data_parent ? lyd_child(data_parent) : *data_root, new_node,
-            userord_anchor, &anchor))) {
+            userord_anchor, dup_idx, &anchor))) {
         goto cleanup;
     }
 
@@ -1371,6 +1563,9 @@ sr_edit_insert(struct lyd_node **data_root, struct lyd_node *data_parent, struct
     }
 
 cleanup:
+    if (!err_info) {
+        sr_edit_dup_idx_update(dup_idx, new_node, 1);
+    }
     return err_info;
 }
 
@@ -1595,42 +1790,20 @@ sr_diff_find_match(const struct lyd_node *diff_sibling, const struct lyd_node *d
 }
 
 /**
- * @brief Add a node from data tree/edit into sysrepo diff.
+ * @brief Insert a new diff subtree into sysrepo diff, merge it if the node is already there.
  *
- * @param[in] node Changed node to be added to the diff.
- * @param[in] meta_val Metadata value (meaning depends on the nodetype).
- * @param[in] prev_meta_value Previous metadata value (meaning depends on the nodetype).
- * @param[in] op Diff operation.
+ * @param[in] node_dup New diff subtree, is spent.
  * @param[in] diff_parent Current sysrepo diff parent.
  * @param[in,out] diff_root Current sysrepo diff root node.
- * @param[out] diff_node Optional created diff node.
+ * @param[out] diff_node Optional inserted or merged diff node.
  * @return err_info, NULL on error.
  */
 static sr_error_info_t *
-sr_edit_diff_add(const struct lyd_node *node, const char *meta_val, const char *prev_meta_val, enum edit_op op,
-        struct lyd_node *diff_parent, struct lyd_node **diff_root, struct lyd_node **diff_node)
+sr_edit_diff_insert(struct lyd_node *node_dup, struct lyd_node *diff_parent, struct lyd_node **diff_root,
+        struct lyd_node **diff_node)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *node_dup = NULL, *diff_match;
-    char *sibling_before_val = NULL;
-
-    assert((op == EDIT_NONE) || (op == EDIT_CREATE) || (op == EDIT_DELETE) || (op == EDIT_REPLACE));
-    assert(!diff_node || !*diff_node);
-
-    if (!diff_parent && !diff_root) {
-        /* we are actually not generating a diff, so just perform what we are supposed to to change the datastore */
-        return NULL;
-    }
-
-    /* duplicate node */
-    if ((err_info = sr_lyd_dup(node, NULL, LYD_DUP_NO_META, 0, &node_dup))) {
-        goto cleanup;
-    }
-
-    /* add specific attributes for the node */
-    if ((err_info = sr_diff_add_meta(node_dup, meta_val, prev_meta_val, op))) {
-        goto cleanup;
-    }
+    struct lyd_node *diff_match;
 
     /* check whether the new diff node is not already in the diff */
     if ((err_info = sr_diff_find_match(diff_parent ? lyd_child(diff_parent) : *diff_root, node_dup, &diff_match))) {
@@ -1668,10 +1841,51 @@ sr_edit_diff_add(const struct lyd_node *node, const char *meta_val, const char *
 
 cleanup:
     lyd_free_tree(node_dup);
-    free(sibling_before_val);
     return err_info;
 }
 
+/**
+ * @brief Add a node from data tree/edit into sysrepo diff.
+ *
+ * @param[in] node Changed node to be added to the diff.
+ * @param[in] meta_val Metadata value (meaning depends on the nodetype).
+ * @param[in] prev_meta_value Previous metadata value (meaning depends on the nodetype).
+ * @param[in] op Diff operation.
+ * @param[in] diff_parent Current sysrepo diff parent.
+ * @param[in,out] diff_root Current sysrepo diff root node.
+ * @param[out] diff_node Optional created diff node.
+ * @return err_info, NULL on error.
+ */
+static sr_error_info_t *
+sr_edit_diff_add(const struct lyd_node *node, const char *meta_val, const char *prev_meta_val, enum edit_op op,
+        struct lyd_node *diff_parent, struct lyd_node **diff_root, struct lyd_node **diff_node)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *node_dup = NULL;
+
+    assert((op == EDIT_NONE) || (op == EDIT_CREATE) || (op == EDIT_DELETE) || (op == EDIT_REPLACE));
+    assert(!diff_node || !*diff_node);
+
+    if (!diff_parent && !diff_root) {
+        /* we are actually not generating a diff, so just perform what we are supposed to to change the datastore */
+        return NULL;
+    }
+
+    /* duplicate node */
+    if ((err_info = sr_lyd_dup(node, NULL, LYD_DUP_NO_META, 0, &node_dup))) {
+        goto cleanup;
+    }
+
+    /* add specific attributes for the node */
+    if ((err_info = sr_diff_add_meta(node_dup, meta_val, prev_meta_val, op))) {
+        lyd_free_tree(node_dup);
+        return err_info;
+    }
+
+    /* add it into the diff */
+    return sr_edit_diff_insert(node_dup, diff_parent, diff_root, diff_node);
+}
+
 /**
  * @brief Check whether this diff node is redundant (does not change data).
  *
@@ -1873,12 +2087,14 @@ cleanup:
  * @param[out] diff_node Created diff node.
  * @param[out] next_op Next operation to be performed with these nodes.
  * @param[out] change Whether some data change occurred.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to use and update.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_apply_move(struct lyd_node **data_root, struct lyd_node *data_parent, const struct lyd_node *edit_node,
         struct lyd_node **data_match, enum insert_val insert, const char *key_or_value, struct lyd_node *diff_parent,
-        struct lyd_node **diff_root, struct lyd_node **diff_node, enum edit_op *next_op, int *change)
+        struct lyd_node **diff_root, struct lyd_node **diff_node, enum edit_op *next_op, int *change,
+        struct sr_edit_dup_idx_s *dup_idx)
 {
     sr_error_info_t *err_info = NULL;
     const struct lyd_node *old_sibling_before, *sibling_before;
@@ -1904,7 +2120,7 @@ sr_edit_apply_move(struct lyd_node **data_root, struct lyd_node *data_parent, co
     old_sibling_before = sr_edit_find_previous_instance(*data_match);
 
     /* move the node */
-    if ((err_info = sr_edit_insert(data_root, data_parent, *data_match, insert, key_or_value))) {
+    if ((err_info = sr_edit_insert(data_root, data_parent, *data_match, insert, key_or_value, dup_idx))) {
         goto error;
     }
 
@@ -2081,12 +2297,13 @@ sr_edit_apply_replace(struct lyd_node *data_match, int val_equal, const struct l
  * @param[out] diff_node Created diff node.
  * @param[out] next_op Next operation to be performed with these nodes.
  * @param[out] change Whether some data change occured.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to update.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_apply_create(struct lyd_node **data_root, struct lyd_node *data_parent, struct lyd_node **data_match,
         int val_equal, const struct lyd_node *edit_node, struct lyd_node *diff_parent, struct lyd_node **diff_root,
-        struct lyd_node **diff_node, enum edit_op *next_op, int *change)
+        struct lyd_node **diff_node, enum edit_op *next_op, int *change, struct sr_edit_dup_idx_s *dup_idx)
 {
     sr_error_info_t *err_info = NULL;
 
@@ -2127,7 +2344,7 @@ sr_edit_apply_create(struct lyd_node **data_root, struct lyd_node *data_parent,
         return err_info;
     }
 
-    if ((err_info = sr_edit_insert(data_root, data_parent, *data_match, 0, NULL))) {
+    if ((err_info = sr_edit_insert(data_root, data_parent, *data_match, 0, NULL, dup_idx))) {
         return err_info;
     }
 
@@ -2142,6 +2359,186 @@ sr_edit_apply_create(struct lyd_node **data_root, struct lyd_node *data_parent,
     return NULL;
 }
 
+/**
+ * @brief Check whether a whole edit subtree can be created at once in data where it does not exist.
+ *
+ * @param[in] edit_node Edit subtree root.
+ * @return Whether the subtree only creates nodes without any metadata affecting the individual descendants.
+ */
+static int
+sr_edit_is_plain_subtree(const struct lyd_node *edit_node)
+{
+    const struct lyd_node *elem;
+
+    if (!edit_node->schema || lysc_is_userordered(edit_node->schema) || (edit_node->flags & LYD_EXT)) {
+        /* opaque, needs an insert position, or an extension node */
+        return 0;
+    }
+
+    LYD_TREE_DFS_BEGIN(edit_node, elem) {
+        if ((elem != edit_node) && (!elem->schema || elem->meta || (elem->flags & LYD_EXT))) {
+            /* operation, origin, insert position, or any other metadata of a descendant, apply them one-by-one */
+            return 0;
+        }
+        if (lysc_is_dup_inst_list(elem->schema)) {
+            /* instance positions are tracked separately */
+            return 0;
+        }
+
+        LYD_TREE_DFS_END(edit_node, elem);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether merging or replacing edit node children would not change the matching data node children.
+ *
+ * @param[in] edit_node Edit node.
+ * @param[in] data_match Matching data node.
+ * @param[in] replace Whether the children replace the data children, otherwise they are merged.
+ * @return Whether the children would change nothing.
+ */
+static int
+sr_edit_is_noop_children_r(const struct lyd_node *edit_node, const struct lyd_node *data_match, int replace)
+{
+    const struct lyd_node *edit_child;
+    struct lyd_node *data_child;
+    uint32_t edit_count = 0, data_count = 0;
+
+    LY_LIST_FOR(lyd_child_no_keys(edit_node), edit_child) {
+        if (!edit_child->schema || edit_child->meta || (edit_child->flags & (LYD_EXT | LYD_DEFAULT)) ||
+                lysc_is_userordered(edit_child->schema) || lysc_is_dup_inst_list(edit_child->schema) ||
+                (edit_child->schema->nodetype & LYD_NODE_ANY)) {
+            /* opaque, own operation or origin, extension, position, or anydata, apply them normally */
+            return 0;
+        }
+
+        /* find the data instance */
+        if (lyd_find_sibling_first(lyd_child(data_match), edit_child, &data_child) ||
+                (data_child->flags & LYD_DEFAULT)) {
+            /* node would be created */
+            return 0;
+        }
+        if ((edit_child->schema->nodetype == LYS_LEAF) && lyd_compare_single(edit_child, data_child, 0)) {
+            /* value would be changed */
+            return 0;
+        }
+
+        if (!sr_edit_is_noop_children_r(edit_child, data_child, replace)) {
+            return 0;
+        }
+        ++edit_count;
+    }
+
+    if (replace) {
+        /* there can be no explicit data children that are not in the edit, they would be removed */
+        LY_LIST_FOR(lyd_child_no_keys(data_match), data_child) {
+            if (!(data_child->flags & LYD_DEFAULT)) {
+                ++data_count;
+            }
+        }
+        if (edit_count != data_count) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether merging or replacing an edit subtree would not change the matching data subtree at all.
+ *
+ * Used to avoid creating a diff that would only be found redundant later.
+ *
+ * @param[in] edit_node Edit subtree root.
+ * @param[in] data_match Matching data node with an equal value.
+ * @param[in] replace Whether the edit replaces the data, otherwise it is merged.
+ * @return Whether applying the edit would change nothing.
+ */
+static int
+sr_edit_is_noop_subtree(const struct lyd_node *edit_node, const struct lyd_node *data_match, int replace)
+{
+    const struct lyd_meta *meta;
+
+    if (!edit_node->schema || !(edit_node->schema->nodetype & (LYS_CONTAINER | LYS_LIST)) ||
+            (edit_node->flags & LYD_EXT)) {
+        /* term nodes are handled without a diff anyway */
+        return 0;
+    }
+
+    LY_LIST_FOR(edit_node->meta, meta) {
+        if (strcmp(meta->name, "operation")) {
+            /* origin, insert position, or other metadata */
+            return 0;
+        }
+    }
+
+    return sr_edit_is_noop_children_r(edit_node, data_match, replace);
+}
+
+/**
+ * @brief Apply edit create operation of a whole subtree that does not exist in data.
+ *
+ * The subtree is inserted into data at once and added into the diff as a single subtree with an inherited
+ * "create" operation.
+ *
+ * @param[in,out] data_root First top-level sibling of the data tree.
+ * @param[in] data_parent Data tree node parent.
+ * @param[in] edit_node Current edit node, must be a plain subtree (::sr_edit_is_plain_subtree()).
+ * @param[out] data_match Created data tree node.
+ * @param[in] diff_parent Current sysrepo diff parent.
+ * @param[in,out] diff_root Sysrepo diff root node.
+ * @param[out] diff_node Created diff node.
+ * @param[out] change Whether some data change occured.
+ * @param[in] dup_idx Optional duplicate-instance (leaf-)list index to update.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_edit_apply_create_subtree(struct lyd_node **data_root, struct lyd_node *data_parent, const struct lyd_node *edit_node,
+        struct lyd_node **data_match, struct lyd_node *diff_parent, struct lyd_node **diff_root,
+        struct lyd_node **diff_node, int *change, struct sr_edit_dup_idx_s *dup_idx)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *node_dup = NULL;
+
+    /* create the whole subtree and insert it */
+    if ((err_info = sr_lyd_dup(edit_node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_NO_META, 0, data_match))) {
+        return err_info;
+    }
+    if ((err_info = sr_edit_insert(data_root, data_parent, *data_match, 0, NULL, dup_idx))) {
+        lyd_free_tree(*data_match);
+        *data_match = NULL;
+        return err_info;
+    }
+
+    if (diff_parent || diff_root) {
+        /* add the subtree into diff with the inherited create operation */
+        if ((err_info = sr_lyd_dup(*data_match, NULL, LYD_DUP_RECURSIVE | LYD_DUP_NO_META, 0, &node_dup))) {
+            return err_info;
+        }
+        if ((err_info = sr_diff_add_meta(node_dup, NULL, NULL, EDIT_CREATE))) {
+            lyd_free_tree(node_dup);
+            return err_info;
+        }
+
+        /* user-ordered lists need information about position */
+        if ((err_info = sr_edit_created_subtree_apply_move(node_dup))) {
+            lyd_free_tree(node_dup);
+            return err_info;
+        }
+
+        if ((err_info = sr_edit_diff_insert(node_dup, diff_parent, diff_root, diff_node))) {
+            return err_info;
+        }
+    }
+
+    if (change) {
+        *change = 1;
+    }
+    return NULL;
+}
+
 /**
  * @brief Apply edit merge operation.
  *
@@ -2334,12 +2731,14 @@ sr_edit_apply_op_error(sr_error_info_t **err_info, enum edit_op op)
  * @param[in] diff_parent Current sysrepo diff parent.
  * @param[in,out] diff_root Sysrepo diff root node.
  * @param[in] flags Flags modifying the behavior.
+ * @param[in] dup_idx Duplicate-instance (leaf-)list index to use and update.
  * @param[out] change Set if there are some data changes.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_apply_r(struct lyd_node **data_root, struct lyd_node *data_parent, const struct lyd_node *edit_node,
-        enum edit_op parent_op, struct lyd_node *diff_parent, struct lyd_node **diff_root, int flags, int *change)
+        enum edit_op parent_op, struct lyd_node *diff_parent, struct lyd_node **diff_root, int flags,
+        struct sr_edit_dup_idx_s *dup_idx, int *change)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *data_match = NULL, *child, *next, *edit_match, *diff_node = NULL, *data_del = NULL;
@@ -2380,7 +2779,25 @@ sr_edit_apply_r(struct lyd_node **data_root, struct lyd_node *data_parent, const
 reapply:
     /* find an equal node in the current data */
     if ((err_info = sr_edit_find(data_parent ? lyd_child(data_parent) : *data_root, edit_node, op, insert, key_or_value,
-            1, flags, &data_match, &val_equal))) {
+            1, flags, dup_idx, &data_match, &val_equal))) {
+        goto cleanup;
+    }
+
+    if (!data_match && ((op == EDIT_CREATE) || (op == EDIT_MERGE) || (op == EDIT_REPLACE)) &&
+            sr_edit_is_plain_subtree(edit_node)) {
+        /* nothing to merge with, create the whole subtree at once */
+        if ((err_info = sr_edit_apply_create_subtree(data_root, data_parent, edit_node, &data_match, diff_parent,
+                diff_root, &diff_node, change, dup_idx))) {
+            sr_edit_apply_op_error(&err_info, op);
+            goto cleanup;
+        }
+        next_op = EDIT_FINISH;
+        goto fix_origin;
+    }
+
+    if (data_match && val_equal && ((op == EDIT_MERGE) || (op == EDIT_REPLACE)) &&
+            sr_edit_is_noop_subtree(edit_node, data_match, (op == EDIT_REPLACE) || (flags & EDIT_APPLY_REPLACE_R))) {
+        /* the data already are exactly as in the edit, avoid creating a redundant diff */
         goto cleanup;
     }
 
@@ -2397,7 +2814,7 @@ reapply:
             break;
         case EDIT_CREATE:
             if ((err_info = sr_edit_apply_create(data_root, data_parent, &data_match, val_equal, edit_node, diff_parent,
-                    diff_root, &diff_node, &next_op, change))) {
+                    diff_root, &diff_node, &next_op, change, dup_idx))) {
                 sr_edit_apply_op_error(&err_info, op);
                 goto cleanup;
             }
@@ -2434,7 +2851,7 @@ reapply:
             break;
         case EDIT_MOVE:
             if ((err_info = sr_edit_apply_move(data_root, data_parent, edit_node, &data_match, insert, key_or_value,
-                    diff_parent, diff_root, &diff_node, &next_op, change))) {
+                    diff_parent, diff_root, &diff_node, &next_op, change, dup_idx))) {
                 sr_edit_apply_op_error(&err_info, op);
                 goto cleanup;
             }
@@ -2458,6 +2875,7 @@ reapply:
         }
     } while ((next_op != EDIT_CONTINUE) && (next_op != EDIT_FINISH));
 
+fix_origin:
     /* fix origin in data */
     sr_edit_diff_get_origin(edit_node, &origin, NULL);
     if (data_match && origin && (err_info = sr_edit_diff_set_origin(data_match, origin, 1))) {
@@ -2470,6 +2888,11 @@ reapply:
     }
 
     if ((prev_op == EDIT_AUTO_REMOVE) || ((prev_op == EDIT_PURGE) && data_del)) {
+        if (data_del) {
+            /* the subtree is being removed */
+            sr_edit_dup_idx_update(dup_idx, data_del, 0);
+        }
+
         /* avoid recursive remove by manually adding all the descendants into the diff */
         if (diff_root && (err_info = sr_edit_apply_remove_diff_subtree_add(data_del, diff_node))) {
             goto cleanup;
@@ -2496,12 +2919,12 @@ reapply:
     if (flags & (EDIT_APPLY_REPLACE_R | EDIT_APPLY_DELETE_R)) {
         /* remove all non-default children that are not in the edit, recursively */
         LY_LIST_FOR_SAFE(lyd_child_no_keys(data_match), next, child) {
-            if ((err_info = sr_edit_find(lyd_child_no_keys(edit_node), child, EDIT_REMOVE, 0, NULL, 0, 0,
+            if ((err_info = sr_edit_find(lyd_child_no_keys(edit_node), child, EDIT_REMOVE, 0, NULL, 0, 0, NULL,
                     &edit_match, NULL))) {
                 goto cleanup;
             }
             if (!edit_match && (err_info = sr_edit_apply_r(data_root, data_match, child, EDIT_REMOVE, diff_parent,
-                    diff_root, flags, change))) {
+                    diff_root, flags, dup_idx, change))) {
                 goto cleanup;
             }
         }
@@ -2510,7 +2933,8 @@ reapply:
     /* apply edit recursively, keys are being checked, in case we were called by the recursion above,
      * edit_node and data_match are the same and so child will be freed, hence the safe loop */
     LY_LIST_FOR_SAFE(lyd_child(edit_node), next, child) {
-        if ((err_info = sr_edit_apply_r(data_root, data_match, child, op, diff_parent, diff_root, flags, change))) {
+        if ((err_info = sr_edit_apply_r(data_root, data_match, child, op, diff_parent, diff_root, flags, dup_idx,
+                change))) {
             goto cleanup;
         }
     }
@@ -2523,7 +2947,10 @@ reapply:
     }
 
 cleanup:
-    sr_lyd_free_tree_safe(data_del, data_root);
+    if (data_del) {
+        sr_edit_dup_idx_update(dup_idx, data_del, 0);
+        sr_lyd_free_tree_safe(data_del, data_root);
+    }
     free(origin);
     return err_info;
 }
@@ -2535,6 +2962,7 @@ sr_edit_mod_apply(const struct lyd_node *edit, const struct lys_module *ly_mod,
     sr_error_info_t *err_info = NULL;
     const struct lyd_node *root;
     struct lyd_node *mod_diff = NULL;
+    struct sr_edit_dup_idx_s dup_idx = {0};
 
     if (change) {
         *change = 0;
@@ -2547,7 +2975,8 @@ sr_edit_mod_apply(const struct lyd_node *edit, const struct lys_module *ly_mod,
         }
 
         /* apply relevant nodes from the edit datatree */
-        if ((err_info = sr_edit_apply_r(data, NULL, root, EDIT_CONTINUE, NULL, diff ? &mod_diff : NULL, 0, change))) {
+        if ((err_info = sr_edit_apply_r(data, NULL, root, EDIT_CONTINUE, NULL, diff ? &mod_diff : NULL, 0, &dup_idx,
+                change))) {
             goto cleanup;
         }
 
@@ -2568,6 +2997,8 @@ sr_edit_mod_apply(const struct lyd_node *edit, const struct lys_module *ly_mod,
 
 cleanup:
     lyd_free_siblings(mod_diff);
+    free(dup_idx.insts);
+    free(dup_idx.meta_pos);
     return err_info;
 }
 
@@ -2800,7 +3231,7 @@ sr_edit_merge_r(struct lyd_node **trg_root, struct lyd_node *trg_parent, const s
         }
     } else {
         /* find an equal node in the current data */
-        if ((err_info = sr_edit_find_match(trg_sibling, src_node, &trg_node))) {
+        if ((err_info = sr_edit_find_match(trg_sibling, src_node, NULL, &trg_node))) {
             goto cleanup;
         }
     }
@@ -2994,11 +3425,16 @@ sr_edit_diff_edit_merge_r(struct lyd_node **trg_root, struct lyd_node *trg_paren
 
     /* find an equal node in the current data */
     trg_sibling = trg_parent ? lyd_child(trg_parent) : *trg_root;
-    if ((err_info = sr_edit_find_match(trg_sibling, src_node, &trg_node))) {
+    if ((err_info = sr_edit_find_match(trg_sibling, src_node, NULL, &trg_node))) {
         goto cleanup;
     }
 
     if (trg_node) {
+        if (sr_edit_diff_find_oper(trg_node, 1, NULL) == EDIT_CREATE) {
+            /* the whole subtree was created, all the descendants are already in the diff */
+            goto cleanup;
+        }
+
         /* merge descendants, recursively */
         LY_LIST_FOR(lyd_child_no_keys(src_node), child_src) {
             if ((err_info = sr_edit_diff_edit_merge_r(trg_root, trg_node, child_src))) {
@@ -3052,7 +3488,7 @@ sr_edit_mod_diff_edit_merge(struct lyd_node **diff, const struct lys_module *ly_
         }
 
         /* merge relevant nodes from the edit datatree */
-        if ((err_info = sr_edit_diff_edit_merge_r(diff, NULL, edit))) {
+        if ((err_info = sr_edit_diff_edit_merge_r(diff, NULL, root))) {
             goto cleanup;
         }
     }
@@ -3444,13 +3880,14 @@ sr_edit_add_update_op(struct lyd_node *node, const char *def_operation)
  * @param[in] xpath XPath to create.
  * @param[in] value Value to set.
  * @param[in] is_oper Whether the XPath is for operational datastore or not.
+ * @param[in] validate Whether to validate @p xpath, otherwise its schema must be known to be valid.
  * @param[out] match Existing matching node, if any.
  * @param[out] rel_xpath Relative oper edit XPath to actually create, needs to be freed.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_edit_add_xpath(const struct ly_ctx *ly_ctx, const struct lyd_node *tree, const char *xpath, const char *value,
-        int is_oper, struct lyd_node **match, char **rel_xpath)
+        int is_oper, int validate, struct lyd_node **match, char **rel_xpath)
 {
     sr_error_info_t *err_info = NULL;
     const char *mod_name, *name, *xp, *pred, *pred_end;
@@ -3469,7 +3906,7 @@ sr_edit_add_xpath(const struct ly_ctx *ly_ctx, const struct lyd_node *tree, cons
     rxpath_len = 0;
 
     /* validate xpath */
-    if ((err_info = sr_lys_find_path(ly_ctx, xpath, NULL, NULL))) {
+    if (validate && (err_info = sr_lys_find_path(ly_ctx, xpath, NULL, NULL))) {
         goto cleanup;
     }
 
@@ -3706,14 +4143,75 @@ sr_edit_add_dup_inst_list_pos(struct lyd_node *parent, const char *xpath)
     return NULL;
 }
 
+/**
+ * @brief Find the last segment of a data path.
+ *
+ * @param[in] xpath Data path.
+ * @param[in] len Length of @p xpath to use.
+ * @return Pointer to the '/' starting the last segment of @p xpath.
+ */
+static const char *
+sr_edit_xpath_last_segment(const char *xpath, size_t len)
+{
+    const char *ptr, *last = xpath;
+    char quot = 0;
+    int pred = 0;
+
+    for (ptr = xpath; ptr < xpath + len; ++ptr) {
+        if (quot) {
+            if (ptr[0] == quot) {
+                quot = 0;
+            }
+        } else if ((ptr[0] == '\'') || (ptr[0] == '\"')) {
+            quot = ptr[0];
+        } else if (ptr[0] == '[') {
+            ++pred;
+        } else if (ptr[0] == ']') {
+            --pred;
+        } else if ((ptr[0] == '/') && !pred) {
+            last = ptr;
+        }
+    }
+
+    return last;
+}
+
+/**
+ * @brief Get an edit node from the cache that is an ancestor of a node to create.
+ *
+ * @param[in] cache Cache of the last added edit node.
+ * @param[in] xpath XPath of the node to create.
+ * @param[out] rel_xpath @p xpath relative to the returned node.
+ * @return Cached node or its closest ancestor whose path is a prefix of @p xpath, NULL if there is none.
+ */
+static struct lyd_node *
+sr_edit_add_cache_get(const struct sr_edit_add_cache_s *cache, const char *xpath, const char **rel_xpath)
+{
+    struct lyd_node *node;
+    size_t len;
+
+    len = cache->node ? strlen(cache->xpath) : 0;
+    for (node = cache->node; node && len; node = lyd_parent(node)) {
+        if (!strncmp(xpath, cache->xpath, len) && (xpath[len] == '/') && (xpath[len + 1] != '/')) {
+            *rel_xpath = xpath + len + 1;
+            return node;
+        }
+
+        /* path of the parent, every path segment is a data node */
+        len = sr_edit_xpath_last_segment(cache->xpath, len) - cache->xpath;
+    }
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, const char *operation,
         const char *def_operation, const sr_move_position_t *position, const char *keys, const char *val,
-        const char *origin, int isolate)
+        const char *origin, int isolate, struct sr_edit_add_cache_s *cache)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *node = NULL, *p, *parent = NULL, *match = NULL;
-    const char *meta_val = NULL, *def_origin;
+    struct lyd_node *node = NULL, *p, *parent = NULL, *match = NULL, *cache_node = NULL;
+    const char *meta_val = NULL, *def_origin, *cache_xpath;
     char *rel_xpath = NULL;
     enum edit_op op;
     int opts, own_oper;
@@ -3725,10 +4223,25 @@ sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, con
         opts |= LYD_NEW_PATH_OPAQ;
     }
 
+    if (cache && !isolate && !position && (session->ds != SR_DS_OPERATIONAL) && !(opts & LYD_NEW_PATH_OPAQ)) {
+        cache_node = sr_edit_add_cache_get(cache, xpath, &cache_xpath);
+    }
+    if (cache_node) {
+        /* try to create the node relative to the cached node, fails if it already exists */
+        if (!(err_info = sr_lyd_new_path(cache_node, NULL, cache_xpath, (void *)value, opts, &parent, &node))) {
+            goto created;
+        }
+
+        /* use the generic way */
+        sr_errinfo_free(&err_info);
+        parent = NULL;
+        node = NULL;
+    }
+
     if (!isolate) {
         /* find an existing node and prepare xpath for oper edit */
         if ((err_info = sr_edit_add_xpath(session->conn->ly_ctx, session->dt[session->ds].edit->tree, xpath, value,
-                (session->ds == SR_DS_OPERATIONAL), &match, &rel_xpath))) {
+                (session->ds == SR_DS_OPERATIONAL), !cache || !cache->valid, &match, &rel_xpath))) {
             goto error_safe;
         }
         if (match) {
@@ -3737,6 +4250,9 @@ sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, con
                     sr_edit_str2op(operation), (session->ds == SR_DS_OPERATIONAL)))) {
                 goto error_safe;
             }
+            if (cache) {
+                cache->node = NULL;
+            }
             goto success;
         }
     }
@@ -3754,7 +4270,10 @@ sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, con
     if (err_info) {
         sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Invalid datastore edit.");
         goto error_safe;
-    } else if (lysc_is_key(node->schema)) {
+    }
+
+created:
+    if (lysc_is_key(node->schema)) {
         sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Editing list key \"%s\" is not supported, edit list instances instead.",
                 LYD_NAME(node));
         goto error_safe;
@@ -3850,6 +4369,16 @@ sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, con
         }
     }
 
+    if (cache) {
+        /* remember the node for the following changes */
+        if (!isolate && (session->ds != SR_DS_OPERATIONAL) && !(opts & LYD_NEW_PATH_OPAQ)) {
+            cache->xpath = xpath;
+            cache->node = node;
+        } else {
+            cache->node = NULL;
+        }
+    }
+
 success:
     free(rel_xpath);
     return NULL;
@@ -3873,70 +4402,86 @@ error_safe:
 }
 
 sr_error_info_t *
-sr_diff_set_getnext(struct ly_set *set, uint32_t *idx, struct lyd_node **node, sr_change_oper_t *op)
+sr_diff_node_change_oper(const struct lyd_node *node, int *skip, sr_change_oper_t *op)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_meta *meta;
-    struct lyd_node *parent, *key;
+    const struct lyd_node *parent;
 
-    while (*idx < set->count) {
-        *node = set->dnodes[*idx];
+    *skip = 0;
 
-        /* find the (inherited) operation of the current edit node */
-        meta = NULL;
-        for (parent = *node; parent; parent = lyd_parent(parent)) {
-            meta = lyd_find_meta(parent->meta, NULL, "yang:operation");
-            if (meta) {
-                break;
-            }
+    /* find the (inherited) operation of the current edit node */
+    meta = NULL;
+    for (parent = node; parent; parent = lyd_parent(parent)) {
+        meta = lyd_find_meta(parent->meta, NULL, "yang:operation");
+        if (meta) {
+            break;
         }
-        if (!meta) {
+    }
+    if (!meta) {
+        SR_ERRINFO_INT(&err_info);
+        return err_info;
+    }
+
+    if ((parent != node) && lysc_is_userordered(parent->schema) && (lyd_get_meta_value(meta)[0] == 'r')) {
+        /* do not return changes for descendants of moved userord lists without operation */
+        *skip = 1;
+        return NULL;
+    }
+
+    /* decide operation */
+    if (meta->value.enum_item->name[0] == 'n') {
+        /* skip the node */
+        *skip = 1;
+    } else if (meta->value.enum_item->name[0] == 'c') {
+        *op = SR_OP_CREATED;
+    } else if (meta->value.enum_item->name[0] == 'd') {
+        *op = SR_OP_DELETED;
+    } else if (meta->value.enum_item->name[0] == 'r') {
+        if (node->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
+            *op = SR_OP_MODIFIED;
+        } else if (node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+            *op = SR_OP_MOVED;
+        } else {
             SR_ERRINFO_INT(&err_info);
             return err_info;
         }
+    }
 
-        if ((parent != *node) && lysc_is_userordered(parent->schema) && (lyd_get_meta_value(meta)[0] == 'r')) {
-            /* do not return changes for descendants of moved userord lists without operation */
-            ++(*idx);
-            continue;
-        }
+    return NULL;
+}
 
-        /* decide operation */
-        if (meta->value.enum_item->name[0] == 'n') {
-            /* skip the node */
-            ++(*idx);
+sr_error_info_t *
+sr_diff_set_getnext(struct ly_set *set, uint32_t *idx, struct lyd_node **node, sr_change_oper_t *op)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *key;
+    int skip;
 
-            /* in case of lists we want to also skip all their keys (but because of the XPath, there may be none selected) */
-            if ((*node)->schema->nodetype == LYS_LIST) {
-                while (*idx < set->count) {
-                    key = set->dnodes[*idx];
+    while (*idx < set->count) {
+        *node = set->dnodes[*idx];
+        ++(*idx);
 
-                    if (lysc_is_key(key->schema) && (lyd_parent(key) == *node)) {
-                        ++(*idx);
-                    } else {
-                        break;
-                    }
+        if ((err_info = sr_diff_node_change_oper(*node, &skip, op))) {
+            return err_info;
+        }
+        if (!skip) {
+            /* success */
+            return NULL;
+        }
+
+        /* in case of lists we want to also skip all their keys (but because of the XPath, there may be none selected) */
+        if ((*node)->schema->nodetype == LYS_LIST) {
+            while (*idx < set->count) {
+                key = set->dnodes[*idx];
+
+                if (lysc_is_key(key->schema) && (lyd_parent(key) == *node)) {
+                    ++(*idx);
+                } else {
+                    break;
                 }
             }
-            continue;
-        } else if (meta->value.enum_item->name[0] == 'c') {
-            *op = SR_OP_CREATED;
-        } else if (meta->value.enum_item->name[0] == 'd') {
-            *op = SR_OP_DELETED;
-        } else if (meta->value.enum_item->name[0] == 'r') {
-            if ((*node)->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
-                *op = SR_OP_MODIFIED;
-            } else if ((*node)->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
-                *op = SR_OP_MOVED;
-            } else {
-                SR_ERRINFO_INT(&err_info);
-                return err_info;
-            }
         }
-
-        /* success */
-        ++(*idx);
-        return NULL;
     }
 
     /* no more changes */
@@ -4062,11 +4607,28 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Learn whether a stored edit node owner is the deleted connection.
+ *
+ * @param[in] owner_cid CID of the node owner.
+ * @param[in] cid CID of the deleted connection, 0 for all the dead connections.
+ * @return Whether the node is owned by the deleted connection.
+ */
+static int
+sr_edit_oper_del_owner(sr_cid_t owner_cid, sr_cid_t cid)
+{
+    if (cid) {
+        return owner_cid == cid;
+    }
+
+    return owner_cid && !sr_conn_is_alive(owner_cid);
+}
+
 /**
  * @brief Update a stored edit subtree by deleting nodes belonging to a connection and optionally selected by an xpath.
  *
  * @param[in] subtree Subtree to update, may be freed.
- * @param[in] cid CID of the deleted connection.
+ * @param[in] cid CID of the deleted connection, 0 for all the dead connections.
  * @param[in] parent_cid CID effective for (inherited from) the @p subtree parent.
  * @param[in] set Set of nodes selected by an xpath, only these can be deleted. If NULL, all the nodes can be deleted.
  * @param[out] child_cid_p CID effective for the @p subtree, 0 if it was deleted.
@@ -4102,13 +4664,13 @@ sr_edit_oper_del_r(struct lyd_node *subtree, sr_cid_t cid, sr_cid_t parent_cid,
         }
     }
 
-    if ((cur_cid != cid) || (set && !ly_set_contains(set, subtree, NULL))) {
+    if (!sr_edit_oper_del_owner(cur_cid, cid) || (set && !ly_set_contains(set, subtree, NULL))) {
         /* this node is not owned by the connection or not selected by the xpath, the subtree is kept */
         *child_cid_p = cur_cid;
         return NULL;
     }
 
-    if (child_cid && (child_cid != cid)) {
+    if (child_cid && !sr_edit_oper_del_owner(child_cid, cid)) {
         /* this node was "deleted" but there are still some children */
         if (cid_own) {
             sr_edit_del_meta_attr(subtree, "cid");
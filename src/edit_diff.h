@@ -46,6 +46,15 @@ enum edit_op {
     EDIT_REMOVE
 };
 
+/**
+ * @brief Last node added into an edit by ::sr_edit_add(), used for creating following nodes relative to it.
+ */
+struct sr_edit_add_cache_s {
+    const char *xpath;      /**< XPath of the cached node, not owned. */
+    struct lyd_node *node;  /**< Cached edit node, NULL if none. */
+    int valid;              /**< Whether the schema of all the added XPaths is known to be valid. */
+};
+
 /**
  * @brief Callback for libyang diff apply.
  *
@@ -179,11 +188,22 @@ sr_error_info_t *sr_edit_mod_diff_edit_merge(struct lyd_node **diff, const struc
  * @param[in] val Optional relative leaf-list value for move change.
  * @param[in] origin Origin of the value, used only for ::SR_DS_OPERATIONAL. Must be prefixed (JSON format).
  * @param[in] isolate Whether to create the new operation separately (isolated) from the others.
+ * @param[in,out] cache Optional cache of the last added node, @p xpath must stay valid while it is used.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_edit_add(sr_session_ctx_t *session, const char *xpath, const char *value, const char *operation,
         const char *def_operation, const sr_move_position_t *position, const char *keys, const char *val,
-        const char *origin, int isolate);
+        const char *origin, int isolate, struct sr_edit_add_cache_s *cache);
+
+/**
+ * @brief Learn the change operation of a sysrepo diff node.
+ *
+ * @param[in] node Node from a sysrepo diff.
+ * @param[out] skip Whether the node is not a change and should be skipped, @p op is not set then.
+ * @param[out] op Change operation.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_diff_node_change_oper(const struct lyd_node *node, int *skip, sr_change_oper_t *op);
 
 /**
  * @brief Get next change from a sysrepo diff set.
@@ -200,7 +220,7 @@ sr_error_info_t *sr_diff_set_getnext(struct ly_set *set, uint32_t *idx, struct l
  * @brief Remove stored edit nodes that belong to a connection and that optionally match an xpath.
  *
  * @param[in,out] edit Edit to remove from.
- * @param[in] cid Connection ID of the deleted connection.
+ * @param[in] cid Connection ID of the deleted connection, 0 for all the dead connections.
  * @param[in] xpath XPath selecting nodes to consider for deletion, NULL for all the nodes.
  * @param[out] change_edit Optional change edit created for subscribers based on the changes made in oper edit.
  * @return err_info, NULL on success.
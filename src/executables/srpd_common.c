@@ -21,10 +21,13 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <libyang/libyang.h>
+
 #include "bin_common.h"
 #include "sysrepo.h"
 
@@ -180,3 +183,87 @@ srpd_sort_plugins(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, int plu
     sr_free_values(values, value_cnt);
     return SR_ERR_OK;
 }
+
+/**
+ * @brief Find a plugin by its name.
+ *
+ * @param[in] plugins Array of plugins.
+ * @param[in] plugin_count Number of plugins within the array.
+ * @param[in] name Name of the plugin, which may or may not include the extension.
+ * @return Index of the plugin, -1 if not found.
+ */
+static int
+srpd_plugin_find(const struct srpd_plugin_s *plugins, int plugin_count, const char *name)
+{
+    int i;
+
+    for (i = 0; i < plugin_count; ++i) {
+        if (!srpd_plugin_names_cmp(&plugins[i], name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int
+srpd_init_config(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, int plugin_count, const char *plugin_name,
+        uint32_t *thread_count, uint32_t *shared_workers)
+{
+    const char *xpath = "/sysrepo-plugind:sysrepo-plugind/plugin-init";
+    sr_data_t *data = NULL;
+    struct lyd_node *cont, *node, *dep;
+    struct srpd_plugin_s *plugin;
+    void *mem;
+    int r, rc = SR_ERR_OK, i;
+
+    *thread_count = 1;
+    *shared_workers = 4;
+
+    if ((r = sr_get_data(sess, xpath, 0, 0, 0, &data))) {
+        SRPLG_LOG_ERR(plugin_name, "Getting \"%s\" data failed (%s)", xpath, sr_strerror(r));
+        return r;
+    }
+    if (!data || !data->tree || lyd_find_path(data->tree, "plugin-init", 0, &cont)) {
+        /* nothing configured */
+        goto cleanup;
+    }
+
+    LY_LIST_FOR(lyd_child(cont), node) {
+        if (!strcmp(LYD_NAME(node), "threads")) {
+            *thread_count = ((struct lyd_node_term *)node)->value.uint8;
+            continue;
+        } else if (!strcmp(LYD_NAME(node), "shared-workers")) {
+            *shared_workers = ((struct lyd_node_term *)node)->value.uint8;
+            continue;
+        }
+
+        /* dependency */
+        if ((i = srpd_plugin_find(plugins, plugin_count, lyd_get_value(lyd_child(node)))) == -1) {
+            /* if the plugin wasn't found, it doesn't matter, it'll just be ignored */
+            continue;
+        }
+        plugin = &plugins[i];
+
+        for (dep = lyd_child(node)->next; dep; dep = dep->next) {
+            if ((i = srpd_plugin_find(plugins, plugin_count, lyd_get_value(dep))) == -1) {
+                SRPLG_LOG_WRN(plugin_name, "Plugin \"%s\" dependency \"%s\" not found.", plugin->plugin_name,
+                        lyd_get_value(dep));
+                continue;
+            }
+
+            mem = realloc(plugin->deps, (plugin->dep_count + 1) * sizeof *plugin->deps);
+            if (!mem) {
+                SRPLG_LOG_ERR(plugin_name, "Memory allocation failed (%s:%d).", __FILE__, __LINE__);
+                rc = SR_ERR_NO_MEMORY;
+                goto cleanup;
+            }
+            plugin->deps = mem;
+            plugin->deps[plugin->dep_count++] = i;
+        }
+    }
+
+cleanup:
+    sr_release_data(data);
+    return rc;
+}
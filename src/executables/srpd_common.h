@@ -27,13 +27,24 @@ struct srpd_int_plugin_s {
     const char *plugin_name;
 };
 
+#define SRPD_INIT_WAIT 0     /**< plugin initialization not yet started */
+#define SRPD_INIT_RUNNING 1  /**< plugin initialization in progress */
+#define SRPD_INIT_DONE 2     /**< plugin initialization finished, whether successfully or not */
+
 struct srpd_plugin_s {
     void *handle;
     srp_init_cb_t init_cb;
+    srp_init_shared_cb_t init_shared_cb;   /**< optional, used instead of init_cb */
     srp_cleanup_cb_t cleanup_cb;
     void *private_data;
     char *plugin_name;
     int initialized;
+
+    sr_session_ctx_t *sess;     /**< session passed to the plugin callbacks */
+    int *deps;                  /**< indices of plugins that must be initialized before this plugin */
+    int dep_count;
+    int init_state;             /**< SRPD_INIT_* */
+    uint64_t init_time;         /**< duration of the plugin initialization in microseconds */
 };
 
 /**
@@ -90,6 +101,22 @@ void srpd_swap(struct srpd_plugin_s *a, struct srpd_plugin_s *b);
  */
 int srpd_sort_plugins(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, int plugin_count, const char *plugin_name);
 
+/**
+ * @brief Learns the plugin initialization configuration.
+ *
+ * Dependencies are stored as plugin indices so the plugins must not be reordered afterwards.
+ *
+ * @param[in] sess Session to be used.
+ * @param[in] plugins Array of sorted plugins.
+ * @param[in] plugin_count Number of plugins within the array.
+ * @param[in] plugin_name Name of the plugin.
+ * @param[out] thread_count Number of threads to initialize the plugins with.
+ * @param[out] shared_workers Number of worker threads of the shared subscription structure.
+ * @return SR_ERR_OK on success.
+ */
+int srpd_init_config(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, int plugin_count, const char *plugin_name,
+        uint32_t *thread_count, uint32_t *shared_workers);
+
 /*
  * plugins
  */
@@ -20,10 +20,12 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <libyang/libyang.h>
 #include <sysrepo.h>
@@ -32,8 +34,35 @@
 #include "config.h"
 #include "srpd_common.h"
 
+#ifdef SR_HAVE_INOTIFY
+# include <sys/inotify.h>
+#endif
+
 #define SRPD_PLUGIN_NAME "srpd_rotation"
 
+/** number of threads compressing the rotated notification files */
+#define SRPD_ROTATION_WORKERS 2
+
+/**
+ * @brief Notification file waiting for rotation.
+ */
+struct srpd_rotation_file {
+    char *name;     /**< file name */
+    time_t time1;   /**< first derived time from the file name */
+    time_t time2;   /**< second derived time from the file name, the files are sorted by it */
+    int queued;     /**< whether the file is queued for compression */
+    int seen;       /**< flag used when rescanning the notification directory */
+};
+
+/**
+ * @brief Queued compression of a notification file.
+ */
+struct srpd_rotation_job {
+    char *name;                     /**< file name */
+    time_t time1;                   /**< first derived time from the file name */
+    struct srpd_rotation_job *next; /**< next queued job */
+};
+
 /**
  * @brief Internal struct for rotation.
  *
@@ -46,6 +75,11 @@ typedef struct {
     sr_subscription_ctx_t *subscr;
     pthread_t tid;
     ATOMIC_T running;
+    const char *notif_dir_name;             /**< notification folder, set while running */
+    struct srpd_rotation_job *jobs;         /**< first queued compression job */
+    struct srpd_rotation_job *jobs_last;    /**< last queued compression job */
+    pthread_mutex_t jobs_lock;              /**< lock for the job queue */
+    pthread_cond_t jobs_cond;               /**< condition for new queued jobs and stopping */
 } srpd_rotation_data_t;
 
 /**
@@ -149,120 +183,494 @@ srpd_format_check(const char *file_name, time_t *file_time1, time_t *file_time2)
     return 0;
 }
 
-static void *
-srpd_rotation_loop(void *arg)
+/**
+ * @brief Remove the timestamp index of a rotated notification file, if any.
+ *
+ * @param[in] notif_dir_name Notification folder.
+ * @param[in] file_name Rotated notification file name.
+ * @param[in] file_time1 First derived time from the file name.
+ */
+static void
+srpd_remove_notif_index(const char *notif_dir_name, const char *file_name, time_t file_time1)
 {
-    int rc = 0;
-    DIR *d = NULL;
-    struct dirent *dir = NULL;
-    time_t current_time, file_time2 = 0;
-    srpd_rotation_data_t *data = (srpd_rotation_data_t *)arg;
-    char *arg1 = NULL, *arg2 = NULL, *remove_str = NULL, *notif_dir_name = NULL;
+    char *path;
+    int len;
 
-    notif_dir_name = srpd_get_notif_path();
-    if (!notif_dir_name) {
-        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Notif directory is NULL.");
+    /* "<module>.notif.<time1>.idx", the index is not needed for the rotated file */
+    len = strstr(file_name, ".notif.") - file_name;
+    if (asprintf(&path, "%s%.*s.notif.%" PRId64 ".idx", notif_dir_name, len, file_name, (int64_t)file_time1) == -1) {
+        return;
+    }
+    if (remove(path) && (errno != ENOENT)) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Removing a file %s failed.", path);
+    }
+    free(path);
+}
+
+/**
+ * @brief Compress a notification file into the output folder and remove it.
+ *
+ * @param[in] data Rotation data.
+ * @param[in] file_name Notification file name.
+ * @param[in] file_time1 First derived time from the file name.
+ */
+static void
+srpd_rotation_compress(srpd_rotation_data_t *data, const char *file_name, time_t file_time1)
+{
+    char *arg1 = NULL, *arg2 = NULL, *remove_str = NULL;
+
+    /* build compressing args */
+    if (asprintf(&arg1, "%s%s.tar.gz", (char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), file_name) == -1) {
+        arg1 = NULL;
         goto cleanup;
     }
-    if (srpd_mkpath((char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), 0777, NULL) == -1) {
-        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Archive directory could not be created");
+
+    /* skip the leading slash */
+    if (asprintf(&arg2, "%s%s", data->notif_dir_name + 1, file_name) == -1) {
+        arg2 = NULL;
         goto cleanup;
     }
 
-    for ( ; ATOMIC_LOAD_RELAXED(data->running); sleep(1)) {
+    /* compress a file with tar in output folder */
+    if (srpd_exec(SRPD_PLUGIN_NAME, SRPD_TAR_BINARY, 6, SRPD_TAR_BINARY, "-czf", arg1, "-C", "/", arg2)) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Compressing a file %s failed.", arg2);
+        goto cleanup;
+    }
+    ATOMIC_INC_RELAXED(data->rotated_files_count);
 
-        /* remember current time */
-        time(&current_time);
+    if (asprintf(&remove_str, "%s%s", data->notif_dir_name, file_name) == -1) {
+        remove_str = NULL;
+        goto cleanup;
+    }
+
+    /* remove a file from notif folder */
+    if (remove(remove_str)) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Removing a file %s failed.", remove_str);
+    } else {
+        srpd_remove_notif_index(data->notif_dir_name, file_name, file_time1);
+    }
+
+cleanup:
+    free(arg1);
+    free(arg2);
+    free(remove_str);
+}
+
+/**
+ * @brief Move a notification file into the output folder.
+ *
+ * @param[in] data Rotation data.
+ * @param[in] file_name Notification file name.
+ * @param[in] file_time1 First derived time from the file name.
+ */
+static void
+srpd_rotation_move(srpd_rotation_data_t *data, const char *file_name, time_t file_time1)
+{
+    char *arg1 = NULL, *arg2 = NULL;
 
-        /* open directory */
-        d = opendir(notif_dir_name);
-        if (!d) {
-            continue;
+    /* build moving args */
+    if (asprintf(&arg1, "%s%s", data->notif_dir_name, file_name) == -1) {
+        arg1 = NULL;
+        goto cleanup;
+    }
+    if (asprintf(&arg2, "%s%s", (char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), file_name) == -1) {
+        arg2 = NULL;
+        goto cleanup;
+    }
+
+    /* move a file to the output folder */
+    if (rename(arg1, arg2) == -1) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Moving a file %s failed.", arg1);
+    } else {
+        ATOMIC_INC_RELAXED(data->rotated_files_count);
+        srpd_remove_notif_index(data->notif_dir_name, file_name, file_time1);
+    }
+
+cleanup:
+    free(arg1);
+    free(arg2);
+}
+
+/**
+ * @brief Compression worker thread, compresses the queued notification files until rotation is stopped.
+ *
+ * @param[in] arg Rotation data.
+ * @return NULL.
+ */
+static void *
+srpd_rotation_worker(void *arg)
+{
+    srpd_rotation_data_t *data = (srpd_rotation_data_t *)arg;
+    struct srpd_rotation_job *job;
+
+    /* JOBS LOCK */
+    pthread_mutex_lock(&data->jobs_lock);
+
+    while (1) {
+        while (!data->jobs && ATOMIC_LOAD_RELAXED(data->running)) {
+            pthread_cond_wait(&data->jobs_cond, &data->jobs_lock);
+        }
+        if (!ATOMIC_LOAD_RELAXED(data->running)) {
+            break;
         }
 
-        /* read whole directory */
-        while ((dir = readdir(d)) && ATOMIC_LOAD_RELAXED(data->running)) {
+        /* dequeue the first job */
+        job = data->jobs;
+        data->jobs = job->next;
+        if (!data->jobs) {
+            data->jobs_last = NULL;
+        }
 
-            /* skip current and parent directories */
-            if (!strcmp(dir->d_name, ".") || !strcmp(dir->d_name, "..")) {
-                continue;
-            }
+        /* JOBS UNLOCK */
+        pthread_mutex_unlock(&data->jobs_lock);
 
-            /* check correct format of the file and retrieve file times */
-            if (srpd_format_check(dir->d_name, NULL, &file_time2)) {
-                continue;
-            }
+        /* compress without blocking the rotation loop or other workers */
+        srpd_rotation_compress(data, job->name, job->time1);
+        free(job->name);
+        free(job);
 
-            /* check whether a file is older than configured time */
-            if ((current_time >= (time_t)ATOMIC_LOAD_RELAXED(data->rotation_time)) &&
-                    (file_time2 < (current_time - (time_t)ATOMIC_LOAD_RELAXED(data->rotation_time)))) {
+        /* JOBS LOCK */
+        pthread_mutex_lock(&data->jobs_lock);
+    }
 
-                /* build compressing args */
-                if (ATOMIC_LOAD_RELAXED(data->compress)) {
-                    if (asprintf(&arg1, "%s%s.tar.gz", (char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), dir->d_name) == -1) {
-                        goto cleanup;
-                    }
+    /* JOBS UNLOCK */
+    pthread_mutex_unlock(&data->jobs_lock);
 
-                    /* skip the leading slash */
-                    if (asprintf(&arg2, "%s%s", notif_dir_name + 1, dir->d_name) == -1) {
-                        goto cleanup;
-                    }
+    return NULL;
+}
 
-                    /* compress a file with tar in output folder */
-                    if ((rc = srpd_exec(SRPD_PLUGIN_NAME, SRPD_TAR_BINARY, 6, SRPD_TAR_BINARY, "-czf", arg1, "-C", "/", arg2))) {
-                        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Compressing a file %s failed.", arg2);
-                    } else {
-                        ATOMIC_INC_RELAXED(data->rotated_files_count);
+/**
+ * @brief Queue compression of a notification file for the workers.
+ *
+ * @param[in] data Rotation data.
+ * @param[in] file File to compress.
+ * @return 0 on success.
+ * @return 1 on failure.
+ */
+static int
+srpd_rotation_queue(srpd_rotation_data_t *data, const struct srpd_rotation_file *file)
+{
+    struct srpd_rotation_job *job;
+    int rc = 0;
 
-                        if (asprintf(&remove_str, "%s%s", notif_dir_name, dir->d_name) == -1) {
-                            goto cleanup;
-                        }
+    /* JOBS LOCK */
+    pthread_mutex_lock(&data->jobs_lock);
 
-                        /* remove a file from notif folder */
-                        if (remove(remove_str)) {
-                            SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Removing a file %s failed.", remove_str);
-                        }
-                    }
+    /* the file may be rediscovered by a rescan while still queued */
+    for (job = data->jobs; job; job = job->next) {
+        if (!strcmp(job->name, file->name)) {
+            goto cleanup;
+        }
+    }
 
-                    /* build moving args */
-                } else {
-                    if (asprintf(&arg1, "%s%s", notif_dir_name, dir->d_name) == -1) {
-                        goto cleanup;
-                    }
-                    if (asprintf(&arg2, "%s%s", (char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), dir->d_name) == -1) {
-                        goto cleanup;
-                    }
+    job = calloc(1, sizeof *job);
+    if (!job || !(job->name = strdup(file->name))) {
+        free(job);
+        rc = 1;
+        goto cleanup;
+    }
+    job->time1 = file->time1;
+
+    if (data->jobs_last) {
+        data->jobs_last->next = job;
+    } else {
+        data->jobs = job;
+    }
+    data->jobs_last = job;
+    pthread_cond_signal(&data->jobs_cond);
+
+cleanup:
+    /* JOBS UNLOCK */
+    pthread_mutex_unlock(&data->jobs_lock);
+    return rc;
+}
+
+/**
+ * @brief Add a notification file to the files waiting for rotation, if not there yet.
+ *
+ * @param[in,out] files Files sorted by their second time.
+ * @param[in,out] file_count Count of @p files.
+ * @param[in] file_name File name, ignored if not a notification file.
+ * @return 0 on success.
+ * @return 1 on failure.
+ */
+static int
+srpd_rotation_file_add(struct srpd_rotation_file **files, uint32_t *file_count, const char *file_name)
+{
+    struct srpd_rotation_file *mem;
+    time_t file_time1, file_time2;
+    uint32_t i, idx;
+
+    /* check correct format of the file and retrieve file times */
+    if (srpd_format_check(file_name, &file_time1, &file_time2)) {
+        return 0;
+    }
+
+    idx = *file_count;
+    for (i = 0; i < *file_count; ++i) {
+        if (!strcmp((*files)[i].name, file_name)) {
+            (*files)[i].seen = 1;
+            return 0;
+        }
+        if ((idx == *file_count) && ((*files)[i].time2 > file_time2)) {
+            idx = i;
+        }
+    }
+
+    mem = realloc(*files, (*file_count + 1) * sizeof **files);
+    if (!mem) {
+        return 1;
+    }
+    *files = mem;
+
+    /* keep the files sorted so only the oldest ones need to be checked */
+    memmove(&(*files)[idx + 1], &(*files)[idx], (*file_count - idx) * sizeof **files);
+    memset(&(*files)[idx], 0, sizeof **files);
+    if (!((*files)[idx].name = strdup(file_name))) {
+        memmove(&(*files)[idx], &(*files)[idx + 1], (*file_count - idx) * sizeof **files);
+        return 1;
+    }
+    (*files)[idx].time1 = file_time1;
+    (*files)[idx].time2 = file_time2;
+    (*files)[idx].seen = 1;
+    ++(*file_count);
+
+    return 0;
+}
+
+/**
+ * @brief Remove a file from the files waiting for rotation.
+ *
+ * @param[in,out] files Files sorted by their second time.
+ * @param[in,out] file_count Count of @p files.
+ * @param[in] idx Index of the file to remove.
+ */
+static void
+srpd_rotation_file_del(struct srpd_rotation_file *files, uint32_t *file_count, uint32_t idx)
+{
+    free(files[idx].name);
+    --(*file_count);
+    memmove(&files[idx], &files[idx + 1], (*file_count - idx) * sizeof *files);
+}
+
+/**
+ * @brief Scan the notification folder and update the files waiting for rotation.
+ *
+ * @param[in] notif_dir_name Notification folder.
+ * @param[in,out] files Files sorted by their second time.
+ * @param[in,out] file_count Count of @p files.
+ */
+static void
+srpd_rotation_scan(const char *notif_dir_name, struct srpd_rotation_file **files, uint32_t *file_count)
+{
+    DIR *d;
+    struct dirent *dir;
+    uint32_t i;
+
+    /* open directory */
+    d = opendir(notif_dir_name);
+    if (!d) {
+        return;
+    }
+
+    for (i = 0; i < *file_count; ++i) {
+        (*files)[i].seen = 0;
+    }
+
+    /* read whole directory */
+    while ((dir = readdir(d))) {
+        if (srpd_rotation_file_add(files, file_count, dir->d_name)) {
+            SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Memory allocation failed (%s:%d).", __FILE__, __LINE__);
+            break;
+        }
+    }
+    closedir(d);
+
+    /* forget removed files, unless the scan failed */
+    for (i = 0; !dir && (i < *file_count); ) {
+        if (!(*files)[i].seen) {
+            srpd_rotation_file_del(*files, file_count, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+/**
+ * @brief Wait for changes in the notification folder and update the files waiting for rotation.
+ *
+ * @param[in] fd Inotify file descriptor watching the notification folder, -1 if not available.
+ * @param[in,out] files Files sorted by their second time.
+ * @param[in,out] file_count Count of @p files.
+ * @param[out] rescan Set if the whole folder needs to be scanned.
+ */
+static void
+srpd_rotation_wait(int fd, struct srpd_rotation_file **files, uint32_t *file_count, int *rescan)
+{
+#ifdef SR_HAVE_INOTIFY
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *event;
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    ssize_t len;
+    char *ptr;
+    uint32_t i;
+
+    if (fd == -1) {
+        sleep(1);
+        *rescan = 1;
+        return;
+    }
+
+    /* wake up at least every second to check the file times */
+    if (poll(&pfd, 1, 1000) < 1) {
+        return;
+    }
+
+    while ((len = read(fd, buf, sizeof buf)) > 0) {
+        for (ptr = buf; ptr < buf + len; ptr += sizeof *event + event->len) {
+            event = (const struct inotify_event *)ptr;
 
-                    /* move a file to the output folder */
-                    if ((rc = rename(arg1, arg2)) == -1) {
-                        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Moving a file %s failed.", arg1);
-                    } else {
-                        ATOMIC_INC_RELAXED(data->rotated_files_count);
+            if (event->mask & IN_Q_OVERFLOW) {
+                /* some events were lost */
+                *rescan = 1;
+            } else if (!event->len) {
+                continue;
+            } else if (event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                for (i = 0; i < *file_count; ++i) {
+                    if (!strcmp((*files)[i].name, event->name)) {
+                        srpd_rotation_file_del(*files, file_count, i);
+                        break;
                     }
                 }
+            } else if (srpd_rotation_file_add(files, file_count, event->name)) {
+                /* try to learn about the file later */
+                *rescan = 1;
+            }
+        }
+    }
+#else
+    (void)fd;
+    (void)files;
+    (void)file_count;
+
+    sleep(1);
+    *rescan = 1;
+#endif
+}
+
+static void *
+srpd_rotation_loop(void *arg)
+{
+    int r, fd = -1, rescan = 1;
+    time_t current_time, rotation_time;
+    srpd_rotation_data_t *data = (srpd_rotation_data_t *)arg;
+    char *notif_dir_name = NULL;
+    struct srpd_rotation_file *files = NULL;
+    struct srpd_rotation_job *job;
+    pthread_t workers[SRPD_ROTATION_WORKERS];
+    uint32_t i, file_count = 0, worker_count = 0;
+
+    notif_dir_name = srpd_get_notif_path();
+    if (!notif_dir_name) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Notif directory is NULL.");
+        goto cleanup;
+    }
+    if (srpd_mkpath((char *)ATOMIC_PTR_LOAD_RELAXED(data->output_folder), 0777, NULL) == -1) {
+        SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Archive directory could not be created");
+        goto cleanup;
+    }
+    data->notif_dir_name = notif_dir_name;
+
+    /* start the compression workers */
+    for (worker_count = 0; worker_count < SRPD_ROTATION_WORKERS; ++worker_count) {
+        if ((r = pthread_create(&workers[worker_count], NULL, &srpd_rotation_worker, data))) {
+            SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Pthread create failed (%s).", strerror(r));
+            break;
+        }
+    }
+    if (!worker_count) {
+        goto cleanup;
+    }
 
-                /* reset commands for next folders */
-                rc = 0;
-                free(arg1);
-                free(arg2);
-                free(remove_str);
-                arg1 = NULL;
-                arg2 = NULL;
-                remove_str = NULL;
+#ifdef SR_HAVE_INOTIFY
+    /* watch the notification folder instead of scanning it periodically */
+    if ((fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+        SRPLG_LOG_WRN(SRPD_PLUGIN_NAME, "Inotify init failed (%s), scanning notification folder.", strerror(errno));
+    } else if (inotify_add_watch(fd, notif_dir_name, IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+            IN_DELETE) == -1) {
+        SRPLG_LOG_WRN(SRPD_PLUGIN_NAME, "Inotify watch failed (%s), scanning notification folder.", strerror(errno));
+        close(fd);
+        fd = -1;
+    }
+#endif
+
+    while (ATOMIC_LOAD_RELAXED(data->running)) {
+        if (rescan) {
+            srpd_rotation_scan(notif_dir_name, &files, &file_count);
+            rescan = 0;
+        }
+
+        /* remember current time */
+        time(&current_time);
+        rotation_time = ATOMIC_LOAD_RELAXED(data->rotation_time);
+
+        /* check the oldest files whether they are older than configured time */
+        for (i = 0; (current_time >= rotation_time) && (i < file_count) &&
+                (files[i].time2 < current_time - rotation_time); ) {
+            if (files[i].queued) {
+                /* being compressed */
+                ++i;
+            } else if (ATOMIC_LOAD_RELAXED(data->compress)) {
+                /* compressed by a worker, forgotten once it is removed */
+                if (srpd_rotation_queue(data, &files[i])) {
+                    SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "Memory allocation failed (%s:%d).", __FILE__, __LINE__);
+                    break;
+                }
+                files[i].queued = 1;
+                ++i;
+            } else {
+                srpd_rotation_move(data, files[i].name, files[i].time1);
+                srpd_rotation_file_del(files, &file_count, i);
             }
         }
-        closedir(d);
-        d = NULL;
+
+        /* wait for new files */
+        srpd_rotation_wait(fd, &files, &file_count, &rescan);
     }
 
 cleanup:
-    free(arg1);
-    free(arg2);
-    free(remove_str);
-    free(notif_dir_name);
-    if (d) {
-        closedir(d);
+    if (worker_count) {
+        /* JOBS LOCK */
+        pthread_mutex_lock(&data->jobs_lock);
+        /* wake the workers, running is not set anymore */
+        pthread_cond_broadcast(&data->jobs_cond);
+        /* JOBS UNLOCK */
+        pthread_mutex_unlock(&data->jobs_lock);
+
+        for (i = 0; i < worker_count; ++i) {
+            if ((r = pthread_join(workers[i], NULL))) {
+                SRPLG_LOG_ERR(SRPD_PLUGIN_NAME, "pthread_join failed (%s).", strerror(r));
+            }
+        }
     }
+
+    /* the remaining files are queued again on the next start */
+    while ((job = data->jobs)) {
+        data->jobs = job->next;
+        free(job->name);
+        free(job);
+    }
+    data->jobs_last = NULL;
+    data->notif_dir_name = NULL;
+
+    for (i = 0; i < file_count; ++i) {
+        free(files[i].name);
+    }
+    free(files);
+    if (fd > -1) {
+        close(fd);
+    }
+    free(notif_dir_name);
     return NULL;
 }
 
@@ -384,6 +792,8 @@ srpd_rotation_init_cb(sr_session_ctx_t *session, void **private_data)
         rc = SR_ERR_NO_MEMORY;
         goto cleanup;
     }
+    pthread_mutex_init(&data->jobs_lock, NULL);
+    pthread_cond_init(&data->jobs_cond, NULL);
 
     /* create notification rotation change subscription */
     if ((rc = sr_module_change_subscribe(session, "sysrepo-plugind", "/sysrepo-plugind:sysrepo-plugind/notif-datastore/rotation/enabled",
@@ -403,6 +813,8 @@ cleanup:
     if (rc) {
         if (data) {
             sr_unsubscribe(data->subscr);
+            pthread_mutex_destroy(&data->jobs_lock);
+            pthread_cond_destroy(&data->jobs_cond);
             free(data);
         }
     } else {
@@ -425,5 +837,7 @@ srpd_rotation_cleanup_cb(sr_session_ctx_t *UNUSED(session), void *private_data)
         }
     }
     free(ATOMIC_PTR_LOAD_RELAXED(data->output_folder));
+    pthread_mutex_destroy(&data->jobs_lock);
+    pthread_cond_destroy(&data->jobs_cond);
     free(data);
 }
@@ -23,6 +23,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
@@ -32,6 +33,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "bin_common.h"
@@ -50,6 +52,19 @@ pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
 /** The name of the configuration module for the sysrepo-plugind program itself. */
 #define SRPD_MODULE_NAME "sysrepo-plugind"
 
+/**
+ * @brief Plugin initialization shared by all the initializing threads.
+ */
+struct srpd_init_s {
+    struct srpd_plugin_s *plugins;  /**< array of plugins */
+    int plugin_count;               /**< number of plugins within the array */
+    int fatal_fail;                 /**< whether a plugin initialization failure stops all the initialization */
+    int failed;                     /**< set if the initialization was stopped */
+    sr_subscription_ctx_t *subscr;  /**< shared subscription structure */
+    pthread_mutex_t lock;           /**< lock for accessing plugin init states and @p failed */
+    pthread_cond_t cond;            /**< signalled when a plugin initialization finishes */
+};
+
 /**
  * @brief An array of internal plugins
  */
@@ -326,9 +341,10 @@ load_plugins(struct srpd_plugin_s **plugins, int *plugin_count)
         plugin = &(*plugins)[*plugin_count];
         memset(plugin, 0, sizeof *plugin);
 
-        /* find required functions */
+        /* find required functions, the shared init callback is preferred */
+        *(void **)&plugin->init_shared_cb = dlsym(handle, SRP_INIT_SHARED_CB);
         *(void **)&plugin->init_cb = dlsym(handle, SRP_INIT_CB);
-        if (!plugin->init_cb) {
+        if (!plugin->init_shared_cb && !plugin->init_cb) {
             error_print(0, "Failed to find function \"%s\" in plugin \"%s\".", SRP_INIT_CB, ent->d_name);
             dlclose(handle);
             rc = -1;
@@ -369,11 +385,192 @@ load_plugins(struct srpd_plugin_s **plugins, int *plugin_count)
     return rc;
 }
 
+/**
+ * @brief Initialize a single plugin and measure the time it took.
+ *
+ * @param[in] plugin Plugin to initialize.
+ * @param[in] subscr Shared subscription structure.
+ * @return Plugin init callback return value.
+ */
+static int
+init_plugin(struct srpd_plugin_s *plugin, sr_subscription_ctx_t *subscr)
+{
+    struct timespec start, end;
+    int r;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (plugin->init_shared_cb) {
+        r = plugin->init_shared_cb(plugin->sess, subscr, &plugin->private_data);
+    } else {
+        r = plugin->init_cb(plugin->sess, &plugin->private_data);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    plugin->init_time = (end.tv_sec - start.tv_sec) * 1000000ULL;
+    plugin->init_time += (end.tv_nsec - start.tv_nsec) / 1000;
+
+    if (r) {
+        SRPLG_LOG_ERR("sysrepo-plugind", "Plugin \"%s\" initialization failed (%s).", plugin->plugin_name,
+                sr_strerror(r));
+    } else {
+        SRPLG_LOG_INF("sysrepo-plugind", "Plugin \"%s\" initialized (%" PRIu64 " us).", plugin->plugin_name,
+                plugin->init_time);
+        plugin->initialized = 1;
+    }
+    return r;
+}
+
+/**
+ * @brief Initialize plugins, in their order, once all their dependencies are initialized.
+ *
+ * Thread function, may be run by several threads concurrently.
+ *
+ * @param[in] arg Shared plugin initialization.
+ * @return NULL.
+ */
+static void *
+init_plugins_thread(void *arg)
+{
+    struct srpd_init_s *init = arg;
+    struct srpd_plugin_s *plugin, *p;
+    int i, j, first, running, dep_failed, r;
+
+    pthread_mutex_lock(&init->lock);
+    while (!init->failed) {
+        /* find the first waiting plugin with all the dependencies initialized */
+        plugin = NULL;
+        first = -1;
+        running = 0;
+        dep_failed = 0;
+        for (i = 0; i < init->plugin_count; ++i) {
+            p = &init->plugins[i];
+            if (p->init_state == SRPD_INIT_RUNNING) {
+                ++running;
+            }
+            if (plugin || (p->init_state != SRPD_INIT_WAIT)) {
+                continue;
+            }
+            if (first == -1) {
+                first = i;
+            }
+
+            for (j = 0; j < p->dep_count; ++j) {
+                if (init->plugins[p->deps[j]].init_state != SRPD_INIT_DONE) {
+                    break;
+                }
+                if (!init->plugins[p->deps[j]].initialized) {
+                    dep_failed = 1;
+                }
+            }
+            if (j == p->dep_count) {
+                plugin = p;
+            } else {
+                dep_failed = 0;
+            }
+        }
+
+        if (first == -1) {
+            /* all the plugins are initialized or being initialized */
+            break;
+        }
+        if (!plugin) {
+            if (running) {
+                /* wait for a plugin initialization to finish */
+                pthread_cond_wait(&init->cond, &init->lock);
+                continue;
+            }
+
+            /* nothing can finish, there must be a dependency cycle */
+            plugin = &init->plugins[first];
+            SRPLG_LOG_WRN("sysrepo-plugind", "Plugin \"%s\" dependencies cannot be satisfied (cyclic dependency?).",
+                    plugin->plugin_name);
+        } else if (dep_failed) {
+            SRPLG_LOG_ERR("sysrepo-plugind", "Plugin \"%s\" not initialized because of a failed dependency.",
+                    plugin->plugin_name);
+            plugin->init_state = SRPD_INIT_DONE;
+            if (init->fatal_fail) {
+                init->failed = 1;
+            }
+            pthread_cond_broadcast(&init->cond);
+            continue;
+        }
+        plugin->init_state = SRPD_INIT_RUNNING;
+
+        pthread_mutex_unlock(&init->lock);
+        r = init_plugin(plugin, init->subscr);
+        pthread_mutex_lock(&init->lock);
+
+        plugin->init_state = SRPD_INIT_DONE;
+        if (r && init->fatal_fail) {
+            init->failed = 1;
+        }
+        pthread_cond_broadcast(&init->cond);
+    }
+    pthread_mutex_unlock(&init->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Initialize all the plugins.
+ *
+ * @param[in] plugins Array of plugins.
+ * @param[in] plugin_count Number of plugins within the array.
+ * @param[in] thread_count Number of threads to initialize independent plugins concurrently.
+ * @param[in] fatal_fail Whether to stop the initialization on the first plugin failure.
+ * @param[in] subscr Shared subscription structure for plugins with the shared init callback.
+ * @return 0 on success.
+ * @return -1 if a plugin failed and @p fatal_fail was set.
+ */
+static int
+init_plugins(struct srpd_plugin_s *plugins, int plugin_count, uint32_t thread_count, int fatal_fail,
+        sr_subscription_ctx_t *subscr)
+{
+    struct srpd_init_s init = {0};
+    pthread_t *tids = NULL;
+    uint32_t i, tid_count = 0;
+    int r;
+
+    init.plugins = plugins;
+    init.plugin_count = plugin_count;
+    init.fatal_fail = fatal_fail;
+    init.subscr = subscr;
+    pthread_mutex_init(&init.lock, NULL);
+    pthread_cond_init(&init.cond, NULL);
+
+    if (thread_count > (uint32_t)plugin_count) {
+        thread_count = plugin_count;
+    }
+    if (thread_count > 1) {
+        /* this thread is also initializing plugins */
+        tids = malloc((thread_count - 1) * sizeof *tids);
+        for (i = 0; tids && (i < thread_count - 1); ++i) {
+            if ((r = pthread_create(&tids[i], NULL, init_plugins_thread, &init))) {
+                /* fewer threads will do */
+                SRPLG_LOG_WRN("sysrepo-plugind", "Creating an init thread failed (%s).", strerror(r));
+                break;
+            }
+            ++tid_count;
+        }
+    }
+
+    init_plugins_thread(&init);
+
+    for (i = 0; i < tid_count; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+    free(tids);
+    pthread_cond_destroy(&init.cond);
+    pthread_mutex_destroy(&init.lock);
+
+    return init.failed ? -1 : 0;
+}
+
 static int
 publish_loaded_plugins(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, int plugin_count)
 {
     int rc = SR_ERR_OK, i;
-    char *xpath;
+    char *xpath, *value;
 
     /* switch to operational */
     sr_session_switch_ds(sess, SR_DS_OPERATIONAL);
@@ -390,6 +587,24 @@ publish_loaded_plugins(sr_session_ctx_t *sess, struct srpd_plugin_s *plugins, in
             if (rc) {
                 goto cleanup;
             }
+
+            /* add its init time */
+            if (asprintf(&xpath, "/sysrepo-plugind:sysrepo-plugind/loaded-plugins/init-time[plugin='%s']/duration",
+                    plugins[i].plugin_name) == -1) {
+                rc = SR_ERR_NO_MEMORY;
+                goto cleanup;
+            }
+            if (asprintf(&value, "%" PRIu64, plugins[i].init_time) == -1) {
+                free(xpath);
+                rc = SR_ERR_NO_MEMORY;
+                goto cleanup;
+            }
+            rc = sr_set_item_str(sess, xpath, value, NULL, 0);
+            free(xpath);
+            free(value);
+            if (rc) {
+                goto cleanup;
+            }
         }
     }
 
@@ -457,8 +672,10 @@ main(int argc, char **argv)
     struct srpd_plugin_s *plugins = NULL;
     sr_conn_ctx_t *conn = NULL;
     sr_session_ctx_t *sess = NULL;
+    sr_subscription_ctx_t *subscr = NULL;
     sr_log_level_t log_level = SR_LL_ERR;
     int plugin_count = 0, i, r, rc = EXIT_FAILURE, opt, debug = 0, pidfd = -1, fatal_fail = 0;
+    uint32_t thread_count, shared_workers;
     const char *plugins_dir, *pidfile = NULL;
 
     struct option options[] = {
@@ -568,21 +785,38 @@ main(int argc, char **argv)
         goto cleanup;
     }
 
-    /* init plugins */
+    /* learn the threads and plugin dependencies */
+    if ((r = srpd_init_config(sess, plugins, plugin_count, "sysrepo-plugind", &thread_count, &shared_workers))) {
+        error_print(r, "Getting plugin init configuration failed.");
+        goto cleanup;
+    }
+
+    /* create the subscription shared by plugins that opted in, handling all their events by a worker pool */
     for (i = 0; i < plugin_count; ++i) {
-        r = plugins[i].init_cb(sess, &plugins[i].private_data);
-        if (r) {
-            SRPLG_LOG_ERR("sysrepo-plugind", "Plugin \"%s\" initialization failed (%s).", plugins[i].plugin_name,
-                    sr_strerror(r));
-            if (fatal_fail) {
+        if (plugins[i].init_shared_cb) {
+            if ((r = sr_subscription_create(conn, SR_SUBSCR_THREAD_POOL, shared_workers, &subscr))) {
+                error_print(r, "Failed to create the shared subscription");
                 goto cleanup;
             }
-        } else {
-            SRPLG_LOG_INF("sysrepo-plugind", "Plugin \"%s\" initialized.", plugins[i].plugin_name);
-            plugins[i].initialized = 1;
+            break;
+        }
+    }
+
+    /* plugins initialized concurrently need their own sessions */
+    for (i = 0; i < plugin_count; ++i) {
+        if (thread_count < 2) {
+            plugins[i].sess = sess;
+        } else if ((r = sr_session_start(conn, SR_DS_RUNNING, &plugins[i].sess)) != SR_ERR_OK) {
+            error_print(r, "Failed to start new session");
+            goto cleanup;
         }
     }
 
+    /* init plugins */
+    if (init_plugins(plugins, plugin_count, thread_count, fatal_fail, subscr)) {
+        goto cleanup;
+    }
+
     /* set state data */
     if ((r = publish_loaded_plugins(sess, plugins, plugin_count))) {
         error_print(r, "Failed to publish loaded plugins.");
@@ -618,13 +852,19 @@ cleanup:
     for (i = 0; i < plugin_count; ++i) {
         /* plugin cleanup */
         if (plugins[i].initialized) {
-            plugins[i].cleanup_cb(sess, plugins[i].private_data);
+            plugins[i].cleanup_cb(plugins[i].sess, plugins[i].private_data);
         }
+    }
 
+    /* stop handling the events of the shared subscription before the plugin callbacks are unloaded */
+    sr_unsubscribe(subscr);
+
+    for (i = 0; i < plugin_count; ++i) {
         if (plugins[i].handle) {
             dlclose(plugins[i].handle);
         }
         free(plugins[i].plugin_name);
+        free(plugins[i].deps);
     }
     free(plugins);
 
@@ -20,11 +20,13 @@
 
 #include <errno.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -92,6 +94,13 @@ help_print(void)
             "  -o, --opaque                 Parse invalid nodes in the edit into opaque nodes. Accepted by edit op.\n"
             "  -p, --depth <depth>          Limit the depth of returned subtrees, 0 (unlimited) by default. Accepted by\n"
             "                               export op.\n"
+            "  -c, --chunk <count>          Process the data in chunks to limit memory use. Export prints the data module\n"
+            "                               by module and at most <count> top-level subtrees at once (\"xml\" only), import\n"
+            "                               replaces the configuration module by module. Accepted by import, export op.\n"
+            "  -j, --jobs <count>           Get or replace the data of modules concurrently using <count> sessions, 1 by\n"
+            "                               default. Export merges the data in the module order (\"xml\" only) unless\n"
+            "                               the path is a directory, then each module is written into <module>.<format>\n"
+            "                               and import reads these files. Accepted by import, export op without a module.\n"
             "  -t, --timeout <seconds>      Set the timeout for the operation, otherwise the default one is used.\n"
             "                               Accepted by all op.\n"
             "  -e, --defaults <wd-mode>     Print the default values, which are trimmed by default (\"report-all\",\n"
@@ -339,9 +348,406 @@ step_create_input_file(LYD_FORMAT format, char *tmp_file)
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Check whether a module can have data to be imported or exported one by one.
+ */
+static int
+step_module_has_data(const struct lys_module *ly_mod)
+{
+    return ly_mod->implemented && ly_mod->compiled && ly_mod->compiled->data && strcmp(ly_mod->name, "sysrepo");
+}
+
+/**
+ * @brief Per-module operation run concurrently by several jobs.
+ */
+struct jobs_s {
+    sr_conn_ctx_t *conn;            /**< connection, each job uses its own session */
+    sr_datastore_t ds;              /**< datastore of the sessions */
+    const struct ly_ctx *ly_ctx;    /**< acquired connection context */
+    const char *dir;                /**< directory with per-module files, NULL if not used */
+    LYD_FORMAT format;              /**< data format */
+    int not_strict;                 /**< import: ignore unknown data */
+    uint32_t max_depth;             /**< export: maximum depth of the subtrees */
+    int wd_opt;                     /**< export: with-defaults print flag */
+    int timeout_s;                  /**< operation timeout */
+
+    struct jobs_mod_s {
+        const struct lys_module *ly_mod;    /**< module to process */
+        struct lyd_node *data;      /**< import: module data to replace with, unless read from @p dir */
+        char *out;                  /**< export: printed module data, unless written into @p dir */
+        int done;                   /**< whether the module was processed */
+    } *mods;                        /**< modules to process, in the context order */
+    uint32_t mod_count;             /**< count of modules */
+    uint32_t next;                  /**< index of the next module to process */
+    int failed;                     /**< set if processing any module failed, no more modules are processed */
+
+    pthread_mutex_t lock;           /**< lock for accessing @p next, @p failed, and module @p done flags */
+    pthread_cond_t cond;            /**< signalled when a module is processed */
+};
+
+static int
+step_jobs_init(sr_session_ctx_t *sess, const struct ly_ctx *ly_ctx, struct jobs_s *jobs)
+{
+    const struct lys_module *ly_mod;
+    uint32_t idx = 0;
+    void *mem;
+
+    jobs->conn = sr_session_get_connection(sess);
+    jobs->ds = sr_session_get_ds(sess);
+    jobs->ly_ctx = ly_ctx;
+    pthread_mutex_init(&jobs->lock, NULL);
+    pthread_cond_init(&jobs->cond, NULL);
+
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &idx))) {
+        if (!step_module_has_data(ly_mod)) {
+            continue;
+        }
+
+        mem = realloc(jobs->mods, (jobs->mod_count + 1) * sizeof *jobs->mods);
+        if (!mem) {
+            error_print(SR_ERR_NO_MEMORY, "Memory allocation failed");
+            return EXIT_FAILURE;
+        }
+        jobs->mods = mem;
+        memset(&jobs->mods[jobs->mod_count], 0, sizeof *jobs->mods);
+        jobs->mods[jobs->mod_count].ly_mod = ly_mod;
+        ++jobs->mod_count;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void
+step_jobs_free(struct jobs_s *jobs)
+{
+    uint32_t i;
+
+    for (i = 0; i < jobs->mod_count; ++i) {
+        lyd_free_siblings(jobs->mods[i].data);
+        free(jobs->mods[i].out);
+    }
+    free(jobs->mods);
+    pthread_cond_destroy(&jobs->cond);
+    pthread_mutex_destroy(&jobs->lock);
+}
+
+static void
+step_jobs_split(struct jobs_s *jobs, struct lyd_node *data)
+{
+    struct lyd_node *node, *next;
+    const struct lys_module *ly_mod;
+    uint32_t i = 0;
+
+    LY_LIST_FOR_SAFE(data, next, node) {
+        /* siblings of a module are usually next to each other */
+        ly_mod = lyd_owner_module(node);
+        if ((i == jobs->mod_count) || (jobs->mods[i].ly_mod != ly_mod)) {
+            for (i = 0; i < jobs->mod_count; ++i) {
+                if (jobs->mods[i].ly_mod == ly_mod) {
+                    break;
+                }
+            }
+        }
+        if (i == jobs->mod_count) {
+            /* no module to import */
+            continue;
+        }
+
+        if (node == data) {
+            data = next;
+        }
+        lyd_unlink_tree(node);
+        lyd_insert_sibling(jobs->mods[i].data, node, &jobs->mods[i].data);
+    }
+
+    lyd_free_siblings(data);
+}
+
+static int
+step_jobs_next(struct jobs_s *jobs, uint32_t *idx)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&jobs->lock);
+    if (!jobs->failed && (jobs->next < jobs->mod_count)) {
+        *idx = jobs->next++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&jobs->lock);
+
+    return found;
+}
+
+static void
+step_jobs_done(struct jobs_s *jobs, uint32_t idx, int rc)
+{
+    pthread_mutex_lock(&jobs->lock);
+    if (idx < jobs->mod_count) {
+        jobs->mods[idx].done = 1;
+    }
+    if (rc) {
+        jobs->failed = 1;
+    }
+    pthread_cond_broadcast(&jobs->cond);
+    pthread_mutex_unlock(&jobs->lock);
+}
+
+static int
+step_module_path(const char *dir, const char *module_name, LYD_FORMAT format, char **path)
+{
+    const struct {
+        LYD_FORMAT format;
+        const char *ext;
+    } exts[] = {{LYD_XML, "xml"}, {LYD_JSON, "json"}, {LYD_LYB, "lyb"}};
+    uint32_t i;
+
+    *path = NULL;
+
+    for (i = 0; i < sizeof exts / sizeof *exts; ++i) {
+        if ((format != LYD_UNKNOWN) && (format != exts[i].format)) {
+            continue;
+        }
+
+        free(*path);
+        if (asprintf(path, "%s/%s.%s", dir, module_name, exts[i].ext) == -1) {
+            *path = NULL;
+            error_print(SR_ERR_NO_MEMORY, "Memory allocation failed");
+            return EXIT_FAILURE;
+        }
+        if ((format != LYD_UNKNOWN) || !access(*path, F_OK)) {
+            /* the file of the format or the first existing one */
+            return EXIT_SUCCESS;
+        }
+    }
+
+    /* no file found */
+    free(*path);
+    *path = NULL;
+    return EXIT_SUCCESS;
+}
+
+static void *
+job_export(void *arg)
+{
+    struct jobs_s *jobs = arg;
+    sr_session_ctx_t *sess = NULL;
+    const struct lys_module *ly_mod;
+    sr_data_t *data;
+    FILE *file;
+    char *str;
+    uint32_t i;
+    int r, rc;
+
+    if ((r = sr_session_start(jobs->conn, jobs->ds, &sess))) {
+        error_print(r, "Failed to start a session");
+        step_jobs_done(jobs, UINT32_MAX, EXIT_FAILURE);
+        return NULL;
+    }
+
+    while (step_jobs_next(jobs, &i)) {
+        ly_mod = jobs->mods[i].ly_mod;
+        data = NULL;
+        rc = EXIT_FAILURE;
+
+        /* get the module data */
+        if (asprintf(&str, "/%s:*", ly_mod->name) == -1) {
+            error_print(SR_ERR_NO_MEMORY, "Getting data failed");
+            goto next;
+        }
+        r = sr_get_data(sess, str, jobs->max_depth, jobs->timeout_s * 1000, 0, &data);
+        free(str);
+        if (r) {
+            error_sr_print(sess);
+            error_print(r, "Getting data of module \"%s\" failed", ly_mod->name);
+            goto next;
+        }
+
+        if (jobs->dir) {
+            /* print into the module file */
+            if (step_module_path(jobs->dir, ly_mod->name, jobs->format, &str)) {
+                goto next;
+            }
+            file = fopen(str, "w");
+            if (!file) {
+                error_print(0, "Failed to open \"%s\" for writing (%s)", str, strerror(errno));
+                free(str);
+                goto next;
+            }
+            free(str);
+            lyd_print_file(file, data ? data->tree : NULL, jobs->format, LYD_PRINT_WITHSIBLINGS | jobs->wd_opt);
+            fclose(file);
+        } else {
+            /* print into memory, written in the module order */
+            lyd_print_mem(&jobs->mods[i].out, data ? data->tree : NULL, jobs->format,
+                    LYD_PRINT_WITHSIBLINGS | jobs->wd_opt);
+        }
+        rc = EXIT_SUCCESS;
+
+next:
+        sr_release_data(data);
+        step_jobs_done(jobs, i, rc);
+    }
+
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static void *
+job_import(void *arg)
+{
+    struct jobs_s *jobs = arg;
+    sr_session_ctx_t *sess = NULL;
+    const struct lys_module *ly_mod;
+    struct lyd_node *data;
+    char *path;
+    uint32_t i;
+    int r, rc;
+
+    if ((r = sr_session_start(jobs->conn, jobs->ds, &sess))) {
+        error_print(r, "Failed to start a session");
+        step_jobs_done(jobs, UINT32_MAX, EXIT_FAILURE);
+        return NULL;
+    }
+
+    while (step_jobs_next(jobs, &i)) {
+        ly_mod = jobs->mods[i].ly_mod;
+        rc = EXIT_FAILURE;
+
+        /* get the module data */
+        data = jobs->mods[i].data;
+        jobs->mods[i].data = NULL;
+        if (jobs->dir) {
+            if (step_module_path(jobs->dir, ly_mod->name, jobs->format, &path)) {
+                goto next;
+            }
+            if (!path || access(path, F_OK)) {
+                /* no module file, the module is not modified */
+                free(path);
+                rc = EXIT_SUCCESS;
+                goto next;
+            }
+            r = step_load_data(jobs->ly_ctx, path, jobs->format, DATA_CONFIG, jobs->not_strict, 0, &data);
+            free(path);
+            if (r) {
+                goto next;
+            }
+        }
+
+        /* replace module config (always spends data) */
+        r = sr_replace_config(sess, ly_mod->name, data, jobs->timeout_s * 1000);
+        if (r) {
+            error_sr_print(sess);
+            error_print(r, "Replace config of module \"%s\" failed", ly_mod->name);
+            goto next;
+        }
+        rc = EXIT_SUCCESS;
+
+next:
+        step_jobs_done(jobs, i, rc);
+    }
+
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static int
+step_jobs_run(struct jobs_s *jobs, uint32_t job_count, void *(*job_cb)(void *), FILE *file)
+{
+    pthread_t *tids;
+    uint32_t i, tid_count = 0;
+    int r, done;
+
+    if (job_count > jobs->mod_count) {
+        job_count = jobs->mod_count;
+    }
+
+    tids = malloc(job_count * sizeof *tids);
+    for (i = 0; tids && (i < job_count); ++i) {
+        if ((r = pthread_create(&tids[i], NULL, job_cb, jobs))) {
+            /* fewer jobs will do */
+            error_print(0, "Creating a job thread failed (%s)", strerror(r));
+            break;
+        }
+        ++tid_count;
+    }
+    if (!tid_count) {
+        /* process all the modules in this thread */
+        job_cb(jobs);
+    }
+
+    /* write the printed data in the module order as soon as they are ready */
+    for (i = 0; file && (i < jobs->mod_count); ++i) {
+        pthread_mutex_lock(&jobs->lock);
+        while (!jobs->mods[i].done && !jobs->failed) {
+            pthread_cond_wait(&jobs->cond, &jobs->lock);
+        }
+        done = jobs->mods[i].done && !jobs->failed;
+        pthread_mutex_unlock(&jobs->lock);
+        if (!done) {
+            break;
+        }
+
+        if (jobs->mods[i].out) {
+            fputs(jobs->mods[i].out, file);
+            free(jobs->mods[i].out);
+            jobs->mods[i].out = NULL;
+        }
+    }
+
+    for (i = 0; i < tid_count; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+    free(tids);
+
+    return jobs->failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int
+step_path_is_dir(const char *path)
+{
+    struct stat st;
+
+    return path && !stat(path, &st) && S_ISDIR(st.st_mode);
+}
+
+static int
+step_import_jobs(sr_session_ctx_t *sess, const struct ly_ctx *ly_ctx, const char *file_path, LYD_FORMAT format,
+        int not_strict, uint32_t job_count, int timeout_s)
+{
+    struct jobs_s jobs = {0};
+    struct lyd_node *data;
+    int rc;
+
+    if (step_jobs_init(sess, ly_ctx, &jobs)) {
+        rc = EXIT_FAILURE;
+        goto cleanup;
+    }
+    jobs.format = format;
+    jobs.not_strict = not_strict;
+    jobs.timeout_s = timeout_s;
+
+    if (step_path_is_dir(file_path)) {
+        /* each module from its file, modules without a file are not modified */
+        jobs.dir = file_path;
+    } else {
+        /* all the modules are replaced as when importing the whole datastore */
+        if (step_load_data(ly_ctx, file_path, format, DATA_CONFIG, not_strict, 0, &data)) {
+            rc = EXIT_FAILURE;
+            goto cleanup;
+        }
+        step_jobs_split(&jobs, data);
+    }
+
+    rc = step_jobs_run(&jobs, job_count, job_import, NULL);
+
+cleanup:
+    step_jobs_free(&jobs);
+    return rc;
+}
+
 static int
 op_import(sr_session_ctx_t *sess, const char *file_path, const char *module_name, LYD_FORMAT format, int not_strict,
-        int timeout_s)
+        int chunk, uint32_t job_count, int timeout_s)
 {
     const struct ly_ctx *ly_ctx;
     struct lyd_node *data;
@@ -349,6 +755,12 @@ op_import(sr_session_ctx_t *sess, const char *file_path, const char *module_name
 
     ly_ctx = sr_acquire_context(sr_session_get_connection(sess));
 
+    if (!module_name && (chunk || (job_count > 1) || step_path_is_dir(file_path))) {
+        /* replace config of each module separately, possibly concurrently */
+        rc = step_import_jobs(sess, ly_ctx, file_path, format, not_strict, job_count, timeout_s);
+        goto cleanup;
+    }
+
     if (step_load_data(ly_ctx, file_path, format, DATA_CONFIG, not_strict, 0, &data)) {
         rc = EXIT_FAILURE;
         goto cleanup;
@@ -368,18 +780,137 @@ cleanup:
     return rc;
 }
 
+static int
+step_export_chunks(sr_session_ctx_t *sess, const char *xpath, uint32_t max_depth, uint32_t chunk, int wd_opt,
+        int timeout_s, FILE *file)
+{
+    sr_get_data_iter_t *iter = NULL;
+    sr_data_t *data;
+    int r;
+
+    if (!(r = sr_get_data_iter_open(sess, xpath, max_depth, timeout_s * 1000, 0, NULL, &iter))) {
+        /* print each chunk right away, XML top-level siblings can simply be concatenated */
+        while (!(r = sr_get_data_iter_next(iter, chunk, &data))) {
+            lyd_print_file(file, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | wd_opt);
+            sr_release_data(data);
+        }
+        sr_get_data_iter_free(iter);
+    } else if (r == SR_ERR_NOT_FOUND) {
+        /* invalid XPath */
+        r = SR_ERR_INVAL_ARG;
+    }
+
+    if (r != SR_ERR_NOT_FOUND) {
+        error_sr_print(sess);
+        error_print(r, "Getting data failed");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int
+step_export_modules(sr_session_ctx_t *sess, uint32_t max_depth, uint32_t chunk, int wd_opt, int timeout_s,
+        FILE *file)
+{
+    const struct ly_ctx *ly_ctx;
+    const struct lys_module *ly_mod;
+    char *str;
+    uint32_t idx = 0;
+    int rc = EXIT_SUCCESS;
+
+    ly_ctx = sr_acquire_context(sr_session_get_connection(sess));
+
+    /* only the data of a single module are being held at once */
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &idx))) {
+        if (!step_module_has_data(ly_mod)) {
+            continue;
+        }
+
+        if (asprintf(&str, "/%s:*", ly_mod->name) == -1) {
+            error_print(SR_ERR_NO_MEMORY, "Getting data failed");
+            rc = EXIT_FAILURE;
+            break;
+        }
+        rc = step_export_chunks(sess, str, max_depth, chunk, wd_opt, timeout_s, file);
+        free(str);
+        if (rc) {
+            break;
+        }
+    }
+
+    sr_release_context(sr_session_get_connection(sess));
+    return rc;
+}
+
+static int
+step_export_jobs(sr_session_ctx_t *sess, const char *dir, LYD_FORMAT format, uint32_t max_depth, uint32_t job_count,
+        int wd_opt, int timeout_s, FILE *file)
+{
+    struct jobs_s jobs = {0};
+    int rc;
+
+    if (step_jobs_init(sess, sr_acquire_context(sr_session_get_connection(sess)), &jobs)) {
+        rc = EXIT_FAILURE;
+        goto cleanup;
+    }
+    jobs.dir = dir;
+    jobs.format = format;
+    jobs.max_depth = max_depth;
+    jobs.wd_opt = wd_opt;
+    jobs.timeout_s = timeout_s;
+
+    /* data of the modules are written either into separate files or merged into the output in the module order */
+    rc = step_jobs_run(&jobs, job_count, job_export, dir ? NULL : file);
+
+cleanup:
+    step_jobs_free(&jobs);
+    sr_release_context(sr_session_get_connection(sess));
+    return rc;
+}
+
 static int
 op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name, const char *xpath, LYD_FORMAT format,
-        uint32_t max_depth, int wd_opt, int timeout_s)
+        uint32_t max_depth, uint32_t chunk, uint32_t job_count, int wd_opt, int timeout_s)
 {
     sr_data_t *data;
     FILE *file = NULL;
     char *str;
-    int r;
+    int r, rc, dir;
 
     if (format == LYD_UNKNOWN) {
         format = LYD_XML;
     }
+    if (chunk && (format != LYD_XML)) {
+        error_print(0, "Exporting data in chunks is supported only in the XML format");
+        return EXIT_FAILURE;
+    }
+
+    dir = step_path_is_dir(file_path);
+    if (!module_name && !xpath && ((job_count > 1) || dir)) {
+        if (chunk) {
+            error_print(0, "Exporting data in chunks is not supported with jobs or into a directory");
+            return EXIT_FAILURE;
+        } else if (!dir && (format != LYD_XML)) {
+            error_print(0, "Exporting data of several jobs into a single file is supported only in the XML format");
+            return EXIT_FAILURE;
+        }
+
+        if (!dir && file_path) {
+            file = fopen(file_path, "w");
+            if (!file) {
+                error_print(0, "Failed to open \"%s\" for writing (%s)", file_path, strerror(errno));
+                return EXIT_FAILURE;
+            }
+        }
+
+        /* get and print the data of each module separately, possibly concurrently */
+        rc = step_export_jobs(sess, dir ? file_path : NULL, format, max_depth, job_count, wd_opt, timeout_s,
+                file ? file : stdout);
+        if (file) {
+            fclose(file);
+        }
+        return rc;
+    }
 
     if (file_path) {
         file = fopen(file_path, "w");
@@ -389,6 +920,28 @@ op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name
         }
     }
 
+    if (chunk) {
+        /* get and print subtrees in chunks */
+        if (module_name) {
+            if (asprintf(&str, "/%s:*", module_name) == -1) {
+                error_print(SR_ERR_NO_MEMORY, "Getting data failed");
+                rc = EXIT_FAILURE;
+            } else {
+                rc = step_export_chunks(sess, str, max_depth, chunk, wd_opt, timeout_s, file ? file : stdout);
+                free(str);
+            }
+        } else if (xpath) {
+            rc = step_export_chunks(sess, xpath, max_depth, chunk, wd_opt, timeout_s, file ? file : stdout);
+        } else {
+            rc = step_export_modules(sess, max_depth, chunk, wd_opt, timeout_s, file ? file : stdout);
+        }
+
+        if (file) {
+            fclose(file);
+        }
+        return rc;
+    }
+
     /* get subtrees */
     if (module_name) {
         if (asprintf(&str, "/%s:*", module_name) == -1) {
@@ -763,7 +1316,7 @@ main(int argc, char **argv)
     const char *module_name = NULL, *editor = NULL, *file_path = NULL, *xpath = NULL, *op_str, *value = NULL;
     char *ptr;
     int r, rc = EXIT_FAILURE, opt, operation = 0, lock = 0, not_strict = 0, opaq = 0, timeout = 0, wd_opt = 0;
-    uint32_t max_depth = 0;
+    uint32_t max_depth = 0, chunk = 0, job_count = 1;
     struct option options[] = {
         {"help",            no_argument,       NULL, 'h'},
         {"version",         no_argument,       NULL, 'V'},
@@ -783,6 +1336,8 @@ main(int argc, char **argv)
         {"not-strict",      no_argument,       NULL, 'n'},
         {"opaque",          no_argument,       NULL, 'o'},
         {"depth",           required_argument, NULL, 'p'},
+        {"chunk",           required_argument, NULL, 'c'},
+        {"jobs",            required_argument, NULL, 'j'},
         {"timeout",         required_argument, NULL, 't'},
         {"defaults",        required_argument, NULL, 'e'},
         {"value",           required_argument, NULL, 'u'},
@@ -797,7 +1352,7 @@ main(int argc, char **argv)
 
     /* process options */
     opterr = 0;
-    while ((opt = getopt_long(argc, argv, "hVI::X::E::R::N::C:S:G:d:m:x:f:lnop:t:e:u:v:", options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hVI::X::E::R::N::C:S:G:d:m:x:f:lnop:c:j:t:e:u:v:", options, NULL)) != -1) {
         /* parameters with optional arguments */
         switch (opt) {
         case 'I':
@@ -970,6 +1525,20 @@ main(int argc, char **argv)
                 goto cleanup;
             }
             break;
+        case 'c':
+            chunk = strtoul(optarg, &ptr, 10);
+            if (ptr[0] || !chunk) {
+                error_print(0, "Invalid chunk \"%s\"", optarg);
+                goto cleanup;
+            }
+            break;
+        case 'j':
+            job_count = strtoul(optarg, &ptr, 10);
+            if (ptr[0] || !job_count) {
+                error_print(0, "Invalid jobs \"%s\"", optarg);
+                goto cleanup;
+            }
+            break;
         case 't':
             timeout = strtoul(optarg, &ptr, 10);
             if (ptr[0]) {
@@ -1070,10 +1639,10 @@ main(int argc, char **argv)
     /* perform the operation */
     switch (operation) {
     case 'I':
-        rc = op_import(sess, file_path, module_name, format, not_strict, timeout);
+        rc = op_import(sess, file_path, module_name, format, not_strict, chunk, job_count, timeout);
         break;
     case 'X':
-        rc = op_export(sess, file_path, module_name, xpath, format, max_depth, wd_opt, timeout);
+        rc = op_export(sess, file_path, module_name, xpath, format, max_depth, chunk, job_count, wd_opt, timeout);
         break;
     case 'E':
         rc = op_edit(sess, file_path, editor, module_name, format, lock, not_strict, opaq, wd_opt, timeout);
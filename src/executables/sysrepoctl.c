@@ -19,7 +19,9 @@
 #include "compat.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -66,6 +68,22 @@ struct change_item {
     int mod_ds;
 };
 
+struct batch_feat {
+    const char *module_name;
+    const char *feature;
+    int enable;
+};
+
+struct batch_item {
+    char *buf;
+    sr_install_mod_t *iitems;
+    uint32_t iitem_count;
+    const char **rem_names;
+    const char **upd_paths;
+    struct batch_feat *feats;
+    uint32_t feat_count;
+};
+
 sr_log_level_t log_level = SR_LL_ERR;
 
 static void
@@ -104,11 +122,18 @@ help_print(void)
             "  -P, --plugin-install <path>\n"
             "                       Install a datastore or notification sysrepo plugin. The plugin is simply copied\n"
             "                       to the designated plugin directory.\n"
+            "  -C, --compact-shm    Compact the shared memory with all the subscriptions, removing any free space\n"
+            "                       left by removed subscriptions.\n"
+            "  -b, --batch <path>   Perform all the changes from a batch file, one directive per line\n"
+            "                       (\"install <path> [<feature>...]\", \"uninstall <module>...\",\n"
+            "                       \"update <path>...\", \"enable-feature <module> <feature>\",\n"
+            "                       \"disable-feature <module> <feature>\").\n"
+            "                       All the directives of one kind are applied together with a single context change.\n"
             "\n"
             "Available options:\n"
             "  -s, --search-dirs <dir-path> [:<dir-path>...]\n"
             "                       Directories to search for include/import modules. Directory with already-installed\n"
-            "                       modules is always searched. Accepted by install, update op.\n"
+            "                       modules is always searched. Accepted by install, update, batch op.\n"
             "  -e, --enable-feature <feature-name>\n"
             "                       Enabled specific feature or use '*' for all the features. Can be specified multiple\n"
             "                       times. Accepted by install, change op.\n"
@@ -133,8 +158,8 @@ help_print(void)
             "                       datastores use the default datastore plugins. Accepted by install op.\n"
             "  -I, --init-data <path>\n"
             "                       Initial data in a file with XML or JSON extension to be set for module(s),\n"
-            "                       useful when there are mandatory top-level nodes. Accepted by install op.\n"
-            "  -f, --force          Force the specific operation. Accepted by uninstall op.\n"
+            "                       useful when there are mandatory top-level nodes. Accepted by install, batch op.\n"
+            "  -f, --force          Force the specific operation. Accepted by uninstall, batch op.\n"
             "  -v, --verbosity <level>\n"
             "                       Change verbosity to a level (none, error, warning, info, debug) or\n"
             "                       number (0, 1, 2, 3, 4). Accepted by all op.\n"
@@ -602,6 +627,206 @@ cleanup:
     return r;
 }
 
+/**
+ * @brief Learn whether a schema file path belongs to a module.
+ *
+ * @param[in] path Schema file path.
+ * @param[in] module_name Module name.
+ * @return Whether the file name is \"<module_name>[@<revision>].<ext>\".
+ */
+static int
+srctl_path_is_module(const char *path, const char *module_name)
+{
+    const char *name;
+    size_t len = strlen(module_name);
+
+    name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+
+    return !strncmp(name, module_name, len) && ((name[len] == '@') || (name[len] == '.'));
+}
+
+/**
+ * @brief Parse a batch file.
+ *
+ * Enabled features of modules installed by the same batch are merged into their install items.
+ *
+ * @param[in] path Batch file path.
+ * @param[out] batch Parsed batch.
+ * @return 0 on success, non-zero on error.
+ */
+static int
+srctl_batch_load(const char *path, struct batch_item *batch)
+{
+    FILE *file;
+    char *line, *next, *tok, *tok_save, *dir, *comment;
+    struct batch_feat *feat;
+    long size;
+    uint32_t i, j, line_no = 0;
+    int r = 1;
+
+    /* read the whole file */
+    if (!(file = fopen(path, "r"))) {
+        error_print(0, "Failed to open \"%s\" (%s)", path, strerror(errno));
+        return 1;
+    }
+    if (fseek(file, 0, SEEK_END) || ((size = ftell(file)) == -1) || fseek(file, 0, SEEK_SET)) {
+        error_print(0, "Failed to learn \"%s\" size (%s)", path, strerror(errno));
+        goto cleanup;
+    }
+    if (!(batch->buf = malloc(size + 1))) {
+        error_print(0, "Memory allocation failed");
+        goto cleanup;
+    }
+    if (fread(batch->buf, 1, size, file) != (size_t)size) {
+        error_print(0, "Failed to read \"%s\"", path);
+        goto cleanup;
+    }
+    batch->buf[size] = '\0';
+
+    /* parse the directives, all the strings point into the buffer */
+    for (line = batch->buf; line; line = next) {
+        if ((next = strchr(line, '\n'))) {
+            *next = '\0';
+            ++next;
+        }
+        ++line_no;
+        if ((comment = strchr(line, '#'))) {
+            *comment = '\0';
+        }
+        if (!(dir = strtok_r(line, " \t\r", &tok_save))) {
+            /* empty line */
+            continue;
+        }
+
+        tok = strtok_r(NULL, " \t\r", &tok_save);
+        if (!tok) {
+            error_print(0, "Missing argument of \"%s\" on line %" PRIu32, dir, line_no);
+            goto cleanup;
+        }
+
+        if (!strcmp(dir, "install")) {
+            if (new_iitem(tok, &batch->iitems, &batch->iitem_count)) {
+                error_print(0, "Memory allocation failed");
+                goto cleanup;
+            }
+            while ((tok = strtok_r(NULL, " \t\r", &tok_save))) {
+                if (new_str(tok, &batch->iitems[batch->iitem_count - 1].features)) {
+                    error_print(0, "Memory allocation failed");
+                    goto cleanup;
+                }
+            }
+        } else if (!strcmp(dir, "uninstall") || !strcmp(dir, "update")) {
+            do {
+                if (new_str(tok, (dir[1] == 'n') ? &batch->rem_names : &batch->upd_paths)) {
+                    error_print(0, "Memory allocation failed");
+                    goto cleanup;
+                }
+            } while ((tok = strtok_r(NULL, " \t\r", &tok_save)));
+        } else if (!strcmp(dir, "enable-feature") || !strcmp(dir, "disable-feature")) {
+            feat = realloc(batch->feats, (batch->feat_count + 1) * sizeof *batch->feats);
+            if (!feat) {
+                error_print(0, "Memory allocation failed");
+                goto cleanup;
+            }
+            batch->feats = feat;
+            feat = &batch->feats[batch->feat_count++];
+
+            feat->module_name = tok;
+            feat->enable = (dir[0] == 'e');
+            if (!(feat->feature = strtok_r(NULL, " \t\r", &tok_save)) || strtok_r(NULL, " \t\r", &tok_save)) {
+                error_print(0, "Expected \"%s <module> <feature>\" on line %" PRIu32, dir, line_no);
+                goto cleanup;
+            }
+        } else {
+            error_print(0, "Unknown directive \"%s\" on line %" PRIu32, dir, line_no);
+            goto cleanup;
+        }
+    }
+
+    /* features enabled for modules being installed are part of their installation */
+    for (i = 0; i < batch->feat_count; ++i) {
+        if (!batch->feats[i].enable) {
+            continue;
+        }
+        for (j = 0; j < batch->iitem_count; ++j) {
+            if (srctl_path_is_module(batch->iitems[j].schema_path, batch->feats[i].module_name)) {
+                break;
+            }
+        }
+        if (j < batch->iitem_count) {
+            if (new_str(batch->feats[i].feature, &batch->iitems[j].features)) {
+                error_print(0, "Memory allocation failed");
+                goto cleanup;
+            }
+            batch->feats[i].feature = NULL;
+        }
+    }
+
+    r = 0;
+
+cleanup:
+    fclose(file);
+    return r;
+}
+
+/**
+ * @brief Perform all the changes of a batch.
+ *
+ * Modules are first uninstalled, then updated, and then installed, each step being a single context change.
+ * The remaining feature changes of already installed modules follow.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] batch Batch to perform.
+ * @param[in] search_dirs Search dirs for install and update.
+ * @param[in] data_path Initial data for the installed modules.
+ * @param[in] force Whether to force uninstall.
+ * @return SR_ERR value.
+ */
+static int
+srctl_batch(sr_conn_ctx_t *conn, const struct batch_item *batch, const char *search_dirs, const char *data_path,
+        int force)
+{
+    int r = SR_ERR_OK;
+    uint32_t i;
+
+    if (batch->rem_names && (r = sr_remove_modules(conn, batch->rem_names, force))) {
+        error_print(r, "Failed to uninstall modules");
+        return r;
+    }
+
+    if (batch->upd_paths && (r = sr_update_modules(conn, batch->upd_paths, search_dirs))) {
+        error_print(r, "Failed to update modules");
+        return r;
+    }
+
+    if (batch->iitem_count && (r = sr_install_modules2(conn, batch->iitems, batch->iitem_count, search_dirs, NULL,
+            data_path, 0))) {
+        error_print(r, "Failed to install modules");
+        return r;
+    }
+
+    for (i = 0; i < batch->feat_count; ++i) {
+        if (!batch->feats[i].feature) {
+            /* enabled during installation */
+            continue;
+        }
+
+        if (batch->feats[i].enable) {
+            r = sr_enable_module_feature(conn, batch->feats[i].module_name, batch->feats[i].feature);
+        } else {
+            r = sr_disable_module_feature(conn, batch->feats[i].module_name, batch->feats[i].feature);
+        }
+        if (r) {
+            error_print(r, "Failed to %s feature \"%s\" of module \"%s\"", batch->feats[i].enable ? "enable" :
+                    "disable", batch->feats[i].feature, batch->feats[i].module_name);
+            return r;
+        }
+    }
+
+    return r;
+}
+
 static int
 srctl_plugin_list(sr_conn_ctx_t *conn)
 {
@@ -636,7 +861,8 @@ main(int argc, char **argv)
     sr_install_mod_t *iitems = NULL;
     uint32_t i, iitem_count = 0;
     struct change_item citem = {.replay = -1, .mod_ds = SR_MOD_DS_PLUGIN_COUNT};
-    const char *file_path = NULL, *search_dirs = NULL, **module_names = NULL, *data_path = NULL;
+    struct batch_item batch = {0};
+    const char *file_path = NULL, *batch_path = NULL, *search_dirs = NULL, **module_names = NULL, *data_path = NULL;
     char *ptr;
     int r, rc = EXIT_FAILURE, opt, operation = 0, force = 0;
     struct option options[] = {
@@ -649,6 +875,8 @@ main(int argc, char **argv)
         {"update",          required_argument, NULL, 'U'},
         {"plugin-list",     no_argument,       NULL, 'L'},
         {"plugin-install",  required_argument, NULL, 'P'},
+        {"compact-shm",     no_argument,       NULL, 'C'},
+        {"batch",           required_argument, NULL, 'b'},
         {"search-dirs",     required_argument, NULL, 's'},
         {"enable-feature",  required_argument, NULL, 'e'},
         {"disable-feature", required_argument, NULL, 'd'},
@@ -671,7 +899,7 @@ main(int argc, char **argv)
 
     /* process options */
     opterr = 0;
-    while ((opt = getopt_long(argc, argv, "hVli:u:c:U:LP:s:e:d:r:o:g:p:D:m:I:fv:", options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hVli:u:c:U:LP:Cb:s:e:d:r:o:g:p:D:m:I:fv:", options, NULL)) != -1) {
         switch (opt) {
         case 'h':
             /* help */
@@ -751,6 +979,23 @@ main(int argc, char **argv)
             operation = 'P';
             file_path = optarg;
             break;
+        case 'C':
+            /* compact-shm */
+            if (operation) {
+                error_print(0, "Operation already specified");
+                goto cleanup;
+            }
+            operation = 'C';
+            break;
+        case 'b':
+            /* batch */
+            if (operation) {
+                error_print(0, "Operation already specified");
+                goto cleanup;
+            }
+            operation = 'b';
+            batch_path = optarg;
+            break;
         case 's':
             /* search-dirs */
             if (search_dirs) {
@@ -865,7 +1110,7 @@ main(int argc, char **argv)
             break;
         case 'I':
             /* init-data */
-            if (operation == 'i') {
+            if ((operation == 'i') || (operation == 'b')) {
                 data_path = optarg;
             } else {
                 error_operation(operation, opt);
@@ -874,7 +1119,7 @@ main(int argc, char **argv)
             break;
         case 'f':
             /* force */
-            if (operation == 'u') {
+            if ((operation == 'u') || (operation == 'b')) {
                 force = 1;
             } else {
                 error_operation(operation, opt);
@@ -915,6 +1160,10 @@ main(int argc, char **argv)
     /* set logging */
     sr_log_stderr(log_level);
 
+    if ((operation == 'b') && srctl_batch_load(batch_path, &batch)) {
+        goto cleanup;
+    }
+
     if (operation != 'P') {
         /* create connection */
         if ((r = sr_connect(0, &conn))) {
@@ -979,6 +1228,19 @@ main(int argc, char **argv)
             goto cleanup;
         }
         break;
+    case 'C':
+        /* compact-shm */
+        if ((r = sr_compact_ext_shm(conn))) {
+            error_print(r, "Failed to compact shared memory");
+            goto cleanup;
+        }
+        break;
+    case 'b':
+        /* batch */
+        if ((r = srctl_batch(conn, &batch, search_dirs, data_path, force))) {
+            goto cleanup;
+        }
+        break;
     case 0:
         error_print(0, "No operation specified");
         goto cleanup;
@@ -998,5 +1260,13 @@ cleanup:
     free(citem.features);
     free(citem.dis_features);
     free(module_names);
+    for (i = 0; i < batch.iitem_count; ++i) {
+        free(batch.iitems[i].features);
+    }
+    free(batch.iitems);
+    free(batch.rem_names);
+    free(batch.upd_paths);
+    free(batch.feats);
+    free(batch.buf);
     return rc;
 }
@@ -20,14 +20,23 @@
 #include "ly_wrap.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <libyang/hash_table.h>
 #include <libyang/libyang.h>
 #include <libyang/plugins_types.h>
 
 #include "common.h"
+#include "config.h"
 #include "log.h"
 #include "sysrepo.h"
 
@@ -219,6 +228,306 @@ cleanup:
     return err_info;
 }
 
+#ifdef SR_PRINTED_CTX_ADDR
+
+#ifndef MAP_FIXED_NOREPLACE
+# define MAP_FIXED_NOREPLACE 0
+#endif
+
+/**
+ * @brief Header of a stored printed context image, the printed context follows it.
+ */
+struct sr_ly_printed_hdr_s {
+    uint32_t shm_ver;       /**< SHM version the image was created with. */
+    uint32_t ly_ver;        /**< libyang SO version the image was printed by. */
+    uint32_t content_id;    /**< Content ID of the modules in the printed context. */
+    uint32_t padding;
+    uint64_t size;          /**< Size of the printed context. */
+};
+
+/** aligned size of the printed context image header */
+#define SR_LY_PRINTED_HDR_SIZE SR_SHM_SIZE(sizeof(struct sr_ly_printed_hdr_s))
+
+/**
+ * @brief Printed context mapped by this process, only one can be mapped at the fixed address.
+ */
+static struct {
+    pthread_mutex_t lock;   /**< Lock for accessing the members. */
+    void *mem;              /**< Mapped image. */
+    size_t size;            /**< Size of the mapped image. */
+    struct ly_ctx *ly_ctx;  /**< Printed context created from the mapped image. */
+} ly_printed = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Get the libyang SO version stored in the printed context image header.
+ *
+ * @return libyang version.
+ */
+static uint32_t
+sr_ly_printed_ly_ver(void)
+{
+    return ((uint32_t)ly_version_so.major << 16) | ((uint32_t)ly_version_so.minor << 8) | ly_version_so.micro;
+}
+
+#endif
+
+sr_error_info_t *
+sr_ly_ctx_printed_load(sr_conn_ctx_t *conn, uint32_t content_id, struct ly_ctx **ly_ctx)
+{
+    sr_error_info_t *err_info = NULL;
+
+    *ly_ctx = NULL;
+
+#ifdef SR_PRINTED_CTX_ADDR
+    struct sr_ly_printed_hdr_s hdr;
+    char *path = NULL;
+    void *mem = MAP_FAILED;
+    size_t size = 0;
+    int fd = -1;
+    struct stat st;
+
+    if ((err_info = sr_path_printed_ctx(&path))) {
+        return err_info;
+    }
+
+    /* PRINTED LOCK */
+    if ((err_info = sr_mlock(&ly_printed.lock, -1, __func__, NULL, NULL))) {
+        free(path);
+        return err_info;
+    }
+
+    if (ly_printed.mem) {
+        /* the fixed address is already used by another printed context */
+        goto cleanup;
+    }
+
+    /* open the image, it does not have to exist */
+    fd = sr_open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            SR_LOG_WRN("Failed to open printed context \"%s\" (%s).", path, strerror(errno));
+        }
+        goto cleanup;
+    }
+
+    /* check that the image is of the current modules */
+    if ((pread(fd, &hdr, sizeof hdr, 0) != sizeof hdr) || (hdr.shm_ver != SR_SHM_VER) ||
+            (hdr.ly_ver != sr_ly_printed_ly_ver()) || (hdr.content_id != content_id) || fstat(fd, &st) ||
+            ((uint64_t)st.st_size != SR_LY_PRINTED_HDR_SIZE + hdr.size)) {
+        goto cleanup;
+    }
+
+    /* map the image at the address it was printed at, private so that nothing is written into the file */
+    size = st.st_size;
+    mem = mmap((void *)(uintptr_t)SR_PRINTED_CTX_ADDR, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED_NOREPLACE,
+            fd, 0);
+    if (mem == MAP_FAILED) {
+        /* the address range is used by something else in this process */
+        goto cleanup;
+    } else if (mem != (void *)(uintptr_t)SR_PRINTED_CTX_ADDR) {
+        /* MAP_FIXED_NOREPLACE not supported and the address was taken */
+        goto cleanup;
+    }
+
+    /* create the context */
+    if (ly_ctx_new_printed((char *)mem + SR_LY_PRINTED_HDR_SIZE, ly_ctx)) {
+        SR_LOG_WRN("Failed to create a context from printed context \"%s\".", path);
+        *ly_ctx = NULL;
+        goto cleanup;
+    }
+
+    /* set the ext callback */
+    ly_ctx_set_ext_data_clb(*ly_ctx, sr_ly_ext_data_clb, conn);
+
+    ly_printed.mem = mem;
+    ly_printed.size = size;
+    ly_printed.ly_ctx = *ly_ctx;
+    mem = MAP_FAILED;
+    SR_LOG_DBG("Printed context of content ID %" PRIu32 " mapped.", content_id);
+
+cleanup:
+    /* PRINTED UNLOCK */
+    sr_munlock(&ly_printed.lock);
+
+    if (mem != MAP_FAILED) {
+        munmap(mem, size);
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+#else
+    (void)conn;
+    (void)content_id;
+#endif
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_ly_ctx_printed_store(const struct ly_ctx *ly_ctx, uint32_t content_id)
+{
+    sr_error_info_t *err_info = NULL;
+
+#ifdef SR_PRINTED_CTX_ADDR
+    struct sr_ly_printed_hdr_s *hdr;
+    char *path = NULL, *tmp_path = NULL;
+    void *mem = MAP_FAILED, *mem_end;
+    size_t size = 0;
+    int fd = -1, ctx_size;
+
+    /* learn the printed size */
+    if ((ctx_size = ly_ctx_compiled_size(ly_ctx)) < 0) {
+        sr_errinfo_new_ly(&err_info, ly_ctx, NULL, SR_ERR_LY);
+        return err_info;
+    }
+    size = SR_LY_PRINTED_HDR_SIZE + ctx_size;
+
+    if ((err_info = sr_path_printed_ctx(&path))) {
+        return err_info;
+    }
+    if (asprintf(&tmp_path, "%s.%ld", path, (long)getpid()) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+        tmp_path = NULL;
+        goto cleanup;
+    }
+
+    /* PRINTED LOCK */
+    if ((err_info = sr_mlock(&ly_printed.lock, -1, __func__, NULL, NULL))) {
+        goto cleanup;
+    }
+
+    if (ly_printed.mem) {
+        /* the fixed address is used by a printed context, the image cannot be printed */
+        goto cleanup_unlock;
+    }
+
+    /* create a new temporary image */
+    fd = sr_open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, SR_SHM_PERM);
+    if (fd == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to open \"%s\" (%s).", tmp_path, strerror(errno));
+        goto cleanup_unlock;
+    }
+    if (ftruncate(fd, size) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "ftruncate");
+        goto cleanup_unlock;
+    }
+
+    /* print the context at the address all the processes map it at */
+    mem = mmap((void *)(uintptr_t)SR_PRINTED_CTX_ADDR, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE,
+            fd, 0);
+    if ((mem == MAP_FAILED) || (mem != (void *)(uintptr_t)SR_PRINTED_CTX_ADDR)) {
+        /* the address range is used by something else in this process */
+        goto cleanup_unlock;
+    }
+    if (ly_ctx_compiled_print(ly_ctx, (char *)mem + SR_LY_PRINTED_HDR_SIZE, &mem_end)) {
+        sr_errinfo_new_ly(&err_info, ly_ctx, NULL, SR_ERR_LY);
+        goto cleanup_unlock;
+    }
+    assert((char *)mem_end <= (char *)mem + size);
+
+    /* fill the header */
+    hdr = mem;
+    hdr->shm_ver = SR_SHM_VER;
+    hdr->ly_ver = sr_ly_printed_ly_ver();
+    hdr->content_id = content_id;
+    hdr->size = ctx_size;
+
+    /* replace the previous image atomically */
+    if (msync(mem, size, MS_SYNC) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "msync");
+        goto cleanup_unlock;
+    }
+    if (rename(tmp_path, path) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "rename");
+        goto cleanup_unlock;
+    }
+    SR_LOG_DBG("Printed context of content ID %" PRIu32 " stored.", content_id);
+
+cleanup_unlock:
+    if (mem != MAP_FAILED) {
+        munmap(mem, size);
+    }
+
+    /* PRINTED UNLOCK */
+    sr_munlock(&ly_printed.lock);
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+
+        /* nothing to do if already renamed */
+        unlink(tmp_path);
+    }
+    free(path);
+    free(tmp_path);
+#else
+    (void)ly_ctx;
+    (void)content_id;
+#endif
+
+    return err_info;
+}
+
+void
+sr_ly_ctx_printed_remove(void)
+{
+#ifdef SR_PRINTED_CTX_ADDR
+    sr_error_info_t *err_info = NULL;
+    char *path;
+
+    if ((err_info = sr_path_printed_ctx(&path))) {
+        sr_errinfo_free(&err_info);
+        return;
+    }
+    if ((unlink(path) == -1) && (errno != ENOENT)) {
+        SR_LOG_WRN("Failed to remove printed context \"%s\" (%s).", path, strerror(errno));
+    }
+    free(path);
+#endif
+}
+
+int
+sr_ly_ctx_is_printed(const struct ly_ctx *ly_ctx)
+{
+#ifdef SR_PRINTED_CTX_ADDR
+    /* only read, the context cannot be destroyed while it is being used */
+    return ly_ctx && (ly_ctx == ly_printed.ly_ctx);
+#else
+    (void)ly_ctx;
+    return 0;
+#endif
+}
+
+void
+sr_ly_ctx_destroy(struct ly_ctx *ly_ctx)
+{
+#ifdef SR_PRINTED_CTX_ADDR
+    sr_error_info_t *err_info = NULL;
+
+    if (ly_ctx && (ly_ctx == ly_printed.ly_ctx)) {
+        /* PRINTED LOCK */
+        if ((err_info = sr_mlock(&ly_printed.lock, -1, __func__, NULL, NULL))) {
+            sr_errinfo_free(&err_info);
+            return;
+        }
+
+        /* destroy the context and unmap its image */
+        ly_ctx_destroy(ly_ctx);
+        munmap(ly_printed.mem, ly_printed.size);
+        ly_printed.mem = NULL;
+        ly_printed.size = 0;
+        ly_printed.ly_ctx = NULL;
+
+        /* PRINTED UNLOCK */
+        sr_munlock(&ly_printed.lock);
+        return;
+    }
+#endif
+
+    ly_ctx_destroy(ly_ctx);
+}
+
 sr_error_info_t *
 sr_lys_parse(struct ly_ctx *ctx, const char *data, const char *path, LYS_INFORMAT format, const char **features,
         struct lys_module **ly_mod)
@@ -911,15 +1220,22 @@ cleanup:
 }
 
 sr_error_info_t *
-sr_lyd_dup_siblings_to_ctx(const struct lyd_node *sibling, const struct ly_ctx *trg_ctx, uint32_t options,
+sr_lyd_dup_to_ctx(const struct lyd_node *node, const struct ly_ctx *trg_ctx, uint32_t options, int siblings,
         struct lyd_node **dup)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t temp_lo = LY_LOSTORE;
+    LY_ERR lyrc;
 
     ly_temp_log_options(&temp_lo);
 
-    if (lyd_dup_siblings_to_ctx(sibling, trg_ctx, NULL, options, dup)) {
+    if (siblings) {
+        lyrc = lyd_dup_siblings_to_ctx(node, trg_ctx, NULL, options, dup);
+    } else {
+        lyrc = lyd_dup_single_to_ctx(node, trg_ctx, NULL, options, dup);
+    }
+
+    if (lyrc) {
         sr_errinfo_new_ly(&err_info, trg_ctx, NULL, SR_ERR_LY);
         goto cleanup;
     }
@@ -1218,6 +1534,24 @@ cleanup:
     return err_info;
 }
 
+sr_error_info_t *
+sr_lyd_diff_tree(const struct lyd_node *target, const struct lyd_node *source, uint32_t options, struct lyd_node **diff)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t temp_lo = LY_LOSTORE;
+
+    ly_temp_log_options(&temp_lo);
+
+    if (lyd_diff_tree(target, source, options, diff)) {
+        sr_errinfo_new_ly(&err_info, target ? LYD_CTX(target) : LYD_CTX(source), source, SR_ERR_LY);
+        goto cleanup;
+    }
+
+cleanup:
+    ly_temp_log_options(NULL);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_lyd_diff_apply_module(struct lyd_node **data, const struct lyd_node *diff, const struct lys_module *mod,
         lyd_diff_cb diff_cb)
@@ -34,6 +34,49 @@
  */
 sr_error_info_t *sr_ly_ctx_init(sr_conn_ctx_t *conn, struct ly_ctx **ly_ctx);
 
+/**
+ * @brief Create a new libyang context from the stored printed context image shared by all the processes.
+ *
+ * Only one printed context can be mapped by a process at a time.
+ *
+ * @param[in] conn Connection to use for the LY ext data callback.
+ * @param[in] content_id Content ID of the modules that must be in the context.
+ * @param[out] ly_ctx Printed libyang context, NULL if there is no suitable image or it cannot be mapped.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_ly_ctx_printed_load(sr_conn_ctx_t *conn, uint32_t content_id, struct ly_ctx **ly_ctx);
+
+/**
+ * @brief Print a compiled libyang context into the printed context image shared by all the processes.
+ *
+ * Does nothing if the image cannot be printed at the fixed address in this process.
+ *
+ * @param[in] ly_ctx Context to print.
+ * @param[in] content_id Content ID of the modules in @p ly_ctx.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_ly_ctx_printed_store(const struct ly_ctx *ly_ctx, uint32_t content_id);
+
+/**
+ * @brief Remove the stored printed context image.
+ */
+void sr_ly_ctx_printed_remove(void);
+
+/**
+ * @brief Learn whether a libyang context is a printed context, which lacks the parsed modules.
+ *
+ * @param[in] ly_ctx Context to examine.
+ * @return Whether the context is printed.
+ */
+int sr_ly_ctx_is_printed(const struct ly_ctx *ly_ctx);
+
+/**
+ * @brief Destroy a libyang context, unmap the image of a printed context.
+ *
+ * @param[in] ly_ctx Context to destroy.
+ */
+void sr_ly_ctx_destroy(struct ly_ctx *ly_ctx);
+
 /**
  * @brief Parse a YANG module.
  *
@@ -413,16 +456,17 @@ sr_error_info_t *sr_lyd_dup(const struct lyd_node *node, struct lyd_node *parent
         struct lyd_node **dup);
 
 /**
- * @brief Duplicate data node siblings into a specific context.
+ * @brief Duplicate data node(s) into a specific context.
  *
- * @param[in] sibling Siblings to duplicate.
+ * @param[in] node Subtree to duplicate.
  * @param[in] trg_ctx Target context.
  * @param[in] options Dup options.
+ * @param[in] siblings Whether to duplicate siblings as well or only the single subtree.
  * @param[out] dup Duplicated data.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_lyd_dup_siblings_to_ctx(const struct lyd_node *sibling, const struct ly_ctx *trg_ctx,
-        uint32_t options, struct lyd_node **dup);
+sr_error_info_t *sr_lyd_dup_to_ctx(const struct lyd_node *node, const struct ly_ctx *trg_ctx, uint32_t options,
+        int siblings, struct lyd_node **dup);
 
 /**
  * @brief Safely free a subtree when there is also a pointer that may point to it.
@@ -569,6 +613,18 @@ sr_error_info_t *sr_lyd_any_copy_value(struct lyd_node *node, const union lyd_an
 sr_error_info_t *sr_lyd_diff_siblings(const struct lyd_node *target, const struct lyd_node *source, uint32_t options,
         struct lyd_node **diff);
 
+/**
+ * @brief Get the diff of 2 data subtrees, with their parents.
+ *
+ * @param[in] target Target diff subtree, NULL if the source subtree was created.
+ * @param[in] source Source diff subtree, NULL if the target subtree was deleted.
+ * @param[in] options Diff options.
+ * @param[out] diff Generated diff.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_lyd_diff_tree(const struct lyd_node *target, const struct lyd_node *source, uint32_t options,
+        struct lyd_node **diff);
+
 /**
  * @brief Apply diff of a specific module on data.
  *
@@ -32,6 +32,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <libyang/hash_table.h>
 #include <libyang/plugins_types.h>
 
 #include "common.h"
@@ -748,6 +749,46 @@ sr_lydmods_add_inv_data_dep(struct lyd_node *sr_mod, const char *inv_dep_mod)
     return NULL;
 }
 
+/**
+ * @brief Add schema dependencies of a module, all the modules augmenting or deviating it.
+ *
+ * @param[in] sr_mod Module to add to.
+ * @param[in] ly_mod Compiled module of @p sr_mod.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_add_schema_deps(struct lyd_node *sr_mod, const struct lys_module *ly_mod)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *dep_mod;
+    struct lyd_node *node;
+    LY_ARRAY_COUNT_TYPE u, count;
+    int dup;
+
+    count = LY_ARRAY_COUNT(ly_mod->augmented_by);
+    for (u = 0; u < count + LY_ARRAY_COUNT(ly_mod->deviated_by); ++u) {
+        dep_mod = (u < count) ? ly_mod->augmented_by[u] : ly_mod->deviated_by[u - count];
+
+        /* a module may both augment and deviate this one */
+        dup = 0;
+        LY_LIST_FOR(lyd_child(sr_mod), node) {
+            if (!strcmp(LYD_NAME(node), "schema-deps") && !strcmp(lyd_get_value(node), dep_mod->name)) {
+                dup = 1;
+                break;
+            }
+        }
+        if (dup) {
+            continue;
+        }
+
+        if ((err_info = sr_lyd_new_term(sr_mod, NULL, "schema-deps", dep_mod->name))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Free all module dependency containers from SR internal module data.
  *
@@ -762,8 +803,8 @@ sr_lydmods_del_deps_all(struct lyd_node *sr_mods)
     uint32_t i;
 
     /* find all the containers */
-    if ((err_info = sr_lyd_find_xpath(sr_mods, "module/deps | module/inverse-deps | module/rpc | module/notification",
-            &set))) {
+    if ((err_info = sr_lyd_find_xpath(sr_mods, "module/deps | module/inverse-deps | module/schema-deps | module/rpc | "
+            "module/notification", &set))) {
         goto cleanup;
     }
 
@@ -777,6 +818,291 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Cached dependencies of a module.
+ */
+struct sr_lydmods_deps_rec {
+    char *name;             /**< Module name. */
+    char *sig;              /**< Signature of all the modules the dependencies were computed from. */
+    char *lyb;              /**< Printed module dependencies, RPCs, and notifications in LYB. */
+};
+
+/**
+ * @brief Process-wide cache of computed module dependencies.
+ */
+static struct {
+    pthread_mutex_t lock;   /**< Cache lock. */
+    struct ly_ht *ht;       /**< Hash table of struct sr_lydmods_deps_rec, by module name. */
+} deps_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Dependency cache hash table equal callback.
+ */
+static ly_bool
+sr_lydmods_deps_ht_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct sr_lydmods_deps_rec *val1, *val2;
+
+    val1 = val1_p;
+    val2 = val2_p;
+
+    return !strcmp(val1->name, val2->name);
+}
+
+/**
+ * @brief Append a string to a module dependency signature.
+ *
+ * @param[in] str String to append.
+ * @param[in,out] sig Signature to append to.
+ * @param[in,out] sig_len Length of @p sig.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deps_sig_add(const char *str, char **sig, size_t *sig_len)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t len = strlen(str);
+    void *mem;
+
+    mem = realloc(*sig, *sig_len + len + 1);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    *sig = mem;
+
+    memcpy(*sig + *sig_len, str, len + 1);
+    *sig_len += len;
+    return NULL;
+}
+
+/**
+ * @brief Append a module revision, submodule revisions, and enabled features to a module dependency signature.
+ *
+ * @param[in] ly_mod Module to append.
+ * @param[in,out] sig Signature to append to.
+ * @param[in,out] sig_len Length of @p sig.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deps_sig_add_module(const struct lys_module *ly_mod, char **sig, size_t *sig_len)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysp_submodule *submod;
+    struct lysp_feature *f = NULL;
+    LY_ARRAY_COUNT_TYPE u;
+    uint32_t idx = 0;
+
+    if ((err_info = sr_lydmods_deps_sig_add(ly_mod->name, sig, sig_len))) {
+        return err_info;
+    }
+    if ((err_info = sr_lydmods_deps_sig_add(ly_mod->implemented ? "@" : "#", sig, sig_len))) {
+        return err_info;
+    }
+    if (ly_mod->revision && (err_info = sr_lydmods_deps_sig_add(ly_mod->revision, sig, sig_len))) {
+        return err_info;
+    }
+
+    LY_ARRAY_FOR(ly_mod->parsed->includes, u) {
+        submod = ly_mod->parsed->includes[u].submodule;
+        if ((err_info = sr_lydmods_deps_sig_add("/", sig, sig_len))) {
+            return err_info;
+        }
+        if (submod->revs && (err_info = sr_lydmods_deps_sig_add(submod->revs[0].date, sig, sig_len))) {
+            return err_info;
+        }
+    }
+
+    while ((f = lysp_feature_next(f, ly_mod->parsed, &idx))) {
+        if (!(f->flags & LYS_FENABLED)) {
+            continue;
+        }
+        if ((err_info = sr_lydmods_deps_sig_add(",", sig, sig_len))) {
+            return err_info;
+        }
+        if ((err_info = sr_lydmods_deps_sig_add(f->name, sig, sig_len))) {
+            return err_info;
+        }
+    }
+
+    return sr_lydmods_deps_sig_add(";", sig, sig_len);
+}
+
+/**
+ * @brief Get the signature of all the modules that the dependencies of a module are computed from.
+ *
+ * These are the module itself, the modules augmenting or deviating it, and all its imports.
+ *
+ * @param[in] ly_mod Module to use.
+ * @param[out] sig Module dependency signature.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deps_sig(const struct lys_module *ly_mod, char **sig)
+{
+    sr_error_info_t *err_info = NULL;
+    LY_ARRAY_COUNT_TYPE u;
+    size_t sig_len = 0;
+
+    *sig = NULL;
+
+    if ((err_info = sr_lydmods_deps_sig_add_module(ly_mod, sig, &sig_len))) {
+        goto cleanup;
+    }
+    LY_ARRAY_FOR(ly_mod->augmented_by, u) {
+        if ((err_info = sr_lydmods_deps_sig_add_module(ly_mod->augmented_by[u], sig, &sig_len))) {
+            goto cleanup;
+        }
+    }
+    if ((err_info = sr_lydmods_deps_sig_add("|", sig, &sig_len))) {
+        goto cleanup;
+    }
+    LY_ARRAY_FOR(ly_mod->deviated_by, u) {
+        if ((err_info = sr_lydmods_deps_sig_add_module(ly_mod->deviated_by[u], sig, &sig_len))) {
+            goto cleanup;
+        }
+    }
+    if ((err_info = sr_lydmods_deps_sig_add("|", sig, &sig_len))) {
+        goto cleanup;
+    }
+    LY_ARRAY_FOR(ly_mod->parsed->imports, u) {
+        if ((err_info = sr_lydmods_deps_sig_add_module(ly_mod->parsed->imports[u].module, sig, &sig_len))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (err_info) {
+        free(*sig);
+        *sig = NULL;
+    }
+    return err_info;
+}
+
+/**
+ * @brief Add cached dependencies of a module into SR internal module data.
+ *
+ * @param[in] sr_mod Module to add to, with no dependencies.
+ * @param[in] sig Current module dependency signature.
+ * @param[out] found Whether the dependencies were found in the cache and added.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deps_cache_get(struct lyd_node *sr_mod, const char *sig, int *found)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_lydmods_deps_rec rec = {0}, *rec_p;
+    struct lyd_node *tree = NULL, *node, *next;
+
+    *found = 0;
+
+    rec.name = (char *)lyd_get_value(lyd_child(sr_mod));
+
+    /* DEPS CACHE LOCK */
+    pthread_mutex_lock(&deps_cache.lock);
+
+    if (!deps_cache.ht || lyht_find(deps_cache.ht, &rec, lyht_hash(rec.name, strlen(rec.name)), (void **)&rec_p) ||
+            strcmp(rec_p->sig, sig)) {
+        /* not cached or the modules changed */
+        goto cleanup;
+    }
+
+    /* parse the cached dependencies */
+    if ((err_info = sr_lyd_parse_data(LYD_CTX(sr_mod), rec_p->lyb, NULL, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_STRICT, 0,
+            &tree))) {
+        goto cleanup;
+    }
+
+cleanup:
+    /* DEPS CACHE UNLOCK */
+    pthread_mutex_unlock(&deps_cache.lock);
+
+    if (!err_info && tree) {
+        /* move them into the module, skip the key */
+        LY_LIST_FOR_SAFE(lyd_child(lyd_child(tree))->next, next, node) {
+            lyd_unlink_tree(node);
+            if ((err_info = sr_lyd_insert_child(sr_mod, node))) {
+                lyd_free_tree(node);
+                break;
+            }
+        }
+        *found = err_info ? 0 : 1;
+    }
+    lyd_free_all(tree);
+    return err_info;
+}
+
+/**
+ * @brief Store computed dependencies of a module into the cache.
+ *
+ * @param[in] sr_mod Module with the dependencies.
+ * @param[in] sig Module dependency signature.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deps_cache_put(const struct lyd_node *sr_mod, const char *sig)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_lydmods_deps_rec rec = {0}, *rec_p;
+    struct lyd_node *mod_dup = NULL, *node, *dup;
+    char *lyb = NULL, *sig_dup = NULL;
+    uint32_t hash;
+
+    /* create a module with only its key and the dependencies */
+    if ((err_info = sr_lyd_dup(sr_mod, NULL, LYD_DUP_WITH_PARENTS, 0, &mod_dup))) {
+        goto cleanup;
+    }
+    LY_LIST_FOR(lyd_child(sr_mod), node) {
+        if (strcmp(LYD_NAME(node), "deps") && strcmp(LYD_NAME(node), "rpc") && strcmp(LYD_NAME(node), "notification")) {
+            continue;
+        }
+        if ((err_info = sr_lyd_dup(node, mod_dup, LYD_DUP_RECURSIVE, 0, &dup))) {
+            goto cleanup;
+        }
+    }
+    if ((err_info = sr_lyd_print_data(lyd_parent(mod_dup), LYD_LYB, 0, -1, &lyb, NULL))) {
+        goto cleanup;
+    }
+    sig_dup = strdup(sig);
+    SR_CHECK_MEM_GOTO(!sig_dup, err_info, cleanup);
+
+    rec.name = (char *)lyd_get_value(lyd_child(sr_mod));
+    hash = lyht_hash(rec.name, strlen(rec.name));
+
+    /* DEPS CACHE LOCK */
+    pthread_mutex_lock(&deps_cache.lock);
+
+    if (!deps_cache.ht) {
+        deps_cache.ht = lyht_new(32, sizeof rec, sr_lydmods_deps_ht_equal_cb, NULL, 1);
+        SR_CHECK_MEM_GOTO(!deps_cache.ht, err_info, cleanup_unlock);
+    }
+
+    if (!lyht_find(deps_cache.ht, &rec, hash, (void **)&rec_p)) {
+        /* replace the outdated dependencies */
+        free(rec_p->sig);
+        free(rec_p->lyb);
+    } else {
+        rec.name = strdup(rec.name);
+        SR_CHECK_MEM_GOTO(!rec.name, err_info, cleanup_unlock);
+        if ((err_info = sr_lyht_insert(deps_cache.ht, &rec, hash))) {
+            free(rec.name);
+            goto cleanup_unlock;
+        }
+        lyht_find(deps_cache.ht, &rec, hash, (void **)&rec_p);
+    }
+    rec_p->sig = sig_dup;
+    rec_p->lyb = lyb;
+    sig_dup = NULL;
+    lyb = NULL;
+
+cleanup_unlock:
+    /* DEPS CACHE UNLOCK */
+    pthread_mutex_unlock(&deps_cache.lock);
+
+cleanup:
+    lyd_free_all(mod_dup);
+    free(lyb);
+    free(sig_dup);
+    return err_info;
+}
+
 /**
  * @brief Rebuild all dependencies (with inverse) and RPCs/notifications with dependencies in SR internal module data.
  *
@@ -792,7 +1118,8 @@ sr_lydmods_add_deps_all(const struct ly_ctx *ly_ctx, struct lyd_node *sr_mods)
     struct ly_set *set = NULL;
     struct lyd_node *sr_mod, *sr_mod2, *sr_deps;
     uint32_t i;
-    char *xpath;
+    char *xpath, *sig = NULL;
+    int found;
     struct sr_lydmods_deps_dfs_arg dfs_arg;
 
     LY_LIST_FOR(lyd_child(sr_mods), sr_mod) {
@@ -811,18 +1138,39 @@ sr_lydmods_add_deps_all(const struct ly_ctx *ly_ctx, struct lyd_node *sr_mods)
         ly_mod = ly_ctx_get_module_implemented(ly_ctx, lyd_get_value(lyd_child(sr_mod)));
         SR_CHECK_INT_GOTO(!ly_mod, err_info, cleanup);
 
-        /* create new deps */
-        if ((err_info = sr_lyd_new_inner(sr_mod, NULL, "deps", &sr_deps))) {
+        /* reuse the deps if none of the modules they are computed from changed */
+        free(sig);
+        if ((err_info = sr_lydmods_deps_sig(ly_mod, &sig))) {
+            goto cleanup;
+        }
+        if ((err_info = sr_lydmods_deps_cache_get(sr_mod, sig, &found))) {
             goto cleanup;
         }
 
-        /* add all module deps (data, RPC, notif) */
-        dfs_arg.sr_mod = sr_mod;
-        dfs_arg.sr_deps = sr_deps;
-        dfs_arg.root_notif = NULL;
-        dfs_arg.err_info = NULL;
-        if (lysc_module_dfs_full(ly_mod, sr_lydmods_add_all_deps_dfs_cb, &dfs_arg)) {
-            err_info = dfs_arg.err_info;
+        if (!found) {
+            /* create new deps */
+            if ((err_info = sr_lyd_new_inner(sr_mod, NULL, "deps", &sr_deps))) {
+                goto cleanup;
+            }
+
+            /* add all module deps (data, RPC, notif) */
+            dfs_arg.sr_mod = sr_mod;
+            dfs_arg.sr_deps = sr_deps;
+            dfs_arg.root_notif = NULL;
+            dfs_arg.err_info = NULL;
+            if (lysc_module_dfs_full(ly_mod, sr_lydmods_add_all_deps_dfs_cb, &dfs_arg)) {
+                err_info = dfs_arg.err_info;
+                goto cleanup;
+            }
+
+            /* cache them */
+            if ((err_info = sr_lydmods_deps_cache_put(sr_mod, sig))) {
+                goto cleanup;
+            }
+        }
+
+        /* add schema deps */
+        if ((err_info = sr_lydmods_add_schema_deps(sr_mod, ly_mod))) {
             goto cleanup;
         }
 
@@ -854,6 +1202,7 @@ sr_lydmods_add_deps_all(const struct ly_ctx *ly_ctx, struct lyd_node *sr_mods)
     }
 
 cleanup:
+    free(sig);
     ly_set_free(set, NULL);
     return err_info;
 }
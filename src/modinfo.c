@@ -171,7 +171,7 @@ sr_modinfo_collect_edit(const struct lyd_node *edit, struct sr_mod_info_s *mod_i
             xpath = lyd_get_value(root);
             if (xpath && xpath[0]) {
                 /* collect xpath to discard */
-                if ((err_info = sr_modinfo_collect_xpath(mod_info->conn->ly_ctx, xpath, SR_DS_OPERATIONAL, NULL, 0,
+                if ((err_info = sr_modinfo_collect_xpath(mod_info->conn, xpath, SR_DS_OPERATIONAL, NULL, 0,
                         mod_info))) {
                     return err_info;
                 }
@@ -260,16 +260,17 @@ sr_modinfo_session_has_data_changes(sr_session_ctx_t *session, const struct lys_
 }
 
 sr_error_info_t *
-sr_modinfo_collect_xpath(const struct ly_ctx *ly_ctx, const char *xpath, sr_datastore_t ds,
+sr_modinfo_collect_xpath(sr_conn_ctx_t *conn, const char *xpath, sr_datastore_t ds,
         sr_session_ctx_t *session, uint32_t xpath_opts, struct sr_mod_info_s *mod_info)
 {
     sr_error_info_t *err_info = NULL;
-    const struct lys_module *prev_ly_mod, *ly_mod;
+    const struct lys_module *prev_ly_mod, *ly_mod, **mods = NULL;
     const struct lysc_node *snode;
     struct ly_set *set = NULL;
     struct ly_ctx *sm_ctx = NULL;
-    uint32_t i;
-    int store_xpath, dup_xpath;
+    uint32_t i, mod_count = 0;
+    int store_xpath, dup_xpath, conventional, cached;
+    void *mem;
 
     /* process (simple) xpath options */
     if (xpath_opts & MOD_INFO_XPATH_STORE_ALL) {
@@ -282,44 +283,73 @@ sr_modinfo_collect_xpath(const struct ly_ctx *ly_ctx, const char *xpath, sr_data
     } else {
         dup_xpath = 0;
     }
+    conventional = SR_IS_CONVENTIONAL_DS(ds);
 
-    /* learn what nodes are needed for evaluation */
-    if (((err_info = sr_lys_find_xpath_atoms(ly_ctx, xpath, LYS_FIND_NO_MATCH_ERROR | LYS_FIND_SCHEMAMOUNT, NULL, &set)))) {
+    /* parse the diffs of all the modules of a change event session that may be needed */
+    if (session && (xpath_opts & MOD_INFO_XPATH_STORE_SESSION_CHANGES) &&
+            (err_info = sr_shmsub_change_listen_diff_complete(session, xpath))) {
         goto cleanup;
     }
 
-    /* add all the modules of the nodes */
-    prev_ly_mod = NULL;
-    for (i = 0; i < set->count; ++i) {
-        snode = set->snodes[i];
-        if (snode->module->ctx != ly_ctx) {
-            /* skip mounted schema nodes and destroy the context */
-            assert(!sm_ctx || (sm_ctx == snode->module->ctx));
-            sm_ctx = snode->module->ctx;
-            continue;
-        } else if ((snode->nodetype & (LYS_RPC | LYS_NOTIF)) || ((snode->flags & LYS_CONFIG_R) && SR_IS_CONVENTIONAL_DS(ds))) {
-            /* skip uninteresting nodes */
-            continue;
+    /* try to use the modules learned for the same xpath before */
+    if ((err_info = sr_conn_xpath_cache_get(conn, xpath, conventional, &mods, &mod_count, &cached))) {
+        goto cleanup;
+    }
+
+    if (!cached) {
+        /* learn what nodes are needed for evaluation */
+        if (((err_info = sr_lys_find_xpath_atoms(conn->ly_ctx, xpath, LYS_FIND_NO_MATCH_ERROR | LYS_FIND_SCHEMAMOUNT,
+                NULL, &set)))) {
+            goto cleanup;
         }
 
-        ly_mod = lysc_owner_module(snode);
-        if (ly_mod == prev_ly_mod) {
-            /* skip already-added modules */
-            continue;
+        /* collect all the modules of the nodes */
+        prev_ly_mod = NULL;
+        for (i = 0; i < set->count; ++i) {
+            snode = set->snodes[i];
+            if (snode->module->ctx != conn->ly_ctx) {
+                /* skip mounted schema nodes and destroy the context */
+                assert(!sm_ctx || (sm_ctx == snode->module->ctx));
+                sm_ctx = snode->module->ctx;
+                continue;
+            } else if ((snode->nodetype & (LYS_RPC | LYS_NOTIF)) || ((snode->flags & LYS_CONFIG_R) && conventional)) {
+                /* skip uninteresting nodes */
+                continue;
+            }
+
+            ly_mod = lysc_owner_module(snode);
+            if (ly_mod == prev_ly_mod) {
+                /* skip already-added modules */
+                continue;
+            }
+            prev_ly_mod = ly_mod;
+
+            if (!ly_mod->implemented || !strcmp(ly_mod->name, "sysrepo") || !strcmp(ly_mod->name, "ietf-netconf")) {
+                /* skip import-only modules, the internal sysrepo module, and ietf-netconf (as it has no data, only in libyang) */
+                continue;
+            }
+
+            mem = realloc(mods, (mod_count + 1) * sizeof *mods);
+            SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+            mods = mem;
+            mods[mod_count] = ly_mod;
+            ++mod_count;
         }
-        prev_ly_mod = ly_mod;
 
-        if (!ly_mod->implemented || !strcmp(ly_mod->name, "sysrepo") || !strcmp(ly_mod->name, "ietf-netconf")) {
-            /* skip import-only modules, the internal sysrepo module, and ietf-netconf (as it has no data, only in libyang) */
-            continue;
+        if (!sm_ctx && (err_info = sr_conn_xpath_cache_add(conn, xpath, conventional, mods, mod_count))) {
+            /* schema-mount contexts are created for each evaluation, cache only standard xpaths */
+            goto cleanup;
         }
+    }
 
+    /* add all the modules */
+    for (i = 0; i < mod_count; ++i) {
         if (xpath_opts & MOD_INFO_XPATH_STORE_SESSION_CHANGES) {
             /* decide for each module */
-            store_xpath = !sr_modinfo_session_has_data_changes(session, ly_mod);
+            store_xpath = !sr_modinfo_session_has_data_changes(session, mods[i]);
         }
 
-        if ((err_info = sr_modinfo_add(ly_mod, store_xpath ? xpath : NULL, dup_xpath, 0, mod_info))) {
+        if ((err_info = sr_modinfo_add(mods[i], store_xpath ? xpath : NULL, dup_xpath, 0, mod_info))) {
             goto cleanup;
         }
     }
@@ -327,6 +357,7 @@ sr_modinfo_collect_xpath(const struct ly_ctx *ly_ctx, const char *xpath, sr_data
 cleanup:
     ly_ctx_destroy(sm_ctx);
     ly_set_free(set, NULL);
+    free(mods);
     return err_info;
 }
 
@@ -347,6 +378,11 @@ sr_modinfo_collect_deps(struct sr_mod_info_s *mod_info)
             }
         /* fallthrough */
         case MOD_INFO_INV_DEP:
+            if (mod->state & MOD_INFO_INV_DEP_SKIP) {
+                /* references of this module are not affected by the changes */
+                break;
+            }
+
             /* this module data will be validated */
             assert(mod->state & MOD_INFO_DATA);
             if ((err_info = sr_shmmod_collect_deps(SR_CONN_MOD_SHM(mod_info->conn),
@@ -399,7 +435,7 @@ sr_modinfo_collect_ext_deps(const struct lysc_node *mp_node, struct sr_mod_info_
     path = lysc_path(mp_node, LYSC_PATH_DATA, NULL, 0);
 
     /* collect all the mounted data */
-    if ((err_info = sr_modinfo_collect_xpath(mod_info->conn->ly_ctx, path, mod_info->ds, NULL,
+    if ((err_info = sr_modinfo_collect_xpath(mod_info->conn, path, mod_info->ds, NULL,
             MOD_INFO_XPATH_STORE_ALL | MOD_INFO_XPATH_STORE_DUP, mod_info))) {
         goto cleanup;
     }
@@ -454,6 +490,125 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Append a module dependency to an array of RPC/action dependencies.
+ *
+ * @param[in] ly_ctx Context to use.
+ * @param[in] mod_name Dependency module name.
+ * @param[in] xpath XPath selecting the required data.
+ * @param[in,out] deps Array of dependencies to append to.
+ * @param[in,out] dep_count Count of @p deps.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_rpc_dep_append(const struct ly_ctx *ly_ctx, const char *mod_name, const char *xpath,
+        struct sr_rpc_dep_mod_s **deps, uint32_t *dep_count)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    void *mem;
+
+    /* find ly module */
+    ly_mod = ly_ctx_get_module_implemented(ly_ctx, mod_name);
+    SR_CHECK_INT_RET(!ly_mod, err_info);
+
+    mem = realloc(*deps, (*dep_count + 1) * sizeof **deps);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    *deps = mem;
+
+    (*deps)[*dep_count].ly_mod = ly_mod;
+    (*deps)[*dep_count].xpath = strdup(xpath);
+    SR_CHECK_MEM_RET(!(*deps)[*dep_count].xpath, err_info);
+    ++(*dep_count);
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_modinfo_collect_rpc_deps(const char *path, int output, const struct lyd_node *data, struct sr_mod_info_s *mod_info)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = mod_info->conn;
+    char *mod_shm_addr = conn->mod_shm.addr;
+    struct sr_rpc_dep_mod_s *deps = NULL;
+    sr_dep_t *shm_deps;
+    uint16_t shm_dep_count;
+    uint32_t i, j, dep_count = 0;
+    off_t *mod_names;
+    const char *str;
+    int instid = 0, found;
+
+    /* use the cached dependencies, if any */
+    if ((err_info = sr_conn_rpc_dep_cache_collect(conn, path, output, mod_info, &instid, &found))) {
+        goto cleanup;
+    }
+    if (found && !instid) {
+        goto cleanup;
+    }
+
+    /* get the dependencies from SHM */
+    if ((err_info = sr_shmmod_get_rpc_deps(SR_CONN_MOD_SHM(conn), path, output, &shm_deps, &shm_dep_count))) {
+        goto cleanup;
+    }
+
+    if (found) {
+        /* only the instance-identifier dependencies depend on the data */
+        for (i = 0; i < shm_dep_count; ++i) {
+            if (shm_deps[i].type != SR_DEP_INSTID) {
+                continue;
+            }
+
+            str = shm_deps[i].instid.default_target_path ? mod_shm_addr + shm_deps[i].instid.default_target_path : NULL;
+            if ((err_info = sr_shmmod_collect_deps_instid(mod_shm_addr + shm_deps[i].instid.source_path, str, data,
+                    mod_info))) {
+                goto cleanup;
+            }
+        }
+        goto cleanup;
+    }
+
+    /* collect all the dependencies */
+    if ((err_info = sr_shmmod_collect_deps(SR_CONN_MOD_SHM(conn), shm_deps, shm_dep_count, data, mod_info))) {
+        goto cleanup;
+    }
+
+    /* learn the dependencies independent of the data to cache them */
+    for (i = 0; i < shm_dep_count; ++i) {
+        switch (shm_deps[i].type) {
+        case SR_DEP_LREF:
+            if ((err_info = sr_modinfo_rpc_dep_append(conn->ly_ctx, mod_shm_addr + shm_deps[i].lref.target_module,
+                    mod_shm_addr + shm_deps[i].lref.target_path, &deps, &dep_count))) {
+                goto cleanup;
+            }
+            break;
+        case SR_DEP_INSTID:
+            instid = 1;
+            break;
+        case SR_DEP_XPATH:
+            mod_names = (off_t *)(mod_shm_addr + shm_deps[i].xpath.target_modules);
+            for (j = 0; j < shm_deps[i].xpath.target_mod_count; ++j) {
+                if ((err_info = sr_modinfo_rpc_dep_append(conn->ly_ctx, mod_shm_addr + mod_names[j],
+                        mod_shm_addr + shm_deps[i].xpath.expr, &deps, &dep_count))) {
+                    goto cleanup;
+                }
+            }
+            break;
+        default:
+            SR_ERRINFO_INT(&err_info);
+            goto cleanup;
+        }
+    }
+
+    /* cache them */
+    err_info = sr_conn_rpc_dep_cache_add(conn, path, output, deps, dep_count, instid);
+    deps = NULL;
+    dep_count = 0;
+
+cleanup:
+    sr_conn_rpc_dep_cache_deps_free(deps, dep_count);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_modinfo_perm_check(struct sr_mod_info_s *mod_info, int wr, int strict)
 {
@@ -727,6 +882,214 @@ sr_modinfo_diff_merge(struct sr_mod_info_s *mod_info, const struct lyd_node *new
     return NULL;
 }
 
+/**
+ * @brief Check whether data siblings can be compared one-by-one regardless of their positions.
+ *
+ * @param[in] first First sibling.
+ * @return Whether there are no opaque nodes or instances with a relevant position.
+ */
+static int
+sr_modinfo_replace_siblings_unordered(const struct lyd_node *first)
+{
+    const struct lyd_node *node;
+
+    LY_LIST_FOR(first, node) {
+        if (!node->schema || lysc_is_userordered(node->schema) || lysc_is_dup_inst_list(node->schema)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Learn the differences of data subtrees or siblings and merge them into a diff.
+ *
+ * @param[in] dst Current data.
+ * @param[in] src New data.
+ * @param[in] siblings Whether to compare all the siblings of @p dst and @p src or only the subtrees.
+ * @param[in,out] diff Diff to merge into.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_replace_diff_add(const struct lyd_node *dst, const struct lyd_node *src, int siblings, struct lyd_node **diff)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *part = NULL;
+
+    if (siblings) {
+        err_info = sr_lyd_diff_siblings(dst, src, LYD_DIFF_DEFAULTS, &part);
+    } else {
+        err_info = sr_lyd_diff_tree(dst, src, LYD_DIFF_DEFAULTS, &part);
+    }
+    if (err_info || !part) {
+        return err_info;
+    }
+
+    if (!*diff) {
+        *diff = part;
+        return NULL;
+    }
+
+    err_info = sr_lyd_diff_merge_all(diff, part);
+    lyd_free_siblings(part);
+    return err_info;
+}
+
+/**
+ * @brief Learn the differences of current and new data siblings, skipping subtrees with equal content hashes.
+ *
+ * @param[in] dst_first First sibling of the current data.
+ * @param[in] src_first First sibling of the new data.
+ * @param[in] parent_path Path hash of the parent of the siblings.
+ * @param[in] dst_hashes Subtree hashes of the current data.
+ * @param[in] dst_hash_count Count of @p dst_hashes.
+ * @param[in] src_hashes Subtree hashes of the new data.
+ * @param[in] src_hash_count Count of @p src_hashes.
+ * @param[in,out] diff Diff to merge into.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_replace_diff_r(const struct lyd_node *dst_first, const struct lyd_node *src_first, uint64_t parent_path,
+        const struct sr_subtree_hash_s *dst_hashes, uint32_t dst_hash_count, const struct sr_subtree_hash_s *src_hashes,
+        uint32_t src_hash_count, struct lyd_node **diff)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *dst, *src;
+    struct lyd_node *match;
+    uint64_t path, content;
+
+    if (!sr_modinfo_replace_siblings_unordered(dst_first) || !sr_modinfo_replace_siblings_unordered(src_first)) {
+        /* instance positions matter, learn the differences of all the siblings */
+        return sr_modinfo_replace_diff_add(dst_first, src_first, 1, diff);
+    }
+
+    LY_LIST_FOR(dst_first, dst) {
+        if (lysc_is_key(dst->schema)) {
+            /* same in both list instances */
+            continue;
+        }
+
+        match = NULL;
+        if (src_first) {
+            lyd_find_sibling_first(src_first, dst, &match);
+        }
+
+        if (match && (dst->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+            path = sr_subtree_hash_path(parent_path, dst);
+            content = sr_subtree_hash_find(dst_hashes, dst_hash_count, path);
+            if (content && (content == sr_subtree_hash_find(src_hashes, src_hash_count, path))) {
+                /* equal subtrees */
+                continue;
+            }
+
+            /* learn the differences of the children */
+            err_info = sr_modinfo_replace_diff_r(lyd_child(dst), lyd_child(match), path, dst_hashes, dst_hash_count,
+                    src_hashes, src_hash_count, diff);
+        } else {
+            /* deleted subtree or a possibly changed term node */
+            err_info = sr_modinfo_replace_diff_add(dst, match, 0, diff);
+        }
+        if (err_info) {
+            return err_info;
+        }
+    }
+
+    LY_LIST_FOR(src_first, src) {
+        if (lysc_is_key(src->schema)) {
+            continue;
+        }
+
+        match = NULL;
+        if (dst_first) {
+            lyd_find_sibling_first(dst_first, src, &match);
+        }
+
+        if (!match && (err_info = sr_modinfo_replace_diff_add(NULL, src, 0, diff))) {
+            /* created subtree */
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_modinfo_subtree_hash_diff(const struct lyd_node *dst_data, const struct sr_subtree_hash_s *dst_hashes,
+        uint32_t dst_hash_count, const struct lyd_node *src_data, const struct sr_subtree_hash_s *src_hashes,
+        uint32_t src_hash_count, struct lyd_node **diff)
+{
+    sr_error_info_t *err_info = NULL;
+
+    *diff = NULL;
+
+    if ((err_info = sr_modinfo_replace_diff_r(dst_data, src_data, SR_SUBTREE_HASH_ROOT, dst_hashes, dst_hash_count,
+            src_hashes, src_hash_count, diff))) {
+        lyd_free_siblings(*diff);
+        *diff = NULL;
+    }
+    return err_info;
+}
+
+/**
+ * @brief Learn the differences of current and new module data using subtree hashes.
+ *
+ * Hashes of the current data are taken from the connection running data cache, if known. Otherwise, they are
+ * generated and stored in the cache for the following replace.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module.
+ * @param[in] dst_mod_data Current module data, loaded from the connection running data cache.
+ * @param[in] src_mod_data New module data.
+ * @param[out] diff Diff of the data, NULL if there are no differences.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_replace_hash_diff(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod,
+        const struct lyd_node *dst_mod_data, const struct lyd_node *src_mod_data, struct lyd_node **diff)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_subtree_hash_s *dst_hashes = NULL, *src_hashes = NULL;
+    uint32_t dst_hash_count, src_hash_count = 0;
+    int dst_cached;
+
+    *diff = NULL;
+
+    /* hashes of the current data */
+    if ((err_info = sr_conn_run_cache_hashes_get(mod_info->conn, mod->ly_mod, &dst_hashes, &dst_hash_count))) {
+        goto cleanup;
+    }
+    dst_cached = dst_hashes ? 1 : 0;
+    if (!dst_cached && (err_info = sr_lyd_subtree_hashes(dst_mod_data, &dst_hashes, &dst_hash_count))) {
+        goto cleanup;
+    }
+
+    /* hashes of the new data */
+    if ((err_info = sr_lyd_subtree_hashes(src_mod_data, &src_hashes, &src_hash_count))) {
+        goto cleanup;
+    }
+
+    if ((err_info = sr_modinfo_subtree_hash_diff(dst_mod_data, dst_hashes, dst_hash_count, src_mod_data, src_hashes,
+            src_hash_count, diff))) {
+        goto cleanup;
+    }
+
+    if (!dst_cached) {
+        /* cache the hashes of the current data, spent */
+        err_info = sr_conn_run_cache_hashes_set(mod_info->conn, mod->ly_mod, dst_hashes, dst_hash_count);
+        dst_hashes = NULL;
+    }
+
+cleanup:
+    free(dst_hashes);
+    free(src_hashes);
+    if (err_info) {
+        lyd_free_siblings(*diff);
+        *diff = NULL;
+    }
+    return err_info;
+}
+
 sr_error_info_t *
 sr_modinfo_replace(struct sr_mod_info_s *mod_info, struct lyd_node **src_data)
 {
@@ -734,20 +1097,50 @@ sr_modinfo_replace(struct sr_mod_info_s *mod_info, struct lyd_node **src_data)
     struct sr_mod_info_mod_s *mod;
     struct lyd_node *src_mod_data, *dst_mod_data, *diff;
     uint32_t i;
+    int use_hashes;
 
     assert(!mod_info->diff && !mod_info->data_cached);
 
+    /* current data are loaded from the cache, where their subtree hashes can be kept */
+    use_hashes = (mod_info->ds == SR_DS_RUNNING) && (mod_info->conn->opts & SR_CONN_CACHE_RUNNING);
+
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
         if (mod->state & MOD_INFO_REQ) {
             dst_mod_data = sr_module_data_unlink(&mod_info->data, mod->ly_mod);
             src_mod_data = sr_module_data_unlink(src_data, mod->ly_mod);
 
-            /* get diff on only this module's data */
-            if ((err_info = sr_lyd_diff_siblings(dst_mod_data, src_mod_data, LYD_DIFF_DEFAULTS, &diff))) {
-                lyd_free_all(dst_mod_data);
-                lyd_free_all(src_mod_data);
-                return err_info;
+            if (use_hashes) {
+                /* skip equal subtrees based on their hashes */
+                err_info = sr_modinfo_replace_hash_diff(mod_info, mod, dst_mod_data, src_mod_data, &diff);
+                if (!err_info && diff) {
+                    /* apply the diff on the current data to keep the default nodes of the skipped subtrees */
+                    err_info = sr_lyd_diff_apply_module(&dst_mod_data, diff, mod->ly_mod, NULL);
+                    if (err_info) {
+                        lyd_free_siblings(diff);
+                    } else {
+                        lyd_free_all(src_mod_data);
+                        src_mod_data = dst_mod_data;
+                        dst_mod_data = NULL;
+                    }
+                }
+                if (err_info) {
+                    lyd_free_all(dst_mod_data);
+                    lyd_free_all(src_mod_data);
+                    return err_info;
+                }
+                mod->state |= MOD_INFO_SUBTREE_HASH;
+            } else if (!lyd_compare_siblings(dst_mod_data, src_mod_data,
+                    LYD_COMPARE_FULL_RECURSION | LYD_COMPARE_DEFAULTS)) {
+                /* same data, no need to generate the diff */
+                diff = NULL;
+            } else {
+                /* get diff on only this module's data */
+                if ((err_info = sr_lyd_diff_siblings(dst_mod_data, src_mod_data, LYD_DIFF_DEFAULTS, &diff))) {
+                    lyd_free_all(dst_mod_data);
+                    lyd_free_all(src_mod_data);
+                    return err_info;
+                }
             }
 
             if (diff) {
@@ -956,99 +1349,286 @@ cleanup:
 }
 
 /**
- * @brief Get specific operational data from a subscriber.
+ * @brief Operational get subscription whose data are to be requested.
+ */
+struct sr_oper_get_batch_s {
+    uint32_t idx1;                  /**< Index of the subscription array with subscriptions with the same XPath. */
+    const char *sub_xpath;          /**< Subscription XPath. */
+    const char **request_xpaths;    /**< XPaths based on which these data are required, NULL if all the data. */
+    uint32_t req_xpath_count;       /**< Count of @p request_xpaths. */
+    struct ly_set *parents;         /**< Data parents to get the data for, NULL if top-level. */
+    uint32_t next;                  /**< Index of the next parent to get the data for. */
+    uint32_t max_depth;             /**< Maximum depth of the required data relative to the subscription nodes,
+                                         0 if unlimited. */
+};
+
+/**
+ * @brief Get the maximum depth of operational data required from a subscription.
  *
- * @param[in] mod Modinfo structure of the data.
- * @param[in] xpath XPath of the provided data.
- * @param[in] request_xpaths XPaths based on which these data are required, if NULL the complete module data are needed.
+ * @param[in] request_xpaths XPaths based on which the data are required, NULL if all the data.
  * @param[in] req_xpath_count Count of @p request_xpaths.
- * @param[in] orig_name Event originator name.
- * @param[in] orig_data Event originator data.
- * @param[in] shm_subs Subscription array.
- * @param[in] idx1 Index of the subscription array from where to read subscriptions with the same XPath.
- * @param[in] parent Data parent required for the subscription, NULL if top-level.
- * @param[in] timeout_ms Operational callback timeout in milliseconds.
- * @param[in] conn Connection.
- * @param[out] oper_data Data tree with appended operational data.
- * @return err_info, NULL on success.
+ * @param[in] sub_xpath Subscription XPath.
+ * @param[in] max_depth Maximum depth of the nodes selected by @p request_xpaths, 0 if unlimited.
+ * @return Maximum depth relative to the subscription nodes, 0 if unlimited or not known.
  */
-static sr_error_info_t *
-sr_xpath_oper_data_get(struct sr_mod_info_mod_s *mod, const char *xpath, const char **request_xpaths,
-        uint32_t req_xpath_count, const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *shm_subs,
-        uint32_t idx1, const struct lyd_node *parent, uint32_t timeout_ms, sr_conn_ctx_t *conn,
-        struct lyd_node **oper_data)
-{
-    sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
-    struct lyd_node *parent_dup = NULL, *last_parent;
-    const char *request_xpath;
-    char *parent_path = NULL;
-    uint32_t i;
-    int required;
+static uint32_t
+sr_oper_get_sub_max_depth(const char **request_xpaths, uint32_t req_xpath_count, const char *sub_xpath,
+        uint32_t max_depth)
+{
+    uint32_t i, depth, last_depth = 0, sub_depth;
 
-    *oper_data = NULL;
+    if (!max_depth || !req_xpath_count || !(sub_depth = sr_xpath_path_depth(sub_xpath))) {
+        return 0;
+    }
 
-    if (parent) {
-        /* duplicate parent so that it is a stand-alone subtree */
-        if ((err_info = sr_lyd_dup(parent, NULL, LYD_DUP_WITH_PARENTS, 0, &last_parent))) {
-            return err_info;
+    /* learn the depth of the deepest required node */
+    for (i = 0; i < req_xpath_count; ++i) {
+        if (!(depth = sr_xpath_path_depth(request_xpaths[i]))) {
+            /* the selected nodes and any nodes needed to select them are not known */
+            return 0;
         }
 
-        /* go top-level */
-        for (parent_dup = last_parent; parent_dup->parent; parent_dup = lyd_parent(parent_dup)) {}
-
-        if (req_xpath_count) {
-            /* check whether the parent would not be filtered out */
-            parent_path = lyd_path(last_parent, LYD_PATH_STD, NULL, 0);
-            SR_CHECK_MEM_GOTO(!parent_path, err_info, cleanup);
-
-            for (i = 0; i < req_xpath_count; ++i) {
-                if ((err_info = sr_xpath_oper_data_required(request_xpaths[i], parent_path, &required))) {
-                    goto cleanup;
-                }
-                if (required) {
-                    break;
-                }
-            }
-            if (i == req_xpath_count) {
-                goto cleanup;
-            }
+        depth += max_depth - 1;
+        if (depth > last_depth) {
+            last_depth = depth;
         }
     }
 
-    /* provide request XPath for the client, if possible */
-    request_xpath = (req_xpath_count == 1) ? request_xpaths[0] : NULL;
-
-    /* get data from client */
-    if ((err_info = sr_shmsub_oper_get_notify(mod, xpath, request_xpath, parent_dup, orig_name, orig_data, shm_subs,
-            idx1, timeout_ms, conn, oper_data, &cb_err_info))) {
-        sr_errinfo_merge(&err_info, cb_err_info);
-        goto cleanup;
+    if (last_depth <= sub_depth) {
+        /* only the subscription nodes (their keys) are required */
+        return 1;
     }
+    return last_depth - sub_depth + 1;
+}
 
-    /* return callback error if some was generated */
-    if (cb_err_info) {
-        sr_errinfo_merge(&err_info, cb_err_info);
-        sr_errinfo_new(&err_info, SR_ERR_CALLBACK_FAILED, "User callback failed.");
-        goto cleanup;
-    }
+/**
+ * @brief Free a batch of operational get subscriptions.
+ *
+ * @param[in] batch Batch to free.
+ * @param[in] batch_count Count of subscriptions in @p batch.
+ */
+static void
+sr_oper_get_batch_free(struct sr_oper_get_batch_s *batch, uint32_t batch_count)
+{
+    uint32_t i;
 
-    if (*oper_data) {
-        /* add any missing NP containers, redundant to add top-level containers */
-        if ((err_info = sr_lyd_new_implicit_tree(*oper_data, LYD_IMPLICIT_NO_DEFAULTS))) {
-            goto cleanup;
-        }
+    for (i = 0; i < batch_count; ++i) {
+        free(batch[i].request_xpaths);
+        ly_set_free(batch[i].parents, NULL);
     }
-
-cleanup:
-    lyd_free_tree(parent_dup);
-    free(parent_path);
-    return err_info;
+    free(batch);
 }
 
 /**
- * @brief Try to merge operational get cached data of a subscription.
+ * @brief Check whether the data of an XPath may overlap with the data of any subscription in a batch so they
+ * cannot be requested concurrently.
  *
- * @param[in] mod Mod info module.
+ * @param[in] batch Batch of subscriptions.
+ * @param[in] batch_count Count of subscriptions in @p batch.
+ * @param[in] xpath XPath to check.
+ * @param[out] overlap Whether the data may overlap.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_oper_get_batch_overlap(const struct sr_oper_get_batch_s *batch, uint32_t batch_count, const char *xpath,
+        int *overlap)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    *overlap = 0;
+    for (i = 0; i < batch_count; ++i) {
+        if ((err_info = sr_xpath_oper_data_required(batch[i].sub_xpath, xpath, overlap))) {
+            return err_info;
+        }
+        if (*overlap) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check whether a data parent is the only possible instance so that it cannot be created by data from other
+ * subscriptions.
+ *
+ * @param[in] set Set with the found parents.
+ * @return Whether the parent is unique.
+ */
+static int
+sr_oper_get_parent_unique(const struct ly_set *set)
+{
+    const struct lyd_node *node;
+
+    if (set->count != 1) {
+        return 0;
+    }
+
+    for (node = set->dnodes[0]; node; node = lyd_parent(node)) {
+        if (!node->schema || (node->schema->nodetype != LYS_CONTAINER)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Get operational data from the subscribers of a batch of subscriptions and merge them into data.
+ *
+ * Requests for all the subscriptions are sent at once, requests for several parents of a single subscription
+ * one after another.
+ *
+ * @param[in] mod Modinfo structure of the data.
+ * @param[in,out] batch Batch of subscriptions, is freed.
+ * @param[in,out] batch_count Count of subscriptions in @p batch, is zeroed.
+ * @param[in] orig_name Event originator name.
+ * @param[in] orig_data Event originator data.
+ * @param[in] shm_subs Subscription array.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] conn Connection.
+ * @param[in,out] data Data tree to merge the operational data into.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_oper_get_batch_data(struct sr_mod_info_mod_s *mod, struct sr_oper_get_batch_s **batch, uint32_t *batch_count,
+        const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *shm_subs, uint32_t timeout_ms,
+        sr_conn_ctx_t *conn, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_oper_get_batch_s *b;
+    struct sr_shmsub_oper_get_req_s *reqs = NULL;
+    struct lyd_node *last_parent, *parent_dup;
+    char *parent_path;
+    uint32_t i, j, req_count = 0;
+    int required;
+
+    if (!*batch_count) {
+        goto cleanup;
+    }
+
+    reqs = calloc(*batch_count, sizeof *reqs);
+    SR_CHECK_MEM_GOTO(!reqs, err_info, cleanup);
+
+    do {
+        /* prepare the next request of every subscription */
+        req_count = 0;
+        for (i = 0; i < *batch_count; ++i) {
+            b = &(*batch)[i];
+
+            while (b->next < (b->parents ? b->parents->count : 1)) {
+                parent_dup = NULL;
+                if (b->parents) {
+                    /* duplicate parent so that it is a stand-alone subtree */
+                    if ((err_info = sr_lyd_dup(b->parents->dnodes[b->next], NULL, LYD_DUP_WITH_PARENTS, 0,
+                            &last_parent))) {
+                        goto cleanup;
+                    }
+
+                    /* go top-level */
+                    for (parent_dup = last_parent; parent_dup->parent; parent_dup = lyd_parent(parent_dup)) {}
+                }
+                ++b->next;
+
+                if (parent_dup && b->req_xpath_count) {
+                    /* check whether the parent would not be filtered out */
+                    parent_path = lyd_path(last_parent, LYD_PATH_STD, NULL, 0);
+                    if (!parent_path) {
+                        lyd_free_tree(parent_dup);
+                        SR_ERRINFO_MEM(&err_info);
+                        goto cleanup;
+                    }
+
+                    required = 0;
+                    for (j = 0; j < b->req_xpath_count; ++j) {
+                        if ((err_info = sr_xpath_oper_data_required(b->request_xpaths[j], parent_path, &required))) {
+                            break;
+                        }
+                        if (required) {
+                            break;
+                        }
+                    }
+                    free(parent_path);
+                    if (err_info) {
+                        lyd_free_tree(parent_dup);
+                        goto cleanup;
+                    }
+                    if (!required) {
+                        lyd_free_tree(parent_dup);
+                        continue;
+                    }
+                }
+
+                /* provide request XPath for the client, if possible */
+                reqs[req_count].idx1 = b->idx1;
+                reqs[req_count].xpath = b->sub_xpath;
+                reqs[req_count].request_xpath = (b->req_xpath_count == 1) ? b->request_xpaths[0] : NULL;
+                reqs[req_count].parent = parent_dup;
+                reqs[req_count].max_depth = b->max_depth;
+                ++req_count;
+                break;
+            }
+        }
+        if (!req_count) {
+            break;
+        }
+
+        /* get data from all the clients */
+        if ((err_info = sr_shmsub_oper_get_notify(mod, reqs, req_count, orig_name, orig_data, shm_subs, timeout_ms,
+                conn))) {
+            for (i = 0; i < req_count; ++i) {
+                sr_errinfo_merge(&err_info, reqs[i].cb_err_info);
+                reqs[i].cb_err_info = NULL;
+            }
+            goto cleanup;
+        }
+
+        /* merge into one data tree in the subscription order */
+        for (i = 0; i < req_count; ++i) {
+            if (reqs[i].cb_err_info) {
+                /* return callback error if some was generated */
+                sr_errinfo_merge(&err_info, reqs[i].cb_err_info);
+                reqs[i].cb_err_info = NULL;
+                sr_errinfo_new(&err_info, SR_ERR_CALLBACK_FAILED, "User callback failed.");
+                goto cleanup;
+            }
+
+            if (reqs[i].data) {
+                /* add any missing NP containers, redundant to add top-level containers */
+                if ((err_info = sr_lyd_new_implicit_tree(reqs[i].data, LYD_IMPLICIT_NO_DEFAULTS))) {
+                    goto cleanup;
+                }
+
+                if ((err_info = sr_lyd_merge(data, reqs[i].data, 1, LYD_MERGE_DESTRUCT))) {
+                    goto cleanup;
+                }
+                reqs[i].data = NULL;
+            }
+
+            lyd_free_tree((struct lyd_node *)reqs[i].parent);
+            reqs[i].parent = NULL;
+        }
+    } while (1);
+
+cleanup:
+    for (i = 0; i < req_count; ++i) {
+        lyd_free_tree((struct lyd_node *)reqs[i].parent);
+        lyd_free_all(reqs[i].data);
+        sr_errinfo_free(&reqs[i].cb_err_info);
+    }
+    free(reqs);
+
+    sr_oper_get_batch_free(*batch, *batch_count);
+    *batch = NULL;
+    *batch_count = 0;
+    return err_info;
+}
+
+/**
+ * @brief Try to merge operational get cached data of a subscription.
+ *
+ * @param[in] mod Mod info module.
  * @param[in] sub_xpath Subscription XPath.
  * @param[in] conn Connection to use.
  * @param[in,out] data Operational data tree to merge into.
@@ -1061,6 +1641,7 @@ sr_module_oper_data_update_cached(struct sr_mod_info_mod_s *mod, const char *sub
 {
     sr_error_info_t *err_info = NULL;
     struct sr_oper_poll_cache_s *cache = NULL;
+    struct lyd_node *cache_data;
     uint32_t i;
 
     *merged = 0;
@@ -1080,7 +1661,9 @@ sr_module_oper_data_update_cached(struct sr_mod_info_mod_s *mod, const char *sub
         }
     }
     if (!cache) {
-        goto cleanup_cache_unlock;
+        /* CONN OPER CACHE UNLOCK */
+        sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+        goto shm_load;
     }
 
     /* CACHE DATA READ LOCK */
@@ -1089,11 +1672,25 @@ sr_module_oper_data_update_cached(struct sr_mod_info_mod_s *mod, const char *sub
         goto cleanup_cache_unlock;
     }
 
+    if (cache->evicted) {
+        /* CACHE DATA UNLOCK */
+        sr_rwunlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+        /* CONN OPER CACHE UNLOCK */
+        sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+        /* the data were evicted because of the cache memory limit */
+        ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_OPER_CACHE].misses);
+        goto shm_load;
+    }
+
     /* merge cached data */
     if ((err_info = sr_lyd_merge(data, cache->data, 1, 0))) {
         goto cleanup_data_cache_unlock;
     }
     *merged = 1;
+    ATOMIC_STORE_RELAXED(cache->last_use, ATOMIC_INC_RELAXED(conn->cache_tick) + 1);
+    ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_OPER_CACHE].hits);
 
 cleanup_data_cache_unlock:
     /* CACHE DATA UNLOCK */
@@ -1102,8 +1699,62 @@ cleanup_data_cache_unlock:
 cleanup_cache_unlock:
     /* CONN OPER CACHE UNLOCK */
     sr_rwunlock(&conn->oper_cache_lock, SR_CONN_OPER_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+    goto cleanup;
+
+shm_load:
+    /* try the data cached by an oper poll subscription of another connection */
+    if ((err_info = sr_conn_oper_cache_shm_load(conn, mod->ly_mod, sub_xpath, &cache_data, merged))) {
+        goto cleanup;
+    }
+    if (*merged && (err_info = sr_lyd_merge(data, cache_data, 1, LYD_MERGE_DESTRUCT))) {
+        lyd_free_siblings(cache_data);
+        *merged = 0;
+    }
+
+cleanup:
+    return err_info;
+}
+
+/**
+ * @brief Check whether all the data provided by an operational get subscription would be filtered out by NACM.
+ *
+ * @param[in] ly_ctx Context to use.
+ * @param[in] nacm_user NACM user of the request, NULL if NACM is not applied.
+ * @param[in] sub_xpath Subscription XPath.
+ * @param[out] denied Whether all the data are denied.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_oper_get_sub_nacm_denied(const struct ly_ctx *ly_ctx, const char *nacm_user, const char *sub_xpath, int *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    struct ly_set *set = NULL;
+    uint32_t i;
+    int valid;
+
+    *denied = 0;
+
+    if (!nacm_user) {
+        /* NACM not applied */
+        return NULL;
+    }
+
+    if ((err_info = sr_lys_find_xpath(ly_ctx, sub_xpath, 0, &valid, &set)) || !valid || !set->count) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < set->count; ++i) {
+        if ((err_info = sr_nacm_check_schema_read_denied(nacm_user, set->snodes[i], denied))) {
+            goto cleanup;
+        }
+        if (!*denied) {
+            /* some data may be permitted */
+            break;
+        }
+    }
 
 cleanup:
+    ly_set_free(set, NULL);
     return err_info;
 }
 
@@ -1117,22 +1768,26 @@ cleanup:
  * @param[in] conn Connection to use.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
  * @param[in] get_oper_opts Get oper data options.
+ * @param[in] max_depth Maximum depth of the nodes selected by the XPaths of @p mod, 0 if unlimited.
+ * @param[in] nacm_user NACM user of the request, subscriptions providing only denied data are skipped.
  * @param[in,out] data Operational data tree.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, const char *orig_name, const void *orig_data, sr_conn_ctx_t *conn,
-        uint32_t timeout_ms, sr_get_oper_flag_t get_oper_opts, struct lyd_node **data)
+        uint32_t timeout_ms, sr_get_oper_flag_t get_oper_opts, uint32_t max_depth, const char *nacm_user,
+        struct lyd_node **data)
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_oper_get_sub_t *shm_subs;
     sr_mod_oper_get_xpath_sub_t *xpath_subs;
     const char *sub_xpath, **request_xpaths = NULL;
     char *parent_xpath = NULL;
-    uint32_t i, j, req_xpath_count = 0;
-    int required, merged;
+    struct sr_oper_get_batch_s *batch = NULL;
+    uint32_t i, j, req_xpath_count = 0, batch_count = 0;
+    int required, merged, overlap, denied;
     struct ly_set *set = NULL;
-    struct lyd_node *edit = NULL, *oper_data;
+    struct lyd_node *edit = NULL;
 
     if (!(get_oper_opts & SR_OPER_NO_STORED)) {
         /* get stored operational edit */
@@ -1154,6 +1809,13 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, const char *orig_name,
         }
     }
 
+    if (!(get_oper_opts & (SR_OPER_NO_STORED | SR_OPER_NO_STATE))) {
+        /* merge the current values of the operational value slots */
+        if ((err_info = sr_oper_slots_merge(conn, mod->shm_mod, mod->ly_mod, data))) {
+            return err_info;
+        }
+    }
+
     if (get_oper_opts & SR_OPER_NO_SUBS) {
         /* do not get data from subscribers */
         return NULL;
@@ -1205,6 +1867,23 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, const char *orig_name,
             }
         }
 
+        /* no need to call the subscriber if NACM filters out all its data */
+        if ((err_info = sr_oper_get_sub_nacm_denied(conn->ly_ctx, nacm_user, sub_xpath, &denied))) {
+            goto cleanup_opergetsub_ext_unlock;
+        }
+        if (denied) {
+            goto next_iter;
+        }
+
+        /* data overlapping with the data of pending requests must be requested only after those are merged */
+        if ((err_info = sr_oper_get_batch_overlap(batch, batch_count, sub_xpath, &overlap))) {
+            goto cleanup_opergetsub_ext_unlock;
+        }
+        if (overlap && (err_info = sr_oper_get_batch_data(mod, &batch, &batch_count, orig_name, orig_data, shm_subs,
+                timeout_ms, conn, data))) {
+            goto cleanup_opergetsub_ext_unlock;
+        }
+
         /* remove any present data */
         if (!(xpath_subs[0].opts & SR_SUBSCR_OPER_MERGE) && (err_info = sr_lyd_xpath_complement(data, sub_xpath))) {
             goto cleanup_opergetsub_ext_unlock;
@@ -1236,50 +1915,62 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, const char *orig_name,
                 goto cleanup_opergetsub_ext_unlock;
             }
 
-            if (!set->count) {
-                /* data parent does not exist */
-                goto next_iter;
-            }
-
-            /* nested data */
-            for (j = 0; j < set->count; ++j) {
-                /* get oper data from the client */
-                if ((err_info = sr_xpath_oper_data_get(mod, sub_xpath, request_xpaths, req_xpath_count, orig_name,
-                        orig_data, shm_subs, i, set->dnodes[j], timeout_ms, conn, &oper_data))) {
+            if (set->count && batch_count && !sr_oper_get_parent_unique(set)) {
+                /* pending requests may create more parents, wait for them if they can */
+                if ((err_info = sr_oper_get_batch_overlap(batch, batch_count, parent_xpath, &overlap))) {
                     goto cleanup_opergetsub_ext_unlock;
                 }
+                if (overlap) {
+                    if ((err_info = sr_oper_get_batch_data(mod, &batch, &batch_count, orig_name, orig_data, shm_subs,
+                            timeout_ms, conn, data))) {
+                        goto cleanup_opergetsub_ext_unlock;
+                    }
 
-                /* merge into one data tree */
-                if ((err_info = sr_lyd_merge(data, oper_data, 1, LYD_MERGE_DESTRUCT))) {
-                    lyd_free_all(oper_data);
-                    goto cleanup_opergetsub_ext_unlock;
+                    ly_set_free(set, NULL);
+                    if ((err_info = sr_lyd_find_xpath(*data, parent_xpath, &set))) {
+                        goto cleanup_opergetsub_ext_unlock;
+                    }
                 }
             }
 
-next_iter:
-            /* cleanup for next iteration */
-            free(parent_xpath);
-            parent_xpath = NULL;
-            ly_set_free(set, NULL);
-            set = NULL;
-        } else {
-            /* top-level data */
-            if ((err_info = sr_xpath_oper_data_get(mod, sub_xpath, request_xpaths, req_xpath_count, orig_name,
-                    orig_data, shm_subs, i, NULL, timeout_ms, conn, &oper_data))) {
-                goto cleanup_opergetsub_ext_unlock;
-            }
-
-            if ((err_info = sr_lyd_merge(data, oper_data, 1, LYD_MERGE_DESTRUCT))) {
-                lyd_free_all(oper_data);
-                goto cleanup_opergetsub_ext_unlock;
+            if (!set->count) {
+                /* data parent does not exist */
+                goto next_iter;
             }
         }
 
+        /* nested or top-level data, add into the batch */
+        batch = sr_realloc(batch, (batch_count + 1) * sizeof *batch);
+        SR_CHECK_MEM_GOTO(!batch, err_info, cleanup_opergetsub_ext_unlock);
+        batch[batch_count].idx1 = i;
+        batch[batch_count].sub_xpath = sub_xpath;
+        batch[batch_count].request_xpaths = request_xpaths;
+        batch[batch_count].req_xpath_count = req_xpath_count;
+        batch[batch_count].parents = set;
+        batch[batch_count].next = 0;
+        batch[batch_count].max_depth = sr_oper_get_sub_max_depth(request_xpaths, req_xpath_count, sub_xpath, max_depth);
+        ++batch_count;
+        request_xpaths = NULL;
+        req_xpath_count = 0;
+        set = NULL;
+
+next_iter:
+        /* cleanup for next iteration */
+        free(parent_xpath);
+        parent_xpath = NULL;
+        ly_set_free(set, NULL);
+        set = NULL;
         free(request_xpaths);
         request_xpaths = NULL;
         req_xpath_count = 0;
     }
 
+    /* get the data of the remaining subscriptions */
+    if ((err_info = sr_oper_get_batch_data(mod, &batch, &batch_count, orig_name, orig_data, shm_subs, timeout_ms,
+            conn, data))) {
+        goto cleanup_opergetsub_ext_unlock;
+    }
+
 cleanup_opergetsub_ext_unlock:
     /* EXT READ UNLOCK */
     sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
@@ -1288,12 +1979,48 @@ cleanup_opergetsub_unlock:
     /* OPER GET SUB READ UNLOCK */
     sr_rwunlock(&mod->shm_mod->oper_get_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
 
+    sr_oper_get_batch_free(batch, batch_count);
     free(request_xpaths);
     free(parent_xpath);
     ly_set_free(set, NULL);
     return err_info;
 }
 
+/**
+ * @brief Add origin to operational (enabled) data from configuration data tree.
+ *
+ * @param[in] enabled_mod_data Enabled operational data of a module.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_module_oper_data_enabled_origin(struct lyd_node *enabled_mod_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *root, *elem;
+    const char *origin;
+
+    LY_LIST_FOR(enabled_mod_data, root) {
+        /* add origin of all top-level nodes */
+        origin = (root->schema->flags & LYS_CONFIG_W) ? SR_CONFIG_ORIGIN : SR_OPER_ORIGIN;
+        if ((err_info = sr_edit_diff_set_origin(root, origin, 1))) {
+            return err_info;
+        }
+
+        LYD_TREE_DFS_BEGIN(root, elem) {
+            /* add origin of default nodes instead of the default flag */
+            if ((elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) && (elem->flags & LYD_DEFAULT)) {
+                if ((err_info = sr_edit_diff_set_origin(elem, "ietf-origin:default", 1))) {
+                    return err_info;
+                }
+                elem->flags &= ~LYD_DEFAULT;
+            }
+            LYD_TREE_DFS_END(root, elem);
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Get operational (enabled) data from configuration data tree.
  *
@@ -1311,11 +2038,9 @@ sr_module_oper_data_get_enabled(sr_conn_ctx_t *conn, struct lyd_node **data, str
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_change_sub_t *shm_changesubs;
-    struct lyd_node *root, *elem;
     uint32_t i, xp_i;
     int data_ready = 0;
     char **xpaths;
-    const char *origin;
 
     /* start with NP containers, which cannot effectively be disabled */
     *enabled_mod_data = NULL;
@@ -1346,7 +2071,7 @@ sr_module_oper_data_get_enabled(sr_conn_ctx_t *conn, struct lyd_node **data, str
         for (i = 0; i < mod->shm_mod->change_sub[SR_DS_RUNNING].sub_count; ++i) {
             if (!shm_changesubs[i].xpath && !(shm_changesubs[i].opts & SR_SUBSCR_PASSIVE)) {
                 /* the whole module is enabled */
-                if ((err_info = sr_lyd_get_module_data(data, mod->ly_mod, 1, dup, enabled_mod_data))) {
+                if ((err_info = sr_lyd_get_module_data(data, mod->ly_mod, 1, dup, 0, enabled_mod_data))) {
                     goto error_ext_sub_unlock;
                 }
                 data_ready = 1;
@@ -1383,24 +2108,7 @@ sr_module_oper_data_get_enabled(sr_conn_ctx_t *conn, struct lyd_node **data, str
     sr_rwunlock(&mod->shm_mod->change_sub[SR_DS_RUNNING].lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
 
     if (get_oper_opts & SR_OPER_WITH_ORIGIN) {
-        LY_LIST_FOR(*enabled_mod_data, root) {
-            /* add origin of all top-level nodes */
-            origin = (root->schema->flags & LYS_CONFIG_W) ? SR_CONFIG_ORIGIN : SR_OPER_ORIGIN;
-            if ((err_info = sr_edit_diff_set_origin(root, origin, 1))) {
-                return err_info;
-            }
-
-            LYD_TREE_DFS_BEGIN(root, elem) {
-                /* add origin of default nodes instead of the default flag */
-                if ((elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) && (elem->flags & LYD_DEFAULT)) {
-                    if ((err_info = sr_edit_diff_set_origin(elem, "ietf-origin:default", 1))) {
-                        return err_info;
-                    }
-                    elem->flags &= ~LYD_DEFAULT;
-                }
-                LYD_TREE_DFS_END(root, elem);
-            }
-        }
+        return sr_module_oper_data_enabled_origin(*enabled_mod_data);
     }
 
     return NULL;
@@ -1416,6 +2124,77 @@ error_sub_unlock:
     return err_info;
 }
 
+/**
+ * @brief Get enabled operational data of a module from the cached running data. The enabled data are selected
+ * only once for the same cached module data and running change subscriptions and then reused.
+ * Cache READ lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mod Mod info module to process.
+ * @param[in] get_oper_opts Get oper data options.
+ * @param[out] enabled_mod_data Enabled operational data of the module.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_module_oper_data_get_enabled_cached(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod,
+        sr_get_oper_flag_t get_oper_opts, struct lyd_node **enabled_mod_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_run_cache_s *cmod = NULL;
+    uint32_t i, gen;
+
+    *enabled_mod_data = NULL;
+
+    /* find the cache mod */
+    for (i = 0; i < conn->run_cache_mod_count; ++i) {
+        if (mod->ly_mod == conn->run_cache_mods[i].mod) {
+            cmod = &conn->run_cache_mods[i];
+            break;
+        }
+    }
+    if (!cmod) {
+        /* not cached, select the enabled data directly */
+        return sr_module_oper_data_get_enabled(conn, &conn->run_cache_snap->data, mod, get_oper_opts, 1,
+                enabled_mod_data);
+    }
+
+    /* learn the generation before selecting the data so that any concurrent change makes them outdated */
+    gen = ATOMIC_LOAD_RELAXED(mod->shm_mod->change_sub[SR_DS_RUNNING].gen);
+
+    /* RUN CACHE ENABLED LOCK */
+    if ((err_info = sr_mlock(&conn->run_cache_enabled_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    if ((cmod->enabled_id != cmod->id) || (cmod->enabled_gen != gen)) {
+        /* select the enabled data again, without origin that is added to every copy */
+        lyd_free_siblings(cmod->enabled);
+        cmod->enabled = NULL;
+        cmod->enabled_id = UINT32_MAX;
+        if ((err_info = sr_module_oper_data_get_enabled(conn, &conn->run_cache_snap->data, mod, 0, 1,
+                &cmod->enabled))) {
+            goto cleanup_unlock;
+        }
+        cmod->enabled_id = cmod->id;
+        cmod->enabled_gen = gen;
+    }
+
+    /* copy the enabled data */
+    if (cmod->enabled && (err_info = sr_lyd_dup(cmod->enabled, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 1,
+            enabled_mod_data))) {
+        goto cleanup_unlock;
+    }
+
+cleanup_unlock:
+    /* RUN CACHE ENABLED UNLOCK */
+    sr_munlock(&conn->run_cache_enabled_lock);
+
+    if (!err_info && (get_oper_opts & SR_OPER_WITH_ORIGIN)) {
+        err_info = sr_module_oper_data_enabled_origin(*enabled_mod_data);
+    }
+    return err_info;
+}
+
 /**
  * @brief Trim all configuration/state nodes/origin from the data based on options.
  *
@@ -1472,29 +2251,28 @@ sr_oper_data_trim_r(struct lyd_node **data, struct lyd_node *sibling, sr_get_ope
 }
 
 /**
- * @brief Load module data of the ietf-yang-library module. They are actually generated.
+ * @brief Generate module data of the ietf-yang-library module.
  *
- * @param[in] mod_info Mod info to use.
- * @param[in] mod Mod info module to use.
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod ietf-yang-library module.
+ * @param[out] mod_data_p Generated module data.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod)
+sr_modinfo_module_data_yanglib_generate(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
+        struct lyd_node **mod_data_p)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *mod_data;
-    uint32_t content_id, i;
+    struct lyd_node *mod_data = NULL;
+    uint32_t i;
     struct ly_set *set = NULL;
 
-    /* get content-id */
-    content_id = SR_CONN_MAIN_SHM(mod_info->conn)->content_id;
-
     /* get the data from libyang */
-    if ((err_info = sr_ly_ctx_get_yanglib_data(mod_info->conn->ly_ctx, &mod_data, content_id))) {
+    if ((err_info = sr_ly_ctx_get_yanglib_data(conn->ly_ctx, &mod_data, conn->content_id))) {
         goto cleanup;
     }
 
-    if (!strcmp(mod->ly_mod->revision, "2019-01-04")) {
+    if (!strcmp(ly_mod->revision, "2019-01-04")) {
         assert(!strcmp(mod_data->schema->name, "yang-library"));
 
         /* add supported datastores */
@@ -1514,7 +2292,7 @@ sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mo
                 0, NULL, NULL))) {
             goto cleanup;
         }
-    } else if (!strcmp(mod->ly_mod->revision, "2016-06-21")) {
+    } else if (!strcmp(ly_mod->revision, "2016-06-21")) {
         assert(!strcmp(mod_data->schema->name, "modules-state"));
 
         /* all data should already be there */
@@ -1544,16 +2322,59 @@ sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mo
         }
     }
 
-    /* connect to the rest of data */
-    if ((err_info = sr_lyd_merge(&mod_info->data, mod_data, 1, LYD_MERGE_DESTRUCT))) {
-        goto cleanup;
-    }
-
 cleanup:
     ly_set_free(set, NULL);
+    if (err_info) {
+        lyd_free_siblings(mod_data);
+    } else {
+        *mod_data_p = mod_data;
+    }
     return err_info;
 }
 
+/**
+ * @brief Load module data of the ietf-yang-library module. They are generated only once for every context.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module to use.
+ * @param[in,out] data Data tree to merge the module data into.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod,
+        struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = mod_info->conn;
+    struct lyd_node *mod_data = NULL;
+
+    /* YANGLIB CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->yanglib_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* the data depend only on the context, which cannot change while it is locked */
+    if (!conn->yanglib_cache && (err_info = sr_modinfo_module_data_yanglib_generate(conn, mod->ly_mod,
+            &conn->yanglib_cache))) {
+        goto cleanup_unlock;
+    }
+
+    if ((err_info = sr_lyd_dup(conn->yanglib_cache, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, 1, &mod_data))) {
+        goto cleanup_unlock;
+    }
+
+cleanup_unlock:
+    /* YANGLIB CACHE UNLOCK */
+    sr_munlock(&conn->yanglib_cache_lock);
+
+    if (err_info) {
+        return err_info;
+    }
+
+    /* connect to the rest of data */
+    return sr_lyd_merge(data, mod_data, 1, LYD_MERGE_DESTRUCT);
+}
+
 /**
  * @brief Add last datastore modification time nodes to a data tree.
  *
@@ -1619,6 +2440,8 @@ sr_modinfo_module_srmon_locks_ds(sr_rwlock_t *rwlock, uint32_t skip_read_cid, co
     sr_error_info_t *err_info = NULL;
     sr_cid_t cid, skip_read_upgr_cid = 0;
     uint32_t i;
+    uint64_t slot;
+    int has_readers = 0;
 
 #define PATH_LEN 128
     char path[PATH_LEN];
@@ -1635,12 +2458,19 @@ sr_modinfo_module_srmon_locks_ds(sr_rwlock_t *rwlock, uint32_t skip_read_cid, co
         skip_read_upgr_cid = cid;
     }
 
-    for (i = 0; (i < SR_RWLOCK_READ_LIMIT) && rwlock->readers[i]; ++i) {
-        cid = rwlock->readers[i];
-        if ((cid == skip_read_cid) && (rwlock->read_count[i] == 1)) {
+    for (i = 0; i < SR_RWLOCK_READ_LIMIT; ++i) {
+        slot = ATOMIC_LOAD_RELAXED(rwlock->readers[i]);
+        if (!SR_RWLOCK_SLOT_COUNT(slot)) {
+            /* free or only reserved slot */
+            continue;
+        }
+        has_readers = 1;
+
+        cid = SR_RWLOCK_SLOT_CID(slot);
+        if ((cid == skip_read_cid) && (SR_RWLOCK_SLOT_COUNT(slot) == 1)) {
             skip_read_cid = 0;
             continue;
-        } else if ((cid == skip_read_upgr_cid) && (rwlock->read_count[i] == 1)) {
+        } else if ((cid == skip_read_upgr_cid) && (SR_RWLOCK_SLOT_COUNT(slot) == 1)) {
             skip_read_upgr_cid = 0;
             continue;
         }
@@ -1652,7 +2482,7 @@ sr_modinfo_module_srmon_locks_ds(sr_rwlock_t *rwlock, uint32_t skip_read_cid, co
     }
 
     /* if there is a read-lock and the writer is set, it is just an urged write-lock being waited on, ignore it */
-    if (!i && (cid = rwlock->writer)) {
+    if (!has_readers && (cid = rwlock->writer)) {
         snprintf(path, PATH_LEN, path_format, cid, "write");
         if ((err_info = sr_lyd_new_path(ctx_node, NULL, path, NULL, 0, NULL, NULL))) {
             goto cleanup;
@@ -1678,6 +2508,7 @@ sr_modinfo_module_srmon_locks(sr_rwlock_t *rwlock, const char *list_name, struct
     sr_error_info_t *err_info = NULL;
     sr_cid_t cid;
     uint32_t i;
+    uint64_t slot;
 
 #define CID_STR_LEN 64
     char cid_str[CID_STR_LEN];
@@ -1717,12 +2548,18 @@ sr_modinfo_module_srmon_locks(sr_rwlock_t *rwlock, const char *list_name, struct
         }
     }
 
-    for (i = 0; (i < SR_RWLOCK_READ_LIMIT) && rwlock->readers[i]; ++i) {
+    for (i = 0; i < SR_RWLOCK_READ_LIMIT; ++i) {
+        slot = ATOMIC_LOAD_RELAXED(rwlock->readers[i]);
+        if (!SR_RWLOCK_SLOT_COUNT(slot)) {
+            /* free or only reserved slot */
+            continue;
+        }
+
         if ((err_info = sr_lyd_new_list(parent, list_name, NULL, &list))) {
             goto cleanup;
         }
 
-        snprintf(cid_str, CID_STR_LEN, "%" PRIu32, rwlock->readers[i]);
+        snprintf(cid_str, CID_STR_LEN, "%" PRIu32, SR_RWLOCK_SLOT_CID(slot));
         if ((err_info = sr_lyd_new_term(list, NULL, "cid", cid_str))) {
             goto cleanup;
         }
@@ -2015,8 +2852,12 @@ sr_modinfo_module_srmon_module(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, struct ly
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *sr_mod, *sr_ds_lock;
+    const struct lys_module *ly_mod;
     sr_datastore_t ds;
     struct sr_mod_lock_s *shm_lock;
+    struct sr_main_ds_lock_s *main_lock;
+    struct timespec lock_ts;
+    uint32_t lock_sid;
 
 #define BUF_LEN 128
     char buf[BUF_LEN], *str = NULL;
@@ -2025,6 +2866,7 @@ sr_modinfo_module_srmon_module(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, struct ly
     if ((err_info = sr_lyd_new_list(sr_state, "module", conn->mod_shm.addr + shm_mod->name, &sr_mod))) {
         return err_info;
     }
+    ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, conn->mod_shm.addr + shm_mod->name);
 
     /* last-modified */
     for (ds = 0; ds < SR_DS_COUNT; ++ds) {
@@ -2049,25 +2891,45 @@ sr_modinfo_module_srmon_module(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, struct ly
             return err_info;
         }
 
+        /* DS lock of all the modules, if it covers this module */
+        lock_sid = 0;
+        main_lock = &SR_CONN_MAIN_SHM(conn)->ds_lock[ds];
+        if (ATOMIC_LOAD_RELAXED(main_lock->sid) && ly_mod && sr_module_all_ds_lockable(ly_mod)) {
+            /* MAIN DS LOCK */
+            if ((err_info = sr_mlock(&main_lock->lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+                return err_info;
+            }
+            lock_sid = ATOMIC_LOAD_RELAXED(main_lock->sid);
+            lock_ts = main_lock->ts;
+
+            /* MAIN DS UNLOCK */
+            sr_munlock(&main_lock->lock);
+        }
+
         /* DS LOCK */
         if ((err_info = sr_mlock(&shm_lock->ds_lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
             return err_info;
         }
 
         if (shm_lock->ds_lock_sid) {
+            lock_sid = shm_lock->ds_lock_sid;
+            lock_ts = shm_lock->ds_lock_ts;
+        }
+
+        if (lock_sid) {
             /* ds-lock (list instance with datastore) */
             if ((err_info = sr_lyd_new_list(sr_mod, "ds-lock", sr_ds2ident(ds), &sr_ds_lock))) {
                 goto ds_unlock;
             }
 
             /* sid */
-            sprintf(buf, "%" PRIu32, shm_lock->ds_lock_sid);
+            sprintf(buf, "%" PRIu32, lock_sid);
             if ((err_info = sr_lyd_new_term(sr_ds_lock, NULL, "sid", buf))) {
                 goto ds_unlock;
             }
 
             /* timestamp */
-            if (ly_time_ts2str(&shm_lock->ds_lock_ts, &str)) {
+            if (ly_time_ts2str(&lock_ts, &str)) {
                 SR_ERRINFO_MEM(&err_info);
                 goto ds_unlock;
             }
@@ -2209,14 +3071,59 @@ rpc_sub_unlock:
     return err_info;
 }
 
+/**
+ * @brief Append "memory" data nodes of a connection to sysrepo-monitoring data.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in,out] sr_conn Connection list instance node.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_conn_memory(sr_conn_ctx_t *conn, struct lyd_node *sr_conn)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *mem_names[SR_CONN_MEM_COUNT] = {"running-cache", "datastore-cache", "operational-cache",
+        "notification-buffer", "context", "running-cache-compact"};
+    uint64_t mem_usage[SR_CONN_MEM_COUNT], saved;
+    struct lyd_node *sr_mem;
+    char buf[22];
+    uint32_t i;
+
+    if ((err_info = sr_conn_mem_usage(conn, mem_usage))) {
+        return err_info;
+    }
+
+    if ((err_info = sr_lyd_new_inner(sr_conn, NULL, "memory", &sr_mem))) {
+        return err_info;
+    }
+    for (i = 0; i < SR_CONN_MEM_COUNT; ++i) {
+        sprintf(buf, "%" PRIu64, mem_usage[i]);
+        if ((err_info = sr_lyd_new_term(sr_mem, NULL, mem_names[i], buf))) {
+            return err_info;
+        }
+    }
+
+    /* memory saved by the compact data */
+    if ((err_info = sr_conn_run_cache_compact_saved(conn, &saved))) {
+        return err_info;
+    }
+    sprintf(buf, "%" PRIu64, saved);
+    if ((err_info = sr_lyd_new_term(sr_mem, NULL, "running-cache-compact-saved", buf))) {
+        return err_info;
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Append all "connection" data nodes to sysrepo-monitoring data.
  *
+ * @param[in] conn Connection to use.
  * @param[in,out] sr_state Main container node of sysrepo-monitoring.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_srmon_connections(struct lyd_node *sr_state)
+sr_modinfo_module_srmon_connections(sr_conn_ctx_t *conn, struct lyd_node *sr_state)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *sr_conn;
@@ -2242,6 +3149,11 @@ sr_modinfo_module_srmon_connections(struct lyd_node *sr_state)
         if ((err_info = sr_lyd_new_term(sr_conn, NULL, "pid", buf))) {
             goto cleanup;
         }
+
+        /* memory, only the memory of this connection is accessible */
+        if ((cids[i] == conn->cid) && (err_info = sr_modinfo_module_srmon_conn_memory(conn, sr_conn))) {
+            goto cleanup;
+        }
     }
 
 cleanup:
@@ -2250,6 +3162,182 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Append all "lock-stats" data nodes to sysrepo-monitoring data.
+ *
+ * @param[in,out] sr_state Main container node of sysrepo-monitoring.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_lock_stats(struct lyd_node *sr_state)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *hist_names[SR_LOCK_STATS_HIST_COUNT] = {"under-10us", "under-100us", "under-1ms", "under-10ms",
+        "under-100ms", "under-1s", "under-10s", "over-10s"};
+    const sr_lock_stats_shm_t *stats;
+    const sr_lock_stats_site_t *site;
+    struct lyd_node *sr_stats, *sr_hold;
+    char buf[22], name[SR_LOCK_STATS_SITE_LEN];
+    uint32_t i, j;
+
+    if (!(stats = sr_lock_stats_get())) {
+        /* not collected */
+        return NULL;
+    }
+
+    for (i = 0; i < SR_LOCK_STATS_SITE_COUNT; ++i) {
+        site = &stats->sites[i];
+        if (!ATOMIC_LOAD_RELAXED(site->site_hash)) {
+            continue;
+        }
+
+        /* the name may still be being written */
+        strncpy(name, site->site, SR_LOCK_STATS_SITE_LEN - 1);
+        name[SR_LOCK_STATS_SITE_LEN - 1] = '\0';
+        if (!name[0]) {
+            continue;
+        }
+
+        /* site */
+        if ((err_info = sr_lyd_new_list(sr_state, "lock-stats", name, &sr_stats))) {
+            return err_info;
+        }
+
+        /* acquire-count */
+        sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(site->acquire_count));
+        if ((err_info = sr_lyd_new_term(sr_stats, NULL, "acquire-count", buf))) {
+            return err_info;
+        }
+
+        /* wait-time-total */
+        sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(site->wait_total_us));
+        if ((err_info = sr_lyd_new_term(sr_stats, NULL, "wait-time-total", buf))) {
+            return err_info;
+        }
+
+        /* wait-time-max */
+        sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(site->wait_max_us));
+        if ((err_info = sr_lyd_new_term(sr_stats, NULL, "wait-time-max", buf))) {
+            return err_info;
+        }
+
+        /* hold-time */
+        if ((err_info = sr_lyd_new_inner(sr_stats, NULL, "hold-time", &sr_hold))) {
+            return err_info;
+        }
+        for (j = 0; j < SR_LOCK_STATS_HIST_COUNT; ++j) {
+            sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(site->hold_hist[j]));
+            if ((err_info = sr_lyd_new_term(sr_hold, NULL, hist_names[j], buf))) {
+                return err_info;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Append an event latency histogram container to a sysrepo-monitoring "event-stats" list instance.
+ *
+ * @param[in,out] sr_stats Event stats list instance.
+ * @param[in] name Histogram container name.
+ * @param[in] hist Histogram to append.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_event_hist(struct lyd_node *sr_stats, const char *name, const ATOMIC64_T *hist)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *hist_names[SR_EVENT_STATS_HIST_COUNT] = {"under-10us", "under-100us", "under-1ms", "under-10ms",
+        "under-100ms", "under-1s", "under-10s", "over-10s"};
+    struct lyd_node *sr_hist;
+    char buf[22];
+    uint32_t i;
+
+    if ((err_info = sr_lyd_new_inner(sr_stats, NULL, name, &sr_hist))) {
+        return err_info;
+    }
+    for (i = 0; i < SR_EVENT_STATS_HIST_COUNT; ++i) {
+        sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(hist[i]));
+        if ((err_info = sr_lyd_new_term(sr_hist, NULL, hist_names[i], buf))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Append all "event-stats" data nodes to sysrepo-monitoring data.
+ *
+ * @param[in,out] sr_state Main container node of sysrepo-monitoring.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_event_stats(struct lyd_node *sr_state)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *type_names[] = {NULL, "change", "operational-get", "rpc", "notification"};
+    const sr_event_stats_shm_t *stats;
+    const sr_event_stats_sub_t *sub;
+    struct lyd_node *sr_stats;
+    char buf[22], name[SR_EVENT_STATS_NAME_LEN];
+    uint32_t i, sub_id, type;
+
+    if (!(stats = sr_event_stats_get())) {
+        /* not collected */
+        return NULL;
+    }
+
+    for (i = 0; i < SR_EVENT_STATS_SUB_COUNT; ++i) {
+        sub = &stats->subs[i];
+        sub_id = ATOMIC_LOAD_RELAXED(sub->sub_id);
+        type = ATOMIC_LOAD_RELAXED(sub->type);
+        if (!sub_id || !type || (type > SR_EVENT_STATS_NOTIF)) {
+            continue;
+        }
+
+        /* the name may still be being written */
+        strncpy(name, sub->name, SR_EVENT_STATS_NAME_LEN - 1);
+        name[SR_EVENT_STATS_NAME_LEN - 1] = '\0';
+
+        /* sub-id */
+        sprintf(buf, "%" PRIu32, sub_id);
+        if ((err_info = sr_lyd_new_list(sr_state, "event-stats", buf, &sr_stats))) {
+            return err_info;
+        }
+
+        /* type */
+        if ((err_info = sr_lyd_new_term(sr_stats, NULL, "type", type_names[type]))) {
+            return err_info;
+        }
+
+        /* module */
+        if (name[0] && (err_info = sr_lyd_new_term(sr_stats, NULL, "module", name))) {
+            return err_info;
+        }
+
+        /* event-count */
+        sprintf(buf, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(sub->event_count));
+        if ((err_info = sr_lyd_new_term(sr_stats, NULL, "event-count", buf))) {
+            return err_info;
+        }
+
+        /* histograms */
+        if ((err_info = sr_modinfo_module_srmon_event_hist(sr_stats, "wake-latency", sub->wake_hist))) {
+            return err_info;
+        }
+        if ((err_info = sr_modinfo_module_srmon_event_hist(sr_stats, "callback-time", sub->cb_hist))) {
+            return err_info;
+        }
+        if ((err_info = sr_modinfo_module_srmon_event_hist(sr_stats, "reply-latency", sub->reply_hist))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Check whether specific operational data are required for a module.
  *
@@ -2304,10 +3392,12 @@ cleanup:
  *
  * @param[in] mod_info Mod info to use.
  * @param[in] mod Mod info module to use.
+ * @param[in,out] data Data tree to merge the module data into.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_data_load_srmon(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod)
+sr_modinfo_module_data_load_srmon(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod,
+        struct lyd_node **data)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *mod_data;
@@ -2370,12 +3460,28 @@ sr_modinfo_module_data_load_srmon(struct sr_mod_info_s *mod_info, struct sr_mod_
     if ((err_info = sr_modinfo_module_data_oper_required(mod, &req, "/sysrepo-monitoring:sysrepo-state/connection"))) {
         goto cleanup;
     }
-    if (req && (err_info = sr_modinfo_module_srmon_connections(mod_data))) {
+    if (req && (err_info = sr_modinfo_module_srmon_connections(mod_info->conn, mod_data))) {
+        goto cleanup;
+    }
+
+    /* lock stats */
+    if ((err_info = sr_modinfo_module_data_oper_required(mod, &req, "/sysrepo-monitoring:sysrepo-state/lock-stats"))) {
+        goto cleanup;
+    }
+    if (req && (err_info = sr_modinfo_module_srmon_lock_stats(mod_data))) {
+        goto cleanup;
+    }
+
+    /* event stats */
+    if ((err_info = sr_modinfo_module_data_oper_required(mod, &req, "/sysrepo-monitoring:sysrepo-state/event-stats"))) {
+        goto cleanup;
+    }
+    if (req && (err_info = sr_modinfo_module_srmon_event_stats(mod_data))) {
         goto cleanup;
     }
 
     /* connect to the rest of data */
-    if ((err_info = sr_lyd_merge(&mod_info->data, mod_data, 1, LYD_MERGE_DESTRUCT))) {
+    if ((err_info = sr_lyd_merge(data, mod_data, 1, LYD_MERGE_DESTRUCT))) {
         goto cleanup;
     }
     mod_data = NULL;
@@ -2386,31 +3492,65 @@ cleanup:
 }
 
 /**
- * @brief Load module data of a specific module.
+ * @brief Get the maximum depth of the data of a module required to get the selected nodes up to their max depth.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module.
+ * @return Maximum absolute depth of the required data, 0 if unlimited or not known.
+ */
+static uint32_t
+sr_modinfo_module_load_depth(const struct sr_mod_info_s *mod_info, const struct sr_mod_info_mod_s *mod)
+{
+    uint32_t i, depth, max_depth = 0;
+
+    if (!mod_info->max_depth || (mod_info->ds == SR_DS_OPERATIONAL) || !mod->xpath_count ||
+            ((mod->state & MOD_INFO_TYPE_MASK) != MOD_INFO_REQ)) {
+        /* operational data and data of dependencies may be needed whole, push data or subscriptions need parents */
+        return 0;
+    }
+
+    for (i = 0; i < mod->xpath_count; ++i) {
+        if (!(depth = sr_xpath_path_depth(mod->xpaths[i]))) {
+            /* the selected nodes and any nodes needed to select them (predicates) are not known */
+            return 0;
+        }
+
+        depth += mod_info->max_depth - 1;
+        if (depth > max_depth) {
+            max_depth = depth;
+        }
+    }
+
+    return max_depth;
+}
+
+/**
+ * @brief Load module data of a specific module, except for operational data provided by clients.
  *
  * @param[in] mod_info Mod info to use.
  * @param[in] mod Mod info module to process.
- * @param[in] orig_name Event originator name.
- * @param[in] orig_data Event originator data.
- * @param[in] timeout_ms Operational callback timeout in milliseconds.
  * @param[in] get_oper_opts Get oper data options.
  * @param[in] run_cached_data_cur Whether any cached running data in @p conn are usable and current.
+ * @param[in,out] data Data tree to add the module data to.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod, const char *orig_name,
-        const void *orig_data, uint32_t timeout_ms, sr_get_oper_flag_t get_oper_opts, int run_cached_data_cur)
+sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod,
+        sr_get_oper_flag_t get_oper_opts, int run_cached_data_cur, struct lyd_node **data)
 {
     sr_error_info_t *err_info = NULL;
     sr_conn_ctx_t *conn = mod_info->conn;
-    struct lyd_node *mod_data = NULL;
+    struct lyd_node *mod_data = NULL, *node, *next;
     const char **xpaths;
-    uint32_t xpath_count;
+    uint32_t xpath_count, load_depth;
     int modified;
 
     assert(!mod_info->data_cached);
     assert((mod_info->ds != SR_DS_OPERATIONAL) || (mod_info->ds2 != SR_DS_OPERATIONAL));
 
+    /* nodes deeper than required are not needed */
+    load_depth = sr_modinfo_module_load_depth(mod_info, mod);
+
     if (run_cached_data_cur) {
         /* there are cached data */
         switch (mod_info->ds) {
@@ -2430,13 +3570,12 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
             }
         /* fallthrough */
         case SR_DS_RUNNING:
-            /* copy all module data */
-            err_info = sr_lyd_get_module_data(&mod_info->conn->run_cache_data, mod->ly_mod, 0, 1, &mod_data);
+            /* copy all module data, up to the required depth */
+            err_info = sr_lyd_get_module_data(&conn->run_cache_snap->data, mod->ly_mod, 0, 1, load_depth, &mod_data);
             break;
         case SR_DS_OPERATIONAL:
-            /* copy only enabled module data */
-            err_info = sr_module_oper_data_get_enabled(conn, &mod_info->conn->run_cache_data, mod, get_oper_opts,
-                    1, &mod_data);
+            /* copy only enabled module data, selected once for the cached data */
+            err_info = sr_module_oper_data_get_enabled_cached(conn, mod, get_oper_opts, &mod_data);
             break;
         }
         if (err_info) {
@@ -2444,7 +3583,7 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
         }
 
         if (mod_data) {
-            lyd_insert_sibling(mod_info->data, mod_data, &mod_info->data);
+            lyd_insert_sibling(*data, mod_data, data);
         }
     }
     if (!run_cached_data_cur) {
@@ -2461,19 +3600,36 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
         }
 
         /* get current DS data (ds2 is running when getting operational data) */
-        if ((err_info = sr_module_file_data_append(mod->ly_mod, mod->ds_handle, mod_info->ds2, xpaths, xpath_count,
-                &mod_info->data))) {
+        if ((conn->opts & SR_CONN_CACHE_DS) &&
+                ((mod_info->ds2 == SR_DS_STARTUP) || (mod_info->ds2 == SR_DS_FACTORY_DEFAULT))) {
+            /* all the module data are cached */
+            err_info = sr_conn_ds_cache_data_append(conn, mod, mod_info->ds2, data);
+        } else {
+            SR_PROBE(ds__load__start, mod->ly_mod->name, (int)mod_info->ds2, xpath_count);
+            err_info = sr_module_file_data_append(mod->ly_mod, mod->ds_handle, mod_info->ds2, xpaths, xpath_count, data);
+            SR_PROBE(ds__load__done, mod->ly_mod->name, (int)mod_info->ds2, err_info ? 1 : 0);
+        }
+        if (err_info) {
             return err_info;
         }
 
+        if (load_depth) {
+            /* free the nodes deeper than required right away */
+            LY_LIST_FOR_SAFE(*data, next, node) {
+                if (lysc_owner_module(node->schema) == mod->ly_mod) {
+                    sr_lyd_trim_depth(node, load_depth);
+                }
+            }
+        }
+
         if (mod_info->ds == SR_DS_OPERATIONAL) {
             /* keep only enabled module data */
-            if ((err_info = sr_module_oper_data_get_enabled(conn, &mod_info->data, mod, get_oper_opts, 0, &mod_data))) {
+            if ((err_info = sr_module_oper_data_get_enabled(conn, data, mod, get_oper_opts, 0, &mod_data))) {
                 return err_info;
             }
-            lyd_free_siblings(sr_module_data_unlink(&mod_info->data, mod->ly_mod));
+            lyd_free_siblings(sr_module_data_unlink(data, mod->ly_mod));
             if (mod_data) {
-                lyd_insert_sibling(mod_info->data, mod_data, &mod_info->data);
+                lyd_insert_sibling(*data, mod_data, data);
             }
         }
     }
@@ -2481,24 +3637,176 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
     if (mod_info->ds == SR_DS_OPERATIONAL) {
         if (!strcmp(mod->ly_mod->name, "ietf-yang-library")) {
             /* append ietf-yang-library state data - internal */
-            if ((err_info = sr_modinfo_module_data_load_yanglib(mod_info, mod))) {
+            if ((err_info = sr_modinfo_module_data_load_yanglib(mod_info, mod, data))) {
                 return err_info;
             }
         } else if (!strcmp(mod->ly_mod->name, "sysrepo-monitoring")) {
             /* append sysrepo-monitoring state data - internal */
-            if ((err_info = sr_modinfo_module_data_load_srmon(mod_info, mod))) {
+            if ((err_info = sr_modinfo_module_data_load_srmon(mod_info, mod, data))) {
                 return err_info;
             }
         }
+    }
 
-        /* append any operational data provided by clients */
-        if ((err_info = sr_module_oper_data_update(mod, orig_name, orig_data, conn, timeout_ms, get_oper_opts,
-                &mod_info->data))) {
+    return NULL;
+}
+
+/**
+ * @brief Load operational data of a specific module provided by clients.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module to process.
+ * @param[in] orig_name Event originator name.
+ * @param[in] orig_data Event originator data.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] get_oper_opts Get oper data options.
+ * @param[in,out] data Data tree with the module data to update.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_data_load_oper(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod, const char *orig_name,
+        const void *orig_data, uint32_t timeout_ms, sr_get_oper_flag_t get_oper_opts, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* append any operational data provided by clients */
+    if ((err_info = sr_module_oper_data_update(mod, orig_name, orig_data, mod_info->conn, timeout_ms, get_oper_opts,
+            mod_info->max_depth, mod_info->nacm_user, data))) {
+        return err_info;
+    }
+
+    /* trim any data according to options (they could not be trimmed before oper subscriptions) */
+    sr_oper_data_trim_r(data, *data, get_oper_opts);
+
+    return NULL;
+}
+
+/**
+ * @brief Check whether the operational get subscriptions of a module may use only the data of the module so that
+ * they can be loaded independently of the data of other modules.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module to check.
+ * @param[in] get_oper_opts Get oper data options.
+ * @param[out] own Whether only the module data are used.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_data_oper_own(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod,
+        sr_get_oper_flag_t get_oper_opts, int *own)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = mod_info->conn;
+    sr_mod_oper_get_sub_t *shm_subs;
+    const char *xpath, *ptr, *start;
+    size_t len = strlen(mod->ly_mod->name);
+    uint32_t i;
+
+    *own = 1;
+
+    if (get_oper_opts & SR_OPER_NO_SUBS) {
+        /* no subscriptions used */
+        return NULL;
+    }
+
+    /* OPER GET SUB READ LOCK */
+    if ((err_info = sr_rwlock(&mod->shm_mod->oper_get_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid,
+            __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* EXT READ LOCK */
+    if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_READ, 0, __func__))) {
+        goto cleanup_opergetsub_unlock;
+    }
+
+    /* every prefix in the subscription XPaths (also in predicates) must be of the module itself */
+    shm_subs = (sr_mod_oper_get_sub_t *)(conn->ext_shm.addr + mod->shm_mod->oper_get_subs);
+    for (i = 0; *own && (i < mod->shm_mod->oper_get_sub_count); ++i) {
+        xpath = conn->ext_shm.addr + shm_subs[i].xpath;
+        for (ptr = strchr(xpath, ':'); ptr; ptr = strchr(ptr + 1, ':')) {
+            for (start = ptr; (start > xpath) && (isalnum(start[-1]) || strchr("_.-", start[-1])); --start) {}
+            if (((size_t)(ptr - start) != len) || strncmp(start, mod->ly_mod->name, len)) {
+                *own = 0;
+                break;
+            }
+        }
+    }
+
+    /* EXT READ UNLOCK */
+    sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+cleanup_opergetsub_unlock:
+    /* OPER GET SUB READ UNLOCK */
+    sr_rwunlock(&mod->shm_mod->oper_get_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+    return err_info;
+}
+
+/**
+ * @brief Module data load job.
+ */
+struct sr_modinfo_load_job_s {
+    struct sr_mod_info_mod_s *mod;      /**< Mod info module to load. */
+    struct lyd_node *data;          /**< Loaded module data. */
+    int oper_later;                 /**< Whether the operational data provided by clients are to be loaded only once
+                                         the data of all the modules are loaded. */
+};
+
+/**
+ * @brief Module data load jobs.
+ */
+struct sr_modinfo_load_s {
+    struct sr_mod_info_s *mod_info; /**< Mod info to use. */
+    const char *orig_name;          /**< Event originator name. */
+    const void *orig_data;          /**< Event originator data. */
+    uint32_t timeout_ms;            /**< Operational callback timeout in milliseconds. */
+    sr_get_oper_flag_t get_oper_opts;   /**< Get oper data options. */
+    int run_cached_data_cur;        /**< Whether any cached running data are usable and current. */
+    struct sr_modinfo_load_job_s *jobs; /**< Jobs of all the modules. */
+};
+
+/**
+ * @brief Execute a module data load job, callback of ::sr_conn_load_run().
+ *
+ * @param[in] idx Job index.
+ * @param[in] cb_data Module data load jobs.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_load_job(uint32_t idx, void *cb_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_modinfo_load_s *load = cb_data;
+    struct sr_modinfo_load_job_s *job = &load->jobs[idx];
+    int denied;
+
+    if ((job->mod->state & MOD_INFO_TYPE_MASK) == MOD_INFO_REQ) {
+        /* data of a required module that NACM would filter out completely are not needed at all */
+        if ((err_info = sr_nacm_check_module_read_denied(load->mod_info->nacm_user, job->mod->ly_mod, &denied))) {
             return err_info;
         }
+        if (denied) {
+            return NULL;
+        }
+    }
 
-        /* trim any data according to options (they could not be trimmed before oper subscriptions) */
-        sr_oper_data_trim_r(&mod_info->data, mod_info->data, get_oper_opts);
+    /* load the module data into a separate tree */
+    if ((err_info = sr_modinfo_module_data_load(load->mod_info, job->mod, load->get_oper_opts,
+            load->run_cached_data_cur, &job->data))) {
+        return err_info;
+    }
+
+    if (load->mod_info->ds == SR_DS_OPERATIONAL) {
+        if ((err_info = sr_modinfo_module_data_oper_own(load->mod_info, job->mod, load->get_oper_opts,
+                &job->oper_later))) {
+            return err_info;
+        }
+        job->oper_later = !job->oper_later;
+
+        if (!job->oper_later && (err_info = sr_modinfo_module_data_load_oper(load->mod_info, job->mod,
+                load->orig_name, load->orig_data, load->timeout_ms, load->get_oper_opts, &job->data))) {
+            return err_info;
+        }
     }
 
     return NULL;
@@ -2675,7 +3983,8 @@ sr_modinfo_data_load(struct sr_mod_info_s *mod_info, int read_only, const char *
     sr_error_info_t *err_info = NULL;
     sr_conn_ctx_t *conn;
     struct sr_mod_info_mod_s *mod;
-    uint32_t i;
+    struct sr_modinfo_load_s load = {0};
+    uint32_t i, job_count = 0;
     int run_data_cache_cur = 0;
 
     conn = mod_info->conn;
@@ -2695,14 +4004,15 @@ sr_modinfo_data_load(struct sr_mod_info_s *mod_info, int read_only, const char *
         if ((err_info = sr_conn_run_cache_update(conn, mod_info, SR_LOCK_READ))) {
             goto cleanup;
         }
+        assert(conn->run_cache_snap);
         run_data_cache_cur = 1;
 
         if (mod_info->ds == SR_DS_RUNNING) {
             if (read_only) {
                 /* we can use the cache directly only if we are working with the running datastore (as the main datastore)
-                 * and not modifying the data */
-                mod_info->data_cached = 1;
-                mod_info->data = conn->run_cache_data;
+                 * and not modifying the data, reference the current snapshot so that it is not changed meanwhile */
+                mod_info->data_cached = sr_conn_run_cache_snap_ref(conn);
+                mod_info->data = mod_info->data_cached->data;
 
                 for (i = 0; i < mod_info->mod_count; ++i) {
                     mod = &mod_info->mods[i];
@@ -2717,139 +4027,534 @@ sr_modinfo_data_load(struct sr_mod_info_s *mod_info, int read_only, const char *
                         continue;
                     }
 
-                    if ((err_info = sr_lyd_get_module_data(&conn->run_cache_data, mod->ly_mod, 0, 1, &mod_info->data))) {
+                    if ((err_info = sr_lyd_get_module_data(&conn->run_cache_snap->data, mod->ly_mod, 0, 1, 0,
+                            &mod_info->data))) {
                         goto cleanup;
                     }
 
-                    mod->state |= MOD_INFO_DATA;
-                }
-            }
-            goto cleanup;
+                    mod->state |= MOD_INFO_DATA;
+                }
+            }
+            goto cleanup;
+        }
+    }
+
+    if ((mod_info->ds == SR_DS_OPERATIONAL) && (mod_info->ds2 == SR_DS_OPERATIONAL)) {
+        /* special case when we are not working with data but with edit */
+        for (i = 0; i < mod_info->mod_count; ++i) {
+            mod = &mod_info->mods[i];
+            if (mod->state & MOD_INFO_DATA) {
+                /* module data were already loaded */
+                continue;
+            }
+
+            assert(!mod->xpath_count);
+            SR_PROBE(ds__load__start, mod->ly_mod->name, (int)SR_DS_OPERATIONAL, 0);
+            err_info = sr_module_file_data_append(mod->ly_mod, mod->ds_handle, SR_DS_OPERATIONAL, NULL, 0,
+                    &mod_info->data);
+            SR_PROBE(ds__load__done, mod->ly_mod->name, (int)SR_DS_OPERATIONAL, err_info ? 1 : 0);
+            if (err_info) {
+                goto cleanup;
+            }
+            mod->state |= MOD_INFO_DATA;
+        }
+
+        /* remove the edit of dead connections, stored back with any changes of these modules */
+        err_info = sr_oper_edit_del_dead(&mod_info->data);
+        goto cleanup;
+    }
+
+    /* collect the modules whose data are to be loaded */
+    load.jobs = calloc(mod_info->mod_count, sizeof *load.jobs);
+    if (!load.jobs) {
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if (!(mod_info->mods[i].state & MOD_INFO_DATA)) {
+            load.jobs[job_count++].mod = &mod_info->mods[i];
+        }
+    }
+
+    /* load data of each module into a separate tree, possibly in parallel */
+    load.mod_info = mod_info;
+    load.orig_name = orig_name;
+    load.orig_data = orig_data;
+    load.timeout_ms = timeout_ms;
+    load.get_oper_opts = get_oper_opts;
+    load.run_cached_data_cur = run_data_cache_cur;
+    if ((err_info = sr_conn_load_run(conn, job_count, sr_modinfo_load_job, &load))) {
+        goto cleanup;
+    }
+
+    /* merge the data in the module order */
+    for (i = 0; i < job_count; ++i) {
+        if (load.jobs[i].data) {
+            lyd_insert_sibling(mod_info->data, load.jobs[i].data, &mod_info->data);
+            load.jobs[i].data = NULL;
+        }
+    }
+
+    /* load the operational data of modules whose subscriptions may require data of other modules */
+    for (i = 0; i < job_count; ++i) {
+        if (load.jobs[i].oper_later && (err_info = sr_modinfo_module_data_load_oper(mod_info, load.jobs[i].mod,
+                orig_name, orig_data, timeout_ms, get_oper_opts, &mod_info->data))) {
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < job_count; ++i) {
+        if (!load.jobs[i].mod->xpath_count) {
+            /* remember only if we request all the data */
+            load.jobs[i].mod->state |= MOD_INFO_DATA;
+        }
+    }
+
+cleanup:
+    /* CACHE READ UNLOCK */
+    sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+    if (load.jobs) {
+        for (i = 0; i < job_count; ++i) {
+            lyd_free_siblings(load.jobs[i].data);
+        }
+        free(load.jobs);
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+sr_modinfo_consolidate(struct sr_mod_info_s *mod_info, sr_lock_mode_t mod_lock, int mi_opts, uint32_t sid,
+        const char *orig_name, const void *orig_data, uint32_t timeout_ms, uint32_t ds_lock_timeout_ms,
+        sr_get_oper_flag_t get_oper_opts)
+{
+    sr_error_info_t *err_info = NULL;
+    int mod_type, new = 0;
+    uint32_t i;
+    struct timespec ts;
+
+    assert(mi_opts & (SR_MI_PERM_NO | SR_MI_PERM_READ | SR_MI_PERM_WRITE));
+
+    if (!mod_info->mod_count) {
+        goto cleanup;
+    }
+
+    if (mi_opts & SR_MI_NEW_DEPS) {
+        mod_type = MOD_INFO_DEP;
+    } else {
+        mod_type = MOD_INFO_REQ;
+    }
+
+    /* check for new modules in mod_info */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if (mod_info->mods[i].state & MOD_INFO_NEW) {
+            /* new module */
+            new = 1;
+
+            /* consolidate without inverse dependencies to not lose track of new modules */
+            if ((err_info = sr_modinfo_mod_new(mod_info->mods[i].ly_mod, mod_type, mod_info))) {
+                goto cleanup;
+            }
+        }
+    }
+    if (!new) {
+        /* no module changes, we are done */
+        return NULL;
+    }
+
+    if (mi_opts & SR_MI_INV_DEPS) {
+        /* add inverse dependencies for added modules */
+        for (i = 0; i < mod_info->mod_count; ++i) {
+            if (mod_info->mods[i].state & mod_type) {
+                if ((err_info = sr_modinfo_mod_inv_deps(mod_info->mods[i].shm_mod, mod_info))) {
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    if (!(mi_opts & SR_MI_PERM_NO)) {
+        /* check permissions */
+        if ((err_info = sr_modinfo_perm_check(mod_info, mi_opts & SR_MI_PERM_WRITE ? 1 : 0, mi_opts & SR_MI_PERM_STRICT))) {
+            goto cleanup;
+        }
+    }
+
+    /* all modules could have been removed by the permission check */
+    if (mod_info->mod_count) {
+        /* sort the modules based on their offsets in the SHM so that we have a uniform order for locking */
+        qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
+    }
+
+    if (mod_lock) {
+        sr_timing_phase_start(mod_info->phase_us, &ts);
+        if (mod_lock == SR_LOCK_READ) {
+            /* MODULES READ LOCK */
+            err_info = sr_shmmod_modinfo_rdlock(mod_info, mi_opts & SR_MI_LOCK_UPGRADEABLE, mi_opts & SR_MI_LOCK_NOFAIR,
+                    sid, timeout_ms, ds_lock_timeout_ms);
+        } else {
+            /* MODULES WRITE LOCK */
+            err_info = sr_shmmod_modinfo_wrlock(mod_info, sid, timeout_ms, ds_lock_timeout_ms);
+        }
+        sr_timing_phase_end(mod_info->phase_us, SR_PHASE_LOCK, &ts);
+        if (err_info) {
+            goto cleanup;
+        }
+    }
+
+    if (!(mi_opts & SR_MI_DATA_NO)) {
+        /* load all modules data */
+        sr_timing_phase_start(mod_info->phase_us, &ts);
+        err_info = sr_modinfo_data_load(mod_info, mi_opts & SR_MI_DATA_RO, orig_name, orig_data, timeout_ms,
+                get_oper_opts);
+        sr_timing_phase_end(mod_info->phase_us, SR_PHASE_LOAD, &ts);
+        if (err_info) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    return err_info;
+}
+
+/**
+ * @brief Check whether there are any deleted or replaced nodes in a diff.
+ *
+ * @param[in] diff Diff to examine.
+ * @param[in] ly_mod Optional module of the diff nodes to examine, all the nodes are examined if not set.
+ * @return Whether some nodes were deleted or replaced.
+ */
+static int
+sr_modinfo_diff_has_removal(const struct lyd_node *diff, const struct lys_module *ly_mod)
+{
+    const struct lyd_node *root, *elem;
+    enum edit_op op;
+
+    LY_LIST_FOR(diff, root) {
+        if (ly_mod && (lyd_owner_module(root) != ly_mod)) {
+            continue;
+        }
+
+        LYD_TREE_DFS_BEGIN(root, elem) {
+            op = sr_edit_diff_find_oper(elem, 1, NULL);
+            if ((op == EDIT_DELETE) || (op == EDIT_REPLACE)) {
+                return 1;
+            }
+
+            LYD_TREE_DFS_END(root, elem);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Find a changed module in mod info.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_name Module name.
+ * @return Changed module, NULL if not found or not changed.
+ */
+static const struct lys_module *
+sr_modinfo_find_changed_mod(const struct sr_mod_info_s *mod_info, const char *mod_name)
+{
+    uint32_t i;
+
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if ((mod_info->mods[i].state & MOD_INFO_CHANGED) && !strcmp(mod_info->mods[i].ly_mod->name, mod_name)) {
+            return mod_info->mods[i].ly_mod;
         }
     }
 
-    /* load data for each module */
-    for (i = 0; i < mod_info->mod_count; ++i) {
-        mod = &mod_info->mods[i];
-        if (mod->state & MOD_INFO_DATA) {
-            /* module data were already loaded */
-            continue;
-        }
+    return NULL;
+}
 
-        if ((mod_info->ds == SR_DS_OPERATIONAL) && (mod_info->ds2 == SR_DS_OPERATIONAL)) {
-            /* special case when we are not working with data but with edit */
-            assert(!mod->xpath_count);
-            if ((err_info = sr_module_file_data_append(mod->ly_mod, mod->ds_handle, SR_DS_OPERATIONAL, NULL, 0,
-                    &mod_info->data))) {
-                goto cleanup;
+/**
+ * @brief Check whether the data dependencies of an inverse dependency module can be affected by the diff.
+ *
+ * @param[in] mod_info Mod info with the diff.
+ * @param[in] mod Inverse dependency module.
+ * @param[out] affected Whether the module references may be affected.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_inv_dep_is_affected(const struct sr_mod_info_s *mod_info, const struct sr_mod_info_mod_s *mod, int *affected)
+{
+    sr_error_info_t *err_info = NULL;
+    char *mod_shm_addr = mod_info->conn->mod_shm.addr;
+    sr_dep_t *shm_deps;
+    const struct lys_module *ly_mod;
+    const char *target_path;
+    struct ly_set *set = NULL;
+    off_t *mod_names;
+    enum edit_op op;
+    uint32_t i, j;
+
+    *affected = 0;
+
+    shm_deps = (sr_dep_t *)(mod_shm_addr + mod->shm_mod->deps);
+    for (i = 0; (i < mod->shm_mod->dep_count) && !*affected; ++i) {
+        switch (shm_deps[i].type) {
+        case SR_DEP_LREF:
+            ly_mod = sr_modinfo_find_changed_mod(mod_info, mod_shm_addr + shm_deps[i].lref.target_module);
+            if (!ly_mod) {
+                /* target module not changed */
+                break;
             }
-        } else {
-            if ((err_info = sr_modinfo_module_data_load(mod_info, mod, orig_name, orig_data, timeout_ms, get_oper_opts,
-                    run_data_cache_cur))) {
+
+            target_path = mod_shm_addr + shm_deps[i].lref.target_path;
+            if ((target_path[0] != '/') || strchr(target_path, '[')) {
+                /* cannot be evaluated on the diff, any removed target module node may be referenced */
+                *affected = sr_modinfo_diff_has_removal(mod_info->diff, ly_mod);
+                break;
+            }
+
+            /* only removing or changing a target can break the leafref */
+            if ((err_info = sr_lyd_find_xpath(mod_info->diff, target_path, &set))) {
                 goto cleanup;
             }
-        }
-        if (!mod->xpath_count) {
-            /* remember only if we request all the data */
-            mod->state |= MOD_INFO_DATA;
+            for (j = 0; j < set->count; ++j) {
+                op = sr_edit_diff_find_oper(set->dnodes[j], 1, NULL);
+                if ((op == EDIT_DELETE) || (op == EDIT_REPLACE)) {
+                    *affected = 1;
+                    break;
+                }
+            }
+            ly_set_free(set, NULL);
+            set = NULL;
+            break;
+        case SR_DEP_INSTID:
+            /* target module is known only from the data, any removed node may be referenced */
+            *affected = sr_modinfo_diff_has_removal(mod_info->diff, NULL);
+            break;
+        case SR_DEP_XPATH:
+            /* any change in a target module may change the result */
+            mod_names = (off_t *)(mod_shm_addr + shm_deps[i].xpath.target_modules);
+            for (j = 0; j < shm_deps[i].xpath.target_mod_count; ++j) {
+                if (sr_modinfo_find_changed_mod(mod_info, mod_shm_addr + mod_names[j])) {
+                    *affected = 1;
+                    break;
+                }
+            }
+            break;
+        default:
+            SR_ERRINFO_INT(&err_info);
+            goto cleanup;
         }
     }
 
 cleanup:
-    if (!mod_info->data_cached) {
-        /* CACHE READ UNLOCK */
-        sr_rwunlock(&conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
-    } /* else the flag marks held READ lock */
+    ly_set_free(set, NULL);
     return err_info;
 }
 
 sr_error_info_t *
-sr_modinfo_consolidate(struct sr_mod_info_s *mod_info, sr_lock_mode_t mod_lock, int mi_opts, uint32_t sid,
-        const char *orig_name, const void *orig_data, uint32_t timeout_ms, uint32_t ds_lock_timeout_ms,
-        sr_get_oper_flag_t get_oper_opts)
+sr_modinfo_inv_deps_skip(struct sr_mod_info_s *mod_info)
 {
     sr_error_info_t *err_info = NULL;
-    int mod_type, new = 0;
-    uint32_t i;
+    struct sr_mod_info_mod_s *mod;
+    uint32_t i, skipped = 0;
+    int affected;
 
-    assert(mi_opts & (SR_MI_PERM_NO | SR_MI_PERM_READ | SR_MI_PERM_WRITE));
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+        mod->state &= ~MOD_INFO_INV_DEP_SKIP;
+        if (!(mod->state & MOD_INFO_INV_DEP) || (mod->state & (MOD_INFO_REQ | MOD_INFO_CHANGED))) {
+            /* not only an inverse dependency */
+            continue;
+        }
 
-    if (!mod_info->mod_count) {
-        goto cleanup;
+        if ((err_info = sr_modinfo_inv_dep_is_affected(mod_info, mod, &affected))) {
+            return err_info;
+        }
+        if (!affected) {
+            mod->state |= MOD_INFO_INV_DEP_SKIP;
+            ++skipped;
+        }
     }
 
-    if (mi_opts & SR_MI_NEW_DEPS) {
-        mod_type = MOD_INFO_DEP;
-    } else {
-        mod_type = MOD_INFO_REQ;
+    if (skipped) {
+        SR_LOG_DBG("Skipping validation of %" PRIu32 " inverse dependency module(s) not affected by the changes.",
+                skipped);
     }
 
-    /* check for new modules in mod_info */
-    for (i = 0; i < mod_info->mod_count; ++i) {
-        if (mod_info->mods[i].state & MOD_INFO_NEW) {
-            /* new module */
-            new = 1;
+    return NULL;
+}
 
-            /* consolidate without inverse dependencies to not lose track of new modules */
-            if ((err_info = sr_modinfo_mod_new(mod_info->mods[i].ly_mod, mod_type, mod_info))) {
-                goto cleanup;
+/**
+ * @brief Check whether a type can reference other data.
+ *
+ * @param[in] type Type to check.
+ * @return Whether the type is a leafref or an instance-identifier requiring an instance.
+ */
+static int
+sr_modinfo_type_is_ref(const struct lysc_type *type)
+{
+    const struct lysc_type_union *uni;
+    LY_ARRAY_COUNT_TYPE u;
+
+    switch (type->basetype) {
+    case LY_TYPE_LEAFREF:
+        return ((struct lysc_type_leafref *)type)->require_instance;
+    case LY_TYPE_INST:
+        return ((struct lysc_type_instanceid *)type)->require_instance;
+    case LY_TYPE_UNION:
+        uni = (struct lysc_type_union *)type;
+        LY_ARRAY_FOR(uni->types, u) {
+            if (sr_modinfo_type_is_ref(uni->types[u])) {
+                return 1;
             }
         }
+        return 0;
+    default:
+        return 0;
     }
-    if (!new) {
-        /* no module changes, we are done */
-        return NULL;
-    }
+}
 
-    if (mi_opts & SR_MI_INV_DEPS) {
-        /* add inverse dependencies for added modules */
-        for (i = 0; i < mod_info->mod_count; ++i) {
-            if (mod_info->mods[i].state & mod_type) {
-                if ((err_info = sr_modinfo_mod_inv_deps(mod_info->mods[i].shm_mod, mod_info))) {
-                    goto cleanup;
-                }
+/**
+ * @brief libyang callback for full module traversal when searching for any constraints referencing other data.
+ */
+static LY_ERR
+sr_modinfo_value_constraint_lysc_dfs_cb(struct lysc_node *node, void *data, ly_bool *dfs_continue)
+{
+    int *found = (int *)data;
+    LY_ARRAY_COUNT_TYPE u;
+    const struct lysc_ext *ext;
+
+    if (node->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+        /* not part of the data */
+        *dfs_continue = 1;
+        return LY_SUCCESS;
+    }
+
+    if (lysc_node_when(node) || lysc_node_musts(node)) {
+        /* XPath expression */
+        *found = 1;
+    } else if ((node->nodetype & (LYS_LEAF | LYS_LEAFLIST)) &&
+            sr_modinfo_type_is_ref(((struct lysc_node_leaf *)node)->type)) {
+        /* leafref or instance-identifier */
+        *found = 1;
+    } else if ((node->nodetype == LYS_LIST) && ((struct lysc_node_list *)node)->uniques) {
+        /* unique */
+        *found = 1;
+    } else {
+        LY_ARRAY_FOR(node->exts, u) {
+            ext = node->exts[u].def;
+            if (!strcmp(ext->name, "mount-point") && !strcmp(ext->module->name, "ietf-yang-schema-mount")) {
+                /* mounted data are validated separately */
+                *found = 1;
+                break;
             }
         }
     }
 
-    if (!(mi_opts & SR_MI_PERM_NO)) {
-        /* check permissions */
-        if ((err_info = sr_modinfo_perm_check(mod_info, mi_opts & SR_MI_PERM_WRITE ? 1 : 0, mi_opts & SR_MI_PERM_STRICT))) {
+    if (*found) {
+        /* just stop the traversal */
+        return LY_EEXIST;
+    }
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Learn whether a module has any constraints that could be affected by a changed value.
+ *
+ * The result is cached in the connection until its context is switched.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Module to check.
+ * @return Whether there are any such constraints, also if it could not be learned.
+ */
+static int
+sr_modinfo_value_constraint_found(sr_conn_ctx_t *conn, const struct lys_module *ly_mod)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_value_constr_cache_s *cache;
+    uint32_t i;
+    int found = 0;
+    void *mem;
+
+    /* VALUE CONSTR CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->value_constr_cache_lock, -1, __func__, NULL, NULL))) {
+        sr_errinfo_free(&err_info);
+        return 1;
+    }
+
+    for (i = 0; i < conn->value_constr_cache_count; ++i) {
+        if (conn->value_constr_cache[i].ly_mod == ly_mod) {
+            found = conn->value_constr_cache[i].found;
             goto cleanup;
         }
     }
 
-    /* all modules could have been removed by the permission check */
-    if (mod_info->mod_count) {
-        /* sort the modules based on their offsets in the SHM so that we have a uniform order for locking */
-        qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
+    /* traverse the module, the result is not cached if there is no memory */
+    lysc_module_dfs_full(ly_mod, sr_modinfo_value_constraint_lysc_dfs_cb, &found);
+
+    mem = realloc(conn->value_constr_cache, (conn->value_constr_cache_count + 1) * sizeof *conn->value_constr_cache);
+    if (!mem) {
+        goto cleanup;
     }
+    conn->value_constr_cache = mem;
+    cache = &conn->value_constr_cache[conn->value_constr_cache_count++];
+    cache->ly_mod = ly_mod;
+    cache->found = found;
 
-    if (mod_lock) {
-        if (mod_lock == SR_LOCK_READ) {
-            /* MODULES READ LOCK */
-            if ((err_info = sr_shmmod_modinfo_rdlock(mod_info, mi_opts & SR_MI_LOCK_UPGRADEABLE, sid, timeout_ms,
-                    ds_lock_timeout_ms))) {
-                goto cleanup;
+cleanup:
+    /* VALUE CONSTR CACHE UNLOCK */
+    sr_munlock(&conn->value_constr_cache_lock);
+    return found;
+}
+
+int
+sr_modinfo_diff_is_value_only(const struct sr_mod_info_s *mod_info)
+{
+    const struct sr_mod_info_mod_s *mod;
+    const struct lyd_node *root, *elem;
+    uint32_t i;
+
+    /* only leaf values can be changed, existing nodes and their parents in the diff must be kept */
+    LY_LIST_FOR(mod_info->diff, root) {
+        LYD_TREE_DFS_BEGIN(root, elem) {
+            if (!elem->schema || (elem->flags & LYD_EXT)) {
+                /* opaque or extension data */
+                return 0;
             }
-        } else {
-            /* MODULES WRITE LOCK */
-            if ((err_info = sr_shmmod_modinfo_wrlock(mod_info, sid, timeout_ms, ds_lock_timeout_ms))) {
-                goto cleanup;
+
+            switch (sr_edit_diff_find_oper(elem, 1, NULL)) {
+            case EDIT_NONE:
+                break;
+            case EDIT_REPLACE:
+                if (elem->schema->nodetype != LYS_LEAF) {
+                    /* user-ordered move */
+                    return 0;
+                }
+                break;
+            default:
+                /* created or deleted node */
+                return 0;
             }
+
+            LYD_TREE_DFS_END(root, elem);
         }
     }
 
-    if (!(mi_opts & SR_MI_DATA_NO)) {
-        /* load all modules data */
-        if ((err_info = sr_modinfo_data_load(mod_info, mi_opts & SR_MI_DATA_RO, orig_name, orig_data, timeout_ms,
-                get_oper_opts))) {
-            goto cleanup;
+    /* the changed modules must not have any constraints that could be affected by a changed value */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+        if (!(mod->state & MOD_INFO_CHANGED)) {
+            continue;
+        }
+
+        if (mod->shm_mod->inv_dep_count) {
+            /* other modules may reference the data */
+            return 0;
+        }
+
+        if (sr_modinfo_value_constraint_found(mod_info->conn, mod->ly_mod)) {
+            return 0;
         }
     }
 
-cleanup:
-    return err_info;
+    return 1;
 }
 
 sr_error_info_t *
@@ -2872,7 +4577,7 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, uint32_t mod_state, int fini
     }
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
-        if (mod->state & mod_state) {
+        if ((mod->state & mod_state) && !(mod->state & MOD_INFO_INV_DEP_SKIP)) {
             /* validate this module */
             if ((err_info = sr_lyd_validate_module(&mod_info->data, mod->ly_mod, val_opts | LYD_VALIDATE_NOT_FINAL,
                     finish_diff ? &diff : NULL))) {
@@ -2908,7 +4613,7 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, uint32_t mod_state, int fini
     /* finish each module validation now */
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
-        if (mod->state & mod_state) {
+        if ((mod->state & mod_state) && !(mod->state & MOD_INFO_INV_DEP_SKIP)) {
             if ((err_info = sr_lyd_validate_module_final(mod_info->data, mod->ly_mod, val_opts))) {
                 SR_ERRINFO_VALID(&err_info);
                 goto cleanup;
@@ -3132,9 +4837,9 @@ sr_error_info_t *
 sr_modinfo_get_filter(struct sr_mod_info_s *mod_info, const char *xpath, sr_session_ctx_t *session,
         struct ly_set **result)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     struct sr_mod_info_mod_s *mod;
-    struct lyd_node *edit = NULL, *diff = NULL;
+    struct lyd_node *edit = NULL, *diff = NULL, *match;
     uint32_t i;
     int is_oper_ds = (session->ds == SR_DS_OPERATIONAL) ? 1 : 0;
 
@@ -3143,6 +4848,9 @@ sr_modinfo_get_filter(struct sr_mod_info_s *mod_info, const char *xpath, sr_sess
         switch (session->ev) {
         case SR_SUB_EV_CHANGE:
         case SR_SUB_EV_UPDATE:
+            if ((err_info = sr_shmsub_change_listen_diff_complete(session, xpath))) {
+                goto cleanup;
+            }
             diff = session->dt[session->ds].diff;
             if (session->ev != SR_SUB_EV_UPDATE) {
                 break;
@@ -3171,11 +4879,8 @@ sr_modinfo_get_filter(struct sr_mod_info_s *mod_info, const char *xpath, sr_sess
         if (mod_info->data_cached) {
             /* data will be changed, we cannot use the cache anymore */
             lyd_dup_siblings(mod_info->data, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, &mod_info->data);
-            mod_info->data_cached = 0;
-
-            /* CACHE READ UNLOCK */
-            sr_rwunlock(&mod_info->conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ,
-                    mod_info->conn->cid, __func__);
+            sr_conn_run_cache_snap_unref(mod_info->data_cached);
+            mod_info->data_cached = NULL;
         }
 
         for (i = 0; (i < mod_info->mod_count) && (session->ds < SR_DS_COUNT); ++i) {
@@ -3194,6 +4899,18 @@ sr_modinfo_get_filter(struct sr_mod_info_s *mod_info, const char *xpath, sr_sess
         }
     }
 
+    if (mod_info->data && sr_xpath_is_instance_path(mod_info->conn->ly_ctx, xpath)) {
+        /* find the single instance using hashes, evaluate the path as an XPath if it cannot be resolved */
+        if ((tmp_err = sr_lyd_find_path(mod_info->data, xpath, 0, &match))) {
+            sr_errinfo_free(&tmp_err);
+        } else {
+            if (!(err_info = sr_ly_set_new(result)) && match) {
+                err_info = sr_ly_set_add(*result, match);
+            }
+            goto cleanup;
+        }
+    }
+
     if (mod_info->data) {
         /* filter return data using the xpath */
         if ((err_info = sr_lyd_find_xpath_root(mod_info->data, xpath, result))) {
@@ -3332,6 +5049,9 @@ sr_modinfo_change_notify_update(struct sr_mod_info_s *mod_info, sr_session_ctx_t
         case SR_DS_STARTUP:
         case SR_DS_RUNNING:
             /* update the modules */
+            if ((err_info = sr_modinfo_inv_deps_skip(mod_info))) {
+                goto cleanup;
+            }
             if ((err_info = sr_modinfo_collect_deps(mod_info))) {
                 goto cleanup;
             }
@@ -3571,82 +5291,180 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Module data store job.
+ */
+struct sr_modinfo_store_job_s {
+    struct sr_mod_info_mod_s *mod;  /**< Mod info module to store. */
+    sr_datastore_t ds;              /**< Datastore to store into. */
+    struct lyd_node *mod_diff;      /**< Unlinked module diff. */
+    struct lyd_node *mod_data;      /**< Unlinked module data. */
+    sr_error_info_t *err_info;      /**< Error of the store. */
+};
+
+/**
+ * @brief Execute a module data store job, callback of ::sr_conn_load_run().
+ *
+ * @param[in] idx Job index.
+ * @param[in] cb_data Array of module data store jobs.
+ * @return Always NULL, the error is kept in the job.
+ */
+static sr_error_info_t *
+sr_modinfo_store_job(uint32_t idx, void *cb_data)
+{
+    struct sr_modinfo_store_job_s *job = &((struct sr_modinfo_store_job_s *)cb_data)[idx];
+
+    /* store the new data */
+    SR_PROBE(ds__store__start, job->mod->ly_mod->name, (int)job->ds);
+    job->err_info = job->mod->ds_handle[job->ds]->plugin->store_cb(job->mod->ly_mod, job->ds, job->mod_diff,
+            job->mod_data, job->mod->ds_handle[job->ds]->plg_data);
+    SR_PROBE(ds__store__done, job->mod->ly_mod->name, (int)job->ds, job->err_info ? 1 : 0);
+    return NULL;
+}
+
 sr_error_info_t *
 sr_modinfo_data_store(struct sr_mod_info_s *mod_info)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     struct sr_mod_info_mod_s *mod;
+    struct sr_modinfo_store_job_s *jobs = NULL;
     struct lyd_node *mod_diff, *mod_data;
+    struct sr_subtree_hash_s *hashes;
     sr_datastore_t store_ds;
-    uint32_t i;
+    uint32_t i, job_count = 0, hash_count;
 
     assert(!mod_info->data_cached);
 
+    if (!mod_info->mod_count) {
+        return NULL;
+    }
+
+    /* separate diff and data of every changed module */
+    jobs = calloc(mod_info->mod_count, sizeof *jobs);
+    if (!jobs) {
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
-        if (mod->state & MOD_INFO_CHANGED) {
-            /* separate diff and data of this module */
-            mod_diff = (mod_info->ds == SR_DS_OPERATIONAL) ? NULL : sr_module_data_unlink(&mod_info->diff, mod->ly_mod);
-            mod_data = sr_module_data_unlink(&mod_info->data, mod->ly_mod);
+        if (!(mod->state & MOD_INFO_CHANGED)) {
+            continue;
+        }
 
-            if ((mod_info->ds == SR_DS_RUNNING) && !mod->ds_handle[mod_info->ds]) {
-                /* 'running' disabled, use 'startup' */
-                store_ds = SR_DS_STARTUP;
-            } else {
-                store_ds = mod_info->ds;
-            }
+        jobs[job_count].mod = mod;
+        jobs[job_count].mod_diff = (mod_info->ds == SR_DS_OPERATIONAL) ? NULL :
+                sr_module_data_unlink(&mod_info->diff, mod->ly_mod);
+        jobs[job_count].mod_data = sr_module_data_unlink(&mod_info->data, mod->ly_mod);
 
-            /* store the new data */
-            if ((err_info = mod->ds_handle[store_ds]->plugin->store_cb(mod->ly_mod, store_ds, mod_diff, mod_data,
-                    mod->ds_handle[store_ds]->plg_data))) {
-                lyd_free_siblings(mod_diff);
-                lyd_free_siblings(mod_data);
-                goto cleanup;
+        if ((mod_info->ds == SR_DS_RUNNING) && !mod->ds_handle[mod_info->ds]) {
+            /* 'running' disabled, use 'startup' */
+            jobs[job_count].ds = SR_DS_STARTUP;
+        } else {
+            jobs[job_count].ds = mod_info->ds;
+        }
+        ++job_count;
+    }
+
+    /* store the data of the modules, possibly in parallel, so that only the slowest module is waited for */
+    if ((err_info = sr_conn_load_run(mod_info->conn, job_count, sr_modinfo_store_job, jobs))) {
+        /* no job was executed, connect the data back */
+        for (i = 0; i < job_count; ++i) {
+            if (jobs[i].mod_diff) {
+                lyd_insert_sibling(mod_info->diff, jobs[i].mod_diff, &mod_info->diff);
+            }
+            if (jobs[i].mod_data) {
+                lyd_insert_sibling(mod_info->data, jobs[i].mod_data, &mod_info->data);
             }
+            jobs[i].mod_diff = NULL;
+            jobs[i].mod_data = NULL;
+        }
+        goto cleanup;
+    }
 
-            if (mod_info->ds == SR_DS_RUNNING) {
-                /* update the cache ID because data were modified, ignored if data_version callback is used instead */
-                mod->shm_mod->run_cache_id++;
+    for (i = 0; i < job_count; ++i) {
+        mod = jobs[i].mod;
+        store_ds = jobs[i].ds;
+        mod_diff = jobs[i].mod_diff;
+        mod_data = jobs[i].mod_data;
+        jobs[i].mod_diff = NULL;
+        jobs[i].mod_data = NULL;
+
+        if (jobs[i].err_info) {
+            /* the store failed, the other modules are still processed because they were stored */
+            sr_errinfo_merge(&err_info, jobs[i].err_info);
+            jobs[i].err_info = NULL;
+            lyd_free_siblings(mod_diff);
+            lyd_free_siblings(mod_data);
+            continue;
+        }
 
-                if (mod_info->conn->opts & SR_CONN_CACHE_RUNNING) {
-                    /* store the changed data in the cache */
-                    if ((err_info = sr_conn_run_cache_update_mod(mod_info->conn, mod->ly_mod, mod->shm_mod->run_cache_id,
-                            mod_data))) {
-                        goto cleanup;
-                    }
+        if (store_ds != SR_DS_RUNNING) {
+            /* update the cache ID of the datastore, ignored if data_version callback is used instead */
+            mod->shm_mod->ds_cache_id[store_ds]++;
+        }
+
+        if (mod_info->ds == SR_DS_RUNNING) {
+            /* update the cache ID because data were modified, ignored if data_version callback is used instead */
+            mod->shm_mod->run_cache_id++;
+
+            if ((mod_info->conn->opts & SR_CONN_CACHE_RUNNING_SHARED) &&
+                    !mod->ds_handle[store_ds]->plugin->data_version_cb &&
+                    (tmp_err = sr_conn_run_cache_shm_publish(mod_info->conn, mod->ly_mod,
+                    mod->shm_mod->run_cache_id, mod_data, mod_diff))) {
+                /* other connections will load the data from the datastore */
+                sr_errinfo_free(&tmp_err);
+            }
+
+            if (mod_info->conn->opts & SR_CONN_CACHE_RUNNING) {
+                hashes = NULL;
+                hash_count = 0;
+                if ((mod->state & MOD_INFO_SUBTREE_HASH) &&
+                        (tmp_err = sr_lyd_subtree_hashes(mod_data, &hashes, &hash_count))) {
+                    /* the hashes will be generated by the next replace */
+                    sr_errinfo_free(&tmp_err);
+                }
 
+                /* store the changed data in the cache */
+                if ((tmp_err = sr_conn_run_cache_update_mod(mod_info->conn, mod->ly_mod, mod->shm_mod->run_cache_id,
+                        mod_data, hashes, hash_count))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                } else {
                     /* mod data spent */
                     mod_data = NULL;
                     mod->state &= ~MOD_INFO_DATA;
                 }
             }
+        }
 
-            /* connect them back */
-            if (mod_diff) {
-                lyd_insert_sibling(mod_info->diff, mod_diff, &mod_info->diff);
-            }
-            if (mod_data) {
-                lyd_insert_sibling(mod_info->data, mod_data, &mod_info->data);
-            }
+        /* connect them back */
+        if (mod_diff) {
+            lyd_insert_sibling(mod_info->diff, mod_diff, &mod_info->diff);
+        }
+        if (mod_data) {
+            lyd_insert_sibling(mod_info->data, mod_data, &mod_info->data);
+        }
 
-            if ((mod_info->ds == SR_DS_OPERATIONAL) && (mod_info->ds2 == SR_DS_OPERATIONAL)) {
-                /* stored oper data, update cache of the modified modules in the connection */
-                if (mod_data) {
-                    if ((err_info = sr_conn_push_oper_mod_add(mod_info->conn, mod->ly_mod->name))) {
-                        goto cleanup;
-                    }
-                } else {
-                    if ((err_info = sr_conn_push_oper_mod_del(mod_info->conn, mod->ly_mod->name))) {
-                        goto cleanup;
-                    }
-                }
+        if ((mod_info->ds == SR_DS_OPERATIONAL) && (mod_info->ds2 == SR_DS_OPERATIONAL)) {
+            /* stored oper data, update cache of the modified modules in the connection */
+            if (mod_data) {
+                tmp_err = sr_conn_push_oper_mod_add(mod_info->conn, mod->ly_mod->name);
+            } else {
+                tmp_err = sr_conn_push_oper_mod_del(mod_info->conn, mod->ly_mod->name);
             }
+            sr_errinfo_merge(&err_info, tmp_err);
         }
     }
 
 cleanup:
+    if (jobs) {
+        for (i = 0; i < job_count; ++i) {
+            lyd_free_siblings(jobs[i].mod_diff);
+            lyd_free_siblings(jobs[i].mod_data);
+            sr_errinfo_free(&jobs[i].err_info);
+        }
+        free(jobs);
+    }
     return err_info;
-
 }
 
 sr_error_info_t *
@@ -3694,10 +5512,9 @@ sr_modinfo_erase(struct sr_mod_info_s *mod_info)
     uint32_t i, j;
 
     lyd_free_siblings(mod_info->diff);
+    sr_shmsub_change_notify_diff_remove(mod_info->conn->cid, &mod_info->diff_id);
     if (mod_info->data_cached) {
-        /* CACHE READ UNLOCK */
-        sr_rwunlock(&mod_info->conn->run_cache_lock, SR_CONN_RUN_CACHE_LOCK_TIMEOUT, SR_LOCK_READ,
-                mod_info->conn->cid, __func__);
+        sr_conn_run_cache_snap_unref(mod_info->data_cached);
     } else {
         lyd_free_siblings(mod_info->data);
     }
@@ -38,6 +38,11 @@
 #define MOD_INFO_DATA       0x0100 /* module data were loaded */
 #define MOD_INFO_CHANGED    0x0200 /* module data were changed */
 #define MOD_INFO_XPATH_DYN  0x0400 /* module XPaths are dynamically allocated and need to be freed */
+#define MOD_INFO_LOCK_BATCH 0x0800 /* module was locked by the lock batch in progress, used only while locking */
+#define MOD_INFO_INV_DEP_SKIP 0x1000 /* inverse dependency module whose references cannot be affected by the diff,
+                                        it will not be validated */
+#define MOD_INFO_SUBTREE_HASH 0x2000 /* module data were replaced using subtree hashes, cache the hashes of the stored
+                                        data */
 
 /**
  * @brief Mod info structure, used for keeping all relevant modules for a data operation.
@@ -46,9 +51,18 @@ struct sr_mod_info_s {
     sr_datastore_t ds;          /**< Main datastore we are working with. */
     sr_datastore_t ds2;         /**< Secondary datastore valid only if differs from the main one. Used only for locking. */
     struct lyd_node *diff;      /**< Diff with previous data. */
+    uint32_t diff_id;           /**< Shared diff segment ID of the published change events, 0 if none. */
     struct lyd_node *data;      /**< Data tree. */
-    int data_cached;            /**< Whether the data are actually cached. */
+    struct sr_run_cache_snap_s *data_cached;    /**< Referenced running cache snapshot if @p data are its data,
+                                                     they must not be modified. */
     sr_conn_ctx_t *conn;        /**< Associated connection. */
+    uint32_t max_depth;         /**< Maximum depth of the nodes selected by the XPaths that are required,
+                                     0 if unlimited. Used for getting operational data and for loading only
+                                     the required depth of the other datastores. */
+    const char *nacm_user;      /**< NACM user whose read access is applied to the loaded data, if set any data
+                                     that would be filtered out completely are not loaded. */
+    uint32_t *phase_us;         /**< Request phase durations to add the durations of the phases to, if set. */
+    int notified;               /**< Set once subscribers may have been notified about the changes. */
 
     struct sr_mod_info_mod_s {
         sr_mod_t *shm_mod;      /**< Module SHM structure. */
@@ -105,7 +119,9 @@ sr_error_info_t *sr_modinfo_collect_edit(const struct lyd_node *edit, struct sr_
 /**
  * @brief Collect required modules for evaluating XPath and getting selected data in mod info.
  *
- * @param[in] ly_ctx libyang context.
+ * The modules are cached in the connection for repeated XPaths.
+ *
+ * @param[in] conn Connection to use.
  * @param[in] xpath XPath to be evaluated.
  * @param[in] ds Target datastore where the @p xpath will be evaluated.
  * @param[in] session Optional session to get the changes from if @p xpath_opts include #MOD_INFO_XPATH_STORE_SESSION_CHANGES.
@@ -113,7 +129,7 @@ sr_error_info_t *sr_modinfo_collect_edit(const struct lyd_node *edit, struct sr_
  * @param[in,out] mod_info Mod info to add to.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_modinfo_collect_xpath(const struct ly_ctx *ly_ctx, const char *xpath, sr_datastore_t ds,
+sr_error_info_t *sr_modinfo_collect_xpath(sr_conn_ctx_t *conn, const char *xpath, sr_datastore_t ds,
         sr_session_ctx_t *session, uint32_t xpath_opts, struct sr_mod_info_s *mod_info);
 
 /**
@@ -135,6 +151,21 @@ sr_error_info_t *sr_modinfo_collect_deps(struct sr_mod_info_s *mod_info);
  */
 sr_error_info_t *sr_modinfo_collect_ext_deps(const struct lysc_node *mp_node, struct sr_mod_info_s *mod_info);
 
+/**
+ * @brief Collect required modules for validating the input or output of an RPC/action in mod info.
+ *
+ * The leafref and XPath dependencies are cached in the connection, only instance-identifier dependencies
+ * are evaluated on @p data every time.
+ *
+ * @param[in] path RPC/action path.
+ * @param[in] output Whether to collect the output or the input dependencies.
+ * @param[in] data Operation data tree for evaluating instance-identifier dependencies.
+ * @param[in,out] mod_info Mod info to add to.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_modinfo_collect_rpc_deps(const char *path, int output, const struct lyd_node *data,
+        struct sr_mod_info_s *mod_info);
+
 /**
  * @brief Check permissions of all the modules in a mod info.
  *
@@ -186,6 +217,25 @@ sr_error_info_t *sr_modinfo_edit_merge(struct sr_mod_info_s *mod_info, const str
  */
 sr_error_info_t *sr_modinfo_replace(struct sr_mod_info_s *mod_info, struct lyd_node **src_data);
 
+/**
+ * @brief Learn the differences of current and new data, skipping subtrees with equal content hashes.
+ *
+ * Only the subtrees with different hashes are descended into so the cost is given by the changed subtrees.
+ * Default nodes are not part of the hashes, the diff of a skipped subtree never includes them.
+ *
+ * @param[in] dst_data Current data.
+ * @param[in] dst_hashes Subtree hashes of @p dst_data.
+ * @param[in] dst_hash_count Count of @p dst_hashes.
+ * @param[in] src_data New data.
+ * @param[in] src_hashes Subtree hashes of @p src_data.
+ * @param[in] src_hash_count Count of @p src_hashes.
+ * @param[out] diff Diff of the data, NULL if there are no differences.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_modinfo_subtree_hash_diff(const struct lyd_node *dst_data,
+        const struct sr_subtree_hash_s *dst_hashes, uint32_t dst_hash_count, const struct lyd_node *src_data, const struct sr_subtree_hash_s *src_hashes,
+        uint32_t src_hash_count, struct lyd_node **diff);
+
 /**
  * @brief Read-lock all changed modules in mod info.
  *
@@ -211,6 +261,12 @@ void sr_modinfo_changesub_rdunlock(struct sr_mod_info_s *mod_info);
 #define SR_MI_PERM_NO           0x40    /**< do not check any permissions */
 #define SR_MI_PERM_READ         0x80    /**< check read permissions of the MOD_INFO_REQ modules */
 #define SR_MI_PERM_WRITE        0x0100  /**< check write permissions of the MOD_INFO_REQ modules */
+#define SR_MI_LOCK_NOFAIR       0x0200  /**< only valid for a read lock, never wait for writers that are still waiting
+                                             for other readers (::sr_rwlock_nofair()), required by event sessions */
+
+/** mod info options for reading the data of a session */
+#define SR_MI_READ_OPTS(session) \
+        (SR_MI_DATA_RO | SR_MI_PERM_READ | (SR_IS_EVENT_SESS(session) ? SR_MI_LOCK_NOFAIR : 0))
 
 /**
  * @brief Consolidate mod info by adding dependencies of the added modules, check the permissions, lock, and load data.
@@ -229,6 +285,30 @@ sr_error_info_t *sr_modinfo_consolidate(struct sr_mod_info_s *mod_info, sr_lock_
         uint32_t sid, const char *orig_name, const void *orig_data, uint32_t timeout_ms, uint32_t ds_lock_timeout_ms,
         sr_get_oper_flag_t get_oper_opts);
 
+/**
+ * @brief Learn which inverse dependency modules can be affected by the diff of mod info and need to be validated,
+ * remember the others in ::MOD_INFO_INV_DEP_SKIP.
+ *
+ * A module is affected if any of its data dependencies references changed data, for leafref and
+ * instance-identifier dependencies only deleted or replaced nodes are considered.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_modinfo_inv_deps_skip(struct sr_mod_info_s *mod_info);
+
+/**
+ * @brief Check whether the diff of mod info only changes values of existing leaves that cannot affect validity
+ * of any data, so the new data do not need to be validated again.
+ *
+ * Values are valid for their types when set, the changed modules must have no XPath, leafref, instance-identifier,
+ * nor unique constraints and no inverse dependencies.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @return Whether the diff changes only values and validation can be skipped.
+ */
+int sr_modinfo_diff_is_value_only(const struct sr_mod_info_s *mod_info);
+
 /**
  * @brief Validate data for modules in mod info.
  *
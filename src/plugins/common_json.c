@@ -749,6 +749,27 @@ srpjson_get_notif_path(const char *plg_name, const char *mod_name, time_t from_t
     return NULL;
 }
 
+sr_error_info_t *
+srpjson_get_notif_index_path(const char *plg_name, const char *mod_name, time_t from_ts, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    int r;
+
+    if (SR_NOTIFICATION_PATH[0]) {
+        r = asprintf(path, "%s/%s.notif.%" PRId64 SRPJSON_NOTIF_INDEX_SUFFIX, SR_NOTIFICATION_PATH, mod_name,
+                (int64_t)from_ts);
+    } else {
+        r = asprintf(path, "%s/data/notif/%s.notif.%" PRId64 SRPJSON_NOTIF_INDEX_SUFFIX, sr_get_repo_path(), mod_name,
+                (int64_t)from_ts);
+    }
+
+    if (r == -1) {
+        srplg_log_errinfo(&err_info, plg_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        return err_info;
+    }
+    return NULL;
+}
+
 int
 srpjson_module_has_data(const struct lys_module *ly_mod, int state_data)
 {
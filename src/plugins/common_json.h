@@ -28,6 +28,21 @@
 /** suffix of backed-up JSON files */
 #define SRPJSON_FILE_BACKUP_SUFFIX ".bck"
 
+/** suffix of journal files with the diffs not yet stored in the JSON files */
+#define SRPJSON_FILE_JOURNAL_SUFFIX ".jrnl"
+
+/** suffix of overlay files with the changes of the running data that make up the candidate data */
+#define SRPJSON_FILE_OVERLAY_SUFFIX ".ovl"
+
+/** journal is folded into the JSON file once it is larger than the file and this size (kB) */
+#define SRPJSON_JOURNAL_MIN_SIZE 64
+
+/** infix of shard files with the data of a single top-level node, followed by its name */
+#define SRPJSON_FILE_SHARD_SUFFIX ".shard."
+
+/** suffix of the manifest files with the names of all the shards of a datastore file */
+#define SRPJSON_FILE_SHARDS_SUFFIX ".shards"
+
 /** permissions of new directories */
 #define SRPJSON_DIR_PERM 00777
 
@@ -37,6 +52,12 @@
 /** notification file will never exceed this size (kB) */
 #define SRPJSON_NOTIF_FILE_MAX_SIZE 1024
 
+/** suffix of the timestamp index files of notification files */
+#define SRPJSON_NOTIF_INDEX_SUFFIX ".idx"
+
+/** notification file size between 2 consecutive timestamp index entries (kB) */
+#define SRPJSON_NOTIF_INDEX_INTERVAL 16
+
 /**
  * @brief Wrapper for writev().
  *
@@ -234,6 +255,17 @@ sr_error_info_t *srpjson_get_notif_dir(const char *plg_name, char **path);
  */
 sr_error_info_t *srpjson_get_notif_path(const char *plg_name, const char *mod_name, time_t from_ts, time_t to_ts, char **path);
 
+/**
+ * @brief Get the path to the timestamp index of a module notification file.
+ *
+ * @param[in] plg_name Plugin name.
+ * @param[in] mod_name Module name.
+ * @param[in] from_ts Timestamp of the first stored notification, it never changes for a notification file.
+ * @param[out] path Created path.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *srpjson_get_notif_index_path(const char *plg_name, const char *mod_name, time_t from_ts, char **path);
+
 /**
  * @brief Check whether a module defines any instantiable data nodes (ignoring operations).
  *
@@ -23,21 +23,44 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <libyang/libyang.h>
 
 #include "common_json.h"
+#include "config.h"
 #include "sysrepo.h"
 
-#define srpds_name "JSON DS file"  /**< plugin name */
+#ifndef srpds_name
+# define srpds_name "JSON DS file"  /**< plugin name */
+# define SRPDS_FORMAT LYD_JSON      /**< format of the data files */
+# define SRPDS_FILE_SUFFIX ""       /**< suffix appended to all the files */
+# define SRPDS_PLUGIN srpds_json    /**< plugin structure */
+#endif
+
+#ifdef SR_JSON_DS_OPER_SEGMENTS
+/* operational edits are stored in shards, one for every connection */
+# define SRPDS_JSON_OPER_SHARDS 1
+#else
+# define SRPDS_JSON_OPER_SHARDS 0
+#endif
+
+#ifdef LYD_PARSE_LYB_SKIP_CTX_CHECK
+/* LYB data may have been printed by another process with a different context of the same modules */
+# define SRPDS_LYB_PARSE_OPTS LYD_PARSE_LYB_SKIP_CTX_CHECK
+#else
+# define SRPDS_LYB_PARSE_OPTS 0
+#endif
 
 static sr_error_info_t *srpds_json_load(const struct lys_module *mod, sr_datastore_t ds, const char **xpaths,
         uint32_t xpath_count, void *plg_data, struct lyd_node **mod_data);
@@ -45,19 +68,1399 @@ static sr_error_info_t *srpds_json_load(const struct lys_module *mod, sr_datasto
 static sr_error_info_t * srpds_json_access_get(const struct lys_module *mod, sr_datastore_t ds, void *plg_data,
         char **owner, char **group, mode_t *perm);
 
+static sr_error_info_t *srpds_json_last_modif(const struct lys_module *mod, sr_datastore_t ds, void *plg_data,
+        struct timespec *mtime);
+
+static void srpds_json_load_top_nodes(const struct lys_module *mod, const char **xpaths, uint32_t xpath_count,
+        struct ly_set **top_nodes);
+
+/**
+ * @brief Append the plugin file suffix to a path.
+ *
+ * @param[in,out] path Path to update.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_path_suffix(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *suffixed;
+
+    if (!SRPDS_FILE_SUFFIX[0]) {
+        return NULL;
+    }
+
+    if (asprintf(&suffixed, "%s%s", *path, SRPDS_FILE_SUFFIX) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        free(*path);
+        *path = NULL;
+        return err_info;
+    }
+    free(*path);
+    *path = suffixed;
+    return NULL;
+}
+
+/**
+ * @brief Get path of a datastore file of this plugin.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] path Datastore file path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_get_path(const struct lys_module *mod, sr_datastore_t ds, char **path)
+{
+    sr_error_info_t *err_info;
+
+    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, path))) {
+        return err_info;
+    }
+    return srpds_json_path_suffix(path);
+}
+
+/**
+ * @brief Get path of a datastore permission file of this plugin.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] path Permission file path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_get_perm_path(const struct lys_module *mod, sr_datastore_t ds, char **path)
+{
+    sr_error_info_t *err_info;
+
+    if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, path))) {
+        return err_info;
+    }
+    return srpds_json_path_suffix(path);
+}
+
+/** length of the journal header with the modification time of the data file it is for */
+#define SRPDS_JSON_JOURNAL_HDR_LEN 31
+
+/**
+ * @brief Get path of the journal of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] path Journal path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_journal_path(const struct lys_module *mod, sr_datastore_t ds, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *ds_path;
+
+    *path = NULL;
+
+    if ((err_info = srpds_json_get_path(mod, ds, &ds_path))) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s%s", ds_path, SRPJSON_FILE_JOURNAL_SUFFIX) == -1) {
+        *path = NULL;
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+    }
+    free(ds_path);
+    return err_info;
+}
+
+/**
+ * @brief Print the journal header for a data file.
+ *
+ * @param[in] mtime Modification time of the data file.
+ * @param[out] hdr Printed header, must be at least ::SRPDS_JSON_JOURNAL_HDR_LEN + 1 long.
+ */
+static void
+srpds_json_journal_hdr(const struct timespec *mtime, char *hdr)
+{
+    sprintf(hdr, "%020lld.%09ld\n", (long long)mtime->tv_sec, (long)mtime->tv_nsec);
+}
+
+/**
+ * @brief Remove the journal of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_journal_remove(const struct lys_module *mod, sr_datastore_t ds)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path;
+
+    if ((err_info = srpds_json_journal_path(mod, ds, &path))) {
+        return err_info;
+    }
+
+    if ((unlink(path) == -1) && (errno != ENOENT)) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Unlinking \"%s\" failed (%s).", path,
+                strerror(errno));
+    }
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Update the journal of a datastore file to be for its current contents.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_journal_rebase(const struct lys_module *mod, sr_datastore_t ds)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *path = NULL, *jrnl_path = NULL, hdr[SRPDS_JSON_JOURNAL_HDR_LEN + 1];
+    int fd = -1;
+
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_journal_path(mod, ds, &jrnl_path))) {
+        goto cleanup;
+    }
+
+    fd = srpjson_open(srpds_name, jrnl_path, O_WRONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            err_info = srpjson_open_error(srpds_name, jrnl_path);
+        }
+        goto cleanup;
+    }
+
+    if (stat(path, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    /* rewrite the header */
+    srpds_json_journal_hdr(&st.st_mtim, hdr);
+    if (pwrite(fd, hdr, SRPDS_JSON_JOURNAL_HDR_LEN, 0) != SRPDS_JSON_JOURNAL_HDR_LEN) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Writing \"%s\" failed (%s).", jrnl_path,
+                strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    free(jrnl_path);
+    return err_info;
+}
+
+/**
+ * @brief Get path of the overlay of the candidate datastore file with its changes of the running data.
+ *
+ * @param[in] mod Module of the data.
+ * @param[out] path Overlay path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_path(const struct lys_module *mod, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *ds_path;
+
+    *path = NULL;
+
+    if ((err_info = srpds_json_get_path(mod, SR_DS_CANDIDATE, &ds_path))) {
+        return err_info;
+    }
+
+    if (asprintf(path, "%s%s", ds_path, SRPJSON_FILE_OVERLAY_SUFFIX) == -1) {
+        *path = NULL;
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+    }
+    free(ds_path);
+    return err_info;
+}
+
+/**
+ * @brief Remove the overlay of the candidate datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_remove(const struct lys_module *mod)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path;
+
+    if ((err_info = srpds_json_overlay_path(mod, &path))) {
+        return err_info;
+    }
+
+    if ((unlink(path) == -1) && (errno != ENOENT)) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Unlinking \"%s\" failed (%s).", path,
+                strerror(errno));
+    }
+    free(path);
+    return err_info;
+}
+
+#if defined (SR_JSON_DS_JOURNAL) || defined (SR_JSON_DS_CANDIDATE_OVERLAY)
+
+/**
+ * @brief Append a diff as a record into a journal or an overlay file.
+ *
+ * @param[in] path Path of the file.
+ * @param[in] hdr Header of the file, the records are appended only if matching.
+ * @param[in] ref_st Stat of the file the records are for, a new file gets the same access rights and grows at most
+ * to its size, or ::SRPJSON_JOURNAL_MIN_SIZE.
+ * @param[in] mod_diff Diff to append.
+ * @param[out] appended Whether the diff was appended.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_record_append(const char *path, const char *hdr, const struct stat *ref_st, const struct lyd_node *mod_diff,
+        int *appended)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat jrnl_st;
+    struct iovec iov[3];
+    char *diff_json = NULL, jrnl_hdr[SRPDS_JSON_JOURNAL_HDR_LEN], last;
+    int fd = -1, creat = 0, iovcnt = 0;
+    off_t max_size;
+    size_t len;
+
+    *appended = 0;
+
+    /* print the diff on a single line */
+    if (lyd_print_mem(&diff_json, mod_diff, LYD_JSON, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK |
+            LYD_PRINT_KEEPEMPTYCONT | LYD_PRINT_WD_IMPL_TAG)) {
+        err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(mod_diff));
+        goto cleanup;
+    }
+    len = strlen(diff_json);
+
+    /* open the file, create it with the same access rights as the reference file */
+    fd = srpjson_open(srpds_name, path, O_RDWR | O_APPEND | O_CREAT | O_EXCL, ref_st->st_mode & 0007777);
+    if (fd > -1) {
+        creat = 1;
+        if (fchown(fd, ref_st->st_uid, ref_st->st_gid) == -1) {
+            /* the file could not be accessed the same way as the reference file */
+            goto cleanup;
+        }
+    } else if (errno == EEXIST) {
+        fd = srpjson_open(srpds_name, path, O_RDWR | O_APPEND, 0);
+    }
+    if (fd == -1) {
+        err_info = srpjson_open_error(srpds_name, path);
+        goto cleanup;
+    }
+    if (fstat(fd, &jrnl_st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path,
+                strerror(errno));
+        goto cleanup;
+    }
+
+    if (!creat) {
+        /* the file must be for the current reference file and end with a complete record */
+        if ((jrnl_st.st_size < SRPDS_JSON_JOURNAL_HDR_LEN) ||
+                (pread(fd, jrnl_hdr, SRPDS_JSON_JOURNAL_HDR_LEN, 0) != SRPDS_JSON_JOURNAL_HDR_LEN) ||
+                memcmp(jrnl_hdr, hdr, SRPDS_JSON_JOURNAL_HDR_LEN) ||
+                (pread(fd, &last, 1, jrnl_st.st_size - 1) != 1) || (last != '\n')) {
+            goto cleanup;
+        }
+    } else {
+        iov[iovcnt].iov_base = (void *)hdr;
+        iov[iovcnt].iov_len = SRPDS_JSON_JOURNAL_HDR_LEN;
+        ++iovcnt;
+    }
+
+    /* check the file size */
+    max_size = (ref_st->st_size > SRPJSON_JOURNAL_MIN_SIZE * 1024) ? ref_st->st_size : SRPJSON_JOURNAL_MIN_SIZE * 1024;
+    if (jrnl_st.st_size + (creat ? SRPDS_JSON_JOURNAL_HDR_LEN : 0) + (off_t)len + 1 > max_size) {
+        goto cleanup;
+    }
+
+    /* append the record */
+    iov[iovcnt].iov_base = diff_json;
+    iov[iovcnt].iov_len = len;
+    ++iovcnt;
+    iov[iovcnt].iov_base = "\n";
+    iov[iovcnt].iov_len = 1;
+    ++iovcnt;
+    if ((err_info = srpjson_writev(srpds_name, fd, iov, iovcnt))) {
+        /* get rid of a partially written record */
+        if (!creat && (ftruncate(fd, jrnl_st.st_size) == -1)) {
+            SRPLG_LOG_WRN(srpds_name, "Failed to truncate \"%s\" (%s).", path, strerror(errno));
+        }
+        goto cleanup;
+    }
+    *appended = 1;
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    if (creat && !*appended) {
+        unlink(path);
+    }
+    free(diff_json);
+    return err_info;
+}
+
+#endif
+
+#ifdef SR_JSON_DS_JOURNAL
+
+/**
+ * @brief Append a diff into the journal of a datastore file.
+ *
+ * The diff is not appended if the journal would grow larger than both the data file and ::SRPJSON_JOURNAL_MIN_SIZE
+ * or if the journal is not usable, the whole data file is expected to be stored instead.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] mod_diff Diff to append.
+ * @param[out] appended Whether the diff was appended.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_journal_append(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *mod_diff,
+        int *appended)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *path = NULL, *jrnl_path = NULL, hdr[SRPDS_JSON_JOURNAL_HDR_LEN + 1];
+
+    *appended = 0;
+
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_journal_path(mod, ds, &jrnl_path))) {
+        goto cleanup;
+    }
+
+    /* the data file the journal is for */
+    if (stat(path, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+    srpds_json_journal_hdr(&st.st_mtim, hdr);
+
+    err_info = srpds_json_record_append(jrnl_path, hdr, &st, mod_diff, appended);
+
+cleanup:
+    free(path);
+    free(jrnl_path);
+    return err_info;
+}
+
+#endif
+
+/**
+ * @brief Apply the diffs stored as records in a journal or an overlay file on loaded data.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] path Path of the file.
+ * @param[in] hdr Header of the file, the records are applied only if matching.
+ * @param[in] top_nodes Selected top-level schema nodes, NULL if all the data were loaded.
+ * @param[in] parse_opts Parse options.
+ * @param[in,out] mod_data Loaded module data.
+ * @param[out] applied Optional, set if the header matched.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_record_apply(const struct lys_module *mod, const char *path, const char *hdr, const struct ly_set *top_nodes,
+        uint32_t parse_opts, struct lyd_node **mod_data, int *applied)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat jrnl_st;
+    struct lyd_node *diff = NULL, *node, *next;
+    const char *jrnl = NULL, *ptr, *end, *eol;
+    char *rec = NULL;
+    int jrnl_fd = -1;
+
+    if (applied) {
+        *applied = 0;
+    }
+
+    jrnl_fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+    if (jrnl_fd == -1) {
+        if (errno != ENOENT) {
+            err_info = srpjson_open_error(srpds_name, path);
+        }
+        goto cleanup;
+    }
+
+    if (fstat(jrnl_fd, &jrnl_st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path,
+                strerror(errno));
+        goto cleanup;
+    }
+    if (jrnl_st.st_size < SRPDS_JSON_JOURNAL_HDR_LEN) {
+        /* no header */
+        goto cleanup;
+    }
+
+    jrnl = mmap(NULL, jrnl_st.st_size, PROT_READ, MAP_PRIVATE, jrnl_fd, 0);
+    if (jrnl == MAP_FAILED) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Mapping \"%s\" failed (%s).", path,
+                strerror(errno));
+        jrnl = NULL;
+        goto cleanup;
+    }
+    end = jrnl + jrnl_st.st_size;
+
+    /* check the records are for these data */
+    if (memcmp(jrnl, hdr, SRPDS_JSON_JOURNAL_HDR_LEN)) {
+        goto cleanup;
+    }
+    if (applied) {
+        *applied = 1;
+    }
+
+    /* apply all the complete records */
+    for (ptr = jrnl + SRPDS_JSON_JOURNAL_HDR_LEN; (eol = memchr(ptr, '\n', end - ptr)); ptr = eol + 1) {
+        rec = strndup(ptr, eol - ptr);
+        if (!rec) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        if (lyd_parse_data_mem(mod->ctx, rec, LYD_JSON, parse_opts, 0, &diff)) {
+            err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_INTERNAL, "Failed to parse a record of \"%s\".",
+                    path);
+            goto cleanup;
+        }
+        free(rec);
+        rec = NULL;
+
+        if (top_nodes) {
+            /* only the selected data were loaded */
+            LY_LIST_FOR_SAFE(diff, next, node) {
+                if (!ly_set_contains(top_nodes, (void *)node->schema, NULL)) {
+                    if (node == diff) {
+                        diff = next;
+                    }
+                    lyd_free_tree(node);
+                }
+            }
+        }
+
+        if (diff && lyd_diff_apply_module(mod_data, diff, mod, NULL, NULL)) {
+            err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_INTERNAL, "Failed to apply a record of \"%s\".",
+                    path);
+            goto cleanup;
+        }
+        lyd_free_siblings(diff);
+        diff = NULL;
+    }
+    if (ptr < end) {
+        /* interrupted append */
+        SRPLG_LOG_WRN(srpds_name, "Ignoring an incomplete record at the end of \"%s\".", path);
+    }
+
+cleanup:
+    if (jrnl) {
+        munmap((void *)jrnl, jrnl_st.st_size);
+    }
+    if (jrnl_fd > -1) {
+        close(jrnl_fd);
+    }
+    free(rec);
+    lyd_free_siblings(diff);
+    return err_info;
+}
+
+/**
+ * @brief Apply the diffs stored in the journal of a datastore file on its loaded data.
+ *
+ * A journal not created for the current data file has all its changes already stored in the data file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] fd File descriptor of the data file.
+ * @param[in] top_nodes Selected top-level schema nodes, NULL if all the data were loaded.
+ * @param[in] parse_opts Parse options.
+ * @param[in,out] mod_data Loaded module data.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_journal_replay(const struct lys_module *mod, sr_datastore_t ds, int fd, const struct ly_set *top_nodes,
+        uint32_t parse_opts, struct lyd_node **mod_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *jrnl_path = NULL, hdr[SRPDS_JSON_JOURNAL_HDR_LEN + 1];
+
+    if ((err_info = srpds_json_journal_path(mod, ds, &jrnl_path))) {
+        goto cleanup;
+    }
+
+    if (fstat(fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" data failed (%s).", mod->name,
+                strerror(errno));
+        goto cleanup;
+    }
+    srpds_json_journal_hdr(&st.st_mtim, hdr);
+
+    err_info = srpds_json_record_apply(mod, jrnl_path, hdr, top_nodes, parse_opts, mod_data, NULL);
+
+cleanup:
+    free(jrnl_path);
+    return err_info;
+}
+
+/**
+ * @brief Get path of a shard file or the shard manifest of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] name Name of the top-level node of the shard, NULL for the manifest.
+ * @param[out] path Shard file path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shard_path(const struct lys_module *mod, sr_datastore_t ds, const char *name, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *ds_path;
+    int r;
+
+    *path = NULL;
+
+    if ((err_info = srpds_json_get_path(mod, ds, &ds_path))) {
+        return err_info;
+    }
+
+    if (name) {
+        r = asprintf(path, "%s" SRPJSON_FILE_SHARD_SUFFIX "%s", ds_path, name);
+    } else {
+        r = asprintf(path, "%s" SRPJSON_FILE_SHARDS_SUFFIX, ds_path);
+    }
+    if (r == -1) {
+        *path = NULL;
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+    }
+    free(ds_path);
+    return err_info;
+}
+
+/**
+ * @brief Free shard names.
+ *
+ * @param[in] names Shard names to free.
+ * @param[in] count Count of @p names.
+ */
+static void
+srpds_json_shards_free(char **names, uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; ++i) {
+        free(names[i]);
+    }
+    free(names);
+}
+
+/**
+ * @brief Read the shard manifest of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] names Names of the top-level nodes stored in shards.
+ * @param[out] count Count of @p names.
+ * @param[out] sharded Whether the data are sharded at all, there is no manifest otherwise.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shards_get(const struct lys_module *mod, sr_datastore_t ds, char ***names, uint32_t *count, int *sharded)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *path = NULL, *buf = NULL, *ptr, *eol;
+    void *mem;
+    int fd = -1;
+
+    *names = NULL;
+    *count = 0;
+    *sharded = 0;
+
+    if ((err_info = srpds_json_shard_path(mod, ds, NULL, &path))) {
+        goto cleanup;
+    }
+
+    fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            err_info = srpjson_open_error(srpds_name, path);
+        }
+        goto cleanup;
+    }
+    if (fstat(fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    /* read the whole manifest */
+    buf = malloc(st.st_size + 1);
+    if (!buf) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    if ((err_info = srpjson_read(srpds_name, fd, buf, st.st_size))) {
+        goto cleanup;
+    }
+    buf[st.st_size] = '\0';
+
+    /* a node name on every line */
+    for (ptr = buf; (eol = strchr(ptr, '\n')); ptr = eol + 1) {
+        mem = realloc(*names, (*count + 1) * sizeof **names);
+        if (!mem) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        *names = mem;
+
+        (*names)[*count] = strndup(ptr, eol - ptr);
+        if (!(*names)[*count]) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        ++(*count);
+    }
+    *sharded = 1;
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    if (err_info) {
+        srpds_json_shards_free(*names, *count);
+        *names = NULL;
+        *count = 0;
+    }
+    free(path);
+    free(buf);
+    return err_info;
+}
+
+/**
+ * @brief Remove all the shard files and the manifest of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shards_remove(const struct lys_module *mod, sr_datastore_t ds)
+{
+    sr_error_info_t *err_info = NULL;
+    char **names = NULL, *path = NULL;
+    uint32_t i, count = 0;
+    int sharded;
+
+    if ((err_info = srpds_json_shards_get(mod, ds, &names, &count, &sharded)) || !sharded) {
+        goto cleanup;
+    }
+
+    /* remove the manifest first, the shards are not used without it */
+    if ((err_info = srpds_json_shard_path(mod, ds, NULL, &path))) {
+        goto cleanup;
+    }
+    if (unlink(path) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Unlinking \"%s\" failed (%s).", path,
+                strerror(errno));
+        goto cleanup;
+    }
+
+    for (i = 0; i < count; ++i) {
+        free(path);
+        if ((err_info = srpds_json_shard_path(mod, ds, names[i], &path))) {
+            goto cleanup;
+        }
+        if ((unlink(path) == -1) && (errno != ENOENT)) {
+            SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", path, strerror(errno));
+        }
+    }
+
+cleanup:
+    srpds_json_shards_free(names, count);
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Update owner, group, and permissions of all the shard files and the manifest of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] owner Optional new owner.
+ * @param[in] group Optional new group.
+ * @param[in] perm Optional new permissions.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shards_chmodown(const struct lys_module *mod, sr_datastore_t ds, const char *owner, const char *group,
+        mode_t perm)
+{
+    sr_error_info_t *err_info = NULL;
+    char **names = NULL, *path = NULL;
+    uint32_t i, count = 0;
+    int sharded;
+
+    if ((err_info = srpds_json_shards_get(mod, ds, &names, &count, &sharded)) || !sharded) {
+        goto cleanup;
+    }
+
+    if ((err_info = srpds_json_shard_path(mod, ds, NULL, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < count; ++i) {
+        free(path);
+        if ((err_info = srpds_json_shard_path(mod, ds, names[i], &path))) {
+            goto cleanup;
+        }
+        if ((err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    srpds_json_shards_free(names, count);
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Load the data of the shards of a datastore file.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] names Names of the top-level nodes stored in shards.
+ * @param[in] count Count of @p names.
+ * @param[in] top_nodes Selected top-level schema nodes, NULL for all.
+ * @param[in] parse_opts Parse options.
+ * @param[in,out] mod_data Module data to add the shard data to.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shards_load(const struct lys_module *mod, sr_datastore_t ds, char **names, uint32_t count,
+        const struct ly_set *top_nodes, uint32_t parse_opts, struct lyd_node **mod_data)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *snode;
+    struct lyd_node *shard_data;
+    char *path = NULL;
+    uint32_t i;
+    int fd = -1;
+
+    for (i = 0; i < count; ++i) {
+        snode = lys_find_child(NULL, mod, names[i], 0, LYS_CONTAINER | LYS_LIST, 0);
+        if (top_nodes && (!snode || !ly_set_contains(top_nodes, (void *)snode, NULL))) {
+            /* not selected */
+            continue;
+        }
+
+        free(path);
+        if ((err_info = srpds_json_shard_path(mod, ds, names[i], &path))) {
+            goto cleanup;
+        }
+
+        fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+        if (fd == -1) {
+            err_info = srpjson_open_error(srpds_name, path);
+            goto cleanup;
+        }
+
+        /* parse the shard and add its data */
+        if (lyd_parse_data_fd(mod->ctx, fd, SRPDS_FORMAT, parse_opts |
+                ((SRPDS_FORMAT == LYD_LYB) ? SRPDS_LYB_PARSE_OPTS : 0), 0, &shard_data)) {
+            err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+            goto cleanup;
+        }
+        close(fd);
+        fd = -1;
+
+        if (shard_data) {
+            lyd_insert_sibling(*mod_data, shard_data, mod_data);
+        }
+    }
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Atomically replace a datastore file, its shard file, or its manifest by a new file.
+ *
+ * @param[in] path Path of the file.
+ * @param[in] data Data to print, if @p buf is not set.
+ * @param[in] buf Text to write instead of data.
+ * @param[in] ds_st Stat of the datastore file, the file gets the same access rights.
+ * @param[out] fallback Set if the file could not get the same access rights as the datastore file, it is not replaced.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_file_replace(const char *path, const struct lyd_node *data, const char *buf, const struct stat *ds_st,
+        int *fallback)
+{
+    sr_error_info_t *err_info = NULL;
+    struct iovec iov;
+    struct ly_out *out = NULL;
+    char *tmp_path = NULL;
+    int fd = -1;
+
+    if (asprintf(&tmp_path, "%s~", path) == -1) {
+        tmp_path = NULL;
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+
+    /* new file with the same access rights as the datastore file */
+    fd = srpjson_open(srpds_name, tmp_path, O_WRONLY | O_CREAT | O_TRUNC, ds_st->st_mode & 0007777);
+    if (fd == -1) {
+        err_info = srpjson_open_error(srpds_name, tmp_path);
+        goto cleanup;
+    }
+    if (fchown(fd, ds_st->st_uid, ds_st->st_gid) == -1) {
+        *fallback = 1;
+        goto cleanup;
+    }
+
+    if (buf) {
+        iov.iov_base = (void *)buf;
+        iov.iov_len = strlen(buf);
+        if ((err_info = srpjson_writev(srpds_name, fd, &iov, 1))) {
+            goto cleanup;
+        }
+    } else {
+        if (ly_out_new_fd(fd, &out)) {
+            err_info = srpjson_log_err_ly(srpds_name, NULL);
+            goto cleanup;
+        }
+        if (lyd_print_all(out, data, SRPDS_FORMAT, LYD_PRINT_SHRINK | LYD_PRINT_KEEPEMPTYCONT | LYD_PRINT_WD_IMPL_TAG)) {
+            err_info = srpjson_log_err_ly(srpds_name, data ? LYD_CTX(data) : NULL);
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_INTERNAL, "Failed to store data into \"%s\".", path);
+            goto cleanup;
+        }
+    }
+
+    /* replace the file */
+    if (rename(tmp_path, path) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Renaming \"%s\" failed (%s).", tmp_path,
+                strerror(errno));
+        goto cleanup;
+    }
+    free(tmp_path);
+    tmp_path = NULL;
+
+cleanup:
+    ly_out_free(out, NULL, 0);
+    if (fd > -1) {
+        close(fd);
+    }
+    if (tmp_path) {
+        unlink(tmp_path);
+    }
+    free(tmp_path);
+    return err_info;
+}
+
+#ifdef SR_JSON_DS_SHARDS
+
+/**
+ * @brief Check whether a diff changes instances of a top-level schema node.
+ *
+ * @param[in] mod_diff Module diff.
+ * @param[in] snode Top-level schema node.
+ * @return Whether @p snode data are changed.
+ */
+static int
+srpds_json_shard_changed(const struct lyd_node *mod_diff, const struct lysc_node *snode)
+{
+    const struct lyd_node *node;
+
+    LY_LIST_FOR(mod_diff, node) {
+        if (node->schema == snode) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Store the top-level containers and lists of a datastore file into their own shard files.
+ *
+ * Only the shards with changes in @p mod_diff are rewritten if the data are already sharded.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[in] path Datastore file path.
+ * @param[in] mod_data Module data to store.
+ * @param[in] mod_diff Optional diff of the stored data and @p mod_data.
+ * @param[out] main_data Copy of the rest of the data to store in the datastore file.
+ * @param[out] sharded Whether the data were stored in shards, they must be stored whole otherwise.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_shards_store(const struct lys_module *mod, sr_datastore_t ds, const char *path,
+        const struct lyd_node *mod_data, const struct lyd_node *mod_diff, struct lyd_node **main_data, int *sharded)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *node, *next;
+    struct lyd_node *shard_data = NULL, *dup;
+    struct stat st;
+    char **old_names = NULL, **names = NULL, *manifest = NULL, *shard_path = NULL, *mem;
+    uint32_t i, j, old_count = 0, count = 0;
+    size_t manifest_len = 0;
+    int old_sharded, fallback = 0, changed;
+    void *nmem;
+
+    *main_data = NULL;
+    *sharded = 0;
+
+    /* the shards get the access rights of the datastore file */
+    if (stat(path, &st) == -1) {
+        if (errno == ENOENT) {
+            /* new datastore file, store it whole for now */
+            goto cleanup;
+        }
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    if ((err_info = srpds_json_shards_get(mod, ds, &old_names, &old_count, &old_sharded))) {
+        goto cleanup;
+    }
+    if (!old_sharded) {
+        /* all the shards need to be stored */
+        mod_diff = NULL;
+    }
+
+    for (node = mod_data; node; node = next) {
+        if (!node->schema || !(node->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+            /* stored in the datastore file */
+            if (lyd_dup_single(node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, &dup)) {
+                err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(node));
+                goto cleanup;
+            }
+            lyd_insert_sibling(*main_data, dup, main_data);
+            next = node->next;
+            continue;
+        }
+
+        /* learn the instances of the shard, they are always adjacent */
+        for (next = node; next && (next->schema == node->schema); next = next->next) {}
+
+        nmem = realloc(names, (count + 1) * sizeof *names);
+        if (!nmem) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        names = nmem;
+        names[count] = (char *)node->schema->name;
+        ++count;
+
+        if (mod_diff && !srpds_json_shard_changed(mod_diff, node->schema)) {
+            /* shard not changed */
+            continue;
+        }
+
+        /* copy the shard data and store them */
+        lyd_free_siblings(shard_data);
+        shard_data = NULL;
+        for ( ; node != next; node = node->next) {
+            if (lyd_dup_single(node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, &dup)) {
+                err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(node));
+                goto cleanup;
+            }
+            lyd_insert_sibling(shard_data, dup, &shard_data);
+        }
+
+        free(shard_path);
+        if ((err_info = srpds_json_shard_path(mod, ds, names[count - 1], &shard_path))) {
+            goto cleanup;
+        }
+        if ((err_info = srpds_json_file_replace(shard_path, shard_data, NULL, &st, &fallback)) || fallback) {
+            goto cleanup;
+        }
+    }
+
+    /* generate the manifest */
+    for (i = 0; i < count; ++i) {
+        mem = realloc(manifest, manifest_len + strlen(names[i]) + 2);
+        if (!mem) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        manifest = mem;
+        manifest_len += sprintf(manifest + manifest_len, "%s\n", names[i]);
+    }
+
+    /* store the manifest if changed */
+    changed = (!old_sharded || (old_count != count));
+    for (i = 0; !changed && (i < count); ++i) {
+        changed = strcmp(old_names[i], names[i]);
+    }
+    if (changed) {
+        free(shard_path);
+        if ((err_info = srpds_json_shard_path(mod, ds, NULL, &shard_path))) {
+            goto cleanup;
+        }
+        if ((err_info = srpds_json_file_replace(shard_path, NULL, manifest ? manifest : "", &st, &fallback)) || fallback) {
+            goto cleanup;
+        }
+    }
+
+    /* remove the shards without any data */
+    for (i = 0; i < old_count; ++i) {
+        for (j = 0; (j < count) && strcmp(old_names[i], names[j]); ++j) {}
+        if (j < count) {
+            continue;
+        }
+
+        free(shard_path);
+        if ((err_info = srpds_json_shard_path(mod, ds, old_names[i], &shard_path))) {
+            goto cleanup;
+        }
+        if ((unlink(shard_path) == -1) && (errno != ENOENT)) {
+            SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", shard_path, strerror(errno));
+        }
+    }
+
+    *sharded = 1;
+
+cleanup:
+    if (err_info || !*sharded) {
+        lyd_free_siblings(*main_data);
+        *main_data = NULL;
+    }
+    lyd_free_siblings(shard_data);
+    srpds_json_shards_free(old_names, old_count);
+    free(names);
+    free(manifest);
+    free(shard_path);
+    return err_info;
+}
+
+#endif
+
+#ifdef SR_JSON_DS_OPER_SEGMENTS
+
+/**
+ * @brief Get the CID of the connection that owns a top-level node of an operational edit.
+ *
+ * @param[in] node Top-level edit node.
+ * @return Owner CID, 0 if none.
+ */
+static uint32_t
+srpds_json_oper_cid(const struct lyd_node *node)
+{
+    struct lyd_meta *meta;
+    struct lyd_attr *attr;
+
+    if (node->schema) {
+        /* data node with metadata */
+        meta = lyd_find_meta(node->meta, NULL, "sysrepo:cid");
+        return meta ? meta->value.uint32 : 0;
+    }
+
+    /* opaque node with attributes */
+    LY_LIST_FOR(((struct lyd_node_opaq *)node)->attr, attr) {
+        if (strcmp(attr->name.name, "cid")) {
+            continue;
+        }
+        if ((attr->format == LY_VALUE_XML) && strcmp(attr->name.module_ns, "http://www.sysrepo.org/yang/sysrepo")) {
+            continue;
+        }
+        if ((attr->format == LY_VALUE_JSON) && strcmp(attr->name.module_name, "sysrepo")) {
+            continue;
+        }
+        return strtoul(attr->value, NULL, 10);
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether a segment file holds exactly the printed data.
+ *
+ * @param[in] path Segment file path.
+ * @param[in] buf Printed data.
+ * @param[in] len Length of @p buf.
+ * @return Whether the file does not need to be rewritten.
+ */
+static int
+srpds_json_oper_segment_same(const char *path, const char *buf, size_t len)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *cur = NULL;
+    int fd, same = 0;
+
+    fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+    if (fd == -1) {
+        return 0;
+    }
+    if ((fstat(fd, &st) == -1) || ((size_t)st.st_size != len)) {
+        goto cleanup;
+    }
+
+    cur = malloc(len ? len : 1);
+    if (!cur) {
+        goto cleanup;
+    }
+    if ((err_info = srpjson_read(srpds_name, fd, cur, len))) {
+        srplg_errinfo_free(&err_info);
+        goto cleanup;
+    }
+    same = !memcmp(cur, buf, len);
+
+cleanup:
+    close(fd);
+    free(cur);
+    return same;
+}
+
+/**
+ * @brief Store the top-level nodes of an operational edit into shards, one for the nodes of every connection.
+ *
+ * A shard is rewritten only if the edit nodes of its connection changed so pushing data by a connection does not
+ * rewrite the data of any other connections.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] path Operational datastore file path.
+ * @param[in] mod_data Operational edit to store.
+ * @param[out] main_data Copy of the edit nodes without an owner to store in the datastore file.
+ * @param[out] sharded Whether the edit was stored in shards, it must be stored whole otherwise.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_oper_segments_store(const struct lys_module *mod, const char *path, const struct lyd_node *mod_data,
+        struct lyd_node **main_data, int *sharded)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *snode = NULL;
+    const struct lyd_node *node;
+    struct lyd_node **segs = NULL, *dup;
+    struct ly_out *out = NULL;
+    struct stat st;
+    char **old_names = NULL, **names = NULL, *manifest = NULL, *seg_path = NULL, *buf = NULL, *mem;
+    uint32_t i, j, cid, *cids = NULL, old_count = 0, count = 0;
+    size_t manifest_len = 0;
+    int old_sharded, fallback = 0, changed;
+    void *nmem;
+
+    *main_data = NULL;
+    *sharded = 0;
+
+    /* the order of user-ordered instances owned by different connections would be lost */
+    while ((snode = lys_getnext(snode, NULL, mod->compiled, 0))) {
+        if (lysc_is_userordered(snode)) {
+            goto cleanup;
+        }
+    }
+
+    /* the shards get the access rights of the datastore file */
+    if (stat(path, &st) == -1) {
+        if (errno == ENOENT) {
+            /* new datastore file, store it whole for now */
+            goto cleanup;
+        }
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    if ((err_info = srpds_json_shards_get(mod, SR_DS_OPERATIONAL, &old_names, &old_count, &old_sharded))) {
+        goto cleanup;
+    }
+
+    /* split the edit by the owner connections */
+    LY_LIST_FOR(mod_data, node) {
+        if (lyd_dup_single(node, NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, &dup)) {
+            err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(node));
+            goto cleanup;
+        }
+
+        if (!(cid = srpds_json_oper_cid(node))) {
+            /* stored in the datastore file */
+            lyd_insert_sibling(*main_data, dup, main_data);
+            continue;
+        }
+
+        for (i = 0; (i < count) && (cids[i] != cid); ++i) {}
+        if (i == count) {
+            nmem = realloc(cids, (count + 1) * sizeof *cids);
+            if (!nmem) {
+                lyd_free_tree(dup);
+                srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+                goto cleanup;
+            }
+            cids = nmem;
+            nmem = realloc(segs, (count + 1) * sizeof *segs);
+            if (!nmem) {
+                lyd_free_tree(dup);
+                srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+                goto cleanup;
+            }
+            segs = nmem;
+            cids[count] = cid;
+            segs[count] = NULL;
+            ++count;
+        }
+        lyd_insert_sibling(segs[i], dup, &segs[i]);
+    }
+
+    names = calloc(count, sizeof *names);
+    if (count && !names) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    for (i = 0; i < count; ++i) {
+        if (asprintf(&names[i], "cid-%" PRIu32, cids[i]) == -1) {
+            names[i] = NULL;
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+
+        /* print the shard */
+        ly_out_free(out, NULL, 0);
+        out = NULL;
+        free(buf);
+        buf = NULL;
+        if (ly_out_new_memory(&buf, 0, &out) || lyd_print_all(out, segs[i], SRPDS_FORMAT,
+                LYD_PRINT_SHRINK | LYD_PRINT_KEEPEMPTYCONT | LYD_PRINT_WD_IMPL_TAG)) {
+            err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+            goto cleanup;
+        }
+
+        free(seg_path);
+        if ((err_info = srpds_json_shard_path(mod, SR_DS_OPERATIONAL, names[i], &seg_path))) {
+            goto cleanup;
+        }
+        if (old_sharded && srpds_json_oper_segment_same(seg_path, buf, ly_out_printed(out))) {
+            /* data of this connection not changed */
+            continue;
+        }
+        if ((err_info = srpds_json_file_replace(seg_path, segs[i], NULL, &st, &fallback)) || fallback) {
+            goto cleanup;
+        }
+    }
+
+    /* generate the manifest */
+    for (i = 0; i < count; ++i) {
+        mem = realloc(manifest, manifest_len + strlen(names[i]) + 2);
+        if (!mem) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        manifest = mem;
+        manifest_len += sprintf(manifest + manifest_len, "%s\n", names[i]);
+    }
+
+    /* store the manifest if changed */
+    changed = (!old_sharded || (old_count != count));
+    for (i = 0; !changed && (i < count); ++i) {
+        changed = strcmp(old_names[i], names[i]);
+    }
+    if (changed) {
+        free(seg_path);
+        if ((err_info = srpds_json_shard_path(mod, SR_DS_OPERATIONAL, NULL, &seg_path))) {
+            goto cleanup;
+        }
+        if ((err_info = srpds_json_file_replace(seg_path, NULL, manifest ? manifest : "", &st, &fallback)) || fallback) {
+            goto cleanup;
+        }
+    }
+
+    /* remove the shards of the connections without any data */
+    for (i = 0; i < old_count; ++i) {
+        for (j = 0; (j < count) && strcmp(old_names[i], names[j]); ++j) {}
+        if (j < count) {
+            continue;
+        }
+
+        free(seg_path);
+        if ((err_info = srpds_json_shard_path(mod, SR_DS_OPERATIONAL, old_names[i], &seg_path))) {
+            goto cleanup;
+        }
+        if ((unlink(seg_path) == -1) && (errno != ENOENT)) {
+            SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", seg_path, strerror(errno));
+        }
+    }
+
+    *sharded = 1;
+
+cleanup:
+    if (err_info || !*sharded) {
+        lyd_free_siblings(*main_data);
+        *main_data = NULL;
+    }
+    for (i = 0; i < count; ++i) {
+        lyd_free_siblings(segs[i]);
+    }
+    free(segs);
+    free(cids);
+    srpds_json_shards_free(names, names ? count : 0);
+    srpds_json_shards_free(old_names, old_count);
+    ly_out_free(out, NULL, 0);
+    free(buf);
+    free(manifest);
+    free(seg_path);
+    return err_info;
+}
+
+#endif
+
 static sr_error_info_t *
-srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *mod_data, const char *owner,
-        const char *group, mode_t perm, int make_backup)
+srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *mod_data,
+        const struct lyd_node *mod_diff, const char *owner, const char *group, mode_t perm, int make_backup)
 {
     sr_error_info_t *err_info = NULL;
     struct stat st;
     struct ly_out *out = NULL;
-    char *path = NULL, *bck_path = NULL;
-    int fd = -1, backup = 0, creat = 0;
+    struct lyd_node *main_data = NULL;
+    char *path = NULL, *bck_path = NULL, *jrnl_path = NULL;
+    int fd = -1, backup = 0, creat = 0, sharded = 0, replace = 0, fallback = 0;
     uint32_t print_opts;
 
     /* get path */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -74,6 +1477,77 @@ srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct
             goto cleanup;
         }
 
+        /* the file is replaced by a new one unless it cannot get the same owner, no backup is needed then */
+        replace = 1;
+    }
+
+    if (perm) {
+        /* try to create the file */
+        fd = srpjson_open(srpds_name, path, O_WRONLY | O_CREAT | O_EXCL, perm);
+        if (fd > 0) {
+            creat = 1;
+        }
+    }
+    if ((fd == -1) && !replace) {
+        /* open existing file */
+        fd = srpjson_open(srpds_name, path, O_WRONLY, perm);
+        if (fd == -1) {
+            err_info = srpjson_open_error(srpds_name, path);
+            goto cleanup;
+        }
+    }
+
+    if (creat && (owner || group)) {
+        /* change the owner of the created file */
+        if ((err_info = srpjson_chmodown(srpds_name, path, owner, group, 0))) {
+            goto cleanup;
+        }
+    }
+
+#ifdef SR_JSON_DS_SHARDS
+    if (ds != SR_DS_OPERATIONAL) {
+        if (mod_diff) {
+            /* journaled changes are not stored in the shards yet */
+            if ((err_info = srpds_json_journal_path(mod, ds, &jrnl_path))) {
+                goto cleanup;
+            }
+            if (srpjson_file_exists(srpds_name, jrnl_path)) {
+                mod_diff = NULL;
+            }
+        }
+
+        /* store the top-level subtrees into their own files and only the rest into the datastore file */
+        if ((err_info = srpds_json_shards_store(mod, ds, path, mod_data, mod_diff, &main_data, &sharded))) {
+            goto cleanup;
+        }
+    }
+#else
+    (void)mod_diff;
+#endif
+#ifdef SR_JSON_DS_OPER_SEGMENTS
+    if (ds == SR_DS_OPERATIONAL) {
+        /* store the edit of every connection into its own file and only the rest into the datastore file */
+        if ((err_info = srpds_json_oper_segments_store(mod, path, mod_data, &main_data, &sharded))) {
+            goto cleanup;
+        }
+    }
+#endif
+    if (!sharded && ((ds != SR_DS_OPERATIONAL) || SRPDS_JSON_OPER_SHARDS)) {
+        /* all the data are stored in the datastore file */
+        if ((err_info = srpds_json_shards_remove(mod, ds))) {
+            goto cleanup;
+        }
+    }
+
+    if (replace) {
+        /* write a new file and atomically replace the datastore file with it */
+        if ((err_info = srpds_json_file_replace(path, sharded ? main_data : mod_data, NULL, &st, &fallback))) {
+            goto cleanup;
+        }
+        if (!fallback) {
+            goto journal_remove;
+        }
+
         /* generate the backup path */
         if (asprintf(&bck_path, "%s%s", path, SRPJSON_FILE_BACKUP_SUFFIX) == -1) {
             srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
@@ -97,27 +1571,11 @@ srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct
         if ((err_info = srpjson_cp_path(srpds_name, bck_path, path))) {
             goto cleanup;
         }
-    }
 
-    if (perm) {
-        /* try to create the file */
-        fd = srpjson_open(srpds_name, path, O_WRONLY | O_CREAT | O_EXCL, perm);
-        if (fd > 0) {
-            creat = 1;
-        }
-    }
-    if (fd == -1) {
         /* open existing file */
-        fd = srpjson_open(srpds_name, path, O_WRONLY, perm);
-    }
-    if (fd == -1) {
-        err_info = srpjson_open_error(srpds_name, path);
-        goto cleanup;
-    }
-
-    if (creat && (owner || group)) {
-        /* change the owner of the created file */
-        if ((err_info = srpjson_chmodown(srpds_name, path, owner, group, 0))) {
+        fd = srpjson_open(srpds_name, path, O_WRONLY, 0);
+        if (fd == -1) {
+            err_info = srpjson_open_error(srpds_name, path);
             goto cleanup;
         }
     }
@@ -130,7 +1588,7 @@ srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct
 
     /* print data */
     print_opts = LYD_PRINT_SHRINK | LYD_PRINT_KEEPEMPTYCONT | LYD_PRINT_WD_IMPL_TAG;
-    if (lyd_print_all(out, mod_data, LYD_JSON, print_opts)) {
+    if (lyd_print_all(out, sharded ? main_data : mod_data, SRPDS_FORMAT, print_opts)) {
         err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(mod_data));
         srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_INTERNAL, "Failed to store data into \"%s\".", path);
         goto cleanup;
@@ -143,6 +1601,12 @@ srpds_json_store_(const struct lys_module *mod, sr_datastore_t ds, const struct
         goto cleanup;
     }
 
+journal_remove:
+    /* all the journaled changes are stored now */
+    if ((ds != SR_DS_OPERATIONAL) && (err_info = srpds_json_journal_remove(mod, ds))) {
+        goto cleanup;
+    }
+
 cleanup:
     /* delete the backup file */
     if (backup && (unlink(bck_path) == -1)) {
@@ -159,9 +1623,228 @@ cleanup:
     }
     free(path);
     free(bck_path);
+    free(jrnl_path);
+    lyd_free_siblings(main_data);
+    return err_info;
+}
+
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+
+/**
+ * @brief Print the overlay header for the current running data.
+ *
+ * @param[in] mod Module of the data.
+ * @param[out] hdr Printed header, must be at least ::SRPDS_JSON_JOURNAL_HDR_LEN + 1 long.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_hdr(const struct lys_module *mod, char *hdr)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec mtime;
+
+    /* running data with all their journaled changes */
+    if ((err_info = srpds_json_last_modif(mod, SR_DS_RUNNING, NULL, &mtime))) {
+        return err_info;
+    }
+    srpds_json_journal_hdr(&mtime, hdr);
+    return NULL;
+}
+
+/**
+ * @brief Append a diff of the running data into the overlay of the candidate datastore file.
+ *
+ * The diff is not appended if the overlay would grow larger than both the running data file and
+ * ::SRPJSON_JOURNAL_MIN_SIZE or if the overlay is not usable, the whole candidate data file is expected to be stored.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] mod_diff Diff to append.
+ * @param[out] appended Whether the diff was appended.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_append(const struct lys_module *mod, const struct lyd_node *mod_diff, int *appended)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st, perm_st;
+    char *path = NULL, *ovl_path = NULL, hdr[SRPDS_JSON_JOURNAL_HDR_LEN + 1];
+
+    *appended = 0;
+
+    if ((err_info = srpds_json_get_path(mod, SR_DS_RUNNING, &path))) {
+        goto cleanup;
+    }
+    if (stat(path, &st) == -1) {
+        /* no running data of this plugin to overlay */
+        goto cleanup;
+    }
+
+    /* the overlay has the access rights of the candidate datastore */
+    free(path);
+    if ((err_info = srpds_json_get_perm_path(mod, SR_DS_CANDIDATE, &path))) {
+        goto cleanup;
+    }
+    if (stat(path, &perm_st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+    perm_st.st_size = st.st_size;
+
+    if ((err_info = srpds_json_overlay_path(mod, &ovl_path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_overlay_hdr(mod, hdr))) {
+        goto cleanup;
+    }
+
+    err_info = srpds_json_record_append(ovl_path, hdr, &perm_st, mod_diff, appended);
+
+cleanup:
+    free(path);
+    free(ovl_path);
+    return err_info;
+}
+
+/**
+ * @brief Load the candidate data as the running data with the changes from the overlay applied.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] xpaths Array of XPaths selecting the data.
+ * @param[in] xpath_count Count of @p xpaths.
+ * @param[out] mod_data Loaded module data.
+ * @param[out] loaded Whether there is a usable overlay and the data were loaded.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_load(const struct lys_module *mod, const char **xpaths, uint32_t xpath_count,
+        struct lyd_node **mod_data, int *loaded)
+{
+    sr_error_info_t *err_info = NULL;
+    struct ly_set *top_nodes = NULL;
+    struct lyd_node *next, *node;
+    char *ovl_path = NULL, hdr[SRPDS_JSON_JOURNAL_HDR_LEN + 1], hdr2[SRPDS_JSON_JOURNAL_HDR_LEN + 1];
+    uint32_t parse_opts = LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED | LYD_PARSE_STRICT;
+
+    *mod_data = NULL;
+    *loaded = 0;
+
+    if ((err_info = srpds_json_overlay_path(mod, &ovl_path))) {
+        goto cleanup;
+    }
+    if (!srpjson_file_exists(srpds_name, ovl_path)) {
+        goto cleanup;
+    }
+
+    /* load the running data the overlay is for */
+    if ((err_info = srpds_json_overlay_hdr(mod, hdr))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_load(mod, SR_DS_RUNNING, xpaths, xpath_count, NULL, mod_data))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_overlay_hdr(mod, hdr2))) {
+        goto cleanup;
+    }
+    if (strcmp(hdr, hdr2)) {
+        /* running data changed while loading them */
+        goto cleanup;
+    }
+
+    if (xpath_count) {
+        /* only the selected top-level nodes are needed */
+        srpds_json_load_top_nodes(mod, xpaths, xpath_count, &top_nodes);
+    }
+
+    /* apply the candidate changes */
+    if ((err_info = srpds_json_record_apply(mod, ovl_path, hdr, top_nodes, parse_opts, mod_data, loaded))) {
+        goto cleanup;
+    }
+
+    if (*loaded && top_nodes) {
+        /* changes were applied only to the selected nodes, drop the rest */
+        LY_LIST_FOR_SAFE(*mod_data, next, node) {
+            if (!ly_set_contains(top_nodes, (void *)node->schema, NULL)) {
+                if (node == *mod_data) {
+                    *mod_data = next;
+                }
+                lyd_free_tree(node);
+            }
+        }
+    }
+
+cleanup:
+    if (err_info || !*loaded) {
+        lyd_free_all(*mod_data);
+        *mod_data = NULL;
+    }
+    free(ovl_path);
+    ly_set_free(top_nodes, NULL);
+    return err_info;
+}
+
+/**
+ * @brief Store the candidate data from the overlay into the candidate datastore file before the running data change.
+ *
+ * @param[in] mod Module of the data.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_overlay_materialize(const struct lys_module *mod)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *mod_data = NULL;
+    struct stat st;
+    char *path = NULL;
+    int loaded, fallback = 0;
+    mode_t perm;
+
+    /* candidate data with the applied overlay */
+    if ((err_info = srpds_json_overlay_load(mod, NULL, 0, &mod_data, &loaded))) {
+        goto cleanup;
+    }
+    if (!loaded) {
+        /* no overlay, or a stale one */
+        goto remove;
+    }
+
+    /* the candidate datastore file appears atomically for the concurrent readers */
+    if ((err_info = srpds_json_get_perm_path(mod, SR_DS_CANDIDATE, &path))) {
+        goto cleanup;
+    }
+    if (stat(path, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+    free(path);
+    if ((err_info = srpds_json_get_path(mod, SR_DS_CANDIDATE, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_file_replace(path, mod_data, NULL, &st, &fallback))) {
+        goto cleanup;
+    }
+    if (fallback) {
+        /* the file could not get the owner of the candidate datastore, create it in place */
+        perm = st.st_mode & 0007777;
+        if ((err_info = srpds_json_store_(mod, SR_DS_CANDIDATE, mod_data, NULL, NULL, NULL, perm, 0))) {
+            goto cleanup;
+        }
+    }
+
+remove:
+    err_info = srpds_json_overlay_remove(mod);
+
+cleanup:
+    free(path);
+    lyd_free_siblings(mod_data);
     return err_info;
 }
 
+#endif
+
 /**
  * @brief Initialize persistent datastore file.
  *
@@ -181,7 +1864,7 @@ srpds_json_install_persistent(const struct lys_module *mod, sr_datastore_t ds, c
     char *path = NULL;
 
     /* check whether the file does not exist */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
     if (srpjson_file_exists(srpds_name, path)) {
@@ -190,7 +1873,7 @@ srpds_json_install_persistent(const struct lys_module *mod, sr_datastore_t ds, c
     }
 
     /* print empty file to store permissions */
-    if ((err_info = srpds_json_store_(mod, ds, NULL, owner, group, perm, 0))) {
+    if ((err_info = srpds_json_store_(mod, ds, NULL, NULL, owner, group, perm, 0))) {
         goto cleanup;
     }
 
@@ -225,7 +1908,7 @@ srpds_json_install(const struct lys_module *mod, sr_datastore_t ds, const char *
 
     /* get path to the perm file */
     free(path);
-    if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_perm_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -257,7 +1940,7 @@ srpds_json_uninstall(const struct lys_module *mod, sr_datastore_t ds, void *UNUS
     char *path = NULL;
 
     /* unlink data file */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
     if ((unlink(path) == -1) && ((errno != ENOENT) || (ds == SR_DS_STARTUP) || (ds == SR_DS_FACTORY_DEFAULT))) {
@@ -265,6 +1948,17 @@ srpds_json_uninstall(const struct lys_module *mod, sr_datastore_t ds, void *UNUS
         SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", path, strerror(errno));
     }
 
+    /* unlink journal and shards */
+    if ((err_info = srpds_json_journal_remove(mod, ds))) {
+        goto cleanup;
+    }
+    if (((ds != SR_DS_OPERATIONAL) || SRPDS_JSON_OPER_SHARDS) && (err_info = srpds_json_shards_remove(mod, ds))) {
+        goto cleanup;
+    }
+    if ((ds == SR_DS_CANDIDATE) && (err_info = srpds_json_overlay_remove(mod))) {
+        goto cleanup;
+    }
+
     if ((ds == SR_DS_STARTUP) || (ds == SR_DS_FACTORY_DEFAULT)) {
         /* done */
         goto cleanup;
@@ -272,7 +1966,7 @@ srpds_json_uninstall(const struct lys_module *mod, sr_datastore_t ds, void *UNUS
 
     /* unlink perm file */
     free(path);
-    if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_perm_path(mod, ds, &path))) {
         goto cleanup;
     }
     if (unlink(path) == -1) {
@@ -308,7 +2002,7 @@ srpds_json_init(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(pl
     }
 
     /* get path to the file */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -318,8 +2012,8 @@ srpds_json_init(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(pl
         goto cleanup;
     }
 
-    /* print empty JSON file */
-    if (lyd_print_fd(fd, NULL, LYD_JSON, LYD_PRINT_SHRINK)) {
+    /* print empty data file */
+    if (lyd_print_fd(fd, NULL, SRPDS_FORMAT, LYD_PRINT_SHRINK)) {
         err_info = srpjson_log_err_ly(srpds_name, NULL);
         goto cleanup;
     }
@@ -351,12 +2045,22 @@ srpds_json_conn_destroy(sr_conn_ctx_t *UNUSED(conn), void *UNUSED(plg_data))
 }
 
 static sr_error_info_t *
-srpds_json_store(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *UNUSED(mod_diff),
+srpds_json_store(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *mod_diff,
         const struct lyd_node *mod_data, void *UNUSED(plg_data))
 {
     sr_error_info_t *err_info = NULL;
     mode_t perm = 0;
     char *path = NULL;
+#if defined (SR_JSON_DS_JOURNAL) || defined (SR_JSON_DS_CANDIDATE_OVERLAY)
+    int appended;
+#endif
+
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    if ((ds == SR_DS_RUNNING) && (err_info = srpds_json_overlay_materialize(mod))) {
+        /* the overlay is valid only for the current running data */
+        goto cleanup;
+    }
+#endif
 
     switch (ds) {
     case SR_DS_STARTUP:
@@ -369,29 +2073,114 @@ srpds_json_store(const struct lys_module *mod, sr_datastore_t ds, const struct l
     case SR_DS_CANDIDATE:
     case SR_DS_OPERATIONAL:
         /* get data file path */
-        if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_path(mod, ds, &path))) {
+            goto cleanup;
+        }
+
+        if (srpjson_file_exists(srpds_name, path)) {
+            /* file exists */
+            break;
+        }
+
+        /* get the correct permissions to set for the new file (not owner/group because we may not have permissions to set them) */
+        if ((err_info = srpds_json_access_get(mod, ds, NULL, NULL, NULL, &perm))) {
+            goto cleanup;
+        }
+        break;
+    }
+
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    if ((ds == SR_DS_CANDIDATE) && perm && mod_diff && (LYD_CTX(mod_diff) == mod->ctx)) {
+        /* candidate data are the running data with the changes appended into the overlay, unless it grew too large */
+        if ((err_info = srpds_json_overlay_append(mod, mod_diff, &appended))) {
+            goto cleanup;
+        }
+        if (appended) {
+            goto cleanup;
+        }
+    }
+#endif
+
+#ifdef SR_JSON_DS_JOURNAL
+    if (!perm && mod_diff && (LYD_CTX(mod_diff) == mod->ctx)) {
+        /* only append the changes to the existing file, unless the journal grew too large */
+        if ((err_info = srpds_json_journal_append(mod, ds, mod_diff, &appended))) {
+            goto cleanup;
+        }
+        if (appended) {
+            goto cleanup;
+        }
+    }
+#endif
+
+    /* store */
+    if ((err_info = srpds_json_store_(mod, ds, mod_data, perm ? NULL : mod_diff, NULL, NULL, perm, 1))) {
+        goto cleanup;
+    }
+
+    /* all the candidate changes are stored in the candidate datastore file */
+    if ((ds == SR_DS_CANDIDATE) && (err_info = srpds_json_overlay_remove(mod))) {
+        goto cleanup;
+    }
+
+cleanup:
+    free(path);
+    return err_info;
+}
+
+/**
+ * @brief Copy a datastore file into another existing one, with the journaled changes.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] trg_ds Target datastore.
+ * @param[in] trg_path Target datastore file path.
+ * @param[in] src_ds Source datastore.
+ * @param[in] src_path Source datastore file path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_copy_path(const struct lys_module *mod, sr_datastore_t trg_ds, const char *trg_path, sr_datastore_t src_ds,
+        const char *src_path)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *mod_data = NULL;
+    char *jrnl_path = NULL, *shards_path = NULL;
+
+    if ((err_info = srpds_json_journal_path(mod, src_ds, &jrnl_path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_json_shard_path(mod, src_ds, NULL, &shards_path))) {
+        goto cleanup;
+    }
+
+    if (srpjson_file_exists(srpds_name, jrnl_path) || srpjson_file_exists(srpds_name, shards_path)) {
+        /* the journal and shards are valid only for the source file, store the data with the changes applied */
+        if ((err_info = srpds_json_load(mod, src_ds, NULL, 0, NULL, &mod_data))) {
             goto cleanup;
         }
-
-        if (srpjson_file_exists(srpds_name, path)) {
-            /* file exists */
-            break;
+        if ((err_info = srpds_json_store_(mod, trg_ds, mod_data, NULL, NULL, NULL, 0, 0))) {
+            goto cleanup;
         }
-
-        /* get the correct permissions to set for the new file (not owner/group because we may not have permissions to set them) */
-        if ((err_info = srpds_json_access_get(mod, ds, NULL, NULL, NULL, &perm))) {
+    } else {
+        /* copy contents of source to target */
+        if ((err_info = srpjson_cp_path(srpds_name, trg_path, src_path))) {
             goto cleanup;
         }
-        break;
-    }
 
-    /* store */
-    if ((err_info = srpds_json_store_(mod, ds, mod_data, NULL, NULL, perm, 1))) {
-        goto cleanup;
+        /* target journaled changes and shards are overwritten */
+        if ((err_info = srpds_json_journal_remove(mod, trg_ds))) {
+            goto cleanup;
+        }
+        if ((err_info = srpds_json_shards_remove(mod, trg_ds))) {
+            goto cleanup;
+        }
     }
 
 cleanup:
-    free(path);
+    free(jrnl_path);
+    free(shards_path);
+    lyd_free_all(mod_data);
     return err_info;
 }
 
@@ -399,11 +2188,11 @@ static void
 srpds_json_recover(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data))
 {
     sr_error_info_t *err_info = NULL;
-    char *path = NULL, *bck_path = NULL;
+    char *path = NULL, *bck_path = NULL, *jrnl_path = NULL;
     struct lyd_node *mod_data = NULL;
 
     /* get path */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -415,15 +2204,25 @@ srpds_json_recover(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED
     srplg_errinfo_free(&err_info);
 
     if (ds == SR_DS_STARTUP) {
-        /* there must be a backup file for startup data */
-        SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" startup data from a backup.", mod->name);
-
         /* generate the backup path */
         if (asprintf(&bck_path, "%s%s", path, SRPJSON_FILE_BACKUP_SUFFIX) == -1) {
             srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
             goto cleanup;
         }
 
+        if ((err_info = srpds_json_journal_path(mod, ds, &jrnl_path))) {
+            goto cleanup;
+        }
+        if (!srpjson_file_exists(srpds_name, bck_path) && srpjson_file_exists(srpds_name, jrnl_path)) {
+            /* the data file was not being stored so the journal must be corrupted */
+            SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" startup data by removing the corrupted journal.", mod->name);
+            err_info = srpds_json_journal_remove(mod, ds);
+            goto cleanup;
+        }
+
+        /* there must be a backup file for startup data */
+        SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" startup data from a backup.", mod->name);
+
         /* restore the backup data, avoid changing permissions of the target file */
         if ((err_info = srpjson_cp_path(srpds_name, path, bck_path))) {
             goto cleanup;
@@ -434,17 +2233,27 @@ srpds_json_recover(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED
             srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Unlinking \"%s\" failed (%s).", bck_path, strerror(errno));
             goto cleanup;
         }
+
+        /* the journaled changes were not stored yet and are for the restored data */
+        if ((err_info = srpds_json_journal_rebase(mod, ds))) {
+            goto cleanup;
+        }
     } else if (ds == SR_DS_RUNNING) {
         /* perform startup->running data file copy */
         SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" running data from the startup data.", mod->name);
 
         /* generate the startup data file path */
-        if ((err_info = srpjson_get_path(srpds_name, mod->name, SR_DS_STARTUP, &bck_path))) {
+        if ((err_info = srpds_json_get_path(mod, SR_DS_STARTUP, &bck_path))) {
             goto cleanup;
         }
 
         /* copy startup data to running */
-        if ((err_info = srpjson_cp_path(srpds_name, path, bck_path))) {
+        if ((err_info = srpds_json_copy_path(mod, ds, path, SR_DS_STARTUP, bck_path))) {
+            goto cleanup;
+        }
+
+        /* the candidate changes were for the corrupted running data */
+        if ((err_info = srpds_json_overlay_remove(mod))) {
             goto cleanup;
         }
     } else {
@@ -452,38 +2261,371 @@ srpds_json_recover(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED
         SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" %s data by removing the corrupted data file.", mod->name,
                 srpjson_ds2str(ds));
 
-        if (unlink(path) == -1) {
+        if ((unlink(path) == -1) && ((errno != ENOENT) || (ds != SR_DS_CANDIDATE))) {
+            /* only the candidate overlay may be corrupted */
             srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Unlinking \"%s\" failed (%s).", path,
                     strerror(errno));
             goto cleanup;
         }
+        if ((err_info = srpds_json_journal_remove(mod, ds))) {
+            goto cleanup;
+        }
+        if ((err_info = srpds_json_shards_remove(mod, ds))) {
+            goto cleanup;
+        }
+        if ((ds == SR_DS_CANDIDATE) && (err_info = srpds_json_overlay_remove(mod))) {
+            goto cleanup;
+        }
     }
 
 cleanup:
     free(path);
     free(bck_path);
+    free(jrnl_path);
     lyd_free_all(mod_data);
     srplg_errinfo_free(&err_info);
 }
 
+/**
+ * @brief Learn the top-level nodes of a module that the data selected by XPaths can be in.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] xpaths Array of XPaths selecting the data.
+ * @param[in] xpath_count Count of @p xpaths.
+ * @param[out] top_nodes Set of the top-level schema nodes, NULL if all the module data may be needed.
+ */
+static void
+srpds_json_load_top_nodes(const struct lys_module *mod, const char **xpaths, uint32_t xpath_count,
+        struct ly_set **top_nodes)
+{
+    struct ly_set *set = NULL, *tops = NULL;
+    const struct lysc_node *snode;
+    uint32_t i, j, temp_lo = LY_LOSTORE;
+
+    *top_nodes = NULL;
+
+    ly_temp_log_options(&temp_lo);
+
+    if (ly_set_new(&tops)) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < xpath_count; ++i) {
+        /* learn the schema nodes the XPath uses */
+        if (lys_find_xpath_atoms(mod->ctx, NULL, xpaths[i], LYS_FIND_NO_MATCH_ERROR, &set)) {
+            goto cleanup;
+        }
+
+        for (j = 0; j < set->count; ++j) {
+            snode = set->snodes[j];
+            if (snode->module->ctx != mod->ctx) {
+                /* mounted data, the whole mount point is needed */
+                goto cleanup;
+            }
+
+            /* top-level data node */
+            while (lysc_data_parent(snode)) {
+                snode = lysc_data_parent(snode);
+            }
+            if ((snode->module != mod) || (snode->nodetype & (LYS_RPC | LYS_NOTIF))) {
+                continue;
+            }
+
+            if (ly_set_add(tops, (void *)snode, 0, NULL)) {
+                goto cleanup;
+            }
+        }
+
+        ly_set_free(set, NULL);
+        set = NULL;
+    }
+
+    if (tops->count) {
+        /* success */
+        *top_nodes = tops;
+        tops = NULL;
+    }
+
+cleanup:
+    ly_temp_log_options(NULL);
+    ly_set_free(set, NULL);
+    ly_set_free(tops, NULL);
+}
+
+/**
+ * @brief Skip JSON whitespace.
+ *
+ * @param[in] ptr Current position.
+ * @param[in] end End of the JSON data.
+ * @return First non-whitespace position.
+ */
+static const char *
+srpds_json_skip_ws(const char *ptr, const char *end)
+{
+    while ((ptr < end) && ((*ptr == ' ') || (*ptr == '\t') || (*ptr == '\n') || (*ptr == '\r'))) {
+        ++ptr;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Skip a JSON string.
+ *
+ * @param[in] ptr Opening quote of the string.
+ * @param[in] end End of the JSON data.
+ * @return Position after the closing quote, NULL if the string is not terminated.
+ */
+static const char *
+srpds_json_skip_str(const char *ptr, const char *end)
+{
+    for (++ptr; ptr < end; ++ptr) {
+        if (*ptr == '\\') {
+            ++ptr;
+        } else if (*ptr == '"') {
+            return ptr + 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Skip a JSON value.
+ *
+ * @param[in] ptr Start of the value.
+ * @param[in] end End of the JSON data.
+ * @return Position after the value, NULL if the value is not valid.
+ */
+static const char *
+srpds_json_skip_value(const char *ptr, const char *end)
+{
+    uint32_t depth = 0;
+
+    if (ptr == end) {
+        return NULL;
+    } else if (*ptr == '"') {
+        return srpds_json_skip_str(ptr, end);
+    } else if ((*ptr != '{') && (*ptr != '[')) {
+        /* number or a literal */
+        while ((ptr < end) && (*ptr != ',') && (*ptr != '}') && (*ptr != ']') && (*ptr != ' ') && (*ptr != '\t') &&
+                (*ptr != '\n') && (*ptr != '\r')) {
+            ++ptr;
+        }
+        return ptr;
+    }
+
+    /* object or array */
+    while (ptr < end) {
+        if (*ptr == '"') {
+            if (!(ptr = srpds_json_skip_str(ptr, end))) {
+                return NULL;
+            }
+            continue;
+        }
+
+        if ((*ptr == '{') || (*ptr == '[')) {
+            ++depth;
+        } else if ((*ptr == '}') || (*ptr == ']')) {
+            if (!--depth) {
+                return ptr + 1;
+            }
+        }
+        ++ptr;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Check whether a top-level JSON member is one of the selected top-level nodes.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] name Member name, not terminated.
+ * @param[in] name_len Length of @p name.
+ * @param[in] top_nodes Selected top-level schema nodes.
+ * @return Whether the member is selected.
+ */
+static int
+srpds_json_member_selected(const struct lys_module *mod, const char *name, size_t name_len,
+        const struct ly_set *top_nodes)
+{
+    size_t mod_len = strlen(mod->name);
+    uint32_t i;
+
+    if (name_len && (name[0] == '@')) {
+        /* metadata of a top-level node */
+        ++name;
+        --name_len;
+    }
+
+    /* top-level nodes are always qualified */
+    if ((name_len <= mod_len) || strncmp(name, mod->name, mod_len) || (name[mod_len] != ':')) {
+        return 0;
+    }
+    name += mod_len + 1;
+    name_len -= mod_len + 1;
+
+    for (i = 0; i < top_nodes->count; ++i) {
+        if (!strncmp(top_nodes->snodes[i]->name, name, name_len) && !top_nodes->snodes[i]->name[name_len]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse only selected top-level nodes from a JSON datastore file.
+ *
+ * The top-level members of the file are only scanned and the selected ones parsed, which avoids building
+ * the data tree of the whole module.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] fd File descriptor of the file.
+ * @param[in] path Path of the file.
+ * @param[in] top_nodes Selected top-level schema nodes.
+ * @param[in] parse_opts Parse options.
+ * @param[out] mod_data Parsed module data.
+ * @param[out] parsed Whether the data were parsed, not set if the file could not be scanned.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_json_load_top_nodes_parse(const struct lys_module *mod, int fd, const char *path, const struct ly_set *top_nodes,
+        uint32_t parse_opts, struct lyd_node **mod_data, int *parsed)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    const char *data = NULL, *end, *ptr, *member;
+    char *buf = NULL, *mem;
+    size_t buf_len = 0, len;
+
+    *parsed = 0;
+
+    if (fstat(fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+    if (!st.st_size) {
+        goto cleanup;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Mapping \"%s\" failed (%s).", path, strerror(errno));
+        data = NULL;
+        goto cleanup;
+    }
+    end = data + st.st_size;
+
+    /* top-level object */
+    ptr = srpds_json_skip_ws(data, end);
+    if ((ptr == end) || (*ptr != '{')) {
+        goto cleanup;
+    }
+    ptr = srpds_json_skip_ws(ptr + 1, end);
+
+    buf = malloc(2);
+    if (!buf) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    buf[buf_len++] = '{';
+
+    /* scan all the members and copy the selected ones */
+    while ((ptr < end) && (*ptr != '}')) {
+        member = ptr;
+        if ((*ptr != '"') || !(ptr = srpds_json_skip_str(ptr, end))) {
+            goto cleanup;
+        }
+        len = (ptr - 1) - (member + 1);
+        ptr = srpds_json_skip_ws(ptr, end);
+        if ((ptr == end) || (*ptr != ':')) {
+            goto cleanup;
+        }
+        if (!(ptr = srpds_json_skip_value(srpds_json_skip_ws(ptr + 1, end), end))) {
+            goto cleanup;
+        }
+
+        if (srpds_json_member_selected(mod, member + 1, len, top_nodes)) {
+            len = ptr - member;
+            mem = realloc(buf, buf_len + len + 2);
+            if (!mem) {
+                srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+                goto cleanup;
+            }
+            buf = mem;
+
+            memcpy(buf + buf_len, member, len);
+            buf_len += len;
+            buf[buf_len++] = ',';
+        }
+
+        ptr = srpds_json_skip_ws(ptr, end);
+        if ((ptr < end) && (*ptr == ',')) {
+            ptr = srpds_json_skip_ws(ptr + 1, end);
+        }
+    }
+    if (ptr == end) {
+        goto cleanup;
+    }
+
+    /* replace the last comma, if any */
+    if (buf[buf_len - 1] == ',') {
+        --buf_len;
+    }
+    buf[buf_len++] = '}';
+    buf[buf_len] = '\0';
+
+    /* parse the selected members */
+    if (lyd_parse_data_mem(mod->ctx, buf, LYD_JSON, parse_opts, 0, mod_data)) {
+        err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+        goto cleanup;
+    }
+    *parsed = 1;
+
+cleanup:
+    if (data) {
+        munmap((void *)data, st.st_size);
+    }
+    free(buf);
+    return err_info;
+}
+
 static sr_error_info_t *
-srpds_json_load(const struct lys_module *mod, sr_datastore_t ds, const char **UNUSED(xpaths), uint32_t UNUSED(xpath_count),
+srpds_json_load(const struct lys_module *mod, sr_datastore_t ds, const char **xpaths, uint32_t xpath_count,
         void *UNUSED(plg_data), struct lyd_node **mod_data)
 {
     sr_error_info_t *err_info = NULL;
-    int fd = -1;
-    char *path = NULL;
-    uint32_t parse_opts;
+    struct ly_set *top_nodes = NULL;
+    struct lyd_node *next, *node;
+    int fd = -1, parsed = 0, sharded = 0;
+    char *path = NULL, **shards = NULL;
+    uint32_t parse_opts, shard_count = 0;
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    int loaded;
+#endif
 
     *mod_data = NULL;
 
     /* prepare correct file path */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
     /* open fd */
     fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    if ((fd == -1) && (errno == ENOENT) && (ds == SR_DS_CANDIDATE)) {
+        /* the candidate changes may be only in the overlay of the running data */
+        if ((err_info = srpds_json_overlay_load(mod, xpaths, xpath_count, mod_data, &loaded))) {
+            goto cleanup;
+        }
+        if (loaded) {
+            goto cleanup;
+        }
+
+        /* the overlay may have been stored into the candidate datastore file meanwhile */
+        fd = srpjson_open(srpds_name, path, O_RDONLY, 0);
+    }
+#endif
     if (fd == -1) {
         if (errno == ENOENT) {
             switch (ds) {
@@ -521,17 +2663,68 @@ srpds_json_load(const struct lys_module *mod, sr_datastore_t ds, const char **UN
         parse_opts |= LYD_PARSE_WHEN_TRUE | LYD_PARSE_NO_NEW;
     }
 
+    if ((ds != SR_DS_OPERATIONAL) || SRPDS_JSON_OPER_SHARDS) {
+        /* learn whether some top-level nodes (or the edits of some connections) are stored in shards */
+        if ((err_info = srpds_json_shards_get(mod, ds, &shards, &shard_count, &sharded))) {
+            goto cleanup;
+        }
+    }
+
+    if (xpath_count && (ds != SR_DS_OPERATIONAL) && (sharded || (SRPDS_FORMAT == LYD_JSON))) {
+        /* only some top-level nodes may be needed, the JSON text can be scanned for them or only their shards read */
+        srpds_json_load_top_nodes(mod, xpaths, xpath_count, &top_nodes);
+    }
+    if (top_nodes && !sharded && (SRPDS_FORMAT == LYD_JSON)) {
+        /* load only the data of these nodes */
+        if ((err_info = srpds_json_load_top_nodes_parse(mod, fd, path, top_nodes, parse_opts, mod_data, &parsed))) {
+            goto cleanup;
+        }
+    }
+
     /* load the data */
-    if (lyd_parse_data_fd(mod->ctx, fd, LYD_JSON, parse_opts, 0, mod_data)) {
+    if (!parsed && lyd_parse_data_fd(mod->ctx, fd, SRPDS_FORMAT, parse_opts |
+            ((SRPDS_FORMAT == LYD_LYB) ? SRPDS_LYB_PARSE_OPTS : 0), 0, mod_data)) {
         err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
         goto cleanup;
     }
 
+    if (sharded && top_nodes) {
+        /* journaled changes are applied only to the selected nodes, drop the rest */
+        LY_LIST_FOR_SAFE(*mod_data, next, node) {
+            if (!ly_set_contains(top_nodes, (void *)node->schema, NULL)) {
+                if (node == *mod_data) {
+                    *mod_data = next;
+                }
+                lyd_free_tree(node);
+            }
+        }
+    }
+    if (sharded) {
+        /* the main file holds only the small top-level nodes, add the selected shards */
+        if ((err_info = srpds_json_shards_load(mod, ds, shards, shard_count, top_nodes, parse_opts, mod_data))) {
+            goto cleanup;
+        }
+    }
+
+    if (ds != SR_DS_OPERATIONAL) {
+        /* apply the journaled changes */
+        if ((err_info = srpds_json_journal_replay(mod, ds, fd, (parsed || sharded) ? top_nodes : NULL, parse_opts,
+                mod_data))) {
+            goto cleanup;
+        }
+    }
+
 cleanup:
     if (fd > -1) {
         close(fd);
     }
+    if (err_info) {
+        lyd_free_all(*mod_data);
+        *mod_data = NULL;
+    }
     free(path);
+    srpds_json_shards_free(shards, shard_count);
+    ly_set_free(top_nodes, NULL);
     return err_info;
 }
 
@@ -543,8 +2736,15 @@ srpds_json_copy(const struct lys_module *mod, sr_datastore_t trg_ds, sr_datastor
     char *src_path = NULL, *trg_path = NULL, *owner = NULL, *group = NULL;
     mode_t perm = 0;
 
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    if ((trg_ds == SR_DS_RUNNING) && (err_info = srpds_json_overlay_materialize(mod))) {
+        /* the overlay is valid only for the current running data */
+        goto cleanup;
+    }
+#endif
+
     /* target path */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, trg_ds, &trg_path))) {
+    if ((err_info = srpds_json_get_path(mod, trg_ds, &trg_path))) {
         goto cleanup;
     }
 
@@ -580,12 +2780,12 @@ srpds_json_copy(const struct lys_module *mod, sr_datastore_t trg_ds, sr_datastor
     }
 
     /* source path */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, src_ds, &src_path))) {
+    if ((err_info = srpds_json_get_path(mod, src_ds, &src_path))) {
         goto cleanup;
     }
 
     /* copy contents of source to target */
-    if ((err_info = srpjson_cp_path(srpds_name, trg_path, src_path))) {
+    if ((err_info = srpds_json_copy_path(mod, trg_ds, trg_path, src_ds, src_path))) {
         goto cleanup;
     }
 
@@ -607,7 +2807,7 @@ srpds_json_candidate_modified(const struct lys_module *mod, void *UNUSED(plg_dat
     char *path = NULL;
 
     /* candidate DS file cannot exist */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, SR_DS_CANDIDATE, &path))) {
+    if ((err_info = srpds_json_get_path(mod, SR_DS_CANDIDATE, &path))) {
         goto cleanup;
     }
 
@@ -618,6 +2818,17 @@ srpds_json_candidate_modified(const struct lys_module *mod, void *UNUSED(plg_dat
         *modified = 0;
     }
 
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+    if (!*modified) {
+        /* or only the changes of the running data are stored in the overlay */
+        free(path);
+        if ((err_info = srpds_json_overlay_path(mod, &path))) {
+            goto cleanup;
+        }
+        *modified = srpjson_file_exists(srpds_name, path);
+    }
+#endif
+
 cleanup:
     free(path);
     return err_info;
@@ -629,7 +2840,7 @@ srpds_json_candidate_reset(const struct lys_module *mod, void *UNUSED(plg_data))
     sr_error_info_t *err_info = NULL;
     char *path;
 
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, SR_DS_CANDIDATE, &path))) {
+    if ((err_info = srpds_json_get_path(mod, SR_DS_CANDIDATE, &path))) {
         return err_info;
     }
 
@@ -638,7 +2849,13 @@ srpds_json_candidate_reset(const struct lys_module *mod, void *UNUSED(plg_data))
     }
     free(path);
 
-    return NULL;
+    if ((err_info = srpds_json_journal_remove(mod, SR_DS_CANDIDATE))) {
+        return err_info;
+    }
+    if ((err_info = srpds_json_overlay_remove(mod))) {
+        return err_info;
+    }
+    return srpds_json_shards_remove(mod, SR_DS_CANDIDATE);
 }
 
 static sr_error_info_t *
@@ -652,7 +2869,7 @@ srpds_json_access_set(const struct lys_module *mod, sr_datastore_t ds, const cha
     assert(mod && (owner || group || perm));
 
     /* get correct path to the datastore file */
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -675,6 +2892,32 @@ srpds_json_access_set(const struct lys_module *mod, sr_datastore_t ds, const cha
         goto cleanup;
     }
 
+    /* journal has the same access rights */
+    free(path);
+    if ((err_info = srpds_json_journal_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if (srpjson_file_exists(srpds_name, path) && (err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+        goto cleanup;
+    }
+
+    /* and so do the shards */
+    if (((ds != SR_DS_OPERATIONAL) || SRPDS_JSON_OPER_SHARDS) &&
+            (err_info = srpds_json_shards_chmodown(mod, ds, owner, group, perm))) {
+        goto cleanup;
+    }
+
+    /* and the candidate overlay */
+    if (ds == SR_DS_CANDIDATE) {
+        free(path);
+        if ((err_info = srpds_json_overlay_path(mod, &path))) {
+            goto cleanup;
+        }
+        if (srpjson_file_exists(srpds_name, path) && (err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+            goto cleanup;
+        }
+    }
+
     switch (ds) {
     case SR_DS_STARTUP:
     case SR_DS_FACTORY_DEFAULT:
@@ -685,7 +2928,7 @@ srpds_json_access_set(const struct lys_module *mod, sr_datastore_t ds, const cha
     case SR_DS_OPERATIONAL:
         /* volatile datastore permission file */
         free(path);
-        if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_perm_path(mod, ds, &path))) {
             goto cleanup;
         }
 
@@ -721,14 +2964,14 @@ srpds_json_access_get(const struct lys_module *mod, sr_datastore_t ds, void *UNU
     switch (ds) {
     case SR_DS_STARTUP:
     case SR_DS_FACTORY_DEFAULT:
-        if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_path(mod, ds, &path))) {
             return err_info;
         }
         break;
     case SR_DS_RUNNING:
     case SR_DS_CANDIDATE:
     case SR_DS_OPERATIONAL:
-        if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_perm_path(mod, ds, &path))) {
             return err_info;
         }
         break;
@@ -787,14 +3030,14 @@ srpds_json_access_check(const struct lys_module *mod, sr_datastore_t ds, void *U
     switch (ds) {
     case SR_DS_STARTUP:
     case SR_DS_FACTORY_DEFAULT:
-        if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_path(mod, ds, &path))) {
             goto cleanup;
         }
         break;
     case SR_DS_RUNNING:
     case SR_DS_CANDIDATE:
     case SR_DS_OPERATIONAL:
-        if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, &path))) {
+        if ((err_info = srpds_json_get_perm_path(mod, ds, &path))) {
             goto cleanup;
         }
         break;
@@ -842,7 +3085,7 @@ srpds_json_last_modif(const struct lys_module *mod, sr_datastore_t ds, void *UNU
     char *path = NULL;
     struct stat st;
 
-    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, &path))) {
+    if ((err_info = srpds_json_get_path(mod, ds, &path))) {
         goto cleanup;
     }
 
@@ -852,8 +3095,36 @@ srpds_json_last_modif(const struct lys_module *mod, sr_datastore_t ds, void *UNU
         /* the file may not exist */
         mtime->tv_sec = 0;
         mtime->tv_nsec = 0;
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+        if (ds == SR_DS_CANDIDATE) {
+            /* candidate data in the overlay are modified with the running data they are for */
+            free(path);
+            if ((err_info = srpds_json_overlay_path(mod, &path))) {
+                goto cleanup;
+            }
+            if (stat(path, &st) == 0) {
+                if ((err_info = srpds_json_last_modif(mod, SR_DS_RUNNING, NULL, mtime))) {
+                    goto cleanup;
+                }
+                if (srpjson_time_cmp(&st.st_mtim, mtime) > 0) {
+                    *mtime = st.st_mtim;
+                }
+            }
+        }
+#endif
+        goto cleanup;
     } else {
         srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    /* changes appended into the journal */
+    free(path);
+    if ((err_info = srpds_json_journal_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((stat(path, &st) == 0) && (srpjson_time_cmp(&st.st_mtim, mtime) > 0)) {
+        *mtime = st.st_mtim;
     }
 
 cleanup:
@@ -861,7 +3132,7 @@ cleanup:
     return err_info;
 }
 
-const struct srplg_ds_s srpds_json = {
+const struct srplg_ds_s SRPDS_PLUGIN = {
     .name = srpds_name,
     .install_cb = srpds_json_install,
     .uninstall_cb = srpds_json_uninstall,
@@ -0,0 +1,28 @@
+/**
+ * @file ds_lyb.c
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief internal LYB datastore plugin
+ *
+ * @copyright
+ * Copyright (c) 2021 - 2023 Deutsche Telekom AG.
+ * Copyright (c) 2021 - 2023 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/*
+ * The plugin is the JSON DS file plugin storing the data in the binary LYB format, which is parsed without
+ * resolving the values from their canonical strings again. The files have their own suffix so that the data
+ * of a module can be migrated between the plugins by changing the datastore plugin of the module.
+ */
+
+#define srpds_name "LYB DS file"   /**< plugin name */
+#define SRPDS_FORMAT LYD_LYB       /**< format of the data files */
+#define SRPDS_FILE_SUFFIX ".lyb"   /**< suffix appended to all the files */
+#define SRPDS_PLUGIN srpds_lyb     /**< plugin structure */
+
+#include "ds_json.c"
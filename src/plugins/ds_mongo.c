@@ -1054,11 +1054,17 @@ srpds_load_conv(mongoc_collection_t *module, const struct lys_module *mod, sr_da
     struct lyd_node *new_node = NULL, *parent_node = NULL;
 
     struct lyd_node **parent_nodes = NULL, **tmp_pnodes = NULL;
-    size_t pnodes_size = 1;
+    size_t pnodes_size = 1, uo_idx = 0;
     uint32_t node_idx = 0, i, j;
     struct lys_module *node_module = NULL;
 
-    opts = BCON_NEW("sort", "{", "path_modif", BCON_INT32(1), "}");
+    /* the documents are sorted so that parents always precede their children and nodes are created in document order
+     * using the parent stack, skip the trailing fields used only for sorting and storing and get them in batches */
+    opts = BCON_NEW("sort", "{", "path_modif", BCON_INT32(1), "}",
+            "projection", "{", "path_modif", BCON_INT32(0), "prev", BCON_INT32(0), "}");
+    if (SR_DS_PLG_MONGO_LOAD_BATCH_SIZE) {
+        BSON_APPEND_INT32(opts, "batchSize", SR_DS_PLG_MONGO_LOAD_BATCH_SIZE);
+    }
     cursor = mongoc_collection_find_with_opts(module, xpath_filter, opts, NULL);
 
     /*
@@ -1327,22 +1333,32 @@ srpds_load_conv(mongoc_collection_t *module, const struct lys_module *mod, sr_da
         /* store nodes and their orders of userordered lists and leaflists for final ordering */
         if ((type == MONGO_LY_LIST_UO) || (type == MONGO_LY_LEAFLIST_UO)) {
             uo_found = 0;
-            for (i = 0; i < uo_lists.size; ++i) {
+
+            /* instances of one list are mostly adjacent in document order, try the last list first */
+            if ((uo_idx < uo_lists.size) && !strcmp(uo_lists.lists[uo_idx].name, path_no_pred)) {
+                uo_found = 1;
+            }
+            for (i = 0; !uo_found && (i < uo_lists.size); ++i) {
                 if (!strcmp(uo_lists.lists[i].name, path_no_pred)) {
                     uo_found = 1;
-                    size = uo_lists.lists[i].size;
-                    data = realloc(uo_lists.lists[i].data, (size + 1) * sizeof *data);
+                    uo_idx = i;
+                }
+            }
+            if (uo_found) {
+                size = uo_lists.lists[uo_idx].size;
+                if (!(size & (size - 1))) {
+                    /* grow the array exponentially, whenever the size reaches a power of 2 */
+                    data = realloc(uo_lists.lists[uo_idx].data, (size * 2) * sizeof *data);
                     if (!data) {
                         ERRINFO(&err_info, SR_ERR_NO_MEMORY, "realloc()", "")
                         goto cleanup;
                     }
-                    uo_lists.lists[i].data = data;
-                    uo_lists.lists[i].data[size].ptr = new_node;
-                    uo_lists.lists[i].data[size].order = order;
-                    uo_lists.lists[i].size = size + 1;
+                    uo_lists.lists[uo_idx].data = data;
                 }
-            }
-            if (!uo_found) {
+                uo_lists.lists[uo_idx].data[size].ptr = new_node;
+                uo_lists.lists[uo_idx].data[size].order = order;
+                uo_lists.lists[uo_idx].size = size + 1;
+            } else {
                 size = uo_lists.size;
                 if (size) {
                     list = realloc(uo_lists.lists, (size + 1) * sizeof *list);
@@ -1375,6 +1391,7 @@ srpds_load_conv(mongoc_collection_t *module, const struct lys_module *mod, sr_da
                 uo_lists.lists[size].data[0].ptr = new_node;
                 uo_lists.lists[size].data[0].order = order;
                 uo_lists.lists[size].size = 1;
+                uo_idx = size;
             }
         }
 
@@ -1599,21 +1616,19 @@ srpds_add_operation(bson_t *bson_query, struct mongo_diff_inner_data *inner)
 }
 
 /**
- * @brief Update the maximum order of a list or a leaf-list in the database.
+ * @brief Update the maximum order of a list or a leaf-list in the database, together with the rest of the diff.
  *
- * @param[in] module Given MongoDB collection.
  * @param[in] path_no_pred Path of a list/leaf-list instance without a predicate.
  * @param[in] max_order Maximum order to store.
+ * @param[out] diff_data Helper structure for storing diff operations.
  * @return NULL on success;
  * @return Sysrepo error info on error.
  */
 static sr_error_info_t *
-srpds_update_maxord(mongoc_collection_t *module, const char *path_no_pred, uint64_t max_order)
+srpds_update_maxord(const char *path_no_pred, uint64_t max_order, struct mongo_diff_data *diff_data)
 {
     sr_error_info_t *err_info = NULL;
-    bson_error_t error;
     char *final_path = NULL;
-    bson_t *bson_query = NULL, *bson_query_key = NULL;
 
     /* update only if max_order has been changed
      * aka is different from zero */
@@ -1626,20 +1641,18 @@ srpds_update_maxord(mongoc_collection_t *module, const char *path_no_pred, uint6
         }
 
         /* selector for replace command */
-        bson_query_key = BCON_NEW("_id", BCON_UTF8(final_path));
+        if ((err_info = srpds_add_operation(BCON_NEW("_id", BCON_UTF8(final_path)), &(diff_data->rep_keys)))) {
+            goto cleanup;
+        }
 
         /* replace command */
-        bson_query = BCON_NEW("$set", "{", "value", BCON_INT64(max_order), "}");
-        if (!mongoc_collection_update_one(module, bson_query_key, bson_query, NULL, NULL, &error)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_update_one()", error.message)
+        if ((err_info = srpds_add_operation(BCON_NEW("$set", "{", "value", BCON_INT64(max_order), "}"), &(diff_data->rep)))) {
             goto cleanup;
         }
     }
 
 cleanup:
     free(final_path);
-    bson_destroy(bson_query_key);
-    bson_destroy(bson_query);
     return err_info;
 }
 
@@ -1942,94 +1955,136 @@ cleanup:
 }
 
 /**
- * @brief If there is only one point order gap between elements where newly created element
- *          should be placed, shifting has to be done, e.g. 1  3  {4}   [5]  8  13
- *                                                                    *
- *                                                                    |
- *                                                                new element
- *                                                                    |
-*                                                                     *
- *                                                          1  3  {4} 5 [6]  8  13
+ * @brief If there is no free order between elements where newly created element should be placed,
+ *          the smallest aligned order window around the previous element that is sparse enough is respaced, e.g.
+ *          window [0, 31]:  3  {4}  [5]   9  20   |  40
+ *                                  *
+ *                                  |
+ *                             new element
+ *                                  |
+ *                                  *
+ *                           4  {8}  12  [16] 20  24   |  40
+ *          Larger windows must be sparser so that the elements are respaced only rarely
+ *          and an insert costs only a few writes on average.
+ *
  * @param[in] module Given MongoDB collection.
  * @param[in] path_no_pred Path of a list/leaf-list instance without a predicate.
- * @param[in] next_elem_order Order of the next element.
- * @param[out] max_order Changed maximum order (shifting can change maximum order).
+ * @param[in] prev_order Order of the previous element, 0 if there is none.
+ * @param[in,out] max_order Changed maximum order (respacing can change maximum order).
+ * @param[out] order Free order for the new element.
  * @return NULL on success;
  * @return Sysrepo error info on error.
  */
 static sr_error_info_t *
-srpds_shift_uo_list_recursively(mongoc_collection_t *module, const char *path_no_pred, uint64_t next_elem_order, uint64_t *max_order)
+srpds_respace_uo_list(mongoc_collection_t *module, const char *path_no_pred, uint64_t prev_order, uint64_t *max_order,
+        uint64_t *order)
 {
-    sr_error_info_t *err_info = 0;
-    int found = 0;
+    sr_error_info_t *err_info = NULL;
     bson_error_t error;
     mongoc_cursor_t *cursor = NULL;
-    bson_t *doc = NULL, *doc2 = NULL, *bson_query_key = NULL,
-            *bson_query_rep = NULL;
+    const bson_t *doc;
+    bson_t *filter = NULL, *opts = NULL, *bson_query_key = NULL, *bson_query_rep = NULL;
     bson_iter_t iter;
-    const char *path = NULL;
+    const char *path;
+    uint64_t lo = 0, size, gap = 0, elem_order, new_order, pos;
+    int64_t count = 0;
+    uint32_t shift;
+    int placed;
 
     if ((err_info = srpds_get_maxord(module, path_no_pred, max_order))) {
         goto cleanup;
     }
 
-    if (*max_order < next_elem_order) {
-        *max_order = next_elem_order;
-    }
-
-    /* find the next element */
-    doc = BCON_NEW("order", BCON_INT64(next_elem_order), "path_no_pred", BCON_UTF8(path_no_pred));
-    cursor = mongoc_collection_find_with_opts(module, doc, NULL, NULL);
+    for (shift = 1; shift < 63; ++shift) {
+        size = (uint64_t)1 << shift;
+        lo = prev_order & ~(size - 1);
 
-    if (mongoc_cursor_next(cursor, (const bson_t **) &doc2)) {
-        found = 1;
-
-        if (!bson_iter_init(&iter, doc2)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "bson_iter_init()", "")
+        /* count the elements in the window */
+        bson_destroy(filter);
+        filter = BCON_NEW("path_no_pred", BCON_UTF8(path_no_pred), "order", "{", "$gte", BCON_INT64((int64_t)lo),
+                "$lte", BCON_INT64((int64_t)(lo + (size - 1))), "}");
+        count = mongoc_collection_count_documents(module, filter, NULL, NULL, NULL, &error);
+        if (count < 0) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_count_documents()", error.message)
             goto cleanup;
         }
 
-        /* get path of the next element */
-        if (!bson_iter_next(&iter)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "bson_iter_next()", "")
+        /* the window is sparse enough if the gaps between its elements and the new element are at least
+         * square root of its size */
+        gap = size / (count + 2);
+        if (gap >= ((uint64_t)1 << (shift / 2))) {
+            break;
+        }
+    }
+    if (shift == 63) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Respacing user-ordered list", "No free order")
+        goto cleanup;
+    }
+
+    /* respace all the elements in the window, the new element is placed after the previous element */
+    opts = BCON_NEW("sort", "{", "order", BCON_INT32(1), "}", "projection", "{", "order", BCON_INT32(1), "}");
+    cursor = mongoc_collection_find_with_opts(module, filter, opts, NULL);
+
+    placed = 0;
+    pos = 1;
+    while (mongoc_cursor_next(cursor, &doc)) {
+        if (!bson_iter_init_find(&iter, doc, "_id")) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "bson_iter_init_find()", "")
             goto cleanup;
         }
         path = bson_iter_utf8(&iter, NULL);
-        if (!bson_utf8_validate(path, strlen(path), 0)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "bson_iter_utf8()", "")
+        if (!bson_iter_init_find(&iter, doc, "order")) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "bson_iter_init_find()", "")
             goto cleanup;
         }
-    }
+        elem_order = bson_iter_int64(&iter);
 
-    if (mongoc_cursor_error(cursor, &error)) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_find_with_opts()", error.message)
-        goto cleanup;
-    }
+        if (!placed && (elem_order > prev_order)) {
+            *order = lo + gap * pos;
+            ++pos;
+            placed = 1;
+        }
 
-    if (found) {
-        /* An element with such order has been found, shift all elements
-         * after this element */
-        if ((err_info = srpds_shift_uo_list_recursively(module, path_no_pred, next_elem_order + 1, max_order))) {
-            goto cleanup;
+        new_order = lo + gap * pos;
+        ++pos;
+        if (new_order == elem_order) {
+            continue;
         }
 
         /* change order of this element,
          * selector for replace command */
+        bson_destroy(bson_query_key);
         bson_query_key = BCON_NEW("_id", BCON_UTF8(path));
 
         /* replace command */
-        bson_query_rep = BCON_NEW("$set", "{", "order", BCON_INT64(next_elem_order + 1), "}");
+        bson_destroy(bson_query_rep);
+        bson_query_rep = BCON_NEW("$set", "{", "order", BCON_INT64((int64_t)new_order), "}");
         if (!mongoc_collection_update_one(module, bson_query_key, bson_query_rep, NULL, NULL, &error)) {
             ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_update_one()", error.message)
             goto cleanup;
         }
     }
 
+    if (mongoc_cursor_error(cursor, &error)) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_find_with_opts()", error.message)
+        goto cleanup;
+    }
+
+    if (!placed) {
+        *order = lo + gap * pos;
+    }
+
+    /* the last order in the window may be the new maximum order */
+    if (*max_order < lo + gap * (count + 1)) {
+        *max_order = lo + gap * (count + 1);
+    }
+
 cleanup:
-    bson_destroy(doc);
-    mongoc_cursor_destroy(cursor);
+    bson_destroy(filter);
+    bson_destroy(opts);
     bson_destroy(bson_query_key);
     bson_destroy(bson_query_rep);
+    mongoc_cursor_destroy(cursor);
     return err_info;
 }
 
@@ -2082,14 +2137,11 @@ srpds_create_uo_op(mongoc_collection_t *module, struct lyd_node *node, const cha
             /* calculate order */
             order = *max_order;
         } else if (next_order - prev_order == 1) {
-            /* shift the next elements by one recursively */
-            if ((err_info = srpds_shift_uo_list_recursively(module, path_no_pred, next_order, max_order))) {
+            /* no free order, respace the elements around */
+            if ((err_info = srpds_respace_uo_list(module, path_no_pred, prev_order, max_order, &order))) {
                 goto cleanup;
             }
 
-            /* calculate order */
-            order = next_order;
-
             /* add new prev element to the next element,
              * selector for replace command */
             bson_query_uo_key = BCON_NEW("prev", BCON_UTF8(prev_pred), "path_no_pred", BCON_UTF8(path_no_pred));
@@ -2136,14 +2188,11 @@ srpds_create_uo_op(mongoc_collection_t *module, struct lyd_node *node, const cha
             /* calculate order */
             order = 1000;
         } else if (next_order == 1) {
-            /* shift next elements by one recursively */
-            if ((err_info = srpds_shift_uo_list_recursively(module, path_no_pred, next_order, max_order))) {
+            /* no free order, respace the first elements */
+            if ((err_info = srpds_respace_uo_list(module, path_no_pred, 0, max_order, &order))) {
                 goto cleanup;
             }
 
-            /* calculate order */
-            order = next_order;
-
             /* add new prev element to the next element,
              * selector for replace command */
             bson_query_uo_key = BCON_NEW("prev", BCON_UTF8(prev_pred), "path_no_pred", BCON_UTF8(path_no_pred));
@@ -2731,7 +2780,7 @@ srpds_load_diff_recursively(mongoc_collection_t *module, const struct lyd_node *
         if (lysc_is_userordered(sibling->schema) && ((sibling->next &&
                 (sibling->schema->name != sibling->next->schema->name)) || !(sibling->next))) {
             /* update max order for lists and leaf-lists */
-            if ((err_info = srpds_update_maxord(module, path_no_pred, max_order))) {
+            if ((err_info = srpds_update_maxord(path_no_pred, max_order, diff_data))) {
                 goto cleanup;
             }
             max_order = 0;
@@ -2775,6 +2824,8 @@ srpds_store_all(mongoc_collection_t *module, const struct lyd_node *mod_diff)
 {
     sr_error_info_t *err_info = NULL;
     bson_error_t error;
+    bson_t reply;
+    mongoc_bulk_operation_t *bulk = NULL;
     struct mongo_diff_data diff_data;
     uint32_t i;
 
@@ -2786,31 +2837,44 @@ srpds_store_all(mongoc_collection_t *module, const struct lyd_node *mod_diff)
         goto cleanup;
     }
 
-    if (diff_data.cre.idx) {
-        if (!mongoc_collection_insert_many(module, (const bson_t **)diff_data.cre.docs,
-                diff_data.cre.idx, NULL, NULL, &error)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_insert_many()", error.message)
+    if (!diff_data.cre.idx && !diff_data.rep.idx && !diff_data.del.idx) {
+        /* nothing to store */
+        goto cleanup;
+    }
+
+    /* all the operations are sent in a single bulk operation, it must be ordered because
+     * the replace operations may change the default flags of the created nodes */
+    bulk = mongoc_collection_create_bulk_operation_with_opts(module, NULL);
+
+    for (i = 0; i < diff_data.cre.idx; ++i) {
+        if (!mongoc_bulk_operation_insert_with_opts(bulk, (const bson_t *)(diff_data.cre.docs)[i], NULL, &error)) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_bulk_operation_insert_with_opts()", error.message)
             goto cleanup;
         }
     }
 
     for (i = 0; i < diff_data.rep.idx; ++i) {
-        if (!mongoc_collection_update_one(module, (const bson_t *)(diff_data.rep_keys.docs)[i],
-                (const bson_t *)(diff_data.rep.docs)[i], NULL, NULL, &error)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_update_one()", error.message)
+        if (!mongoc_bulk_operation_update_one_with_opts(bulk, (const bson_t *)(diff_data.rep_keys.docs)[i],
+                (const bson_t *)(diff_data.rep.docs)[i], NULL, &error)) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_bulk_operation_update_one_with_opts()", error.message)
             goto cleanup;
         }
     }
 
     for (i = 0; i < diff_data.del.idx; ++i) {
-        if (!mongoc_collection_delete_one(module, (const bson_t *)(diff_data.del.docs)[i],
-                NULL, NULL, &error)) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_collection_delete_one()", error.message)
+        if (!mongoc_bulk_operation_remove_one_with_opts(bulk, (const bson_t *)(diff_data.del.docs)[i], NULL, &error)) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_bulk_operation_remove_one_with_opts()", error.message)
             goto cleanup;
         }
     }
 
+    if (!mongoc_bulk_operation_execute(bulk, &reply, &error)) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "mongoc_bulk_operation_execute()", error.message)
+    }
+    bson_destroy(&reply);
+
 cleanup:
+    mongoc_bulk_operation_destroy(bulk);
     srpds_diff_data_destroy(&diff_data);
     return err_info;
 }
@@ -17,11 +17,13 @@
 #define _GNU_SOURCE
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <grp.h>
 #include <pthread.h>
 #include <pwd.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,19 +42,20 @@
 
 #define plugin_name "REDIS DS"
 
-#define ERRINFO(err, type, func, message) srplg_log_errinfo(err, plugin_name, NULL, type, func " failed on %d in %s [%s].", __LINE__, __FILE__, message);
+/* maximum number of pipelined commands with unread replies */
+#define SRPDS_PIPE_MAX 1024
+
+/* number of results read at once using a cursor */
+#define SRPDS_CURSOR_COUNT "1000"
 
-/* context should be different for each thread */
-typedef struct redis_thread_data_s {
-    redisContext *ctx;
-    pthread_t id;
-} redis_thread_data_t;
+#define ERRINFO(err, type, func, message) srplg_log_errinfo(err, plugin_name, NULL, type, func " failed on %d in %s [%s].", __LINE__, __FILE__, message);
 
-/* pool of connections */
+/* pool of connections, a context is checked out by a thread for a single callback so that threads never share it */
 typedef struct redis_plg_conn_data_s {
-    pthread_rwlock_t lock;
-    redis_thread_data_t *conn_pool;
-    uint32_t size;
+    pthread_mutex_t lock;
+    redisContext **conn_pool;   /* idle contexts */
+    uint32_t size;              /* count of idle contexts */
+    uint32_t alloc;             /* allocated size of the pool */
 } redis_plg_conn_data_t;
 
 /* types of commands */
@@ -61,6 +64,99 @@ typedef enum rds_command_s {
     RDS_CMD_COPY
 } rds_command_t;
 
+/* count of the pipelined commands with unread replies, every thread has its own context */
+static _Thread_local uint32_t srpds_pipe_pending;
+
+/**
+ * @brief Read the replies of all the pipelined commands.
+ *
+ * Must be called before any other command is executed in the context.
+ *
+ * @param[in] ctx Redis context.
+ * @param[in] zero_err Whether a zero integer reply is an error.
+ * @return NULL on success;
+ * @return Sysrepo error info of the first failed command.
+ */
+static sr_error_info_t *
+srpds_pipe_flush(redisContext *ctx, int zero_err)
+{
+    sr_error_info_t *err_info = NULL;
+    redisReply *reply;
+
+    while (srpds_pipe_pending) {
+        if (redisGetReply(ctx, (void **)&reply) != REDIS_OK) {
+            /* no more replies can be read */
+            if (!err_info) {
+                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "redisGetReply()", ctx->errstr)
+            }
+            srpds_pipe_pending = 0;
+            break;
+        }
+        --srpds_pipe_pending;
+
+        if (!err_info && ((reply->type == REDIS_REPLY_ERROR) || (zero_err && !reply->integer))) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Pipelined command", reply->str ? reply->str : "")
+        }
+        freeReplyObject(reply);
+    }
+
+    return err_info;
+}
+
+/**
+ * @brief Read the replies of all the pipelined commands, even on an error.
+ *
+ * @param[in] ctx Redis context.
+ * @param[in] zero_err Whether a zero integer reply is an error.
+ * @param[in,out] err_info Error info to set on a failed command if not set yet.
+ */
+static void
+srpds_pipe_finish(redisContext *ctx, int zero_err, sr_error_info_t **err_info)
+{
+    sr_error_info_t *err_info2;
+
+    err_info2 = srpds_pipe_flush(ctx, zero_err);
+    if (*err_info) {
+        srplg_errinfo_free(&err_info2);
+    } else {
+        *err_info = err_info2;
+    }
+}
+
+/**
+ * @brief Pipeline a command, its reply is read later by ::srpds_pipe_flush().
+ *
+ * @param[in] ctx Redis context.
+ * @param[in] zero_err Whether a zero integer reply is an error.
+ * @param[in] format Format of the command.
+ * @param[in] ... Format arguments.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_pipe_append(redisContext *ctx, int zero_err, const char *format, ...)
+{
+    sr_error_info_t *err_info = NULL;
+    va_list ap;
+    int r;
+
+    va_start(ap, format);
+    r = redisvAppendCommand(ctx, format, ap);
+    va_end(ap);
+    if (r != REDIS_OK) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "redisvAppendCommand()", ctx->errstr)
+        return err_info;
+    }
+    ++srpds_pipe_pending;
+
+    if (srpds_pipe_pending == SRPDS_PIPE_MAX) {
+        /* limit the size of the output buffer */
+        err_info = srpds_pipe_flush(ctx, zero_err);
+    }
+
+    return err_info;
+}
+
 /**
  * @brief Get the prefix for the given datastore.
  *
@@ -87,10 +183,10 @@ srpds_ds2dsprefix(sr_datastore_t ds)
 }
 
 /**
- * @brief Initialize plugin connection data.
+ * @brief Check out a Redis context from the pool of plugin connection data, create a new one if none is idle.
  *
  * @param[in,out] pdata Plugin connection data.
- * @param[out] ctx Retrieved Redis context.
+ * @param[out] ctx Retrieved Redis context, must be returned using ::srpds_data_destroy().
  * @return NULL on success;
  * @return Sysrepo error info on error.
  */
@@ -100,94 +196,123 @@ srpds_data_init(redis_plg_conn_data_t *pdata, redisContext **ctx)
     sr_error_info_t *err_info = NULL;
     redisContext *rds_ctx = NULL;
     redisReply *reply = NULL;
-    redis_thread_data_t *new_pool = NULL;
-    int found = 0;
 
     *ctx = NULL;
 
-    /* PLUGIN DATA RDLOCK */
-    pthread_rwlock_rdlock(&pdata->lock);
+    /* PLUGIN DATA LOCK */
+    pthread_mutex_lock(&pdata->lock);
 
-    /* find redis context in the existing connection */
-    for (uint32_t i = 0; i < pdata->size; ++i) {
-        if (pdata->conn_pool[i].id == pthread_self()) {
-            *ctx = pdata->conn_pool[i].ctx;
-            found = 1;
-            break;
-        }
+    /* take an idle context */
+    if (pdata->size) {
+        *ctx = pdata->conn_pool[--pdata->size];
     }
 
     /* PLUGIN DATA UNLOCK */
-    pthread_rwlock_unlock(&pdata->lock);
-
-    if (!found) {
-        /* context not found, so create one */
-        rds_ctx = redisConnect(SR_DS_PLG_REDIS_HOST, SR_DS_PLG_REDIS_PORT);
-        if ((rds_ctx == NULL) || rds_ctx->err) {
-            if (rds_ctx) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "redisConnect()", rds_ctx->errstr)
-                goto cleanup;
-            } else {
-                ERRINFO(&err_info, SR_ERR_NO_MEMORY, "redisConnect()", "Could not allocate Redis context")
-                goto cleanup;
-            }
-        }
+    pthread_mutex_unlock(&pdata->lock);
 
-        /* authenticate if needed */
-        if (strlen(SR_DS_PLG_REDIS_USERNAME)) {
-            reply = redisCommand(rds_ctx, "AUTH " SR_DS_PLG_REDIS_USERNAME " " SR_DS_PLG_REDIS_PASSWORD);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_UNAUTHORIZED, "Authentication", reply->str)
-                goto cleanup;
-            }
-            freeReplyObject(reply);
-        }
-
-        /* PLUGIN DATA WRLOCK */
-        pthread_rwlock_wrlock(&pdata->lock);
-
-        new_pool = realloc(pdata->conn_pool, (sizeof *new_pool) * (pdata->size + 1));
-        if (!new_pool) {
-            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "realloc()", "")
-
-            /* PLUGIN DATA UNLOCK */
-            pthread_rwlock_unlock(&pdata->lock);
+    if (*ctx) {
+        return NULL;
+    }
 
+    /* no idle context, so create one */
+    rds_ctx = redisConnect(SR_DS_PLG_REDIS_HOST, SR_DS_PLG_REDIS_PORT);
+    if ((rds_ctx == NULL) || rds_ctx->err) {
+        if (rds_ctx) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "redisConnect()", rds_ctx->errstr)
+            goto cleanup;
+        } else {
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "redisConnect()", "Could not allocate Redis context")
             goto cleanup;
         }
+    }
 
-        pdata->conn_pool = new_pool;
-        pdata->conn_pool[pdata->size].ctx = rds_ctx;
-        pdata->conn_pool[pdata->size].id = pthread_self();
-        pdata->size = pdata->size + 1;
-        *ctx = rds_ctx;
-
-        /* PLUGIN DATA UNLOCK */
-        pthread_rwlock_unlock(&pdata->lock);
-
-        /* set necessary configuration */
-        reply = redisCommand(*ctx, "FT.CONFIG SET MAXAGGREGATERESULTS -1");
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting MAXAGGREGATERESULTS option", reply->str)
+    /* authenticate if needed */
+    if (strlen(SR_DS_PLG_REDIS_USERNAME)) {
+        reply = redisCommand(rds_ctx, "AUTH " SR_DS_PLG_REDIS_USERNAME " " SR_DS_PLG_REDIS_PASSWORD);
+        if (!reply) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Authentication", rds_ctx->errstr)
+            goto cleanup;
+        } else if (reply->type == REDIS_REPLY_ERROR) {
+            ERRINFO(&err_info, SR_ERR_UNAUTHORIZED, "Authentication", reply->str)
             goto cleanup;
         }
         freeReplyObject(reply);
+    }
 
-        reply = redisCommand(*ctx, "FT.CONFIG SET MAXEXPANSIONS 1000000000000");
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting MAXEXPANSIONS option", reply->str)
-            goto cleanup;
-        }
+    /* set necessary configuration */
+    reply = redisCommand(rds_ctx, "FT.CONFIG SET MAXAGGREGATERESULTS -1");
+    if (!reply || (reply->type == REDIS_REPLY_ERROR)) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting MAXAGGREGATERESULTS option", reply ? reply->str : rds_ctx->errstr)
+        goto cleanup;
     }
+    freeReplyObject(reply);
+
+    reply = redisCommand(rds_ctx, "FT.CONFIG SET MAXEXPANSIONS 1000000000000");
+    if (!reply || (reply->type == REDIS_REPLY_ERROR)) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting MAXEXPANSIONS option", reply ? reply->str : rds_ctx->errstr)
+        goto cleanup;
+    }
+
+    *ctx = rds_ctx;
+    rds_ctx = NULL;
 
 cleanup:
-    if (err_info && rds_ctx) {
+    if (rds_ctx) {
         redisFree(rds_ctx);
     }
     freeReplyObject(reply);
     return err_info;
 }
 
+/**
+ * @brief Return a Redis context checked out using ::srpds_data_init() into the pool of plugin connection data.
+ *
+ * @param[in,out] pdata Plugin connection data.
+ * @param[in] ctx Redis context, is freed if broken or if it cannot be returned.
+ */
+static void
+srpds_data_destroy(redis_plg_conn_data_t *pdata, redisContext *ctx)
+{
+    sr_error_info_t *err_info;
+    redisContext **new_pool;
+
+    if (!ctx) {
+        return;
+    }
+
+    if (!ctx->err && srpds_pipe_pending) {
+        /* replies of a failed callback, the context must be reusable */
+        err_info = srpds_pipe_flush(ctx, 0);
+        srplg_errinfo_free(&err_info);
+    }
+    if (ctx->err) {
+        /* the connection is broken, a new one will be created */
+        srpds_pipe_pending = 0;
+        redisFree(ctx);
+        return;
+    }
+
+    /* PLUGIN DATA LOCK */
+    pthread_mutex_lock(&pdata->lock);
+
+    if (pdata->size == pdata->alloc) {
+        new_pool = realloc(pdata->conn_pool, (pdata->alloc + 1) * sizeof *new_pool);
+        if (!new_pool) {
+            /* PLUGIN DATA UNLOCK */
+            pthread_mutex_unlock(&pdata->lock);
+
+            redisFree(ctx);
+            return;
+        }
+        pdata->conn_pool = new_pool;
+        ++pdata->alloc;
+    }
+    pdata->conn_pool[pdata->size++] = ctx;
+
+    /* PLUGIN DATA UNLOCK */
+    pthread_mutex_unlock(&pdata->lock);
+}
+
 /**
  * @brief Get data prefix.
  *
@@ -411,21 +536,14 @@ static sr_error_info_t *
 srpds_set_maxord(redisContext *ctx, const char *mod_ns, const char *path_no_pred, uint64_t max_order)
 {
     sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
 
     /* update only if max_order has been changed
      * aka is different from zero */
     if (max_order) {
         /* update maximum order of the list */
-        reply = redisCommand(ctx, "HSET %s:meta:%s value %" PRIu64, mod_ns, path_no_pred, max_order);
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Changing maximum order", reply->str)
-            goto cleanup;
-        }
+        err_info = srpds_pipe_append(ctx, 0, "HSET %s:meta:%s value %" PRIu64, mod_ns, path_no_pred, max_order);
     }
 
-cleanup:
-    freeReplyObject(reply);
     return err_info;
 }
 
@@ -460,6 +578,10 @@ srpds_get_maxord(redisContext *ctx, const char *mod_ns, const char *path_no_pred
     redisReply *reply = NULL;
 
     if (*out_max_order == 0) {
+        if ((err_info = srpds_pipe_flush(ctx, 0))) {
+            goto cleanup;
+        }
+
         /* get maximum order of the list */
         reply = redisCommand(ctx, "HGET %s:meta:%s value", mod_ns, path_no_pred);
         if (reply->type == REDIS_REPLY_ERROR) {
@@ -492,6 +614,10 @@ srpds_load_prev(redisContext *ctx, const char *mod_ns, const char *prev, const c
     sr_error_info_t *err_info = NULL;
     redisReply *reply = NULL;
 
+    if ((err_info = srpds_pipe_flush(ctx, 0))) {
+        goto cleanup;
+    }
+
     reply = redisCommand(ctx, "HGET %s:data:%s%s order", mod_ns, path_no_pred, prev);
     if (reply->type == REDIS_REPLY_ERROR) {
         ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Getting order of the previous node", reply->str)
@@ -594,6 +720,11 @@ srpds_load_next(redisContext *ctx, const char *mod_ns, const char *prev, const c
     args_array[4] = "1";
     args_array[5] = "order";
 
+    /* the previous changes must be applied */
+    if ((err_info = srpds_pipe_flush(ctx, 0))) {
+        goto cleanup;
+    }
+
     reply = redisCommandArgv(ctx, argnum, (const char **)args_array, NULL);
     if (reply->type == REDIS_REPLY_ERROR) {
         ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
@@ -622,39 +753,47 @@ cleanup:
 }
 
 /**
- * @brief If there is only one point order gap between elements where newly created element
- *          should be placed, shifting has to be done, e.g. 1  3  {4}   [5]  8  13
- *                                                                    *
- *                                                                    |
- *                                                                new element
- *                                                                    |
- *                                                                    *
- *                                                          1  3  {4} 5 [6]  8  13
+ * @brief If there is no free order between elements where newly created element should be placed,
+ *          the smallest aligned order window around the previous element that is sparse enough is respaced, e.g.
+ *          window [0, 31]:  3  {4}  [5]   9  20   |  40
+ *                                  *
+ *                                  |
+ *                             new element
+ *                                  |
+ *                                  *
+ *                           4  {8}  12  [16] 20  24   |  40
+ *          Larger windows must be sparser so that the elements are respaced only rarely
+ *          and an insert costs only a few writes on average.
+ *
  * @param[in] ctx Redis context
  * @param[in] mod_ns Database prefix for the module.
  * @param[in] path_no_pred Path of a list/leaf-list instance without a predicate.
- * @param[in] next_elem_order Order of the next element.
- * @param[out] max_order Changed maximum order (shifting can change maximum order).
+ * @param[in] prev_order Order of the previous element, 0 if there is none.
+ * @param[in,out] max_order Changed maximum order (respacing can change maximum order).
+ * @param[out] order Free order for the new element.
  * @return NULL on success;
  * @return Sysrepo error info on error.
  */
 static sr_error_info_t *
-srpds_shift_uo_list_recursively(redisContext *ctx, const char *mod_ns, const char *path_no_pred, uint64_t next_elem_order, uint64_t *max_order)
+srpds_respace_uo_list(redisContext *ctx, const char *mod_ns, const char *path_no_pred, uint64_t prev_order,
+        uint64_t *max_order, uint64_t *order)
 {
     sr_error_info_t *err_info = NULL;
-    int argnum = 6;
-    redisReply *reply = NULL, *reply2 = NULL;
+    int argnum = 14;
+    redisReply *reply = NULL, *row;
     char *arg = NULL, *args_array[argnum], *path_no_pred_escaped = NULL;
+    const char *key;
+    uint64_t lo, size, gap, elem_order, new_order;
+    uint32_t i, k, count, pos, shift;
+    int placed;
+
+    args_array[1] = NULL;
+    args_array[2] = NULL;
 
     if ((err_info = srpds_get_maxord(ctx, mod_ns, path_no_pred, max_order))) {
         goto cleanup;
     }
 
-    /* in case of overflow, update maxorder */
-    if (*max_order < next_elem_order) {
-        *max_order = next_elem_order;
-    }
-
     /* escape all special characters so that query is valid */
     if ((err_info = srpds_escape_string(path_no_pred, &path_no_pred_escaped))) {
         goto cleanup;
@@ -666,48 +805,105 @@ srpds_shift_uo_list_recursively(redisContext *ctx, const char *mod_ns, const cha
         goto cleanup;
     }
     args_array[1] = arg;
-    if (asprintf(&arg, "@order:[%" PRIu64 " %" PRIu64 "] @path_no_pred:{%s}", next_elem_order, next_elem_order, path_no_pred_escaped) == -1) {
-        ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
-        goto cleanup;
-    }
-    args_array[2] = arg;
 
-    /* retrieve only key */
+    /* retrieve keys and orders of the elements in the window, sorted */
     args_array[3] = "LOAD";
-    args_array[4] = "1";
+    args_array[4] = "2";
     args_array[5] = "__key";
+    args_array[6] = "order";
+    args_array[7] = "SORTBY";
+    args_array[8] = "2";
+    args_array[9] = "@order";
+    args_array[10] = "ASC";
+    args_array[11] = "LIMIT";
+    args_array[12] = "0";
+    args_array[13] = "1000000000000";
 
-    reply = redisCommandArgv(ctx, argnum, (const char **)args_array, NULL);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
+    /* the previous changes must be applied */
+    if ((err_info = srpds_pipe_flush(ctx, 0))) {
         goto cleanup;
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", "No reply array")
+
+    for (shift = 1; shift < 63; ++shift) {
+        size = (uint64_t)1 << shift;
+        lo = prev_order & ~(size - 1);
+
+        free(args_array[2]);
+        args_array[2] = NULL;
+        if (asprintf(&arg, "@order:[%" PRIu64 " %" PRIu64 "] @path_no_pred:{%s}", lo, lo + (size - 1),
+                path_no_pred_escaped) == -1) {
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
+            goto cleanup;
+        }
+        args_array[2] = arg;
+
+        freeReplyObject(reply);
+        reply = redisCommandArgv(ctx, argnum, (const char **)args_array, NULL);
+        if (reply->type == REDIS_REPLY_ERROR) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
+            goto cleanup;
+        }
+        if (reply->type != REDIS_REPLY_ARRAY) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", "No reply array")
+            goto cleanup;
+        }
+
+        /* the window is sparse enough if the gaps between its elements and the new element are at least
+         * square root of its size */
+        count = reply->elements - 1;
+        gap = size / (count + 2);
+        if (gap >= ((uint64_t)1 << (shift / 2))) {
+            break;
+        }
+    }
+    if (shift == 63) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Respacing user-ordered list", "No free order")
         goto cleanup;
     }
 
-    if (reply->element[0]->integer == 1) {
-        /* An element with such order has been found, shift all elements
-         * after this element */
-        if ((err_info = srpds_shift_uo_list_recursively(ctx, mod_ns, path_no_pred, next_elem_order + 1, max_order))) {
+    /* respace all the elements in the window, the new element is placed after the previous element */
+    placed = 0;
+    for (i = 0, pos = 1; i < count; ++i, ++pos) {
+        row = reply->element[i + 1];
+        key = NULL;
+        elem_order = 0;
+        for (k = 0; k + 1 < row->elements; k += 2) {
+            if (!strcmp(row->element[k]->str, "__key")) {
+                key = row->element[k + 1]->str;
+            } else if (!strcmp(row->element[k]->str, "order")) {
+                elem_order = (uint64_t)strtoull(row->element[k + 1]->str, NULL, 0);
+            }
+        }
+        if (!key) {
+            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", "No key of an element")
             goto cleanup;
         }
 
-        /* on [1] -> [1] is the key of the found element */
-        reply2 = redisCommand(ctx, "HSET %s order %" PRIu64, reply->element[1]->element[1]->str, next_elem_order + 1);
-        if (reply2->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting order", reply2->str)
+        if (!placed && (elem_order > prev_order)) {
+            *order = lo + gap * pos;
+            ++pos;
+            placed = 1;
+        }
+
+        new_order = lo + gap * pos;
+        if ((new_order != elem_order) && (err_info = srpds_pipe_append(ctx, 0, "HSET %s order %" PRIu64, key, new_order))) {
             goto cleanup;
         }
     }
+    if (!placed) {
+        *order = lo + gap * pos;
+    }
+
+    /* the last order in the window may be the new maximum order */
+    if (*max_order < lo + gap * (count + 1)) {
+        *max_order = lo + gap * (count + 1);
+    }
 
 cleanup:
     free(path_no_pred_escaped);
     free(args_array[1]);
     free(args_array[2]);
     freeReplyObject(reply);
-    freeReplyObject(reply2);
     return err_info;
 }
 
@@ -727,20 +923,9 @@ static sr_error_info_t *
 srpds_insert_uo_element(redisContext *ctx, const char *mod_ns, const char *path, const char *prev,
         uint64_t order, const char *path_no_pred)
 {
-    sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
-
     /* insert the element */
-    reply = redisCommand(ctx, "HSET %s:data:%s path %s prev %s is_prev_empty %d order %" PRIu64 " path_no_pred %s",
-            mod_ns, path, path, prev, (prev[0] == '\0') ? 1 : 0, order, path_no_pred);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Inserting userordered element", reply->str)
-        goto cleanup;
-    }
-
-cleanup:
-    freeReplyObject(reply);
-    return err_info;
+    return srpds_pipe_append(ctx, 0, "HSET %s:data:%s path %s prev %s is_prev_empty %d order %" PRIu64
+            " path_no_pred %s", mod_ns, path, path, prev, (prev[0] == '\0') ? 1 : 0, order, path_no_pred);
 }
 
 /**
@@ -755,19 +940,8 @@ cleanup:
 static sr_error_info_t *
 srpds_delete_uo_element(redisContext *ctx, const char *mod_ns, const char *path)
 {
-    sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
-
     /* delete the element */
-    reply = redisCommand(ctx, "DEL %s:data:%s", mod_ns, path);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Deleting user ordered element", reply->str)
-        goto cleanup;
-    }
-
-cleanup:
-    freeReplyObject(reply);
-    return err_info;
+    return srpds_pipe_append(ctx, 0, "DEL %s:data:%s", mod_ns, path);
 }
 
 /**
@@ -786,7 +960,7 @@ srpds_change_next_element(redisContext *ctx, const char *mod_ns, const char *pat
 {
     sr_error_info_t *err_info = NULL;
     int argnum = 6;
-    redisReply *reply = NULL, *reply2 = NULL;
+    redisReply *reply = NULL;
     char *arg = NULL, *args_array[argnum], *prev_escaped = NULL, *path_no_pred_escaped = NULL;
 
     if ((err_info = srpds_escape_string(prev, &prev_escaped))) {
@@ -819,6 +993,11 @@ srpds_change_next_element(redisContext *ctx, const char *mod_ns, const char *pat
     args_array[4] = "1";
     args_array[5] = "__key";
 
+    /* the previous changes must be applied */
+    if ((err_info = srpds_pipe_flush(ctx, 0))) {
+        goto cleanup;
+    }
+
     reply = redisCommandArgv(ctx, argnum, (const char **)args_array, NULL);
     if (reply->type == REDIS_REPLY_ERROR) {
         ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
@@ -831,10 +1010,8 @@ srpds_change_next_element(redisContext *ctx, const char *mod_ns, const char *pat
 
     /* change the next element */
     if (reply->elements == 2) {
-        reply2 = redisCommand(ctx, "HSET %s prev %s is_prev_empty %d", reply->element[1]->element[1]->str,
-                new_prev, (new_prev[0] == '\0') ? 1 : 0);
-        if (reply2->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Changing next element", reply2->str)
+        if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s prev %s is_prev_empty %d", reply->element[1]->element[1]->str,
+                new_prev, (new_prev[0] == '\0') ? 1 : 0))) {
             goto cleanup;
         }
     }
@@ -844,7 +1021,6 @@ cleanup:
     free(path_no_pred_escaped);
     free(args_array[1]);
     free(args_array[2]);
-    freeReplyObject(reply2);
     freeReplyObject(reply);
     return err_info;
 }
@@ -868,7 +1044,7 @@ srpds_create_uo_op(redisContext *ctx, const char *mod_ns, const char *path, cons
         const char *value, const char *value_pred, uint64_t *max_order)
 {
     sr_error_info_t *err_info = NULL;
-    uint64_t prev_order = 0, next_order = 0;
+    uint64_t prev_order = 0, next_order = 0, order;
 
     /* there is a previous element */
     if (strcmp(value, "")) {
@@ -894,8 +1070,8 @@ srpds_create_uo_op(redisContext *ctx, const char *mod_ns, const char *path, cons
                 goto cleanup;
             }
         } else if (next_order - prev_order == 1) {
-            /* shift next elements by one recursively */
-            if ((err_info = srpds_shift_uo_list_recursively(ctx, mod_ns, path_no_pred, next_order, max_order))) {
+            /* no free order, respace the elements around */
+            if ((err_info = srpds_respace_uo_list(ctx, mod_ns, path_no_pred, prev_order, max_order, &order))) {
                 goto cleanup;
             }
 
@@ -904,7 +1080,7 @@ srpds_create_uo_op(redisContext *ctx, const char *mod_ns, const char *path, cons
                 goto cleanup;
             }
 
-            if ((err_info = srpds_insert_uo_element(ctx, mod_ns, path, value_pred, next_order, path_no_pred))) {
+            if ((err_info = srpds_insert_uo_element(ctx, mod_ns, path, value_pred, order, path_no_pred))) {
                 goto cleanup;
             }
         } else {
@@ -939,8 +1115,8 @@ srpds_create_uo_op(redisContext *ctx, const char *mod_ns, const char *path, cons
                 goto cleanup;
             }
         } else if (next_order == 1) {
-            /* shift next elements by one recursively */
-            if ((err_info = srpds_shift_uo_list_recursively(ctx, mod_ns, path_no_pred, next_order, max_order))) {
+            /* no free order, respace the first elements */
+            if ((err_info = srpds_respace_uo_list(ctx, mod_ns, path_no_pred, 0, max_order, &order))) {
                 goto cleanup;
             }
 
@@ -949,7 +1125,7 @@ srpds_create_uo_op(redisContext *ctx, const char *mod_ns, const char *path, cons
                 goto cleanup;
             }
 
-            if ((err_info = srpds_insert_uo_element(ctx, mod_ns, path, value_pred, next_order, path_no_pred))) {
+            if ((err_info = srpds_insert_uo_element(ctx, mod_ns, path, value_pred, order, path_no_pred))) {
                 goto cleanup;
             }
         } else {
@@ -1012,18 +1188,7 @@ cleanup:
 static sr_error_info_t *
 srpds_change_default_flag(redisContext *ctx, const char *mod_ns, const char *path, int add_or_remove)
 {
-    sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
-
-    reply = redisCommand(ctx, "HSET %s:data:%s dflt_flag %" PRIu32, mod_ns, path, add_or_remove);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting default flag", reply->str)
-        goto cleanup;
-    }
-
-cleanup:
-    freeReplyObject(reply);
-    return err_info;
+    return srpds_pipe_append(ctx, 0, "HSET %s:data:%s dflt_flag %" PRIu32, mod_ns, path, add_or_remove);
 }
 
 /**
@@ -1157,7 +1322,6 @@ srpds_create_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, co
         const char *predicate, const char *value, const char *value_pred, int32_t valtype, uint64_t *max_order)
 {
     sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
 
     if (lysc_is_userordered(node->schema)) {
         /* insert a new element into the user-ordered list */
@@ -1167,17 +1331,14 @@ srpds_create_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, co
     } else {
         /* set a node without a value */
         if (!value) {
-            reply = redisCommand(ctx, "HSET %s:data:%s path %s path_no_pred %s", mod_ns, path, path, path_no_pred);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating data", reply->str)
+            if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:data:%s path %s path_no_pred %s", mod_ns, path, path,
+                    path_no_pred))) {
                 goto cleanup;
             }
             /* set a node with a value */
         } else {
-            reply = redisCommand(ctx, "HSET %s:data:%s path %s value %s valtype %" PRId32 " path_no_pred %s",
-                    mod_ns, path, path, value, valtype, path_no_pred);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating data", reply->str)
+            if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:data:%s path %s value %s valtype %" PRId32
+                    " path_no_pred %s", mod_ns, path, path, value, valtype, path_no_pred))) {
                 goto cleanup;
             }
         }
@@ -1189,7 +1350,6 @@ srpds_create_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, co
     }
 
 cleanup:
-    freeReplyObject(reply);
     return err_info;
 }
 
@@ -1211,7 +1371,6 @@ srpds_delete_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, co
         const char *predicate, const char *orig_value_pred)
 {
     sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
 
     if (lysc_is_userordered(node->schema)) {
         /* delete an element from the user-ordered list */
@@ -1220,15 +1379,12 @@ srpds_delete_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, co
         }
     } else {
         /* delete all fields within the key */
-        reply = redisCommand(ctx, "DEL %s:data:%s", mod_ns, path);
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Deleting data", reply->str)
+        if ((err_info = srpds_pipe_append(ctx, 0, "DEL %s:data:%s", mod_ns, path))) {
             goto cleanup;
         }
     }
 
 cleanup:
-    freeReplyObject(reply);
     return err_info;
 }
 
@@ -1253,7 +1409,6 @@ srpds_replace_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, c
         const char *predicate, const char *value, const char *value_pred, const char *orig_value_pred, uint64_t *max_order)
 {
     sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
 
     if (lysc_is_userordered(node->schema)) {
         /* delete an element from the user-ordered list */
@@ -1266,9 +1421,7 @@ srpds_replace_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, c
             goto cleanup;
         }
     } else {
-        reply = redisCommand(ctx, "HSET %s:data:%s value %s", mod_ns, path, value);
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Replacing data", reply->str)
+        if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:data:%s value %s", mod_ns, path, value))) {
             goto cleanup;
         }
     }
@@ -1279,7 +1432,6 @@ srpds_replace_op(redisContext *ctx, const char *mod_ns, struct lyd_node *node, c
     }
 
 cleanup:
-    freeReplyObject(reply);
     return err_info;
 }
 
@@ -1504,7 +1656,6 @@ srpds_store_oper_recursively(redisContext *ctx, const struct lyd_node *mod_data,
     const char *predicate = NULL;
     const char *meta_value, *value = NULL;
     uint32_t valtype;
-    redisReply *reply = NULL;
 
     while (sibling) {
         /* get path */
@@ -1536,34 +1687,24 @@ srpds_store_oper_recursively(redisContext *ctx, const struct lyd_node *mod_data,
 
         /* create all data */
         if (!value) {
-            reply = redisCommand(ctx, "HSET %s:data:%s path %s is_opaque %d order %" PRIu64 " path_no_pred %s",
-                    mod_ns, path, path, sibling->schema ? 0 : 1, (uint64_t)strtoull((predicate[0] == '\0') ? "0" : predicate + 1, NULL, 0), path_no_pred);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating data", reply->str)
+            if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:data:%s path %s is_opaque %d order %" PRIu64 " path_no_pred %s",
+                    mod_ns, path, path, sibling->schema ? 0 : 1, (uint64_t)strtoull((predicate[0] == '\0') ? "0" : predicate + 1, NULL, 0), path_no_pred))) {
                 goto cleanup;
             }
         } else {
-            reply = redisCommand(ctx, "HSET %s:data:%s path %s value %s valtype %d is_opaque %d order %" PRIu64 " path_no_pred %s",
-                    mod_ns, path, path, value, valtype, sibling->schema ? 0 : 1, (uint64_t)strtoull((predicate[0] == '\0') ? "0" : predicate + 1, NULL, 0), path_no_pred);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating data", reply->str)
+            if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:data:%s path %s value %s valtype %d is_opaque %d order %" PRIu64 " path_no_pred %s",
+                    mod_ns, path, path, value, valtype, sibling->schema ? 0 : 1, (uint64_t)strtoull((predicate[0] == '\0') ? "0" : predicate + 1, NULL, 0), path_no_pred))) {
                 goto cleanup;
             }
         }
-        freeReplyObject(reply);
-        reply = NULL;
 
         /* for default nodes metadata */
         if ((sibling->flags & LYD_DEFAULT) && (sibling->schema->nodetype & LYD_NODE_TERM)) {
             /* valtype = 0 --> default flag */
-            reply = redisCommand(ctx, "HSET %s:meta:%s:ietf-netconf-with-defaults:default path %s metaname ietf-netconf-with-defaults:default value true valtype 0",
-                    mod_ns, path, path);
-            if (reply->type == REDIS_REPLY_ERROR) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating metadata", reply->str)
+            if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:meta:%s:ietf-netconf-with-defaults:default path %s metaname ietf-netconf-with-defaults:default value true valtype 0",
+                    mod_ns, path, path))) {
                 goto cleanup;
             }
-            freeReplyObject(reply);
-            reply = NULL;
         }
 
         /* create metadata and attributes of the node */
@@ -1576,17 +1717,13 @@ srpds_store_oper_recursively(redisContext *ctx, const struct lyd_node *mod_data,
                 /* skip yang:lyds_tree metadata, this is libyang specific data */
                 if (strcmp(meta->annotation->module->name, "yang") || strcmp(meta->name, "lyds_tree")) {
                     /* valtype = 1 --> metadata */
-                    reply = redisCommand(ctx, "HSET %s:meta:%s:%s:%s path %s metaname %s:%s value %s valtype 1",
-                            mod_ns, path, meta->annotation->module->name, meta->name, path, meta->annotation->module->name, meta->name, meta_value);
-                    if (reply->type == REDIS_REPLY_ERROR) {
-                        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating metadata", reply->str)
+                    if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:meta:%s:%s:%s path %s metaname %s:%s value %s valtype 1",
+                            mod_ns, path, meta->annotation->module->name, meta->name, path, meta->annotation->module->name, meta->name, meta_value))) {
                         goto cleanup;
                     }
                 }
 
                 meta = meta->next;
-                freeReplyObject(reply);
-                reply = NULL;
             }
         } else {
             /* opaque nodes */
@@ -1606,18 +1743,14 @@ srpds_store_oper_recursively(redisContext *ctx, const struct lyd_node *mod_data,
                 /* skip yang:lyds_tree attributes, this is libyang specific data */
                 if (strcmp(module->name, "yang") || strcmp(attr->name.name, "lyds_tree")) {
                     /* valtype = 2 --> attributes */
-                    reply = redisCommand(ctx, "HSET %s:meta:%s:%s:%s path %s metaname %s:%s value %s valtype 2",
-                            mod_ns, path, module->name, attr->name.name, path, module->name, attr->name.name, attr->value);
-                    if (reply->type == REDIS_REPLY_ERROR) {
-                        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Creating metadata", reply->str)
+                    if ((err_info = srpds_pipe_append(ctx, 0, "HSET %s:meta:%s:%s:%s path %s metaname %s:%s value %s valtype 2",
+                            mod_ns, path, module->name, attr->name.name, path, module->name, attr->name.name, attr->value))) {
                         goto cleanup;
                     }
                 }
 
                 attr = attr->next;
                 module = NULL;
-                freeReplyObject(reply);
-                reply = NULL;
             }
         }
 
@@ -1638,7 +1771,6 @@ srpds_store_oper_recursively(redisContext *ctx, const struct lyd_node *mod_data,
 cleanup:
     free(path);
     free(path_no_pred);
-    freeReplyObject(reply);
     return err_info;
 }
 
@@ -1657,37 +1789,27 @@ static sr_error_info_t *
 srpds_set_flags(redisContext *ctx, const char *mod_ns, sr_datastore_t ds, struct timespec *spec, int candidate_modified)
 {
     sr_error_info_t *err_info = NULL;
-    redisReply *reply = NULL;
 
     /* set last-modified flag in seconds */
-    reply = redisCommand(ctx, "SET %s:glob:last-modified-sec %" PRId64, mod_ns, spec->tv_sec);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting last-modified flag", reply->str)
+    if ((err_info = srpds_pipe_append(ctx, 0, "SET %s:glob:last-modified-sec %" PRId64, mod_ns, spec->tv_sec))) {
         goto cleanup;
     }
-    freeReplyObject(reply);
-    reply = NULL;
 
     /* set last-modified flag in nanoseconds */
-    reply = redisCommand(ctx, "SET %s:glob:last-modified-nsec %" PRId64, mod_ns, spec->tv_nsec);
-    if (reply->type == REDIS_REPLY_ERROR) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting last-modified flag", reply->str)
+    if ((err_info = srpds_pipe_append(ctx, 0, "SET %s:glob:last-modified-nsec %" PRId64, mod_ns, spec->tv_nsec))) {
         goto cleanup;
     }
-    freeReplyObject(reply);
-    reply = NULL;
 
     /* set candidate-modified flag */
     if (ds == SR_DS_CANDIDATE) {
-        reply = redisCommand(ctx, "SET %s:glob:candidate-modified %d", mod_ns, candidate_modified);
-        if (reply->type == REDIS_REPLY_ERROR) {
-            ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Setting candidate-modified flag", reply->str)
+        if ((err_info = srpds_pipe_append(ctx, 0, "SET %s:glob:candidate-modified %d", mod_ns, candidate_modified))) {
             goto cleanup;
         }
     }
 
 cleanup:
-    freeReplyObject(reply);
+    /* get the replies of these and all the previous pipelined commands */
+    srpds_pipe_finish(ctx, 0, &err_info);
     return err_info;
 }
 
@@ -1707,7 +1829,11 @@ srpds_load_and_exec(redisContext *ctx, const char *mod_ns, const char *index_typ
 {
     sr_error_info_t *err_info = NULL;
     uint32_t i;
-    redisReply *reply = NULL, *reply2 = NULL;
+    redisReply *reply = NULL;
+
+    if ((err_info = srpds_pipe_flush(ctx, 0))) {
+        goto cleanup;
+    }
 
     reply = redisCommand(ctx, "FT.AGGREGATE %s:%s * LOAD 1 __key", mod_ns, index_type);
     if (reply->type == REDIS_REPLY_ERROR) {
@@ -1723,32 +1849,25 @@ srpds_load_and_exec(redisContext *ctx, const char *mod_ns, const char *index_typ
     switch (cmd_type) {
     case RDS_CMD_DEL:
         for (i = 1; i < reply->elements; ++i) {
-            reply2 = redisCommand(ctx, "DEL %s", reply->element[i]->element[1]->str);
-            if ((reply2->type == REDIS_REPLY_ERROR) || (reply2->integer == 0)) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Deleting", reply2->str)
+            if ((err_info = srpds_pipe_append(ctx, 1, "DEL %s", reply->element[i]->element[1]->str))) {
                 goto cleanup;
             }
-            freeReplyObject(reply2);
-            reply2 = NULL;
         }
         break;
     case RDS_CMD_COPY:
         for (i = 1; i < reply->elements; ++i) {
-            reply2 = redisCommand(ctx, "COPY %s %s%s REPLACE", reply->element[i]->element[1]->str,
-                    trg_ds, strchr(strchr(reply->element[i]->element[1]->str, ':') + 1, ':'));
-            if ((reply2->type == REDIS_REPLY_ERROR) || (reply2->integer == 0)) {
-                ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "Copying", reply2->str)
+            if ((err_info = srpds_pipe_append(ctx, 1, "COPY %s %s%s REPLACE", reply->element[i]->element[1]->str,
+                    trg_ds, strchr(strchr(reply->element[i]->element[1]->str, ':') + 1, ':')))) {
                 goto cleanup;
             }
-            freeReplyObject(reply2);
-            reply2 = NULL;
         }
         break;
     }
 
 cleanup:
+    /* every key must have been deleted or copied */
+    srpds_pipe_finish(ctx, 1, &err_info);
     freeReplyObject(reply);
-    freeReplyObject(reply2);
     return err_info;
 }
 
@@ -1874,93 +1993,245 @@ cleanup:
 }
 
 /**
- * @brief Put all load XPaths into a regex.
+ * @brief Learn the leading simple location steps of an XPath, with only key or value equality predicates.
+ *
+ * @param[in] xpath Absolute XPath.
+ * @param[out] ends Offsets of the ends of all the simple steps in @p xpath, NULL if there are none.
+ * @param[out] count Count of @p ends.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_load_path_steps(const char *xpath, uint32_t **ends, uint32_t *count)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *p, *q, *r;
+    int depth = 0;
+    char quot = 0;
+
+    *ends = NULL;
+    *count = 0;
+
+    /* unions and parent steps may select nodes outside of the subtree of any prefix */
+    for (p = xpath; *p; ++p) {
+        if (quot) {
+            if (*p == quot) {
+                quot = 0;
+            }
+        } else if ((*p == '\'') || (*p == '"')) {
+            quot = *p;
+        } else if (*p == '[') {
+            ++depth;
+        } else if (*p == ']') {
+            --depth;
+        } else if (!depth && ((*p == '|') || ((p[0] == '.') && (p[1] == '.')))) {
+            return NULL;
+        }
+    }
+
+    *ends = malloc((strlen(xpath) + 1) * sizeof **ends);
+    if (!*ends) {
+        ERRINFO(&err_info, SR_ERR_NO_MEMORY, "malloc()", "")
+        return err_info;
+    }
+
+    for (p = xpath; (p[0] == '/') && (p[1] != '/'); p = q) {
+        /* node name, possibly with a prefix */
+        for (q = p + 1; isalnum(*q) || (*q == '_') || (*q == '-') || (*q == '.') || (*q == ':'); ++q) {}
+        if ((q == p + 1) || (p[1] == '.')) {
+            break;
+        }
+
+        /* predicates [name='value'] or [.='value'] */
+        while (*q == '[') {
+            for (r = q + 1; isalnum(*r) || (*r == '_') || (*r == '-') || (*r == '.') || (*r == ':'); ++r) {}
+            if ((r == q + 1) || (*r != '=') || ((r[1] != '\'') && (r[1] != '"'))) {
+                break;
+            }
+            quot = r[1];
+            r = strchr(r + 2, quot);
+            if (!r || (r[1] != ']')) {
+                break;
+            }
+            q = r + 2;
+        }
+        if (*q && (*q != '/')) {
+            /* a complex predicate or an expression, the simple steps end before this one */
+            break;
+        }
+
+        (*ends)[*count] = q - xpath;
+        ++(*count);
+    }
+
+    if (!*count) {
+        free(*ends);
+        *ends = NULL;
+    }
+    return err_info;
+}
+
+/**
+ * @brief Learn the canonical path all the data selected by an XPath are prefixed with.
  *
  * @param[in] ctx Libyang context.
- * @param[in] xpaths Array of XPaths.
- * @param[in] xpath_cnt XPath count.
- * @param[out] out Final regular expression.
+ * @param[in] xpath Absolute XPath.
+ * @param[out] prefix Path prefix as stored in the database, NULL if all the data must be loaded.
  * @return NULL on success;
  * @return Sysrepo error info on error.
  */
 static sr_error_info_t *
-srpds_process_load_paths(struct ly_ctx *ctx, const char **xpaths, uint32_t xpath_cnt, char **out)
+srpds_load_path_prefix(struct ly_ctx *ctx, const char *xpath, char **prefix)
 {
-    uint32_t i;
-    int32_t j;
     sr_error_info_t *err_info = NULL;
-    char *tmp = NULL, *path = NULL;
-    struct lyd_node *ctx_node = NULL, *match = NULL;
+    uint32_t *ends = NULL, count, i;
     uint32_t log_options = 0, *old_options;
+    struct lyd_node *first = NULL, *last = NULL;
+    const struct lysc_node *snode;
+    char *path = NULL, *tmp = NULL, *ptr;
 
-    *out = NULL;
+    *prefix = NULL;
 
-    /* create new data node for lyd_find_path to work correctly */
-    if (lyd_new_path(NULL, ctx, "/ietf-yang-library:yang-library", NULL, 0, &ctx_node) != LY_SUCCESS) {
-        ERRINFO(&err_info, SR_ERR_LY, "lyd_new_path()", "")
+    /* learn the simple steps */
+    if ((err_info = srpds_load_path_steps(xpath, &ends, &count)) || !count) {
         goto cleanup;
     }
 
-    /* build a regex */
-    for (i = 0; i < xpath_cnt; ++i) {
-        old_options = ly_temp_log_options(&log_options);
-        /* check whether the xpaths are paths */
-        if (lyd_find_path(ctx_node, xpaths[i], 0, &match) != LY_ENOTFOUND) {
-            /* not a path, load all data */
+    /* create the data of the longest simple steps to print their canonical path, key values are canonized too */
+    old_options = ly_temp_log_options(&log_options);
+    for (i = count; i; --i) {
+        free(path);
+        path = strndup(xpath, ends[i - 1]);
+        if (!path) {
             ly_temp_log_options(old_options);
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "strndup()", strerror(errno))
+            goto cleanup;
+        }
+        if (!lyd_new_path2(NULL, ctx, path, NULL, 0, 0, 0, &first, &last) && last) {
+            break;
+        }
+        lyd_free_all(first);
+        first = NULL;
+        last = NULL;
+    }
+    ly_temp_log_options(old_options);
+
+    if (last) {
+        *prefix = lyd_path(last, LYD_PATH_STD, NULL, 0);
+        if (!*prefix) {
+            ERRINFO(&err_info, SR_ERR_LY, "lyd_path()", "")
             goto cleanup;
         }
-        ly_temp_log_options(old_options);
 
-        /* copy the path for further manipulation */
-        path = strdup(xpaths[i]);
+        if ((i == count) && lysc_is_key(last->schema)) {
+            /* key leaves are not stored in the database, only predicates */
+            *strrchr(*prefix, '/') = '\0';
+        }
+    }
+
+    if (i < count) {
+        /* the next step cannot be instantiated (a leaf without a value or a list without all the keys),
+         * all its instances are selected */
+        free(path);
+        path = strndup(xpath, ends[i]);
         if (!path) {
-            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "strdup()", strerror(errno))
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "strndup()", strerror(errno))
+            goto cleanup;
+        }
+        if ((ptr = strchr(path + (i ? ends[i - 1] : 0), '['))) {
+            *ptr = '\0';
+        }
+        snode = lys_find_path(ctx, NULL, path, 0);
+        if (!snode) {
+            /* invalid path, leave it for the caller */
+            free(*prefix);
+            *prefix = NULL;
             goto cleanup;
         }
 
+        if (asprintf(&tmp, "%s/%s%s%s", *prefix ? *prefix : "",
+                (!last || (snode->module != last->schema->module)) ? snode->module->name : "",
+                (!last || (snode->module != last->schema->module)) ? ":" : "", snode->name) == -1) {
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
+            goto cleanup;
+        }
+        free(*prefix);
+        *prefix = tmp;
+    }
+
+cleanup:
+    if (err_info) {
+        free(*prefix);
+        *prefix = NULL;
+    }
+    free(ends);
+    free(path);
+    lyd_free_all(first);
+    return err_info;
+}
+
+/**
+ * @brief Put all load XPaths into a query of the path prefixes of the selected data.
+ *
+ * @param[in] ctx Libyang context.
+ * @param[in] xpaths Array of XPaths.
+ * @param[in] xpath_cnt XPath count.
+ * @param[out] out Final query, NULL if all the data must be loaded.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_process_load_paths(struct ly_ctx *ctx, const char **xpaths, uint32_t xpath_cnt, char **out)
+{
+    uint32_t i;
+    sr_error_info_t *err_info = NULL;
+    char *tmp = NULL, *path = NULL, *prefix = NULL;
+
+    *out = NULL;
+
+    /* build a query */
+    for (i = 0; i < xpath_cnt; ++i) {
         /* all relative paths should be transformed into absolute */
-        if (path[0] != '/') {
-            if (asprintf(&tmp, "/%s", path) == -1) {
-                ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
-                goto cleanup;
-            }
-            free(path);
-            path = tmp;
+        if (asprintf(&path, "%s%s", (xpaths[i][0] != '/') ? "/" : "", xpaths[i]) == -1) {
+            path = NULL;
+            ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
+            goto cleanup;
         }
 
-        /* path is key */
-        if (lysc_is_key(lys_find_path(ctx, NULL, path, 0))) {
-            for (j = strlen(path) - 1; j >= 0; --j) {
-                /* key leaves are not stored in the database, only predicates */
-                if (path[j] == '/') {
-                    path[j] = '\0';
-                    break;
-                }
-            }
+        /* the selected data are all in the subtree of this prefix */
+        if ((err_info = srpds_load_path_prefix(ctx, path, &prefix))) {
+            goto cleanup;
+        }
+        if (!prefix) {
+            /* load all data */
+            free(*out);
+            *out = NULL;
+            goto cleanup;
         }
 
-        if ((err_info = srpds_escape_string(path, &tmp))) {
+        if ((err_info = srpds_escape_string(prefix, &tmp))) {
             goto cleanup;
         }
-        free(path);
-        path = tmp;
+        free(prefix);
+        prefix = tmp;
 
-        /* start regex */
+        /* start query */
         if (i == 0) {
-            if (asprintf(&tmp, "%s*", path) == -1) {
+            if (asprintf(&tmp, "%s*", prefix) == -1) {
                 ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
                 goto cleanup;
             }
-            /* continue regex */
+            /* continue query */
         } else {
-            if (asprintf(&tmp, "%s | %s*", *out, path) == -1) {
+            if (asprintf(&tmp, "%s | %s*", *out, prefix) == -1) {
                 ERRINFO(&err_info, SR_ERR_NO_MEMORY, "asprintf()", strerror(errno))
                 goto cleanup;
             }
         }
         free(*out);
         *out = tmp;
+        free(prefix);
+        prefix = NULL;
         free(path);
         path = NULL;
     }
@@ -1968,9 +2239,10 @@ srpds_process_load_paths(struct ly_ctx *ctx, const char **xpaths, uint32_t xpath
 cleanup:
     if (err_info) {
         free(*out);
+        *out = NULL;
     }
     free(path);
-    lyd_free_all(ctx_node);
+    free(prefix);
     return err_info;
 }
 
@@ -2024,7 +2296,7 @@ srpds_load_oper(redisContext *ctx, const struct lys_module *mod, const char *mod
             "SORTBY 4 @path_no_pred ASC @order ASC "
             "LOAD * "
             "LIMIT 0 1000000000000 "
-            "WITHCURSOR COUNT 100 ", mod_ns);
+            "WITHCURSOR COUNT " SRPDS_CURSOR_COUNT " ", mod_ns);
     if (reply->type == REDIS_REPLY_ERROR) {
         ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
         goto cleanup;
@@ -2088,7 +2360,7 @@ srpds_load_oper(redisContext *ctx, const struct lys_module *mod, const char *mod
         }
         freeReplyObject(reply);
 
-        reply = redisCommand(ctx, "FT.CURSOR READ %s:data %" PRIu64 " COUNT 100", mod_ns, cursor);
+        reply = redisCommand(ctx, "FT.CURSOR READ %s:data %" PRIu64 " COUNT " SRPDS_CURSOR_COUNT, mod_ns, cursor);
         if (reply->type == REDIS_REPLY_ERROR) {
             ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
             goto cleanup;
@@ -2104,7 +2376,7 @@ srpds_load_oper(redisContext *ctx, const struct lys_module *mod, const char *mod
     reply = redisCommand(ctx, "FT.AGGREGATE %s:meta * "
             "LOAD * "
             "LIMIT 0 1000000000000 "
-            "WITHCURSOR COUNT 100 ", mod_ns);
+            "WITHCURSOR COUNT " SRPDS_CURSOR_COUNT " ", mod_ns);
     if (reply->type == REDIS_REPLY_ERROR) {
         ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
         goto cleanup;
@@ -2175,7 +2447,7 @@ srpds_load_oper(redisContext *ctx, const struct lys_module *mod, const char *mod
         }
         freeReplyObject(reply);
 
-        reply = redisCommand(ctx, "FT.CURSOR READ %s:meta %" PRIu64 " COUNT 100", mod_ns, cursor);
+        reply = redisCommand(ctx, "FT.CURSOR READ %s:meta %" PRIu64 " COUNT " SRPDS_CURSOR_COUNT, mod_ns, cursor);
         if (reply->type == REDIS_REPLY_ERROR) {
             ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
             goto cleanup;
@@ -2278,7 +2550,7 @@ srpds_load_conv(redisContext *ctx, const struct lys_module *mod, sr_datastore_t
     args_array[13] = "1000000000000";
     args_array[14] = "WITHCURSOR";
     args_array[15] = "COUNT";
-    args_array[16] = "100";
+    args_array[16] = SRPDS_CURSOR_COUNT;
 
     reply = redisCommandArgv(ctx, argnum, (const char **)args_array, NULL);
     if (reply->type == REDIS_REPLY_ERROR) {
@@ -2370,7 +2642,7 @@ srpds_load_conv(redisContext *ctx, const struct lys_module *mod, sr_datastore_t
         }
         freeReplyObject(reply);
 
-        reply = redisCommand(ctx, "FT.CURSOR READ %s:data %" PRIu64 " COUNT 100", mod_ns, cursor);
+        reply = redisCommand(ctx, "FT.CURSOR READ %s:data %" PRIu64 " COUNT " SRPDS_CURSOR_COUNT, mod_ns, cursor);
         if (reply->type == REDIS_REPLY_ERROR) {
             ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "FT.AGGREGATE", reply->str)
             goto cleanup;
@@ -2613,6 +2885,7 @@ srpds_redis_candidate_modified(const struct lys_module *mod, void *plg_data, int
     *modified = atoi(reply->str);
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     freeReplyObject(reply);
     return err_info;
@@ -2665,6 +2938,7 @@ srpds_redis_copy(const struct lys_module *mod, sr_datastore_t trg_ds, sr_datasto
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns_src);
     free(mod_ns_trg);
     return err_info;
@@ -2730,6 +3004,11 @@ srpds_redis_store(const struct lys_module *mod, sr_datastore_t ds, const struct
     }
 
 cleanup:
+    if (ctx) {
+        /* the diff is stored using pipelined commands */
+        srpds_pipe_finish(ctx, 0, &err_info);
+    }
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     return err_info;
 }
@@ -2762,6 +3041,7 @@ srpds_redis_access_get(const struct lys_module *mod, sr_datastore_t ds, void *pl
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     freeReplyObject(reply);
     return err_info;
@@ -2824,6 +3104,7 @@ srpds_redis_access_set(const struct lys_module *mod, sr_datastore_t ds, const ch
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     freeReplyObject(reply);
     return err_info;
@@ -2915,6 +3196,7 @@ srpds_redis_access_check(const struct lys_module *mod, sr_datastore_t ds, void *
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(username);
     free(groupname);
     free(owner);
@@ -2994,6 +3276,7 @@ srpds_redis_install(const struct lys_module *mod, sr_datastore_t ds, const char
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     free(username);
     free(groupname);
@@ -3033,6 +3316,7 @@ srpds_redis_uninstall(const struct lys_module *mod, sr_datastore_t ds, void *plg
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     return err_info;
 }
@@ -3076,6 +3360,7 @@ srpds_redis_load(const struct lys_module *mod, sr_datastore_t ds, const char **x
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(out_regex);
     free(mod_ns);
     return err_info;
@@ -3136,6 +3421,7 @@ srpds_redis_last_modif(const struct lys_module *mod, sr_datastore_t ds, void *pl
     mtime->tv_nsec = strtoll(reply->str, NULL, 0);
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     freeReplyObject(reply);
     return err_info;
@@ -3177,6 +3463,7 @@ srpds_redis_candidate_reset(const struct lys_module *mod, void *plg_data)
     }
 
 cleanup:
+    srpds_data_destroy(pdata, ctx);
     free(mod_ns);
     return err_info;
 }
@@ -3199,8 +3486,8 @@ srpds_redis_conn_init(sr_conn_ctx_t *conn, void **plg_data)
         goto cleanup;
     }
 
-    if (pthread_rwlock_init(&data->lock, NULL)) {
-        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "pthread_rwlock_init()", "")
+    if (pthread_mutex_init(&data->lock, NULL)) {
+        ERRINFO(&err_info, SR_ERR_OPERATION_FAILED, "pthread_mutex_init()", "")
         goto cleanup;
     }
     *plg_data = data;
@@ -3223,10 +3510,10 @@ srpds_redis_conn_destroy(sr_conn_ctx_t *conn, void *plg_data)
 
     /* destroy all redis contexts in conn_pool */
     for (i = 0; i < data->size; ++i) {
-        redisFree(data->conn_pool[i].ctx);
+        redisFree(data->conn_pool[i]);
     }
     free(data->conn_pool);
-    pthread_rwlock_destroy(&data->lock);
+    pthread_mutex_destroy(&data->lock);
     free(data);
 }
 
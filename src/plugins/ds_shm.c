@@ -0,0 +1,759 @@
+/**
+ * @file ds_shm.c
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief internal SHM operational datastore plugin
+ *
+ * @copyright
+ * Copyright (c) 2021 - 2024 Deutsche Telekom AG.
+ * Copyright (c) 2021 - 2024 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/*
+ * The plugin supports only the operational datastore, which is volatile. The stored edit of every module is kept
+ * in LYB in its own SHM segment that is written in place by the storing process and mapped by the readers of any
+ * process, there are no files printed or parsed and no network I/O. Every write is versioned by a sequence number
+ * in the segment header (seqlock) so that a reader never parses a partially-written edit. Only the permissions
+ * are kept in a persistent file, the segment is created with them on the first store.
+ */
+
+#define _GNU_SOURCE
+
+#include "compat.h"
+#include "plugins_datastore.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libyang/libyang.h>
+
+#include "common_json.h"
+#include "config.h"
+#include "sysrepo.h"
+
+#define srpds_name "SHM DS"         /**< plugin name */
+#define SRPDS_SHM_SUFFIX ".seg"     /**< suffix appended to all the files */
+
+/** maximum number of attempts to read a segment while it is being written */
+#define SRPDS_SHM_READ_RETRIES 1000
+
+#ifdef LYD_PARSE_LYB_SKIP_CTX_CHECK
+/* LYB data may have been printed by another process with a different context of the same modules */
+# define SRPDS_LYB_PARSE_OPTS LYD_PARSE_LYB_SKIP_CTX_CHECK
+#else
+# define SRPDS_LYB_PARSE_OPTS 0
+#endif
+
+/**
+ * @brief Operational edit SHM segment header, followed by the LYB edit.
+ */
+typedef struct {
+    ATOMIC_T seq;               /**< Sequence number of the writes, odd while the edit is being written. */
+    uint32_t data_len;          /**< Length of the LYB edit. */
+    struct timespec mtime;      /**< Time of the last modification. */
+} srpds_shm_hdr_t;
+
+/** size of the segment header */
+#define SRPDS_SHM_HDR_SIZE ((sizeof(srpds_shm_hdr_t) + 7) & ~(size_t)7)
+
+/**
+ * @brief Append the plugin suffix to a path.
+ *
+ * @param[in,out] path Path to update.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_path_suffix(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    char *new_path;
+
+    if (asprintf(&new_path, "%s%s", *path, SRPDS_SHM_SUFFIX) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        return err_info;
+    }
+    free(*path);
+    *path = new_path;
+
+    return NULL;
+}
+
+/**
+ * @brief Check that a datastore is supported by this plugin.
+ *
+ * @param[in] ds Datastore.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_check_ds(sr_datastore_t ds)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if (ds != SR_DS_OPERATIONAL) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_UNSUPPORTED,
+                "Datastore \"%s\" is not supported, only the operational datastore is.", srpjson_ds2str(ds));
+    }
+
+    return err_info;
+}
+
+/**
+ * @brief Get path of the SHM segment of a module.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] path Segment path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_get_path(const struct lys_module *mod, sr_datastore_t ds, char **path)
+{
+    sr_error_info_t *err_info;
+
+    if ((err_info = srpjson_get_path(srpds_name, mod->name, ds, path))) {
+        return err_info;
+    }
+    return srpds_shm_path_suffix(path);
+}
+
+/**
+ * @brief Get path of the persistent permission file of a module.
+ *
+ * @param[in] mod Module of the data.
+ * @param[in] ds Datastore.
+ * @param[out] path Permission file path.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_get_perm_path(const struct lys_module *mod, sr_datastore_t ds, char **path)
+{
+    sr_error_info_t *err_info;
+
+    if ((err_info = srpjson_get_perm_path(srpds_name, mod->name, ds, path))) {
+        return err_info;
+    }
+    return srpds_shm_path_suffix(path);
+}
+
+/**
+ * @brief Map an existing SHM segment of a module.
+ *
+ * @param[in] path Segment path.
+ * @param[in] flags Open flags, O_RDONLY or O_RDWR.
+ * @param[out] addr Mapped segment, NULL if it does not exist.
+ * @param[out] size Size of the mapping.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_map(const char *path, int flags, char **addr, size_t *size)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    int fd;
+
+    *addr = NULL;
+    *size = 0;
+
+    fd = srpjson_open(srpds_name, path, flags, 0);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            /* nothing stored yet */
+            return NULL;
+        }
+        return srpjson_open_error(srpds_name, path);
+    }
+
+    if (fstat(fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path,
+                strerror(errno));
+        goto cleanup;
+    }
+    if ((size_t)st.st_size < SRPDS_SHM_HDR_SIZE) {
+        /* being created */
+        goto cleanup;
+    }
+
+    *addr = mmap(NULL, st.st_size, (flags == O_RDWR) ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (*addr == MAP_FAILED) {
+        *addr = NULL;
+        srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Mapping \"%s\" failed (%s).", path,
+                strerror(errno));
+        goto cleanup;
+    }
+    *size = st.st_size;
+
+cleanup:
+    close(fd);
+    return err_info;
+}
+
+/**
+ * @brief Read a consistent copy of the edit in an SHM segment.
+ *
+ * @param[in] path Segment path.
+ * @param[out] data Copy of the LYB edit, NULL if there is none.
+ * @param[out] mtime Optional time of the last modification, zero if there is no segment.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+static sr_error_info_t *
+srpds_shm_read(const char *path, char **data, struct timespec *mtime)
+{
+    sr_error_info_t *err_info = NULL;
+    srpds_shm_hdr_t *hdr;
+    char *addr = NULL, *buf = NULL, *mem;
+    size_t size = 0;
+    uint32_t seq, data_len, i;
+    struct timespec ts;
+
+    *data = NULL;
+    if (mtime) {
+        memset(mtime, 0, sizeof *mtime);
+    }
+
+    for (i = 0; i < SRPDS_SHM_READ_RETRIES; ++i) {
+        if (!addr && (err_info = srpds_shm_map(path, O_RDONLY, &addr, &size))) {
+            goto cleanup;
+        }
+        if (!addr) {
+            /* no edit */
+            goto cleanup;
+        }
+        hdr = (srpds_shm_hdr_t *)addr;
+
+        seq = ATOMIC_LOAD_RELAXED(hdr->seq);
+        if (seq % 2) {
+            /* being written */
+            sched_yield();
+            continue;
+        }
+        ATOMIC_THREAD_FENCE();
+
+        data_len = hdr->data_len;
+        ts = hdr->mtime;
+        if (SRPDS_SHM_HDR_SIZE + data_len > size) {
+            /* the segment has grown meanwhile, remap it */
+            munmap(addr, size);
+            addr = NULL;
+            continue;
+        }
+
+        mem = realloc(buf, data_len ? data_len : 1);
+        if (!mem) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+            goto cleanup;
+        }
+        buf = mem;
+        memcpy(buf, addr + SRPDS_SHM_HDR_SIZE, data_len);
+
+        ATOMIC_THREAD_FENCE();
+        if (ATOMIC_LOAD_RELAXED(hdr->seq) != seq) {
+            /* written meanwhile, read again */
+            continue;
+        }
+
+        /* consistent copy */
+        if (data_len) {
+            *data = buf;
+            buf = NULL;
+        }
+        if (mtime) {
+            *mtime = ts;
+        }
+        goto cleanup;
+    }
+
+    srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_TIME_OUT, "Reading \"%s\" failed, it is constantly written.",
+            path);
+
+cleanup:
+    if (addr) {
+        munmap(addr, size);
+    }
+    free(buf);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_install(const struct lys_module *mod, sr_datastore_t ds, const char *owner, const char *group, mode_t perm,
+        void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+    int fd = -1;
+    char *path = NULL;
+
+    assert(perm);
+
+    if ((err_info = srpds_shm_check_ds(ds))) {
+        return err_info;
+    }
+
+    /* startup data dir for the permission file */
+    if ((err_info = srpjson_get_startup_dir(srpds_name, &path))) {
+        return err_info;
+    }
+    if (!srpjson_file_exists(srpds_name, path) && (err_info = srpjson_mkpath(srpds_name, path, SRPJSON_DIR_PERM))) {
+        goto cleanup;
+    }
+
+    /* create the permission file */
+    free(path);
+    if ((err_info = srpds_shm_get_perm_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((fd = srpjson_open(srpds_name, path, O_RDONLY | O_CREAT | O_EXCL, perm)) == -1) {
+        err_info = srpjson_open_error(srpds_name, path);
+        goto cleanup;
+    }
+
+    /* update the owner/group of the file */
+    if ((owner || group) && (err_info = srpjson_chmodown(srpds_name, path, owner, group, 0))) {
+        goto cleanup;
+    }
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_uninstall(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    /* unlink the segment */
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((unlink(path) == -1) && (errno != ENOENT)) {
+        SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", path, strerror(errno));
+    }
+
+    /* unlink the permission file */
+    free(path);
+    if ((err_info = srpds_shm_get_perm_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if (unlink(path) == -1) {
+        SRPLG_LOG_WRN(srpds_name, "Failed to unlink \"%s\" (%s).", path, strerror(errno));
+    }
+
+cleanup:
+    free(path);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_init(const struct lys_module *UNUSED(mod), sr_datastore_t UNUSED(ds), void *UNUSED(plg_data))
+{
+    /* operational datastore is empty after boot, the segment is created by the first store */
+    return NULL;
+}
+
+static sr_error_info_t *
+srpds_shm_conn_init(sr_conn_ctx_t *UNUSED(conn), void **UNUSED(plg_data))
+{
+    return NULL;
+}
+
+static void
+srpds_shm_conn_destroy(sr_conn_ctx_t *UNUSED(conn), void *UNUSED(plg_data))
+{
+}
+
+static sr_error_info_t *srpds_shm_access_get(const struct lys_module *mod, sr_datastore_t ds, void *plg_data,
+        char **owner, char **group, mode_t *perm);
+
+static sr_error_info_t *
+srpds_shm_store(const struct lys_module *mod, sr_datastore_t ds, const struct lyd_node *UNUSED(mod_diff),
+        const struct lyd_node *mod_data, void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+    struct ly_out *out = NULL;
+    srpds_shm_hdr_t *hdr;
+    char *path = NULL, *buf = NULL, *addr = NULL;
+    size_t size = 0, data_len;
+    mode_t perm = 0;
+    int fd = -1;
+
+    if ((err_info = srpds_shm_check_ds(ds))) {
+        return err_info;
+    }
+
+    /* print the edit, if any */
+    data_len = 0;
+    if (mod_data) {
+        if (ly_out_new_memory(&buf, 0, &out)) {
+            err_info = srpjson_log_err_ly(srpds_name, NULL);
+            goto cleanup;
+        }
+        if (lyd_print_all(out, mod_data, LYD_LYB, LYD_PRINT_SHRINK | LYD_PRINT_KEEPEMPTYCONT | LYD_PRINT_WD_IMPL_TAG)) {
+            err_info = srpjson_log_err_ly(srpds_name, LYD_CTX(mod_data));
+            goto cleanup;
+        }
+        data_len = ly_out_printed(out);
+    }
+
+    /* open the segment, create it with the permissions of the module if it does not exist */
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if (!srpjson_file_exists(srpds_name, path) && (err_info = srpds_shm_access_get(mod, ds, NULL, NULL, NULL, &perm))) {
+        goto cleanup;
+    }
+    fd = srpjson_open(srpds_name, path, perm ? O_RDWR | O_CREAT : O_RDWR, perm);
+    if (fd == -1) {
+        err_info = srpjson_open_error(srpds_name, path);
+        goto cleanup;
+    }
+
+    /* the segment only grows so that the readers always map the header */
+    if ((err_info = srpds_shm_map(path, O_RDWR, &addr, &size))) {
+        goto cleanup;
+    }
+    if (SRPDS_SHM_HDR_SIZE + data_len > size) {
+        if (addr) {
+            munmap(addr, size);
+            addr = NULL;
+        }
+        size = SRPDS_SHM_HDR_SIZE + data_len;
+        if (ftruncate(fd, size) == -1) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Failed to truncate \"%s\" (%s).", path,
+                    strerror(errno));
+            goto cleanup;
+        }
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            addr = NULL;
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Mapping \"%s\" failed (%s).", path,
+                    strerror(errno));
+            goto cleanup;
+        }
+    }
+    hdr = (srpds_shm_hdr_t *)addr;
+
+    /* SEQ WRITE BEGIN */
+    ATOMIC_INC_RELAXED(hdr->seq);
+    ATOMIC_THREAD_FENCE();
+
+    memcpy(addr + SRPDS_SHM_HDR_SIZE, buf, data_len);
+    hdr->data_len = data_len;
+    clock_gettime(CLOCK_REALTIME, &hdr->mtime);
+
+    /* SEQ WRITE END */
+    ATOMIC_THREAD_FENCE();
+    ATOMIC_INC_RELAXED(hdr->seq);
+
+cleanup:
+    if (addr) {
+        munmap(addr, size);
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    ly_out_free(out, NULL, 0);
+    free(buf);
+    free(path);
+    return err_info;
+}
+
+static void
+srpds_shm_recover(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+    srpds_shm_hdr_t *hdr;
+    char *path = NULL, *addr = NULL;
+    size_t size = 0;
+
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_shm_map(path, O_RDWR, &addr, &size)) || !addr) {
+        goto cleanup;
+    }
+    hdr = (srpds_shm_hdr_t *)addr;
+
+    if (ATOMIC_LOAD_RELAXED(hdr->seq) % 2) {
+        /* the writer crashed, the edit may be incomplete */
+        SRPLG_LOG_WRN(srpds_name, "Recovering \"%s\" operational data by removing the partially written edit.",
+                mod->name);
+        hdr->data_len = 0;
+        clock_gettime(CLOCK_REALTIME, &hdr->mtime);
+        ATOMIC_THREAD_FENCE();
+        ATOMIC_INC_RELAXED(hdr->seq);
+    }
+
+cleanup:
+    if (addr) {
+        munmap(addr, size);
+    }
+    free(path);
+    srplg_errinfo_free(&err_info);
+}
+
+static sr_error_info_t *
+srpds_shm_load(const struct lys_module *mod, sr_datastore_t ds, const char **UNUSED(xpaths),
+        uint32_t UNUSED(xpath_count), void *UNUSED(plg_data), struct lyd_node **mod_data)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL, *data = NULL;
+
+    *mod_data = NULL;
+
+    if ((err_info = srpds_shm_check_ds(ds))) {
+        return err_info;
+    }
+
+    /* copy the edit */
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpds_shm_read(path, &data, NULL)) || !data) {
+        goto cleanup;
+    }
+
+    /* parse it, the edit may include opaque nodes */
+    if (lyd_parse_data_mem(mod->ctx, data, LYD_LYB, LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED | LYD_PARSE_OPAQ |
+            SRPDS_LYB_PARSE_OPTS, 0, mod_data)) {
+        err_info = srpjson_log_err_ly(srpds_name, mod->ctx);
+        goto cleanup;
+    }
+
+cleanup:
+    if (err_info) {
+        lyd_free_all(*mod_data);
+        *mod_data = NULL;
+    }
+    free(data);
+    free(path);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_copy(const struct lys_module *UNUSED(mod), sr_datastore_t trg_ds, sr_datastore_t src_ds,
+        void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* only a single datastore is supported */
+    if (!(err_info = srpds_shm_check_ds(trg_ds))) {
+        err_info = srpds_shm_check_ds(src_ds);
+    }
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_candidate_modified(const struct lys_module *UNUSED(mod), void *UNUSED(plg_data), int *modified)
+{
+    *modified = 0;
+    return srpds_shm_check_ds(SR_DS_CANDIDATE);
+}
+
+static sr_error_info_t *
+srpds_shm_candidate_reset(const struct lys_module *UNUSED(mod), void *UNUSED(plg_data))
+{
+    return srpds_shm_check_ds(SR_DS_CANDIDATE);
+}
+
+static sr_error_info_t *
+srpds_shm_access_set(const struct lys_module *mod, sr_datastore_t ds, const char *owner, const char *group,
+        mode_t perm, void *UNUSED(plg_data))
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    assert(mod && (owner || group || perm));
+
+    /* update the segment, if any */
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if (srpjson_file_exists(srpds_name, path) && (err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+        goto cleanup;
+    }
+
+    /* and the permission file */
+    free(path);
+    if ((err_info = srpds_shm_get_perm_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+    if ((err_info = srpjson_chmodown(srpds_name, path, owner, group, perm))) {
+        goto cleanup;
+    }
+
+cleanup:
+    free(path);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_access_get(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data), char **owner,
+        char **group, mode_t *perm)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    char *path;
+
+    if (owner) {
+        *owner = NULL;
+    }
+    if (group) {
+        *group = NULL;
+    }
+
+    if ((err_info = srpds_shm_get_perm_path(mod, ds, &path))) {
+        return err_info;
+    }
+
+    /* stat */
+    if (stat(path, &st) == -1) {
+        if (errno == EACCES) {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_UNAUTHORIZED, "Learning \"%s\" permissions failed.",
+                    mod->name);
+        } else {
+            srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Stat of \"%s\" failed (%s).", path,
+                    strerror(errno));
+        }
+        free(path);
+        return err_info;
+    }
+    free(path);
+
+    /* get owner */
+    if (owner && (err_info = srpjson_get_pwd(srpds_name, &st.st_uid, owner))) {
+        goto error;
+    }
+
+    /* get group */
+    if (group && (err_info = srpjson_get_grp(srpds_name, &st.st_gid, group))) {
+        goto error;
+    }
+
+    /* get perms */
+    if (perm) {
+        *perm = st.st_mode & 0007777;
+    }
+
+    return NULL;
+
+error:
+    if (owner) {
+        free(*owner);
+        *owner = NULL;
+    }
+    if (group) {
+        free(*group);
+        *group = NULL;
+    }
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_access_check(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data), int *read, int *write)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path;
+
+    if ((err_info = srpds_shm_get_perm_path(mod, ds, &path))) {
+        return err_info;
+    }
+
+    /* check read */
+    if (read) {
+        if (eaccess(path, R_OK) == -1) {
+            if (errno == EACCES) {
+                *read = 0;
+            } else {
+                srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Eaccess of \"%s\" failed (%s).", path,
+                        strerror(errno));
+                goto cleanup;
+            }
+        } else {
+            *read = 1;
+        }
+    }
+
+    /* check write */
+    if (write) {
+        if (eaccess(path, W_OK) == -1) {
+            if (errno == EACCES) {
+                *write = 0;
+            } else {
+                srplg_log_errinfo(&err_info, srpds_name, NULL, SR_ERR_SYS, "Eaccess of \"%s\" failed (%s).", path,
+                        strerror(errno));
+                goto cleanup;
+            }
+        } else {
+            *write = 1;
+        }
+    }
+
+cleanup:
+    free(path);
+    return err_info;
+}
+
+static sr_error_info_t *
+srpds_shm_last_modif(const struct lys_module *mod, sr_datastore_t ds, void *UNUSED(plg_data), struct timespec *mtime)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL, *data = NULL;
+
+    if ((err_info = srpds_shm_get_path(mod, ds, &path))) {
+        goto cleanup;
+    }
+
+    /* the time is written together with the edit */
+    if ((err_info = srpds_shm_read(path, &data, mtime))) {
+        goto cleanup;
+    }
+
+cleanup:
+    free(data);
+    free(path);
+    return err_info;
+}
+
+const struct srplg_ds_s srpds_shm = {
+    .name = srpds_name,
+    .install_cb = srpds_shm_install,
+    .uninstall_cb = srpds_shm_uninstall,
+    .init_cb = srpds_shm_init,
+    .conn_init_cb = srpds_shm_conn_init,
+    .conn_destroy_cb = srpds_shm_conn_destroy,
+    .store_cb = srpds_shm_store,
+    .recover_cb = srpds_shm_recover,
+    .load_cb = srpds_shm_load,
+    .copy_cb = srpds_shm_copy,
+    .candidate_modified_cb = srpds_shm_candidate_modified,
+    .candidate_reset_cb = srpds_shm_candidate_reset,
+    .access_set_cb = srpds_shm_access_set,
+    .access_get_cb = srpds_shm_access_get,
+    .access_check_cb = srpds_shm_access_check,
+    .last_modif_cb = srpds_shm_last_modif,
+    .data_version_cb = NULL,
+};
@@ -23,6 +23,8 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,37 +38,95 @@
 #include "common_json.h"
 #include "sysrepo.h"
 
-#define srpntf_name "JSON notif" /**< plugin name */
+#ifndef srpntf_name
+# define srpntf_name "JSON notif"   /**< plugin name */
+# define SRPNTF_FORMAT LYD_JSON     /**< format of the stored notifications */
+# define SRPNTF_PLUGIN srpntf_json  /**< plugin structure */
+#endif
+
+/** flag of the notification length of a record in the LYB format, both formats are read by all the plugins */
+#define SRPNTF_LEN_LYB 0x80000000
+
+/**
+ * @brief Notification file timestamp index entry.
+ *
+ * Holds the offset of a notification and the latest timestamp of all the notifications stored before it so that
+ * the entries are sorted even if the timestamps are not.
+ */
+struct srpntf_idx_entry {
+    struct timespec ts;
+    uint64_t offset;
+};
+
+/**
+ * @brief Append state of the latest notification file of a module.
+ */
+struct srpntf_head {
+    char *mod_name;             /**< module name */
+    time_t from_ts;             /**< earliest stored notification in the file */
+    time_t to_ts;               /**< latest stored notification in the file */
+    char *path;                 /**< notification file path */
+    int fd;                     /**< notification file opened for appending, -1 if none */
+    dev_t dev;                  /**< notification file device */
+    ino_t ino;                  /**< notification file inode */
+    off_t size;                 /**< notification file size after the last append */
+    int idx_fd;                 /**< timestamp index file opened for appending, -1 if none */
+    uint64_t idx_offset;        /**< offset of the last index entry, 0 if none */
+    struct timespec max_ts;     /**< latest timestamp of all the notifications stored in the file */
+};
 
 /**
- * @brief Write notification into fd using vector IO.
+ * @brief Append states of all the modules storing notifications in this process, the stores of a single module
+ * are serialized by the replay lock.
+ */
+static struct {
+    pthread_mutex_t lock;       /**< lock for accessing the heads */
+    struct srpntf_head **heads; /**< append states */
+    uint32_t count;             /**< count of heads */
+} srpntf_heads = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/** maximum number of notifications written using a single writev() */
+#define SRPNTF_WRITEV_BATCH 64
+
+/** size of a notification record in a file */
+#define SRPNTF_RECORD_SIZE(notif_len) (sizeof(struct timespec) + sizeof(uint32_t) + ((notif_len) & ~SRPNTF_LEN_LYB))
+
+/**
+ * @brief Write notifications into fd using vector IO and sync them once.
  *
- * @param[in] notif_json Notification in JSON format.
- * @param[in] notif_json_len Length of notification in JSON format.
- * @param[in] notif_ts Notification timestamp.
+ * @param[in] fd File descriptor.
+ * @param[in] notif_data Notifications in the plugin format.
+ * @param[in] notif_lens Lengths of the notifications with the format flag.
+ * @param[in] notif_ts Notification timestamps.
+ * @param[in] count Count of notifications.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-srpntf_writev_notif(int fd, const char *notif_json, uint32_t notif_json_len, const struct timespec *notif_ts)
+srpntf_writev_notifs(int fd, char **notif_data, uint32_t *notif_lens, const struct timespec *notif_ts, uint32_t count)
 {
     sr_error_info_t *err_info = NULL;
-    struct iovec iov[3];
-
-    /* timestamp */
-    iov[0].iov_base = (void *)notif_ts;
-    iov[0].iov_len = sizeof *notif_ts;
-
-    /* notification length */
-    iov[1].iov_base = &notif_json_len;
-    iov[1].iov_len = sizeof notif_json_len;
-
-    /* notification */
-    iov[2].iov_base = (void *)notif_json;
-    iov[2].iov_len = notif_json_len;
+    struct iovec iov[SRPNTF_WRITEV_BATCH * 3];
+    uint32_t i, j;
+
+    for (i = 0; i < count; i += j) {
+        for (j = 0; (j < SRPNTF_WRITEV_BATCH) && (i + j < count); ++j) {
+            /* timestamp */
+            iov[j * 3].iov_base = (void *)&notif_ts[i + j];
+            iov[j * 3].iov_len = sizeof *notif_ts;
+
+            /* notification length with the format */
+            iov[j * 3 + 1].iov_base = &notif_lens[i + j];
+            iov[j * 3 + 1].iov_len = sizeof *notif_lens;
+
+            /* notification */
+            iov[j * 3 + 2].iov_base = notif_data[i + j];
+            iov[j * 3 + 2].iov_len = notif_lens[i + j] & ~SRPNTF_LEN_LYB;
+        }
 
-    /* write the vector */
-    if ((err_info = srpjson_writev(srpntf_name, fd, iov, 3))) {
-        return err_info;
+        /* write the vector */
+        if ((err_info = srpjson_writev(srpntf_name, fd, iov, j * 3))) {
+            return err_info;
+        }
     }
 
     /* fsync */
@@ -98,7 +158,7 @@ srpntf_read_ts(int notif_fd, struct timespec *notif_ts)
  *
  * @param[in] notif_fd Notification file descriptor.
  * @param[in] ly_ctx libyang context.
- * @param[out] notif Notification data tree.
+ * @param[out] notif Notification data tree, NULL if it was skipped.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
@@ -108,11 +168,14 @@ srpntf_read_notif(int notif_fd, struct ly_ctx *ly_ctx, struct lyd_node **notif)
     char *notif_json = NULL;
     struct ly_in *in = NULL;
     uint32_t notif_json_len;
+    LYD_FORMAT format;
 
-    /* read the length */
+    /* read the length and learn the format */
     if ((err_info = srpjson_read(srpntf_name, notif_fd, &notif_json_len, sizeof notif_json_len))) {
         goto cleanup;
     }
+    format = (notif_json_len & SRPNTF_LEN_LYB) ? LYD_LYB : LYD_JSON;
+    notif_json_len &= ~SRPNTF_LEN_LYB;
 
     /* read the notification */
     notif_json = malloc(notif_json_len + 1);
@@ -128,7 +191,13 @@ srpntf_read_notif(int notif_fd, struct ly_ctx *ly_ctx, struct lyd_node **notif)
 
     /* parse the notification */
     ly_in_new_memory(notif_json, &in);
-    if (lyd_parse_op(ly_ctx, NULL, in, LYD_JSON, LYD_TYPE_NOTIF_YANG, notif, NULL)) {
+    if (lyd_parse_op(ly_ctx, NULL, in, format, LYD_TYPE_NOTIF_YANG, notif, NULL)) {
+        if (format == LYD_LYB) {
+            /* LYB data are bound to the YANG modules they were printed with, which may have changed since */
+            SRPLG_LOG_WRN(srpntf_name, "Skipping a stored LYB notification not matching the current modules.");
+            *notif = NULL;
+            goto cleanup;
+        }
         err_info = srpjson_log_err_ly(srpntf_name, ly_ctx);
         goto cleanup;
     }
@@ -155,6 +224,7 @@ srpntf_skip_notif(int notif_fd)
     if ((err_info = srpjson_read(srpntf_name, notif_fd, &notif_json_len, sizeof notif_json_len))) {
         return err_info;
     }
+    notif_json_len &= ~SRPNTF_LEN_LYB;
 
     /* skip the notification */
     if (lseek(notif_fd, notif_json_len, SEEK_CUR) == -1) {
@@ -165,6 +235,86 @@ srpntf_skip_notif(int notif_fd)
     return NULL;
 }
 
+/**
+ * @brief Seek in a notification file right before a notification that may be the first with a timestamp
+ * no earlier than a start time, if its index allows it.
+ *
+ * @param[in] mod_name Module name.
+ * @param[in] from_ts Earliest stored notification in the file.
+ * @param[in] notif_fd Notification file descriptor at the beginning of the file.
+ * @param[in] start Start time.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srpntf_index_seek(const char *mod_name, time_t from_ts, int notif_fd, const struct timespec *start)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srpntf_idx_entry *entries = NULL;
+    struct stat st;
+    uint32_t count, lo, hi, mid;
+    uint64_t offset = 0;
+    char *path = NULL;
+    int fd = -1;
+
+    if ((err_info = srpjson_get_notif_index_path(srpntf_name, mod_name, from_ts, &path))) {
+        goto cleanup;
+    }
+
+    /* read the whole index, if any */
+    fd = srpjson_open(srpntf_name, path, O_RDONLY, 0);
+    if ((fd == -1) || (fstat(fd, &st) == -1)) {
+        goto cleanup;
+    }
+    count = st.st_size / sizeof *entries;
+    if (!count) {
+        /* no entries */
+        goto cleanup;
+    }
+    entries = malloc(count * sizeof *entries);
+    if (!entries) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    if (pread(fd, entries, count * sizeof *entries, 0) != (ssize_t)(count * sizeof *entries)) {
+        goto cleanup;
+    }
+
+    /* find the first entry preceded by a later or equal notification */
+    lo = 0;
+    hi = count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (srpjson_time_cmp(&entries[mid].ts, start) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (!lo) {
+        /* the first notification may be the one */
+        goto cleanup;
+    }
+    offset = entries[lo - 1].offset;
+
+    /* the index is written after the notifications, but check it anyway */
+    if ((fstat(notif_fd, &st) == -1) || (offset > (uint64_t)st.st_size)) {
+        goto cleanup;
+    }
+
+    if (lseek(notif_fd, offset, SEEK_SET) == -1) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_SYS, "Lseek failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    free(entries);
+    free(path);
+    return err_info;
+}
+
 /**
  * @brief Open notification replay file.
  *
@@ -259,6 +409,10 @@ srpntf_find_file(const char *mod_name, time_t from_ts, time_t to_ts, time_t *fil
         /* read timestamps */
         errno = 0;
         ts1 = strtoull(dirent->d_name + pref_len, &ptr, 10);
+        if (!errno && !strcmp(ptr, SRPJSON_NOTIF_INDEX_SUFFIX)) {
+            /* timestamp index file */
+            continue;
+        }
         if (errno || (ptr[0] != '-')) {
             SRPLG_LOG_WRN(srpntf_name, "Invalid notification file \"%s\" encountered.", dirent->d_name);
             continue;
@@ -364,6 +518,278 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Get the append state of a module, create it if it does not exist yet.
+ *
+ * @param[in] mod_name Module name.
+ * @param[out] head Append state of the module.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srpntf_head_get(const char *mod_name, struct srpntf_head **head)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srpntf_head **mem;
+    uint32_t i;
+
+    *head = NULL;
+
+    /* HEADS LOCK */
+    pthread_mutex_lock(&srpntf_heads.lock);
+
+    for (i = 0; i < srpntf_heads.count; ++i) {
+        if (!strcmp(srpntf_heads.heads[i]->mod_name, mod_name)) {
+            *head = srpntf_heads.heads[i];
+            goto cleanup;
+        }
+    }
+
+    /* new head */
+    mem = realloc(srpntf_heads.heads, (srpntf_heads.count + 1) * sizeof *srpntf_heads.heads);
+    if (!mem) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    srpntf_heads.heads = mem;
+
+    *head = calloc(1, sizeof **head);
+    if (!*head || !((*head)->mod_name = strdup(mod_name))) {
+        free(*head);
+        *head = NULL;
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
+        goto cleanup;
+    }
+    (*head)->fd = -1;
+    (*head)->idx_fd = -1;
+    srpntf_heads.heads[srpntf_heads.count++] = *head;
+
+cleanup:
+    /* HEADS UNLOCK */
+    pthread_mutex_unlock(&srpntf_heads.lock);
+    return err_info;
+}
+
+/**
+ * @brief Close the files of an append state.
+ *
+ * @param[in] head Append state to close.
+ */
+static void
+srpntf_head_close(struct srpntf_head *head)
+{
+    if (head->fd > -1) {
+        close(head->fd);
+        head->fd = -1;
+    }
+    if (head->idx_fd > -1) {
+        close(head->idx_fd);
+        head->idx_fd = -1;
+    }
+    free(head->path);
+    head->path = NULL;
+}
+
+/**
+ * @brief Check whether an append state is still valid. Other processes may have stored notifications
+ * or the file may have been rotated.
+ *
+ * @param[in] head Append state to check.
+ * @return Whether the state is valid.
+ */
+static int
+srpntf_head_valid(const struct srpntf_head *head)
+{
+    struct stat st;
+
+    if (head->fd == -1) {
+        return 0;
+    }
+
+    /* nothing was appended, not even the end-of-file marker */
+    if ((fstat(head->fd, &st) == -1) || (st.st_size != head->size)) {
+        return 0;
+    }
+
+    /* the file was not renamed or moved */
+    if ((stat(head->path, &st) == -1) || (st.st_dev != head->dev) || (st.st_ino != head->ino)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Open the timestamp index of the notification file of an append state.
+ *
+ * @param[in] head Append state.
+ * @param[in] create Whether to create a new empty index.
+ */
+static void
+srpntf_head_index_open(struct srpntf_head *head, int create)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    if ((err_info = srpjson_get_notif_index_path(srpntf_name, head->mod_name, head->from_ts, &path))) {
+        srplg_errinfo_free(&err_info);
+        return;
+    }
+
+    if (create) {
+        head->idx_fd = srpjson_open(srpntf_name, path, O_RDWR | O_APPEND | O_CREAT | O_TRUNC, SRPJSON_NOTIF_PERM);
+    } else {
+        head->idx_fd = srpjson_open(srpntf_name, path, O_RDWR | O_APPEND, 0);
+    }
+    if ((head->idx_fd == -1) && (create || (errno != ENOENT))) {
+        SRPLG_LOG_WRN(srpntf_name, "Opening notification index \"%s\" failed (%s).", strrchr(path, '/') + 1,
+                strerror(errno));
+    }
+    free(path);
+}
+
+/**
+ * @brief Add an entry into the timestamp index, if due, after a notification was appended.
+ *
+ * The index is only an optimization so it is removed on any error, an incomplete index could skip notifications.
+ *
+ * @param[in] head Append state.
+ * @param[in] offset Offset of the appended notification.
+ * @param[in] notif_ts Timestamp of the appended notification.
+ */
+static void
+srpntf_head_index(struct srpntf_head *head, off_t offset, const struct timespec *notif_ts)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srpntf_idx_entry entry;
+    char *path = NULL;
+
+    if ((head->idx_fd > -1) && offset && ((uint64_t)offset >= head->idx_offset + SRPJSON_NOTIF_INDEX_INTERVAL * 1024)) {
+        entry.ts = head->max_ts;
+        entry.offset = offset;
+        if (write(head->idx_fd, &entry, sizeof entry) == sizeof entry) {
+            head->idx_offset = offset;
+        } else {
+            close(head->idx_fd);
+            head->idx_fd = -1;
+            if (!(err_info = srpjson_get_notif_index_path(srpntf_name, head->mod_name, head->from_ts, &path))) {
+                SRPLG_LOG_WRN(srpntf_name, "Writing notification index \"%s\" failed, removing it.",
+                        strrchr(path, '/') + 1);
+                unlink(path);
+                free(path);
+            }
+            srplg_errinfo_free(&err_info);
+        }
+    }
+
+    if (srpjson_time_cmp(notif_ts, &head->max_ts) > 0) {
+        head->max_ts = *notif_ts;
+    }
+}
+
+/**
+ * @brief Load the append state of the latest notification file of a module from the files.
+ *
+ * @param[in] head Append state to load.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srpntf_head_load(struct srpntf_head *head)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srpntf_idx_entry entry;
+    struct timespec ts;
+    struct stat st;
+    int fd = -1;
+
+    srpntf_head_close(head);
+    memset(&head->max_ts, 0, sizeof head->max_ts);
+    head->idx_offset = 0;
+
+    /* find the latest notification file, the only readdir */
+    if ((err_info = srpntf_find_file(head->mod_name, 0, 0, &head->from_ts, &head->to_ts))) {
+        goto cleanup;
+    }
+    if (!head->from_ts) {
+        /* no notifications stored */
+        goto cleanup;
+    }
+
+    /* open it for appending */
+    if ((err_info = srpjson_get_notif_path(srpntf_name, head->mod_name, head->from_ts, head->to_ts, &head->path))) {
+        goto cleanup;
+    }
+    head->fd = srpjson_open(srpntf_name, head->path, O_RDWR | O_APPEND, 0);
+    if (head->fd == -1) {
+        err_info = srpjson_open_error(srpntf_name, head->path);
+        goto cleanup;
+    }
+    if (fstat(head->fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_SYS, "Fstat failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+    head->dev = st.st_dev;
+    head->ino = st.st_ino;
+    head->size = st.st_size;
+
+    if ((head->size >= (off_t)sizeof ts) && (pread(head->fd, &ts, sizeof ts, head->size - sizeof ts) == sizeof ts) &&
+            !ts.tv_sec && !ts.tv_nsec) {
+        /* end-of-file marker, the file is full */
+        close(head->fd);
+        head->fd = -1;
+        goto cleanup;
+    }
+
+    srpntf_head_index_open(head, 0);
+    if (head->idx_fd == -1) {
+        /* no index to maintain */
+        goto cleanup;
+    }
+
+    /* learn the last index entry */
+    if ((fstat(head->idx_fd, &st) == -1) || ((st.st_size >= (off_t)sizeof entry) &&
+            (pread(head->idx_fd, &entry, sizeof entry, (st.st_size / sizeof entry - 1) * sizeof entry) != sizeof entry))) {
+        close(head->idx_fd);
+        head->idx_fd = -1;
+        goto cleanup;
+    }
+    if (st.st_size >= (off_t)sizeof entry) {
+        head->max_ts = entry.ts;
+        head->idx_offset = entry.offset;
+    }
+
+    /* and the latest timestamp of all the notifications after it */
+    if ((err_info = srpntf_open_file(head->mod_name, head->from_ts, head->to_ts, O_RDONLY, &fd))) {
+        goto cleanup;
+    }
+    if (lseek(fd, head->idx_offset, SEEK_SET) == -1) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_SYS, "Lseek failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+    while (1) {
+        if ((err_info = srpntf_read_ts(fd, &ts))) {
+            goto cleanup;
+        }
+        if (!ts.tv_sec) {
+            break;
+        }
+        if (srpjson_time_cmp(&ts, &head->max_ts) > 0) {
+            head->max_ts = ts;
+        }
+        if ((err_info = srpntf_skip_notif(fd))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    if (err_info) {
+        srpntf_head_close(head);
+    }
+    return err_info;
+}
+
 static sr_error_info_t *
 srpntf_json_enable(const struct lys_module *mod)
 {
@@ -393,96 +819,191 @@ cleanup:
 static sr_error_info_t *
 srpntf_json_disable(const struct lys_module *mod)
 {
-    (void)mod;
+    struct srpntf_head *head;
+    uint32_t i;
+
+    /* HEADS LOCK */
+    pthread_mutex_lock(&srpntf_heads.lock);
+
+    /* forget the append state, no notifications are being stored */
+    for (i = 0; i < srpntf_heads.count; ++i) {
+        head = srpntf_heads.heads[i];
+        if (!strcmp(head->mod_name, mod->name)) {
+            srpntf_head_close(head);
+            free(head->mod_name);
+            free(head);
+            srpntf_heads.heads[i] = srpntf_heads.heads[--srpntf_heads.count];
+            break;
+        }
+    }
+
+    /* HEADS UNLOCK */
+    pthread_mutex_unlock(&srpntf_heads.lock);
 
     return NULL;
 }
 
+/**
+ * @brief Create a new notification file of an append state, the current one is full.
+ *
+ * @param[in] head Append state.
+ * @param[in] notif_ts Timestamp of the first notification to be stored in the new file.
+ * @return err_info, NULL on success.
+ */
 static sr_error_info_t *
-srpntf_json_store(const struct lys_module *mod, const struct lyd_node *notif, const struct timespec *notif_ts)
+srpntf_head_new_file(struct srpntf_head *head, const struct timespec *notif_ts)
 {
     sr_error_info_t *err_info = NULL;
-    int fd = -1;
-    struct ly_out *out = NULL;
+    struct timespec eof_ts = {0};
+    struct iovec iov;
     struct stat st;
-    char *notif_json = NULL;
-    uint32_t notif_json_len;
-    time_t from_ts, to_ts;
-    size_t file_size;
 
-    /* create out */
-    if (ly_out_new_memory(&notif_json, 0, &out)) {
-        err_info = srpjson_log_err_ly(srpntf_name, mod->ctx);
-        goto cleanup;
+    if (head->fd > -1) {
+        /* mark the end of the current file for other processes and readers */
+        iov.iov_base = &eof_ts;
+        iov.iov_len = sizeof eof_ts;
+        if ((err_info = srpjson_writev(srpntf_name, head->fd, &iov, 1))) {
+            return err_info;
+        }
     }
+    srpntf_head_close(head);
 
-    /* convert notification into JSON */
-    if (lyd_print_all(out, notif, LYD_JSON, LYD_PRINT_SHRINK)) {
-        err_info = srpjson_log_err_ly(srpntf_name, mod->ctx);
-        goto cleanup;
+    /* creating a new file */
+    head->from_ts = notif_ts->tv_sec;
+    head->to_ts = notif_ts->tv_sec;
+    if ((err_info = srpjson_get_notif_path(srpntf_name, head->mod_name, head->from_ts, head->to_ts, &head->path))) {
+        return err_info;
+    }
+    if ((err_info = srpntf_open_file(head->mod_name, head->from_ts, head->to_ts, O_RDWR | O_APPEND | O_CREAT | O_EXCL,
+            &head->fd))) {
+        return err_info;
+    }
+    if (fstat(head->fd, &st) == -1) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_SYS, "Fstat failed (%s).", strerror(errno));
+        return err_info;
     }
+    head->dev = st.st_dev;
+    head->ino = st.st_ino;
+    head->size = 0;
+    memset(&head->max_ts, 0, sizeof head->max_ts);
+    head->idx_offset = 0;
+    srpntf_head_index_open(head, 1);
 
-    /* learn its length */
-    notif_json_len = ly_out_printed(out);
+    return NULL;
+}
 
-    /* find the latest notification file for this module */
-    if ((err_info = srpntf_find_file(mod->name, 0, 0, &from_ts, &to_ts))) {
+static sr_error_info_t *
+srpntf_json_store_batch(const struct lys_module *mod, const struct lyd_node **notifs, const struct timespec *notif_ts,
+        uint32_t count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srpntf_head *head = NULL;
+    struct ly_out *out = NULL;
+    char **notif_data = NULL;
+    uint32_t *notif_lens = NULL, i, j, k;
+    off_t size;
+    time_t to_ts;
+
+    notif_data = calloc(count, sizeof *notif_data);
+    notif_lens = malloc(count * sizeof *notif_lens);
+    if (!notif_data || !notif_lens) {
+        srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_NO_MEMORY, "Memory allocation failed.");
         goto cleanup;
     }
 
-    if (from_ts && to_ts) {
-        /* open the file */
-        if ((err_info = srpntf_open_file(mod->name, from_ts, to_ts, O_WRONLY | O_APPEND, &fd))) {
+    /* convert the notifications into the plugin format */
+    for (i = 0; i < count; ++i) {
+        if (ly_out_new_memory(&notif_data[i], 0, &out)) {
+            err_info = srpjson_log_err_ly(srpntf_name, mod->ctx);
             goto cleanup;
         }
-
-        /* get file size */
-        if (fstat(fd, &st) == -1) {
-            srplg_log_errinfo(&err_info, srpntf_name, NULL, SR_ERR_SYS, "Fstat failed (%s).", strerror(errno));
+        if (lyd_print_all(out, notifs[i], SRPNTF_FORMAT, LYD_PRINT_SHRINK)) {
+            err_info = srpjson_log_err_ly(srpntf_name, mod->ctx);
             goto cleanup;
         }
-        file_size = st.st_size;
 
-        if (file_size + sizeof *notif_ts + sizeof notif_json_len + notif_json_len <= SRPJSON_NOTIF_FILE_MAX_SIZE * 1024) {
-            /* add the notification into the file if there is still space */
-            if ((err_info = srpntf_writev_notif(fd, notif_json, notif_json_len, notif_ts))) {
-                goto cleanup;
-            }
+        /* learn its length */
+        notif_lens[i] = ly_out_printed(out);
+        if (SRPNTF_FORMAT == LYD_LYB) {
+            notif_lens[i] |= SRPNTF_LEN_LYB;
+        }
+        ly_out_free(out, NULL, 0);
+        out = NULL;
+    }
+
+    /* get the latest notification file for this module, load it only if another process stored a notification */
+    if ((err_info = srpntf_head_get(mod->name, &head))) {
+        goto cleanup;
+    }
+    if (!srpntf_head_valid(head) && (err_info = srpntf_head_load(head))) {
+        goto cleanup;
+    }
 
-            /* update notification file name */
-            if ((err_info = srpntf_rename_file(mod->name, from_ts, to_ts, notif_ts->tv_sec))) {
+    for (i = 0; i < count; i += j) {
+        /* learn how many notifications still fit into the file, a new file gets at least one */
+        j = 0;
+        if (head->fd > -1) {
+            for (size = head->size; i + j < count; ++j) {
+                if (size && (size + SRPNTF_RECORD_SIZE(notif_lens[i + j]) > SRPJSON_NOTIF_FILE_MAX_SIZE * 1024)) {
+                    break;
+                }
+                size += SRPNTF_RECORD_SIZE(notif_lens[i + j]);
+            }
+        }
+        if (!j) {
+            if ((err_info = srpntf_head_new_file(head, &notif_ts[i]))) {
                 goto cleanup;
             }
+            continue;
+        }
 
-            /* we are done */
+        /* add the notifications into the file */
+        if ((err_info = srpntf_writev_notifs(head->fd, notif_data + i, notif_lens + i, notif_ts + i, j))) {
             goto cleanup;
         }
+        to_ts = head->to_ts;
+        for (k = i; k < i + j; ++k) {
+            srpntf_head_index(head, head->size, &notif_ts[k]);
+            head->size += SRPNTF_RECORD_SIZE(notif_lens[k]);
+            if (notif_ts[k].tv_sec > to_ts) {
+                to_ts = notif_ts[k].tv_sec;
+            }
+        }
 
-        /* we will create a new file, close this one */
-        close(fd);
-        fd = -1;
-    }
-
-    /* creating a new file */
-    if ((err_info = srpntf_open_file(mod->name, notif_ts->tv_sec, notif_ts->tv_sec,
-            O_WRONLY | O_APPEND | O_CREAT | O_EXCL, &fd))) {
-        goto cleanup;
-    }
-
-    /* write the notification */
-    if ((err_info = srpntf_writev_notif(fd, notif_json, notif_json_len, notif_ts))) {
-        goto cleanup;
+        /* update notification file name */
+        if (to_ts > head->to_ts) {
+            if ((err_info = srpntf_rename_file(mod->name, head->from_ts, head->to_ts, to_ts))) {
+                goto cleanup;
+            }
+            head->to_ts = to_ts;
+            free(head->path);
+            head->path = NULL;
+            if ((err_info = srpjson_get_notif_path(srpntf_name, mod->name, head->from_ts, head->to_ts, &head->path))) {
+                goto cleanup;
+            }
+        }
     }
 
 cleanup:
+    if (err_info && head) {
+        /* unknown state of the files */
+        srpntf_head_close(head);
+    }
     ly_out_free(out, NULL, 0);
-    if (fd > -1) {
-        close(fd);
+    for (i = 0; notif_data && (i < count); ++i) {
+        free(notif_data[i]);
     }
-    free(notif_json);
+    free(notif_data);
+    free(notif_lens);
     return err_info;
 }
 
+static sr_error_info_t *
+srpntf_json_store(const struct lys_module *mod, const struct lyd_node *notif, const struct timespec *notif_ts)
+{
+    return srpntf_json_store_batch(mod, &notif, notif_ts, 1);
+}
+
 struct srpntf_rn_state {
     time_t file_from;
     time_t file_to;
@@ -531,7 +1052,12 @@ srpntf_json_replay_next(const struct lys_module *mod, const struct timespec *sta
             goto cleanup;
         }
 
-        /* skip all earlier notifications */
+        /* skip most of the earlier notifications using the index */
+        if ((err_info = srpntf_index_seek(mod->name, st->file_from, st->fd, start))) {
+            goto cleanup;
+        }
+
+        /* skip all the remaining earlier notifications */
         while (1) {
             /* read timestamp */
             if ((err_info = srpntf_read_ts(st->fd, notif_ts))) {
@@ -553,9 +1079,10 @@ srpntf_json_replay_next(const struct lys_module *mod, const struct timespec *sta
         /* replay notifications until stop is reached */
         while (notif_ts->tv_sec && (srpjson_time_cmp(notif_ts, stop) < 0)) {
 
-            /* parse notification, return it */
-            err_info = srpntf_read_notif(st->fd, mod->ctx, notif);
-            goto cleanup;
+            /* parse notification, return it unless skipped */
+            if ((err_info = srpntf_read_notif(st->fd, mod->ctx, notif)) || *notif) {
+                goto cleanup;
+            }
 
 next_notif:
             /* read next timestamp */
@@ -793,7 +1320,7 @@ cleanup:
     return err_info;
 }
 
-const struct srplg_ntf_s srpntf_json = {
+const struct srplg_ntf_s SRPNTF_PLUGIN = {
     .name = srpntf_name,
     .enable_cb = srpntf_json_enable,
     .disable_cb = srpntf_json_disable,
@@ -803,4 +1330,5 @@ const struct srplg_ntf_s srpntf_json = {
     .access_set_cb = srpntf_json_access_set,
     .access_get_cb = srpntf_json_access_get,
     .access_check_cb = srpntf_json_access_check,
+    .store_batch_cb = srpntf_json_store_batch,
 };
@@ -0,0 +1,28 @@
+/**
+ * @file ntf_lyb.c
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief internal LYB notifications plugin
+ *
+ * @copyright
+ * Copyright (c) 2021 - 2023 Deutsche Telekom AG.
+ * Copyright (c) 2021 - 2023 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/*
+ * The plugin is the JSON notif plugin storing the notifications in the binary LYB format, which is parsed without
+ * resolving the values from their canonical strings again. Every record is flagged with its format and both plugins
+ * read both formats from the same files so the plugin of a module can be changed without losing its notifications.
+ * LYB notifications are bound to the YANG modules they were printed with and are skipped if they no longer match.
+ */
+
+#define srpntf_name "LYB notif"    /**< plugin name */
+#define SRPNTF_FORMAT LYD_LYB      /**< format of the stored notifications */
+#define SRPNTF_PLUGIN srpntf_lyb   /**< plugin structure */
+
+#include "ntf_json.c"
@@ -275,7 +275,8 @@ typedef sr_error_info_t *(*srds_last_modif)(const struct lys_module *mod, sr_dat
  * the timestamp written may be the same, which is a CRITICAL problem because the old data would be considered current.
  *
  * @param[in] mod Specific module.
- * @param[in] ds Specific datastore, set always to ::SR_DS_RUNNING.
+ * @param[in] ds Specific datastore, ::SR_DS_RUNNING or, if the data of the datastore are cached (::SR_CONN_CACHE_DS),
+ * ::SR_DS_STARTUP or ::SR_DS_FACTORY_DEFAULT.
  * @param[in] plg_data Plugin data.
  * @param[out] version Current data version, different than the previous if data changed since then.
  * @return NULL on success;
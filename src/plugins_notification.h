@@ -40,7 +40,7 @@ extern "C" {
 /**
  * @brief Notification plugin API version
  */
-#define SRPLG_NTF_API_VERSION 3
+#define SRPLG_NTF_API_VERSION 4
 
 /**
  * @brief Initialize notification storage for a specific module.
@@ -76,6 +76,22 @@ typedef sr_error_info_t *(*srntf_disable)(const struct lys_module *mod);
 typedef sr_error_info_t *(*srntf_store)(const struct lys_module *mod, const struct lyd_node *notif,
         const struct timespec *notif_ts);
 
+/**
+ * @brief Store several notifications of a module for replay at once, optional callback.
+ *
+ * Called instead of ::srntf_store() for the notifications buffered by a session, which should be written
+ * at once instead of one by one.
+ *
+ * @param[in] mod Specific module.
+ * @param[in] notifs Notification data trees, in the order they should be stored.
+ * @param[in] notif_ts Notification timestamps.
+ * @param[in] count Count of @p notifs and @p notif_ts.
+ * @return NULL on success;
+ * @return Sysrepo error info on error.
+ */
+typedef sr_error_info_t *(*srntf_store_batch)(const struct lys_module *mod, const struct lyd_node **notifs,
+        const struct timespec *notif_ts, uint32_t count);
+
 /**
  * @brief Replay the next notification of a module.
  *
@@ -153,6 +169,7 @@ struct srplg_ntf_s {
     srntf_access_set access_set_cb; /**< callback for setting access rights for notification data */
     srntf_access_get access_get_cb; /**< callback got getting access rights for notification data */
     srntf_access_check access_check_cb; /**< callback for checking user access to notificaion data */
+    srntf_store_batch store_batch_cb;   /**< optional callback for storing several notifications at once */
 };
 
 /**
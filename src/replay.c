@@ -41,19 +41,22 @@
 #include "sysrepo.h"
 
 /**
- * @brief Store the notification for replay.
+ * @brief Store notifications of a module for replay.
  *
  * @param[in] conn Connection to use.
  * @param[in] shm_mod Notification SHM module.
- * @param[in] notif Notification data tree.
- * @param[in] notif_ts Notification timestamp.
+ * @param[in] notifs Notification data trees.
+ * @param[in] notif_ts Notification timestamps.
+ * @param[in] count Count of @p notifs and @p notif_ts.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_notif_write(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const struct lyd_node *notif, struct timespec notif_ts)
+sr_notif_write(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const struct lyd_node **notifs, const struct timespec *notif_ts,
+        uint32_t count)
 {
     sr_error_info_t *err_info = NULL;
     const struct sr_ntf_handle_s *ntf_handle;
+    uint32_t i;
 
     /* find handle */
     if ((err_info = sr_ntf_handle_find(conn->mod_shm.addr + shm_mod->plugins[SR_MOD_DS_NOTIF], conn, &ntf_handle))) {
@@ -65,12 +68,25 @@ sr_notif_write(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const struct lyd_node *no
         goto cleanup;
     }
 
-    /* store the notification */
-    if ((err_info = ntf_handle->plugin->store_cb(lyd_owner_module(notif), notif, &notif_ts))) {
-        goto cleanup_unlock;
+    SR_PROBE(notif__store__start, lyd_owner_module(notifs[0])->name, count);
+
+    if (ntf_handle->plugin->store_batch_cb) {
+        /* store all the notifications at once */
+        if ((err_info = ntf_handle->plugin->store_batch_cb(lyd_owner_module(notifs[0]), notifs, notif_ts, count))) {
+            goto cleanup_unlock;
+        }
+    } else {
+        /* store the notifications one by one */
+        for (i = 0; i < count; ++i) {
+            if ((err_info = ntf_handle->plugin->store_cb(lyd_owner_module(notifs[i]), notifs[i], &notif_ts[i]))) {
+                goto cleanup_unlock;
+            }
+        }
     }
 
 cleanup_unlock:
+    SR_PROBE(notif__store__done, lyd_owner_module(notifs[0])->name, count, err_info ? 1 : 0);
+
     /* REPLAY WRITE UNLOCK */
     sr_rwunlock(&shm_mod->replay_lock, SR_MOD_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
 cleanup:
@@ -179,7 +195,7 @@ sr_replay_store(sr_session_ctx_t *sess, const struct lyd_node *notif, struct tim
 
     if (!has_buf) {
         /* write the notification to a replay file */
-        if ((err_info = sr_notif_write(sess->conn, shm_mod, notif, notif_ts))) {
+        if ((err_info = sr_notif_write(sess->conn, shm_mod, &notif, &notif_ts, 1))) {
             return err_info;
         }
     }
@@ -204,29 +220,43 @@ static sr_error_info_t *
 sr_notif_buf_thread_write_notifs(sr_conn_ctx_t *conn, struct sr_sess_notif_buf_node *first)
 {
     sr_error_info_t *err_info = NULL;
-    struct sr_sess_notif_buf_node *prev;
+    struct sr_sess_notif_buf_node *node, *next;
+    const struct lyd_node *notifs[SR_NOTIF_BUF_BATCH];
+    struct timespec notif_ts[SR_NOTIF_BUF_BATCH];
+    const struct lys_module *ly_mod;
     sr_mod_t *shm_mod;
+    uint32_t count;
 
     while (first) {
+        /* collect the following notifications of the same module */
+        ly_mod = lyd_owner_module(first->notif);
+        count = 0;
+        for (node = first; node && (count < SR_NOTIF_BUF_BATCH) && (lyd_owner_module(node->notif) == ly_mod);
+                node = node->next) {
+            notifs[count] = node->notif;
+            notif_ts[count] = node->notif_ts;
+            ++count;
+        }
+
         /* find SHM mod */
-        shm_mod = sr_shmmod_find_module(SR_CONN_MOD_SHM(conn), lyd_owner_module(first->notif)->name);
+        shm_mod = sr_shmmod_find_module(SR_CONN_MOD_SHM(conn), ly_mod->name);
         if (!shm_mod) {
             SR_ERRINFO_INT(&err_info);
             return err_info;
         }
 
-        /* store the notification */
-        if ((err_info = sr_notif_write(conn, shm_mod, first->notif, first->notif_ts))) {
+        /* store the notifications with a single replay lock */
+        if ((err_info = sr_notif_write(conn, shm_mod, notifs, notif_ts, count))) {
             return err_info;
         }
 
-        /* next iter */
-        prev = first;
-        first = first->next;
-
-        /* free prev */
-        lyd_free_siblings(prev->notif);
-        free(prev);
+        /* free them */
+        while (first != node) {
+            next = first->next;
+            lyd_free_siblings(first->notif);
+            free(first);
+            first = next;
+        }
     }
 
     return NULL;
@@ -295,92 +325,187 @@ cleanup:
     return err_info;
 }
 
-sr_error_info_t *
-sr_replay_notify(sr_conn_ctx_t *conn, const char *mod_name, uint32_t sub_id, const char *xpath,
-        const struct timespec *start_time, const struct timespec *stop_time, struct timespec *listen_since,
-        sr_event_notif_cb cb, sr_event_notif_tree_cb tree_cb, void *private_data)
+/**
+ * @brief Replay stream of a single notification subscription, with its next notification prefetched.
+ */
+struct sr_replay_stream_s {
+    const struct sr_replay_req_s *req;  /**< Replay request of the stream. */
+    const struct sr_ntf_handle_s *ntf_handle;   /**< Notification plugin handle of the module. */
+    const struct lys_module *ly_mod;    /**< Module of the notifications. */
+    struct timespec stop_ts;    /**< Only notifications with smaller timestamp are replayed. */
+    void *state;                /**< Replay plugin iterator state. */
+    struct lyd_node *notif;     /**< Prefetched next notification to replay, NULL if the stream is finished. */
+    struct timespec notif_ts;   /**< Timestamp of @p notif. */
+};
+
+/**
+ * @brief Prefetch the next notification of a replay stream matching its XPath filter.
+ *
+ * @param[in] stream Replay stream.
+ * @param[in,out] set Set used for XPath filter evaluation.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_replay_stream_next(struct sr_replay_stream_s *stream, struct ly_set **set)
+{
+    sr_error_info_t *err_info = NULL;
+
+    assert(!stream->notif);
+
+    while (!(err_info = stream->ntf_handle->plugin->replay_next_cb(stream->ly_mod, stream->req->start_time,
+            &stream->stop_ts, &stream->notif, &stream->notif_ts, &stream->state)) && stream->state) {
+        if (!stream->req->xpath) {
+            /* no filter */
+            break;
+        }
+
+        /* make sure the XPath filter matches something */
+        ly_set_free(*set, NULL);
+        *set = NULL;
+        SR_CHECK_INT_RET(lyd_find_xpath(stream->notif, stream->req->xpath, set), err_info);
+        if ((*set)->count) {
+            break;
+        }
+
+        /* filtered out, next */
+        lyd_free_siblings(stream->notif);
+        stream->notif = NULL;
+    }
+
+    if (err_info || !stream->state) {
+        /* error or no more notifications, the state was freed */
+        stream->state = NULL;
+        lyd_free_siblings(stream->notif);
+        stream->notif = NULL;
+    }
+    return err_info;
+}
+
+/**
+ * @brief Prepare a replay stream and prefetch its first notification.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] req Replay request of the stream.
+ * @param[out] stream Prepared replay stream.
+ * @param[in,out] set Set used for XPath filter evaluation.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_replay_stream_init(sr_conn_ctx_t *conn, const struct sr_replay_req_s *req, struct sr_replay_stream_s *stream,
+        struct ly_set **set)
 {
     sr_error_info_t *err_info = NULL;
-    const struct sr_ntf_handle_s *ntf_handle;
-    const struct lys_module *ly_mod;
     sr_mod_t *shm_mod;
-    struct timespec notif_ts, stop_ts;
-    struct ly_set *set = NULL;
-    struct lyd_node *notif = NULL, *notif_op;
-    sr_session_ctx_t *ev_sess = NULL;
-    void *state = NULL;
+
+    stream->req = req;
 
     /* get the stop timestamp - only notifications with smaller timestamp can be replayed */
-    if (!SR_TS_IS_ZERO(*stop_time) && (sr_time_cmp(stop_time, listen_since) < 1)) {
-        stop_ts = *stop_time;
+    if (!SR_TS_IS_ZERO(*req->stop_time) && (sr_time_cmp(req->stop_time, req->listen_since) < 1)) {
+        stream->stop_ts = *req->stop_time;
     } else {
-        stop_ts = *listen_since;
+        stream->stop_ts = *req->listen_since;
     }
 
     /* find SHM mod for replay lock and check if replay is even supported */
-    shm_mod = sr_shmmod_find_module(SR_CONN_MOD_SHM(conn), mod_name);
-    SR_CHECK_INT_GOTO(!shm_mod, err_info, cleanup);
-
-    /* create event session */
-    if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_NOTIF, NULL, &ev_sess))) {
-        goto cleanup;
-    }
+    shm_mod = sr_shmmod_find_module(SR_CONN_MOD_SHM(conn), req->mod_name);
+    SR_CHECK_INT_RET(!shm_mod, err_info);
 
     if (!shm_mod->replay_supp) {
-        SR_LOG_WRN("Module \"%s\" does not support notification replay.", mod_name);
-        goto replay_complete;
+        SR_LOG_WRN("Module \"%s\" does not support notification replay.", req->mod_name);
+        return NULL;
     }
 
     /* find module */
-    ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, mod_name);
-    assert(ly_mod);
+    stream->ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, req->mod_name);
+    assert(stream->ly_mod);
 
     /* find handle */
-    if ((err_info = sr_ntf_handle_find(conn->mod_shm.addr + shm_mod->plugins[SR_MOD_DS_NOTIF], conn, &ntf_handle))) {
+    if ((err_info = sr_ntf_handle_find(conn->mod_shm.addr + shm_mod->plugins[SR_MOD_DS_NOTIF], conn, &stream->ntf_handle))) {
+        return err_info;
+    }
+
+    /* prefetch the first notification */
+    return sr_replay_stream_next(stream, set);
+}
+
+sr_error_info_t *
+sr_replay_notify(sr_conn_ctx_t *conn, const struct sr_replay_req_s *reqs, uint32_t req_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_replay_stream_s *streams = NULL, *stream;
+    struct ly_set *set = NULL;
+    struct lyd_node *notif_op;
+    sr_session_ctx_t *ev_sess = NULL;
+    uint32_t i;
+
+    if (!req_count) {
+        return NULL;
+    }
+
+    /* create event session */
+    if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_NOTIF, NULL, &ev_sess))) {
         goto cleanup;
     }
 
-    /* replay all notifications */
-    while (!(err_info = ntf_handle->plugin->replay_next_cb(ly_mod, start_time, &stop_ts, &notif, &notif_ts, &state)) && state) {
-        /* make sure the XPath filter matches something */
-        if (xpath) {
-            ly_set_free(set, NULL);
-            SR_CHECK_INT_GOTO(lyd_find_xpath(notif, xpath, &set), err_info, cleanup);
+    /* prepare all the streams, only a single prefetched notification is held for each */
+    streams = calloc(req_count, sizeof *streams);
+    SR_CHECK_MEM_GOTO(!streams, err_info, cleanup);
+    for (i = 0; i < req_count; ++i) {
+        if ((err_info = sr_replay_stream_init(conn, &reqs[i], &streams[i], &set))) {
+            goto cleanup;
         }
+    }
 
-        if (!xpath || set->count) {
-            /* find notification node */
-            notif_op = notif;
-            if ((err_info = sr_ly_find_last_parent(&notif_op, LYS_NOTIF))) {
-                goto cleanup;
+    /* merge the streams, always replay the earliest prefetched notification */
+    while (1) {
+        stream = NULL;
+        for (i = 0; i < req_count; ++i) {
+            if (streams[i].notif && (!stream || (sr_time_cmp(&streams[i].notif_ts, &stream->notif_ts) < 0))) {
+                stream = &streams[i];
             }
-            SR_CHECK_INT_GOTO(notif_op->schema->nodetype != LYS_NOTIF, err_info, cleanup);
+        }
+        if (!stream) {
+            /* all the streams are finished */
+            break;
+        }
 
-            /* call callback */
-            if ((err_info = sr_notif_call_callback(ev_sess, cb, tree_cb, private_data, SR_EV_NOTIF_REPLAY, sub_id,
-                    notif_op, &notif_ts))) {
-                goto cleanup;
-            }
+        /* find notification node */
+        notif_op = stream->notif;
+        if ((err_info = sr_ly_find_last_parent(&notif_op, LYS_NOTIF))) {
+            goto cleanup;
         }
+        SR_CHECK_INT_GOTO(notif_op->schema->nodetype != LYS_NOTIF, err_info, cleanup);
 
-        /* next */
-        lyd_free_siblings(notif);
-        notif = NULL;
-    }
-    if (err_info) {
-        goto cleanup;
+        /* call callback */
+        if ((err_info = sr_notif_call_callback(ev_sess, stream->req->cb, stream->req->tree_cb, stream->req->private_data,
+                SR_EV_NOTIF_REPLAY, stream->req->sub_id, notif_op, &stream->notif_ts))) {
+            goto cleanup;
+        }
+
+        /* prefetch the next notification of this stream */
+        lyd_free_siblings(stream->notif);
+        stream->notif = NULL;
+        if ((err_info = sr_replay_stream_next(stream, &set))) {
+            goto cleanup;
+        }
     }
 
-replay_complete:
     /* replay is completed */
-    if ((err_info = sr_notif_call_callback(ev_sess, cb, tree_cb, private_data, SR_EV_NOTIF_REPLAY_COMPLETE, sub_id,
-            NULL, &stop_ts))) {
-        goto cleanup;
+    for (i = 0; i < req_count; ++i) {
+        if ((err_info = sr_notif_call_callback(ev_sess, reqs[i].cb, reqs[i].tree_cb, reqs[i].private_data,
+                SR_EV_NOTIF_REPLAY_COMPLETE, reqs[i].sub_id, NULL, &streams[i].stop_ts))) {
+            goto cleanup;
+        }
     }
 
 cleanup:
     sr_session_stop(ev_sess);
-    lyd_free_all(notif);
+    if (streams) {
+        for (i = 0; i < req_count; ++i) {
+            lyd_free_siblings(streams[i].notif);
+        }
+        free(streams);
+    }
     ly_set_free(set, NULL);
     return err_info;
 }
@@ -42,23 +42,33 @@ sr_error_info_t *sr_replay_store(sr_session_ctx_t *sess, const struct lyd_node *
 void *sr_notif_buf_thread(void *arg);
 
 /**
- * @brief Replay valid notifications.
+ * @brief Notification replay request of a single subscription.
+ */
+struct sr_replay_req_s {
+    const char *mod_name;       /**< Module name. */
+    uint32_t sub_id;            /**< Subscription ID. */
+    const char *xpath;          /**< Optional selected notifications. */
+    const struct timespec *start_time;  /**< Earliest notification of interest. */
+    const struct timespec *stop_time;   /**< Latest notification of interest. */
+    struct timespec *listen_since;  /**< Timestamp of the subscription listening for notifications. There must be
+                                         no notification replayed with a later timestamp because it will be received
+                                         as a realtime notification. */
+    sr_event_notif_cb cb;       /**< Notification callback to call. */
+    sr_event_notif_tree_cb tree_cb; /**< Notification tree callback to call. */
+    void *private_data;         /**< Notification callback private data. */
+};
+
+/**
+ * @brief Replay valid notifications of several subscriptions, merged by their timestamps.
+ *
+ * Replay iterators of all the requests are read in parallel with only the next notification of each prefetched
+ * so that the notifications are replayed in the timestamp order across all the modules.
  *
  * @param[in] conn Connection to use.
- * @param[in] mod_name Module name.
- * @param[in] sub_id Subscription ID.
- * @param[in] xpath Optional selected notifications.
- * @param[in] start_time Earliest notification of interest.
- * @param[in] stop_time Latest notification of interest.
- * @param[in] listen_since Timestamp of the subscription listening for notifications. There must be no notification
- * replayed with a later timestamp because it will be received as a realtime notification.
- * @param[in] callback Notification callback to call.
- * @param[in] tree_callback Notification tree callback to call.
- * @param[in] private_data Notification callback private data.
+ * @param[in] reqs Replay requests.
+ * @param[in] req_count Count of @p reqs.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_replay_notify(sr_conn_ctx_t *conn, const char *mod_name, uint32_t sub_id, const char *xpath,
-        const struct timespec *start_time, const struct timespec *stop_time, struct timespec *listen_since,
-        sr_event_notif_cb callback, sr_event_notif_tree_cb tree_callback, void *private_data);
+sr_error_info_t *sr_replay_notify(sr_conn_ctx_t *conn, const struct sr_replay_req_s *reqs, uint32_t req_count);
 
 #endif
@@ -36,6 +36,7 @@
 #include <libyang/libyang.h>
 
 #include "common.h"
+#include "config.h"
 #include "log.h"
 #include "shm_mod.h"
 #include "shm_sub.h"
@@ -69,8 +70,8 @@ sr_shmext_conn_remap_lock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int ext_lock
         if ((err_info = sr_file_get_size(conn->ext_shm.fd, &shm_file_size))) {
             goto error_ext_remap_unlock;
         }
-        if (shm_file_size != conn->ext_shm.size) {
-            /* ext SHM size changed and we need to remap it */
+        if ((shm_file_size != conn->ext_shm.size) && !SR_SHM_RESERVED(&conn->ext_shm, shm_file_size)) {
+            /* ext SHM size changed over the reserved address space and we need to remap it */
             if (mode == SR_LOCK_READ_UPGR) {
                 /* REMAP WRITE LOCK UPGRADE */
                 if ((err_info = sr_rwrelock(&conn->ext_remap_lock, SR_CONN_REMAP_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
@@ -130,17 +131,13 @@ void
 sr_shmext_conn_remap_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int ext_lock, const char *func)
 {
     sr_error_info_t *err_info = NULL;
-    sr_ext_hole_t *iter, *last = NULL;
+    sr_ext_hole_t *last;
     uint32_t last_size;
     size_t shm_file_size = 0;
 
     /* make ext SHM smaller if there is a memory hole at its end */
     if (((mode == SR_LOCK_WRITE) || (mode == SR_LOCK_WRITE_URGE)) && ext_lock) {
-        while ((iter = sr_ext_hole_next(last, SR_CONN_EXT_SHM(conn)))) {
-            last = iter;
-        }
-
-        if (last && ((uint32_t)((char *)last - conn->ext_shm.addr) + last->size == conn->ext_shm.size)) {
+        if ((last = sr_ext_hole_find_end(SR_CONN_EXT_SHM(conn), conn->ext_shm.size))) {
             if ((err_info = sr_file_get_size(conn->ext_shm.fd, &shm_file_size))) {
                 goto cleanup_unlock;
             }
@@ -186,12 +183,16 @@ sr_shmext_open(sr_shm_t *shm, int zero)
         goto error;
     }
 
+    /* reserve address space so that growing ext SHM does not require other connections to remap it */
+    shm->reserve = SR_SHM_RESERVE_SIZE;
+    shm->huge = sr_shm_hugepages();
+
     /* either zero the memory or keep it exactly the way it was */
     if ((err_info = sr_shm_remap(shm, zero ? SR_SHM_SIZE(sizeof(sr_ext_shm_t)) : 0))) {
         goto error;
     }
     if (zero) {
-        ((sr_ext_shm_t *)shm->addr)->first_hole_off = 0;
+        memset(shm->addr, 0, sizeof(sr_ext_shm_t));
     }
 
     return NULL;
@@ -288,6 +289,7 @@ sr_shmext_print(sr_mod_shm_t *mod_shm, sr_shm_t *shm_ext)
     int msg_len = 0;
     char *msg;
     sr_ext_hole_t *hole;
+    uint32_t class, off, class_count[SR_EXT_HOLE_CLASS_COUNT], largest;
     sr_ext_shm_t *ext_shm = (sr_ext_shm_t *)shm_ext->addr;
 
     if ((sr_stderr_ll < SR_LL_DBG) && (sr_syslog_ll < SR_LL_DBG) && !sr_lcb) {
@@ -301,10 +303,13 @@ sr_shmext_print(sr_mod_shm_t *mod_shm, sr_shm_t *shm_ext)
     }
 
     /* add all memory holes */
-    for (hole = sr_ext_hole_next(NULL, ext_shm); hole; hole = sr_ext_hole_next(hole, ext_shm)) {
-        if (sr_shmext_print_add_item(&items, &item_count, ((char *)hole) - shm_ext->addr, hole->size,
-                "memory hole (size %" PRIu32 ")", hole->size)) {
-            goto error;
+    for (class = 0; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        for (off = ext_shm->first_hole_off[class]; off; off = hole->next_hole_off) {
+            hole = (sr_ext_hole_t *)(shm_ext->addr + off);
+            if (sr_shmext_print_add_item(&items, &item_count, off, hole->size, "memory hole (size %" PRIu32 ")",
+                    hole->size)) {
+                goto error;
+            }
         }
     }
 
@@ -461,6 +466,24 @@ sr_shmext_print(sr_mod_shm_t *mod_shm, sr_shm_t *shm_ext)
     SR_LOG_DBG("#SHM:\n%s", msg);
     free(msg);
 
+    /* print memory hole statistics, fragmentation is the free memory not usable for the largest allocation */
+    sr_ext_hole_stats(ext_shm, class_count, &largest);
+    msg = NULL;
+    msg_len = 0;
+    printed = 0;
+    for (class = 0; class < SR_EXT_HOLE_CLASS_COUNT; ++class) {
+        if (class_count[class]) {
+            printed += sr_sprintf(&msg, &msg_len, printed, "%s %" PRIu32 "B+: %" PRIu32, printed ? "," : "",
+                    (uint32_t)SR_SHM_MEM_ALIGN << class, class_count[class]);
+        }
+    }
+    SR_LOG_DBG("#SHM holes: %" PRIu32 " holes of %" PRIu32 "B (%" PRIu32 "%% of ext SHM), largest %" PRIu32
+            "B, fragmentation %" PRIu32 "%%, by size class:%s", ext_shm->hole_count, ext_shm->hole_size,
+            (uint32_t)(((uint64_t)ext_shm->hole_size * 100) / shm_ext->size), largest,
+            ext_shm->hole_size ? (uint32_t)(((uint64_t)(ext_shm->hole_size - largest) * 100) / ext_shm->hole_size) : 0,
+            msg ? msg : " none");
+    free(msg);
+
     /* fail on an assert if something is wrong */
     cur_off = 0;
     for (i = 0; i < item_count; ++i) {
@@ -498,6 +521,254 @@ error:
     free(items);
 }
 
+int
+sr_shmext_compact_needed(sr_conn_ctx_t *conn)
+{
+    sr_ext_shm_t *ext_shm = SR_CONN_EXT_SHM(conn);
+
+    if (!ext_shm || (ext_shm->hole_size < SR_EXT_COMPACT_HOLE_MIN)) {
+        return 0;
+    }
+
+    return ((uint64_t)ext_shm->hole_size * 100) >= ((uint64_t)conn->ext_shm.size * SR_EXT_COMPACT_HOLE_PERC);
+}
+
+/**
+ * @brief Collect all the module and RPC subscription locks in the order they are to be locked.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[out] locks Array of all the subscription locks.
+ * @param[out] lock_count Count of @p locks.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmext_compact_collect_locks(sr_mod_shm_t *mod_shm, sr_rwlock_t ***locks, uint32_t *lock_count)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_mod_t *shm_mod;
+    sr_rpc_t *shm_rpc;
+    sr_datastore_t ds;
+    uint32_t i, j, count = 0;
+
+    *locks = NULL;
+    *lock_count = 0;
+
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        count += SR_DS_COUNT + 4 + SR_SHM_MOD_IDX(mod_shm, i)->rpc_count;
+    }
+    if (!count) {
+        return NULL;
+    }
+
+    *locks = malloc(count * sizeof **locks);
+    SR_CHECK_MEM_RET(!*locks, err_info);
+
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        shm_mod = SR_SHM_MOD_IDX(mod_shm, i);
+
+        for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+            (*locks)[(*lock_count)++] = &shm_mod->change_sub[ds].lock;
+        }
+        (*locks)[(*lock_count)++] = &shm_mod->oper_get_lock;
+        (*locks)[(*lock_count)++] = &shm_mod->oper_poll_lock;
+        (*locks)[(*lock_count)++] = &shm_mod->notif_lock;
+        (*locks)[(*lock_count)++] = &shm_mod->rpc_ext_lock;
+
+        shm_rpc = (sr_rpc_t *)(((char *)mod_shm) + shm_mod->rpcs);
+        for (j = 0; j < shm_mod->rpc_count; ++j) {
+            (*locks)[(*lock_count)++] = &shm_rpc[j].lock;
+        }
+    }
+    assert(*lock_count == count);
+
+    return NULL;
+}
+
+/**
+ * @brief Relocate RPC/action subscriptions with their XPaths into the compacted ext SHM.
+ *
+ * @param[in] old_addr Current ext SHM address.
+ * @param[in] new_addr Compacted ext SHM address.
+ * @param[in,out] subs Offset of RPC subs, is updated.
+ * @param[in] sub_count Count of RPC subs.
+ * @param[in,out] new_end Current end of @p new_addr.
+ */
+static void
+sr_shmext_compact_rpc_subs(char *old_addr, char *new_addr, off_t *subs, uint32_t sub_count, char **new_end)
+{
+    sr_mod_rpc_sub_t *rpc_subs;
+    uint32_t i;
+
+    *subs = sr_shmcpy(new_addr, old_addr + *subs, sub_count * sizeof *rpc_subs, new_end);
+
+    rpc_subs = (sr_mod_rpc_sub_t *)(new_addr + *subs);
+    for (i = 0; i < sub_count; ++i) {
+        rpc_subs[i].xpath = sr_shmcpy(new_addr, old_addr + rpc_subs[i].xpath,
+                sr_strshmlen(old_addr + rpc_subs[i].xpath), new_end);
+    }
+}
+
+/**
+ * @brief Relocate all the subscriptions of a module into the compacted ext SHM.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[in] shm_mod SHM module with subscriptions, its offsets are updated.
+ * @param[in] old_addr Current ext SHM address.
+ * @param[in] new_addr Compacted ext SHM address.
+ * @param[in,out] new_end Current end of @p new_addr.
+ */
+static void
+sr_shmext_compact_mod(sr_mod_shm_t *mod_shm, sr_mod_t *shm_mod, char *old_addr, char *new_addr, char **new_end)
+{
+    sr_mod_change_sub_t *change_subs;
+    sr_mod_oper_get_sub_t *oper_get_subs;
+    sr_mod_oper_poll_sub_t *oper_poll_subs;
+    sr_mod_notif_sub_t *notif_subs;
+    sr_rpc_t *shm_rpc;
+    sr_datastore_t ds;
+    uint32_t i;
+
+    /* change subscriptions */
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        shm_mod->change_sub[ds].subs = sr_shmcpy(new_addr, old_addr + shm_mod->change_sub[ds].subs,
+                shm_mod->change_sub[ds].sub_count * sizeof *change_subs, new_end);
+
+        change_subs = (sr_mod_change_sub_t *)(new_addr + shm_mod->change_sub[ds].subs);
+        for (i = 0; i < shm_mod->change_sub[ds].sub_count; ++i) {
+            if (change_subs[i].xpath) {
+                change_subs[i].xpath = sr_shmcpy(new_addr, old_addr + change_subs[i].xpath,
+                        sr_strshmlen(old_addr + change_subs[i].xpath), new_end);
+            }
+        }
+    }
+
+    /* oper get subscriptions */
+    shm_mod->oper_get_subs = sr_shmcpy(new_addr, old_addr + shm_mod->oper_get_subs,
+            shm_mod->oper_get_sub_count * sizeof *oper_get_subs, new_end);
+
+    oper_get_subs = (sr_mod_oper_get_sub_t *)(new_addr + shm_mod->oper_get_subs);
+    for (i = 0; i < shm_mod->oper_get_sub_count; ++i) {
+        oper_get_subs[i].xpath = sr_shmcpy(new_addr, old_addr + oper_get_subs[i].xpath,
+                sr_strshmlen(old_addr + oper_get_subs[i].xpath), new_end);
+        oper_get_subs[i].xpath_subs = sr_shmcpy(new_addr, old_addr + oper_get_subs[i].xpath_subs,
+                oper_get_subs[i].xpath_sub_count * sizeof(sr_mod_oper_get_xpath_sub_t), new_end);
+    }
+
+    /* oper poll subscriptions */
+    shm_mod->oper_poll_subs = sr_shmcpy(new_addr, old_addr + shm_mod->oper_poll_subs,
+            shm_mod->oper_poll_sub_count * sizeof *oper_poll_subs, new_end);
+
+    oper_poll_subs = (sr_mod_oper_poll_sub_t *)(new_addr + shm_mod->oper_poll_subs);
+    for (i = 0; i < shm_mod->oper_poll_sub_count; ++i) {
+        oper_poll_subs[i].xpath = sr_shmcpy(new_addr, old_addr + oper_poll_subs[i].xpath,
+                sr_strshmlen(old_addr + oper_poll_subs[i].xpath), new_end);
+    }
+
+    /* RPC subscriptions */
+    shm_rpc = (sr_rpc_t *)(((char *)mod_shm) + shm_mod->rpcs);
+    for (i = 0; i < shm_mod->rpc_count; ++i) {
+        sr_shmext_compact_rpc_subs(old_addr, new_addr, &shm_rpc[i].subs, shm_rpc[i].sub_count, new_end);
+    }
+
+    /* notif subscriptions */
+    shm_mod->notif_subs = sr_shmcpy(new_addr, old_addr + shm_mod->notif_subs,
+            shm_mod->notif_sub_count * sizeof *notif_subs, new_end);
+
+    notif_subs = (sr_mod_notif_sub_t *)(new_addr + shm_mod->notif_subs);
+    for (i = 0; i < shm_mod->notif_sub_count; ++i) {
+        if (notif_subs[i].xpath) {
+            notif_subs[i].xpath = sr_shmcpy(new_addr, old_addr + notif_subs[i].xpath,
+                    sr_strshmlen(old_addr + notif_subs[i].xpath), new_end);
+        }
+    }
+
+    /* ext RPC subscriptions */
+    sr_shmext_compact_rpc_subs(old_addr, new_addr, &shm_mod->rpc_ext_subs, shm_mod->rpc_ext_sub_count, new_end);
+}
+
+sr_error_info_t *
+sr_shmext_compact(sr_conn_ctx_t *conn, uint32_t timeout_ms, int force)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_mod_shm_t *mod_shm = SR_CONN_MOD_SHM(conn);
+    sr_ext_shm_t *ext_shm;
+    sr_rwlock_t **locks = NULL;
+    uint32_t i, lock_count, locked = 0;
+    char *new_addr = NULL, *new_end;
+    size_t old_size, new_size;
+
+    /* learn all the subscription locks */
+    if ((err_info = sr_shmext_compact_collect_locks(mod_shm, &locks, &lock_count))) {
+        return err_info;
+    }
+
+    /* SUB WRITE LOCK, all of them so that no subscriptions can be read or changed */
+    for (locked = 0; locked < lock_count; ++locked) {
+        if ((err_info = sr_rwlock(locks[locked], timeout_ms, SR_LOCK_WRITE, conn->cid, __func__, NULL, NULL))) {
+            goto cleanup_sub_unlock;
+        }
+    }
+
+    /* EXT WRITE LOCK */
+    if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_WRITE, 1, __func__))) {
+        goto cleanup_sub_unlock;
+    }
+    ext_shm = SR_CONN_EXT_SHM(conn);
+    old_size = conn->ext_shm.size;
+
+    if (!ext_shm->hole_count || (!force && !sr_shmext_compact_needed(conn))) {
+        /* nothing to do */
+        goto cleanup_ext_unlock;
+    }
+
+    SR_LOG_DBG("#SHM before (compacting)");
+    sr_shmext_print(mod_shm, &conn->ext_shm);
+
+    /* the compacted copy can never be larger */
+    new_addr = calloc(1, old_size);
+    SR_CHECK_MEM_GOTO(!new_addr, err_info, cleanup_ext_unlock);
+    new_end = new_addr + SR_SHM_SIZE(sizeof(sr_ext_shm_t));
+
+    /* relocate all the subscriptions, offsets in mod SHM are updated */
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        sr_shmext_compact_mod(mod_shm, SR_SHM_MOD_IDX(mod_shm, i), conn->ext_shm.addr, new_addr, &new_end);
+    }
+    new_size = new_end - new_addr;
+    assert(new_size + ext_shm->hole_size == old_size);
+
+    /* copy the compacted subscriptions back, there are no holes anymore */
+    memcpy(conn->ext_shm.addr + SR_SHM_SIZE(sizeof(sr_ext_shm_t)), new_addr + SR_SHM_SIZE(sizeof(sr_ext_shm_t)),
+            new_size - SR_SHM_SIZE(sizeof(sr_ext_shm_t)));
+    memset(ext_shm->first_hole_off, 0, sizeof ext_shm->first_hole_off);
+    ext_shm->hole_count = 0;
+    ext_shm->hole_size = 0;
+
+    /* remap (and truncate) ext SHM */
+    if ((err_info = sr_shm_remap(&conn->ext_shm, new_size))) {
+        goto cleanup_ext_unlock;
+    }
+
+    SR_LOG_INF("Ext SHM compacted from %" PRIu64 " B to %" PRIu64 " B.", (uint64_t)old_size, (uint64_t)new_size);
+
+    SR_LOG_DBG("#SHM after (compacting)");
+    sr_shmext_print(mod_shm, &conn->ext_shm);
+
+cleanup_ext_unlock:
+    /* EXT WRITE UNLOCK */
+    sr_shmext_conn_remap_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+
+cleanup_sub_unlock:
+    /* SUB WRITE UNLOCK */
+    while (locked) {
+        --locked;
+        sr_rwunlock(locks[locked], timeout_ms, SR_LOCK_WRITE, conn->cid, __func__);
+    }
+
+    free(new_addr);
+    free(locks);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_shmext_change_sub_add(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, sr_datastore_t ds, uint32_t sub_id, const char *xpath,
         uint32_t priority, int sub_opts, uint32_t evpipe_num)
@@ -557,6 +828,7 @@ sr_shmext_change_sub_add(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, sr_datastore_t
     shm_sub->evpipe_num = evpipe_num;
     ATOMIC_STORE_RELAXED(shm_sub->suspended, 0);
     shm_sub->cid = conn->cid;
+    ATOMIC_INC_RELAXED(shm_mod->change_sub[ds].gen);
 
     SR_LOG_DBG("#SHM after (adding change sub)");
     sr_shmext_print(SR_CONN_MOD_SHM(conn), &conn->ext_shm);
@@ -629,6 +901,7 @@ sr_shmext_change_sub_modify(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, sr_datastore
     } else {
         shm_sub[i].xpath = 0;
     }
+    ATOMIC_INC_RELAXED(shm_mod->change_sub[ds].gen);
 
     SR_LOG_DBG("#SHM after (modifying change sub)");
     sr_shmext_print(SR_CONN_MOD_SHM(conn), &conn->ext_shm);
@@ -669,6 +942,7 @@ sr_shmext_change_sub_free(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, sr_datastore_t
     /* free the subscription and its xpath, if any */
     sr_shmrealloc_del(&conn->ext_shm, &shm_mod->change_sub[ds].subs, &shm_mod->change_sub[ds].sub_count, sizeof *shm_sub,
             del_idx, shm_sub->xpath ? sr_strshmlen(conn->ext_shm.addr + shm_sub->xpath) : 0, shm_sub->xpath);
+    ATOMIC_INC_RELAXED(shm_mod->change_sub[ds].gen);
 
     SR_LOG_DBG("#SHM after (removing change sub)");
     sr_shmext_print(SR_CONN_MOD_SHM(conn), &conn->ext_shm);
@@ -1304,6 +1578,7 @@ sr_shmext_notif_sub_add(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t sub_id,
     sr_error_info_t *err_info = NULL, *tmp_err;
     off_t xpath_off;
     sr_mod_notif_sub_t *shm_sub;
+    uint32_t i;
 
     /* EXT WRITE LOCK */
     if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_WRITE, 1, __func__))) {
@@ -1336,12 +1611,23 @@ sr_shmext_notif_sub_add(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t sub_id,
 
     if (shm_mod->notif_sub_count == 1) {
         /* create the sub SHM while still holding the locks */
-        if ((err_info = sr_shmsub_create(conn->mod_shm.addr + shm_mod->name, "notif", -1, sizeof(sr_multi_sub_shm_t)))) {
+        if ((err_info = sr_shmsub_create(conn->mod_shm.addr + shm_mod->name, "notif", -1, sizeof(sr_notif_sub_shm_t)))) {
             goto cleanup_unlock;
         }
 
-        /* create the data sub SHM */
-        if ((err_info = sr_shmsub_data_create(conn->mod_shm.addr + shm_mod->name, "notif", -1))) {
+        /* create the data sub SHM for each ring slot */
+        for (i = 0; i < SR_SUB_NOTIF_RING_SIZE; ++i) {
+            if ((err_info = sr_shmsub_data_create(conn->mod_shm.addr + shm_mod->name, "notif", i))) {
+                break;
+            }
+        }
+        if (err_info) {
+            while (i) {
+                --i;
+                if ((tmp_err = sr_shmsub_data_unlink(conn->mod_shm.addr + shm_mod->name, "notif", i))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                }
+            }
             if ((tmp_err = sr_shmsub_unlink(conn->mod_shm.addr + shm_mod->name, "notif", -1))) {
                 sr_errinfo_merge(&err_info, tmp_err);
             }
@@ -1369,6 +1655,7 @@ sr_shmext_notif_sub_free(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t del_id
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_notif_sub_t *shm_sub;
+    uint32_t i;
 
     shm_sub = &((sr_mod_notif_sub_t *)(conn->ext_shm.addr + shm_mod->notif_subs))[del_idx];
 
@@ -1388,9 +1675,11 @@ sr_shmext_notif_sub_free(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t del_id
             goto cleanup;
         }
 
-        /* unlink the sub data SHM */
-        if ((err_info = sr_shmsub_data_unlink(conn->mod_shm.addr + shm_mod->name, "notif", -1))) {
-            goto cleanup;
+        /* unlink the sub data SHM of each ring slot */
+        for (i = 0; i < SR_SUB_NOTIF_RING_SIZE; ++i) {
+            if ((err_info = sr_shmsub_data_unlink(conn->mod_shm.addr + shm_mod->name, "notif", i))) {
+                goto cleanup;
+            }
         }
     }
 
@@ -1525,7 +1814,7 @@ sr_shmext_rpc_sub_add(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, off_t *subs, u
     sr_error_info_t *err_info = NULL, *tmp_err;
     off_t xpath_off;
     sr_mod_rpc_sub_t *shm_sub;
-    uint32_t i;
+    uint32_t i, lane;
     char *mod_name = NULL, *p = NULL;
     int r, path_found = 0;
 
@@ -1596,16 +1885,31 @@ sr_shmext_rpc_sub_add(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, off_t *subs, u
     sr_shmext_print(SR_CONN_MOD_SHM(conn), &conn->ext_shm);
 
     if (!path_found && sub_cid) {
-        /* create the sub SHM while still holding the locks */
+        /* create the sub SHM of all the lanes while still holding the locks */
         mod_name = sr_get_first_ns(path);
-        if ((err_info = sr_shmsub_create(mod_name, "rpc", sr_str_hash(path, 0), sizeof(sr_multi_sub_shm_t)))) {
-            goto cleanup_unlock;
-        }
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+            if ((err_info = sr_shmsub_create(mod_name, "rpc", sr_str_hash(path, lane), sizeof(sr_multi_sub_shm_t)))) {
+                break;
+            }
 
-        /* create the data sub SHM */
-        if ((err_info = sr_shmsub_data_create(mod_name, "rpc", sr_str_hash(path, 0)))) {
-            if ((tmp_err = sr_shmsub_unlink(mod_name, "rpc", sr_str_hash(path, 0)))) {
-                sr_errinfo_merge(&err_info, tmp_err);
+            /* create the data sub SHM */
+            if ((err_info = sr_shmsub_data_create(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                if ((tmp_err = sr_shmsub_unlink(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                }
+                break;
+            }
+        }
+        if (err_info) {
+            /* remove the lanes created so far */
+            while (lane) {
+                --lane;
+                if ((tmp_err = sr_shmsub_unlink(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                }
+                if ((tmp_err = sr_shmsub_data_unlink(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                }
             }
             goto cleanup_unlock;
         }
@@ -1635,7 +1939,7 @@ sr_shmext_rpc_sub_free(sr_conn_ctx_t *conn, off_t *subs, uint32_t *sub_count, co
     sr_error_info_t *err_info = NULL;
     sr_mod_rpc_sub_t *shm_subs;
     char *mod_name = NULL, *p;
-    uint32_t i;
+    uint32_t i, lane;
     int r;
 
     shm_subs = (sr_mod_rpc_sub_t *)(conn->ext_shm.addr + *subs);
@@ -1667,15 +1971,17 @@ sr_shmext_rpc_sub_free(sr_conn_ctx_t *conn, off_t *subs, uint32_t *sub_count, co
     }
 
     if (i == *sub_count) {
-        /* unlink the sub SHM */
         mod_name = sr_get_first_ns(path);
-        if ((err_info = sr_shmsub_unlink(mod_name, "rpc", sr_str_hash(path, 0)))) {
-            goto cleanup;
-        }
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+            /* unlink the sub SHM */
+            if ((err_info = sr_shmsub_unlink(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                goto cleanup;
+            }
 
-        /* unlink the sub data SHM */
-        if ((err_info = sr_shmsub_data_unlink(mod_name, "rpc", sr_str_hash(path, 0)))) {
-            goto cleanup;
+            /* unlink the sub data SHM */
+            if ((err_info = sr_shmsub_data_unlink(mod_name, "rpc", sr_str_hash(path, lane)))) {
+                goto cleanup;
+            }
         }
     }
 
@@ -2065,54 +2371,71 @@ cleanup_unlock1:
     return err_info;
 }
 
-void
-sr_shmext_recover_sub_all(sr_conn_ctx_t *conn)
+/**
+ * @brief Recover all the subscriptions of a module, callback of ::sr_conn_load_run().
+ *
+ * @param[in] idx Module index.
+ * @param[in] cb_data Connection to use.
+ * @return NULL, errors are only logged.
+ */
+static sr_error_info_t *
+sr_shmext_recover_sub_mod_job(uint32_t idx, void *cb_data)
 {
     sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = cb_data;
     sr_datastore_t ds;
     sr_mod_t *shm_mod;
     sr_rpc_t *shm_rpc;
-    uint32_t i, j;
+    uint32_t j;
 
-    /* go through all the modules, RPCs and recover their subscriptions */
-    for (i = 0; i < SR_CONN_MOD_SHM(conn)->mod_count; ++i) {
-        shm_mod = SR_SHM_MOD_IDX(conn->mod_shm.addr, i);
-
-        /* change subs */
-        for (ds = 0; ds < SR_DS_COUNT; ++ds) {
-            if ((err_info = sr_shmext_recover_sub_change(conn, shm_mod, ds))) {
-                sr_errinfo_free(&err_info);
-            }
-        }
+    shm_mod = SR_SHM_MOD_IDX(conn->mod_shm.addr, idx);
 
-        /* oper get subs */
-        if ((err_info = sr_shmext_recover_sub_oper_get(conn, shm_mod))) {
+    /* change subs */
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        if ((err_info = sr_shmext_recover_sub_change(conn, shm_mod, ds))) {
             sr_errinfo_free(&err_info);
         }
+    }
 
-        /* oper poll subs */
-        if ((err_info = sr_shmext_recover_sub_oper_poll(conn, shm_mod))) {
-            sr_errinfo_free(&err_info);
-        }
+    /* oper get subs */
+    if ((err_info = sr_shmext_recover_sub_oper_get(conn, shm_mod))) {
+        sr_errinfo_free(&err_info);
+    }
 
-        /* notif subs */
-        if ((err_info = sr_shmext_recover_sub_notif(conn, shm_mod))) {
-            sr_errinfo_free(&err_info);
-        }
+    /* oper poll subs */
+    if ((err_info = sr_shmext_recover_sub_oper_poll(conn, shm_mod))) {
+        sr_errinfo_free(&err_info);
+    }
 
-        /* RPC ext subs */
-        if ((err_info = sr_shmext_recover_sub_rpc_ext(conn, shm_mod))) {
-            sr_errinfo_free(&err_info);
-        }
+    /* notif subs */
+    if ((err_info = sr_shmext_recover_sub_notif(conn, shm_mod))) {
+        sr_errinfo_free(&err_info);
+    }
 
-        /* RPC subs */
-        shm_rpc = (sr_rpc_t *)(conn->mod_shm.addr + shm_mod->rpcs);
-        for (j = 0; j < shm_mod->rpc_count; ++j) {
-            if ((err_info = sr_shmext_recover_sub_rpc(conn, &shm_rpc[i]))) {
-                sr_errinfo_free(&err_info);
-            }
+    /* RPC ext subs */
+    if ((err_info = sr_shmext_recover_sub_rpc_ext(conn, shm_mod))) {
+        sr_errinfo_free(&err_info);
+    }
+
+    /* RPC subs */
+    shm_rpc = (sr_rpc_t *)(conn->mod_shm.addr + shm_mod->rpcs);
+    for (j = 0; j < shm_mod->rpc_count; ++j) {
+        if ((err_info = sr_shmext_recover_sub_rpc(conn, &shm_rpc[j]))) {
+            sr_errinfo_free(&err_info);
         }
     }
+
+    return NULL;
+}
+
+void
+sr_shmext_recover_sub_all(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info;
+
+    /* go through all the modules, RPCs and recover their subscriptions, the modules in parallel */
+    err_info = sr_conn_load_run(conn, SR_CONN_MOD_SHM(conn)->mod_count, sr_shmext_recover_sub_mod_job, conn);
+    sr_errinfo_free(&err_info);
 }
 
 /**
@@ -2536,46 +2859,80 @@ cleanup:
     return err_info;
 }
 
-sr_error_info_t *
-sr_shmext_check_sub_all(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx)
+/**
+ * @brief Subscription check of all the modules executed in parallel.
+ */
+struct sr_shmext_check_sub_s {
+    sr_conn_ctx_t *conn;                    /**< Connection to use. */
+    const struct ly_ctx *new_ctx;           /**< New updated context. */
+    struct sr_conn_alive_cache_s alive;     /**< Aliveness of the subscription CIDs, checked once each. */
+};
+
+/**
+ * @brief Check validity of all the subscriptions of a module, callback of ::sr_conn_load_run().
+ *
+ * @param[in] idx Module index.
+ * @param[in] cb_data Subscription check.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmext_check_sub_mod_job(uint32_t idx, void *cb_data)
 {
     sr_error_info_t *err_info = NULL;
+    struct sr_shmext_check_sub_s *check = cb_data;
+    sr_conn_ctx_t *conn = check->conn;
     sr_mod_t *smod;
     sr_rpc_t *srpcs;
-    uint32_t i;
     uint16_t j;
     sr_datastore_t ds;
 
-    for (i = 0; i < SR_CONN_MOD_SHM(conn)->mod_count; ++i) {
-        smod = SR_SHM_MOD_IDX(conn->mod_shm.addr, i);
-
-        for (ds = 0; ds < SR_DS_COUNT; ++ds) {
-            /* check mod change subs */
-            if ((err_info = sr_shmext_change_sub_check(conn, smod, ds, new_ctx))) {
-                goto cleanup;
-            }
-        }
+    smod = SR_SHM_MOD_IDX(conn->mod_shm.addr, idx);
+    sr_conn_alive_cache_use(&check->alive);
 
-        /* check mod oper subs */
-        if ((err_info = sr_shmext_oper_sub_check(conn, smod, new_ctx))) {
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        /* check mod change subs */
+        if ((err_info = sr_shmext_change_sub_check(conn, smod, ds, check->new_ctx))) {
             goto cleanup;
         }
+    }
 
-        /* check mod notif subs */
-        if ((err_info = sr_shmext_notif_sub_check(conn, smod, new_ctx))) {
-            goto cleanup;
-        }
+    /* check mod oper subs */
+    if ((err_info = sr_shmext_oper_sub_check(conn, smod, check->new_ctx))) {
+        goto cleanup;
+    }
 
-        srpcs = (sr_rpc_t *)(conn->mod_shm.addr + smod->rpcs);
-        for (j = 0; j < smod->rpc_count; ++j) {
-            /* check RPC subs */
-            if ((err_info = sr_shmext_rpc_sub_check(conn, conn->mod_shm.addr + smod->name, &srpcs[j], new_ctx))) {
-                goto cleanup;
-            }
+    /* check mod notif subs */
+    if ((err_info = sr_shmext_notif_sub_check(conn, smod, check->new_ctx))) {
+        goto cleanup;
+    }
+
+    srpcs = (sr_rpc_t *)(conn->mod_shm.addr + smod->rpcs);
+    for (j = 0; j < smod->rpc_count; ++j) {
+        /* check RPC subs */
+        if ((err_info = sr_shmext_rpc_sub_check(conn, conn->mod_shm.addr + smod->name, &srpcs[j], check->new_ctx))) {
+            goto cleanup;
         }
     }
 
 cleanup:
+    sr_conn_alive_cache_use(NULL);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_shmext_check_sub_all(sr_conn_ctx_t *conn, const struct ly_ctx *new_ctx)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_shmext_check_sub_s check = {.conn = conn, .new_ctx = new_ctx};
+
+    if ((err_info = sr_conn_alive_cache_init(&check.alive))) {
+        return err_info;
+    }
+
+    /* check the modules in parallel, a connection with many subscriptions is checked only once */
+    err_info = sr_conn_load_run(conn, SR_CONN_MOD_SHM(conn)->mod_count, sr_shmext_check_sub_mod_job, &check);
+
+    sr_conn_alive_cache_destroy(&check.alive);
     return err_info;
 }
 
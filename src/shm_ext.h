@@ -58,6 +58,27 @@ sr_error_info_t *sr_shmext_open(sr_shm_t *shm, int zero);
  */
 void sr_shmext_print(sr_mod_shm_t *mod_shm, sr_shm_t *shm_ext);
 
+/**
+ * @brief Check whether ext SHM is fragmented enough for an automatic compaction. Used only as a hint
+ * so no locks are held.
+ *
+ * @param[in] conn Connection to use.
+ * @return Whether ext SHM should be compacted.
+ */
+int sr_shmext_compact_needed(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Compact ext SHM by relocating all the subscriptions to its beginning, removing all memory holes,
+ * and truncating it. All the module and RPC subscription locks are WRITE locked for the duration.
+ * Ext SHM is remapped!
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] timeout_ms Timeout for locking each subscription lock.
+ * @param[in] force Whether to compact ext SHM even if ::sr_shmext_compact_needed() does not require it.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmext_compact(sr_conn_ctx_t *conn, uint32_t timeout_ms, int force);
+
 /**
  * @brief Add main SHM module change subscription and create sub SHM if the first subscription was added.
  * Ext SHM may be remapped!
@@ -24,6 +24,7 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -67,7 +68,180 @@ static struct {
     } *list_head;                       /**< process connection list head */
 
     pthread_mutex_t create_lock;        /**< lock used for synchronizing new connection creation within the process */
-} conn_proc = {.list_lock = PTHREAD_MUTEX_INITIALIZER, .list_head = NULL, .create_lock = PTHREAD_MUTEX_INITIALIZER};
+
+    sr_shm_t main_shm;                  /**< main SHM mapping used for the connection aliveness registry, protected
+                                             by list_lock */
+    ino_t main_shm_ino;                 /**< inode of the mapped main SHM */
+} conn_proc = {
+    .list_lock = PTHREAD_MUTEX_INITIALIZER, .list_head = NULL, .create_lock = PTHREAD_MUTEX_INITIALIZER,
+    .main_shm = {.fd = -1}
+};
+
+/**
+ * @brief Get the current monotonic time in ms for the connection aliveness registry.
+ *
+ * @return Truncated monotonic time.
+ */
+static uint32_t
+sr_shmmain_conn_reg_ms(void)
+{
+    struct timespec ts;
+
+    sr_timeouttime_get(&ts, 0);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/**
+ * @brief Get the connection aliveness registry slot of a CID.
+ * CONN LIST lock must be held.
+ *
+ * @param[in] cid CID of the connection.
+ * @return Registry slot, NULL if the registry is not mapped.
+ */
+static sr_conn_reg_slot_t *
+sr_shmmain_conn_reg_slot(sr_cid_t cid)
+{
+    if (!conn_proc.main_shm.addr) {
+        return NULL;
+    }
+
+    return &((sr_main_shm_t *)conn_proc.main_shm.addr)->conn_reg[cid % SR_CONN_REG_SIZE];
+}
+
+/**
+ * @brief Map the current main SHM for the connection aliveness registry, if not already.
+ * CONN LIST lock must be held.
+ *
+ * The registry is only a cache, it is not used on any error.
+ */
+static void
+sr_shmmain_conn_reg_map(void)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+    struct stat st;
+
+    if ((err_info = sr_path_main_shm(&path))) {
+        goto cleanup;
+    }
+    if (stat(path, &st) == -1) {
+        goto cleanup;
+    }
+    if (conn_proc.main_shm.addr && (st.st_ino == conn_proc.main_shm_ino)) {
+        /* current main SHM mapped */
+        goto cleanup;
+    }
+
+    /* map the main SHM, it may have been recreated */
+    sr_shm_clear(&conn_proc.main_shm);
+    conn_proc.main_shm.fd = sr_open(path, O_RDWR, SR_SHM_PERM);
+    if (conn_proc.main_shm.fd == -1) {
+        goto cleanup;
+    }
+    if ((err_info = sr_shm_remap(&conn_proc.main_shm, 0))) {
+        sr_shm_clear(&conn_proc.main_shm);
+        goto cleanup;
+    }
+    if ((conn_proc.main_shm.size < sizeof(sr_main_shm_t)) ||
+            (((sr_main_shm_t *)conn_proc.main_shm.addr)->shm_ver != SR_SHM_VER)) {
+        sr_shm_clear(&conn_proc.main_shm);
+        goto cleanup;
+    }
+    conn_proc.main_shm_ino = st.st_ino;
+
+    /* the mapping is kept without the file */
+    close(conn_proc.main_shm.fd);
+    conn_proc.main_shm.fd = -1;
+
+cleanup:
+    sr_errinfo_free(&err_info);
+    free(path);
+}
+
+/**
+ * @brief Check whether a connection is alive using the connection aliveness registry.
+ * CONN LIST lock must be held.
+ *
+ * @param[in] cid CID of the connection.
+ * @param[out] pid Optional PID of the process of the connection.
+ * @return Whether the connection was recently found alive and its process still exists, if not,
+ * the lockfile must be checked.
+ */
+static int
+sr_shmmain_conn_reg_alive(sr_cid_t cid, pid_t *pid)
+{
+    sr_conn_reg_slot_t *slot;
+    uint32_t reg_pid, check_ms;
+
+    if (!(slot = sr_shmmain_conn_reg_slot(cid)) || (ATOMIC_LOAD_RELAXED(slot->cid) != cid)) {
+        return 0;
+    }
+    reg_pid = ATOMIC_LOAD_RELAXED(slot->pid);
+    check_ms = ATOMIC_LOAD_RELAXED(slot->check_ms);
+    if (ATOMIC_LOAD_RELAXED(slot->cid) != cid) {
+        /* slot reused meanwhile */
+        return 0;
+    }
+
+    if (sr_shmmain_conn_reg_ms() - check_ms > SR_CONN_REG_CHECK_INTERVAL) {
+        /* the PID could have been reused, check the lockfile again */
+        return 0;
+    }
+    if (reg_pid && (kill(reg_pid, 0) == -1) && (errno == ESRCH)) {
+        /* the process terminated (PID is 0 if in another PID namespace), the lockfile check recovers the connection */
+        return 0;
+    }
+
+    if (pid) {
+        *pid = reg_pid;
+    }
+    return 1;
+}
+
+/**
+ * @brief Store the result of a connection lockfile check in the connection aliveness registry.
+ *
+ * @param[in] cid CID of the connection.
+ * @param[in] alive Whether the connection is alive.
+ * @param[in] pid PID of the process of the connection if alive.
+ */
+static void
+sr_shmmain_conn_reg_update(sr_cid_t cid, int alive, pid_t pid)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_reg_slot_t *slot;
+    uint_fast32_t exp_cid;
+    int r;
+
+    /* CONN LIST LOCK */
+    if ((err_info = sr_mlock(&conn_proc.list_lock, SR_CONN_LIST_LOCK_TIMEOUT, __func__, NULL, NULL))) {
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
+    if (!(slot = sr_shmmain_conn_reg_slot(cid))) {
+        goto cleanup_unlock;
+    }
+
+    if (alive) {
+        /* free the slot first so that no reader combines the members of different connections */
+        if (ATOMIC_LOAD_RELAXED(slot->cid) != cid) {
+            ATOMIC_STORE_RELAXED(slot->cid, 0);
+        }
+        ATOMIC_STORE_RELAXED(slot->pid, pid);
+        ATOMIC_STORE_RELAXED(slot->check_ms, sr_shmmain_conn_reg_ms());
+        ATOMIC_STORE_RELAXED(slot->cid, cid);
+    } else {
+        /* free the slot if still used by the dead connection */
+        exp_cid = cid;
+        ATOMIC_COMPARE_EXCHANGE_RELAXED(slot->cid, exp_cid, 0, r);
+        (void)r;
+    }
+
+cleanup_unlock:
+    /* CONN LIST UNLOCK */
+    sr_munlock(&conn_proc.list_lock);
+}
 
 sr_error_info_t *
 sr_shmmain_check_dirs(void)
@@ -212,6 +386,15 @@ sr_shmmain_conn_check(sr_cid_t cid, int *conn_alive, pid_t *pid)
         }
     }
 
+    /* the connection may have been recently found alive by any process */
+    if (sr_shmmain_conn_reg_alive(cid, pid)) {
+        *conn_alive = 1;
+
+        /* CONN LIST UNLOCK */
+        sr_munlock(&conn_proc.list_lock);
+        goto cleanup;
+    }
+
     /* CONN LIST UNLOCK */
     sr_munlock(&conn_proc.list_lock);
 
@@ -227,6 +410,7 @@ sr_shmmain_conn_check(sr_cid_t cid, int *conn_alive, pid_t *pid)
             if (pid) {
                 *pid = 0;
             }
+            sr_shmmain_conn_reg_update(cid, 0, 0);
             goto cleanup;
         }
         SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
@@ -253,6 +437,7 @@ sr_shmmain_conn_check(sr_cid_t cid, int *conn_alive, pid_t *pid)
         if (pid) {
             *pid = 0;
         }
+        sr_shmmain_conn_reg_update(cid, 0, 0);
 
         /* delete the file */
         if (!unlink(path)) {
@@ -268,6 +453,7 @@ sr_shmmain_conn_check(sr_cid_t cid, int *conn_alive, pid_t *pid)
         if (pid) {
             *pid = fl.l_pid;
         }
+        sr_shmmain_conn_reg_update(cid, 1, fl.l_pid);
     }
 
 cleanup:
@@ -373,6 +559,9 @@ sr_shmmain_conn_list_add(sr_cid_t cid)
     conn_item->_next = conn_proc.list_head;
     conn_proc.list_head = conn_item;
 
+    /* map the connection aliveness registry of the current main SHM */
+    sr_shmmain_conn_reg_map();
+
     /* CONN LIST UNLOCK */
     sr_munlock(&conn_proc.list_lock);
 
@@ -436,6 +625,9 @@ sr_shmmain_conn_list_del(sr_cid_t cid)
     /* CONN LIST UNLOCK */
     sr_munlock(&conn_proc.list_lock);
 
+    /* the connection is no longer alive */
+    sr_shmmain_conn_reg_update(cid, 0, 0);
+
     /* remove the lockfile as well */
     if ((err_info = sr_path_conn_lockfile(cid, 0, &path))) {
         return err_info;
@@ -454,6 +646,7 @@ sr_shmmain_open(sr_shm_t *shm, int *created)
     sr_error_info_t *err_info = NULL;
     sr_main_shm_t *main_shm;
     char *shm_name = NULL, buf[128];
+    sr_datastore_t ds;
     int creat = 0;
 
     if ((err_info = sr_path_main_shm(&shm_name))) {
@@ -505,14 +698,23 @@ sr_shmmain_open(sr_shm_t *shm, int *created)
         if ((err_info = sr_mutex_init(&main_shm->lydmods_lock, 1))) {
             goto cleanup;
         }
+        for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+            if ((err_info = sr_mutex_init(&main_shm->ds_lock[ds].lock, 1))) {
+                goto cleanup;
+            }
+        }
         ATOMIC_STORE_RELAXED(main_shm->new_sr_cid, 1);
         ATOMIC_STORE_RELAXED(main_shm->new_sr_sid, 1);
         ATOMIC_STORE_RELAXED(main_shm->new_sub_id, 1);
         ATOMIC_STORE_RELAXED(main_shm->new_evpipe_num, 1);
         strncpy(main_shm->repo_path, sr_get_repo_path(), sizeof main_shm->repo_path - 1);
 
-        /* remove leftover event pipes */
+        /* remove leftover event pipes, diff segments, running cache, oper cache, and oper slots segments */
         sr_remove_evpipes();
+        sr_remove_sub_diffs(0);
+        sr_remove_run_caches();
+        sr_remove_oper_caches();
+        sr_remove_oper_slots(NULL);
     } else {
         /* check version */
         if (main_shm->shm_ver != SR_SHM_VER) {
@@ -76,7 +76,7 @@ sr_shmmod_open(sr_shm_t *shm, int zero)
         goto error;
     }
     if (zero) {
-        ((sr_mod_shm_t *)shm->addr)->mod_count = 0;
+        memset(shm->addr, 0, sizeof(sr_mod_shm_t));
     }
 
     return NULL;
@@ -90,10 +90,27 @@ sr_mod_t *
 sr_shmmod_find_module(sr_mod_shm_t *mod_shm, const char *name)
 {
     sr_mod_t *shm_mod;
+    off_t *index;
     uint32_t i;
 
     assert(name);
 
+    if (mod_shm->mod_index) {
+        /* use the hash index */
+        index = (off_t *)(((char *)mod_shm) + mod_shm->mod_index);
+        i = sr_str_hash(name, 0) & (mod_shm->mod_index_size - 1);
+        while (index[i]) {
+            shm_mod = (sr_mod_t *)(((char *)mod_shm) + index[i]);
+            if (!strcmp(((char *)mod_shm) + shm_mod->name, name)) {
+                return shm_mod;
+            }
+            i = (i + 1) & (mod_shm->mod_index_size - 1);
+        }
+
+        return NULL;
+    }
+
+    /* index not built yet, mod SHM is being filled */
     for (i = 0; i < mod_shm->mod_count; ++i) {
         shm_mod = SR_SHM_MOD_IDX(mod_shm, i);
         if (!strcmp(((char *)mod_shm) + shm_mod->name, name)) {
@@ -109,11 +126,27 @@ sr_shmmod_find_rpc(sr_mod_shm_t *mod_shm, const char *path)
 {
     sr_mod_t *shm_mod;
     sr_rpc_t *shm_rpc;
+    off_t *index;
     char *mod_name;
-    uint16_t i;
+    uint32_t i;
 
     assert(path);
 
+    if (mod_shm->rpc_index) {
+        /* use the hash index */
+        index = (off_t *)(((char *)mod_shm) + mod_shm->rpc_index);
+        i = sr_str_hash(path, 0) & (mod_shm->rpc_index_size - 1);
+        while (index[i]) {
+            shm_rpc = (sr_rpc_t *)(((char *)mod_shm) + index[i]);
+            if (!strcmp(((char *)mod_shm) + shm_rpc->path, path)) {
+                return shm_rpc;
+            }
+            i = (i + 1) & (mod_shm->rpc_index_size - 1);
+        }
+
+        return NULL;
+    }
+
     /* find module first */
     mod_name = sr_get_first_ns(path);
     shm_mod = sr_shmmod_find_module(mod_shm, mod_name);
@@ -156,6 +189,7 @@ sr_shmmod_init(sr_shm_t *shm_mod, size_t shm_mod_idx)
         if ((err_info = sr_rwlock_init(&smod->data_lock_info[ds].data_lock, 1))) {
             return err_info;
         }
+        smod->data_lock_info[ds].data_lock.fair_wait_ms = SR_MOD_LOCK_FAIR_WAIT;
         if ((err_info = sr_mutex_init(&smod->data_lock_info[ds].ds_lock, 1))) {
             return err_info;
         }
@@ -278,6 +312,7 @@ sr_shmmod_fill(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node *sr_
         for (ds = 0; ds < SR_DS_COUNT; ++ds) {
             smod->change_sub[ds].subs = old_smod->change_sub[ds].subs;
             smod->change_sub[ds].sub_count = old_smod->change_sub[ds].sub_count;
+            ATOMIC_STORE_RELAXED(smod->change_sub[ds].gen, ATOMIC_LOAD_RELAXED(old_smod->change_sub[ds].gen));
         }
 
         /* copy oper get subscriptions */
@@ -291,6 +326,12 @@ sr_shmmod_fill(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node *sr_
         /* copy notif subscriptions */
         smod->notif_subs = old_smod->notif_subs;
         smod->notif_sub_count = old_smod->notif_sub_count;
+
+        /* running data may not have been copied from startup yet */
+        ATOMIC_STORE_RELAXED(smod->run_inherit, ATOMIC_LOAD_RELAXED(old_smod->run_inherit));
+
+        /* operational value slots may be used */
+        ATOMIC_STORE_RELAXED(smod->oper_slots, ATOMIC_LOAD_RELAXED(old_smod->oper_slots));
     }
 
     return NULL;
@@ -434,7 +475,7 @@ cleanup:
 }
 
 /**
- * @brief Add module (data and inverse) dependencies into mod SHM.
+ * @brief Add module (data, inverse, and schema) dependencies into mod SHM.
  *
  * @param[in] shm_mod Mod SHM structure to remap and append the data to.
  * @param[in] shm_mod_idx Mod SHM mod index of @p sr_mod.
@@ -448,15 +489,16 @@ sr_shmmod_add_deps(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node
     struct lyd_node *sr_child, *sr_dep;
     sr_mod_t *smod, *ref_smod;
     sr_dep_t *shm_deps;
-    off_t *shm_inv_deps;
+    off_t *shm_inv_deps, *shm_schema_deps;
     sr_mod_shm_t *mod_shm;
     char *shm_end;
-    size_t paths_len, dep_i, inv_dep_i, old_shm_size;
+    size_t paths_len, dep_i, inv_dep_i, schema_dep_i, old_shm_size;
 
     smod = SR_SHM_MOD_IDX(shm_mod->addr, shm_mod_idx);
 
     assert(!smod->dep_count);
     assert(!smod->inv_dep_count);
+    assert(!smod->schema_dep_count);
 
     /* count arrays and paths length */
     paths_len = 0;
@@ -472,6 +514,9 @@ sr_shmmod_add_deps(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node
         } else if (!strcmp(sr_child->schema->name, "inverse-deps")) {
             /* another inverse data dependency */
             ++smod->inv_dep_count;
+        } else if (!strcmp(sr_child->schema->name, "schema-deps")) {
+            /* another schema dependency */
+            ++smod->schema_dep_count;
         }
     }
 
@@ -480,7 +525,7 @@ sr_shmmod_add_deps(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node
 
     /* enlarge and possibly remap mod SHM */
     if ((err_info = sr_shm_remap(shm_mod, shm_mod->size + paths_len + SR_SHM_SIZE(smod->dep_count * sizeof(sr_dep_t)) +
-            SR_SHM_SIZE(smod->inv_dep_count * sizeof(off_t))))) {
+            SR_SHM_SIZE(smod->inv_dep_count * sizeof(off_t)) + SR_SHM_SIZE(smod->schema_dep_count * sizeof(off_t))))) {
         return err_info;
     }
     smod = SR_SHM_MOD_IDX(shm_mod->addr, shm_mod_idx);
@@ -496,6 +541,10 @@ sr_shmmod_add_deps(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node
     shm_inv_deps = (off_t *)(shm_mod->addr + smod->inv_deps);
     inv_dep_i = 0;
 
+    smod->schema_deps = sr_shmcpy(shm_mod->addr, NULL, smod->schema_dep_count * sizeof(off_t), &shm_end);
+    shm_schema_deps = (off_t *)(shm_mod->addr + smod->schema_deps);
+    schema_dep_i = 0;
+
     LY_LIST_FOR(lyd_child(sr_mod), sr_child) {
         if (!strcmp(sr_child->schema->name, "deps")) {
             /* now fill the dependency array */
@@ -509,10 +558,17 @@ sr_shmmod_add_deps(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_node
             shm_inv_deps[inv_dep_i] = ref_smod->name;
 
             ++inv_dep_i;
+        } else if (!strcmp(sr_child->schema->name, "schema-deps")) {
+            ref_smod = sr_shmmod_find_module(mod_shm, lyd_get_value(sr_child));
+            SR_CHECK_INT_RET(!ref_smod, err_info);
+            shm_schema_deps[schema_dep_i] = ref_smod->name;
+
+            ++schema_dep_i;
         }
     }
     SR_CHECK_INT_RET(dep_i != smod->dep_count, err_info);
     SR_CHECK_INT_RET(inv_dep_i != smod->inv_dep_count, err_info);
+    SR_CHECK_INT_RET(schema_dep_i != smod->schema_dep_count, err_info);
 
     /* mod SHM size must be exactly what we allocated */
     assert(shm_end == shm_mod->addr + shm_mod->size);
@@ -766,6 +822,115 @@ sr_shmmod_add_notifs(sr_shm_t *shm_mod, size_t shm_mod_idx, const struct lyd_nod
     return NULL;
 }
 
+/**
+ * @brief Get the size of a hash index for a number of items, at most half-full.
+ *
+ * @param[in] count Item count.
+ * @return Hash index size, power of 2.
+ */
+static uint32_t
+sr_shmmod_index_size(uint32_t count)
+{
+    uint32_t size = 1;
+
+    while (size < count * 2) {
+        size <<= 1;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Insert an item into a hash index.
+ *
+ * @param[in] index Hash index.
+ * @param[in] index_size Size of @p index.
+ * @param[in] key Item key.
+ * @param[in] item Item offset in mod SHM.
+ */
+static void
+sr_shmmod_index_insert(off_t *index, uint32_t index_size, const char *key, off_t item)
+{
+    uint32_t i;
+
+    /* linear probing, there is always a free slot */
+    i = sr_str_hash(key, 0) & (index_size - 1);
+    while (index[i]) {
+        i = (i + 1) & (index_size - 1);
+    }
+    index[i] = item;
+}
+
+/**
+ * @brief Add module and RPC hash indices into mod SHM.
+ *
+ * @param[in] shm_mod Mod SHM structure to remap and append the data to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmod_add_index(sr_shm_t *shm_mod)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_mod_shm_t *mod_shm;
+    sr_mod_t *smod;
+    sr_rpc_t *shm_rpcs;
+    off_t mod_index, rpc_index, *index;
+    uint32_t i, j, rpc_count, mod_index_size, rpc_index_size;
+    char *shm_end;
+    size_t old_shm_size;
+
+    mod_shm = (sr_mod_shm_t *)shm_mod->addr;
+
+    /* count RPCs */
+    rpc_count = 0;
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        rpc_count += SR_SHM_MOD_IDX(mod_shm, i)->rpc_count;
+    }
+    mod_index_size = sr_shmmod_index_size(mod_shm->mod_count);
+    rpc_index_size = sr_shmmod_index_size(rpc_count);
+
+    /* remember mod SHM size */
+    old_shm_size = shm_mod->size;
+
+    /* enlarge and possibly remap mod SHM */
+    if ((err_info = sr_shm_remap(shm_mod, shm_mod->size + SR_SHM_SIZE(mod_index_size * sizeof(off_t)) +
+            SR_SHM_SIZE(rpc_index_size * sizeof(off_t))))) {
+        return err_info;
+    }
+    shm_end = shm_mod->addr + old_shm_size;
+    mod_shm = (sr_mod_shm_t *)shm_mod->addr;
+
+    /* allocate the indices */
+    mod_index = sr_shmcpy(shm_mod->addr, NULL, mod_index_size * sizeof(off_t), &shm_end);
+    memset(shm_mod->addr + mod_index, 0, mod_index_size * sizeof(off_t));
+    rpc_index = sr_shmcpy(shm_mod->addr, NULL, rpc_index_size * sizeof(off_t), &shm_end);
+    memset(shm_mod->addr + rpc_index, 0, rpc_index_size * sizeof(off_t));
+
+    /* fill them */
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        smod = SR_SHM_MOD_IDX(mod_shm, i);
+        index = (off_t *)(shm_mod->addr + mod_index);
+        sr_shmmod_index_insert(index, mod_index_size, shm_mod->addr + smod->name, (char *)smod - shm_mod->addr);
+
+        shm_rpcs = (sr_rpc_t *)(shm_mod->addr + smod->rpcs);
+        index = (off_t *)(shm_mod->addr + rpc_index);
+        for (j = 0; j < smod->rpc_count; ++j) {
+            sr_shmmod_index_insert(index, rpc_index_size, shm_mod->addr + shm_rpcs[j].path,
+                    (char *)&shm_rpcs[j] - shm_mod->addr);
+        }
+    }
+
+    /* use the indices */
+    mod_shm->mod_index = mod_index;
+    mod_shm->mod_index_size = mod_index_size;
+    mod_shm->rpc_index = rpc_index;
+    mod_shm->rpc_index_size = rpc_index_size;
+
+    /* mod SHM size must be exactly what we allocated */
+    assert(shm_end == shm_mod->addr + shm_mod->size);
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmmod_store_modules(sr_shm_t *shm_mod, const struct lyd_node *sr_mods)
 {
@@ -791,8 +956,10 @@ sr_shmmod_store_modules(sr_shm_t *shm_mod, const struct lyd_node *sr_mods)
         goto cleanup;
     }
 
-    /* set module count */
+    /* set module count, the index is built only when all the modules are stored */
     ((sr_mod_shm_t *)shm_mod->addr)->mod_count = set->count;
+    ((sr_mod_shm_t *)shm_mod->addr)->mod_index = 0;
+    ((sr_mod_shm_t *)shm_mod->addr)->rpc_index = 0;
 
     /* add all modules into SHM */
     for (i = 0; i < set->count; ++i) {
@@ -830,6 +997,11 @@ sr_shmmod_store_modules(sr_shm_t *shm_mod, const struct lyd_node *sr_mods)
         }
     }
 
+    /* build the lookup index */
+    if ((err_info = sr_shmmod_add_index(shm_mod))) {
+        goto cleanup;
+    }
+
     /* finally initialize all the locks after mod SHM size and address are final */
     for (i = 0; i < set->count; ++i) {
         sr_mod = set->dnodes[i];
@@ -872,14 +1044,42 @@ sr_shmmod_features2array(char *mod_shm_addr, off_t *shm_features, uint16_t feat_
     return NULL;
 }
 
+/**
+ * @brief Load a single mod SHM module into a context, it is not compiled.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[in] ly_ctx libyang context to update.
+ * @param[in] smod Mod SHM module to load.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmod_ctx_load_module(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, sr_mod_t *smod)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    off_t *shm_features;
+    const char **features;
+
+    /* create the features array */
+    shm_features = (off_t *)((char *)mod_shm + smod->features);
+    if ((err_info = sr_shmmod_features2array((char *)mod_shm, shm_features, smod->feat_count, &features))) {
+        return err_info;
+    }
+
+    /* load the module */
+    err_info = sr_ly_ctx_load_module(ly_ctx, (char *)mod_shm + smod->name, smod->rev[0] ? smod->rev : NULL, features,
+            &ly_mod);
+    free(features);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_shmmod_ctx_load_modules(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, const struct ly_set *skip_mod_set)
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_t *smod;
-    const struct lys_module *skip_mod, *ly_mod;
-    off_t *shm_features;
-    const char *mod_name, **features;
+    const struct lys_module *skip_mod;
+    const char *mod_name;
     uint32_t i, j;
 
     for (i = 0; i < mod_shm->mod_count; ++i) {
@@ -899,16 +1099,8 @@ sr_shmmod_ctx_load_modules(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, const s
             }
         }
 
-        /* create the features array */
-        shm_features = (off_t *)((char *)mod_shm + smod->features);
-        if ((err_info = sr_shmmod_features2array((char *)mod_shm, shm_features, smod->feat_count, &features))) {
-            return err_info;
-        }
-
         /* load the module */
-        err_info = sr_ly_ctx_load_module(ly_ctx, mod_name, smod->rev[0] ? smod->rev : NULL, features, &ly_mod);
-        free(features);
-        if (err_info) {
+        if ((err_info = sr_shmmod_ctx_load_module(mod_shm, ly_ctx, smod))) {
             return err_info;
         }
     }
@@ -921,6 +1113,167 @@ sr_shmmod_ctx_load_modules(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, const s
     return NULL;
 }
 
+/**
+ * @brief Mark a module to be loaded into a lazy context.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[in] name Module name.
+ * @param[in,out] load Array of flags for every mod SHM module whether it is to be loaded.
+ * @param[in,out] stack Stack of marked module indices whose dependencies were not processed yet.
+ * @param[in,out] stack_count Count of @p stack items.
+ */
+static void
+sr_shmmod_ctx_lazy_mark(sr_mod_shm_t *mod_shm, const char *name, uint8_t *load, uint32_t *stack,
+        uint32_t *stack_count)
+{
+    sr_mod_t *smod;
+    uint32_t idx;
+
+    if (!(smod = sr_shmmod_find_module(mod_shm, name))) {
+        /* not an installed module, libyang loads it if needed */
+        return;
+    }
+
+    idx = smod - SR_SHM_MOD_IDX(mod_shm, 0);
+    if (load[idx]) {
+        return;
+    }
+
+    load[idx] = 1;
+    stack[(*stack_count)++] = idx;
+}
+
+/**
+ * @brief Mark all the modules data dependencies refer to.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[in] shm_deps Mod SHM dependencies.
+ * @param[in] shm_dep_count Count of @p shm_deps.
+ * @param[in,out] load Array of flags for every mod SHM module whether it is to be loaded.
+ * @param[in,out] stack Stack of marked module indices whose dependencies were not processed yet.
+ * @param[in,out] stack_count Count of @p stack items.
+ * @return 0 on success, 1 if the dependencies may refer to any module.
+ */
+static int
+sr_shmmod_ctx_lazy_mark_deps(sr_mod_shm_t *mod_shm, sr_dep_t *shm_deps, uint16_t shm_dep_count, uint8_t *load,
+        uint32_t *stack, uint32_t *stack_count)
+{
+    char *mod_shm_addr = (char *)mod_shm;
+    off_t *target_mods;
+    uint16_t i, j;
+
+    for (i = 0; i < shm_dep_count; ++i) {
+        switch (shm_deps[i].type) {
+        case SR_DEP_LREF:
+            sr_shmmod_ctx_lazy_mark(mod_shm, mod_shm_addr + shm_deps[i].lref.target_module, load, stack, stack_count);
+            break;
+        case SR_DEP_INSTID:
+            /* the target is known only from the data */
+            return 1;
+        case SR_DEP_XPATH:
+            target_mods = (off_t *)(mod_shm_addr + shm_deps[i].xpath.target_modules);
+            for (j = 0; j < shm_deps[i].xpath.target_mod_count; ++j) {
+                sr_shmmod_ctx_lazy_mark(mod_shm, mod_shm_addr + target_mods[j], load, stack, stack_count);
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+sr_error_info_t *
+sr_shmmod_ctx_load_modules_lazy(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, char **mod_names, uint32_t mod_name_count)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *int_mods[] = {"ietf-yang-library", "sysrepo-monitoring", "sysrepo-plugind", "ietf-netconf",
+        "ietf-netconf-with-defaults", "ietf-netconf-notifications", "ietf-origin"};
+    const struct lys_module *ly_mod;
+    char *mod_shm_addr = (char *)mod_shm;
+    sr_mod_t *smod;
+    sr_rpc_t *shm_rpcs;
+    sr_notif_t *shm_notifs;
+    off_t *mod_refs;
+    uint8_t *load = NULL;
+    uint32_t *stack = NULL, stack_count = 0, i;
+    uint16_t j;
+    int full = 0;
+
+    load = calloc(mod_shm->mod_count, sizeof *load);
+    stack = malloc(mod_shm->mod_count * sizeof *stack);
+    SR_CHECK_MEM_GOTO(!load || !stack, err_info, cleanup);
+
+    /* modules already in the context, sysrepo internal modules, and the requested modules */
+    i = 0;
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &i))) {
+        if (ly_mod->implemented) {
+            sr_shmmod_ctx_lazy_mark(mod_shm, ly_mod->name, load, stack, &stack_count);
+        }
+    }
+    for (i = 0; i < sizeof int_mods / sizeof *int_mods; ++i) {
+        sr_shmmod_ctx_lazy_mark(mod_shm, int_mods[i], load, stack, &stack_count);
+    }
+    for (i = 0; i < mod_name_count; ++i) {
+        sr_shmmod_ctx_lazy_mark(mod_shm, mod_names[i], load, stack, &stack_count);
+    }
+
+    /* add the whole dependency closure, the imports are loaded by libyang */
+    while (stack_count && !full) {
+        smod = SR_SHM_MOD_IDX(mod_shm, stack[--stack_count]);
+
+        /* data dependencies */
+        full = sr_shmmod_ctx_lazy_mark_deps(mod_shm, (sr_dep_t *)(mod_shm_addr + smod->deps), smod->dep_count, load,
+                stack, &stack_count);
+
+        /* operation dependencies */
+        shm_rpcs = (sr_rpc_t *)(mod_shm_addr + smod->rpcs);
+        for (j = 0; !full && (j < smod->rpc_count); ++j) {
+            full = sr_shmmod_ctx_lazy_mark_deps(mod_shm, (sr_dep_t *)(mod_shm_addr + shm_rpcs[j].in_deps),
+                    shm_rpcs[j].in_dep_count, load, stack, &stack_count);
+            full |= sr_shmmod_ctx_lazy_mark_deps(mod_shm, (sr_dep_t *)(mod_shm_addr + shm_rpcs[j].out_deps),
+                    shm_rpcs[j].out_dep_count, load, stack, &stack_count);
+        }
+        shm_notifs = (sr_notif_t *)(mod_shm_addr + smod->notifs);
+        for (j = 0; !full && (j < smod->notif_count); ++j) {
+            full = sr_shmmod_ctx_lazy_mark_deps(mod_shm, (sr_dep_t *)(mod_shm_addr + shm_notifs[j].deps),
+                    shm_notifs[j].dep_count, load, stack, &stack_count);
+        }
+
+        /* modules validated together with this one and modules completing its schema */
+        mod_refs = (off_t *)(mod_shm_addr + smod->inv_deps);
+        for (j = 0; j < smod->inv_dep_count; ++j) {
+            sr_shmmod_ctx_lazy_mark(mod_shm, mod_shm_addr + mod_refs[j], load, stack, &stack_count);
+        }
+        mod_refs = (off_t *)(mod_shm_addr + smod->schema_deps);
+        for (j = 0; j < smod->schema_dep_count; ++j) {
+            sr_shmmod_ctx_lazy_mark(mod_shm, mod_shm_addr + mod_refs[j], load, stack, &stack_count);
+        }
+    }
+
+    if (full) {
+        /* an instance-identifier may refer to any module */
+        err_info = sr_shmmod_ctx_load_modules(mod_shm, ly_ctx, NULL);
+        goto cleanup;
+    }
+
+    /* load all the marked modules */
+    for (i = 0; i < mod_shm->mod_count; ++i) {
+        if (load[i] && (err_info = sr_shmmod_ctx_load_module(mod_shm, ly_ctx, SR_SHM_MOD_IDX(mod_shm, i)))) {
+            goto cleanup;
+        }
+    }
+
+    /* compile */
+    if ((err_info = sr_ly_ctx_compile(ly_ctx))) {
+        goto cleanup;
+    }
+
+cleanup:
+    free(load);
+    free(stack);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_shmmod_get_rpc_deps(sr_mod_shm_t *mod_shm, const char *path, int output, sr_dep_t **shm_deps, uint16_t *shm_dep_count)
 {
@@ -1165,20 +1518,23 @@ sr_shmmod_recover_cb(sr_lock_mode_t mode, sr_cid_t cid, void *data)
  * @param[in] timeout_ms Timeout in ms. If 0, the default timeout is used.
  * @param[in] mode Lock mode of the module.
  * @param[in] ds_timeout_ms Timeout in ms for DS-lock in case it is required and locked, if 0 no waiting is performed.
- * @param[in] cid Connection ID.
+ * @param[in] conn Connection to use.
  * @param[in] sid Sysrepo session ID to store.
  * @param[in] ds_handle DS plugin handle.
  * @param[in] relock Whether some lock is already held or not.
+ * @param[in] nofair Whether a READ lock ignores the writer-fair policy, see ::sr_rwlock_nofair().
+ * @param[out] ds_locked_err Optional, set if the error returned is the module being DS-locked by another session.
  */
 static sr_error_info_t *
 sr_shmmod_lock(const struct lys_module *ly_mod, sr_datastore_t ds, struct sr_mod_lock_s *shm_lock, uint32_t timeout_ms,
-        sr_lock_mode_t mode, uint32_t ds_timeout_ms, sr_cid_t cid, uint32_t sid, const struct sr_ds_handle_s *ds_handle,
-        int relock)
+        sr_lock_mode_t mode, uint32_t ds_timeout_ms, sr_conn_ctx_t *conn, uint32_t sid,
+        const struct sr_ds_handle_s *ds_handle, int relock, int nofair, int *ds_locked_err)
 {
     sr_error_info_t *err_info = NULL, *tmp_err;
     struct sr_shmmod_recover_cb_s cb_data;
+    sr_cid_t cid = conn->cid;
     int ds_locked;
-    uint32_t sleep_ms;
+    uint32_t sleep_ms, ds_lock_sid = 0;
 
     if (!timeout_ms) {
         /* default timeout */
@@ -1196,6 +1552,10 @@ ds_lock_retry:
     if (relock) {
         /* RELOCK */
         err_info = sr_rwrelock(&shm_lock->data_lock, timeout_ms, mode, cid, __func__, sr_shmmod_recover_cb, &cb_data);
+    } else if (nofair) {
+        /* LOCK */
+        err_info = sr_rwlock_nofair(&shm_lock->data_lock, timeout_ms, mode, cid, __func__, sr_shmmod_recover_cb,
+                &cb_data);
     } else {
         /* LOCK */
         err_info = sr_rwlock(&shm_lock->data_lock, timeout_ms, mode, cid, __func__, sr_shmmod_recover_cb, &cb_data);
@@ -1212,11 +1572,20 @@ ds_lock_retry:
 
         /* DS lock cannot be held for these lock modes */
         if (shm_lock->ds_lock_sid && (shm_lock->ds_lock_sid != sid)) {
+            ds_lock_sid = shm_lock->ds_lock_sid;
             ds_locked = 1;
         }
 
         /* DS UNLOCK */
         sr_munlock(&shm_lock->ds_lock);
+
+        /* nor the DS lock of all the modules, changed only with all the modules WRITE-locked */
+        if (!ds_locked) {
+            ds_lock_sid = ATOMIC_LOAD_RELAXED(SR_CONN_MAIN_SHM(conn)->ds_lock[ds].sid);
+            if (ds_lock_sid && (ds_lock_sid != sid) && sr_module_all_ds_lockable(ly_mod)) {
+                ds_locked = 1;
+            }
+        }
     }
 
     if (ds_locked) {
@@ -1258,7 +1627,10 @@ revert_lock:
     } else {
         /* timeout elapsed */
         sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Module \"%s\" is DS-locked by session %" PRIu32 ".",
-                ly_mod->name, shm_lock->ds_lock_sid);
+                ly_mod->name, ds_lock_sid);
+        if (ds_locked_err) {
+            *ds_locked_err = 1;
+        }
     }
 
 cleanup:
@@ -1266,26 +1638,80 @@ cleanup:
 }
 
 /**
- * @brief Lock all modules in a mod info.
+ * @brief Unlock all the modules locked by the lock batch in progress.
+ *
+ * @param[in] mod_info Mod info with modules.
+ * @param[in] ds Locked datastore.
+ * @param[in] mode Lock mode.
+ * @param[in] lock_bit Bit set for all the locked modules.
+ */
+static void
+sr_shmmod_modinfo_lock_batch_revert(struct sr_mod_info_s *mod_info, sr_datastore_t ds, sr_lock_mode_t mode,
+        uint32_t lock_bit)
+{
+    struct sr_mod_info_mod_s *mod;
+    uint32_t i;
+
+    if (mode == SR_LOCK_WRITE_URGE) {
+        mode = SR_LOCK_WRITE;
+    }
+
+    i = mod_info->mod_count;
+    while (i) {
+        --i;
+        mod = &mod_info->mods[i];
+        if (!(mod->state & MOD_INFO_LOCK_BATCH)) {
+            continue;
+        }
+
+        /* MOD UNLOCK */
+        sr_rwunlock(&mod->shm_mod->data_lock_info[ds].data_lock, SR_MOD_LOCK_TIMEOUT, mode, mod_info->conn->cid,
+                __func__);
+
+        mod->state &= ~(lock_bit | MOD_INFO_LOCK_BATCH);
+    }
+}
+
+/**
+ * @brief Lock all modules in a mod info as a single batch.
+ *
+ * All the module locks of a batch attempt share one deadline so locking the whole batch never takes longer than
+ * @p timeout_ms. If a module is DS-locked, all the modules locked by the batch are unlocked before backing off so
+ * that no locks are held while waiting and the whole batch is retried, with a new deadline, until @p ds_timeout_ms
+ * elapses.
  *
  * @param[in] mod_info Mod info with modules to lock.
  * @param[in] ds Datastore to lock.
  * @param[in] mode Lock mode.
  * @param[in] lock_bit Bit to set for all locked modules.
+ * @param[in] nofair Whether READ locks ignore the writer-fair policy, see ::sr_rwlock_nofair().
  * @param[in] sid Session ID.
- * @param[in] timeout_ms Timeout in ms for mod lock.
+ * @param[in] timeout_ms Timeout in ms for locking all the modules. If 0, the default timeout is used.
  * @param[in] ds_timeout_ms Timeout in ms for DS-lock in case it is required and locked, if 0 no waiting is performed.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_shmmod_modinfo_lock(struct sr_mod_info_s *mod_info, sr_datastore_t ds, sr_lock_mode_t mode, uint32_t lock_bit,
-        uint32_t sid, uint32_t timeout_ms, uint32_t ds_timeout_ms)
+        int nofair, uint32_t sid, uint32_t timeout_ms, uint32_t ds_timeout_ms)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t i;
+    uint32_t i, lock_count, retry_count = 0, mod_timeout_ms, sleep_ms;
+    int elapsed_ms, start_locked, ds_locked;
     struct sr_mod_info_mod_s *mod;
     struct sr_mod_lock_s *shm_lock;
+    struct timespec start_ts, batch_ts, cur_ts;
+
+    if (!timeout_ms) {
+        /* default timeout */
+        timeout_ms = SR_MOD_LOCK_TIMEOUT;
+    }
+    sr_timeouttime_get(&start_ts, 0);
 
+batch_retry:
+    /* the back-off is not part of the lock timeout of the batch */
+    sr_timeouttime_get(&batch_ts, 0);
+    lock_count = 0;
+    ds_locked = 0;
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
         shm_lock = &mod->shm_mod->data_lock_info[ds];
@@ -1302,41 +1728,94 @@ sr_shmmod_modinfo_lock(struct sr_mod_info_s *mod_info, sr_datastore_t ds, sr_loc
             }
         }
 
+        /* use whatever is left of the batch timeout, but always try to lock */
+        sr_timeouttime_get(&cur_ts, 0);
+        elapsed_ms = sr_time_sub_ms(&cur_ts, &batch_ts);
+        mod_timeout_ms = ((elapsed_ms > -1) && ((uint32_t)elapsed_ms < timeout_ms)) ? timeout_ms - elapsed_ms : 1;
+
+        if (((ds == SR_DS_RUNNING) || (ds == SR_DS_CANDIDATE)) && ATOMIC_LOAD_RELAXED(mod->shm_mod->run_inherit)) {
+            /* first access to running data (unmodified candidate data are running data) after boot, copy them */
+            start_locked = ((mod_info->ds == SR_DS_STARTUP) &&
+                    (mod->state & (MOD_INFO_RLOCK | MOD_INFO_RLOCK_UPGR | MOD_INFO_WLOCK))) ||
+                    ((mod_info->ds2 == SR_DS_STARTUP) && (mod->state & MOD_INFO_RLOCK2));
+            if ((err_info = sr_shmmod_run_inherit_copy(mod_info->conn, mod->ly_mod, mod->shm_mod, mod_timeout_ms,
+                    start_locked))) {
+                goto error;
+            }
+        }
+
         /* MOD LOCK */
-        if ((err_info = sr_shmmod_lock(mod->ly_mod, ds, shm_lock, timeout_ms, mode, ds_timeout_ms,
-                mod_info->conn->cid, sid, mod->ds_handle[ds], 0))) {
-            return err_info;
+        if ((err_info = sr_shmmod_lock(mod->ly_mod, ds, shm_lock, mod_timeout_ms, mode, 0, mod_info->conn, sid,
+                mod->ds_handle[ds], 0, nofair, &ds_locked))) {
+            goto error;
         }
 
         /* set the flag for unlocking */
-        mod->state |= lock_bit;
+        mod->state |= lock_bit | MOD_INFO_LOCK_BATCH;
+        ++lock_count;
     }
 
+    /* batch locked */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod_info->mods[i].state &= ~MOD_INFO_LOCK_BATCH;
+    }
+
+    if (lock_count) {
+        sr_timeouttime_get(&cur_ts, 0);
+        SR_LOG_DBG("Locked %" PRIu32 " modules (%s DS) in %d ms (%" PRIu32 " retries).", lock_count, sr_ds2str(ds),
+                sr_time_sub_ms(&cur_ts, &start_ts), retry_count);
+    }
     return NULL;
+
+error:
+    if (ds_locked) {
+        sr_timeouttime_get(&cur_ts, 0);
+        elapsed_ms = sr_time_sub_ms(&cur_ts, &start_ts);
+        if ((elapsed_ms > -1) && ((uint32_t)elapsed_ms < ds_timeout_ms)) {
+            /* DS-locked, back off without holding any locks and retry the whole batch */
+            sr_errinfo_free(&err_info);
+            sr_shmmod_modinfo_lock_batch_revert(mod_info, ds, mode, lock_bit);
+
+            sleep_ms = ds_timeout_ms - elapsed_ms;
+            if (sleep_ms > SR_DS_LOCK_TIMEOUT_STEP) {
+                sleep_ms = SR_DS_LOCK_TIMEOUT_STEP;
+            }
+            sr_msleep(sleep_ms);
+            ++retry_count;
+            goto batch_retry;
+        }
+    }
+
+    /* keep the locked modules flagged, they are unlocked by the caller */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod_info->mods[i].state &= ~MOD_INFO_LOCK_BATCH;
+    }
+    return err_info;
 }
 
 sr_error_info_t *
-sr_shmmod_modinfo_rdlock(struct sr_mod_info_s *mod_info, int upgradeable, uint32_t sid, uint32_t timeout_ms,
+sr_shmmod_modinfo_rdlock(struct sr_mod_info_s *mod_info, int upgradeable, int nofair, uint32_t sid, uint32_t timeout_ms,
         uint32_t ds_timeout_ms)
 {
     sr_error_info_t *err_info = NULL;
 
     if (upgradeable) {
         /* read-upgr-lock main DS */
-        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_READ_UPGR, MOD_INFO_RLOCK_UPGR, sid,
-                timeout_ms, ds_timeout_ms))) {
+        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_READ_UPGR, MOD_INFO_RLOCK_UPGR, nofair,
+                sid, timeout_ms, ds_timeout_ms))) {
             return err_info;
         }
     } else {
         /* read-lock main DS */
-        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_READ, MOD_INFO_RLOCK, sid, timeout_ms, 0))) {
+        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_READ, MOD_INFO_RLOCK, nofair, sid,
+                timeout_ms, 0))) {
             return err_info;
         }
     }
 
     if (mod_info->ds2 != mod_info->ds) {
         /* read-lock the secondary DS */
-        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds2, SR_LOCK_READ, MOD_INFO_RLOCK2, sid,
+        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds2, SR_LOCK_READ, MOD_INFO_RLOCK2, nofair, sid,
                 timeout_ms, 0))) {
             return err_info;
         }
@@ -1351,14 +1830,14 @@ sr_shmmod_modinfo_wrlock(struct sr_mod_info_s *mod_info, uint32_t sid, uint32_t
     sr_error_info_t *err_info = NULL;
 
     /* urge write-lock main DS (to prevent starvation) */
-    if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_WRITE_URGE, MOD_INFO_WLOCK, sid, timeout_ms,
-            ds_timeout_ms))) {
+    if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds, SR_LOCK_WRITE_URGE, MOD_INFO_WLOCK, 0, sid,
+            timeout_ms, ds_timeout_ms))) {
         return err_info;
     }
 
     if (mod_info->ds2 != mod_info->ds) {
         /* read-lock the secondary DS */
-        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds2, SR_LOCK_READ, MOD_INFO_RLOCK2, sid,
+        if ((err_info = sr_shmmod_modinfo_lock(mod_info, mod_info->ds2, SR_LOCK_READ, MOD_INFO_RLOCK2, 0, sid,
                 timeout_ms, 0))) {
             return err_info;
         }
@@ -1384,7 +1863,7 @@ sr_shmmod_modinfo_rdlock_upgrade(struct sr_mod_info_s *mod_info, uint32_t sid, u
         if ((mod->state & (MOD_INFO_RLOCK_UPGR | MOD_INFO_REQ)) == (MOD_INFO_RLOCK_UPGR | MOD_INFO_REQ)) {
             /* MOD WRITE UPGRADE */
             if ((err_info = sr_shmmod_lock(mod->ly_mod, mod_info->ds, shm_lock, timeout_ms, SR_LOCK_WRITE_URGE,
-                    ds_timeout_ms, mod_info->conn->cid, sid, mod->ds_handle[mod_info->ds], 1))) {
+                    ds_timeout_ms, mod_info->conn, sid, mod->ds_handle[mod_info->ds], 1, 0, NULL))) {
                 return err_info;
             }
 
@@ -1413,7 +1892,7 @@ sr_shmmod_modinfo_wrlock_downgrade(struct sr_mod_info_s *mod_info, uint32_t sid,
         if (mod->state & (MOD_INFO_WLOCK | MOD_INFO_RLOCK_UPGR)) {
             /* MOD READ DOWNGRADE */
             if ((err_info = sr_shmmod_lock(mod->ly_mod, mod_info->ds, shm_lock, timeout_ms, SR_LOCK_READ,
-                    0, mod_info->conn->cid, sid, mod->ds_handle[mod_info->ds], 1))) {
+                    0, mod_info->conn, sid, mod->ds_handle[mod_info->ds], 1, 0, NULL))) {
                 return err_info;
             }
 
@@ -1475,10 +1954,31 @@ sr_shmmod_release_locks(sr_conn_ctx_t *conn, uint32_t sid)
     const struct lys_module *ly_mod;
     struct sr_mod_lock_s *shm_lock;
     const struct sr_ds_handle_s *ds_handle;
+    struct sr_main_ds_lock_s *main_lock;
     sr_datastore_t ds;
-    int ds_locked;
+    int ds_locked, all_ds_locked[SR_DS_COUNT] = {0};
     uint32_t i;
 
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        main_lock = &SR_CONN_MAIN_SHM(conn)->ds_lock[ds];
+
+        /* MAIN DS LOCK */
+        if ((err_info = sr_mlock(&main_lock->lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+            sr_errinfo_free(&err_info);
+            continue;
+        }
+
+        if (ATOMIC_LOAD_RELAXED(main_lock->sid) == sid) {
+            /* DS lock of all the modules held, clear it */
+            all_ds_locked[ds] = 1;
+            ATOMIC_STORE_RELAXED(main_lock->sid, 0);
+            memset(&main_lock->ts, 0, sizeof main_lock->ts);
+        }
+
+        /* MAIN DS UNLOCK */
+        sr_munlock(&main_lock->lock);
+    }
+
     for (i = 0; i < SR_CONN_MOD_SHM(conn)->mod_count; ++i) {
         smod = SR_SHM_MOD_IDX(conn->mod_shm.addr, i);
         ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, conn->mod_shm.addr + smod->name);
@@ -1492,7 +1992,7 @@ sr_shmmod_release_locks(sr_conn_ctx_t *conn, uint32_t sid)
                 continue;
             }
 
-            ds_locked = 0;
+            ds_locked = all_ds_locked[ds] && sr_module_all_ds_lockable(ly_mod);
             if (shm_lock->ds_lock_sid == sid) {
                 /* DS lock held */
                 ds_locked = 1;
@@ -1513,8 +2013,8 @@ sr_shmmod_release_locks(sr_conn_ctx_t *conn, uint32_t sid)
                 }
 
                 /* MOD WRITE LOCK */
-                if ((err_info = sr_shmmod_lock(ly_mod, ds, shm_lock, SR_MOD_LOCK_TIMEOUT, SR_LOCK_WRITE, 0, conn->cid,
-                        sid, ds_handle, 0))) {
+                if ((err_info = sr_shmmod_lock(ly_mod, ds, shm_lock, SR_MOD_LOCK_TIMEOUT, SR_LOCK_WRITE, 0, conn, sid,
+                        ds_handle, 0, 0, NULL))) {
                     sr_errinfo_free(&err_info);
                 } else {
                     /* reset candidate */
@@ -1607,6 +2107,80 @@ cleanup:
     return err_info;
 }
 
+sr_error_info_t *
+sr_shmmod_run_inherit_copy(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, sr_mod_t *shm_mod,
+        uint32_t timeout_ms, int start_locked)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct sr_ds_handle_s *sds_handle, *rds_handle;
+    struct sr_shmmod_recover_cb_s cb_data;
+    struct sr_mod_lock_s *run_lock, *start_lock;
+
+    if (!ATOMIC_LOAD_RELAXED(shm_mod->run_inherit)) {
+        /* already copied */
+        return NULL;
+    }
+
+    if (!timeout_ms) {
+        /* default timeout */
+        timeout_ms = SR_MOD_LOCK_TIMEOUT;
+    }
+
+    /* get DS plugin handles */
+    if ((err_info = sr_ds_handle_find(conn->mod_shm.addr + shm_mod->plugins[SR_DS_STARTUP], conn, &sds_handle))) {
+        return err_info;
+    }
+    if ((err_info = sr_ds_handle_find(conn->mod_shm.addr + shm_mod->plugins[SR_DS_RUNNING], conn, &rds_handle))) {
+        return err_info;
+    }
+
+    run_lock = &shm_mod->data_lock_info[SR_DS_RUNNING];
+    start_lock = &shm_mod->data_lock_info[SR_DS_STARTUP];
+    cb_data.ly_ctx_p = (struct ly_ctx **)&ly_mod->ctx;
+    cb_data.ds = SR_DS_RUNNING;
+    cb_data.ds_handle = rds_handle;
+
+    /* RUNNING WRITE LOCK */
+    if ((err_info = sr_rwlock(&run_lock->data_lock, timeout_ms, SR_LOCK_WRITE, conn->cid, __func__,
+            sr_shmmod_recover_cb, &cb_data))) {
+        return err_info;
+    }
+
+    if (!ATOMIC_LOAD_RELAXED(shm_mod->run_inherit)) {
+        /* copied meanwhile */
+        goto cleanup_run_unlock;
+    }
+
+    if (!start_locked) {
+        cb_data.ds = SR_DS_STARTUP;
+        cb_data.ds_handle = sds_handle;
+
+        /* STARTUP READ LOCK */
+        if ((err_info = sr_rwlock(&start_lock->data_lock, timeout_ms, SR_LOCK_READ, conn->cid, __func__,
+                sr_shmmod_recover_cb, &cb_data))) {
+            goto cleanup_run_unlock;
+        }
+    }
+
+    /* copy startup to running */
+    err_info = sr_shmmod_copy_mod(ly_mod, sds_handle, SR_DS_STARTUP, rds_handle, SR_DS_RUNNING);
+
+    if (!start_locked) {
+        /* STARTUP READ UNLOCK */
+        sr_rwunlock(&start_lock->data_lock, timeout_ms, SR_LOCK_READ, conn->cid, __func__);
+    }
+
+    if (!err_info) {
+        ATOMIC_STORE_RELAXED(shm_mod->run_inherit, 0);
+        SR_LOG_INF("Module \"%s\" data copied from <startup> to <running>.", ly_mod->name);
+    }
+
+cleanup_run_unlock:
+    /* RUNNING WRITE UNLOCK */
+    sr_rwunlock(&run_lock->data_lock, timeout_ms, SR_LOCK_WRITE, conn->cid, __func__);
+    return err_info;
+}
+
 /**
  * @brief qsort(3) compar callback implementation.
  */
@@ -1672,14 +2246,23 @@ sr_shmmod_reboot_init(sr_conn_ctx_t *conn, int initialized)
             continue;
         }
 
+#ifdef SR_LAZY_RUNNING
+        /* running data inherit startup data until they are first accessed and copied */
+        ATOMIC_STORE_RELAXED(smods[i]->run_inherit, 1);
+#else
         /* copy startup to running */
         if ((err_info = sr_shmmod_copy_mod(ly_mod, ds_handle[SR_DS_STARTUP], SR_DS_STARTUP, ds_handle[SR_DS_RUNNING],
                 SR_DS_RUNNING))) {
             goto cleanup;
         }
+#endif
     }
 
+#ifdef SR_LAZY_RUNNING
+    SR_LOG_INF("Datastore <running> inherits <startup>, copied on the first access of each module.");
+#else
     SR_LOG_INF("Datastore copied from <startup> to <running>.");
+#endif
 
 cleanup:
     free(smods);
@@ -1711,7 +2294,7 @@ sr_shmmod_change_prio(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, sr_d
 
     /* SHM MOD LOCK */
     if ((err_info = sr_shmmod_lock(ly_mod, ds, shm_lock, SR_CHANGE_CB_TIMEOUT, prio_p ? SR_LOCK_READ : SR_LOCK_WRITE,
-            SR_CHANGE_CB_TIMEOUT, conn->cid, 0, ds_handle, 0))) {
+            SR_CHANGE_CB_TIMEOUT, conn, 0, ds_handle, 0, 0, NULL))) {
         return err_info;
     }
 
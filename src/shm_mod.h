@@ -78,6 +78,22 @@ sr_error_info_t *sr_shmmod_store_modules(sr_shm_t *shm_mod, const struct lyd_nod
  */
 sr_error_info_t *sr_shmmod_ctx_load_modules(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, const struct ly_set *skip_mod_set);
 
+/**
+ * @brief Load only some modules stored in mod SHM into a context, for ::SR_CONN_CTX_LAZY connections.
+ *
+ * Loaded are the modules already implemented in the context, sysrepo internal modules, and the requested modules,
+ * all with the modules that their data, operations, or schema depend on, recursively. If an instance-identifier
+ * dependency is found, all the modules are loaded.
+ *
+ * @param[in] mod_shm Mod SHM.
+ * @param[in,out] ly_ctx libyang context to update.
+ * @param[in] mod_names Names of the requested modules.
+ * @param[in] mod_name_count Count of @p mod_names.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmmod_ctx_load_modules_lazy(sr_mod_shm_t *mod_shm, struct ly_ctx *ly_ctx, char **mod_names,
+        uint32_t mod_name_count);
+
 /**
  * @brief Get SHM dependencies of an RPC/action.
  *
@@ -160,12 +176,13 @@ void sr_shmmod_recover_cb(sr_lock_mode_t mode, sr_cid_t cid, void *data);
  *
  * @param[in] mod_info Mod info to use.
  * @param[in] upgradeable Whether the lock will be upgraded to WRITE later. Used only for main DS of @p mod_info!
+ * @param[in] nofair Whether the locks ignore the writer-fair policy, for event sessions, see ::sr_rwlock_nofair().
  * @param[in] sid Sysrepo session ID.
  * @param[in] timeout_ms Timeout in ms for getting mod lock, 0 for the default.
  * @param[in] ds_timeout_ms Timeout in ms for DS-lock in case it is required and locked, if 0 no waiting is performed.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmmod_modinfo_rdlock(struct sr_mod_info_s *mod_info, int upgradeable, uint32_t sid,
+sr_error_info_t *sr_shmmod_modinfo_rdlock(struct sr_mod_info_s *mod_info, int upgradeable, int nofair, uint32_t sid,
         uint32_t timeout_ms, uint32_t ds_timeout_ms);
 
 /**
@@ -231,7 +248,32 @@ void sr_shmmod_release_locks(sr_conn_ctx_t *conn, uint32_t sid);
 sr_error_info_t *sr_shmmod_update_replay_support(sr_mod_shm_t *mod_shm, const struct ly_set *mod_set, int enable);
 
 /**
- * @brief Initialize datastores after a reboot. Includes calling init callbacks and copying startup DS to running DS.
+ * @brief Copy startup data of a module into running if running data still inherit them after boot.
+ *
+ * Called on the first access to the running data of a module with ::SR_LAZY_RUNNING before locking them.
+ *
+ * Running (and candidate) data of a module are read only after this copy, which is ensured by
+ * ::sr_shmmod_modinfo_rdlock() and ::sr_shmmod_modinfo_wrlock() for all the data read through a mod info. Only these
+ * code paths may read running data without the mod info lock:
+ * - loading all the data on a context change (context_change.c), which calls this function first;
+ * - this function itself and ::sr_shmmod_reboot_init(), which access the data using the DS plugins directly;
+ * - initializing the data of newly installed modules, which never inherit startup data.
+ *
+ * Any new code path reading running data of a module without the mod info lock must call this function first.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod libyang module.
+ * @param[in] shm_mod SHM module.
+ * @param[in] timeout_ms Timeout in ms for locking the module. If 0, the default timeout is used.
+ * @param[in] start_locked Whether startup data of the module are already locked.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmmod_run_inherit_copy(sr_conn_ctx_t *conn, const struct lys_module *ly_mod, sr_mod_t *shm_mod,
+        uint32_t timeout_ms, int start_locked);
+
+/**
+ * @brief Initialize datastores after a reboot. Includes calling init callbacks and copying startup DS to running DS
+ * or, with ::SR_LAZY_RUNNING, marking the running data of the modules as inheriting startup data.
  *
  * @param[in] conn Connection to use.
  * @param[in] initialized Whether installed modules have already been initialized or not.
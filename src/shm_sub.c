@@ -20,6 +20,7 @@
 #include "shm_sub.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
@@ -33,6 +34,7 @@
 #include <unistd.h>
 
 #include "common.h"
+#include "config.h"
 #include "context_change.h"
 #include "edit_diff.h"
 #include "log.h"
@@ -76,13 +78,14 @@ struct sr_shmsub_many_info_change_s {
     struct sr_mod_info_mod_s *mod;
     uint32_t mod_priority;
     uint32_t cur_priority;
+    uint32_t subscriber_count;
     int change_error;
     uint32_t err_priority;
     uint32_t err_subscriber_count;
 };
 
 /**
- * @brief Structure for parallel (for all subscribers for the same XPath) oper get notifications.
+ * @brief Structure for parallel (for all subscribers of all the requested XPaths) oper get notifications.
  */
 struct sr_shmsub_many_info_oper_get_s {
     sr_shm_t shm_sub;
@@ -95,6 +98,7 @@ struct sr_shmsub_many_info_oper_get_s {
     sr_error_info_t *cb_err_info;
 
     sr_mod_oper_get_xpath_sub_t *xpath_sub;
+    uint32_t req_idx;
 };
 
 sr_error_info_t *
@@ -130,6 +134,9 @@ sr_shmsub_create(const char *name, const char *suffix1, int64_t suffix2, size_t
         goto cleanup;
     }
 
+    /* the lock mutex is also used directly for waiting on events, all readers must lock it */
+    sub_shm->lock.mutex_read = 1;
+
 cleanup:
     free(path);
     sr_shm_clear(&shm);
@@ -255,6 +262,10 @@ sr_shmsub_data_open_remap(const char *name, const char *suffix1, int64_t suffix2
             SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
             goto cleanup;
         }
+
+        /* data are written repeatedly by the originator and all the subscribers, avoid remapping on growth */
+        shm->reserve = SR_SHM_RESERVE_SIZE;
+        shm->huge = sr_shm_hugepages();
     }
 
     /* map it */
@@ -270,6 +281,68 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Resize an opened subscription data SHM for writing an event and let the listeners know about it.
+ *
+ * Needs the sub SHM WRITE lock.
+ *
+ * @param[in] sub_shm Subscription SHM with the data SHM size generation.
+ * @param[in,out] shm Mapped data SHM.
+ * @param[in] new_shm_size Size of the data to write.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_data_resize(sr_sub_shm_t *sub_shm, sr_shm_t *shm, size_t new_shm_size)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t old_size = shm->size;
+
+    if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm, new_shm_size))) {
+        return err_info;
+    }
+
+    if (shm->size != old_size) {
+        /* SHM file was truncated, listeners with a persistent mapping must read its new size */
+        ATOMIC_INC_RELAXED(sub_shm->data_gen);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Open and map a subscription data SHM of a listener, which keeps it mapped for the subscription lifetime.
+ *
+ * The size of the SHM file is read only if it was resized since the last event.
+ *
+ * @param[in] name Subscription name (module name).
+ * @param[in] suffix1 First suffix.
+ * @param[in] suffix2 Second suffix, none if set to -1.
+ * @param[in] sub_shm Subscription SHM with the data SHM size generation.
+ * @param[in,out] shm Persistent data SHM.
+ * @param[in,out] data_gen Data SHM size generation of @p shm.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_data_listen_map(const char *name, const char *suffix1, int64_t suffix2, sr_sub_shm_t *sub_shm, sr_shm_t *shm,
+        uint32_t *data_gen)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t cur_gen;
+
+    cur_gen = ATOMIC_LOAD_RELAXED(sub_shm->data_gen);
+    if ((shm->fd > -1) && (cur_gen == *data_gen)) {
+        /* mapping is up-to-date */
+        return NULL;
+    }
+
+    if ((err_info = sr_shmsub_data_open_remap(name, suffix1, suffix2, shm, 0))) {
+        return err_info;
+    }
+    *data_gen = cur_gen;
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmsub_data_unlink(const char *name, const char *suffix1, int64_t suffix2)
 {
@@ -325,107 +398,35 @@ sr_shmsub_recover(sr_sub_shm_t *sub_shm)
             sr_ev2str(ev), sub_shm->orig_cid,
             (uint32_t)ATOMIC_LOAD_RELAXED(sub_shm->request_id));
 
-    /* clear the event */
+    /* clear the event and remove any diff segments of the dead originator */
     ATOMIC_STORE_RELAXED(sub_shm->event, SR_SUB_EV_NONE);
+    if (sub_shm->orig_cid) {
+        sr_remove_sub_diffs(sub_shm->orig_cid);
+    }
     sub_shm->orig_cid = 0;
 }
 
 /**
- * @brief Wait for and keep WRITE lock on a subscription when a new event is to be written.
+ * @brief Wait on a subscription condition for an event to be processed.
  *
- * @param[in] sub_shm Subscription SHM to lock.
- * @param[in] shm_name Subscription SHM name.
- * @param[in] lock_event Which leftover event is OK to lock the SHM with, if any.
- * @param[in] cid Connection ID.
- * @return err_info, NULL on success.
+ * @param[in] sub_shm Subscription SHM with the condition.
+ * @param[in] conn Connection to use, decides whether to spin before sleeping.
+ * @param[in] timeout_abs Absolute timeout for waiting.
+ * @return errno
  */
-static sr_error_info_t *
-sr_shmsub_notify_new_wrlock(sr_sub_shm_t *sub_shm, const char *shm_name, sr_sub_event_t lock_event, sr_cid_t cid)
+static int
+sr_shmsub_cond_wait(sr_sub_shm_t *sub_shm, sr_conn_ctx_t *conn, struct timespec *timeout_abs)
 {
-    sr_error_info_t *err_info = NULL;
-    struct timespec timeout_abs;
-    sr_sub_event_t last_event;
-    uint32_t last_request_id;
-    int ret;
-
-    /* it is only possible to lock with none or error */
-    assert(!lock_event || (SR_SUB_EV_ERROR == lock_event));
-
-    /* WRITE LOCK */
-    if ((err_info = sr_rwlock(&sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, cid, __func__, NULL, NULL))) {
-        return err_info;
-    }
-
-    if (ATOMIC_LOAD_RELAXED(sub_shm->event) && (ATOMIC_LOAD_RELAXED(sub_shm->event) != lock_event)) {
-        /* instead of waiting, try to recover the event immediately */
-        sr_shmsub_recover(sub_shm);
-    }
-
-    assert(sub_shm->lock.writer == cid);
-    /* FAKE WRITE UNLOCK */
-    sub_shm->lock.writer = 0;
-
-    /* wait until there is no event and there are no readers (just like write lock) */
-    sr_timeouttime_get(&timeout_abs, SR_SUBSHM_LOCK_TIMEOUT);
-    ret = 0;
-    while (!ret && (sub_shm->lock.readers[0] || (ATOMIC_LOAD_RELAXED(sub_shm->event) &&
-            (ATOMIC_LOAD_RELAXED(sub_shm->event) != lock_event)))) {
-        /* COND WAIT */
-        ret = sr_cond_clockwait(&sub_shm->lock.cond, &sub_shm->lock.mutex, COMPAT_CLOCK_ID, &timeout_abs);
-    }
-
-    if (!sub_shm->lock.readers[0]) {
-        /* FAKE WRITE LOCK */
-        assert(!sub_shm->lock.writer);
-        sub_shm->lock.writer = cid;
-
-        if (ret == ETIMEDOUT) {
-            /* try to recover the event again in case the originator crashed later */
-            sr_shmsub_recover(sub_shm);
-            if (!ATOMIC_LOAD_RELAXED(sub_shm->event)) {
-                /* recovered */
-                ret = 0;
-            }
-        }
-    }
-
-    last_event = ATOMIC_LOAD_RELAXED(sub_shm->event);
-    last_request_id = ATOMIC_LOAD_RELAXED(sub_shm->request_id);
-
-    if (ret) {
-        if ((ret == ETIMEDOUT) && (!sub_shm->lock.readers[0]) &&
-                (!last_event || (last_event == lock_event))) {
-            /* even though the timeout has elapsed, the event was handled so continue normally */
-            /* ensure that there are no readers left, otherwise we don't have the write lock */
-            goto event_handled;
-        } else if ((ret == ETIMEDOUT) && (last_event && (last_event != lock_event))) {
-            /* timeout */
-            sr_errinfo_new(&err_info, SR_ERR_TIME_OUT,
-                    "Waiting for subscription of \"%s\" failed, previous event \"%s\" ID %" PRIu32 " was not processed.",
-                    shm_name, sr_ev2str(last_event), last_request_id);
-        } else {
-            /* other error */
-            SR_ERRINFO_COND(&err_info, __func__, ret);
-        }
-
-        if (!sub_shm->lock.readers[0]) {
-            /* WRITE UNLOCK */
-            sr_rwunlock(&sub_shm->lock, 0, SR_LOCK_WRITE, cid, __func__);
-        } else {
-            /* we only hold the mutex */
-            sr_munlock(&sub_shm->lock.mutex);
-        }
-        return err_info;
+#ifdef SR_SUB_SPIN_WAIT
+    (void)conn;
+#else
+    if (!(conn->opts & SR_CONN_SUB_SPIN_WAIT)) {
+        return sr_cond_clockwait(&sub_shm->lock.cond, &sub_shm->lock.mutex, COMPAT_CLOCK_ID, timeout_abs);
     }
+#endif
 
-event_handled:
-    /* we have write lock and the expected event, remove any left over orig_cid */
-    if (sub_shm->orig_cid) {
-        SR_LOG_WRN("Recovered \"%s\" previous event \"%s\" ID %" PRIu32 " abandoned by CID %" PRIu32,
-                shm_name, sr_ev2str(last_event), last_request_id, sub_shm->orig_cid);
-        sub_shm->orig_cid = 0;
-    }
-    return NULL;
+    /* events are usually processed within microseconds, avoid the context switches */
+    return sr_cond_clockwait_spin(&sub_shm->lock.cond, &sub_shm->lock.mutex, COMPAT_CLOCK_ID, timeout_abs);
 }
 
 /**
@@ -446,7 +447,7 @@ event_handled:
  *                                    success (never error) event is cleared,
  *              ::SR_SUB_EV_ERROR - an answer is expected and SHM will be further accessed so do not clear any events.
  * @param[in] clear_ev_on_err Whether to clear the current event if error/timeout occurs or leave it be.
- * @param[in] cid Connection ID.
+ * @param[in] conn Connection to use.
  * @param[in] shm_data_sub Opened sub data SHM.
  * @param[in] timeout_abs Absolute timeout for the event to be handled.
  * @param[out] lock_lost Set if the WRITE lock was released, possible only if err_info is returned.
@@ -455,7 +456,7 @@ event_handled:
  */
 static sr_error_info_t *
 _sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t event, uint32_t request_id, sr_sub_event_t expected_ev,
-        int clear_ev_on_err, sr_cid_t cid, sr_shm_t *shm_data_sub, struct timespec *timeout_abs, int *lock_lost,
+        int clear_ev_on_err, sr_conn_ctx_t *conn, sr_shm_t *shm_data_sub, struct timespec *timeout_abs, int *lock_lost,
         sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
@@ -471,16 +472,16 @@ _sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t event, uint32_t
 
     *lock_lost = 0;
 
-    assert(sub_shm->lock.writer == cid);
+    assert(sub_shm->lock.writer == conn->cid);
     /* FAKE WRITE UNLOCK */
     sub_shm->lock.writer = 0;
 
     /* wait until this event was processed and there are no readers or another writer (just like a write lock) */
     ret = 0;
-    while (!ret && (sub_shm->lock.readers[0] || sub_shm->lock.writer ||
+    while (!ret && (sr_rwlock_has_readers(&sub_shm->lock) || sub_shm->lock.writer ||
             (ATOMIC_LOAD_RELAXED(sub_shm->event) && !SR_IS_NOTIFY_EVENT(ATOMIC_LOAD_RELAXED(sub_shm->event))))) {
         /* COND WAIT */
-        ret = sr_cond_clockwait(&sub_shm->lock.cond, &sub_shm->lock.mutex, COMPAT_CLOCK_ID, timeout_abs);
+        ret = sr_shmsub_cond_wait(sub_shm, conn, timeout_abs);
     }
     /* we are holding the mutex but no lock flags are set */
 
@@ -502,7 +503,8 @@ _sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t event, uint32_t
         } else if ((ret == ETIMEDOUT) && (event == last_event)) { /* our publised event remains untouched in SHM */
             /* WRITE LOCK, chances are we will get it if we ignore the event */
             timeout_abs2 = sr_time_ts_add(timeout_abs, SR_EVENT_TIMEOUT_LOCK_TIMEOUT);
-            if (!(err_info = sr_sub_rwlock(&sub_shm->lock, &timeout_abs2, SR_LOCK_WRITE, cid, __func__, NULL, NULL, 1))) {
+            if (!(err_info = sr_sub_rwlock(&sub_shm->lock, &timeout_abs2, SR_LOCK_WRITE, conn->cid, __func__, NULL, NULL,
+                    1))) {
                 /* event timeout */
                 sr_errinfo_new(cb_err_info, SR_ERR_TIME_OUT, "EV ORIGIN: SHM event \"%s\" ID %" PRIu32 " processing timed out.",
                         sr_ev2str(event), request_id);
@@ -520,13 +522,13 @@ _sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t event, uint32_t
 
         if (write_lock) {
             /* we already have the write lock */
-        } else if (sub_shm->lock.readers[0] || sub_shm->lock.writer) {
+        } else if (sr_rwlock_has_readers(&sub_shm->lock) || sub_shm->lock.writer) {
             /* UNLOCK mutex, we do not really have the lock */
             sr_munlock(&sub_shm->lock.mutex);
             *lock_lost = 1;
         } else {
             /* set the WRITE lock back */
-            sub_shm->lock.writer = cid;
+            sub_shm->lock.writer = conn->cid;
         }
 
         if (event == last_event) {
@@ -544,7 +546,11 @@ _sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t event, uint32_t
 
 event_handled:
     /* FAKE WRITE LOCK */
-    sub_shm->lock.writer = cid;
+    sub_shm->lock.writer = conn->cid;
+
+#ifdef SR_EVENT_TRACE
+    sr_event_trace_reply(&sub_shm->trace);
+#endif
 
     /* remap sub data SHM */
     if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm_data_sub, 0))) {
@@ -636,7 +642,7 @@ event_handled:
  *                                    success (never error) event is cleared,
  *              ::SR_SUB_EV_ERROR - an answer is expected and SHM will be further accessed so do not clear any events.
  * @param[in] clear_ev_on_err Whether to clear the current event if error/timeout occurs or leave it be.
- * @param[in] cid Connection ID.
+ * @param[in] conn Connection to use.
  * @param[in] shm_data_sub Opened sub data SHM.
  * @param[in] timeout_ms Timeout in milliseconds.
  * @param[out] lock_lost Set if the WRITE lock was released, possible only if err_info is returned.
@@ -644,7 +650,7 @@ event_handled:
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t expected_ev, int clear_ev_on_err, sr_cid_t cid,
+sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t expected_ev, int clear_ev_on_err, sr_conn_ctx_t *conn,
         sr_shm_t *shm_data_sub, uint32_t timeout_ms, int *lock_lost, sr_error_info_t **cb_err_info)
 {
     sr_sub_event_t event;
@@ -658,7 +664,7 @@ sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t expected_ev, int
     /* compute the timeout */
     sr_timeouttime_get(&timeout_abs, timeout_ms);
 
-    return _sr_shmsub_notify_wait_wr(sub_shm, event, request_id, expected_ev, clear_ev_on_err, cid, shm_data_sub,
+    return _sr_shmsub_notify_wait_wr(sub_shm, event, request_id, expected_ev, clear_ev_on_err, conn, shm_data_sub,
             &timeout_abs, lock_lost, cb_err_info);
 }
 
@@ -679,13 +685,13 @@ sr_shmsub_notify_wait_wr(sr_sub_shm_t *sub_shm, sr_sub_event_t expected_ev, int
  *                                    success (never error) event is cleared,
  *              ::SR_SUB_EV_ERROR - an answer is expected and SHM will be further accessed so do not clear any events.
  * @param[in] clear_ev_on_err Whether to clear the current event if error/timeout occurs or leave it be.
- * @param[in] cid Connection ID.
+ * @param[in] conn Connection to use.
  * @param[in] timeout_ms Timeout in milliseconds.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_shmsub_notify_many_wait_wr(struct sr_shmsub_many_info_s *notify_subs, uint32_t notify_size, uint32_t notify_count,
-        sr_sub_event_t expected_ev, int clear_ev_on_err, sr_cid_t cid, uint32_t timeout_ms)
+        sr_sub_event_t expected_ev, int clear_ev_on_err, sr_conn_ctx_t *conn, uint32_t timeout_ms)
 {
     sr_error_info_t *err_info = NULL, *tmp_err;
     struct sr_shmsub_many_info_s *nsub;
@@ -708,7 +714,7 @@ sr_shmsub_notify_many_wait_wr(struct sr_shmsub_many_info_s *notify_subs, uint32_
         nsub->request_id = ATOMIC_LOAD_RELAXED(nsub->sub_shm->request_id);
 
         /* SUB UNLOCK */
-        sr_rwunlock(&nsub->sub_shm->lock, 0, nsub->lock, cid, __func__);
+        sr_rwunlock(&nsub->sub_shm->lock, 0, nsub->lock, conn->cid, __func__);
         nsub->lock = SR_LOCK_NONE;
     }
 
@@ -722,7 +728,8 @@ sr_shmsub_notify_many_wait_wr(struct sr_shmsub_many_info_s *notify_subs, uint32_
         assert(!nsub->lock);
 
         /* SUB WRITE LOCK */
-        if ((tmp_err = sr_sub_rwlock(&nsub->sub_shm->lock, &timeout_abs, SR_LOCK_WRITE, cid, __func__, NULL, NULL, 0))) {
+        if ((tmp_err = sr_sub_rwlock(&nsub->sub_shm->lock, &timeout_abs, SR_LOCK_WRITE, conn->cid, __func__, NULL, NULL,
+                0))) {
             /* fatal problem, clear the event without WRITE lock for it not to get stuck */
             if ((nsub->event == ATOMIC_LOAD_RELAXED(nsub->sub_shm->event)) &&
                     (nsub->request_id == ATOMIC_LOAD_RELAXED(nsub->sub_shm->request_id))) {
@@ -742,7 +749,7 @@ sr_shmsub_notify_many_wait_wr(struct sr_shmsub_many_info_s *notify_subs, uint32_
 
         /* wait for an event change */
         tmp_err = _sr_shmsub_notify_wait_wr(nsub->sub_shm, nsub->event, nsub->request_id, expected_ev, clear_ev_on_err,
-                cid, &nsub->shm_data_sub, &timeout_abs, &lock_lost, &nsub->cb_err_info);
+                conn, &nsub->shm_data_sub, &timeout_abs, &lock_lost, &nsub->cb_err_info);
         if (tmp_err) {
             if (lock_lost) {
                 /* WRITE lock lost */
@@ -799,10 +806,15 @@ sr_shmsub_notify_write_event(sr_sub_shm_t *sub_shm, sr_cid_t orig_cid, uint32_t
     sub_shm->orig_cid = orig_cid;
     ATOMIC_STORE_RELAXED(sub_shm->request_id, request_id);
     ATOMIC_STORE_RELAXED(sub_shm->event, event);
+#ifdef SR_EVENT_TRACE
+    if (event) {
+        sr_event_trace_enqueue(&sub_shm->trace);
+    }
+#endif
 
     /* remap if needed */
     if (xpath || data_len) {
-        if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm_data_sub, orig_size +
+        if ((err_info = sr_shmsub_data_resize(sub_shm, shm_data_sub, orig_size +
                 (xpath ? sr_strshmlen(xpath) : 0) + data_len))) {
             return err_info;
         }
@@ -827,6 +839,9 @@ sr_shmsub_notify_write_event(sr_sub_shm_t *sub_shm, sr_cid_t orig_cid, uint32_t
         memcpy(shm_data_ptr, data, data_len);
     }
 
+    if (event) {
+        SR_PROBE(event__write, event_desc, (int)event, request_id, data_len);
+    }
     if (event && event_desc) {
         SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" ID %" PRIu32 " published.", event_desc, sr_ev2str(event), request_id);
     }
@@ -878,10 +893,16 @@ sr_shmsub_multi_notify_write_event(sr_multi_sub_shm_t *multi_sub_shm, sr_cid_t o
     ATOMIC_STORE_RELAXED(multi_sub_shm->event, event);
     ATOMIC_STORE_RELAXED(multi_sub_shm->priority, priority);
     multi_sub_shm->subscriber_count = subscriber_count;
+    ATOMIC_STORE_RELAXED(multi_sub_shm->async_done, 0);
+#ifdef SR_EVENT_TRACE
+    if (event) {
+        sr_event_trace_enqueue(&multi_sub_shm->trace);
+    }
+#endif
 
     /* remap if needed */
     if (data_len) {
-        if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm_data_sub, orig_size + data_len))) {
+        if ((err_info = sr_shmsub_data_resize((sr_sub_shm_t *)multi_sub_shm, shm_data_sub, orig_size + data_len))) {
             return err_info;
         }
 
@@ -901,6 +922,9 @@ sr_shmsub_multi_notify_write_event(sr_multi_sub_shm_t *multi_sub_shm, sr_cid_t o
         shm_data_ptr += data_len;
     }
 
+    if (event) {
+        SR_PROBE(event__write, event_desc, (int)event, request_id, data_len);
+    }
     if (event && event_desc) {
         SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" ID %" PRIu32 " priority %" PRIu32 " for %" PRIu32 " subscribers published.",
                 event_desc, sr_ev2str(event), request_id, priority, subscriber_count);
@@ -908,110 +932,645 @@ sr_shmsub_multi_notify_write_event(sr_multi_sub_shm_t *multi_sub_shm, sr_cid_t o
     return NULL;
 }
 
+/** process-wide ID of the last created shared diff segment, unique together with the connection CID */
+static ATOMIC_T sr_shmsub_diff_id = 0;
+
 /**
- * @brief Whether an event is valid (should be processed) for a change subscription.
+ * @brief Collect distinct XPaths of module change subscriptions that want their diff pruned.
  *
- * @param[in] ev Event.
- * @param[in] sub_opts Subscription options.
- * @return 0 if not, non-zero is it is.
+ * @param[in] mod_info Mod info with the module.
+ * @param[in] ly_mod Module of the subscriptions.
+ * @param[out] xpaths Array of XPaths.
+ * @param[out] xp_count Count of @p xpaths.
+ * @return err_info, NULL on success.
  */
-static int
-sr_shmsub_change_listen_event_is_valid(sr_sub_event_t ev, sr_subscr_options_t sub_opts)
+static sr_error_info_t *
+sr_shmsub_change_notify_diff_xpaths(const struct sr_mod_info_s *mod_info, const struct lys_module *ly_mod,
+        char ***xpaths, uint32_t *xp_count)
 {
     sr_error_info_t *err_info = NULL;
+    struct sr_mod_info_mod_s *mod = NULL;
+    sr_mod_change_sub_t *shm_sub;
+    const char *xpath;
+    uint32_t i, j;
+    void *mem;
 
-    switch (ev) {
-    case SR_SUB_EV_UPDATE:
-        if (!(sub_opts & SR_SUBSCR_UPDATE)) {
-            return 0;
+    *xpaths = NULL;
+    *xp_count = 0;
+
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if (mod_info->mods[i].ly_mod == ly_mod) {
+            mod = &mod_info->mods[i];
+            break;
         }
-        break;
-    case SR_SUB_EV_CHANGE:
-    case SR_SUB_EV_ABORT:
-        if (sub_opts & SR_SUBSCR_DONE_ONLY) {
-            return 0;
+    }
+    if (!mod) {
+        return NULL;
+    }
+
+    /* EXT READ LOCK */
+    if ((err_info = sr_shmext_conn_remap_lock(mod_info->conn, SR_LOCK_READ, 0, __func__))) {
+        return err_info;
+    }
+
+    shm_sub = (sr_mod_change_sub_t *)(mod_info->conn->ext_shm.addr + mod->shm_mod->change_sub[mod_info->ds].subs);
+    for (i = 0; i < mod->shm_mod->change_sub[mod_info->ds].sub_count; ++i) {
+        if (!(shm_sub[i].opts & SR_SUBSCR_FILTER_DIFF) || !shm_sub[i].xpath) {
+            continue;
         }
-        break;
-    case SR_SUB_EV_DONE:
-        break;
-    default:
-        /* just print it */
-        SR_ERRINFO_INT(&err_info);
-        sr_errinfo_free(&err_info);
-        return 0;
+        xpath = mod_info->conn->ext_shm.addr + shm_sub[i].xpath;
+
+        /* subscriptions with the same XPath share the pruned diff */
+        for (j = 0; j < *xp_count; ++j) {
+            if (!strcmp((*xpaths)[j], xpath)) {
+                break;
+            }
+        }
+        if (j < *xp_count) {
+            continue;
+        }
+
+        mem = realloc(*xpaths, (*xp_count + 1) * sizeof **xpaths);
+        SR_CHECK_MEM_GOTO(!mem, err_info, cleanup_unlock);
+        *xpaths = mem;
+        (*xpaths)[*xp_count] = strdup(xpath);
+        SR_CHECK_MEM_GOTO(!(*xpaths)[*xp_count], err_info, cleanup_unlock);
+        ++(*xp_count);
     }
 
-    return 1;
+cleanup_unlock:
+    /* EXT READ UNLOCK */
+    sr_shmext_conn_remap_unlock(mod_info->conn, SR_LOCK_READ, 0, __func__);
+
+    if (err_info) {
+        for (j = 0; j < *xp_count; ++j) {
+            free((*xpaths)[j]);
+        }
+        free(*xpaths);
+        *xpaths = NULL;
+        *xp_count = 0;
+    }
+    return err_info;
 }
 
 /**
- * @brief Check whether there is a change (some diff) for the subscription based on the used XPath filter.
+ * @brief Prune a module diff to only the changes selected by an XPath and their parents.
  *
- * @param[in] xpath Used XPath filter.
- * @param[in] diff Full diff for the module.
- * @return 0 if not, non-zero if there is.
+ * @param[in] mod_diff Module diff.
+ * @param[in] xpath XPath selecting the changes.
+ * @param[out] pruned Pruned diff, may be NULL if no changes are selected.
+ * @return err_info, NULL on success.
  */
-static int
-sr_shmsub_change_filter_is_valid(const char *xpath, const struct lyd_node *diff)
+static sr_error_info_t *
+sr_shmsub_change_notify_diff_prune(const struct lyd_node *mod_diff, const char *xpath, struct lyd_node **pruned)
 {
     sr_error_info_t *err_info = NULL;
-    struct ly_set *set;
-    const struct lyd_node *elem;
+    struct ly_set *set = NULL;
+    struct lyd_node *dup, *parent;
+    const struct lyd_node *orig;
+    struct lyd_meta *meta;
     uint32_t i;
-    enum edit_op op;
-    int ret = 0;
 
-    if (!xpath) {
-        return 1;
-    }
+    *pruned = NULL;
 
-    /* must succeed */
-    if ((err_info = sr_lyd_find_xpath(diff, xpath, &set))) {
-        sr_errinfo_free(&err_info);
-        return 0;
+    if ((err_info = sr_lyd_find_xpath(mod_diff, xpath, &set))) {
+        goto cleanup;
     }
 
     for (i = 0; i < set->count; ++i) {
-        LYD_TREE_DFS_BEGIN(set->dnodes[i], elem) {
-            op = sr_edit_diff_find_oper(elem, 1, NULL);
-            assert(op);
-            if (op != EDIT_NONE) {
-                ret = 1;
-                break;
+        /* duplicate the subtree with its parents and their operations */
+        if ((err_info = sr_lyd_dup(set->dnodes[i], NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_PARENTS | LYD_DUP_WITH_FLAGS,
+                0, &dup))) {
+            goto cleanup;
+        }
+
+        /* parents are duplicated without metadata, copy their operations so the diff stays valid */
+        for (parent = lyd_parent(dup), orig = lyd_parent(set->dnodes[i]); parent;
+                dup = parent, parent = lyd_parent(parent), orig = lyd_parent(orig)) {
+            LY_LIST_FOR(orig->meta, meta) {
+                if ((err_info = sr_lyd_new_meta(parent, meta->annotation->module, meta->name,
+                        lyd_get_meta_value(meta)))) {
+                    lyd_free_all(parent);
+                    goto cleanup;
+                }
             }
-            LYD_TREE_DFS_END(set->dnodes[i], elem);
         }
-        if (ret) {
-            break;
+
+        /* merge into the pruned diff, overlapping subtrees are merged as well */
+        if ((err_info = sr_lyd_merge(pruned, dup, 0, LYD_MERGE_DESTRUCT))) {
+            lyd_free_all(dup);
+            goto cleanup;
         }
     }
-    ly_set_free(set, NULL);
 
-    return ret;
+cleanup:
+    ly_set_free(set, NULL);
+    if (err_info) {
+        lyd_free_all(*pruned);
+        *pruned = NULL;
+    }
+    return err_info;
 }
 
 /**
- * @brief Learn whether there is a subscription for a change event.
+ * @brief Create a shared diff segment for change events, it is written once and referenced by all the subscribers.
  *
- * @param[in] conn Connection to use.
- * @param[in] mod Mod info module to use.
- * @param[in] ds Datastore.
- * @param[in] diff Event diff.
- * @param[in] ev Event.
- * @param[out] max_priority_p Highest priority among the valid subscribers.
- * @return 0 if not, non-zero if there is.
+ * The diff of every module is printed separately so that the subscribers can parse only the one they need.
+ * Additionally, the diff is pruned for every distinct XPath of the subscriptions with ::SR_SUBSCR_FILTER_DIFF.
+ *
+ * @param[in] mod_info Mod info with the modules and subscriptions.
+ * @param[in,out] diff Diff to write, the top-level siblings of its modules may be reordered.
+ * @param[in] print_opts LYB print options.
+ * @param[out] diff_ref Reference to the created segment.
+ * @return err_info, NULL on success.
  */
-static int
-sr_shmsub_change_notify_has_subscription(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
-        const struct lyd_node *diff, sr_sub_event_t ev, uint32_t *max_priority_p)
+static sr_error_info_t *
+sr_shmsub_change_notify_diff_create(const struct sr_mod_info_s *mod_info, struct lyd_node **diff, uint32_t print_opts,
+        sr_sub_diff_ref_t *diff_ref)
 {
     sr_error_info_t *err_info = NULL;
-    int has_sub = 0;
-    uint32_t i;
-    sr_mod_change_sub_t *shm_sub;
+    struct sr_shmsub_diff_mod_s {
+        const char *name;
+        char *xpath;
+        struct lyd_node *diff;
+        char *lyb;
+        uint32_t lyb_len;
+    } *mods = NULL, *m;
+    const struct lys_module *ly_mod;
+    struct lyd_node *mod_diff, *pruned;
+    sr_sub_diff_shm_t *diff_shm;
+    sr_sub_diff_mod_t *shm_mods;
+    sr_shm_t shm = SR_SHM_INITIALIZER;
+    uint32_t i, mod_count = 0, xp_count = 0;
+    size_t shm_size;
+    char *path = NULL, *shm_ptr, **xpaths = NULL;
+    void *mem;
 
-    /* EXT READ LOCK */
-    if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_READ, 0, __func__))) {
+    diff_ref->cid = mod_info->conn->cid;
+    diff_ref->diff_id = 0;
+
+    /* split the diff into module diffs and print them */
+    shm_size = SR_SHM_SIZE(sizeof *diff_shm);
+    while (*diff) {
+        mem = realloc(mods, (mod_count + 1) * sizeof *mods);
+        SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+        mods = mem;
+        m = &mods[mod_count];
+        memset(m, 0, sizeof *m);
+        ++mod_count;
+
+        ly_mod = lyd_owner_module(*diff);
+        if (ly_mod) {
+            m->name = ly_mod->name;
+            m->diff = sr_module_data_unlink(diff, ly_mod);
+        } else {
+            /* unknown opaque node, only ever parsed with all the other modules */
+            m->name = "";
+            m->diff = *diff;
+            *diff = (*diff)->next;
+            lyd_unlink_tree(m->diff);
+        }
+
+        if ((err_info = sr_lyd_print_data(m->diff, LYD_LYB, print_opts, -1, &m->lyb, &m->lyb_len))) {
+            goto cleanup;
+        }
+        shm_size += SR_SHM_SIZE(sizeof *shm_mods) + sr_strshmlen(m->name) + SR_SHM_SIZE(m->lyb_len);
+
+        if (!ly_mod) {
+            continue;
+        }
+
+        /* add the pruned diffs of this module */
+        if ((err_info = sr_shmsub_change_notify_diff_xpaths(mod_info, ly_mod, &xpaths, &xp_count))) {
+            goto cleanup;
+        }
+        mod_diff = m->diff;
+        for (i = 0; i < xp_count; ++i) {
+            mem = realloc(mods, (mod_count + 1) * sizeof *mods);
+            SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+            mods = mem;
+            m = &mods[mod_count];
+            memset(m, 0, sizeof *m);
+            ++mod_count;
+
+            m->name = ly_mod->name;
+            m->xpath = xpaths[i];
+            xpaths[i] = NULL;
+
+            if ((err_info = sr_shmsub_change_notify_diff_prune(mod_diff, m->xpath, &pruned))) {
+                goto cleanup;
+            }
+            err_info = sr_lyd_print_data(pruned, LYD_LYB, print_opts, -1, &m->lyb, &m->lyb_len);
+            lyd_free_all(pruned);
+            if (err_info) {
+                goto cleanup;
+            }
+            shm_size += SR_SHM_SIZE(sizeof *shm_mods) + sr_strshmlen(m->name) + sr_strshmlen(m->xpath) +
+                    SR_SHM_SIZE(m->lyb_len);
+        }
+        free(xpaths);
+        xpaths = NULL;
+        xp_count = 0;
+    }
+
+    /* create the segment */
+    do {
+        diff_ref->diff_id = ATOMIC_INC_RELAXED(sr_shmsub_diff_id) + 1;
+    } while (!diff_ref->diff_id);
+    if ((err_info = sr_path_sub_diff_shm(diff_ref->cid, diff_ref->diff_id, &path))) {
+        goto cleanup;
+    }
+    shm.fd = sr_open(path, O_RDWR | O_CREAT | O_EXCL, SR_SUB_SHM_PERM);
+    if (shm.fd == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to create \"%s\" SHM (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+    if ((err_info = sr_shm_remap(&shm, shm_size))) {
+        goto cleanup;
+    }
+
+    /* write the header, module diff records, and then all the names, XPaths, and diffs */
+    diff_shm = (sr_sub_diff_shm_t *)shm.addr;
+    diff_shm->mod_count = mod_count;
+    shm_ptr = shm.addr + SR_SHM_SIZE(sizeof *diff_shm) + mod_count * SR_SHM_SIZE(sizeof *shm_mods);
+    for (i = 0; i < mod_count; ++i) {
+        shm_mods = (sr_sub_diff_mod_t *)(shm.addr + SR_SHM_SIZE(sizeof *diff_shm) + i * SR_SHM_SIZE(sizeof *shm_mods));
+
+        strcpy(shm_ptr, mods[i].name);
+        shm_mods->name = shm_ptr - shm.addr;
+        shm_ptr += sr_strshmlen(mods[i].name);
+
+        if (mods[i].xpath) {
+            strcpy(shm_ptr, mods[i].xpath);
+            shm_mods->xpath = shm_ptr - shm.addr;
+            shm_ptr += sr_strshmlen(mods[i].xpath);
+        } else {
+            shm_mods->xpath = 0;
+        }
+
+        memcpy(shm_ptr, mods[i].lyb, mods[i].lyb_len);
+        shm_mods->diff = shm_ptr - shm.addr;
+        shm_mods->diff_len = mods[i].lyb_len;
+        shm_ptr += SR_SHM_SIZE(mods[i].lyb_len);
+    }
+
+cleanup:
+    /* restore the diff */
+    for (i = 0; i < mod_count; ++i) {
+        if (mods[i].diff) {
+            lyd_insert_sibling(*diff, mods[i].diff, diff);
+        }
+        free(mods[i].xpath);
+        free(mods[i].lyb);
+    }
+    free(mods);
+    for (i = 0; i < xp_count; ++i) {
+        free(xpaths[i]);
+    }
+    free(xpaths);
+
+    if (err_info) {
+        if (shm.fd > -1) {
+            unlink(path);
+        }
+        diff_ref->diff_id = 0;
+    }
+    sr_shm_clear(&shm);
+    free(path);
+    return err_info;
+}
+
+void
+sr_shmsub_change_notify_diff_remove(sr_cid_t cid, uint32_t *diff_id)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    if (!*diff_id) {
+        return;
+    }
+
+    if ((err_info = sr_path_sub_diff_shm(cid, *diff_id, &path))) {
+        goto cleanup;
+    }
+    if (unlink(path) == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to unlink \"%s\" SHM (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    *diff_id = 0;
+    free(path);
+    sr_errinfo_free(&err_info);
+}
+
+/**
+ * @brief Open and map the header of a shared diff segment for writing its asynchronous references.
+ *
+ * @param[in] diff_ref Reference to the segment.
+ * @param[out] shm Mapped segment header.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_change_diff_async_open(const sr_sub_diff_ref_t *diff_ref, sr_shm_t *shm)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    assert(shm->fd == -1);
+
+    if ((err_info = sr_path_sub_diff_shm(diff_ref->cid, diff_ref->diff_id, &path))) {
+        goto cleanup;
+    }
+
+    shm->fd = sr_open(path, O_RDWR, SR_SUB_SHM_PERM);
+    if (shm->fd == -1) {
+        SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
+        goto cleanup;
+    }
+    shm->size = SR_SHM_SIZE(sizeof(sr_sub_diff_shm_t));
+    shm->addr = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (shm->addr == MAP_FAILED) {
+        shm->addr = NULL;
+        sr_errinfo_new(&err_info, SR_ERR_NO_MEMORY, "Failed to map shared memory (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    free(path);
+    if (err_info) {
+        sr_shm_clear(shm);
+    }
+    return err_info;
+}
+
+/**
+ * @brief Release an asynchronous reference of a shared diff segment, the last one removes the segment.
+ *
+ * @param[in] diff_ref Reference to the segment.
+ * @param[in] shm Mapped segment header, opened if not.
+ */
+static void
+sr_shmsub_change_diff_async_unref(const sr_sub_diff_ref_t *diff_ref, sr_shm_t *shm)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t diff_id;
+
+    if ((shm->fd == -1) && (err_info = sr_shmsub_change_diff_async_open(diff_ref, shm))) {
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
+    if (ATOMIC_DEC_RELAXED(((sr_sub_diff_shm_t *)shm->addr)->async_refs) == 1) {
+        /* last reference */
+        diff_id = diff_ref->diff_id;
+        sr_shmsub_change_notify_diff_remove(diff_ref->cid, &diff_id);
+    }
+    sr_shm_clear(shm);
+}
+
+/**
+ * @brief Recover an asynchronous "done" event its subscribers have not processed in time, they may have crashed
+ * or never process events. The originator is alive but does not wait for the event.
+ * WRITE lock on the SHM must be held!
+ *
+ * @param[in] multi_sub_shm Change subscription SHM to recover.
+ * @param[in] shm_name Subscription SHM name.
+ */
+static void
+sr_shmsub_change_recover_async_done(sr_multi_sub_shm_t *multi_sub_shm, const char *shm_name)
+{
+    sr_sub_diff_ref_t diff_ref;
+    sr_shm_t shm_diff = SR_SHM_INITIALIZER;
+
+    if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) != SR_SUB_EV_DONE) ||
+            !ATOMIC_LOAD_RELAXED(multi_sub_shm->async_done)) {
+        return;
+    }
+
+    SR_LOG_WRN("EV ORIGIN: \"%s\" asynchronous \"%s\" event ID %" PRIu32 " not processed by %" PRIu32
+            " subscribers recovered.", shm_name, sr_ev2str(SR_SUB_EV_DONE),
+            (uint32_t)ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id), multi_sub_shm->subscriber_count);
+
+    /* clear the event */
+    diff_ref = multi_sub_shm->async_diff;
+    ATOMIC_STORE_RELAXED(multi_sub_shm->async_done, 0);
+    multi_sub_shm->orig_cid = 0;
+    multi_sub_shm->subscriber_count = 0;
+    ATOMIC_STORE_RELAXED(multi_sub_shm->event, SR_SUB_EV_NONE);
+
+    /* release the diff segment reference the subscribers would have */
+    sr_shmsub_change_diff_async_unref(&diff_ref, &shm_diff);
+}
+
+/**
+ * @brief Wait for and keep WRITE lock on a subscription when a new event is to be written.
+ *
+ * @param[in] sub_shm Subscription SHM to lock.
+ * @param[in] shm_name Subscription SHM name.
+ * @param[in] lock_event Which leftover event is OK to lock the SHM with, if any.
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notify_new_wrlock(sr_sub_shm_t *sub_shm, const char *shm_name, sr_sub_event_t lock_event, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+    sr_sub_event_t last_event;
+    uint32_t last_request_id;
+    int ret;
+
+    /* it is only possible to lock with none or error */
+    assert(!lock_event || (SR_SUB_EV_ERROR == lock_event));
+
+    /* WRITE LOCK */
+    if ((err_info = sr_rwlock(&sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__, NULL,
+            NULL))) {
+        return err_info;
+    }
+
+    if (ATOMIC_LOAD_RELAXED(sub_shm->event) && (ATOMIC_LOAD_RELAXED(sub_shm->event) != lock_event)) {
+        /* instead of waiting, try to recover the event immediately */
+        sr_shmsub_recover(sub_shm);
+    }
+
+    assert(sub_shm->lock.writer == conn->cid);
+    /* FAKE WRITE UNLOCK */
+    sub_shm->lock.writer = 0;
+
+    /* wait until there is no event and there are no readers (just like write lock) */
+    sr_timeouttime_get(&timeout_abs, SR_SUBSHM_LOCK_TIMEOUT);
+    ret = 0;
+    while (!ret && (sr_rwlock_has_readers(&sub_shm->lock) || (ATOMIC_LOAD_RELAXED(sub_shm->event) &&
+            (ATOMIC_LOAD_RELAXED(sub_shm->event) != lock_event)))) {
+        /* COND WAIT */
+        ret = sr_shmsub_cond_wait(sub_shm, conn, &timeout_abs);
+    }
+
+    if (!sr_rwlock_has_readers(&sub_shm->lock)) {
+        /* FAKE WRITE LOCK */
+        assert(!sub_shm->lock.writer);
+        sub_shm->lock.writer = conn->cid;
+
+        if (ret == ETIMEDOUT) {
+            /* try to recover the event again in case the originator crashed later */
+            sr_shmsub_recover(sub_shm);
+
+            /* only change subscriptions have "done" events, an asynchronous one is not waited for by its originator */
+            if (ATOMIC_LOAD_RELAXED(sub_shm->event) == SR_SUB_EV_DONE) {
+                sr_shmsub_change_recover_async_done((sr_multi_sub_shm_t *)sub_shm, shm_name);
+            }
+            if (!ATOMIC_LOAD_RELAXED(sub_shm->event)) {
+                /* recovered */
+                ret = 0;
+            }
+        }
+    }
+
+    last_event = ATOMIC_LOAD_RELAXED(sub_shm->event);
+    last_request_id = ATOMIC_LOAD_RELAXED(sub_shm->request_id);
+
+    if (ret) {
+        if ((ret == ETIMEDOUT) && (!sr_rwlock_has_readers(&sub_shm->lock)) &&
+                (!last_event || (last_event == lock_event))) {
+            /* even though the timeout has elapsed, the event was handled so continue normally */
+            /* ensure that there are no readers left, otherwise we don't have the write lock */
+            goto event_handled;
+        } else if ((ret == ETIMEDOUT) && (last_event && (last_event != lock_event))) {
+            /* timeout */
+            sr_errinfo_new(&err_info, SR_ERR_TIME_OUT,
+                    "Waiting for subscription of \"%s\" failed, previous event \"%s\" ID %" PRIu32 " was not processed.",
+                    shm_name, sr_ev2str(last_event), last_request_id);
+        } else {
+            /* other error */
+            SR_ERRINFO_COND(&err_info, __func__, ret);
+        }
+
+        if (!sr_rwlock_has_readers(&sub_shm->lock)) {
+            /* WRITE UNLOCK */
+            sr_rwunlock(&sub_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+        } else {
+            /* we only hold the mutex */
+            sr_munlock(&sub_shm->lock.mutex);
+        }
+        return err_info;
+    }
+
+event_handled:
+    /* we have write lock and the expected event, remove any left over orig_cid */
+    if (sub_shm->orig_cid) {
+        SR_LOG_WRN("Recovered \"%s\" previous event \"%s\" ID %" PRIu32 " abandoned by CID %" PRIu32,
+                shm_name, sr_ev2str(last_event), last_request_id, sub_shm->orig_cid);
+        sub_shm->orig_cid = 0;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Whether an event is valid (should be processed) for a change subscription.
+ *
+ * @param[in] ev Event.
+ * @param[in] sub_opts Subscription options.
+ * @return 0 if not, non-zero is it is.
+ */
+static int
+sr_shmsub_change_listen_event_is_valid(sr_sub_event_t ev, sr_subscr_options_t sub_opts)
+{
+    sr_error_info_t *err_info = NULL;
+
+    switch (ev) {
+    case SR_SUB_EV_UPDATE:
+        if (!(sub_opts & SR_SUBSCR_UPDATE)) {
+            return 0;
+        }
+        break;
+    case SR_SUB_EV_CHANGE:
+    case SR_SUB_EV_ABORT:
+        if (sub_opts & SR_SUBSCR_DONE_ONLY) {
+            return 0;
+        }
+        break;
+    case SR_SUB_EV_DONE:
+        break;
+    default:
+        /* just print it */
+        SR_ERRINFO_INT(&err_info);
+        sr_errinfo_free(&err_info);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether there is a change (some diff) for the subscription based on the used XPath filter.
+ *
+ * @param[in] xpath Used XPath filter.
+ * @param[in] diff Full diff for the module.
+ * @return 0 if not, non-zero if there is.
+ */
+static int
+sr_shmsub_change_filter_is_valid(const char *xpath, const struct lyd_node *diff)
+{
+    sr_error_info_t *err_info = NULL;
+    struct ly_set *set;
+    const struct lyd_node *elem;
+    uint32_t i;
+    enum edit_op op;
+    int ret = 0;
+
+    if (!xpath) {
+        return 1;
+    }
+
+    /* must succeed */
+    if ((err_info = sr_lyd_find_xpath(diff, xpath, &set))) {
+        sr_errinfo_free(&err_info);
+        return 0;
+    }
+
+    for (i = 0; i < set->count; ++i) {
+        LYD_TREE_DFS_BEGIN(set->dnodes[i], elem) {
+            op = sr_edit_diff_find_oper(elem, 1, NULL);
+            assert(op);
+            if (op != EDIT_NONE) {
+                ret = 1;
+                break;
+            }
+            LYD_TREE_DFS_END(set->dnodes[i], elem);
+        }
+        if (ret) {
+            break;
+        }
+    }
+    ly_set_free(set, NULL);
+
+    return ret;
+}
+
+/**
+ * @brief Learn whether there is a subscription for a change event.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mod Mod info module to use.
+ * @param[in] ds Datastore.
+ * @param[in] diff Event diff.
+ * @param[in] ev Event.
+ * @param[out] max_priority_p Highest priority among the valid subscribers.
+ * @return 0 if not, non-zero if there is.
+ */
+static int
+sr_shmsub_change_notify_has_subscription(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
+        const struct lyd_node *diff, sr_sub_event_t ev, uint32_t *max_priority_p)
+{
+    sr_error_info_t *err_info = NULL;
+    int has_sub = 0;
+    uint32_t i;
+    sr_mod_change_sub_t *shm_sub;
+
+    /* EXT READ LOCK */
+    if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_READ, 0, __func__))) {
         sr_errinfo_free(&err_info);
         return 0;
     }
@@ -1149,43 +1708,136 @@ sr_shmsub_change_notify_next_subscription(sr_conn_ctx_t *conn, struct sr_mod_inf
     return NULL;
 }
 
-sr_error_info_t *
-sr_shmsub_notify_evpipe(uint32_t evpipe_num)
+/**
+ * @brief Write into a subscriber event pipe to notify it there is a new event. Needs the evpipe cache lock.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] evpipe_num Subscriber event pipe number.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notify_evpipe_locked(sr_conn_ctx_t *conn, uint32_t evpipe_num)
 {
     sr_error_info_t *err_info = NULL;
+    struct sr_evpipe_cache_s *entry = NULL;
     char *path = NULL, buf[1] = {0};
     int fd = -1, ret;
+    uint32_t i;
 
-    /* get path to the pipe */
-    if ((err_info = sr_path_evpipe(evpipe_num, &path))) {
-        goto cleanup;
+    for (i = 0; i < SR_EVPIPE_CACHE_SIZE; ++i) {
+        if ((conn->evpipe_cache[i].fd > -1) && (conn->evpipe_cache[i].evpipe_num == evpipe_num)) {
+            entry = &conn->evpipe_cache[i];
+            fd = entry->fd;
+            break;
+        }
     }
 
-    /* open pipe for writing */
-    if ((fd = sr_open(path, O_WRONLY | O_NONBLOCK, 0)) == -1) {
-        sr_errinfo_new(&err_info, SR_ERR_SYS, "Opening \"%s\" for writing failed (%s).", path, strerror(errno));
-        goto cleanup;
+    if (!entry) {
+        /* get path to the pipe */
+        if ((err_info = sr_path_evpipe(evpipe_num, &path))) {
+            goto cleanup;
+        }
+
+        /* open pipe for reading and writing so that the write never fails with EPIPE (and SIGPIPE) even if
+         * the subscriber closes it, possible only with sufficient permissions */
+        if ((fd = sr_open(path, O_RDWR | O_NONBLOCK, 0)) > -1) {
+            /* cache it, replace the oldest entry */
+            entry = &conn->evpipe_cache[conn->evpipe_cache_next];
+            conn->evpipe_cache_next = (conn->evpipe_cache_next + 1) % SR_EVPIPE_CACHE_SIZE;
+            if (entry->fd > -1) {
+                close(entry->fd);
+            }
+            entry->evpipe_num = evpipe_num;
+            entry->fd = fd;
+        } else if ((errno != EACCES) || ((fd = sr_open(path, O_WRONLY | O_NONBLOCK, 0)) == -1)) {
+            /* open pipe only for writing */
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Opening \"%s\" for writing failed (%s).", path, strerror(errno));
+            goto cleanup;
+        }
     }
 
     /* write one arbitrary byte */
     do {
         ret = write(fd, buf, 1);
-    } while (!ret);
-    if (ret == -1) {
+    } while (!ret || ((ret == -1) && (errno == EINTR)));
+    if ((ret == -1) && (errno != EAGAIN)) {
         SR_ERRINFO_SYSERRNO(&err_info, "write");
         goto cleanup;
     }
-
-    /* success */
+    /* if the pipe is full, the subscriber has not read the previous wakeups yet and this one is not needed */
 
 cleanup:
-    if (fd > -1) {
+    if (err_info && entry) {
+        /* reopen on the next notification */
+        entry->fd = -1;
+    }
+    if ((fd > -1) && (!entry || err_info)) {
         close(fd);
     }
+
     free(path);
     return err_info;
 }
 
+sr_error_info_t *
+sr_shmsub_notify_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* EVPIPE CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->evpipe_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    err_info = sr_shmsub_notify_evpipe_locked(conn, evpipe_num);
+
+    /* EVPIPE CACHE UNLOCK */
+    sr_munlock(&conn->evpipe_cache_lock);
+
+    return err_info;
+}
+
+/**
+ * @brief Write into subscriber event pipes to notify them there is a new event, each pipe only once.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] evpipes Subscriber event pipe numbers, may include duplicates.
+ * @param[in] evpipe_count Count of @p evpipes.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notify_evpipes(sr_conn_ctx_t *conn, const uint32_t *evpipes, uint32_t evpipe_count)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i, j;
+
+    if (!evpipe_count) {
+        return NULL;
+    }
+
+    /* EVPIPE CACHE LOCK */
+    if ((err_info = sr_mlock(&conn->evpipe_cache_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    for (i = 0; i < evpipe_count; ++i) {
+        /* subscriptions sharing one subscription structure share its event pipe, one wakeup is enough */
+        for (j = 0; (j < i) && (evpipes[j] != evpipes[i]); ++j) {}
+        if (j < i) {
+            continue;
+        }
+
+        if ((err_info = sr_shmsub_notify_evpipe_locked(conn, evpipes[i]))) {
+            break;
+        }
+    }
+
+    /* EVPIPE CACHE UNLOCK */
+    sr_munlock(&conn->evpipe_cache_lock);
+
+    return err_info;
+}
+
 /**
  * @brief Write into change subscribers event pipe to notify them there is a new event.
  *
@@ -1203,7 +1855,7 @@ sr_shmsub_change_notify_evpipe(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mo
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_change_sub_t *shm_sub;
-    uint32_t i;
+    uint32_t i, *evpipes = NULL, evpipe_count = 0;
 
     /* EXT READ LOCK */
     if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_READ, 0, __func__))) {
@@ -1229,16 +1881,20 @@ sr_shmsub_change_notify_evpipe(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mo
 
         /* valid subscription */
         if (shm_sub[i].priority == priority) {
-            if ((err_info = sr_shmsub_notify_evpipe(shm_sub[i].evpipe_num))) {
-                goto cleanup;
-            }
+            evpipes = sr_realloc(evpipes, (evpipe_count + 1) * sizeof *evpipes);
+            SR_CHECK_MEM_GOTO(!evpipes, err_info, cleanup);
+            evpipes[evpipe_count++] = shm_sub[i].evpipe_num;
         }
     }
 
+    /* notify the subscribers */
+    err_info = sr_shmsub_notify_evpipes(conn, evpipes, evpipe_count);
+
 cleanup:
     /* EXT READ UNLOCK */
     sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
 
+    free(evpipes);
     return err_info;
 }
 
@@ -1282,8 +1938,8 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, const char *orig_
     sr_multi_sub_shm_t *multi_sub_shm;
     struct sr_mod_info_mod_s *mod = NULL;
     struct lyd_node *edit;
-    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL;
-    char *diff_lyb = NULL;
+    uint32_t cur_priority, subscriber_count, *aux = NULL;
+    sr_sub_diff_ref_t diff_ref = {0};
     struct ly_ctx *ly_ctx;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER, shm_data_sub = SR_SHM_INITIALIZER;
     sr_cid_t cid;
@@ -1317,10 +1973,9 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, const char *orig_
             continue;
         }
 
-        /* prepare diff to write into SHM */
-        if (!diff_lyb && (err_info = sr_lyd_print_data(mod_info->diff, LYD_LYB, LYD_PRINT_SHRINK, -1, &diff_lyb,
-                &diff_lyb_len))) {
-            SR_ERRINFO_INT(&err_info);
+        /* prepare the shared diff segment referenced from SHM */
+        if (!diff_ref.diff_id && (err_info = sr_shmsub_change_notify_diff_create(mod_info, &mod_info->diff,
+                LYD_PRINT_SHRINK, &diff_ref))) {
             goto cleanup;
         }
 
@@ -1331,7 +1986,8 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, const char *orig_
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
         /* SUB WRITE LOCK */
-        if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, mod->ly_mod->name, 0, cid))) {
+        if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, mod->ly_mod->name, 0,
+                mod_info->conn))) {
             goto cleanup;
         }
 
@@ -1349,8 +2005,8 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, const char *orig_
                 mod->request_id = ++multi_sub_shm->request_id;
             }
             if ((err_info = sr_shmsub_multi_notify_write_event(multi_sub_shm, cid, mod->request_id, cur_priority,
-                    SR_SUB_EV_UPDATE, orig_name, orig_data, subscriber_count, &shm_data_sub, diff_lyb, diff_lyb_len,
-                    mod->ly_mod->name))) {
+                    SR_SUB_EV_UPDATE, orig_name, orig_data, subscriber_count, &shm_data_sub, (char *)&diff_ref,
+                    sizeof diff_ref, mod->ly_mod->name))) {
                 goto cleanup_wrunlock;
             }
 
@@ -1361,7 +2017,7 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, const char *orig_
             }
 
             /* wait until the event is processed */
-            if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_ERROR, 0, cid,
+            if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_ERROR, 0, mod_info->conn,
                     &shm_data_sub, timeout_ms, &lock_lost, cb_err_info))) {
                 if (lock_lost) {
                     goto cleanup;
@@ -1423,7 +2079,7 @@ cleanup_wrunlock:
 
 cleanup:
     free(aux);
-    free(diff_lyb);
+    sr_shmsub_change_notify_diff_remove(cid, &diff_ref.diff_id);
     sr_shm_clear(&shm_sub);
     sr_shm_clear(&shm_data_sub);
     if (err_info || *cb_err_info) {
@@ -1496,17 +2152,27 @@ cleanup:
  * @brief Set module priority of all notify_subs modules. Priorities are consolidated to always have
  * a difference of 1 with the lowest priority being 0.
  *
+ * @param[in] conn Connection to use.
  * @param[in] nsubs Array of notify_subs.
  * @param[in] ncount Count of @p nsubs.
  * @param[in] ds Datastore.
  * @param[out] max_mpriority Maxmimum module priority assigned.
  */
 static void
-sr_shmsub_change_notify_nsubs_set_mod_prio(struct sr_shmsub_many_info_change_s *nsubs, uint32_t ncount,
-        sr_datastore_t ds, uint32_t *max_mpriority)
+sr_shmsub_change_notify_nsubs_set_mod_prio(sr_conn_ctx_t *conn, struct sr_shmsub_many_info_change_s *nsubs,
+        uint32_t ncount, sr_datastore_t ds, uint32_t *max_mpriority)
 {
     uint32_t i, cur_mprio = 0, min_mprio, nsubs_left = ncount;
 
+    if (conn->opts & SR_CONN_CHANGE_NOTIFY_PARALLEL) {
+        /* all the modules notified simultaneously, they all keep priority 0 */
+        for (i = 0; i < ncount; ++i) {
+            nsubs[i].mod_priority = 0;
+        }
+        *max_mpriority = 0;
+        return;
+    }
+
     for (i = 0; i < ncount; ++i) {
         /* assign all module priorities */
         nsubs[i].mod_priority = nsubs[i].mod->shm_mod->data_lock_info[ds].prio;
@@ -1543,10 +2209,10 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, const char *orig_
         uint32_t timeout_ms, sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t notify_count = 0, max_priority, cur_mpriority, diff_lyb_len, *aux = NULL, i, subscriber_count;
+    uint32_t notify_count = 0, max_priority, cur_mpriority, *aux = NULL, i, subscriber_count;
     struct sr_shmsub_many_info_change_s *notify_subs = NULL, *nsub;
     struct sr_mod_info_mod_s *mod = NULL;
-    char *diff_lyb = NULL;
+    sr_sub_diff_ref_t diff_ref;
     int opts, pending_events;
     sr_cid_t cid;
 
@@ -1589,12 +2255,15 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, const char *orig_
     }
 
     /* assign consolidated module priorities */
-    sr_shmsub_change_notify_nsubs_set_mod_prio(notify_subs, notify_count, mod_info->ds, &cur_mpriority);
+    sr_shmsub_change_notify_nsubs_set_mod_prio(mod_info->conn, notify_subs, notify_count, mod_info->ds,
+            &cur_mpriority);
 
-    /* prepare the diff to write into subscription SHM */
-    if ((err_info = sr_lyd_print_data(mod_info->diff, LYD_LYB, 0, -1, &diff_lyb, &diff_lyb_len))) {
+    /* prepare the shared diff segment referenced from subscription SHM, kept for the "done" event */
+    sr_shmsub_change_notify_diff_remove(cid, &mod_info->diff_id);
+    if ((err_info = sr_shmsub_change_notify_diff_create(mod_info, &mod_info->diff, 0, &diff_ref))) {
         goto cleanup;
     }
+    mod_info->diff_id = diff_ref.diff_id;
 
     do {
         pending_events = 0;
@@ -1625,7 +2294,7 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, const char *orig_
             nsub->sub_shm = (sr_sub_shm_t *)nsub->shm_sub.addr;
 
             /* SUB WRITE LOCK */
-            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, cid))) {
+            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, mod_info->conn))) {
                 goto cleanup;
             }
             nsub->lock = SR_LOCK_WRITE;
@@ -1642,7 +2311,7 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, const char *orig_
             }
             if ((err_info = sr_shmsub_multi_notify_write_event((sr_multi_sub_shm_t *)nsub->shm_sub.addr, cid,
                     nsub->mod->request_id, nsub->cur_priority, SR_SUB_EV_CHANGE, orig_name, orig_data, subscriber_count,
-                    &nsub->shm_data_sub, diff_lyb, diff_lyb_len, nsub->mod->ly_mod->name))) {
+                    &nsub->shm_data_sub, (char *)&diff_ref, sizeof diff_ref, nsub->mod->ly_mod->name))) {
                 goto cleanup;
             }
 
@@ -1664,7 +2333,7 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, const char *orig_
 
         /* wait until the events are processed */
         if ((err_info = sr_shmsub_notify_many_wait_wr((struct sr_shmsub_many_info_s *)notify_subs, sizeof *notify_subs,
-                notify_count, SR_SUB_EV_SUCCESS, 0, cid, timeout_ms))) {
+                notify_count, SR_SUB_EV_SUCCESS, 0, mod_info->conn, timeout_ms))) {
             goto cleanup;
         }
 
@@ -1711,21 +2380,67 @@ cleanup:
     }
 
     free(aux);
-    free(diff_lyb);
     free(notify_subs);
     return err_info;
 }
 
+/**
+ * @brief Learn whether the current round of "done" events is the last one so it does not have to be waited for.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] notify_subs Notify subs with the pending events set.
+ * @param[in] notify_count Count of @p notify_subs.
+ * @param[in] cur_mpriority Current module priority.
+ * @param[out] last Set if there are no other subscribers to be notified after this round.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_change_notify_done_is_last(struct sr_mod_info_s *mod_info, struct sr_shmsub_many_info_change_s *notify_subs,
+        uint32_t notify_count, uint32_t cur_mpriority, int *last)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_shmsub_many_info_change_s *nsub;
+    uint32_t i, next_priority, subscriber_count;
+    int opts;
+
+    *last = 0;
+
+    if (cur_mpriority) {
+        /* modules with a lower priority are notified next */
+        return NULL;
+    }
+
+    for (i = 0; i < notify_count; ++i) {
+        nsub = &notify_subs[i];
+        if (!nsub->pending_event) {
+            continue;
+        }
+
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, nsub->mod, mod_info->ds,
+                mod_info->diff, SR_SUB_EV_DONE, nsub->cur_priority, &next_priority, &subscriber_count, &opts))) {
+            return err_info;
+        }
+        if (subscriber_count) {
+            /* subscribers with a lower priority are notified next */
+            return NULL;
+        }
+    }
+
+    *last = 1;
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *orig_name, const void *orig_data,
-        uint32_t timeout_ms)
+        uint32_t timeout_ms, int async)
 {
     sr_error_info_t *err_info = NULL;
     struct sr_mod_info_mod_s *mod = NULL;
-    uint32_t notify_count = 0, max_priority, cur_mpriority, diff_lyb_len, *aux = NULL, i, subscriber_count;
+    uint32_t notify_count = 0, max_priority, cur_mpriority, *aux = NULL, i;
     struct sr_shmsub_many_info_change_s *notify_subs = NULL, *nsub;
-    char *diff_lyb = NULL;
-    int opts, pending_events;
+    sr_sub_diff_ref_t diff_ref;
+    sr_shm_t shm_diff = SR_SHM_INITIALIZER;
+    int opts, pending_events, last = 0;
     sr_cid_t cid;
 
     cid = mod_info->conn->cid;
@@ -1760,11 +2475,18 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *
     }
 
     /* assign consolidated module priorities */
-    sr_shmsub_change_notify_nsubs_set_mod_prio(notify_subs, notify_count, mod_info->ds, &cur_mpriority);
+    sr_shmsub_change_notify_nsubs_set_mod_prio(mod_info->conn, notify_subs, notify_count, mod_info->ds,
+            &cur_mpriority);
 
-    /* prepare the diff to write into subscription SHM */
-    if (!diff_lyb && (err_info = sr_lyd_print_data(mod_info->diff, LYD_LYB, 0, -1, &diff_lyb, &diff_lyb_len))) {
-        goto cleanup;
+    /* reuse the shared diff segment of the "change" event, if any */
+    if (mod_info->diff_id) {
+        diff_ref.cid = cid;
+        diff_ref.diff_id = mod_info->diff_id;
+    } else {
+        if ((err_info = sr_shmsub_change_notify_diff_create(mod_info, &mod_info->diff, 0, &diff_ref))) {
+            goto cleanup;
+        }
+        mod_info->diff_id = diff_ref.diff_id;
     }
 
     do {
@@ -1778,15 +2500,48 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *
 
             /* get next subscriber(s) priority and subscriber count */
             if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, nsub->mod, mod_info->ds,
-                    mod_info->diff, SR_SUB_EV_DONE, nsub->cur_priority, &nsub->cur_priority, &subscriber_count, &opts))) {
+                    mod_info->diff, SR_SUB_EV_DONE, nsub->cur_priority, &nsub->cur_priority,
+                    &nsub->subscriber_count, &opts))) {
                 goto cleanup;
             }
 
-            if (!subscriber_count) {
+            if (!nsub->subscriber_count) {
                 continue;
             }
             nsub->pending_event = 1;
             pending_events = 1;
+        }
+        if (!pending_events) {
+            /* all module events generated and processed, next module priority, if any */
+            if (!cur_mpriority) {
+                break;
+            }
+
+            --cur_mpriority;
+            continue;
+        }
+
+        if (async) {
+            /* the last round is not waited for, the subscribers finish it and remove the diff segment */
+            if ((err_info = sr_shmsub_change_notify_done_is_last(mod_info, notify_subs, notify_count, cur_mpriority,
+                    &last))) {
+                goto cleanup;
+            }
+            if (last) {
+                if ((err_info = sr_shmsub_change_diff_async_open(&diff_ref, &shm_diff))) {
+                    goto cleanup;
+                }
+
+                /* our own reference while publishing the events */
+                ATOMIC_STORE_RELAXED(((sr_sub_diff_shm_t *)shm_diff.addr)->async_refs, 1);
+            }
+        }
+
+        for (i = 0; i < notify_count; ++i) {
+            nsub = &notify_subs[i];
+            if (!nsub->pending_event) {
+                continue;
+            }
 
             /* open sub SHM and map it */
             if ((err_info = sr_shmsub_open_map(nsub->mod->ly_mod->name, sr_ds2str(mod_info->ds), -1, &nsub->shm_sub))) {
@@ -1795,7 +2550,7 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *
             nsub->sub_shm = (sr_sub_shm_t *)nsub->shm_sub.addr;
 
             /* SUB WRITE LOCK */
-            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, cid))) {
+            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, mod_info->conn))) {
                 goto cleanup;
             }
             nsub->lock = SR_LOCK_WRITE;
@@ -1811,10 +2566,17 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *
                 nsub->mod->request_id = ++nsub->sub_shm->request_id;
             }
             if ((err_info = sr_shmsub_multi_notify_write_event((sr_multi_sub_shm_t *)nsub->shm_sub.addr, cid,
-                    nsub->mod->request_id, nsub->cur_priority, SR_SUB_EV_DONE, orig_name, orig_data, subscriber_count,
-                    &nsub->shm_data_sub, diff_lyb, diff_lyb_len, nsub->mod->ly_mod->name))) {
+                    nsub->mod->request_id, nsub->cur_priority, SR_SUB_EV_DONE, orig_name, orig_data,
+                    nsub->subscriber_count, &nsub->shm_data_sub, (char *)&diff_ref, sizeof diff_ref,
+                    nsub->mod->ly_mod->name))) {
                 goto cleanup;
             }
+            if (last) {
+                /* the subscribers cannot see the event before we unlock it */
+                ATOMIC_INC_RELAXED(((sr_sub_diff_shm_t *)shm_diff.addr)->async_refs);
+                ((sr_multi_sub_shm_t *)nsub->shm_sub.addr)->async_diff = diff_ref;
+                ATOMIC_STORE_RELAXED(((sr_multi_sub_shm_t *)nsub->shm_sub.addr)->async_done, 1);
+            }
 
             /* notify the subscribers using an event pipe */
             if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn, nsub->mod, mod_info->ds, mod_info->diff,
@@ -1822,19 +2584,29 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *
                 goto cleanup;
             }
         }
-        if (!pending_events) {
-            /* all module events generated and processed, next module priority, if any */
-            if (!cur_mpriority) {
-                break;
-            }
 
-            --cur_mpriority;
-            continue;
+        if (last) {
+            for (i = 0; i < notify_count; ++i) {
+                nsub = &notify_subs[i];
+                if (!nsub->pending_event) {
+                    continue;
+                }
+
+                /* SUB WRITE UNLOCK, the next event waits until the subscribers clear this one */
+                sr_rwunlock(&nsub->sub_shm->lock, 0, SR_LOCK_WRITE, cid, __func__);
+                nsub->lock = SR_LOCK_NONE;
+
+                SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" ID %" PRIu32 " priority %" PRIu32 " published asynchronously.",
+                        nsub->mod->ly_mod->name, sr_ev2str(SR_SUB_EV_DONE), nsub->mod->request_id, nsub->cur_priority);
+
+                nsub->pending_event = 0;
+            }
+            break;
         }
 
         /* wait until the events are processed */
         if ((err_info = sr_shmsub_notify_many_wait_wr((struct sr_shmsub_many_info_s *)notify_subs, sizeof *notify_subs,
-                notify_count, SR_SUB_EV_FINISHED, 1, cid, timeout_ms))) {
+                notify_count, SR_SUB_EV_FINISHED, 1, mod_info->conn, timeout_ms))) {
             goto cleanup;
         }
 
@@ -1871,8 +2643,16 @@ cleanup:
         sr_shm_clear(&notify_subs[i].shm_data_sub);
     }
 
+    if (shm_diff.fd > -1) {
+        /* the change is finished once the subscribers release their references */
+        sr_shmsub_change_diff_async_unref(&diff_ref, &shm_diff);
+        mod_info->diff_id = 0;
+    } else {
+        /* the change is finished */
+        sr_shmsub_change_notify_diff_remove(cid, &mod_info->diff_id);
+    }
+
     free(aux);
-    free(diff_lyb);
     free(notify_subs);
     return err_info;
 }
@@ -1885,9 +2665,9 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
     sr_multi_sub_shm_t *multi_sub_shm;
     struct lyd_node *abort_diff;
     struct sr_mod_info_mod_s *mod = NULL;
-    uint32_t notify_count = 0, max_priority, cur_mpriority, subscriber_count, diff_lyb_len, *aux = NULL, i;
+    uint32_t notify_count = 0, max_priority, cur_mpriority, subscriber_count, *aux = NULL, i;
     struct sr_shmsub_many_info_change_s *notify_subs = NULL, *nsub;
-    char *diff_lyb = NULL;
+    sr_sub_diff_ref_t diff_ref = {0};
     int last_priority = 0, pending_events;
     sr_cid_t cid;
 
@@ -1937,7 +2717,8 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
         multi_sub_shm = (sr_multi_sub_shm_t *)nsub->shm_sub.addr;
 
         /* SUB WRITE LOCK */
-        if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, SR_SUB_EV_ERROR, cid))) {
+        if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, SR_SUB_EV_ERROR,
+                mod_info->conn))) {
             goto cleanup;
         }
         nsub->lock = SR_LOCK_WRITE;
@@ -1952,7 +2733,7 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
         if (nsub->sub_shm->event == SR_SUB_EV_ERROR) {
             nsub->change_error = 1;
             nsub->err_priority = ATOMIC_LOAD_RELAXED(multi_sub_shm->priority);
-            nsub->err_subscriber_count = multi_sub_shm->subscriber_count;
+            nsub->subscriber_count = multi_sub_shm->subscriber_count;
 
             /* clear the error */
             assert(nsub->sub_shm->request_id == nsub->mod->request_id);
@@ -1968,15 +2749,16 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
     }
 
     /* assign consolidated module priorities */
-    sr_shmsub_change_notify_nsubs_set_mod_prio(notify_subs, notify_count, mod_info->ds, &cur_mpriority);
+    sr_shmsub_change_notify_nsubs_set_mod_prio(mod_info->conn, notify_subs, notify_count, mod_info->ds,
+            &cur_mpriority);
 
     /* first reverse change diff for abort */
     if ((err_info = sr_lyd_diff_reverse_all(mod_info->diff, &abort_diff))) {
         goto cleanup;
     }
 
-    /* prepare the diff to write into subscription SHM */
-    err_info = sr_lyd_print_data(abort_diff, LYD_LYB, 0, -1, &diff_lyb, &diff_lyb_len);
+    /* prepare the shared diff segment referenced from subscription SHM */
+    err_info = sr_shmsub_change_notify_diff_create(mod_info, &abort_diff, 0, &diff_ref);
     lyd_free_all(abort_diff);
     if (err_info) {
         goto cleanup;
@@ -1999,7 +2781,7 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
 
             if (subscriber_count && nsub->change_error && (nsub->err_priority == nsub->cur_priority)) {
                 /* do not notify subscribers that did not process the previous event */
-                subscriber_count -= nsub->err_subscriber_count;
+                subscriber_count -= nsub->subscriber_count;
             }
             if (!subscriber_count) {
                 continue;
@@ -2015,7 +2797,7 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
             multi_sub_shm = (sr_multi_sub_shm_t *)nsub->shm_sub.addr;
 
             /* SUB WRITE LOCK */
-            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, cid))) {
+            if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, nsub->mod->ly_mod->name, 0, mod_info->conn))) {
                 goto cleanup;
             }
             nsub->lock = SR_LOCK_WRITE;
@@ -2029,7 +2811,7 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
             /* write the event */
             if ((err_info = sr_shmsub_multi_notify_write_event(multi_sub_shm, cid, nsub->mod->request_id,
                     nsub->cur_priority, SR_SUB_EV_ABORT, orig_name, orig_data, subscriber_count, &nsub->shm_data_sub,
-                    diff_lyb, diff_lyb_len, nsub->mod->ly_mod->name))) {
+                    (char *)&diff_ref, sizeof diff_ref, nsub->mod->ly_mod->name))) {
                 goto cleanup;
             }
 
@@ -2051,7 +2833,7 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, const char
 
         /* wait until the events are processed */
         if ((err_info = sr_shmsub_notify_many_wait_wr((struct sr_shmsub_many_info_s *)notify_subs, sizeof *notify_subs,
-                notify_count, SR_SUB_EV_FINISHED, 1, cid, timeout_ms))) {
+                notify_count, SR_SUB_EV_FINISHED, 1, mod_info->conn, timeout_ms))) {
             goto cleanup;
         }
 
@@ -2095,104 +2877,126 @@ cleanup:
     }
 
     free(aux);
-    free(diff_lyb);
+    sr_shmsub_change_notify_diff_remove(cid, &diff_ref.diff_id);
     free(notify_subs);
     return err_info;
 }
 
 sr_error_info_t *
-sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, const char *xpath, const char *request_xpath,
-        const struct lyd_node *parent, const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *oper_get_subs,
-        uint32_t idx1, uint32_t timeout_ms, sr_conn_ctx_t *conn, struct lyd_node **data, sr_error_info_t **cb_err_info)
+sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, struct sr_shmsub_oper_get_req_s *reqs, uint32_t req_count,
+        const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *oper_get_subs, uint32_t timeout_ms,
+        sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t i, notify_count = 0, parent_lyb_len, request_id;
+    uint32_t i, r, notify_count = 0, *ev_data_len = NULL, parent_lyb_len, request_id;
     struct sr_shmsub_many_info_oper_get_s *notify_subs = NULL, *nsub;
+    struct sr_shmsub_oper_get_req_s *req;
     sr_mod_oper_get_xpath_sub_t *xpath_sub;
-    char *parent_lyb = NULL;
+    char **ev_data = NULL, *parent_lyb = NULL;
     struct lyd_node *oper_data;
     sr_cid_t cid;
 
-    if (!request_xpath) {
-        request_xpath = "";
-    }
     cid = conn->cid;
 
-    i = 0;
-    while (i < oper_get_subs[idx1].xpath_sub_count) {
-        xpath_sub = &((sr_mod_oper_get_xpath_sub_t *)(conn->ext_shm.addr + oper_get_subs[idx1].xpath_subs))[i];
+    for (r = 0; r < req_count; ++r) {
+        req = &reqs[r];
+        req->data = NULL;
+        req->cb_err_info = NULL;
 
-        /* check subscription aliveness */
-        if (!sr_conn_is_alive(xpath_sub->cid)) {
-            /* recover the subscription */
-            if ((err_info = sr_shmext_oper_get_sub_stop(conn, mod->shm_mod, idx1, i, 1, SR_LOCK_READ, 1))) {
-                sr_errinfo_free(&err_info);
-            }
+        i = 0;
+        while (i < oper_get_subs[req->idx1].xpath_sub_count) {
+            xpath_sub = &((sr_mod_oper_get_xpath_sub_t *)(conn->ext_shm.addr + oper_get_subs[req->idx1].xpath_subs))[i];
 
-            /* oper get subscriptions change */
-            if ((err_info = sr_shmsub_oper_poll_get_sub_change_notify_evpipe(conn, mod->ly_mod->name, xpath))) {
-                sr_errinfo_free(&err_info);
+            /* check subscription aliveness */
+            if (!sr_conn_is_alive(xpath_sub->cid)) {
+                /* recover the subscription */
+                if ((err_info = sr_shmext_oper_get_sub_stop(conn, mod->shm_mod, req->idx1, i, 1, SR_LOCK_READ, 1))) {
+                    sr_errinfo_free(&err_info);
+                }
+
+                /* oper get subscriptions change */
+                if ((err_info = sr_shmsub_oper_poll_get_sub_change_notify_evpipe(conn, mod->ly_mod->name,
+                        req->xpath))) {
+                    sr_errinfo_free(&err_info);
+                }
+                continue;
             }
-            continue;
-        }
 
-        /* skip suspended subscriptions */
-        if (ATOMIC_LOAD_RELAXED(xpath_sub->suspended)) {
-            ++i;
-            continue;
-        }
+            /* skip suspended subscriptions */
+            if (ATOMIC_LOAD_RELAXED(xpath_sub->suspended)) {
+                ++i;
+                continue;
+            }
 
-        notify_subs = sr_realloc(notify_subs, (notify_count + 1) * sizeof *notify_subs);
-        SR_CHECK_MEM_GOTO(!notify_subs, err_info, cleanup);
+            notify_subs = sr_realloc(notify_subs, (notify_count + 1) * sizeof *notify_subs);
+            SR_CHECK_MEM_GOTO(!notify_subs, err_info, cleanup);
 
-        /* init */
-        memset(&notify_subs[notify_count], 0, sizeof *notify_subs);
-        notify_subs[notify_count].xpath_sub = xpath_sub;
-        notify_subs[notify_count].shm_sub.fd = -1;
-        notify_subs[notify_count].shm_data_sub.fd = -1;
-        ++notify_count;
+            /* init */
+            memset(&notify_subs[notify_count], 0, sizeof *notify_subs);
+            notify_subs[notify_count].xpath_sub = xpath_sub;
+            notify_subs[notify_count].req_idx = r;
+            notify_subs[notify_count].shm_sub.fd = -1;
+            notify_subs[notify_count].shm_data_sub.fd = -1;
+            ++notify_count;
 
-        ++i;
+            ++i;
+        }
     }
 
-    /* print the parent (or nothing) into LYB */
-    if ((err_info = sr_lyd_print_data(parent, LYD_LYB, 0, -1, &parent_lyb, &parent_lyb_len))) {
-        goto cleanup;
+    /* prepare the event data of every request, max depth followed by the parent (or nothing) in LYB */
+    ev_data = calloc(req_count, sizeof *ev_data);
+    ev_data_len = calloc(req_count, sizeof *ev_data_len);
+    SR_CHECK_MEM_GOTO(!ev_data || !ev_data_len, err_info, cleanup);
+    for (r = 0; r < req_count; ++r) {
+        if ((err_info = sr_lyd_print_data(reqs[r].parent, LYD_LYB, 0, -1, &parent_lyb, &parent_lyb_len))) {
+            goto cleanup;
+        }
+
+        ev_data_len[r] = SR_SHM_SIZE(sizeof reqs[r].max_depth) + parent_lyb_len;
+        ev_data[r] = calloc(1, ev_data_len[r]);
+        SR_CHECK_MEM_GOTO(!ev_data[r], err_info, cleanup);
+        memcpy(ev_data[r], &reqs[r].max_depth, sizeof reqs[r].max_depth);
+        memcpy(ev_data[r] + SR_SHM_SIZE(sizeof reqs[r].max_depth), parent_lyb, parent_lyb_len);
+        free(parent_lyb);
+        parent_lyb = NULL;
     }
 
+    /* publish all the requests first so that the subscribers can process them concurrently */
     for (i = 0; i < notify_count; ++i) {
         nsub = &notify_subs[i];
+        req = &reqs[nsub->req_idx];
 
         /* open sub SHM and map it */
-        if ((err_info = sr_shmsub_open_map(mod->ly_mod->name, "oper", sr_str_hash(xpath, nsub->xpath_sub->priority),
-                &nsub->shm_sub))) {
+        if ((err_info = sr_shmsub_open_map(mod->ly_mod->name, "oper",
+                sr_str_hash(req->xpath, nsub->xpath_sub->priority), &nsub->shm_sub))) {
             goto cleanup;
         }
         nsub->sub_shm = (sr_sub_shm_t *)nsub->shm_sub.addr;
 
         /* SUB WRITE LOCK */
-        if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, mod->ly_mod->name, 0, cid))) {
+        if ((err_info = sr_shmsub_notify_new_wrlock(nsub->sub_shm, mod->ly_mod->name, 0, conn))) {
             goto cleanup;
         }
         nsub->lock = SR_LOCK_WRITE;
 
         /* open sub data SHM */
         if ((err_info = sr_shmsub_data_open_remap(mod->ly_mod->name, "oper",
-                sr_str_hash(xpath, nsub->xpath_sub->priority), &nsub->shm_data_sub, 0))) {
+                sr_str_hash(req->xpath, nsub->xpath_sub->priority), &nsub->shm_data_sub, 0))) {
             goto cleanup;
         }
 
         /* write the request for state data */
         request_id = ATOMIC_LOAD_RELAXED(nsub->sub_shm->request_id) + 1;
         if ((err_info = sr_shmsub_notify_write_event(nsub->sub_shm, cid, request_id, SR_SUB_EV_OPER, orig_name,
-                orig_data, &nsub->shm_data_sub, request_xpath, parent_lyb, parent_lyb_len, NULL))) {
+                orig_data, &nsub->shm_data_sub, req->request_xpath ? req->request_xpath : "", ev_data[nsub->req_idx],
+                ev_data_len[nsub->req_idx], NULL))) {
             goto cleanup;
         }
-        SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " published.", xpath,
+        SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " published.", req->xpath,
                 sr_ev2str(SR_SUB_EV_OPER), i, request_id);
 
         /* notify using event pipe */
-        if ((err_info = sr_shmsub_notify_evpipe(nsub->xpath_sub->evpipe_num))) {
+        if ((err_info = sr_shmsub_notify_evpipe(conn, nsub->xpath_sub->evpipe_num))) {
             goto cleanup;
         }
 
@@ -2201,28 +3005,29 @@ sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, const char *xpath, cons
 
     /* wait until the events are processed */
     if ((err_info = sr_shmsub_notify_many_wait_wr((struct sr_shmsub_many_info_s *)notify_subs, sizeof *notify_subs,
-            notify_count, SR_SUB_EV_ERROR, 1, cid, timeout_ms))) {
+            notify_count, SR_SUB_EV_ERROR, 1, conn, timeout_ms))) {
         goto cleanup;
     }
 
     for (i = 0; i < notify_count; ++i) {
         nsub = &notify_subs[i];
+        req = &reqs[nsub->req_idx];
         if (!nsub->pending_event) {
             continue;
         }
 
         if (nsub->cb_err_info) {
             /* failed callback */
-            SR_LOG_WRN("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " failed (%s).", xpath,
+            SR_LOG_WRN("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " failed (%s).", req->xpath,
                     sr_ev2str(SR_SUB_EV_OPER), i, nsub->request_id, sr_strerror(nsub->cb_err_info->err[0].err_code));
 
             /* merge the error and continue */
-            sr_errinfo_merge(cb_err_info, nsub->cb_err_info);
+            sr_errinfo_merge(&req->cb_err_info, nsub->cb_err_info);
             nsub->cb_err_info = NULL;
             nsub->pending_event = 0;
             continue;
         } else {
-            SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " succeeded.", xpath,
+            SR_LOG_INF("EV ORIGIN: \"%s\" \"%s\" index %" PRIu32 " ID %" PRIu32 " succeeded.", req->xpath,
                     sr_ev2str(SR_SUB_EV_OPER), i, nsub->request_id);
         }
 
@@ -2242,8 +3047,8 @@ sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, const char *xpath, cons
         sr_rwunlock(&nsub->sub_shm->lock, 0, SR_LOCK_WRITE, cid, __func__);
         nsub->lock = SR_LOCK_NONE;
 
-        /* merge returned data into data tree */
-        if ((err_info = sr_lyd_merge(data, oper_data, 1, LYD_MERGE_DESTRUCT | LYD_MERGE_WITH_FLAGS))) {
+        /* merge returned data into the data tree of the request */
+        if ((err_info = sr_lyd_merge(&req->data, oper_data, 1, LYD_MERGE_DESTRUCT | LYD_MERGE_WITH_FLAGS))) {
             goto cleanup;
         }
 
@@ -2261,6 +3066,13 @@ cleanup:
         sr_shm_clear(&notify_subs[i].shm_data_sub);
     }
 
+    if (ev_data) {
+        for (r = 0; r < req_count; ++r) {
+            free(ev_data[r]);
+        }
+    }
+    free(ev_data);
+    free(ev_data_len);
     free(parent_lyb);
     free(notify_subs);
     return err_info;
@@ -2627,20 +3439,77 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Open and WRITE lock the sub SHM of an RPC/action lane for a new event.
+ *
+ * A lane with no pending event is preferred so that several RPCs/actions can be processed at once. If all
+ * the lanes are busy, wait for the first lane of this connection.
+ *
+ * @param[in] mod_name RPC/action module name.
+ * @param[in] path RPC/action path.
+ * @param[in] request_id Request ID of an already published event, which is always in its lane, 0 for a new event.
+ * @param[in] lock_event Which leftover event is OK to lock the SHM with, if any.
+ * @param[in] conn Connection to use.
+ * @param[out] lane Index of the locked lane.
+ * @param[out] shm_sub Opened sub SHM of @p lane.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_rpc_notify_lane_wrlock(const char *mod_name, const char *path, uint32_t request_id,
+        sr_sub_event_t lock_event, sr_conn_ctx_t *conn, uint32_t *lane, sr_shm_t *shm_sub)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    if (request_id) {
+        /* request IDs are congruent with their lane index */
+        *lane = request_id % SR_RPC_LANE_COUNT;
+    } else {
+        /* find a lane with no event, every connection starts with a different one */
+        for (i = 0; i < SR_RPC_LANE_COUNT; ++i) {
+            *lane = (conn->cid + i) % SR_RPC_LANE_COUNT;
+            if ((err_info = sr_shmsub_open_map(mod_name, "rpc", sr_str_hash(path, *lane), shm_sub))) {
+                return err_info;
+            }
+            if (ATOMIC_LOAD_RELAXED(((sr_multi_sub_shm_t *)shm_sub->addr)->event) == SR_SUB_EV_NONE) {
+                break;
+            }
+            sr_shm_clear(shm_sub);
+        }
+        if (i == SR_RPC_LANE_COUNT) {
+            /* all the lanes are busy */
+            *lane = conn->cid % SR_RPC_LANE_COUNT;
+        }
+    }
+
+    /* open sub SHM and map it, if not already */
+    if ((err_info = sr_shmsub_open_map(mod_name, "rpc", sr_str_hash(path, *lane), shm_sub))) {
+        return err_info;
+    }
+
+    /* SUB WRITE LOCK */
+    if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)shm_sub->addr, path, lock_event, conn))) {
+        return err_info;
+    }
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, off_t *subs, uint32_t *sub_count, const char *path,
         const struct lyd_node *input, const char *orig_name, const void *orig_data, uint32_t timeout_ms,
-        uint32_t *request_id, struct lyd_node **output, sr_error_info_t **cb_err_info)
+        uint32_t *request_id, struct lyd_node **output, int *output_trusted, sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
     char *input_lyb = NULL;
-    uint32_t i, input_lyb_len, cur_priority, subscriber_count, *evpipes = NULL;
+    uint32_t input_lyb_len, cur_priority, subscriber_count, lane, *evpipes = NULL;
     int opts, lock_lost;
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER, shm_data_sub = SR_SHM_INITIALIZER;
 
     assert(!input->parent);
     *output = NULL;
+    *output_trusted = 0;
 
     /* just find out whether there are any subscriptions and if so, what is the highest priority */
     if (!sr_shmsub_rpc_notify_has_subscription(conn, sub_lock, subs, sub_count, path, input, &cur_priority)) {
@@ -2678,19 +3547,16 @@ first_sub:
         goto cleanup;
     }
 
-    /* open sub SHM and map it */
-    if ((err_info = sr_shmsub_open_map(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, 0), &shm_sub))) {
+    /* open sub SHM of a free lane and SUB WRITE LOCK */
+    if ((err_info = sr_shmsub_rpc_notify_lane_wrlock(lyd_owner_module(input)->name, path, *request_id, 0, conn, &lane,
+            &shm_sub))) {
         goto cleanup;
     }
     multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
-    /* SUB WRITE LOCK */
-    if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, path, 0, conn->cid))) {
-        goto cleanup;
-    }
-
     /* open sub data SHM */
-    if ((err_info = sr_shmsub_data_open_remap(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, 0), &shm_data_sub, 0))) {
+    if ((err_info = sr_shmsub_data_open_remap(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, lane),
+            &shm_data_sub, 0))) {
         goto cleanup_wrunlock;
     }
 
@@ -2706,12 +3572,15 @@ first_sub:
             if ((err_info = sr_shmsub_rpc_internal_call_callback(conn, input, output))) {
                 goto cleanup;
             }
+            *output_trusted = 0;
             goto next_sub;
         }
 
         /* write the event */
         if (!*request_id) {
-            *request_id = ++multi_sub_shm->request_id;
+            /* next request ID congruent with the lane index */
+            *request_id = (ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id) / SR_RPC_LANE_COUNT + 1) *
+                    SR_RPC_LANE_COUNT + lane;
         }
         if ((err_info = sr_shmsub_multi_notify_write_event(multi_sub_shm, conn->cid, *request_id, cur_priority,
                 SR_SUB_EV_RPC, orig_name, orig_data, subscriber_count, &shm_data_sub, input_lyb, input_lyb_len, path))) {
@@ -2719,14 +3588,12 @@ first_sub:
         }
 
         /* notify using event pipe */
-        for (i = 0; i < subscriber_count; ++i) {
-            if ((err_info = sr_shmsub_notify_evpipe(evpipes[i]))) {
-                goto cleanup_wrunlock;
-            }
+        if ((err_info = sr_shmsub_notify_evpipes(conn, evpipes, subscriber_count))) {
+            goto cleanup_wrunlock;
         }
 
         /* wait until the event is processed */
-        if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_ERROR, 0, conn->cid,
+        if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_ERROR, 0, conn,
                 &shm_data_sub, timeout_ms, &lock_lost, cb_err_info))) {
             if (lock_lost) {
                 goto cleanup;
@@ -2752,6 +3619,7 @@ first_sub:
             sr_errinfo_new(&err_info, SR_ERR_VALIDATION_FAILED, "Failed to parse returned \"RPC\" data.");
             goto cleanup_wrunlock;
         }
+        *output_trusted = (opts & SR_SUBSCR_RPC_TRUSTED) ? 1 : 0;
 
         /* event processed */
         multi_sub_shm->event = SR_SUB_EV_NONE;
@@ -2787,26 +3655,23 @@ sr_shmsub_rpc_notify_abort(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, off_t *su
 {
     sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
     char *input_lyb = NULL;
-    uint32_t i, input_lyb_len, cur_priority, err_priority, subscriber_count, err_subscriber_count, *evpipes = NULL;
+    uint32_t input_lyb_len, cur_priority, err_priority, subscriber_count, err_subscriber_count, lane, *evpipes = NULL;
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER, shm_data_sub = SR_SHM_INITIALIZER;
     int first_iter, lock_lost;
 
     assert(request_id);
 
-    /* open sub SHM and map it */
-    if ((err_info = sr_shmsub_open_map(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, 0), &shm_sub))) {
+    /* open sub SHM of the lane with the failed event and SUB WRITE LOCK */
+    if ((err_info = sr_shmsub_rpc_notify_lane_wrlock(lyd_owner_module(input)->name, path, request_id, SR_SUB_EV_ERROR,
+            conn, &lane, &shm_sub))) {
         goto cleanup;
     }
     multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
-    /* SUB WRITE LOCK */
-    if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, path, SR_SUB_EV_ERROR, conn->cid))) {
-        goto cleanup;
-    }
-
     /* open sub data SHM */
-    if ((err_info = sr_shmsub_data_open_remap(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, 0), &shm_data_sub, 0))) {
+    if ((err_info = sr_shmsub_data_open_remap(lyd_owner_module(input)->name, "rpc", sr_str_hash(path, lane),
+            &shm_data_sub, 0))) {
         goto cleanup_wrunlock;
     }
 
@@ -2866,14 +3731,12 @@ clear_shm:
         }
 
         /* notify using event pipe */
-        for (i = 0; i < subscriber_count; ++i) {
-            if ((err_info = sr_shmsub_notify_evpipe(evpipes[i]))) {
-                goto cleanup_wrunlock;
-            }
+        if ((err_info = sr_shmsub_notify_evpipes(conn, evpipes, subscriber_count))) {
+            goto cleanup_wrunlock;
         }
 
         /* wait until the event is processed */
-        if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_FINISHED, 1, conn->cid,
+        if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_FINISHED, 1, conn,
                 &shm_data_sub, timeout_ms, &lock_lost, &cb_err_info))) {
             if (lock_lost) {
                 goto cleanup;
@@ -2907,23 +3770,258 @@ cleanup:
     return err_info;
 }
 
+/** next ring slot to be written in a notification subscription SHM */
+#define SR_SHMSUB_NOTIF_NEXT_SLOT(notif_shm) \
+        (&(notif_shm)->slots[(ATOMIC_LOAD_RELAXED((notif_shm)->request_id) + 1) % SR_SUB_NOTIF_RING_SIZE])
+
+/**
+ * @brief Recover a notification event abandoned by its subscribers.
+ * WRITE lock on the SHM must be held!
+ *
+ * @param[in] slot Notification subscription SHM ring slot to recover.
+ * @param[in] shm_name Subscription SHM name.
+ */
+static void
+sr_shmsub_notif_recover_slot(sr_notif_sub_slot_t *slot, const char *shm_name)
+{
+    if (!ATOMIC_LOAD_RELAXED(slot->event) || (slot->orig_cid && sr_conn_is_alive(slot->orig_cid))) {
+        return;
+    }
+
+    SR_LOG_WRN("EV ORIGIN: \"%s\" \"notif\" ID %" PRIu32 " of CID %" PRIu32 " recovered.", shm_name,
+            (uint32_t)ATOMIC_LOAD_RELAXED(slot->request_id), slot->orig_cid);
+
+    /* free the slot */
+    ATOMIC_STORE_RELAXED(slot->event, SR_SUB_EV_NONE);
+    slot->orig_cid = 0;
+    slot->subscriber_count = 0;
+}
+
+/**
+ * @brief Wait for and keep WRITE lock on a notification subscription when its next ring slot is free.
+ *
+ * @param[in] notif_shm Notification subscription SHM to lock.
+ * @param[in] shm_name Subscription SHM name.
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notif_notify_slot_wrlock(sr_notif_sub_shm_t *notif_shm, const char *shm_name, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_abs;
+    sr_notif_sub_slot_t *slot;
+    int ret;
+
+    /* WRITE LOCK */
+    if ((err_info = sr_rwlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__, NULL,
+            NULL))) {
+        return err_info;
+    }
+
+    slot = SR_SHMSUB_NOTIF_NEXT_SLOT(notif_shm);
+    if (ATOMIC_LOAD_RELAXED(slot->event)) {
+        /* the ring is full, instead of waiting, try to recover the oldest event immediately */
+        sr_shmsub_notif_recover_slot(slot, shm_name);
+    }
+    if (!ATOMIC_LOAD_RELAXED(slot->event)) {
+        /* free slot */
+        return NULL;
+    }
+
+    assert(notif_shm->lock.writer == conn->cid);
+    /* FAKE WRITE UNLOCK */
+    notif_shm->lock.writer = 0;
+
+    /* wait until the next slot is free and there are no readers (just like write lock), the slot may change if
+     * another originator writes an event meanwhile */
+    sr_timeouttime_get(&timeout_abs, SR_SUBSHM_LOCK_TIMEOUT);
+    ret = 0;
+    while (!ret && (sr_rwlock_has_readers(&notif_shm->lock) ||
+            ATOMIC_LOAD_RELAXED(SR_SHMSUB_NOTIF_NEXT_SLOT(notif_shm)->event))) {
+        /* COND WAIT */
+        ret = sr_shmsub_cond_wait((sr_sub_shm_t *)notif_shm, conn, &timeout_abs);
+    }
+    slot = SR_SHMSUB_NOTIF_NEXT_SLOT(notif_shm);
+
+    if (!sr_rwlock_has_readers(&notif_shm->lock)) {
+        /* FAKE WRITE LOCK */
+        assert(!notif_shm->lock.writer);
+        notif_shm->lock.writer = conn->cid;
+
+        if (ret == ETIMEDOUT) {
+            /* try to recover the event again in case the subscriber crashed later */
+            sr_shmsub_notif_recover_slot(slot, shm_name);
+        }
+        if (!ATOMIC_LOAD_RELAXED(slot->event)) {
+            /* even though the timeout may have elapsed, the slot is free so continue normally */
+            return NULL;
+        }
+    }
+
+    if (ret == ETIMEDOUT) {
+        /* timeout */
+        sr_errinfo_new(&err_info, SR_ERR_TIME_OUT, "Waiting for subscription of \"%s\" failed, all %d events "
+                "were not processed, the oldest event ID %" PRIu32 ".", shm_name, SR_SUB_NOTIF_RING_SIZE,
+                (uint32_t)ATOMIC_LOAD_RELAXED(slot->request_id));
+    } else {
+        /* other error */
+        SR_ERRINFO_COND(&err_info, __func__, ret);
+    }
+
+    if (!sr_rwlock_has_readers(&notif_shm->lock)) {
+        /* WRITE UNLOCK */
+        sr_rwunlock(&notif_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+    } else {
+        /* we only hold the mutex */
+        sr_munlock(&notif_shm->lock.mutex);
+    }
+    return err_info;
+}
+
+/**
+ * @brief Write a notification event into the next free ring slot of notification subscription SHM and
+ * its sub data SHM.
+ *
+ * @param[in] notif_shm Notification subscription SHM to write to.
+ * @param[in] shm_name Subscription SHM name.
+ * @param[in] sub_cid CID of a subscriber, used for recovery.
+ * @param[in] orig_name Originator name.
+ * @param[in] orig_data Originator data.
+ * @param[in] subscriber_count Subscriber count.
+ * @param[in] data Notification data written into sub data SHM.
+ * @param[in] data_len Length of @p data.
+ * @param[out] request_id Request ID of the written event.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notif_notify_write_event(sr_notif_sub_shm_t *notif_shm, const char *shm_name, sr_cid_t sub_cid,
+        const char *orig_name, const void *orig_data, uint32_t subscriber_count, const char *data, uint32_t data_len,
+        uint32_t *request_id)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
+    sr_notif_sub_slot_t *slot;
+    const uint32_t empty_data[] = {0};
+    uint32_t orig_size, slot_idx;
+    char *shm_data_ptr;
+
+    if (!orig_name) {
+        orig_name = "";
+    }
+    if (!orig_data) {
+        orig_data = empty_data;
+    }
+    orig_size = sr_strshmlen(orig_name) + SR_SHM_SIZE(sr_ev_data_size(orig_data));
+
+    *request_id = ATOMIC_LOAD_RELAXED(notif_shm->request_id) + 1;
+    slot_idx = *request_id % SR_SUB_NOTIF_RING_SIZE;
+    slot = &notif_shm->slots[slot_idx];
+    assert(!ATOMIC_LOAD_RELAXED(slot->event));
+
+    /* open and remap the slot sub data SHM */
+    if ((err_info = sr_shmsub_data_open_remap(shm_name, "notif", slot_idx, &shm_data_sub, orig_size + data_len))) {
+        goto cleanup;
+    }
+    shm_data_ptr = shm_data_sub.addr;
+
+    /* write originator name and data */
+    strcpy(shm_data_ptr, orig_name);
+    shm_data_ptr += sr_strshmlen(orig_name);
+    memcpy(shm_data_ptr, orig_data, sr_ev_data_size(orig_data));
+    shm_data_ptr += SR_SHM_SIZE(sr_ev_data_size(orig_data));
+
+    /* write the notification */
+    memcpy(shm_data_ptr, data, data_len);
+
+    /* fill the slot and publish the event */
+    slot->orig_cid = sub_cid;
+    slot->subscriber_count = subscriber_count;
+#ifdef SR_EVENT_TRACE
+    sr_event_trace_enqueue(&slot->trace);
+#endif
+    ATOMIC_STORE_RELAXED(slot->request_id, *request_id);
+    ATOMIC_STORE_RELAXED(slot->event, SR_SUB_EV_NOTIF);
+    ATOMIC_STORE_RELAXED(notif_shm->request_id, *request_id);
+
+    SR_PROBE(event__write, shm_name, (int)SR_SUB_EV_NOTIF, *request_id, data_len);
+    SR_LOG_INF("EV ORIGIN: \"%s\" \"notif\" ID %" PRIu32 " for %" PRIu32 " subscribers published.", shm_name,
+            *request_id, subscriber_count);
+
+cleanup:
+    sr_shm_clear(&shm_data_sub);
+    return err_info;
+}
+
+/**
+ * @brief Wait for subscribers to process a notification event.
+ *
+ * @param[in] notif_shm Notification subscription SHM.
+ * @param[in] request_id Request ID of the event.
+ * @param[in] conn Connection to use.
+ * @param[in] timeout_ms Timeout in milliseconds.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notif_notify_wait(sr_notif_sub_shm_t *notif_shm, uint32_t request_id, sr_conn_ctx_t *conn,
+        uint32_t timeout_ms)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_notif_sub_slot_t *slot;
+    struct timespec timeout_abs;
+    int ret;
+
+    slot = &notif_shm->slots[request_id % SR_SUB_NOTIF_RING_SIZE];
+    sr_timeouttime_get(&timeout_abs, timeout_ms);
+
+    /* MUTEX LOCK */
+    if ((err_info = sr_mlock(&notif_shm->lock.mutex, SR_SUBSHM_LOCK_TIMEOUT, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* wait until the slot is freed or reused for another event */
+    ret = 0;
+    while (!ret && (ATOMIC_LOAD_RELAXED(slot->request_id) == request_id) &&
+            (ATOMIC_LOAD_RELAXED(slot->event) == SR_SUB_EV_NOTIF)) {
+        /* COND WAIT */
+        ret = sr_shmsub_cond_wait((sr_sub_shm_t *)notif_shm, conn, &timeout_abs);
+    }
+
+    /* MUTEX UNLOCK */
+    sr_munlock(&notif_shm->lock.mutex);
+
+    /* we do not care about a timeout */
+    if (ret && (ret != ETIMEDOUT)) {
+        SR_ERRINFO_COND(&err_info, __func__, ret);
+    }
+    return err_info;
+}
+
 sr_error_info_t *
 sr_shmsub_notif_notify(sr_conn_ctx_t *conn, const struct lyd_node *notif, struct timespec notif_ts_mono,
         struct timespec notif_ts_real, const char *orig_name, const void *orig_data, uint32_t timeout_ms, int wait)
 {
-    sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
+    return sr_shmsub_notif_notify_batch(conn, &notif, 1, notif_ts_mono, notif_ts_real, orig_name, orig_data,
+            timeout_ms, wait);
+}
+
+sr_error_info_t *
+sr_shmsub_notif_notify_batch(sr_conn_ctx_t *conn, const struct lyd_node **notifs, uint32_t notif_count,
+        struct timespec notif_ts_mono, struct timespec notif_ts_real, const char *orig_name, const void *orig_data,
+        uint32_t timeout_ms, int wait)
+{
+    sr_error_info_t *err_info = NULL;
     const struct lys_module *ly_mod;
     sr_mod_notif_sub_t *notif_subs;
     char *notif_lyb = NULL, *data = NULL;
-    uint32_t notif_sub_count, notif_lyb_len, data_len = 0, request_id, i;
-    int lock_lost;
+    uint32_t notif_sub_count, notif_lyb_len, data_len = 0, request_id, i, *evpipes = NULL, evpipe_count = 0;
     sr_cid_t sub_cid;
-    sr_multi_sub_shm_t *multi_sub_shm;
-    sr_shm_t shm_sub = SR_SHM_INITIALIZER, shm_data_sub = SR_SHM_INITIALIZER;
+    sr_notif_sub_shm_t *notif_shm;
+    sr_shm_t shm_sub = SR_SHM_INITIALIZER;
 
-    assert(!notif->parent);
+    assert(notif_count);
 
-    ly_mod = lyd_owner_module(notif);
+    ly_mod = lyd_owner_module(notifs[0]);
 
     /* EXT READ LOCK */
     if ((err_info = sr_shmext_conn_remap_lock(conn, SR_LOCK_READ, 0, __func__))) {
@@ -2941,34 +4039,49 @@ sr_shmsub_notif_notify(sr_conn_ctx_t *conn, const struct lyd_node *notif, struct
         goto cleanup_ext_unlock;
     }
 
-    /* print the notification into LYB */
-    if ((err_info = sr_lyd_print_data(notif, LYD_LYB, 0, -1, &notif_lyb, &notif_lyb_len))) {
-        goto cleanup_ext_unlock;
-    }
-
-    /* generate complete notification data with the timestamps */
-    data = malloc(sizeof notif_ts_mono + sizeof notif_ts_real + notif_lyb_len);
+    /* generate complete notification data with the timestamps and the notification count */
+    data = malloc(sizeof notif_ts_mono + sizeof notif_ts_real + sizeof notif_count);
     SR_CHECK_MEM_GOTO(!data, err_info, cleanup_ext_unlock);
     memcpy(data + data_len, &notif_ts_mono, sizeof notif_ts_mono);
     data_len += sizeof notif_ts_mono;
     memcpy(data + data_len, &notif_ts_real, sizeof notif_ts_real);
     data_len += sizeof notif_ts_real;
-    memcpy(data + data_len, notif_lyb, notif_lyb_len);
-    data_len += notif_lyb_len;
+    memcpy(data + data_len, &notif_count, sizeof notif_count);
+    data_len += sizeof notif_count;
+
+    for (i = 0; i < notif_count; ++i) {
+        assert(!notifs[i]->parent && (lyd_owner_module(notifs[i]) == ly_mod));
+
+        /* print the notification into LYB */
+        if ((err_info = sr_lyd_print_data(notifs[i], LYD_LYB, 0, -1, &notif_lyb, &notif_lyb_len))) {
+            goto cleanup_ext_unlock;
+        }
+
+        /* append it with its length */
+        data = sr_realloc(data, data_len + sizeof notif_lyb_len + notif_lyb_len);
+        SR_CHECK_MEM_GOTO(!data, err_info, cleanup_ext_unlock);
+        memcpy(data + data_len, &notif_lyb_len, sizeof notif_lyb_len);
+        data_len += sizeof notif_lyb_len;
+        memcpy(data + data_len, notif_lyb, notif_lyb_len);
+        data_len += notif_lyb_len;
+
+        free(notif_lyb);
+        notif_lyb = NULL;
+    }
 
     /* open sub SHM and map it */
     if ((err_info = sr_shmsub_open_map(ly_mod->name, "notif", -1, &shm_sub))) {
         goto cleanup_ext_unlock;
     }
-    multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
+    notif_shm = (sr_notif_sub_shm_t *)shm_sub.addr;
 
     /* EXT READ UNLOCK */
     sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
 
-    /* do not wait for previous events with EXT lock */
+    /* do not wait for a free slot with EXT lock */
 
     /* SUB WRITE LOCK */
-    if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, ly_mod->name, 0, conn->cid))) {
+    if ((err_info = sr_shmsub_notif_notify_slot_wrlock(notif_shm, ly_mod->name, conn))) {
         goto cleanup;
     }
 
@@ -2979,19 +4092,13 @@ sr_shmsub_notif_notify(sr_conn_ctx_t *conn, const struct lyd_node *notif, struct
 
     /* reacquire the pointer to notif_subs but they should not be changed (only moved) */
     if ((err_info = sr_notif_find_subscriber(conn, ly_mod->name, &notif_subs, &notif_sub_count, &sub_cid))) {
-        goto cleanup_ext_unlock;
-    }
-    assert(notif_sub_count);
-
-    /* open sub data SHM */
-    if ((err_info = sr_shmsub_data_open_remap(ly_mod->name, "notif", -1, &shm_data_sub, 0))) {
         goto cleanup_ext_sub_unlock;
     }
+    assert(notif_sub_count);
 
-    /* write the notification, use first subscriber CID - works better than the originator */
-    request_id = multi_sub_shm->request_id + 1;
-    if ((err_info = sr_shmsub_multi_notify_write_event(multi_sub_shm, sub_cid, request_id, 0, SR_SUB_EV_NOTIF,
-            orig_name, orig_data, notif_sub_count, &shm_data_sub, data, data_len, ly_mod->name))) {
+    /* write the notification into the free slot, use first subscriber CID - works better than the originator */
+    if ((err_info = sr_shmsub_notif_notify_write_event(notif_shm, ly_mod->name, sub_cid, orig_name, orig_data,
+            notif_sub_count, data, data_len, &request_id))) {
         goto cleanup_ext_sub_unlock;
     }
 
@@ -3002,41 +4109,36 @@ sr_shmsub_notif_notify(sr_conn_ctx_t *conn, const struct lyd_node *notif, struct
             continue;
         }
 
-        if ((err_info = sr_shmsub_notify_evpipe(notif_subs[i].evpipe_num))) {
-            goto cleanup_ext_sub_unlock;
-        }
+        evpipes = sr_realloc(evpipes, (evpipe_count + 1) * sizeof *evpipes);
+        SR_CHECK_MEM_GOTO(!evpipes, err_info, cleanup_ext_sub_unlock);
+        evpipes[evpipe_count++] = notif_subs[i].evpipe_num;
+    }
+    if ((err_info = sr_shmsub_notify_evpipes(conn, evpipes, evpipe_count))) {
+        goto cleanup_ext_sub_unlock;
     }
 
     /* EXT READ UNLOCK */
     sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
 
+    /* SUB WRITE UNLOCK, other originators can write their events while the subscribers process this one */
+    sr_rwunlock(&notif_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+
     if (wait) {
         /* wait until the event is processed */
-        if ((err_info = sr_shmsub_notify_wait_wr((sr_sub_shm_t *)multi_sub_shm, SR_SUB_EV_NONE, 1, conn->cid,
-                &shm_data_sub, timeout_ms, &lock_lost, &cb_err_info))) {
-            if (lock_lost) {
-                goto cleanup;
-            } else {
-                goto cleanup_sub_unlock;
-            }
-        }
-
-        /* we do not care about an error */
-        sr_errinfo_free(&cb_err_info);
+        err_info = sr_shmsub_notif_notify_wait(notif_shm, request_id, conn, timeout_ms);
     }
 
-cleanup_sub_unlock:
-    multi_sub_shm->orig_cid = 0;
-    /* SUB WRITE UNLOCK */
-    sr_rwunlock(&multi_sub_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
-
     /* success */
     goto cleanup;
 
 cleanup_ext_sub_unlock:
-    multi_sub_shm->orig_cid = 0;
+    /* EXT READ UNLOCK */
+    sr_shmext_conn_remap_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+cleanup_sub_unlock:
     /* SUB WRITE UNLOCK */
-    sr_rwunlock(&multi_sub_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+    sr_rwunlock(&notif_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+    goto cleanup;
 
 cleanup_ext_unlock:
     /* EXT READ UNLOCK */
@@ -3045,8 +4147,8 @@ cleanup_ext_unlock:
 cleanup:
     free(notif_lyb);
     free(data);
+    free(evpipes);
     sr_shm_clear(&shm_sub);
-    sr_shm_clear(&shm_data_sub);
     return err_info;
 }
 
@@ -3125,6 +4227,15 @@ sr_shmsub_multi_listen_write_event(sr_multi_sub_shm_t *multi_sub_shm, uint32_t v
             }
             break;
         case SR_SUB_EV_DONE:
+            if (ATOMIC_LOAD_RELAXED(multi_sub_shm->async_done)) {
+                /* notifier does not wait for this event, clear it and make shm ready for next notification */
+                assert(!err_code);
+                ATOMIC_STORE_RELAXED(multi_sub_shm->async_done, 0);
+                multi_sub_shm->orig_cid = 0;
+                ATOMIC_STORE_RELAXED(multi_sub_shm->event, SR_SUB_EV_NONE);
+                break;
+            }
+        /* fallthrough */
         case SR_SUB_EV_ABORT:
             /* notifier waits for these events to clear them and make shm ready for next notification */
             assert(!err_code);
@@ -3145,7 +4256,7 @@ sr_shmsub_multi_listen_write_event(sr_multi_sub_shm_t *multi_sub_shm, uint32_t v
 
     if (data && data_len) {
         /* remap if needed */
-        if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm_data_sub, data_len))) {
+        if ((err_info = sr_shmsub_data_resize((sr_sub_shm_t *)multi_sub_shm, shm_data_sub, data_len))) {
             return err_info;
         }
 
@@ -3251,6 +4362,172 @@ sr_shmsub_prepare_error(sr_error_t err_code, sr_session_ctx_t *ev_sess, char **d
     return NULL;
 }
 
+/**
+ * @brief Open and map a shared diff segment read-only.
+ *
+ * @param[in] diff_ref Reference to the segment.
+ * @param[out] shm Mapped segment.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_change_listen_diff_open(const sr_sub_diff_ref_t *diff_ref, sr_shm_t *shm)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+
+    assert(shm->fd == -1);
+
+    if ((err_info = sr_path_sub_diff_shm(diff_ref->cid, diff_ref->diff_id, &path))) {
+        goto cleanup;
+    }
+
+    /* open and map it, the segment never changes */
+    shm->fd = sr_open(path, O_RDONLY, SR_SUB_SHM_PERM);
+    if (shm->fd == -1) {
+        SR_ERRINFO_SYSERRPATH(&err_info, "open", path);
+        goto cleanup;
+    }
+    if ((err_info = sr_file_get_size(shm->fd, &shm->size))) {
+        goto cleanup;
+    }
+    shm->addr = mmap(NULL, shm->size, PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (shm->addr == MAP_FAILED) {
+        shm->addr = NULL;
+        sr_errinfo_new(&err_info, SR_ERR_NO_MEMORY, "Failed to map shared memory (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    free(path);
+    if (err_info) {
+        sr_shm_clear(shm);
+    }
+    return err_info;
+}
+
+/**
+ * @brief Parse module diffs from a shared diff segment.
+ *
+ * @param[in] ly_ctx libyang context to use.
+ * @param[in] diff_shm Mapped shared diff segment.
+ * @param[in] mod_name Module name.
+ * @param[in] xpath Optional XPath to parse the diff of @p mod_name pruned to this XPath.
+ * @param[in] other Whether to parse the diffs of all the modules except @p mod_name instead of only its diff.
+ * @param[in,out] diff Diff to append the parsed diffs to.
+ * @param[out] found Optional number of the parsed diffs.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_change_listen_diff_parse(const struct ly_ctx *ly_ctx, const char *diff_shm, const char *mod_name,
+        const char *xpath, int other, struct lyd_node **diff, uint32_t *found)
+{
+    sr_error_info_t *err_info = NULL;
+    const sr_sub_diff_mod_t *shm_mod;
+    struct lyd_node *mod_diff;
+    uint32_t i;
+
+    if (found) {
+        *found = 0;
+    }
+
+    for (i = 0; i < ((sr_sub_diff_shm_t *)diff_shm)->mod_count; ++i) {
+        shm_mod = (sr_sub_diff_mod_t *)(diff_shm + SR_SHM_SIZE(sizeof(sr_sub_diff_shm_t)) +
+                i * SR_SHM_SIZE(sizeof *shm_mod));
+        if (!strcmp(diff_shm + shm_mod->name, mod_name) == !other) {
+            continue;
+        }
+        if (xpath && !other) {
+            if (!shm_mod->xpath || strcmp(diff_shm + shm_mod->xpath, xpath)) {
+                continue;
+            }
+        } else if (shm_mod->xpath) {
+            /* pruned diff */
+            continue;
+        }
+
+        if ((err_info = sr_lyd_parse_data(ly_ctx, diff_shm + shm_mod->diff, NULL, LYD_LYB,
+                LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT | LYD_PARSE_ORDERED, 0, &mod_diff))) {
+            return err_info;
+        }
+        if (!*diff) {
+            *diff = mod_diff;
+        } else if (mod_diff && (err_info = sr_lyd_insert_sibling(*diff, mod_diff, diff))) {
+            lyd_free_siblings(mod_diff);
+            return err_info;
+        }
+        if (found) {
+            ++(*found);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check whether an XPath can select only nodes from the data tree of a single module.
+ *
+ * @param[in] xpath XPath to check.
+ * @param[in] mod_name Module name.
+ * @return Whether only @p mod_name data can be selected or not.
+ */
+static int
+sr_shmsub_change_listen_xpath_is_mod(const char *xpath, const char *mod_name)
+{
+    const char *ptr, *prefix;
+    size_t len = strlen(mod_name);
+    char quot = 0;
+
+    if ((xpath[0] != '/') || (xpath[1] == '/')) {
+        /* relative or descendant paths can select any data */
+        return 0;
+    }
+
+    for (ptr = xpath; *ptr; ++ptr) {
+        if (quot) {
+            if (*ptr == quot) {
+                quot = 0;
+            }
+        } else if ((*ptr == '\'') || (*ptr == '\"')) {
+            quot = *ptr;
+        } else if (*ptr == '|') {
+            /* union */
+            return 0;
+        } else if (*ptr == ':') {
+            /* every prefix (and axis) must be the module name */
+            for (prefix = ptr; (prefix > xpath) && (isalnum(prefix[-1]) || strchr("_-.", prefix[-1])); --prefix) {}
+            if (((size_t)(ptr - prefix) != len) || strncmp(prefix, mod_name, len)) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+sr_error_info_t *
+sr_shmsub_change_listen_diff_complete(sr_session_ctx_t *session, const char *xpath)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if (!session->ev_data.diff_shm) {
+        /* nothing more to parse */
+        return NULL;
+    }
+
+    if (xpath && sr_shmsub_change_listen_xpath_is_mod(xpath, session->ev_data.diff_mod)) {
+        /* the diff of the module is enough */
+        return NULL;
+    }
+
+    if ((err_info = sr_shmsub_change_listen_diff_parse(session->conn->ly_ctx, session->ev_data.diff_shm,
+            session->ev_data.diff_mod, NULL, 1, &session->dt[session->ds].diff, NULL))) {
+        return err_info;
+    }
+    session->ev_data.diff_shm = NULL;
+
+    return NULL;
+}
+
 struct info_sub_s {
     sr_sub_event_t event;
     uint32_t request_id;
@@ -3304,6 +4581,9 @@ sr_shmsub_change_listen_relock(sr_multi_sub_shm_t *multi_sub_shm, sr_lock_mode_t
                 sr_shmsub_change_listen_event_is_valid(SR_SUB_EV_ABORT, sub->opts)) {
             /* update session */
             ev_sess->ev = SR_SUB_EV_ABORT;
+            if ((*err_info = sr_shmsub_change_listen_diff_complete(ev_sess, NULL))) {
+                return 1;
+            }
             if ((*err_info = sr_lyd_diff_reverse_all(ev_sess->dt[ev_sess->ds].diff, &abort_diff))) {
                 SR_ERRINFO_INT(err_info);
                 return 1;
@@ -3331,19 +4611,25 @@ sr_error_info_t *
 sr_shmsub_change_listen_process_module_events(struct modsub_change_s *change_subs, sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t i, data_len = 0, valid_subscr_count;
+    uint32_t i, j, data_len = 0, valid_subscr_count, found;
     char *data = NULL, *shm_data_ptr;
-    int ret = SR_ERR_OK, filter_valid;
+    const char *mod_diff_shm = NULL;
+    int ret = SR_ERR_OK, filter_valid, relock_fail, pruned = 0, async_done = 0;
     sr_lock_mode_t sub_lock = SR_LOCK_NONE;
-    struct lyd_node *diff;
     sr_data_t *edit_data;
     sr_error_t err_code = SR_ERR_OK;
     struct modsub_changesub_s *change_sub;
     sr_multi_sub_shm_t *multi_sub_shm;
-    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
+    sr_shm_t shm_diff = SR_SHM_INITIALIZER;
+    sr_sub_diff_ref_t diff_ref;
+    struct lyd_node *mod_diff = NULL, *sub_diff;
     sr_session_ctx_t *ev_sess = NULL;
     struct info_sub_s sub_info;
 
+#ifdef SR_EVENT_TRACE
+    uint64_t wake, cb_start = 0, cb_end = 0;
+#endif
+
     multi_sub_shm = (sr_multi_sub_shm_t *)change_subs->sub_shm.addr;
 
     for (i = 0; i < change_subs->sub_count; ++i) {
@@ -3373,11 +4659,16 @@ sr_shmsub_change_listen_process_module_events(struct modsub_change_s *change_sub
         goto cleanup;
     }
 
-    /* open sub data SHM */
-    if ((err_info = sr_shmsub_data_open_remap(change_subs->module_name, sr_ds2str(change_subs->ds), -1, &shm_data_sub, 0))) {
+#ifdef SR_EVENT_TRACE
+    wake = sr_event_trace_now();
+#endif
+
+    /* map sub data SHM */
+    if ((err_info = sr_shmsub_data_listen_map(change_subs->module_name, sr_ds2str(change_subs->ds), -1,
+            (sr_sub_shm_t *)multi_sub_shm, &change_subs->data_shm, &change_subs->data_gen))) {
         goto cleanup;
     }
-    shm_data_ptr = shm_data_sub.addr;
+    shm_data_ptr = change_subs->data_shm.addr;
 
     /* remember subscription info in SHM */
     sub_info.event = ATOMIC_LOAD_RELAXED(multi_sub_shm->event);
@@ -3389,17 +4680,30 @@ sr_shmsub_change_listen_process_module_events(struct modsub_change_s *change_sub
         goto cleanup;
     }
 
-    /* parse event diff */
-    if ((err_info = sr_lyd_parse_data(conn->ly_ctx, shm_data_ptr, NULL, LYD_LYB,
-            LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT | LYD_PARSE_ORDERED, 0, &diff))) {
-        SR_ERRINFO_INT(&err_info);
+    /* map the shared diff segment, it stays valid even if the originator removes it */
+    memcpy(&diff_ref, shm_data_ptr, sizeof diff_ref);
+    if ((err_info = sr_shmsub_change_listen_diff_open(&diff_ref, &shm_diff))) {
         goto cleanup;
     }
 
-    /* assign to session */
-    ev_sess->dt[ev_sess->ds].diff = diff;
+    /* parse the module diff unless all the subscriptions use a pruned diff, the diffs of other modules only when
+     * needed */
+    for (j = i; j < change_subs->sub_count; ++j) {
+        if (sr_shmsub_change_listen_is_new_event(multi_sub_shm, &change_subs->subs[j]) &&
+                (!(change_subs->subs[j].opts & SR_SUBSCR_FILTER_DIFF) || !change_subs->subs[j].xpath)) {
+            break;
+        }
+    }
+    if ((j < change_subs->sub_count) && (err_info = sr_shmsub_change_listen_diff_parse(conn->ly_ctx, shm_diff.addr,
+            change_subs->module_name, NULL, 0, &ev_sess->dt[ev_sess->ds].diff, NULL))) {
+        SR_ERRINFO_INT(&err_info);
+        goto cleanup;
+    }
+    ev_sess->ev_data.diff_shm = shm_diff.addr;
+    ev_sess->ev_data.diff_mod = change_subs->module_name;
 
     /* process event */
+    SR_PROBE(event__read, change_subs->module_name, (int)sub_info.event, sub_info.request_id);
     SR_LOG_INF("EV LISTEN: \"%s\" \"%s\" ID %" PRIu32 " priority %" PRIu32 " processing (remaining %" PRIu32 " subscribers).",
             change_subs->module_name, sr_ev2str(sub_info.event), sub_info.request_id, sub_info.priority,
             multi_sub_shm->subscriber_count);
@@ -3420,23 +4724,68 @@ process_event:
         sr_rwunlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, sub_lock, conn->cid, __func__);
         sub_lock = SR_LOCK_NONE;
 
+        if ((change_sub->opts & SR_SUBSCR_FILTER_DIFF) && change_sub->xpath) {
+            /* use the diff pruned for this subscription, it may have subscribed after the event was published */
+            sub_diff = NULL;
+            if ((err_info = sr_shmsub_change_listen_diff_parse(conn->ly_ctx, shm_diff.addr, change_subs->module_name,
+                    change_sub->xpath, 0, &sub_diff, &found)) || (!found &&
+                    (err_info = sr_shmsub_change_listen_diff_parse(conn->ly_ctx, shm_diff.addr,
+                    change_subs->module_name, NULL, 0, &sub_diff, NULL)))) {
+                lyd_free_all(sub_diff);
+                goto cleanup;
+            }
+
+            mod_diff = ev_sess->dt[ev_sess->ds].diff;
+            mod_diff_shm = ev_sess->ev_data.diff_shm;
+            ev_sess->dt[ev_sess->ds].diff = sub_diff;
+            ev_sess->ev_data.diff_shm = NULL;
+            pruned = 1;
+        } else if (change_sub->xpath) {
+            if ((err_info = sr_shmsub_change_listen_diff_complete(ev_sess, change_sub->xpath))) {
+                goto cleanup;
+            }
+        }
+
         /* call callback if there are some changes */
-        filter_valid = sr_shmsub_change_filter_is_valid(change_sub->xpath, diff);
+        filter_valid = sr_shmsub_change_filter_is_valid(change_sub->xpath, ev_sess->dt[ev_sess->ds].diff);
         if (filter_valid) {
+#ifdef SR_EVENT_TRACE
+            cb_start = sr_event_trace_now();
+#endif
             ret = change_sub->cb(ev_sess, change_sub->sub_id, change_subs->module_name, change_sub->xpath,
                     sr_ev2api(sub_info.event), sub_info.request_id, change_sub->private_data);
+#ifdef SR_EVENT_TRACE
+            cb_end = sr_event_trace_now();
+#endif
         } else if (!(change_sub->opts & SR_SUBSCR_FILTER_ORIG)) {
             /* filtered out (not by originator) */
             ATOMIC_INC_RELAXED(change_sub->filtered_out);
         }
 
         /* SUB READ LOCK */
-        if (sr_shmsub_change_listen_relock(multi_sub_shm, SR_LOCK_READ, &sub_info, change_sub,
-                change_subs->module_name, ret, filter_valid, ev_sess, &err_info)) {
+        relock_fail = sr_shmsub_change_listen_relock(multi_sub_shm, SR_LOCK_READ, &sub_info, change_sub,
+                change_subs->module_name, ret, filter_valid, ev_sess, &err_info);
+
+        if (pruned) {
+            /* back to the module diff */
+            lyd_free_all(ev_sess->dt[ev_sess->ds].diff);
+            ev_sess->dt[ev_sess->ds].diff = mod_diff;
+            ev_sess->ev_data.diff_shm = mod_diff_shm;
+            mod_diff = NULL;
+            pruned = 0;
+        }
+        if (relock_fail) {
             goto cleanup;
         }
         sub_lock = SR_LOCK_READ;
 
+#ifdef SR_EVENT_TRACE
+        if (filter_valid) {
+            sr_event_trace_callback(&multi_sub_shm->trace, change_sub->sub_id, SR_EVENT_STATS_CHANGE,
+                    change_subs->module_name, wake, cb_start, cb_end);
+        }
+#endif
+
         if (!filter_valid && (change_sub->opts & SR_SUBSCR_FILTER_ORIG)) {
             /* not a valid event for this subscription */
             continue;
@@ -3514,9 +4863,14 @@ process_event:
     }
     sub_lock = SR_LOCK_WRITE_URGE;
 
+    /* learn whether we are the last subscriber of an event the originator does not wait for */
+    async_done = (sub_info.event == SR_SUB_EV_DONE) && ATOMIC_LOAD_RELAXED(multi_sub_shm->async_done) &&
+            (multi_sub_shm->subscriber_count == valid_subscr_count);
+
     /* finish event */
-    if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, valid_subscr_count, err_code, &shm_data_sub, data,
-            data_len, change_subs->module_name, err_code ? "fail" : "success"))) {
+    if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, valid_subscr_count, err_code,
+            &change_subs->data_shm, data, data_len, change_subs->module_name, err_code ? "fail" : "success"))) {
+        async_done = 0;
         goto cleanup;
     }
 
@@ -3526,9 +4880,60 @@ cleanup:
         sr_rwunlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, sub_lock, conn->cid, __func__);
     }
 
+    if (async_done) {
+        /* the event is finished, release the diff segment reference of this module */
+        sr_shm_clear(&shm_diff);
+        sr_shmsub_change_diff_async_unref(&diff_ref, &shm_diff);
+    }
+
     free(data);
+    if (pruned) {
+        lyd_free_all(ev_sess->dt[ev_sess->ds].diff);
+        ev_sess->dt[ev_sess->ds].diff = mod_diff;
+    }
     sr_session_stop(ev_sess);
-    sr_shm_clear(&shm_data_sub);
+    sr_shm_clear(&shm_diff);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_shmsub_change_listen_sub_del(struct modsub_change_s *change_subs, uint32_t idx, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_multi_sub_shm_t *multi_sub_shm;
+    sr_sub_diff_ref_t diff_ref;
+    sr_shm_t shm_diff = SR_SHM_INITIALIZER;
+    int last = 0;
+
+    multi_sub_shm = (sr_multi_sub_shm_t *)change_subs->sub_shm.addr;
+    if (!ATOMIC_LOAD_RELAXED(multi_sub_shm->async_done)) {
+        /* no asynchronous event */
+        return NULL;
+    }
+
+    /* SUB WRITE LOCK */
+    if ((err_info = sr_rwlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
+            NULL, NULL))) {
+        return err_info;
+    }
+
+    if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) == SR_SUB_EV_DONE) &&
+            ATOMIC_LOAD_RELAXED(multi_sub_shm->async_done) &&
+            sr_shmsub_change_listen_is_new_event(multi_sub_shm, &change_subs->subs[idx])) {
+        /* the subscription is counted for the event but will never process it, finish it instead */
+        last = (multi_sub_shm->subscriber_count == 1);
+        diff_ref = multi_sub_shm->async_diff;
+        err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, 1, SR_ERR_OK, &change_subs->data_shm, NULL, 0,
+                change_subs->module_name, "abandoned");
+    }
+
+    /* SUB WRITE UNLOCK */
+    sr_rwunlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+
+    if (last && !err_info) {
+        /* the event is finished, release the diff segment reference of this module */
+        sr_shmsub_change_diff_async_unref(&diff_ref, &shm_diff);
+    }
     return err_info;
 }
 
@@ -3569,7 +4974,7 @@ sr_shmsub_listen_write_event(sr_sub_shm_t *sub_shm, sr_error_t err_code, sr_shm_
 
     if (data && data_len) {
         /* remap if needed */
-        if ((err_info = sr_shmsub_data_open_remap(NULL, NULL, -1, shm_data_sub, data_len))) {
+        if ((err_info = sr_shmsub_data_resize(sub_shm, shm_data_sub, data_len))) {
             return err_info;
         }
 
@@ -3633,9 +5038,12 @@ sr_shmsub_oper_get_listen_process_module_events(struct modsub_operget_s *oper_ge
     struct modsub_opergetsub_s *oper_get_sub;
     struct lyd_node *parent = NULL, *orig_parent, *node;
     sr_sub_shm_t *sub_shm;
-    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
     sr_session_ctx_t *ev_sess = NULL;
 
+#ifdef SR_EVENT_TRACE
+    uint64_t wake, cb_start, cb_end;
+#endif
+
     for (i = 0; (err_code == SR_ERR_OK) && (i < oper_get_subs->sub_count); ++i) {
         oper_get_sub = &oper_get_subs->subs[i];
         sub_shm = (sr_sub_shm_t *)oper_get_sub->sub_shm.addr;
@@ -3665,13 +5073,16 @@ sr_shmsub_oper_get_listen_process_module_events(struct modsub_operget_s *oper_ge
             continue;
         }
         request_id = ATOMIC_LOAD_RELAXED(sub_shm->request_id);
+#ifdef SR_EVENT_TRACE
+        wake = sr_event_trace_now();
+#endif
 
-        /* open sub data SHM */
-        if ((err_info = sr_shmsub_data_open_remap(oper_get_subs->module_name, "oper", sr_str_hash(oper_get_sub->path,
-                oper_get_sub->priority), &shm_data_sub, 0))) {
+        /* map sub data SHM */
+        if ((err_info = sr_shmsub_data_listen_map(oper_get_subs->module_name, "oper", sr_str_hash(oper_get_sub->path,
+                oper_get_sub->priority), sub_shm, &oper_get_sub->data_shm, &oper_get_sub->data_gen))) {
             goto error_rdunlock;
         }
-        shm_data_ptr = shm_data_sub.addr;
+        shm_data_ptr = oper_get_sub->data_shm.addr;
 
         /* parse originator name and data (while creating the event session) */
         if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_CHANGE, &shm_data_ptr, &ev_sess))) {
@@ -3683,6 +5094,10 @@ sr_shmsub_oper_get_listen_process_module_events(struct modsub_operget_s *oper_ge
         SR_CHECK_MEM_GOTO(!request_xpath, err_info, error_rdunlock);
         shm_data_ptr += sr_strshmlen(request_xpath);
 
+        /* parse max depth */
+        memcpy(&ev_sess->ev_data.oper_max_depth, shm_data_ptr, sizeof ev_sess->ev_data.oper_max_depth);
+        shm_data_ptr += SR_SHM_SIZE(sizeof ev_sess->ev_data.oper_max_depth);
+
         /* parse data parent */
         if ((err_info = sr_lyd_parse_data(conn->ly_ctx, shm_data_ptr, NULL, LYD_LYB, LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT,
                 0, &parent))) {
@@ -3698,13 +5113,20 @@ sr_shmsub_oper_get_listen_process_module_events(struct modsub_operget_s *oper_ge
         sr_rwunlock(&sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
 
         /* process event */
+        SR_PROBE(event__read, oper_get_sub->path, (int)SR_SUB_EV_OPER, request_id);
         SR_LOG_INF("EV LISTEN: \"%s\" \"%s\" ID %" PRIu32 " processing.", oper_get_sub->path, sr_ev2str(SR_SUB_EV_OPER),
                 request_id);
 
         /* call callback */
         orig_parent = parent;
+#ifdef SR_EVENT_TRACE
+        cb_start = sr_event_trace_now();
+#endif
         err_code = oper_get_sub->cb(ev_sess, oper_get_sub->sub_id, oper_get_subs->module_name, oper_get_sub->path,
                 request_xpath[0] ? request_xpath : NULL, request_id, &parent, oper_get_sub->private_data);
+#ifdef SR_EVENT_TRACE
+        cb_end = sr_event_trace_now();
+#endif
 
         /* go again to the top-level root for printing */
         if (parent) {
@@ -3752,8 +5174,13 @@ sr_shmsub_oper_get_listen_process_module_events(struct modsub_operget_s *oper_ge
             goto error;
         }
 
+#ifdef SR_EVENT_TRACE
+        sr_event_trace_callback(&sub_shm->trace, oper_get_sub->sub_id, SR_EVENT_STATS_OPER_GET,
+                oper_get_subs->module_name, wake, cb_start, cb_end);
+#endif
+
         /* finish event */
-        if ((err_info = sr_shmsub_listen_write_event(sub_shm, err_code, &shm_data_sub, data, data_len,
+        if ((err_info = sr_shmsub_listen_write_event(sub_shm, err_code, &oper_get_sub->data_shm, data, data_len,
                 oper_get_sub->path, err_code ? "fail" : "success"))) {
             goto error_wrunlock;
         }
@@ -3771,7 +5198,6 @@ next_iter:
         data = NULL;
         lyd_free_all(parent);
         parent = NULL;
-        sr_shm_clear(&shm_data_sub);
     }
 
     /* success */
@@ -3791,7 +5217,6 @@ error:
     free(data);
     lyd_free_all(parent);
     free(request_xpath);
-    sr_shm_clear(&shm_data_sub);
     return err_info;
 }
 
@@ -3890,11 +5315,77 @@ sr_shmsub_oper_poll_listen_is_cache_valid(const struct sr_oper_poll_cache_s *cac
     return 1;
 }
 
+/**
+ * @brief Evict the least recently used data cached by operational poll subscriptions until the caches fit their
+ * memory limit. Data used for generating the next diff are never evicted.
+ * CONN OPER CACHE READ lock is expected to be held, no CACHE DATA lock.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] cur Cache with the just polled data.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_oper_poll_cache_evict(sr_conn_ctx_t *conn, struct sr_oper_poll_cache_s *cur)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_oper_poll_cache_s *cache, *lru;
+    uint64_t total = 0;
+    uint32_t i, n;
+
+    /* the other caches are not locked so the sizes are approximate */
+    for (i = 0; i < conn->oper_cache_count; ++i) {
+        total += conn->oper_caches[i].size;
+    }
+
+    for (n = 0; (n < conn->oper_cache_count) && (total > conn->mem_limit[SR_CONN_MEM_OPER_CACHE]); ++n) {
+        /* find the least recently used data */
+        lru = NULL;
+        for (i = 0; i < conn->oper_cache_count; ++i) {
+            cache = &conn->oper_caches[i];
+            if (!cache->size || cache->hashes || (lru && (ATOMIC_LOAD_RELAXED(cache->last_use) >=
+                    ATOMIC_LOAD_RELAXED(lru->last_use)))) {
+                continue;
+            }
+            lru = cache;
+        }
+        if (!lru) {
+            break;
+        }
+
+        /* CACHE DATA WRITE LOCK */
+        if ((err_info = sr_rwlock(&lru->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid,
+                __func__, NULL, NULL))) {
+            return err_info;
+        }
+
+        /* the data may have been polled again meanwhile */
+        if (lru->size && !lru->hashes) {
+            if (lru == cur) {
+                SR_LOG_WRN("Operational poll data of \"%s\" (%" PRIu64 " B) exceed the cache memory limit, not cached.",
+                        cur->path, cur->size);
+            }
+
+            /* evict the data, they are read from the shared cache or the subscriber until the next poll */
+            lyd_free_siblings(lru->data);
+            lru->data = NULL;
+            total -= lru->size;
+            lru->size = 0;
+            lru->evicted = 1;
+            ATOMIC_INC_RELAXED(conn->cache_stats[SR_CONN_MEM_OPER_CACHE].evictions);
+        }
+
+        /* CACHE DATA WRITE UNLOCK */
+        sr_rwunlock(&lru->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+    }
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_poll_subs, sr_conn_ctx_t *conn,
         struct timespec *wake_up_in)
 {
-    sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
+    sr_error_info_t *err_info = NULL, *cb_err_info = NULL, *tmp_err;
     uint32_t i, j;
     sr_data_t *data = NULL;
     const struct lys_module *ly_mod;
@@ -3906,6 +5397,8 @@ sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_
     int found;
     sr_session_ctx_t *ev_sess = NULL;
     sr_get_options_t get_opts;
+    struct sr_subtree_hash_s *hashes = NULL;
+    uint32_t hash_count = 0;
 
     /* find LY module */
     ly_mod = ly_ctx_get_module_implemented(conn->ly_ctx, oper_poll_subs->module_name);
@@ -3966,7 +5459,13 @@ sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_
             /* free any previously cached data and timestamp */
             lyd_free_siblings(cache->data);
             cache->data = NULL;
+            free(cache->hashes);
+            cache->hashes = NULL;
+            cache->hash_count = 0;
             memset(&cache->timestamp, 0, sizeof cache->timestamp);
+            cache->size = 0;
+            cache->evicted = 0;
+            sr_conn_oper_cache_shm_remove(oper_poll_subs->module_name, oper_poll_sub->path);
 
             SR_LOG_INF("No oper get subscription \"%s\" to cache.", oper_poll_sub->path);
             goto finish_iter;
@@ -3999,9 +5498,19 @@ sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_
 
         /* generate diff if supported */
         if (oper_poll_sub->opts & SR_SUBSCR_OPER_POLL_DIFF) {
-            /* prepare mod info */
+            /* hashes of the new data, the hashes of the cached data are kept from the previous poll */
+            if ((err_info = sr_lyd_subtree_hashes(data->tree, &hashes, &hash_count))) {
+                goto finish_iter;
+            }
+            if (!cache->hashes && cache->data && (err_info = sr_lyd_subtree_hashes(cache->data, &cache->hashes,
+                    &cache->hash_count))) {
+                goto finish_iter;
+            }
+
+            /* prepare mod info, diff only the subtrees that changed */
             mod_info.data = cache->data;
-            if ((err_info = sr_lyd_diff_siblings(cache->data, data->tree, LYD_DIFF_DEFAULTS, &mod_info.diff))) {
+            if ((err_info = sr_modinfo_subtree_hash_diff(cache->data, cache->hashes, cache->hash_count, data->tree,
+                    hashes, hash_count, &mod_info.diff))) {
                 goto finish_iter;
             }
 
@@ -4021,16 +5530,32 @@ sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_
             }
         }
 
-        /* store in cache and update the timestamp */
+        /* store in cache with its hashes and update the timestamp */
         lyd_free_siblings(cache->data);
         cache->data = mod_info.data = NULL;
         if (data) {
             cache->data = mod_info.data = data->tree;
             data->tree = NULL;
         }
+        free(cache->hashes);
+        cache->hashes = hashes;
+        cache->hash_count = hash_count;
+        hashes = NULL;
+        hash_count = 0;
         sr_release_data(data);
         sr_realtime_get(&cache->timestamp);
 
+        /* share the data with other connections, they will ask the subscribers on failure */
+        if ((tmp_err = sr_conn_oper_cache_shm_publish(conn, oper_poll_subs->module_name, oper_poll_sub->path,
+                cache->data, &cache->timestamp, oper_poll_sub->valid_ms))) {
+            sr_errinfo_free(&tmp_err);
+        }
+
+        /* learn the size of the cached data for the memory limit */
+        cache->size = sr_lyd_mem_size(cache->data, NULL);
+        cache->evicted = 0;
+        ATOMIC_STORE_RELAXED(cache->last_use, ATOMIC_INC_RELAXED(conn->cache_tick) + 1);
+
         /* update when to wake up */
         invalid_in = sr_time_ts_add(NULL, oper_poll_sub->valid_ms);
         if (wake_up_in && (!wake_up_in->tv_sec || (sr_time_cmp(&invalid_in, wake_up_in) < 0))) {
@@ -4042,6 +5567,9 @@ sr_shmsub_oper_poll_listen_process_module_events(struct modsub_operpoll_s *oper_
 finish_iter:
         /* CACHE DATA WRITE UNLOCK */
         sr_rwunlock(&cache->data_lock, SR_CONN_OPER_CACHE_DATA_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__);
+        free(hashes);
+        hashes = NULL;
+        hash_count = 0;
 
         if (err_info) {
             goto cleanup_unlock;
@@ -4055,13 +5583,21 @@ finish_iter:
             sr_errinfo_free(&cb_err_info);
 
             /* publish "done" event */
-            if ((err_info = sr_shmsub_change_notify_change_done(&mod_info, NULL, NULL, SR_CHANGE_CB_TIMEOUT))) {
+            if ((err_info = sr_shmsub_change_notify_change_done(&mod_info, NULL, NULL, SR_CHANGE_CB_TIMEOUT, 0))) {
                 goto cleanup_unlock;
             }
 
             lyd_free_siblings(mod_info.diff);
             mod_info.diff = NULL;
         }
+
+        if (conn->mem_limit[SR_CONN_MEM_OPER_CACHE]) {
+            /* keep the caches within their memory limit, the cached data may be freed */
+            mod_info.data = NULL;
+            if ((err_info = sr_shmsub_oper_poll_cache_evict(conn, cache))) {
+                goto cleanup_unlock;
+            }
+        }
     }
 
 cleanup_unlock:
@@ -4108,7 +5644,7 @@ sr_shmsub_oper_poll_get_sub_change_notify_evpipe(sr_conn_ctx_t *conn, const char
     for (i = 0; i < shm_mod->oper_poll_sub_count; ++i) {
         if (!strcmp(oper_get_path, conn->ext_shm.addr + shm_subs[i].xpath)) {
             /* relevant oper get subscriptions change for this oper poll subscription */
-            if ((err_info = sr_shmsub_notify_evpipe(shm_subs[i].evpipe_num))) {
+            if ((err_info = sr_shmsub_notify_evpipe(conn, shm_subs[i].evpipe_num))) {
                 goto cleanup_opergetsub_ext_unlock;
             }
         }
@@ -4146,6 +5682,7 @@ sr_shmsub_rpc_listen_call_callback(struct opsub_rpcsub_s *rpc_sub, sr_session_ct
     const struct lyd_node *elem;
     void *mem;
     char buf[22], *val_str, *op_xpath = NULL;
+    struct sr_lyd_path_s path = {0};
     sr_val_t *input_vals = NULL, *output_vals = NULL;
     size_t i, input_val_count = 0, output_val_count = 0;
 
@@ -4185,7 +5722,7 @@ sr_shmsub_rpc_listen_call_callback(struct opsub_rpcsub_s *rpc_sub, sr_session_ct
                 }
                 input_vals = mem;
 
-                if ((err_info = sr_val_ly2sr(elem, &input_vals[input_val_count]))) {
+                if ((err_info = sr_val_ly2sr(elem, &path, &input_vals[input_val_count]))) {
                     goto cleanup;
                 }
 
@@ -4242,6 +5779,7 @@ fake_cb_error:
 
 cleanup:
     free(op_xpath);
+    sr_lyd_path_erase(&path);
     sr_free_values(input_vals, input_val_count);
     sr_free_values(output_vals, output_val_count);
     if (*err_code && *output_op) {
@@ -4257,11 +5795,12 @@ cleanup:
  *
  * @param[in] multi_sub_shm SHM to read from.
  * @param[in] sub Current subscription.
+ * @param[in] lane RPC/action lane of @p multi_sub_shm.
  * @return 0 if not.
  * @return non-zero if this is a new event for the subscription.
  */
 static int
-sr_shmsub_rpc_listen_is_new_event(sr_multi_sub_shm_t *multi_sub_shm, struct opsub_rpcsub_s *sub)
+sr_shmsub_rpc_listen_is_new_event(sr_multi_sub_shm_t *multi_sub_shm, struct opsub_rpcsub_s *sub, uint32_t lane)
 {
     sr_sub_event_t event = ATOMIC_LOAD_RELAXED(multi_sub_shm->event);
     uint32_t request_id = ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id);
@@ -4273,11 +5812,12 @@ sr_shmsub_rpc_listen_is_new_event(sr_multi_sub_shm_t *multi_sub_shm, struct opsu
     }
 
     /* new event and request ID */
-    if ((request_id == ATOMIC_LOAD_RELAXED(sub->request_id)) && (event == ATOMIC_LOAD_RELAXED(sub->event))) {
+    if ((request_id == ATOMIC_LOAD_RELAXED(sub->request_id[lane])) &&
+            (event == ATOMIC_LOAD_RELAXED(sub->event[lane]))) {
         return 0;
     }
-    if ((event == SR_SUB_EV_ABORT) && ((ATOMIC_LOAD_RELAXED(sub->event) != SR_SUB_EV_RPC) ||
-            (ATOMIC_LOAD_RELAXED(sub->request_id) != request_id))) {
+    if ((event == SR_SUB_EV_ABORT) && ((ATOMIC_LOAD_RELAXED(sub->event[lane]) != SR_SUB_EV_RPC) ||
+            (ATOMIC_LOAD_RELAXED(sub->request_id[lane]) != request_id))) {
         /* process "abort" only on subscriptions that have successfully processed "RPC" */
         return 0;
     }
@@ -4362,7 +5902,7 @@ sr_shmsub_rpc_listen_relock(sr_multi_sub_shm_t *multi_sub_shm, sr_lock_mode_t mo
 }
 
 sr_error_info_t *
-sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ctx_t *conn)
+sr_shmsub_rpc_listen_process_lane_events(struct opsub_rpc_s *rpc_subs, uint32_t lane, sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t i, data_len = 0, valid_subscr_count;
@@ -4372,15 +5912,18 @@ sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ct
     sr_error_t err_code = SR_ERR_OK, ret;
     struct opsub_rpcsub_s *rpc_sub = NULL;
     sr_multi_sub_shm_t *multi_sub_shm;
-    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
     sr_session_ctx_t *ev_sess = NULL;
     struct info_sub_s sub_info;
 
-    multi_sub_shm = (sr_multi_sub_shm_t *)rpc_subs->sub_shm.addr;
+#ifdef SR_EVENT_TRACE
+    uint64_t wake = 0, cb_start, cb_end;
+#endif
+
+    multi_sub_shm = (sr_multi_sub_shm_t *)rpc_subs->sub_shm[lane].addr;
 
     for (i = 0; i < rpc_subs->sub_count; ++i) {
         rpc_sub = &rpc_subs->subs[i];
-        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub)) {
+        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub, lane)) {
             /* no new event */
             continue;
         }
@@ -4395,19 +5938,23 @@ sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ct
         }
 
         /* recheck new event with lock */
-        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub)) {
+        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub, lane)) {
             continue;
         }
 
         /* there is a new event so there is some operation that can be parsed */
         if (!ev_sess) {
-            /* open sub data SHM */
+#ifdef SR_EVENT_TRACE
+            wake = sr_event_trace_now();
+#endif
+
+            /* map sub data SHM */
             module_name = sr_get_first_ns(rpc_subs->path);
-            if ((err_info = sr_shmsub_data_open_remap(module_name, "rpc", sr_str_hash(rpc_subs->path, 0),
-                    &shm_data_sub, 0))) {
+            if ((err_info = sr_shmsub_data_listen_map(module_name, "rpc", sr_str_hash(rpc_subs->path, lane),
+                    (sr_sub_shm_t *)multi_sub_shm, &rpc_subs->data_shm[lane], &rpc_subs->data_gen[lane]))) {
                 goto cleanup;
             }
-            shm_data_ptr = shm_data_sub.addr;
+            shm_data_ptr = rpc_subs->data_shm[lane].addr;
 
             /* parse originator name and data (while creating the event session) */
             if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_RPC, &shm_data_ptr, &ev_sess))) {
@@ -4444,6 +5991,7 @@ sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ct
     }
 
     /* process event */
+    SR_PROBE(event__read, rpc_subs->path, (int)sub_info.event, sub_info.request_id);
     SR_LOG_INF("EV LISTEN: \"%s\" \"%s\" ID %" PRIu32 " priority %" PRIu32 " processing (remaining %" PRIu32 " subscribers).",
             rpc_subs->path, sr_ev2str(sub_info.event), sub_info.request_id, sub_info.priority,
             multi_sub_shm->subscriber_count);
@@ -4454,7 +6002,7 @@ sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ct
 
     for ( ; i < rpc_subs->sub_count; ++i) {
         rpc_sub = &rpc_subs->subs[i];
-        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub) ||
+        if (!sr_shmsub_rpc_listen_is_new_event(multi_sub_shm, rpc_sub, lane) ||
                 !sr_shmsub_rpc_listen_filter_is_valid(input, rpc_sub->xpath)) {
             continue;
         }
@@ -4468,10 +6016,16 @@ process_event:
         lyd_free_all(output);
 
         /* call callback */
+#ifdef SR_EVENT_TRACE
+        cb_start = sr_event_trace_now();
+#endif
         if ((err_info = sr_shmsub_rpc_listen_call_callback(rpc_sub, ev_sess, input_op, sub_info.event,
                 sub_info.request_id, &output, &ret))) {
             goto cleanup;
         }
+#ifdef SR_EVENT_TRACE
+        cb_end = sr_event_trace_now();
+#endif
 
         /* SUB READ LOCK */
         if (sr_shmsub_rpc_listen_relock(multi_sub_shm, SR_LOCK_READ, &sub_info, rpc_sub, rpc_subs->path, ret,
@@ -4480,6 +6034,11 @@ process_event:
         }
         sub_lock = SR_LOCK_READ;
 
+#ifdef SR_EVENT_TRACE
+        sr_event_trace_callback(&multi_sub_shm->trace, rpc_sub->sub_id, SR_EVENT_STATS_RPC, module_name, wake,
+                cb_start, cb_end);
+#endif
+
         if (sub_info.event == SR_SUB_EV_RPC) {
             if (ret == SR_ERR_CALLBACK_SHELVE) {
                 /* processing was shelved, so interupt the whole RPC processing in order to get correct final output */
@@ -4493,8 +6052,8 @@ process_event:
                 err_code = ret;
 
                 /* remember request ID and "abort" event so that we do not process it */
-                ATOMIC_STORE_RELAXED(rpc_sub->request_id, ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id));
-                ATOMIC_STORE_RELAXED(rpc_sub->event, SR_SUB_EV_ABORT);
+                ATOMIC_STORE_RELAXED(rpc_sub->request_id[lane], ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id));
+                ATOMIC_STORE_RELAXED(rpc_sub->event[lane], SR_SUB_EV_ABORT);
                 break;
             }
         }
@@ -4503,8 +6062,8 @@ process_event:
         ++valid_subscr_count;
 
         /* remember request ID and event so that we do not process it again */
-        ATOMIC_STORE_RELAXED(rpc_sub->request_id, ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id));
-        ATOMIC_STORE_RELAXED(rpc_sub->event, ATOMIC_LOAD_RELAXED(multi_sub_shm->event));
+        ATOMIC_STORE_RELAXED(rpc_sub->request_id[lane], ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id));
+        ATOMIC_STORE_RELAXED(rpc_sub->event[lane], ATOMIC_LOAD_RELAXED(multi_sub_shm->event));
     }
 
     /*
@@ -4532,8 +6091,8 @@ process_event:
     sub_lock = SR_LOCK_WRITE_URGE;
 
     /* finish event */
-    if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, valid_subscr_count, err_code, &shm_data_sub, data,
-            data_len, rpc_subs->path, err_code ? "fail" : "success"))) {
+    if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, valid_subscr_count, err_code,
+            &rpc_subs->data_shm[lane], data, data_len, rpc_subs->path, err_code ? "fail" : "success"))) {
         goto cleanup;
     }
 
@@ -4548,28 +6107,49 @@ cleanup:
     free(data);
     lyd_free_all(input);
     lyd_free_all(output);
-    sr_shm_clear(&shm_data_sub);
     return err_info;
 }
 
+sr_error_info_t *
+sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc_subs, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t lane;
+
+    for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+        if ((err_info = sr_shmsub_rpc_listen_process_lane_events(rpc_subs, lane, conn))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Whether a notification is valid (not filtered out) for a notif subscription.
  *
- * @param[in] input Operation input data tree.
- * @param[in] xpath Full subscription XPath.
+ * @param[in] notif Notification data tree.
+ * @param[in] sub Notification subscription with the XPath and its compiled filter.
+ * @param[in] conn Connection to use.
  * @return 0 if not, non-zero is it is.
  */
 static int
-sr_shmsub_notif_listen_filter_is_valid(const struct lyd_node *notif, const char *xpath)
+sr_shmsub_notif_listen_filter_is_valid(const struct lyd_node *notif, struct modsub_notifsub_s *sub, sr_conn_ctx_t *conn)
 {
     sr_error_info_t *err_info = NULL;
     ly_bool result;
+    int match;
 
-    if (!xpath) {
+    if (!sub->xpath) {
         return 1;
     }
 
-    if (lyd_eval_xpath(notif, xpath, &result)) {
+    /* compiled filter bound to schema nodes, if the XPath is simple enough */
+    if (sub->filter && !sr_notif_filter_match(sub->filter, notif, conn->content_id, &match)) {
+        return match;
+    }
+
+    if (lyd_eval_xpath(notif, sub->xpath, &result)) {
         SR_ERRINFO_INT(&err_info);
         sr_errinfo_free(&err_info);
         return 0;
@@ -4581,69 +6161,102 @@ sr_shmsub_notif_listen_filter_is_valid(const struct lyd_node *notif, const char
     return 0;
 }
 
-sr_error_info_t *
-sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn)
-{
-    sr_error_info_t *err_info = NULL;
-    uint32_t i, request_id, valid_subscr_count;
-    struct lyd_node *orig_notif = NULL, *notif_dup = NULL, *notif, *notif_op;
-    struct sr_denied denied = {0};
-    struct timespec notif_ts_mono, notif_ts_real;
-    char *shm_data_ptr;
-    sr_multi_sub_shm_t *multi_sub_shm;
-    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
-    sr_session_ctx_t *ev_sess = NULL;
-    struct modsub_notifsub_s *sub;
-
-    multi_sub_shm = (sr_multi_sub_shm_t *)notif_subs->sub_shm.addr;
+/** whether a notification event request ID is newer than the last processed one, with wrap-around */
+#define SR_SHMSUB_NOTIF_IS_NEW(request_id, last_request_id) ((int32_t)((request_id) - (last_request_id)) > 0)
 
-    /* no new event */
-    if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) != SR_SUB_EV_NOTIF) ||
-            (ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id) == ATOMIC_LOAD_RELAXED(notif_subs->request_id))) {
-        goto cleanup;
+/**
+ * @brief Finish processing a notification event in a ring slot, free it if processed by all the subscribers.
+ * WRITE lock on the SHM must be held!
+ *
+ * @param[in] slot Notification subscription SHM ring slot.
+ * @param[in] valid_subscr_count Number of subscribers that processed the event.
+ * @param[in] module_name Module name for printing.
+ * @param[in] result_str Result of processing for printing.
+ */
+static void
+sr_shmsub_notif_listen_finish_slot(sr_notif_sub_slot_t *slot, uint32_t valid_subscr_count, const char *module_name,
+        const char *result_str)
+{
+    if (valid_subscr_count >= slot->subscriber_count) {
+        /* last subscriber finished, free the slot */
+        slot->subscriber_count = 0;
+        slot->orig_cid = 0;
+        ATOMIC_STORE_RELAXED(slot->event, SR_SUB_EV_NONE);
+    } else {
+        slot->subscriber_count -= valid_subscr_count;
     }
 
-    /* SUB READ LOCK */
-    if ((err_info = sr_rwlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__,
-            NULL, NULL))) {
-        goto cleanup;
-    }
+    SR_LOG_INF("EV LISTEN: \"%s\" \"notif\" ID %" PRIu32 " %s (remaining %" PRIu32 " subscribers).", module_name,
+            (uint32_t)ATOMIC_LOAD_RELAXED(slot->request_id), result_str, slot->subscriber_count);
+}
+
+/**
+ * @brief Find the ring slot with the oldest notification event not yet processed.
+ *
+ * @param[in] notif_shm Notification subscription SHM.
+ * @param[in] last_request_id Request ID of the last processed event.
+ * @return Index of the slot, -1 if there is none.
+ */
+static int
+sr_shmsub_notif_listen_next_slot(sr_notif_sub_shm_t *notif_shm, uint32_t last_request_id)
+{
+    uint32_t i, request_id, min_request_id = 0;
+    int slot_idx = -1;
 
-    /* recheck new event with lock */
-    if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) != SR_SUB_EV_NOTIF) ||
-            (ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id) == ATOMIC_LOAD_RELAXED(notif_subs->request_id))) {
-        goto cleanup_rdunlock;
-    }
-    request_id = ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id);
+    for (i = 0; i < SR_SUB_NOTIF_RING_SIZE; ++i) {
+        if (ATOMIC_LOAD_RELAXED(notif_shm->slots[i].event) != SR_SUB_EV_NOTIF) {
+            continue;
+        }
 
-    /* open sub data SHM */
-    if ((err_info = sr_shmsub_data_open_remap(notif_subs->module_name, "notif", -1, &shm_data_sub, 0))) {
-        goto cleanup_rdunlock;
-    }
-    shm_data_ptr = shm_data_sub.addr;
+        request_id = ATOMIC_LOAD_RELAXED(notif_shm->slots[i].request_id);
+        if (!SR_SHMSUB_NOTIF_IS_NEW(request_id, last_request_id)) {
+            /* already processed */
+            continue;
+        }
 
-    /* parse originator name and data (while creating the event session) */
-    if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_NOTIF, &shm_data_ptr, &ev_sess))) {
-        goto cleanup_rdunlock;
+        if ((slot_idx == -1) || SR_SHMSUB_NOTIF_IS_NEW(min_request_id, request_id)) {
+            /* older event */
+            slot_idx = i;
+            min_request_id = request_id;
+        }
     }
 
-    /* parse timestamps */
-    memcpy(&notif_ts_mono, shm_data_ptr, sizeof notif_ts_mono);
-    shm_data_ptr += sizeof notif_ts_mono;
-    memcpy(&notif_ts_real, shm_data_ptr, sizeof notif_ts_real);
-    shm_data_ptr += sizeof notif_ts_real;
+    return slot_idx;
+}
 
-    /* parse notification */
-    if ((err_info = sr_lyd_parse_op(conn->ly_ctx, shm_data_ptr, LYD_LYB, LYD_TYPE_NOTIF_YANG, &orig_notif))) {
-        SR_ERRINFO_INT(&err_info);
-        goto cleanup_rdunlock;
-    }
+/**
+ * @brief Pass a single notification of a notification event to all the module subscriptions.
+ *
+ * @param[in] notif_subs Module notification subscriptions.
+ * @param[in] ev_sess Event session to use.
+ * @param[in] orig_notif Notification, may be modified.
+ * @param[in] notif_ts_mono Notification monotonic timestamp.
+ * @param[in] notif_ts_real Notification realtime timestamp.
+ * @param[in] request_id Request ID of the event.
+ * @param[in] trace Event trace of the slot, used only with event tracing.
+ * @param[in] wake Timestamp when the event was noticed, used only with event tracing.
+ * @param[out] valid_subscr_count Number of subscribers that processed the notification.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notif_listen_process_notif(struct modsub_notif_s *notif_subs, sr_session_ctx_t *ev_sess,
+        struct lyd_node *orig_notif, const struct timespec *notif_ts_mono, const struct timespec *notif_ts_real,
+        uint32_t request_id, sr_sub_trace_t *trace, uint64_t wake, uint32_t *valid_subscr_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *notif_dup = NULL, *notif, *notif_op;
+    struct sr_denied denied = {0};
+    struct modsub_notifsub_s *sub;
+    uint32_t i;
 
-    /* SUB READ UNLOCK */
-    sr_rwunlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+#ifdef SR_EVENT_TRACE
+    uint64_t cb_start;
+#else
+    (void)trace;
+    (void)wake;
+#endif
 
-    /* process event */
-    valid_subscr_count = 0;
+    *valid_subscr_count = 0;
     for (i = 0; i < notif_subs->sub_count; ++i) {
         sub = &notif_subs->subs[i];
 
@@ -4652,12 +6265,13 @@ sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs,
             continue;
         }
 
-        if (!valid_subscr_count) {
+        if (!*valid_subscr_count) {
             /* Print a message only the first time we get here */
+            SR_PROBE(event__read, notif_subs->module_name, (int)SR_SUB_EV_NOTIF, request_id);
             SR_LOG_INF("EV LISTEN: \"%s\" \"notif\" ID %" PRIu32 " processing.", notif_subs->module_name, request_id);
         }
 
-        if (sr_time_cmp(&sub->listen_since_mono, &notif_ts_mono) > 0) {
+        if (sr_time_cmp(&sub->listen_since_mono, notif_ts_mono) > 0) {
             /* generated before this subscription has been made */
             SR_LOG_INF("EV LISTEN: \"%s\" \"notif\" ID %" PRIu32 " ignored, subscription created after the notification.",
                     notif_subs->module_name, request_id);
@@ -4702,19 +6316,27 @@ sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs,
         }
 
         /* NACM and xpath filter */
-        if (!denied.denied && sr_shmsub_notif_listen_filter_is_valid(notif_op, sub->xpath)) {
+        if (!denied.denied && sr_shmsub_notif_listen_filter_is_valid(notif_op, sub, ev_sess->conn)) {
             /* call callback */
+#ifdef SR_EVENT_TRACE
+            cb_start = sr_event_trace_now();
+#endif
             if ((err_info = sr_notif_call_callback(ev_sess, sub->cb, sub->tree_cb, sub->private_data,
-                    SR_EV_NOTIF_REALTIME, sub->sub_id, notif_op, &notif_ts_real))) {
+                    SR_EV_NOTIF_REALTIME, sub->sub_id, notif_op, notif_ts_real))) {
                 goto cleanup;
             }
+#ifdef SR_EVENT_TRACE
+            /* the slot is not reused until all the subscribers finish so its trace can be written without the lock */
+            sr_event_trace_callback(trace, sub->sub_id, SR_EVENT_STATS_NOTIF, notif_subs->module_name, wake,
+                    cb_start, sr_event_trace_now());
+#endif
         } else {
             /* filtered out */
             ATOMIC_INC_RELAXED(notif_subs->subs[i].filtered_out);
         }
 
         /* processed */
-        ++valid_subscr_count;
+        ++(*valid_subscr_count);
 
         if (!denied.denied) {
             /* may have been modified and is useless now */
@@ -4723,46 +6345,182 @@ sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs,
         }
     }
 
+cleanup:
+    free(denied.rule_name);
+    lyd_free_all(notif_dup);
+    return err_info;
+}
+
+/**
+ * @brief Process a single notification event in a ring slot, it may include several notifications.
+ *
+ * @param[in] notif_subs Module notification subscriptions.
+ * @param[in] conn Connection to use.
+ * @param[in] slot_idx Index of the ring slot with the event.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_notif_listen_process_slot(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn, uint32_t slot_idx)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i, request_id, valid_subscr_count = 0, notif_count, notif_lyb_len, parsed_count = 0;
+    struct lyd_node **orig_notifs = NULL;
+    struct timespec notif_ts_mono, notif_ts_real;
+    char *shm_data_ptr;
+    sr_notif_sub_shm_t *notif_shm;
+    sr_notif_sub_slot_t *slot;
+    sr_shm_t shm_data_sub = SR_SHM_INITIALIZER;
+    sr_session_ctx_t *ev_sess = NULL;
+    uint64_t wake = 0;
+
+    notif_shm = (sr_notif_sub_shm_t *)notif_subs->sub_shm.addr;
+    slot = &notif_shm->slots[slot_idx];
+
+    /* SUB READ LOCK */
+    if ((err_info = sr_rwlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__,
+            NULL, NULL))) {
+        goto cleanup;
+    }
+
+    /* recheck new event with lock */
+    if ((ATOMIC_LOAD_RELAXED(slot->event) != SR_SUB_EV_NOTIF) ||
+            !SR_SHMSUB_NOTIF_IS_NEW(ATOMIC_LOAD_RELAXED(slot->request_id), ATOMIC_LOAD_RELAXED(notif_subs->request_id))) {
+        goto cleanup_rdunlock;
+    }
+    request_id = ATOMIC_LOAD_RELAXED(slot->request_id);
+#ifdef SR_EVENT_TRACE
+    wake = sr_event_trace_now();
+#endif
+
+    /* open sub data SHM of the slot */
+    if ((err_info = sr_shmsub_data_open_remap(notif_subs->module_name, "notif", slot_idx, &shm_data_sub, 0))) {
+        goto cleanup_rdunlock;
+    }
+    shm_data_ptr = shm_data_sub.addr;
+
+    /* parse originator name and data (while creating the event session) */
+    if ((err_info = _sr_session_start(conn, SR_DS_OPERATIONAL, SR_SUB_EV_NOTIF, &shm_data_ptr, &ev_sess))) {
+        goto cleanup_rdunlock;
+    }
+
+    /* parse timestamps and the notification count */
+    memcpy(&notif_ts_mono, shm_data_ptr, sizeof notif_ts_mono);
+    shm_data_ptr += sizeof notif_ts_mono;
+    memcpy(&notif_ts_real, shm_data_ptr, sizeof notif_ts_real);
+    shm_data_ptr += sizeof notif_ts_real;
+    memcpy(&notif_count, shm_data_ptr, sizeof notif_count);
+    shm_data_ptr += sizeof notif_count;
+
+    orig_notifs = calloc(notif_count, sizeof *orig_notifs);
+    SR_CHECK_MEM_GOTO(!orig_notifs, err_info, cleanup_rdunlock);
+
+    /* parse all the notifications */
+    for (parsed_count = 0; parsed_count < notif_count; ++parsed_count) {
+        memcpy(&notif_lyb_len, shm_data_ptr, sizeof notif_lyb_len);
+        shm_data_ptr += sizeof notif_lyb_len;
+
+        if ((err_info = sr_lyd_parse_op(conn->ly_ctx, shm_data_ptr, LYD_LYB, LYD_TYPE_NOTIF_YANG,
+                &orig_notifs[parsed_count]))) {
+            SR_ERRINFO_INT(&err_info);
+            goto cleanup_rdunlock;
+        }
+        shm_data_ptr += notif_lyb_len;
+    }
+
+    /* SUB READ UNLOCK */
+    sr_rwunlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+
+    /* process event, all the notifications in the order they were generated */
+    for (i = 0; i < notif_count; ++i) {
+        if ((err_info = sr_shmsub_notif_listen_process_notif(notif_subs, ev_sess, orig_notifs[i], &notif_ts_mono,
+                &notif_ts_real, request_id, &slot->trace, wake, &valid_subscr_count))) {
+            goto cleanup;
+        }
+    }
+
     /* remember request ID so that we do not process it again */
     ATOMIC_STORE_RELAXED(notif_subs->request_id, request_id);
 
     /* SUB WRITE LOCK */
-    if ((err_info = sr_rwlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
+    if ((err_info = sr_rwlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
             NULL, NULL))) {
         goto cleanup;
     }
 
-    /* no error/timeout should be possible */
-    if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) != SR_SUB_EV_NOTIF) ||
-            (ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id) != ATOMIC_LOAD_RELAXED(notif_subs->request_id))) {
-        SR_ERRINFO_INT(&err_info);
-        goto cleanup_wrunlock;
-    }
-
-    /* finish event */
-    if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, valid_subscr_count, 0, &shm_data_sub, NULL, 0,
-            notif_subs->module_name, "success"))) {
-        goto cleanup_wrunlock;
+    /* the event could have been recovered meanwhile */
+    if ((ATOMIC_LOAD_RELAXED(slot->event) == SR_SUB_EV_NOTIF) && (ATOMIC_LOAD_RELAXED(slot->request_id) == request_id)) {
+        /* finish event */
+        sr_shmsub_notif_listen_finish_slot(slot, valid_subscr_count, notif_subs->module_name, "success");
     }
 
-cleanup_wrunlock:
     /* SUB WRITE UNLOCK */
-    sr_rwunlock(&multi_sub_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+    sr_rwunlock(&notif_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
     goto cleanup;
 
 cleanup_rdunlock:
     /* SUB READ UNLOCK */
-    sr_rwunlock(&multi_sub_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
+    sr_rwunlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_READ, conn->cid, __func__);
 
 cleanup:
-    free(denied.rule_name);
     sr_session_stop(ev_sess);
-    lyd_free_all(orig_notif);
-    lyd_free_all(notif_dup);
+    for (i = 0; i < parsed_count; ++i) {
+        lyd_free_all(orig_notifs[i]);
+    }
+    free(orig_notifs);
     sr_shm_clear(&shm_data_sub);
     return err_info;
 }
 
+sr_error_info_t *
+sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_notif_sub_shm_t *notif_shm;
+    int slot_idx;
+
+    notif_shm = (sr_notif_sub_shm_t *)notif_subs->sub_shm.addr;
+
+    /* process all the new events in the order they were written */
+    while ((slot_idx = sr_shmsub_notif_listen_next_slot(notif_shm, ATOMIC_LOAD_RELAXED(notif_subs->request_id))) > -1) {
+        if ((err_info = sr_shmsub_notif_listen_process_slot(notif_subs, conn, slot_idx))) {
+            break;
+        }
+    }
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_shmsub_notif_listen_ignore_events(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_notif_sub_shm_t *notif_shm;
+    sr_notif_sub_slot_t *slot;
+    uint32_t i;
+
+    notif_shm = (sr_notif_sub_shm_t *)notif_subs->sub_shm.addr;
+
+    /* SUB WRITE LOCK */
+    if ((err_info = sr_rwlock(&notif_shm->lock, SR_SUBSHM_LOCK_TIMEOUT, SR_LOCK_WRITE, conn->cid, __func__,
+            NULL, NULL))) {
+        return err_info;
+    }
+
+    for (i = 0; i < SR_SUB_NOTIF_RING_SIZE; ++i) {
+        slot = &notif_shm->slots[i];
+        if ((ATOMIC_LOAD_RELAXED(slot->event) == SR_SUB_EV_NOTIF) &&
+                SR_SHMSUB_NOTIF_IS_NEW(ATOMIC_LOAD_RELAXED(slot->request_id), ATOMIC_LOAD_RELAXED(notif_subs->request_id))) {
+            /* there is an event we were supposed to process, too late now, just ignore it */
+            sr_shmsub_notif_listen_finish_slot(slot, 1, notif_subs->module_name, "ignored");
+        }
+    }
+
+    /* SUB WRITE UNLOCK */
+    sr_rwunlock(&notif_shm->lock, 0, SR_LOCK_WRITE, conn->cid, __func__);
+
+    return NULL;
+}
+
 void
 sr_shmsub_notif_listen_module_get_stop_time_in(struct modsub_notif_s *notif_subs, struct timespec *wake_up_in)
 {
@@ -4849,28 +6607,63 @@ cleanup:
 }
 
 sr_error_info_t *
-sr_shmsub_notif_listen_module_replay(struct modsub_notif_s *notif_subs, sr_subscription_ctx_t *subscr)
+sr_shmsub_notif_listen_replay(sr_subscription_ctx_t *subscr)
 {
     sr_error_info_t *err_info = NULL;
+    struct modsub_notif_s *notif_subs;
     struct modsub_notifsub_s *notif_sub;
-    uint32_t i;
-
-    for (i = 0; i < notif_subs->sub_count; ++i) {
-        notif_sub = &notif_subs->subs[i];
-        if (!SR_TS_IS_ZERO(notif_sub->start_time) && !notif_sub->replayed) {
-            /* we need to perform the requested replay */
-            if ((err_info = sr_replay_notify(subscr->conn, notif_subs->module_name, notif_sub->sub_id, notif_sub->xpath,
-                    &notif_sub->start_time, &notif_sub->stop_time, &notif_sub->listen_since_real, notif_sub->cb,
-                    notif_sub->tree_cb, notif_sub->private_data))) {
-                return err_info;
+    struct sr_replay_req_s *reqs = NULL, *req;
+    uint32_t i, j, req_count = 0;
+
+    /* collect all the requested replays of all the modules */
+    for (i = 0; i < subscr->notif_sub_count; ++i) {
+        notif_subs = &subscr->notif_subs[i];
+        for (j = 0; j < notif_subs->sub_count; ++j) {
+            notif_sub = &notif_subs->subs[j];
+            if (SR_TS_IS_ZERO(notif_sub->start_time) || notif_sub->replayed) {
+                continue;
             }
 
-            /* all notifications were replayed and it is now a standard subscription */
-            notif_sub->replayed = 1;
+            req = sr_realloc(reqs, (req_count + 1) * sizeof *reqs);
+            SR_CHECK_MEM_GOTO(!req, err_info, cleanup);
+            reqs = req;
+
+            req = &reqs[req_count];
+            req->mod_name = notif_subs->module_name;
+            req->sub_id = notif_sub->sub_id;
+            req->xpath = notif_sub->xpath;
+            req->start_time = &notif_sub->start_time;
+            req->stop_time = &notif_sub->stop_time;
+            req->listen_since = &notif_sub->listen_since_real;
+            req->cb = notif_sub->cb;
+            req->tree_cb = notif_sub->tree_cb;
+            req->private_data = notif_sub->private_data;
+            ++req_count;
         }
     }
+    if (!req_count) {
+        goto cleanup;
+    }
 
-    return NULL;
+    /* perform the replay of all the subscriptions at once so that the notifications are ordered across modules */
+    if ((err_info = sr_replay_notify(subscr->conn, reqs, req_count))) {
+        goto cleanup;
+    }
+
+    /* all notifications were replayed and they are now standard subscriptions */
+    for (i = 0; i < subscr->notif_sub_count; ++i) {
+        notif_subs = &subscr->notif_subs[i];
+        for (j = 0; j < notif_subs->sub_count; ++j) {
+            notif_sub = &notif_subs->subs[j];
+            if (!SR_TS_IS_ZERO(notif_sub->start_time)) {
+                notif_sub->replayed = 1;
+            }
+        }
+    }
+
+cleanup:
+    free(reqs);
+    return err_info;
 }
 
 void *
@@ -4940,3 +6733,199 @@ error:
     pthread_detach(pthread_self());
     return NULL;
 }
+
+/**
+ * @brief Process new events of the module subscriptions handled by a worker thread.
+ *
+ * @param[in] worker Worker thread.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_listen_worker_process_events(struct sr_subscr_worker_s *worker)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_subscription_ctx_t *subscr = worker->subscr;
+    sr_lock_mode_t ctx_mode = SR_LOCK_NONE;
+    uint32_t i, lane, n = 0;
+
+    /* SUBS READ LOCK */
+    if ((err_info = sr_rwlock(&subscr->subs_lock, SR_SUBSCR_LOCK_TIMEOUT, SR_LOCK_READ, subscr->conn->cid, __func__,
+            NULL, NULL))) {
+        return err_info;
+    }
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(subscr->conn, SR_LOCK_READ, 0, __func__))) {
+        goto cleanup_unlock;
+    }
+    ctx_mode = SR_LOCK_READ;
+
+    /* module subscriptions are distributed among the workers, each is always handled by a single one */
+    for (i = 0; i < subscr->change_sub_count; ++i, ++n) {
+        if ((n % subscr->worker_count) != worker->idx) {
+            continue;
+        }
+        if ((err_info = sr_shmsub_change_listen_process_module_events(&subscr->change_subs[i], subscr->conn))) {
+            goto cleanup_unlock;
+        }
+    }
+    for (i = 0; i < subscr->oper_get_sub_count; ++i, ++n) {
+        if ((n % subscr->worker_count) != worker->idx) {
+            continue;
+        }
+        if ((err_info = sr_shmsub_oper_get_listen_process_module_events(&subscr->oper_get_subs[i], subscr->conn))) {
+            goto cleanup_unlock;
+        }
+    }
+    for (i = 0; i < subscr->rpc_sub_count; ++i) {
+        /* RPC/action lanes are independent so several events of a single operation can be processed at once */
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane, ++n) {
+            if ((n % subscr->worker_count) != worker->idx) {
+                continue;
+            }
+            if ((err_info = sr_shmsub_rpc_listen_process_lane_events(&subscr->rpc_subs[i], lane, subscr->conn))) {
+                goto cleanup_unlock;
+            }
+        }
+    }
+
+cleanup_unlock:
+    if (ctx_mode) {
+        /* CONTEXT UNLOCK */
+        sr_lycc_unlock(subscr->conn, ctx_mode, 0, __func__);
+    }
+
+    /* SUBS READ UNLOCK */
+    sr_rwunlock(&subscr->subs_lock, SR_SUBSCR_LOCK_TIMEOUT, SR_LOCK_READ, subscr->conn->cid, __func__);
+
+    return err_info;
+}
+
+/**
+ * @brief Worker thread of a subscription structure.
+ *
+ * @param[in] arg Pointer to the worker structure.
+ * @return Always NULL.
+ */
+static void *
+sr_shmsub_listen_worker_thread(void *arg)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_subscr_worker_s *worker = (struct sr_subscr_worker_s *)arg;
+    sr_subscription_ctx_t *subscr = worker->subscr;
+    uint32_t gen = 0;
+    int r, running, retry = 0;
+
+    while (1) {
+        /* MUTEX LOCK */
+        if ((r = pthread_mutex_lock(&subscr->worker_lock.mutex))) {
+            SR_ERRINFO_LOCK(&err_info, __func__, r);
+            break;
+        }
+
+        /* wait for new events */
+        r = 0;
+        while (!r && subscr->worker_running && !retry && (gen == subscr->worker_gen)) {
+            /* COND WAIT */
+            r = sr_cond_wait(&subscr->worker_lock.cond, &subscr->worker_lock.mutex);
+        }
+        gen = subscr->worker_gen;
+        running = subscr->worker_running;
+
+        /* MUTEX UNLOCK */
+        pthread_mutex_unlock(&subscr->worker_lock.mutex);
+
+        if (r) {
+            SR_ERRINFO_COND(&err_info, __func__, r);
+            break;
+        } else if (!running) {
+            break;
+        }
+
+        /* process the new events */
+        err_info = sr_shmsub_listen_worker_process_events(worker);
+
+        /* on time out try again to actually process the current event because unless another event is generated,
+         * the workers will not get woken up, other errors were logged and do not stop the worker */
+        retry = (err_info && (err_info->err[0].err_code == SR_ERR_TIME_OUT));
+        sr_errinfo_free(&err_info);
+    }
+
+    sr_errinfo_free(&err_info);
+    return NULL;
+}
+
+sr_error_info_t *
+sr_shmsub_listen_workers_start(sr_subscription_ctx_t *subscr, uint32_t count)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    int r;
+
+    assert(!subscr->workers);
+
+    subscr->workers = calloc(count, sizeof *subscr->workers);
+    SR_CHECK_MEM_RET(!subscr->workers, err_info);
+    subscr->worker_count = count;
+    subscr->worker_running = 1;
+
+    for (i = 0; i < count; ++i) {
+        subscr->workers[i].subscr = subscr;
+        subscr->workers[i].idx = i;
+        if ((r = pthread_create(&subscr->workers[i].tid, NULL, sr_shmsub_listen_worker_thread, &subscr->workers[i]))) {
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Creating a new thread failed (%s).", strerror(r));
+
+            /* join only the started workers */
+            subscr->worker_count = i;
+            sr_errinfo_merge(&err_info, sr_shmsub_listen_workers_stop(subscr));
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+void
+sr_shmsub_listen_workers_wake(sr_subscription_ctx_t *subscr)
+{
+    /* MUTEX LOCK */
+    pthread_mutex_lock(&subscr->worker_lock.mutex);
+
+    ++subscr->worker_gen;
+    sr_cond_broadcast(&subscr->worker_lock.cond);
+
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&subscr->worker_lock.mutex);
+}
+
+sr_error_info_t *
+sr_shmsub_listen_workers_stop(sr_subscription_ctx_t *subscr)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    int r;
+
+    if (!subscr->workers) {
+        return NULL;
+    }
+
+    /* MUTEX LOCK */
+    pthread_mutex_lock(&subscr->worker_lock.mutex);
+
+    subscr->worker_running = 0;
+    sr_cond_broadcast(&subscr->worker_lock.cond);
+
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&subscr->worker_lock.mutex);
+
+    for (i = 0; i < subscr->worker_count; ++i) {
+        if ((r = pthread_join(subscr->workers[i].tid, NULL))) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Joining the worker thread failed (%s).", strerror(r));
+        }
+    }
+
+    free(subscr->workers);
+    subscr->workers = NULL;
+    subscr->worker_count = 0;
+    return err_info;
+}
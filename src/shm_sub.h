@@ -91,13 +91,25 @@ sr_error_info_t *sr_shmsub_data_create(const char *name, const char *suffix1, in
  */
 sr_error_info_t *sr_shmsub_data_unlink(const char *name, const char *suffix1, int64_t suffix2);
 
+/**
+ * @brief Remove a shared diff segment created for change events.
+ *
+ * @param[in] cid CID of the connection that created the segment.
+ * @param[in,out] diff_id Diff segment ID, is set to 0. Nothing is done if already 0.
+ */
+void sr_shmsub_change_notify_diff_remove(sr_cid_t cid, uint32_t *diff_id);
+
 /**
  * @brief Write into a subscriber event pipe to notify it there is a new event.
  *
+ * The pipe is kept opened in the connection cache, if permitted, for the next notifications. A full pipe
+ * means there are unread wakeups and is not an error.
+ *
+ * @param[in] conn Connection to use.
  * @param[in] evpipe_num Subscriber event pipe number.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmsub_notify_evpipe(uint32_t evpipe_num);
+sr_error_info_t *sr_shmsub_notify_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num);
 
 /**
  * @brief Notify about (generate) a change "update" event.
@@ -141,10 +153,12 @@ sr_error_info_t *sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info,
  * @param[in] orig_name Event originator name.
  * @param[in] orig_data Event originator data.
  * @param[in] timeout_ms Change callback timeout in milliseconds. Set to 0 if the event should not be waited for.
+ * @param[in] async Whether not to wait for the last priority of the subscribers, they finish the event on their own
+ * and any following event on their subscriptions waits for it.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, const char *orig_name,
-        const void *orig_data, uint32_t timeout_ms);
+        const void *orig_data, uint32_t timeout_ms, int async);
 
 /**
  * @brief Notify about (generate) a change "abort" event.
@@ -159,25 +173,36 @@ sr_error_info_t *sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_
         const void *orig_data, uint32_t timeout_ms);
 
 /**
- * @brief Notify about (generate) an operational get event.
+ * @brief Operational get request for a single subscription XPath.
+ */
+struct sr_shmsub_oper_get_req_s {
+    uint32_t idx1;                  /**< Index of the subscription array where subscriptions with the XPath are. */
+    const char *xpath;              /**< Subscription XPath. */
+    const char *request_xpath;      /**< Requested XPath, NULL if not known. */
+    const struct lyd_node *parent;  /**< Existing parent to append the data to, NULL for top-level data. */
+    uint32_t max_depth;             /**< Maximum depth of the requested data relative to the subscription nodes,
+                                         0 if unlimited. */
+    struct lyd_node *data;          /**< Data provided by the subscribers. */
+    sr_error_info_t *cb_err_info;   /**< Callback error information generated by the subscribers, if any. */
+};
+
+/**
+ * @brief Notify about (generate) operational get events for several subscription XPaths at once and wait for
+ * all the replies.
  *
  * @param[in] mod Modinfo structure.
- * @param[in] xpath Subscription XPath.
- * @param[in] request_xpath Requested XPath.
- * @param[in] parent Existing parent to append the data to.
+ * @param[in,out] reqs Requests with distinct subscription XPaths, their data and callback errors are set.
+ * @param[in] req_count Count of @p reqs.
  * @param[in] orig_name Event originator name.
  * @param[in] orig_data Event originator data.
  * @param[in] oper_get_subs An array of operational get subscriptions.
- * @param[in] idx1 Index of the array where operational subscriptions with the same XPath are.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
  * @param[in] conn Connection.
- * @param[out] data Data provided by the subscriber.
- * @param[out] cb_err_info Callback error information generated by a subscriber, if any.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, const char *xpath, const char *request_xpath,
-        const struct lyd_node *parent, const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *oper_get_subs,
-        uint32_t idx1, uint32_t timeout_ms, sr_conn_ctx_t *conn, struct lyd_node **data, sr_error_info_t **cb_err_info);
+sr_error_info_t *sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, struct sr_shmsub_oper_get_req_s *reqs,
+        uint32_t req_count, const char *orig_name, const void *orig_data, sr_mod_oper_get_sub_t *oper_get_subs,
+        uint32_t timeout_ms, sr_conn_ctx_t *conn);
 
 /**
  * @brief Notify about (generate) an RPC/action event.
@@ -194,12 +219,14 @@ sr_error_info_t *sr_shmsub_oper_get_notify(struct sr_mod_info_mod_s *mod, const
  * @param[in] timeout_ms RPC/action callback timeout in milliseconds.
  * @param[in,out] request_id Generated request ID, set to 0 when passing.
  * @param[out] output Operation output returned by the last subscriber on success.
+ * @param[out] output_trusted Whether the last subscriber is trusted to return valid @p output
+ * (::SR_SUBSCR_RPC_TRUSTED).
  * @param[out] cb_err_info Callback error information generated by a subscriber, if any.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, off_t *subs, uint32_t *sub_count,
         const char *path, const struct lyd_node *input, const char *orig_name, const void *orig_data, uint32_t timeout_ms,
-        uint32_t *request_id, struct lyd_node **output, sr_error_info_t **cb_err_info);
+        uint32_t *request_id, struct lyd_node **output, int *output_trusted, sr_error_info_t **cb_err_info);
 
 /**
  * @brief Notify about (generate) an RPC/action abort event.
@@ -236,6 +263,24 @@ sr_error_info_t *sr_shmsub_rpc_notify_abort(sr_conn_ctx_t *conn, sr_rwlock_t *su
 sr_error_info_t *sr_shmsub_notif_notify(sr_conn_ctx_t *conn, const struct lyd_node *notif, struct timespec notif_ts_mono,
         struct timespec notif_ts_real, const char *orig_name, const void *orig_data, uint32_t timeout_ms, int wait);
 
+/**
+ * @brief Notify about (generate) several notifications of a single module in one notification event.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] notifs Notification data trees.
+ * @param[in] notif_count Count of @p notifs.
+ * @param[in] notif_ts_mono Monotonic timestamp of all the notifications.
+ * @param[in] notif_ts_real Realtime timestamp of all the notifications.
+ * @param[in] orig_name Event originator name.
+ * @param[in] orig_data Event originator data.
+ * @param[in] timeout_ms Notification callback timeout in milliseconds. Used only if @p wait is set.
+ * @param[in] wait Whether to wait for the callbacks or not.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_notif_notify_batch(sr_conn_ctx_t *conn, const struct lyd_node **notifs, uint32_t notif_count,
+        struct timespec notif_ts_mono, struct timespec notif_ts_real, const char *orig_name, const void *orig_data,
+        uint32_t timeout_ms, int wait);
+
 /**
  * @brief Write the result of having processed a multi-subscriber event.
  *
@@ -264,6 +309,30 @@ sr_error_info_t *sr_shmsub_multi_listen_write_event(sr_multi_sub_shm_t *multi_su
  */
 sr_error_info_t *sr_shmsub_change_listen_process_module_events(struct modsub_change_s *change_subs, sr_conn_ctx_t *conn);
 
+/**
+ * @brief Finish a pending asynchronous "done" event for a change subscription being removed, it would never
+ * be processed and the event never cleared otherwise.
+ *
+ * @param[in] change_subs Module change subscriptions.
+ * @param[in] idx Index of the removed subscription in @p change_subs.
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_change_listen_sub_del(struct modsub_change_s *change_subs, uint32_t idx,
+        sr_conn_ctx_t *conn);
+
+/**
+ * @brief Parse the diffs of all the other modules of a change event session, if not done yet.
+ *
+ * Change event sessions initially include only the diff of the subscribed module.
+ *
+ * @param[in] session Change event session.
+ * @param[in] xpath Optional XPath to be evaluated on the diff, nothing is parsed if it can select only
+ * the subscribed module data.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_change_listen_diff_complete(sr_session_ctx_t *session, const char *xpath);
+
 /**
  * @brief Write into evpipe of relevant operational poll subscriptions on an operational get subscription change (added/removed).
  *
@@ -297,7 +366,18 @@ sr_error_info_t *sr_shmsub_oper_poll_listen_process_module_events(struct modsub_
         sr_conn_ctx_t *conn, struct timespec *wake_up_in);
 
 /**
- * @brief Process all RPC/action events for one RPC/action, if any.
+ * @brief Process all RPC/action events in one lane of one RPC/action, if any.
+ *
+ * @param[in] rpc_sub RPC/action subscriptions.
+ * @param[in] lane RPC/action lane to process.
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_rpc_listen_process_lane_events(struct opsub_rpc_s *rpc_subs, uint32_t lane,
+        sr_conn_ctx_t *conn);
+
+/**
+ * @brief Process all RPC/action events for one RPC/action in all its lanes, if any.
  *
  * @param[in] rpc_sub RPC/action subscriptions.
  * @param[in] conn Connection to use.
@@ -314,6 +394,15 @@ sr_error_info_t *sr_shmsub_rpc_listen_process_rpc_events(struct opsub_rpc_s *rpc
  */
 sr_error_info_t *sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn);
 
+/**
+ * @brief Ignore all the pending module notification events of a removed subscription.
+ *
+ * @param[in] notif_subs Module notification subscriptions.
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_notif_listen_ignore_events(struct modsub_notif_s *notif_subs, sr_conn_ctx_t *conn);
+
 /**
  * @brief Get nearest stop time of a subscription, if any.
  *
@@ -335,13 +424,12 @@ sr_error_info_t *sr_shmsub_notif_listen_module_stop_time(uint32_t notif_subs_idx
         sr_subscription_ctx_t *subscr, int *module_finished);
 
 /**
- * @brief Check notification subscription replay state and perform it if requested.
+ * @brief Check notification subscriptions replay state of all the modules and perform it if requested.
  *
- * @param[in] notif_subs Module notification subscriptions.
  * @param[in] subscr Subscriptions structure.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmsub_notif_listen_module_replay(struct modsub_notif_s *notif_subs, sr_subscription_ctx_t *subscr);
+sr_error_info_t *sr_shmsub_notif_listen_replay(sr_subscription_ctx_t *subscr);
 
 /**
  * @brief Listener handler thread of all subscriptions.
@@ -351,4 +439,28 @@ sr_error_info_t *sr_shmsub_notif_listen_module_replay(struct modsub_notif_s *not
  */
 void *sr_shmsub_listen_thread(void *arg);
 
+/**
+ * @brief Start the worker threads of a subscription structure.
+ *
+ * @param[in] subscr Subscription structure.
+ * @param[in] count Worker thread count.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_listen_workers_start(sr_subscription_ctx_t *subscr, uint32_t count);
+
+/**
+ * @brief Wake the worker threads of a subscription structure to process new events.
+ *
+ * @param[in] subscr Subscription structure.
+ */
+void sr_shmsub_listen_workers_wake(sr_subscription_ctx_t *subscr);
+
+/**
+ * @brief Stop and join the worker threads of a subscription structure, if any.
+ *
+ * @param[in] subscr Subscription structure.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_listen_workers_stop(sr_subscription_ctx_t *subscr);
+
 #endif /* _SHM_SUB_H */
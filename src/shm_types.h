@@ -25,7 +25,7 @@
 #include "common_types.h"
 #include "sysrepo_types.h"
 
-#define SR_SHM_VER 17   /**< Main, mod, and ext SHM version of their expected content structures. */
+#define SR_SHM_VER 35   /**< Main, mod, and ext SHM version of their expected content structures. */
 #define SR_MAIN_SHM_LOCK "sr_main_lock"     /**< Main SHM file lock name. */
 
 /**
@@ -121,6 +121,10 @@ typedef struct {
     char rev[11];               /**< Module revision. */
     int replay_supp;            /**< Whether module supports replay. */
     uint32_t run_cache_id;      /**< Running cached data ID. */
+    ATOMIC_T run_inherit;       /**< Whether running data still inherit startup data after boot and are copied from
+                                     them on the first access. */
+    ATOMIC_T oper_slots;        /**< Whether the operational value slots SHM of the module may exist. */
+    uint32_t ds_cache_id[SR_DS_READ_COUNT]; /**< Cached data ID of the other datastores (::SR_CONN_CACHE_DS). */
     off_t plugins[SR_MOD_DS_PLUGIN_COUNT];  /**< Module plugin names (offsets in mod SHM). */
 
     off_t features;             /**< Array of enabled features (off_t *) (offset in mod SHM). */
@@ -134,12 +138,16 @@ typedef struct {
     uint16_t dep_count;         /**< Number of module data dependencies. */
     off_t inv_deps;             /**< Array of inverse module data dependencies (off_t *) (offset in mod SHM). */
     uint16_t inv_dep_count;     /**< Number of inverse module data dependencies. */
+    off_t schema_deps;          /**< Array of augmenting or deviating modules (off_t *) (offset in mod SHM). */
+    uint16_t schema_dep_count;  /**< Number of schema dependencies. */
 
     struct {
         sr_rwlock_t lock;       /**< Process-shared lock for reading or preventing changes (READ) or modifying (WRITE)
                                      change subscriptions. */
         off_t subs;             /**< Array of change subscriptions (offset in ext SHM). */
         uint32_t sub_count;     /**< Number of change subscriptions. */
+        ATOMIC_T gen;           /**< Generation of the change subscriptions, incremented whenever one is added,
+                                     modified, or removed. */
     } change_sub[SR_DS_COUNT];  /**< Change subscriptions for each datastore. */
 
     sr_rwlock_t oper_get_lock;  /**< Process-shared lock for reading or preventing changes (READ) or modifying (WRITE)
@@ -168,8 +176,27 @@ typedef struct {
  */
 typedef struct {
     uint32_t mod_count;         /**< Number of installed modules stored after this structure. */
+
+    off_t mod_index;            /**< Hash index of modules by their name, array of module offsets (off_t *) with
+                                     0 for free slots (offset in mod SHM), 0 if not built yet. */
+    uint32_t mod_index_size;    /**< Number of slots in the module hash index, power of 2. */
+    off_t rpc_index;            /**< Hash index of RPCs/actions of all the modules by their path, array of RPC
+                                     offsets (off_t *) with 0 for free slots (offset in mod SHM), 0 if not built yet. */
+    uint32_t rpc_index_size;    /**< Number of slots in the RPC hash index, power of 2. */
 } sr_mod_shm_t;
 
+/** number of slots in the connection aliveness registry */
+#define SR_CONN_REG_SIZE 1024
+
+/**
+ * @brief Connection aliveness registry slot, shares the result of the last lockfile check of a connection.
+ */
+typedef struct {
+    ATOMIC_T cid;               /**< CID of the connection found alive, 0 for a free slot. */
+    ATOMIC_T pid;               /**< PID of the process of the connection. */
+    ATOMIC_T check_ms;          /**< Monotonic time (ms, truncated) of the last lockfile check. */
+} sr_conn_reg_slot_t;
+
 /**
  * @brief Main SHM structure.
  */
@@ -181,7 +208,12 @@ typedef struct {
     sr_rwlock_t context_lock;   /**< Process-shared lock for accessing connection LY context, lydmods data,
                                      and SHM mod modules. */
     pthread_mutex_t lydmods_lock;   /**< Process-shared lock for modifying SR internal module data. */
-    uint32_t content_id;        /**< Context content ID of the latest context. */
+    ATOMIC_T content_id;        /**< Context content ID of the latest context, published only after the new
+                                     context content (mod SHM, lydmods data) is fully stored. Stored with release
+                                     and loaded with acquire semantics so that a process seeing a new ID also sees
+                                     the content, which is otherwise also ordered by the context lock held WRITE by
+                                     the publisher and READ by the readers. It only detects a context change, there
+                                     is no handoff of the old context so readers still wait for the whole change. */
 
     ATOMIC_T new_sr_cid;        /**< Connection ID for a new connection. */
     ATOMIC_T new_sr_sid;        /**< SID for a new session. */
@@ -189,6 +221,16 @@ typedef struct {
     ATOMIC_T new_evpipe_num;    /**< Event pipe number for a new subscription. */
 
     char repo_path[256];        /**< Repository path used when main SHM was created. */
+
+    struct sr_main_ds_lock_s {
+        pthread_mutex_t lock;   /**< Process-shared lock for changing the datastore lock information. */
+        ATOMIC_T sid;           /**< SID of the datastore lock of all the modules (NETCONF lock of the whole
+                                     datastore), checked alongside DS locks of the modules. If 0, it is not held. */
+        struct timespec ts;     /**< Timestamp of the datastore lock. */
+    } ds_lock[SR_DS_COUNT];     /**< Datastore lock of all the modules for each datastore. */
+
+    sr_conn_reg_slot_t conn_reg[SR_CONN_REG_SIZE];  /**< Connection aliveness registry, slot of a CID is
+                                                         CID % ::SR_CONN_REG_SIZE. */
 } sr_main_shm_t;
 
 /**
@@ -273,13 +315,92 @@ typedef struct {
     sr_cid_t cid;               /**< Connection ID. */
 } sr_mod_rpc_sub_t;
 
+/** number of ext SHM memory hole size classes, the last class holds all the larger holes */
+#define SR_EXT_HOLE_CLASS_COUNT 16
+
 /**
  * @brief Ext SHM structure.
  */
 typedef struct {
-    uint32_t first_hole_off;    /**< Offset of the first memory hole, 0 if there is none. */
+    uint32_t first_hole_off[SR_EXT_HOLE_CLASS_COUNT];   /**< Offsets of the first memory hole of each size class,
+                                                             0 if there is none. Class i holds holes of sizes at least
+                                                             SR_SHM_MEM_ALIGN * 2^i and the lists are ordered by offset. */
+    uint32_t hole_count;        /**< Number of all memory holes. */
+    uint32_t hole_size;         /**< Total size of all memory holes. */
 } sr_ext_shm_t;
 
+/** number of lock sites in lock stats SHM, must be a power of 2 */
+#define SR_LOCK_STATS_SITE_COUNT 256
+
+/** maximum length of a lock site name including the terminating zero */
+#define SR_LOCK_STATS_SITE_LEN 64
+
+/** number of lock hold duration histogram buckets, bucket i holds durations below 10^(i+1) us, the last one the rest */
+#define SR_LOCK_STATS_HIST_COUNT 8
+
+/**
+ * @brief Lock stats SHM statistics of all the locks acquired at a single site.
+ */
+typedef struct {
+    ATOMIC_T site_hash;         /**< Hash of the site name, 0 if unused. */
+    char site[SR_LOCK_STATS_SITE_LEN];  /**< Lock site name (locking function). */
+    ATOMIC64_T acquire_count;   /**< Number of lock acquisitions. */
+    ATOMIC64_T wait_total_us;   /**< Cumulative time spent waiting for the locks (us). */
+    ATOMIC64_T wait_max_us;     /**< Maximum time spent waiting for a lock (us). */
+    ATOMIC64_T hold_hist[SR_LOCK_STATS_HIST_COUNT]; /**< Histogram of the lock hold durations. */
+} sr_lock_stats_site_t;
+
+/**
+ * @brief Lock stats SHM structure, collected only if compiled with lock statistics.
+ */
+typedef struct {
+    ATOMIC_T shm_ver;           /**< Lock stats SHM version, 0 if not yet initialized. */
+    sr_lock_stats_site_t sites[SR_LOCK_STATS_SITE_COUNT];   /**< Hash table of lock sites. */
+} sr_lock_stats_shm_t;
+
+/** number of subscriptions in event stats SHM, must be a power of 2 */
+#define SR_EVENT_STATS_SUB_COUNT 1024
+
+/** maximum length of a module name in event stats SHM including the terminating zero */
+#define SR_EVENT_STATS_NAME_LEN 64
+
+/** number of event latency histogram buckets, bucket i holds latencies below 10^(i+1) us, the last one the rest */
+#define SR_EVENT_STATS_HIST_COUNT 8
+
+/**
+ * @brief Subscription type of an event stats SHM subscription.
+ */
+typedef enum {
+    SR_EVENT_STATS_CHANGE = 1,  /**< Change subscription. */
+    SR_EVENT_STATS_OPER_GET,    /**< Operational get subscription. */
+    SR_EVENT_STATS_RPC,         /**< RPC/action subscription. */
+    SR_EVENT_STATS_NOTIF        /**< Notification subscription. */
+} sr_event_stats_type_t;
+
+/**
+ * @brief Event stats SHM statistics of all the events processed by a single subscription.
+ */
+typedef struct {
+    ATOMIC_T sub_id;            /**< Subscription ID, 0 if unused. */
+    ATOMIC_T type;              /**< Subscription type (::sr_event_stats_type_t). */
+    char name[SR_EVENT_STATS_NAME_LEN]; /**< Subscription module name. */
+    ATOMIC64_T event_count;     /**< Number of events processed by the subscription callback. */
+    ATOMIC64_T wake_hist[SR_EVENT_STATS_HIST_COUNT];    /**< Histogram of the durations between an event was published
+                                                             and the subscriber started processing it. */
+    ATOMIC64_T cb_hist[SR_EVENT_STATS_HIST_COUNT];  /**< Histogram of the callback durations. */
+    ATOMIC64_T reply_hist[SR_EVENT_STATS_HIST_COUNT];   /**< Histogram of the durations between the callback finished
+                                                             and the originator observed the reply. */
+} sr_event_stats_sub_t;
+
+/**
+ * @brief Event stats SHM structure, collected only if compiled with event tracing.
+ */
+typedef struct {
+    ATOMIC_T shm_ver;           /**< Event stats SHM version, 0 if not yet initialized. */
+    sr_event_stats_sub_t subs[SR_EVENT_STATS_SUB_COUNT];    /**< Subscriptions, subscription with ID N uses item
+                                                                 N % ::SR_EVENT_STATS_SUB_COUNT. */
+} sr_event_stats_shm_t;
+
 /**
  * @brief Ext SHM memory hole.
  */
@@ -294,7 +415,8 @@ typedef struct {
  * data SHM contents
  *
  * FOR SUBSCRIBERS:
- * event SR_SUB_EV_UPDATE, SR_SUB_EV_CHANGE, SR_SUB_EV_DONE, SR_SUB_EV_ABORT - char *user; char *diff_lyb - diff tree
+ * event SR_SUB_EV_UPDATE, SR_SUB_EV_CHANGE, SR_SUB_EV_DONE, SR_SUB_EV_ABORT - char *user; sr_sub_diff_ref_t diff_ref -
+ *      reference to the shared diff segment
  *
  * FOR ORIGINATOR (when subscriber_count is 0):
  * event SR_SUB_EV_SUCCESS - char *edit_lyb
@@ -302,9 +424,134 @@ typedef struct {
  */
 
 /*
- * notification subscription SHM (multi)
+ * shared diff segment
  *
- * data SHM contents
+ * written once by the originator for all the modules, priorities, and events of a change, mapped read-only
+ * by the subscribers while they hold the change sub SHM lock of an event referencing it; if the "done" event
+ * is not waited for, the segment is removed by the last subscriber that processed it
+ *
+ * sr_sub_diff_shm_t header;
+ * followed by:
+ * sr_sub_diff_mod_t mods[header.mod_count];
+ * (char *mod_name; char *xpath (if set); char *mod_diff_lyb)[header.mod_count]
+ */
+
+/**
+ * @brief Reference to a shared diff segment.
+ */
+typedef struct {
+    sr_cid_t cid;               /**< CID of the originator that created the segment. */
+    uint32_t diff_id;           /**< Diff segment ID unique for @p cid. */
+} sr_sub_diff_ref_t;
+
+/**
+ * @brief Shared diff segment module diff.
+ */
+typedef struct {
+    off_t name;                 /**< Module name (offset in the segment). */
+    off_t xpath;                /**< XPath the diff is pruned to (offset in the segment), 0 for the module diff. */
+    off_t diff;                 /**< Module diff in LYB (offset in the segment). */
+    uint32_t diff_len;          /**< Module diff length. */
+} sr_sub_diff_mod_t;
+
+/**
+ * @brief Shared diff segment header.
+ */
+typedef struct {
+    uint32_t mod_count;         /**< Count of module diffs. */
+    ATOMIC_T async_refs;        /**< References held by the asynchronous "done" events not processed yet and
+                                     by their originator while publishing them, 0 if not used. */
+} sr_sub_diff_shm_t;
+
+/*
+ * shared running cache segment
+ *
+ * one per module, contains the running data of the module in LYB, replaced as a whole (rename) whenever
+ * data with a new cache ID are published so it requires no locks and is read by connections with
+ * SR_CONN_CACHE_RUNNING_SHARED when their cached data of the module are not current
+ *
+ * sr_run_cache_shm_t header;
+ * followed by:
+ * char *mod_data_lyb
+ * char *mod_diff_lyb (if header.diff_len)
+ */
+
+/**
+ * @brief Shared running cache segment header.
+ */
+typedef struct {
+    uint32_t shm_ver;           /**< Main SHM version of the segment. */
+    uint32_t content_id;        /**< Context content ID the data were printed in. */
+    uint32_t cache_id;          /**< Running cache ID (or data version) of the data. */
+    uint32_t lyb_len;           /**< Module data LYB length. */
+    uint32_t diff_len;          /**< Module diff LYB length from the previous cache ID, 0 if not included. */
+} sr_run_cache_shm_t;
+
+/*
+ * shared oper cache segment
+ *
+ * one per module and oper poll subscription path, contains the data cached by the oper poll subscription in LYB,
+ * replaced as a whole (rename) whenever the data are refreshed so it requires no locks and is read by all
+ * the connections while the data are valid
+ *
+ * sr_oper_cache_shm_t header;
+ * followed by:
+ * char *path (header.path_len)
+ * char *data_lyb
+ */
+
+/**
+ * @brief Shared oper cache segment header.
+ */
+typedef struct {
+    uint32_t shm_ver;           /**< Main SHM version of the segment. */
+    uint32_t content_id;        /**< Context content ID the data were printed in. */
+    struct timespec timestamp;  /**< Realtime timestamp of the cached data. */
+    uint32_t valid_ms;          /**< Validity period of the cached data. */
+    uint32_t path_len;          /**< Length of the subscription path including the terminating zero. */
+    uint32_t lyb_len;           /**< Cached data LYB length. */
+} sr_oper_cache_shm_t;
+
+/*
+ * operational value slots SHM
+ *
+ * one per module, created zeroed with a fixed number of slots when the first slot is added, every used slot holds
+ * the path and the current value of an operational leaf updated in place by its owner connection, protected by
+ * a sequence lock, and merged into the operational data of the module whenever they are read
+ */
+
+/** number of operational value slots of a module */
+#define SR_OPER_SLOT_COUNT 1024
+
+/** maximum length of an operational value slot leaf path including the terminating zero */
+#define SR_OPER_SLOT_PATH_LEN 256
+
+/** maximum length of an operational value slot value including the terminating zero */
+#define SR_OPER_SLOT_VALUE_LEN 64
+
+/**
+ * @brief Operational value slot.
+ */
+typedef struct {
+    ATOMIC_T cid;               /**< CID of the owner connection, 0 if the slot is free. */
+    ATOMIC_T seq;               /**< Sequence number, odd while the path or the value is being written. */
+    char path[SR_OPER_SLOT_PATH_LEN];   /**< Leaf path, empty if the slot is free. */
+    char value[SR_OPER_SLOT_VALUE_LEN]; /**< Current leaf value. */
+} sr_oper_slot_shm_t;
+
+/**
+ * @brief Operational value slots SHM structure.
+ */
+typedef struct {
+    ATOMIC_T shm_ver;           /**< Operational value slots SHM version, 0 if not yet initialized. */
+    ATOMIC_T slot_count;        /**< Number of slots ever used, all the following slots are free. */
+    sr_oper_slot_shm_t slots[SR_OPER_SLOT_COUNT];   /**< Value slots. */
+} sr_oper_slots_shm_t;
+
+/*
+ * notification subscription SHM (ring)
+ *
+ * data SHM contents, one data SHM for each ring slot
  *
  * FOR SUBSCRIBERS
  * followed by:
@@ -318,7 +565,8 @@ typedef struct {
  *
  * FOR SUBSCRIBER
  * followed by:
- * event SR_SUB_EV_OPER - char *user; char *request_xpath; char *parent_lyb - existing data tree parent
+ * event SR_SUB_EV_OPER - char *user; char *request_xpath; uint32_t max_depth - maximum depth of the requested data
+ *     relative to the subscription nodes, 0 if unlimited; char *parent_lyb - existing data tree parent
  *
  * FOR ORIGINATOR
  * followed by:
@@ -341,6 +589,18 @@ typedef struct {
  * event SR_SUB_EV_ERROR - char *error_message; char *error_xpath
  */
 
+/**
+ * @brief Event trace, timestamps (us) of the event processing stages, 0 if not reached or not traced.
+ */
+typedef struct {
+    ATOMIC64_T enqueue;         /**< Event published by the originator. */
+    ATOMIC64_T wake;            /**< Event noticed by a subscriber. */
+    ATOMIC64_T cb_start;        /**< Subscriber callback started. */
+    ATOMIC64_T cb_end;          /**< Subscriber callback finished. */
+    ATOMIC64_T reply;           /**< Subscriber reply observed by the originator. */
+    ATOMIC_T sub_id;            /**< ID of the subscription whose callback finished last. */
+} sr_sub_trace_t;
+
 /**
  * @brief Generic (single-subscriber) subscription SHM structure.
  */
@@ -350,6 +610,8 @@ typedef struct {
     sr_cid_t orig_cid;          /**< Event originator CID. */
     ATOMIC_T request_id;        /**< Request ID. */
     ATOMIC_T event;             /**< Event. */
+    ATOMIC_T data_gen;          /**< Generation of the sub data SHM size, incremented on every resize. */
+    sr_sub_trace_t trace;       /**< Trace of the last event, written only if compiled with event tracing. */
 } sr_sub_shm_t;
 
 /**
@@ -361,10 +623,49 @@ typedef struct {
     sr_cid_t orig_cid;          /**< Event originator CID. */
     ATOMIC_T request_id;        /**< Request ID. */
     ATOMIC_T event;             /**< Event. */
+    ATOMIC_T data_gen;          /**< Generation of the sub data SHM size, incremented on every resize. */
+    sr_sub_trace_t trace;       /**< Trace of the last event, written only if compiled with event tracing. */
 
     /* specific fields */
     ATOMIC_T priority;          /**< Priority of the subscriber. */
     uint32_t subscriber_count;  /**< Number of subscribers to process this event. */
+    ATOMIC_T async_done;        /**< Set if the originator does not wait for this "done" event, the last subscriber
+                                     clears it instead. */
+    sr_sub_diff_ref_t async_diff;   /**< Diff segment referenced by the asynchronous "done" event, its reference
+                                         is released when the event is cleared. */
 } sr_multi_sub_shm_t;
 
+/** number of notification events that can be pending at once in a notification subscription SHM */
+#define SR_SUB_NOTIF_RING_SIZE 8
+
+/**
+ * @brief Notification subscription SHM ring slot with a single event.
+ */
+typedef struct {
+    sr_cid_t orig_cid;          /**< CID of a subscriber supposed to process the event, for recovery. */
+    ATOMIC_T request_id;        /**< Request ID of the event. */
+    ATOMIC_T event;             /**< Event, ::SR_SUB_EV_NONE if the slot is free. */
+    uint32_t subscriber_count;  /**< Number of subscribers yet to process this event. */
+    sr_sub_trace_t trace;       /**< Trace of the event, written only if compiled with event tracing. */
+} sr_notif_sub_slot_t;
+
+/**
+ * @brief Notification subscription SHM structure, a ring of events processed in order of their request IDs.
+ *
+ * Originators only wait for a free slot so the subscribers may process several events in a row.
+ */
+typedef struct {
+    sr_rwlock_t lock;           /**< Process-shared lock for accessing the SHM structure. */
+
+    sr_cid_t orig_cid;          /**< Unused, compatible with ::sr_sub_shm_t. */
+    ATOMIC_T request_id;        /**< Request ID of the last written event. */
+    ATOMIC_T event;             /**< Unused, events are stored in the slots. */
+    ATOMIC_T data_gen;          /**< Unused, every slot has its own sub data SHM. */
+    sr_sub_trace_t trace;       /**< Unused, every slot has its own trace. */
+
+    /* specific fields */
+    sr_notif_sub_slot_t slots[SR_SUB_NOTIF_RING_SIZE];  /**< Ring slots, event with request ID N is in slot
+                                                             N % ::SR_SUB_NOTIF_RING_SIZE. */
+} sr_notif_sub_shm_t;
+
 #endif /* _SHM_TYPES_H */
@@ -34,6 +34,30 @@
 #include "log.h"
 #include "sysrepo_types.h"
 
+/** maximum spin duration in ns before sleeping on the futex */
+#define SR_COND_SPIN_MAX_NS 50000
+
+/** minimum spin duration in ns, kept so that shorter waits are still detected */
+#define SR_COND_SPIN_MIN_NS 1000
+
+/** number of spin iterations between reading the current time */
+#define SR_COND_SPIN_CHECK_ITER 64
+
+/** hint the CPU that we are spinning */
+#if defined (__x86_64__) || defined (__i386__)
+# define SR_COND_CPU_RELAX() __builtin_ia32_pause()
+#elif defined (__aarch64__) || defined (__arm__)
+# define SR_COND_CPU_RELAX() __asm__ __volatile__ ("yield")
+#else
+# define SR_COND_CPU_RELAX() __asm__ __volatile__ ("" ::: "memory")
+#endif
+
+/** current spin duration in ns, adapted to the wait times observed by this process */
+static ATOMIC_T sr_cond_spin_ns = SR_COND_SPIN_MAX_NS / 2;
+
+/** number of online CPUs, 0 if not learned yet */
+static ATOMIC_T sr_cond_cpu_count;
+
 sr_error_info_t *
 sr_cond_init(sr_cond_t *cond, int UNUSED(shared), int UNUSED(robust))
 {
@@ -113,8 +137,85 @@ sr_cond_mutex_lock(pthread_mutex_t *mutex)
     return 0;
 }
 
+/**
+ * @brief Spin until a futex changes its value or the current spin duration elapses.
+ *
+ * The spin duration is adjusted afterwards, it grows towards twice the observed wait time if the change
+ * occurred and is halved otherwise.
+ *
+ * @param[in] cond Condition variable to spin on.
+ * @param[in] last_val Last value of the futex.
+ * @return Whether the futex value changed.
+ */
+static int
+sr_cond_spin(sr_cond_t *cond, uint32_t last_val)
+{
+    struct timespec start_ts, cur_ts;
+    uint_fast32_t spin_ns, spent_ns = 0, target_ns;
+    uint32_t i = 0;
+    long cpu_count;
+    int changed = 0;
+
+    cpu_count = ATOMIC_LOAD_RELAXED(sr_cond_cpu_count);
+    if (!cpu_count) {
+        cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpu_count < 1) {
+            cpu_count = 1;
+        }
+        ATOMIC_STORE_RELAXED(sr_cond_cpu_count, cpu_count);
+    }
+    if (cpu_count == 1) {
+        /* the waker cannot run while we are spinning */
+        return 0;
+    }
+
+    spin_ns = ATOMIC_LOAD_RELAXED(sr_cond_spin_ns);
+    clock_gettime(CLOCK_MONOTONIC, &start_ts);
+
+    do {
+        if (*(volatile uint32_t *)&cond->futex != last_val) {
+            changed = 1;
+        } else {
+            SR_COND_CPU_RELAX();
+            if (++i % SR_COND_SPIN_CHECK_ITER) {
+                continue;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &cur_ts);
+        spent_ns = (cur_ts.tv_sec - start_ts.tv_sec) * 1000000000L + (cur_ts.tv_nsec - start_ts.tv_nsec);
+    } while (!changed && (spent_ns < spin_ns));
+
+    /* adapt the spin duration, races between threads do not matter */
+    if (changed) {
+        target_ns = 2 * spent_ns;
+        if (target_ns > SR_COND_SPIN_MAX_NS) {
+            target_ns = SR_COND_SPIN_MAX_NS;
+        }
+        spin_ns = (3 * spin_ns + target_ns) / 4;
+    } else {
+        spin_ns /= 2;
+    }
+    if (spin_ns < SR_COND_SPIN_MIN_NS) {
+        spin_ns = SR_COND_SPIN_MIN_NS;
+    }
+    ATOMIC_STORE_RELAXED(sr_cond_spin_ns, spin_ns);
+
+    return changed;
+}
+
+/**
+ * @brief Wait on a condition variable.
+ *
+ * @param[in] cond Condition variable to wait on.
+ * @param[in] mutex Conditional variable mutex.
+ * @param[in] clockid ID of the clock to use.
+ * @param[in] timeout_abs Absolute timeout for waiting on the condition, infinite if NULL.
+ * @param[in] spin Whether to spin before sleeping on the futex.
+ * @return errno
+ */
 static int
-sr_cond_wait_(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs)
+sr_cond_wait_(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs, int spin)
 {
     int r, rf;
     uint32_t last_val;
@@ -125,11 +226,16 @@ sr_cond_wait_(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct
     /* MUTEX UNLOCK */
     pthread_mutex_unlock(mutex);
 
-    /* wait, ignore EINTR */
-    do {
-        errno = 0;
-        rf = sys_futex_wait(&cond->futex, last_val, clockid, timeout_abs);
-    } while ((rf == -1) && (errno == EINTR));
+    if (spin && sr_cond_spin(cond, last_val)) {
+        /* changed while spinning, no need to sleep */
+        rf = 0;
+    } else {
+        /* wait, ignore EINTR */
+        do {
+            errno = 0;
+            rf = sys_futex_wait(&cond->futex, last_val, clockid, timeout_abs);
+        } while ((rf == -1) && (errno == EINTR));
+    }
 
     /* MUTEX LOCK */
     if ((r = sr_cond_mutex_lock(mutex))) {
@@ -147,13 +253,19 @@ sr_cond_wait_(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct
 int
 sr_cond_wait(sr_cond_t *cond, pthread_mutex_t *mutex)
 {
-    return sr_cond_wait_(cond, mutex, 0, NULL);
+    return sr_cond_wait_(cond, mutex, 0, NULL, 0);
 }
 
 int
 sr_cond_clockwait(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs)
 {
-    return sr_cond_wait_(cond, mutex, clockid, timeout_abs);
+    return sr_cond_wait_(cond, mutex, clockid, timeout_abs, 0);
+}
+
+int
+sr_cond_clockwait_spin(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs)
+{
+    return sr_cond_wait_(cond, mutex, clockid, timeout_abs, 1);
 }
 
 void
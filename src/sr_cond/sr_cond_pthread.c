@@ -82,6 +82,12 @@ sr_cond_clockwait(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, st
     return pthread_cond_clockwait(cond, mutex, clockid, timeout_abs);
 }
 
+int
+sr_cond_clockwait_spin(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs)
+{
+    return pthread_cond_clockwait(cond, mutex, clockid, timeout_abs);
+}
+
 void
 sr_cond_broadcast(sr_cond_t *cond)
 {
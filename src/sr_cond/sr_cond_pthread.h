@@ -64,6 +64,19 @@ int sr_cond_wait(sr_cond_t *cond, pthread_mutex_t *mutex);
  */
 int sr_cond_clockwait(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs);
 
+/**
+ * @brief Wrapper for pthread_cond_clockwait() that may briefly spin before sleeping.
+ *
+ * Spinning is not supported by this implementation so it is equal to ::sr_cond_clockwait().
+ *
+ * @param[in] cond Condition variable to wait on.
+ * @param[in] mutex Conditional variable mutex.
+ * @param[in] clockid ID of the clock to use.
+ * @param[in] timeout_abs Absolute real/mono (depends on compat) timeout for waiting on the condition.
+ * @return errno
+ */
+int sr_cond_clockwait_spin(sr_cond_t *cond, pthread_mutex_t *mutex, clockid_t clockid, struct timespec *timeout_abs);
+
 /**
  * @brief Wrapper for pthread_cond_broadcast().
  *
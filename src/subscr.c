@@ -66,6 +66,7 @@ sr_subscr_change_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_sess
         change_sub = &subscr->change_subs[i];
         memset(change_sub, 0, sizeof *change_sub);
         change_sub->sub_shm.fd = -1;
+        change_sub->data_shm.fd = -1;
 
         /* set attributes */
         mem[1] = strdup(mod_name);
@@ -118,6 +119,7 @@ error:
     }
     if (change_sub) {
         sr_shm_clear(&change_sub->sub_shm);
+        sr_shm_clear(&change_sub->data_shm);
     }
     if (new_sub) {
         --subscr->change_sub_count;
@@ -151,6 +153,7 @@ sr_subscr_change_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id)
                 free(change_sub->module_name);
                 free(change_sub->subs);
                 sr_shm_clear(&change_sub->sub_shm);
+                sr_shm_clear(&change_sub->data_shm);
                 if (i < subscr->change_sub_count - 1) {
                     memcpy(change_sub, &subscr->change_subs[subscr->change_sub_count - 1], sizeof *change_sub);
                 }
@@ -223,6 +226,7 @@ sr_subscr_oper_get_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_se
     oper_get_sub->subs = mem[2];
     memset(oper_get_sub->subs + oper_get_sub->sub_count, 0, sizeof *oper_get_sub->subs);
     oper_get_sub->subs[oper_get_sub->sub_count].sub_shm.fd = -1;
+    oper_get_sub->subs[oper_get_sub->sub_count].data_shm.fd = -1;
 
     /* set attributes */
     oper_get_sub->subs[oper_get_sub->sub_count].sub_id = sub_id;
@@ -274,6 +278,7 @@ sr_subscr_oper_get_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id)
             /* found our subscription, replace it with the last */
             free(oper_get_sub->subs[j].path);
             sr_shm_clear(&oper_get_sub->subs[j].sub_shm);
+            sr_shm_clear(&oper_get_sub->subs[j].data_shm);
             if (j < oper_get_sub->sub_count - 1) {
                 memcpy(&oper_get_sub->subs[j], &oper_get_sub->subs[oper_get_sub->sub_count - 1], sizeof *oper_get_sub->subs);
             }
@@ -436,6 +441,7 @@ sr_subscr_notif_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_sessi
 {
     sr_error_info_t *err_info = NULL;
     struct modsub_notif_s *notif_sub = NULL;
+    sr_notif_sub_shm_t *notif_shm;
     uint32_t i;
     void *mem[4] = {NULL};
     int new_sub = 0;
@@ -472,6 +478,10 @@ sr_subscr_notif_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_sessi
             goto error;
         }
 
+        /* consider all the events still in the ring new, they may be meant for this subscription */
+        notif_shm = (sr_notif_sub_shm_t *)notif_sub->sub_shm.addr;
+        ATOMIC_STORE_RELAXED(notif_sub->request_id, ATOMIC_LOAD_RELAXED(notif_shm->request_id) - SR_SUB_NOTIF_RING_SIZE);
+
         /* make the subscription visible only after everything succeeds */
         ++subscr->notif_sub_count;
 
@@ -493,6 +503,11 @@ sr_subscr_notif_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_sessi
         mem[3] = strdup(xpath);
         SR_CHECK_MEM_GOTO(!mem[3], err_info, error);
         notif_sub->subs[notif_sub->sub_count].xpath = mem[3];
+
+        /* compile the filter, if possible */
+        if ((err_info = sr_notif_filter_compile(xpath, &notif_sub->subs[notif_sub->sub_count].filter))) {
+            goto error;
+        }
     }
     notif_sub->subs[notif_sub->sub_count].listen_since_mono = *listen_since_mono;
     notif_sub->subs[notif_sub->sub_count].listen_since_real = *listen_since_real;
@@ -534,7 +549,6 @@ sr_subscr_notif_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_ev_no
     struct modsub_notifsub_s *sub;
     sr_session_ctx_t *ev_sess = NULL;
     struct timespec cur_time;
-    sr_multi_sub_shm_t *multi_sub_shm;
 
     /* create event session */
     if ((err_info = _sr_session_start(subscr->conn, SR_DS_OPERATIONAL, SR_SUB_EV_NOTIF, NULL, &ev_sess))) {
@@ -555,14 +569,9 @@ sr_subscr_notif_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_ev_no
             /* we must be holding SUBS WRITE lock to prevent 1) ignoring a notification and then processing it and
              * 2) processing a standard notification after signalling subscription termination */
 
-            multi_sub_shm = (sr_multi_sub_shm_t *)notif_sub->sub_shm.addr;
-            if ((ATOMIC_LOAD_RELAXED(multi_sub_shm->event) == SR_SUB_EV_NOTIF) &&
-                    (ATOMIC_LOAD_RELAXED(multi_sub_shm->request_id) != ATOMIC_LOAD_RELAXED(notif_sub->request_id))) {
-                /* there is an event we were supposed to process, too late now, just ignore it */
-                if ((err_info = sr_shmsub_multi_listen_write_event(multi_sub_shm, 1, 0, NULL, NULL, 0,
-                        notif_sub->module_name, "ignored"))) {
-                    sr_errinfo_free(&err_info);
-                }
+            /* there may be events we were supposed to process, too late now, just ignore them */
+            if ((err_info = sr_shmsub_notif_listen_ignore_events(notif_sub, subscr->conn))) {
+                sr_errinfo_free(&err_info);
             }
 
             if (ev_sess) {
@@ -576,6 +585,7 @@ sr_subscr_notif_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_ev_no
 
             /* replace the subscription with the last */
             free(sub->xpath);
+            sr_notif_filter_free(sub->filter);
             if (j < notif_sub->sub_count - 1) {
                 memcpy(sub, &notif_sub->subs[notif_sub->sub_count - 1], sizeof *notif_sub->subs);
             }
@@ -617,7 +627,7 @@ sr_subscr_rpc_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_session
 {
     sr_error_info_t *err_info = NULL;
     struct opsub_rpc_s *rpc_sub = NULL;
-    uint32_t i;
+    uint32_t i, lane;
     char *mod_name;
     void *mem[4] = {NULL};
     int new_sub = 0;
@@ -642,7 +652,10 @@ sr_subscr_rpc_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_session
 
         rpc_sub = &subscr->rpc_subs[i];
         memset(rpc_sub, 0, sizeof *rpc_sub);
-        rpc_sub->sub_shm.fd = -1;
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+            rpc_sub->sub_shm[lane].fd = -1;
+            rpc_sub->data_shm[lane].fd = -1;
+        }
 
         /* set attributes */
         mem[1] = strdup(path);
@@ -653,10 +666,17 @@ sr_subscr_rpc_sub_add(sr_subscription_ctx_t *subscr, uint32_t sub_id, sr_session
         /* get module name */
         mod_name = sr_get_first_ns(xpath);
 
-        /* open specific SHM and map it */
-        err_info = sr_shmsub_open_map(mod_name, "rpc", sr_str_hash(path, 0), &rpc_sub->sub_shm);
+        /* open specific SHM of all the lanes and map them */
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+            if ((err_info = sr_shmsub_open_map(mod_name, "rpc", sr_str_hash(path, lane), &rpc_sub->sub_shm[lane]))) {
+                break;
+            }
+        }
         free(mod_name);
         if (err_info) {
+            for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+                sr_shm_clear(&rpc_sub->sub_shm[lane]);
+            }
             goto error;
         }
 
@@ -699,7 +719,10 @@ error:
     }
     if (new_sub) {
         --subscr->rpc_sub_count;
-        sr_shm_clear(&rpc_sub->sub_shm);
+        for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+            sr_shm_clear(&rpc_sub->sub_shm[lane]);
+            sr_shm_clear(&rpc_sub->data_shm[lane]);
+        }
     }
     return err_info;
 }
@@ -707,7 +730,7 @@ error:
 void
 sr_subscr_rpc_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id)
 {
-    uint32_t i, j;
+    uint32_t i, j, lane;
     struct opsub_rpc_s *rpc_sub;
 
     for (i = 0; i < subscr->rpc_sub_count; ++i) {
@@ -728,7 +751,10 @@ sr_subscr_rpc_sub_del(sr_subscription_ctx_t *subscr, uint32_t sub_id)
             if (!rpc_sub->sub_count) {
                 /* no other subscriptions for this RPC/action, replace it with the last */
                 free(rpc_sub->path);
-                sr_shm_clear(&rpc_sub->sub_shm);
+                for (lane = 0; lane < SR_RPC_LANE_COUNT; ++lane) {
+                    sr_shm_clear(&rpc_sub->sub_shm[lane]);
+                    sr_shm_clear(&rpc_sub->data_shm[lane]);
+                }
                 free(rpc_sub->subs);
                 if (i < subscr->rpc_sub_count - 1) {
                     memcpy(rpc_sub, &subscr->rpc_subs[subscr->rpc_sub_count - 1], sizeof *rpc_sub);
@@ -978,6 +1004,11 @@ sr_change_sub_del(sr_subscription_ctx_t *subscr, uint32_t idx1, uint32_t idx2, s
         goto cleanup_unlock;
     }
 
+    /* finish an asynchronous event it has not processed, nobody else would */
+    if ((err_info = sr_shmsub_change_listen_sub_del(change_sub, idx2, subscr->conn))) {
+        goto cleanup_unlock;
+    }
+
     /* properly remove the subscription from ext SHM, with separate specific SHM segment if no longer needed while
      * holding CHANGE SUB lock to prevent data races and processing events after the subscription is removed from SHM */
     if ((err_info = sr_shmext_change_sub_del(subscr->conn, shm_mod, ds, sub_id))) {
@@ -1829,6 +1860,7 @@ sr_notif_call_callback(sr_session_ctx_t *ev_sess, sr_event_notif_cb cb, sr_event
     const struct lyd_node *elem;
     void *mem;
     char *notif_xpath = NULL;
+    struct sr_lyd_path_s path = {0};
     sr_val_t *vals = NULL;
     size_t val_count = 0;
 
@@ -1855,7 +1887,7 @@ sr_notif_call_callback(sr_session_ctx_t *ev_sess, sr_event_notif_cb cb, sr_event
                     }
                     vals = mem;
 
-                    if ((err_info = sr_val_ly2sr(elem, &vals[val_count]))) {
+                    if ((err_info = sr_val_ly2sr(elem, &path, &vals[val_count]))) {
                         goto cleanup;
                     }
 
@@ -1872,6 +1904,7 @@ sr_notif_call_callback(sr_session_ctx_t *ev_sess, sr_event_notif_cb cb, sr_event
 
 cleanup:
     free(notif_xpath);
+    sr_lyd_path_erase(&path);
     sr_free_values(vals, val_count);
     return err_info;
 }
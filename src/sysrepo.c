@@ -20,6 +20,7 @@
 #include "sysrepo.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
@@ -71,11 +72,16 @@ sr_conn_new(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
 {
     sr_conn_ctx_t *conn;
     sr_error_info_t *err_info = NULL;
+    uint32_t i;
 
     conn = calloc(1, sizeof *conn);
     SR_CHECK_MEM_RET(!conn, err_info);
 
     conn->opts = opts;
+    if (opts & (SR_CONN_CACHE_RUNNING_SHARED | SR_CONN_CACHE_RUNNING_COMPACT)) {
+        /* shared cache is used to update the connection cache, compact data are part of it */
+        conn->opts |= SR_CONN_CACHE_RUNNING;
+    }
     if ((err_info = sr_ly_ctx_init(conn, &conn->ly_ctx))) {
         goto error1;
     }
@@ -118,12 +124,75 @@ sr_conn_new(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
     if ((err_info = sr_mutex_init(&conn->oper_push_mod_lock, 0))) {
         goto error11;
     }
+    if ((err_info = sr_mutex_init(&conn->evpipe_cache_lock, 0))) {
+        goto error12;
+    }
+    for (i = 0; i < SR_EVPIPE_CACHE_SIZE; ++i) {
+        conn->evpipe_cache[i].fd = -1;
+    }
+    if ((err_info = sr_rwlock_init(&conn->load_lock, 0))) {
+        goto error13;
+    }
+    if ((err_info = sr_mutex_init(&conn->xpath_cache_lock, 0))) {
+        goto error14;
+    }
+    if ((err_info = sr_mutex_init(&conn->commit_group_lock, 0))) {
+        goto error15;
+    }
+    if ((err_info = sr_cond_init(&conn->commit_group_cond, 0, 0))) {
+        goto error16;
+    }
+    if ((err_info = sr_mutex_init(&conn->ds_cache_lock, 0))) {
+        goto error17;
+    }
+    if ((err_info = sr_mutex_init(&conn->lazy_lock, 0))) {
+        goto error18;
+    }
+    if ((err_info = sr_mutex_init(&conn->rpc_dep_cache_lock, 0))) {
+        goto error19;
+    }
+    if ((err_info = sr_mutex_init(&conn->yanglib_cache_lock, 0))) {
+        goto error20;
+    }
+    if ((err_info = sr_mutex_init(&conn->run_cache_enabled_lock, 0))) {
+        goto error21;
+    }
+    if ((err_info = sr_mutex_init(&conn->oper_slots_cache_lock, 0))) {
+        goto error22;
+    }
+    if ((err_info = sr_mutex_init(&conn->value_constr_cache_lock, 0))) {
+        goto error23;
+    }
 
     *conn_p = conn;
     return NULL;
 
-error11:
+error23:
+    pthread_mutex_destroy(&conn->oper_slots_cache_lock);
+error22:
+    pthread_mutex_destroy(&conn->run_cache_enabled_lock);
+error21:
+    pthread_mutex_destroy(&conn->yanglib_cache_lock);
+error20:
+    pthread_mutex_destroy(&conn->rpc_dep_cache_lock);
+error19:
+    pthread_mutex_destroy(&conn->lazy_lock);
+error18:
+    pthread_mutex_destroy(&conn->ds_cache_lock);
+error17:
+    sr_cond_destroy(&conn->commit_group_cond);
+error16:
+    pthread_mutex_destroy(&conn->commit_group_lock);
+error15:
+    pthread_mutex_destroy(&conn->xpath_cache_lock);
+error14:
+    sr_rwlock_destroy(&conn->load_lock);
+error13:
+    pthread_mutex_destroy(&conn->evpipe_cache_lock);
+error12:
     pthread_mutex_destroy(&conn->oper_push_mod_lock);
+error11:
+    sr_rwlock_destroy(&conn->oper_cache_lock);
 error10:
     sr_ntf_handle_free(conn->ntf_handles, conn->ntf_handle_count);
 error9:
@@ -161,6 +230,9 @@ sr_conn_free(sr_conn_ctx_t *conn)
         return;
     }
 
+    /* stop the load workers */
+    sr_conn_load_workers_stop(conn);
+
     /* destroy DS plugin data */
     sr_conn_ds_destroy(conn);
 
@@ -169,12 +241,14 @@ sr_conn_free(sr_conn_ctx_t *conn)
     /* unlocked data destroy */
     lyd_free_siblings(conn->ly_ext_data);
     sr_conn_run_cache_flush(conn);
+    sr_conn_ds_cache_flush(conn);
     for (i = 0; i < conn->oper_cache_count; ++i) {
         lyd_free_siblings(conn->oper_caches[i].data);
+        free(conn->oper_caches[i].hashes);
     }
 
     /* context destroy */
-    ly_ctx_destroy(conn->ly_ctx);
+    sr_ly_ctx_destroy(conn->ly_ctx);
 
     pthread_mutex_destroy(&conn->ptr_lock);
     sr_rwlock_destroy(&conn->ly_ext_data_lock);
@@ -197,6 +271,50 @@ sr_conn_free(sr_conn_ctx_t *conn)
     free(conn->oper_push_mods);
     pthread_mutex_destroy(&conn->oper_push_mod_lock);
 
+    for (i = 0; i < SR_EVPIPE_CACHE_SIZE; ++i) {
+        if (conn->evpipe_cache[i].fd > -1) {
+            close(conn->evpipe_cache[i].fd);
+        }
+    }
+    pthread_mutex_destroy(&conn->evpipe_cache_lock);
+    sr_rwlock_destroy(&conn->load_lock);
+
+    for (i = 0; i < SR_XPATH_CACHE_SIZE; ++i) {
+        free(conn->xpath_cache[i].xpath);
+        free(conn->xpath_cache[i].mods);
+    }
+    pthread_mutex_destroy(&conn->xpath_cache_lock);
+
+    for (i = 0; i < SR_RPC_DEP_CACHE_SIZE; ++i) {
+        free(conn->rpc_dep_cache[i].path);
+        sr_conn_rpc_dep_cache_deps_free(conn->rpc_dep_cache[i].deps, conn->rpc_dep_cache[i].dep_count);
+    }
+    pthread_mutex_destroy(&conn->rpc_dep_cache_lock);
+
+    lyd_free_siblings(conn->yanglib_cache);
+    pthread_mutex_destroy(&conn->yanglib_cache_lock);
+    pthread_mutex_destroy(&conn->run_cache_enabled_lock);
+
+    for (i = 0; i < conn->oper_slots_cache_count; ++i) {
+        sr_shm_clear(&conn->oper_slots_cache[i].shm);
+    }
+    free(conn->oper_slots_cache);
+    pthread_mutex_destroy(&conn->oper_slots_cache_lock);
+
+    free(conn->value_constr_cache);
+    pthread_mutex_destroy(&conn->value_constr_cache_lock);
+
+    assert(!conn->commit_group);
+    pthread_mutex_destroy(&conn->commit_group_lock);
+    sr_cond_destroy(&conn->commit_group_cond);
+    pthread_mutex_destroy(&conn->ds_cache_lock);
+
+    for (i = 0; i < conn->lazy_mod_count; ++i) {
+        free(conn->lazy_mods[i]);
+    }
+    free(conn->lazy_mods);
+    pthread_mutex_destroy(&conn->lazy_lock);
+
     free(conn);
 }
 
@@ -268,7 +386,7 @@ sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
 
         /* get and store content-id in main SHM */
         assert(!strcmp(LYD_NAME(lyd_child(sr_mods)), "content-id"));
-        main_shm->content_id = ((struct lyd_node_term *)lyd_child(sr_mods))->value.uint32;
+        ATOMIC_STORE_RELEASE(main_shm->content_id, ((struct lyd_node_term *)lyd_child(sr_mods))->value.uint32);
 
         /* recover anything left in ext SHM */
         sr_shmext_recover_sub_all(conn);
@@ -278,6 +396,12 @@ sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
             goto cleanup_unlock;
         }
 
+        /* all the modules are needed for initializing the datastores */
+        conn->opts &= ~SR_CONN_CTX_LAZY;
+
+        /* any printed context was created for the previous SHM state */
+        sr_ly_ctx_printed_remove();
+
         assert((conn->ext_shm.size == SR_SHM_SIZE(sizeof(sr_ext_shm_t))) || sr_ext_hole_next(NULL, SR_CONN_EXT_SHM(conn)));
         if ((hole = sr_ext_hole_next(NULL, SR_CONN_EXT_SHM(conn)))) {
             /* there is something in ext SHM, is it only a single memory hole? */
@@ -290,7 +414,7 @@ sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
             if ((err_info = sr_shm_remap(&conn->ext_shm, SR_SHM_SIZE(sizeof(sr_ext_shm_t))))) {
                 goto cleanup_unlock;
             }
-            SR_CONN_EXT_SHM(conn)->first_hole_off = 0;
+            memset(SR_CONN_EXT_SHM(conn), 0, sizeof(sr_ext_shm_t));
         }
 
         /* add internal RPC subscription into ext SHM */
@@ -454,6 +578,33 @@ sr_session_release_context(sr_session_ctx_t *session)
     sr_release_context(session->conn);
 }
 
+API int
+sr_require_modules(sr_conn_ctx_t *conn, const char **module_names)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    SR_CHECK_ARG_APIRET(!conn || !module_names, NULL, err_info);
+
+    for (i = 0; module_names[i]; ++i) {
+        if ((err_info = sr_lycc_lazy_require(conn, module_names[i], NULL))) {
+            return sr_api_ret(NULL, err_info);
+        }
+    }
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
+    /* context was updated */
+
+    /* CONTEXT UNLOCK */
+    sr_lycc_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+    return sr_api_ret(NULL, err_info);
+}
+
 API uint32_t
 sr_get_content_id(sr_conn_ctx_t *conn)
 {
@@ -527,6 +678,83 @@ cleanup:
     return sr_api_ret(NULL, err_info);
 }
 
+API int
+sr_compact_ext_shm(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn, NULL, err_info);
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
+    /* compact ext SHM regardless of its fragmentation */
+    err_info = sr_shmext_compact(conn, SR_SHMEXT_SUB_LOCK_TIMEOUT, 1);
+
+    /* CONTEXT UNLOCK */
+    sr_lycc_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+    return sr_api_ret(NULL, err_info);
+}
+
+API int
+sr_conn_get_mem_usage(sr_conn_ctx_t *conn, uint64_t *mem_usage)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || !mem_usage, NULL, err_info);
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
+    err_info = sr_conn_mem_usage(conn, mem_usage);
+
+    /* CONTEXT UNLOCK */
+    sr_lycc_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+    return sr_api_ret(NULL, err_info);
+}
+
+API int
+sr_conn_set_mem_limit(sr_conn_ctx_t *conn, sr_conn_mem_t mem, uint64_t limit)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || ((mem != SR_CONN_MEM_RUN_CACHE) && (mem != SR_CONN_MEM_DS_CACHE) &&
+            (mem != SR_CONN_MEM_OPER_CACHE)), NULL, err_info);
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
+    err_info = sr_conn_mem_limit_set(conn, mem, limit);
+
+    /* CONTEXT UNLOCK */
+    sr_lycc_unlock(conn, SR_LOCK_READ, 0, __func__);
+
+    return sr_api_ret(NULL, err_info);
+}
+
+API int
+sr_conn_get_cache_stats(sr_conn_ctx_t *conn, sr_conn_mem_t cache, sr_cache_stats_t *stats)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || ((cache != SR_CONN_MEM_RUN_CACHE) && (cache != SR_CONN_MEM_DS_CACHE) &&
+            (cache != SR_CONN_MEM_OPER_CACHE)) || !stats, NULL, err_info);
+
+    stats->hits = ATOMIC_LOAD_RELAXED(conn->cache_stats[cache].hits);
+    stats->misses = ATOMIC_LOAD_RELAXED(conn->cache_stats[cache].misses);
+    stats->evictions = ATOMIC_LOAD_RELAXED(conn->cache_stats[cache].evictions);
+
+    return sr_api_ret(NULL, NULL);
+}
+
 API uid_t
 sr_get_su_uid(void)
 {
@@ -555,6 +783,11 @@ sr_discard_oper_changes(sr_conn_ctx_t *conn, sr_session_ctx_t *session, const ch
     }
     SR_MODINFO_INIT(mod_info, conn, SR_DS_OPERATIONAL, SR_DS_OPERATIONAL);
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, NULL, xpath))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         goto cleanup;
@@ -562,7 +795,7 @@ sr_discard_oper_changes(sr_conn_ctx_t *conn, sr_session_ctx_t *session, const ch
 
     /* collect all required modules */
     if (xpath) {
-        if ((err_info = sr_modinfo_collect_xpath(conn->ly_ctx, xpath, SR_DS_OPERATIONAL, NULL, 0, &mod_info))) {
+        if ((err_info = sr_modinfo_collect_xpath(conn, xpath, SR_DS_OPERATIONAL, NULL, 0, &mod_info))) {
             goto cleanup;
         }
     } else {
@@ -1032,6 +1265,16 @@ sr_session_get_orig_data(sr_session_ctx_t *session, uint32_t idx, uint32_t *size
     return sr_ev_data_get(session->ev_data.orig_data, idx, size, (void **)data);
 }
 
+API uint32_t
+sr_session_get_oper_max_depth(sr_session_ctx_t *session)
+{
+    if (!session || !session->ev) {
+        return 0;
+    }
+
+    return session->ev_data.oper_max_depth;
+}
+
 API int
 sr_session_get_error(sr_session_ctx_t *session, const sr_error_info_t **error_info)
 {
@@ -1212,6 +1455,67 @@ sr_session_get_connection(sr_session_ctx_t *session)
     return session->conn;
 }
 
+API int
+sr_session_set_timing(sr_session_ctx_t *session, int enable, uint32_t slow_ms)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session, session, err_info);
+
+    memset(&session->timing, 0, sizeof session->timing);
+    session->timing.enabled = enable ? 1 : 0;
+    session->timing.slow_ms = enable ? slow_ms : 0;
+
+    return sr_api_ret(session, NULL);
+}
+
+API int
+sr_session_get_timing(sr_session_ctx_t *session, uint32_t *total_us, uint32_t *phase_us)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session, session, err_info);
+
+    if (!session->timing.enabled) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Request timing is not enabled for session %" PRIu32 ".",
+                session->sid);
+        return sr_api_ret(session, err_info);
+    }
+
+    if (total_us) {
+        *total_us = session->timing.total_us;
+    }
+    if (phase_us) {
+        memcpy(phase_us, session->timing.phase_us, sizeof session->timing.phase_us);
+    }
+
+    return sr_api_ret(session, NULL);
+}
+
+API int
+sr_session_set_async_done(sr_session_ctx_t *session, int enable)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session, session, err_info);
+
+    session->async_done = enable ? 1 : 0;
+
+    return sr_api_ret(session, NULL);
+}
+
+API int
+sr_session_get_mem_usage(sr_session_ctx_t *session, uint64_t *edit, uint64_t *notif_buf)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session, session, err_info);
+
+    err_info = sr_sess_mem_usage(session, edit, notif_buf);
+
+    return sr_api_ret(session, err_info);
+}
+
 API const char *
 sr_get_repo_path(void)
 {
@@ -1560,7 +1864,7 @@ _sr_install_modules(sr_conn_ctx_t *conn, const char *search_dirs, const char *da
     }
 
     /* update content ID and safely switch the context */
-    SR_CONN_MAIN_SHM(conn)->content_id = ly_ctx_get_modules_hash(new_ctx);
+    ATOMIC_STORE_RELEASE(SR_CONN_MAIN_SHM(conn)->content_id, ly_ctx_get_modules_hash(new_ctx));
     sr_conn_ctx_switch(conn, &new_ctx, &old_ctx);
 
     goto cleanup;
@@ -1601,7 +1905,7 @@ cleanup:
     sr_lycc_update_data_clear(&data_info);
     lyd_free_siblings(mod_data);
     lyd_free_siblings(sr_mods);
-    ly_ctx_destroy(old_ctx);
+    sr_ly_ctx_destroy(old_ctx);
     ly_ctx_destroy(new_ctx);
 
     /* CONTEXT UNLOCK */
@@ -1870,14 +2174,14 @@ sr_remove_modules(sr_conn_ctx_t *conn, const char **module_names, int force)
     }
 
     /* update content ID and safely switch the context */
-    SR_CONN_MAIN_SHM(conn)->content_id = ly_ctx_get_modules_hash(new_ctx);
+    ATOMIC_STORE_RELEASE(SR_CONN_MAIN_SHM(conn)->content_id, ly_ctx_get_modules_hash(new_ctx));
     sr_conn_ctx_switch(conn, &new_ctx, &old_ctx);
 
 cleanup:
     sr_lycc_update_data_clear(&data_info);
     lyd_free_siblings(sr_mods);
     lyd_free_siblings(sr_del_mods);
-    ly_ctx_destroy(old_ctx);
+    sr_ly_ctx_destroy(old_ctx);
     ly_ctx_destroy(new_ctx);
 
     /* CONTEXT UNLOCK */
@@ -2115,13 +2419,13 @@ sr_update_modules(sr_conn_ctx_t *conn, const char **schema_paths, const char *se
     }
 
     /* update content ID and safely switch the context */
-    SR_CONN_MAIN_SHM(conn)->content_id = ly_ctx_get_modules_hash(new_ctx);
+    ATOMIC_STORE_RELEASE(SR_CONN_MAIN_SHM(conn)->content_id, ly_ctx_get_modules_hash(new_ctx));
     sr_conn_ctx_switch(conn, &new_ctx, &old_ctx);
 
 cleanup:
     sr_lycc_update_data_clear(&data_info);
     lyd_free_siblings(sr_mods);
-    ly_ctx_destroy(old_ctx);
+    sr_ly_ctx_destroy(old_ctx);
     ly_ctx_destroy(new_ctx);
 
     /* CONTEXT UNLOCK */
@@ -2617,13 +2921,13 @@ sr_change_module_feature(sr_conn_ctx_t *conn, const char *module_name, const cha
     }
 
     /* update content ID and safely switch the context */
-    SR_CONN_MAIN_SHM(conn)->content_id = ly_ctx_get_modules_hash(new_ctx);
+    ATOMIC_STORE_RELEASE(SR_CONN_MAIN_SHM(conn)->content_id, ly_ctx_get_modules_hash(new_ctx));
     sr_conn_ctx_switch(conn, &new_ctx, &old_ctx);
 
 cleanup:
     sr_lycc_update_data_clear(&data_info);
     lyd_free_siblings(sr_mods);
-    ly_ctx_destroy(old_ctx);
+    sr_ly_ctx_destroy(old_ctx);
     ly_ctx_destroy(new_ctx);
 
     /* CONTEXT UNLOCK */
@@ -2771,6 +3075,12 @@ sr_get_item(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
     *value = NULL;
     /* for operational, use operational and running datastore */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info.nacm_user = session->nacm_user;
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -2778,13 +3088,13 @@ sr_get_item(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
     }
 
     /* collect all required modules */
-    if ((err_info = sr_modinfo_collect_xpath(session->conn->ly_ctx, path, session->ds, session,
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, path, session->ds, session,
             MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
         goto cleanup;
     }
 
     /* add modules into mod_info with deps, locking, and their data */
-    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ,
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session),
             session->sid, session->orig_name, session->orig_data, timeout_ms, 0, 0))) {
         goto cleanup;
     }
@@ -2811,7 +3121,7 @@ sr_get_item(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
     *value = malloc(sizeof **value);
     SR_CHECK_MEM_GOTO(!*value, err_info, cleanup);
 
-    if ((err_info = sr_val_ly2sr(set->dnodes[0], *value))) {
+    if ((err_info = sr_val_ly2sr(set->dnodes[0], NULL, *value))) {
         goto cleanup;
     }
 
@@ -2862,6 +3172,7 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, uint32_t timeout_ms,
     sr_error_info_t *err_info = NULL;
     struct ly_set *set = NULL;
     struct sr_mod_info_s mod_info;
+    struct sr_lyd_path_s path = {0};
     uint32_t i;
 
     SR_CHECK_ARG_APIRET(!session || !xpath || !values || !value_cnt ||
@@ -2874,6 +3185,12 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, uint32_t timeout_ms,
     *value_cnt = 0;
     /* for operational, use operational and running datastore */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info.nacm_user = session->nacm_user;
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -2881,13 +3198,13 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, uint32_t timeout_ms,
     }
 
     /* collect all required modules */
-    if ((err_info = sr_modinfo_collect_xpath(session->conn->ly_ctx, xpath, session->ds, session,
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, xpath, session->ds, session,
             MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
         goto cleanup;
     }
 
     /* add modules into mod_info with deps, locking, and their data */
-    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ, session->sid,
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session), session->sid,
             session->orig_name, session->orig_data, timeout_ms, 0, opts))) {
         goto cleanup;
     }
@@ -2902,16 +3219,23 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, uint32_t timeout_ms,
         goto cleanup;
     }
 
-    if (set->count) {
-        *values = calloc(set->count, sizeof **values);
-        SR_CHECK_MEM_GOTO(!*values, err_info, cleanup);
-    }
-
-    for (i = 0; i < set->count; ++i) {
-        if ((err_info = sr_val_ly2sr(set->dnodes[i], (*values) + i))) {
+    if (opts & SR_GET_VALUES_ARENA) {
+        /* all the values in a single block */
+        if ((err_info = sr_vals_ly2sr_arena(set, values, value_cnt))) {
             goto cleanup;
         }
-        ++(*value_cnt);
+    } else {
+        if (set->count) {
+            *values = calloc(set->count, sizeof **values);
+            SR_CHECK_MEM_GOTO(!*values, err_info, cleanup);
+        }
+
+        for (i = 0; i < set->count; ++i) {
+            if ((err_info = sr_val_ly2sr(set->dnodes[i], &path, (*values) + i))) {
+                goto cleanup;
+            }
+            ++(*value_cnt);
+        }
     }
 
 cleanup:
@@ -2920,6 +3244,7 @@ cleanup:
 
     ly_set_free(set, NULL);
     sr_modinfo_erase(&mod_info);
+    sr_lyd_path_erase(&path);
 
     /* CONTEXT UNLOCK */
     sr_lycc_unlock(session->conn, SR_LOCK_READ, 0, __func__);
@@ -2946,6 +3271,12 @@ sr_get_subtree(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms,
     }
     /* for operational, use operational and running datastore */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info.nacm_user = session->nacm_user;
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -2958,13 +3289,13 @@ sr_get_subtree(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms,
     }
 
     /* collect all the required modules, do not store xpaths if some changes will be applied (we need all the base data then) */
-    if ((err_info = sr_modinfo_collect_xpath(session->conn->ly_ctx, path, session->ds, session,
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, path, session->ds, session,
             MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
         goto cleanup;
     }
 
     /* add modules into mod_info with deps, locking, and their data */
-    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ, session->sid,
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session), session->sid,
             session->orig_name, session->orig_data, timeout_ms, 0, 0))) {
         goto cleanup;
     }
@@ -3033,66 +3364,33 @@ sr_lyht_value_get_data_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod),
     return val1->input_parent == val2->input_parent;
 }
 
-API int
-sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
-        const sr_get_options_t opts, sr_data_t **data)
+/**
+ * @brief Duplicate selected subtrees with their parents into a result data tree.
+ *
+ * @param[in] session Session to use for NACM filtering.
+ * @param[in] set Set of the selected nodes, no node may be a descendant of another.
+ * @param[in] start Index of the first node in @p set to duplicate.
+ * @param[in] count Count of nodes from @p start in @p set to duplicate.
+ * @param[in] max_depth Maximum depth of the selected subtrees, 0 is unlimited.
+ * @param[in,out] tree Result data tree to add the subtrees to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_get_data_dup(sr_session_ctx_t *session, const struct ly_set *set, uint32_t start, uint32_t count, uint32_t max_depth,
+        struct lyd_node **tree)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t i, hash;
     int dup_opts, denied;
-    struct sr_mod_info_s mod_info;
-    struct ly_set *set = NULL;
     struct lyd_node *node, *parent, *node_parent, *input_node;
     struct ly_ht *ht = NULL;
     struct sr_lyht_get_data_rec rec, *rec_p;
 
-    SR_CHECK_ARG_APIRET(!session || !xpath || !data || ((session->ds != SR_DS_OPERATIONAL) && (opts & SR_OPER_MASK)),
-            session, err_info);
-
-    if (!timeout_ms) {
-        timeout_ms = SR_OPER_CB_TIMEOUT;
-    }
-
-    /* for operational, use operational and running datastore */
-    SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
-
-    /* CONTEXT LOCK */
-    if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
-        return sr_api_ret(session, err_info);
-    }
-
-    /* prepare data wrapper */
-    if ((err_info = _sr_acquire_data(session->conn, NULL, data))) {
-        goto cleanup;
-    }
-
-    /* collect all required modules */
-    if ((err_info = sr_modinfo_collect_xpath(session->conn->ly_ctx, xpath, session->ds, session,
-            MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
-        goto cleanup;
-    }
-
-    /* add modules into mod_info with deps, locking, and their data */
-    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ, session->sid,
-            session->orig_name, session->orig_data, timeout_ms, 0, opts))) {
-        goto cleanup;
-    }
-
-    /* filter the required data */
-    if ((err_info = sr_modinfo_get_filter(&mod_info, (opts & SR_GET_NO_FILTER) ? "/*" : xpath, session, &set))) {
-        goto cleanup;
-    }
-
-    /* get rid of all redundant results that are descendants of another result */
-    if ((err_info = sr_xpath_set_filter_subtrees(set))) {
-        goto cleanup;
-    }
-
     /* create a hash table for finding existing parents */
     ht = lyht_new(1, sizeof rec, sr_lyht_value_get_data_equal_cb, NULL, 1);
     SR_CHECK_MEM_GOTO(!ht, err_info, cleanup);
 
-    for (i = 0; i < set->count; ++i) {
+    for (i = start; i < start + count; ++i) {
         /* check whether a parent does not exist yet in the result */
         for (parent = lyd_parent(set->dnodes[i]); parent; parent = lyd_parent(parent)) {
             hash = lyht_hash((void *)&parent, sizeof parent);
@@ -3131,7 +3429,7 @@ sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, ui
 
         if (!parent) {
             /* connect to the result */
-            if ((err_info = sr_lyd_insert_sibling((*data)->tree, node_parent, &(*data)->tree))) {
+            if ((err_info = sr_lyd_insert_sibling(*tree, node_parent, tree))) {
                 lyd_free_tree(node);
                 goto cleanup;
             }
@@ -3154,20 +3452,256 @@ sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, ui
     }
 
 cleanup:
-    /* MODULES UNLOCK */
-    sr_shmmod_modinfo_unlock(&mod_info);
-
-    ly_set_free(set, NULL);
-    sr_modinfo_erase(&mod_info);
     lyht_free(ht, NULL);
+    return err_info;
+}
 
-    if (err_info || !(*data)->tree) {
-        sr_release_data(*data);
-        *data = NULL;
-    }
+API int
+sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
+        const sr_get_options_t opts, sr_data_t **data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_mod_info_s mod_info;
+    struct ly_set *set = NULL;
+    struct timespec ts;
+
+    SR_CHECK_ARG_APIRET(!session || !xpath || !data || ((session->ds != SR_DS_OPERATIONAL) && (opts & SR_OPER_MASK)),
+            session, err_info);
+
+    if (!timeout_ms) {
+        timeout_ms = SR_OPER_CB_TIMEOUT;
+    }
+
+    /* for operational, use operational and running datastore */
+    SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info.nacm_user = session->nacm_user;
+    mod_info.phase_us = SR_SESS_PHASE_US(session);
+    if (!(opts & SR_GET_NO_FILTER)) {
+        /* providers of operational data may use it */
+        mod_info.max_depth = max_depth;
+    }
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
+
+    sr_timing_request_start(session, &ts);
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+        sr_timing_request_end(session, "get data", &ts);
+        return sr_api_ret(session, err_info);
+    }
+
+    /* prepare data wrapper */
+    if ((err_info = _sr_acquire_data(session->conn, NULL, data))) {
+        goto cleanup;
+    }
+
+    /* collect all required modules */
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, xpath, session->ds, session,
+            MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
+        goto cleanup;
+    }
+
+    /* add modules into mod_info with deps, locking, and their data */
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session), session->sid,
+            session->orig_name, session->orig_data, timeout_ms, 0, opts))) {
+        goto cleanup;
+    }
+
+    /* filter the required data */
+    if ((err_info = sr_modinfo_get_filter(&mod_info, (opts & SR_GET_NO_FILTER) ? "/*" : xpath, session, &set))) {
+        goto cleanup;
+    }
+
+    /* get rid of all redundant results that are descendants of another result */
+    if ((err_info = sr_xpath_set_filter_subtrees(set))) {
+        goto cleanup;
+    }
+
+    /* duplicate all the selected subtrees */
+    if ((err_info = sr_get_data_dup(session, set, 0, set->count, max_depth, &(*data)->tree))) {
+        goto cleanup;
+    }
+
+cleanup:
+    /* MODULES UNLOCK */
+    sr_shmmod_modinfo_unlock(&mod_info);
+
+    ly_set_free(set, NULL);
+    sr_modinfo_erase(&mod_info);
+
+    if (err_info || !(*data)->tree) {
+        sr_release_data(*data);
+        *data = NULL;
+    }
+    sr_timing_request_end(session, "get data", &ts);
+    return sr_api_ret(session, err_info);
+}
+
+API int
+sr_get_data_iter_open(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
+        const sr_get_options_t opts, const char *resume_path, sr_get_data_iter_t **iter)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_mod_info_s *mod_info;
+    struct lyd_node *node;
+    uint32_t idx;
+
+    SR_CHECK_ARG_APIRET(!session || !xpath || !iter || ((session->ds != SR_DS_OPERATIONAL) && (opts & SR_OPER_MASK)),
+            session, err_info);
+
+    if (!timeout_ms) {
+        timeout_ms = SR_OPER_CB_TIMEOUT;
+    }
+
+    /* allocate the iterator */
+    *iter = calloc(1, sizeof **iter);
+    SR_CHECK_MEM_GOTO(!*iter, err_info, error);
+    (*iter)->session = session;
+    (*iter)->max_depth = max_depth;
+    (*iter)->mod_info = mod_info = calloc(1, sizeof *mod_info);
+    SR_CHECK_MEM_GOTO(!mod_info, err_info, error);
+
+    /* for operational, use operational and running datastore */
+    SR_MODINFO_INIT(*mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info->nacm_user = session->nacm_user;
+    if (!(opts & SR_GET_NO_FILTER)) {
+        /* providers of operational data may use it */
+        mod_info->max_depth = max_depth;
+    }
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, xpath))) {
+        goto error;
+    }
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+        goto error;
+    }
+    (*iter)->ctx_locked = 1;
+
+    /* collect all required modules */
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, xpath, session->ds, session,
+            MOD_INFO_XPATH_STORE_SESSION_CHANGES, mod_info))) {
+        goto error_unlock;
+    }
+
+    /* add modules into mod_info with deps, locking, and their data */
+    if ((err_info = sr_modinfo_consolidate(mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session), session->sid,
+            session->orig_name, session->orig_data, timeout_ms, 0, opts))) {
+        goto error_unlock;
+    }
+
+    /* filter the required data */
+    if ((err_info = sr_modinfo_get_filter(mod_info, (opts & SR_GET_NO_FILTER) ? "/*" : xpath, session, &(*iter)->set))) {
+        goto error_unlock;
+    }
+
+    /* MODULES UNLOCK, the data are owned by mod_info or are a referenced cache snapshot */
+    sr_shmmod_modinfo_unlock(mod_info);
+
+    /* get rid of all redundant results that are descendants of another result */
+    if ((err_info = sr_xpath_set_filter_subtrees((*iter)->set))) {
+        goto error;
+    }
+
+    if (resume_path) {
+        /* continue after the resume node */
+        if ((err_info = sr_lyd_find_path(mod_info->data, resume_path, 0, &node))) {
+            goto error;
+        }
+        if (!node || !ly_set_contains((*iter)->set, node, &idx)) {
+            sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, "Resume node \"%s\" not found among the selected data.",
+                    resume_path);
+            goto error;
+        }
+        (*iter)->idx = idx + 1;
+    }
+
+    return sr_api_ret(session, NULL);
+
+error_unlock:
+    /* MODULES UNLOCK */
+    sr_shmmod_modinfo_unlock(mod_info);
+
+error:
+    sr_get_data_iter_free(*iter);
+    *iter = NULL;
     return sr_api_ret(session, err_info);
 }
 
+API int
+sr_get_data_iter_next(sr_get_data_iter_t *iter, uint32_t count, sr_data_t **data)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_session_ctx_t *session;
+    uint32_t chunk;
+
+    SR_CHECK_ARG_APIRET(!iter || !count || !data, iter ? iter->session : NULL, err_info);
+
+    session = iter->session;
+    *data = NULL;
+
+    if (iter->idx == iter->set->count) {
+        /* no more data */
+        return SR_ERR_NOT_FOUND;
+    }
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(session, err_info);
+    }
+
+    /* prepare data wrapper */
+    if ((err_info = _sr_acquire_data(session->conn, NULL, data))) {
+        return sr_api_ret(session, err_info);
+    }
+
+    /* duplicate the next subtrees, skip chunks completely filtered out by NACM */
+    while (!(*data)->tree && (iter->idx < iter->set->count)) {
+        chunk = (iter->set->count - iter->idx < count) ? iter->set->count - iter->idx : count;
+        if ((err_info = sr_get_data_dup(session, iter->set, iter->idx, chunk, iter->max_depth, &(*data)->tree))) {
+            goto cleanup;
+        }
+        iter->idx += chunk;
+    }
+
+cleanup:
+    if (err_info || !(*data)->tree) {
+        sr_release_data(*data);
+        *data = NULL;
+    }
+    if (!err_info && !*data) {
+        return SR_ERR_NOT_FOUND;
+    }
+    return sr_api_ret(session, err_info);
+}
+
+API void
+sr_get_data_iter_free(sr_get_data_iter_t *iter)
+{
+    if (!iter) {
+        return;
+    }
+
+    ly_set_free(iter->set, NULL);
+    if (iter->mod_info) {
+        sr_modinfo_erase(iter->mod_info);
+        free(iter->mod_info);
+    }
+
+    if (iter->ctx_locked) {
+        /* CONTEXT UNLOCK */
+        sr_lycc_unlock(iter->session->conn, SR_LOCK_READ, 0, __func__);
+    }
+
+    free(iter);
+}
+
 API int
 sr_get_node(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr_data_t **node)
 {
@@ -3184,6 +3718,12 @@ sr_get_node(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
 
     /* for operational, use operational and running datastore */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
+    mod_info.nacm_user = session->nacm_user;
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -3196,13 +3736,13 @@ sr_get_node(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
     }
 
     /* collect all required modules */
-    if ((err_info = sr_modinfo_collect_xpath(session->conn->ly_ctx, path, session->ds, session,
+    if ((err_info = sr_modinfo_collect_xpath(session->conn, path, session->ds, session,
             MOD_INFO_XPATH_STORE_SESSION_CHANGES, &mod_info))) {
         goto cleanup;
     }
 
     /* add modules into mod_info with deps, locking, and their data */
-    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_DATA_RO | SR_MI_PERM_READ,
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_READ, SR_MI_READ_OPTS(session),
             session->sid, session->orig_name, session->orig_data, timeout_ms, 0, 0))) {
         goto cleanup;
     }
@@ -3305,6 +3845,11 @@ sr_free_values(sr_val_t *values, size_t count)
         return;
     }
 
+    if (sr_vals_arena_free(values, count)) {
+        /* single block freed */
+        return;
+    }
+
     for (i = 0; i < count; ++i) {
         free(values[i].xpath);
         free(values[i].origin);
@@ -3341,6 +3886,11 @@ sr_set_item(sr_session_ctx_t *session, const char *path, const sr_val_t *value,
         path = value->xpath;
     }
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -3355,6 +3905,37 @@ sr_set_item(sr_session_ctx_t *session, const char *path, const sr_val_t *value,
     return sr_set_item_str(session, path, str_val, value ? value->origin : NULL, opts);
 }
 
+/**
+ * @brief Learn the edit operation for deleting a node.
+ *
+ * @param[in] session Session to use.
+ * @param[in] path Path of the node to delete.
+ * @param[in] opts Edit options.
+ * @return Edit operation.
+ */
+static const char *
+sr_delete_item_oper(sr_session_ctx_t *session, const char *path, const sr_edit_options_t opts)
+{
+    const char *operation;
+    const struct lysc_node *snode;
+    uint32_t temp_lo = 0;
+
+    /* turn off logging */
+    ly_temp_log_options(&temp_lo);
+    if ((path[strlen(path) - 1] != ']') && (snode = lys_find_path(session->conn->ly_ctx, NULL, path, 0)) &&
+            (snode->nodetype & (LYS_LEAFLIST | LYS_LIST)) &&
+            !strcmp((path + strlen(path)) - strlen(snode->name), snode->name)) {
+        operation = "purge";
+    } else if (opts & SR_EDIT_STRICT) {
+        operation = "delete";
+    } else {
+        operation = "remove";
+    }
+    ly_temp_log_options(NULL);
+
+    return operation;
+}
+
 API int
 sr_set_item_str(sr_session_ctx_t *session, const char *path, const char *value, const char *origin,
         const sr_edit_options_t opts)
@@ -3376,6 +3957,11 @@ sr_set_item_str(sr_session_ctx_t *session, const char *path, const char *value,
         }
     }
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        goto cleanup;
+    }
+
     if (!session->dt[session->ds].edit) {
         /* CONTEXT LOCK */
         if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -3390,7 +3976,7 @@ sr_set_item_str(sr_session_ctx_t *session, const char *path, const char *value,
 
     /* add the operation into edit */
     err_info = sr_edit_add(session, path, value, opts & SR_EDIT_STRICT ? "create" : "merge",
-            opts & SR_EDIT_NON_RECURSIVE ? "none" : "merge", NULL, NULL, NULL, pref_origin, opts & SR_EDIT_ISOLATE);
+            opts & SR_EDIT_NON_RECURSIVE ? "none" : "merge", NULL, NULL, NULL, pref_origin, opts & SR_EDIT_ISOLATE, NULL);
 
 cleanup:
     if (session->dt[session->ds].edit && !session->dt[session->ds].edit->tree) {
@@ -3402,14 +3988,27 @@ cleanup:
 }
 
 API int
-sr_delete_item(sr_session_ctx_t *session, const char *path, const sr_edit_options_t opts)
+sr_set_items(sr_session_ctx_t *session, const sr_edit_item_t *items, uint32_t item_count, const char *origin,
+        const sr_edit_options_t opts)
 {
     sr_error_info_t *err_info = NULL;
-    const char *operation;
-    const struct lysc_node *snode;
-    uint32_t temp_lo = 0;
+    struct sr_edit_add_cache_s cache = {0};
+    char *pref_origin = NULL;
+    uint32_t i;
 
-    SR_CHECK_ARG_APIRET(!session || !path || SR_EDIT_DS_API_CHECK(session->ds, opts), session, err_info);
+    SR_CHECK_ARG_APIRET(!session || (!items && item_count) || SR_EDIT_DS_API_CHECK(session->ds, opts), session, err_info);
+
+    /* we do not need any lock, ext SHM is not accessed */
+
+    if (origin) {
+        if (!strchr(origin, ':')) {
+            /* add ietf-origin prefix if none used */
+            pref_origin = malloc(11 + 1 + strlen(origin) + 1);
+            sprintf(pref_origin, "ietf-origin:%s", origin);
+        } else {
+            pref_origin = strdup(origin);
+        }
+    }
 
     if (!session->dt[session->ds].edit) {
         /* CONTEXT LOCK */
@@ -3423,22 +4022,307 @@ sr_delete_item(sr_session_ctx_t *session, const char *path, const sr_edit_option
         }
     }
 
-    /* turn off logging */
-    ly_temp_log_options(&temp_lo);
-    if ((path[strlen(path) - 1] != ']') && (snode = lys_find_path(session->conn->ly_ctx, NULL, path, 0)) &&
-            (snode->nodetype & (LYS_LEAFLIST | LYS_LIST)) &&
-            !strcmp((path + strlen(path)) - strlen(snode->name), snode->name)) {
-        operation = "purge";
-    } else if (opts & SR_EDIT_STRICT) {
-        operation = "delete";
-    } else {
-        operation = "remove";
+    for (i = 0; i < item_count; ++i) {
+        if (!items[i].xpath) {
+            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Missing path of item %" PRIu32 ".", i);
+            goto cleanup;
+        }
+
+        /* add the operation into edit, reuse the last created edit node */
+        if (items[i].oper == SR_EDIT_ITEM_DELETE) {
+            err_info = sr_edit_add(session, items[i].xpath, NULL, sr_delete_item_oper(session, items[i].xpath, opts),
+                    opts & SR_EDIT_STRICT ? "none" : "ether", NULL, NULL, NULL, NULL, opts & SR_EDIT_ISOLATE, &cache);
+        } else {
+            err_info = sr_edit_add(session, items[i].xpath, items[i].value, opts & SR_EDIT_STRICT ? "create" : "merge",
+                    opts & SR_EDIT_NON_RECURSIVE ? "none" : "merge", NULL, NULL, NULL, pref_origin,
+                    opts & SR_EDIT_ISOLATE, &cache);
+        }
+        if (err_info) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (session->dt[session->ds].edit && !session->dt[session->ds].edit->tree) {
+        sr_release_data(session->dt[session->ds].edit);
+        session->dt[session->ds].edit = NULL;
+    }
+    free(pref_origin);
+    return sr_api_ret(session, err_info);
+}
+
+/**
+ * @brief Parse an edit template path.
+ *
+ * @param[in] path Template path with placeholders.
+ * @param[in,out] tmpl Edit template to fill.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_edit_template_parse(const char *path, sr_edit_template_t *tmpl)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *ptr, *end;
+    char quot = 0;
+    uint32_t depth = 0, len, spath_len = 0, i;
+    void *mem;
+
+    tmpl->path = malloc(strlen(path) + 1);
+    tmpl->spath = malloc(strlen(path) + 1);
+    SR_CHECK_MEM_RET(!tmpl->path || !tmpl->spath, err_info);
+
+    for (ptr = path; ptr[0]; ++ptr) {
+        if (quot) {
+            /* quoted literal, copied as is */
+            if (ptr[0] == quot) {
+                quot = 0;
+            }
+        } else if ((ptr[0] == '\'') || (ptr[0] == '\"')) {
+            quot = ptr[0];
+        } else if (ptr[0] == '[') {
+            ++depth;
+        } else if (ptr[0] == ']') {
+            if (!depth) {
+                goto invalid;
+            }
+            --depth;
+            tmpl->path[tmpl->path_len++] = ptr[0];
+            continue;
+        } else if (ptr[0] == '$') {
+            /* placeholder, only instead of a predicate literal */
+            for (len = tmpl->path_len; len && isspace(tmpl->path[len - 1]); --len) {}
+            if (!depth || !len || (tmpl->path[len - 1] != '=')) {
+                goto invalid;
+            }
+            for (end = ptr + 1; isalnum(end[0]) || (end[0] == '_') || (end[0] == '-') || (end[0] == '.'); ++end) {}
+            for (i = 0; isspace(end[i]); ++i) {}
+            if ((end == ptr + 1) || (end[i] != ']')) {
+                goto invalid;
+            }
+
+            mem = realloc(tmpl->arg_pos, (tmpl->arg_count + 1) * sizeof *tmpl->arg_pos);
+            SR_CHECK_MEM_RET(!mem, err_info);
+            tmpl->arg_pos = mem;
+            tmpl->arg_pos[tmpl->arg_count++] = tmpl->path_len;
+
+            ptr = end - 1;
+            continue;
+        }
+
+        tmpl->path[tmpl->path_len++] = ptr[0];
+        if (!depth) {
+            tmpl->spath[spath_len++] = ptr[0];
+        }
+    }
+    if (quot || depth) {
+        goto invalid;
+    }
+    tmpl->path[tmpl->path_len] = '\0';
+    tmpl->spath[spath_len] = '\0';
+
+    return NULL;
+
+invalid:
+    sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Invalid edit template path \"%s\".", path);
+    return err_info;
+}
+
+API int
+sr_edit_template_new(sr_conn_ctx_t *conn, const char *path, sr_edit_template_t **tmpl)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || !path || !tmpl, NULL, err_info);
+
+    *tmpl = calloc(1, sizeof **tmpl);
+    SR_CHECK_MEM_GOTO(!*tmpl, err_info, cleanup);
+
+    /* parse the path, it is bound to a context only when used */
+    if ((err_info = sr_edit_template_parse(path, *tmpl))) {
+        goto cleanup;
+    }
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, NULL, (*tmpl)->spath))) {
+        goto cleanup;
+    }
+
+cleanup:
+    if (err_info) {
+        sr_edit_template_free(*tmpl);
+        *tmpl = NULL;
+    }
+    return sr_api_ret(NULL, err_info);
+}
+
+/**
+ * @brief Bind arguments of an instance to an edit template path.
+ *
+ * @param[in] tmpl Edit template.
+ * @param[in] args Arguments of the instance.
+ * @param[in] idx Index of the buffer to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_edit_template_bind(sr_edit_template_t *tmpl, const char **args, uint32_t idx)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i, size, len, prev;
+    char quot;
+    void *mem;
+
+    /* learn the length of the path */
+    size = tmpl->path_len + 1;
+    for (i = 0; i < tmpl->arg_count; ++i) {
+        if (!args[i]) {
+            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Missing edit template argument %" PRIu32 ".", i);
+            return err_info;
+        }
+        size += strlen(args[i]) + 2;
+    }
+
+    if (tmpl->buf_size[idx] < size) {
+        mem = realloc(tmpl->buf[idx], size);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        tmpl->buf[idx] = mem;
+        tmpl->buf_size[idx] = size;
+    }
+
+    /* insert the quoted arguments */
+    len = 0;
+    prev = 0;
+    for (i = 0; i < tmpl->arg_count; ++i) {
+        if (!strchr(args[i], '\'')) {
+            quot = '\'';
+        } else if (!strchr(args[i], '\"')) {
+            quot = '\"';
+        } else {
+            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Edit template argument \"%s\" includes both quotes.", args[i]);
+            return err_info;
+        }
+
+        memcpy(tmpl->buf[idx] + len, tmpl->path + prev, tmpl->arg_pos[i] - prev);
+        len += tmpl->arg_pos[i] - prev;
+        len += sprintf(tmpl->buf[idx] + len, "%c%s%c", quot, args[i], quot);
+        prev = tmpl->arg_pos[i];
+    }
+    strcpy(tmpl->buf[idx] + len, tmpl->path + prev);
+
+    return NULL;
+}
+
+API int
+sr_edit_template_set(sr_session_ctx_t *session, sr_edit_template_t *tmpl, const char **args, const char **values,
+        uint32_t count, const char *origin, const sr_edit_options_t opts)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_edit_add_cache_s cache = {0};
+    char *pref_origin = NULL;
+    uint32_t i;
+
+    SR_CHECK_ARG_APIRET(!session || !tmpl || (!args && count && tmpl->arg_count) ||
+            SR_EDIT_DS_API_CHECK(session->ds, opts), session, err_info);
+
+    /* we do not need any lock, ext SHM is not accessed */
+
+    if (origin) {
+        if (!strchr(origin, ':')) {
+            /* add ietf-origin prefix if none used */
+            pref_origin = malloc(11 + 1 + strlen(origin) + 1);
+            sprintf(pref_origin, "ietf-origin:%s", origin);
+        } else {
+            pref_origin = strdup(origin);
+        }
+    }
+
+    if (!session->dt[session->ds].edit) {
+        /* CONTEXT LOCK */
+        if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+            goto cleanup;
+        }
+
+        /* prepare edit with context lock */
+        if ((err_info = _sr_acquire_data(session->conn, NULL, &session->dt[session->ds].edit))) {
+            goto cleanup;
+        }
+    }
+
+    if ((tmpl->ly_ctx != session->conn->ly_ctx) || (tmpl->content_id != session->conn->content_id)) {
+        /* (re)bind the schema path to the current context */
+        tmpl->ly_ctx = NULL;
+        if ((err_info = sr_lys_find_path(session->conn->ly_ctx, tmpl->spath, NULL, &tmpl->snode))) {
+            goto cleanup;
+        }
+        tmpl->ly_ctx = session->conn->ly_ctx;
+        tmpl->content_id = session->conn->content_id;
+    }
+
+    /* the schema of the paths is valid, only the arguments differ */
+    cache.valid = 1;
+    for (i = 0; i < count; ++i) {
+        if ((err_info = sr_edit_template_bind(tmpl, args ? args + i * tmpl->arg_count : NULL, i % 2))) {
+            goto cleanup;
+        }
+
+        /* add the operation into edit, reuse the last created edit node */
+        if ((err_info = sr_edit_add(session, tmpl->buf[i % 2], values ? values[i] : NULL,
+                opts & SR_EDIT_STRICT ? "create" : "merge", opts & SR_EDIT_NON_RECURSIVE ? "none" : "merge", NULL, NULL,
+                NULL, pref_origin, opts & SR_EDIT_ISOLATE, &cache))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (session->dt[session->ds].edit && !session->dt[session->ds].edit->tree) {
+        sr_release_data(session->dt[session->ds].edit);
+        session->dt[session->ds].edit = NULL;
+    }
+    free(pref_origin);
+    return sr_api_ret(session, err_info);
+}
+
+API void
+sr_edit_template_free(sr_edit_template_t *tmpl)
+{
+    if (!tmpl) {
+        return;
+    }
+
+    free(tmpl->path);
+    free(tmpl->arg_pos);
+    free(tmpl->spath);
+    free(tmpl->buf[0]);
+    free(tmpl->buf[1]);
+    free(tmpl);
+}
+
+API int
+sr_delete_item(sr_session_ctx_t *session, const char *path, const sr_edit_options_t opts)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session || !path || SR_EDIT_DS_API_CHECK(session->ds, opts), session, err_info);
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        goto cleanup;
+    }
+
+    if (!session->dt[session->ds].edit) {
+        /* CONTEXT LOCK */
+        if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+            goto cleanup;
+        }
+
+        /* prepare edit with context lock */
+        if ((err_info = _sr_acquire_data(session->conn, NULL, &session->dt[session->ds].edit))) {
+            goto cleanup;
+        }
     }
-    ly_temp_log_options(NULL);
 
     /* add the operation into edit */
-    err_info = sr_edit_add(session, path, NULL, operation, opts & SR_EDIT_STRICT ? "none" : "ether", NULL, NULL, NULL,
-            NULL, opts & SR_EDIT_ISOLATE);
+    err_info = sr_edit_add(session, path, NULL, sr_delete_item_oper(session, path, opts),
+            opts & SR_EDIT_STRICT ? "none" : "ether", NULL, NULL, NULL, NULL, opts & SR_EDIT_ISOLATE, NULL);
 
 cleanup:
     if (session->dt[session->ds].edit && !session->dt[session->ds].edit->tree) {
@@ -3493,6 +4377,153 @@ cleanup:
     return sr_api_ret(session, err_info);
 }
 
+API int
+sr_oper_slot_add(sr_session_ctx_t *session, const char *path, const char *value, sr_oper_slot_t **slot)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *parent = NULL, *node;
+    const struct lys_module *ly_mod;
+    sr_mod_t *shm_mod;
+    char *leaf_path = NULL;
+    size_t value_len;
+
+    SR_CHECK_ARG_APIRET(!session || (session->ds != SR_DS_OPERATIONAL) || !path || !value || !slot, session, err_info);
+
+    *slot = NULL;
+
+    value_len = strlen(value);
+    if (value_len >= SR_OPER_SLOT_VALUE_LEN) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Value \"%s\" is too long for an operational value slot.", value);
+        return sr_api_ret(session, err_info);
+    }
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
+    /* CONTEXT LOCK */
+    if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
+        return sr_api_ret(session, err_info);
+    }
+
+    /* check the leaf */
+    if ((err_info = sr_lyd_new_path(NULL, session->conn->ly_ctx, path, value, 0, &parent, &node))) {
+        goto cleanup_unlock;
+    }
+    if (!node || (node->schema->nodetype != LYS_LEAF) || !(node->schema->flags & LYS_CONFIG_R)) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Path \"%s\" does not identify a state leaf.", path);
+        goto cleanup_unlock;
+    }
+    ly_mod = node->schema->module;
+
+    /* check write perm */
+    if ((err_info = sr_perm_check(session->conn, ly_mod, SR_DS_OPERATIONAL, 1, NULL))) {
+        goto cleanup_unlock;
+    }
+
+    leaf_path = lyd_path(node, LYD_PATH_STD, NULL, 0);
+    SR_CHECK_MEM_GOTO(!leaf_path, err_info, cleanup_unlock);
+    if (strlen(leaf_path) >= SR_OPER_SLOT_PATH_LEN) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Path \"%s\" is too long for an operational value slot.", leaf_path);
+        goto cleanup_unlock;
+    }
+
+    *slot = calloc(1, sizeof **slot);
+    SR_CHECK_MEM_GOTO(!*slot, err_info, cleanup_unlock);
+    (*slot)->cid = session->conn->cid;
+
+    /* map the slots of the module */
+    if ((err_info = sr_oper_slots_shm_map(ly_mod->name, 1, &(*slot)->shm))) {
+        goto cleanup_unlock;
+    }
+
+    /* allocate a slot */
+    if ((err_info = sr_oper_slot_alloc((sr_oper_slots_shm_t *)(*slot)->shm.addr, (*slot)->cid, leaf_path, value,
+            value_len, &(*slot)->idx))) {
+        goto cleanup_unlock;
+    }
+
+    /* the readers must map the slots of the module */
+    shm_mod = sr_shmmod_find_module(SR_CONN_MOD_SHM(session->conn), ly_mod->name);
+    SR_CHECK_INT_GOTO(!shm_mod, err_info, cleanup_unlock);
+    ATOMIC_STORE_RELAXED(shm_mod->oper_slots, 1);
+
+cleanup_unlock:
+    /* CONTEXT UNLOCK */
+    sr_lycc_unlock(session->conn, SR_LOCK_READ, 0, __func__);
+
+    lyd_free_all(parent);
+    free(leaf_path);
+    if (err_info && *slot) {
+        sr_shm_clear(&(*slot)->shm);
+        free(*slot);
+        *slot = NULL;
+    }
+    return sr_api_ret(session, err_info);
+}
+
+/**
+ * @brief Check that an operational value slot handle is valid and still owns its slot.
+ *
+ * @param[in] slot Slot handle to check.
+ * @return Whether the handle is valid.
+ */
+static int
+sr_oper_slot_check(const sr_oper_slot_t *slot)
+{
+    sr_oper_slot_shm_t *slot_shm;
+
+    if (!slot->shm.addr || (slot->shm.size != sizeof(sr_oper_slots_shm_t)) || (slot->idx >= SR_OPER_SLOT_COUNT) ||
+            !slot->cid) {
+        return 0;
+    }
+
+    slot_shm = &((sr_oper_slots_shm_t *)slot->shm.addr)->slots[slot->idx];
+    return ATOMIC_LOAD_RELAXED(slot_shm->cid) == slot->cid;
+}
+
+API int
+sr_oper_slot_set(sr_oper_slot_t *slot, const char *value)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t value_len;
+
+    SR_CHECK_ARG_APIRET(!slot || !value || !sr_oper_slot_check(slot), NULL, err_info);
+
+    value_len = strlen(value);
+    if (value_len >= SR_OPER_SLOT_VALUE_LEN) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Value \"%s\" is too long for an operational value slot.", value);
+        return sr_api_ret(NULL, err_info);
+    }
+
+    /* update the value in-place */
+    sr_oper_slot_write(&((sr_oper_slots_shm_t *)slot->shm.addr)->slots[slot->idx], NULL, value, value_len);
+
+    return sr_api_ret(NULL, NULL);
+}
+
+API int
+sr_oper_slot_del(sr_oper_slot_t *slot)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_oper_slot_shm_t *slot_shm;
+
+    if (!slot) {
+        return sr_api_ret(NULL, NULL);
+    }
+    SR_CHECK_ARG_APIRET(!sr_oper_slot_check(slot), NULL, err_info);
+
+    /* free the slot, the cleared slot must be visible before it can be taken over */
+    slot_shm = &((sr_oper_slots_shm_t *)slot->shm.addr)->slots[slot->idx];
+    sr_oper_slot_write(slot_shm, "", "", 0);
+    ATOMIC_STORE_RELEASE(slot_shm->cid, 0);
+
+    sr_shm_clear(&slot->shm);
+    free(slot);
+    return sr_api_ret(NULL, NULL);
+}
+
 API int
 sr_move_item(sr_session_ctx_t *session, const char *path, const sr_move_position_t position, const char *list_keys,
         const char *leaflist_value, const char *origin, const sr_edit_options_t opts)
@@ -3512,6 +4543,11 @@ sr_move_item(sr_session_ctx_t *session, const char *path, const sr_move_position
         }
     }
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        goto cleanup;
+    }
+
     if (!session->dt[session->ds].edit) {
         /* CONTEXT LOCK */
         if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -3527,7 +4563,7 @@ sr_move_item(sr_session_ctx_t *session, const char *path, const sr_move_position
     /* add the operation into edit */
     err_info = sr_edit_add(session, path, NULL, opts & SR_EDIT_STRICT ? "create" : "merge",
             opts & SR_EDIT_NON_RECURSIVE ? "none" : "merge", &position, list_keys, leaflist_value, pref_origin,
-            opts & SR_EDIT_ISOLATE);
+            opts & SR_EDIT_ISOLATE, NULL);
 
 cleanup:
     if (session->dt[session->ds].edit && !session->dt[session->ds].edit->tree) {
@@ -3638,6 +4674,11 @@ sr_validate(sr_session_ctx_t *session, const char *module_name, uint32_t timeout
     /* for operational, use operational and running datastore */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds == SR_DS_OPERATIONAL ? SR_DS_RUNNING : session->ds);
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, module_name, NULL))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -3765,6 +4806,7 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     uint32_t sid = 0;
     char *orig_name = NULL;
     void *orig_data = NULL;
+    struct timespec ts;
 
     *cb_err_info = NULL;
 
@@ -3808,6 +4850,17 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     switch (mod_info->ds) {
     case SR_DS_STARTUP:
     case SR_DS_RUNNING:
+        if (sr_modinfo_diff_is_value_only(mod_info)) {
+            /* new values cannot affect validity of the data, no need to load the dependencies and validate */
+            SR_LOG_DBG("Only values of \"%s\" datastore leaves changed, skipping validation.", sr_ds2str(mod_info->ds));
+            break;
+        }
+
+        /* learn which inverse dependencies need to be validated */
+        if ((err_info = sr_modinfo_inv_deps_skip(mod_info))) {
+            goto cleanup;
+        }
+
         /* collect validation dependencies and add those to mod_info as well */
         if ((err_info = sr_modinfo_collect_deps(mod_info))) {
             goto cleanup;
@@ -3817,16 +4870,21 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
             goto cleanup;
         }
 
-        if ((err_info = sr_modinfo_validate(mod_info, MOD_INFO_CHANGED | MOD_INFO_INV_DEP, 1))) {
+        sr_timing_phase_start(mod_info->phase_us, &ts);
+        err_info = sr_modinfo_validate(mod_info, MOD_INFO_CHANGED | MOD_INFO_INV_DEP, 1);
+        sr_timing_phase_end(mod_info->phase_us, SR_PHASE_VALIDATE, &ts);
+        if (err_info) {
             goto cleanup;
         }
         break;
     case SR_DS_CANDIDATE:
         /* does not have to be valid but we need all default values and no state data */
-        if ((err_info = sr_modinfo_add_defaults(mod_info, 1))) {
-            goto cleanup;
+        sr_timing_phase_start(mod_info->phase_us, &ts);
+        if (!(err_info = sr_modinfo_add_defaults(mod_info, 1))) {
+            err_info = sr_modinfo_check_state_data(mod_info);
         }
-        if ((err_info = sr_modinfo_check_state_data(mod_info))) {
+        sr_timing_phase_end(mod_info->phase_us, SR_PHASE_VALIDATE, &ts);
+        if (err_info) {
             goto cleanup;
         }
         break;
@@ -3850,14 +4908,20 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* CHANGE SUB READ LOCK */
-    if ((err_info = sr_modinfo_changesub_rdlock(mod_info))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_modinfo_changesub_rdlock(mod_info);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_LOCK, &ts);
+    if (err_info) {
         goto cleanup;
     }
     change_sub_lock = SR_LOCK_READ;
 
     /* first publish "update" event for the diff to be updated */
-    if ((err_info = sr_modinfo_change_notify_update(mod_info, session, timeout_ms, &change_sub_lock, cb_err_info)) ||
-            *cb_err_info) {
+    mod_info->notified = 1;
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_modinfo_change_notify_update(mod_info, session, timeout_ms, &change_sub_lock, cb_err_info);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_NOTIFY, &ts);
+    if (err_info || *cb_err_info) {
         goto cleanup;
     }
 
@@ -3867,12 +4931,16 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* publish final diff in a "change" event for any subscribers and wait for them */
-    if ((err_info = sr_shmsub_change_notify_change(mod_info, orig_name, orig_data, timeout_ms, cb_err_info))) {
-        goto cleanup;
-    }
-    if (*cb_err_info) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_shmsub_change_notify_change(mod_info, orig_name, orig_data, timeout_ms, cb_err_info);
+    if (!err_info && *cb_err_info) {
         /* "change" event failed, publish "abort" event and finish */
         err_info = sr_shmsub_change_notify_change_abort(mod_info, orig_name, orig_data, timeout_ms);
+        sr_timing_phase_end(mod_info->phase_us, SR_PHASE_NOTIFY, &ts);
+        goto cleanup;
+    }
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_NOTIFY, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
@@ -3883,12 +4951,18 @@ store:
     }
 
     /* MODULES WRITE LOCK (upgrade) */
-    if ((err_info = sr_shmmod_modinfo_rdlock_upgrade(mod_info, sid, timeout_ms, timeout_ms))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_shmmod_modinfo_rdlock_upgrade(mod_info, sid, timeout_ms, timeout_ms);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_LOCK, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
     /* store updated datastore */
-    if ((err_info = sr_modinfo_data_store(mod_info))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_modinfo_data_store(mod_info);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_STORE, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
@@ -3898,12 +4972,16 @@ store:
     }
 
     /* publish "done" event, all changes were applied */
-    if ((err_info = sr_shmsub_change_notify_change_done(mod_info, orig_name, orig_data, timeout_ms))) {
-        goto cleanup;
-    }
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_shmsub_change_notify_change_done(mod_info, orig_name, orig_data, timeout_ms,
+            session ? session->async_done : 0);
 
     /* generate netconf-config-change notification */
-    if (session && (err_info = sr_modinfo_generate_config_change_notif(mod_info, session))) {
+    if (!err_info && session) {
+        err_info = sr_modinfo_generate_config_change_notif(mod_info, session);
+    }
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_NOTIFY, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
@@ -3919,24 +4997,29 @@ cleanup:
     return err_info;
 }
 
-API int
-sr_apply_changes(sr_session_ctx_t *session, uint32_t timeout_ms)
+/**
+ * @brief Apply edits of one or more sessions as a single transaction.
+ *
+ * @param[in] sessions Sessions with the edits to apply in this order, the first one is the originator of the changes.
+ * @param[in] session_count Count of @p sessions, must be 1 for operational DS.
+ * @param[in] timeout_ms Change callback timeout in milliseconds.
+ * @param[out] cb_err_info Callback error info in case an error occured.
+ * @param[out] notified Optional, set if any subscribers may have been notified about the changes.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_apply_changes_sessions(sr_session_ctx_t **sessions, uint32_t session_count, uint32_t timeout_ms,
+        sr_error_info_t **cb_err_info, int *notified)
 {
-    sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
+    sr_error_info_t *err_info = NULL;
+    sr_session_ctx_t *session = sessions[0];
     struct sr_mod_info_s mod_info;
-    uint32_t mi_opts;
-
-    SR_CHECK_ARG_APIRET(!session || !SR_IS_STANDARD_DS(session->ds), session, err_info);
-
-    if (!session->dt[session->ds].edit) {
-        return sr_api_ret(session, NULL);
-    }
+    uint32_t mi_opts, i;
+    struct timespec ts;
 
-    if (!timeout_ms) {
-        timeout_ms = SR_CHANGE_CB_TIMEOUT;
-    }
     /* even for operational datastore, we do not need any running data */
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds);
+    mod_info.phase_us = SR_SESS_PHASE_US(session);
 
     mi_opts = SR_MI_LOCK_UPGRADEABLE | SR_MI_PERM_NO;
     if ((session->ds != SR_DS_OPERATIONAL) && (session->ds != SR_DS_CANDIDATE)) {
@@ -3944,8 +5027,10 @@ sr_apply_changes(sr_session_ctx_t *session, uint32_t timeout_ms)
     } /* else stored oper edit or candidate data are not validated so we do not need data from other modules */
 
     /* collect all required modules */
-    if ((err_info = sr_modinfo_collect_edit(session->dt[session->ds].edit->tree, &mod_info))) {
-        goto cleanup;
+    for (i = 0; i < session_count; ++i) {
+        if ((err_info = sr_modinfo_collect_edit(sessions[i]->dt[session->ds].edit->tree, &mod_info))) {
+            goto cleanup;
+        }
     }
 
     /* add modules into mod_info with deps, locking, and their data */
@@ -3955,22 +5040,272 @@ sr_apply_changes(sr_session_ctx_t *session, uint32_t timeout_ms)
     }
 
     /* create diff */
+    sr_timing_phase_start(mod_info.phase_us, &ts);
     if (mod_info.ds == SR_DS_OPERATIONAL) {
+        assert(session_count == 1);
         err_info = sr_modinfo_edit_merge(&mod_info, session->dt[session->ds].edit->tree, 1);
     } else {
-        err_info = sr_modinfo_edit_apply(&mod_info, session->dt[session->ds].edit->tree, 1);
+        for (i = 0; (i < session_count) && !err_info; ++i) {
+            /* the diff of every edit is merged into the previous ones */
+            err_info = sr_modinfo_edit_apply(&mod_info, sessions[i]->dt[session->ds].edit->tree, 1);
+        }
     }
+    sr_timing_phase_end(mod_info.phase_us, SR_PHASE_EDIT, &ts);
     if (err_info) {
         goto cleanup;
     }
 
     /* notify all the subscribers and store the changes */
-    err_info = sr_changes_notify_store(&mod_info, session, timeout_ms, &cb_err_info);
+    err_info = sr_changes_notify_store(&mod_info, session, timeout_ms, cb_err_info);
 
 cleanup:
+    if (notified) {
+        *notified = mod_info.notified;
+    }
+
     /* MODULES UNLOCK */
     sr_shmmod_modinfo_unlock(&mod_info);
     sr_modinfo_erase(&mod_info);
+    return err_info;
+}
+
+/**
+ * @brief Create the error of a group commit member if the group failed after notifying subscribers.
+ *
+ * @param[out] member_err_info Member error info to create.
+ * @param[in] err_info Error of the group.
+ * @param[in] cb_err_info Callback error of the group.
+ */
+static void
+sr_apply_changes_group_err(sr_error_info_t **member_err_info, const sr_error_info_t *err_info,
+        const sr_error_info_t *cb_err_info)
+{
+    const sr_error_info_t *e = cb_err_info ? cb_err_info : err_info;
+
+    sr_errinfo_new(member_err_info, cb_err_info ? SR_ERR_CALLBACK_FAILED : e->err[e->err_count - 1].err_code,
+            "Changes applied in a group commit failed (%s).", e->err[e->err_count - 1].message);
+}
+
+/**
+ * @brief Wake the members of a group commit once it was applied and finish the group of the leader.
+ *
+ * Expected to be called with the GROUP COMMIT LOCK held, if locking failed it must still be called so that
+ * the members do not wait forever.
+ *
+ * @param[in] conn Connection of the group.
+ * @param[in] group Members of the group taken by the leader.
+ * @param[in] fallback Whether the members must apply their changes alone.
+ */
+static void
+sr_apply_changes_group_release(sr_conn_ctx_t *conn, struct sr_commit_group_s *group, int fallback)
+{
+    struct sr_commit_group_s *iter;
+
+    /* wake the members, they are not accessed after the lock is released */
+    for (iter = group; iter; iter = iter->next) {
+        iter->fallback = fallback;
+        iter->done = 1;
+    }
+    if (group) {
+        sr_cond_broadcast(&conn->commit_group_cond);
+    }
+    --conn->commit_group_applying;
+}
+
+/**
+ * @brief Apply changes of a session as part of a group commit, see ::SR_CONN_GROUP_COMMIT.
+ *
+ * If a leader of another session is collecting a group, join it and wait for it to be applied. Otherwise, if
+ * another session is applying its changes, become the leader, allow other sessions to join for
+ * ::SR_GROUP_COMMIT_WINDOW, and apply all the edits at once. Without a concurrent commit, apply the changes alone
+ * right away. If applying the group fails before any subscribers are notified, every session applies its own changes
+ * alone, otherwise all the sessions fail.
+ *
+ * @param[in] session Session with the edit to apply.
+ * @param[in] timeout_ms Change callback timeout in milliseconds, also the timeout for joining a group.
+ * @param[out] cb_err_info Callback error info in case an error occured.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_apply_changes_group(sr_session_ctx_t *session, uint32_t timeout_ms, sr_error_info_t **cb_err_info)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    sr_conn_ctx_t *conn = session->conn;
+    struct sr_commit_group_s member = {0}, *group = NULL, *iter, **member_p;
+    sr_session_ctx_t **sessions = NULL;
+    struct timespec timeout_abs;
+    uint32_t session_count, i;
+    int fallback = 1, notified = 0;
+
+    /* GROUP COMMIT LOCK */
+    if ((err_info = sr_mlock(&conn->commit_group_lock, -1, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    if (conn->commit_group_leader && (conn->commit_group_ds == session->ds)) {
+        /* join the group */
+        member.session = session;
+        member.next = conn->commit_group;
+        conn->commit_group = &member;
+
+        /* wait until the leader applies the group */
+        sr_timeouttime_get(&timeout_abs, timeout_ms);
+        while (!member.done) {
+            if (member.taken) {
+                /* the leader is applying the group and accesses the member once done */
+                sr_cond_wait(&conn->commit_group_cond, &conn->commit_group_lock);
+            } else if ((sr_cond_clockwait(&conn->commit_group_cond, &conn->commit_group_lock, COMPAT_CLOCK_ID,
+                    &timeout_abs) == ETIMEDOUT) && !member.taken) {
+                /* leave the group */
+                for (member_p = &conn->commit_group; *member_p != &member; member_p = &(*member_p)->next) {}
+                *member_p = member.next;
+
+                /* GROUP COMMIT UNLOCK */
+                sr_munlock(&conn->commit_group_lock);
+
+                sr_errinfo_new(&err_info, SR_ERR_TIME_OUT, "Waiting for a group commit timed out.");
+                return err_info;
+            }
+        }
+
+        /* GROUP COMMIT UNLOCK */
+        sr_munlock(&conn->commit_group_lock);
+
+        if (member.fallback) {
+            /* subscribers were not notified, apply alone */
+            return sr_apply_changes_sessions(&session, 1, timeout_ms, cb_err_info, NULL);
+        }
+        return member.err_info;
+    }
+
+    if (conn->commit_group_leader || !conn->commit_group_applying) {
+        /* incompatible group or no concurrent commit to group with */
+        ++conn->commit_group_applying;
+
+        /* GROUP COMMIT UNLOCK */
+        sr_munlock(&conn->commit_group_lock);
+
+        err_info = sr_apply_changes_sessions(&session, 1, timeout_ms, cb_err_info, NULL);
+        goto cleanup;
+    }
+
+    /* become the leader, there are concurrent commits */
+    conn->commit_group_leader = 1;
+    conn->commit_group_ds = session->ds;
+    ++conn->commit_group_applying;
+
+    /* GROUP COMMIT UNLOCK */
+    sr_munlock(&conn->commit_group_lock);
+
+    /* let other sessions join */
+    sr_msleep(SR_GROUP_COMMIT_WINDOW);
+
+    /* GROUP COMMIT LOCK */
+    if ((err_info = sr_mlock(&conn->commit_group_lock, -1, __func__, NULL, NULL))) {
+        /* stop leading anyway and let the joined members apply alone instead of waiting forever */
+        group = conn->commit_group;
+        conn->commit_group = NULL;
+        conn->commit_group_leader = 0;
+        sr_apply_changes_group_release(conn, group, 1);
+        return err_info;
+    }
+
+    /* take the group */
+    group = conn->commit_group;
+    conn->commit_group = NULL;
+    conn->commit_group_leader = 0;
+    for (iter = group; iter; iter = iter->next) {
+        iter->taken = 1;
+    }
+
+    /* GROUP COMMIT UNLOCK */
+    sr_munlock(&conn->commit_group_lock);
+
+    if (!group) {
+        /* no other session joined */
+        err_info = sr_apply_changes_sessions(&session, 1, timeout_ms, cb_err_info, NULL);
+        goto cleanup;
+    }
+
+    /* collect the sessions, in the order they joined */
+    session_count = 1;
+    for (iter = group; iter; iter = iter->next) {
+        ++session_count;
+    }
+    sessions = malloc(session_count * sizeof *sessions);
+    if (sessions) {
+        sessions[0] = session;
+        i = session_count;
+        for (iter = group; iter; iter = iter->next) {
+            sessions[--i] = iter->session;
+        }
+
+        /* apply the group */
+        err_info = sr_apply_changes_sessions(sessions, session_count, timeout_ms, cb_err_info, &notified);
+        if (!err_info && !*cb_err_info) {
+            fallback = 0;
+        } else if (notified) {
+            /* subscribers saw the changes of the group, every member fails with the group */
+            fallback = 0;
+            for (iter = group; iter; iter = iter->next) {
+                sr_apply_changes_group_err(&iter->err_info, err_info, *cb_err_info);
+            }
+        } else {
+            SR_LOG_DBG("Group commit of %" PRIu32 " sessions failed, applying the changes separately.", session_count);
+            sr_errinfo_free(&err_info);
+            sr_errinfo_free(cb_err_info);
+        }
+        free(sessions);
+    }
+
+    if (fallback) {
+        err_info = sr_apply_changes_sessions(&session, 1, timeout_ms, cb_err_info, NULL);
+    }
+
+cleanup:
+    /* GROUP COMMIT LOCK */
+    if ((tmp_err = sr_mlock(&conn->commit_group_lock, -1, __func__, NULL, NULL))) {
+        /* the members must not wait forever */
+        sr_apply_changes_group_release(conn, group, fallback);
+        sr_errinfo_merge(&err_info, tmp_err);
+        return err_info;
+    }
+
+    sr_apply_changes_group_release(conn, group, fallback);
+
+    /* GROUP COMMIT UNLOCK */
+    sr_munlock(&conn->commit_group_lock);
+
+    return err_info;
+}
+
+API int
+sr_apply_changes(sr_session_ctx_t *session, uint32_t timeout_ms)
+{
+    sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
+    struct timespec ts;
+
+    SR_CHECK_ARG_APIRET(!session || !SR_IS_STANDARD_DS(session->ds), session, err_info);
+
+    if (!session->dt[session->ds].edit) {
+        return sr_api_ret(session, NULL);
+    }
+
+    if (!timeout_ms) {
+        timeout_ms = SR_CHANGE_CB_TIMEOUT;
+    }
+
+    sr_timing_request_start(session, &ts);
+
+    if ((session->conn->opts & SR_CONN_GROUP_COMMIT) && (session->ds != SR_DS_OPERATIONAL) && !session->nacm_user &&
+            !session->orig_name) {
+        /* apply together with concurrent commits of other sessions */
+        err_info = sr_apply_changes_group(session, timeout_ms, &cb_err_info);
+    } else {
+        err_info = sr_apply_changes_sessions(&session, 1, timeout_ms, &cb_err_info, NULL);
+    }
+
+    sr_timing_request_end(session, "apply changes", &ts);
 
     if (!err_info && !cb_err_info) {
         /* free applied edit */
@@ -4068,6 +5403,12 @@ _sr_replace_config(sr_session_ctx_t *session, const struct lys_module *ly_mod, s
         goto cleanup;
     }
 
+    if (!mod_info.diff) {
+        /* the data are the same, there is nothing to notify about or store */
+        SR_LOG_INF("No \"%s\" datastore changes to apply.", sr_ds2str(mod_info.ds));
+        goto cleanup;
+    }
+
     /* notify all the subscribers and store the changes */
     err_info = sr_changes_notify_store(&mod_info, session, timeout_ms, &cb_err_info);
 
@@ -4096,6 +5437,11 @@ sr_replace_config(sr_session_ctx_t *session, const char *module_name, struct lyd
         goto cleanup;
     }
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, module_name, NULL))) {
+        goto cleanup;
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         goto cleanup;
@@ -4164,6 +5510,11 @@ sr_copy_config(sr_session_ctx_t *session, const char *module_name, sr_datastore_
         SR_MODINFO_INIT(mod_info, session->conn, src_datastore, src_datastore);
     }
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, module_name, NULL))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -4264,6 +5615,12 @@ sr_change_dslock(struct sr_mod_info_s *mod_info, uint32_t sid, int lock)
     struct sr_mod_info_mod_s *mod;
     struct sr_mod_lock_s *shm_lock;
 
+    if (lock && (ATOMIC_LOAD_RELAXED(SR_CONN_MAIN_SHM(mod_info->conn)->ds_lock[mod_info->ds].sid) == sid)) {
+        /* the modules are WRITE-locked so the DS lock of all the modules cannot change */
+        sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Datastore is already locked by this session %" PRIu32 ".", sid);
+        return err_info;
+    }
+
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
         shm_lock = &mod->shm_mod->data_lock_info[mod_info->ds];
@@ -4348,6 +5705,180 @@ error:
     return err_info;
 }
 
+/**
+ * @brief (Un)lock the datastore lock of all the modules.
+ *
+ * If not locked as a whole, the DS locks of all the modules are unlocked using ::sr_change_dslock().
+ *
+ * @param[in] mod_info Mod info with all the modules with data, WRITE-locked.
+ * @param[in] sid Sysrepo session ID.
+ * @param[in] lock Whether to lock or unlock.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_change_dslock_all(struct sr_mod_info_s *mod_info, uint32_t sid, int lock)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_main_ds_lock_s *main_lock = &SR_CONN_MAIN_SHM(mod_info->conn)->ds_lock[mod_info->ds];
+    struct sr_mod_info_mod_s *mod;
+    struct sr_mod_lock_s *shm_lock;
+    uint32_t i;
+    int ds_locked, modified, unlock_mods = 0;
+
+    /* MAIN DS LOCK */
+    if ((err_info = sr_mlock(&main_lock->lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+        return err_info;
+    }
+
+    /* held by another session, the modules could not have been WRITE-locked */
+    assert(!ATOMIC_LOAD_RELAXED(main_lock->sid) || (ATOMIC_LOAD_RELAXED(main_lock->sid) == sid));
+
+    if (!lock) {
+        if (ATOMIC_LOAD_RELAXED(main_lock->sid)) {
+            ATOMIC_STORE_RELAXED(main_lock->sid, 0);
+            memset(&main_lock->ts, 0, sizeof main_lock->ts);
+        } else {
+            /* the modules may all be DS-locked separately */
+            unlock_mods = 1;
+        }
+        goto cleanup;
+    }
+
+    if (ATOMIC_LOAD_RELAXED(main_lock->sid)) {
+        sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Datastore is already locked by this session %" PRIu32 ".", sid);
+        goto cleanup;
+    }
+
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+        shm_lock = &mod->shm_mod->data_lock_info[mod_info->ds];
+
+        /* DS LOCK */
+        if ((err_info = sr_mlock(&shm_lock->ds_lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+            goto cleanup;
+        }
+
+        /* held by another session, the module could not have been WRITE-locked */
+        ds_locked = shm_lock->ds_lock_sid ? 1 : 0;
+
+        /* DS UNLOCK */
+        sr_munlock(&shm_lock->ds_lock);
+
+        if (ds_locked) {
+            sr_errinfo_new(&err_info, SR_ERR_LOCKED, "Module \"%s\" is already locked by this session %" PRIu32 ".",
+                    mod->ly_mod->name, sid);
+            goto cleanup;
+        } else if (mod_info->ds == SR_DS_CANDIDATE) {
+            /* learn whether candidate was modified */
+            if ((err_info = mod->ds_handle[SR_DS_CANDIDATE]->plugin->candidate_modified_cb(mod->ly_mod,
+                    mod->ds_handle[SR_DS_CANDIDATE]->plg_data, &modified))) {
+                goto cleanup;
+            }
+
+            if (modified) {
+                sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, "Module \"%s\" candidate datastore data have "
+                        "already been modified.", mod->ly_mod->name);
+                goto cleanup;
+            }
+        }
+    }
+
+    /* DS-lock all the modules at once */
+    sr_realtime_get(&main_lock->ts);
+    ATOMIC_STORE_RELAXED(main_lock->sid, sid);
+
+cleanup:
+    /* MAIN DS UNLOCK */
+    sr_munlock(&main_lock->lock);
+
+    if (unlock_mods) {
+        err_info = sr_change_dslock(mod_info, sid, 0);
+    }
+    return err_info;
+}
+
+/**
+ * @brief Replace the datastore lock of all the modules held by a session with DS locks of each module.
+ *
+ * @param[in] session Session holding the datastore lock.
+ * @param[in] timeout_ms Timeout for locking the modules.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_change_dslock_all_split(sr_session_ctx_t *session, uint32_t timeout_ms)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    struct sr_main_ds_lock_s *main_lock = &SR_CONN_MAIN_SHM(session->conn)->ds_lock[session->ds];
+    struct sr_mod_info_s mod_info;
+    struct sr_mod_lock_s *shm_lock;
+    uint32_t i, j;
+
+    SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds);
+
+    /* collect all the modules and lock them the same way as for (un)locking them */
+    if ((err_info = sr_modinfo_add_all_modules_with_data(session->conn->ly_ctx, 0, &mod_info))) {
+        goto cleanup;
+    }
+    if ((err_info = sr_modinfo_consolidate(&mod_info, SR_LOCK_WRITE, SR_MI_DATA_NO | SR_MI_PERM_READ | SR_MI_PERM_STRICT,
+            session->sid, session->orig_name, session->orig_data, 0, timeout_ms, 0))) {
+        goto cleanup;
+    }
+
+    /* MAIN DS LOCK */
+    if ((err_info = sr_mlock(&main_lock->lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+        goto cleanup;
+    }
+
+    if (ATOMIC_LOAD_RELAXED(main_lock->sid) == session->sid) {
+        for (i = 0; i < mod_info.mod_count; ++i) {
+            shm_lock = &mod_info.mods[i].shm_mod->data_lock_info[mod_info.ds];
+
+            /* DS LOCK */
+            if ((err_info = sr_mlock(&shm_lock->ds_lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+                break;
+            }
+
+            shm_lock->ds_lock_sid = session->sid;
+            shm_lock->ds_lock_ts = main_lock->ts;
+
+            /* DS UNLOCK */
+            sr_munlock(&shm_lock->ds_lock);
+        }
+
+        if (err_info) {
+            /* revert the module DS locks, keep the datastore lock */
+            for (j = 0; j < i; ++j) {
+                shm_lock = &mod_info.mods[j].shm_mod->data_lock_info[mod_info.ds];
+
+                /* DS LOCK */
+                if ((tmp_err = sr_mlock(&shm_lock->ds_lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+                    sr_errinfo_free(&tmp_err);
+                    continue;
+                }
+
+                shm_lock->ds_lock_sid = 0;
+                memset(&shm_lock->ds_lock_ts, 0, sizeof shm_lock->ds_lock_ts);
+
+                /* DS UNLOCK */
+                sr_munlock(&shm_lock->ds_lock);
+            }
+        } else {
+            ATOMIC_STORE_RELAXED(main_lock->sid, 0);
+            memset(&main_lock->ts, 0, sizeof main_lock->ts);
+        }
+    }
+
+    /* MAIN DS UNLOCK */
+    sr_munlock(&main_lock->lock);
+
+cleanup:
+    /* MODULES UNLOCK */
+    sr_shmmod_modinfo_unlock(&mod_info);
+
+    sr_modinfo_erase(&mod_info);
+    return err_info;
+}
+
 /**
  * @brief (Un)lock a specific or all modules datastore locks.
  *
@@ -4368,6 +5899,11 @@ _sr_un_lock(sr_session_ctx_t *session, const char *module_name, int lock, uint32
 
     SR_MODINFO_INIT(mod_info, session->conn, session->ds, session->ds);
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, module_name, NULL))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -4380,6 +5916,14 @@ _sr_un_lock(sr_session_ctx_t *session, const char *module_name, int lock, uint32
             sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, "Module \"%s\" was not found in sysrepo.", module_name);
             goto cleanup;
         }
+
+        if (!lock && sr_module_all_ds_lockable(ly_mod) &&
+                (ATOMIC_LOAD_RELAXED(SR_CONN_MAIN_SHM(session->conn)->ds_lock[session->ds].sid) == session->sid)) {
+            /* only this module is unlocked, keep all the other modules locked */
+            if ((err_info = sr_change_dslock_all_split(session, timeout_ms))) {
+                goto cleanup;
+            }
+        }
     }
 
     /* collect all required modules and lock to wait until other sessions finish working with the data */
@@ -4398,7 +5942,12 @@ _sr_un_lock(sr_session_ctx_t *session, const char *module_name, int lock, uint32
     }
 
     /* DS-(un)lock them */
-    if ((err_info = sr_change_dslock(&mod_info, session->sid, lock))) {
+    if (ly_mod) {
+        err_info = sr_change_dslock(&mod_info, session->sid, lock);
+    } else {
+        err_info = sr_change_dslock_all(&mod_info, session->sid, lock);
+    }
+    if (err_info) {
         goto cleanup;
     }
 
@@ -4440,6 +5989,7 @@ sr_get_lock(sr_conn_ctx_t *conn, sr_datastore_t datastore, const char *module_na
     struct sr_mod_info_s mod_info;
     const struct lys_module *ly_mod = NULL;
     struct sr_mod_lock_s *shm_lock = NULL;
+    struct sr_main_ds_lock_s *main_lock;
     uint32_t i, sid;
     struct timespec ts;
     int ds_locked;
@@ -4454,6 +6004,11 @@ sr_get_lock(sr_conn_ctx_t *conn, sr_datastore_t datastore, const char *module_na
     }
     SR_MODINFO_INIT(mod_info, conn, datastore, datastore);
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, module_name, NULL))) {
+        return sr_api_ret(NULL, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(NULL, err_info);
@@ -4483,6 +6038,30 @@ sr_get_lock(sr_conn_ctx_t *conn, sr_datastore_t datastore, const char *module_na
         goto cleanup;
     }
 
+    /* check DS lock of all the modules */
+    main_lock = &SR_CONN_MAIN_SHM(conn)->ds_lock[datastore];
+
+    /* MAIN DS LOCK */
+    if ((err_info = sr_mlock(&main_lock->lock, SR_DS_LOCK_MUTEX_TIMEOUT, __func__, NULL, NULL))) {
+        goto cleanup;
+    }
+    sid = ATOMIC_LOAD_RELAXED(main_lock->sid);
+    ts = main_lock->ts;
+
+    /* MAIN DS UNLOCK */
+    sr_munlock(&main_lock->lock);
+
+    if (sid && (!ly_mod || sr_module_all_ds_lockable(ly_mod))) {
+        *is_locked = 1;
+        if (id) {
+            *id = sid;
+        }
+        if (timestamp) {
+            *timestamp = ts;
+        }
+        goto cleanup;
+    }
+
     /* check DS-lock of the module(s) */
     ds_locked = 1;
     sid = 0;
@@ -4555,7 +6134,7 @@ sr_subscription_process_events(sr_subscription_ctx_t *subscription, sr_session_c
 {
     sr_error_info_t *err_info = NULL;
     int ret, mod_finished;
-    char buf[1];
+    char buf[64];
     uint32_t i;
     sr_lock_mode_t ctx_mode = SR_LOCK_NONE;
 
@@ -4574,10 +6153,11 @@ sr_subscription_process_events(sr_subscription_ctx_t *subscription, sr_session_c
         return sr_api_ret(session, err_info);
     }
 
-    /* read all bytes from the pipe, there can be several events by now */
+    /* read all bytes from the pipe, there can be several events by now, all of them are processed at once so
+     * drain the wakeups of all the subscriptions in as few reads as possible */
     do {
-        ret = read(subscription->evpipe, buf, 1);
-    } while (ret == 1);
+        ret = read(subscription->evpipe, buf, sizeof buf);
+    } while (ret == (int)sizeof buf);
     if ((ret == -1) && (errno != EAGAIN)) {
         SR_ERRINFO_SYSERRNO(&err_info, "read");
         sr_errinfo_new(&err_info, SR_ERR_INTERNAL, "Failed to read from an event pipe.");
@@ -4590,6 +6170,12 @@ sr_subscription_process_events(sr_subscription_ctx_t *subscription, sr_session_c
     }
     ctx_mode = SR_LOCK_READ;
 
+    if (subscription->worker_count) {
+        /* change, operational get, and RPC/action subscriptions are handled by the worker threads */
+        sr_shmsub_listen_workers_wake(subscription);
+        goto oper_poll;
+    }
+
     /* change subscriptions */
     for (i = 0; i < subscription->change_sub_count; ++i) {
         if ((err_info = sr_shmsub_change_listen_process_module_events(&subscription->change_subs[i], subscription->conn))) {
@@ -4604,6 +6190,7 @@ sr_subscription_process_events(sr_subscription_ctx_t *subscription, sr_session_c
         }
     }
 
+oper_poll:
     /* operational poll subscriptions */
     for (i = 0; i < subscription->oper_poll_sub_count; ++i) {
         if ((err_info = sr_shmsub_oper_poll_listen_process_module_events(&subscription->oper_poll_subs[i],
@@ -4612,21 +6199,23 @@ sr_subscription_process_events(sr_subscription_ctx_t *subscription, sr_session_c
         }
     }
 
-    /* RPC/action subscriptions */
-    for (i = 0; i < subscription->rpc_sub_count; ++i) {
-        if ((err_info = sr_shmsub_rpc_listen_process_rpc_events(&subscription->rpc_subs[i], subscription->conn))) {
-            goto cleanup_unlock;
+    if (!subscription->worker_count) {
+        /* RPC/action subscriptions */
+        for (i = 0; i < subscription->rpc_sub_count; ++i) {
+            if ((err_info = sr_shmsub_rpc_listen_process_rpc_events(&subscription->rpc_subs[i], subscription->conn))) {
+                goto cleanup_unlock;
+            }
         }
     }
 
+    /* perform any notification replays requested, merged across all the modules */
+    if ((err_info = sr_shmsub_notif_listen_replay(subscription))) {
+        goto cleanup_unlock;
+    }
+
     /* notification subscriptions */
     i = 0;
     while (i < subscription->notif_sub_count) {
-        /* perform any replays requested */
-        if ((err_info = sr_shmsub_notif_listen_module_replay(&subscription->notif_subs[i], subscription))) {
-            goto cleanup_unlock;
-        }
-
         /* check whether a subscription did not finish */
         mod_finished = 0;
         if ((err_info = sr_shmsub_notif_listen_module_stop_time(i, SR_LOCK_READ, subscription, &mod_finished))) {
@@ -4953,7 +6542,7 @@ sr_subscription_thread_resume(sr_subscription_ctx_t *subscription)
     }
 
     /* generate a new event for the thread to wake up */
-    if ((err_info = sr_shmsub_notify_evpipe(subscription->evpipe_num))) {
+    if ((err_info = sr_shmsub_notify_evpipe(subscription->conn, subscription->evpipe_num))) {
         return sr_api_ret(NULL, err_info);
     }
 
@@ -4983,6 +6572,13 @@ _sr_unsubscribe(sr_subscription_ctx_t *subscription)
     /* delete all subscriptions which also removes this subscription from all the sessions */
     err_info = sr_subscr_del_all(subscription);
 
+    if (!err_info && sr_shmext_compact_needed(subscription->conn)) {
+        /* compact fragmented ext SHM, skipped if any subscriptions are being used */
+        if ((tmp_err = sr_shmext_compact(subscription->conn, SR_SHMEXT_COMPACT_LOCK_TIMEOUT, 0))) {
+            sr_errinfo_free(&tmp_err);
+        }
+    }
+
     /* CONTEXT UNLOCK */
     sr_lycc_unlock(subscription->conn, SR_LOCK_READ, 0, __func__);
 
@@ -4997,7 +6593,7 @@ _sr_unsubscribe(sr_subscription_ctx_t *subscription)
         ATOMIC_STORE_RELAXED(subscription->thread_running, 0);
 
         /* generate a new event for the thread to wake up */
-        if ((tmp_err = sr_shmsub_notify_evpipe(subscription->evpipe_num))) {
+        if ((tmp_err = sr_shmsub_notify_evpipe(subscription->conn, subscription->evpipe_num))) {
             sr_errinfo_merge(&err_info, tmp_err);
         } else {
             /* join the thread */
@@ -5008,6 +6604,11 @@ _sr_unsubscribe(sr_subscription_ctx_t *subscription)
         }
     }
 
+    /* stop the worker threads, if any */
+    if ((tmp_err = sr_shmsub_listen_workers_stop(subscription))) {
+        sr_errinfo_merge(&err_info, tmp_err);
+    }
+
     /* unlink event pipe */
     if ((tmp_err = sr_path_evpipe(subscription->evpipe_num, &path))) {
         /* continue */
@@ -5023,6 +6624,7 @@ _sr_unsubscribe(sr_subscription_ctx_t *subscription)
     /* free attributes */
     close(subscription->evpipe);
     sr_rwlock_destroy(&subscription->subs_lock);
+    sr_rwlock_destroy(&subscription->worker_lock);
     free(subscription);
     return err_info;
 }
@@ -5139,7 +6741,7 @@ sr_module_change_subscribe_enable(sr_session_ctx_t *session, struct sr_mod_info_
                 goto cleanup;
             }
         } else {
-            if ((err_info = sr_lyd_get_module_data(&mod_info->data, ly_mod, 0, 1, &enabled_data))) {
+            if ((err_info = sr_lyd_get_module_data(&mod_info->data, ly_mod, 0, 1, 0, &enabled_data))) {
                 goto cleanup;
             }
         }
@@ -5198,11 +6800,12 @@ cleanup:
  *
  * @param[in] conn Connection to use.
  * @param[in] opts Subscription options.
+ * @param[in] worker_count Number of worker threads with ::SR_SUBSCR_THREAD_POOL, 0 for ::SR_SUBSCR_POOL_THREADS.
  * @param[out] subs_p Allocated subscription.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_subscr_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, sr_subscription_ctx_t **subs_p)
+sr_subscr_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, uint32_t worker_count, sr_subscription_ctx_t **subs_p)
 {
     sr_error_info_t *err_info = NULL;
     char *path = NULL;
@@ -5216,6 +6819,9 @@ sr_subscr_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, sr_subscription_ctx
     if ((err_info = sr_rwlock_init(&(*subs_p)->subs_lock, 0))) {
         goto error;
     }
+    if ((err_info = sr_rwlock_init(&(*subs_p)->worker_lock, 0))) {
+        goto error;
+    }
     (*subs_p)->conn = conn;
     (*subs_p)->evpipe = -1;
 
@@ -5241,6 +6847,16 @@ sr_subscr_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, sr_subscription_ctx
     }
 
     if (!(opts & SR_SUBSCR_NO_THREAD)) {
+        if (opts & SR_SUBSCR_THREAD_POOL) {
+            /* start the worker threads handling the events on behalf of the listen thread */
+            if (!worker_count) {
+                worker_count = SR_SUBSCR_POOL_THREADS;
+            }
+            if ((err_info = sr_shmsub_listen_workers_start(*subs_p, worker_count))) {
+                goto error;
+            }
+        }
+
         /* set thread_running to non-zero so that thread does not immediately quit */
         if (opts & SR_SUBSCR_THREAD_SUSPEND) {
             ATOMIC_STORE_RELAXED((*subs_p)->thread_running, 2);
@@ -5261,15 +6877,31 @@ sr_subscr_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, sr_subscription_ctx
 
 error:
     free(path);
+    sr_errinfo_merge(&err_info, sr_shmsub_listen_workers_stop(*subs_p));
     if ((*subs_p)->evpipe > -1) {
         close((*subs_p)->evpipe);
     }
     sr_rwlock_destroy(&(*subs_p)->subs_lock);
+    sr_rwlock_destroy(&(*subs_p)->worker_lock);
     free(*subs_p);
     *subs_p = NULL;
     return err_info;
 }
 
+API int
+sr_subscription_create(sr_conn_ctx_t *conn, sr_subscr_options_t opts, uint32_t worker_count,
+        sr_subscription_ctx_t **subscription)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || (opts & ~(SR_SUBSCR_NO_THREAD | SR_SUBSCR_THREAD_SUSPEND | SR_SUBSCR_THREAD_POOL)) ||
+            ((opts & SR_SUBSCR_NO_THREAD) && (opts & SR_SUBSCR_THREAD_POOL)) || !subscription, NULL, err_info);
+
+    *subscription = NULL;
+    err_info = sr_subscr_new(conn, opts, worker_count, subscription);
+    return sr_api_ret(NULL, err_info);
+}
+
 API int
 sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, const char *xpath,
         sr_module_change_cb callback, void *private_data, uint32_t priority, sr_subscr_options_t opts,
@@ -5290,7 +6922,13 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
 
     conn = session->conn;
     /* only these options are relevant outside this function and will be stored */
-    sub_opts = opts & (SR_SUBSCR_DONE_ONLY | SR_SUBSCR_PASSIVE | SR_SUBSCR_UPDATE | SR_SUBSCR_FILTER_ORIG);
+    sub_opts = opts & (SR_SUBSCR_DONE_ONLY | SR_SUBSCR_PASSIVE | SR_SUBSCR_UPDATE | SR_SUBSCR_FILTER_ORIG |
+            SR_SUBSCR_FILTER_DIFF);
+
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, module_name, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
@@ -5324,7 +6962,7 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
 
     if (!*subscription) {
         /* create a new subscription */
-        if ((err_info = sr_subscr_new(conn, opts, subscription))) {
+        if ((err_info = sr_subscr_new(conn, opts, 0, subscription))) {
             goto cleanup;
         }
     } else if (opts & SR_SUBSCR_THREAD_SUSPEND) {
@@ -5501,10 +7139,120 @@ cleanup_unlock:
     return sr_api_ret(NULL, err_info);
 }
 
+/**
+ * @brief Learn whether an XPath selects whole subtrees that can be walked lazily instead of selecting all the nodes.
+ *
+ * @param[in] xpath XPath to examine.
+ * @param[out] root_xpath XPath of the subtree roots, NULL for all the top-level nodes.
+ * @return Whether the XPath selects "<root_xpath>//.", whole subtrees.
+ */
+static int
+sr_changes_xpath_subtrees(const char *xpath, char **root_xpath)
+{
+    size_t len;
+
+    *root_xpath = NULL;
+
+    /* ignore trailing whitespaces */
+    len = strlen(xpath);
+    while (len && isspace(xpath[len - 1])) {
+        --len;
+    }
+
+    if ((len < 3) || strncmp(xpath + len - 3, "//.", 3)) {
+        return 0;
+    }
+    len -= 3;
+
+    if (strchr(xpath, '|')) {
+        /* union, the roots may not apply to all the expressions */
+        return 0;
+    }
+
+    while (len && isspace(xpath[len - 1])) {
+        --len;
+    }
+    if (!len) {
+        /* all the nodes */
+        return 1;
+    }
+    if (xpath[len - 1] == '/') {
+        /* unexpected path form */
+        return 0;
+    }
+
+    *root_xpath = strndup(xpath, len);
+    return *root_xpath ? 1 : 0;
+}
+
+/**
+ * @brief Get next change from a change iterator.
+ *
+ * @param[in] iter Change iterator.
+ * @param[out] node Changed node, NULL if there are no more changes.
+ * @param[out] op Change operation.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_change_iter_getnext(sr_change_iter_t *iter, struct lyd_node **node, sr_change_oper_t *op)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *root, *elem;
+    int skip;
+
+    if (!iter->subtrees) {
+        return sr_diff_set_getnext(iter->set, &iter->idx, node, op);
+    }
+
+    while (iter->idx < iter->set->count) {
+        root = iter->set->dnodes[iter->idx];
+
+        /* next node in a DFS walk of the subtree */
+        elem = iter->dfs_node;
+        if (!elem) {
+            elem = root;
+        } else if (lyd_child(elem)) {
+            elem = lyd_child(elem);
+        } else {
+            while ((elem != root) && !elem->next) {
+                elem = lyd_parent(elem);
+            }
+            elem = (elem == root) ? NULL : elem->next;
+        }
+
+        if (!elem) {
+            /* subtree finished, skip any roots in it (in document order, so they follow) */
+            iter->dfs_node = NULL;
+            do {
+                ++iter->idx;
+                for (elem = (iter->idx < iter->set->count) ? lyd_parent(iter->set->dnodes[iter->idx]) : NULL;
+                        elem && (elem != root);
+                        elem = lyd_parent(elem)) {}
+            } while (elem);
+            continue;
+        }
+        iter->dfs_node = elem;
+
+        if ((err_info = sr_diff_node_change_oper(elem, &skip, op))) {
+            return err_info;
+        }
+        if (!skip) {
+            *node = elem;
+            return NULL;
+        }
+    }
+
+    /* no more changes */
+    *node = NULL;
+    return NULL;
+}
+
 static int
 _sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, int dup, sr_change_iter_t **iter)
 {
     sr_error_info_t *err_info = NULL;
+    struct lyd_node *diff, *root;
+    char *root_xpath = NULL;
 
     SR_CHECK_ARG_APIRET(!session || !SR_IS_EVENT_SESS(session) || !xpath || !iter, session, err_info);
 
@@ -5513,6 +7261,11 @@ _sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, int dup, sr_c
         return sr_api_ret(session, err_info);
     }
 
+    /* parse the diffs of other modules if they can be selected */
+    if ((err_info = sr_shmsub_change_listen_diff_complete(session, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
+
     *iter = calloc(1, sizeof **iter);
     if (!*iter) {
         SR_ERRINFO_MEM(&err_info);
@@ -5520,12 +7273,31 @@ _sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, int dup, sr_c
     }
 
     if (session->dt[session->ds].diff) {
+        diff = session->dt[session->ds].diff;
         if (dup) {
-            if ((err_info = sr_lyd_dup(session->dt[session->ds].diff, NULL, LYD_DUP_RECURSIVE, 1, &(*iter)->diff))) {
+            if ((err_info = sr_lyd_dup(diff, NULL, LYD_DUP_RECURSIVE, 1, &(*iter)->diff))) {
                 goto error;
             }
+            diff = (*iter)->diff;
+        }
+
+        if (sr_changes_xpath_subtrees(xpath, &root_xpath)) {
+            /* select only the subtree roots, all their descendants are returned while iterating */
+            (*iter)->subtrees = 1;
+            if (root_xpath) {
+                err_info = sr_lyd_find_xpath(diff, root_xpath, &(*iter)->set);
+            } else if (!(err_info = sr_ly_set_new(&(*iter)->set))) {
+                LY_LIST_FOR(diff, root) {
+                    if (ly_set_add((*iter)->set, root, 1, NULL)) {
+                        SR_ERRINFO_MEM(&err_info);
+                        break;
+                    }
+                }
+            }
+        } else {
+            err_info = sr_lyd_find_xpath(diff, xpath, &(*iter)->set);
         }
-        if ((err_info = sr_lyd_find_xpath(session->dt[session->ds].diff, xpath, &(*iter)->set))) {
+        if (err_info) {
             goto error;
         }
     } else {
@@ -5536,9 +7308,11 @@ _sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, int dup, sr_c
     }
     (*iter)->idx = 0;
 
+    free(root_xpath);
     return sr_api_ret(session, NULL);
 
 error:
+    free(root_xpath);
     sr_free_change_iter(*iter);
     return sr_api_ret(session, err_info);
 }
@@ -5559,13 +7333,15 @@ sr_dup_changes_iter(sr_session_ctx_t *session, const char *xpath, sr_change_iter
  * @brief Transform change from a libyang node tree into sysrepo value.
  *
  * @param[in] node libyang node.
+ * @param[in] path Path builder of the change iterator.
  * @param[in] value_str Optional value to override.
  * @param[in] anchor Optional position/keys/value anchor to override.
  * @param[out] sr_val_p Transformed sysrepo value.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_change_ly2sr(const struct lyd_node *node, const char *value_str, const char *anchor, sr_val_t **sr_val_p)
+sr_change_ly2sr(const struct lyd_node *node, struct sr_lyd_path_s *path, const char *value_str, const char *anchor,
+        sr_val_t **sr_val_p)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t end;
@@ -5596,8 +7372,8 @@ sr_change_ly2sr(const struct lyd_node *node, const char *value_str, const char *
         node_ptr = node;
     }
 
-    /* fill the sr value */
-    if ((err_info = sr_val_ly2sr(node_ptr, sr_val))) {
+    /* fill the sr value, the path builder must not remember the temporary node */
+    if ((err_info = sr_val_ly2sr(node_ptr, node_dup ? NULL : path, sr_val))) {
         goto cleanup;
     }
 
@@ -5668,7 +7444,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
     SR_CHECK_ARG_APIRET(!session || !iter || !operation || !old_value || !new_value, session, err_info);
 
     /* get next change */
-    if ((err_info = sr_diff_set_getnext(iter->set, &iter->idx, &node, &op))) {
+    if ((err_info = sr_change_iter_getnext(iter, &node, &op))) {
         return sr_api_ret(session, err_info);
     }
 
@@ -5680,7 +7456,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
     /* create values */
     switch (op) {
     case SR_OP_DELETED:
-        if ((err_info = sr_change_ly2sr(node, NULL, NULL, old_value))) {
+        if ((err_info = sr_change_ly2sr(node, &iter->path, NULL, NULL, old_value))) {
             return sr_api_ret(session, err_info);
         }
         *new_value = NULL;
@@ -5696,7 +7472,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
             SR_ERRINFO_INT(&err_info);
             return sr_api_ret(session, err_info);
         }
-        if ((err_info = sr_change_ly2sr(node, lyd_get_meta_value(meta), NULL, old_value))) {
+        if ((err_info = sr_change_ly2sr(node, &iter->path, lyd_get_meta_value(meta), NULL, old_value))) {
             return sr_api_ret(session, err_info);
         }
         if (meta2->value.boolean) {
@@ -5704,7 +7480,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
         } else {
             (*old_value)->dflt = 0;
         }
-        if ((err_info = sr_change_ly2sr(node, NULL, NULL, new_value))) {
+        if ((err_info = sr_change_ly2sr(node, &iter->path, NULL, NULL, new_value))) {
             return sr_api_ret(session, err_info);
         }
         break;
@@ -5712,7 +7488,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
         if (!lysc_is_userordered(node->schema)) {
             /* not a user-ordered list, so the operation is a simple creation */
             *old_value = NULL;
-            if ((err_info = sr_change_ly2sr(node, NULL, NULL, new_value))) {
+            if ((err_info = sr_change_ly2sr(node, &iter->path, NULL, NULL, new_value))) {
                 return sr_api_ret(session, err_info);
             }
             break;
@@ -5728,11 +7504,11 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
 
         if (lyd_get_meta_value(meta)[0]) {
             if (lysc_is_dup_inst_list(node->schema)) {
-                err_info = sr_change_ly2sr(node, NULL, lyd_get_meta_value(meta), old_value);
+                err_info = sr_change_ly2sr(node, &iter->path, NULL, lyd_get_meta_value(meta), old_value);
             } else if (node->schema->nodetype == LYS_LEAFLIST) {
-                err_info = sr_change_ly2sr(node, lyd_get_meta_value(meta), NULL, old_value);
+                err_info = sr_change_ly2sr(node, &iter->path, lyd_get_meta_value(meta), NULL, old_value);
             } else {
-                err_info = sr_change_ly2sr(node, NULL, lyd_get_meta_value(meta), old_value);
+                err_info = sr_change_ly2sr(node, &iter->path, NULL, lyd_get_meta_value(meta), old_value);
             }
             if (err_info) {
                 return sr_api_ret(session, err_info);
@@ -5741,7 +7517,7 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
             /* inserted as the first item */
             *old_value = NULL;
         }
-        if ((err_info = sr_change_ly2sr(node, NULL, NULL, new_value))) {
+        if ((err_info = sr_change_ly2sr(node, &iter->path, NULL, NULL, new_value))) {
             return sr_api_ret(session, err_info);
         }
         break;
@@ -5771,7 +7547,7 @@ sr_get_change_tree_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_ch
     }
 
     /* get next change */
-    if ((err_info = sr_diff_set_getnext(iter->set, &iter->idx, (struct lyd_node **)node, operation))) {
+    if ((err_info = sr_change_iter_getnext(iter, (struct lyd_node **)node, operation))) {
         return sr_api_ret(session, err_info);
     }
 
@@ -5841,12 +7617,15 @@ sr_free_change_iter(sr_change_iter_t *iter)
 
     lyd_free_all(iter->diff);
     ly_set_free(iter->set, NULL);
+    sr_lyd_path_erase(&iter->path);
     free(iter);
 }
 
 API const struct lyd_node *
 sr_get_change_diff(sr_session_ctx_t *session)
 {
+    sr_error_info_t *err_info = NULL;
+
     if (!session || !SR_IS_EVENT_SESS(session)) {
         return NULL;
     }
@@ -5855,6 +7634,12 @@ sr_get_change_diff(sr_session_ctx_t *session)
         return NULL;
     }
 
+    /* the whole diff is returned */
+    if ((err_info = sr_shmsub_change_listen_diff_complete(session, NULL))) {
+        sr_errinfo_free(&err_info);
+        return NULL;
+    }
+
     return session->dt[session->ds].diff;
 }
 
@@ -5888,6 +7673,11 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
 
     conn = session->conn;
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, NULL, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -5931,7 +7721,7 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
 
     if (!*subscription) {
         /* create a new subscription */
-        if ((err_info = sr_subscr_new(conn, opts, subscription))) {
+        if ((err_info = sr_subscr_new(conn, opts, 0, subscription))) {
             goto cleanup;
         }
     } else if (opts & SR_SUBSCR_THREAD_SUSPEND) {
@@ -5961,12 +7751,13 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
     /* add RPC/action subscription into ext SHM and create separate specific SHM segment */
     if (is_ext) {
         if ((err_info = sr_shmext_rpc_sub_add(conn, &shm_mod->rpc_ext_lock, &shm_mod->rpc_ext_subs,
-                &shm_mod->rpc_ext_sub_count, path, sub_id, xpath, priority, 0, (*subscription)->evpipe_num, conn->cid))) {
+                &shm_mod->rpc_ext_sub_count, path, sub_id, xpath, priority, opts & SR_SUBSCR_RPC_TRUSTED,
+                (*subscription)->evpipe_num, conn->cid))) {
             goto cleanup_unlock2;
         }
     } else {
         if ((err_info = sr_shmext_rpc_sub_add(conn, &shm_rpc->lock, &shm_rpc->subs, &shm_rpc->sub_count, path, sub_id,
-                xpath, priority, 0, (*subscription)->evpipe_num, conn->cid))) {
+                xpath, priority, opts & SR_SUBSCR_RPC_TRUSTED, (*subscription)->evpipe_num, conn->cid))) {
             goto cleanup_unlock2;
         }
     }
@@ -6039,6 +7830,7 @@ sr_rpc_send(sr_session_ctx_t *session, const char *path, const sr_val_t *input,
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *input_tree = NULL, *elem;
+    struct sr_lyd_path_s opath = {0};
     sr_data_t *output_data = NULL;
     char *val_str, buf[22];
     size_t i;
@@ -6052,6 +7844,11 @@ sr_rpc_send(sr_session_ctx_t *session, const char *path, const sr_val_t *input,
     *output = NULL;
     *output_cnt = 0;
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -6086,7 +7883,7 @@ sr_rpc_send(sr_session_ctx_t *session, const char *path, const sr_val_t *input,
             SR_CHECK_MEM_GOTO(!*output, err_info, cleanup);
 
             /* fill it */
-            if ((err_info = sr_val_ly2sr(elem, &(*output)[*output_cnt]))) {
+            if ((err_info = sr_val_ly2sr(elem, &opath, &(*output)[*output_cnt]))) {
                 goto cleanup;
             }
 
@@ -6100,6 +7897,7 @@ sr_rpc_send(sr_session_ctx_t *session, const char *path, const sr_val_t *input,
 cleanup:
     lyd_free_all(input_tree);
     sr_release_data(output_data);
+    sr_lyd_path_erase(&opath);
 
     /* CONTEXT UNLOCK */
     sr_lycc_unlock(session->conn, SR_LOCK_READ, 0, __func__);
@@ -6179,9 +7977,9 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
 {
     sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
     sr_rpc_t *shm_rpc;
-    sr_dep_t *shm_deps;
-    uint16_t shm_dep_count;
     uint32_t event_id = 0;
+    struct timespec ts;
+    int output_trusted;
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -6194,10 +7992,7 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
     }
 
     /* collect all required modules for input validation */
-    if ((err_info = sr_shmmod_get_rpc_deps(SR_CONN_MOD_SHM(session->conn), path, 0, &shm_deps, &shm_dep_count))) {
-        goto cleanup;
-    }
-    if ((err_info = sr_shmmod_collect_deps(SR_CONN_MOD_SHM(session->conn), shm_deps, shm_dep_count, input, mod_info))) {
+    if ((err_info = sr_modinfo_collect_rpc_deps(path, 0, input, mod_info))) {
         goto cleanup;
     }
     if ((err_info = sr_modinfo_consolidate(mod_info, SR_LOCK_READ, SR_MI_NEW_DEPS | SR_MI_DATA_RO | SR_MI_PERM_NO,
@@ -6206,7 +8001,10 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
     }
 
     /* validate the operation, must be valid only at the time of execution */
-    if ((err_info = sr_modinfo_op_validate(mod_info, input_op, 0))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_modinfo_op_validate(mod_info, input_op, 0);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_VALIDATE, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
@@ -6215,6 +8013,7 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
 
     sr_modinfo_erase(mod_info);
     SR_MODINFO_INIT(*mod_info, session->conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
+    mod_info->phase_us = SR_SESS_PHASE_US(session);
 
     if (!strcmp(path, SR_RPC_FACTORY_RESET_PATH)) {
         /* update the input as needed */
@@ -6228,21 +8027,26 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
     SR_CHECK_INT_GOTO(!shm_rpc, err_info, cleanup);
 
     /* RPC SUB READ LOCK */
-    if ((err_info = sr_rwlock(&shm_rpc->lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, session->conn->cid, __func__,
-            NULL, NULL))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_rwlock(&shm_rpc->lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, session->conn->cid, __func__,
+            NULL, NULL);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_LOCK, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
     /* publish RPC in an event and wait for a reply from the last subscriber */
-    if ((err_info = sr_shmsub_rpc_notify(session->conn, &shm_rpc->lock, &shm_rpc->subs, &shm_rpc->sub_count, path, input,
-            session->orig_name, session->orig_data, timeout_ms, &event_id, &(*output)->tree, &cb_err_info))) {
-        goto cleanup_rpcsub_unlock;
-    }
-
-    if (cb_err_info) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_shmsub_rpc_notify(session->conn, &shm_rpc->lock, &shm_rpc->subs, &shm_rpc->sub_count, path, input,
+            session->orig_name, session->orig_data, timeout_ms, &event_id, &(*output)->tree, &output_trusted,
+            &cb_err_info);
+    if (!err_info && cb_err_info) {
         /* "rpc" event failed, publish "abort" event and finish */
         err_info = sr_shmsub_rpc_notify_abort(session->conn, &shm_rpc->lock, &shm_rpc->subs, &shm_rpc->sub_count, path,
                 input, session->orig_name, session->orig_data, timeout_ms, event_id);
+    }
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_NOTIFY, &ts);
+    if (err_info || cb_err_info) {
         goto cleanup_rpcsub_unlock;
     }
 
@@ -6254,11 +8058,13 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
         goto cleanup;
     }
 
-    /* collect all required modules for output validation */
-    if ((err_info = sr_shmmod_get_rpc_deps(SR_CONN_MOD_SHM(session->conn), path, 1, &shm_deps, &shm_dep_count))) {
+    if (output_trusted) {
+        /* the subscriber is trusted to return valid output */
         goto cleanup;
     }
-    if ((err_info = sr_shmmod_collect_deps(SR_CONN_MOD_SHM(session->conn), shm_deps, shm_dep_count, input, mod_info))) {
+
+    /* collect all required modules for output validation */
+    if ((err_info = sr_modinfo_collect_rpc_deps(path, 1, input, mod_info))) {
         goto cleanup;
     }
     if ((err_info = sr_modinfo_consolidate(mod_info, SR_LOCK_READ, SR_MI_NEW_DEPS | SR_MI_DATA_RO | SR_MI_PERM_NO,
@@ -6267,7 +8073,10 @@ _sr_rpc_send_tree(sr_session_ctx_t *session, struct sr_mod_info_s *mod_info, con
     }
 
     /* validate the output */
-    if ((err_info = sr_modinfo_op_validate(mod_info, (*output)->tree, 1))) {
+    sr_timing_phase_start(mod_info->phase_us, &ts);
+    err_info = sr_modinfo_op_validate(mod_info, (*output)->tree, 1);
+    sr_timing_phase_end(mod_info->phase_us, SR_PHASE_VALIDATE, &ts);
+    if (err_info) {
         goto cleanup;
     }
 
@@ -6311,6 +8120,7 @@ _sr_rpc_ext_send_tree(sr_session_ctx_t *session, const struct lyd_node *ext_pare
     sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
     sr_mod_t *shm_mod;
     uint32_t event_id = 0;
+    int output_trusted;
 
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
@@ -6352,7 +8162,7 @@ _sr_rpc_ext_send_tree(sr_session_ctx_t *session, const struct lyd_node *ext_pare
     /* publish RPC in an event and wait for a reply from the last subscriber */
     if ((err_info = sr_shmsub_rpc_notify(session->conn, &shm_mod->rpc_ext_lock, &shm_mod->rpc_ext_subs,
             &shm_mod->rpc_ext_sub_count, path, input, session->orig_name, session->orig_data, timeout_ms, &event_id,
-            &(*output)->tree, &cb_err_info))) {
+            &(*output)->tree, &output_trusted, &cb_err_info))) {
         goto cleanup_rpcsub_unlock;
     }
 
@@ -6371,10 +8181,15 @@ _sr_rpc_ext_send_tree(sr_session_ctx_t *session, const struct lyd_node *ext_pare
         goto cleanup;
     }
 
+    if (output_trusted) {
+        /* the subscriber is trusted to return valid output */
+        goto cleanup;
+    }
+
     /* use the same mod info, just get READ lock again */
 
     /* MODULES READ LOCK */
-    if ((err_info = sr_shmmod_modinfo_rdlock(mod_info, 0, session->sid, timeout_ms, SR_OPER_CB_TIMEOUT))) {
+    if ((err_info = sr_shmmod_modinfo_rdlock(mod_info, 0, 0, session->sid, timeout_ms, SR_OPER_CB_TIMEOUT))) {
         return err_info;
     }
 
@@ -6411,6 +8226,7 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
     struct lyd_node *input_top, *input_op, *ext_parent = NULL;
     char *path = NULL, *str, *parent_path = NULL;
     struct sr_denied denied = {0};
+    struct timespec ts;
 
     SR_CHECK_ARG_APIRET(!session || !input || !output, session, err_info);
 
@@ -6424,6 +8240,8 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
         timeout_ms = SR_RPC_CB_TIMEOUT;
     }
     SR_MODINFO_INIT(mod_info, session->conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
+    mod_info.phase_us = SR_SESS_PHASE_US(session);
+    sr_timing_request_start(session, &ts);
 
     /* check input data tree */
     input_op = NULL;
@@ -6521,6 +8339,7 @@ cleanup:
     free(path);
     sr_modinfo_erase(&mod_info);
     free(denied.rule_name);
+    sr_timing_request_end(session, "RPC send", &ts);
     return sr_api_ret(session, err_info);
 }
 
@@ -6560,6 +8379,11 @@ _sr_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const char
             (!callback && !tree_callback) || !subscription, session, err_info);
     conn = session->conn;
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, mod_name, xpath))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -6584,7 +8408,7 @@ _sr_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const char
 
     if (!*subscription) {
         /* create a new subscription */
-        if ((err_info = sr_subscr_new(conn, opts, subscription))) {
+        if ((err_info = sr_subscr_new(conn, opts, 0, subscription))) {
             goto cleanup;
         }
     } else if (opts & SR_SUBSCR_THREAD_SUSPEND) {
@@ -6634,7 +8458,7 @@ _sr_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const char
 
     if (start_time || stop_time) {
         /* notify subscription there are already some events (replay needs to be performed) or stop time needs to be checked */
-        if ((err_info = sr_shmsub_notify_evpipe((*subscription)->evpipe_num))) {
+        if ((err_info = sr_shmsub_notify_evpipe(conn, (*subscription)->evpipe_num))) {
             goto error2;
         }
     }
@@ -6693,6 +8517,11 @@ sr_notif_send(sr_session_ctx_t *session, const char *path, const sr_val_t *value
 
     SR_CHECK_ARG_APIRET(!session || !path, session, err_info);
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(session->conn, NULL, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(session->conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -6724,29 +8553,33 @@ cleanup:
     return ret ? ret : sr_api_ret(session, err_info);
 }
 
-API int
-sr_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif, uint32_t timeout_ms, int wait)
+/**
+ * @brief Check and validate a notification to be sent.
+ *
+ * @param[in] session Session to use.
+ * @param[in] notif Notification data tree.
+ * @param[out] notif_top_p Top-level node of @p notif.
+ * @param[out] shm_mod_p SHM module of the notification.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_notif_send_validate(sr_session_ctx_t *session, struct lyd_node *notif, struct lyd_node **notif_top_p,
+        sr_mod_t **shm_mod_p)
 {
     sr_error_info_t *err_info = NULL;
     struct sr_mod_info_s mod_info;
     struct lyd_node *notif_top, *notif_op, *parent;
     sr_dep_t *shm_deps;
     sr_mod_t *shm_mod;
-    struct timespec notif_ts_mono, notif_ts_real;
     uint16_t shm_dep_count;
     char *parent_path = NULL;
 
-    SR_CHECK_ARG_APIRET(!session || !notif, session, err_info);
-
     for (notif_top = notif; notif_top->parent; notif_top = lyd_parent(notif_top)) {}
     if (session->conn->ly_ctx != LYD_CTX(notif_top)) {
         sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, "Data trees must be created using the session connection libyang context.");
-        return sr_api_ret(session, err_info);
+        return err_info;
     }
 
-    if (!timeout_ms) {
-        timeout_ms = SR_NOTIF_CB_TIMEOUT;
-    }
     SR_MODINFO_INIT(mod_info, session->conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
 
     /* check notif data tree */
@@ -6825,9 +8658,37 @@ sr_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif, uint32_t t
         goto cleanup;
     }
 
+    *notif_top_p = notif_top;
+    *shm_mod_p = shm_mod;
+
+cleanup:
     /* MODULES UNLOCK */
     sr_shmmod_modinfo_unlock(&mod_info);
 
+    free(parent_path);
+    sr_modinfo_erase(&mod_info);
+    return err_info;
+}
+
+API int
+sr_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif, uint32_t timeout_ms, int wait)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *notif_top;
+    sr_mod_t *shm_mod;
+    struct timespec notif_ts_mono, notif_ts_real;
+
+    SR_CHECK_ARG_APIRET(!session || !notif, session, err_info);
+
+    if (!timeout_ms) {
+        timeout_ms = SR_NOTIF_CB_TIMEOUT;
+    }
+
+    /* check and validate the notification */
+    if ((err_info = sr_notif_send_validate(session, notif, &notif_top, &shm_mod))) {
+        goto cleanup;
+    }
+
     /* NOTIF SUB READ LOCK */
     if ((err_info = sr_rwlock(&shm_mod->notif_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, session->conn->cid,
             __func__, NULL, NULL))) {
@@ -6855,11 +8716,81 @@ sr_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif, uint32_t t
     }
 
 cleanup:
-    /* MODULES UNLOCK */
-    sr_shmmod_modinfo_unlock(&mod_info);
+    return sr_api_ret(session, err_info);
+}
 
-    free(parent_path);
-    sr_modinfo_erase(&mod_info);
+API int
+sr_notif_send_batch(sr_session_ctx_t *session, struct lyd_node **notifs, uint32_t notif_count, uint32_t timeout_ms,
+        int wait)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node **notif_tops = NULL;
+    struct lyd_node *notif_top;
+    sr_mod_t **shm_mods = NULL;
+    struct timespec notif_ts_mono, notif_ts_real;
+    uint32_t i, j;
+
+    SR_CHECK_ARG_APIRET(!session || (!notifs && notif_count), session, err_info);
+    for (i = 0; i < notif_count; ++i) {
+        SR_CHECK_ARG_APIRET(!notifs[i], session, err_info);
+    }
+
+    if (!notif_count) {
+        return sr_api_ret(session, NULL);
+    }
+    if (!timeout_ms) {
+        timeout_ms = SR_NOTIF_CB_TIMEOUT;
+    }
+
+    notif_tops = malloc(notif_count * sizeof *notif_tops);
+    shm_mods = malloc(notif_count * sizeof *shm_mods);
+    SR_CHECK_MEM_GOTO(!notif_tops || !shm_mods, err_info, cleanup);
+
+    /* check and validate all the notifications first */
+    for (i = 0; i < notif_count; ++i) {
+        if ((err_info = sr_notif_send_validate(session, notifs[i], &notif_top, &shm_mods[i]))) {
+            goto cleanup;
+        }
+        notif_tops[i] = notif_top;
+    }
+
+    /* all the notifications are generated at once */
+    sr_timeouttime_get(&notif_ts_mono, 0);
+    sr_realtime_get(&notif_ts_real);
+
+    for (i = 0; i < notif_count; i = j) {
+        /* consecutive notifications of a single module are published in one event */
+        for (j = i + 1; (j < notif_count) && (shm_mods[j] == shm_mods[i]); ++j) {}
+
+        /* NOTIF SUB READ LOCK */
+        if ((err_info = sr_rwlock(&shm_mods[i]->notif_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ,
+                session->conn->cid, __func__, NULL, NULL))) {
+            goto cleanup;
+        }
+
+        /* publish the notifs in an event */
+        err_info = sr_shmsub_notif_notify_batch(session->conn, &notif_tops[i], j - i, notif_ts_mono, notif_ts_real,
+                session->orig_name, session->orig_data, timeout_ms, wait);
+
+        /* NOTIF SUB READ UNLOCK */
+        sr_rwunlock(&shm_mods[i]->notif_lock, SR_SHMEXT_SUB_LOCK_TIMEOUT, SR_LOCK_READ, session->conn->cid,
+                __func__);
+
+        if (err_info) {
+            goto cleanup;
+        }
+    }
+
+    /* store the notifications for a replay */
+    for (i = 0; i < notif_count; ++i) {
+        if ((err_info = sr_replay_store(session, notif_tops[i], notif_ts_real))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    free(notif_tops);
+    free(shm_mods);
     return sr_api_ret(session, err_info);
 }
 
@@ -6950,9 +8881,14 @@ sr_notif_sub_modify_xpath(sr_subscription_ctx_t *subscription, uint32_t sub_id,
     /* update xpath */
     free(notif_sub->xpath);
     notif_sub->xpath = NULL;
+    sr_notif_filter_free(notif_sub->filter);
+    notif_sub->filter = NULL;
     if (xpath) {
         notif_sub->xpath = strdup(xpath);
         SR_CHECK_MEM_GOTO(!notif_sub->xpath, err_info, cleanup_unlock);
+        if ((err_info = sr_notif_filter_compile(xpath, &notif_sub->filter))) {
+            goto cleanup_unlock;
+        }
     }
 
     /* create event session */
@@ -7029,7 +8965,7 @@ sr_notif_sub_modify_stop_time(sr_subscription_ctx_t *subscription, uint32_t sub_
     }
 
     /* generate a new event for the thread to wake up */
-    if ((err_info = sr_shmsub_notify_evpipe(subscription->evpipe_num))) {
+    if ((err_info = sr_shmsub_notify_evpipe(subscription->conn, subscription->evpipe_num))) {
         goto cleanup_unlock;
     }
 
@@ -7061,6 +8997,11 @@ sr_oper_get_subscribe(sr_session_ctx_t *session, const char *module_name, const
     /* only these options are relevant outside this function and will be stored */
     sub_opts = opts & SR_SUBSCR_OPER_MERGE;
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, module_name, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -7084,7 +9025,7 @@ sr_oper_get_subscribe(sr_session_ctx_t *session, const char *module_name, const
 
     if (!*subscription) {
         /* create a new subscription */
-        if ((err_info = sr_subscr_new(conn, opts, subscription))) {
+        if ((err_info = sr_subscr_new(conn, opts, 0, subscription))) {
             goto cleanup;
         }
     } else if (opts & SR_SUBSCR_THREAD_SUSPEND) {
@@ -7182,6 +9123,11 @@ sr_oper_poll_subscribe(sr_session_ctx_t *session, const char *module_name, const
     /* only these options are relevant outside this function and will be stored */
     sub_opts = opts & SR_SUBSCR_OPER_POLL_DIFF;
 
+    /* require the modules in a lazy context */
+    if ((err_info = sr_lycc_lazy_require(conn, module_name, path))) {
+        return sr_api_ret(session, err_info);
+    }
+
     /* CONTEXT LOCK */
     if ((err_info = sr_lycc_lock(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(session, err_info);
@@ -7205,7 +9151,7 @@ sr_oper_poll_subscribe(sr_session_ctx_t *session, const char *module_name, const
 
     if (!*subscription) {
         /* create a new subscription */
-        if ((err_info = sr_subscr_new(conn, opts, subscription))) {
+        if ((err_info = sr_subscr_new(conn, opts, 0, subscription))) {
             goto cleanup;
         }
     } else if (opts & SR_SUBSCR_THREAD_SUSPEND) {
@@ -7261,7 +9207,7 @@ sr_oper_poll_subscribe(sr_session_ctx_t *session, const char *module_name, const
     }
 
     /* make sure the event handler updates its wake up period */
-    if ((err_info = sr_shmsub_notify_evpipe((*subscription)->evpipe_num))) {
+    if ((err_info = sr_shmsub_notify_evpipe(conn, (*subscription)->evpipe_num))) {
         goto error4;
     }
 
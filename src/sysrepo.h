@@ -178,6 +178,19 @@ void sr_release_context(sr_conn_ctx_t *conn);
  */
 void sr_session_release_context(sr_session_ctx_t *session);
 
+/**
+ * @brief Load modules into the _libyang_ context of a connection with ::SR_CONN_CTX_LAZY, together with all
+ * the modules they depend on. Does nothing for other connections.
+ *
+ * Modules are loaded automatically when used by API calls so this is needed only before working with them
+ * directly in the context, see ::sr_acquire_context(). The context cannot be acquired by this thread.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] module_names Array of module names ended by NULL.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_require_modules(sr_conn_ctx_t *conn, const char **module_names);
+
 /**
  * @brief Get content ID of the current YANG module set. It conforms to the requirements for ietf-yang-library
  * "content-id" node value.
@@ -197,6 +210,54 @@ uint32_t sr_get_content_id(sr_conn_ctx_t *conn);
  */
 int sr_get_plugins(sr_conn_ctx_t *conn, const char ***ds_plugins, const char ***ntf_plugins);
 
+/**
+ * @brief Compact ext SHM with all the subscriptions by removing any memory holes left by removed subscriptions.
+ * Ext SHM is also compacted automatically when a subscription is removed and it is too fragmented.
+ *
+ * Blocks all the subscriptions for the duration of the operation.
+ *
+ * @param[in] conn Connection to use.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_compact_ext_shm(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Get the memory used by the caches and buffers of a connection.
+ *
+ * The sizes are estimates of the memory allocated for the data trees, computed by traversing them.
+ *
+ * @param[in] conn Connection to use.
+ * @param[out] mem_usage Array of ::SR_CONN_MEM_COUNT items to fill with the [sizes](@ref sr_conn_mem_t) in bytes.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_conn_get_mem_usage(sr_conn_ctx_t *conn, uint64_t *mem_usage);
+
+/**
+ * @brief Limit the memory used by a cache of a connection.
+ *
+ * Once the cached data exceed the limit, the least recently used data of other modules or subscriptions are evicted
+ * from the cache first. Data that alone exceed the limit are not cached at all. Data of operational poll
+ * subscriptions generating diffs (::SR_SUBSCR_OPER_POLL_DIFF) are never evicted because they are needed for the next
+ * diff. With ::SR_CONN_CACHE_RUNNING_COMPACT, evicted running data are kept in a compact form that counts towards
+ * the limit and is evicted only once there are no other running data to evict.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] mem Cache to limit, ::SR_CONN_MEM_RUN_CACHE, ::SR_CONN_MEM_DS_CACHE, or ::SR_CONN_MEM_OPER_CACHE.
+ * @param[in] limit Maximum size of the cached data in bytes, 0 for no limit.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_conn_set_mem_limit(sr_conn_ctx_t *conn, sr_conn_mem_t mem, uint64_t limit);
+
+/**
+ * @brief Get the usage statistics of a cache of a connection.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] cache Cache to learn about, ::SR_CONN_MEM_RUN_CACHE, ::SR_CONN_MEM_DS_CACHE, or ::SR_CONN_MEM_OPER_CACHE.
+ * @param[out] stats Statistics of the cache since the connection was created.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_conn_get_cache_stats(sr_conn_ctx_t *conn, sr_conn_mem_t cache, sr_cache_stats_t *stats);
+
 /**
  * @brief Get the sysrepo SUPERUSER UID.
  *
@@ -333,6 +394,19 @@ void sr_session_del_orig_data(sr_session_ctx_t *session);
  */
 int sr_session_get_orig_data(sr_session_ctx_t *session, uint32_t idx, uint32_t *size, const void **data);
 
+/**
+ * @brief Get the maximum depth of the data requested from an operational get callback.
+ *
+ * The depth is relative to the subscription nodes, which have depth 1. The nodes at the maximum depth do not
+ * need to have any descendants, only list instances require their keys. So, a depth of 1 means only the keys of
+ * the subscription list instances are required. The caller discards any deeper data so the callback can skip
+ * generating them.
+ *
+ * @param[in] session Implicit session provided in an operational get callback.
+ * @return Maximum depth of the requested data, 0 if unlimited or the session is not of an operational get event.
+ */
+uint32_t sr_session_get_oper_max_depth(sr_session_ctx_t *session);
+
 /**
  * @brief Retrieve information about the error that has occurred
  * during the last operation executed within provided session.
@@ -446,6 +520,58 @@ const char *sr_session_get_user(sr_session_ctx_t *session);
  */
 sr_conn_ctx_t *sr_session_get_connection(sr_session_ctx_t *session);
 
+/**
+ * @brief Enable or disable timing of the [phases](@ref sr_phase_t) of the requests of a session.
+ *
+ * Timed are ::sr_apply_changes(), ::sr_get_data(), and ::sr_rpc_send_tree() (with ::sr_rpc_send()), the durations
+ * of the last of them can be learned using ::sr_session_get_timing().
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] enable Whether to enable or disable the timing.
+ * @param[in] slow_ms If set, requests taking longer than this number of milliseconds are logged as warnings with
+ * the durations of all their phases.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_session_set_timing(sr_session_ctx_t *session, int enable, uint32_t slow_ms);
+
+/**
+ * @brief Get the durations of the [phases](@ref sr_phase_t) of the last timed request of a session.
+ *
+ * Phases not performed by the request have zero duration and the total duration also includes the time not spent
+ * in any of the phases.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[out] total_us Optional total duration of the request in microseconds.
+ * @param[out] phase_us Optional array of ::SR_PHASE_COUNT items to fill with the durations of the phases in
+ * microseconds.
+ * @return Error code (::SR_ERR_OK on success), ::SR_ERR_INVAL_ARG if the timing is not enabled.
+ */
+int sr_session_get_timing(sr_session_ctx_t *session, uint32_t *total_us, uint32_t *phase_us);
+
+/**
+ * @brief Set whether ::sr_apply_changes() of a session waits for the subscribers to process the
+ * ::SR_EV_DONE event.
+ *
+ * If enabled, the event of the last (lowest) priority of the subscribers is only published and the subscribers
+ * finish it on their own so that slow "done" callbacks do not delay the caller. Any following event on these
+ * subscriptions still waits until they are finished with it.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] enable Whether not to wait for the event.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_session_set_async_done(sr_session_ctx_t *session, int enable);
+
+/**
+ * @brief Get the memory used by the prepared changes and buffered notifications of a session.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[out] edit Optional estimated size of the prepared edits of all the datastores in bytes.
+ * @param[out] notif_buf Optional estimated size of the notifications buffered for storing in bytes.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_session_get_mem_usage(sr_session_ctx_t *session, uint64_t *edit, uint64_t *notif_buf);
+
 /** @} connsess */
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -835,6 +961,47 @@ int sr_get_subtree(sr_session_ctx_t *session, const char *path, uint32_t timeout
 int sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
         const sr_get_options_t opts, sr_data_t **data);
 
+/**
+ * @brief Create an iterator for retrieving the selected subtrees in chunks, useful for huge lists.
+ *
+ * The data are loaded and filtered only once and the iterator keeps them, so the returned chunks are consistent.
+ * The iterator does not hold any module locks but the connection context cannot be changed until it is freed.
+ * The session must not be stopped before the iterator is freed.
+ *
+ * Required READ access, but if the access check fails, the module data are simply ignored without an error.
+ *
+ * @see ::sr_get_data_iter_next for retrieving the data using this iterator.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] xpath [XPath](@ref paths) selecting root nodes of subtrees to be retrieved.
+ * @param[in] max_depth Maximum depth of the selected subtrees, see ::sr_get_data.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds. If 0, default is used.
+ * @param[in] opts Options overriding default get behaviour.
+ * @param[in] resume_path Optional [path](@ref paths) of one of the selected nodes (such as a list instance
+ * with all its keys) returned previously, the iteration starts with the node following it.
+ * @param[out] iter Iterator context, should be freed with ::sr_get_data_iter_free.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_NOT_FOUND if @p resume_path was not found).
+ */
+int sr_get_data_iter_open(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
+        const sr_get_options_t opts, const char *resume_path, sr_get_data_iter_t **iter);
+
+/**
+ * @brief Get the next chunk of selected subtrees from the iterator created by ::sr_get_data_iter_open call.
+ *
+ * @param[in] iter Iterator to use.
+ * @param[in] count Maximum count of selected subtrees in the chunk.
+ * @param[out] data SR data with connected top-level data trees of the next chunk of the selected data.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_NOT_FOUND if there are no more data).
+ */
+int sr_get_data_iter_next(sr_get_data_iter_t *iter, uint32_t count, sr_data_t **data);
+
+/**
+ * @brief Free the iterator created by ::sr_get_data_iter_open call with all the data it holds.
+ *
+ * @param[in] iter Iterator to free.
+ */
+void sr_get_data_iter_free(sr_get_data_iter_t *iter);
+
 /**
  * @brief Retrieve a single value matching the provided XPath.
  * Data are represented as a single _libyang_ node.
@@ -935,6 +1102,71 @@ int sr_set_item(sr_session_ctx_t *session, const char *path, const sr_val_t *val
 int sr_set_item_str(sr_session_ctx_t *session, const char *path, const char *value, const char *origin,
         const sr_edit_options_t opts);
 
+/**
+ * @brief Prepare to set or delete several data elements at once. These changes are applied only after calling
+ * ::sr_apply_changes().
+ *
+ * Function provides the same functionality as calling ::sr_set_item_str() or ::sr_delete_item() for each item
+ * but it is faster for many items. Items whose paths share a prefix with the previous item are created relative
+ * to the already created edit nodes so ordering the items depth-first (parents before their descendants) is
+ * recommended. Processing stops on the first failed item with all the previous items kept in the edit.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] items Array of items to set or delete.
+ * @param[in] item_count Count of @p items.
+ * @param[in] origin Origin of all the set values, used only for ::SR_DS_OPERATIONAL edits. Module ietf-origin is
+ * assumed if no prefix used.
+ * @param[in] opts Options overriding default behavior of this call, used for all the items.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_OPERATION_FAILED if the whole edit was discarded).
+ */
+int sr_set_items(sr_session_ctx_t *session, const sr_edit_item_t *items, uint32_t item_count, const char *origin,
+        const sr_edit_options_t opts);
+
+/**
+ * @brief Compile an edit template used for repeatedly setting data elements whose paths differ only in
+ * predicate values, such as list keys.
+ *
+ * Placeholders in the form `$name` can be used instead of a literal in a predicate, for example
+ * `/ietf-interfaces:interfaces/interface[name=$n]/description`. The template is parsed once and its schema
+ * nodes are resolved once for every context so setting values using ::sr_edit_template_set() avoids
+ * the repeated path parsing and validation of ::sr_set_item_str(). A template must not be used concurrently.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] path [Path](@ref paths) identifier of the data element with placeholders.
+ * @param[out] tmpl Compiled template, free with ::sr_edit_template_free().
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_edit_template_new(sr_conn_ctx_t *conn, const char *path, sr_edit_template_t **tmpl);
+
+/**
+ * @brief Prepare to set data elements of an edit template. These changes are applied only after calling
+ * ::sr_apply_changes().
+ *
+ * Function provides the same functionality as calling ::sr_set_item_str() with the template path with
+ * the placeholders substituted by the quoted arguments. Several instances are created relative to each other
+ * the same way as in ::sr_set_items().
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] tmpl Edit template to use.
+ * @param[in] args Arguments of all the instances, the count of placeholders for each instance in the order
+ * of the placeholders in the template path.
+ * @param[in] values String representations of the values of the instances to be set, can be NULL.
+ * @param[in] count Count of instances to set.
+ * @param[in] origin Origin of all the set values, used only for ::SR_DS_OPERATIONAL edits. Module ietf-origin is
+ * assumed if no prefix used.
+ * @param[in] opts Options overriding default behavior of this call, used for all the instances.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_OPERATION_FAILED if the whole edit was discarded).
+ */
+int sr_edit_template_set(sr_session_ctx_t *session, sr_edit_template_t *tmpl, const char **args, const char **values,
+        uint32_t count, const char *origin, const sr_edit_options_t opts);
+
+/**
+ * @brief Free an edit template.
+ *
+ * @param[in] tmpl Edit template to free.
+ */
+void sr_edit_template_free(sr_edit_template_t *tmpl);
+
 /**
  * @brief Prepare to delete the nodes matching the specified xpath. These changes are applied only
  * after calling ::sr_apply_changes(). The accepted values are the same as for ::sr_set_item_str.
@@ -974,6 +1206,41 @@ int sr_oper_delete_item_str(sr_session_ctx_t *session, const char *path, const c
  */
 int sr_discard_items(sr_session_ctx_t *session, const char *xpath);
 
+/**
+ * @brief Add an operational value slot of a state leaf. Usable only for ::SR_DS_OPERATIONAL datastore.
+ *
+ * Meant for values changing at a high rate, such as counters. The value is stored in shared memory and can be
+ * updated in-place using ::sr_oper_slot_set() without any edit, locks, or datastore writes. Slot values are merged
+ * into the push operational data of the module when read, they do not generate any change notifications and are
+ * discarded when the session connection is terminated.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] path [Path](@ref paths) identifier of the state leaf.
+ * @param[in] value Initial value of the leaf.
+ * @param[out] slot Created slot, free with ::sr_oper_slot_del().
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_OPERATION_FAILED if there is no free slot).
+ */
+int sr_oper_slot_add(sr_session_ctx_t *session, const char *path, const char *value, sr_oper_slot_t **slot);
+
+/**
+ * @brief Update the value of an operational value slot.
+ *
+ * The value is not validated and an invalid value is ignored when the data are read.
+ *
+ * @param[in] slot Slot to update.
+ * @param[in] value New value of the leaf.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_INVAL_ARG if @p value is too long or @p slot is not valid).
+ */
+int sr_oper_slot_set(sr_oper_slot_t *slot, const char *value);
+
+/**
+ * @brief Remove an operational value slot, its value is no longer part of the operational data.
+ *
+ * @param[in] slot Slot to remove and free.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_INVAL_ARG if @p slot is not valid).
+ */
+int sr_oper_slot_del(sr_oper_slot_t *slot);
+
 /**
  * @brief Prepare to move/create the instance of an user-ordered list or leaf-list to the specified position.
  * These changes are applied only after calling ::sr_apply_changes().
@@ -1181,10 +1448,28 @@ int sr_get_lock(sr_conn_ctx_t *conn, sr_datastore_t datastore, const char *modul
  * @{
  */
 
+/**
+ * @brief Create an empty subscription structure that subscriptions can be added to by passing it to any of
+ * the subscribe functions. Useful for sharing a single handler thread (and worker threads) and a single event pipe
+ * among several independent subscribers in one process, for example plugins. Subscribers sharing the structure must
+ * remove only their own subscriptions using ::sr_unsubscribe_sub() and must not use ::SR_SUBSCR_THREAD_SUSPEND when
+ * subscribing.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] opts Subscription structure options, only ::SR_SUBSCR_NO_THREAD, ::SR_SUBSCR_THREAD_SUSPEND, and
+ * ::SR_SUBSCR_THREAD_POOL are accepted.
+ * @param[in] worker_count Number of worker threads if ::SR_SUBSCR_THREAD_POOL is used, 0 for the compile-time default.
+ * @param[out] subscription Created subscription structure, free with ::sr_unsubscribe().
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_subscription_create(sr_conn_ctx_t *conn, sr_subscr_options_t opts, uint32_t worker_count,
+        sr_subscription_ctx_t **subscription);
+
 /**
  * @brief Get the event pipe of a subscription. Do not call unless ::SR_SUBSCR_NO_THREAD flag was used
- * when subscribing! Event pipe can be used in `select()`, `poll()`, or similar functions to listen for new events.
- * It will then be ready for reading.
+ * when subscribing! Event pipe can be used in `select()`, `poll()`, `epoll()`, or similar functions to listen for new
+ * events. It will then be ready for reading. Wakeups are coalesced so one may cover several events, all of them are
+ * handled by a single ::sr_subscription_process_events() call.
  *
  * @param[in] subscription Subscription without a listening thread.
  * @param[out] event_pipe Event pipe of the subscription, do not close! It will be closed
@@ -1311,7 +1596,8 @@ int sr_unsubscribe(sr_subscription_ctx_t *subscription);
  * A0, B3;
  * ```
  * As soon as a callback fails, its batch of callbacks is the last to be notified. Also note that the callbacks may
- * not actually be executed concurrently in case they are handled by a single subscription (thread).
+ * not actually be executed concurrently in case they are handled by a single subscription (thread). Changes performed
+ * by a connection with ::SR_CONN_CHANGE_NOTIFY_PARALLEL are notified ignoring this order.
  *
  * This order (of `running` datastore) is also used when initializing and copying data from `startup` to `running`
  * on SHM creation.
@@ -1661,6 +1947,28 @@ int sr_notif_send(sr_session_ctx_t *session, const char *path, const sr_val_t *v
  */
 int sr_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif, uint32_t timeout_ms, int wait);
 
+/**
+ * @brief Send several notifications at once. Consecutive notifications of a single module are published
+ * in one event so the subscribers are notified only once for all of them, which is much more efficient for
+ * bursts of notifications than calling ::sr_notif_send_tree() for each.
+ *
+ * All the notifications get the same timestamp. Required access is the same as for ::sr_notif_send_tree().
+ *
+ * @note Notifications must be valid in (are validated against) the [operational datastore](@ref oper_ds) context.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in,out] notifs Array of notification data trees to send in @p session connection _libyang_ context,
+ * are validated.
+ * @param[in] notif_count Count of @p notifs.
+ * @param[in] timeout_ms Notification callback timeout in milliseconds. If 0, default is used. Relevant only
+ * if @p wait is set.
+ * @param[in] wait Whether to wait until all (if any) notification callbacks were called (synchronous delivery)
+ * or just publish the notifications without waiting for their processing (asynchronous delivery).
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_notif_send_batch(sr_session_ctx_t *session, struct lyd_node **notifs, uint32_t notif_count, uint32_t timeout_ms,
+        int wait);
+
 /**
  * @brief Get information about an existing notification subscription.
  *
@@ -1745,7 +2053,9 @@ int sr_oper_get_subscribe(sr_session_ctx_t *session, const char *module_name, co
  *
  * The operational data are cached in the connection of @p session. When any session created on this connection
  * requires data of the cached operational get subscription at @p path, the callback is not called and the cached data
- * are used instead. Additionally, if @p opts include ::SR_SUBSCR_OPER_POLL_DIFF, any changes detected on cache data
+ * are used instead. The cached data are also shared with all the other connections, which use them instead of calling
+ * the callback until @p valid_ms elapses from their retrieval. Reading with ::SR_OPER_NO_POLL_CACHED bypasses both
+ * caches. Additionally, if @p opts include ::SR_SUBSCR_OPER_POLL_DIFF, any changes detected on cache data
  * refresh are reported to corresponding subscribers. For an operational get subscription, there can only be a
  * __single__ operational poll subscription with this flag. The first cache update is performed directly by this
  * function.
@@ -1780,12 +2090,21 @@ int sr_oper_poll_subscribe(sr_session_ctx_t *session, const char *module_name, c
  */
 
 /**
- * @brief sysrepo-plugind plugin initialization callback name that must exist in every plugin.
+ * @brief sysrepo-plugind plugin initialization callback name that must exist in every plugin,
+ * unless it has ::SRP_INIT_SHARED_CB.
  *
  * The callback must be of ::srp_init_cb_t type.
  */
 #define SRP_INIT_CB     "sr_plugin_init_cb"
 
+/**
+ * @brief sysrepo-plugind optional plugin initialization callback name, used instead of ::SRP_INIT_CB if it exists.
+ * All the events of such plugins are handled by the worker threads of a single shared subscription structure.
+ *
+ * The callback must be of ::srp_init_shared_cb_t type.
+ */
+#define SRP_INIT_SHARED_CB  "sr_plugin_init_shared_cb"
+
 /**
  * @brief sysrepo-plugind plugin cleanup callback name that must exist in every plugin.
  *
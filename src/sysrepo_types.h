@@ -105,7 +105,49 @@ typedef enum {
     SR_CONN_DEFAULT = 0x0,              /**< No special behaviour. */
     SR_CONN_CACHE_RUNNING = 0x1,        /**< Always cache running datastore data which makes mainly repeated retrieval
                                              of data much faster. Affects all sessions created on this connection. */
-    SR_CONN_CTX_SET_PRIV_PARSED = 0x2   /**< Use LY_CTX_SET_PRIV_PARSED option for the connection libyang context. */
+    SR_CONN_CTX_SET_PRIV_PARSED = 0x2,  /**< Use LY_CTX_SET_PRIV_PARSED option for the connection libyang context. */
+    SR_CONN_SUB_SPIN_WAIT = 0x4,        /**< When waiting for subscribers to process an event, briefly busy-wait before
+                                             sleeping. Lowers the latency of quickly handled events at the cost of
+                                             CPU time. Always used if sysrepo was compiled with ENABLE_SUB_SPIN_WAIT. */
+    SR_CONN_CHANGE_NOTIFY_PARALLEL = 0x8,   /**< Ignore the module order (::sr_module_change_set_order()) when notifying
+                                             module change subscribers of changes performed by this connection and
+                                             notify all the modules simultaneously. Callbacks of a single module are
+                                             still notified based on their priority. */
+    SR_CONN_CACHE_RUNNING_SHARED = 0x10, /**< Same as ::SR_CONN_CACHE_RUNNING but the serialized running data of every
+                                             module are also shared with all the other connections with this flag.
+                                             After a change of the data, a connection parses the shared data instead
+                                             of loading them from the datastore plugin, which is done only once
+                                             system-wide. */
+    SR_CONN_GROUP_COMMIT = 0x20,        /**< Concurrent ::sr_apply_changes() calls of sessions of this connection on
+                                             the same datastore are applied together as a single transaction.
+                                             A call is briefly delayed for others to join only if another call is
+                                             being applied, otherwise it is applied right away. Subscribers are
+                                             notified once with all the changes of the group, which are attributed
+                                             to the session that started the group. The timeout of every call also
+                                             limits the time it waits for the group to be started. If the group
+                                             fails before any subscriber is notified, every session applies its
+                                             changes alone to get its own result, otherwise all of them fail.
+                                             Sessions with a NACM user or an originator name are always applied
+                                             alone. */
+    SR_CONN_CACHE_DS = 0x40,            /**< Cache also the data of the startup and factory-default datastores, which
+                                             are loaded again only once they have changed. Repeated retrieval of
+                                             the data of these datastores is then much faster. Affects all sessions
+                                             created on this connection. */
+    SR_CONN_CTX_LAZY = 0x80,            /**< Do not load all the installed modules into the connection libyang context.
+                                             Only sysrepo internal modules are loaded and any other module once it is
+                                             used by a path or a module name of an API call or required by
+                                             ::sr_require_modules(), always with all the modules it depends on.
+                                             A module required while the thread holds the context (acquired context
+                                             or data, uncommitted changes) is loaded only once it is released.
+                                             Data of modules not loaded are not accessible, modules cannot be
+                                             changed using this connection, and the connection that creates SHM
+                                             always loads all the modules. Connections using few modules start much
+                                             faster and with less memory. */
+    SR_CONN_CACHE_RUNNING_COMPACT = 0x100 /**< Same as ::SR_CONN_CACHE_RUNNING but with a memory limit of the cache
+                                             (::sr_conn_set_mem_limit()), the evicted running data of a module are
+                                             kept in the compact binary (LYB) form instead of being freed. Once
+                                             required again and still current, they are parsed back into a data tree
+                                             instead of being loaded from the datastore plugin. */
 } sr_conn_flag_t;
 
 /**
@@ -136,6 +178,41 @@ typedef enum {
  */
 #define SR_DS_READ_COUNT 5
 
+/**
+ * @brief Timed phases of a request, see ::sr_session_set_timing().
+ */
+typedef enum {
+    SR_PHASE_LOCK = 0,      /**< Waiting for and acquiring module and subscription locks. */
+    SR_PHASE_LOAD,          /**< Loading module data, including operational data from their providers. */
+    SR_PHASE_EDIT,          /**< Applying the edit on the loaded data and creating the diff. */
+    SR_PHASE_VALIDATE,      /**< Validating the new data or RPC/action input and output. */
+    SR_PHASE_NOTIFY,        /**< Notifying the subscribers and waiting for their replies. */
+    SR_PHASE_STORE,         /**< Storing the new data. */
+    SR_PHASE_COUNT          /**< Count of all the phases. */
+} sr_phase_t;
+
+/**
+ * @brief Memory usage of a connection, see ::sr_conn_get_mem_usage().
+ */
+typedef enum {
+    SR_CONN_MEM_RUN_CACHE = 0,  /**< Cached running data (::SR_CONN_CACHE_RUNNING). */
+    SR_CONN_MEM_DS_CACHE,       /**< Cached startup and factory-default data (::SR_CONN_CACHE_DS). */
+    SR_CONN_MEM_OPER_CACHE,     /**< Data cached by operational poll subscriptions. */
+    SR_CONN_MEM_NOTIF_BUF,      /**< Notifications of all the sessions buffered for storing. */
+    SR_CONN_MEM_CONTEXT,        /**< Compiled libyang context, 0 if not supported by libyang. */
+    SR_CONN_MEM_RUN_CACHE_COMPACT,  /**< Evicted cached running data kept compact (::SR_CONN_CACHE_RUNNING_COMPACT). */
+    SR_CONN_MEM_COUNT           /**< Count of all the memory usage items. */
+} sr_conn_mem_t;
+
+/**
+ * @brief Usage statistics of a connection cache, see ::sr_conn_get_cache_stats().
+ */
+typedef struct {
+    uint64_t hits;          /**< Number of times current data were found in the cache. */
+    uint64_t misses;        /**< Number of times the data were not cached or were outdated. */
+    uint64_t evictions;     /**< Number of times data were evicted from the cache because of its memory limit. */
+} sr_cache_stats_t;
+
 /**
  * @brief Special notification datastore of a module.
  */
@@ -315,9 +392,15 @@ typedef enum {
  * @brief Flags used to override default data get behavior.
  */
 typedef enum {
-    SR_GET_NO_FILTER = 0x010000      /**< Do not apply the filter and return the whole "base" data which the filter
+    SR_GET_NO_FILTER = 0x010000,     /**< Do not apply the filter and return the whole "base" data which the filter
                                           would normally be applied on. The filter is used only when deciding what data
                                           to retrieve from subscribers and similar optimization cases. */
+    SR_GET_VALUES_ARENA = 0x020000   /**< Return the values of ::sr_get_items() in a single memory block together with
+                                          all their strings, which avoids an allocation per string and is freed at
+                                          once by ::sr_free_values(). The values must not be modified by the value
+                                          setters or reallocated, only read, duplicated, and freed. A single value
+                                          of the array must never be freed using ::sr_free_val() or
+                                          ::sr_free_val_content(). */
 } sr_get_flag_t;
 
 /**
@@ -365,6 +448,28 @@ typedef enum {
     SR_MOVE_LAST = 3       /**< Move the specified item to the position of the last child. */
 } sr_move_position_t;
 
+/**
+ * @brief Operation of a single item of ::sr_set_items call.
+ */
+typedef enum {
+    SR_EDIT_ITEM_SET = 0,  /**< Set the item, the same as ::sr_set_item_str. */
+    SR_EDIT_ITEM_DELETE = 1 /**< Delete the item, the same as ::sr_delete_item. */
+} sr_edit_item_oper_t;
+
+/**
+ * @brief Single item of ::sr_set_items call.
+ */
+typedef struct {
+    const char *xpath;          /**< [Path](@ref paths) identifier of the data element. */
+    const char *value;          /**< String representation of the value to be set, ignored for deleting. */
+    sr_edit_item_oper_t oper;   /**< Operation of the item. */
+} sr_edit_item_t;
+
+/**
+ * @brief Edit template with a parameterized path compiled using ::sr_edit_template_new call.
+ */
+typedef struct sr_edit_template_s sr_edit_template_t;
+
 /** @} editdata */
 
 /**
@@ -454,7 +559,31 @@ typedef enum {
      * event handling but results in 0 filtered-out changes returned by ::sr_module_change_sub_get_info(). Accepted
      * only for ::sr_module_change_subscribe().
      */
-    SR_SUBSCR_FILTER_ORIG = 0x100
+    SR_SUBSCR_FILTER_ORIG = 0x100,
+
+    /**
+     * @brief The event originator prunes the module diff to the subscription XPath before passing it to the subscriber
+     * so the callback is given only the changes selected by this XPath (with their parents) instead of all the changes
+     * of the module. Accepted only for ::sr_module_change_subscribe() with an XPath.
+     */
+    SR_SUBSCR_FILTER_DIFF = 0x200,
+
+    /**
+     * @brief In addition to the handler thread, start a pool of worker threads (their count is set at compile time)
+     * that handle change, operational get, and RPC/action events of different modules in parallel so that a slow
+     * callback does not delay the events of other modules. Events of a single module are still handled sequentially,
+     * except for RPCs/actions, several of which can be handled at once.
+     * Accepted only when creating a new subscription structure and not together with ::SR_SUBSCR_NO_THREAD.
+     */
+    SR_SUBSCR_THREAD_POOL = 0x400,
+
+    /**
+     * @brief The output generated by the callback is trusted to be valid so the RPC/action originator does not validate
+     * it, which saves loading all the data the output depends on. If there are several subscriptions with the priority
+     * of the last called callback, it is enough that one of them uses this flag. Accepted only for
+     * ::sr_rpc_subscribe() and ::sr_rpc_subscribe_tree().
+     */
+    SR_SUBSCR_RPC_TRUSTED = 0x800
 
 } sr_subscr_flag_t;
 
@@ -524,6 +653,16 @@ typedef enum {
  */
 typedef struct sr_change_iter_s sr_change_iter_t;
 
+/**
+ * @brief Iterator used for retrieval of selected data in chunks using ::sr_get_data_iter_open call.
+ */
+typedef struct sr_get_data_iter_s sr_get_data_iter_t;
+
+/**
+ * @brief Operational value slot of a frequently updated leaf added using ::sr_oper_slot_add call.
+ */
+typedef struct sr_oper_slot_s sr_oper_slot_t;
+
 /**
  * @brief Callback to be called on the event of changing datastore content of the specified module.
  *
@@ -703,6 +842,23 @@ typedef int (*sr_oper_get_items_cb)(sr_session_ctx_t *session, uint32_t sub_id,
  */
 typedef int (*srp_init_cb_t)(sr_session_ctx_t *session, void **private_data);
 
+/**
+ * @brief Sysrepo plugin initialization callback subscribing into a subscription structure shared by all
+ * such plugins (see ::sr_subscription_create()).
+ *
+ * @param[in] session Sysrepo session that can be used for any API calls needed
+ * for plugin initialization.
+ * @param[in] subscription Shared subscription structure that must be passed (a copy of the pointer) to
+ * all the subscribe calls. Only the created subscriptions must be removed by ::sr_unsubscribe_sub() on cleanup,
+ * never the whole structure.
+ * @param[out] private_data Private context (opaque to sysrepo) that will be
+ * passed to ::srp_cleanup_cb_t when plugin cleanup is requested.
+ *
+ * @return Error code (::SR_ERR_OK on success).
+ */
+typedef int (*srp_init_shared_cb_t)(sr_session_ctx_t *session, sr_subscription_ctx_t *subscription,
+        void **private_data);
+
 /**
  * @brief Sysrepo plugin cleanup callback.
  *
@@ -26,6 +26,7 @@
 #include <pwd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <libyang/libyang.h>
@@ -41,6 +42,59 @@ static struct sr_nacm nacm;
 #define EMEM_CB sr_session_set_error_message(session, "Memory allocation failed (%s:%d)", __FILE__, __LINE__)
 #define EINT_CB sr_session_set_error_message(session, "Internal error (%s:%d)", __FILE__, __LINE__)
 
+/**
+ * @brief Free the compiled rules and cached verdicts of a NACM user, keeping its name and groups.
+ *
+ * @param[in] nuser NACM user to free the caches of.
+ */
+static void
+sr_nacm_user_caches_free(struct sr_nacm_user *nuser)
+{
+    uint32_t i;
+
+    for (i = 0; i < nuser->mod_count; ++i) {
+        free(nuser->mods[i].mod_name);
+        free(nuser->mods[i].rules);
+    }
+    free(nuser->mods);
+    free(nuser->verdicts);
+    free(nuser->accesses);
+}
+
+/**
+ * @brief Free a cached NACM user.
+ *
+ * @param[in] nuser NACM user to free.
+ */
+static void
+sr_nacm_user_free(struct sr_nacm_user *nuser)
+{
+    uint32_t i;
+
+    free(nuser->name);
+    for (i = 0; i < nuser->group_count; ++i) {
+        free(nuser->groups[i]);
+    }
+    free(nuser->groups);
+    sr_nacm_user_caches_free(nuser);
+}
+
+/**
+ * @brief Free all the cached NACM users, must be called on any NACM configuration change.
+ */
+static void
+sr_nacm_users_clear(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < nacm.user_count; ++i) {
+        sr_nacm_user_free(&nacm.users[i]);
+    }
+    free(nacm.users);
+    nacm.users = NULL;
+    nacm.user_count = 0;
+}
+
 /* /ietf-netconf-acm:nacm */
 static int
 sr_nacm_nacm_params_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const char *UNUSED(module_name), const char *xpath,
@@ -67,6 +121,9 @@ sr_nacm_nacm_params_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
 
+    /* compiled rules may change */
+    sr_nacm_users_clear();
+
     while ((rc = sr_get_change_tree_next(session, iter, &op, &node, NULL, NULL, NULL)) == SR_ERR_OK) {
         term = (struct lyd_node_term *)node;
         if (!strcmp(node->schema->name, "enable-nacm")) {
@@ -193,8 +250,11 @@ sr_nacm_srmon_oper_cb(sr_session_ctx_t *UNUSED(session), uint32_t UNUSED(sub_id)
 {
     sr_error_info_t *err_info = NULL;
     int rc = SR_ERR_OK;
-    struct lyd_node *cont;
-    char num_str[11];
+    struct lyd_node *cont, *list;
+    struct sr_nacm_rule_list *rlist;
+    struct sr_nacm_rule *r;
+    const char *keys[2];
+    char num_str[21];
 
     assert(*parent);
 
@@ -223,6 +283,48 @@ sr_nacm_srmon_oper_cb(sr_session_ctx_t *UNUSED(session), uint32_t UNUSED(sub_id)
         goto cleanup_unlock;
     }
 
+    /* evaluation statistics */
+    sprintf(num_str, "%" PRIu64, nacm.checks);
+    if ((err_info = sr_lyd_new_term(cont, NULL, "checks", num_str))) {
+        goto cleanup_unlock;
+    }
+    sprintf(num_str, "%" PRIu64, nacm.evaluated_nodes);
+    if ((err_info = sr_lyd_new_term(cont, NULL, "evaluated-nodes", num_str))) {
+        goto cleanup_unlock;
+    }
+    sprintf(num_str, "%" PRIu64, nacm.max_check_nodes);
+    if ((err_info = sr_lyd_new_term(cont, NULL, "max-check-evaluated-nodes", num_str))) {
+        goto cleanup_unlock;
+    }
+    sprintf(num_str, "%" PRIu64, nacm.evaluation_time);
+    if ((err_info = sr_lyd_new_term(cont, NULL, "evaluation-time", num_str))) {
+        goto cleanup_unlock;
+    }
+    sprintf(num_str, "%" PRIu64, nacm.max_check_time);
+    if ((err_info = sr_lyd_new_term(cont, NULL, "max-check-time", num_str))) {
+        goto cleanup_unlock;
+    }
+
+    /* rule statistics */
+    for (rlist = nacm.rule_lists; rlist; rlist = rlist->next) {
+        for (r = rlist->rules; r; r = r->next) {
+            keys[0] = rlist->name;
+            keys[1] = r->name;
+            if (lyd_new_list3(cont, NULL, "rule", keys, NULL, 0, &list)) {
+                sr_errinfo_new(&err_info, SR_ERR_LY, "%s", ly_last_logmsg());
+                goto cleanup_unlock;
+            }
+            sprintf(num_str, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(r->hits));
+            if ((err_info = sr_lyd_new_term(list, NULL, "hits", num_str))) {
+                goto cleanup_unlock;
+            }
+            sprintf(num_str, "%" PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(r->path_evals));
+            if ((err_info = sr_lyd_new_term(list, NULL, "path-evaluations", num_str))) {
+                goto cleanup_unlock;
+            }
+        }
+    }
+
 cleanup_unlock:
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
@@ -280,6 +382,9 @@ sr_nacm_group_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const char
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
 
+    /* compiled rules may change */
+    sr_nacm_users_clear();
+
     while ((rc = sr_get_change_tree_next(session, iter, &op, &node, NULL, NULL, NULL)) == SR_ERR_OK) {
         if (!strcmp(node->schema->name, "group")) {
             /* name must be present */
@@ -581,6 +686,9 @@ sr_nacm_rule_list_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const c
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
 
+    /* compiled rules may change */
+    sr_nacm_users_clear();
+
     while ((rc = sr_get_change_tree_next(session, iter, &op, &node, NULL, &prev_list, NULL)) == SR_ERR_OK) {
         if (!strcmp(node->schema->name, "rule-list")) {
             /* name must be present */
@@ -740,6 +848,9 @@ sr_nacm_rule_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const char *
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
 
+    /* compiled rules may change */
+    sr_nacm_users_clear();
+
     while ((rc = sr_get_change_tree_next(session, iter, &op, &node, NULL, &prev_list, NULL)) == SR_ERR_OK) {
         if (!strcmp(node->schema->name, "rule")) {
             /* find parent rule list */
@@ -1113,6 +1224,8 @@ sr_nacm_destroy(void)
         free(rule_list);
     }
 
+    sr_nacm_users_clear();
+
     nacm.rule_lists = NULL;
     nacm.groups = NULL;
     nacm.group_count = 0;
@@ -1451,257 +1564,742 @@ sr_nacm_rule_group_match(struct sr_nacm_rule_list *rlist, char **groups, uint32_
 }
 
 /**
- * @brief Free all NACM groups. Supposed to be called after @ref sr_nacm_collect_group.
+ * @brief Start a new NACM check, any rule target schema nodes resolved before are no longer valid.
  *
- * @param[out] groups Sorted array of collected groups to free
- * @param[out] group_count Number of @p groups.
+ * @param[in] ly_ctx Context of the checked data.
  */
 static void
-sr_nacm_free_groups(char **groups, uint32_t group_count)
+sr_nacm_check_start(const struct ly_ctx *ly_ctx)
 {
-    uint32_t i;
+    struct timespec ts;
 
-    if (!groups) {
-        return;
+    if (!++nacm.check_gen) {
+        /* 0 is never a valid generation */
+        ++nacm.check_gen;
     }
+    nacm.check_ctx = ly_ctx;
+
+    /* statistics of the check */
+    ATOMIC_STORE_RELAXED(nacm.check_nodes, 0);
+    sr_timeouttime_get(&ts, 0);
+    nacm.check_start = ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief Finish a NACM check started by ::sr_nacm_check_start(), update the evaluation statistics.
+ */
+static void
+sr_nacm_check_end(void)
+{
+    struct timespec ts;
+    uint64_t nodes, now, dur;
 
-    for (i = 0; i < group_count; ++i) {
-        free(groups[i]);
+    nodes = ATOMIC_LOAD_RELAXED(nacm.check_nodes);
+    sr_timeouttime_get(&ts, 0);
+    now = ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+    dur = (now > nacm.check_start) ? now - nacm.check_start : 0;
+
+    ++nacm.checks;
+    nacm.evaluated_nodes += nodes;
+    if (nodes > nacm.max_check_nodes) {
+        nacm.max_check_nodes = nodes;
+    }
+    nacm.evaluation_time += dur;
+    if (dur > nacm.max_check_time) {
+        nacm.max_check_time = dur;
     }
-    free(groups);
 }
 
 /**
- * @brief Check NACM access for a single node.
+ * @brief Get the cached NACM user with collected groups, create it if not cached.
  *
- * @param[in] node Node to check. Can be NULL if @p node_path and @p node_schema are set.
- * @param[in] node_path Node path of the node to check. Can be NULL if @p node is set.
- * @param[in] node_schema Schema of the node to check. Can be NULL if @p node is set.
- * @param[in] oper Operation to check.
- * @param[in] groups Array of groups name to be checked for permissions
- * @param[in] group_count Length of @p groups
- * @param[in] user NACM user.
- * @param[out] access SR_NACM result access, on denied and both @p rule and @p def unset, it is the default access.
- * @param[out] rule Offending rule if @p access denied, if applicable.
- * @param[out] def Offending NACM extension if @p access denied, if applicable.
- * @return errinfo, NULL on success.
+ * @param[in] user User name.
+ * @param[out] nuser Cached NACM user.
+ * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_nacm_allowed_node(const struct lyd_node *node, const char *node_path, const struct lysc_node *node_schema,
-        uint8_t oper, char **groups, uint32_t group_count, const char *user, enum sr_nacm_access *access,
-        struct sr_nacm_rule **rule, struct lysc_ext **def)
+sr_nacm_user_get(const char *user, struct sr_nacm_user **nuser)
 {
     sr_error_info_t *err_info = NULL;
-    struct sr_nacm_rule_list *rlist;
-    struct sr_nacm_rule *r;
-    char *path;
+    struct sr_nacm_user *nu;
+    time_t now;
+    uint32_t i;
+    void *mem;
 
-    *access = SR_NACM_ACCESS_DENY;
-    if (rule) {
-        *rule = NULL;
-    }
-    if (def) {
-        *def = NULL;
+    now = time(NULL);
+
+    for (i = 0; i < nacm.user_count; ++i) {
+        if (strcmp(nacm.users[i].name, user)) {
+            continue;
+        }
+
+        if (!nacm.enable_external_groups || (now < nacm.users[i].expires) ||
+                (nacm.users[i].check_gen == nacm.check_gen)) {
+            /* cached, never collected again during a single check */
+            nacm.users[i].check_gen = nacm.check_gen;
+            *nuser = &nacm.users[i];
+            return NULL;
+        }
+
+        /* system groups may have changed, collect them again */
+        sr_nacm_user_free(&nacm.users[i]);
+        --nacm.user_count;
+        memmove(&nacm.users[i], &nacm.users[i + 1], (nacm.user_count - i) * sizeof *nacm.users);
+        break;
     }
 
-    enum {
-        RULE_PARTIAL_MATCH_NONE = 0,
-        RULE_PARTIAL_MATCH_PERMIT = 1,
-        RULE_PARTIAL_MATCH_DENY = 2
-    } partial_access = RULE_PARTIAL_MATCH_NONE;
-    int path_match;
-    LY_ARRAY_COUNT_TYPE u;
+    if (nacm.user_count == SR_NACM_USER_CACHE_SIZE) {
+        /* forget the oldest user */
+        sr_nacm_user_free(&nacm.users[0]);
+        --nacm.user_count;
+        memmove(&nacm.users[0], &nacm.users[1], nacm.user_count * sizeof *nacm.users);
+    }
 
-    assert(node || (node_path && node_schema));
-    assert(oper);
+    /* add a new user */
+    mem = realloc(nacm.users, (nacm.user_count + 1) * sizeof *nacm.users);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    nacm.users = mem;
+    nu = &nacm.users[nacm.user_count];
+    memset(nu, 0, sizeof *nu);
 
-    if (!node_schema) {
-        node_schema = node->schema;
+    nu->name = strdup(user);
+    SR_CHECK_MEM_RET(!nu->name, err_info);
+    if ((err_info = sr_nacm_collect_groups(user, &nu->groups, &nu->group_count))) {
+        sr_nacm_user_free(nu);
+        return err_info;
     }
+    nu->expires = now + SR_NACM_USER_CACHE_TIMEOUT;
+    nu->check_gen = nacm.check_gen;
+    ++nacm.user_count;
 
-    /*
-     * ref https://tools.ietf.org/html/rfc8341#section-3.4.4
-     */
+    *nuser = nu;
+    return NULL;
+}
 
-    /* 4) collected groups passed as argument */
+/**
+ * @brief Get the rules of a user that can match nodes of a module, compile them if not yet done.
+ *
+ * Rules of other modules with a data target are kept as well because they can still partially match.
+ *
+ * @param[in] nuser Cached NACM user.
+ * @param[in] mod_name Module name.
+ * @param[out] mod_rules Rules of the user for the module.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_user_mod_rules(struct sr_nacm_user *nuser, const char *mod_name, struct sr_nacm_mod_rules **mod_rules)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_nacm_mod_rules *mr;
+    struct sr_nacm_rule_list *rlist;
+    struct sr_nacm_rule *r;
+    uint32_t i;
+    void *mem;
 
-    /* 5) no groups */
-    if (!group_count) {
-        goto step10;
+    /* consecutive nodes are mostly from the same module */
+    if ((nuser->last_mod < nuser->mod_count) && !strcmp(nuser->mods[nuser->last_mod].mod_name, mod_name)) {
+        *mod_rules = &nuser->mods[nuser->last_mod];
+        return NULL;
+    }
+
+    for (i = 0; i < nuser->mod_count; ++i) {
+        if (!strcmp(nuser->mods[i].mod_name, mod_name)) {
+            nuser->last_mod = i;
+            *mod_rules = &nuser->mods[i];
+            return NULL;
+        }
     }
 
-    /* 6) find matching rule lists */
+    /* compile the rules of a new module */
+    mem = realloc(nuser->mods, (nuser->mod_count + 1) * sizeof *nuser->mods);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    nuser->mods = mem;
+    mr = &nuser->mods[nuser->mod_count];
+    memset(mr, 0, sizeof *mr);
+
+    mr->mod_name = strdup(mod_name);
+    SR_CHECK_MEM_GOTO(!mr->mod_name, err_info, error);
+
     for (rlist = nacm.rule_lists; rlist; rlist = rlist->next) {
-        if (!sr_nacm_rule_group_match(rlist, groups, group_count)) {
+        if (!sr_nacm_rule_group_match(rlist, nuser->groups, nuser->group_count)) {
             /* no group match */
             continue;
         }
 
-        /* 7) find matching rules */
         for (r = rlist->rules; r; r = r->next) {
-            /* access operation matching */
-            if (!(r->operations & oper)) {
-                continue;
-            }
-
-            /* target (rule) type matching */
-            switch (r->target_type) {
-            case SR_NACM_TARGET_RPC:
-                if (node_schema->nodetype != LYS_RPC) {
-                    continue;
-                }
-                if (r->target && strcmp(r->target, node_schema->name)) {
-                    /* exact match needed */
-                    continue;
-                }
-                break;
-            case SR_NACM_TARGET_NOTIF:
-                /* only top-level notification */
-                if (node_schema->parent || (node_schema->nodetype != LYS_NOTIF)) {
-                    continue;
-                }
-                if (r->target && strcmp(r->target, node_schema->name)) {
-                    /* exact match needed */
-                    continue;
-                }
-                break;
-            case SR_NACM_TARGET_DATA:
-                if (node_schema->nodetype & (LYS_RPC | LYS_NOTIF)) {
-                    continue;
-                }
-            /* fallthrough */
-            case SR_NACM_TARGET_ANY:
-                if (r->target) {
-                    /* exact match or is a descendant (specified in RFC 8341 page 27) for full tree access */
-                    if (!node_path) {
-                        path = lyd_path(node, LYD_PATH_STD, NULL, 0);
-                        path_match = sr_nacm_allowed_path(r->target, path, user);
-                        free(path);
-                    } else {
-                        path_match = sr_nacm_allowed_path(r->target, node_path, user);
-                    }
-
-                    if (!path_match) {
-                        continue;
-                    } else if (path_match == 2) {
-                        /* partial match, continue searching for a full match */
-                        partial_access |= r->action_deny ? RULE_PARTIAL_MATCH_DENY : RULE_PARTIAL_MATCH_PERMIT;
-                        continue;
-                    }
-                }
-                break;
-            }
-
-            /* module name matching, after partial path matches */
-            if (r->module_name && strcmp(r->module_name, node_schema->module->name)) {
+            if (r->module_name && strcmp(r->module_name, mod_name) &&
+                    (!r->target || ((r->target_type != SR_NACM_TARGET_DATA) && (r->target_type != SR_NACM_TARGET_ANY)))) {
+                /* can never match */
                 continue;
             }
 
-            /* 8) rule matched */
-            *access = r->action_deny ? SR_NACM_ACCESS_DENY : SR_NACM_ACCESS_PERMIT;
-            if (rule) {
-                *rule = r;
-            }
-            goto cleanup;
+            mem = realloc(mr->rules, (mr->rule_count + 1) * sizeof *mr->rules);
+            SR_CHECK_MEM_GOTO(!mem, err_info, error);
+            mr->rules = mem;
+            mr->rules[mr->rule_count] = r;
+            ++mr->rule_count;
         }
     }
 
-    /* 9) no matching rule found */
-
-step10:
-    /* 10) check default-deny-all extension */
-    LY_ARRAY_FOR(node_schema->exts, u) {
-        if (!strcmp(node_schema->exts[u].def->module->name, "ietf-netconf-acm")) {
-            if (!strcmp(node_schema->exts[u].def->name, "default-deny-all")) {
-                if (def) {
-                    *def = node_schema->exts[u].def;
-                }
-                goto cleanup;
-            }
-            if ((oper & (SR_NACM_OP_CREATE | SR_NACM_OP_UPDATE | SR_NACM_OP_DELETE)) &&
-                    !strcmp(node_schema->exts[u].def->name, "default-deny-write")) {
-                if (def) {
-                    *def = node_schema->exts[u].def;
-                }
-                goto cleanup;
-            }
-        }
-    }
+    nuser->last_mod = nuser->mod_count;
+    ++nuser->mod_count;
+    *mod_rules = mr;
+    return NULL;
 
-    /* 11) was already covered in 10) */
+error:
+    free(mr->mod_name);
+    free(mr->rules);
+    return err_info;
+}
 
-    /* 12) check defaults */
-    switch (oper) {
-    case SR_NACM_OP_READ:
-        if (nacm.default_read_deny) {
-            *access = SR_NACM_ACCESS_DENY;
-        } else {
-            /* permit, but not by an explicit rule */
-            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
-        }
-        break;
-    case SR_NACM_OP_CREATE:
-    case SR_NACM_OP_UPDATE:
-    case SR_NACM_OP_DELETE:
-        if (nacm.default_write_deny) {
-            *access = SR_NACM_ACCESS_DENY;
-        } else {
-            /* permit, but not by an explicit rule */
-            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+/**
+ * @brief Get the schema node of a rule target, resolve it if not done in the current check.
+ *
+ * @param[in] r Rule with a target.
+ * @return Target schema node, NULL if it could not be resolved.
+ */
+static const struct lysc_node *
+sr_nacm_rule_target_snode(struct sr_nacm_rule *r)
+{
+    uint32_t *prev_lo, temp_lo = 0;
+
+    if (r->target_gen != nacm.check_gen) {
+        /* resolve rule target schema node in the context of this check */
+        r->target_snode = NULL;
+        if (nacm.check_ctx) {
+            prev_lo = ly_temp_log_options(&temp_lo);
+            r->target_snode = lys_find_path(nacm.check_ctx, NULL, r->target, 0);
+            ly_temp_log_options(prev_lo);
         }
-        break;
-    case SR_NACM_OP_EXEC:
-        if (nacm.default_exec_deny) {
-            *access = SR_NACM_ACCESS_DENY;
-        } else {
-            /* permit, but not by an explicit rule */
-            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+        if (r->target_snode && (r->target_snode->flags & (LYS_IS_INPUT | LYS_IS_OUTPUT))) {
+            /* RPC/action input and output nodes cannot be distinguished by the path */
+            r->target_snode = NULL;
         }
-        break;
-    default:
-        SR_ERRINFO_INT(&err_info);
-        goto cleanup;
+        r->target_gen = nacm.check_gen;
     }
 
-cleanup:
-    if ((*access == SR_NACM_ACCESS_DENY) && (partial_access & RULE_PARTIAL_MATCH_PERMIT)) {
-        /* node itself is not allowed but a rule allows access to some descendants so it may be allowed at the end */
-        *access = SR_NACM_ACCESS_PARTIAL_DENY;
-    } else if ((*access == SR_NACM_ACCESS_PERMIT) && (partial_access & RULE_PARTIAL_MATCH_DENY)) {
-        /* node itself is allowed but a rule denies access to some descendants */
-        *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
-    }
-    return NULL;
+    return r->target_snode;
 }
 
-sr_error_info_t *
-sr_nacm_check_operation(const char *nacm_user, const struct lyd_node *data, struct sr_denied *denied)
+/**
+ * @brief Check whether a rule target can match a node based on the schema node of the target.
+ *
+ * @param[in] r Rule with a target.
+ * @param[in] node_schema Schema node of the checked node.
+ * @param[in] partial Whether to consider partial matches, too.
+ * @return 0 if the target can never match the node.
+ * @return 1 if the node path needs to be matched with the target.
+ */
+static int
+sr_nacm_rule_target_related(struct sr_nacm_rule *r, const struct lysc_node *node_schema, int partial)
 {
-    sr_error_info_t *err_info = NULL;
-    const struct lyd_node *op = NULL;
-    char **groups = NULL;
-    uint32_t group_count = 0;
-    int allowed = 0;
-    enum sr_nacm_access access;
-    struct sr_nacm_rule *rule = NULL;
-    struct lysc_ext *def = NULL;
+    const struct lysc_node *iter, *target;
 
-    /* NACM LOCK */
-    pthread_mutex_lock(&nacm.lock);
+    target = sr_nacm_rule_target_snode(r);
+    if (!target || (node_schema->module->ctx != nacm.check_ctx)) {
+        /* unknown, the path must be matched */
+        return 1;
+    }
 
-    /* check access for the whole data tree first */
-    err_info = sr_nacm_allowed_tree(data->schema, nacm_user, &allowed);
-    if (err_info || allowed) {
-        goto cleanup;
+    /* target is the node or its ancestor, full match possible */
+    for (iter = node_schema; iter; iter = iter->parent) {
+        if (iter == target) {
+            return 1;
+        }
     }
 
-    if ((err_info = sr_nacm_collect_groups(nacm_user, &groups, &group_count))) {
-        goto cleanup;
+    if (partial) {
+        /* node is an ancestor of the target, partial match possible */
+        for (iter = target->parent; iter; iter = iter->parent) {
+            if (iter == node_schema) {
+                return 1;
+            }
+        }
     }
 
-    op = data;
-    while (op) {
-        if (op->schema->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+    return 0;
+}
+
+/**
+ * @brief Get the read access verdict of a single schema node of a user, ignoring its descendants.
+ *
+ * @param[in] nuser Cached NACM user with the compiled rules.
+ * @param[in] snode Schema node.
+ * @param[out] verdict Verdict for all the data instances of @p snode.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_schema_node_verdict(struct sr_nacm_user *nuser, const struct lysc_node *snode, enum sr_nacm_subtree *verdict)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_nacm_mod_rules *mod_rules;
+    struct sr_nacm_rule *r;
+    LY_ARRAY_COUNT_TYPE u;
+    uint32_t i;
+
+    *verdict = SR_NACM_SUBTREE_MIXED;
+
+    if ((snode->module->ctx != nacm.check_ctx) || (snode->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) ||
+            (snode->flags & (LYS_IS_INPUT | LYS_IS_OUTPUT | LYS_IS_NOTIF))) {
+        /* not a standard data node of the checked context */
+        return NULL;
+    }
+
+    LY_ARRAY_FOR(snode->exts, u) {
+        if (!strcmp(snode->exts[u].def->module->name, "ietf-netconf-acm") &&
+                !strcmp(snode->exts[u].def->name, "default-deny-all")) {
+            /* denied unless a rule permits it */
+            return NULL;
+        } else if (!strcmp(snode->exts[u].def->module->name, "ietf-yang-schema-mount") &&
+                !strcmp(snode->exts[u].def->name, "mount-point")) {
+            /* mounted data are not in the schema subtree */
+            return NULL;
+        }
+    }
+
+    if (nuser->group_count) {
+        if ((err_info = sr_nacm_user_mod_rules(nuser, snode->module->name, &mod_rules))) {
+            return err_info;
+        }
+
+        for (i = 0; i < mod_rules->rule_count; ++i) {
+            r = mod_rules->rules[i];
+            if (!(r->operations & SR_NACM_OP_READ) || (r->target_type == SR_NACM_TARGET_RPC) ||
+                    (r->target_type == SR_NACM_TARGET_NOTIF)) {
+                /* can never match a data node read */
+                continue;
+            }
+
+            if (r->target) {
+                if (sr_nacm_rule_target_related(r, snode, 0)) {
+                    /* matches only some instances */
+                    return NULL;
+                }
+                continue;
+            }
+
+            if (!r->module_name || !strcmp(r->module_name, snode->module->name)) {
+                /* matches all the instances */
+                *verdict = r->action_deny ? SR_NACM_SUBTREE_DENY : SR_NACM_SUBTREE_PERMIT;
+                return NULL;
+            }
+        }
+    }
+
+    /* default access */
+    *verdict = nacm.default_read_deny ? SR_NACM_SUBTREE_DENY : SR_NACM_SUBTREE_PERMIT;
+    return NULL;
+}
+
+/**
+ * @brief Get the read access verdict of a whole schema subtree of a user.
+ *
+ * Verdicts are cached for the duration of a single check.
+ *
+ * @param[in] nuser Cached NACM user with the compiled rules.
+ * @param[in] snode Root schema node of the subtree.
+ * @param[out] verdict Verdict for all the data instances of the schema subtree.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_schema_subtree_verdict(struct sr_nacm_user *nuser, const struct lysc_node *snode,
+        enum sr_nacm_subtree *verdict)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *child;
+    enum sr_nacm_subtree ch_verdict;
+    uint32_t lo, hi, mid;
+    void *mem;
+
+    if (nuser->verdict_gen != nacm.check_gen) {
+        /* verdicts of a previous check */
+        nuser->verdict_count = 0;
+        nuser->verdict_gen = nacm.check_gen;
+    }
+
+    /* binary search in the cached verdicts sorted by the schema node */
+    lo = 0;
+    hi = nuser->verdict_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (nuser->verdicts[mid].snode == snode) {
+            *verdict = nuser->verdicts[mid].verdict;
+            return NULL;
+        } else if ((uintptr_t)nuser->verdicts[mid].snode < (uintptr_t)snode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* node verdict */
+    if ((err_info = sr_nacm_schema_node_verdict(nuser, snode, verdict))) {
+        return err_info;
+    }
+
+    if (*verdict != SR_NACM_SUBTREE_MIXED) {
+        /* all the descendants must have the same verdict */
+        LY_LIST_FOR(lysc_node_child(snode), child) {
+            if ((err_info = sr_nacm_schema_subtree_verdict(nuser, child, &ch_verdict))) {
+                return err_info;
+            }
+            if (ch_verdict != *verdict) {
+                *verdict = SR_NACM_SUBTREE_MIXED;
+                break;
+            }
+        }
+    }
+
+    /* find the position again, the descendants were added */
+    lo = 0;
+    hi = nuser->verdict_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if ((uintptr_t)nuser->verdicts[mid].snode < (uintptr_t)snode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* cache the verdict */
+    mem = realloc(nuser->verdicts, (nuser->verdict_count + 1) * sizeof *nuser->verdicts);
+    SR_CHECK_MEM_RET(!mem, err_info);
+    nuser->verdicts = mem;
+    memmove(&nuser->verdicts[lo + 1], &nuser->verdicts[lo], (nuser->verdict_count - lo) * sizeof *nuser->verdicts);
+    nuser->verdicts[lo].snode = snode;
+    nuser->verdicts[lo].verdict = *verdict;
+    ++nuser->verdict_count;
+
+    return NULL;
+}
+
+/**
+ * @brief Find the cached access of a schema node for an operation or the position to insert it to.
+ *
+ * @param[in] nuser Cached NACM user.
+ * @param[in] snode Schema node.
+ * @param[in] oper Checked operation.
+ * @param[out] idx Index of the access if found, otherwise the index to insert it to.
+ * @return Found access, NULL if not cached.
+ */
+static struct sr_nacm_snode_access *
+sr_nacm_snode_access_find(struct sr_nacm_user *nuser, const struct lysc_node *snode, uint8_t oper, uint32_t *idx)
+{
+    struct sr_nacm_snode_access *acc;
+    uint32_t lo, hi, mid;
+
+    if (nuser->access_gen != nacm.check_gen) {
+        /* accesses of a previous check */
+        nuser->access_count = 0;
+        nuser->access_gen = nacm.check_gen;
+    }
+
+    lo = 0;
+    hi = nuser->access_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        acc = &nuser->accesses[mid];
+        if ((acc->snode == snode) && (acc->oper == oper)) {
+            *idx = mid;
+            return acc;
+        } else if (((uintptr_t)acc->snode < (uintptr_t)snode) || ((acc->snode == snode) && (acc->oper < oper))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *idx = lo;
+    return NULL;
+}
+
+/**
+ * @brief Check NACM access for a single node.
+ *
+ * The access is cached for the duration of a single check if it was decided only based on the schema node.
+ *
+ * @param[in] node Node to check. Can be NULL if @p node_path and @p node_schema are set.
+ * @param[in] node_path Node path of the node to check. Can be NULL if @p node is set.
+ * @param[in] node_schema Schema of the node to check. Can be NULL if @p node is set.
+ * @param[in] oper Operation to check.
+ * @param[in] nuser Cached NACM user with the compiled rules.
+ * @param[out] access SR_NACM result access, on denied and both @p rule and @p def unset, it is the default access.
+ * @param[out] rule Offending rule if @p access denied, if applicable.
+ * @param[out] def Offending NACM extension if @p access denied, if applicable.
+ * @return errinfo, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_allowed_node(const struct lyd_node *node, const char *node_path, const struct lysc_node *node_schema,
+        uint8_t oper, struct sr_nacm_user *nuser, enum sr_nacm_access *access, struct sr_nacm_rule **rule,
+        struct lysc_ext **def)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_nacm_mod_rules *mod_rules;
+    struct sr_nacm_rule *r, *match_rule = NULL;
+    struct lysc_ext *match_def = NULL;
+    struct sr_nacm_snode_access *acc;
+    char *path = NULL;
+    uint32_t i, acc_idx = 0;
+    int cacheable;
+    void *mem;
+
+    *access = SR_NACM_ACCESS_DENY;
+    if (rule) {
+        *rule = NULL;
+    }
+    if (def) {
+        *def = NULL;
+    }
+
+    enum {
+        RULE_PARTIAL_MATCH_NONE = 0,
+        RULE_PARTIAL_MATCH_PERMIT = 1,
+        RULE_PARTIAL_MATCH_DENY = 2
+    } partial_access = RULE_PARTIAL_MATCH_NONE;
+    int path_match;
+    LY_ARRAY_COUNT_TYPE u;
+
+    assert(node || (node_path && node_schema));
+    assert(oper);
+
+    if (!node_schema) {
+        node_schema = node->schema;
+    }
+
+    ATOMIC_INC_RELAXED(nacm.check_nodes);
+
+    /* schema nodes of other contexts cannot be cached */
+    cacheable = (node_schema->module->ctx == nacm.check_ctx);
+    if (cacheable && (acc = sr_nacm_snode_access_find(nuser, node_schema, oper, &acc_idx))) {
+        /* same access as for the previous instances */
+        if (acc->rule) {
+            ATOMIC_INC_RELAXED(acc->rule->hits);
+        }
+        *access = acc->access;
+        if (rule) {
+            *rule = acc->rule;
+        }
+        if (def) {
+            *def = acc->def;
+        }
+        return NULL;
+    }
+
+    /*
+     * ref https://tools.ietf.org/html/rfc8341#section-3.4.4
+     */
+
+    /* 4) collected groups passed as argument */
+
+    /* 5) no groups */
+    if (!nuser->group_count) {
+        goto step10;
+    }
+
+    /* 6) find matching rule lists, compiled with only the rules relevant for the module */
+    if ((err_info = sr_nacm_user_mod_rules(nuser, node_schema->module->name, &mod_rules))) {
+        goto cleanup;
+    }
+
+    /* 7) find matching rules */
+    for (i = 0; i < mod_rules->rule_count; ++i) {
+        r = mod_rules->rules[i];
+
+        /* access operation matching */
+        if (!(r->operations & oper)) {
+            continue;
+        }
+
+        /* target (rule) type matching */
+        switch (r->target_type) {
+        case SR_NACM_TARGET_RPC:
+            if (node_schema->nodetype != LYS_RPC) {
+                continue;
+            }
+            if (r->target && strcmp(r->target, node_schema->name)) {
+                /* exact match needed */
+                continue;
+            }
+            break;
+        case SR_NACM_TARGET_NOTIF:
+            /* only top-level notification */
+            if (node_schema->parent || (node_schema->nodetype != LYS_NOTIF)) {
+                continue;
+            }
+            if (r->target && strcmp(r->target, node_schema->name)) {
+                /* exact match needed */
+                continue;
+            }
+            break;
+        case SR_NACM_TARGET_DATA:
+            if (node_schema->nodetype & (LYS_RPC | LYS_NOTIF)) {
+                continue;
+            }
+        /* fallthrough */
+        case SR_NACM_TARGET_ANY:
+            if (r->target) {
+                if (!sr_nacm_rule_target_related(r, node_schema, 1)) {
+                    /* target schema node is not related to the node */
+                    continue;
+                }
+
+                /* the access depends on the data instance */
+                cacheable = 0;
+
+                /* exact match or is a descendant (specified in RFC 8341 page 27) for full tree access */
+                ATOMIC_INC_RELAXED(r->path_evals);
+                if (!node_path) {
+                    if (!path) {
+                        path = lyd_path(node, LYD_PATH_STD, NULL, 0);
+                        SR_CHECK_MEM_GOTO(!path, err_info, cleanup);
+                    }
+                    path_match = sr_nacm_allowed_path(r->target, path, nuser->name);
+                } else {
+                    path_match = sr_nacm_allowed_path(r->target, node_path, nuser->name);
+                }
+
+                if (!path_match) {
+                    continue;
+                } else if (path_match == 2) {
+                    /* partial match, continue searching for a full match */
+                    partial_access |= r->action_deny ? RULE_PARTIAL_MATCH_DENY : RULE_PARTIAL_MATCH_PERMIT;
+                    continue;
+                }
+            }
+            break;
+        }
+
+        /* module name matching, after partial path matches */
+        if (r->module_name && strcmp(r->module_name, node_schema->module->name)) {
+            continue;
+        }
+
+        /* 8) rule matched */
+        *access = r->action_deny ? SR_NACM_ACCESS_DENY : SR_NACM_ACCESS_PERMIT;
+        match_rule = r;
+        ATOMIC_INC_RELAXED(r->hits);
+        goto cleanup;
+    }
+
+    /* 9) no matching rule found */
+
+step10:
+    /* 10) check default-deny-all extension */
+    LY_ARRAY_FOR(node_schema->exts, u) {
+        if (!strcmp(node_schema->exts[u].def->module->name, "ietf-netconf-acm")) {
+            if (!strcmp(node_schema->exts[u].def->name, "default-deny-all")) {
+                match_def = node_schema->exts[u].def;
+                goto cleanup;
+            }
+            if ((oper & (SR_NACM_OP_CREATE | SR_NACM_OP_UPDATE | SR_NACM_OP_DELETE)) &&
+                    !strcmp(node_schema->exts[u].def->name, "default-deny-write")) {
+                match_def = node_schema->exts[u].def;
+                goto cleanup;
+            }
+        }
+    }
+
+    /* 11) was already covered in 10) */
+
+    /* 12) check defaults */
+    switch (oper) {
+    case SR_NACM_OP_READ:
+        if (nacm.default_read_deny) {
+            *access = SR_NACM_ACCESS_DENY;
+        } else {
+            /* permit, but not by an explicit rule */
+            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+        }
+        break;
+    case SR_NACM_OP_CREATE:
+    case SR_NACM_OP_UPDATE:
+    case SR_NACM_OP_DELETE:
+        if (nacm.default_write_deny) {
+            *access = SR_NACM_ACCESS_DENY;
+        } else {
+            /* permit, but not by an explicit rule */
+            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+        }
+        break;
+    case SR_NACM_OP_EXEC:
+        if (nacm.default_exec_deny) {
+            *access = SR_NACM_ACCESS_DENY;
+        } else {
+            /* permit, but not by an explicit rule */
+            *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+        }
+        break;
+    default:
+        SR_ERRINFO_INT(&err_info);
+        goto cleanup;
+    }
+
+cleanup:
+    if ((*access == SR_NACM_ACCESS_DENY) && (partial_access & RULE_PARTIAL_MATCH_PERMIT)) {
+        /* node itself is not allowed but a rule allows access to some descendants so it may be allowed at the end */
+        *access = SR_NACM_ACCESS_PARTIAL_DENY;
+    } else if ((*access == SR_NACM_ACCESS_PERMIT) && (partial_access & RULE_PARTIAL_MATCH_DENY)) {
+        /* node itself is allowed but a rule denies access to some descendants */
+        *access = SR_NACM_ACCESS_PARTIAL_PERMIT;
+    }
+    if (rule) {
+        *rule = match_rule;
+    }
+    if (def) {
+        *def = match_def;
+    }
+
+    if (!err_info && cacheable) {
+        /* cache the access, the same for all the instances of the schema node */
+        mem = realloc(nuser->accesses, (nuser->access_count + 1) * sizeof *nuser->accesses);
+        if (!mem) {
+            SR_ERRINFO_MEM(&err_info);
+        } else {
+            nuser->accesses = mem;
+            acc = &nuser->accesses[acc_idx];
+            memmove(acc + 1, acc, (nuser->access_count - acc_idx) * sizeof *acc);
+            acc->snode = node_schema;
+            acc->oper = oper;
+            acc->access = *access;
+            acc->rule = match_rule;
+            acc->def = match_def;
+            ++nuser->access_count;
+        }
+    }
+
+    free(path);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_nacm_check_operation(const char *nacm_user, const struct lyd_node *data, struct sr_denied *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lyd_node *op = NULL;
+    struct sr_nacm_user *nuser;
+    int allowed = 0;
+    enum sr_nacm_access access;
+    struct sr_nacm_rule *rule = NULL;
+    struct lysc_ext *def = NULL;
+
+    /* NACM LOCK */
+    pthread_mutex_lock(&nacm.lock);
+    sr_nacm_check_start(LYD_CTX(data));
+
+    /* check access for the whole data tree first */
+    err_info = sr_nacm_allowed_tree(data->schema, nacm_user, &allowed);
+    if (err_info || allowed) {
+        goto cleanup;
+    }
+
+    if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
+        goto cleanup;
+    }
+
+    op = data;
+    while (op) {
+        if (op->schema->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
             /* we found the desired node */
             break;
         }
@@ -1737,8 +2335,7 @@ sr_nacm_check_operation(const char *nacm_user, const struct lyd_node *data, stru
 
     if (op->schema->nodetype & (LYS_RPC | LYS_ACTION)) {
         /* check X access on the RPC/action */
-        if ((err_info = sr_nacm_allowed_node(op, NULL, NULL, SR_NACM_OP_EXEC, groups, group_count, nacm_user, &access,
-                &rule, &def))) {
+        if ((err_info = sr_nacm_allowed_node(op, NULL, NULL, SR_NACM_OP_EXEC, nuser, &access, &rule, &def))) {
             goto cleanup;
         }
 
@@ -1749,8 +2346,7 @@ sr_nacm_check_operation(const char *nacm_user, const struct lyd_node *data, stru
         assert(op->schema->nodetype == LYS_NOTIF);
 
         /* check R access on the notification */
-        if ((err_info = sr_nacm_allowed_node(op, NULL, NULL, SR_NACM_OP_READ, groups, group_count, nacm_user, &access,
-                &rule, &def))) {
+        if ((err_info = sr_nacm_allowed_node(op, NULL, NULL, SR_NACM_OP_READ, nuser, &access, &rule, &def))) {
             goto cleanup;
         }
 
@@ -1761,8 +2357,8 @@ sr_nacm_check_operation(const char *nacm_user, const struct lyd_node *data, stru
 
     if (op->parent) {
         /* check R access on the parents, the last parent must be enough */
-        if ((err_info = sr_nacm_allowed_node(lyd_parent(op), NULL, NULL, SR_NACM_OP_READ, groups, group_count,
-                nacm_user, &access, &rule, &def))) {
+        if ((err_info = sr_nacm_allowed_node(lyd_parent(op), NULL, NULL, SR_NACM_OP_READ, nuser, &access, &rule,
+                &def))) {
             goto cleanup;
         }
 
@@ -1786,45 +2382,199 @@ cleanup:
         denied->def = def;
     }
 
+    sr_nacm_check_end();
+
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
 
-    sr_nacm_free_groups(groups, group_count);
     return err_info;
 }
 
 /**
  * @brief Filter out any nodes in a subtree for which the user does not have R access, recursively.
  *
+ * @param[in] conn Connection whose worker threads to use for filtering many children in parallel, NULL to filter
+ * sequentially.
  * @param[in] subtree Subtree to filter.
- * @param[in] user User for the NACM filtering.
- * @param[in] groups Array of collected groups.
- * @param[in] group_count Number of @p groups.
+ * @param[in] nuser Cached NACM user for the NACM filtering.
  * @param[out] access Highest access among descendants (recursively), permit is the highest.
  * @param[in,out] denied Set of denied access data subtrees to add to.
  * @return errinfo, NULL on success.
  */
 static sr_error_info_t *
-sr_nacm_check_data_read_filter_r(const struct lyd_node *subtree, const char *user, char **groups, uint32_t group_count,
+sr_nacm_check_data_read_filter_r(sr_conn_ctx_t *conn, const struct lyd_node *subtree, struct sr_nacm_user *nuser,
+        enum sr_nacm_access *access, struct ly_set *denied);
+
+/**
+ * @brief Children of a subtree filtered by a single job.
+ */
+struct sr_nacm_filter_part_s {
+    const struct lyd_node *first;   /**< First child of the part. */
+    uint32_t count;                 /**< Number of children in the part. */
+    struct sr_nacm_user nuser;      /**< Copy of the NACM user sharing its groups but with its own caches. */
+    enum sr_nacm_access access;     /**< Highest access among the children. */
+    struct ly_set denied;           /**< Denied access data subtrees of the part. */
+};
+
+/**
+ * @brief Filter the children of a subtree part, callback of ::sr_conn_load_run().
+ *
+ * @param[in] idx Part index.
+ * @param[in] cb_data Array of all the parts.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_filter_part_job(uint32_t idx, void *cb_data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_nacm_filter_part_s *part = &((struct sr_nacm_filter_part_s *)cb_data)[idx];
+    const struct lyd_node *child;
+    enum sr_nacm_access ch_access;
+    uint32_t i;
+
+    part->access = SR_NACM_ACCESS_DENY;
+
+    for (i = 0, child = part->first; i < part->count; ++i, child = child->next) {
+        /* no nested parallel filtering */
+        if ((err_info = sr_nacm_check_data_read_filter_r(NULL, child, &part->nuser, &ch_access, &part->denied))) {
+            return err_info;
+        }
+
+        if (ch_access > part->access) {
+            part->access = ch_access;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Filter the children of a subtree in parallel, each part by a separate job.
+ *
+ * The jobs do not modify any shared NACM data, they use their own caches and collect the denied subtrees that are
+ * then moved to @p denied in the children order. The NACM lock must be held.
+ *
+ * @param[in] conn Connection whose worker threads to use.
+ * @param[in] subtree Subtree with the children to filter.
+ * @param[in] child_count Number of children of @p subtree.
+ * @param[in] nuser Cached NACM user for the NACM filtering.
+ * @param[out] child_access Highest access among the children.
+ * @param[in,out] denied Set of denied access data subtrees to add to.
+ * @return errinfo, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_check_data_read_filter_parallel(sr_conn_ctx_t *conn, const struct lyd_node *subtree, uint32_t child_count,
+        struct sr_nacm_user *nuser, enum sr_nacm_access *child_access, struct ly_set *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_nacm_filter_part_s *parts;
+    struct sr_nacm_rule_list *rlist;
+    struct sr_nacm_rule *r;
+    const struct lyd_node *child;
+    uint32_t i, j, part_count;
+
+    *child_access = SR_NACM_ACCESS_DENY;
+
+    /* a part for each worker and this thread */
+    part_count = SR_LOAD_POOL_THREADS + 1;
+    if (part_count > child_count) {
+        part_count = child_count;
+    }
+    parts = calloc(part_count, sizeof *parts);
+    SR_CHECK_MEM_RET(!parts, err_info);
+
+    /* resolve all the rule targets now so that the jobs only read them */
+    for (rlist = nacm.rule_lists; rlist; rlist = rlist->next) {
+        for (r = rlist->rules; r; r = r->next) {
+            if (r->target) {
+                sr_nacm_rule_target_snode(r);
+            }
+        }
+    }
+
+    /* split the children evenly */
+    child = lyd_child(subtree);
+    for (i = 0; i < part_count; ++i) {
+        parts[i].first = child;
+        parts[i].count = child_count / part_count + ((i < child_count % part_count) ? 1 : 0);
+        parts[i].nuser.name = nuser->name;
+        parts[i].nuser.groups = nuser->groups;
+        parts[i].nuser.group_count = nuser->group_count;
+        for (j = 0; j < parts[i].count; ++j) {
+            child = child->next;
+        }
+    }
+
+    err_info = sr_conn_load_run(conn, part_count, sr_nacm_filter_part_job, parts);
+
+    for (i = 0; i < part_count; ++i) {
+        if (!err_info) {
+            /* move the denied subtrees */
+            for (j = 0; j < parts[i].denied.count; ++j) {
+                if (ly_set_add(denied, parts[i].denied.dnodes[j], 1, NULL)) {
+                    sr_errinfo_new(&err_info, SR_ERR_LY, "%s", ly_last_logmsg());
+                    break;
+                }
+            }
+
+            if (parts[i].access > *child_access) {
+                *child_access = parts[i].access;
+            }
+        }
+
+        ly_set_erase(&parts[i].denied, NULL);
+        sr_nacm_user_caches_free(&parts[i].nuser);
+    }
+    free(parts);
+
+    return err_info;
+}
+
+static sr_error_info_t *
+sr_nacm_check_data_read_filter_r(sr_conn_ctx_t *conn, const struct lyd_node *subtree, struct sr_nacm_user *nuser,
         enum sr_nacm_access *access, struct ly_set *denied)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *next, *child;
     enum sr_nacm_access node_access, ch_access, child_access = SR_NACM_ACCESS_DENY;
+    enum sr_nacm_subtree verdict;
+    uint32_t child_count = 0;
 
     *access = SR_NACM_ACCESS_DENY;
 
     /* check access of the node */
-    if ((err_info = sr_nacm_allowed_node(subtree, NULL, NULL, SR_NACM_OP_READ, groups, group_count, user, &node_access,
-            NULL, NULL))) {
+    if ((err_info = sr_nacm_allowed_node(subtree, NULL, NULL, SR_NACM_OP_READ, nuser, &node_access, NULL, NULL))) {
         return err_info;
     }
 
+    if ((node_access == SR_NACM_ACCESS_PARTIAL_PERMIT) && (subtree->schema->nodetype & LYD_NODE_INNER)) {
+        /* the whole subtree may be permitted based on the schema */
+        if ((err_info = sr_nacm_schema_subtree_verdict(nuser, subtree->schema, &verdict))) {
+            return err_info;
+        }
+        if (verdict == SR_NACM_SUBTREE_PERMIT) {
+            node_access = SR_NACM_ACCESS_PERMIT;
+        }
+    }
+
     if ((node_access == SR_NACM_ACCESS_PARTIAL_DENY) || (node_access == SR_NACM_ACCESS_PARTIAL_PERMIT)) {
         /* only partial access, we must check children recursively */
-        if (subtree->schema->nodetype & LYD_NODE_INNER) {
+        if (conn && SR_NACM_FILTER_PARALLEL_MIN && SR_LOAD_POOL_THREADS &&
+                (subtree->schema->nodetype & LYD_NODE_INNER)) {
+            LY_LIST_FOR(lyd_child(subtree), child) {
+                ++child_count;
+            }
+        }
+
+        if (child_count >= SR_NACM_FILTER_PARALLEL_MIN) {
+            /* many children, filter them in parallel */
+            if ((err_info = sr_nacm_check_data_read_filter_parallel(conn, subtree, child_count, nuser, &child_access,
+                    denied))) {
+                return err_info;
+            }
+        } else if (subtree->schema->nodetype & LYD_NODE_INNER) {
             LY_LIST_FOR_SAFE(lyd_child(subtree), next, child) {
-                if ((err_info = sr_nacm_check_data_read_filter_r(child, user, groups, group_count, &ch_access, denied))) {
+                if ((err_info = sr_nacm_check_data_read_filter_r(conn, child, nuser, &ch_access, denied))) {
                     return err_info;
                 }
 
@@ -1866,17 +2616,16 @@ sr_nacm_check_data_read_filter_r(const struct lyd_node *subtree, const char *use
 /**
  * @brief Collect any subtrees in a selected subtree for which the user does not have R access, recursively.
  *
+ * @param[in] conn Connection whose worker threads to use for filtering in parallel, NULL to filter sequentially.
  * @param[in] subtree Subtree to filter.
- * @param[in] user User for the NACM filtering.
- * @param[in] groups Array of collected groups.
- * @param[in] group_count Number of @p groups.
+ * @param[in] nuser Cached NACM user for the NACM filtering.
  * @param[out] access Highest access among descendants (recursively), permit is the highest.
  * @param[in,out] denied Set of denied access data subtrees to add to.
  * @return errinfo, NULL on success.
  */
 static sr_error_info_t *
-sr_nacm_check_data_read_filter_select_r(const struct lyd_node *subtree, const char *user, char **groups,
-        uint32_t group_count, enum sr_nacm_access *access, struct ly_set *denied)
+sr_nacm_check_data_read_filter_select_r(sr_conn_ctx_t *conn, const struct lyd_node *subtree,
+        struct sr_nacm_user *nuser, enum sr_nacm_access *access, struct ly_set *denied)
 {
     sr_error_info_t *err_info = NULL;
     const struct lyd_node *parent = NULL;
@@ -1887,8 +2636,7 @@ sr_nacm_check_data_read_filter_select_r(const struct lyd_node *subtree, const ch
             parent = lyd_parent(parent);
 
             /* check access for parent node */
-            if ((err_info = sr_nacm_allowed_node(parent, NULL, NULL, SR_NACM_OP_READ, groups, group_count, user, access,
-                    NULL, NULL))) {
+            if ((err_info = sr_nacm_allowed_node(parent, NULL, NULL, SR_NACM_OP_READ, nuser, access, NULL, NULL))) {
                 return err_info;
             }
 
@@ -1907,7 +2655,7 @@ sr_nacm_check_data_read_filter_select_r(const struct lyd_node *subtree, const ch
     }
 
     /* check the subtree normally */
-    if ((err_info = sr_nacm_check_data_read_filter_r(subtree, user, groups, group_count, access, denied))) {
+    if ((err_info = sr_nacm_check_data_read_filter_r(conn, subtree, nuser, access, denied))) {
         return err_info;
     }
 
@@ -1925,18 +2673,19 @@ sr_nacm_check_data_read_filter_select_r(const struct lyd_node *subtree, const ch
  * According to https://tools.ietf.org/html/rfc8341#section-3.2.4
  * recovery session is allowed to access all nodes.
  *
+ * @param[in] conn Connection whose worker threads to use for filtering in parallel, NULL to filter sequentially.
  * @param[in] nacm_user NACM username to use.
  * @param[in] tree Data tree (ignoring siblings) to filter. If not top-level, all parents are also checked.
  * @param[in,out] denied Set of denied access data subtrees to add to.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_nacm_check_data_read_filter(const char *nacm_user, const struct lyd_node *tree, struct ly_set *denied)
+sr_nacm_check_data_read_filter(sr_conn_ctx_t *conn, const char *nacm_user, const struct lyd_node *tree,
+        struct ly_set *denied)
 {
     sr_error_info_t *err_info = NULL;
     const struct lyd_node *tree_top;
-    char **groups = NULL;
-    uint32_t group_count;
+    struct sr_nacm_user *nuser;
     enum sr_nacm_access access;
     int allowed;
 
@@ -1951,26 +2700,24 @@ sr_nacm_check_data_read_filter(const char *nacm_user, const struct lyd_node *tre
         tree_top = lyd_parent(tree_top);
     }
 
-    /* collect user groups */
-    if ((err_info = sr_nacm_collect_groups(nacm_user, &groups, &group_count))) {
-        goto cleanup;
-    }
-
     /* basic global checks for the whole tree */
     if ((err_info = sr_nacm_allowed_tree(tree_top->schema, nacm_user, &allowed))) {
-        goto cleanup;
+        return err_info;
     }
 
     if (!allowed) {
+        /* get user with collected groups */
+        if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
+            return err_info;
+        }
+
         /* check whether any node access is denied */
-        if ((err_info = sr_nacm_check_data_read_filter_select_r(tree, nacm_user, groups, group_count, &access, denied))) {
-            goto cleanup;
+        if ((err_info = sr_nacm_check_data_read_filter_select_r(conn, tree, nuser, &access, denied))) {
+            return err_info;
         }
     }
 
-cleanup:
-    sr_nacm_free_groups(groups, group_count);
-    return err_info;
+    return NULL;
 }
 
 sr_error_info_t *
@@ -1979,7 +2726,7 @@ sr_nacm_get_node_set_read_filter(sr_session_ctx_t *session, struct ly_set *set)
     sr_error_info_t *err_info = NULL;
     struct ly_set denied_set = {0};
     uint32_t i, j;
-    int denied;
+    int denied, started = 0;
 
     if (!session->nacm_user) {
         /* nothing to do */
@@ -1988,10 +2735,15 @@ sr_nacm_get_node_set_read_filter(sr_session_ctx_t *session, struct ly_set *set)
 
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
+    if (set->count) {
+        sr_nacm_check_start(LYD_CTX(set->dnodes[0]));
+        started = 1;
+    }
 
     i = 0;
     while (i < set->count) {
-        if ((err_info = sr_nacm_check_data_read_filter(session->nacm_user, set->dnodes[i], &denied_set))) {
+        if ((err_info = sr_nacm_check_data_read_filter(session->conn, session->nacm_user, set->dnodes[i],
+                &denied_set))) {
             goto cleanup;
         }
 
@@ -2014,6 +2766,10 @@ sr_nacm_get_node_set_read_filter(sr_session_ctx_t *session, struct ly_set *set)
     }
 
 cleanup:
+    if (started) {
+        sr_nacm_check_end();
+    }
+
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
 
@@ -2038,9 +2794,12 @@ sr_nacm_get_subtree_read_filter(sr_session_ctx_t *session, struct lyd_node *subt
 
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
+    sr_nacm_check_start(LYD_CTX(subtree));
 
     /* apply NACM on the subtree */
-    err_info = sr_nacm_check_data_read_filter(session->nacm_user, subtree, &denied_set);
+    err_info = sr_nacm_check_data_read_filter(session->conn, session->nacm_user, subtree, &denied_set);
+
+    sr_nacm_check_end();
 
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
@@ -2067,6 +2826,157 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Check whether all the data instances of a schema subtree are denied R access.
+ *
+ * Any ancestor that could be permitted would make the subtree permitted as a whole so all of them must be denied.
+ *
+ * @param[in] nuser Cached NACM user with the compiled rules.
+ * @param[in] snode Root schema node of the subtree.
+ * @param[out] denied Whether all the data instances are denied.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_nacm_schema_read_denied(struct sr_nacm_user *nuser, const struct lysc_node *snode, int *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *parent;
+    enum sr_nacm_subtree verdict;
+
+    *denied = 0;
+
+    if (lysc_is_key(snode)) {
+        /* keys are never denied */
+        return NULL;
+    }
+
+    /* the whole subtree */
+    if ((err_info = sr_nacm_schema_subtree_verdict(nuser, snode, &verdict))) {
+        return err_info;
+    }
+    if (verdict != SR_NACM_SUBTREE_DENY) {
+        return NULL;
+    }
+
+    /* all the data ancestors */
+    for (parent = snode->parent; parent; parent = parent->parent) {
+        if (parent->nodetype & (LYS_CHOICE | LYS_CASE)) {
+            continue;
+        }
+
+        if ((err_info = sr_nacm_schema_node_verdict(nuser, parent, &verdict))) {
+            return err_info;
+        }
+        if (verdict != SR_NACM_SUBTREE_DENY) {
+            return NULL;
+        }
+    }
+
+    *denied = 1;
+    return NULL;
+}
+
+sr_error_info_t *
+sr_nacm_check_schema_read_denied(const char *nacm_user, const struct lysc_node *snode, int *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *top;
+    struct sr_nacm_user *nuser;
+    int allowed;
+
+    *denied = 0;
+
+    if (!nacm_user) {
+        /* nothing to do */
+        return NULL;
+    }
+
+    for (top = snode; top->parent; top = top->parent) {}
+
+    /* NACM LOCK */
+    pthread_mutex_lock(&nacm.lock);
+    sr_nacm_check_start(snode->module->ctx);
+
+    /* basic global checks */
+    if ((err_info = sr_nacm_allowed_tree(top, nacm_user, &allowed)) || allowed) {
+        goto cleanup;
+    }
+
+    /* get user with collected groups */
+    if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
+        goto cleanup;
+    }
+
+    err_info = sr_nacm_schema_read_denied(nuser, snode, denied);
+
+cleanup:
+    sr_nacm_check_end();
+
+    /* NACM UNLOCK */
+    pthread_mutex_unlock(&nacm.lock);
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_nacm_check_module_read_denied(const char *nacm_user, const struct lys_module *ly_mod, int *denied)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lysc_node *snode = NULL;
+    struct sr_nacm_user *nuser = NULL;
+    int allowed, has_data = 0;
+
+    *denied = 0;
+
+    if (!nacm_user) {
+        /* nothing to do */
+        return NULL;
+    }
+
+    /* NACM LOCK */
+    pthread_mutex_lock(&nacm.lock);
+    sr_nacm_check_start(ly_mod->ctx);
+
+    while ((snode = lys_getnext(snode, NULL, ly_mod->compiled, 0))) {
+        if (snode->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+            /* not data nodes */
+            continue;
+        }
+        has_data = 1;
+
+        if (!nuser) {
+            /* basic global checks */
+            if ((err_info = sr_nacm_allowed_tree(snode, nacm_user, &allowed)) || allowed) {
+                goto cleanup;
+            }
+
+            /* get user with collected groups */
+            if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
+                goto cleanup;
+            }
+        }
+
+        if ((err_info = sr_nacm_schema_read_denied(nuser, snode, denied))) {
+            goto cleanup;
+        }
+        if (!*denied) {
+            /* some data may be permitted */
+            goto cleanup;
+        }
+    }
+
+    /* a module without any data nodes is never skipped */
+    *denied = has_data;
+
+cleanup:
+    sr_nacm_check_end();
+
+    /* NACM UNLOCK */
+    pthread_mutex_unlock(&nacm.lock);
+
+    return err_info;
+}
+
 sr_error_info_t *
 sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, struct sr_denied *denied)
 {
@@ -2075,8 +2985,8 @@ sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, s
     struct lyd_node_any *ly_value;
     struct lyd_node *ly_target, *next, *iter;
     const struct lysc_node *snode;
-    uint32_t i, j, group_count = 0, removed = 0;
-    char **groups = NULL;
+    uint32_t i, j, removed = 0;
+    struct sr_nacm_user *nuser;
     enum sr_nacm_access access;
 
     assert(!strcmp(LYD_NAME(notif), "push-change-update"));
@@ -2088,8 +2998,9 @@ sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, s
 
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
+    sr_nacm_check_start(LYD_CTX(notif));
 
-    if ((err_info = sr_nacm_collect_groups(nacm_user, &groups, &group_count))) {
+    if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
         goto cleanup;
     }
 
@@ -2110,8 +3021,8 @@ sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, s
         }
 
         /* check the change itself */
-        if ((err_info = sr_nacm_allowed_node(NULL, lyd_get_value(ly_target), snode, SR_NACM_OP_READ, groups,
-                group_count, nacm_user, &access, NULL, NULL))) {
+        if ((err_info = sr_nacm_allowed_node(NULL, lyd_get_value(ly_target), snode, SR_NACM_OP_READ, nuser, &access,
+                NULL, NULL))) {
             goto cleanup;
         }
 
@@ -2126,7 +3037,7 @@ sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, s
 
             /* filter out any nested nodes */
             LY_LIST_FOR_SAFE(lyd_child(ly_value->value.tree), next, iter) {
-                if ((err_info = sr_nacm_check_data_read_filter(nacm_user, iter, &denied_s))) {
+                if ((err_info = sr_nacm_check_data_read_filter(NULL, nacm_user, iter, &denied_s))) {
                     goto cleanup;
                 }
             }
@@ -2152,10 +3063,11 @@ sr_nacm_check_push_update_notif(const char *nacm_user, struct lyd_node *notif, s
     }
 
 cleanup:
+    sr_nacm_check_end();
+
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
 
-    sr_nacm_free_groups(groups, group_count);
     ly_set_free(set, NULL);
     ly_set_erase(&denied_s, NULL);
     return err_info;
@@ -2165,16 +3077,14 @@ cleanup:
  * @brief Check whether diff node siblings can be applied by a user, recursively with children.
  *
  * @param[in] diff First diff sibling.
- * @param[in] user User for the NACM check.
+ * @param[in] nuser Cached NACM user for the NACM check.
  * @param[in] parent_op Inherited parent operation.
- * @param[in] groups Array of collected groups.
- * @param[in] group_count Number of @p groups.
  * @param[in,out] denied Deny details, if applicable.
  * @return errinfo, NULL on success.
  */
 static sr_error_info_t *
-sr_nacm_check_diff_r(const struct lyd_node *diff, const char *user, const char *parent_op, char **groups,
-        uint32_t group_count, struct sr_denied *denied)
+sr_nacm_check_diff_r(const struct lyd_node *diff, struct sr_nacm_user *nuser, const char *parent_op,
+        struct sr_denied *denied)
 {
     sr_error_info_t *err_info = NULL;
     const char *op;
@@ -2225,7 +3135,7 @@ sr_nacm_check_diff_r(const struct lyd_node *diff, const char *user, const char *
 
         /* check access for the node, none operation is always allowed */
         if (oper) {
-            if ((err_info = sr_nacm_allowed_node(diff, NULL, NULL, oper, groups, group_count, user, &access, &rule, &def))) {
+            if ((err_info = sr_nacm_allowed_node(diff, NULL, NULL, oper, nuser, &access, &rule, &def))) {
                 return err_info;
             }
 
@@ -2243,7 +3153,7 @@ sr_nacm_check_diff_r(const struct lyd_node *diff, const char *user, const char *
         }
 
         /* go recursively */
-        if ((err_info = sr_nacm_check_diff_r(lyd_child(diff), user, op, groups, group_count, denied))) {
+        if ((err_info = sr_nacm_check_diff_r(lyd_child(diff), nuser, op, denied))) {
             return err_info;
         }
 
@@ -2260,16 +3170,12 @@ sr_error_info_t *
 sr_nacm_check_diff(const char *nacm_user, const struct lyd_node *diff, struct sr_denied *denied)
 {
     sr_error_info_t *err_info = NULL;
-    char **groups = NULL;
-    uint32_t group_count = 0;
+    struct sr_nacm_user *nuser;
     int allowed;
 
     /* NACM LOCK */
     pthread_mutex_lock(&nacm.lock);
-
-    if ((err_info = sr_nacm_collect_groups(nacm_user, &groups, &group_count))) {
-        goto cleanup;
-    }
+    sr_nacm_check_start(LYD_CTX(diff));
 
     /* any node can be used in this case */
     if ((err_info = sr_nacm_allowed_tree(diff->schema, nacm_user, &allowed))) {
@@ -2277,7 +3183,11 @@ sr_nacm_check_diff(const char *nacm_user, const struct lyd_node *diff, struct sr
     }
 
     if (!allowed) {
-        if ((err_info = sr_nacm_check_diff_r(diff, nacm_user, NULL, groups, group_count, denied))) {
+        if ((err_info = sr_nacm_user_get(nacm_user, &nuser))) {
+            goto cleanup;
+        }
+
+        if ((err_info = sr_nacm_check_diff_r(diff, nuser, NULL, denied))) {
             goto cleanup;
         }
 
@@ -2287,10 +3197,11 @@ sr_nacm_check_diff(const char *nacm_user, const struct lyd_node *diff, struct sr
     }
 
 cleanup:
+    sr_nacm_check_end();
+
     /* NACM UNLOCK */
     pthread_mutex_unlock(&nacm.lock);
 
-    sr_nacm_free_groups(groups, group_count);
     return err_info;
 }
 
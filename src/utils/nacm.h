@@ -19,10 +19,12 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <time.h>
 
 #include <libyang/libyang.h>
 #include <sysrepo.h>
 
+#include "compat.h"
 #include "config.h"
 
 #define SR_NACM_OP_CREATE 0x01 /**< NACM operation create */
@@ -32,6 +34,9 @@
 #define SR_NACM_OP_EXEC   0x10 /**< NACM operation exec */
 #define SR_NACM_OP_ALL    0x1F /**< All NACM operations */
 
+#define SR_NACM_USER_CACHE_SIZE 32      /**< maximum number of users with cached compiled rules */
+#define SR_NACM_USER_CACHE_TIMEOUT 5    /**< timeout in seconds of cached system groups of a user */
+
 /**
  * @brief Rule target node type.
  */
@@ -42,6 +47,22 @@ typedef enum sr_nacm_target_type {
     SR_NACM_TARGET_ANY     /**< Rule target is any node. */
 } SR_NACM_TARGET_TYPE;
 
+enum sr_nacm_access {
+    SR_NACM_ACCESS_DENY = 1,           /**< access to the node is denied */
+    SR_NACM_ACCESS_PARTIAL_DENY = 2,   /**< access to the node is denied but it is a prefix of a matching rule */
+    SR_NACM_ACCESS_PARTIAL_PERMIT = 3, /**< access to the node is permitted but any children must still be checked */
+    SR_NACM_ACCESS_PERMIT = 4          /**< access to the node is permitted with any children */
+};
+
+/**
+ * @brief NACM read access verdict of all the data instances of a schema subtree.
+ */
+enum sr_nacm_subtree {
+    SR_NACM_SUBTREE_MIXED = 0,  /**< access to the nodes must be checked separately */
+    SR_NACM_SUBTREE_PERMIT,     /**< access to all the nodes is permitted */
+    SR_NACM_SUBTREE_DENY        /**< access to all the nodes is denied */
+};
+
 /**
  * @brief Main NACM container structure.
  */
@@ -57,6 +78,12 @@ struct sr_nacm {
     uint32_t denied_data_writes;    /**< Counter of denied data writes. */
     uint32_t denied_notifications;  /**< Counter of denied notifications. */
 
+    uint64_t checks;                /**< Counter of all the checks. */
+    uint64_t evaluated_nodes;       /**< Counter of nodes evaluated by all the checks. */
+    uint64_t max_check_nodes;       /**< Highest number of nodes evaluated by a single check. */
+    uint64_t evaluation_time;       /**< Time spent in all the checks, in us. */
+    uint64_t max_check_time;        /**< Longest duration of a single check, in us. */
+
     /**
      * @brief NACM group.
      */
@@ -86,20 +113,70 @@ struct sr_nacm {
             uint8_t operations;     /**< Rule operations associated with it. */
             char action_deny;       /**< Whether the rule action is "deny" (otherwise "permit"). */
             char *comment;          /**< Rule comment. */
+            const struct lysc_node *target_snode;  /**< Schema node of the target, valid only for @p target_gen. */
+            uint32_t target_gen;    /**< Check generation @p target_snode was resolved in. */
+            ATOMIC64_T hits;        /**< Counter of nodes the rule was applied to. */
+            ATOMIC64_T path_evals;  /**< Counter of node paths matched against the target. */
             struct sr_nacm_rule *next; /**< Pointer to the next rule. */
         } *rules;                   /**< List of rules in the rule list. */
 
         struct sr_nacm_rule_list *next;    /**< Pointer to the next rule list. */
     } *rule_lists;                  /**< List of all the rule lists. */
 
-    pthread_mutex_t lock;           /**< Lock for accessing all the NACM members. */
-};
+    /**
+     * @brief Compiled NACM rules of a user, valid until the next NACM configuration change.
+     */
+    struct sr_nacm_user {
+        char *name;                 /**< User name. */
+        char **groups;              /**< Sorted all groups of the user. */
+        uint32_t group_count;       /**< Number of groups. */
+        time_t expires;             /**< Time the system groups of the user need to be collected again. */
+        uint32_t check_gen;         /**< Generation of the last check the user was used in. */
 
-enum sr_nacm_access {
-    SR_NACM_ACCESS_DENY = 1,           /**< access to the node is denied */
-    SR_NACM_ACCESS_PARTIAL_DENY = 2,   /**< access to the node is denied but it is a prefix of a matching rule */
-    SR_NACM_ACCESS_PARTIAL_PERMIT = 3, /**< access to the node is permitted but any children must still be checked */
-    SR_NACM_ACCESS_PERMIT = 4          /**< access to the node is permitted with any children */
+        /**
+         * @brief Rules of the user that can match nodes of a module.
+         */
+        struct sr_nacm_mod_rules {
+            char *mod_name;         /**< Module name. */
+            struct sr_nacm_rule **rules;    /**< Rules of the matching rule lists, in the evaluation order. */
+            uint32_t rule_count;    /**< Number of rules. */
+        } *mods;                    /**< Rule buckets of all the modules used so far. */
+        uint32_t mod_count;         /**< Number of modules. */
+        uint32_t last_mod;          /**< Index of the last used module. */
+
+        /**
+         * @brief Read access verdict of a schema subtree.
+         */
+        struct sr_nacm_snode_verdict {
+            const struct lysc_node *snode;  /**< Root schema node of the subtree. */
+            enum sr_nacm_subtree verdict;   /**< Verdict of the subtree. */
+        } *verdicts;                /**< Verdicts sorted by the schema node, valid only for @p verdict_gen. */
+        uint32_t verdict_count;     /**< Number of verdicts. */
+        uint32_t verdict_gen;       /**< Check generation the verdicts were computed in. */
+
+        /**
+         * @brief Access of all the data instances of a schema node for an operation, decided without any rule
+         * with a data path.
+         */
+        struct sr_nacm_snode_access {
+            const struct lysc_node *snode;  /**< Schema node. */
+            uint8_t oper;                   /**< Checked operation. */
+            enum sr_nacm_access access;     /**< Access to the node. */
+            struct sr_nacm_rule *rule;      /**< Matched rule, if any. */
+            struct lysc_ext *def;           /**< Matched NACM extension, if any. */
+        } *accesses;                /**< Accesses sorted by the schema node and operation, valid only for
+                                         @p access_gen. */
+        uint32_t access_count;      /**< Number of accesses. */
+        uint32_t access_gen;        /**< Check generation the accesses were decided in. */
+    } *users;                       /**< Cached compiled rules of recently checked users. */
+    uint32_t user_count;            /**< Number of users. */
+
+    uint32_t check_gen;             /**< Generation of the current check, rule target schema nodes are bound to it. */
+    const struct ly_ctx *check_ctx; /**< Context of the current check. */
+    ATOMIC64_T check_nodes;         /**< Number of nodes evaluated by the current check. */
+    uint64_t check_start;           /**< Start time of the current check, in us. */
+
+    pthread_mutex_t lock;           /**< Lock for accessing all the NACM members. */
 };
 
 /**
@@ -167,6 +244,26 @@ sr_error_info_t *sr_nacm_get_node_set_read_filter(sr_session_ctx_t *session, str
  */
 sr_error_info_t *sr_nacm_get_subtree_read_filter(sr_session_ctx_t *session, struct lyd_node *subtree, int *denied);
 
+/**
+ * @brief Check whether all the data instances of a schema subtree would be filtered out for R access.
+ *
+ * @param[in] nacm_user NACM username to use, nothing is ever denied if NULL.
+ * @param[in] snode Root schema node of the subtree.
+ * @param[out] denied Set if all the data of the subtree are denied.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_nacm_check_schema_read_denied(const char *nacm_user, const struct lysc_node *snode, int *denied);
+
+/**
+ * @brief Check whether all the data of a module would be filtered out for R access.
+ *
+ * @param[in] nacm_user NACM username to use, nothing is ever denied if NULL.
+ * @param[in] ly_mod Module to check.
+ * @param[out] denied Set if all the data of the module are denied.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_nacm_check_module_read_denied(const char *nacm_user, const struct lys_module *ly_mod, int *denied);
+
 /**
  * @brief Check whether the notification is allowed for a user and filter out any edits the user
  * does not have R access to.
@@ -26,6 +26,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/uio.h>
 #include <time.h>
 
@@ -36,15 +38,48 @@
 #include "compat.h"
 #include "log.h"
 #include "ly_wrap.h"
+#include "sn_yang_push.h"
 #include "sysrepo.h"
 
 static struct srsn_state snstate = {
     .sub_lock = PTHREAD_MUTEX_INITIALIZER,
     .dispatch_lock = PTHREAD_MUTEX_INITIALIZER,
+    .epfd = -1,
+    .evfd = -1,
 };
 
 static ATOMIC_T new_sub_id = 1;
 
+/**
+ * @brief Maximum number of epoll events processed by the read dispatch thread at once.
+ */
+#define SRSN_DISPATCH_EPOLL_EVENTS 64
+
+/**
+ * @brief Number of printed notifications kept for sending to other subscriptions.
+ */
+#define SRSN_NTF_LYB_CACHE_SIZE 8
+
+/**
+ * @brief Notification printed once in LYB and shared by all the subscriptions it is sent to.
+ */
+struct srsn_ntf_lyb {
+    const struct lyd_node *notif;   /**< printed notification, used only for identification */
+    struct timespec timestamp;      /**< notification timestamp */
+    char *lyb;                      /**< printed notification */
+    uint32_t size;                  /**< size of @p lyb */
+    uint32_t refcount;              /**< number of users, including the cache */
+};
+
+/**
+ * @brief Cache of recently printed notifications.
+ */
+static struct {
+    pthread_mutex_t lock;           /**< cache lock */
+    struct srsn_ntf_lyb *ntfs[SRSN_NTF_LYB_CACHE_SIZE]; /**< cached notifications, NULL if slot unused */
+    uint32_t next;                  /**< next slot to use */
+} ntf_lyb_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
 void
 srsn_filter_erase(struct srsn_filter *filter)
 {
@@ -710,7 +745,6 @@ srsn_sub_new(const char *xpath_filter, const struct timespec *stop_time, sr_subs
     }
     s->xpath_filter = xpath_filter ? strdup(xpath_filter) : NULL;
     pthread_mutex_init(&s->stop_sntimer.lock, NULL);
-    pthread_cond_init(&s->stop_sntimer.cond, NULL);
     if (stop_time) {
         s->stop_time = *stop_time;
     }
@@ -772,7 +806,6 @@ srsn_sub_free(struct srsn_sub *sub)
         sr_errinfo_new(&err_info, SR_ERR_SYS, "Destroying stop timer lock failed (%s).", strerror(r));
         sr_errinfo_free(&err_info);
     }
-    pthread_cond_destroy(&sub->stop_sntimer.cond);
 
     switch (sub->type) {
     case SRSN_SUB_NOTIF:
@@ -787,17 +820,15 @@ srsn_sub_free(struct srsn_sub *sub)
             sr_errinfo_new(&err_info, SR_ERR_SYS, "Destroying update timer lock failed (%s).", strerror(r));
             sr_errinfo_free(&err_info);
         }
-        pthread_cond_destroy(&sub->update_sntimer.cond);
-        break;
+            break;
     case SRSN_YANG_PUSH_ON_CHANGE:
-        sr_release_data(sub->change_ntf);
+        srsn_yp_ntf_change_free(sub);
         srsn_update_timer(NULL, NULL, &sub->damp_sntimer);
         if ((r = pthread_mutex_destroy(&sub->damp_sntimer.lock))) {
             sr_errinfo_new(&err_info, SR_ERR_SYS, "Destroying dampening timer lock failed (%s).", strerror(r));
             sr_errinfo_free(&err_info);
         }
-        pthread_cond_destroy(&sub->damp_sntimer.cond);
-        break;
+            break;
     }
 
     /* close the pipe as last, poll can be waiting for it to signal the subscription fully terminated */
@@ -857,6 +888,11 @@ srsn_sub_free(struct srsn_sub *sub)
     if (!--snstate.count) {
         free(snstate.subs);
         snstate.subs = NULL;
+
+        /* no yang-push subscriptions can use the processed diffs and snapshots anymore */
+        srsn_yp_diff_cache_flush();
+        srsn_yp_snapshot_cache_flush();
+        srsn_ntf_lyb_cache_flush();
     }
 }
 
@@ -1123,98 +1159,429 @@ srsn_find(uint32_t sub_id, int locked)
     return sub;
 }
 
-sr_error_info_t *
-srsn_ntf_send(struct srsn_sub *sub, const struct timespec *timestamp, const struct lyd_node *ly_ntf)
+/**
+ * @brief Write a printed notification of a subscription into its pipe.
+ *
+ * @param[in] sub Subscription to use.
+ * @param[in] timestamp Notification timestamp.
+ * @param[in] ntf_lyb Notification in LYB.
+ * @param[in] size Size of @p ntf_lyb.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_ntf_write(struct srsn_sub *sub, const struct timespec *timestamp, const char *ntf_lyb, uint32_t size)
 {
     sr_error_info_t *err_info = NULL;
     struct iovec bufs[3];
-    uint32_t size;
-    char *ntf_lyb = NULL;
 
     /* 1) write the timestamp */
     bufs[0].iov_base = (void *)timestamp;
     bufs[0].iov_len = sizeof *timestamp;
 
-    /* get the LYB notification data */
-    if ((err_info = sr_lyd_print_data(ly_ntf, LYD_LYB, 0, -1, &ntf_lyb, &size))) {
-        goto cleanup;
-    }
-
     /* 2) write LYB size */
     bufs[1].iov_base = &size;
     bufs[1].iov_len = sizeof size;
 
     /* 3) write LYB data */
-    bufs[2].iov_base = ntf_lyb;
+    bufs[2].iov_base = (void *)ntf_lyb;
     bufs[2].iov_len = size;
 
     /* atomic vector write */
     if (writev(sub->wfd, bufs, 3) == -1) {
         sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to write a notification (%s).", strerror(errno));
-        goto cleanup;
+        return err_info;
     }
 
     /* increase sent notification count */
     ATOMIC_INC_RELAXED(sub->sent_count);
 
+    return NULL;
+}
+
+sr_error_info_t *
+srsn_ntf_send(struct srsn_sub *sub, const struct timespec *timestamp, const struct lyd_node *ly_ntf)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t size;
+    char *ntf_lyb = NULL;
+
+    /* get the LYB notification data */
+    if ((err_info = sr_lyd_print_data(ly_ntf, LYD_LYB, 0, -1, &ntf_lyb, &size))) {
+        goto cleanup;
+    }
+
+    /* write it */
+    err_info = srsn_ntf_write(sub, timestamp, ntf_lyb, size);
+
 cleanup:
     free(ntf_lyb);
     return err_info;
 }
 
 /**
- * @brief Timer thread function.
+ * @brief Release a printed notification, free it if no longer used. Cache lock is expected to be held.
+ *
+ * @param[in] ntf Printed notification to release.
+ */
+static void
+srsn_ntf_lyb_release_(struct srsn_ntf_lyb *ntf)
+{
+    if (--ntf->refcount) {
+        return;
+    }
+
+    free(ntf->lyb);
+    free(ntf);
+}
+
+/**
+ * @brief Find a printed notification in the cache.
+ *
+ * @param[in] notif Notification to find.
+ * @param[in] timestamp Notification timestamp.
+ * @return Found printed notification with a new reference, NULL if not found.
+ */
+static struct srsn_ntf_lyb *
+srsn_ntf_lyb_find(const struct lyd_node *notif, const struct timespec *timestamp)
+{
+    struct srsn_ntf_lyb *ntf;
+    uint32_t i;
+
+    for (i = 0; i < SRSN_NTF_LYB_CACHE_SIZE; ++i) {
+        ntf = ntf_lyb_cache.ntfs[i];
+        if (ntf && (ntf->notif == notif) && !sr_time_cmp(&ntf->timestamp, timestamp)) {
+            ++ntf->refcount;
+            return ntf;
+        }
+    }
+
+    return NULL;
+}
+
+sr_error_info_t *
+srsn_ntf_send_shared(struct srsn_sub *sub, const struct timespec *timestamp, const struct lyd_node *ly_ntf)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srsn_ntf_lyb *ntf, *ntf2;
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&ntf_lyb_cache.lock);
+
+    ntf = srsn_ntf_lyb_find(ly_ntf, timestamp);
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&ntf_lyb_cache.lock);
+
+    if (!ntf) {
+        /* print the notification, without holding the lock */
+        ntf = calloc(1, sizeof *ntf);
+        SR_CHECK_MEM_RET(!ntf, err_info);
+        ntf->notif = ly_ntf;
+        ntf->timestamp = *timestamp;
+        if ((err_info = sr_lyd_print_data(ly_ntf, LYD_LYB, 0, -1, &ntf->lyb, &ntf->size))) {
+            free(ntf);
+            return err_info;
+        }
+
+        /* CACHE LOCK */
+        pthread_mutex_lock(&ntf_lyb_cache.lock);
+
+        if ((ntf2 = srsn_ntf_lyb_find(ly_ntf, timestamp))) {
+            /* printed by another thread meanwhile */
+            free(ntf->lyb);
+            free(ntf);
+            ntf = ntf2;
+        } else {
+            /* one reference for the cache and one for us */
+            ntf->refcount = 2;
+            if (ntf_lyb_cache.ntfs[ntf_lyb_cache.next]) {
+                srsn_ntf_lyb_release_(ntf_lyb_cache.ntfs[ntf_lyb_cache.next]);
+            }
+            ntf_lyb_cache.ntfs[ntf_lyb_cache.next] = ntf;
+            ntf_lyb_cache.next = (ntf_lyb_cache.next + 1) % SRSN_NTF_LYB_CACHE_SIZE;
+        }
+
+        /* CACHE UNLOCK */
+        pthread_mutex_unlock(&ntf_lyb_cache.lock);
+    }
+
+    /* write the shared buffer */
+    err_info = srsn_ntf_write(sub, timestamp, ntf->lyb, ntf->size);
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&ntf_lyb_cache.lock);
+
+    srsn_ntf_lyb_release_(ntf);
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&ntf_lyb_cache.lock);
+
+    return err_info;
+}
+
+void
+srsn_ntf_lyb_cache_flush(void)
+{
+    uint32_t i;
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&ntf_lyb_cache.lock);
+
+    for (i = 0; i < SRSN_NTF_LYB_CACHE_SIZE; ++i) {
+        if (ntf_lyb_cache.ntfs[i]) {
+            srsn_ntf_lyb_release_(ntf_lyb_cache.ntfs[i]);
+            ntf_lyb_cache.ntfs[i] = NULL;
+        }
+    }
+    ntf_lyb_cache.next = 0;
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&ntf_lyb_cache.lock);
+}
+
+/**
+ * @brief Shared scheduler of all the SRSN timers, a min-heap of the timers ordered by their trigger processed
+ * by a few threads.
+ */
+static struct {
+    pthread_mutex_t lock;           /**< scheduler lock, protects also the scheduling members of all the timers */
+    pthread_cond_t cond;            /**< signaled when the first trigger changes */
+    pthread_cond_t done_cond;       /**< broadcasted when a timer callback finishes */
+    struct srsn_timer **heap;       /**< min-heap of scheduled timers */
+    uint32_t count;                 /**< count of scheduled timers */
+    uint32_t size;                  /**< allocated size of the heap */
+    uint32_t thread_count;          /**< count of running scheduler threads */
+} sntimers = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *srsn_timer_thread(void *arg);
+
+/**
+ * @brief Swap 2 timers in the scheduler heap.
+ *
+ * @param[in] i Index of the first timer.
+ * @param[in] j Index of the second timer.
+ */
+static void
+srsn_timer_heap_swap(uint32_t i, uint32_t j)
+{
+    struct srsn_timer *tmp;
+
+    tmp = sntimers.heap[i];
+    sntimers.heap[i] = sntimers.heap[j];
+    sntimers.heap[j] = tmp;
+
+    sntimers.heap[i]->heap_pos = i + 1;
+    sntimers.heap[j]->heap_pos = j + 1;
+}
+
+/**
+ * @brief Restore the scheduler heap property after a timer trigger changed.
+ *
+ * @param[in] i Index of the changed timer.
+ */
+static void
+srsn_timer_heap_fix(uint32_t i)
+{
+    uint32_t parent, child;
+
+    /* move up */
+    while (i) {
+        parent = (i - 1) / 2;
+        if (sr_time_cmp(&sntimers.heap[parent]->trigger, &sntimers.heap[i]->trigger) <= 0) {
+            break;
+        }
+        srsn_timer_heap_swap(i, parent);
+        i = parent;
+    }
+
+    /* move down */
+    while ((child = 2 * i + 1) < sntimers.count) {
+        if ((child + 1 < sntimers.count) &&
+                (sr_time_cmp(&sntimers.heap[child + 1]->trigger, &sntimers.heap[child]->trigger) < 0)) {
+            ++child;
+        }
+        if (sr_time_cmp(&sntimers.heap[i]->trigger, &sntimers.heap[child]->trigger) <= 0) {
+            break;
+        }
+        srsn_timer_heap_swap(i, child);
+        i = child;
+    }
+}
+
+/**
+ * @brief Remove a timer from the scheduler heap, if scheduled. Scheduler lock is expected to be held.
+ *
+ * @param[in] sntimer Timer to remove.
+ */
+static void
+srsn_timer_heap_remove(struct srsn_timer *sntimer)
+{
+    uint32_t i;
+
+    if (!sntimer->heap_pos) {
+        return;
+    }
+
+    i = sntimer->heap_pos - 1;
+    sntimer->heap_pos = 0;
+    --sntimers.count;
+    if (i < sntimers.count) {
+        /* move the last timer in its place */
+        sntimers.heap[i] = sntimers.heap[sntimers.count];
+        sntimers.heap[i]->heap_pos = i + 1;
+        srsn_timer_heap_fix(i);
+    }
+}
+
+/**
+ * @brief Schedule a timer in the scheduler heap and make sure there is a thread to process it. Scheduler lock
+ * is expected to be held.
+ *
+ * @param[in] sntimer Timer to schedule.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_timer_heap_insert(struct srsn_timer *sntimer)
+{
+    sr_error_info_t *err_info = NULL;
+    pthread_t tid;
+    void *mem;
+    int r;
+
+    assert(!sntimer->heap_pos);
+
+    if (sntimers.count == sntimers.size) {
+        /* enlarge the heap */
+        mem = realloc(sntimers.heap, (sntimers.size ? sntimers.size * 2 : 8) * sizeof *sntimers.heap);
+        SR_CHECK_MEM_RET(!mem, err_info);
+        sntimers.heap = mem;
+        sntimers.size = sntimers.size ? sntimers.size * 2 : 8;
+    }
+
+    /* add the timer */
+    sntimers.heap[sntimers.count] = sntimer;
+    sntimer->heap_pos = ++sntimers.count;
+    srsn_timer_heap_fix(sntimers.count - 1);
+
+    if ((sntimers.thread_count < SR_SN_TIMER_THREADS) && (sntimers.thread_count < sntimers.count)) {
+        /* start another scheduler thread */
+        if ((r = pthread_create(&tid, NULL, srsn_timer_thread, NULL))) {
+            if (!sntimers.thread_count) {
+                srsn_timer_heap_remove(sntimer);
+                sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to create a thread (%s).", strerror(r));
+                return err_info;
+            }
+
+            /* the running threads will process it */
+        } else {
+            pthread_detach(tid);
+            ++sntimers.thread_count;
+        }
+    }
+
+    /* the first trigger may have changed */
+    pthread_cond_broadcast(&sntimers.cond);
+
+    return NULL;
+}
+
+/**
+ * @brief Timer scheduler thread function, terminates once there are no scheduled timers.
  */
 static void *
-srsn_timer_thread(void *arg)
+srsn_timer_thread(void *UNUSED(arg))
 {
-    struct srsn_timer *sntimer = arg;
-    struct timespec trigger;
-    int r, freed = 0;
+    sr_error_info_t *err_info = NULL;
+    struct srsn_timer *sntimer;
+    struct timespec trigger, cur_ts;
     uint32_t interval_ms;
+    int run, freed;
 
-    /* TIMER LOCK */
-    pthread_mutex_lock(&sntimer->lock);
+    /* SCHED LOCK */
+    pthread_mutex_lock(&sntimers.lock);
 
-wait:
-    do {
-        /* wait until the trigger, allow its modification from another thread */
-        trigger = sntimer->trigger;
+    while (sntimers.count) {
+        sntimer = sntimers.heap[0];
+        sr_realtime_get(&cur_ts);
+        if (sr_time_cmp(&sntimer->trigger, &cur_ts) > 0) {
+            /* wait until the first trigger, allow its modification from another thread */
+            trigger = sntimer->trigger;
 
-        /* TIMER COND WAIT */
-        r = pthread_cond_clockwait(&sntimer->cond, &sntimer->lock, CLOCK_REALTIME, &trigger);
+            /* SCHED COND WAIT */
+            pthread_cond_clockwait(&sntimers.cond, &sntimers.lock, CLOCK_REALTIME, &trigger);
+            continue;
+        }
 
-        if (!sntimer->tid) {
-            /* we should terminate */
-            goto cleanup;
+        /* the timer is due, it cannot be freed until its callback finishes */
+        srsn_timer_heap_remove(sntimer);
+        sntimer->cb_tid = pthread_self();
+
+        /* SCHED UNLOCK */
+        pthread_mutex_unlock(&sntimers.lock);
+
+        /* TIMER LOCK */
+        pthread_mutex_lock(&sntimer->lock);
+
+        /* SCHED LOCK */
+        pthread_mutex_lock(&sntimers.lock);
+
+        if (!sntimer->active || sntimer->heap_pos) {
+            /* stopped or rescheduled meanwhile */
+            run = 0;
+        } else {
+            run = 1;
+            if (sntimer->interval.tv_sec || sntimer->interval.tv_nsec) {
+                /* schedule the next trigger ahead of the callback */
+                interval_ms = sntimer->interval.tv_sec * 1000;
+                interval_ms += sntimer->interval.tv_nsec / 1000000;
+                sntimer->trigger = sr_time_ts_add(&sntimer->trigger, interval_ms);
+                if ((err_info = srsn_timer_heap_insert(sntimer))) {
+                    /* the timer cannot be scheduled again */
+                    sr_errinfo_free(&err_info);
+                    sntimer->active = 0;
+                }
+            } else {
+                /* one-shot timer is finished */
+                sntimer->active = 0;
+            }
         }
-    } while (!r);
-    assert(r == ETIMEDOUT);
 
-    /* prepare the next trigger ahead of the callback */
-    if (sntimer->interval.tv_sec || sntimer->interval.tv_nsec) {
-        interval_ms = sntimer->interval.tv_sec * 1000;
-        interval_ms += sntimer->interval.tv_nsec / 1000000;
+        /* SCHED UNLOCK */
+        pthread_mutex_unlock(&sntimers.lock);
 
-        /* add the interval */
-        sntimer->trigger = sr_time_ts_add(&sntimer->trigger, interval_ms);
-    }
+        /* call the callback */
+        freed = 0;
+        if (run) {
+            sntimer->cb(sntimer->arg, &freed);
+        }
+        if (!freed) {
+            /* TIMER UNLOCK */
+            pthread_mutex_unlock(&sntimer->lock);
+        }
 
-    /* call the callback */
-    sntimer->cb(sntimer->arg, &freed);
-    if (freed) {
-        /* special case when the timer was unlocked and freed */
-        return NULL;
+        /* SCHED LOCK */
+        pthread_mutex_lock(&sntimers.lock);
+
+        if (!freed) {
+            /* a freed timer (unlocked by its callback) cannot have anyone waiting for it */
+            sntimer->cb_tid = 0;
+        }
+        pthread_cond_broadcast(&sntimers.done_cond);
     }
 
-    if (sntimer->interval.tv_sec || sntimer->interval.tv_nsec) {
-        /* wait until the next trigger */
-        goto wait;
+    /* no timers left, terminate */
+    if (!--sntimers.thread_count) {
+        free(sntimers.heap);
+        sntimers.heap = NULL;
+        sntimers.size = 0;
     }
 
-cleanup:
-    /* TIMER UNLOCK */
-    pthread_mutex_unlock(&sntimer->lock);
+    /* SCHED UNLOCK */
+    pthread_mutex_unlock(&sntimers.lock);
 
     return NULL;
 }
@@ -1224,49 +1591,53 @@ srsn_create_timer(void (*cb)(void *arg, int *freed), void *arg, const struct tim
         const struct timespec *interval, struct srsn_timer *sntimer)
 {
     sr_error_info_t *err_info = NULL;
-    int r;
 
-    /* prepare argument */
+    /* SCHED LOCK */
+    pthread_mutex_lock(&sntimers.lock);
+
+    assert(!sntimer->active);
+
+    /* prepare the timer */
     sntimer->cb = cb;
     sntimer->arg = arg;
     sntimer->trigger = *trigger;
     if (interval) {
         sntimer->interval = *interval;
+    } else {
+        sntimer->interval.tv_sec = 0;
+        sntimer->interval.tv_nsec = 0;
     }
 
-    /* create the timer thread */
-    if ((r = pthread_create(&sntimer->tid, NULL, srsn_timer_thread, sntimer))) {
-        sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to create a thread (%s).", strerror(r));
-        return err_info;
+    /* schedule it, may have been popped by a scheduler thread waiting for its lock */
+    if (!sntimer->heap_pos && (err_info = srsn_timer_heap_insert(sntimer))) {
+        goto cleanup;
     }
+    sntimer->active = 1;
 
-    return NULL;
+cleanup:
+    /* SCHED UNLOCK */
+    pthread_mutex_unlock(&sntimers.lock);
+    return err_info;
 }
 
 void
 srsn_update_timer(const struct timespec *trigger, const struct timespec *interval, struct srsn_timer *sntimer)
 {
     sr_error_info_t *err_info = NULL;
-    pthread_t tid = 0;
-    int r;
 
     /* TIMER LOCK */
     pthread_mutex_lock(&sntimer->lock);
 
+    /* SCHED LOCK */
+    pthread_mutex_lock(&sntimers.lock);
+
     /* timer must exist if it is not just a cleanup */
-    assert(!trigger || sntimer->tid);
+    assert(!trigger || sntimer->active);
 
     if (!trigger) {
-        if (sntimer->tid) {
-            /* stop the timer, thread will terminate on its own */
-            if (pthread_self() == sntimer->tid) {
-                /* use detach because this is the timer thread itself */
-                pthread_detach(sntimer->tid);
-            } else {
-                tid = sntimer->tid;
-            }
-            sntimer->tid = 0;
-        }
+        /* stop the timer */
+        sntimer->active = 0;
+        srsn_timer_heap_remove(sntimer);
     } else {
         /* update trigger and/or interval */
         sntimer->trigger = *trigger;
@@ -1276,21 +1647,30 @@ srsn_update_timer(const struct timespec *trigger, const struct timespec *interva
             sntimer->interval.tv_sec = 0;
             sntimer->interval.tv_nsec = 0;
         }
-    }
 
-    /* COND SIGNAL */
-    pthread_cond_signal(&sntimer->cond);
+        /* reschedule */
+        if (sntimer->heap_pos) {
+            srsn_timer_heap_fix(sntimer->heap_pos - 1);
+            pthread_cond_broadcast(&sntimers.cond);
+        } else if ((err_info = srsn_timer_heap_insert(sntimer))) {
+            sntimer->active = 0;
+            sr_errinfo_free(&err_info);
+        }
+    }
 
     /* TIMER UNLOCK */
     pthread_mutex_unlock(&sntimer->lock);
 
-    if (tid) {
-        /* wait until the thread finishes */
-        if ((r = pthread_join(tid, NULL))) {
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Failed to join a thread (%s).", strerror(r));
-            sr_errinfo_free(&err_info);
+    if (!trigger) {
+        /* wait until the callback finishes, unless called from the callback itself */
+        while (sntimer->cb_tid && !pthread_equal(sntimer->cb_tid, pthread_self())) {
+            /* SCHED COND WAIT */
+            pthread_cond_wait(&sntimers.done_cond, &sntimers.lock);
         }
     }
+
+    /* SCHED UNLOCK */
+    pthread_mutex_unlock(&sntimers.lock);
 }
 
 sr_error_info_t *
@@ -1424,6 +1804,26 @@ srsn_ntf_add_dup(const struct lyd_node *notif, const struct timespec *timestamp,
     ++(*ntf_count);
 }
 
+/**
+ * @brief Send a notification received from sysrepo for a subscription. The same notification is delivered
+ * to all the subscriptions of a stream so it is printed only once for all of them.
+ *
+ * @param[in] sub Subscription to use.
+ * @param[in] timestamp Notification timestamp.
+ * @param[in] notif Top-level notification node.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_ntf_send_notif(struct srsn_sub *sub, const struct timespec *timestamp, const struct lyd_node *notif)
+{
+    if (!strcmp(notif->schema->module->name, "ietf-yang-push") && !strcmp(LYD_NAME(notif), "push-change-update")) {
+        /* may be a NACM-filtered duplicate specific for a single subscriber */
+        return srsn_ntf_send(sub, timestamp, notif);
+    }
+
+    return srsn_ntf_send_shared(sub, timestamp, notif);
+}
+
 /**
  * @brief New notification callback used for notifications received on subscription made by \<notif-subscribe\> RPC.
  */
@@ -1485,7 +1885,7 @@ srsn_sn_rpc_subscribe_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), con
             srsn_ntf_add_dup(notif, timestamp, &sub->rt_notifs, &sub->rt_notif_count);
         } else {
             /* send the realtime notification */
-            if ((err_info = srsn_ntf_send(sub, timestamp, notif))) {
+            if ((err_info = srsn_ntf_send_notif(sub, timestamp, notif))) {
                 sr_errinfo_free(&err_info);
             }
         }
@@ -1494,7 +1894,7 @@ srsn_sn_rpc_subscribe_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), con
         assert(notif);
 
         /* send the replayed notification */
-        if ((err_info = srsn_ntf_send(sub, timestamp, notif))) {
+        if ((err_info = srsn_ntf_send_notif(sub, timestamp, notif))) {
             sr_errinfo_free(&err_info);
         }
         break;
@@ -1519,7 +1919,8 @@ srsn_sn_sr_subscribe(sr_session_ctx_t *sess, struct srsn_sub *sub, int sub_no_th
     const sr_error_info_t *tmp_err;
     const struct ly_ctx *ly_ctx;
     const struct lys_module *ly_mod;
-    int rc = SR_ERR_OK, enabled;
+    int rc = SR_ERR_OK, enabled, suspended = 0;
+    uint32_t opts;
     struct timespec ts;
     struct ly_set *mod_set = NULL;
     uint32_t idx;
@@ -1541,6 +1942,18 @@ srsn_sn_sr_subscribe(sr_session_ctx_t *sess, struct srsn_sub *sub, int sub_no_th
     sub->sr_sub_id_count = mod_set->count;
     sub->replay_complete_count = sub->start_time.tv_sec ? 0 : mod_set->count;
 
+    opts = sub_no_thread ? SR_SUBSCR_NO_THREAD : 0;
+    if (sub->start_time.tv_sec && !sub_no_thread) {
+        /* keep the handler thread suspended until all the modules are subscribed so that their replay is performed
+         * at once and the notifications are merged in the timestamp order */
+        if (!sub->sr_sub) {
+            opts |= SR_SUBSCR_THREAD_SUSPEND;
+            suspended = 1;
+        } else if (!sr_subscription_thread_suspend(sub->sr_sub)) {
+            suspended = 1;
+        }
+    }
+
     for (idx = 0; idx < mod_set->count; ++idx) {
         ly_mod = mod_set->objs[idx];
 
@@ -1556,8 +1969,8 @@ srsn_sn_sr_subscribe(sr_session_ctx_t *sess, struct srsn_sub *sub, int sub_no_th
 
         /* subscribe to the module */
         if ((rc = sr_notif_subscribe_tree(sess, ly_mod->name, sub->xpath_filter,
-                sub->start_time.tv_sec ? &sub->start_time : NULL, NULL, srsn_sn_rpc_subscribe_cb, sub,
-                sub_no_thread ? SR_SUBSCR_NO_THREAD : 0, &sub->sr_sub))) {
+                sub->start_time.tv_sec ? &sub->start_time : NULL, NULL, srsn_sn_rpc_subscribe_cb, sub, opts,
+                &sub->sr_sub))) {
             sr_session_get_error(sess, &tmp_err);
             sr_errinfo_new(&err_info, tmp_err->err[0].err_code, "%s", tmp_err->err[0].message);
             goto error;
@@ -1565,6 +1978,9 @@ srsn_sn_sr_subscribe(sr_session_ctx_t *sess, struct srsn_sub *sub, int sub_no_th
 
         /* add new sub ID */
         sub->sr_sub_ids[idx] = sr_subscription_get_last_sub_id(sub->sr_sub);
+
+        /* the thread is already suspended */
+        opts &= ~SR_SUBSCR_THREAD_SUSPEND;
     }
 
     if (sub->start_time.tv_sec && (sr_time_cmp(replay_start, &sub->start_time) <= 0)) {
@@ -1586,6 +2002,10 @@ error:
     sub->sr_sub_id_count = 0;
 
 cleanup:
+    if (suspended && sub->sr_sub) {
+        /* perform the replay of all the modules */
+        sr_subscription_thread_resume(sub->sr_sub);
+    }
     sr_session_release_context(sess);
     ly_set_free(mod_set, NULL);
     return err_info;
@@ -1612,6 +2032,35 @@ srsn_dispatch_init(sr_conn_ctx_t *conn, srsn_notif_cb cb)
     return NULL;
 }
 
+/**
+ * @brief Remove a sub-ntf FD from the dispatch and close it. Dispatch lock is expected to be held.
+ *
+ * @param[in] dfd Dispatched FD to remove.
+ */
+static void
+srsn_dispatch_fd_del(struct srsn_dispatch_fd *dfd)
+{
+    uint32_t i;
+
+    /* stop watching and close it */
+    epoll_ctl(snstate.epfd, EPOLL_CTL_DEL, dfd->fd, NULL);
+    close(dfd->fd);
+
+    /* remove it from the array */
+    for (i = 0; i < snstate.dfd_count; ++i) {
+        if (snstate.dfds[i] == dfd) {
+            break;
+        }
+    }
+    assert(i < snstate.dfd_count);
+    if (i < snstate.dfd_count - 1) {
+        snstate.dfds[i] = snstate.dfds[snstate.dfd_count - 1];
+    }
+    --snstate.dfd_count;
+
+    free(dfd);
+}
+
 /**
  * @brief Thread reading notifications from subscriptions.
  */
@@ -1619,44 +2068,54 @@ static void *
 srsn_read_dispatch_thread(void *UNUSED(arg))
 {
     sr_error_info_t *err_info = NULL;
+    struct epoll_event events[SRSN_DISPATCH_EPOLL_EVENTS];
+    struct srsn_dispatch_fd *dfd;
     const struct ly_ctx *ly_ctx;
     struct timespec ts;
     struct lyd_node *notif;
-    uint32_t i;
-    int r, locked = 0;
-
-    /* DISPATCH LOCK */
-    if ((r = pthread_mutex_lock(&snstate.dispatch_lock))) {
-        sr_errinfo_new(&err_info, SR_ERR_SYS, "Locking failed (%s: %s).", __func__, strerror(r));
-        goto cleanup;
-    }
-    locked = 1;
+    uint64_t val;
+    int i, n, r, locked = 0;
+
+    while (1) {
+        /* wait for notifications or a wake up without holding the lock, new FDs are being watched immediately */
+        n = epoll_wait(snstate.epfd, events, SRSN_DISPATCH_EPOLL_EVENTS, -1);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Epoll wait failed (%s).", strerror(errno));
+            goto cleanup;
+        }
 
-    while (snstate.tid) {
-        /* poll */
-        if (snstate.valid_pfds) {
-            r = poll(snstate.pfds, snstate.pfd_count, 10);
-        } else {
-            r = 0;
+        /* DISPATCH LOCK */
+        if ((r = pthread_mutex_lock(&snstate.dispatch_lock))) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, "Locking failed (%s: %s).", __func__, strerror(r));
+            goto cleanup;
         }
-        if (r == -1) {
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Poll failed (%s).", strerror(errno));
+        locked = 1;
+
+        if (!snstate.tid) {
+            /* we should terminate */
             goto cleanup;
         }
 
-        for (i = 0; r; ++i) {
-            if (!snstate.pfds[i].revents) {
-                /* no event */
+        for (i = 0; i < n; ++i) {
+            dfd = events[i].data.ptr;
+            if (!dfd) {
+                /* wake up event, just consume it */
+                if (read(snstate.evfd, &val, sizeof val) == -1) {
+                    /* nothing to consume */
+                }
                 continue;
             }
 
-            if (snstate.pfds[i].revents & POLLIN) {
+            if (events[i].events & EPOLLIN) {
                 /* lock the context */
                 ly_ctx = sr_acquire_context(snstate.conn);
 
                 /* read all notifs and call the callback */
-                while (!srsn_read_notif(snstate.pfds[i].fd, ly_ctx, &ts, &notif)) {
-                    snstate.cb(notif, &ts, snstate.cb_data[i]);
+                while (!srsn_read_notif(dfd->fd, ly_ctx, &ts, &notif)) {
+                    snstate.cb(notif, &ts, dfd->cb_data);
                     lyd_free_tree(notif);
                 }
 
@@ -1664,30 +2123,15 @@ srsn_read_dispatch_thread(void *UNUSED(arg))
                 sr_release_context(snstate.conn);
             }
 
-            if (snstate.pfds[i].revents & POLLHUP) {
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
                 /* subscription terminated */
-                close(snstate.pfds[i].fd);
-                snstate.pfds[i].fd = -1;
-                --snstate.valid_pfds;
+                srsn_dispatch_fd_del(dfd);
             }
-
-            /* processed */
-            --r;
         }
 
         /* DISPATCH UNLOCK */
         pthread_mutex_unlock(&snstate.dispatch_lock);
         locked = 0;
-
-        /* sleep, to yield the lock */
-        sr_msleep(10);
-
-        /* DISPATCH LOCK */
-        if ((r = pthread_mutex_lock(&snstate.dispatch_lock))) {
-            sr_errinfo_new(&err_info, SR_ERR_SYS, "Locking failed (%s: %s).", __func__, strerror(r));
-            goto cleanup;
-        }
-        locked = 1;
     }
 
 cleanup:
@@ -1700,11 +2144,55 @@ cleanup:
     return NULL;
 }
 
+/**
+ * @brief Create the epoll FD with the wake up event FD. Dispatch lock is expected to be held.
+ *
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_dispatch_epoll_create(void)
+{
+    sr_error_info_t *err_info = NULL;
+    struct epoll_event ev = {0};
+
+    if ((snstate.epfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Creating epoll FD failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+    if ((snstate.evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Creating event FD failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+    /* watch the wake up event, identified by no data */
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(snstate.epfd, EPOLL_CTL_ADD, snstate.evfd, &ev) == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Adding an epoll FD failed (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+cleanup:
+    if (err_info) {
+        if (snstate.evfd > -1) {
+            close(snstate.evfd);
+            snstate.evfd = -1;
+        }
+        if (snstate.epfd > -1) {
+            close(snstate.epfd);
+            snstate.epfd = -1;
+        }
+    }
+    return err_info;
+}
+
 sr_error_info_t *
 srsn_dispatch_add(int fd, void *cb_data)
 {
     sr_error_info_t *err_info = NULL;
-    uint32_t i;
+    struct srsn_dispatch_fd *dfd = NULL;
+    struct epoll_event ev = {0};
     void *mem;
     int r;
 
@@ -1725,36 +2213,31 @@ srsn_dispatch_add(int fd, void *cb_data)
         goto cleanup;
     }
 
-    if (snstate.valid_pfds < snstate.pfd_count) {
-        /* move the invalid PFDs and their cb_data, keep the order */
-        i = 0;
-        while (i < snstate.pfd_count) {
-            if (snstate.pfds[i].fd == -1) {
-                memmove(&snstate.pfds[i], &snstate.pfds[i + 1], (snstate.pfd_count - (i + 1)) * sizeof *snstate.pfds);
-                memmove(&snstate.cb_data[i], &snstate.cb_data[i + 1], (snstate.pfd_count - (i + 1)) * sizeof *snstate.cb_data);
-
-                --snstate.pfd_count;
-            } else {
-                ++i;
-            }
-        }
+    if ((snstate.epfd == -1) && (err_info = srsn_dispatch_epoll_create())) {
+        goto cleanup;
     }
 
-    /* realloc arrays */
-    mem = realloc(snstate.pfds, (snstate.valid_pfds + 1) * sizeof *snstate.pfds);
-    SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
-    snstate.pfds = mem;
-    mem = realloc(snstate.cb_data, (snstate.valid_pfds + 1) * sizeof *snstate.cb_data);
+    /* realloc array */
+    mem = realloc(snstate.dfds, (snstate.dfd_count + 1) * sizeof *snstate.dfds);
     SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
-    snstate.cb_data = mem;
-
-    /* add the new items */
-    snstate.pfds[snstate.valid_pfds].fd = fd;
-    snstate.pfds[snstate.valid_pfds].events = POLLIN;
-    snstate.cb_data[snstate.valid_pfds] = cb_data;
-
-    ++snstate.valid_pfds;
-    snstate.pfd_count = snstate.valid_pfds;
+    snstate.dfds = mem;
+
+    /* create the new item */
+    dfd = malloc(sizeof *dfd);
+    SR_CHECK_MEM_GOTO(!dfd, err_info, cleanup);
+    dfd->fd = fd;
+    dfd->cb_data = cb_data;
+
+    /* watch it, even a waiting dispatch thread notices it immediately */
+    ev.events = EPOLLIN;
+    ev.data.ptr = dfd;
+    if (epoll_ctl(snstate.epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Adding an epoll FD failed (%s).", strerror(errno));
+        free(dfd);
+        goto cleanup;
+    }
+    snstate.dfds[snstate.dfd_count] = dfd;
+    ++snstate.dfd_count;
 
     if (!snstate.tid) {
         /* create the thread */
@@ -1784,7 +2267,7 @@ srsn_dispatch_count(void)
         goto cleanup;
     }
 
-    count = snstate.valid_pfds;
+    count = snstate.dfd_count;
 
     /* DISPATCH UNLOCK */
     pthread_mutex_unlock(&snstate.dispatch_lock);
@@ -1799,6 +2282,7 @@ srsn_dispatch_destroy(void)
 {
     sr_error_info_t *err_info = NULL;
     pthread_t tid;
+    uint64_t val = 1;
     uint32_t i;
     int r;
 
@@ -1811,6 +2295,12 @@ srsn_dispatch_destroy(void)
     tid = snstate.tid;
     snstate.tid = 0;
 
+    /* wake up the thread */
+    if (tid && (write(snstate.evfd, &val, sizeof val) == -1)) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, "Waking up the dispatch thread failed (%s).", strerror(errno));
+        sr_errinfo_free(&err_info);
+    }
+
     /* DISPATCH UNLOCK */
     pthread_mutex_unlock(&snstate.dispatch_lock);
 
@@ -1827,17 +2317,21 @@ srsn_dispatch_destroy(void)
     }
 
     /* free vars */
-    for (i = 0; i < snstate.pfd_count; ++i) {
-        if (snstate.pfds[i].fd > -1) {
-            close(snstate.pfds[i].fd);
-        }
+    for (i = 0; i < snstate.dfd_count; ++i) {
+        close(snstate.dfds[i]->fd);
+        free(snstate.dfds[i]);
+    }
+    free(snstate.dfds);
+    snstate.dfds = NULL;
+    snstate.dfd_count = 0;
+    if (snstate.evfd > -1) {
+        close(snstate.evfd);
+        snstate.evfd = -1;
+    }
+    if (snstate.epfd > -1) {
+        close(snstate.epfd);
+        snstate.epfd = -1;
     }
-    free(snstate.pfds);
-    snstate.pfds = NULL;
-    free(snstate.cb_data);
-    snstate.cb_data = NULL;
-    snstate.pfd_count = 0;
-    snstate.valid_pfds = 0;
 
     /* DISPATCH UNLOCK */
     pthread_mutex_unlock(&snstate.dispatch_lock);
@@ -46,13 +46,15 @@ struct srsn_filter {
  * @brief Internal timer structure.
  */
 struct srsn_timer {
-    pthread_mutex_t lock;
-    pthread_cond_t cond;
-    pthread_t tid;
+    pthread_mutex_t lock;   /**< held while the callback is being called */
     void (*cb)(void *arg, int *freed);
     void *arg;
     struct timespec trigger;
     struct timespec interval;
+
+    int active;             /**< whether the timer is scheduled */
+    uint32_t heap_pos;      /**< position in the shared scheduler heap plus one, 0 if not in the heap */
+    pthread_t cb_tid;       /**< thread calling the callback, 0 if none */
 };
 
 /**
@@ -115,6 +117,7 @@ struct srsn_state {
                 int excluded_changes[SRSN_COUNT_YP_CHANGE];
 
                 sr_data_t *change_ntf;
+                struct ly_ht *edit_ht;          /* latest edit of every target in change_ntf */
                 uint32_t patch_id;
                 uint32_t edit_id;
                 struct timespec last_notif;
@@ -130,10 +133,13 @@ struct srsn_state {
     pthread_t tid;          /**< set only if the dispatch thread is running */
     sr_conn_ctx_t *conn;
     srsn_notif_cb cb;
-    struct pollfd *pfds;    /**< array of sub-ntf FDs to read notifications from */
-    void **cb_data;         /**< array connected with pfds providing cb_data for each sub-ntf */
-    uint32_t pfd_count;
-    uint32_t valid_pfds;    /**< count of current valid (fd > -1) pfd items */
+    int epfd;               /**< epoll FD watching all the sub-ntf FDs, -1 if not created */
+    int evfd;               /**< event FD for waking up the dispatch thread, -1 if not created */
+    struct srsn_dispatch_fd {
+        int fd;             /**< sub-ntf FD to read notifications from */
+        void *cb_data;      /**< cb_data for the sub-ntf */
+    } **dfds;               /**< array of all the dispatched sub-ntf FDs */
+    uint32_t dfd_count;
 };
 
 /**
@@ -270,7 +276,24 @@ struct srsn_sub *srsn_find(uint32_t sub_id, int locked);
 sr_error_info_t *srsn_ntf_send(struct srsn_sub *sub, const struct timespec *timestamp, const struct lyd_node *ly_ntf);
 
 /**
- * @brief Create a new SRSN timer.
+ * @brief Send a notification for a subscription, printing the same notification (identified by the node and
+ * timestamp) only once for all the subscriptions it is sent to.
+ *
+ * @param[in] sub Subscription to use.
+ * @param[in] timestamp Notification timestamp.
+ * @param[in] ly_ntf Notification data tree, must not be modified for other subscriptions.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *srsn_ntf_send_shared(struct srsn_sub *sub, const struct timespec *timestamp,
+        const struct lyd_node *ly_ntf);
+
+/**
+ * @brief Free all the notifications printed for sending to subscriptions.
+ */
+void srsn_ntf_lyb_cache_flush(void);
+
+/**
+ * @brief Create a new SRSN timer. All the timers are processed by a few shared scheduler threads.
  *
  * @param[in] cb Callback to call on a trigger.
  * @param[in] arg Argument to pass @p cb.
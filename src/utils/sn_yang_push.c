@@ -20,6 +20,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -42,27 +43,264 @@ srsn_yp_reset_patch_id(struct srsn_sub *sub)
     sub->patch_id = 1;
 }
 
-sr_error_info_t *
-srsn_yp_ntf_update_send(struct srsn_sub *sub)
+/**
+ * @brief Number of periodic yang-push snapshots kept for subscriptions with coinciding updates.
+ */
+#define SRSN_YP_SNAPSHOT_CACHE_SIZE 16
+
+/**
+ * @brief Retrieved data of a periodic yang-push update, shared by all the subscriptions with the same filter
+ * whose updates coincide.
+ */
+struct srsn_yp_snapshot {
+    sr_conn_ctx_t *conn;        /**< connection used for the retrieval */
+    sr_datastore_t ds;          /**< retrieved datastore */
+    char *xpath;                /**< subscription XPath filter, NULL for all the data */
+
+    pthread_mutex_t lock;       /**< held while the data are being retrieved */
+    struct timespec start_ts;   /**< monotonic timestamp of the retrieval start, zeroed if none */
+    uint32_t content_id;        /**< context content ID of the data */
+    char *lyb;                  /**< retrieved data in LYB, NULL if there are none */
+
+    uint32_t refcount;          /**< number of users, including the cache */
+};
+
+/**
+ * @brief Cache of recently retrieved periodic yang-push snapshots.
+ */
+static struct {
+    pthread_mutex_t lock;       /**< cache lock */
+    struct srsn_yp_snapshot *snaps[SRSN_YP_SNAPSHOT_CACHE_SIZE];    /**< cached snapshots, NULL if slot unused */
+    uint32_t next;              /**< next slot to use */
+} yp_snapshot_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Release a snapshot, free it if no longer used. Cache lock is expected to be held.
+ *
+ * @param[in] snap Snapshot to release.
+ */
+static void
+srsn_yp_snapshot_release_(struct srsn_yp_snapshot *snap)
+{
+    if (--snap->refcount) {
+        return;
+    }
+
+    free(snap->xpath);
+    free(snap->lyb);
+    pthread_mutex_destroy(&snap->lock);
+    free(snap);
+}
+
+/**
+ * @brief Release a snapshot acquired by ::srsn_yp_snapshot_acquire().
+ *
+ * @param[in] snap Snapshot to release.
+ */
+static void
+srsn_yp_snapshot_release(struct srsn_yp_snapshot *snap)
+{
+    if (!snap) {
+        return;
+    }
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_snapshot_cache.lock);
+
+    srsn_yp_snapshot_release_(snap);
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_snapshot_cache.lock);
+}
+
+/**
+ * @brief Find the snapshot of a subscription filter or create a new one. Its lock is held on return.
+ *
+ * @param[in] sub Periodic subscription.
+ * @param[out] snap Acquired snapshot, use ::srsn_yp_snapshot_release() when no longer needed.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_yp_snapshot_acquire(const struct srsn_sub *sub, struct srsn_yp_snapshot **snap)
+{
+    sr_error_info_t *err_info = NULL;
+    struct srsn_yp_snapshot *s = NULL;
+    uint32_t i;
+
+    *snap = NULL;
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_snapshot_cache.lock);
+
+    for (i = 0; i < SRSN_YP_SNAPSHOT_CACHE_SIZE; ++i) {
+        s = yp_snapshot_cache.snaps[i];
+        if (s && (s->conn == sub->conn) && (s->ds == sub->ds) && ((!s->xpath && !sub->xpath_filter) ||
+                (s->xpath && sub->xpath_filter && !strcmp(s->xpath, sub->xpath_filter)))) {
+            break;
+        }
+    }
+
+    if (i < SRSN_YP_SNAPSHOT_CACHE_SIZE) {
+        /* found */
+        ++s->refcount;
+    } else {
+        /* create a new snapshot */
+        s = calloc(1, sizeof *s);
+        SR_CHECK_MEM_GOTO(!s, err_info, cleanup_unlock);
+        pthread_mutex_init(&s->lock, NULL);
+        s->conn = sub->conn;
+        s->ds = sub->ds;
+        if (sub->xpath_filter && !(s->xpath = strdup(sub->xpath_filter))) {
+            pthread_mutex_destroy(&s->lock);
+            free(s);
+            SR_ERRINFO_MEM(&err_info);
+            goto cleanup_unlock;
+        }
+
+        /* one reference for the cache and one for the caller */
+        s->refcount = 2;
+        if (yp_snapshot_cache.snaps[yp_snapshot_cache.next]) {
+            srsn_yp_snapshot_release_(yp_snapshot_cache.snaps[yp_snapshot_cache.next]);
+        }
+        yp_snapshot_cache.snaps[yp_snapshot_cache.next] = s;
+        yp_snapshot_cache.next = (yp_snapshot_cache.next + 1) % SRSN_YP_SNAPSHOT_CACHE_SIZE;
+    }
+
+cleanup_unlock:
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_snapshot_cache.lock);
+
+    if (!err_info) {
+        /* SNAPSHOT LOCK, waits for another subscription retrieving the data */
+        pthread_mutex_lock(&s->lock);
+
+        *snap = s;
+    }
+    return err_info;
+}
+
+void
+srsn_yp_snapshot_cache_flush(void)
+{
+    uint32_t i;
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_snapshot_cache.lock);
+
+    for (i = 0; i < SRSN_YP_SNAPSHOT_CACHE_SIZE; ++i) {
+        if (yp_snapshot_cache.snaps[i]) {
+            srsn_yp_snapshot_release_(yp_snapshot_cache.snaps[i]);
+            yp_snapshot_cache.snaps[i] = NULL;
+        }
+    }
+    yp_snapshot_cache.next = 0;
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_snapshot_cache.lock);
+}
+
+/**
+ * @brief Get the data of a periodic yang-push update, reuse the snapshot retrieved by another subscription
+ * whose update coincides with this one, if possible.
+ *
+ * @param[in] sub Periodic subscription.
+ * @param[in] tick_ts Monotonic timestamp of the update.
+ * @param[out] data Retrieved data.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_yp_update_data_get(struct srsn_sub *sub, const struct timespec *tick_ts, sr_data_t **data)
 {
     sr_error_info_t *err_info = NULL;
+    struct srsn_yp_snapshot *snap = NULL;
     sr_session_ctx_t *sr_sess = NULL;
-    struct lyd_node *ly_ntf = NULL;
-    struct timespec ts;
-    sr_data_t *data = NULL;
-    char buf[11];
+    const struct ly_ctx *ly_ctx;
+    struct lyd_node *tree = NULL;
     int r;
 
+    *data = NULL;
+
+    /* get the snapshot, SNAPSHOT LOCK */
+    if ((err_info = srsn_yp_snapshot_acquire(sub, &snap))) {
+        goto cleanup;
+    }
+
+    /* CONTEXT LOCK */
+    ly_ctx = sr_acquire_context(sub->conn);
+
+    if ((snap->start_ts.tv_sec || snap->start_ts.tv_nsec) && (snap->content_id == sr_get_content_id(sub->conn)) &&
+            (sr_time_sub_ms(tick_ts, &snap->start_ts) <= SR_SN_YP_SNAPSHOT_SHARE_MS)) {
+        /* the snapshot was retrieved for this update, parse it */
+        if (snap->lyb && (err_info = sr_lyd_parse_data(ly_ctx, snap->lyb, NULL, LYD_LYB,
+                LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT | LYD_PARSE_OPAQ, 0, &tree))) {
+            /* CONTEXT UNLOCK */
+            sr_release_context(sub->conn);
+            goto cleanup_unlock;
+        }
+
+        /* store as SR data with the context lock, is unlocked on error */
+        if ((r = sr_acquire_data(sub->conn, tree, data))) {
+            sr_errinfo_new(&err_info, r, "Failed to acquire data.");
+        }
+        goto cleanup_unlock;
+    }
+
+    /* CONTEXT UNLOCK, is locked again by the retrieval */
+    sr_release_context(sub->conn);
+
+    /* invalidate the previous snapshot */
+    memset(&snap->start_ts, 0, sizeof snap->start_ts);
+    free(snap->lyb);
+    snap->lyb = NULL;
+
     /* start a new session */
     if ((r = sr_session_start(sub->conn, sub->ds, &sr_sess))) {
         sr_errinfo_new(&err_info, r, "Failed to start a new SR session.");
-        goto cleanup;
+        goto cleanup_unlock;
     }
 
     /* get the data from sysrepo */
-    if ((r = sr_get_data(sr_sess, sub->xpath_filter ? sub->xpath_filter : "/*", 0, 0, 0, &data))) {
+    sr_timeouttime_get(&snap->start_ts, 0);
+    if ((r = sr_get_data(sr_sess, sub->xpath_filter ? sub->xpath_filter : "/*", 0, 0, 0, data))) {
         err_info = sr_sess->err_info;
         sr_sess->err_info = NULL;
+        memset(&snap->start_ts, 0, sizeof snap->start_ts);
+        goto cleanup_unlock;
+    }
+
+    /* serialize the data once for all the coinciding subscriptions */
+    if (*data && (err_info = sr_lyd_print_data((*data)->tree, LYD_LYB, 0, -1, &snap->lyb, NULL))) {
+        memset(&snap->start_ts, 0, sizeof snap->start_ts);
+        goto cleanup_unlock;
+    }
+    snap->content_id = sr_get_content_id(sub->conn);
+
+cleanup_unlock:
+    /* SNAPSHOT UNLOCK */
+    pthread_mutex_unlock(&snap->lock);
+
+cleanup:
+    sr_session_stop(sr_sess);
+    srsn_yp_snapshot_release(snap);
+    if (err_info) {
+        sr_release_data(*data);
+        *data = NULL;
+    }
+    return err_info;
+}
+
+sr_error_info_t *
+srsn_yp_ntf_update_send(struct srsn_sub *sub)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *ly_ntf = NULL;
+    struct timespec ts, tick_ts;
+    sr_data_t *data = NULL;
+    char buf[11];
+
+    /* get the data, possibly shared with other subscriptions */
+    sr_timeouttime_get(&tick_ts, 0);
+    if ((err_info = srsn_yp_update_data_get(sub, &tick_ts, &data))) {
         goto cleanup;
     }
 
@@ -89,7 +327,6 @@ srsn_yp_ntf_update_send(struct srsn_sub *sub)
 cleanup:
     lyd_free_tree(ly_ntf);
     sr_release_data(data);
-    sr_session_stop(sr_sess);
     return err_info;
 }
 
@@ -132,7 +369,7 @@ srsn_yp_schedule_periodic_update(uint32_t period_ms, const struct timespec *anch
     interval.tv_sec = period_ms / 1000;
     interval.tv_nsec = (period_ms % 1000) * 1000000;
 
-    if (!sntimer->tid) {
+    if (!sntimer->active) {
         /* create the timer */
         if ((err_info = srsn_create_timer(srsn_yp_update_timer_cb, sub, &trigger, &interval, sntimer))) {
             goto cleanup;
@@ -146,6 +383,48 @@ cleanup:
     return err_info;
 }
 
+/**
+ * @brief Record of the latest edit of a target in a pending YANG patch.
+ */
+struct srsn_yp_edit_rec {
+    char *target;               /**< edit target path */
+    struct lyd_node *edit;      /**< edit in the YANG patch */
+};
+
+/**
+ * @brief Edit hash table equal callback.
+ */
+static ly_bool
+srsn_yp_edit_ht_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct srsn_yp_edit_rec *val1, *val2;
+
+    val1 = val1_p;
+    val2 = val2_p;
+
+    return !strcmp(val1->target, val2->target);
+}
+
+/**
+ * @brief Edit hash table value free callback.
+ */
+static void
+srsn_yp_edit_ht_free_cb(void *val_p)
+{
+    struct srsn_yp_edit_rec *val = val_p;
+
+    free(val->target);
+}
+
+void
+srsn_yp_ntf_change_free(struct srsn_sub *sub)
+{
+    sr_release_data(sub->change_ntf);
+    sub->change_ntf = NULL;
+    lyht_free(sub->edit_ht, srsn_yp_edit_ht_free_cb);
+    sub->edit_ht = NULL;
+}
+
 /**
  * @brief Send a prepared yang-push on-change change notification.
  *
@@ -162,8 +441,7 @@ srsn_yp_ntf_change_send(struct srsn_sub *sub)
     if ((err_info = srsn_ntf_send(sub, &ts, sub->change_ntf->tree))) {
         return err_info;
     }
-    sr_release_data(sub->change_ntf);
-    sub->change_ntf = NULL;
+    srsn_yp_ntf_change_free(sub);
 
     /* set last_notif timestamp */
     sub->last_notif = ts;
@@ -206,7 +484,7 @@ srsn_yp_ntf_change_ready(struct srsn_sub *sub, int *ready)
         return NULL;
     }
 
-    if (sub->damp_sntimer.tid) {
+    if (sub->damp_sntimer.active) {
         /* timer is already set */
         *ready = 0;
         return NULL;
@@ -289,89 +567,235 @@ srsn_yp_op2str(srsn_yp_change_t op)
 }
 
 /**
- * @brief Remove any previous edits in a YANG patch of a target.
+ * @brief Number of recently processed diffs kept for other subscriptions with the same filter.
+ */
+#define SRSN_YP_DIFF_CACHE_SIZE 16
+
+/**
+ * @brief Prepared yang-push edit of a single diff change, independent of any subscription.
+ */
+struct srsn_yp_change {
+    srsn_yp_change_t yp_op;     /**< yang-push operation */
+    char *target;               /**< edit target path */
+    char *point;                /**< edit point, if any */
+    const char *where;          /**< edit where, if any */
+    char *value;                /**< edit value in XML, if any */
+};
+
+/**
+ * @brief Diff of a module change event processed for a specific filter, shared by all the subscriptions
+ * with this filter.
+ */
+struct srsn_yp_diff {
+    char *module_name;          /**< changed module */
+    sr_datastore_t ds;          /**< changed datastore */
+    uint32_t request_id;        /**< request ID of the change event */
+    char *xpath;                /**< subscription XPath filter, NULL for the whole module */
+
+    pthread_mutex_t lock;       /**< held while the changes are being prepared */
+    int prepared;               /**< whether the changes were successfully prepared */
+    struct srsn_yp_change *changes; /**< prepared changes */
+    uint32_t change_count;      /**< count of prepared changes */
+
+    uint32_t refcount;          /**< number of users, including the cache */
+};
+
+/**
+ * @brief Cache of recently processed diffs.
+ */
+static struct {
+    pthread_mutex_t lock;       /**< cache lock */
+    struct srsn_yp_diff *diffs[SRSN_YP_DIFF_CACHE_SIZE];    /**< cached diffs, NULL if slot unused */
+    uint32_t next;              /**< next slot to use */
+} yp_diff_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Free prepared changes of a processed diff.
  *
- * @param[in] ly_yp YANG patch node.
- * @param[in] target Target edits to remove.
- * @return err_info, NULL on success.
+ * @param[in] diff Diff to use.
  */
-static sr_error_info_t *
-srsn_yp_ntf_change_edit_clear_target(struct lyd_node *ly_yp, const char *target)
+static void
+srsn_yp_diff_changes_free(struct srsn_yp_diff *diff)
 {
-    sr_error_info_t *err_info = NULL;
-    struct ly_set *set = NULL;
-    char quot, *xpath = NULL;
+    uint32_t i;
 
-    /* find the edit of this target, be careful with the quotes in the XPath */
-    quot = strchr(target, '\'') ? '\"' : '\'';
-    if (asprintf(&xpath, "/ietf-yang-push:push-change-update/datastore-changes/yang-patch/edit[target=%c%s%c]",
-            quot, target, quot) == -1) {
-        SR_ERRINFO_MEM(&err_info);
-        goto cleanup;
+    for (i = 0; i < diff->change_count; ++i) {
+        free(diff->changes[i].target);
+        free(diff->changes[i].point);
+        free(diff->changes[i].value);
     }
-    if ((err_info = sr_lyd_find_xpath(ly_yp, xpath, &set))) {
-        goto cleanup;
+    free(diff->changes);
+    diff->changes = NULL;
+    diff->change_count = 0;
+}
+
+/**
+ * @brief Free a processed diff.
+ *
+ * @param[in] diff Diff to free.
+ */
+static void
+srsn_yp_diff_free(struct srsn_yp_diff *diff)
+{
+    if (!diff) {
+        return;
     }
-    assert((set->count == 0) || (set->count == 1));
 
-    /* remove the previous change of this target */
-    if (set->count) {
-        lyd_free_tree(set->dnodes[0]);
+    srsn_yp_diff_changes_free(diff);
+    free(diff->module_name);
+    free(diff->xpath);
+    pthread_mutex_destroy(&diff->lock);
+    free(diff);
+}
+
+/**
+ * @brief Release a processed diff, free it if no longer used. Cache lock is expected to be held.
+ *
+ * @param[in] diff Diff to release.
+ */
+static void
+srsn_yp_diff_release_(struct srsn_yp_diff *diff)
+{
+    if (!--diff->refcount) {
+        srsn_yp_diff_free(diff);
     }
+}
 
-cleanup:
-    free(xpath);
-    ly_set_free(set, NULL);
-    return err_info;
+/**
+ * @brief Release a processed diff acquired by ::srsn_yp_diff_acquire().
+ *
+ * @param[in] diff Diff to release.
+ */
+static void
+srsn_yp_diff_release(struct srsn_yp_diff *diff)
+{
+    if (!diff) {
+        return;
+    }
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_diff_cache.lock);
+
+    srsn_yp_diff_release_(diff);
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_diff_cache.lock);
 }
 
 /**
- * @brief Append a new edit (change) to a YANG patch.
+ * @brief Find a processed diff of a change event and filter or create a new one. Its lock is held on return
+ * so that it is prepared only once.
  *
- * @param[in] ly_yp YANG patch node to append to.
- * @param[in] yp_op yang-push operation.
- * @param[in] node Changed node.
- * @param[in] prev_value Previous leaf-list value, if any.
- * @param[in] prev_list Previous list value, if any.
- * @param[in] sub Subscription to use.
+ * @param[in] module_name Changed module.
+ * @param[in] ds Changed datastore.
+ * @param[in] request_id Request ID of the change event.
+ * @param[in] xpath Subscription XPath filter.
+ * @param[out] diff Acquired diff, use ::srsn_yp_diff_release() when no longer needed.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-srsn_yp_ntf_change_edit_append(struct lyd_node *ly_yp, srsn_yp_change_t yp_op, const struct lyd_node *node,
-        const char *prev_value, const char *prev_list, struct srsn_sub *sub)
+srsn_yp_diff_acquire(const char *module_name, sr_datastore_t ds, uint32_t request_id, const char *xpath,
+        struct srsn_yp_diff **diff)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *ly_edit, *value_tree = NULL;
-    char buf[26], *path = NULL, *point = NULL, quot, *xml;
-    uint32_t edit_id;
+    struct srsn_yp_diff *d = NULL;
+    uint32_t i;
 
-    /* get the edit target path */
-    path = lyd_path(node, LYD_PATH_STD, NULL, 0);
-    SR_CHECK_MEM_GOTO(!path, err_info, cleanup);
+    *diff = NULL;
 
-    /* remove any previous change of this target */
-    if ((err_info = srsn_yp_ntf_change_edit_clear_target(ly_yp, path))) {
-        goto cleanup;
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_diff_cache.lock);
+
+    for (i = 0; i < SRSN_YP_DIFF_CACHE_SIZE; ++i) {
+        d = yp_diff_cache.diffs[i];
+        if (d && (d->request_id == request_id) && (d->ds == ds) && !strcmp(d->module_name, module_name) &&
+                ((!d->xpath && !xpath) || (d->xpath && xpath && !strcmp(d->xpath, xpath)))) {
+            break;
+        }
     }
 
-    /* generate new edit ID */
-    edit_id = sub->edit_id++;
+    if (i < SRSN_YP_DIFF_CACHE_SIZE) {
+        /* found, it may still be being prepared */
+        ++d->refcount;
+    } else {
+        /* create a new diff */
+        d = calloc(1, sizeof *d);
+        SR_CHECK_MEM_GOTO(!d, err_info, cleanup_unlock);
+        pthread_mutex_init(&d->lock, NULL);
+        d->ds = ds;
+        d->request_id = request_id;
+        d->module_name = strdup(module_name);
+        if (!d->module_name || (xpath && !(d->xpath = strdup(xpath)))) {
+            srsn_yp_diff_free(d);
+            SR_ERRINFO_MEM(&err_info);
+            goto cleanup_unlock;
+        }
 
-    /* edit with edit-id */
-    sprintf(buf, "edit-%" PRIu32, edit_id);
-    if ((err_info = sr_lyd_new_list(ly_yp, "edit", buf, &ly_edit))) {
-        goto cleanup;
+        /* one reference for the cache and one for the caller */
+        d->refcount = 2;
+        if (yp_diff_cache.diffs[yp_diff_cache.next]) {
+            srsn_yp_diff_release_(yp_diff_cache.diffs[yp_diff_cache.next]);
+        }
+        yp_diff_cache.diffs[yp_diff_cache.next] = d;
+        yp_diff_cache.next = (yp_diff_cache.next + 1) % SRSN_YP_DIFF_CACHE_SIZE;
     }
 
-    /* operation */
-    if ((err_info = sr_lyd_new_term(ly_edit, NULL, "operation", srsn_yp_op2str(yp_op)))) {
-        goto cleanup;
+cleanup_unlock:
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_diff_cache.lock);
+
+    if (!err_info) {
+        /* DIFF LOCK, waits for another thread preparing it */
+        pthread_mutex_lock(&d->lock);
+
+        *diff = d;
     }
+    return err_info;
+}
 
-    /* target */
-    if ((err_info = sr_lyd_new_term(ly_edit, NULL, "target", path))) {
-        goto cleanup;
+void
+srsn_yp_diff_cache_flush(void)
+{
+    uint32_t i;
+
+    /* CACHE LOCK */
+    pthread_mutex_lock(&yp_diff_cache.lock);
+
+    for (i = 0; i < SRSN_YP_DIFF_CACHE_SIZE; ++i) {
+        if (yp_diff_cache.diffs[i]) {
+            srsn_yp_diff_release_(yp_diff_cache.diffs[i]);
+            yp_diff_cache.diffs[i] = NULL;
+        }
     }
+    yp_diff_cache.next = 0;
+
+    /* CACHE UNLOCK */
+    pthread_mutex_unlock(&yp_diff_cache.lock);
+}
+
+/**
+ * @brief Prepare a yang-push edit of a single change.
+ *
+ * @param[in] yp_op yang-push operation.
+ * @param[in] node Changed node.
+ * @param[in] prev_value Previous leaf-list value, if any.
+ * @param[in] prev_list Previous list value, if any.
+ * @param[out] change Prepared change.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_yp_change_prepare(srsn_yp_change_t yp_op, const struct lyd_node *node, const char *prev_value,
+        const char *prev_list, struct srsn_yp_change *change)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *value_tree = NULL;
+    char quot;
+
+    change->yp_op = yp_op;
+
+    /* get the edit target path */
+    change->target = lyd_path(node, LYD_PATH_STD, NULL, 0);
+    SR_CHECK_MEM_GOTO(!change->target, err_info, cleanup);
 
     if ((yp_op == SRSN_YP_CHANGE_INSERT) || (yp_op == SRSN_YP_CHANGE_MOVE)) {
         /* point */
@@ -379,33 +803,28 @@ srsn_yp_ntf_change_edit_append(struct lyd_node *ly_yp, srsn_yp_change_t yp_op, c
             assert(prev_value);
             if (prev_value[0]) {
                 quot = strchr(prev_value, '\'') ? '\"' : '\'';
-                if (asprintf(&point, "%s[.=%c%s%c]", path, quot, prev_value, quot) == -1) {
+                if (asprintf(&change->point, "%s[.=%c%s%c]", change->target, quot, prev_value, quot) == -1) {
+                    change->point = NULL;
                     SR_ERRINFO_MEM(&err_info);
                     goto cleanup;
                 }
             }
         } else {
             if (prev_list[0]) {
-                if (asprintf(&point, "%s%s", path, prev_list) == -1) {
+                if (asprintf(&change->point, "%s%s", change->target, prev_list) == -1) {
+                    change->point = NULL;
                     SR_ERRINFO_MEM(&err_info);
                     goto cleanup;
                 }
             }
         }
-        if (point && (err_info = sr_lyd_new_term(ly_edit, NULL, "point", point))) {
-            goto cleanup;
-        }
 
         /* where */
         if (((node->schema->nodetype == LYS_LEAFLIST) && !prev_value[0]) ||
                 ((node->schema->nodetype == LYS_LIST) && !prev_list[0])) {
-            if ((err_info = sr_lyd_new_term(ly_edit, NULL, "where", "first"))) {
-                goto cleanup;
-            }
+            change->where = "first";
         } else {
-            if ((err_info = sr_lyd_new_term(ly_edit, NULL, "where", "after"))) {
-                goto cleanup;
-            }
+            change->where = "after";
         }
     }
 
@@ -415,20 +834,160 @@ srsn_yp_ntf_change_edit_append(struct lyd_node *ly_yp, srsn_yp_change_t yp_op, c
             goto cleanup;
         }
 
-        /* value, add as an XML subtree so that it can be printed in LYB */
-        if ((err_info = sr_lyd_print_data(value_tree, LYD_XML, LYD_PRINT_SHRINK | LYD_PRINT_WD_ALL, -1, &xml, NULL))) {
+        /* value, stored as an XML subtree so that it can be printed in LYB */
+        if ((err_info = sr_lyd_print_data(value_tree, LYD_XML, LYD_PRINT_SHRINK | LYD_PRINT_WD_ALL, -1,
+                &change->value, NULL))) {
             goto cleanup;
         }
-        assert(xml);
+        assert(change->value);
+    }
+
+cleanup:
+    lyd_free_tree(value_tree);
+    return err_info;
+}
+
+/**
+ * @brief Prepare all the yang-push edits of a diff. Diff lock is expected to be held.
+ *
+ * @param[in] session Callback session with the diff.
+ * @param[in] module_name Changed module.
+ * @param[in] xpath Subscription XPath filter.
+ * @param[in] diff Diff to prepare.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_yp_diff_prepare(sr_session_ctx_t *session, const char *module_name, const char *xpath, struct srsn_yp_diff *diff)
+{
+    sr_error_info_t *err_info = NULL;
+    char *xp = NULL;
+    sr_change_iter_t *iter = NULL;
+    sr_change_oper_t op;
+    const struct lyd_node *node;
+    const char *prev_value, *prev_list;
+    void *mem;
+    int r;
+
+    assert(!diff->prepared && !diff->change_count);
+
+    if (xpath) {
+        r = asprintf(&xp, "%s//.", xpath);
+    } else {
+        r = asprintf(&xp, "/%s:*//.", module_name);
+    }
+    SR_CHECK_MEM_GOTO(r == -1, err_info, cleanup);
+    if (sr_get_changes_iter(session, xp, &iter)) {
+        err_info = session->err_info;
+        session->err_info = NULL;
+        goto cleanup;
+    }
+
+    while (!sr_get_change_tree_next(session, iter, &op, &node, &prev_value, &prev_list, NULL)) {
+        mem = realloc(diff->changes, (diff->change_count + 1) * sizeof *diff->changes);
+        SR_CHECK_MEM_GOTO(!mem, err_info, cleanup);
+        diff->changes = mem;
+        memset(&diff->changes[diff->change_count], 0, sizeof *diff->changes);
+        ++diff->change_count;
+
+        if ((err_info = srsn_yp_change_prepare(srsn_yp_op_sr2yp(op, node), node, prev_value, prev_list,
+                &diff->changes[diff->change_count - 1]))) {
+            goto cleanup;
+        }
+    }
+
+    diff->prepared = 1;
+
+cleanup:
+    if (err_info) {
+        /* let another subscription try again */
+        srsn_yp_diff_changes_free(diff);
+    }
+    free(xp);
+    sr_free_change_iter(iter);
+    return err_info;
+}
+
+/**
+ * @brief Append a new edit (change) to a YANG patch, replacing any previous edit of the same target so that
+ * there is always only the latest edit of every target.
+ *
+ * @param[in] ly_yp YANG patch node to append to.
+ * @param[in] change Prepared change to append.
+ * @param[in] sub Subscription to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+srsn_yp_ntf_change_edit_append(struct lyd_node *ly_yp, const struct srsn_yp_change *change, struct srsn_sub *sub)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *ly_edit;
+    struct srsn_yp_edit_rec rec, *rec_p = NULL;
+    char buf[26], *xml;
+    uint32_t edit_id, hash;
+
+    /* remove any previous change of this target */
+    rec.target = change->target;
+    hash = lyht_hash(change->target, strlen(change->target));
+    if (!lyht_find(sub->edit_ht, &rec, hash, (void **)&rec_p)) {
+        lyd_free_tree(rec_p->edit);
+        rec_p->edit = NULL;
+    } else {
+        rec_p = NULL;
+    }
+
+    /* generate new edit ID */
+    edit_id = sub->edit_id++;
+
+    /* edit with edit-id */
+    sprintf(buf, "edit-%" PRIu32, edit_id);
+    if ((err_info = sr_lyd_new_list(ly_yp, "edit", buf, &ly_edit))) {
+        goto cleanup;
+    }
+
+    /* operation */
+    if ((err_info = sr_lyd_new_term(ly_edit, NULL, "operation", srsn_yp_op2str(change->yp_op)))) {
+        goto cleanup;
+    }
+
+    /* target */
+    if ((err_info = sr_lyd_new_term(ly_edit, NULL, "target", change->target))) {
+        goto cleanup;
+    }
+
+    /* point */
+    if (change->point && (err_info = sr_lyd_new_term(ly_edit, NULL, "point", change->point))) {
+        goto cleanup;
+    }
+
+    /* where */
+    if (change->where && (err_info = sr_lyd_new_term(ly_edit, NULL, "where", change->where))) {
+        goto cleanup;
+    }
+
+    if (change->value) {
+        /* value, the node takes ownership of the string */
+        xml = strdup(change->value);
+        SR_CHECK_MEM_GOTO(!xml, err_info, cleanup);
         if ((err_info = sr_lyd_new_any(ly_edit, "value", xml, LYD_ANYDATA_XML))) {
+            free(xml);
+            goto cleanup;
+        }
+    }
+
+    /* remember the latest edit of the target */
+    if (rec_p) {
+        rec_p->edit = ly_edit;
+    } else {
+        rec.target = strdup(change->target);
+        SR_CHECK_MEM_GOTO(!rec.target, err_info, cleanup);
+        rec.edit = ly_edit;
+        if ((err_info = sr_lyht_insert(sub->edit_ht, &rec, hash))) {
+            free(rec.target);
             goto cleanup;
         }
     }
 
 cleanup:
-    free(path);
-    free(point);
-    lyd_free_tree(value_tree);
     if (err_info) {
         sr_errinfo_new(&err_info, err_info->err[0].err_code, "Failed to store data edit for an on-change notification.");
     }
@@ -437,45 +996,47 @@ cleanup:
 
 /**
  * @brief Module change callback for yang-push data changes.
+ *
+ * The diff is processed only once for all the subscriptions with the same filter, the first subscription to
+ * receive a change event prepares the edits and all the others only append them to their YANG patches.
  */
 static int
 srsn_yp_on_change_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const char *module_name,
-        const char *xpath, sr_event_t UNUSED(event), uint32_t UNUSED(request_id), void *private_data)
+        const char *xpath, sr_event_t UNUSED(event), uint32_t request_id, void *private_data)
 {
     sr_error_info_t *err_info = NULL;
     struct srsn_sub *sub = private_data;
-    char *xp = NULL, buf[26];
-    sr_change_iter_t *iter = NULL;
-    sr_change_oper_t op;
-    const struct lyd_node *node;
+    struct srsn_yp_diff *diff = NULL;
+    const struct srsn_yp_change *change;
+    char buf[26];
     const struct ly_ctx *ly_ctx;
     struct lyd_node *ly_yp = NULL;
-    const char *prev_value, *prev_list;
-    srsn_yp_change_t yp_op;
     int ready, r;
-    uint32_t patch_id;
+    uint32_t i, patch_id;
 
     assert(sub->type == SRSN_YANG_PUSH_ON_CHANGE);
 
-    if (xpath) {
-        r = asprintf(&xp, "%s//.", xpath);
-    } else {
-        r = asprintf(&xp, "/%s:*//.", module_name);
+    /* get the processed diff, DIFF LOCK */
+    if ((err_info = srsn_yp_diff_acquire(module_name, sr_session_get_ds(session), request_id, xpath, &diff))) {
+        goto cleanup;
     }
-    SR_CHECK_MEM_GOTO(r == -1, err_info, cleanup);
-    if (sr_get_changes_iter(session, xp, &iter)) {
-        err_info = session->err_info;
-        session->err_info = NULL;
+    if (!diff->prepared) {
+        /* we are the first subscription (or the previous attempt failed), prepare it */
+        err_info = srsn_yp_diff_prepare(session, module_name, xpath, diff);
+    }
+
+    /* DIFF UNLOCK, prepared changes are not modified anymore */
+    pthread_mutex_unlock(&diff->lock);
+    if (err_info) {
         goto cleanup;
     }
 
     /* TIMER LOCK */
     pthread_mutex_lock(&sub->damp_sntimer.lock);
 
-    while (!sr_get_change_tree_next(session, iter, &op, &node, &prev_value, &prev_list, NULL)) {
-        /* learn yang-push operation */
-        yp_op = srsn_yp_op_sr2yp(op, node);
-        if (sub->excluded_changes[yp_op]) {
+    for (i = 0; i < diff->change_count; ++i) {
+        change = &diff->changes[i];
+        if (sub->excluded_changes[change->yp_op]) {
             /* excluded */
             ++sub->excluded_change_count;
             continue;
@@ -509,13 +1070,17 @@ srsn_yp_on_change_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const c
 
             /* initialize edit-id */
             sub->edit_id = 1;
+
+            /* index of the latest edit of every target */
+            sub->edit_ht = lyht_new(8, sizeof(struct srsn_yp_edit_rec), srsn_yp_edit_ht_equal_cb, NULL, 1);
+            SR_CHECK_MEM_GOTO(!sub->edit_ht, err_info, cleanup_unlock);
         }
         if (!ly_yp) {
             ly_yp = lyd_child(lyd_child(sub->change_ntf->tree)->next);
         }
 
         /* append a new edit */
-        if ((err_info = srsn_yp_ntf_change_edit_append(ly_yp, yp_op, node, prev_value, prev_list, sub))) {
+        if ((err_info = srsn_yp_ntf_change_edit_append(ly_yp, change, sub))) {
             goto cleanup_unlock;
         }
     }
@@ -537,16 +1102,14 @@ srsn_yp_on_change_cb(sr_session_ctx_t *session, uint32_t UNUSED(sub_id), const c
 
 cleanup_unlock:
     if (err_info && sub->change_ntf) {
-        sr_release_data(sub->change_ntf);
-        sub->change_ntf = NULL;
+        srsn_yp_ntf_change_free(sub);
     }
 
     /* TIMER UNLOCK */
     pthread_mutex_unlock(&sub->damp_sntimer.lock);
 
 cleanup:
-    free(xp);
-    sr_free_change_iter(iter);
+    srsn_yp_diff_release(diff);
 
     /* return value is ignored anyway */
     sr_errinfo_free(&err_info);
@@ -768,7 +1331,7 @@ srsn_yp_on_change_modify(struct srsn_sub *sub, uint32_t dampening_period_ms)
             if (sub->change_ntf && (err_info = srsn_yp_ntf_change_send(sub))) {
                 goto cleanup;
             }
-        } else if (sub->damp_sntimer.tid) {
+        } else if (sub->damp_sntimer.active) {
             /* learn when the next notification is due */
             next_notif = sr_time_ts_add(&sub->last_notif, dampening_period_ms);
 
@@ -83,4 +83,21 @@ sr_error_info_t *srsn_yp_periodic_modify(struct srsn_sub *sub, uint32_t period_m
  */
 sr_error_info_t *srsn_yp_on_change_modify(struct srsn_sub *sub, uint32_t dampening_period_ms);
 
+/**
+ * @brief Free a pending on-change notification of a subscription.
+ *
+ * @param[in] sub Subscription to use.
+ */
+void srsn_yp_ntf_change_free(struct srsn_sub *sub);
+
+/**
+ * @brief Free all the diffs processed for on-change subscriptions and shared by subscriptions with equal filters.
+ */
+void srsn_yp_diff_cache_flush(void);
+
+/**
+ * @brief Free all the data snapshots shared by periodic subscriptions with equal filters.
+ */
+void srsn_yp_snapshot_cache_flush(void);
+
 #endif /* SN_YANG_PUSH_H_ */
@@ -283,7 +283,6 @@ srsn_yang_push_periodic(sr_session_ctx_t *session, sr_datastore_t ds, const char
         s->anchor_time = *anchor_time;
     }
     pthread_mutex_init(&s->update_sntimer.lock, NULL);
-    pthread_cond_init(&s->update_sntimer.cond, NULL);
 
     /* schedule the periodic updates */
     if ((err_info = srsn_yp_schedule_periodic_update(s->period_ms, anchor_time, s, &s->update_sntimer))) {
@@ -345,7 +344,6 @@ srsn_yang_push_on_change(sr_session_ctx_t *session, sr_datastore_t ds, const cha
     }
     s->patch_id = 1;
     pthread_mutex_init(&s->damp_sntimer.lock, NULL);
-    pthread_cond_init(&s->damp_sntimer.cond, NULL);
 
     /* send the initial update notification */
     if (sync_on_start && (err_info = srsn_yp_ntf_update_send(s))) {
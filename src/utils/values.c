@@ -942,7 +942,7 @@ sr_tree_to_val(const struct lyd_node *data, const char *path, sr_val_t **value)
     *value = malloc(sizeof **value);
     SR_CHECK_MEM_GOTO(!*value, err_info, cleanup);
 
-    if ((err_info = sr_val_ly2sr(set->dnodes[0], *value))) {
+    if ((err_info = sr_val_ly2sr(set->dnodes[0], NULL, *value))) {
         goto cleanup;
     }
 
@@ -956,6 +956,7 @@ sr_tree_to_values(const struct lyd_node *data, const char *xpath, sr_val_t **val
 {
     sr_error_info_t *err_info = NULL;
     struct ly_set *set = NULL;
+    struct sr_lyd_path_s path = {0};
     uint32_t i;
 
     SR_CHECK_ARG_APIRET(!data || !xpath || !values || !value_cnt, NULL, err_info);
@@ -978,7 +979,7 @@ sr_tree_to_values(const struct lyd_node *data, const char *xpath, sr_val_t **val
                 continue;
             }
 
-            if ((err_info = sr_val_ly2sr(set->dnodes[i], *values + *value_cnt))) {
+            if ((err_info = sr_val_ly2sr(set->dnodes[i], &path, *values + *value_cnt))) {
                 goto cleanup;
             }
             ++(*value_cnt);
@@ -987,6 +988,7 @@ sr_tree_to_values(const struct lyd_node *data, const char *xpath, sr_val_t **val
 
 cleanup:
     ly_set_free(set, NULL);
+    sr_lyd_path_erase(&path);
     if (err_info) {
         sr_free_values(*values, *value_cnt);
         *values = NULL;
@@ -19,8 +19,12 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <libyang/libyang.h>
 
@@ -41,6 +45,20 @@
 
 #define ABS(x) (x < 0) * (-x) + (x >= 0) * x
 
+/* number of subscribers of the subscription tests, each with its own subscription thread */
+#define SUB_COUNT 4
+
+struct test_state;
+
+/**
+ * @brief Additional subscription structure.
+ */
+struct test_sub {
+    sr_subscription_ctx_t *sub;
+    struct test_state *state;
+    uint32_t idx;
+};
+
 /**
  * @brief Test state structure.
  */
@@ -50,6 +68,12 @@ struct test_state {
     sr_subscription_ctx_t *sub;
     const struct lys_module *mod;
     uint32_t count;
+
+    struct test_sub subs[SUB_COUNT];
+    struct lyd_node *tree;
+    uint32_t iter;
+    pid_t sub_pid;
+    int sub_pipe;
 };
 
 typedef int (*setup_cb)(struct test_state *state);
@@ -185,6 +209,40 @@ create_user_order_list_inst(const struct lys_module *mod, uint32_t offset, uint3
     return SR_ERR_OK;
 }
 
+/**
+ * @brief Create RPC input with list instances.
+ *
+ * @param[in] mod Module of the RPC.
+ * @param[in] count Number of list instances to create.
+ * @param[out] input Created RPC input.
+ * @return SR ERR value.
+ */
+static int
+create_rpc_input(const struct lys_module *mod, uint32_t count, struct lyd_node **input)
+{
+    uint32_t i;
+    char k_val[32], l_val[32];
+    struct lyd_node *list;
+
+    if (lyd_new_inner(NULL, mod, "rpc", 0, input)) {
+        return SR_ERR_LY;
+    }
+
+    for (i = 0; i < count; ++i) {
+        sprintf(k_val, "%" PRIu32, i);
+        sprintf(l_val, "l%" PRIu32, i);
+
+        if (lyd_new_list(*input, NULL, "lst", 0, &list, k_val)) {
+            return SR_ERR_LY;
+        }
+        if (lyd_new_term(list, NULL, "l", l_val, 0, NULL)) {
+            return SR_ERR_LY;
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
 /**
  * @brief Execute a test.
  *
@@ -262,6 +320,110 @@ oper_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, con
     return create_list_inst(state->mod, 0, state->count, parent);
 }
 
+static int
+oper_part_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *path,
+        const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct test_sub *tsub = private_data;
+    uint32_t part = tsub->state->count / SUB_COUNT;
+
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)path;
+    (void)request_xpath;
+    (void)request_id;
+
+    /* every provider returns its part of the list instances, the last one also the remainder */
+    if (tsub->idx == SUB_COUNT - 1) {
+        return create_list_inst(tsub->state->mod, tsub->idx * part, tsub->state->count - tsub->idx * part, parent);
+    }
+    return create_list_inst(tsub->state->mod, tsub->idx * part, part, parent);
+}
+
+static int
+change_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+static int
+rpc_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *op_path, const struct lyd_node *input, sr_event_t event,
+        uint32_t request_id, struct lyd_node *output, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)op_path;
+    (void)input;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    if (lyd_new_term(output, NULL, "l", "out", 1, NULL)) {
+        return SR_ERR_LY;
+    }
+
+    return SR_ERR_OK;
+}
+
+static void
+notif_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type, const struct lyd_node *notif,
+        struct timespec *timestamp, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)notif_type;
+    (void)notif;
+    (void)timestamp;
+    (void)private_data;
+}
+
+/**
+ * @brief Subscriber process handling the RPC.
+ *
+ * @param[in] ready_fd Pipe to announce the subscription is ready.
+ * @param[in] quit_fd Pipe to wait on for the end of the test.
+ * @return SR ERR value.
+ */
+static int
+rpc_subscriber_proc(int ready_fd, int quit_fd)
+{
+    int r;
+    char buf;
+    sr_conn_ctx_t *conn = NULL;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *sub = NULL;
+
+    if ((r = sr_connect(SR_CONN_DEFAULT, &conn))) {
+        goto cleanup;
+    }
+    if ((r = sr_session_start(conn, SR_DS_RUNNING, &sess))) {
+        goto cleanup;
+    }
+    if ((r = sr_rpc_subscribe_tree(sess, "/perf:rpc", rpc_cb, NULL, 0, 0, &sub))) {
+        goto cleanup;
+    }
+
+    /* ready, wait for the end */
+    if ((write(ready_fd, "r", 1) != 1) || (read(quit_fd, &buf, 1) != 1)) {
+        r = SR_ERR_SYS;
+    }
+
+cleanup:
+    sr_unsubscribe(sub);
+    sr_disconnect(conn);
+    return r;
+}
+
 /* TEST SETUPS */
 static int
 setup_empty(struct test_state *state)
@@ -430,6 +592,180 @@ setup_subscribe_oper(struct test_state *state)
     return SR_ERR_OK;
 }
 
+static int
+setup_subscribe_oper_merge(struct test_state *state)
+{
+    int r;
+    uint32_t i;
+
+    if ((r = setup_empty(state))) {
+        return r;
+    }
+
+    /* several providers of the same data merged together */
+    for (i = 0; i < SUB_COUNT; ++i) {
+        state->subs[i].state = state;
+        state->subs[i].idx = i;
+        if ((r = sr_oper_get_subscribe(state->sess, "perf", "/perf:cont", oper_part_cb, &state->subs[i],
+                SR_SUBSCR_OPER_MERGE, &state->subs[i].sub))) {
+            return r;
+        }
+    }
+
+    return sr_session_switch_ds(state->sess, SR_DS_OPERATIONAL);
+}
+
+static int
+setup_oper_data(struct test_state *state)
+{
+    int r;
+
+    if ((r = setup_empty(state))) {
+        return r;
+    }
+
+    return create_list_inst(state->mod, 0, state->count, &state->tree);
+}
+
+static int
+subscribe_change(struct test_state *state, int prio)
+{
+    int r;
+    uint32_t i;
+
+    if ((r = setup_running(state))) {
+        return r;
+    }
+
+    for (i = 0; i < SUB_COUNT; ++i) {
+        if ((r = sr_module_change_subscribe(state->sess, "perf", NULL, change_cb, NULL, prio ? i + 1 : 0, 0,
+                &state->subs[i].sub))) {
+            return r;
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
+static int
+setup_subscribe_change(struct test_state *state)
+{
+    /* all the subscribers are notified at once */
+    return subscribe_change(state, 0);
+}
+
+static int
+setup_subscribe_change_prio(struct test_state *state)
+{
+    /* the subscribers are notified one after another */
+    return subscribe_change(state, 1);
+}
+
+static int
+setup_rpc(struct test_state *state)
+{
+    int r;
+
+    if ((r = setup_empty(state))) {
+        return r;
+    }
+
+    return create_rpc_input(state->mod, state->count, &state->tree);
+}
+
+static int
+setup_subscribe_rpc(struct test_state *state)
+{
+    int r;
+
+    if ((r = setup_rpc(state))) {
+        return r;
+    }
+
+    return sr_rpc_subscribe_tree(state->sess, "/perf:rpc", rpc_cb, NULL, 0, 0, &state->subs[0].sub);
+}
+
+static int
+setup_subscribe_rpc_proc(struct test_state *state)
+{
+    int pipes[4];
+    char buf;
+
+    if (pipe(pipes)) {
+        return SR_ERR_SYS;
+    }
+    if (pipe(pipes + 2)) {
+        close(pipes[0]);
+        close(pipes[1]);
+        return SR_ERR_SYS;
+    }
+
+    /* fork the subscriber before connecting */
+    state->sub_pid = fork();
+    if (state->sub_pid == -1) {
+        return SR_ERR_SYS;
+    } else if (!state->sub_pid) {
+        close(pipes[0]);
+        close(pipes[3]);
+        exit(rpc_subscriber_proc(pipes[1], pipes[2]));
+    }
+    close(pipes[1]);
+    close(pipes[2]);
+    state->sub_pipe = pipes[3];
+
+    /* wait for the subscriber */
+    if (read(pipes[0], &buf, 1) != 1) {
+        close(pipes[0]);
+        return SR_ERR_SYS;
+    }
+    close(pipes[0]);
+
+    return setup_rpc(state);
+}
+
+static int
+setup_subscribe_notif(struct test_state *state)
+{
+    int r;
+    uint32_t i;
+
+    if ((r = setup_empty(state))) {
+        return r;
+    }
+
+    if (lyd_new_inner(NULL, state->mod, "notif", 0, &state->tree)) {
+        return SR_ERR_LY;
+    }
+    if (lyd_new_term(state->tree, NULL, "l", "val", 0, NULL)) {
+        return SR_ERR_LY;
+    }
+
+    for (i = 0; i < SUB_COUNT; ++i) {
+        if ((r = sr_notif_subscribe_tree(state->sess, "perf", NULL, NULL, NULL, notif_cb, NULL, 0,
+                &state->subs[i].sub))) {
+            return r;
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Remove all the additional subscriptions.
+ *
+ * @param[in] state Test state.
+ */
+static void
+unsubscribe_subs(struct test_state *state)
+{
+    uint32_t i;
+
+    for (i = 0; i < SUB_COUNT; ++i) {
+        sr_unsubscribe(state->subs[i].sub);
+        state->subs[i].sub = NULL;
+    }
+}
+
 static void
 teardown_empty(struct test_state *state)
 {
@@ -458,6 +794,49 @@ teardown_oper(struct test_state *state)
     sr_disconnect(state->conn);
 }
 
+static void
+teardown_data(struct test_state *state)
+{
+    lyd_free_siblings(state->tree);
+    state->tree = NULL;
+    teardown_empty(state);
+}
+
+static void
+teardown_subscribe_data(struct test_state *state)
+{
+    unsubscribe_subs(state);
+    teardown_data(state);
+}
+
+static void
+teardown_subscribe_running(struct test_state *state)
+{
+    unsubscribe_subs(state);
+    teardown_running(state);
+}
+
+static void
+teardown_subscribe_rpc_proc(struct test_state *state)
+{
+    int wstatus;
+
+    /* stop the subscriber */
+    if (write(state->sub_pipe, "q", 1) == 1) {
+        waitpid(state->sub_pid, &wstatus, 0);
+    }
+    close(state->sub_pipe);
+    teardown_data(state);
+}
+
+static void
+teardown_subscribe_oper_merge(struct test_state *state)
+{
+    sr_session_switch_ds(state->sess, SR_DS_RUNNING);
+    unsubscribe_subs(state);
+    teardown_empty(state);
+}
+
 static void
 teardown_subscribe_oper(struct test_state *state)
 {
@@ -672,6 +1051,50 @@ test_items_create(struct test_state *state, struct timespec *ts_start, struct ti
     return SR_ERR_OK;
 }
 
+static int
+test_items_create_batch(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    int r;
+    uint32_t i;
+    sr_edit_item_t *items;
+
+    items = calloc(state->count, sizeof *items);
+    for (i = 0; i < state->count; ++i) {
+        if ((asprintf((char **)&items[i].xpath, "/perf:cont/lst[k1='%" PRIu32 "'][k2='str%" PRIu32 "']/l", i, i) == -1) ||
+                (asprintf((char **)&items[i].value, "l%" PRIu32, i) == -1)) {
+            r = SR_ERR_NO_MEMORY;
+            goto cleanup;
+        }
+    }
+
+    TEST_START(ts_start);
+
+    if ((r = sr_set_items(state->sess, items, state->count, NULL, 0))) {
+        goto cleanup;
+    }
+
+    if ((r = sr_apply_changes(state->sess, state->count * 100))) {
+        goto cleanup;
+    }
+
+    TEST_END(ts_end);
+
+    if ((r = sr_delete_item(state->sess, "/perf:cont/lst", 0))) {
+        goto cleanup;
+    }
+    if ((r = sr_apply_changes(state->sess, state->count * 100))) {
+        goto cleanup;
+    }
+
+cleanup:
+    for (i = 0; i < state->count; ++i) {
+        free((char *)items[i].xpath);
+        free((char *)items[i].value);
+    }
+    free(items);
+    return r;
+}
+
 static int
 test_items_create_oper(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
 {
@@ -826,6 +1249,124 @@ test_item_remove(struct test_state *state, struct timespec *ts_start, struct tim
     return SR_ERR_OK;
 }
 
+static int
+test_item_modify_subs(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    int r;
+    char path[64], l_val[32];
+
+    /* always a different value so that the subscribers are notified */
+    sprintf(path, "/perf:cont/lst[k1='%" PRIu32 "'][k2='str%" PRIu32 "']/l", state->count / 2, state->count / 2);
+    sprintf(l_val, "l-new%" PRIu32, state->iter++);
+
+    TEST_START(ts_start);
+
+    if ((r = sr_set_item_str(state->sess, path, l_val, NULL, 0))) {
+        return r;
+    }
+    if ((r = sr_apply_changes(state->sess, 0))) {
+        return r;
+    }
+
+    TEST_END(ts_end);
+
+    return SR_ERR_OK;
+}
+
+static int
+test_rpc(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    int r;
+    sr_data_t *output;
+
+    TEST_START(ts_start);
+
+    if ((r = sr_rpc_send_tree(state->sess, state->tree, 0, &output))) {
+        return r;
+    }
+
+    TEST_END(ts_end);
+
+    sr_release_data(output);
+
+    return SR_ERR_OK;
+}
+
+static int
+test_notif(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    int r;
+
+    TEST_START(ts_start);
+
+    /* wait until all the subscribers process the notification */
+    if ((r = sr_notif_send_tree(state->sess, state->tree, 0, 1))) {
+        return r;
+    }
+
+    TEST_END(ts_end);
+
+    return SR_ERR_OK;
+}
+
+static int
+test_lyb_data(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    char *lyb;
+    struct lyd_node *tree;
+
+    /* the same work as when the oper data are passed from a provider */
+    TEST_START(ts_start);
+
+    if (lyd_print_mem(&lyb, state->tree, LYD_LYB, LYD_PRINT_WITHSIBLINGS)) {
+        return SR_ERR_LY;
+    }
+    if (lyd_parse_data_mem(state->mod->ctx, lyb, LYD_LYB, LYD_PARSE_STORE_ONLY | LYD_PARSE_STRICT, 0, &tree)) {
+        free(lyb);
+        return SR_ERR_LY;
+    }
+
+    TEST_END(ts_end);
+
+    free(lyb);
+    lyd_free_siblings(tree);
+
+    return SR_ERR_OK;
+}
+
+static int
+test_lyb_rpc(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    char *lyb;
+    struct ly_in *in;
+    struct lyd_node *tree;
+    LY_ERR lyrc;
+
+    /* the same work as when the RPC input is passed to a subscriber */
+    TEST_START(ts_start);
+
+    if (lyd_print_mem(&lyb, state->tree, LYD_LYB, 0)) {
+        return SR_ERR_LY;
+    }
+    if (ly_in_new_memory(lyb, &in)) {
+        free(lyb);
+        return SR_ERR_LY;
+    }
+    lyrc = lyd_parse_op(state->mod->ctx, NULL, in, LYD_LYB, LYD_TYPE_RPC_YANG, &tree, NULL);
+    ly_in_free(in, 0);
+    if (lyrc) {
+        free(lyb);
+        return SR_ERR_LY;
+    }
+
+    TEST_END(ts_end);
+
+    free(lyb);
+    lyd_free_tree(tree);
+
+    return SR_ERR_OK;
+}
+
 static int
 sysrepo_init(const char *plg_name, struct test_state *state, uint32_t count)
 {
@@ -911,9 +1452,12 @@ struct test tests[] = {
     {"get tree hash cached", setup_running_cached, test_get_tree_hash, teardown_running},
     {"get user ordered tree", setup_userordered_running, test_get_user_order_tree, teardown_running},
     {"get oper tree", setup_subscribe_oper, test_get_oper_tree, teardown_subscribe_oper},
+    {"get oper tree 4 providers", setup_subscribe_oper_merge, test_get_oper_tree, teardown_subscribe_oper_merge},
+    {"oper data lyb print and parse", setup_oper_data, test_lyb_data, teardown_data},
     {"create batch", setup_empty, test_batch_create, teardown_empty},
     {"create user ordered items", setup_empty, test_user_order_items_create, teardown_empty},
     {"create all items", setup_empty, test_items_create, teardown_empty},
+    {"create all items batch", setup_empty, test_items_create_batch, teardown_empty},
     {"create all items oper", setup_empty_oper, test_items_create_oper, teardown_empty},
     {"remove all items", setup_running, test_items_remove, teardown_empty},
     {"remove all items cached", setup_running_cached, test_items_remove, teardown_empty},
@@ -924,6 +1468,12 @@ struct test tests[] = {
     {"modify an item cached", setup_running_cached, test_item_modify, teardown_running},
     {"remove an item", setup_running, test_item_remove, teardown_running},
     {"remove an item cached", setup_running_cached, test_item_remove, teardown_running},
+    {"modify an item 4 subs", setup_subscribe_change, test_item_modify_subs, teardown_subscribe_running},
+    {"modify an item 4 priorities", setup_subscribe_change_prio, test_item_modify_subs, teardown_subscribe_running},
+    {"send rpc", setup_subscribe_rpc, test_rpc, teardown_subscribe_data},
+    {"send rpc other process", setup_subscribe_rpc_proc, test_rpc, teardown_subscribe_rpc_proc},
+    {"rpc input lyb print and parse", setup_rpc, test_lyb_rpc, teardown_data},
+    {"send notif 4 subs", setup_subscribe_notif, test_notif, teardown_subscribe_data},
 };
 
 void
@@ -1018,57 +1568,314 @@ print_bottom_table_boundary()
     printf("|\n\n");
 }
 
+/**
+ * @brief Output formats.
+ */
+enum output_format {
+    OUT_TABLE = 0,  /**< human-readable table */
+    OUT_CSV,        /**< CSV, one line per test, usable as a baseline */
+    OUT_JSON        /**< JSON array, one object per test */
+};
+
+/**
+ * @brief Statistics of repeated runs of a test, in usec.
+ */
+struct test_stats {
+    int64_t mean;
+    int64_t median;
+    int64_t min;
+    int64_t max;
+    int64_t stddev;
+};
+
+/**
+ * @brief Baseline time of a test.
+ */
+struct baseline {
+    char *plugin;
+    char *test;
+    int64_t mean;
+};
+
+static int
+time_cmp(const void *ptr1, const void *ptr2)
+{
+    int64_t time1 = *(const int64_t *)ptr1, time2 = *(const int64_t *)ptr2;
+
+    return (time1 > time2) - (time1 < time2);
+}
+
+/**
+ * @brief Compute statistics of the times of repeated runs.
+ *
+ * @param[in,out] times Times of all the runs, are sorted.
+ * @param[in] runs Number of runs.
+ * @param[out] stats Computed statistics.
+ */
+static void
+compute_stats(int64_t *times, uint32_t runs, struct test_stats *stats)
+{
+    uint32_t i;
+    int64_t sum = 0;
+    uint64_t var = 0, sq, prev;
+
+    qsort(times, runs, sizeof *times, time_cmp);
+
+    for (i = 0; i < runs; ++i) {
+        sum += times[i];
+    }
+    stats->mean = sum / runs;
+    stats->median = (runs % 2) ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+    stats->min = times[0];
+    stats->max = times[runs - 1];
+
+    for (i = 0; i < runs; ++i) {
+        var += (uint64_t)((times[i] - stats->mean) * (times[i] - stats->mean));
+    }
+    var /= runs;
+
+    /* integer square root */
+    sq = var;
+    prev = 0;
+    while (sq && (sq != prev) && (sq * sq > var)) {
+        prev = sq;
+        sq = (sq + var / sq) / 2;
+    }
+    stats->stddev = (int64_t)sq;
+}
+
+/**
+ * @brief Load a baseline from a CSV file previously printed by this tool.
+ *
+ * @param[in] path Path to the CSV file.
+ * @param[out] bases Loaded baselines.
+ * @param[out] base_count Count of @p bases.
+ * @return SR ERR value.
+ */
+static int
+baseline_load(const char *path, struct baseline **bases, uint32_t *base_count)
+{
+    FILE *f;
+    char line[256], *plugin, *test, *mean, *ptr;
+    void *mem;
+    int ret = SR_ERR_OK;
+
+    *bases = NULL;
+    *base_count = 0;
+
+    if (!(f = fopen(path, "r"))) {
+        fprintf(stderr, "Failed to open baseline \"%s\".\n", path);
+        return SR_ERR_SYS;
+    }
+
+    while (fgets(line, sizeof line, f)) {
+        /* plugin,test,runs,mean_usec,... */
+        plugin = strtok_r(line, ",\n", &ptr);
+        test = strtok_r(NULL, ",\n", &ptr);
+        if (!test || !strtok_r(NULL, ",\n", &ptr) || !(mean = strtok_r(NULL, ",\n", &ptr))) {
+            continue;
+        }
+        if (!strcmp(plugin, "plugin")) {
+            /* header */
+            continue;
+        }
+
+        mem = realloc(*bases, (*base_count + 1) * sizeof **bases);
+        if (!mem) {
+            ret = SR_ERR_NO_MEMORY;
+            break;
+        }
+        *bases = mem;
+        (*bases)[*base_count].plugin = strdup(plugin);
+        (*bases)[*base_count].test = strdup(test);
+        (*bases)[*base_count].mean = strtoll(mean, NULL, 10);
+        ++(*base_count);
+    }
+
+    fclose(f);
+    return ret;
+}
+
+/**
+ * @brief Free baselines.
+ *
+ * @param[in] bases Baselines to free.
+ * @param[in] base_count Count of @p bases.
+ */
+static void
+baseline_free(struct baseline *bases, uint32_t base_count)
+{
+    uint32_t i;
+
+    for (i = 0; i < base_count; ++i) {
+        free(bases[i].plugin);
+        free(bases[i].test);
+    }
+    free(bases);
+}
+
+/**
+ * @brief Find the baseline of a test.
+ *
+ * @param[in] bases Baselines.
+ * @param[in] base_count Count of @p bases.
+ * @param[in] plg_name Plugin name.
+ * @param[in] test_name Test name.
+ * @return Found baseline, NULL if none.
+ */
+static const struct baseline *
+baseline_find(const struct baseline *bases, uint32_t base_count, const char *plg_name, const char *test_name)
+{
+    uint32_t i;
+
+    for (i = 0; i < base_count; ++i) {
+        if (!strcmp(bases[i].plugin, plg_name) && !strcmp(bases[i].test, test_name)) {
+            return &bases[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Print test results in a machine-readable format.
+ *
+ * @param[in] format Output format.
+ * @param[in] plg_name Plugin name.
+ * @param[in] test_name Test name.
+ * @param[in] runs Number of runs.
+ * @param[in] stats Statistics of the runs.
+ * @param[in] first Whether these are the first results printed.
+ */
+static void
+print_test_results_mr(enum output_format format, const char *plg_name, const char *test_name, uint32_t runs,
+        const struct test_stats *stats, int first)
+{
+    if (format == OUT_CSV) {
+        printf("%s,%s,%" PRIu32 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 "\n", plg_name,
+                test_name, runs, stats->mean, stats->median, stats->min, stats->max, stats->stddev);
+    } else {
+        printf("%s\n  {\"plugin\": \"%s\", \"test\": \"%s\", \"runs\": %" PRIu32 ", \"mean_usec\": %" PRId64
+                ", \"median_usec\": %" PRId64 ", \"min_usec\": %" PRId64 ", \"max_usec\": %" PRId64
+                ", \"stddev_usec\": %" PRId64 "}", first ? "" : ",", plg_name, test_name, runs, stats->mean,
+                stats->median, stats->min, stats->max, stats->stddev);
+    }
+}
+
+static void
+usage(const char *progname)
+{
+    fprintf(stderr, "Usage:\n%s [-f table|csv|json] [-r runs] [-b baseline-csv [-t threshold-percent]] "
+            "list-instance-count test-tries\n\n", progname);
+}
+
 int
 main(int argc, char **argv)
 {
-    int ret = 0;
-    uint32_t i, j, count, tries, plg_cnt, test_cnt;
-    const char *plg_name;
-    int64_t *times = NULL, time;
+    int ret = 0, opt, first = 1, regressions = 0;
+    uint32_t i, j, k, count, tries, runs = 1, threshold = 10, plg_cnt, test_cnt, base_count = 0;
+    const char *plg_name, *baseline_path = NULL;
+    int64_t *times = NULL, *run_times = NULL;
+    enum output_format format = OUT_TABLE;
+    struct baseline *bases = NULL;
+    const struct baseline *base;
+    struct test_stats stats;
     struct test_state state = {0};
 
-    /* change print color */
-    printf("\033[0;37;1m");
-
     /* handle arguments */
-    if (argc < 3) {
-        fprintf(stderr, "Usage:\n%s list-instance-count test-tries\n\n", argv[0]);
+    while ((opt = getopt(argc, argv, "f:r:b:t:")) != -1) {
+        switch (opt) {
+        case 'f':
+            if (!strcmp(optarg, "table")) {
+                format = OUT_TABLE;
+            } else if (!strcmp(optarg, "csv")) {
+                format = OUT_CSV;
+            } else if (!strcmp(optarg, "json")) {
+                format = OUT_JSON;
+            } else {
+                fprintf(stderr, "Invalid format \"%s\".\n", optarg);
+                return SR_ERR_INVAL_ARG;
+            }
+            break;
+        case 'r':
+            if (atoi(optarg) <= 0) {
+                fprintf(stderr, "Invalid runs \"%s\".\n", optarg);
+                return SR_ERR_INVAL_ARG;
+            }
+            runs = atoi(optarg);
+            break;
+        case 'b':
+            baseline_path = optarg;
+            break;
+        case 't':
+            if (atoi(optarg) < 0) {
+                fprintf(stderr, "Invalid threshold \"%s\".\n", optarg);
+                return SR_ERR_INVAL_ARG;
+            }
+            threshold = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return SR_ERR_INVAL_ARG;
+        }
+    }
+
+    if (argc - optind < 2) {
+        usage(argv[0]);
         return SR_ERR_INVAL_ARG;
     }
 
-    count = atoi(argv[1]);
+    count = atoi(argv[optind]);
     if (count <= 0) {
-        fprintf(stderr, "Invalid count \"%s\".\n", argv[1]);
+        fprintf(stderr, "Invalid count \"%s\".\n", argv[optind]);
         return SR_ERR_INVAL_ARG;
     }
 
-    tries = atoi(argv[2]);
+    tries = atoi(argv[optind + 1]);
     if (tries <= 0) {
-        fprintf(stderr, "Invalid tries \"%s\".\n", argv[2]);
+        fprintf(stderr, "Invalid tries \"%s\".\n", argv[optind + 1]);
         return SR_ERR_INVAL_ARG;
     }
 
+    if (baseline_path && (ret = baseline_load(baseline_path, &bases, &base_count))) {
+        goto cleanup;
+    }
+
     /* establish the number of plugins and tests */
     plg_cnt = sr_ds_plugin_int_count();
     test_cnt = (sizeof tests / sizeof(struct test));
 
-    /* allocate a time var for every test of the default plugin */
+    /* allocate a time var for every test of the default plugin and for every run */
     times = calloc(test_cnt, sizeof *times);
-    if (!times) {
+    run_times = calloc(runs, sizeof *run_times);
+    if (!times || !run_times) {
         fprintf(stderr, "Out of memory.\n");
-        return SR_ERR_NO_MEMORY;
+        ret = SR_ERR_NO_MEMORY;
+        goto cleanup;
     }
 
-    printf("\n| Options\n\n  Data set size      : %" PRIu32 "\n  Each test executed : %" PRIu32 " %s\n\n", count, tries,
-            (tries > 1) ? "times" : "time");
-    printf("\n| Performance tests\n");
+    if (format == OUT_TABLE) {
+        /* change print color */
+        printf("\033[0;37;1m");
+
+        printf("\n| Options\n\n  Data set size      : %" PRIu32 "\n  Each test executed : %" PRIu32 " %s\n", count,
+                tries, (tries > 1) ? "times" : "time");
+        printf("  Runs of each test  : %" PRIu32 "\n\n", runs);
+        printf("\n| Performance tests\n");
+    } else if (format == OUT_CSV) {
+        printf("plugin,test,runs,mean_usec,median_usec,min_usec,max_usec,stddev_usec\n");
+    } else {
+        printf("[");
+    }
 
     /* for every plugin run a set of tests */
     for (i = 0; i < plg_cnt; ++i) {
         /* plugin name */
         plg_name = sr_internal_ds_plugins[i]->name;
 
-        print_top_table_boundary(plg_name);
+        if (format == OUT_TABLE) {
+            print_top_table_boundary(plg_name);
+        }
 
         /* init */
         if ((ret = sysrepo_init(plg_name, &state, count))) {
@@ -1077,17 +1884,33 @@ main(int argc, char **argv)
 
         /* tests */
         for (j = 0; j < test_cnt; ++j) {
-            if ((ret = exec_test(tests[j].setup, tests[j].test, tests[j].teardown, tries, &time, &state))) {
-                /* one of the tests failed */
-                goto cleanup;
+            for (k = 0; k < runs; ++k) {
+                if ((ret = exec_test(tests[j].setup, tests[j].test, tests[j].teardown, tries, &run_times[k], &state))) {
+                    /* one of the tests failed */
+                    goto cleanup;
+                }
             }
+            compute_stats(run_times, runs, &stats);
 
             /* store defaults plugin times to calculate the differences */
             if (i == 0) {
-                times[j] = time;
+                times[j] = stats.mean;
             }
 
-            print_test_results(tests[j].name, time, times[j]);
+            if (format == OUT_TABLE) {
+                print_test_results(tests[j].name, stats.mean, times[j]);
+            } else {
+                print_test_results_mr(format, plg_name, tests[j].name, runs, &stats, first);
+                first = 0;
+            }
+
+            /* compare with the baseline */
+            base = baseline_find(bases, base_count, plg_name, tests[j].name);
+            if (base && (stats.mean * 100 > base->mean * (100 + threshold))) {
+                fprintf(stderr, "Regression: %s \"%s\" mean %" PRId64 " usec, baseline %" PRId64 " usec.\n", plg_name,
+                        tests[j].name, stats.mean, base->mean);
+                ++regressions;
+            }
         }
 
         /* destroy */
@@ -1095,15 +1918,28 @@ main(int argc, char **argv)
             goto cleanup;
         }
 
-        print_bottom_table_boundary();
+        if (format == OUT_TABLE) {
+            print_bottom_table_boundary();
+        }
     }
 
-    printf("\nAll comparisons refer to how many times faster (green) or slower (red) the current plugin is compared to the first plugin.\n\n");
+    if (format == OUT_TABLE) {
+        printf("\nAll comparisons refer to how many times faster (green) or slower (red) the current plugin is compared to the first plugin.\n\n");
 
-    /* change print color */
-    printf(" \033[0;37m");
+        /* change print color */
+        printf(" \033[0;37m");
+    } else if (format == OUT_JSON) {
+        printf("\n]\n");
+    }
+
+    if (regressions) {
+        fprintf(stderr, "%d test(s) slower than the baseline by more than %" PRIu32 " %%.\n", regressions, threshold);
+        ret = SR_ERR_OPERATION_FAILED;
+    }
 
 cleanup:
     free(times);
+    free(run_times);
+    baseline_free(bases, base_count);
     return ret;
 }
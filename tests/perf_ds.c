@@ -0,0 +1,614 @@
+/**
+ * @file perf_ds.c
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief datastore plugin performance tests
+ *
+ * Copyright (c) 2024 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#include "common.h"
+#include "common_types.h"
+#include "config.h"
+#include "plugins_datastore.h"
+#include "sysrepo.h"
+#include "tests/tcommon.h"
+
+#define BILLION 1000000000
+
+/**
+ * @brief Tested dataset types.
+ */
+enum dataset_type {
+    DSET_FLAT = 0,  /**< flat list */
+    DSET_DEEP,      /**< nested lists */
+    DSET_ORDERED,   /**< user-ordered list */
+    DSET_COUNT
+};
+
+static const char *dataset_names[DSET_COUNT] = {"flat list", "deep tree", "user-ordered list"};
+
+/**
+ * @brief Test state structure.
+ */
+struct test_state {
+    const struct lys_module *mod;
+    const struct srplg_ds_s *plugin;
+    void *plg_data;
+    uint32_t count;
+    uint32_t tries;
+    uint64_t *lats;
+};
+
+/**
+ * @brief Get current time as timespec.
+ *
+ * @param[out] ts Timespec to fill.
+ */
+static void
+time_get(struct timespec *ts)
+{
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime(CLOCK_MONOTONIC_RAW, ts);
+#elif defined (CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, ts);
+#elif defined (CLOCK_REALTIME)
+    /* no monotonic clock available, return realtime */
+    clock_gettime(CLOCK_REALTIME, ts);
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    ts->tv_sec = (time_t)tv.tv_sec;
+    ts->tv_nsec = 1000L * (long)tv.tv_usec;
+#endif
+}
+
+/**
+ * @brief Get the difference of 2 timespecs in nanoseconds.
+ *
+ * @param[in] ts1 Smaller (older) timespec.
+ * @param[in] ts2 Larger (later) timespec.
+ * @return Difference of timespecs in nsec.
+ */
+static uint64_t
+time_diff(const struct timespec *ts1, const struct timespec *ts2)
+{
+    return (uint64_t)(ts2->tv_sec - ts1->tv_sec) * BILLION + ts2->tv_nsec - ts1->tv_nsec;
+}
+
+/**
+ * @brief Get the number of bytes written by this process so far.
+ *
+ * Includes all the bytes passed to write syscalls, so also the data sent to a database server.
+ *
+ * @return Written bytes, UINT64_MAX if not known.
+ */
+static uint64_t
+written_bytes(void)
+{
+    FILE *f;
+    char line[128];
+    uint64_t wchar = UINT64_MAX;
+
+    if (!(f = fopen("/proc/self/io", "r"))) {
+        return UINT64_MAX;
+    }
+
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, "wchar: %" SCNu64, &wchar) == 1) {
+            break;
+        }
+    }
+
+    fclose(f);
+    return wchar;
+}
+
+/**
+ * @brief Print a plugin error and free it.
+ *
+ * @param[in] err_info Error info to print.
+ * @param[in] op Failed operation.
+ * @return SR ERR value of the error.
+ */
+static int
+plugin_err(sr_error_info_t *err_info, const char *op)
+{
+    int ret;
+
+    ret = err_info->err[0].err_code;
+    fprintf(stderr, "Plugin callback \"%s\" failed (%s).\n", op, err_info->err[0].message);
+    sr_errinfo_free(&err_info);
+    return ret;
+}
+
+/**
+ * @brief Get the path of a leaf of a dataset instance.
+ *
+ * @param[in] dset Dataset type.
+ * @param[in] i Instance index.
+ * @param[out] path Path buffer to fill.
+ */
+static void
+dataset_path(enum dataset_type dset, uint32_t i, char *path)
+{
+    switch (dset) {
+    case DSET_FLAT:
+        sprintf(path, "/perf-ds:flat/lst[k='%" PRIu32 "']/l", i);
+        break;
+    case DSET_DEEP:
+        /* 10 instances on the first 2 levels, the rest on the last level */
+        sprintf(path, "/perf-ds:deep/a[k='%" PRIu32 "']/b/c[k='%" PRIu32 "']/d/e[k='%" PRIu32 "']/v", i % 10,
+                (i / 10) % 10, i / 100);
+        break;
+    case DSET_ORDERED:
+        sprintf(path, "/perf-ds:ordered/lst[k='%" PRIu32 "']/l", i);
+        break;
+    case DSET_COUNT:
+        break;
+    }
+}
+
+/**
+ * @brief Create data of a dataset.
+ *
+ * @param[in] state Test state.
+ * @param[in] dset Dataset type.
+ * @param[out] data Created data.
+ * @return SR ERR value.
+ */
+static int
+dataset_create(struct test_state *state, enum dataset_type dset, struct lyd_node **data)
+{
+    uint32_t i;
+    char path[128], val[32];
+
+    *data = NULL;
+    for (i = 0; i < state->count; ++i) {
+        dataset_path(dset, i, path);
+        sprintf(val, "val%" PRIu32, i);
+        if (lyd_new_path(*data, state->mod->ctx, path, val, 0, *data ? NULL : data)) {
+            return SR_ERR_LY;
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Create modified data of a dataset and the diff from the current data, as if an edit was applied.
+ *
+ * Changes every 100th value and in the user-ordered list also moves the last instance to the beginning.
+ *
+ * @param[in] state Test state.
+ * @param[in] dset Dataset type.
+ * @param[in] data Current data.
+ * @param[in] iter Modification iteration, for unique values.
+ * @param[out] new_data New data.
+ * @param[out] diff Diff of @p data and @p new_data.
+ * @return SR ERR value.
+ */
+static int
+dataset_modify(struct test_state *state, enum dataset_type dset, const struct lyd_node *data, uint32_t iter,
+        struct lyd_node **new_data, struct lyd_node **diff)
+{
+    uint32_t i;
+    char path[128], val[32];
+    struct lyd_node *first, *last;
+
+    *new_data = NULL;
+    *diff = NULL;
+
+    if (lyd_dup_siblings(data, NULL, LYD_DUP_RECURSIVE, new_data)) {
+        return SR_ERR_LY;
+    }
+
+    for (i = 0; i < state->count; i += 100) {
+        dataset_path(dset, i, path);
+        sprintf(val, "new%" PRIu32 "-%" PRIu32, iter, i);
+        if (lyd_new_path(*new_data, NULL, path, val, LYD_NEW_PATH_UPDATE, NULL)) {
+            return SR_ERR_LY;
+        }
+    }
+
+    if ((dset == DSET_ORDERED) && (state->count > 1)) {
+        first = lyd_child(*new_data);
+        last = first->prev;
+        if (lyd_insert_before(first, last)) {
+            return SR_ERR_LY;
+        }
+    }
+
+    if (lyd_diff_siblings(data, *new_data, 0, diff)) {
+        return SR_ERR_LY;
+    }
+
+    return SR_ERR_OK;
+}
+
+static int
+lat_cmp(const void *ptr1, const void *ptr2)
+{
+    uint64_t lat1 = *(const uint64_t *)ptr1, lat2 = *(const uint64_t *)ptr2;
+
+    return (lat1 > lat2) - (lat1 < lat2);
+}
+
+/**
+ * @brief Print a latency in usec.
+ *
+ * @param[in] lat Latency in nsec.
+ */
+static void
+print_lat(uint64_t lat)
+{
+    printf(" %9" PRIu64 ".%01" PRIu64 " |", lat / 1000, (lat % 1000) / 100);
+}
+
+/**
+ * @brief Print the results of an operation.
+ *
+ * @param[in] state Test state with the latencies of all the tries.
+ * @param[in] dset Dataset type.
+ * @param[in] op Operation name.
+ * @param[in] bytes Bytes written by all the tries, UINT64_MAX if not known.
+ */
+static void
+print_results(struct test_state *state, enum dataset_type dset, const char *op, uint64_t bytes)
+{
+    uint64_t total = 0;
+    uint32_t i;
+
+    for (i = 0; i < state->tries; ++i) {
+        total += state->lats[i];
+    }
+    qsort(state->lats, state->tries, sizeof *state->lats, lat_cmp);
+
+    printf("| %-17s | %-14s | %10" PRIu64 " |", dataset_names[dset], op,
+            (uint64_t)state->tries * BILLION / (total ? total : 1));
+    print_lat(state->lats[(state->tries - 1) / 2]);
+    print_lat(state->lats[((uint64_t)state->tries - 1) * 99 / 100]);
+    print_lat(state->lats[state->tries - 1]);
+    if (bytes == UINT64_MAX) {
+        printf(" %12s |\n", "-");
+    } else {
+        printf(" %12" PRIu64 " |\n", bytes / state->tries);
+    }
+}
+
+/**
+ * @brief Run all the operations on a dataset.
+ *
+ * @param[in] state Test state.
+ * @param[in] dset Dataset type.
+ * @return SR ERR value.
+ */
+static int
+test_dataset(struct test_state *state, enum dataset_type dset)
+{
+    int ret = SR_ERR_OK;
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *data = NULL, *new_data = NULL, *diff = NULL, *rem_diff = NULL, *loaded;
+    struct timespec ts_start, ts_end, mtime;
+    uint64_t bytes;
+    uint32_t i, version;
+
+    if ((ret = dataset_create(state, dset, &data))) {
+        goto cleanup;
+    }
+    if (lyd_diff_siblings(NULL, data, 0, &diff) || lyd_diff_siblings(data, NULL, 0, &rem_diff)) {
+        ret = SR_ERR_LY;
+        goto cleanup;
+    }
+
+    /* store all the data into an empty datastore */
+    bytes = 0;
+    for (i = 0; i < state->tries; ++i) {
+        bytes -= written_bytes();
+        time_get(&ts_start);
+        err_info = state->plugin->store_cb(state->mod, SR_DS_RUNNING, diff, data, state->plg_data);
+        time_get(&ts_end);
+        bytes += written_bytes();
+        if (err_info) {
+            ret = plugin_err(err_info, "store");
+            goto cleanup;
+        }
+        state->lats[i] = time_diff(&ts_start, &ts_end);
+
+        /* remove the data again, not measured */
+        if ((i < state->tries - 1) &&
+                (err_info = state->plugin->store_cb(state->mod, SR_DS_RUNNING, rem_diff, NULL, state->plg_data))) {
+            ret = plugin_err(err_info, "store");
+            goto cleanup;
+        }
+    }
+    print_results(state, dset, "store all", (written_bytes() == UINT64_MAX) ? UINT64_MAX : bytes);
+
+    /* store changes of the data */
+    bytes = 0;
+    for (i = 0; i < state->tries; ++i) {
+        lyd_free_siblings(diff);
+        if ((ret = dataset_modify(state, dset, data, i, &new_data, &diff))) {
+            goto cleanup;
+        }
+
+        bytes -= written_bytes();
+        time_get(&ts_start);
+        err_info = state->plugin->store_cb(state->mod, SR_DS_RUNNING, diff, new_data, state->plg_data);
+        time_get(&ts_end);
+        bytes += written_bytes();
+        if (err_info) {
+            ret = plugin_err(err_info, "store");
+            goto cleanup;
+        }
+        state->lats[i] = time_diff(&ts_start, &ts_end);
+
+        lyd_free_siblings(data);
+        data = new_data;
+        new_data = NULL;
+    }
+    print_results(state, dset, "store changes", (written_bytes() == UINT64_MAX) ? UINT64_MAX : bytes);
+
+    /* load the data */
+    for (i = 0; i < state->tries; ++i) {
+        time_get(&ts_start);
+        err_info = state->plugin->load_cb(state->mod, SR_DS_RUNNING, NULL, 0, state->plg_data, &loaded);
+        time_get(&ts_end);
+        if (err_info) {
+            ret = plugin_err(err_info, "load");
+            goto cleanup;
+        }
+        state->lats[i] = time_diff(&ts_start, &ts_end);
+        lyd_free_siblings(loaded);
+    }
+    print_results(state, dset, "load", 0);
+
+    /* copy the data into startup */
+    bytes = 0;
+    for (i = 0; i < state->tries; ++i) {
+        bytes -= written_bytes();
+        time_get(&ts_start);
+        err_info = state->plugin->copy_cb(state->mod, SR_DS_STARTUP, SR_DS_RUNNING, state->plg_data);
+        time_get(&ts_end);
+        bytes += written_bytes();
+        if (err_info) {
+            ret = plugin_err(err_info, "copy");
+            goto cleanup;
+        }
+        state->lats[i] = time_diff(&ts_start, &ts_end);
+    }
+    print_results(state, dset, "copy", (written_bytes() == UINT64_MAX) ? UINT64_MAX : bytes);
+
+    /* get the last modification */
+    for (i = 0; i < state->tries; ++i) {
+        time_get(&ts_start);
+        err_info = state->plugin->last_modif_cb(state->mod, SR_DS_RUNNING, state->plg_data, &mtime);
+        time_get(&ts_end);
+        if (err_info) {
+            ret = plugin_err(err_info, "last_modif");
+            goto cleanup;
+        }
+        state->lats[i] = time_diff(&ts_start, &ts_end);
+    }
+    print_results(state, dset, "last modif", 0);
+
+    /* get the data version, optional */
+    if (state->plugin->data_version_cb) {
+        for (i = 0; i < state->tries; ++i) {
+            time_get(&ts_start);
+            err_info = state->plugin->data_version_cb(state->mod, SR_DS_RUNNING, state->plg_data, &version);
+            time_get(&ts_end);
+            if (err_info) {
+                ret = plugin_err(err_info, "data_version");
+                goto cleanup;
+            }
+            state->lats[i] = time_diff(&ts_start, &ts_end);
+        }
+        print_results(state, dset, "data version", 0);
+    }
+
+    /* remove the data */
+    lyd_free_siblings(rem_diff);
+    if (lyd_diff_siblings(data, NULL, 0, &rem_diff)) {
+        ret = SR_ERR_LY;
+        goto cleanup;
+    }
+    if ((err_info = state->plugin->store_cb(state->mod, SR_DS_RUNNING, rem_diff, NULL, state->plg_data))) {
+        ret = plugin_err(err_info, "store");
+        goto cleanup;
+    }
+
+cleanup:
+    lyd_free_siblings(data);
+    lyd_free_siblings(new_data);
+    lyd_free_siblings(diff);
+    lyd_free_siblings(rem_diff);
+    return ret;
+}
+
+/**
+ * @brief Install the test module using a DS plugin.
+ *
+ * @param[in] plg_name DS plugin name.
+ * @return SR ERR value.
+ */
+static int
+sysrepo_init(const char *plg_name)
+{
+    int ret, i;
+    sr_conn_ctx_t *conn;
+    sr_module_ds_t mod_ds;
+
+    for (i = 0; i < 5; ++i) {
+        mod_ds.plugin_name[i] = plg_name;
+    }
+    mod_ds.plugin_name[5] = "JSON notif";
+
+    /* setup env */
+    if ((ret = setenv("SYSREPO_REPOSITORY_PATH", TESTS_REPO_DIR "/test_repositories/sr_perf_ds", 1))) {
+        return ret;
+    }
+    if ((ret = setenv("SYSREPO_SHM_PREFIX", "_tests_sr_sr_perf_ds", 1))) {
+        return ret;
+    }
+
+    sr_log_stderr(SR_LL_WRN);
+
+    if ((ret = sr_connect(SR_CONN_DEFAULT, &conn))) {
+        return ret;
+    }
+
+    /* remove module if it was installed previously */
+    sr_log_stderr(SR_LL_NONE);
+    ret = sr_remove_module(conn, "perf-ds", 1);
+    sr_log_stderr(SR_LL_WRN);
+    if (ret && (ret != SR_ERR_NOT_FOUND)) {
+        sr_disconnect(conn);
+        return ret;
+    }
+
+    /* install module */
+    ret = sr_install_module2(conn, TESTS_SRC_DIR "/files/perf-ds.yang", NULL, NULL, &mod_ds, NULL, NULL, 0, NULL,
+            NULL, LYD_XML);
+    sr_disconnect(conn);
+    return ret;
+}
+
+/**
+ * @brief Remove the test module.
+ *
+ * @return SR ERR value.
+ */
+static int
+sysrepo_destroy(void)
+{
+    int ret;
+    sr_conn_ctx_t *conn;
+
+    if ((ret = sr_connect(SR_CONN_DEFAULT, &conn))) {
+        return ret;
+    }
+
+    ret = sr_remove_module(conn, "perf-ds", 0);
+    sr_disconnect(conn);
+    return ret;
+}
+
+/**
+ * @brief Run all the datasets with a DS plugin.
+ *
+ * @param[in] state Test state.
+ * @param[in] plg_name DS plugin name.
+ * @return SR ERR value.
+ */
+static int
+test_plugin(struct test_state *state, const char *plg_name)
+{
+    int ret;
+    sr_error_info_t *err_info;
+    sr_conn_ctx_t *conn = NULL;
+    const struct sr_ds_handle_s *ds_handle;
+    uint32_t dset;
+
+    if ((ret = sysrepo_init(plg_name))) {
+        return ret;
+    }
+
+    /* the connection initializes the plugin data of the installed module */
+    if ((ret = sr_connect(SR_CONN_DEFAULT, &conn))) {
+        goto cleanup;
+    }
+    if ((err_info = sr_ds_handle_find(plg_name, conn, &ds_handle))) {
+        ret = plugin_err(err_info, "conn_init");
+        goto cleanup;
+    }
+    state->plugin = ds_handle->plugin;
+    state->plg_data = ds_handle->plg_data;
+    state->mod = ly_ctx_get_module_implemented(sr_acquire_context(conn), "perf-ds");
+
+    printf("\n  %s\n\n", plg_name);
+    printf("| dataset           | operation      |      ops/s |    p50 usec |    p99 usec |    max usec |"
+            " bytes per op |\n");
+    printf("|-------------------|----------------|------------|-------------|-------------|-------------|"
+            "--------------|\n");
+
+    for (dset = 0; dset < DSET_COUNT; ++dset) {
+        if ((ret = test_dataset(state, dset))) {
+            break;
+        }
+    }
+
+    sr_release_context(conn);
+
+cleanup:
+    sr_disconnect(conn);
+    if (sysrepo_destroy() && !ret) {
+        ret = SR_ERR_INTERNAL;
+    }
+    return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret = 0;
+    uint32_t i;
+    struct test_state state = {0};
+
+    /* handle arguments */
+    if (argc < 3) {
+        fprintf(stderr, "Usage:\n%s list-instance-count test-tries\n\n", argv[0]);
+        return SR_ERR_INVAL_ARG;
+    }
+
+    if (atoi(argv[1]) <= 0) {
+        fprintf(stderr, "Invalid count \"%s\".\n", argv[1]);
+        return SR_ERR_INVAL_ARG;
+    }
+    state.count = atoi(argv[1]);
+
+    if (atoi(argv[2]) <= 0) {
+        fprintf(stderr, "Invalid tries \"%s\".\n", argv[2]);
+        return SR_ERR_INVAL_ARG;
+    }
+    state.tries = atoi(argv[2]);
+
+    state.lats = malloc(state.tries * sizeof *state.lats);
+    if (!state.lats) {
+        fprintf(stderr, "Out of memory.\n");
+        return SR_ERR_NO_MEMORY;
+    }
+
+    printf("\n| Options\n\n  Data set size      : %" PRIu32 "\n  Each test executed : %" PRIu32 " %s\n\n", state.count,
+            state.tries, (state.tries > 1) ? "times" : "time");
+    printf("\n| Datastore plugin tests\n");
+
+    /* run the tests for every internal plugin */
+    for (i = 0; i < sr_ds_plugin_int_count(); ++i) {
+        if ((ret = test_plugin(&state, sr_internal_ds_plugins[i]->name))) {
+            break;
+        }
+    }
+    printf("\n");
+
+    free(state.lats);
+    return ret;
+}
@@ -0,0 +1,704 @@
+/**
+ * @file perf_scale.c
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief multi-process multi-threaded scaling performance tests
+ *
+ * Copyright (c) 2024 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libyang/libyang.h>
+
+#include "sysrepo.h"
+#include "tests/tcommon.h"
+
+#define BILLION 1000000000
+
+/**
+ * @brief Operation types of the mixed workload.
+ */
+enum op_type {
+    OP_GET = 0,
+    OP_APPLY,
+    OP_RPC,
+    OP_NOTIF,
+    OP_COUNT
+};
+
+static const char *op_names[OP_COUNT] = {"get", "apply changes", "rpc", "notify"};
+
+/**
+ * @brief Get the operation type of an operation of a worker thread.
+ *
+ * Operations are interleaved so that all the types are executed concurrently by the threads.
+ */
+#define OP_TYPE(proc_id, thread_id, op_idx) (((proc_id) + (thread_id) + (op_idx)) % OP_COUNT)
+
+/**
+ * @brief Worker thread structure.
+ */
+struct worker_thread {
+    pthread_t tid;
+    sr_conn_ctx_t *conn;
+    uint32_t proc_id;
+    uint32_t thread_id;
+    uint32_t op_count;
+    uint64_t *lats;         /**< latencies of all the operations in nsec, shared with the main process */
+    int ret;
+};
+
+/**
+ * @brief Get current time as timespec.
+ *
+ * @param[out] ts Timespec to fill.
+ */
+static void
+time_get(struct timespec *ts)
+{
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime(CLOCK_MONOTONIC_RAW, ts);
+#elif defined (CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, ts);
+#elif defined (CLOCK_REALTIME)
+    /* no monotonic clock available, return realtime */
+    clock_gettime(CLOCK_REALTIME, ts);
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    ts->tv_sec = (time_t)tv.tv_sec;
+    ts->tv_nsec = 1000L * (long)tv.tv_usec;
+#endif
+}
+
+/**
+ * @brief Get the difference of 2 timespecs in nanoseconds.
+ *
+ * @param[in] ts1 Smaller (older) timespec.
+ * @param[in] ts2 Larger (later) timespec.
+ * @return Difference of timespecs in nsec.
+ */
+static uint64_t
+time_diff(const struct timespec *ts1, const struct timespec *ts2)
+{
+    return (uint64_t)(ts2->tv_sec - ts1->tv_sec) * BILLION + ts2->tv_nsec - ts1->tv_nsec;
+}
+
+/**
+ * @brief Read a number of synchronization bytes from a pipe.
+ *
+ * @param[in] fd Pipe read end.
+ * @param[in] count Number of bytes to read.
+ * @return 0 on success, -1 on error.
+ */
+static int
+pipe_read(int fd, uint32_t count)
+{
+    char buf[64];
+    ssize_t r;
+
+    while (count) {
+        r = read(fd, buf, (count < sizeof buf) ? count : sizeof buf);
+        if (r <= 0) {
+            if ((r == -1) && (errno == EINTR)) {
+                continue;
+            }
+            return -1;
+        }
+        count -= r;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Write a number of synchronization bytes into a pipe.
+ *
+ * @param[in] fd Pipe write end.
+ * @param[in] count Number of bytes to write.
+ * @return 0 on success, -1 on error.
+ */
+static int
+pipe_write(int fd, uint32_t count)
+{
+    char buf[64] = {0};
+    ssize_t r;
+
+    while (count) {
+        r = write(fd, buf, (count < sizeof buf) ? count : sizeof buf);
+        if (r <= 0) {
+            if ((r == -1) && (errno == EINTR)) {
+                continue;
+            }
+            return -1;
+        }
+        count -= r;
+    }
+
+    return 0;
+}
+
+static int
+module_change_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+static int
+rpc_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *xpath, const sr_val_t *input, const size_t input_cnt,
+        sr_event_t event, uint32_t request_id, sr_val_t **output, size_t *output_cnt, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)xpath;
+    (void)input;
+    (void)input_cnt;
+    (void)event;
+    (void)request_id;
+    (void)output;
+    (void)output_cnt;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+static void
+notif_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type, const char *xpath,
+        const sr_val_t *values, const size_t values_cnt, struct timespec *timestamp, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)notif_type;
+    (void)xpath;
+    (void)values;
+    (void)values_cnt;
+    (void)timestamp;
+    (void)private_data;
+}
+
+/**
+ * @brief Subscriber process handling the changes, RPCs, and notifications of all the workers.
+ *
+ * @param[in] ready_fd Pipe to announce the subscriptions are ready.
+ * @param[in] quit_fd Pipe to wait on for the end of the tests.
+ * @return SR ERR value.
+ */
+static int
+subscriber_proc(int ready_fd, int quit_fd)
+{
+    int ret;
+    sr_conn_ctx_t *conn = NULL;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *sub = NULL;
+
+    if ((ret = sr_connect(0, &conn))) {
+        goto cleanup;
+    }
+    if ((ret = sr_session_start(conn, SR_DS_RUNNING, &sess))) {
+        goto cleanup;
+    }
+
+    /* subscribe to everything the workers do */
+    if ((ret = sr_module_change_subscribe(sess, "perf-scale", NULL, module_change_cb, NULL, 0, 0, &sub))) {
+        goto cleanup;
+    }
+    if ((ret = sr_rpc_subscribe(sess, "/perf-scale:rpc", rpc_cb, NULL, 0, 0, &sub))) {
+        goto cleanup;
+    }
+    if ((ret = sr_notif_subscribe(sess, "perf-scale", NULL, NULL, NULL, notif_cb, NULL, 0, &sub))) {
+        goto cleanup;
+    }
+
+    /* ready, wait for the end */
+    if (pipe_write(ready_fd, 1) || pipe_read(quit_fd, 1)) {
+        ret = SR_ERR_SYS;
+        goto cleanup;
+    }
+
+cleanup:
+    sr_unsubscribe(sub);
+    sr_disconnect(conn);
+    return ret;
+}
+
+/**
+ * @brief Worker thread executing the mixed workload.
+ *
+ * @param[in] arg Worker thread structure.
+ * @return NULL.
+ */
+static void *
+worker_thread(void *arg)
+{
+    struct worker_thread *wt = arg;
+    sr_session_ctx_t *sess = NULL;
+    sr_data_t *data;
+    sr_val_t val = {0}, *output;
+    size_t output_cnt;
+    struct timespec ts_start, ts_end;
+    char path[128], str[32];
+    uint32_t i;
+    int ret;
+
+    if ((ret = sr_session_start(wt->conn, SR_DS_RUNNING, &sess))) {
+        goto cleanup;
+    }
+
+    /* every thread changes its own list instance */
+    sprintf(path, "/perf-scale:cont/lst[k='p%" PRIu32 "t%" PRIu32 "']/l", wt->proc_id, wt->thread_id);
+    val.type = SR_STRING_T;
+    val.data.string_val = str;
+
+    for (i = 0; i < wt->op_count; ++i) {
+        sprintf(str, "val%" PRIu32, i);
+        data = NULL;
+        output = NULL;
+        output_cnt = 0;
+
+        time_get(&ts_start);
+        switch (OP_TYPE(wt->proc_id, wt->thread_id, i)) {
+        case OP_GET:
+            ret = sr_get_data(sess, "/perf-scale:cont", 0, 0, 0, &data);
+            sr_release_data(data);
+            break;
+        case OP_APPLY:
+            if (!(ret = sr_set_item_str(sess, path, str, NULL, 0))) {
+                ret = sr_apply_changes(sess, 0);
+            }
+            break;
+        case OP_RPC:
+            val.xpath = (char *)"/perf-scale:rpc/l";
+            ret = sr_rpc_send(sess, "/perf-scale:rpc", &val, 1, 0, &output, &output_cnt);
+            sr_free_values(output, output_cnt);
+            break;
+        case OP_NOTIF:
+            val.xpath = (char *)"/perf-scale:notif/l";
+            ret = sr_notif_send(sess, "/perf-scale:notif", &val, 1, 0, 0);
+            break;
+        default:
+            ret = SR_ERR_INTERNAL;
+            break;
+        }
+        time_get(&ts_end);
+
+        if (ret) {
+            fprintf(stderr, "Operation \"%s\" failed (%s).\n", op_names[OP_TYPE(wt->proc_id, wt->thread_id, i)],
+                    sr_strerror(ret));
+            goto cleanup;
+        }
+        wt->lats[i] = time_diff(&ts_start, &ts_end);
+    }
+
+cleanup:
+    sr_session_stop(sess);
+    wt->ret = ret;
+    return NULL;
+}
+
+/**
+ * @brief Worker process running its threads on a shared connection.
+ *
+ * @param[in] proc_id Process index.
+ * @param[in] thread_count Number of threads to run.
+ * @param[in] op_count Number of operations executed by every thread.
+ * @param[in] lats Shared latencies of this process.
+ * @param[in] ready_fd Pipe to announce the connection is ready.
+ * @param[in] start_fd Pipe to wait on for the start of the test.
+ * @return SR ERR value.
+ */
+static int
+worker_proc(uint32_t proc_id, uint32_t thread_count, uint32_t op_count, uint64_t *lats, int ready_fd, int start_fd)
+{
+    int ret;
+    sr_conn_ctx_t *conn = NULL;
+    struct worker_thread *wts = NULL;
+    uint32_t i;
+
+    if ((ret = sr_connect(0, &conn))) {
+        goto cleanup;
+    }
+
+    wts = calloc(thread_count, sizeof *wts);
+    if (!wts) {
+        ret = SR_ERR_NO_MEMORY;
+        goto cleanup;
+    }
+
+    /* ready, wait for the start */
+    if (pipe_write(ready_fd, 1) || pipe_read(start_fd, 1)) {
+        ret = SR_ERR_SYS;
+        goto cleanup;
+    }
+
+    for (i = 0; i < thread_count; ++i) {
+        wts[i].conn = conn;
+        wts[i].proc_id = proc_id;
+        wts[i].thread_id = i;
+        wts[i].op_count = op_count;
+        wts[i].lats = lats + i * op_count;
+        if (pthread_create(&wts[i].tid, NULL, worker_thread, &wts[i])) {
+            ret = SR_ERR_SYS;
+            thread_count = i;
+            break;
+        }
+    }
+
+    for (i = 0; i < thread_count; ++i) {
+        pthread_join(wts[i].tid, NULL);
+        if (!ret && wts[i].ret) {
+            ret = wts[i].ret;
+        }
+    }
+
+cleanup:
+    free(wts);
+    sr_disconnect(conn);
+    return ret;
+}
+
+/**
+ * @brief Run the mixed workload with a concurrency level.
+ *
+ * @param[in] proc_count Number of worker processes.
+ * @param[in] thread_count Number of threads of every process.
+ * @param[in] op_count Number of operations executed by every thread.
+ * @param[in] lats Shared latencies of all the operations.
+ * @param[out] wall Wall time of the whole run in nsec.
+ * @return SR ERR value.
+ */
+static int
+run_level(uint32_t proc_count, uint32_t thread_count, uint32_t op_count, uint64_t *lats, uint64_t *wall)
+{
+    int ret = SR_ERR_OK, ready[2], start[2], wstatus;
+    struct timespec ts_start, ts_end;
+    uint32_t i, started = 0;
+    pid_t pid;
+
+    if (pipe(ready)) {
+        return SR_ERR_SYS;
+    }
+    if (pipe(start)) {
+        close(ready[0]);
+        close(ready[1]);
+        return SR_ERR_SYS;
+    }
+
+    for (i = 0; i < proc_count; ++i) {
+        pid = fork();
+        if (pid == -1) {
+            ret = SR_ERR_SYS;
+            break;
+        } else if (!pid) {
+            /* worker */
+            close(ready[0]);
+            close(start[1]);
+            exit(worker_proc(i, thread_count, op_count, lats + i * thread_count * op_count, ready[1], start[0]));
+        }
+        ++started;
+    }
+
+    /* only the workers write ready and read start so that their failure is detected */
+    close(ready[1]);
+    close(start[0]);
+
+    /* wait for all the workers to connect and start them at once */
+    if (!ret && pipe_read(ready[0], started)) {
+        ret = SR_ERR_SYS;
+    }
+    time_get(&ts_start);
+    if (pipe_write(start[1], started)) {
+        ret = SR_ERR_SYS;
+    }
+
+    /* wait for all the workers */
+    for (i = 0; i < started; ++i) {
+        if (wait(&wstatus) == -1) {
+            ret = SR_ERR_SYS;
+        } else if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus)) {
+            ret = SR_ERR_INTERNAL;
+        }
+    }
+    time_get(&ts_end);
+    *wall = time_diff(&ts_start, &ts_end);
+
+    close(ready[0]);
+    close(start[1]);
+    return ret;
+}
+
+static int
+lat_cmp(const void *ptr1, const void *ptr2)
+{
+    uint64_t lat1 = *(const uint64_t *)ptr1, lat2 = *(const uint64_t *)ptr2;
+
+    return (lat1 > lat2) - (lat1 < lat2);
+}
+
+/**
+ * @brief Print a latency in usec.
+ *
+ * @param[in] lat Latency in nsec.
+ */
+static void
+print_lat(uint64_t lat)
+{
+    printf(" %9" PRIu64 ".%01" PRIu64 " |", lat / 1000, (lat % 1000) / 100);
+}
+
+/**
+ * @brief Print the results of a concurrency level, for every operation type.
+ *
+ * @param[in] proc_count Number of worker processes.
+ * @param[in] thread_count Number of threads of every process.
+ * @param[in] op_count Number of operations executed by every thread.
+ * @param[in] lats Latencies of all the operations.
+ * @param[in] wall Wall time of the whole run in nsec.
+ * @param[in] buf Buffer for the latencies of a single operation type, big enough for all the operations.
+ */
+static void
+print_level_results(uint32_t proc_count, uint32_t thread_count, uint32_t op_count, const uint64_t *lats, uint64_t wall,
+        uint64_t *buf)
+{
+    uint32_t p, t, i, type, count, total = 0;
+
+    for (type = 0; type < OP_COUNT; ++type) {
+        /* collect the latencies of this operation type */
+        count = 0;
+        for (p = 0; p < proc_count; ++p) {
+            for (t = 0; t < thread_count; ++t) {
+                for (i = 0; i < op_count; ++i) {
+                    if (OP_TYPE(p, t, i) == type) {
+                        buf[count++] = lats[(p * thread_count + t) * op_count + i];
+                    }
+                }
+            }
+        }
+        if (!count) {
+            continue;
+        }
+        total += count;
+
+        qsort(buf, count, sizeof *buf, lat_cmp);
+
+        printf("| %5" PRIu32 " | %7" PRIu32 " | %-13s | %10" PRIu64 " |", proc_count, thread_count, op_names[type],
+                (uint64_t)count * BILLION / (wall ? wall : 1));
+        print_lat(buf[((uint64_t)count - 1) * 500 / 1000]);
+        print_lat(buf[((uint64_t)count - 1) * 990 / 1000]);
+        print_lat(buf[((uint64_t)count - 1) * 999 / 1000]);
+        printf("\n");
+    }
+
+    printf("| %5" PRIu32 " | %7" PRIu32 " | %-13s | %10" PRIu64 " | %11s | %11s | %11s |\n", proc_count, thread_count,
+            "total", (uint64_t)total * BILLION / (wall ? wall : 1), "", "", "");
+}
+
+/**
+ * @brief Prepare the repository and install the test module.
+ *
+ * @return SR ERR value.
+ */
+static int
+sysrepo_init(void)
+{
+    int ret;
+    sr_conn_ctx_t *conn;
+
+    /* setup env */
+    if ((ret = setenv("SYSREPO_REPOSITORY_PATH", TESTS_REPO_DIR "/test_repositories/sr_perf_scale", 1))) {
+        return ret;
+    }
+    if ((ret = setenv("SYSREPO_SHM_PREFIX", "_tests_sr_sr_perf_scale", 1))) {
+        return ret;
+    }
+
+    /* turn on logging */
+    sr_log_stderr(SR_LL_WRN);
+
+    if ((ret = sr_connect(0, &conn))) {
+        return ret;
+    }
+
+    /* remove module if it was installed previously */
+    sr_log_stderr(SR_LL_NONE);
+    ret = sr_remove_module(conn, "perf-scale", 1);
+    sr_log_stderr(SR_LL_WRN);
+    if (ret && (ret != SR_ERR_NOT_FOUND)) {
+        sr_disconnect(conn);
+        return ret;
+    }
+
+    /* install module */
+    ret = sr_install_module(conn, TESTS_SRC_DIR "/files/perf-scale.yang", NULL, NULL);
+    sr_disconnect(conn);
+    return ret;
+}
+
+/**
+ * @brief Remove the test module.
+ *
+ * @return SR ERR value.
+ */
+static int
+sysrepo_destroy(void)
+{
+    int ret;
+    sr_conn_ctx_t *conn;
+
+    if ((ret = sr_connect(0, &conn))) {
+        return ret;
+    }
+
+    ret = sr_remove_module(conn, "perf-scale", 0);
+    sr_disconnect(conn);
+    return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret = 0, sub_ready[2] = {-1, -1}, sub_quit[2] = {-1, -1}, wstatus;
+    uint32_t max_procs, threads, ops, procs;
+    uint64_t *lats = MAP_FAILED, *buf = NULL, wall;
+    size_t lats_size = 0;
+    pid_t sub_pid = -1;
+
+    /* handle arguments */
+    if (argc < 4) {
+        fprintf(stderr, "Usage:\n%s max-process-count thread-count op-count\n\n", argv[0]);
+        return SR_ERR_INVAL_ARG;
+    }
+
+    if (atoi(argv[1]) <= 0) {
+        fprintf(stderr, "Invalid process count \"%s\".\n", argv[1]);
+        return SR_ERR_INVAL_ARG;
+    }
+    max_procs = atoi(argv[1]);
+
+    if (atoi(argv[2]) <= 0) {
+        fprintf(stderr, "Invalid thread count \"%s\".\n", argv[2]);
+        return SR_ERR_INVAL_ARG;
+    }
+    threads = atoi(argv[2]);
+
+    if (atoi(argv[3]) <= 0) {
+        fprintf(stderr, "Invalid operation count \"%s\".\n", argv[3]);
+        return SR_ERR_INVAL_ARG;
+    }
+    ops = atoi(argv[3]);
+
+    /* a failed process is detected by the pipes */
+    signal(SIGPIPE, SIG_IGN);
+
+    if ((ret = sysrepo_init())) {
+        fprintf(stderr, "Failed to install the test module (%s).\n", sr_strerror(ret));
+        return ret;
+    }
+
+    /* latencies are written by the worker processes */
+    lats_size = (size_t)max_procs * threads * ops * sizeof *lats;
+    lats = mmap(NULL, lats_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    buf = malloc(lats_size);
+    if ((lats == MAP_FAILED) || !buf) {
+        fprintf(stderr, "Out of memory.\n");
+        ret = SR_ERR_NO_MEMORY;
+        goto cleanup;
+    }
+
+    /* start the subscriber process */
+    if (pipe(sub_ready) || pipe(sub_quit)) {
+        ret = SR_ERR_SYS;
+        goto cleanup;
+    }
+    sub_pid = fork();
+    if (sub_pid == -1) {
+        ret = SR_ERR_SYS;
+        goto cleanup;
+    } else if (!sub_pid) {
+        exit(subscriber_proc(sub_ready[1], sub_quit[0]));
+    }
+    close(sub_ready[1]);
+    close(sub_quit[0]);
+    if (pipe_read(sub_ready[0], 1)) {
+        fprintf(stderr, "Subscriber process failed.\n");
+        ret = SR_ERR_SYS;
+        goto cleanup;
+    }
+
+    printf("\n| Options\n\n  Max processes           : %" PRIu32 "\n  Threads per process     : %" PRIu32
+            "\n  Operations per thread   : %" PRIu32 "\n\n", max_procs, threads, ops);
+    printf("| Scaling tests (latencies in usec)\n\n");
+    printf("| procs | threads | operation     |      ops/s |         p50 |         p99 |        p999 |\n");
+    printf("|-------|---------|---------------|------------|-------------|-------------|-------------|\n");
+
+    /* double the number of processes for every level */
+    procs = 1;
+    while (1) {
+        if ((ret = run_level(procs, threads, ops, lats, &wall))) {
+            fprintf(stderr, "Workers with %" PRIu32 " process(es) failed.\n", procs);
+            goto cleanup;
+        }
+        print_level_results(procs, threads, ops, lats, wall, buf);
+
+        if (procs == max_procs) {
+            break;
+        }
+        procs = (procs * 2 > max_procs) ? max_procs : procs * 2;
+    }
+    printf("\n");
+
+cleanup:
+    if (sub_pid > 0) {
+        /* stop the subscriber */
+        pipe_write(sub_quit[1], 1);
+        if ((waitpid(sub_pid, &wstatus, 0) == -1) || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus)) {
+            fprintf(stderr, "Subscriber process failed.\n");
+            if (!ret) {
+                ret = SR_ERR_SYS;
+            }
+        }
+    }
+    if (sub_ready[0] > -1) {
+        close(sub_ready[0]);
+    }
+    if (sub_quit[1] > -1) {
+        close(sub_quit[1]);
+    }
+    if (lats != MAP_FAILED) {
+        munmap(lats, lats_size);
+    }
+    free(buf);
+    if (sysrepo_destroy() && !ret) {
+        ret = SR_ERR_INTERNAL;
+    }
+    return ret;
+}
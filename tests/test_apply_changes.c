@@ -16,12 +16,15 @@
 
 #define _GNU_SOURCE
 
+#include <dirent.h>
+#include <inttypes.h>
 #include <poll.h>
 #include <pthread.h>
 #include <sched.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
@@ -7341,639 +7344,406 @@ test_done_timeout_priority(void **state)
 
 /* TEST */
 static int
-module_list_replace_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+module_async_done_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
         sr_event_t event, uint32_t request_id, void *private_data)
 {
     struct state *st = (struct state *)private_data;
-    sr_change_oper_t op;
     sr_change_iter_t *iter;
+    sr_change_oper_t op;
     const struct lyd_node *node;
-    const char *prev_val;
     int ret;
 
     (void)sub_id;
+    (void)module_name;
+    (void)xpath;
     (void)request_id;
 
-    assert_string_equal(module_name, "ietf-interfaces");
-    assert_null(xpath);
-
-    switch (ATOMIC_LOAD_RELAXED(st->cb_called)) {
-    case 0:
-    case 1:
-        if (ATOMIC_LOAD_RELAXED(st->cb_called) % 2) {
-            assert_int_equal(event, SR_EV_DONE);
-        } else {
-            assert_int_equal(event, SR_EV_CHANGE);
-        }
-
-        /* get changes iter */
-        ret = sr_get_changes_iter(session, "/ietf-interfaces:*//.", &iter);
-        assert_int_equal(ret, SR_ERR_OK);
-
-        /* 1st interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth52");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.100");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "24");
-
-        /* 2nd interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth53");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.101");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "24");
-
-        /* 3rd interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth54");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
-        assert_true(node->flags & LYD_DEFAULT);
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.102");
-
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "16");
+    assert_int_equal(event, SR_EV_DONE);
 
-        /* 4th interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
+    /* slow callback */
+    usleep(300000);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth55");
+    /* the diff must still be available */
+    ret = sr_get_changes_iter(session, "/test:*//.", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_change_tree_next(session, iter, &op, &node, NULL, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(node->schema->name, "l1");
+    sr_free_change_iter(iter);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
+    ATOMIC_INC_RELAXED(st->cb_called);
+    return SR_ERR_OK;
+}
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
+static void
+test_async_done(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_session_ctx_t *sess;
+    int ret, i;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_async_done_cb, st, 0, SR_SUBSCR_DONE_ONLY, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
-        assert_true(node->flags & LYD_DEFAULT);
+    ret = sr_session_set_async_done(sess, 1);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
+    /* returns before the callback finishes */
+    ret = sr_set_item_str(sess, "/test:l1[k='key1']/v", "1", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 0);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.103");
+    /* the next event waits for the previous one */
+    ret = sr_delete_item(sess, "/test:l1[k='key1']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "16");
+    /* wait for the last callback */
+    for (i = 0; (i < 100) && (ATOMIC_LOAD_RELAXED(st->cb_called) < 2); ++i) {
+        usleep(10000);
+    }
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
 
-        /* no more changes */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    sr_unsubscribe(subscr);
+    sr_session_stop(sess);
+}
 
-        sr_free_change_iter(iter);
-        break;
-    case 2:
-    case 3:
-        if (ATOMIC_LOAD_RELAXED(st->cb_called) % 2) {
-            assert_int_equal(event, SR_EV_DONE);
-        } else {
-            assert_int_equal(event, SR_EV_CHANGE);
+static int
+async_done_diff_count(sr_conn_ctx_t *conn)
+{
+    const char *prefix;
+    char *name;
+    DIR *dir;
+    struct dirent *ent;
+    int count = 0;
+
+    prefix = getenv(SR_SHM_PREFIX_ENV);
+    if (!prefix) {
+        prefix = SR_SHM_PREFIX_DEFAULT;
+    }
+    assert_int_not_equal(asprintf(&name, "%sdiff.%08" PRIx32 ".", prefix, conn->cid), -1);
+
+    /* shared diff segments of the originator */
+    dir = opendir(SR_SHM_DIR);
+    assert_non_null(dir);
+    while ((ent = readdir(dir))) {
+        if (!strncmp(ent->d_name, name, strlen(name))) {
+            ++count;
         }
+    }
+    closedir(dir);
+    free(name);
 
-        /* get changes iter */
-        ret = sr_get_changes_iter(session, "/ietf-interfaces:*//.", &iter);
-        assert_int_equal(ret, SR_ERR_OK);
-
-        /* 1st interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "description");
+    return count;
+}
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
+static void
+test_async_done_abandoned(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_session_ctx_t *sess, *sub_sess;
+    sr_conn_ctx_t *sub_conn;
+    int ret;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
+    ret = sr_connect(0, &sub_conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(sub_conn, SR_DS_RUNNING, &sub_sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_set_async_done(sess, 1);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
+    /* the subscriber never processes any events */
+    ret = sr_module_change_subscribe(sub_sess, "test", NULL, module_async_done_cb, st, 0,
+            SR_SUBSCR_DONE_ONLY | SR_SUBSCR_NO_THREAD, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
+    /* the diff segment is kept for the subscriber */
+    ret = sr_set_item_str(sess, "/test:l1[k='key1']/v", "1", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(async_done_diff_count(st->conn), 1);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.100");
+    /* the next event recovers the previous one once it times out, its diff segment is removed */
+    ret = sr_set_item_str(sess, "/test:l1[k='key1']/v", "2", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(async_done_diff_count(st->conn), 1);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "24");
+    /* unsubscribing finishes the pending event */
+    sr_unsubscribe(subscr);
+    assert_int_equal(async_done_diff_count(st->conn), 0);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 0);
 
-        /* 2nd interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_MODIFIED);
-        assert_string_equal(prev_val, "24");
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "16");
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:l1[k='key1']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+    sr_disconnect(sub_conn);
+}
 
-        /* 3rd interafce */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
+/* TEST */
+static int
+module_change_other_mod_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    sr_change_oper_t op;
+    sr_change_iter_t *iter;
+    const struct lyd_node *node;
+    const char *prev_val;
+    int ret;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.102");
+    (void)sub_id;
+    (void)xpath;
+    (void)request_id;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "16");
+    assert_string_equal(module_name, "test");
+    if (ATOMIC_LOAD_RELAXED(st->cb_called) == 0) {
+        assert_int_equal(event, SR_EV_CHANGE);
+    } else {
+        assert_int_equal(event, SR_EV_DONE);
+    }
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
+    /* changes of the subscribed module */
+    ret = sr_get_changes_iter(session, "/test:*//.", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.122");
+    ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(op, SR_OP_CREATED);
+    assert_string_equal(node->schema->name, "test-leaf");
+    sr_free_change_iter(iter);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "8");
+    /* changes of another module in the same commit are available as well */
+    ret = sr_get_changes_iter(session, "/ietf-interfaces:*//.", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        /* 4th interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
+    ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(op, SR_OP_CREATED);
+    assert_string_equal(node->schema->name, "interface");
+    sr_free_change_iter(iter);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth55");
+    /* the whole diff */
+    node = sr_get_change_diff(session);
+    if (event == SR_EV_DONE) {
+        assert_non_null(node);
+        assert_non_null(node->next);
+    }
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
+    ATOMIC_INC_RELAXED(st->cb_called);
+    return SR_ERR_OK;
+}
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
+static void
+test_change_other_mod(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    int ret;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ipv4");
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_change_other_mod_cb, st, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "forwarding");
-        assert_true(node->flags & LYD_DEFAULT);
+    /* change both modules at once */
+    ret = sr_set_item_str(sess, "/test:test-leaf", "52", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth52']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "address");
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "ip");
-        assert_string_equal(lyd_get_value(node), "192.168.2.103");
+    sr_unsubscribe(subscr);
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_DELETED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "prefix-length");
-        assert_string_equal(lyd_get_value(node), "16");
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        /* 5th interface */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "interface");
+    sr_session_stop(sess);
+}
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "name");
-        assert_string_equal(lyd_get_value(node), "eth56");
+/* TEST */
+static int
+module_change_filter_diff_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    sr_change_oper_t op;
+    sr_change_iter_t *iter;
+    const struct lyd_node *node, *iface;
+    const char *prev_val;
+    int ret, count = 0;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "type");
-        assert_string_equal(lyd_get_value(node), "iana-if-type:ethernetCsmacd");
+    (void)sub_id;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
 
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_OK);
-        assert_int_equal(op, SR_OP_CREATED);
-        assert_null(prev_val);
-        assert_string_equal(node->schema->name, "enabled");
-        assert_true(node->flags & LYD_DEFAULT);
+    assert_string_equal(module_name, "ietf-interfaces");
 
-        /* no more changes */
-        ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL);
-        assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    /* all the changes of the module, only eth1 ones were passed */
+    ret = sr_get_changes_iter(session, "/ietf-interfaces:*//.", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
 
-        sr_free_change_iter(iter);
-        break;
-    default:
-        fail();
+    while ((ret = sr_get_change_tree_next(session, iter, &op, &node, &prev_val, NULL, NULL)) == SR_ERR_OK) {
+        if (!strcmp(node->schema->name, "interfaces")) {
+            continue;
+        }
+        for (iface = node; strcmp(iface->schema->name, "interface"); iface = lyd_parent(iface)) {}
+        assert_string_equal(lyd_get_value(lyd_child(iface)), "eth1");
+        ++count;
     }
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    assert_int_not_equal(count, 0);
+    sr_free_change_iter(iter);
 
     ATOMIC_INC_RELAXED(st->cb_called);
     return SR_ERR_OK;
 }
 
-static void *
-apply_list_replace_thread(void *arg)
+static void
+test_filter_diff(void **state)
 {
-    struct state *st = (struct state *)arg;
+    struct state *st = (struct state *)*state;
     sr_session_ctx_t *sess;
-    sr_data_t *data;
-    struct lyd_node *edit;
-    char *str1;
-    const char *str2;
+    sr_subscription_ctx_t *subscr = NULL;
     int ret;
 
     ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
     assert_int_equal(ret, SR_ERR_OK);
 
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth52']/type", "iana-if-type:ethernetCsmacd", NULL, 0);
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", "/ietf-interfaces:interfaces/interface[name='eth1']",
+            module_change_filter_diff_cb, st, 0, SR_SUBSCR_FILTER_DIFF, &subscr);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth52']/ietf-ip:ipv4/address[ip='192.168.2.100']"
-            "/prefix-length", "24", NULL, 0);
+
+    /* change 2 interfaces */
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth53']/type", "iana-if-type:ethernetCsmacd", NULL, 0);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth2']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth53']/ietf-ip:ipv4/address[ip='192.168.2.101']"
-            "/prefix-length", "24", NULL, 0);
+    ret = sr_apply_changes(sess, 0);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth54']/type", "iana-if-type:ethernetCsmacd", NULL, 0);
+
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
+
+    sr_unsubscribe(subscr);
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth54']/ietf-ip:ipv4/address[ip='192.168.2.102']"
-            "/prefix-length", "16", NULL, 0);
+    ret = sr_apply_changes(sess, 0);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth55']/type", "iana-if-type:ethernetCsmacd", NULL, 0);
+
+    sr_session_stop(sess);
+}
+
+/* TEST */
+static int
+module_change_parallel_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event == SR_EV_CHANGE) {
+        /* both modules must be notified at once */
+        pthread_barrier_wait(&st->barrier);
+    }
+
+    ATOMIC_INC_RELAXED(st->cb_called);
+    return SR_ERR_OK;
+}
+
+static void
+test_change_parallel(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr1 = NULL, *subscr2 = NULL;
+    int ret;
+
+    ret = sr_connect(SR_CONN_CHANGE_NOTIFY_PARALLEL, &conn);
     assert_int_equal(ret, SR_ERR_OK);
-    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth55']/ietf-ip:ipv4/address[ip='192.168.2.103']"
-            "/prefix-length", "16", NULL, 0);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
     assert_int_equal(ret, SR_ERR_OK);
 
-    /* wait for subscription before applying changes */
-    pthread_barrier_wait(&st->barrier);
+    /* order: test, ietf-interfaces, ignored */
+    sr_module_change_set_order(st->conn, "test", SR_DS_RUNNING, 100);
+    sr_module_change_set_order(st->conn, "ietf-interfaces", SR_DS_RUNNING, 0);
 
-    /* set initial data */
-    ret = sr_apply_changes(sess, 0);
+    /* separate subscriptions so that the callbacks are executed concurrently */
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_change_parallel_cb, st, 0, 0, &subscr1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_change_parallel_cb, st, 0, 0, &subscr2);
     assert_int_equal(ret, SR_ERR_OK);
 
-    /* signal changes were applied #1 */
-    pthread_barrier_wait(&st->barrier);
-
-    /* change data effectively replacing or creating some list instances */
-    str2 = "{"
-            "\"ietf-interfaces:interfaces\": {"
-            "  \"interface\": ["
-            "    { \"name\": \"eth52\", \"@\": { \"ietf-netconf:operation\": \"remove\" } },"
-            "    { \"name\": \"eth53\", \"@\": { \"ietf-netconf:operation\": \"remove\" } },"
-            "    { \"name\": \"eth54\", \"@\": { \"ietf-netconf:operation\": \"remove\" } },"
-            "    { \"name\": \"eth55\", \"@\": { \"ietf-netconf:operation\": \"remove\" } },"
-            "    { \"name\": \"eth52\", \"type\": \"iana-if-type:ethernetCsmacd\", \"description\": \"this is eth52\" },"
-            "    { \"name\": \"eth53\", \"type\": \"iana-if-type:ethernetCsmacd\", \"ietf-ip:ipv4\": {"
-            "      \"address\": [ { \"ip\": \"192.168.2.101\", \"prefix-length\": 16 } ]"
-            "    } },"
-            "    { \"name\": \"eth54\", \"type\": \"iana-if-type:ethernetCsmacd\", \"ietf-ip:ipv4\": {"
-            "      \"address\": [ { \"ip\": \"192.168.2.122\", \"prefix-length\": 8 } ]"
-            "    } },"
-            "    { \"name\": \"eth56\", \"type\": \"iana-if-type:ethernetCsmacd\" }"
-            "  ]"
-            "}}";
-    ret = lyd_parse_data_mem(sr_acquire_context(st->conn), str2, LYD_JSON, LYD_PARSE_ONLY, 0, &edit);
-    assert_int_equal(ret, LY_SUCCESS);
-    ret = sr_edit_batch(sess, edit, "merge");
-    assert_int_equal(ret, SR_ERR_OK);
-    lyd_free_siblings(edit);
-    sr_release_context(st->conn);
+    /* change both modules */
+    ret = sr_set_item_str(sess, "/test:test-leaf", "20", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth0']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
     ret = sr_apply_changes(sess, 0);
     assert_int_equal(ret, SR_ERR_OK);
 
-    /* signal changes were applied #2 */
-    pthread_barrier_wait(&st->barrier);
+    /* change and done of both */
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 4);
 
-    /* check current data tree */
-    ret = sr_get_data(sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
-    assert_int_equal(ret, SR_ERR_OK);
-    ret = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
-    sr_release_data(data);
-    assert_int_equal(ret, LY_SUCCESS);
-
-    str2 = "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
-            "<interface><name>eth52</name><description>this is eth52</description>"
-            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type></interface>"
-            "<interface><name>eth53</name>"
-            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
-            "<ipv4 xmlns=\"urn:ietf:params:xml:ns:yang:ietf-ip\">"
-            "<address><ip>192.168.2.101</ip><prefix-length>16</prefix-length></address></ipv4></interface>"
-            "<interface><name>eth54</name>"
-            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
-            "<ipv4 xmlns=\"urn:ietf:params:xml:ns:yang:ietf-ip\">"
-            "<address><ip>192.168.2.122</ip><prefix-length>8</prefix-length></address></ipv4></interface>"
-            "<interface><name>eth56</name>"
-            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type></interface>"
-            "</interfaces>";
-    assert_string_equal(str1, str2);
-    free(str1);
+    sr_unsubscribe(subscr1);
+    sr_unsubscribe(subscr2);
 
-    /* signal that we have finished */
-    pthread_barrier_wait(&st->barrier);
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 
+    sr_module_change_set_order(st->conn, "test", SR_DS_RUNNING, 0);
     sr_session_stop(sess);
-    return NULL;
+    sr_disconnect(conn);
 }
 
-static void *
-subscribe_list_replace_thread(void *arg)
+/* TEST */
+static void
+test_thread_pool(void **state)
 {
-    struct state *st = (struct state *)arg;
+    struct state *st = (struct state *)*state;
     sr_session_ctx_t *sess;
     sr_subscription_ctx_t *subscr = NULL;
     int ret;
@@ -7981,40 +7751,98 @@ subscribe_list_replace_thread(void *arg)
     ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
     assert_int_equal(ret, SR_ERR_OK);
 
-    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_list_replace_cb, st, 0, 0, &subscr);
+    /* single subscription structure, the callbacks are still executed concurrently by the workers */
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_change_parallel_cb, st, 0, SR_SUBSCR_THREAD_POOL,
+            &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_change_parallel_cb, st, 0, 0, &subscr);
     assert_int_equal(ret, SR_ERR_OK);
 
-    /* signal that subscription was created */
-    pthread_barrier_wait(&st->barrier);
-
-    /* wait until changes are applied #1 */
-    pthread_barrier_wait(&st->barrier);
-
-    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
-
-    /* wait until changes are applied #2 */
-    pthread_barrier_wait(&st->barrier);
+    /* change both modules */
+    ret = sr_set_item_str(sess, "/test:test-leaf", "20", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth0']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 
     assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 4);
 
-    /* wait for the other thread to finish */
-    pthread_barrier_wait(&st->barrier);
-
     sr_unsubscribe(subscr);
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
     sr_session_stop(sess);
-    return NULL;
 }
 
+/* TEST */
 static void
-test_list_replace(void **state)
+test_shared_subscr(void **state)
 {
-    pthread_t tid[2];
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL, *subscr1, *subscr2;
+    uint32_t sub_id1, sub_id2;
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
 
-    pthread_create(&tid[0], NULL, apply_list_replace_thread, *state);
-    pthread_create(&tid[1], NULL, subscribe_list_replace_thread, *state);
+    /* invalid options */
+    ret = sr_subscription_create(st->conn, SR_SUBSCR_NO_THREAD | SR_SUBSCR_THREAD_POOL, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+    ret = sr_subscription_create(st->conn, SR_SUBSCR_ENABLED, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
 
-    pthread_join(tid[0], NULL);
-    pthread_join(tid[1], NULL);
+    /* empty subscription structure shared by 2 independent subscribers */
+    ret = sr_subscription_create(st->conn, SR_SUBSCR_THREAD_POOL, 2, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    subscr1 = subscr;
+    subscr2 = subscr;
+
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_change_parallel_cb, st, 0, 0, &subscr1);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_ptr_equal(subscr1, subscr);
+    sub_id1 = sr_subscription_get_last_sub_id(subscr1);
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_change_parallel_cb, st, 0, 0, &subscr2);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_ptr_equal(subscr2, subscr);
+    sub_id2 = sr_subscription_get_last_sub_id(subscr2);
+
+    /* change both modules, handled concurrently by the workers */
+    ret = sr_set_item_str(sess, "/test:test-leaf", "20", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth0']/type", "iana-if-type:ethernetCsmacd",
+            NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 4);
+
+    /* each subscriber removes only its subscription */
+    ret = sr_unsubscribe_sub(subscr1, sub_id1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_unsubscribe_sub(subscr2, sub_id2);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_unsubscribe(subscr);
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_session_stop(sess);
 }
 
 /* MAIN */
@@ -8049,7 +7877,14 @@ main(void)
         cmocka_unit_test_setup_teardown(test_write_starve, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_mult_update, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_done_timeout_priority, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_async_done, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_async_done_abandoned, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_list_replace, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_other_mod, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_filter_diff, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_parallel, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_thread_pool, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_shared_subscr, setup_f, teardown_f),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
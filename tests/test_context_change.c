@@ -466,6 +466,64 @@ test_feature_change(void **state)
     pthread_join(tid[1], NULL);
 }
 
+/* TEST */
+static void
+test_lazy_ctx(void **state)
+{
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    const struct ly_ctx *ly_ctx;
+    const char *module_names[] = {"mod1", NULL};
+    int ret;
+
+    (void)state;
+
+    ret = sr_connect(SR_CONN_CTX_LAZY, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* module not used yet */
+    ly_ctx = sr_acquire_context(conn);
+    assert_non_null(ly_ctx);
+    assert_null(ly_ctx_get_module_implemented(ly_ctx, "mod1"));
+    assert_non_null(ly_ctx_get_module_implemented(ly_ctx, "ietf-yang-library"));
+    sr_release_context(conn);
+
+    /* module used by a path */
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/mod1:cont/l1", "val", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(sess, "/mod1:cont", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(data);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "val");
+    sr_release_data(data);
+
+    ly_ctx = sr_acquire_context(conn);
+    assert_non_null(ly_ctx_get_module_implemented(ly_ctx, "mod1"));
+    sr_release_context(conn);
+
+    /* already loaded */
+    ret = sr_require_modules(conn, module_names);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* modules cannot be changed */
+    ret = sr_remove_module(conn, "mod1", 0);
+    assert_int_equal(ret, SR_ERR_UNSUPPORTED);
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/mod1:cont", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_session_stop(sess);
+    sr_disconnect(conn);
+}
+
 /* MAIN */
 int
 main(void)
@@ -473,6 +531,7 @@ main(void)
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_deviation, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_feature_change, setup_f, teardown_f),
+        cmocka_unit_test(test_lazy_ctx),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
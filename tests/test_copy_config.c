@@ -20,6 +20,7 @@
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
@@ -29,6 +30,7 @@
 #include <libyang/libyang.h>
 
 #include "common.h"
+#include "config.h"
 #include "sysrepo.h"
 #include "tests/tcommon.h"
 
@@ -2463,6 +2465,280 @@ test_replace_when(void **state)
     pthread_join(tid[1], NULL);
 }
 
+/* TEST */
+static int
+module_replace_hash_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_ctx)
+{
+    struct state *st = (struct state *)private_ctx;
+    sr_change_oper_t op;
+    sr_change_iter_t *iter;
+    sr_val_t *old_val, *new_val;
+    int ret;
+
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event != SR_EV_CHANGE) {
+        return SR_ERR_OK;
+    }
+
+    ret = sr_get_changes_iter(session, "/ietf-interfaces:*//.", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* only the changed description */
+    ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(op, SR_OP_MODIFIED);
+    assert_string_equal(new_val->xpath, "/ietf-interfaces:interfaces/interface[name='eth2']/description");
+    assert_string_equal(old_val->data.string_val, "second");
+    assert_string_equal(new_val->data.string_val, "changed");
+    sr_free_val(old_val);
+    sr_free_val(new_val);
+
+    ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    sr_free_change_iter(iter);
+
+    ATOMIC_INC_RELAXED(st->cb_called);
+    return SR_ERR_OK;
+}
+
+static void
+test_replace_hash(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    struct lyd_node *config;
+    sr_data_t *data;
+    char *str1;
+    const char *str2, *fmt;
+    char buf[1024];
+    int ret;
+
+    /* connection with cached running data and the subtree hashes */
+    ret = sr_connect(SR_CONN_CACHE_RUNNING, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    fmt =
+            "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+            "  <interface>"
+            "    <name>eth1</name>"
+            "    <description>first</description>"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+            "  </interface>"
+            "  <interface>"
+            "    <name>eth2</name>"
+            "    <description>%s</description>"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+            "  </interface>"
+            "</interfaces>";
+
+    /* initial config */
+    sprintf(buf, fmt, "second");
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(st->ly_ctx, buf, LYD_XML, LYD_PARSE_STRICT,
+            LYD_VALIDATE_NO_STATE | LYD_VALIDATE_PRESENT, &config));
+    ret = sr_replace_config(sess, "ietf-interfaces", config, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_replace_hash_cb, st, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* same config, no changes */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(st->ly_ctx, buf, LYD_XML, LYD_PARSE_STRICT,
+            LYD_VALIDATE_NO_STATE | LYD_VALIDATE_PRESENT, &config));
+    ret = sr_replace_config(sess, "ietf-interfaces", config, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 0);
+
+    /* one changed leaf, the other interface is skipped */
+    sprintf(buf, fmt, "changed");
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(st->ly_ctx, buf, LYD_XML, LYD_PARSE_STRICT,
+            LYD_VALIDATE_NO_STATE | LYD_VALIDATE_PRESENT, &config));
+    ret = sr_replace_config(sess, "ietf-interfaces", config, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
+
+    /* check current data tree, including the default nodes */
+    ret = sr_get_data(sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL);
+    assert_int_equal(ret, 0);
+    sr_release_data(data);
+
+    str2 =
+            "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">\n"
+            "  <interface>\n"
+            "    <name>eth1</name>\n"
+            "    <description>first</description>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>\n"
+            "    <enabled>true</enabled>\n"
+            "  </interface>\n"
+            "  <interface>\n"
+            "    <name>eth2</name>\n"
+            "    <description>changed</description>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>\n"
+            "    <enabled>true</enabled>\n"
+            "  </interface>\n"
+            "</interfaces>\n";
+
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    sr_unsubscribe(subscr);
+    sr_disconnect(conn);
+}
+
+/**
+ * @brief Simulate a reboot by removing main SHM so that it is created again and running data are initialized
+ * from startup data (copied or, with ENABLE_LAZY_RUNNING, inherited until first accessed).
+ */
+static void
+reboot_shm(struct state *st)
+{
+    const char *prefix;
+    char *path;
+    int ret;
+
+    sr_release_context(st->conn);
+    st->ly_ctx = NULL;
+    sr_disconnect(st->conn);
+    st->conn = NULL;
+
+    prefix = getenv(SR_SHM_PREFIX_ENV);
+    if (!prefix) {
+        prefix = SR_SHM_PREFIX_DEFAULT;
+    }
+    ret = asprintf(&path, "%s/%s_main", SR_SHM_DIR, prefix);
+    assert_int_not_equal(ret, -1);
+    assert_int_equal(unlink(path), 0);
+    free(path);
+
+    ret = sr_connect(0, &st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    st->ly_ctx = sr_acquire_context(st->conn);
+}
+
+static void
+assert_item_str(sr_session_ctx_t *sess, const char *path, const char *value)
+{
+    sr_val_t *val;
+    int ret;
+
+    ret = sr_get_item(sess, path, 0, &val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, value);
+    sr_free_val(val);
+}
+
+static void
+test_reboot(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_val_t *vals;
+    size_t val_count;
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_STARTUP, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* startup data of several modules, each accessed differently after the reboot */
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description", "start", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/test:ll1", "1", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/when1:l2", "start", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/list-case:ac1/acl1[acs1='a']/acl1ch1cs1lf1", "start", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* different running data, lost on reboot */
+    ret = sr_session_switch_ds(sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description", "run", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/test:ll1", "5", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/when1:l2", "run", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/list-case:ac1/acl1[acs1='a']/acl1ch1cs1lf1", "run", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+
+    reboot_shm(st);
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* get */
+    assert_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description", "start");
+
+    /* edit, the startup data are kept */
+    ret = sr_set_item_str(sess, "/test:ll1", "2", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_items(sess, "/test:ll1", 0, 0, &vals, &val_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(val_count, 2);
+    assert_int_equal(vals[0].data.int16_val, 1);
+    assert_int_equal(vals[1].data.int16_val, 2);
+    sr_free_values(vals, val_count);
+
+    /* copy-config from startup, startup is locked while running data are copied */
+    ret = sr_copy_config(sess, "when1", SR_DS_STARTUP, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_item_str(sess, "/when1:l2", "start");
+
+    /* candidate reset */
+    ret = sr_session_switch_ds(sess, SR_DS_CANDIDATE);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_copy_config(sess, "list-case", SR_DS_RUNNING, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_item_str(sess, "/list-case:ac1/acl1[acs1='a']/acl1ch1cs1lf1", "start");
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/list-case:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_copy_config(sess, NULL, SR_DS_RUNNING, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/when1:l2", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/list-case:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(sess, SR_DS_STARTUP);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/when1:l2", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess, "/list-case:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+}
+
 /* MAIN */
 int
 main(void)
@@ -2477,6 +2753,8 @@ main(void)
         cmocka_unit_test_setup_teardown(test_replace_dflt, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_replace_case, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_replace_when, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_replace_hash, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_reboot, setup_f, teardown_f),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
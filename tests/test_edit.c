@@ -309,6 +309,134 @@ test_create1(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+static void
+test_set_items(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_data_t *subtree;
+    char *str;
+    const char *str2;
+    int ret;
+    sr_edit_item_t items[] = {
+        {"/ietf-interfaces:interfaces/interface[name='eth64']", NULL, SR_EDIT_ITEM_SET},
+        {"/ietf-interfaces:interfaces/interface[name='eth64']/type", "iana-if-type:ethernetCsmacd", SR_EDIT_ITEM_SET},
+        {"/ietf-interfaces:interfaces/interface[name='eth64']/enabled", "false", SR_EDIT_ITEM_SET},
+        {"/ietf-interfaces:interfaces/interface[name='eth65']/type", "iana-if-type:ethernetCsmacd", SR_EDIT_ITEM_SET},
+        {"/ietf-interfaces:interfaces/interface[name='eth65']/description", "desc", SR_EDIT_ITEM_SET},
+        {"/ietf-interfaces:interfaces/interface[name='eth65']/description", NULL, SR_EDIT_ITEM_DELETE},
+        {"/ietf-interfaces:interfaces/interface[name='eth64']/type", "iana-if-type:softwareLoopback", SR_EDIT_ITEM_SET},
+    };
+
+    /* set all the items at once */
+    ret = sr_set_items(st->sess, items, sizeof items / sizeof *items, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_subtree(st->sess, "/ietf-interfaces:interfaces", 0, &subtree);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    lyd_print_mem(&str, subtree->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    sr_release_data(subtree);
+
+    str2 =
+            "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">\n"
+            "  <interface>\n"
+            "    <name>eth64</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:softwareLoopback</type>\n"
+            "    <enabled>false</enabled>\n"
+            "  </interface>\n"
+            "  <interface>\n"
+            "    <name>eth65</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>\n"
+            "  </interface>\n"
+            "</interfaces>\n";
+
+    assert_string_equal(str, str2);
+    free(str);
+
+    /* strict create of an existing item fails */
+    ret = sr_set_items(st->sess, items, 2, NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_EXISTS);
+    ret = sr_discard_changes(st->sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* invalid item */
+    items[0].xpath = NULL;
+    ret = sr_set_items(st->sess, items, 1, NULL, 0);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+}
+
+static void
+test_edit_template(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_edit_template_t *tmpl;
+    sr_data_t *subtree;
+    char *str;
+    const char *str2;
+    int ret;
+    const char *args[] = {"eth66", "eth67", "eth'68"};
+    const char *values[] = {
+        "iana-if-type:ethernetCsmacd", "iana-if-type:softwareLoopback", "iana-if-type:ethernetCsmacd"
+    };
+
+    /* invalid templates */
+    ret = sr_edit_template_new(st->conn, "/ietf-interfaces:interfaces/interface/$n", &tmpl);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+    ret = sr_edit_template_new(st->conn, "/ietf-interfaces:interfaces/interface[name=$n", &tmpl);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    /* unknown node */
+    ret = sr_edit_template_new(st->conn, "/ietf-interfaces:interfaces/interface[name=$n]/typo", &tmpl);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_edit_template_set(st->sess, tmpl, args, values, 1, NULL, 0);
+    assert_int_not_equal(ret, SR_ERR_OK);
+    sr_edit_template_free(tmpl);
+
+    /* set several instances */
+    ret = sr_edit_template_new(st->conn, "/ietf-interfaces:interfaces/interface[name = $n]/type", &tmpl);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_edit_template_set(st->sess, tmpl, args, values, 3, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* reuse the template */
+    ret = sr_edit_template_set(st->sess, tmpl, args, values + 1, 1, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_edit_template_free(tmpl);
+
+    ret = sr_get_subtree(st->sess, "/ietf-interfaces:interfaces", 0, &subtree);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    lyd_print_mem(&str, subtree->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    sr_release_data(subtree);
+
+    str2 =
+            "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">\n"
+            "  <interface>\n"
+            "    <name>eth66</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:softwareLoopback</type>\n"
+            "  </interface>\n"
+            "  <interface>\n"
+            "    <name>eth67</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:softwareLoopback</type>\n"
+            "  </interface>\n"
+            "  <interface>\n"
+            "    <name>eth'68</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>\n"
+            "  </interface>\n"
+            "</interfaces>\n";
+
+    assert_string_equal(str, str2);
+    free(str);
+}
+
 static void
 test_create2(void **state)
 {
@@ -563,6 +691,78 @@ test_replace(void **state)
     free(str);
 }
 
+static int
+module_noop_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    int *cb_called = private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event == SR_EV_CHANGE) {
+        ++(*cb_called);
+    }
+    return SR_ERR_OK;
+}
+
+static void
+test_noop(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_data_t *data;
+    struct lyd_node *config;
+    int ret, cb_called = 0;
+
+    ret = sr_module_change_subscribe(st->sess, "ietf-interfaces", NULL, module_noop_cb, &cb_called, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* create some data */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth64']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(cb_called, 1);
+
+    /* merge the same data */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth64']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(cb_called, 1);
+
+    /* replace with the same data */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_edit_batch(st->sess, data->tree, "replace");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(cb_called, 1);
+
+    /* replace config with the same data */
+    assert_int_equal(LY_SUCCESS, lyd_dup_siblings(data->tree, NULL, LYD_DUP_RECURSIVE, &config));
+    sr_release_data(data);
+    ret = sr_replace_config(st->sess, "ietf-interfaces", config, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(cb_called, 1);
+
+    /* actual change */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth64']/enabled", "false", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(cb_called, 2);
+
+    sr_unsubscribe(subscr);
+}
+
 static void
 test_replace_userord(void **state)
 {
@@ -1540,6 +1740,51 @@ test_unknown_ns(void **state)
     sr_discard_changes(st->sess);
 }
 
+static void
+test_timing(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_data_t *data;
+    uint32_t total_us, phase_us[SR_PHASE_COUNT], sum = 0, i;
+    int ret;
+
+    /* not enabled */
+    ret = sr_session_get_timing(st->sess, &total_us, phase_us);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    ret = sr_session_set_timing(st->sess, 1, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* timed apply changes */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth64']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_get_timing(st->sess, &total_us, phase_us);
+    assert_int_equal(ret, SR_ERR_OK);
+    for (i = 0; i < SR_PHASE_COUNT; ++i) {
+        sum += phase_us[i];
+    }
+    assert_true(total_us >= sum);
+
+    /* timed get, no edit or store phases */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+
+    ret = sr_session_get_timing(st->sess, NULL, phase_us);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(phase_us[SR_PHASE_EDIT], 0);
+    assert_int_equal(phase_us[SR_PHASE_STORE], 0);
+
+    ret = sr_session_set_timing(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_get_timing(st->sess, &total_us, NULL);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+}
+
 int
 main(void)
 {
@@ -1547,10 +1792,13 @@ main(void)
         cmocka_unit_test(test_edit_item),
         cmocka_unit_test_teardown(test_delete, clear_interfaces),
         cmocka_unit_test_teardown(test_create1, clear_interfaces),
+        cmocka_unit_test_teardown(test_set_items, clear_interfaces),
+        cmocka_unit_test_teardown(test_edit_template, clear_interfaces),
         cmocka_unit_test_teardown(test_create2, clear_interfaces),
         cmocka_unit_test_teardown(test_create_np_cont, clear_interfaces),
         cmocka_unit_test_teardown(test_move, clear_test),
         cmocka_unit_test_teardown(test_replace, clear_interfaces),
+        cmocka_unit_test_teardown(test_noop, clear_interfaces),
         cmocka_unit_test_teardown(test_replace_userord, clear_test),
         cmocka_unit_test_teardown(test_none, clear_interfaces),
         cmocka_unit_test_teardown(test_isolate, clear_interfaces),
@@ -1564,6 +1812,7 @@ main(void)
         cmocka_unit_test(test_edit_forbid_node_types),
         cmocka_unit_test(test_anyxml),
         cmocka_unit_test(test_unknown_ns),
+        cmocka_unit_test_teardown(test_timing, clear_interfaces),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
@@ -16,6 +16,7 @@
 
 #define _GNU_SOURCE
 
+#include <inttypes.h>
 #include <pthread.h>
 #include <setjmp.h>
 #include <stdarg.h>
@@ -234,6 +235,374 @@ test_cached_thread(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+/* TEST */
+static void *
+cached_update_thread(void *arg)
+{
+    sr_conn_ctx_t *conn = arg;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    struct lyd_node *node;
+    uint32_t i;
+    int ret;
+
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* keep reading the cached data while they are being changed */
+    for (i = 0; i < 50; ++i) {
+        ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+        assert_int_equal(ret, SR_ERR_OK);
+        assert_non_null(data->tree);
+        assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='key']", 0, &node));
+        sr_release_data(data);
+    }
+
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static void
+test_cached_update(void **state)
+{
+    struct state *st = (struct state *)*state;
+    pthread_t tid;
+    sr_data_t *data;
+    struct lyd_node *node;
+    uint32_t i;
+    int ret;
+
+    ret = sr_set_item_str(st->csess, "/simple:ac1/acl1[acs1='key']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->csess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    pthread_create(&tid, NULL, cached_update_thread, st->cconn);
+
+    /* change the cached data meanwhile */
+    for (i = 0; i < 50; ++i) {
+        ret = sr_set_item_str(st->csess, "/simple:ac1/acd1", (i % 2) ? "true" : "false", NULL, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+        ret = sr_apply_changes(st->csess, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    pthread_join(tid, NULL);
+
+    /* the cache has the last change */
+    ret = sr_get_data(st->csess, "/simple:ac1/acd1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acd1", 0, &node));
+    assert_string_equal(lyd_get_value(node), "true");
+    sr_release_data(data);
+
+    /* cleanup */
+    ret = sr_delete_item(st->csess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->csess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
+/* TEST */
+static void
+test_cached_shared(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn1, *conn2;
+    sr_session_ctx_t *sess1, *sess2;
+    sr_data_t *data;
+    struct lyd_node *node;
+    int ret;
+
+    ret = sr_connect(SR_CONN_CACHE_RUNNING_SHARED, &conn1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_connect(SR_CONN_CACHE_RUNNING_SHARED, &conn2);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn1, SR_DS_RUNNING, &sess1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn2, SR_DS_RUNNING, &sess2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* cache the data in both connections */
+    ret = sr_get_data(sess1, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_get_data(sess2, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+
+    /* change the data in one connection, the other one uses the published data */
+    ret = sr_set_item_str(sess1, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess1, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess2, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    sr_release_data(data);
+
+    /* change the data in a connection without the shared cache */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='b']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess2, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, &node));
+    sr_release_data(data);
+    ret = sr_get_data(sess1, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, &node));
+    sr_release_data(data);
+
+    /* remove some data, the other connection applies only the diff of the change */
+    ret = sr_delete_item(sess1, "/simple:ac1/acl1[acs1='a']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess1, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess2, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_ENOTFOUND, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, &node));
+    sr_release_data(data);
+
+    /* cleanup */
+    ret = sr_delete_item(st->sess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_disconnect(conn1);
+    sr_disconnect(conn2);
+}
+
+/* TEST */
+static void
+test_cached_ds(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    struct lyd_node *node;
+    int ret;
+
+    ret = sr_connect(SR_CONN_CACHE_DS, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_STARTUP, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(st->sess, SR_DS_STARTUP);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* cache the data */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+
+    /* change the data in another connection */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the changed data are loaded again */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    sr_release_data(data);
+
+    /* change the data in the connection, the cached data are modified */
+    ret = sr_set_item_str(sess, "/simple:ac1/acl1[acs1='b']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='a']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, &node));
+    sr_release_data(data);
+
+    /* the data are not changed, the cached data are returned */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, &node));
+    sr_release_data(data);
+
+    /* cleanup */
+    ret = sr_delete_item(st->sess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(st->sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_disconnect(conn);
+}
+
+/* TEST */
+static void
+test_cached_mem_limit(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    uint64_t mem_usage[SR_CONN_MEM_COUNT], edit;
+    sr_cache_stats_t stats, stats2;
+    int ret;
+
+    ret = sr_connect(SR_CONN_CACHE_DS, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_STARTUP, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(st->sess, SR_DS_STARTUP);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* only caches can be limited */
+    ret = sr_conn_set_mem_limit(conn, SR_CONN_MEM_CONTEXT, 1);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+    ret = sr_conn_get_cache_stats(conn, SR_CONN_MEM_NOTIF_BUF, &stats);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    /* prepared edit */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_get_mem_usage(st->sess, &edit, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(edit > 0);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_get_mem_usage(st->sess, &edit, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(edit, 0);
+
+    /* cache the data */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_conn_get_mem_usage(conn, mem_usage);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(mem_usage[SR_CONN_MEM_DS_CACHE] > 0);
+    assert_int_equal(mem_usage[SR_CONN_MEM_RUN_CACHE], 0);
+    ret = sr_conn_get_cache_stats(conn, SR_CONN_MEM_DS_CACHE, &stats);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(stats.misses > 0);
+
+    /* read the cached data */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_conn_get_cache_stats(conn, SR_CONN_MEM_DS_CACHE, &stats2);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(stats2.hits > stats.hits);
+    assert_int_equal(stats2.misses, stats.misses);
+    assert_int_equal(stats2.evictions, 0);
+
+    /* limit the cache and change the data, they are too big to be cached */
+    ret = sr_conn_set_mem_limit(conn, SR_CONN_MEM_DS_CACHE, 1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='b']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='b']", 0, NULL));
+    sr_release_data(data);
+    ret = sr_conn_get_mem_usage(conn, mem_usage);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(mem_usage[SR_CONN_MEM_DS_CACHE], 0);
+    ret = sr_conn_get_cache_stats(conn, SR_CONN_MEM_DS_CACHE, &stats);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(stats.evictions > 0);
+
+    /* no limit */
+    ret = sr_conn_set_mem_limit(conn, SR_CONN_MEM_DS_CACHE, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_conn_get_mem_usage(conn, mem_usage);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(mem_usage[SR_CONN_MEM_DS_CACHE] > 0);
+
+    /* cleanup */
+    ret = sr_delete_item(st->sess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_switch_ds(st->sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_disconnect(conn);
+}
+
+/* TEST */
+static void
+test_cached_compact(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    uint64_t mem_usage[SR_CONN_MEM_COUNT];
+    char path[64];
+    int ret, i;
+
+    ret = sr_connect(SR_CONN_CACHE_RUNNING_COMPACT, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* set some data */
+    for (i = 0; i < 20; ++i) {
+        sprintf(path, "/simple:ac1/acl1[acs1='entry%d']", i);
+        ret = sr_set_item_str(st->sess, path, NULL, NULL, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* cache the data of 2 modules */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_get_data(sess, "/defaults:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_conn_get_mem_usage(conn, mem_usage);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(mem_usage[SR_CONN_MEM_RUN_CACHE] > 0);
+    assert_int_equal(mem_usage[SR_CONN_MEM_RUN_CACHE_COMPACT], 0);
+
+    /* limit the cache and cache another module, the least recently used data are kept compact */
+    ret = sr_conn_set_mem_limit(conn, SR_CONN_MEM_RUN_CACHE, mem_usage[SR_CONN_MEM_RUN_CACHE] - 1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(sess, "/mod:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_conn_get_mem_usage(conn, mem_usage);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_true(mem_usage[SR_CONN_MEM_RUN_CACHE_COMPACT] > 0);
+
+    /* the compact data are parsed again */
+    ret = sr_get_data(sess, "/simple:ac1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "acl1[acs1='entry19']", 0, NULL));
+    sr_release_data(data);
+
+    /* cleanup */
+    ret = sr_delete_item(st->sess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_disconnect(conn);
+}
+
 /* TEST */
 static int
 enable_cached_get_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath, sr_event_t event,
@@ -279,6 +648,84 @@ test_enable_cached_get(void **state)
     sr_unsubscribe(sub);
 }
 
+/* TEST */
+static int
+dummy_change_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+static void
+test_enabled_cached_oper(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *sub = NULL;
+    sr_data_t *data;
+    sr_val_t *values;
+    size_t count;
+    char *str;
+    int ret;
+
+    /* set some running data */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='b']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_switch_ds(st->csess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe to a subtree, read the enabled data twice */
+    ret = sr_module_change_subscribe(st->csess, "simple", "/simple:ac1/acl1[acs1='a']", dummy_change_cb, NULL, 0, 0,
+            &sub);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->csess, "/simple:ac1/acl1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    ret = sr_get_data(st->csess, "/simple:ac1/acl1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_print_mem(&str, data->tree, LYD_XML, LYD_PRINT_SHRINK | LYD_PRINT_WITHSIBLINGS);
+    sr_release_data(data);
+    assert_string_equal(str, "<ac1 xmlns=\"s\"><acl1><acs1>a</acs1></acl1></ac1>");
+    free(str);
+
+    /* subscribe to the whole module, all the data are enabled */
+    ret = sr_module_change_subscribe(st->csess, "simple", NULL, dummy_change_cb, NULL, 0, 0, &sub);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->csess, "/simple:ac1/acl1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_print_mem(&str, data->tree, LYD_XML, LYD_PRINT_SHRINK | LYD_PRINT_WITHSIBLINGS);
+    sr_release_data(data);
+    assert_string_equal(str, "<ac1 xmlns=\"s\"><acl1><acs1>a</acs1></acl1><acl1><acs1>b</acs1></acl1></ac1>");
+    free(str);
+
+    /* unsubscribe, no data are enabled */
+    sr_unsubscribe(sub);
+    ret = sr_get_items(st->csess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 0);
+    sr_free_values(values, count);
+
+    /* cleanup */
+    ret = sr_session_switch_ds(st->csess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(st->sess, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
 /* TEST */
 static void
 test_no_read_access(void **state)
@@ -363,21 +810,68 @@ test_explicit_default(void **state)
 }
 
 /* TEST */
-static int
-dummy_change_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath, sr_event_t event,
-        uint32_t request_id, void *private_data)
+static void
+test_partial_load(void **state)
 {
-    (void)session;
-    (void)sub_id;
-    (void)module_name;
-    (void)xpath;
-    (void)event;
-    (void)request_id;
-    (void)private_data;
+    struct state *st = (struct state *)*state;
+    sr_data_t *data;
+    struct lyd_node *node;
+    int ret;
 
-    return SR_ERR_OK;
+    /* set data in several top-level nodes */
+    ret = sr_set_item_str(st->sess, "/defaults:l1[k='a']/cont1/ll", "val", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/defaults:l2[k='b']/c1/lf1", "lf1-val", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/defaults:cont/l", "l-val", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* get data of a single top-level node */
+    ret = sr_get_data(st->sess, "/defaults:l2[k='b']/c1/lf1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "/defaults:l2[k='b']/c1/lf1", 0, &node));
+    assert_string_equal(lyd_get_value(node), "lf1-val");
+    sr_release_data(data);
+
+    /* get data depending on another top-level node */
+    ret = sr_get_data(st->sess, "/defaults:cont[/defaults:l1/k='a']/l", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "/defaults:cont/l", 0, &node));
+    assert_string_equal(lyd_get_value(node), "l-val");
+    sr_release_data(data);
+
+    ret = sr_get_data(st->sess, "/defaults:cont[/defaults:l1/k='c']/l", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_null(data);
+
+    /* get only limited depth of the data */
+    ret = sr_get_data(st->sess, "/defaults:l1", 1, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "/defaults:l1[k='a']", 0, &node));
+    assert_int_equal(LY_ENOTFOUND, lyd_find_path(data->tree, "/defaults:l1[k='a']/cont1", 0, &node));
+    sr_release_data(data);
+
+    /* the full data are still there */
+    ret = sr_get_data(st->sess, "/defaults:l1", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "/defaults:l1[k='a']/cont1/ll", 0, &node));
+    assert_string_equal(lyd_get_value(node), "val");
+    sr_release_data(data);
+
+    /* cleanup */
+    ret = sr_delete_item(st->sess, "/defaults:l1[k='a']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(st->sess, "/defaults:l2[k='b']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(st->sess, "/defaults:cont", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 }
 
+/* TEST */
 static int
 union_oper_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
         const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data)
@@ -528,6 +1022,7 @@ test_key(void **state)
 {
     struct state *st = (struct state *)*state;
     sr_data_t *data;
+    sr_val_t *val;
     char *str1;
     const char *str2;
     int ret;
@@ -554,7 +1049,217 @@ test_key(void **state)
     assert_string_equal(str1, str2);
     free(str1);
 
+    /* read the instances directly */
+    ret = sr_get_node(st->sess, "/defaults:l1[k='val']", 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "val");
+    sr_release_data(data);
+    ret = sr_get_item(st->sess, "/defaults:l1[k='val']/k", 0, &val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, "val");
+    sr_free_val(val);
+    ret = sr_get_node(st->sess, "/defaults:l1[k='val2']", 0, &data);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    ret = sr_get_item(st->sess, "/defaults:l1[k=\"val2\"]/k", 0, &val);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+
+    /* cleanup */
+    sr_delete_item(st->sess, "/defaults:l1", 0);
+    sr_apply_changes(st->sess, 0);
+}
+
+/* TEST */
+static void
+test_iter(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_get_data_iter_t *iter;
+    sr_data_t *data;
+    struct lyd_node *node;
+    char *str1, path[64];
+    const char *str2;
+    uint32_t i;
+    int ret;
+
+    /* set a list */
+    for (i = 0; i < 5; ++i) {
+        sprintf(path, "/defaults:l1[k='val%" PRIu32 "']", i);
+        ret = sr_set_item_str(st->sess, path, NULL, NULL, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read it in chunks */
+    ret = sr_get_data_iter_open(st->sess, "/defaults:l1", 0, 0, 0, NULL, &iter);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data_iter_next(iter, 2, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    assert_int_equal(ret, 0);
+    sr_release_data(data);
+    str2 =
+            "<l1 xmlns=\"urn:defaults\"><k>val0</k></l1>"
+            "<l1 xmlns=\"urn:defaults\"><k>val1</k></l1>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    ret = sr_get_data_iter_next(iter, 2, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+
+    ret = sr_get_data_iter_next(iter, 2, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    assert_int_equal(ret, 0);
+    sr_release_data(data);
+    str2 = "<l1 xmlns=\"urn:defaults\"><k>val4</k></l1>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    ret = sr_get_data_iter_next(iter, 2, &data);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+    assert_null(data);
+    sr_get_data_iter_free(iter);
+
+    /* resume after an instance */
+    ret = sr_get_data_iter_open(st->sess, "/defaults:l1", 0, 0, 0, "/defaults:l1[k='val2']", &iter);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data_iter_next(iter, 10, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    i = 0;
+    LY_LIST_FOR(data->tree, node) {
+        ++i;
+    }
+    assert_int_equal(i, 2);
+    sr_release_data(data);
+    sr_get_data_iter_free(iter);
+
+    /* resume after a missing instance */
+    ret = sr_get_data_iter_open(st->sess, "/defaults:l1", 0, 0, 0, "/defaults:l1[k='val9']", &iter);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+
+    /* cleanup */
+    sr_delete_item(st->sess, "/defaults:l1", 0);
+    sr_apply_changes(st->sess, 0);
+}
+
+/* TEST */
+static void
+test_values_arena(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_val_t *values, *arena_values, *dup_values;
+    size_t count, arena_count;
+    char path[64];
+    uint32_t i;
+    int ret;
+
+    /* set a list with enough instances to grow the arena */
+    for (i = 0; i < 200; ++i) {
+        sprintf(path, "/defaults:l1[k='val%" PRIu32 "']", i);
+        ret = sr_set_item_str(st->sess, path, NULL, NULL, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* get the values both ways */
+    ret = sr_get_items(st->sess, "/defaults:l1//.", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_items(st->sess, "/defaults:l1//.", 0, SR_GET_VALUES_ARENA, &arena_values, &arena_count);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* they must be equal */
+    assert_int_equal(count, arena_count);
+    for (i = 0; i < count; ++i) {
+        assert_true(sr_equal_val(&values[i], &arena_values[i]));
+        assert_string_equal(values[i].xpath, arena_values[i].xpath);
+    }
+
+    /* a duplicate is a standard array */
+    ret = sr_dup_values(arena_values, arena_count, &dup_values);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_free_values(arena_values, arena_count);
+    for (i = 0; i < count; ++i) {
+        assert_true(sr_equal_val(&values[i], &dup_values[i]));
+    }
+    sr_free_values(dup_values, count);
+    sr_free_values(values, count);
+
+    /* string data */
+    ret = sr_get_items(st->sess, "/defaults:l1/k", 0, SR_GET_VALUES_ARENA, &arena_values, &arena_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(arena_count, 200);
+    assert_int_equal(arena_values[0].type, SR_STRING_T);
+    assert_string_equal(arena_values[0].xpath, "/defaults:l1[k='val0']/k");
+    assert_string_equal(arena_values[0].data.string_val, "val0");
+    sr_free_values(arena_values, arena_count);
+
+    /* no values */
+    ret = sr_get_items(st->sess, "/defaults:l2", 0, SR_GET_VALUES_ARENA, &arena_values, &arena_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_null(arena_values);
+    assert_int_equal(arena_count, 0);
+
+    /* cleanup */
+    sr_delete_item(st->sess, "/defaults:l1", 0);
+    sr_apply_changes(st->sess, 0);
+}
+
+/* TEST */
+static void
+test_values_xpath(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const char *xpaths[] = {"/simple:ac1//.", "/defaults:pcont//.", "/defaults:l1//."};
+    sr_val_t *values;
+    sr_data_t *data;
+    struct ly_set *set;
+    size_t count;
+    char *path;
+    uint32_t i, j;
+    int ret;
+
+    /* set data with augments, keys needing both quotes, and leaf-lists */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1=\"it's\"]", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/defaults:pcont/ll", "7", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/defaults:pcont/ll2", "8", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/defaults:l1[k='x']/cont1/ll", "y", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    for (i = 0; i < sizeof xpaths / sizeof *xpaths; ++i) {
+        ret = sr_get_items(st->sess, xpaths[i], 0, 0, &values, &count);
+        assert_int_equal(ret, SR_ERR_OK);
+        ret = sr_get_data(st->sess, xpaths[i], 0, 0, 0, &data);
+        assert_int_equal(ret, SR_ERR_OK);
+
+        /* the generated paths must match the libyang ones */
+        assert_int_equal(lyd_find_xpath(data->tree, xpaths[i], &set), LY_SUCCESS);
+        assert_int_equal(set->count, count);
+        for (j = 0; j < count; ++j) {
+            path = lyd_path(set->dnodes[j], LYD_PATH_STD, NULL, 0);
+            assert_string_equal(values[j].xpath, path);
+            free(path);
+        }
+
+        ly_set_free(set, NULL);
+        sr_release_data(data);
+        sr_free_values(values, count);
+    }
+
     /* cleanup */
+    sr_delete_item(st->sess, "/simple:ac1", 0);
+    sr_delete_item(st->sess, "/defaults:pcont", 0);
     sr_delete_item(st->sess, "/defaults:l1", 0);
     sr_apply_changes(st->sess, 0);
 }
@@ -714,11 +1419,21 @@ main(void)
         cmocka_unit_test(test_invalid),
         cmocka_unit_test(test_cached_datastore),
         cmocka_unit_test(test_cached_thread),
+        cmocka_unit_test(test_cached_update),
+        cmocka_unit_test(test_cached_shared),
+        cmocka_unit_test(test_cached_ds),
+        cmocka_unit_test(test_cached_mem_limit),
+        cmocka_unit_test(test_cached_compact),
         cmocka_unit_test(test_enable_cached_get),
+        cmocka_unit_test(test_enabled_cached_oper),
         cmocka_unit_test(test_no_read_access),
         cmocka_unit_test(test_explicit_default),
+        cmocka_unit_test(test_partial_load),
         cmocka_unit_test(test_union),
         cmocka_unit_test(test_key),
+        cmocka_unit_test(test_iter),
+        cmocka_unit_test(test_values_arena),
+        cmocka_unit_test(test_values_xpath),
         cmocka_unit_test(test_factory_default),
         cmocka_unit_test(test_subtree2xpath),
     };
@@ -30,6 +30,8 @@
 #include <libyang/libyang.h>
 
 #include "sysrepo.h"
+
+#include "common.h"
 #include "tests/tcommon.h"
 
 struct state {
@@ -292,6 +294,54 @@ test_session_stop_unlock(void **state)
     sr_session_stop(sess2);
 }
 
+/* TEST */
+static void
+test_write_locked(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess1, *sess2;
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* lock all modules */
+    ret = sr_lock(sess1, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* other session cannot write */
+    ret = sr_set_item_str(sess2, "/test:test-leaf", "1", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0);
+    assert_int_equal(ret, SR_ERR_LOCKED);
+
+    /* the locking session can */
+    ret = sr_set_item_str(sess1, "/test:test-leaf", "2", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess1, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* unlock a single module, the other modules stay locked */
+    ret = sr_unlock(sess1, "test");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_lock(sess2, "ietf-interfaces", 0);
+    assert_int_equal(ret, SR_ERR_LOCKED);
+
+    /* cleanup, releases the locks */
+    ret = sr_delete_item(sess1, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess1, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess1);
+    ret = sr_lock(sess2, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess2);
+}
+
 /* TEST */
 static void
 test_get_lock(void **state)
@@ -434,6 +484,583 @@ test_timeout(void **state)
     pthread_join(tid[1], NULL);
 }
 
+/* TEST */
+#define RWLOCK_STRESS_READERS 4
+#define RWLOCK_STRESS_WRITERS 2
+#define RWLOCK_STRESS_THREADS (RWLOCK_STRESS_READERS + RWLOCK_STRESS_WRITERS)
+
+struct rwlock_stress {
+    sr_rwlock_t lock;
+    pthread_barrier_t barrier;
+    volatile uint32_t first;
+    volatile uint32_t second;
+    ATOMIC_T torn;
+};
+
+struct rwlock_stress_arg {
+    struct rwlock_stress *rs;
+    sr_conn_ctx_t *conn;
+};
+
+static void *
+rwlock_stress_reader_thread(void *arg)
+{
+    struct rwlock_stress_arg *a = arg;
+    sr_error_info_t *err_info;
+    uint32_t first, second;
+    int i;
+
+    pthread_barrier_wait(&a->rs->barrier);
+
+    for (i = 0; i < 20000; ++i) {
+        err_info = sr_rwlock(&a->rs->lock, 5000, SR_LOCK_READ, a->conn->cid, __func__, NULL, NULL);
+        assert_null(err_info);
+
+        /* the writer changes both values together */
+        first = a->rs->first;
+        second = a->rs->second;
+        if (first != second) {
+            ATOMIC_INC_RELAXED(a->rs->torn);
+        }
+
+        sr_rwunlock(&a->rs->lock, 5000, SR_LOCK_READ, a->conn->cid, __func__);
+    }
+
+    return NULL;
+}
+
+static void *
+rwlock_stress_writer_thread(void *arg)
+{
+    struct rwlock_stress_arg *a = arg;
+    sr_error_info_t *err_info;
+    int i;
+
+    pthread_barrier_wait(&a->rs->barrier);
+
+    for (i = 0; i < 2000; ++i) {
+        err_info = sr_rwlock(&a->rs->lock, 5000, SR_LOCK_WRITE, a->conn->cid, __func__, NULL, NULL);
+        assert_null(err_info);
+
+        a->rs->first = a->rs->first + 1;
+        a->rs->second = a->rs->first;
+
+        sr_rwunlock(&a->rs->lock, 5000, SR_LOCK_WRITE, a->conn->cid, __func__);
+    }
+
+    return NULL;
+}
+
+static void
+test_rwlock_stress(void **state)
+{
+    struct rwlock_stress rs = {0};
+    struct rwlock_stress_arg args[RWLOCK_STRESS_THREADS];
+    pthread_t tid[RWLOCK_STRESS_THREADS];
+    sr_error_info_t *err_info;
+    int i, ret;
+
+    (void)state;
+
+    err_info = sr_rwlock_init(&rs.lock, 0);
+    assert_null(err_info);
+    pthread_barrier_init(&rs.barrier, NULL, RWLOCK_STRESS_THREADS);
+
+    /* every thread uses its own connection so that readers are not recursive and recovery sees them alive */
+    for (i = 0; i < RWLOCK_STRESS_THREADS; ++i) {
+        args[i].rs = &rs;
+        ret = sr_connect(0, &args[i].conn);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    for (i = 0; i < RWLOCK_STRESS_THREADS; ++i) {
+        pthread_create(&tid[i], NULL, (i < RWLOCK_STRESS_READERS) ? rwlock_stress_reader_thread :
+                rwlock_stress_writer_thread, &args[i]);
+    }
+    for (i = 0; i < RWLOCK_STRESS_THREADS; ++i) {
+        pthread_join(tid[i], NULL);
+    }
+
+    /* no reader saw a partial change and no write was lost */
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rs.torn), 0);
+    assert_int_equal(rs.first, RWLOCK_STRESS_WRITERS * 2000);
+    assert_int_equal(rs.second, rs.first);
+    assert_false(sr_rwlock_has_readers(&rs.lock));
+
+    for (i = 0; i < RWLOCK_STRESS_THREADS; ++i) {
+        sr_disconnect(args[i].conn);
+    }
+    pthread_barrier_destroy(&rs.barrier);
+    sr_rwlock_destroy(&rs.lock);
+}
+
+/* TEST */
+#define RWLOCK_FAIR_READERS 3
+#define RWLOCK_FAIR_WAIT_MS 50
+
+struct rwlock_fair {
+    sr_rwlock_t lock;
+    ATOMIC_T stop;
+    ATOMIC_T started;
+    ATOMIC_T wr_locked;
+    sr_conn_ctx_t *conn[RWLOCK_FAIR_READERS + 1];
+};
+
+struct rwlock_fair_arg {
+    struct rwlock_fair *rf;
+    sr_conn_ctx_t *conn;
+};
+
+static uint32_t
+rwlock_fair_msdiff(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void
+rwlock_fair_init(struct rwlock_fair *rf)
+{
+    sr_error_info_t *err_info;
+    int i, ret;
+
+    memset(rf, 0, sizeof *rf);
+    err_info = sr_rwlock_init(&rf->lock, 0);
+    assert_null(err_info);
+    rf->lock.fair_wait_ms = RWLOCK_FAIR_WAIT_MS;
+
+    /* the CIDs must be of alive connections, otherwise their locks are recovered */
+    for (i = 0; i < RWLOCK_FAIR_READERS + 1; ++i) {
+        ret = sr_connect(0, &rf->conn[i]);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+}
+
+static void
+rwlock_fair_destroy(struct rwlock_fair *rf)
+{
+    int i;
+
+    assert_false(sr_rwlock_has_readers(&rf->lock));
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf->lock.fair_writer), 0);
+
+    for (i = 0; i < RWLOCK_FAIR_READERS + 1; ++i) {
+        sr_disconnect(rf->conn[i]);
+    }
+    sr_rwlock_destroy(&rf->lock);
+}
+
+static void
+rwlock_fair_wait_writer(struct rwlock_fair *rf, sr_cid_t cid)
+{
+    int i;
+
+    /* the writer blocks new readers after waiting for RWLOCK_FAIR_WAIT_MS */
+    for (i = 0; (i < 200) && (ATOMIC_LOAD_RELAXED(rf->lock.fair_writer) != cid); ++i) {
+        usleep(10000);
+    }
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf->lock.fair_writer), cid);
+}
+
+static void *
+rwlock_fair_reader_thread(void *arg)
+{
+    struct rwlock_fair_arg *a = arg;
+    sr_error_info_t *err_info;
+
+    ATOMIC_INC_RELAXED(a->rf->started);
+    while (!ATOMIC_LOAD_RELAXED(a->rf->stop)) {
+        err_info = sr_rwlock(&a->rf->lock, 5000, SR_LOCK_READ, a->conn->cid, __func__, NULL, NULL);
+        assert_null(err_info);
+
+        /* readers overlap so that there is always one holding the lock */
+        usleep(2000);
+
+        sr_rwunlock(&a->rf->lock, 5000, SR_LOCK_READ, a->conn->cid, __func__);
+    }
+
+    return NULL;
+}
+
+static void *
+rwlock_fair_writer_thread(void *arg)
+{
+    struct rwlock_fair_arg *a = arg;
+    sr_error_info_t *err_info;
+
+    err_info = sr_rwlock(&a->rf->lock, 5000, SR_LOCK_WRITE, a->conn->cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    ATOMIC_STORE_RELAXED(a->rf->wr_locked, 1);
+
+    sr_rwunlock(&a->rf->lock, 5000, SR_LOCK_WRITE, a->conn->cid, __func__);
+    return NULL;
+}
+
+static void
+test_rwlock_fair_storm(void **state)
+{
+    struct rwlock_fair rf;
+    struct rwlock_fair_arg args[RWLOCK_FAIR_READERS];
+    pthread_t tid[RWLOCK_FAIR_READERS];
+    sr_error_info_t *err_info;
+    struct timespec start;
+    sr_cid_t cid;
+    int i;
+
+    (void)state;
+
+    rwlock_fair_init(&rf);
+    cid = rf.conn[RWLOCK_FAIR_READERS]->cid;
+
+    /* start a reader storm */
+    for (i = 0; i < RWLOCK_FAIR_READERS; ++i) {
+        args[i].rf = &rf;
+        args[i].conn = rf.conn[i];
+        pthread_create(&tid[i], NULL, rwlock_fair_reader_thread, &args[i]);
+    }
+    while (ATOMIC_LOAD_RELAXED(rf.started) < RWLOCK_FAIR_READERS) {
+        usleep(1000);
+    }
+    usleep(10000);
+
+    /* the writer blocks new readers after the fair wait and then waits only for the current ones to finish */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    err_info = sr_rwlock(&rf.lock, 5000, SR_LOCK_WRITE, cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    assert_true(rwlock_fair_msdiff(&start) < RWLOCK_FAIR_WAIT_MS + 500);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.lock.fair_writer), 0);
+    ATOMIC_STORE_RELAXED(rf.stop, 1);
+    sr_rwunlock(&rf.lock, 5000, SR_LOCK_WRITE, cid, __func__);
+
+    for (i = 0; i < RWLOCK_FAIR_READERS; ++i) {
+        pthread_join(tid[i], NULL);
+    }
+    rwlock_fair_destroy(&rf);
+}
+
+static void
+test_rwlock_fair_recursive(void **state)
+{
+    struct rwlock_fair rf;
+    struct rwlock_fair_arg arg;
+    pthread_t tid;
+    sr_error_info_t *err_info;
+    sr_cid_t rd_cid, new_cid;
+
+    (void)state;
+
+    rwlock_fair_init(&rf);
+    rd_cid = rf.conn[0]->cid;
+    new_cid = rf.conn[1]->cid;
+
+    /* hold a read lock */
+    err_info = sr_rwlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+
+    /* a writer starts blocking new readers */
+    arg.rf = &rf;
+    arg.conn = rf.conn[RWLOCK_FAIR_READERS];
+    pthread_create(&tid, NULL, rwlock_fair_writer_thread, &arg);
+    rwlock_fair_wait_writer(&rf, arg.conn->cid);
+
+    /* a new reader is blocked */
+    err_info = sr_rwlock(&rf.lock, 100, SR_LOCK_READ, new_cid, __func__, NULL, NULL);
+    assert_non_null(err_info);
+    assert_int_equal(err_info->err[0].err_code, SR_ERR_TIME_OUT);
+    sr_errinfo_free(&err_info);
+
+    /* the recursive read lock is not, the writer waits for it */
+    err_info = sr_rwlock(&rf.lock, 100, SR_LOCK_READ, rd_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 0);
+
+    /* the writer gets the lock once both are released */
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__);
+    pthread_join(tid, NULL);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 1);
+
+    rwlock_fair_destroy(&rf);
+}
+
+static void *
+rwlock_fair_upgr_thread(void *arg)
+{
+    struct rwlock_fair_arg *a = arg;
+    sr_error_info_t *err_info;
+
+    /* relock to WRITE while a fair writer is waiting */
+    err_info = sr_rwrelock(&a->rf->lock, 2000, SR_LOCK_WRITE, a->conn->cid, __func__, NULL, NULL);
+    assert_null(err_info);
+
+    /* the other writer waits because the upgraded lock is still held */
+    assert_int_equal(ATOMIC_LOAD_RELAXED(a->rf->wr_locked), 0);
+
+    sr_rwunlock(&a->rf->lock, 2000, SR_LOCK_WRITE, a->conn->cid, __func__);
+    return NULL;
+}
+
+static void
+test_rwlock_fair_upgr(void **state)
+{
+    struct rwlock_fair rf;
+    struct rwlock_fair_arg wr_arg, upgr_arg;
+    pthread_t wr_tid, upgr_tid;
+    sr_error_info_t *err_info;
+    sr_cid_t upgr_cid, rd_cid;
+
+    (void)state;
+
+    rwlock_fair_init(&rf);
+    upgr_cid = rf.conn[0]->cid;
+    rd_cid = rf.conn[1]->cid;
+
+    /* hold a read-upgr and a read lock */
+    err_info = sr_rwlock(&rf.lock, 1000, SR_LOCK_READ_UPGR, upgr_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    err_info = sr_rwlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+
+    /* a writer starts blocking new readers */
+    wr_arg.rf = &rf;
+    wr_arg.conn = rf.conn[RWLOCK_FAIR_READERS];
+    pthread_create(&wr_tid, NULL, rwlock_fair_writer_thread, &wr_arg);
+    rwlock_fair_wait_writer(&rf, wr_arg.conn->cid);
+
+    /* upgrade the read-upgr lock, it waits only for the reader */
+    upgr_arg.rf = &rf;
+    upgr_arg.conn = rf.conn[0];
+    pthread_create(&upgr_tid, NULL, rwlock_fair_upgr_thread, &upgr_arg);
+    usleep(20000);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__);
+
+    /* both the upgraded lock and the writer succeed */
+    pthread_join(upgr_tid, NULL);
+    pthread_join(wr_tid, NULL);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 1);
+
+    rwlock_fair_destroy(&rf);
+}
+
+static void
+test_rwlock_fair_dead(void **state)
+{
+    struct rwlock_fair rf;
+    sr_conn_ctx_t *conn;
+    sr_error_info_t *err_info;
+    sr_cid_t dead_cid;
+    int ret;
+
+    (void)state;
+
+    rwlock_fair_init(&rf);
+
+    /* a writer blocking new readers crashed */
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    dead_cid = conn->cid;
+    sr_disconnect(conn);
+    ATOMIC_STORE_RELAXED(rf.lock.fair_writer, dead_cid);
+
+    /* a reader recovers the lock and is not blocked anymore */
+    err_info = sr_rwlock(&rf.lock, 100, SR_LOCK_READ, rf.conn[0]->cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.lock.fair_writer), 0);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rf.conn[0]->cid, __func__);
+
+    /* readers lock without waiting again */
+    err_info = sr_rwlock(&rf.lock, 10, SR_LOCK_READ, rf.conn[1]->cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rf.conn[1]->cid, __func__);
+
+    rwlock_fair_destroy(&rf);
+}
+
+static void *
+rwlock_fair_urge_thread(void *arg)
+{
+    struct rwlock_fair_arg *a = arg;
+    sr_error_info_t *err_info;
+
+    err_info = sr_rwlock(&a->rf->lock, 5000, SR_LOCK_WRITE_URGE, a->conn->cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    ATOMIC_STORE_RELAXED(a->rf->wr_locked, 1);
+
+    sr_rwunlock(&a->rf->lock, 5000, SR_LOCK_WRITE, a->conn->cid, __func__);
+    return NULL;
+}
+
+static void
+test_rwlock_fair_nofair(void **state)
+{
+    struct rwlock_fair rf;
+    struct rwlock_fair_arg arg;
+    pthread_t tid;
+    sr_error_info_t *err_info;
+    sr_cid_t rd_cid, ev_cid;
+    int i;
+
+    (void)state;
+
+    rwlock_fair_init(&rf);
+    rd_cid = rf.conn[0]->cid;
+    ev_cid = rf.conn[1]->cid;
+    arg.rf = &rf;
+    arg.conn = rf.conn[RWLOCK_FAIR_READERS];
+
+    /* hold a read lock and let a writer start blocking new readers */
+    err_info = sr_rwlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    pthread_create(&tid, NULL, rwlock_fair_writer_thread, &arg);
+    rwlock_fair_wait_writer(&rf, arg.conn->cid);
+
+    /* a new reader ignoring the policy is not blocked */
+    err_info = sr_rwlock_nofair(&rf.lock, 100, SR_LOCK_READ, ev_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 0);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, ev_cid, __func__);
+
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__);
+    pthread_join(tid, NULL);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 1);
+
+    /* hold a read lock and let an urged writer wait for it */
+    ATOMIC_STORE_RELAXED(rf.wr_locked, 0);
+    err_info = sr_rwlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    pthread_create(&tid, NULL, rwlock_fair_urge_thread, &arg);
+    for (i = 0; (i < 200) && (rf.lock.writer != arg.conn->cid); ++i) {
+        usleep(10000);
+    }
+    assert_int_equal(rf.lock.writer, arg.conn->cid);
+
+    /* a new reader is blocked */
+    err_info = sr_rwlock(&rf.lock, 100, SR_LOCK_READ, ev_cid, __func__, NULL, NULL);
+    assert_non_null(err_info);
+    assert_int_equal(err_info->err[0].err_code, SR_ERR_TIME_OUT);
+    sr_errinfo_free(&err_info);
+
+    /* a new reader ignoring the policy joins the current one, the writer waits for both */
+    err_info = sr_rwlock_nofair(&rf.lock, 100, SR_LOCK_READ, ev_cid, __func__, NULL, NULL);
+    assert_null(err_info);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, rd_cid, __func__);
+    usleep(20000);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 0);
+    sr_rwunlock(&rf.lock, 1000, SR_LOCK_READ, ev_cid, __func__);
+
+    pthread_join(tid, NULL);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(rf.wr_locked), 1);
+
+    rwlock_fair_destroy(&rf);
+}
+
+/* TEST */
+struct event_read {
+    sr_conn_ctx_t *conn;
+    pthread_barrier_t barrier;
+    int read_ret;
+};
+
+static int
+event_read_change_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    struct event_read *er = private_data;
+    sr_data_t *data = NULL;
+
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event != SR_EV_CHANGE) {
+        return SR_ERR_OK;
+    }
+
+    /* sync #1 */
+    pthread_barrier_wait(&er->barrier);
+
+    /* let the writer wait long enough to block new readers */
+    usleep((SR_MOD_LOCK_FAIR_WAIT + 200) * 1000);
+
+    /* the writer waits for the originator, which waits for this callback */
+    er->read_ret = sr_get_data(session, "/test:*", 0, 1000, 0, &data);
+    sr_release_data(data);
+
+    return SR_ERR_OK;
+}
+
+static void *
+event_read_order_thread(void *arg)
+{
+    struct event_read *er = arg;
+    uint32_t prio;
+    int ret;
+
+    ret = sr_module_change_get_order(er->conn, "test", SR_DS_RUNNING, &prio);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* sync #1 */
+    pthread_barrier_wait(&er->barrier);
+
+    /* WRITE lock the module while it is being changed */
+    ret = sr_module_change_set_order(er->conn, "test", SR_DS_RUNNING, prio);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    return NULL;
+}
+
+static void
+test_event_sess_read(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct event_read er = {0};
+    sr_conn_ctx_t *sub_conn;
+    sr_session_ctx_t *sess, *sub_sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    pthread_t tid;
+    int ret;
+
+    ret = sr_connect(0, &sub_conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_connect(0, &er.conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    pthread_barrier_init(&er.barrier, NULL, 2);
+    er.read_ret = SR_ERR_INTERNAL;
+
+    ret = sr_session_start(sub_conn, SR_DS_RUNNING, &sub_sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_module_change_subscribe(sub_sess, "test", NULL, event_read_change_cb, &er, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* another connection starts WRITE locking the module once the callback is called */
+    pthread_create(&tid, NULL, event_read_order_thread, &er);
+
+    /* change the module, the callback reads it */
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/test:test-leaf", "1", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(er.read_ret, SR_ERR_OK);
+
+    pthread_join(tid, NULL);
+
+    /* cleanup */
+    ret = sr_delete_item(sess, "/test:test-leaf", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+    sr_unsubscribe(subscr);
+    sr_disconnect(sub_conn);
+    sr_disconnect(er.conn);
+    pthread_barrier_destroy(&er.barrier);
+}
+
 /* MAIN */
 int
 main(void)
@@ -442,8 +1069,16 @@ main(void)
         cmocka_unit_test(test_one_session),
         cmocka_unit_test(test_multi_session),
         cmocka_unit_test(test_session_stop_unlock),
+        cmocka_unit_test(test_write_locked),
         cmocka_unit_test(test_get_lock),
         cmocka_unit_test(test_timeout),
+        cmocka_unit_test(test_rwlock_stress),
+        cmocka_unit_test(test_rwlock_fair_storm),
+        cmocka_unit_test(test_rwlock_fair_recursive),
+        cmocka_unit_test(test_rwlock_fair_upgr),
+        cmocka_unit_test(test_rwlock_fair_dead),
+        cmocka_unit_test(test_rwlock_fair_nofair),
+        cmocka_unit_test(test_event_sess_read),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
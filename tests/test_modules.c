@@ -515,6 +515,7 @@ test_inv_deps(void **state)
             "</xpath>"
             "</deps>"
             "<inverse-deps>ietf-routing</inverse-deps>"
+            "<schema-deps>ietf-routing</schema-deps>"
             "</module>");
 
     /* remove augment */
@@ -622,6 +623,7 @@ test_update_module(void **state)
             "<plugin><datastore>ds:operational</datastore><name>" SR_DEFAULT_OPERATIONAL_DS "</name></plugin>"
             "<plugin><datastore>fd:factory-default</datastore><name>" SR_DEFAULT_FACTORY_DEFAULT_DS "</name></plugin>"
             "<plugin><datastore>notification</datastore><name>" SR_DEFAULT_NOTIFICATION_DS "</name></plugin>"
+            "<schema-deps>rev-ref</schema-deps>"
             "<notification>"
             "<path xmlns:r=\"urn:rev\">/r:notif</path>"
             "</notification>"
@@ -1006,6 +1008,7 @@ test_foreign_aug(void **state)
             "<expression>starts-with(acs1,'aa')</expression>"
             "</xpath>"
             "</deps>"
+            "<schema-deps>aug</schema-deps>"
             "</module>");
 
     /* fail because of dep */
@@ -1056,6 +1059,7 @@ test_foreign_aug(void **state)
             "<expression>starts-with(acs1,'aa')</expression>"
             "</xpath>"
             "</deps>"
+            "<schema-deps>aug</schema-deps>"
             "</module>");
 
     /* cleanup */
@@ -1158,6 +1162,7 @@ test_startup_data_foreign_identityref(void **state)
             "<expression xmlns:t1=\"http://www.example.net/t1\" xmlns:tt=\"http://www.example.net/t-types\">t1:layer-protocol-name='tt:desc'</expression>"
             "</xpath>"
             "</deps>"
+            "<schema-deps>t2</schema-deps>"
             "</module>");
     cmp_int_data(st->conn, "t2",
             "<module xmlns=\"http://www.sysrepo.org/yang/sysrepo\">"
@@ -1568,6 +1573,112 @@ test_running_disabled(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+static void
+test_lyb_plugin(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const sr_module_ds_t mod_ds = {{"LYB DS file", "LYB DS file", "LYB DS file", "LYB DS file", "LYB DS file",
+            "JSON notif"}};
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    int ret;
+
+    /* install a module with all the data in LYB files */
+    ret = sr_install_module2(st->conn, TESTS_SRC_DIR "/files/simple.yang", TESTS_SRC_DIR "/files", NULL, &mod_ds, NULL,
+            NULL, 0, NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* store some 'running' data and copy them into 'startup' */
+    ret = sr_set_item_str(sess, "/simple:ac1/acd1", "false", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_switch_ds(sess, SR_DS_STARTUP);
+    ret = sr_copy_config(sess, "simple", SR_DS_RUNNING, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* context change, the data are stored again */
+    ret = sr_install_module(st->conn, TESTS_SRC_DIR "/files/test-cont.yang", TESTS_SRC_DIR "/files", NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* load the data from both datastores */
+    ret = sr_get_data(sess, "/simple:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "false");
+    sr_release_data(data);
+    sr_session_switch_ds(sess, SR_DS_RUNNING);
+    ret = sr_get_data(sess, "/simple:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "false");
+    sr_release_data(data);
+
+    /* cleanup */
+    sr_session_stop(sess);
+    ret = sr_remove_module(st->conn, "test-cont", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_remove_module(st->conn, "simple", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
+static void
+test_shm_plugin(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const sr_module_ds_t mod_ds = {{"JSON DS file", "JSON DS file", "JSON DS file", "SHM DS", "JSON DS file",
+            "JSON notif"}};
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    int ret;
+
+    /* install a module with operational data in SHM */
+    ret = sr_install_module2(st->conn, TESTS_SRC_DIR "/files/simple.yang", TESTS_SRC_DIR "/files", NULL, &mod_ds, NULL,
+            NULL, 0, NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(st->conn, SR_DS_OPERATIONAL, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* store some push operational data, twice so that the segment is rewritten */
+    ret = sr_set_item_str(sess, "/simple:ac1/acd1", "true", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/simple:ac1/acd1", "false", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* context change, the data are stored again */
+    ret = sr_install_module(st->conn, TESTS_SRC_DIR "/files/test-cont.yang", TESTS_SRC_DIR "/files", NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* load the data */
+    ret = sr_get_data(sess, "/simple:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "false");
+    sr_release_data(data);
+
+    /* discard them, the default value is back */
+    ret = sr_discard_items(sess, "/simple:ac1");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(sess, "/simple:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_string_equal(lyd_get_value(lyd_child(data->tree)), "true");
+    sr_release_data(data);
+
+    /* cleanup */
+    sr_session_stop(sess);
+    ret = sr_remove_module(st->conn, "test-cont", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_remove_module(st->conn, "simple", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
 int
 main(void)
 {
@@ -1591,6 +1702,8 @@ main(void)
         cmocka_unit_test_setup_teardown(test_update_data_deviation, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_update_data_no_write_perm, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_running_disabled, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyb_plugin, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_shm_plugin, setup_f, teardown_f),
     };
 
     test_log_init();
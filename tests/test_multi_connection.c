@@ -20,6 +20,7 @@
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -420,6 +421,165 @@ test_sub_suspend(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+static int
+module_spin_wait_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    int *cb_called = private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event == SR_EV_DONE) {
+        ++(*cb_called);
+    }
+    return SR_ERR_OK;
+}
+
+static void
+test_spin_wait(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    char path[64];
+    int ret, i, cb_called = 0;
+
+    /* connection busy-waiting for the subscribers */
+    ret = sr_connect(SR_CONN_SUB_SPIN_WAIT, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_module_change_subscribe(st->sess2, "ietf-interfaces", NULL, module_spin_wait_cb, &cb_called, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* every change is processed by the subscriber */
+    for (i = 0; i < 20; ++i) {
+        sprintf(path, "/ietf-interfaces:interfaces/interface[name='eth%d']/type", i);
+        ret = sr_set_item_str(sess, path, "iana-if-type:ethernetCsmacd", NULL, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+        ret = sr_apply_changes(sess, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    assert_int_equal(cb_called, 20);
+
+    sr_unsubscribe(subscr);
+    sr_disconnect(conn);
+}
+
+struct group_commit_arg {
+    sr_conn_ctx_t *conn;
+    pthread_barrier_t *barrier;
+    int idx;
+    int ret;
+};
+
+static void *
+group_commit_thread(void *arg)
+{
+    struct group_commit_arg *gc_arg = arg;
+    sr_session_ctx_t *sess;
+    char path[64];
+    int ret;
+
+    ret = sr_session_start(gc_arg->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the last 2 threads create the same interface */
+    sprintf(path, "/ietf-interfaces:interfaces/interface[name='eth%d']", (gc_arg->idx > 8) ? 8 : gc_arg->idx);
+    ret = sr_set_item_str(sess, path, NULL, NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    strcat(path, "/type");
+    ret = sr_set_item_str(sess, path, "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    pthread_barrier_wait(gc_arg->barrier);
+    gc_arg->ret = sr_apply_changes(sess, 0);
+
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static int
+module_group_commit_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        sr_event_t event, uint32_t request_id, void *private_data)
+{
+    int *cb_called = private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_id;
+
+    if (event == SR_EV_DONE) {
+        ++(*cb_called);
+    }
+    return SR_ERR_OK;
+}
+
+static void
+test_group_commit(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const int thread_count = 10;
+    struct group_commit_arg args[thread_count];
+    pthread_t tid[thread_count];
+    pthread_barrier_t barrier;
+    sr_conn_ctx_t *conn;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_val_t *values;
+    size_t value_count;
+    int ret, i, ok_count = 0, cb_called = 0;
+
+    /* connection applying concurrent commits together */
+    ret = sr_connect(SR_CONN_GROUP_COMMIT, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_module_change_subscribe(st->sess2, "ietf-interfaces", NULL, module_group_commit_cb, &cb_called, 0, 0,
+            &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    pthread_barrier_init(&barrier, NULL, thread_count);
+    for (i = 0; i < thread_count; ++i) {
+        args[i].conn = conn;
+        args[i].barrier = &barrier;
+        args[i].idx = i;
+        pthread_create(&tid[i], NULL, group_commit_thread, &args[i]);
+    }
+    for (i = 0; i < thread_count; ++i) {
+        pthread_join(tid[i], NULL);
+        if (args[i].ret == SR_ERR_OK) {
+            ++ok_count;
+        } else {
+            assert_int_equal(args[i].ret, SR_ERR_EXISTS);
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+
+    /* every commit got its own result */
+    assert_int_equal(ok_count, thread_count - 1);
+
+    /* subscriber was not notified more than once per commit */
+    assert_int_not_equal(cb_called, 0);
+    assert_true(cb_called <= ok_count);
+
+    /* all the interfaces were created */
+    ret = sr_get_items(st->sess3, "/ietf-interfaces:interfaces/interface", 0, 0, &values, &value_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(value_count, thread_count - 1);
+    sr_free_values(values, value_count);
+
+    sr_unsubscribe(subscr);
+    sr_disconnect(conn);
+}
+
 int
 main(void)
 {
@@ -427,6 +587,8 @@ main(void)
         cmocka_unit_test_teardown(test_create1, clear_interfaces),
         cmocka_unit_test(test_new),
         cmocka_unit_test_teardown(test_sub_suspend, clear_interfaces),
+        cmocka_unit_test_teardown(test_spin_wait, clear_interfaces),
+        cmocka_unit_test_teardown(test_group_commit, clear_interfaces),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
@@ -19,6 +19,7 @@
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -815,6 +816,308 @@ test_read_var(void **state)
     free(str);
 }
 
+/* TEST */
+static int
+setup_oper_denied_nacm(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const struct ly_ctx *ctx;
+    const char *data;
+    struct lyd_node *edit;
+
+    /* set NACM */
+    data = "<nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\">\n"
+            "  <enable-external-groups>false</enable-external-groups>\n"
+            "  <groups>\n"
+            "    <group>\n"
+            "      <name>test-group</name>\n"
+            "      <user-name>test-user</user-name>\n"
+            "    </group>\n"
+            "  </groups>\n"
+            "  <rule-list>\n"
+            "    <name>rule1</name>\n"
+            "    <group>test-group</group>\n"
+            "    <rule>\n"
+            "      <name>deny-cont</name>\n"
+            "      <module-name>test</module-name>\n"
+            "      <path xmlns:t=\"urn:test\">/t:cont</path>\n"
+            "      <access-operations>read</access-operations>\n"
+            "      <action>deny</action>\n"
+            "    </rule>\n"
+            "  </rule-list>\n"
+            "</nacm>\n";
+    ctx = sr_acquire_context(st->conn);
+    if (lyd_parse_data_mem(ctx, data, LYD_XML, LYD_PARSE_STRICT | LYD_PARSE_ONLY, 0, &edit)) {
+        return 1;
+    }
+    if (sr_edit_batch(st->sess, edit, "merge")) {
+        return 1;
+    }
+    lyd_free_siblings(edit);
+    sr_release_context(st->conn);
+    if (sr_apply_changes(st->sess, 0)) {
+        return 1;
+    }
+
+    /* set user */
+    if (sr_nacm_set_user(st->sess, "test-user")) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static int
+oper_denied_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    int *called = private_data;
+    const struct ly_ctx *ly_ctx;
+
+    (void)sub_id;
+    (void)module_name;
+    (void)request_xpath;
+    (void)request_id;
+
+    ly_ctx = sr_session_acquire_context(session);
+
+    if (!strcmp(xpath, "/test:cont")) {
+        ++called[0];
+        assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, ly_ctx, "/test:cont/ll2", "5", 0, parent));
+    } else {
+        ++called[1];
+        assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, ly_ctx, "/test:test-leaf", "7", 0, parent));
+    }
+
+    sr_session_release_context(session);
+    return SR_ERR_OK;
+}
+
+static void
+test_oper_denied(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *sub = NULL;
+    sr_data_t *data;
+    char *str;
+    int ret, called[2] = {0};
+
+    ret = sr_oper_get_subscribe(st->sess, "test", "/test:cont", oper_denied_cb, called, 0, &sub);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_oper_get_subscribe(st->sess, "test", "/test:test-leaf", oper_denied_cb, called, 0, &sub);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the provider of denied data is not called at all */
+    ret = sr_get_data(st->sess, "/test:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = lyd_print_mem(&str, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    assert_int_equal(ret, LY_SUCCESS);
+    sr_release_data(data);
+    assert_string_equal(str, "<test-leaf xmlns=\"urn:test\">7</test-leaf>\n");
+    free(str);
+    assert_int_equal(called[0], 0);
+    assert_int_equal(called[1], 1);
+
+    /* without NACM both are called */
+    ret = sr_nacm_set_user(st->sess, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->sess, "/test:cont", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(data);
+    sr_release_data(data);
+    assert_int_equal(called[0], 1);
+
+    sr_unsubscribe(sub);
+    ret = sr_session_switch_ds(st->sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
+/* TEST */
+static int
+setup_read_large_nacm(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const struct ly_ctx *ctx;
+    const char *data;
+    struct lyd_node *edit;
+    char path[64], value[16];
+    int i;
+
+    /* set NACM */
+    data = "<nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\">\n"
+            "  <enable-external-groups>false</enable-external-groups>\n"
+            "  <groups>\n"
+            "    <group>\n"
+            "      <name>test-group</name>\n"
+            "      <user-name>test-user</user-name>\n"
+            "    </group>\n"
+            "  </groups>\n"
+            "  <rule-list>\n"
+            "    <name>rule1</name>\n"
+            "    <group>test-group</group>\n"
+            "    <rule>\n"
+            "      <name>forbid-v</name>\n"
+            "      <module-name>test</module-name>\n"
+            "      <path xmlns:t=\"urn:test\">/t:cont/t:l2/t:v</path>\n"
+            "      <access-operations>read</access-operations>\n"
+            "      <action>deny</action>\n"
+            "    </rule>\n"
+            "    <rule>\n"
+            "      <name>forbid-k2-list</name>\n"
+            "      <module-name>test</module-name>\n"
+            "      <path xmlns:t=\"urn:test\">/t:cont/t:l2[t:k='k2']</path>\n"
+            "      <access-operations>read</access-operations>\n"
+            "      <action>deny</action>\n"
+            "    </rule>\n"
+            "  </rule-list>\n"
+            "</nacm>\n";
+    ctx = sr_acquire_context(st->conn);
+    if (lyd_parse_data_mem(ctx, data, LYD_XML, LYD_PARSE_STRICT | LYD_PARSE_ONLY, 0, &edit)) {
+        return 1;
+    }
+    if (sr_edit_batch(st->sess, edit, "merge")) {
+        return 1;
+    }
+    lyd_free_siblings(edit);
+    sr_release_context(st->conn);
+
+    /* enough list instances to be filtered in parallel */
+    for (i = 0; i < 5000; ++i) {
+        sprintf(path, "/test:cont/l2[k='k%d']/v", i);
+        sprintf(value, "%d", i % 256);
+        if (sr_set_item_str(st->sess, path, value, NULL, 0)) {
+            return 1;
+        }
+    }
+    if (sr_apply_changes(st->sess, 0)) {
+        return 1;
+    }
+
+    /* set user */
+    if (sr_nacm_set_user(st->sess, "test-user")) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static void
+test_read_large(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_data_t *data;
+    struct ly_set *set;
+    int ret;
+
+    ret = sr_get_data(st->sess, "/test:cont", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* all the instances except one, without values */
+    ret = lyd_find_xpath(data->tree, "/test:cont/l2", &set);
+    assert_int_equal(ret, LY_SUCCESS);
+    assert_int_equal(set->count, 4999);
+    ly_set_free(set, NULL);
+
+    ret = lyd_find_xpath(data->tree, "/test:cont/l2[k='k2'] | /test:cont/l2/v", &set);
+    assert_int_equal(ret, LY_SUCCESS);
+    assert_int_equal(set->count, 0);
+    ly_set_free(set, NULL);
+
+    ret = lyd_find_xpath(data->tree, "/test:cont/l2[k='k4999']/k", &set);
+    assert_int_equal(ret, LY_SUCCESS);
+    assert_int_equal(set->count, 1);
+    ly_set_free(set, NULL);
+
+    sr_release_data(data);
+
+    /* the path rules were evaluated for every instance */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->sess, "/sysrepo-monitoring:sysrepo-state/connection/nacm-stats", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_find_xpath(data->tree, "/sysrepo-monitoring:sysrepo-state/connection/nacm-stats/"
+            "rule[rule-list='rule1'][name='forbid-k2-list'][path-evaluations >= 5000][hits >= 1]", &set);
+    assert_int_equal(ret, LY_SUCCESS);
+    assert_int_equal(set->count, 1);
+    ly_set_free(set, NULL);
+    sr_release_data(data);
+    ret = sr_session_switch_ds(st->sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
+/* TEST */
+static void
+test_cache_change(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    char *str;
+    int ret;
+
+    /* the rules of the user are cached */
+    ret = sr_get_data(st->sess, "/test:cont/l2", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_print_mem(&str, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    assert_int_equal(ret, LY_SUCCESS);
+    sr_release_data(data);
+    assert_string_equal(str,
+            "<cont xmlns=\"urn:test\">\n"
+            "  <l2>\n"
+            "    <k>k1</k>\n"
+            "  </l2>\n"
+            "</cont>\n");
+    free(str);
+
+    /* a new rule is used for the next check */
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-netconf-acm:nacm/rule-list[name='rule1']/rule[name='allow-value']/module-name",
+            "test", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-netconf-acm:nacm/rule-list[name='rule1']/rule[name='allow-value']/path",
+            "/test:cont/test:l2/test:v", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-netconf-acm:nacm/rule-list[name='rule1']/rule[name='allow-value']/"
+            "access-operations", "read", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-netconf-acm:nacm/rule-list[name='rule1']/rule[name='allow-value']/action",
+            "permit", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(st->sess, "/test:cont/l2", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = lyd_print_mem(&str, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    assert_int_equal(ret, LY_SUCCESS);
+    sr_release_data(data);
+    assert_string_equal(str,
+            "<cont xmlns=\"urn:test\">\n"
+            "  <l2>\n"
+            "    <k>k1</k>\n"
+            "    <v>10</v>\n"
+            "  </l2>\n"
+            "</cont>\n");
+    free(str);
+
+    /* the groups of the user are collected again after a group change */
+    ret = sr_delete_item(sess, "/ietf-netconf-acm:nacm/groups/group[name='test-group']/user-name[.='test-user']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(st->sess, "/test:cont/l2", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_null(data);
+
+    sr_session_stop(sess);
+}
+
 int
 main(void)
 {
@@ -825,6 +1128,9 @@ main(void)
         cmocka_unit_test_setup_teardown(test_write, setup_write_nacm, teardown_nacm),
         cmocka_unit_test_setup_teardown(test_exec, setup_exec_nacm, teardown_nacm),
         cmocka_unit_test_setup_teardown(test_read_var, setup_read_var_nacm, teardown_nacm),
+        cmocka_unit_test_setup_teardown(test_oper_denied, setup_oper_denied_nacm, teardown_nacm),
+        cmocka_unit_test_setup_teardown(test_read_large, setup_read_large_nacm, teardown_nacm),
+        cmocka_unit_test_setup_teardown(test_cache_change, setup_read_nacm, teardown_nacm),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
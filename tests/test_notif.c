@@ -917,6 +917,76 @@ test_replay_interval(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static uint32_t replay_merge_sub_ids[2];
+static char replay_merge_order[128];
+
+static void
+notif_replay_merge_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type,
+        const struct lyd_node *notif, struct timespec *timestamp, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    char sub = (sub_id == replay_merge_sub_ids[0]) ? 'a' : 'b';
+    size_t len = strlen(replay_merge_order);
+
+    (void)session;
+    (void)timestamp;
+
+    switch (notif_type) {
+    case SR_EV_NOTIF_REPLAY:
+        assert_non_null(notif);
+        snprintf(replay_merge_order + len, sizeof replay_merge_order - len, "%c%s ", sub,
+                lyd_get_value(lyd_child(lyd_child(notif))));
+        break;
+    case SR_EV_NOTIF_REPLAY_COMPLETE:
+        snprintf(replay_merge_order + len, sizeof replay_merge_order - len, "%c. ", sub);
+        break;
+    default:
+        /* ignore */
+        return;
+    }
+
+    ATOMIC_INC_RELAXED(st->cb_called);
+}
+
+static void
+test_replay_merge(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    struct timespec start = {0}, stop = {0};
+    int ret;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+    replay_merge_order[0] = '\0';
+
+    /* stop excludes the notifications and second granularity is not enough */
+    stop.tv_nsec = 999999999;
+
+    /* subscribe to 2 overlapping replay intervals */
+    start.tv_sec = start_ts + 2;
+    stop.tv_sec = start_ts + 10;
+    ret = sr_notif_subscribe_tree(st->sess, "ops", NULL, &start, &stop, notif_replay_merge_cb, st, SR_SUBSCR_NO_THREAD,
+            &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    replay_merge_sub_ids[0] = sr_subscription_get_last_sub_id(subscr);
+
+    start.tv_sec = start_ts + 8;
+    stop.tv_sec = start_ts + 12;
+    ret = sr_notif_subscribe_tree(st->sess, "ops", NULL, &start, &stop, notif_replay_merge_cb, st, SR_SUBSCR_NO_THREAD,
+            &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    replay_merge_sub_ids[1] = sr_subscription_get_last_sub_id(subscr);
+
+    /* both replays are performed at once, merged by the notification timestamps */
+    ret = sr_subscription_process_events(subscr, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 11);
+    assert_string_equal(replay_merge_order, "a3 a4 a5 b5 a6 b6 a7 b7 b8 a. b. ");
+
+    sr_unsubscribe(subscr);
+}
+
 /* TEST */
 static void
 notif_no_replay_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type,
@@ -1674,6 +1744,178 @@ test_send_nowait2(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static void
+test_send_queued(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    int ret, i;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    ret = sr_notif_subscribe(st->sess, "ops", NULL, NULL, NULL, notif_send_nowait_cb, st, SR_SUBSCR_NO_THREAD, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* send several notifs without processing them, none of the originators wait for the previous ones */
+    for (i = 0; i < 5; ++i) {
+        ret = sr_notif_send(st->sess, "/ops:notif4", NULL, 0, 0, 0);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    /* process all the events at once */
+    ret = sr_subscription_process_events(subscr, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 5);
+
+    /* nothing more to process */
+    ret = sr_subscription_process_events(subscr, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 5);
+
+    sr_unsubscribe(subscr);
+}
+
+/* TEST */
+static void
+test_send_batch(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    struct lyd_node *notifs[20];
+    int ret, i;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    ret = sr_notif_subscribe(st->sess, "ops", NULL, NULL, NULL, notif_send_nowait_cb, st, SR_SUBSCR_NO_THREAD, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* more notifs than there are slots for separate events */
+    for (i = 0; i < 20; ++i) {
+        assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, st->ly_ctx, "/ops:notif4", NULL, 0, &notifs[i]));
+    }
+
+    /* send them all in a single event */
+    ret = sr_notif_send_batch(st->sess, notifs, 20, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    for (i = 0; i < 20; ++i) {
+        lyd_free_all(notifs[i]);
+    }
+
+    /* process all the notifs at once */
+    ret = sr_subscription_process_events(subscr, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 20);
+
+    sr_unsubscribe(subscr);
+}
+
+/* TEST */
+static void
+test_send_filter(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    struct lyd_node *notif;
+    const char *values[] = {"a", "x", "b'c", NULL};
+    int ret, i;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    /* compiled filter */
+    ret = sr_notif_subscribe(st->sess, "ops", "(/ops:notif4[l='a'] | /ops:notif4[ops:l=\"b'c\"])", NULL, NULL,
+            notif_send_nowait_cb, st, SR_SUBSCR_NO_THREAD, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* evaluated filter */
+    ret = sr_notif_subscribe(st->sess, "ops", "/ops:notif4[starts-with(l, 'b')]", NULL, NULL, notif_send_nowait_cb,
+            st, SR_SUBSCR_NO_THREAD, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    for (i = 0; i < 4; ++i) {
+        if (values[i]) {
+            assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, st->ly_ctx, "/ops:notif4/l", values[i], 0, &notif));
+        } else {
+            assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, st->ly_ctx, "/ops:notif4", NULL, 0, &notif));
+        }
+        ret = sr_notif_send_tree(st->sess, notif, 0, 0);
+        lyd_free_all(notif);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    /* "a" and "b'c" pass the first filter, "b'c" passes the second one */
+    ret = sr_subscription_process_events(subscr, NULL, NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 3);
+
+    sr_unsubscribe(subscr);
+}
+
+/* TEST */
+static void
+notif_compact_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type, const char *xpath,
+        const sr_val_t *values, const size_t values_cnt, struct timespec *timestamp, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)values;
+    (void)values_cnt;
+    (void)timestamp;
+
+    if (notif_type == SR_EV_NOTIF_TERMINATED) {
+        /* ignore */
+        return;
+    }
+
+    assert_int_equal(notif_type, SR_EV_NOTIF_REALTIME);
+    assert_string_equal(xpath, "/ops:notif4");
+
+    /* signal that we were called */
+    ATOMIC_INC_RELAXED(st->cb_called);
+    pthread_barrier_wait(&st->barrier);
+}
+
+static void
+test_compact_shm(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr[8] = {NULL};
+    int ret, i;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    /* subscribe several times */
+    for (i = 0; i < 8; ++i) {
+        ret = sr_notif_subscribe(st->sess, "ops", "/ops:notif4", NULL, NULL, notif_compact_cb, st, 0, &subscr[i]);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    /* unsubscribe all but the last, leaving memory holes */
+    for (i = 0; i < 7; ++i) {
+        sr_unsubscribe(subscr[i]);
+    }
+
+    /* compact */
+    ret = sr_compact_ext_shm(st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the subscription still works */
+    ret = sr_notif_send(st->sess, "/ops:notif4", NULL, 0, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for the callback */
+    pthread_barrier_wait(&st->barrier);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
+
+    /* compact again, nothing to do */
+    ret = sr_compact_ext_shm(st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_unsubscribe(subscr[7]);
+}
+
 /* TEST */
 static void
 notif_schema_mount_cb(sr_session_ctx_t *session, uint32_t sub_id, const sr_ev_notif_type_t notif_type,
@@ -1842,6 +2084,7 @@ main(void)
         cmocka_unit_test_setup(test_stop, clear_ops_notif),
         cmocka_unit_test_setup_teardown(test_replay_simple, clear_ops_notif, clear_ops),
         cmocka_unit_test_setup(test_replay_interval, create_ops_notif),
+        cmocka_unit_test(test_replay_merge),
         cmocka_unit_test_setup_teardown(test_no_replay, clear_ops_notif, clear_ops),
         cmocka_unit_test_teardown(test_notif_config_change, clear_ops),
         cmocka_unit_test_teardown(test_notif_buffer, clear_session),
@@ -1851,6 +2094,10 @@ main(void)
         cmocka_unit_test(test_wait),
         cmocka_unit_test(test_send_nowait),
         cmocka_unit_test(test_send_nowait2),
+        cmocka_unit_test(test_send_queued),
+        cmocka_unit_test(test_send_batch),
+        cmocka_unit_test(test_send_filter),
+        cmocka_unit_test(test_compact_shm),
         cmocka_unit_test(test_schema_mount),
     };
 
@@ -36,6 +36,7 @@ struct state {
     sr_conn_ctx_t *conn;
     sr_session_ctx_t *sess;
     ATOMIC_T cb_called;
+    ATOMIC_T max_depth;
     pthread_barrier_t barrier2;
     pthread_barrier_t barrier5;
 };
@@ -249,7 +250,7 @@ static void
 test_yang_lib(void **state)
 {
     struct state *st = (struct state *)*state;
-    sr_data_t *data;
+    sr_data_t *data, *data2;
     sr_subscription_ctx_t *subscr = NULL;
     int ret;
 
@@ -276,8 +277,24 @@ test_yang_lib(void **state)
     assert_string_equal(data->tree->schema->name, "modules-state");
     assert_string_equal(lyd_child(data->tree)->prev->schema->name, "module-set-id");
 #endif
+
+    /* read the cached data, they are the same */
+    ret = sr_get_data(st->sess, "/ietf-yang-library:*", 0, 0, 0, &data2);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(lyd_compare_siblings(data->tree, data2->tree, LYD_COMPARE_FULL_RECURSION), LY_SUCCESS);
+    sr_release_data(data2);
     sr_release_data(data);
 
+    /* context change, the data are generated again */
+    ret = sr_install_module(st->conn, TESTS_SRC_DIR "/files/simple.yang", TESTS_SRC_DIR "/files", NULL);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->sess, "/ietf-yang-library:*//module[name='simple']", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(data);
+    sr_release_data(data);
+    ret = sr_remove_module(st->conn, "simple", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
     /* subscribe as dummy state data provider, they should get deleted */
     ret = sr_oper_get_subscribe(st->sess, "ietf-yang-library", "/ietf-yang-library:*", yang_lib_oper_cb, NULL, 0, &subscr);
     assert_int_equal(ret, SR_ERR_OK);
@@ -2162,6 +2179,99 @@ test_xpath_check(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static int
+max_depth_oper_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    const struct ly_ctx *ly_ctx = sr_acquire_context(sr_session_get_connection(session));
+
+    (void)sub_id;
+    (void)module_name;
+    (void)xpath;
+    (void)request_xpath;
+    (void)request_id;
+
+    ATOMIC_STORE_RELAXED(st->max_depth, sr_session_get_oper_max_depth(session));
+
+    assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, ly_ctx, "/ietf-interfaces:interfaces-state/interface[name='eth0']/type",
+            "iana-if-type:ethernetCsmacd", 0, parent));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(*parent, NULL, "/ietf-interfaces:interfaces-state/interface[name='eth0']/"
+            "oper-status", "up", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(*parent, NULL, "/ietf-interfaces:interfaces-state/interface[name='eth0']/"
+            "statistics/discontinuity-time", "2000-01-01T02:00:00-00:00", 0, NULL));
+
+    sr_release_context(sr_session_get_connection(session));
+
+    ATOMIC_INC_RELAXED(st->cb_called);
+    return SR_ERR_OK;
+}
+
+static void
+test_max_depth(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_data_t *data;
+    sr_subscription_ctx_t *subscr = NULL;
+    char *str1;
+    const char *str2;
+    int ret;
+
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_oper_get_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state", max_depth_oper_cb,
+            st, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* unlimited depth */
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->max_depth), 0);
+
+    /* only the interfaces with their keys */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state", 2, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->max_depth), 2);
+
+    lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    sr_release_data(data);
+    str2 =
+            "<interfaces-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+            "<interface><name>eth0</name></interface>"
+            "</interfaces-state>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    /* only the subscription nodes */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:*", 1, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 3);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->max_depth), 1);
+
+    /* a deeper node selected */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state/interface/statistics", 1, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 4);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->max_depth), 3);
+
+    /* predicate, depth not known */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state/interface[name='eth0']", 1, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 5);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->max_depth), 0);
+
+    sr_unsubscribe(subscr);
+}
+
 /* TEST */
 static int
 state_only_oper_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
@@ -3142,6 +3252,64 @@ test_same_xpath_parallel(void **state)
     sr_unsubscribe(subscr5);
 }
 
+/* TEST */
+static int
+diff_xpath_parallel_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
+        const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    const struct ly_ctx *ly_ctx;
+
+    (void)sub_id;
+    (void)module_name;
+    (void)request_xpath;
+    (void)request_id;
+
+    /* wait for the other provider so that we assure the requests are sent in parallel */
+    pthread_barrier_wait(&st->barrier2);
+
+    if (!strcmp(xpath, "/ietf-interfaces:interfaces-state")) {
+        ly_ctx = sr_acquire_context(sr_session_get_connection(session));
+        assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, ly_ctx, "/ietf-interfaces:interfaces-state/interface[name='eth5']/"
+                "type", "iana-if-type:ethernetCsmacd", 0, parent));
+        sr_release_context(sr_session_get_connection(session));
+    }
+
+    return SR_ERR_OK;
+}
+
+static void
+test_diff_xpath_parallel(void **state)
+{
+    struct state *st = (struct state *)*state;
+    int ret;
+    sr_data_t *data;
+    sr_subscription_ctx_t *subscr1 = NULL, *subscr2 = NULL;
+    struct lyd_node *node;
+
+    /* subscribe as state data providers of different subtrees, in separate threads */
+    ret = sr_oper_get_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state", diff_xpath_parallel_cb,
+            st, 0, &subscr1);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_oper_get_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces", diff_xpath_parallel_cb,
+            st, 0, &subscr2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read the data from operational, both providers must be asked at once */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_get_data(st->sess, "/ietf-interfaces:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    assert_int_equal(LY_SUCCESS, lyd_find_path(data->tree, "/ietf-interfaces:interfaces-state/interface[name='eth5']",
+            0, &node));
+
+    sr_release_data(data);
+
+    sr_unsubscribe(subscr1);
+    sr_unsubscribe(subscr2);
+}
+
 /* TEST */
 static int
 same_xpath_fail_successful_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name, const char *xpath,
@@ -3374,6 +3542,72 @@ test_cache(void **state)
     assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
 }
 
+/* TEST */
+static void
+test_cache_shared(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_data_t *data;
+    sr_subscription_ctx_t *subscr1 = NULL, *subscr2 = NULL;
+    char *str1;
+    const char *str2;
+    int ret;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    /* subscribe as state data provider */
+    ret = sr_oper_get_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state", cache_oper_cb,
+            st, 0, &subscr1);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe for oper poll */
+    ret = sr_oper_poll_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state", 3000, 0, &subscr2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read the data from operational using another connection */
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_OPERATIONAL, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(sess, "/ietf-interfaces:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+
+    sr_release_data(data);
+
+    str2 =
+            "<interfaces-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">\n"
+            "  <interface>\n"
+            "    <name>eth5</name>\n"
+            "    <type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>\n"
+            "    <oper-status>testing</oper-status>\n"
+            "    <statistics>\n"
+            "      <discontinuity-time>2000-01-01T02:00:00-00:00</discontinuity-time>\n"
+            "    </statistics>\n"
+            "  </interface>\n"
+            "</interfaces-state>\n";
+
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    /* the shared cache is bypassed if requested */
+    ret = sr_get_data(sess, "/ietf-interfaces:*", 0, 0, SR_OPER_NO_POLL_CACHED, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_release_data(data);
+
+    sr_disconnect(conn);
+    sr_unsubscribe(subscr1);
+    sr_unsubscribe(subscr2);
+
+    /* one callback call for the cache and one for the bypassing read */
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
+}
+
 /* TEST */
 static void
 test_cache_no_sub(void **state)
@@ -3745,6 +3979,7 @@ main(void)
         cmocka_unit_test_teardown(test_invalid, clear_up),
         cmocka_unit_test_teardown(test_mixed, clear_up),
         cmocka_unit_test_teardown(test_xpath_check, clear_up),
+        cmocka_unit_test_teardown(test_max_depth, clear_up),
         cmocka_unit_test_teardown(test_state_only, clear_up),
         cmocka_unit_test_teardown(test_config_only, clear_up),
         cmocka_unit_test_teardown(test_union, clear_up),
@@ -3755,8 +3990,10 @@ main(void)
         cmocka_unit_test_teardown(test_state_default_merge, clear_up),
         cmocka_unit_test_teardown(test_same_xpath, clear_up),
         cmocka_unit_test_teardown(test_same_xpath_parallel, clear_up),
+        cmocka_unit_test_teardown(test_diff_xpath_parallel, clear_up),
         cmocka_unit_test_teardown(test_same_xpath_fail, clear_up),
         cmocka_unit_test_teardown(test_cache, clear_up),
+        cmocka_unit_test_teardown(test_cache_shared, clear_up),
         cmocka_unit_test_teardown(test_cache_no_sub, clear_up),
         cmocka_unit_test_teardown(test_cache_diff, clear_up),
     };
@@ -4207,6 +4207,72 @@ test_oper_list_enabled(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static void
+test_oper_slot(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_oper_slot_t *slot;
+    sr_val_t *val;
+    int ret;
+
+    /* switch to operational DS */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* not a state leaf */
+    ret = sr_oper_slot_add(st->sess, "/mixed-config:test-state/test-case[name='c1']/a", "val", &slot);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    /* add a slot */
+    ret = sr_oper_slot_add(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", "1", &slot);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read it */
+    ret = sr_get_item(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", 0, &val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(val->data.uint32_val, 1);
+    sr_free_val(val);
+
+    /* invalid arguments */
+    ret = sr_oper_slot_set(NULL, "42");
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+    ret = sr_oper_slot_set(slot, NULL);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    /* update it */
+    ret = sr_oper_slot_set(slot, "42");
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_item(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", 0, &val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(val->data.uint32_val, 42);
+    sr_free_val(val);
+
+    /* remove it */
+    ret = sr_oper_slot_del(slot);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_item(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", 0, &val);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+
+    /* add it again, read using the already mapped slots */
+    ret = sr_oper_slot_add(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", "7", &slot);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_item(st->sess, "/mixed-config:test-state/test-case[name='c1']/result", 0, &val);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(val->data.uint32_val, 7);
+    sr_free_val(val);
+
+    ret = sr_oper_slot_del(slot);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* cleanup */
+    ret = sr_session_switch_ds(st->sess, SR_DS_RUNNING);
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
 int
 main(void)
 {
@@ -4238,6 +4304,7 @@ main(void)
         cmocka_unit_test_teardown(test_oper_set_del_leaflist, clear_up),
         cmocka_unit_test_teardown(test_change_filter, clear_up),
         cmocka_unit_test_teardown(test_oper_list_enabled, clear_up),
+        cmocka_unit_test_teardown(test_oper_slot, clear_up),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
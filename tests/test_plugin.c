@@ -23,6 +23,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -35,6 +36,8 @@
 #include "sysrepo.h"
 
 #include "common.h"
+#include "common_json.h"
+#include "config.h"
 #include "plugins_datastore.h"
 #include "tests/tcommon.h"
 
@@ -1410,6 +1413,304 @@ test_copy(void **state)
     assert_true(perm == (S_IRUSR | S_IWUSR));
 }
 
+#if defined (SR_JSON_DS_JOURNAL) || defined (SR_JSON_DS_SHARDS) || defined (SR_JSON_DS_OPER_SEGMENTS) || \
+        defined (SR_JSON_DS_CANDIDATE_OVERLAY)
+
+/**
+ * @brief Get path of a file of the module data stored by a file plugin.
+ *
+ * @param[in] ds Datastore of the data.
+ * @param[in] suffix Suffix of the file appended to the datastore file path.
+ * @return File path;
+ * @return NULL if the tested plugin does not store the data in files.
+ */
+static char *
+file_plg_path(sr_datastore_t ds, const char *suffix)
+{
+    sr_error_info_t *err_info;
+    const char *plg_suffix;
+    char *ds_path, *path;
+
+    if (!strcmp(plg_name, "JSON DS file")) {
+        plg_suffix = "";
+    } else if (!strcmp(plg_name, "LYB DS file")) {
+        plg_suffix = ".lyb";
+    } else {
+        return NULL;
+    }
+
+    err_info = srpjson_get_path(plg_name, "plugin", ds, &ds_path);
+    assert_null(err_info);
+    assert_int_not_equal(asprintf(&path, "%s%s%s", ds_path, plg_suffix, suffix), -1);
+    free(ds_path);
+    return path;
+}
+
+#endif
+
+#ifdef SR_JSON_DS_JOURNAL
+
+/* TEST */
+static void
+test_journal(void **state)
+{
+    int rc;
+    test_data_t *tdata = *state;
+    struct stat st;
+    sr_val_t *val = NULL;
+    char *path, *str;
+    off_t size;
+
+    if (!(path = file_plg_path(SR_DS_RUNNING, SRPJSON_FILE_JOURNAL_SUFFIX))) {
+        return;
+    }
+
+    /* the changes are appended into the journal */
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", "a", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(stat(path, &st), 0);
+    size = st.st_size;
+
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", "b", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(stat(path, &st), 0);
+    assert_true(st.st_size > size);
+
+    /* the journaled changes are loaded */
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, "b");
+    sr_free_val(val);
+
+    /* a change not fitting into the journal stores the whole file with all the changes */
+    str = malloc(SRPJSON_JOURNAL_MIN_SIZE * 1024 + 1);
+    assert_non_null(str);
+    memset(str, 'c', SRPJSON_JOURNAL_MIN_SIZE * 1024);
+    str[SRPJSON_JOURNAL_MIN_SIZE * 1024] = '\0';
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='b']/acs2", str, NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(stat(path, &st), -1);
+    assert_int_equal(errno, ENOENT);
+
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, "b");
+    sr_free_val(val);
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='b']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, str);
+    sr_free_val(val);
+
+    free(str);
+    free(path);
+}
+
+#endif
+
+#ifdef SR_JSON_DS_SHARDS
+
+/* TEST */
+static void
+test_shards(void **state)
+{
+    int rc;
+    test_data_t *tdata = *state;
+    struct stat st;
+    sr_val_t *val = NULL;
+    char *path, *shard_path, *manifest_path, *str, buf[32];
+    FILE *f;
+
+    if (!(path = file_plg_path(SR_DS_RUNNING, ""))) {
+        return;
+    }
+    shard_path = file_plg_path(SR_DS_RUNNING, SRPJSON_FILE_SHARD_SUFFIX "simple-cont");
+    manifest_path = file_plg_path(SR_DS_RUNNING, SRPJSON_FILE_SHARDS_SUFFIX);
+
+    /* large enough not to fit into the journal, if used, so that the data are stored right away */
+    str = malloc(SRPJSON_JOURNAL_MIN_SIZE * 1024 + 1);
+    assert_non_null(str);
+    memset(str, 'a', SRPJSON_JOURNAL_MIN_SIZE * 1024);
+    str[SRPJSON_JOURNAL_MIN_SIZE * 1024] = '\0';
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", str, NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the top-level container is stored in its shard, listed in the manifest */
+    assert_int_equal(stat(shard_path, &st), 0);
+    assert_true(st.st_size > SRPJSON_JOURNAL_MIN_SIZE * 1024);
+    assert_int_equal(stat(path, &st), 0);
+    assert_true(st.st_size < SRPJSON_JOURNAL_MIN_SIZE * 1024);
+
+    f = fopen(manifest_path, "r");
+    assert_non_null(f);
+    assert_non_null(fgets(buf, sizeof buf, f));
+    assert_string_equal(buf, "simple-cont\n");
+    assert_null(fgets(buf, sizeof buf, f));
+    fclose(f);
+
+    /* the data are loaded from the shard */
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, str);
+    sr_free_val(val);
+
+    free(str);
+    free(path);
+    free(shard_path);
+    free(manifest_path);
+}
+
+#endif
+
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+
+/* TEST */
+static void
+test_candidate_overlay(void **state)
+{
+    int rc;
+    test_data_t *tdata = *state;
+    sr_val_t *val = NULL;
+    char *path, *ovl_path;
+
+    if (!(path = file_plg_path(SR_DS_CANDIDATE, ""))) {
+        return;
+    }
+    ovl_path = file_plg_path(SR_DS_CANDIDATE, SRPJSON_FILE_OVERLAY_SUFFIX);
+
+    /* only the changes of the running data are stored */
+    rc = sr_session_switch_ds(tdata->sess, SR_DS_CANDIDATE);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", "a", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_true(srpjson_file_exists(plg_name, ovl_path));
+    assert_false(srpjson_file_exists(plg_name, path));
+
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, "a");
+    sr_free_val(val);
+
+    /* running data not affected */
+    rc = sr_session_switch_ds(tdata->sess, SR_DS_RUNNING);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_NOT_FOUND);
+
+    /* changing the running data stores the candidate data with the changes from the overlay */
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='b']/acs2", "b", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_false(srpjson_file_exists(plg_name, ovl_path));
+    assert_true(srpjson_file_exists(plg_name, path));
+
+    rc = sr_session_switch_ds(tdata->sess, SR_DS_CANDIDATE);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='a']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_string_equal(val->data.string_val, "a");
+    sr_free_val(val);
+    rc = sr_get_item(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/acl1[acs1='b']/acs2", 0, &val);
+    assert_int_equal(rc, SR_ERR_NOT_FOUND);
+
+    /* reset */
+    rc = sr_copy_config(tdata->sess, "plugin", SR_DS_RUNNING, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_false(srpjson_file_exists(plg_name, ovl_path));
+    assert_false(srpjson_file_exists(plg_name, path));
+
+    free(path);
+    free(ovl_path);
+}
+
+#endif
+
+#ifdef SR_JSON_DS_OPER_SEGMENTS
+
+/* TEST */
+static void
+test_oper_segments(void **state)
+{
+    int rc;
+    test_data_t *tdata = *state;
+    sr_data_t *data = NULL;
+    char *seg_path, *manifest_path, *str1 = NULL, buf[32], seg_name[32];
+    FILE *f;
+    const char *str2 =
+            "<simple-cont xmlns=\"s\">\n"
+            "  <simple-cont2>\n"
+            "    <ac1>\n"
+            "      <dup-keys>first</dup-keys>\n"
+            "      <dup-keys>second</dup-keys>\n"
+            "    </ac1>\n"
+            "  </simple-cont2>\n"
+            "</simple-cont>\n";
+
+    sprintf(seg_name, "cid-%" PRIu32, tdata->conn->cid);
+    if (!(manifest_path = file_plg_path(SR_DS_OPERATIONAL, SRPJSON_FILE_SHARDS_SUFFIX))) {
+        return;
+    }
+    assert_int_not_equal(asprintf(&str1, SRPJSON_FILE_SHARD_SUFFIX "%s", seg_name), -1);
+    seg_path = file_plg_path(SR_DS_OPERATIONAL, str1);
+    free(str1);
+    str1 = NULL;
+
+    /* OPERATIONAL */
+    rc = sr_session_switch_ds(tdata->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the first edit may create the datastore file */
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/dup-keys", "first", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_set_item_str(tdata->sess, "/plugin:simple-cont/simple-cont2/ac1/dup-keys", "second", NULL, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the edit of the connection is stored in its segment, listed in the manifest */
+    assert_true(srpjson_file_exists(plg_name, seg_path));
+    f = fopen(manifest_path, "r");
+    assert_non_null(f);
+    assert_non_null(fgets(buf, sizeof buf, f));
+    strcat(seg_name, "\n");
+    assert_string_equal(buf, seg_name);
+    assert_null(fgets(buf, sizeof buf, f));
+    fclose(f);
+
+    /* the data are loaded from the segment */
+    rc = sr_get_data(tdata->sess, "/plugin:*", 0, 0, 0, &data);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = lyd_print_mem(&str1, data->tree, LYD_XML, LYD_PRINT_WITHSIBLINGS);
+    assert_int_equal(rc, LY_SUCCESS);
+    sr_release_data(data);
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    /* the segment of a connection without any data is removed */
+    rc = sr_discard_items(tdata->sess, "/plugin:*");
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_apply_changes(tdata->sess, 0);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_false(srpjson_file_exists(plg_name, seg_path));
+
+    free(seg_path);
+    free(manifest_path);
+}
+
+#endif
+
 int
 main(void)
 {
@@ -1424,6 +1725,18 @@ main(void)
         cmocka_unit_test_teardown(test_access_setandget2, teardown_access),
         cmocka_unit_test(test_access_check),
         cmocka_unit_test_teardown(test_copy, teardown_store),
+#ifdef SR_JSON_DS_JOURNAL
+        cmocka_unit_test_teardown(test_journal, teardown_store),
+#endif
+#ifdef SR_JSON_DS_SHARDS
+        cmocka_unit_test_teardown(test_shards, teardown_store),
+#endif
+#ifdef SR_JSON_DS_CANDIDATE_OVERLAY
+        cmocka_unit_test_teardown(test_candidate_overlay, teardown_store),
+#endif
+#ifdef SR_JSON_DS_OPER_SEGMENTS
+        cmocka_unit_test_teardown(test_oper_segments, teardown_store_oper),
+#endif
     };
 
     int rc;
@@ -1311,6 +1311,145 @@ test_rpc_shelve(void **state)
     pthread_join(tid[1], NULL);
 }
 
+/* TEST */
+static int
+rpc_pipeline_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *op_path, const struct lyd_node *input,
+        sr_event_t event, uint32_t request_id, struct lyd_node *output, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+
+    (void)session;
+    (void)sub_id;
+    (void)op_path;
+    (void)input;
+    (void)event;
+    (void)request_id;
+
+    /* callback called */
+    ATOMIC_INC_RELAXED(st->cb_called);
+
+    /* wait for the callback of the other RPC, they must be processed at once */
+    pthread_barrier_wait(&st->barrier);
+
+    /* create output data */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(output, NULL, "l5", "256", LYD_NEW_VAL_OUTPUT, NULL));
+
+    return SR_ERR_OK;
+}
+
+static void *
+send_rpc_pipeline_thread(void *arg)
+{
+    struct state *st = (struct state *)arg;
+    sr_session_ctx_t *sess;
+    struct lyd_node *input_op;
+    sr_data_t *output_op;
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* create the RPC */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, st->ly_ctx, "/ops:rpc3/l4", "vall", 0, &input_op));
+
+    /* send the RPC */
+    ret = sr_rpc_send_tree(sess, input_op, 0, &output_op);
+    lyd_free_all(input_op);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* check output */
+    assert_string_equal(lyd_child(output_op->tree)->schema->name, "l5");
+    assert_string_equal(lyd_get_value(lyd_child(output_op->tree)), "256");
+
+    sr_release_data(output_op);
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static void
+test_rpc_pipeline(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    pthread_t tid[2];
+    int count, ret;
+
+    ATOMIC_STORE_RELAXED(st->cb_called, 0);
+
+    /* the lanes of the RPC are processed by different workers */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc3", rpc_pipeline_cb, st, 0, SR_SUBSCR_THREAD_POOL, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    pthread_create(&tid[0], NULL, send_rpc_pipeline_thread, st);
+
+    /* send the second RPC only when the first is being processed */
+    count = 0;
+    while ((ATOMIC_LOAD_RELAXED(st->cb_called) < 1) && (count < 1500)) {
+        usleep(10000);
+        ++count;
+    }
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 1);
+
+    pthread_create(&tid[1], NULL, send_rpc_pipeline_thread, st);
+
+    pthread_join(tid[0], NULL);
+    pthread_join(tid[1], NULL);
+    assert_int_equal(ATOMIC_LOAD_RELAXED(st->cb_called), 2);
+
+    sr_unsubscribe(subscr);
+}
+
+/* TEST */
+static int
+rpc_trusted_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *op_path, const struct lyd_node *input,
+        sr_event_t event, uint32_t request_id, struct lyd_node *output, void *private_data)
+{
+    (void)session;
+    (void)sub_id;
+    (void)op_path;
+    (void)input;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    /* create invalid output data, there is no leafref target */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(output, NULL, "cont/l3", "inval-ref", LYD_NEW_VAL_OUTPUT, NULL));
+
+    return SR_ERR_OK;
+}
+
+static void
+test_rpc_trusted(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr = NULL;
+    struct lyd_node *input;
+    sr_data_t *output;
+    int ret;
+
+    assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, st->ly_ctx, "/ops:rpc2", NULL, 0, &input));
+
+    /* the output is validated */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc2", rpc_trusted_cb, NULL, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_send_tree(st->sess, input, 0, &output);
+    assert_int_equal(ret, SR_ERR_VALIDATION_FAILED);
+    assert_null(output);
+    sr_unsubscribe(subscr);
+    subscr = NULL;
+
+    /* the output is trusted */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc2", rpc_trusted_cb, NULL, 0, SR_SUBSCR_RPC_TRUSTED, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_send_tree(st->sess, input, 0, &output);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(output->tree, "cont/l3", 0, NULL));
+    sr_release_data(output);
+    sr_unsubscribe(subscr);
+
+    lyd_free_all(input);
+}
+
 /* TEST */
 static int
 rpc_dummy_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *xpath, const sr_val_t *input, const size_t input_cnt,
@@ -2004,6 +2143,8 @@ main(void)
         cmocka_unit_test(test_action_deps),
         cmocka_unit_test_teardown(test_action_change_config, clear_ops),
         cmocka_unit_test(test_rpc_shelve),
+        cmocka_unit_test(test_rpc_pipeline),
+        cmocka_unit_test(test_rpc_trusted),
         cmocka_unit_test(test_input_parameters),
         cmocka_unit_test_teardown(test_rpc_action_with_no_thread, clear_ops),
         cmocka_unit_test(test_rpc_oper),
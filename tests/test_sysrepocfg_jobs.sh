@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# Test of sysrepocfg import and export with concurrent per-module jobs.
+#
+# usage: test_sysrepocfg_jobs.sh <sysrepoctl> <sysrepocfg> <tests-src-dir> <work-dir>
+#
+
+set -e
+
+SYSREPOCTL="$1"
+SYSREPOCFG="$2"
+FILES="$3/files"
+WORK="$4"
+
+rm -rf "$WORK"
+mkdir -p "$WORK/dir"
+
+# install the modules
+"$SYSREPOCTL" -s "$FILES" -i "$FILES/test.yang"
+"$SYSREPOCTL" -s "$FILES" -i "$FILES/iana-if-type.yang"
+"$SYSREPOCTL" -s "$FILES" -i "$FILES/ietf-interfaces.yang"
+
+cat > "$WORK/data.xml" <<END
+<test-leaf xmlns="urn:test">12</test-leaf>
+<interfaces xmlns="urn:ietf:params:xml:ns:yang:ietf-interfaces">
+  <interface>
+    <name>eth1</name>
+    <type xmlns:ianaift="urn:ietf:params:xml:ns:yang:iana-if-type">ianaift:ethernetCsmacd</type>
+  </interface>
+</interfaces>
+END
+: > "$WORK/empty.xml"
+
+# import from a file split into modules
+"$SYSREPOCFG" --import="$WORK/data.xml" -f xml -j 2
+
+# export merged in the module order must match the sequential export
+"$SYSREPOCFG" --export="$WORK/one.xml" -f xml
+"$SYSREPOCFG" --export="$WORK/two.xml" -f xml -j 2
+cmp "$WORK/one.xml" "$WORK/two.xml"
+grep -q "<test-leaf" "$WORK/one.xml"
+grep -q "<name>eth1</name>" "$WORK/one.xml"
+
+# export into a directory, a file per module
+"$SYSREPOCFG" --export="$WORK/dir" -f xml -j 2
+grep -q "<test-leaf" "$WORK/dir/test.xml"
+grep -q "<name>eth1</name>" "$WORK/dir/ietf-interfaces.xml"
+
+# clear the configuration
+"$SYSREPOCFG" --import="$WORK/empty.xml" -f xml
+"$SYSREPOCFG" --export="$WORK/cleared.xml" -f xml
+if grep -q "<test-leaf" "$WORK/cleared.xml"; then
+    echo "Configuration was not cleared." >&2
+    exit 1
+fi
+
+# import from the directory restores the same configuration
+"$SYSREPOCFG" --import="$WORK/dir" -f xml -j 2
+"$SYSREPOCFG" --export="$WORK/three.xml" -f xml -j 2
+cmp "$WORK/one.xml" "$WORK/three.xml"
+
+rm -rf "$WORK"
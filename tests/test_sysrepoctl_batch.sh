@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Test of sysrepoctl batch of module and feature changes.
+#
+# usage: test_sysrepoctl_batch.sh <sysrepoctl> <tests-src-dir> <work-dir>
+#
+
+set -e
+
+SYSREPOCTL="$1"
+FILES="$2/files"
+WORK="$3"
+
+rm -rf "$WORK"
+mkdir -p "$WORK"
+
+# print the list line of a module
+mod_line() {
+    "$SYSREPOCTL" -l | grep "^$1 " || true
+}
+
+# fail with a message
+fail() {
+    echo "$1" >&2
+    "$SYSREPOCTL" -l >&2
+    exit 1
+}
+
+# install with features, the enabled feature is merged into the installation
+cat > "$WORK/batch1" <<END
+# modules
+install $FILES/test.yang
+install $FILES/features.yang feat1
+
+enable-feature features feat2   # implies feat1
+END
+"$SYSREPOCTL" -s "$FILES" -b "$WORK/batch1"
+
+[ -n "$(mod_line test)" ] || fail "Module \"test\" not installed."
+mod_line features | grep -q "feat1" || fail "Feature \"feat1\" not enabled."
+mod_line features | grep -q "feat2" || fail "Feature \"feat2\" not enabled."
+if mod_line features | grep -q "feat3"; then
+    fail "Feature \"feat3\" enabled."
+fi
+
+# feature changes of an installed module
+printf "enable-feature features feat3\n" > "$WORK/batch2"
+"$SYSREPOCTL" -b "$WORK/batch2"
+mod_line features | grep -q "feat3" || fail "Feature \"feat3\" not enabled."
+
+printf "disable-feature features feat3\n" > "$WORK/batch3"
+"$SYSREPOCTL" -b "$WORK/batch3"
+if mod_line features | grep -q "feat3"; then
+    fail "Feature \"feat3\" not disabled."
+fi
+mod_line features | grep -q "feat2" || fail "Feature \"feat2\" disabled."
+
+# invalid batch must fail without any changes
+printf "uninstall features\nrename features\n" > "$WORK/batch4"
+if "$SYSREPOCTL" -b "$WORK/batch4" 2> /dev/null; then
+    fail "Invalid batch succeeded."
+fi
+[ -n "$(mod_line features)" ] || fail "Module \"features\" uninstalled by an invalid batch."
+
+# uninstall dependent modules together
+printf "uninstall features test\n" > "$WORK/batch5"
+"$SYSREPOCTL" -b "$WORK/batch5"
+[ -z "$(mod_line features)" ] || fail "Module \"features\" not uninstalled."
+[ -z "$(mod_line test)" ] || fail "Module \"test\" not uninstalled."
+
+rm -rf "$WORK"
@@ -136,6 +136,14 @@ test_leafref(void **state)
     ret = sr_discard_changes(st->sess);
     assert_int_equal(ret, SR_ERR_OK);
 
+    /* only a value change of the referenced leaf, still needs to be validated */
+    ret = sr_set_item_str(st->sess, "/test:test-leaf", "8", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_VALIDATION_FAILED);
+    ret = sr_discard_changes(st->sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
     /* check final datastore contents */
     ret = sr_get_data(st->sess, "/test:* | /refs:*", 0, 0, 0, &data);
     assert_int_equal(ret, SR_ERR_OK);
@@ -147,6 +155,12 @@ test_leafref(void **state)
     assert_string_equal(data->tree->next->next->schema->name, "cont");
 
     sr_release_data(data);
+
+    /* creating referenced data cannot break the references */
+    ret = sr_set_item_str(st->sess, "/test:ll1[.='-3000']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0);
+    assert_int_equal(ret, SR_ERR_OK);
 }
 
 static void